@@ -11,16 +11,19 @@
 #include "game/gameConnection.h"
 #include "core/fileStream.h"
 #include "audio/audioStreamSourceFactory.h"
+#include "audio/audioStreamThread.h"
 
 #ifdef TORQUE_OS_MAC
 //#define REL_WORKAROUND
 #endif
 
 //-------------------------------------------------------------------------
-#define MAX_AUDIOSOURCES      16                // maximum number of concurrent sources
+#define MAX_AUDIOSOURCES      32                // maximum number of concurrent sources
 #define MIN_GAIN              0.05f             // anything with lower gain will not be started
 #define MIN_UNCULL_PERIOD     500               // time before buffer is checked to be unculled
 #define MIN_UNCULL_GAIN       0.1f              // min gain of source to be unculled
+#define CULL_HYSTERESIS       1.25f             // a sound has to be this much louder to take another's source
+#define VOICE_FADE_MS         150               // fade time for loopers/streamers moving on and off sources
 
 #define ALX_DEF_SAMPLE_RATE      44100          // default values for mixer
 #define ALX_DEF_SAMPLE_BITS      16
@@ -74,6 +77,19 @@ static F32                    mScore[MAX_AUDIOSOURCES];                    // fo
 static F32                    mSourceVolume[MAX_AUDIOSOURCES];             // the samples current un-attenuated gain (not scaled by master/channel gains)
 static U32                    mType[MAX_AUDIOSOURCES];                     // the channel which this source belongs
 
+// Virtual voices: the loopers and streamers are tracked by their images
+// whether or not they have a source, and move on and off the sources as
+// their scores change.  The scores are computed in one pass over the
+// values below, which mirror what was last set on each source so scoring
+// needs no AL queries, and a voice fades out before it gives up its
+// source to a looper or streamer, and fades in when it gets one back.
+static bool                   mSource3D[MAX_AUDIOSOURCES];                 // positioned in the world (not listener relative)
+static Point3F                mSourcePosition[MAX_AUDIOSOURCES];
+static F32                    mSourceMinDistance[MAX_AUDIOSOURCES];        // AL_REFERENCE_DISTANCE
+static F32                    mSourceMaxDistance[MAX_AUDIOSOURCES];        // AL_MAX_DISTANCE
+static F32                    mFadeGain[MAX_AUDIOSOURCES];                 // 0->1, scales the source gain
+static F32                    mFadeRate[MAX_AUDIOSOURCES];                 // per ms, < 0 fades out to be culled
+
 static AudioSampleEnvironment*        mSampleEnvironment[MAX_AUDIOSOURCES];           // currently playing sample environments
 static bool                           mEnvironmentEnabled = false;                    // environment enabled?
 static SimObjectPtr<AudioEnvironment> mCurrentEnvironment;                            // the last environment set
@@ -244,7 +260,75 @@ static bool findFreeSource(U32 *index)
 }
 
 //--------------------------------------------------------------------------
-// - cull out the min source that is below volume
+// the score of a sound: its volume, attenuated linearly out to the max distance
+inline F32 computeScore(F32 volume, bool is3D, const Point3F &position, F32 min, F32 max, const Point3F &listener)
+{
+   if(!is3D)
+      return(volume);
+
+   F32 dist = (position - listener).magnitudeSafe();
+   if(dist >= max)
+      return(0.f);
+   else if(dist > min)
+      return(volume * (max-dist) / (max-min));
+   return(volume);
+}
+
+// volume = SourceVolume * ChannelVolume * MasterVolume * fade
+inline F32 alxSourceGain(U32 index)
+{
+   return(mClampF(mSourceVolume[index] * mAudioTypeVolume[mType[index]] * mMasterVolume * mFadeGain[index], 0.f, 1.f));
+}
+
+// record what a newly assigned source was set up with
+static void alxSetVoice(U32 index, const Audio::Description *desc, const Point3F *position)
+{
+   mSource3D[index] = (position != NULL);
+   if(position)
+      mSourcePosition[index] = *position;
+   mSourceMinDistance[index] = desc->mReferenceDistance;
+   mSourceMaxDistance[index] = desc->mMaxDistance;
+   mFadeGain[index] = 1.f;
+   mFadeRate[index] = 0.f;
+}
+
+// a voice coming back onto a source starts silent
+static void alxFadeInVoice(U32 index)
+{
+   mFadeGain[index] = 0.f;
+   mFadeRate[index] = 1.f / VOICE_FADE_MS;
+   alSourcef(mSource[index], AL_GAIN, Audio::linearToDB(0.f));
+}
+
+// the score a source is culled by: one that's fading out is on its way anyway
+inline F32 cullScore(U32 index)
+{
+   return(mScore[index] * mFadeGain[index] * CULL_HYSTERESIS);
+}
+
+static void cullVoice(U32 best);
+
+static void alxResetVoices()
+{
+   for(U32 i = 0; i < MAX_AUDIOSOURCES; i++)
+   {
+      mSource3D[i] = false;
+      mFadeGain[i] = 1.f;
+      mFadeRate[i] = 0.f;
+   }
+}
+
+static U32 countFadingOutSources()
+{
+   U32 count = 0;
+   for(U32 i = 0; i < mNumSources; i++)
+      if(mFadeRate[i] < 0.f)
+         count++;
+   return(count);
+}
+
+//--------------------------------------------------------------------------
+// - cull out the min source that is sufficiently below volume
 // - streams/voice/loading streams are all scored > 2
 // - volumes are attenuated by channel only
 static bool cullSource(U32 *index, F32 volume)
@@ -255,9 +339,39 @@ static bool cullSource(U32 *index, F32 volume)
    S32 best = -1;
    for(S32 i = 0; i < mNumSources; i++)
    {
-      if(mScore[i] < minVolume)
+      F32 score = cullScore(i);
+      if(score < minVolume)
+      {
+         minVolume = score;
+         best = i;
+      }
+   }
+
+   if(best == -1)
+      return(false);
+
+   cullVoice(best);
+   *index = best;
+
+   return(true);
+}
+
+//--------------------------------------------------------------------------
+// Start fading out the min source that is sufficiently below volume, for a
+// looper/streamer which can wait for it.  The fade culls it when it ends.
+static bool fadeOutSource(F32 volume)
+{
+   F32 minVolume = volume;
+   S32 best = -1;
+   for(S32 i = 0; i < mNumSources; i++)
+   {
+      if(mFadeRate[i] < 0.f)
+         continue;
+
+      F32 score = cullScore(i);
+      if(score < minVolume)
       {
-         minVolume = mScore[i];
+         minVolume = score;
          best = i;
       }
    }
@@ -265,6 +379,14 @@ static bool cullSource(U32 *index, F32 volume)
    if(best == -1)
       return(false);
 
+   mFadeRate[best] = -1.f / VOICE_FADE_MS;
+   return(true);
+}
+
+//--------------------------------------------------------------------------
+// take the source away from whatever is playing on it
+static void cullVoice(U32 best)
+{
    // check if culling a looper
    LoopingList::iterator itr = mLoopingList.findImage(mHandle[best]);
    if(itr)
@@ -311,9 +433,7 @@ static bool cullSource(U32 *index, F32 volume)
    alSourceStop(mSource[best]);
    mHandle[best] = NULL_AUDIOHANDLE;
    mBuffer[best] = 0;
-   *index = best;
-
-   return(true);
+   mFadeRate[best] = 0.f;
 }
 
 //--------------------------------------------------------------------------
@@ -354,6 +474,14 @@ ALuint alxFindSource(AUDIOHANDLE handle)
    return(INVALID_SOURCE);
 }
 
+// keep the position the scores are computed from
+static void alxMoveVoice(AUDIOHANDLE handle, const Point3F &position)
+{
+   U32 idx = alxFindIndex(handle);
+   if(idx != MAX_AUDIOSOURCES)
+      mSourcePosition[idx] = position;
+}
+
 
 //--------------------------------------------------------------------------
 /**   Determmine if an AUDIOHANDLE is valid.
@@ -748,6 +876,13 @@ AUDIOHANDLE alxCreateSource(const Audio::Description *desc,
    mSourceVolume[index] = desc->mVolume;
    mSampleEnvironment[index] = sampleEnvironment;
 
+   // streamers are positioned from their image, at the origin without a transform
+   Point3F position(0.f, 0.f, 0.f);
+   if(transform)
+      transform->getColumn(3, &position);
+   bool is3D = desc->mIs3D && (transform || desc->mIsStreaming);
+   alxSetVoice(index, desc, is3D ? &position : NULL);
+
    ALuint source = mSource[index];
 
    // setup play info
@@ -1328,11 +1463,7 @@ void alxUpdateTypeGain(U32 type)
       alGetSourcei(mSource[i], AL_SOURCE_STATE, &state);
 
       if(state == AL_PLAYING)
-      {
-         // volume = SourceVolume * ChannelVolume * MasterVolume
-         F32 vol = mClampF(mSourceVolume[i] * mAudioTypeVolume[mType[i]] * mMasterVolume, 0.f, 1.f);
-         alSourcef(mSource[i], AL_GAIN, Audio::linearToDB(vol) );
-      }
+         alSourcef(mSource[i], AL_GAIN, Audio::linearToDB(alxSourceGain(i)) );
    }
 }
 
@@ -1372,12 +1503,21 @@ void alxSourcef(AUDIOHANDLE handle, ALenum pname, ALfloat value)
 //          if(val == AL_TRUE)
 // #endif
          {
-            F32 vol = mClampF(mSourceVolume[idx] * mAudioTypeVolume[mType[idx]] * mMasterVolume, 0.f, 1.f);
-            alSourcef(source, AL_GAIN, Audio::linearToDB(vol) );
+            alSourcef(source, AL_GAIN, Audio::linearToDB(alxSourceGain(idx)) );
          }
       }
       else
+      {
          alSourcef(source, pname, value);
+
+         // keep the values the scores are computed from
+         if(pname == AL_REFERENCE_DISTANCE || pname == AL_MAX_DISTANCE)
+         {
+            U32 idx = alxFindIndex(handle);
+            if(idx != MAX_AUDIOSOURCES)
+               (pname == AL_REFERENCE_DISTANCE ? mSourceMinDistance : mSourceMaxDistance)[idx] = value;
+         }
+      }
    }
    alxLoopSourcef(handle, pname, value);
    alxStreamSourcef(handle, pname, value);
@@ -1387,7 +1527,11 @@ void alxSourcefv(AUDIOHANDLE handle, ALenum pname, ALfloat *values)
 {
    ALuint source = alxFindSource(handle);
    if(source != INVALID_SOURCE)
+   {
       alSourcefv(source, pname, values);
+      if(pname == AL_POSITION)
+         alxMoveVoice(handle, Point3F(values[0], values[1], values[2]));
+   }
 
    if((pname == AL_POSITION) || (pname == AL_DIRECTION) || (pname == AL_VELOCITY)) {
       alxLoopSource3f(handle, pname, values[0], values[1], values[2]);
@@ -1405,6 +1549,8 @@ void alxSource3f(AUDIOHANDLE handle, ALenum pname, ALfloat value1, ALfloat value
       values[1] = value2;
       values[2] = value3;
       alSourcefv(source, pname, values);
+      if(pname == AL_POSITION)
+         alxMoveVoice(handle, Point3F(value1, value2, value3));
    }
    alxLoopSource3f(handle, pname, value1, value2, value3);
    alxStreamSource3f(handle, pname, value1, value2, value3);
@@ -1414,7 +1560,24 @@ void alxSourcei(AUDIOHANDLE handle, ALenum pname, ALint value)
 {
    ALuint source = alxFindSource(handle);
    if(source != INVALID_SOURCE)
+   {
       alSourcei(source, pname, value);
+
+#ifdef REL_WORKAROUND
+      if(pname == AL_SOURCE_ABSOLUTE)
+#else
+      if(pname == AL_SOURCE_RELATIVE)
+#endif
+      {
+         U32 idx = alxFindIndex(handle);
+         if(idx != MAX_AUDIOSOURCES)
+#ifdef REL_WORKAROUND
+            mSource3D[idx] = (value == AL_TRUE);
+#else
+            mSource3D[idx] = (value == AL_FALSE);
+#endif
+      }
+   }
    alxLoopSourcei(handle, pname, value);
    alxStreamSourcei(handle, pname, value);
 }
@@ -1435,6 +1598,7 @@ void alxSourceMatrixF(AUDIOHANDLE handle, const MatrixF *transform)
       // OpenAL uses a Right-Handed corrdinate system so flip the orientation vector
       alSource3f(source, AL_POSITION, pos.x, pos.y, pos.z);
       alSource3f(source, AL_DIRECTION, -dir.x, -dir.y, -dir.z);
+      alxMoveVoice(handle, pos);
    }
 
    alxLoopSource3f(handle, AL_POSITION, pos.x, pos.y, pos.z);
@@ -1679,38 +1843,44 @@ void alxLoopingUpdate()
          return;
 
       U32 index = MAX_AUDIOSOURCES;
+      U32 pendingSources = countFadingOutSources();
 
       if(culledList.size() > 1)
          culledList.sort();
 
       for(itr = culledList.begin(); itr != culledList.end(); itr++)
       {
-         if(!findFreeSource(&index))
+          // check buffer
+         if(!bool((*itr)->mBuffer))
          {
-            // score does not include master volume
-            if(!cullSource(&index, (*itr)->mScore))
-               break;
+            // remove from culled list
+            LoopingList::iterator tmp;
+            tmp = mLoopingCulledList.findImage((*itr)->mHandle);
+            AssertFatal(tmp, "alxLoopingUpdate: failed to find culled source");
+            mLoopingCulledList.erase_fast(tmp);
 
-             // check buffer
-            if(!bool((*itr)->mBuffer))
+            // remove from looping list (and free)
+            tmp = mLoopingList.findImage((*itr)->mHandle);
+            if(tmp)
             {
-               // remove from culled list
-               LoopingList::iterator tmp;
-               tmp = mLoopingCulledList.findImage((*itr)->mHandle);
-               AssertFatal(tmp, "alxLoopingUpdate: failed to find culled source");
-               mLoopingCulledList.erase_fast(tmp);
-
-               // remove from looping list (and free)
-               tmp = mLoopingList.findImage((*itr)->mHandle);
-               if(tmp)
-               {
-                  (*tmp)->clear();
-                  mLoopingFreeList.push_back(*tmp);
-                  mLoopingList.erase_fast(tmp);
-               }
-
-               continue;
+               (*tmp)->clear();
+               mLoopingFreeList.push_back(*tmp);
+               mLoopingList.erase_fast(tmp);
             }
+
+            continue;
+         }
+
+         if(!findFreeSource(&index))
+         {
+            // wait for a source that's already fading out, or fade one
+            // out (score does not include master volume); the looper
+            // comes in when it's free
+            if(pendingSources)
+               pendingSources--;
+            else if(!fadeOutSource((*itr)->mScore))
+               break;
+            continue;
          }
 
          // remove from culled list
@@ -1732,6 +1902,8 @@ void alxLoopingUpdate()
          alGetError();
 
          alxSourcePlay(source, *itr);
+         alxSetVoice(index, &(*itr)->mDescription, (*itr)->mDescription.mIs3D ? &(*itr)->mPosition : NULL);
+         alxFadeInVoice(index);
          if(mEnvironmentEnabled)
             alxSourceEnvironment(source, *itr);
 
@@ -1781,6 +1953,7 @@ void alxStreamingUpdate()
          return;
 
       U32 index = MAX_AUDIOSOURCES;
+      U32 pendingSources = countFadingOutSources();
 
       if(culledList.size() > 1)
          culledList.sort();
@@ -1789,45 +1962,34 @@ void alxStreamingUpdate()
       {
          if(!findFreeSource(&index))
          {
-            // score does not include master volume
-            if(!cullSource(&index, (*itr)->mScore))
+            // wait for a source that's already fading out, or fade one
+            // out (score does not include master volume); the streamer
+            // comes in when it's free
+            if(pendingSources)
+               pendingSources--;
+            else if(!fadeOutSource((*itr)->mScore))
                break;
-
-             // check buffer
-            //if(!bool((*itr)->mBuffer))
-            //{
-               // remove from culled list
-               StreamingList::iterator tmp;
-               tmp = mStreamingCulledList.findImage((*itr)->mHandle);
-               AssertFatal(tmp, "alxStreamingUpdate: failed to find culled source");
-               mStreamingCulledList.erase_fast(tmp);
-
-               // remove from streaming list (and free)
-               tmp = mStreamingList.findImage((*itr)->mHandle);
-               if(tmp)
-               {
-                  delete(*tmp);
-                  mStreamingList.erase_fast(tmp);
-               }
-
-               continue;
-            //}
+            continue;
          }
 
          // remove from culled list
          StreamingList::iterator tmp = mStreamingCulledList.findImage((*itr)->mHandle);
          AssertFatal(tmp, "alxStreamingUpdate: failed to find culled source");
          mStreamingCulledList.erase_fast(tmp);
+
+         // the stream queues its buffers on its new source
+         ALuint source = mSource[index];
+         (*itr)->mSource = source;
          alxSourcePlay(*itr);
+
          // restore all state data
          mHandle[index] = (*itr)->mHandle;
          mScore[index] = (*itr)->mScore;
          mSourceVolume[index] = (*itr)->mDescription.mVolume;
          mType[index] = (*itr)->mDescription.mType;
          mSampleEnvironment[index] = (*itr)->mEnvironment;
-
-         ALuint source = mSource[index];
-		 (*itr)->mSource = mSource[index];
+         alxSetVoice(index, &(*itr)->mDescription, (*itr)->mDescription.mIs3D ? &(*itr)->mPosition : NULL);
+         alxFadeInVoice(index);
 
          // setup play info
          alGetError();
@@ -1913,35 +2075,7 @@ void alxUpdateScores(bool sourcesOnly)
 
       // grab the volume.. (not attenuated by master for score)
       F32 volume = mSourceVolume[i] * mAudioTypeVolume[mType[i]];
-
-      // 3d?
-      mScore[i] = volume;
-#ifdef REL_WORKAROUND
-      ALint val = AL_FALSE;
-      alGetSourcei(mSource[i], AL_SOURCE_ABSOLUTE, &val);
-      if(val == AL_TRUE)
-#else
-      ALint val = AL_FALSE;
-      alGetSourcei(mSource[i], AL_SOURCE_RELATIVE, &val);
-      if(val == AL_FALSE)
-#endif
-      {
-         // approximate 3d volume
-         Point3F pos;
-         alGetSourcefv(mSource[i], AL_POSITION, (ALfloat*)((F32*)pos) );
-
-         ALfloat min=0, max=1;
-         alGetSourcef(mSource[i], AL_REFERENCE_DISTANCE, &min);
-         alGetSourcef(mSource[i], AL_MAX_DISTANCE, &max);
-
-         pos -= listener;
-         F32 dist = pos.magnitudeSafe();
-
-         if(dist >= max)
-            mScore[i] = 0.f;
-         else if(dist > min)
-            mScore[i] *= (max-dist) / (max-min);
-      }
+      mScore[i] = computeScore(volume, mSource3D[i], mSourcePosition[i], mSourceMinDistance[i], mSourceMaxDistance[i], listener);
    }
 
    if(sourcesOnly)
@@ -1958,23 +2092,10 @@ void alxUpdateScores(bool sourcesOnly)
       if((updateTime - (*itr)->mCullTime) < MIN_UNCULL_PERIOD)
          continue;
 
-      (*itr)->mScore = (*itr)->mDescription.mVolume;
-      if((*itr)->mDescription.mIs3D)
-      {
-         Point3F pos = (*itr)->mPosition - listener;
-         F32 dist = pos.magnitudeSafe();
-
-         F32 min = (*itr)->mDescription.mReferenceDistance;
-         F32 max = (*itr)->mDescription.mMaxDistance;
-
-         if(dist >= max)
-            (*itr)->mScore = 0.f;
-         else if(dist > min)
-            (*itr)->mScore *= (max-dist) / (max-min);
-      }
-
-      // attenuate by the channel gain
-      (*itr)->mScore *= mAudioTypeVolume[(*itr)->mDescription.mType];
+      // attenuated by the channel gain
+      const Audio::Description &desc = (*itr)->mDescription;
+      (*itr)->mScore = computeScore(desc.mVolume * mAudioTypeVolume[desc.mType], desc.mIs3D, (*itr)->mPosition,
+                                    desc.mReferenceDistance, desc.mMaxDistance, listener);
    }
 
    // update the streamers
@@ -1986,23 +2107,10 @@ void alxUpdateScores(bool sourcesOnly)
       if((updateTime - (*itr)->mCullTime) < MIN_UNCULL_PERIOD)
          continue;
 
-      (*itr)->mScore = (*itr)->mDescription.mVolume;
-      if((*itr)->mDescription.mIs3D)
-      {
-         Point3F pos = (*itr)->mPosition - listener;
-         F32 dist = pos.magnitudeSafe();
-
-         F32 min = (*itr)->mDescription.mReferenceDistance;
-         F32 max = (*itr)->mDescription.mMaxDistance;
-
-         if(dist >= max)
-            (*itr)->mScore = 0.f;
-         else if(dist > min)
-            (*itr)->mScore *= (max-dist) / (max-min);
-      }
-
-      // attenuate by the channel gain
-      (*itr)->mScore *= mAudioTypeVolume[(*itr)->mDescription.mType];
+      // attenuated by the channel gain
+      const Audio::Description &desc = (*itr)->mDescription;
+      (*itr)->mScore = computeScore(desc.mVolume * mAudioTypeVolume[desc.mType], desc.mIs3D, (*itr)->mPosition,
+                                    desc.mReferenceDistance, desc.mMaxDistance, listener);
    }
 }
 
@@ -2015,32 +2123,53 @@ void alxUpdateMaxDistance()
 
    for(U32 i = 0; i < mNumSources; i++)
    {
-      if(mHandle[i] == NULL_AUDIOHANDLE)
+      if(mHandle[i] == NULL_AUDIOHANDLE || !mSource3D[i])
          continue;
 
-#ifdef REL_WORKAROUND
-      ALint val = AL_FALSE;
-      alGetSourcei(mSource[i], AL_SOURCE_ABSOLUTE, &val);
-      if(val == AL_FALSE)
-#else
-      ALint val = AL_FALSE;
-      alGetSourcei(mSource[i], AL_SOURCE_RELATIVE, &val);
-      if(val == AL_TRUE)
-#endif
-         continue;
+      F32 dist = mSourceMaxDistance[i] - (mSourcePosition[i] - listener).len();
 
-      Point3F pos;
-      alGetSourcefv(mSource[i], AL_POSITION, (F32*)pos);
+      F32 gain = (dist < 0.f) ? 0.f : alxSourceGain(i);
+      alSourcef(mSource[i], AL_GAIN, Audio::linearToDB(gain));
 
-      F32 dist = 0.f;
-      alGetSourcef(mSource[i], AL_MAX_DISTANCE, &dist);
+   }
+}
 
-      pos -= listener;
-      dist -= pos.len();
+// step the voice fades, and cull the voices that have faded out.  3d
+// sources get their faded gain from alxUpdateMaxDistance().
+void alxUpdateFades()
+{
+   static U32 lastTime = Platform::getRealMilliseconds();
+   U32 time = Platform::getRealMilliseconds();
+   F32 elapsed = F32(time - lastTime);
+   lastTime = time;
 
-      F32 gain = (dist < 0.f) ? 0.f : mSourceVolume[i] * mAudioTypeVolume[mType[i]] * mMasterVolume;
-      alSourcef(mSource[i], AL_GAIN, Audio::linearToDB(gain));
+   for(U32 i = 0; i < mNumSources; i++)
+   {
+      if(mFadeRate[i] == 0.f)
+         continue;
+
+      if(mHandle[i] == NULL_AUDIOHANDLE)
+      {
+         mFadeRate[i] = 0.f;
+         continue;
+      }
+
+      mFadeGain[i] += mFadeRate[i] * elapsed;
+      if(mFadeGain[i] >= 1.f)
+      {
+         mFadeGain[i] = 1.f;
+         mFadeRate[i] = 0.f;
+      }
+      else if(mFadeGain[i] <= 0.f)
+      {
+         // faded out: the looper/streamer waiting for a source takes it
+         mFadeGain[i] = 0.f;
+         cullVoice(i);
+         continue;
+      }
 
+      if(!mSource3D[i])
+         alSourcef(mSource[i], AL_GAIN, Audio::linearToDB(alxSourceGain(i)));
    }
 }
 
@@ -2049,6 +2178,8 @@ void alxUpdateMaxDistance()
 //--------------------------------------------------------------------------
 void alxUpdate()
 {
+   alxUpdateFades();
+
    //if(mForceMaxDistanceUpdate)
       alxUpdateMaxDistance();
 
@@ -2335,6 +2466,7 @@ bool prepareContext()
 
    // invalidate all existing handles
    dMemset(mHandle, NULL_AUDIOHANDLE, sizeof(mHandle));
+   alxResetVoices();
 
    // pre-load profile data
    SimGroup* grp = Sim::getDataBlockGroup();
@@ -2432,6 +2564,7 @@ bool OpenALInit()
 
    // invalidate all existing handles
    dMemset(mHandle, NULL_AUDIOHANDLE, sizeof(mHandle));
+   alxResetVoices();
 
    // default all channels to full gain
    for(U32 i = 0; i < Audio::NumAudioTypes; i++)
@@ -2445,6 +2578,8 @@ bool OpenALInit()
    alDistanceModel(AL_INVERSE_DISTANCE);
    alListenerf(AL_GAIN_LINEAR, 1.f);
 
+   AudioStreamThread::startThread();
+
    return true;
 }
 
@@ -2452,6 +2587,7 @@ bool OpenALInit()
 void OpenALShutdown()
 {
    alxStopAll();
+   AudioStreamThread::stopThread();
 
    //if(mInitialized)
    {
@@ -8,6 +8,9 @@
 #include "core/stream.h"
 #include "console/console.h"
 #include "core/frameAllocator.h"
+#include "core/memstream.h"
+#include "core/resManager.h"
+#include "console/consoleTypes.h"
 
 #ifndef TORQUE_NO_OGGVORBIS
 #include "vorbis/codec.h"
@@ -76,14 +79,30 @@ struct WAVChunkHdr
 
 
 
+AudioBuffer * AudioBuffer::smResidentHead = NULL;
+AudioBuffer * AudioBuffer::smResidentTail = NULL;
+S32           AudioBuffer::smResidentBytes = 0;
+S32           AudioBuffer::smCacheSize = 64 << 20;
+S32           AudioBuffer::smCompressedThreshold = 2 << 20;
+
 //--------------------------------------
 AudioBuffer::AudioBuffer(StringTableEntry filename)
 {
-   AssertFatal(StringTable->lookup(filename), "AudioBuffer:: filename is not a string table entry");
+   AssertFatal(!filename || StringTable->lookup(filename), "AudioBuffer:: filename is not a string table entry");
 
    mFilename = filename;
    mLoading = false;
    malBuffer = 0;
+
+   mFormat = AL_FORMAT_MONO16;
+   mFreq = 22050;
+   mPCM = NULL;
+   mPCMSize = 0;
+   mCompressed = NULL;
+   mCompressedSize = 0;
+   mResidentSize = 0;
+   mPrevResident = NULL;
+   mNextResident = NULL;
 }
 
 AudioBuffer::~AudioBuffer()
@@ -91,9 +110,39 @@ AudioBuffer::~AudioBuffer()
    if( malBuffer != 0 ) {
       alDeleteBuffers( 1, &malBuffer );
    }
+   if(mResidentSize)
+      unlinkResident();
+   freePCM();
+   delete [] mCompressed;
+}
+
+void AudioBuffer::consoleInit()
+{
+   Con::addVariable("$pref::Audio::bufferCacheSize", TypeS32, &smCacheSize);
+   Con::addVariable("$pref::Audio::compressedThreshold", TypeS32, &smCompressedThreshold);
+   Con::addVariable("$Stats::audioBufferBytes", TypeS32, &smResidentBytes);
 }
 
 //--------------------------------------
+const char *AudioBuffer::getSoundFile(const char *filename, char *buffer, U32 bufferSize)
+{
+   if(ResourceManager->find(filename))
+      return filename;
+
+   // wav file doesn't exist, try ogg file instead
+   S32 len = dStrlen(filename);
+   if (len>3 && !dStricmp(filename+len-4,".wav") && U32(len) < bufferSize)
+   {
+      dStrcpy(buffer,filename);
+      buffer[len-3] = 'o';
+      buffer[len-2] = 'g';
+      buffer[len-1] = 'g';
+      if(ResourceManager->find(buffer))
+         return buffer;
+   }
+   return NULL;
+}
+
 Resource<AudioBuffer> AudioBuffer::find(const char *filename)
 {
    U32 mark = FrameAllocator::getWaterMark();
@@ -137,9 +186,106 @@ Resource<AudioBuffer> AudioBuffer::find(const char *filename)
    return buffer;
 }
 
-ResourceInstance* AudioBuffer::construct(Stream &)
+ResourceInstance* AudioBuffer::construct(Stream &stream)
 {
-   return NULL;
+   AudioBuffer *buffer = new AudioBuffer(NULL);
+   if(!buffer->decode(stream, true))
+   {
+      delete buffer;
+      return NULL;
+   }
+   return buffer;
+}
+
+//-----------------------------------------------------------------
+bool AudioBuffer::decode(Stream &stream, bool allowCompressed)
+{
+   U32 start = stream.getPosition();
+   char id[4];
+   if(!stream.read(4, id) || !stream.setPosition(start))
+      return false;
+
+   if(!dStrncmp(id, "RIFF", 4))
+      return readWAV(stream);
+#ifndef TORQUE_NO_OGGVORBIS
+   if(!dStrncmp(id, "OggS", 4))
+      return readOgg(stream, allowCompressed);
+#endif
+   return false;
+}
+
+void AudioBuffer::freePCM()
+{
+   delete [] mPCM;
+   mPCM = NULL;
+   mPCMSize = 0;
+}
+
+bool AudioBuffer::upload()
+{
+   alBufferData(malBuffer, mFormat, mPCM, mPCMSize, mFreq);
+   U32 size = mPCMSize;
+   freePCM();
+   if(alGetError() != AL_NO_ERROR)
+      return false;
+
+   mResidentSize = size;
+   linkResident();
+   return true;
+}
+
+//-----------------------------------------------------------------
+void AudioBuffer::linkResident()
+{
+   mPrevResident = NULL;
+   mNextResident = smResidentHead;
+   if(smResidentHead)
+      smResidentHead->mPrevResident = this;
+   else
+      smResidentTail = this;
+   smResidentHead = this;
+   smResidentBytes += mResidentSize;
+}
+
+void AudioBuffer::unlinkResident()
+{
+   if(mPrevResident)
+      mPrevResident->mNextResident = mNextResident;
+   else
+      smResidentHead = mNextResident;
+   if(mNextResident)
+      mNextResident->mPrevResident = mPrevResident;
+   else
+      smResidentTail = mPrevResident;
+   mPrevResident = mNextResident = NULL;
+   smResidentBytes -= mResidentSize;
+   mResidentSize = 0;
+}
+
+bool AudioBuffer::releaseALBuffer()
+{
+   // OpenAL refuses to delete a buffer a source is using
+   alGetError();
+   alDeleteBuffers(1, &malBuffer);
+   if(alGetError() != AL_NO_ERROR)
+      return false;
+
+   malBuffer = 0;
+   unlinkResident();
+   return true;
+}
+
+void AudioBuffer::enforceCacheSize()
+{
+   AudioBuffer *buffer = smResidentTail;
+   while(buffer && smResidentBytes > smCacheSize)
+   {
+      // never the one just uploaded, which is at the head
+      AudioBuffer *prev = buffer->mPrevResident;
+      if(prev)
+         buffer->releaseALBuffer();
+      buffer = prev;
+   }
 }
 
 //-----------------------------------------------------------------
@@ -154,49 +300,73 @@ ALuint AudioBuffer::getALBuffer()
    // Intangir> fix for newest openAL from creative (it returns true, yea right 0 is not a valid buffer)
    // it MIGHT not work at all for all i know.
    if (malBuffer && alIsBuffer(malBuffer))
+   {
+      // most recently used
+      if(mResidentSize && mPrevResident)
+      {
+         U32 size = mResidentSize;
+         unlinkResident();
+         mResidentSize = size;
+         linkResident();
+      }
       return malBuffer;
+   }
+
+   // the buffer went with an old context
+   if(mResidentSize)
+      unlinkResident();
 
    alGenBuffers(1, &malBuffer);
    if(alGetError() != AL_NO_ERROR)
       return 0;
 
-   ResourceObject * obj = ResourceManager->find(mFilename);
-   if(obj)
+   // Decoded by the resource manager or kept compressed; otherwise evicted
+   // (or added empty by find()), so read the file again.
+   bool readSuccess = mPCM != NULL;
+   if(!readSuccess && mCompressed)
    {
-      bool readSuccess = false;
-      S32 len = dStrlen(mFilename);
-
-      if(len > 3 && !dStricmp(mFilename + len - 4, ".wav"))
+      MemStream stream(mCompressedSize, mCompressed, true, false);
+      readSuccess = decode(stream, false);
+   }
+   else if(!readSuccess)
+   {
+      Stream *stream = mSourceResource ? ResourceManager->openStream(mSourceResource) :
+                       mFilename ? ResourceManager->openStream(mFilename) : NULL;
+      if(stream)
       {
 #ifdef LOG_SOUND_LOADS
-         Con::printf("Reading WAV: %s\n", mFilename);
+         Con::printf("Reading sound: %s\n", mFilename ? mFilename : mSourceResource->name);
 #endif
-         readSuccess = readWAV(obj);
+         // now that it's been played, keep a large one compressed
+         readSuccess = decode(*stream, true);
+         ResourceManager->closeStream(stream);
       }
-#ifndef TORQUE_NO_OGGVORBIS
-      else if(len > 3 && !dStricmp(mFilename + len - 4, ".ogg"))
+
+      if(readSuccess && mCompressed)
       {
-#  ifdef LOG_SOUND_LOADS
-         Con::printf("Reading Ogg: %s\n", mFilename);
-#  endif
-         readSuccess = readOgg(obj);
+         MemStream memStream(mCompressedSize, mCompressed, true, false);
+         readSuccess = decode(memStream, false);
       }
-#endif
-      if(readSuccess)
-         return(malBuffer);
    }
 
+   if(readSuccess && upload())
+   {
+      enforceCacheSize();
+      return(malBuffer);
+   }
+
+   freePCM();
    alDeleteBuffers(1, &malBuffer);
    malBuffer = NULL;
 
    return 0;
 }
 
-/*!   The Read a WAV file from the given ResourceObject and initialize
-      an alBuffer with it.
+/*!   Read a WAV file from the given stream into mPCM.
 */
-bool AudioBuffer::readWAV(ResourceObject *obj)
+bool AudioBuffer::readWAV(Stream &strm)
 {
+   MemoryTagScope tagScope(Memory::TagAudio);
    WAVChunkHdr chunkHdr;
    WAVFmtExHdr fmtExHdr;
    WAVFileHdr  fileHdr;
@@ -209,9 +379,7 @@ bool AudioBuffer::readWAV(ResourceObject *obj)
    ALsizei freq   = 22050;
    ALboolean loop = AL_FALSE;
 
-   Stream *stream = ResourceManager->openStream(obj);
-   if (!stream)
-      return false;
+   Stream *stream = &strm;
 
    stream->read(4, &fileHdr.id[0]);
    stream->read(&fileHdr.size);
@@ -322,23 +490,27 @@ bool AudioBuffer::readWAV(ResourceObject *obj)
       chunkRemaining = chunkHdr.size + (chunkHdr.size&1);
    }
 
-   ResourceManager->closeStream(stream);
    if (data)
    {
-      alBufferData(malBuffer, format, data, size, freq);
-      delete [] data;
-      return (alGetError() == AL_NO_ERROR);
+      freePCM();
+      mPCM = (U8 *) data;
+      mPCMSize = size;
+      mFormat = format;
+      mFreq = freq;
+      return true;
    }
 
    return false;
 }
 
 #ifndef TORQUE_NO_OGGVORBIS
-/*!   The Read an Ogg Vorbis file from the given ResourceObject and initialize
-      an alBuffer with it.
+/*!   Read an Ogg Vorbis file from the given stream into mPCM or, if it
+      decodes to more than smCompressedThreshold and allowCompressed is set,
+      keep the file itself in mCompressed.
 */
-bool AudioBuffer::readOgg(ResourceObject *obj)
+bool AudioBuffer::readOgg(Stream &strm, bool allowCompressed)
 {
+   MemoryTagScope tagScope(Memory::TagAudio);
    OggVorbisFile vf;
    vorbis_info *vi;
 
@@ -357,9 +529,8 @@ bool AudioBuffer::readOgg(ResourceObject *obj)
 
    int eof = 0;
 
-   Stream *stream = ResourceManager->openStream(obj);
-   if (!stream)
-      return false;
+   Stream *stream = &strm;
+   U32 start = stream->getPosition();
 
    if(vf.ov_open(stream, NULL, 0) < 0) {
       return false;
@@ -379,6 +550,22 @@ bool AudioBuffer::readOgg(ResourceObject *obj)
       size = 4 * samples;
    }
 
+   if(allowCompressed && size > smCompressedThreshold)
+   {
+      vf.ov_clear();
+
+      U32 fileSize = stream->getStreamSize() - start;
+      U8 *file = new U8[fileSize];
+      if(!stream->setPosition(start) || !stream->read(fileSize, file))
+      {
+         delete [] file;
+         return false;
+      }
+      delete [] mCompressed;
+      mCompressed = file;
+      mCompressedSize = fileSize;
+      return true;
+   }
 
     data=new char[size];
 
@@ -390,12 +577,14 @@ bool AudioBuffer::readOgg(ResourceObject *obj)
   /* cleanup */
   vf.ov_clear();
 
-   ResourceManager->closeStream(stream);
    if (data)
    {
-      alBufferData(malBuffer, format, data, size, freq);
-      delete [] data;
-      return (alGetError() == AL_NO_ERROR);
+      freePCM();
+      mPCM = (U8 *) data;
+      mPCMSize = size;
+      mFormat = format;
+      mFreq = freq;
+      return true;
    }
 
    return false;
@@ -23,6 +23,19 @@
 
 //--------------------------------------------------------------------------
 
+/// A sound loaded into an OpenAL buffer.
+///
+/// The resource manager constructs these from .wav and .ogg files, which
+/// decodes them (on its loader thread for ResManager::loadAsync(), which
+/// is how AudioProfile preloads), and getALBuffer() uploads the samples to
+/// OpenAL on first use.  An Ogg that decodes to more than
+/// $pref::Audio::compressedThreshold bytes stays compressed in memory
+/// instead and is decoded each time it's uploaded.
+///
+/// The uploaded buffers are a cache of at most $pref::Audio::bufferCacheSize
+/// bytes: past that the least recently used ones that aren't playing give
+/// their OpenAL data back, and are decoded again, from memory or the file,
+/// when they're next played.
 class AudioBuffer: public ResourceInstance
 {
    friend class AudioThread;
@@ -32,20 +45,62 @@ private:
    bool              mLoading;
    ALuint            malBuffer;
 
+   ALenum            mFormat;
+   ALsizei           mFreq;
+   U8 *              mPCM;             ///< Decoded, waiting to be uploaded.
+   U32               mPCMSize;
+   U8 *              mCompressed;      ///< The whole Ogg file, for large sounds.
+   U32               mCompressedSize;
+   U32               mResidentSize;    ///< Bytes uploaded to malBuffer.
+
+   /// Buffers with data in OpenAL, most recently used first.
+   AudioBuffer *     mPrevResident;
+   AudioBuffer *     mNextResident;
+
+   static AudioBuffer * smResidentHead;
+   static AudioBuffer * smResidentTail;
+   static S32           smResidentBytes;
+
    bool readRIFFchunk(Stream &s, const char *seekLabel, U32 *size);
-   bool readWAV(ResourceObject *obj);
+   bool readWAV(Stream &stream);
 
 #ifndef TORQUE_NO_OGGVORBIS
-   bool readOgg(ResourceObject *obj);
+   bool readOgg(Stream &stream, bool allowCompressed);
    long oggRead(OggVorbisFile* vf, char *buffer,int length,
 		    int bigendianp,int *bitstream);
 #endif
 
+   /// Decodes a .wav or .ogg.  Doesn't touch OpenAL, so it's safe on the
+   /// loader thread.
+   bool decode(Stream &stream, bool allowCompressed);
+   /// Moves mPCM into malBuffer.
+   bool upload();
+   void freePCM();
+
+   void linkResident();
+   void unlinkResident();
+   /// Gives the OpenAL data back; fails if the buffer is playing.
+   bool releaseALBuffer();
+   static void enforceCacheSize();
+
 public:
+   static S32 smCacheSize;             ///< $pref::Audio::bufferCacheSize
+   static S32 smCompressedThreshold;   ///< $pref::Audio::compressedThreshold
+
    AudioBuffer(StringTableEntry filename);
    ~AudioBuffer();
    ALuint getALBuffer();
    bool isLoading() {return(mLoading);}
+   /// Kept as the Ogg file and only decoded when played.
+   bool isCompressed() const { return mCompressed != NULL; }
+
+   U32 getResourceSize() const { return sizeof(AudioBuffer) + mPCMSize + mCompressedSize; }
+
+   static void consoleInit();
+
+   /// The file find() would load for filename: the .wav, or the .ogg of the
+   /// same name if there is no .wav.  NULL if neither exists.
+   static const char *getSoundFile(const char *filename, char *buffer, U32 bufferSize);
 
    static Resource<AudioBuffer> find(const char *filename);
    static ResourceInstance* construct(Stream& stream);
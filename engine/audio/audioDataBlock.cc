@@ -423,7 +423,10 @@ bool AudioProfile::preload(bool server, char errorBuffer[256])
    if(!Parent::preload(server, errorBuffer))
       return false;
 
-   if(!server && NetConnection::filesWereDownloaded() && !bool(AudioBuffer::find(mFilename)))
+   // only check the file is there; onAdd() loads it in the background
+   char oggFile[256];
+   if(!server && NetConnection::filesWereDownloaded() && mFilename &&
+      !AudioBuffer::getSoundFile(mFilename, oggFile, sizeof(oggFile)))
       return false;
    return true;
 }
@@ -451,18 +454,37 @@ bool AudioProfile::onAdd()
       }
    }
 
+   // Decode on the loader thread while the mission loads, so the first
+   // play doesn't hitch; the upload is done once it comes back.
    if(mPreload && mFilename != NULL && alcGetCurrentContext())
    {
-      mBuffer = AudioBuffer::find(mFilename);
-      if(bool(mBuffer))
-      {
-         ALuint bufferId = mBuffer->getALBuffer();
-      }
+      char oggFile[256];
+      const char *file = AudioBuffer::getSoundFile(mFilename, oggFile, sizeof(oggFile));
+      if(file)
+         ResourceManager->loadAsync(file, bufferLoaded, (void *)(dsize_t) getId());
    }
 
    return(true);
 }
 
+void AudioProfile::bufferLoaded(ResourceObject *obj, void *userData)
+{
+   AudioProfile *profile = dynamic_cast<AudioProfile*>(Sim::findObject(SimObjectId((dsize_t) userData)));
+   if(!obj)
+      return;
+   if(!profile)
+   {
+      ResourceManager->unlock(obj);
+      return;
+   }
+
+   // the resource takes over the lock loadAsync() handed us; large sounds
+   // stay compressed until they're played
+   profile->mBuffer = obj;
+   if(alcGetCurrentContext() && !profile->mBuffer->isCompressed())
+      profile->mBuffer->getALBuffer();
+}
+
 //--------------------------------------------------------------------------
 void AudioProfile::packData(BitStream* stream)
 {
@@ -114,6 +114,9 @@ private:
 
    Resource<AudioBuffer> mBuffer;
 
+   /// Takes the preloaded buffer, or drops it if the profile is gone.
+   static void bufferLoaded(ResourceObject *obj, void *userData);
+
 public:
    // field info
    U32                     mDescriptionObjectID;
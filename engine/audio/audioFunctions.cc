@@ -128,6 +128,7 @@ ConsoleFunction(OpenALInitDriver, bool, 1, 1, "Initializes the OpenAL driver.\n\
       if (!registered) {
          ResourceManager->registerExtension(".wav", AudioBuffer::construct);
 		 ResourceManager->registerExtension(".ogg", AudioBuffer::construct);
+         AudioBuffer::consoleInit();
 	  }
       registered = true;
       return true;
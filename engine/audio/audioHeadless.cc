@@ -0,0 +1,54 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+// The headless build (TORQUE_HEADLESS) has no sound: of audio/ it keeps only
+// the datablocks, which the server sends to clients.  These take the place
+// of the alx calls the simulation code makes, so they link and play nothing.
+
+#include "audio/audio.h"
+#include "audio/audioBuffer.h"
+
+AUDIOHANDLE alxCreateSource(const Audio::Description *, const char *, const MatrixF *, AudioSampleEnvironment *)
+{
+   return NULL_AUDIOHANDLE;
+}
+
+AUDIOHANDLE alxCreateSource(AudioDescription *, const char *, const MatrixF *, AudioSampleEnvironment *)
+{
+   return NULL_AUDIOHANDLE;
+}
+
+AUDIOHANDLE alxCreateSource(const AudioProfile *, const MatrixF *)
+{
+   return NULL_AUDIOHANDLE;
+}
+
+AudioStreamSource *alxFindAudioStreamSource(AUDIOHANDLE) { return NULL; }
+ALuint alxFindSource(AUDIOHANDLE) { return 0; }
+ALuint alxGetWaveLen(ALuint) { return 0; }
+
+AUDIOHANDLE alxPlay(AUDIOHANDLE) { return NULL_AUDIOHANDLE; }
+AUDIOHANDLE alxPlay(const AudioProfile *, const MatrixF *, const Point3F *) { return NULL_AUDIOHANDLE; }
+void alxStop(AUDIOHANDLE) {}
+bool alxIsPlaying(AUDIOHANDLE) { return false; }
+
+void alxSourcef(AUDIOHANDLE, ALenum, ALfloat) {}
+void alxSource3f(AUDIOHANDLE, ALenum, ALfloat, ALfloat, ALfloat) {}
+void alxSourcei(AUDIOHANDLE, ALenum, ALint) {}
+void alxSourceMatrixF(AUDIOHANDLE, const MatrixF *) {}
+void alxGetSourcei(AUDIOHANDLE, ALenum, ALint *value) { *value = 0; }
+
+void alxListenerMatrixF(const MatrixF *) {}
+void alxSetEnvironment(const AudioEnvironment *) {}
+const AudioEnvironment *alxGetEnvironment() { return NULL; }
+void alxUpdate() {}
+
+//--------------------------------------------------------------------------
+
+ALuint AudioBuffer::getALBuffer() { return 0; }
+
+const char *AudioBuffer::getSoundFile(const char *, char *, U32) { return NULL; }
+
+Resource<AudioBuffer> AudioBuffer::find(const char *) { return Resource<AudioBuffer>(); }
@@ -0,0 +1,237 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "audio/audioStreamSource.h"
+#include "audio/audioStreamThread.h"
+#include "platform/profiler.h"
+
+DecodedStreamSource::DecodedStreamSource(const char *filename)
+{
+   mHandle     = NULL_AUDIOHANDLE;
+   mSource     = NULL;
+
+   dMemset(&mDescription, 0, sizeof(Audio::Description));
+   mEnvironment = 0;
+   mPosition.set(0.f,0.f,0.f);
+   mDirection.set(0.f,1.f,0.f);
+   mPitch = 1.f;
+   mScore = 0.f;
+   mCullTime = 0;
+
+   bFinishedPlaying = false;
+   bIsValid = false;
+   mFilename = filename;
+
+   mFormat = AL_FORMAT_MONO16;
+   mFreq = 0;
+   for(U32 i = 0; i < NUMBUFFERS; i++)
+      mBufferList[i] = 0;
+   mNumFreeBuffers = 0;
+   mNumQueuedBuffers = 0;
+   mRing = NULL;
+
+   bBuffersAllocated = false;
+   bDecoderOpen = false;
+   bThreaded = false;
+   bDecodeFinished = false;
+   bFinished = false;
+   mElapsedTime = 0.f;
+}
+
+DecodedStreamSource::~DecodedStreamSource()
+{
+   AssertFatal(!bDecoderOpen, "DecodedStreamSource: subclass must call freeStream() in its destructor.");
+}
+
+//--------------------------------------------------------------------------
+
+bool DecodedStreamSource::initStream()
+{
+   alSourceStop(mSource);
+   alSourcei(mSource, AL_BUFFER, 0);
+
+   bFinished = false;
+   bDecodeFinished = false;
+   mElapsedTime = 0.f;
+
+   if(!openDecoder())
+      return false;
+   bDecoderOpen = true;
+
+   // Clear Error Code
+   alGetError();
+
+   alGenBuffers(NUMBUFFERS, mBufferList);
+   if (alGetError() != AL_NO_ERROR)
+      return false;
+
+   bBuffersAllocated = true;
+   for(U32 i = 0; i < NUMBUFFERS; i++)
+      mFreeBuffers[i] = mBufferList[NUMBUFFERS - 1 - i];
+   mNumFreeBuffers = NUMBUFFERS;
+   mNumQueuedBuffers = 0;
+
+   // Fill the queue here, so the sound starts when it's played rather
+   // than when the stream thread first gets to it.
+   mRing = new AudioStreamRing;
+   decodeAhead();
+   if(!queueDecodedBuffers())
+      return false;
+
+   alSourcei(mSource, AL_LOOPING, AL_FALSE);
+
+   bIsValid = true;
+   bThreaded = AudioStreamThread::addSource(this);
+
+   return true;
+}
+
+void DecodedStreamSource::freeStream()
+{
+   if(bThreaded)
+   {
+      AudioStreamThread::removeSource(this);
+      bThreaded = false;
+   }
+   bIsValid = false;
+
+   if(bBuffersAllocated)
+   {
+      // the buffers can't be deleted while they're queued
+      alSourceStop(mSource);
+      alSourcei(mSource, AL_BUFFER, 0);
+      alDeleteBuffers(NUMBUFFERS, mBufferList);
+      alGetError();
+
+      for(U32 i = 0; i < NUMBUFFERS; i++)
+         mBufferList[i] = 0;
+      mNumFreeBuffers = 0;
+      mNumQueuedBuffers = 0;
+      bBuffersAllocated = false;
+   }
+
+   delete mRing;
+   mRing = NULL;
+
+   if(bDecoderOpen)
+   {
+      closeDecoder();
+      bDecoderOpen = false;
+   }
+}
+
+//--------------------------------------------------------------------------
+
+void DecodedStreamSource::decodeAhead()
+{
+   if(bDecodeFinished)
+      return;
+
+   PROFILE_START(DecodedStreamSource_decodeAhead);
+   bool rewound = false;
+   while(U8 *buffer = mRing->getWriteBuffer())
+   {
+      U32 size = decode(buffer, AudioStreamRing::ChunkSize);
+      if(size)
+      {
+         mRing->commit(size, getDecodeTime(), false);
+         rewound = false;
+         continue;
+      }
+
+      // A stream that's still empty straight after rewinding would loop
+      // forever, so that ends it too.
+      if(mDescription.mIsLooping && !rewound && rewind())
+      {
+         rewound = true;
+         continue;
+      }
+
+      mRing->commit(0, getDecodeTime(), true);
+      bDecodeFinished = true;
+      break;
+   }
+   PROFILE_END();
+}
+
+bool DecodedStreamSource::queueDecodedBuffers()
+{
+   while(mNumFreeBuffers && !bFinished)
+   {
+      const U8 *data;
+      const AudioStreamRing::Chunk *chunk = mRing->peek(data);
+      if(!chunk)
+         break;
+
+      if(chunk->endOfStream)
+      {
+         bFinished = true;
+         mRing->pop();
+         break;
+      }
+
+      ALuint bufferID = mFreeBuffers[--mNumFreeBuffers];
+      alBufferData(bufferID, mFormat, data, chunk->size, mFreq);
+      mElapsedTime = chunk->time;
+      mRing->pop();
+      if (alGetError() != AL_NO_ERROR)
+         return false;
+
+      alSourceQueueBuffers(mSource, 1, &bufferID);
+      if (alGetError() != AL_NO_ERROR)
+         return false;
+      mNumQueuedBuffers++;
+   }
+   return true;
+}
+
+bool DecodedStreamSource::updateBuffers()
+{
+   // don't do anything if stream not loaded properly
+   if(!bIsValid)
+      return false;
+
+   if(!bThreaded)
+      decodeAhead();
+
+   // reset AL error code
+   alGetError();
+
+   // Take back the buffers that have been played...
+   ALint processed;
+   alGetSourcei(mSource, AL_BUFFERS_PROCESSED, &processed);
+   while(processed-- > 0)
+   {
+      ALuint bufferID;
+      alSourceUnqueueBuffers(mSource, 1, &bufferID);
+      if (alGetError() != AL_NO_ERROR)
+         return false;
+      mFreeBuffers[mNumFreeBuffers++] = bufferID;
+      mNumQueuedBuffers--;
+   }
+
+   // ...and refill them with whatever has been decoded since.
+   if(!queueDecodedBuffers())
+      return false;
+
+   if(bFinished && mNumQueuedBuffers == 0)
+   {
+      bFinishedPlaying = true;
+      return false;
+   }
+
+#ifdef TORQUE_OS_LINUX
+   checkPosition();
+#endif
+
+   // If the queue ran dry before the decoder caught up, the source
+   // stopped; start it again on what's queued now.
+   ALint state;
+   alGetSourcei(mSource, AL_SOURCE_STATE, &state);
+   if (state == AL_STOPPED && mNumQueuedBuffers)
+      alSourcePlay(mSource);
+
+   return true;
+}
@@ -26,6 +26,8 @@
 
 #define NUMBUFFERS 16
 
+class AudioStreamRing;
+
 class AudioStreamSource
 {
 	public:
@@ -61,4 +63,60 @@ class AudioStreamSource
 		const char* mFilename;
 };
 
+/// A stream source decoded to PCM ahead of playback on the AudioStreamThread.
+///
+/// Subclasses only decode: openDecoder() and closeDecoder() run on the main
+/// thread, and decode(), rewind() and getDecodeTime() on the stream thread
+/// between them.  This class owns the OpenAL buffers; updateBuffers() moves
+/// decoded chunks from the ring into the buffers OpenAL has finished with,
+/// restarts the source if it ran dry and reports when the last queued
+/// buffer has played.  Looping rewinds on the stream thread, so the loop
+/// point doesn't wait for the main thread either.
+class DecodedStreamSource : public AudioStreamSource
+{
+	public:
+		DecodedStreamSource(const char *filename);
+		virtual ~DecodedStreamSource();
+
+		virtual bool initStream();
+		virtual bool updateBuffers();
+		virtual void freeStream();
+      virtual F32 getElapsedTime() { return mElapsedTime; }
+
+      /// Decodes until the ring is full or the stream ends.  Called on the
+      /// stream thread, or from updateBuffers() when it isn't running.
+      void decodeAhead();
+
+	protected:
+      /// Opens mFilename and sets mFormat and mFreq.
+      virtual bool openDecoder() = 0;
+      virtual void closeDecoder() = 0;
+      /// Decodes up to size bytes; returns 0 at the end of the stream.
+      virtual U32 decode(U8 *buffer, U32 size) = 0;
+      /// Goes back to the start for looping.
+      virtual bool rewind() = 0;
+      /// The stream time after the last decode(), for getElapsedTime().
+      virtual F32 getDecodeTime() { return 0.f; }
+
+      ALenum   mFormat;
+      ALsizei  mFreq;
+
+	private:
+      ALuint   mBufferList[NUMBUFFERS];
+      ALuint   mFreeBuffers[NUMBUFFERS];  ///< Not queued on the source.
+      U32      mNumFreeBuffers;
+      U32      mNumQueuedBuffers;
+
+      AudioStreamRing *mRing;
+
+      bool     bBuffersAllocated;
+      bool     bDecoderOpen;
+      bool     bThreaded;                 ///< Registered with the AudioStreamThread.
+      bool     bDecodeFinished;           ///< Stream thread side: end of stream committed.
+      bool     bFinished;                 ///< Main thread side: end of stream reached.
+      F32      mElapsedTime;
+
+      bool queueDecodedBuffers();
+};
+
 #endif // _AUDIOSTREAMSOURCE_H_
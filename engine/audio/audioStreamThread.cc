@@ -0,0 +1,89 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "audio/audioStreamThread.h"
+#include "audio/audioStreamSource.h"
+#include "platform/platformMutex.h"
+#include "platform/profiler.h"
+
+AudioStreamThread *          AudioStreamThread::smThread = NULL;
+void *                       AudioStreamThread::smMutex = NULL;
+Vector<DecodedStreamSource*> AudioStreamThread::smSources(__FILE__, __LINE__);
+
+AudioStreamThread::AudioStreamThread() : Thread(0, 0, false)
+{
+   mStopping = false;
+}
+
+void AudioStreamThread::run(S32)
+{
+   while(!mStopping)
+   {
+      Mutex::lockMutex(smMutex);
+      for(U32 i = 0; i < smSources.size(); i++)
+         smSources[i]->decodeAhead();
+      Mutex::unlockMutex(smMutex);
+
+      Platform::sleep(DecodeIntervalMs);
+   }
+}
+
+//--------------------------------------------------------------------------
+
+void AudioStreamThread::startThread()
+{
+#ifdef TORQUE_MULTITHREAD
+   if(smThread)
+      return;
+
+   AssertFatal(smSources.empty(), "AudioStreamThread::startThread: sources are already streaming.");
+   smMutex = Mutex::createMutex();
+   smThread = new AudioStreamThread;
+   smThread->start();
+#endif
+}
+
+void AudioStreamThread::stopThread()
+{
+   if(!smThread)
+      return;
+
+   AssertFatal(smSources.empty(), "AudioStreamThread::stopThread: sources are still streaming.");
+   smThread->mStopping = true;
+   smThread->join();
+   delete smThread;
+   smThread = NULL;
+
+   Mutex::destroyMutex(smMutex);
+   smMutex = NULL;
+}
+
+bool AudioStreamThread::addSource(DecodedStreamSource *source)
+{
+   if(!smThread)
+      return false;
+
+   Mutex::lockMutex(smMutex);
+   smSources.push_back(source);
+   Mutex::unlockMutex(smMutex);
+   return true;
+}
+
+void AudioStreamThread::removeSource(DecodedStreamSource *source)
+{
+   if(!smThread)
+      return;
+
+   PROFILE_START(AudioStreamThread_removeSource);
+   Mutex::lockMutex(smMutex);
+   for(U32 i = 0; i < smSources.size(); i++)
+      if(smSources[i] == source)
+      {
+         smSources.erase_fast(i);
+         break;
+      }
+   Mutex::unlockMutex(smMutex);
+   PROFILE_END();
+}
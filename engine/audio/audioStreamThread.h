@@ -0,0 +1,142 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _AUDIOSTREAMTHREAD_H_
+#define _AUDIOSTREAMTHREAD_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _PLATFORMATOMIC_H_
+#include "platform/platformAtomic.h"
+#endif
+#ifndef _PLATFORMTHREAD_H_
+#include "platform/platformThread.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+
+class DecodedStreamSource;
+
+/// Decoded PCM handed from the stream thread to the main thread.
+///
+/// A fixed ring of chunks with a single producer, the stream thread, and a
+/// single consumer, the main thread, which copies the chunks into OpenAL
+/// buffers.  Neither side ever blocks; the producer stops decoding when the
+/// ring is full and the consumer stops queueing when it's empty.  The
+/// counters work the same way as SPSCQueue's.
+class AudioStreamRing
+{
+  public:
+   enum Constants {
+      NumChunks = 16,               ///< Power of two.
+      ChunkSize = 32768             ///< Bytes, the size of one OpenAL buffer.
+   };
+
+   struct Chunk
+   {
+      U32  size;
+      F32  time;                    ///< Stream time at the end of the chunk.
+      bool endOfStream;             ///< No data; nothing follows.
+   };
+
+  private:
+   enum { Mask = NumChunks - 1 };
+
+   U8 *         mData;
+   Chunk        mChunks[NumChunks];
+
+   volatile U32 mHead;              ///< Written by the consumer only.
+   U8           mPad[60];
+   volatile U32 mTail;              ///< Written by the producer only.
+
+  public:
+   AudioStreamRing() : mHead(0), mTail(0) { mData = new U8[NumChunks * ChunkSize]; }
+   ~AudioStreamRing() { delete [] mData; }
+
+   /// @name Producer
+   /// @{
+
+   /// Where to decode the next chunk, or NULL if the ring is full.
+   U8 *getWriteBuffer()
+   {
+      U32 tail = mTail;
+      if(tail - dAtomicRead(mHead) == NumChunks)
+         return NULL;
+      return mData + (tail & Mask) * ChunkSize;
+   }
+
+   /// Publishes the chunk getWriteBuffer() returned.
+   void commit(U32 size, F32 time, bool endOfStream)
+   {
+      U32 tail = mTail;
+      Chunk &chunk = mChunks[tail & Mask];
+      chunk.size = size;
+      chunk.time = time;
+      chunk.endOfStream = endOfStream;
+      dAtomicWrite(mTail, tail + 1);
+   }
+   /// @}
+
+   /// @name Consumer
+   /// @{
+
+   /// The oldest chunk and its data, or NULL if the ring is empty.
+   const Chunk *peek(const U8 *&data)
+   {
+      U32 head = mHead;
+      if(dAtomicRead(mTail) == head)
+         return NULL;
+      data = mData + (head & Mask) * ChunkSize;
+      return &mChunks[head & Mask];
+   }
+
+   /// Hands the chunk peek() returned back to the producer.
+   void pop() { dAtomicWrite(mHead, mHead + 1); }
+   /// @}
+};
+
+/// The thread that decodes the streaming sounds ahead of playback.
+///
+/// A DecodedStreamSource registers itself once its stream is open and
+/// unregisters before closing it.  Every few milliseconds the thread tops
+/// up each registered source's AudioStreamRing, and the main thread only
+/// moves the decoded chunks into OpenAL from alxStreamingUpdate(), so a
+/// stream keeps playing through a long frame as long as its ring and
+/// OpenAL queue last.  All the OpenAL calls stay on the main thread.
+///
+/// The thread runs from OpenALInit() to OpenALShutdown().  Without
+/// TORQUE_MULTITHREAD it never starts, and the sources decode on the main
+/// thread in updateBuffers(), as they always did.
+class AudioStreamThread : public Thread
+{
+   static AudioStreamThread *          smThread;
+   static void *                       smMutex;       ///< Guards smSources, held while decoding.
+   static Vector<DecodedStreamSource*> smSources;
+
+   volatile bool mStopping;
+
+   AudioStreamThread();
+
+  public:
+   enum Constants {
+      DecodeIntervalMs = 10
+   };
+
+   void run(S32 arg);
+
+   static void startThread();
+   static void stopThread();
+   static bool isRunning() { return smThread != NULL; }
+
+   /// Returns false if the thread isn't running, in which case the source
+   /// has to decode for itself.
+   static bool addSource(DecodedStreamSource *source);
+   /// Waits for the source's decoding to finish if it's in progress.
+   static void removeSource(DecodedStreamSource *source);
+};
+
+#endif // _AUDIOSTREAMTHREAD_H_
@@ -8,7 +8,6 @@
 #include "audio/vorbisStreamSource.h"
 #include "vorbis/codec.h"
 
-#define BUFFERSIZE 32768
 #define CHUNKSIZE 4096
 
 #if defined(TORQUE_BIG_ENDIAN)
@@ -19,349 +18,100 @@
 
 extern const char * MusicPlayerStreamingHook(const AUDIOHANDLE & handle);
 
-VorbisStreamSource::VorbisStreamSource(const char *filename)
+VorbisStreamSource::VorbisStreamSource(const char *filename) : DecodedStreamSource(filename)
 {
    stream = NULL;
-   bIsValid = false;
-   bBuffersAllocated = false;
    bVorbisFileInitialized = false;
-   mBufferList[0] = 0;
-   clear();
-
-   mFilename = filename;
-   mPosition = Point3F(0.f,0.f,0.f);
+   mTotalTime = 0.f;
+   current_section = 0;
 }
 
 VorbisStreamSource::~VorbisStreamSource()
 {
-   if(bReady && bIsValid)
-      freeStream();
-}
-
-void VorbisStreamSource::clear()
-{
-   if(stream)
-      freeStream();
-
-   mHandle           = NULL_AUDIOHANDLE;
-   mSource           = NULL;
-
-   if(mBufferList[0] != 0)
-      alDeleteBuffers(NUMBUFFERS, mBufferList);
-   for(int i = 0; i < NUMBUFFERS; i++)
-      mBufferList[i] = 0;
-
-   dMemset(&mDescription, 0, sizeof(Audio::Description));
-   mEnvironment = 0;
-   mPosition.set(0.f,0.f,0.f);
-   mDirection.set(0.f,1.f,0.f);
-   mPitch = 1.f;
-   mScore = 0.f;
-   mCullTime = 0;
-
-   bReady = false;
-   bFinishedPlaying = false;
-   bIsValid = false;
-   bBuffersAllocated = false;
-   bVorbisFileInitialized = false;
+   freeStream();
 }
 
-bool VorbisStreamSource::initStream()
+bool VorbisStreamSource::openFile(const char * file)
 {
-   vorbis_info *vi;
-
-   ALint error;
-
-   bFinished = false;
-
-   // JMQ: changed buffer to static and doubled size.  workaround for
-   // https://206.163.64.242/mantis/view_bug_page.php?f_id=0000242
-   static char data[BUFFERSIZE*2];
-
-   alSourceStop(mSource);
-   alSourcei(mSource, AL_BUFFER, 0);
-
+   mFilename = file;
    stream = ResourceManager->openStream(mFilename);
-   if(stream != NULL)
-   {
-      if(vf.ov_open(stream, NULL, 0) < 0)
-      {
-         return false;
-      }
-
-      bVorbisFileInitialized = true;
-
-      //Read Vorbis File Info
-      vi = vf.ov_info(-1);
-      freq = vi->rate;
-
-      long samples = (long)vf.ov_pcm_total(-1);
-
-      if(vi->channels == 1)
-      {
-         format = AL_FORMAT_MONO16;
-         DataSize = 2 * samples;
-      }
-      else
-      {
-         format = AL_FORMAT_STEREO16;
-         DataSize = 4 * samples;
-      }
-      DataLeft = DataSize;
-
-      // Clear Error Code
-      alGetError();
-
-      alGenBuffers(NUMBUFFERS, mBufferList);
-      if ((error = alGetError()) != AL_NO_ERROR)
-         return false;
-
-      bBuffersAllocated = true;
-
-      int numBuffers = 0;
-      for(int loop = 0; loop < NUMBUFFERS; loop++)
-      {
-         ALuint DataToRead = (DataLeft > BUFFERSIZE) ? BUFFERSIZE : DataLeft;
-         if (DataToRead == DataLeft)
-            bFinished = AL_TRUE;
-
-         long ret = oggRead(data, BUFFERSIZE, ENDIAN, &current_section);
-         if(ret <= 0)
-         {
-            bFinished = AL_TRUE;
-            break;
-         }
-
-         DataLeft -= ret;
-         alBufferData(mBufferList[loop], format, data, ret, freq);
-         ++numBuffers;
-
-         if ((error = alGetError()) != AL_NO_ERROR)
-            return false;
-         if(bFinished)
-            break;
-      }
-
-      // Queue the buffers on the source
-      alSourceQueueBuffers(mSource, NUMBUFFERS, mBufferList);
-      if ((error = alGetError()) != AL_NO_ERROR)
-         return false;
+   if(stream == NULL)
+      return false;
 
-      alSourcei(mSource, AL_LOOPING, AL_FALSE);
-      bReady = true;
-   }
-   else
-   {
+   if(vf.ov_open(stream, NULL, 0) < 0)
       return false;
-   }
-   bIsValid = true;
 
+   bVorbisFileInitialized = true;
+
+   //Read Vorbis File Info
+   vorbis_info * vi = vf.ov_info(-1);
+   mFreq = vi->rate;
+   mFormat = (vi->channels == 1) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+   mTotalTime = vf.ov_time_total(-1);
    return true;
 }
 
-bool VorbisStreamSource::updateBuffers()
+void VorbisStreamSource::closeFile()
 {
-   ALint         processed;
-   ALuint         BufferID;
-   ALint         error;
-   // JMQ: changed buffer to static and doubled size.  workaround for
-   // https://206.163.64.242/mantis/view_bug_page.php?f_id=0000242
-   static char data[BUFFERSIZE*2];
-
-   // don't do anything if stream not loaded properly
-   if(!bIsValid)
-      return false;
-
-   if(bFinished && mDescription.mIsLooping)
-      resetStream();
-
-   // reset AL error code
-   alGetError();
-
-#if 1 //def TORQUE_OS_LINUX
-   // JMQ: this doesn't really help on linux.  it may make things worse.
-   // if it doesn't help on mac/win either, could disable it.
-   ALint state;
-   alGetSourcei(mSource, AL_SOURCE_STATE, &state);
-   if (state == AL_STOPPED)
+   if(bVorbisFileInitialized)
    {
-      // um, yeah.  you should be playing
-      // restart
-      alSourcePlay(mSource);
-      //#ifdef TORQUE_DEBUG
-      //Con::errorf(">><<>><< THE MUSIC STOPPED >><<>><<");
-      //#endif
-      return true;
+      vf.ov_clear();
+      bVorbisFileInitialized = false;
    }
-#endif
 
-#ifdef TORQUE_OS_LINUX
-   checkPosition();
-#endif
-
-   // Get status
-   alGetSourcei(mSource, AL_BUFFERS_PROCESSED, &processed);
-
-   // If some buffers have been played, unqueue them and load new audio into them, then add them to the queue
-   if (processed > 0)
+   if(stream != NULL)
    {
-      while (processed)
-      {
-         alSourceUnqueueBuffers(mSource, 1, &BufferID);
-         if ((error = alGetError()) != AL_NO_ERROR)
-            return false;
-
-         if (!bFinished)
-         {
-            ALuint DataToRead = (DataLeft > BUFFERSIZE) ? BUFFERSIZE : DataLeft;
-
-            if (DataToRead == DataLeft)
-               bFinished = AL_TRUE;
-
-            long ret = oggRead(data, BUFFERSIZE, ENDIAN, &current_section);
-            if(ret > 0)
-            {
-               DataLeft -= ret;
-
-               alBufferData(BufferID, format, data, ret, freq);
-               if ((error = alGetError()) != AL_NO_ERROR)
-                  return false;
-
-               // Queue buffer
-               alSourceQueueBuffers(mSource, 1, &BufferID);
-               if ((error = alGetError()) != AL_NO_ERROR)
-                  return false;
-            }
-
-            processed--;
-
-            if(bFinished && mDescription.mIsLooping)
-            {
-               resetStream();
-            }
-         }
-         else
-         {
-            buffersinqueue--;
-            processed--;
-
-            if (buffersinqueue == 0)
-            {
-               bFinishedPlaying = AL_TRUE;
-               return AL_FALSE;
-            }
-         }
-      }
+      ResourceManager->closeStream(stream);
+      stream = NULL;
    }
-
-   return true;
 }
 
-void VorbisStreamSource::freeStream()
+bool VorbisStreamSource::openDecoder()
 {
-   bReady = false;
-
-   if(stream != NULL)
-      ResourceManager->closeStream(stream);
-
-   stream = NULL;
-
-   if(bBuffersAllocated)
-   {
-      if(mBufferList[0] != 0)
-         alDeleteBuffers(NUMBUFFERS, mBufferList);
-      for(int i = 0; i < NUMBUFFERS; i++)
-         mBufferList[i] = 0;
+   if(openFile(mFilename))
+      return true;
+   closeFile();
+   return false;
+}
 
-      bBuffersAllocated = false;
-   }
+void VorbisStreamSource::closeDecoder()
+{
+   closeFile();
+}
 
-   if(bVorbisFileInitialized)
-   {
-      vf.ov_clear();
-      bVorbisFileInitialized = false;
-   }
+U32 VorbisStreamSource::decode(U8 *buffer, U32 size)
+{
+   if(!bVorbisFileInitialized)
+      return 0;
+   long ret = oggRead((char *) buffer, size, ENDIAN, &current_section);
+   return ret > 0 ? U32(ret) : 0;
 }
 
-void VorbisStreamSource::resetStream()
+bool VorbisStreamSource::rewind()
 {
    // MusicPlayerStreamingHook allow you to create a handler
    // where you can rotate through streaming files
-   // Comment in and provide hook if desired.
+   // Comment in and provide hook if desired.  It's called on the
+   // stream thread, and the new file must have the same format.
    //
    //const char * newFile = MusicPlayerStreamingHook(mHandle);
    //if (newFile)
    //{
    //   setNewFile(newFile);
-   //   return;
+   //   return bVorbisFileInitialized;
    //}
    //else
    {
-      vf.ov_pcm_seek(0);
-      DataLeft = DataSize;
-      bFinished = AL_FALSE;
+      return bVorbisFileInitialized && vf.ov_pcm_seek(0) == 0;
    }
 }
 
 void VorbisStreamSource::setNewFile(const char * file)
 {
-   //---------------------
-   // close down old file...
-   //---------------------
-
-   if(stream != NULL)
-   {
-      ResourceManager->closeStream(stream);
-      stream = NULL;
-   }
-
-   if(bVorbisFileInitialized)
-   {
-      vf.ov_clear();
-      bVorbisFileInitialized = false;
-   }
-
-   //---------------------
-   // open up new file...
-   //---------------------
-
-   mFilename = file;
-   stream = ResourceManager->openStream(mFilename);
-   if(stream != NULL)
-   {
-      if(vf.ov_open(stream, NULL, 0) < 0)
-      {
-         bFinished = AL_TRUE;
-         bVorbisFileInitialized = false;
-         bIsValid = false;
-         return;
-      }
-
-      //Read Vorbis File Info
-      vorbis_info * vi = vf.ov_info(-1);
-      freq = vi->rate;
-
-      long samples = (long)vf.ov_pcm_total(-1);
-
-      if(vi->channels == 1)
-      {
-         format = AL_FORMAT_MONO16;
-         DataSize = 2 * samples;
-      }
-      else
-      {
-         format = AL_FORMAT_STEREO16;
-         DataSize = 4 * samples;
-      }
-      DataLeft = DataSize;
-
-      // Clear Error Code
-      alGetError();
-
-      bFinished = AL_FALSE;
-      bVorbisFileInitialized = true;
-      bIsValid = true;
-   }
+   // close down old file and open up the new one
+   closeFile();
+   if(!openFile(file))
+      closeFile();
 }
 
 // ov_read() only returns a maximum of one page worth of data
@@ -431,12 +181,12 @@ void AudioStreamSource::checkPosition()
 
 #endif
 
-F32 VorbisStreamSource::getElapsedTime()
+F32 VorbisStreamSource::getDecodeTime()
 {
-   return vf.ov_time_tell();
+   return bVorbisFileInitialized ? F32(vf.ov_time_tell()) : 0.f;
 }
 
 F32 VorbisStreamSource::getTotalTime()
 {
-   return vf.ov_time_total(-1);
+   return mTotalTime;
 }
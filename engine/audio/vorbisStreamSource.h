@@ -14,44 +14,33 @@
 
 #include "audio/vorbisStream.h"
 
-class VorbisStreamSource: public AudioStreamSource
+class VorbisStreamSource: public DecodedStreamSource
 {
 	public:
 		VorbisStreamSource(const char *filename);
 		virtual ~VorbisStreamSource();
 
-		virtual bool initStream();
-		virtual bool updateBuffers();
-		virtual void freeStream();
-      virtual F32 getElapsedTime();
       virtual F32 getTotalTime();
 
+	protected:
+      virtual bool openDecoder();
+      virtual void closeDecoder();
+      virtual U32 decode(U8 *buffer, U32 size);
+      virtual bool rewind();
+      virtual F32 getDecodeTime();
+
 	private:
-		ALuint				    mBufferList[NUMBUFFERS];
-		S32						mNumBuffers;
-		S32						mBufferSize;
 		Stream				   *stream;
 
-		bool					bReady;
-		bool					bFinished;
-
-		ALenum  format;
-		ALsizei size;
-		ALsizei freq;
-
-		ALuint			DataSize;
-		ALuint			DataLeft;
-		ALuint			buffersinqueue;
-
-		bool			bBuffersAllocated;
 		bool			bVorbisFileInitialized;
+      F32         mTotalTime;
 
 		int current_section;
 		OggVorbisFile vf;
 
-		void clear();
 		long oggRead(char *buffer,int length, int bigendianp,int *bitstream);
-		void resetStream();
+      bool openFile(const char * file);
+      void closeFile();
       void setNewFile(const char * file);
 };
 
@@ -7,8 +7,6 @@
 
 #include "audio/wavStreamSource.h"
 
-#define BUFFERSIZE 32768
-
 typedef struct
 {
 	ALubyte		riff[4];		// 'RIFF'
@@ -84,251 +82,83 @@ struct WAVChunkHdr
 
 
 
-WavStreamSource::WavStreamSource(const char *filename)  {
+WavStreamSource::WavStreamSource(const char *filename) : DecodedStreamSource(filename) {
    stream = NULL;
-   bIsValid = false;
-   bBuffersAllocated = false;
-   mBufferList[0] = 0;
-   clear();
-
-   mFilename = filename;
-   mPosition = Point3F(0.f,0.f,0.f);
+   DataSize = 0;
+   DataLeft = 0;
+   dataStart = 0;
+   bytesPerSec = 0;
 }
 
 WavStreamSource::~WavStreamSource() {
-	if(bReady && bIsValid)
-		freeStream();
-}
-
-void WavStreamSource::clear()
-{
-	if(stream)
-		freeStream();
-
-	mHandle           = NULL_AUDIOHANDLE;
-	mSource			  = NULL;
-
-	if(mBufferList[0] != 0)
-		alDeleteBuffers(NUMBUFFERS, mBufferList);
-	for(int i = 0; i < NUMBUFFERS; i++)
-		mBufferList[i] = 0;
-
-	dMemset(&mDescription, 0, sizeof(Audio::Description));
-	mEnvironment = 0;
-	mPosition.set(0.f,0.f,0.f);
-	mDirection.set(0.f,1.f,0.f);
-	mPitch = 1.f;
-	mScore = 0.f;
-	mCullTime = 0;
-
-	bReady = false;
-	bFinishedPlaying = false;
-	bIsValid = false;
-	bBuffersAllocated = false;
+	freeStream();
 }
 
-bool WavStreamSource::initStream() {
+bool WavStreamSource::openDecoder() {
    WAVChunkHdr chunkHdr;
-   WAVFmtExHdr fmtExHdr;
    WAVFileHdr  fileHdr;
-   WAVSmplHdr  smplHdr;
    WAVFmtHdr   fmtHdr;
 
-   WAVE_Struct wave;
-
-   ALint			error;
-
-   bFinished = false;
-
-   char   data[BUFFERSIZE];
-
-   alSourceStop(mSource);
-   alSourcei(mSource, AL_BUFFER, 0);
-
 	stream = ResourceManager->openStream(mFilename);
-	if(stream != NULL) {
-	   stream->read(4, &fileHdr.id[0]);
-	   stream->read(&fileHdr.size);
-	   stream->read(4, &fileHdr.type[0]);
-
-	   stream->read(4, &chunkHdr.id[0]);
-	   stream->read(&chunkHdr.size);
-
-	   // WAV Format header
-		stream->read(&fmtHdr.format);
-		stream->read(&fmtHdr.channels);
-		stream->read(&fmtHdr.samplesPerSec);
-		stream->read(&fmtHdr.bytesPerSec);
-		stream->read(&fmtHdr.blockAlign);
-		stream->read(&fmtHdr.bitsPerSample);
-
-		format=(fmtHdr.channels==1?
-		   (fmtHdr.bitsPerSample==8?AL_FORMAT_MONO8:AL_FORMAT_MONO16):
-		   (fmtHdr.bitsPerSample==8?AL_FORMAT_STEREO8:AL_FORMAT_STEREO16));
-		freq=fmtHdr.samplesPerSec;
-
-		 stream->read(4, &chunkHdr.id[0]);
-		 stream->read(&chunkHdr.size);
-
-		DataSize = chunkHdr.size;
-		DataLeft = DataSize;
-		dataStart = stream->getPosition();
-
-		// Clear Error Code
-		alGetError();
-
-		alGenBuffers(NUMBUFFERS, mBufferList);
-		if ((error = alGetError()) != AL_NO_ERROR) {
-			return false;
-		}
-
-		bBuffersAllocated = true;
-
-		int numBuffers = 0;
-		for(int loop = 0; loop < NUMBUFFERS; loop++)
-		{
-			ALuint DataToRead = (DataLeft > BUFFERSIZE) ? BUFFERSIZE : DataLeft;
-
-			if (DataToRead == DataLeft)
-				bFinished = AL_TRUE;
-			stream->read(DataToRead, data);
-			DataLeft -= DataToRead;
-			alBufferData(mBufferList[loop], format, data, DataToRead, freq);	
-			if ((error = alGetError()) != AL_NO_ERROR) {
-				return false;
-			}
-			++numBuffers;
-			if(bFinished)
-				break;
-		}
-
-		// Queue the buffers on the source
-		alSourceQueueBuffers(mSource, numBuffers, mBufferList);
-		if ((error = alGetError()) != AL_NO_ERROR) {
-			return false;
-		}
-
-		buffersinqueue = numBuffers;
-		alSourcei(mSource, AL_LOOPING, AL_FALSE);
-		bReady = true;
-	}
-	else {
-		return false;
-	}
-
-	bIsValid = true;
-
-   return true;
-}
-
-bool WavStreamSource::updateBuffers() {
-
-	ALint			processed;
-	ALuint			BufferID;
-	ALint			error;
-	char data[BUFFERSIZE];
-
-	// don't do anything if buffer isn't initialized
-	if(!bIsValid)
+	if(stream == NULL)
 		return false;
 
-	if(bFinished && mDescription.mIsLooping) {
-		resetStream();
-	}
+   stream->read(4, &fileHdr.id[0]);
+   stream->read(&fileHdr.size);
+   stream->read(4, &fileHdr.type[0]);
 
-	// reset AL error code
-	alGetError();
+   stream->read(4, &chunkHdr.id[0]);
+   stream->read(&chunkHdr.size);
 
-	// Get status
-	alGetSourcei(mSource, AL_BUFFERS_PROCESSED, &processed);
+   // WAV Format header
+	stream->read(&fmtHdr.format);
+	stream->read(&fmtHdr.channels);
+	stream->read(&fmtHdr.samplesPerSec);
+	stream->read(&fmtHdr.bytesPerSec);
+	stream->read(&fmtHdr.blockAlign);
+	stream->read(&fmtHdr.bitsPerSample);
 
-	// If some buffers have been played, unqueue them and load new audio into them, then add them to the queue
-	if (processed > 0)
-	{
+	mFormat=(fmtHdr.channels==1?
+	   (fmtHdr.bitsPerSample==8?AL_FORMAT_MONO8:AL_FORMAT_MONO16):
+	   (fmtHdr.bitsPerSample==8?AL_FORMAT_STEREO8:AL_FORMAT_STEREO16));
+	mFreq=fmtHdr.samplesPerSec;
+	bytesPerSec=fmtHdr.bytesPerSec;
 
-		while (processed)
-		{
-			alSourceUnqueueBuffers(mSource, 1, &BufferID);
-			if ((error = alGetError()) != AL_NO_ERROR)
-				return false;
+	stream->read(4, &chunkHdr.id[0]);
+	stream->read(&chunkHdr.size);
 
-			if (!bFinished)
-			{
-				ALuint DataToRead = (DataLeft > BUFFERSIZE) ? BUFFERSIZE : DataLeft;
-
-				if (DataToRead == DataLeft) {
-					bFinished = AL_TRUE;
-				}
-					
-				stream->read(DataToRead, data);
-				DataLeft -= DataToRead;
-					
-				alBufferData(BufferID, format, data, DataToRead, freq);
-				if ((error = alGetError()) != AL_NO_ERROR)
-					return false;
-
-				// Queue buffer
-				alSourceQueueBuffers(mSource, 1, &BufferID);
-				if ((error = alGetError()) != AL_NO_ERROR)
-					return false;
-
-				processed--;
-
-				if(bFinished && mDescription.mIsLooping) {
-					resetStream();
-				}
-			}
-			else
-			{
-				buffersinqueue--;
-				processed--;
-
-				if (buffersinqueue == 0)
-				{
-					bFinishedPlaying = AL_TRUE;
-					return AL_FALSE;
-				}
-			}
-		}
-	}
+	DataSize = chunkHdr.size;
+	DataLeft = DataSize;
+	dataStart = stream->getPosition();
 
-	return AL_TRUE;
+   return true;
 }
 
-void WavStreamSource::freeStream() {
-	bReady = false;
-
-	
+void WavStreamSource::closeDecoder() {
 	if(stream != NULL)
 		ResourceManager->closeStream(stream);
 	stream = NULL;
+}
 
-	if(bBuffersAllocated) {
-		if(mBufferList[0] != 0)
-			alDeleteBuffers(NUMBUFFERS, mBufferList);
-		for(int i = 0; i < NUMBUFFERS; i++)
-			mBufferList[i] = 0;
-
-		bBuffersAllocated = false;
-	}
+U32 WavStreamSource::decode(U8 *buffer, U32 size) {
+	U32 DataToRead = (DataLeft > size) ? size : DataLeft;
+	if(!DataToRead || !stream->read(DataToRead, buffer))
+		return 0;
+	DataLeft -= DataToRead;
+	return DataToRead;
 }
 
-void WavStreamSource::resetStream() {
-	stream->setPosition(dataStart);
+bool WavStreamSource::rewind() {
 	DataLeft = DataSize;
-	bFinished = AL_FALSE;
+	return stream->setPosition(dataStart);
 }
 
-#include "console/console.h"
-
-F32 WavStreamSource::getElapsedTime()
+F32 WavStreamSource::getDecodeTime()
 {
-   Con::warnf( "GetElapsedTime not implemented in WaveStreams yet" );
-   return -1.f;
+   return bytesPerSec ? F32(DataSize - DataLeft) / bytesPerSec : 0.f;
 }
 
 F32 WavStreamSource::getTotalTime()
 {
-   Con::warnf( "GetTotalTime not implemented in WaveStreams yet" );
-   return -1.f;
+   return bytesPerSec ? F32(DataSize) / bytesPerSec : 0.f;
 }
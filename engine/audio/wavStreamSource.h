@@ -10,40 +10,28 @@
 #include "audio/audioStreamSource.h"
 #endif
 
-class WavStreamSource: public AudioStreamSource
+class WavStreamSource: public DecodedStreamSource
 {
 	public:
 		WavStreamSource(const char *filename);
 		virtual ~WavStreamSource();
 
-		virtual bool initStream();
-		virtual bool updateBuffers();
-		virtual void freeStream();
-      virtual F32 getElapsedTime();
       virtual F32 getTotalTime();
 
+	protected:
+      virtual bool openDecoder();
+      virtual void closeDecoder();
+      virtual U32 decode(U8 *buffer, U32 size);
+      virtual bool rewind();
+      virtual F32 getDecodeTime();
+
 	private:
-		ALuint				    mBufferList[NUMBUFFERS];
-		S32						mNumBuffers;
-		S32						mBufferSize;
 		Stream				   *stream;
 
-		bool					bReady;
-		bool					bFinished;
-
-		ALenum  format;
-		ALsizei size;
-		ALsizei freq;
-
 		ALuint			DataSize;
 		ALuint			DataLeft;
 		ALuint			dataStart;
-		ALuint			buffersinqueue;
-
-		bool			bBuffersAllocated;
-
-		void clear();
-		void resetStream();
+		ALuint			bytesPerSec;
 };
 
 #endif // _AUDIOSTREAMSOURCE_H_
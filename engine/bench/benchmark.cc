@@ -0,0 +1,197 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "bench/benchmark.h"
+#include "core/tVector.h"
+#include "core/fileStream.h"
+#include "core/resManager.h"
+#include "console/console.h"
+#include "game/version.h"
+
+Benchmark    *Benchmark::smList = NULL;
+volatile U32  Benchmark::smSink = 0;
+
+static S32          sArgc = 0;
+static const char **sArgv = NULL;
+
+/// Set by game/main.cc's DemoGame::main to run instead of the main loop.
+extern S32 (*gBenchmarkMain)(S32 argc, const char **argv);
+
+namespace
+{
+   /// Installs the runner when the bench sources are linked in.
+   struct BenchmarkHook
+   {
+      BenchmarkHook() { gBenchmarkMain = Benchmark::runAll; }
+   } sBenchmarkHook;
+
+   struct Result
+   {
+      const char *name;
+      const char *unit;
+      bool        skipped;
+      U32         iterations;
+      F64         minNs;
+      F64         medianNs;
+      F64         meanNs;
+      F64         maxNs;
+   };
+
+   S32 QSORT_CALLBACK cmpF64(const void *a, const void *b)
+   {
+      F64 da = *(const F64 *) a;
+      F64 db = *(const F64 *) b;
+      return (da < db) ? -1 : ((da > db) ? 1 : 0);
+   }
+
+   /// Wall time of one prepared run, in ms.
+   U32 timeRun(Benchmark *bench, U32 iterations)
+   {
+      bench->prepare(iterations);
+      U32 start = Platform::getRealMilliseconds();
+      bench->run(iterations);
+      return Platform::getRealMilliseconds() - start;
+   }
+
+   void writeResults(const char *fileName, const Vector<Result> &results, U32 reps)
+   {
+      FileStream fws;
+      if(!fws.open(fileName, FileStream::Write))
+      {
+         Con::errorf("Benchmark: unable to write results to %s.", fileName);
+         return;
+      }
+
+      char buf[512];
+#ifdef TORQUE_DEBUG
+      const char *build = "debug";
+#else
+      const char *build = "release";
+#endif
+      dSprintf(buf, sizeof(buf), "{\n\"version\":\"%s\",\n\"compiled\":\"%s\",\n\"build\":\"%s\",\n\"repetitions\":%d,\n\"benchmarks\":[",
+               getVersionString(), getCompileTimeString(), build, reps);
+      fws.write(dStrlen(buf), buf);
+
+      for(U32 i = 0; i < results.size(); i++)
+      {
+         const Result &r = results[i];
+         const char *sep = i ? ",\n" : "\n";
+         if(r.skipped)
+            dSprintf(buf, sizeof(buf), "%s{\"name\":\"%s\",\"skipped\":true}", sep, r.name);
+         else
+            dSprintf(buf, sizeof(buf), "%s{\"name\":\"%s\",\"unit\":\"%s\",\"iterations\":%d,"
+                     "\"minNs\":%.2f,\"medianNs\":%.2f,\"meanNs\":%.2f,\"maxNs\":%.2f}",
+                     sep, r.name, r.unit, r.iterations, r.minNs, r.medianNs, r.meanNs, r.maxNs);
+         fws.write(dStrlen(buf), buf);
+      }
+
+      const char *footer = "\n]\n}\n";
+      fws.write(dStrlen(footer), footer);
+      fws.close();
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+Benchmark::Benchmark(const char *name)
+{
+   mName = name;
+   mNext = smList;
+   smList = this;
+}
+
+const char *Benchmark::getArg(const char *name, const char *def)
+{
+   for(S32 i = 1; i < sArgc - 1; i++)
+      if(sArgv[i][0] == '-' && !dStricmp(sArgv[i] + 1, name))
+         return sArgv[i + 1];
+   return def;
+}
+
+S32 Benchmark::runAll(S32 argc, const char **argv)
+{
+   sArgc = argc;
+   sArgv = argv;
+
+   const char *filter  = getArg("filter", NULL);
+   const char *outFile = getArg("out", "benchmarks.json");
+   const char *mod     = getArg("mod", "starter.fps");
+   U32 reps    = getMax(dAtoi(getArg("reps", "5")), 1);
+   U32 minTime = getMax(dAtoi(getArg("minTime", "200")), 10);
+
+   ResourceManager->setModPaths(1, &mod);
+
+   // The list is in reverse link order; run them by name so reports line up.
+   Vector<Benchmark *> benches;
+   for(Benchmark *walk = smList; walk; walk = walk->mNext)
+      if(!filter || dStrstr(walk->mName, filter))
+         benches.push_back(walk);
+   for(S32 i = 0; i < benches.size(); i++)
+      for(S32 j = i + 1; j < benches.size(); j++)
+         if(dStrcmp(benches[j]->mName, benches[i]->mName) < 0)
+         {
+            Benchmark *swap = benches[i];
+            benches[i] = benches[j];
+            benches[j] = swap;
+         }
+
+   Con::printf("Running %d benchmarks, %d repetitions of %d ms each.", benches.size(), reps, minTime);
+   Con::printf("%-24s %12s %12s %12s %12s  %s", "benchmark", "min ns", "median ns", "mean ns", "max ns", "iterations");
+
+   Vector<Result> results;
+   Vector<F64> samples;
+   for(U32 i = 0; i < benches.size(); i++)
+   {
+      Benchmark *bench = benches[i];
+
+      Result r;
+      dMemset(&r, 0, sizeof(r));
+      r.name = bench->mName;
+      r.unit = bench->getUnit();
+
+      if(!bench->setup())
+      {
+         bench->cleanup();
+         r.skipped = true;
+         results.push_back(r);
+         Con::printf("%-24s skipped", r.name);
+         continue;
+      }
+
+      // Double the count until a run is long enough to time, then scale
+      // it to the requested length.  This also warms the caches.
+      U32 iterations = 1;
+      U32 elapsed;
+      while((elapsed = timeRun(bench, iterations)) < minTime / 8 && iterations < (1 << 30))
+         iterations <<= 1;
+      if(elapsed)
+         iterations = getMax(U32(F64(iterations) * minTime / elapsed), U32(1));
+
+      samples.clear();
+      F64 total = 0;
+      for(U32 rep = 0; rep < reps; rep++)
+      {
+         F64 ns = F64(timeRun(bench, iterations)) * 1000000.0 / iterations;
+         samples.push_back(ns);
+         total += ns;
+      }
+      bench->cleanup();
+
+      dQsort(samples.address(), samples.size(), sizeof(F64), cmpF64);
+      r.iterations = iterations;
+      r.minNs      = samples.first();
+      r.maxNs      = samples.last();
+      r.meanNs     = total / reps;
+      r.medianNs   = (reps & 1) ? samples[reps / 2] : (samples[reps / 2 - 1] + samples[reps / 2]) * 0.5;
+      results.push_back(r);
+
+      Con::printf("%-24s %12.1f %12.1f %12.1f %12.1f  %d %s", r.name,
+                  r.minNs, r.medianNs, r.meanNs, r.maxNs, r.iterations, r.unit);
+   }
+
+   writeResults(outFile, results, reps);
+   Con::printf("Wrote %s (sink %d).", outFile, U32(smSink));
+   return 0;
+}
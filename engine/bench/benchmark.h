@@ -0,0 +1,71 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _BENCHMARK_H_
+#define _BENCHMARK_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+/// A timed loop over one engine hot path, run by the torqueBench target.
+///
+/// Each benchmark is a static instance of a Benchmark subclass, so linking
+/// its file in is all it takes to add it.  The runner calls setup() once,
+/// then for each repetition prepare() with the iteration count, untimed,
+/// and run() with the same count, timed.  cleanup() is called at the end
+/// whether or not setup() succeeded.
+///
+/// torqueBench is the dedicated server build with the bench sources added;
+/// it initializes the engine like the game does, without running main.cs,
+/// and then runs the benchmarks instead of the main loop.  Arguments:
+///
+///  - -filter <text>    Only run benchmarks whose name contains text.
+///  - -reps <n>         Timed repetitions of each benchmark, default 5.
+///  - -minTime <ms>     Length a repetition is scaled to, default 200.
+///  - -out <file>       JSON results, default benchmarks.json.
+///  - -mod <path>       Mod path for resource loads, default starter.fps.
+///
+/// Benchmarks can take their own arguments through getArg().
+class Benchmark
+{
+   static Benchmark *smList;
+   Benchmark *mNext;
+
+   const char *mName;
+
+  protected:
+   /// Feeds a result to a volatile sink, so the compiler can't drop the
+   /// work that produced it.
+   static void consume(U32 value) { smSink += value; }
+   static volatile U32 smSink;
+
+  public:
+   Benchmark(const char *name);
+   virtual ~Benchmark() {}
+
+   const char *getName() const { return mName; }
+
+   /// What one iteration does, for the report.
+   virtual const char *getUnit() const { return "iteration"; }
+
+   /// Builds the benchmark's data.  Returns false to skip the benchmark,
+   /// after printing why.
+   virtual bool setup() { return true; }
+   /// Untimed, called before each run() with the same count.
+   virtual void prepare(U32 /*iterations*/) {}
+   /// Does iterations of the work being measured.
+   virtual void run(U32 iterations) = 0;
+   virtual void cleanup() {}
+
+   /// The value following -name on the command line, or def.
+   static const char *getArg(const char *name, const char *def);
+
+   /// Runs the benchmarks and writes the report; the harness's replacement
+   /// for the main loop.
+   static S32 runAll(S32 argc, const char **argv);
+};
+
+#endif
@@ -0,0 +1,273 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "bench/benchmark.h"
+#include "core/bitStream.h"
+#include "core/stringTable.h"
+#include "core/tVector.h"
+#include "console/console.h"
+#include "math/mPoint.h"
+#include "math/mRandom.h"
+
+//-----------------------------------------------------------------------------
+// BitStream
+//-----------------------------------------------------------------------------
+
+namespace
+{
+   enum
+   {
+      PacketSize       = 1500,
+      UpdatesPerPacket = 32
+   };
+
+   /// Roughly what a ShapeBase move update puts in a packet.
+   struct SyntheticUpdate
+   {
+      U32     ghostIndex;
+      Point3F position;
+      Point3F velocity;
+      Point3F normal;
+      F32     energy;
+      bool    damaged;
+   };
+
+   SyntheticUpdate sUpdates[UpdatesPerPacket];
+   U8              sPacket[PacketSize];
+
+   void buildUpdates()
+   {
+      MRandomLCG rand(1234);
+      for(U32 i = 0; i < UpdatesPerPacket; i++)
+      {
+         SyntheticUpdate &u = sUpdates[i];
+         u.ghostIndex = rand.randI(0, 1023);
+         u.position.set(rand.randF(-1000, 1000), rand.randF(-1000, 1000), rand.randF(0, 300));
+         u.velocity.set(rand.randF(-20, 20), rand.randF(-20, 20), rand.randF(-20, 20));
+         u.normal.set(rand.randF(-1, 1), rand.randF(-1, 1), 1);
+         u.normal.normalize();
+         u.energy  = rand.randF();
+         u.damaged = rand.randI() & 1;
+      }
+   }
+
+   void writePacket(BitStream &stream)
+   {
+      for(U32 i = 0; i < UpdatesPerPacket; i++)
+      {
+         const SyntheticUpdate &u = sUpdates[i];
+         stream.writeInt(u.ghostIndex, 10);
+         stream.writeCompressedPoint(u.position);
+         stream.writeSignedFloat(u.velocity.x / 20, 12);
+         stream.writeSignedFloat(u.velocity.y / 20, 12);
+         stream.writeSignedFloat(u.velocity.z / 20, 12);
+         stream.writeNormalVector(u.normal, 10);
+         stream.writeFloat(u.energy, 8);
+         stream.writeFlag(u.damaged);
+      }
+   }
+}
+
+class BitStreamWriteBenchmark : public Benchmark
+{
+  public:
+   BitStreamWriteBenchmark() : Benchmark("BitStreamWrite") {}
+   const char *getUnit() const { return "packet"; }
+
+   bool setup()
+   {
+      buildUpdates();
+      return true;
+   }
+
+   void run(U32 iterations)
+   {
+      for(U32 i = 0; i < iterations; i++)
+      {
+         BitStream stream(sPacket, PacketSize);
+         writePacket(stream);
+         consume(stream.getCurPos());
+      }
+   }
+} sBitStreamWriteBenchmark;
+
+class BitStreamReadBenchmark : public Benchmark
+{
+  public:
+   BitStreamReadBenchmark() : Benchmark("BitStreamRead") {}
+   const char *getUnit() const { return "packet"; }
+
+   bool setup()
+   {
+      buildUpdates();
+      BitStream stream(sPacket, PacketSize);
+      writePacket(stream);
+      return true;
+   }
+
+   void run(U32 iterations)
+   {
+      for(U32 i = 0; i < iterations; i++)
+      {
+         BitStream stream(sPacket, PacketSize);
+         F32 sum = 0;
+         for(U32 j = 0; j < UpdatesPerPacket; j++)
+         {
+            Point3F pos, norm;
+            U32 ghost = stream.readInt(10);
+            stream.readCompressedPoint(&pos);
+            sum += stream.readSignedFloat(12);
+            sum += stream.readSignedFloat(12);
+            sum += stream.readSignedFloat(12);
+            stream.readNormalVector(&norm, 10);
+            sum += stream.readFloat(8);
+            if(stream.readFlag())
+               sum += ghost;
+            sum += pos.x + norm.z;
+         }
+         consume(U32(sum));
+      }
+   }
+} sBitStreamReadBenchmark;
+
+//-----------------------------------------------------------------------------
+// StringTable
+//-----------------------------------------------------------------------------
+
+/// Inserts strings the table hasn't seen, so every insert allocates a new
+/// entry, and grows the table now and then like a mission load does.
+class StringTableInsertBenchmark : public Benchmark
+{
+   Vector<char> mNames;
+   U32 mSerial;
+
+  public:
+   StringTableInsertBenchmark() : Benchmark("StringTableInsert") { mSerial = 0; }
+   const char *getUnit() const { return "insert"; }
+
+   enum { NameLength = 24 };
+
+   void prepare(U32 iterations)
+   {
+      mNames.setSize(iterations * NameLength);
+      for(U32 i = 0; i < iterations; i++)
+         dSprintf(&mNames[i * NameLength], NameLength, "benchName_%08x", mSerial++);
+   }
+
+   void run(U32 iterations)
+   {
+      for(U32 i = 0; i < iterations; i++)
+         consume(U8(StringTable->insert(&mNames[i * NameLength])[0]));
+   }
+
+   void cleanup()
+   {
+      mNames.clear();
+      mNames.compact();
+   }
+} sStringTableInsertBenchmark;
+
+/// Looks up strings the table already has, the common case.
+class StringTableLookupBenchmark : public Benchmark
+{
+   enum { NumNames = 4096, NameLength = 24 };
+   char mNames[NumNames][NameLength];
+
+  public:
+   StringTableLookupBenchmark() : Benchmark("StringTableLookup") {}
+   const char *getUnit() const { return "lookup"; }
+
+   bool setup()
+   {
+      for(U32 i = 0; i < NumNames; i++)
+      {
+         dSprintf(mNames[i], NameLength, "benchLookup_%d", i);
+         StringTable->insert(mNames[i]);
+      }
+      return true;
+   }
+
+   void run(U32 iterations)
+   {
+      for(U32 i = 0; i < iterations; i++)
+         consume(U8(StringTable->lookup(mNames[i & (NumNames - 1)])[0]));
+   }
+} sStringTableLookupBenchmark;
+
+//-----------------------------------------------------------------------------
+// Script
+//-----------------------------------------------------------------------------
+
+namespace
+{
+   /// Canned scripts, each a function taking one argument; defined once
+   /// and then called through Con::executef() like engine callbacks are.
+   const char *sBenchScripts =
+      "function benchFib(%n)\n"
+      "{\n"
+      "   if(%n < 2)\n"
+      "      return %n;\n"
+      "   return benchFib(%n - 1) + benchFib(%n - 2);\n"
+      "}\n"
+      "function benchLoop(%n)\n"
+      "{\n"
+      "   %sum = 0;\n"
+      "   for(%i = 0; %i < %n; %i++)\n"
+      "      %sum += %i * 3 % 7;\n"
+      "   return %sum;\n"
+      "}\n"
+      "function benchStrings(%n)\n"
+      "{\n"
+      "   %str = \"\";\n"
+      "   for(%i = 0; %i < %n; %i++)\n"
+      "      %str = getSubStr(%str @ %i SPC \"word\", 0, 64);\n"
+      "   return strlen(%str);\n"
+      "}\n"
+      "function benchGlobals(%n)\n"
+      "{\n"
+      "   for(%i = 0; %i < %n; %i++)\n"
+      "      $BenchGlobal[%i % 16] = $BenchGlobal[(%i + 1) % 16] + 1;\n"
+      "   return $BenchGlobal[0];\n"
+      "}\n";
+
+   bool sBenchScriptsDefined = false;
+}
+
+/// Calls a canned script function; most of the time is in CodeBlock::exec.
+class ScriptBenchmark : public Benchmark
+{
+   const char *mFunction;
+   const char *mArgument;
+
+  public:
+   ScriptBenchmark(const char *name, const char *function, const char *argument)
+      : Benchmark(name)
+   {
+      mFunction = function;
+      mArgument = argument;
+   }
+   const char *getUnit() const { return "call"; }
+
+   bool setup()
+   {
+      if(!sBenchScriptsDefined)
+      {
+         Con::evaluate(sBenchScripts, false, "benchmarks");
+         sBenchScriptsDefined = true;
+      }
+      return true;
+   }
+
+   void run(U32 iterations)
+   {
+      for(U32 i = 0; i < iterations; i++)
+         consume(dAtoi(Con::executef(2, mFunction, mArgument)));
+   }
+};
+
+ScriptBenchmark sScriptFibBenchmark("ScriptFib", "benchFib", "12");
+ScriptBenchmark sScriptLoopBenchmark("ScriptLoop", "benchLoop", "1000");
+ScriptBenchmark sScriptStringsBenchmark("ScriptStrings", "benchStrings", "100");
+ScriptBenchmark sScriptGlobalsBenchmark("ScriptGlobals", "benchGlobals", "1000");
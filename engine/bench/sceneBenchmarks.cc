@@ -0,0 +1,383 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "bench/benchmark.h"
+#include "core/resManager.h"
+#include "core/memstream.h"
+#include "core/tVector.h"
+#include "console/console.h"
+#include "math/mRandom.h"
+#include "sim/sceneObject.h"
+#include "ts/tsShape.h"
+#include "ts/tsShapeInstance.h"
+#include "ts/tsMesh.h"
+#include "terrain/terrData.h"
+#include "terrain/terrRender.h"
+#include "terrain/blender.h"
+#include "dgl/gBitmap.h"
+
+//-----------------------------------------------------------------------------
+// Container
+//-----------------------------------------------------------------------------
+
+namespace
+{
+   /// A unit box, which is all the container needs to cast against.
+   class BenchBox : public SceneObject
+   {
+     public:
+      BenchBox(const Point3F &pos, F32 size)
+      {
+         mTypeMask = StaticObjectType;
+         mObjBox.min.set(-size, -size, -size);
+         mObjBox.max.set(size, size, size);
+         MatrixF mat(true);
+         mat.setColumn(3, pos);
+         setTransform(mat);
+      }
+
+      bool castRay(const Point3F &start, const Point3F &end, RayInfo *info)
+      {
+         F32 t;
+         Point3F normal;
+         if(!mObjBox.collideLine(start, end, &t, &normal))
+            return false;
+         info->t = t;
+         info->normal = normal;
+         info->object = this;
+         info->material = 0;
+         return true;
+      }
+   };
+
+   enum
+   {
+      GridSize  = 32,      ///< Boxes along each side of the grid.
+      GridPitch = 16,      ///< Meters between boxes.
+      NumRays   = 1024
+   };
+}
+
+/// A container of its own with a grid of boxes, and rays of the lengths
+/// projectiles and line of sight checks cast, some hitting and some not.
+class ContainerBenchmark : public Benchmark
+{
+  protected:
+   Container         *mContainer;
+   Vector<BenchBox *> mBoxes;
+   Vector<RayQuery>   mRays;
+
+  public:
+   ContainerBenchmark(const char *name) : Benchmark(name) { mContainer = NULL; }
+   const char *getUnit() const { return "ray"; }
+
+   bool setup()
+   {
+      mContainer = new Container;
+
+      MRandomLCG rand(4321);
+      F32 extent = GridSize * GridPitch;
+      for(U32 y = 0; y < GridSize; y++)
+         for(U32 x = 0; x < GridSize; x++)
+         {
+            Point3F pos(x * GridPitch, y * GridPitch, rand.randF(0, 8));
+            BenchBox *box = new BenchBox(pos, rand.randF(1, 4));
+            mContainer->addObject(box);
+            mBoxes.push_back(box);
+         }
+
+      mRays.setSize(NumRays);
+      for(U32 i = 0; i < NumRays; i++)
+      {
+         RayQuery &ray = mRays[i];
+         ray.start.set(rand.randF(0, extent), rand.randF(0, extent), rand.randF(0, 10));
+         Point3F dir(rand.randF(-1, 1), rand.randF(-1, 1), rand.randF(-0.2f, 0.2f));
+         dir.normalizeSafe();
+         ray.end = ray.start + dir * rand.randF(10, 200);
+      }
+      return true;
+   }
+
+   void cleanup()
+   {
+      for(U32 i = 0; i < mBoxes.size(); i++)
+      {
+         mContainer->removeObject(mBoxes[i]);
+         delete mBoxes[i];
+      }
+      mBoxes.clear();
+      mRays.clear();
+      delete mContainer;
+      mContainer = NULL;
+   }
+};
+
+class ContainerCastRayBenchmark : public ContainerBenchmark
+{
+  public:
+   ContainerCastRayBenchmark() : ContainerBenchmark("ContainerCastRay") {}
+
+   void run(U32 iterations)
+   {
+      for(U32 i = 0; i < iterations; i++)
+      {
+         const RayQuery &ray = mRays[i & (NumRays - 1)];
+         RayInfo info;
+         consume(mContainer->castRay(ray.start, ray.end, StaticObjectType, &info));
+      }
+   }
+} sContainerCastRayBenchmark;
+
+class ContainerCastRaysBenchmark : public ContainerBenchmark
+{
+   Vector<RayInfo> mHits;
+
+  public:
+   ContainerCastRaysBenchmark() : ContainerBenchmark("ContainerCastRays") {}
+
+   bool setup()
+   {
+      mHits.setSize(NumRays);
+      return ContainerBenchmark::setup();
+   }
+
+   /// In batches of 64, about what a ProjectileBatch casts in a tick.
+   void run(U32 iterations)
+   {
+      for(U32 i = 0; i < iterations; i += 64)
+      {
+         U32 count = getMin(iterations - i, U32(64));
+         U32 first = i & (NumRays - 1) & ~63;
+         consume(mContainer->castRays(&mRays[first], count, StaticObjectType, &mHits[first]));
+      }
+   }
+} sContainerCastRaysBenchmark;
+
+//-----------------------------------------------------------------------------
+// Shapes
+//-----------------------------------------------------------------------------
+
+/// Parses the -shape file from memory, as the resource manager does on a
+/// load, without the file system.
+class TSShapeReadBenchmark : public Benchmark
+{
+   U8 *mFile;
+   U32 mFileSize;
+
+  public:
+   TSShapeReadBenchmark() : Benchmark("TSShapeRead") { mFile = NULL; mFileSize = 0; }
+   const char *getUnit() const { return "shape"; }
+
+   bool setup()
+   {
+      const char *fileName = getArg("shape", "starter.fps/data/shapes/player/player.dts");
+      Stream *stream = ResourceManager->openStream(fileName);
+      if(!stream)
+      {
+         Con::errorf("TSShapeRead: unable to open %s.", fileName);
+         return false;
+      }
+      mFileSize = stream->getStreamSize();
+      mFile = new U8[mFileSize];
+      bool ok = stream->read(mFileSize, mFile);
+      ResourceManager->closeStream(stream);
+      return ok;
+   }
+
+   void run(U32 iterations)
+   {
+      for(U32 i = 0; i < iterations; i++)
+      {
+         MemStream stream(mFileSize, mFile, true, false);
+         TSShape *shape = new TSShape;
+         consume(shape->read(&stream));
+         delete shape;
+      }
+   }
+
+   void cleanup()
+   {
+      delete [] mFile;
+      mFile = NULL;
+   }
+} sTSShapeReadBenchmark;
+
+/// Skins every skin mesh of the -shape file's top detail, in its root pose.
+class SkinUpdateBenchmark : public Benchmark
+{
+   Resource<TSShape>   mShape;
+   TSShapeInstance    *mInstance;
+   Vector<TSSkinMesh *> mSkins;
+
+  public:
+   SkinUpdateBenchmark() : Benchmark("SkinUpdate") { mInstance = NULL; }
+   const char *getUnit() const { return "instance"; }
+
+   bool setup()
+   {
+      const char *fileName = getArg("shape", "starter.fps/data/shapes/player/player.dts");
+      mShape = ResourceManager->load(fileName);
+      if(bool(mShape) == false)
+      {
+         Con::errorf("SkinUpdate: unable to load %s.", fileName);
+         return false;
+      }
+
+      mInstance = new TSShapeInstance(mShape, false);
+      mInstance->animate();
+      for(U32 i = 0; i < mInstance->mMeshObjects.size(); i++)
+      {
+         TSMesh *mesh = mInstance->mMeshObjects[i].getMesh(0);
+         if(mesh && mesh->getMeshType() == TSMesh::SkinMeshType)
+            mSkins.push_back(static_cast<TSSkinMesh *>(mesh));
+      }
+      if(mSkins.empty())
+      {
+         Con::errorf("SkinUpdate: %s has no skin meshes.", fileName);
+         return false;
+      }
+      return true;
+   }
+
+   void run(U32 iterations)
+   {
+      TSShapeInstance::ObjectInstance::smTransforms = mInstance->mNodeTransforms.address();
+      for(U32 i = 0; i < iterations; i++)
+         for(U32 j = 0; j < mSkins.size(); j++)
+         {
+            mSkins[j]->updateSkin();
+            consume(U32(mSkins[j]->verts[0].x));
+         }
+      TSShapeInstance::ObjectInstance::smTransforms = NULL;
+   }
+
+   void cleanup()
+   {
+      mSkins.clear();
+      delete mInstance;
+      mInstance = NULL;
+      mShape = NULL;
+   }
+} sSkinUpdateBenchmark;
+
+//-----------------------------------------------------------------------------
+// Terrain
+//-----------------------------------------------------------------------------
+
+/// Blends the -terrain file's alpha maps with synthetic source textures
+/// and a synthetic light map, cycling through the detail levels the
+/// terrain renderer asks for.  The block is never added to the
+/// simulation; the blender only needs its grid.
+class TerrainBlendBenchmark : public Benchmark
+{
+   Resource<TerrainFile> mFile;
+   TerrainBlock *mBlock;
+   Blender      *mBlender;
+   U16          *mLightMap;
+   U32          *mBuffer;
+   GBitmap      *mBitmap;
+
+   enum { LightMapSize = 512, SourceSize = 256, NumSourceMips = 5 };
+
+  public:
+   TerrainBlendBenchmark() : Benchmark("TerrainBlend")
+   {
+      mBlock = NULL;
+      mBlender = NULL;
+      mLightMap = NULL;
+      mBuffer = NULL;
+      mBitmap = NULL;
+   }
+   const char *getUnit() const { return "texture"; }
+
+   bool setup()
+   {
+      const char *fileName = getArg("terrain", "starter.fps/data/missions/stronghold.ter");
+      mFile = ResourceManager->load(fileName, true);
+      if(bool(mFile) == false)
+      {
+         Con::errorf("TerrainBlend: unable to load %s.", fileName);
+         return false;
+      }
+
+      mBlock = new TerrainBlock;
+      mBlock->setFile(mFile);
+
+      U32 numMaterials = 0;
+      U8 *alphas[TerrainBlock::MaterialGroups];
+      while(numMaterials < TerrainBlock::MaterialGroups && mFile->mMaterialAlphaMap[numMaterials])
+      {
+         alphas[numMaterials] = mFile->mMaterialAlphaMap[numMaterials];
+         numMaterials++;
+      }
+      if(!numMaterials)
+      {
+         Con::errorf("TerrainBlend: %s has no materials.", fileName);
+         return false;
+      }
+
+      // A different pattern for each material, RGB with its mips.
+      mBlender = new Blender(numMaterials, NumSourceMips, alphas);
+      for(U32 m = 0; m < numMaterials; m++)
+      {
+         U8 *mips[NumSourceMips];
+         U32 size = SourceSize;
+         for(U32 level = 0; level < NumSourceMips; level++, size >>= 1)
+         {
+            mips[level] = new U8[size * size * 3];
+            for(U32 i = 0; i < size * size; i++)
+            {
+               mips[level][i * 3 + 0] = U8(i * (m + 1));
+               mips[level][i * 3 + 1] = U8((i >> 3) + m * 40);
+               mips[level][i * 3 + 2] = U8(i ^ (m * 77));
+            }
+         }
+         mBlender->addSourceTexture(m, (const U8 **) mips);
+         for(U32 level = 0; level < NumSourceMips; level++)
+            delete [] mips[level];
+      }
+
+      mLightMap = new U16[LightMapSize * LightMapSize];
+      for(U32 i = 0; i < LightMapSize * LightMapSize; i++)
+         mLightMap[i] = U16(0xFFFF - (i & 0x3DEF));
+
+      mBuffer = new U32[Blender::getBlendBufferSize()];
+      mBitmap = new GBitmap(TerrainTextureSize, TerrainTextureSize, true, GBitmap::RGB5551);
+      return true;
+   }
+
+   void run(U32 iterations)
+   {
+      U16 *mips[TerrainTextureMipLevel + 1];
+      for(U32 i = 0; i < mBitmap->getNumMipLevels(); i++)
+         mips[i] = (U16 *) mBitmap->getWritableBits(i);
+
+      for(U32 i = 0; i < iterations; i++)
+      {
+         // Levels 2 to 5, the squares per texture edge being 1 << level.
+         U32 level = 2 + (i & 3);
+         U32 step = 1 << level;
+         S32 x = ((i >> 2) * step) & TerrainBlock::BlockMask;
+         S32 y = ((i >> 8) * step) & TerrainBlock::BlockMask;
+         mBlender->blendThreadSafe(x, y, level, mLightMap, mips, mBuffer, mBlock);
+         consume(mips[0][0]);
+      }
+   }
+
+   void cleanup()
+   {
+      delete mBitmap;
+      delete [] mBuffer;
+      delete [] mLightMap;
+      delete mBlender;
+      delete mBlock;
+      mBitmap = NULL;
+      mBuffer = NULL;
+      mLightMap = NULL;
+      mBlender = NULL;
+      mBlock = NULL;
+      mFile = NULL;
+   }
+} sTerrainBlendBenchmark;
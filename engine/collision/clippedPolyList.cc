@@ -8,6 +8,7 @@
 #include "math/mMath.h"
 #include "console/console.h"
 #include "collision/clippedPolyList.h"
+#include "core/tVectorPool.h"
 
 
 bool ClippedPolyList::allowClipping = true;
@@ -23,12 +24,22 @@ ClippedPolyList::ClippedPolyList()
    VECTOR_SET_ASSOCIATION(mPolyPlaneList);
    VECTOR_SET_ASSOCIATION(mPlaneList);
 
+   // Reuse the storage of lists from earlier queries
+   VectorPool<Poly>::acquire(mPolyList);
+   VectorPool<Vertex>::acquire(mVertexList);
+   VectorPool<U32>::acquire(mIndexList);
+   VectorPool<PlaneF>::acquire(mPolyPlaneList);
+
    mNormal.set(0,0,0);
    mIndexList.reserve(100);
 }
 
 ClippedPolyList::~ClippedPolyList()
 {
+   VectorPool<Poly>::release(mPolyList);
+   VectorPool<Vertex>::release(mVertexList);
+   VectorPool<U32>::release(mIndexList);
+   VectorPool<PlaneF>::release(mPolyPlaneList);
 }
 
 
@@ -50,6 +50,7 @@ public:
    static bool allowClipping;
 
    typedef Vector<PlaneF> PlaneList;
+   typedef SmallVector<PlaneF, 8> ClipPlaneList;
    typedef Vector<Vertex> VertexList;
    typedef Vector<Poly> PolyList;
    typedef Vector<U32> IndexList;
@@ -61,8 +62,8 @@ public:
 
    PlaneList mPolyPlaneList;
 
-   // Data set by caller
-   PlaneList mPlaneList;
+   // Data set by caller, rarely more than the six sides of a box
+   ClipPlaneList mPlaneList;
    VectorF mNormal;
 
    //
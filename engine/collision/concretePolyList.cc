@@ -7,6 +7,7 @@
 #include "math/mMath.h"
 #include "console/console.h"
 #include "collision/concretePolyList.h"
+#include "core/tVectorPool.h"
 
 
 //----------------------------------------------------------------------------
@@ -18,12 +19,21 @@ ConcretePolyList::ConcretePolyList()
    VECTOR_SET_ASSOCIATION(mIndexList);
    VECTOR_SET_ASSOCIATION(mPolyPlaneList);
 
+   // Reuse the storage of lists from earlier queries
+   VectorPool<Poly>::acquire(mPolyList);
+   VectorPool<Point3F>::acquire(mVertexList);
+   VectorPool<U32>::acquire(mIndexList);
+   VectorPool<PlaneF>::acquire(mPolyPlaneList);
+
    mIndexList.reserve(100);
 }
 
 ConcretePolyList::~ConcretePolyList()
 {
-
+   VectorPool<Poly>::release(mPolyList);
+   VectorPool<Point3F>::release(mVertexList);
+   VectorPool<U32>::release(mIndexList);
+   VectorPool<PlaneF>::release(mPolyPlaneList);
 }
 
 
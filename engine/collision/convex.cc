@@ -11,6 +11,7 @@
 #include "terrain/terrData.h"
 #include "collision/convex.h"
 #include "collision/gjk.h"
+#include "platform/platformMutex.h"
 
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
@@ -44,6 +45,11 @@ CollisionState::~CollisionState()
       mListb->free();
 }
 
+void CollisionState::free()
+{
+   delete this;
+}
+
 void CollisionState::swap()
 {
 }
@@ -309,6 +315,8 @@ void CollisionWorkingList::free()
 //----------------------------------------------------------------------------
 
 U32 Convex::sTag = (U32)-1;
+bool Convex::smThreaded = false;
+void* Convex::smSharedMutex = NULL;
 
 //----------------------------------------------------------------------------
 
@@ -316,6 +324,11 @@ Convex::Convex()
 {
    mNext = mPrev = this;
    mTag = 0;
+
+   mStaticQueryBox.min.set(0, 0, 0);
+   mStaticQueryBox.max.set(0, 0, 0);
+   mStaticQueryMask = 0;
+   mStaticQueryKey = 0;
 }
 
 Convex::~Convex()
@@ -325,7 +338,7 @@ Convex::~Convex()
 
    // Delete collision states
    while (mList.mNext != &mList)
-      delete mList.mNext->mState;
+      mList.mNext->mState->free();
 
    // Free up working list
    while (mWorking.wLink.mNext != &mWorking)
@@ -446,10 +459,36 @@ void Convex::updateWorkingList(const Box3F& box, const U32 colMask)
 {
    sTag++;
 
+   AssertFatal(mObject->getContainer(), "Must be in a container!");
+   Container* container = mObject->getContainer();
+
+   // Terrain, interiors and static shapes are only looked for again when
+   // the box leaves the region they were found for.  The region is padded
+   // by half the box so a moving object keeps it for a while.
+   const U32 staticMask  = colMask & Container::csmStaticCollisionMask;
+   const U32 dynamicMask = colMask & ~Container::csmStaticCollisionMask;
+   bool updateStatic = staticMask != mStaticQueryMask ||
+                       container->getStaticChangeKey() != mStaticQueryKey ||
+                       !mStaticQueryBox.isContained(box);
+   if (updateStatic) {
+      Point3F pad = (box.max - box.min) * 0.5f;
+      mStaticQueryBox.min = box.min - pad;
+      mStaticQueryBox.max = box.max + pad;
+      mStaticQueryMask = staticMask;
+      mStaticQueryKey = container->getStaticChangeKey();
+   }
+
    // Clear objects off the working list that are no longer intersecting
    for (CollisionWorkingList* itr = mWorking.wLink.mNext; itr != &mWorking; itr = itr->wLink.mNext) {
-      itr->mConvex->mTag = sTag;
-      if ((!box.isOverlapped(itr->mConvex->getBoundingBox())) || (!itr->mConvex->getObject()->isCollisionEnabled())) {
+      Convex* cv = itr->mConvex;
+      cv->mTag = sTag;
+      bool cached = (cv->getObject()->getTypeMask() & mStaticQueryMask) != 0;
+      const Box3F& keepBox = cached ? mStaticQueryBox : box;
+      if ((!keepBox.isOverlapped(cv->getBoundingBox())) || (!cv->getObject()->isCollisionEnabled())) {
+         // a static object with collision turned off needs finding again
+         if (cached && !cv->getObject()->isCollisionEnabled())
+            mStaticQueryMask = 0;
+
          CollisionWorkingList* cl = itr;
          itr = itr->wLink.mPrev;
          cl->free();
@@ -457,12 +496,19 @@ void Convex::updateWorkingList(const Box3F& box, const U32 colMask)
    }
 
    // Special processing for the terrain and interiors...
-   AssertFatal(mObject->getContainer(), "Must be in a container!");
-
    SimpleQueryList sql;
-   mObject->getContainer()->findObjects(box, colMask,SimpleQueryList::insertionCallback, &sql);
-   for (U32 i = 0; i < sql.mList.size(); i++)
-      sql.mList[i]->buildConvex(box, this);
+   if (updateStatic && staticMask) {
+      container->findObjects(mStaticQueryBox, staticMask, SimpleQueryList::insertionCallback, &sql);
+      for (U32 i = 0; i < sql.mList.size(); i++)
+         sql.mList[i]->buildConvex(mStaticQueryBox, this);
+      sql.mList.clear();
+   }
+
+   if (dynamicMask) {
+      container->findObjects(box, dynamicMask, SimpleQueryList::insertionCallback, &sql);
+      for (U32 i = 0; i < sql.mList.size(); i++)
+         sql.mList[i]->buildConvex(box, this);
+   }
 }
 
 // ---------------------------------------------------------------------------
@@ -481,6 +527,7 @@ void Convex::updateStateList(const MatrixF& mat, const Point3F& scale, const Poi
       box1.max.setMax(oldMin + *displacement);
       box1.max.setMax(oldMax + *displacement);
    }
+   lockShared();
    sTag++;
 
    // Destroy states which are no longer intersecting
@@ -490,7 +537,7 @@ void Convex::updateStateList(const MatrixF& mat, const Point3F& scale, const Poi
       if (!box1.isOverlapped(cv->getBoundingBox())) {
          CollisionState* cs = itr->mState;
          itr = itr->mPrev;
-         delete cs;
+         cs->free();
       }
    }
 
@@ -498,12 +545,13 @@ void Convex::updateStateList(const MatrixF& mat, const Point3F& scale, const Poi
    for (CollisionWorkingList* itr0 = mWorking.wLink.mNext; itr0 != &mWorking; itr0 = itr0->wLink.mNext) {
       register Convex* cv = itr0->mConvex;
       if (cv->mTag != sTag && box1.isOverlapped(cv->getBoundingBox())) {
-         CollisionState* state = new GjkCollisionState;
+         CollisionState* state = GjkCollisionState::alloc();
          state->set(this,cv,mat,cv->getTransform());
          state->mLista->linkAfter(&mList);
          state->mListb->linkAfter(&cv->mList);
       }
    }
+   unlockShared();
 }
 
 
@@ -595,6 +643,29 @@ void Convex::getPolyList(AbstractPolyList*)
 }
 
 
+//----------------------------------------------------------------------------
+
+void Convex::setThreaded(bool threaded)
+{
+   // Set and cleared from the main thread, with no steps running
+   if (threaded && !smSharedMutex)
+      smSharedMutex = Mutex::createMutex();
+   smThreaded = threaded;
+}
+
+void Convex::lockShared()
+{
+   if (smThreaded)
+      Mutex::lockMutex(smSharedMutex);
+}
+
+void Convex::unlockShared()
+{
+   if (smThreaded)
+      Mutex::unlockMutex(smSharedMutex);
+}
+
+
 //-----------------------------------------------------------------------------
 // This function based on code orignally written for the book:
 // 3D Game Engine Design, by David H. Eberly
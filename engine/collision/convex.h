@@ -81,6 +81,11 @@ struct CollisionState
    //
    CollisionState();
    virtual ~CollisionState();
+
+   /// Unlinks the state and releases it; states may be pooled, so use this
+   /// rather than delete.
+   virtual void free();
+
    virtual void swap();
    virtual void set(Convex* a,Convex* b,const MatrixF& a2w, const MatrixF& b2w);
    virtual F32 distance(const MatrixF& a2w, const MatrixF& b2w, const F32 dontCareDist,
@@ -154,6 +159,19 @@ class Convex {
    U32 mTag;
    static U32 sTag;
 
+   static bool  smThreaded;
+   static void* smSharedMutex;
+
+   /// @name Static object cache
+   /// updateWorkingList() looks for the static types over a region larger
+   /// than it was asked for, and only looks again once asked for something
+   /// outside it or the container's static objects change.
+   /// @{
+   Box3F mStaticQueryBox;     ///< Region the static convexes were built for
+   U32   mStaticQueryMask;    ///< Static types looked for, 0 if nothing is cached
+   U32   mStaticQueryKey;     ///< Container::getStaticChangeKey() when they were
+   /// @}
+
 protected:
    CollisionStateList   mList;            ///< Objects we're testing against
    CollisionWorkingList mWorking;         ///< Objects within our bounds
@@ -212,6 +230,10 @@ public:
    /// Updates the working collision list of objects which are currently colliding with
    /// (inside the bounds of) this Convex.
    ///
+   /// The static types in colMask (Container::csmStaticCollisionMask) are
+   /// only queried when box leaves the region last queried for them, so the
+   /// list may hold static convexes somewhat outside box.
+   ///
    /// @param  box      Used as the bounding box.
    /// @param  colMask  Mask of objects to check against.
    void updateWorkingList(const Box3F& box, const U32 colMask);
@@ -244,6 +266,18 @@ public:
 
    ///
    bool getCollisionInfo(const MatrixF& mat, const Point3F& scale, CollisionList* cList,F32 tol);
+
+   /// @name Threaded physics
+   /// While ProcessList steps physics on the thread pool, the state lists,
+   /// which link the convexes of different objects, are only changed under
+   /// a lock.  Container queries made from a step go under the same lock,
+   /// through lockShared() and unlockShared(), which do nothing otherwise.
+   /// @{
+   static void setThreaded(bool threaded);
+   static bool isThreaded() { return smThreaded; }
+   static void lockShared();
+   static void unlockShared();
+   /// @}
 };
 
 #endif
@@ -190,8 +190,9 @@ void ConvexBrush::setupTransform()
    invTrans.inverse();
 
    // Untransform our verts
-   for (U32 i = 0; i < mFaces.mVertexList.size(); i++)
-      invTrans.mulP(mFaces.mVertexList[i]);
+   if (mFaces.mVertexList.size())
+      m_matF_x_point3F_array(invTrans, mFaces.mVertexList[0], mFaces.mVertexList[0],
+                             mFaces.mVertexList.size(), sizeof(Point3F));
 
    // Untransform our bounds
    invTrans.mulP(mBounds.min);
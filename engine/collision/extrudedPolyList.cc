@@ -11,6 +11,13 @@
 #include "collision/polyhedron.h"
 #include "collision/collision.h"
 
+// The plane tests only need SSE1 float ops, so they're built wherever the
+// compiler knows about SSE and used when the CPU reports it.
+#if defined(TORQUE_CPU_X86) && (defined(TORQUE_COMPILER_VISUALC) || defined(__SSE__))
+#  define EXTRUDED_POLY_LIST_USE_SSE
+#  include <xmmintrin.h>
+#endif
+
 // Minimum distance from a face
 F32 ExtrudedPolyList::FaceEpsilon = 0.01f;
 
@@ -25,13 +32,13 @@ ExtrudedPolyList::ExtrudedPolyList()
    VECTOR_SET_ASSOCIATION(mExtrudedList);
    VECTOR_SET_ASSOCIATION(mPlaneList);
    VECTOR_SET_ASSOCIATION(mPolyPlaneList);
+   VECTOR_SET_ASSOCIATION(mPolyPlaneFacingAway);
+   VECTOR_SET_ASSOCIATION(mPlaneGroups);
 
    mVelocity.set(0.0f,0.0f,0.0f);
-   mIndexList.reserve(128);
-   mVertexList.reserve(64);
-   mPolyPlaneList.reserve(64);
-   mPlaneList.reserve(64);
+   mNormalVelocity.set(0.0f,0.0f,0.0f);
    mCollisionList = 0;
+   mUseSSE = false;
 }
 
 ExtrudedPolyList::~ExtrudedPolyList()
@@ -55,6 +62,7 @@ void ExtrudedPolyList::extrude(const Polyhedron& pt, const VectorF& vector)
    mVertexList.clear();
    mPlaneList.clear();
    mPolyPlaneList.clear();
+   mPolyPlaneFacingAway.clear();
 
    // Determine which faces will be extruded.
    mExtrudedList.setSize(pt.planeList.size());
@@ -106,6 +114,79 @@ void ExtrudedPolyList::extrude(const Polyhedron& pt, const VectorF& vector)
          ef2.planeMask |= pmask << 1;
       }
    }
+   AssertFatal(mPlaneList.size() <= 32, "ExtrudedPolyList::extrude: too many planes for the vertex masks");
+
+   // Regroup the planes for getPlaneMask().  Padding planes are a unit
+   // behind everything.
+   U32 numGroups = (mPlaneList.size() + 3) >> 2;
+   mPlaneGroups.setSize(numGroups * 16);
+   for (U32 g = 0; g < numGroups; g++)
+   {
+      F32* group = &mPlaneGroups[g * 16];
+      for (U32 k = 0; k < 4; k++)
+      {
+         U32 p = g * 4 + k;
+         if (p < mPlaneList.size())
+         {
+            group[k]      = mPlaneList[p].x;
+            group[4 + k]  = mPlaneList[p].y;
+            group[8 + k]  = mPlaneList[p].z;
+            group[12 + k] = mPlaneList[p].d;
+         }
+         else
+         {
+            group[k] = group[4 + k] = group[8 + k] = 0.0f;
+            group[12 + k] = -1.0f;
+         }
+      }
+   }
+
+#if defined(EXTRUDED_POLY_LIST_USE_SSE)
+   mUseSSE = (Platform::SystemInfo.processor.properties & CPU_PROP_SSE) != 0;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+
+U32 ExtrudedPolyList::getPlaneMask(const Point3F& p, U32 firstPlane, bool strict)
+{
+   if (firstPlane >= mPlaneList.size())
+      return 0;
+
+   U32 mask = 0;
+#if defined(EXTRUDED_POLY_LIST_USE_SSE)
+   if (mUseSSE)
+   {
+      // Four planes per compare, with the same sums in the same order
+      // as PlaneF::distToPlane()
+      const __m128 px = _mm_set1_ps(p.x);
+      const __m128 py = _mm_set1_ps(p.y);
+      const __m128 pz = _mm_set1_ps(p.z);
+      const __m128 zero = _mm_setzero_ps();
+      U32 numGroups = mPlaneGroups.size() >> 4;
+      for (U32 g = firstPlane >> 2; g < numGroups; g++)
+      {
+         const F32* group = &mPlaneGroups[g * 16];
+         __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+                          _mm_mul_ps(_mm_loadu_ps(group), px),
+                          _mm_mul_ps(_mm_loadu_ps(group + 4), py)),
+                          _mm_mul_ps(_mm_loadu_ps(group + 8), pz)),
+                          _mm_loadu_ps(group + 12));
+         __m128 front = strict ? _mm_cmpgt_ps(dist, zero) : _mm_cmpge_ps(dist, zero);
+         mask |= U32(_mm_movemask_ps(front)) << (g * 4);
+      }
+      return mask & ~(BIT(firstPlane) - 1);
+   }
+#endif
+
+   for (U32 i = firstPlane; i < mPlaneList.size(); i++)
+   {
+      F32 dist = mPlaneList[i].distToPlane(p);
+      if (strict ? dist > 0.f : dist >= 0.f)
+         mask |= BIT(i);
+   }
+   return mask;
 }
 
 
@@ -142,10 +223,7 @@ U32 ExtrudedPolyList::addPoint(const Point3F& p)
    mMatrix.mulP(v.point);
 
    // Build the plane mask, planes come in pairs
-   v.mask = 0;
-   for (U32 i = 0; i < mPlaneList.size(); i ++)
-      if (mPlaneList[i].distToPlane(v.point) >= 0.f)
-         v.mask |= BIT(i);
+   v.mask = getPlaneMask(v.point, 0, false);
 
    return mVertexList.size() - 1;
 }
@@ -156,6 +234,9 @@ U32 ExtrudedPolyList::addPlane(const PlaneF& plane)
    mPolyPlaneList.increment();
    mPlaneTransformer.transform(plane, mPolyPlaneList.last());
 
+   // Polys often share planes, so their back face test is done once here
+   mPolyPlaneFacingAway.push_back(mDot(mPolyPlaneList.last(), mNormalVelocity) > 0.f);
+
    return mPolyPlaneList.size() - 1;
 }
 
@@ -177,17 +258,20 @@ void ExtrudedPolyList::plane(U32 v1, U32 v2, U32 v3)
                    
    // We hope this isn't needed but we're leaving it in anyway -- BJG/EGH
    mPoly.plane.normalizeSafe();
+   mPoly.facingAway = mDot(mPoly.plane, mNormalVelocity) > 0.f;
 }
 
 void ExtrudedPolyList::plane(const PlaneF& p)
 {
    mPlaneTransformer.transform(p, mPoly.plane);
+   mPoly.facingAway = mDot(mPoly.plane, mNormalVelocity) > 0.f;
 }
 
 void ExtrudedPolyList::plane(const U32 index)
 {
    AssertFatal(index < mPolyPlaneList.size(), "Out of bounds index!");
    mPoly.plane = mPolyPlaneList[index];
+   mPoly.facingAway = mPolyPlaneFacingAway[index];
 }
 
 const PlaneF& ExtrudedPolyList::getIndexedPlane(const U32 index)
@@ -206,10 +290,19 @@ void ExtrudedPolyList::end()
 {
    // Anything facing away from the mVelocity is rejected  (and also
    // cap to max collisions)
-   if (mDot(mPoly.plane, mNormalVelocity) > 0.f ||
+   if (mPoly.facingAway ||
       mCollisionList->count >= CollisionList::MaxCollisions)
       return;
 
+   // The vertex masks are combined once here rather than for every face
+   U32 andMask = ~0, orMask = 0;
+   for (U32 i = 0; i < mIndexList.size(); i++)
+   {
+      U32 mask = mVertexList[mIndexList[i]].mask;
+      andMask &= mask;
+      orMask |= mask;
+   }
+
    // Test the built up poly (stored in mPoly) against all our extruded
    // faces.
    U32           cFaceCount = 0;
@@ -232,7 +325,7 @@ void ExtrudedPolyList::end()
          continue;
 
       // Test, and skip if colliding.
-      if (!testPoly(*face))
+      if (!testPoly(*face, andMask, orMask))
          continue;
  
       // Note collision.
@@ -256,7 +349,7 @@ void ExtrudedPolyList::end()
             continue;
 
          // Do collision as above.
-         if (!testPoly(*face))
+         if (!testPoly(*face, andMask, orMask))
             continue;
 
          // Note the collision.
@@ -317,7 +410,7 @@ void ExtrudedPolyList::end()
 
 //----------------------------------------------------------------------------
 
-bool ExtrudedPolyList::testPoly(ExtrudedFace& face)
+bool ExtrudedPolyList::testPoly(ExtrudedFace& face, U32 andMask, U32 orMask)
 {
    // Build intial inside/outside plane masks
    U32 indexStart = 0;
@@ -325,13 +418,9 @@ bool ExtrudedPolyList::testPoly(ExtrudedFace& face)
    U32 oVertexSize = mVertexList.size();
    U32 oIndexSize = mIndexList.size();
 
-   U32 frontMask = 0,backMask = 0;
-   for (U32 i = indexStart; i < indexEnd; i++) 
-   {
-      U32 mask = mVertexList[mIndexList[i]].mask & face.planeMask;
-      frontMask |= mask;
-      backMask |= ~mask;
-   }
+   // Planes some vertex is in front of, and planes some vertex is not
+   U32 frontMask = orMask & face.planeMask;
+   U32 backMask = ~andMask;
 
    // Clip the mPoly against the planes that bound the face...
    // Trivial accept if all the vertices are on the backsides of
@@ -375,14 +464,8 @@ bool ExtrudedPolyList::testPoly(ExtrudedFace& face)
                iv.point.x = v1.x + vv.x * t;
                iv.point.y = v1.y + vv.y * t;
                iv.point.z = v1.z + vv.z * t;
-               iv.mask = 0;
-
                // Test against the remaining planes
-               for (U32 i = p+1; i < mPlaneList.size(); i ++)
-               {
-                  if (mPlaneList[i].distToPlane(iv.point) > 0.f)
-                     iv.mask |= BIT(i);
-               }
+               iv.mask = getPlaneMask(iv.point, p + 1, true);
             }
 
             if (!(mask2 & pmask)) 
@@ -39,6 +39,7 @@ public:
       PlaneF plane;
       SceneObject* object;
       U32 material;
+      bool facingAway;     ///< Plane faces along the sweep, nothing to hit
    };
 
    struct ExtrudedFace {
@@ -53,10 +54,13 @@ public:
       F32 height;
    };
 
-   typedef Vector<ExtrudedFace> ExtrudedList;
-   typedef Vector<PlaneF> PlaneList;
-   typedef Vector<Vertex> VertexList;
-   typedef Vector<U32> IndexList;
+   // Sized for the working set of a typical sweep, which then never
+   // touches the heap.  The vertex masks limit mPlaneList to 32 planes.
+   typedef SmallVector<ExtrudedFace, 16> ExtrudedList;
+   typedef SmallVector<PlaneF, 32> PlaneList;
+   typedef SmallVector<Vertex, 64> VertexList;
+   typedef SmallVector<U32, 128> IndexList;
+   typedef SmallVector<PlaneF, 64> PolyPlaneList;
 
    static F32 EqualEpsilon;
    static F32 FaceEpsilon;
@@ -74,11 +78,21 @@ public:
    // Returned info
    CollisionList* mCollisionList;
 
-   PlaneList mPolyPlaneList;
+   PolyPlaneList mPolyPlaneList;
+   SmallVector<bool, 64> mPolyPlaneFacingAway;  ///< Poly::facingAway for each of mPolyPlaneList
+
+   /// mPlaneList again, four planes at a time as x[4] y[4] z[4] d[4], padded
+   /// out with planes nothing is in front of.
+   SmallVector<F32, 128> mPlaneGroups;
+   bool         mUseSSE;
 
    //
 private:
-   bool testPoly(ExtrudedFace&);
+   /// Mask of the planes from firstPlane on that p is in front of; on the
+   /// plane counts as in front unless strict.
+   U32  getPlaneMask(const Point3F& p, U32 firstPlane, bool strict);
+   /// andMask and orMask are the poly's vertex masks and'ed and or'ed together.
+   bool testPoly(ExtrudedFace&, U32 andMask, U32 orMask);
 
 public:
    ExtrudedPolyList();
@@ -27,6 +27,8 @@ static U32 sIteration = 15;     // Stuck in a loop?
 S32 num_iterations = 0;
 S32 num_irregularities = 0;
 
+static FreeListChunker<GjkCollisionState> sStateChunker;
+
 
 //----------------------------------------------------------------------------
 
@@ -39,6 +41,17 @@ GjkCollisionState::~GjkCollisionState()
 {
 }
 
+GjkCollisionState* GjkCollisionState::alloc()
+{
+   return constructInPlace(sStateChunker.alloc());
+}
+
+void GjkCollisionState::free()
+{
+   destructInPlace(this);
+   sStateChunker.free(this);
+}
+
 
 //----------------------------------------------------------------------------
 
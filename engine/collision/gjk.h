@@ -52,6 +52,11 @@ struct GjkCollisionState: public CollisionState
    GjkCollisionState();
    ~GjkCollisionState();
 
+   /// States come and go as the working lists change, so they're kept on
+   /// a free list instead of going through the allocator each time.
+   static GjkCollisionState* alloc();
+   void free();
+
    void set(Convex* a,Convex* b,const MatrixF& a2w, const MatrixF& b2w);
 
    void getCollisionInfo(const MatrixF& mat, Collision* info);
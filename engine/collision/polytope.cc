@@ -8,6 +8,7 @@
 #include "math/mMath.h"
 #include "collision/collision.h"
 #include "collision/polytope.h"
+#include "core/tVectorPool.h"
 
 //----------------------------------------------------------------------------
 
@@ -18,6 +19,12 @@ Polytope::Polytope()
    VECTOR_SET_ASSOCIATION(mVertexList);
    VECTOR_SET_ASSOCIATION(mVolumeList);
 
+   // Reuse the storage of polytopes from earlier queries
+   VectorPool<Edge>::acquire(mEdgeList);
+   VectorPool<Face>::acquire(mFaceList);
+   VectorPool<Vertex>::acquire(mVertexList);
+   VectorPool<Volume>::acquire(mVolumeList);
+
    mVertexList.reserve(100);
    mFaceList.reserve(200);
    mEdgeList.reserve(100);
@@ -25,6 +32,14 @@ Polytope::Polytope()
    sideCount = 0;
 }
 
+Polytope::~Polytope()
+{
+   VectorPool<Edge>::release(mEdgeList);
+   VectorPool<Face>::release(mFaceList);
+   VectorPool<Vertex>::release(mVertexList);
+   VectorPool<Volume>::release(mVolumeList);
+}
+
 
 //----------------------------------------------------------------------------
 // Box should be axis aligned in the transform space provided.
@@ -120,6 +135,7 @@ void Polytope::intersect(SimObject* object,const BSPNode* root)
 
    // Always clips the first volume against the BSP
    VolumeStack stack;
+   VectorPool<StackElement>::acquire(stack);
    stack.reserve(50);
    stack.increment();
    stack.last().edgeList = mVolumeList[0].edgeList;
@@ -239,6 +255,7 @@ void Polytope::intersect(SimObject* object,const BSPNode* root)
          stack.push_back(backVolume);
       }
    }
+   VectorPool<StackElement>::release(stack);
 }
 
 
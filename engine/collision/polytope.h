@@ -82,6 +82,7 @@ private:
 public:
    //
    Polytope();
+   ~Polytope();
    void buildBox(const MatrixF& transform,const Box3F& box);
    void intersect(SimObject*, const BSPNode* node);
    inline bool didIntersect()  { return mVolumeList.size() > 1; }
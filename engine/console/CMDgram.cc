@@ -1004,12 +1004,13 @@ while (0)
 #endif /* not YYLSP_NEEDED */
 #endif
 
-/* If nonreentrant, generate the variables here */
+/* If nonreentrant, generate the variables here.  They're thread local so
+   the script compiler can run on several threads at once. */
 
 #ifndef YYPURE
 
-int	yychar;			/*  the lookahead symbol		*/
-YYSTYPE	yylval;			/*  the semantic value of the		*/
+TORQUE_THREAD_LOCAL int	yychar;			/*  the lookahead symbol		*/
+TORQUE_THREAD_LOCAL YYSTYPE	yylval;			/*  the semantic value of the		*/
 				/*  lookahead symbol			*/
 
 #ifdef YYLSP_NEEDED
@@ -1017,11 +1018,11 @@ YYLTYPE yylloc;			/*  location data for the lookahead	*/
 				/*  symbol				*/
 #endif
 
-int yynerrs;			/*  number of parse errors so far       */
+TORQUE_THREAD_LOCAL int yynerrs;			/*  number of parse errors so far       */
 #endif  /* not YYPURE */
 
 #if YYDEBUG != 0
-int yydebug;			/*  nonzero means print parse trace	*/
+TORQUE_THREAD_LOCAL int yydebug;			/*  nonzero means print parse trace	*/
 /* Since this is uninitialized, it does not stop multiple parsers
    from coexisting.  */
 #endif
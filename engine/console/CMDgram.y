@@ -27,6 +27,10 @@ void CMDerror(char *, ...);
 
 #define alloca dMalloc
 
+// compileAll() runs the parser on several threads, so after regenerating
+// CMDgram.cc mark the skeleton's yychar, yylval, yynerrs and yydebug
+// TORQUE_THREAD_LOCAL by hand, along with CMDlval in cmdgram.h.
+
 %}
 %{
         /* Reserved Word Definitions */
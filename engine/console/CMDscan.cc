@@ -28,6 +28,8 @@
 #define YY_FLEX_MINOR_VERSION 5
 
 #include <stdio.h>
+// For TORQUE_THREAD_LOCAL on the flex statics below.
+#include "platform/platform.h"
 
 
 /* cfront 1.2 defines "c_plusplus" instead of "__cplusplus" */
@@ -117,8 +119,8 @@
 
 typedef struct yy_buffer_state *YY_BUFFER_STATE;
 
-extern int yyleng;
-extern FILE *yyin, *yyout;
+extern TORQUE_THREAD_LOCAL int yyleng;
+extern TORQUE_THREAD_LOCAL FILE *yyin, *yyout;
 
 #define EOB_ACT_CONTINUE_SCAN 0
 #define EOB_ACT_END_OF_FILE 1
@@ -216,7 +218,7 @@ struct yy_buffer_state
 #define YY_BUFFER_EOF_PENDING 2
 	};
 
-static YY_BUFFER_STATE yy_current_buffer = 0;
+static TORQUE_THREAD_LOCAL YY_BUFFER_STATE yy_current_buffer = 0;
 
 /* We provide macros for accessing buffer states in case in the
  * future we want to put the buffer states in a more general
@@ -226,22 +228,22 @@ static YY_BUFFER_STATE yy_current_buffer = 0;
 
 
 /* yy_hold_char holds the character lost when yytext is formed. */
-static char yy_hold_char;
+static TORQUE_THREAD_LOCAL char yy_hold_char;
 
-static int yy_n_chars;		/* number of characters read into yy_ch_buf */
+static TORQUE_THREAD_LOCAL int yy_n_chars;		/* number of characters read into yy_ch_buf */
 
 
-int yyleng;
+TORQUE_THREAD_LOCAL int yyleng;
 
 /* Points to current character in buffer. */
-static char *yy_c_buf_p = (char *) 0;
-static int yy_init = 1;		/* whether we need to initialize */
-static int yy_start = 0;	/* start state number */
+static TORQUE_THREAD_LOCAL char *yy_c_buf_p = (char *) 0;
+static TORQUE_THREAD_LOCAL int yy_init = 1;		/* whether we need to initialize */
+static TORQUE_THREAD_LOCAL int yy_start = 0;	/* start state number */
 
 /* Flag which is used to allow yywrap()'s to do buffer switches
  * instead of setting up a fresh yyin.  A bit of a hack ...
  */
-static int yy_did_buffer_switch_on_eof;
+static TORQUE_THREAD_LOCAL int yy_did_buffer_switch_on_eof;
 
 void yyrestart YY_PROTO(( FILE *input_file ));
 
@@ -280,9 +282,9 @@ static void yy_flex_free YY_PROTO(( void * ));
 #define YY_AT_BOL() (yy_current_buffer->yy_at_bol)
 
 typedef unsigned char YY_CHAR;
-FILE *yyin = (FILE *) 0, *yyout = (FILE *) 0;
+TORQUE_THREAD_LOCAL FILE *yyin = (FILE *) 0, *yyout = (FILE *) 0;
 typedef int yy_state_type;
-extern char *yytext;
+extern TORQUE_THREAD_LOCAL char *yytext;
 #define yytext_ptr yytext
 
 static yy_state_type yy_get_previous_state YY_PROTO(( void ));
@@ -511,8 +513,8 @@ static yyconst short int yy_chk[356] =
       197,  197,  197,  197,  197
     } ;
 
-static yy_state_type yy_last_accepting_state;
-static char *yy_last_accepting_cpos;
+static TORQUE_THREAD_LOCAL yy_state_type yy_last_accepting_state;
+static TORQUE_THREAD_LOCAL char *yy_last_accepting_cpos;
 
 /* The intent behind this definition is that it'll catch
  * any uses of REJECT which flex missed.
@@ -520,7 +522,7 @@ static char *yy_last_accepting_cpos;
 #define REJECT reject_used_but_not_detected
 #define yymore() yymore_used_but_not_detected
 #define YY_MORE_ADJ 0
-char *yytext;
+TORQUE_THREAD_LOCAL char *yytext;
 #line 1 "c:\\Cvs\\Tge\\engine\\console\\CMDscan.l"
 #define INITIAL 0
 #line 2 "c:\\Cvs\\Tge\\engine\\console\\CMDscan.l"
@@ -570,8 +572,10 @@ inline int isatty(int) { return 0; }
       result = n; \
    }
 
-// General helper stuff.
-static int lineIndex;
+// General helper stuff.  All of the scanner's state is per thread, so
+// compileAll() can compile scripts in parallel; the flex generated
+// statics above are marked by hand.
+static TORQUE_THREAD_LOCAL int lineIndex;
 
 // File state
 void CMDSetScanBuffer(const char *sb, const char *fn);
@@ -614,9 +618,9 @@ static int input YY_PROTO(( void ));
 #endif
 
 #if YY_STACK_USED
-static int yy_start_stack_ptr = 0;
-static int yy_start_stack_depth = 0;
-static int *yy_start_stack = 0;
+static TORQUE_THREAD_LOCAL int yy_start_stack_ptr = 0;
+static TORQUE_THREAD_LOCAL int yy_start_stack_depth = 0;
+static TORQUE_THREAD_LOCAL int *yy_start_stack = 0;
 #ifndef YY_NO_PUSH_STATE
 static void yy_push_state YY_PROTO(( int new_state ));
 #endif
@@ -2062,10 +2066,10 @@ int main()
 #line 187 "c:\\Cvs\\Tge\\engine\\console\\CMDscan.l"
 
 
-static const char *scanBuffer;
-static const char *fileName;
-static int scanIndex;
-static int fakeLineIndex;
+static TORQUE_THREAD_LOCAL const char *scanBuffer;
+static TORQUE_THREAD_LOCAL const char *fileName;
+static TORQUE_THREAD_LOCAL int scanIndex;
+static TORQUE_THREAD_LOCAL int fakeLineIndex;
 
  
 const char * CMDGetCurrentFile()
@@ -2078,12 +2082,14 @@ int CMDGetCurrentLine()
    return lineIndex;
 }
 
-extern bool Compiler::gSyntaxError;
-
 void CMDerror(char *format, ...)
 {
    Compiler::gSyntaxError = true;
 
+   // A compile off the main thread is redone on it to report the error.
+   if(Con::isThreadQuiet())
+      return;
+
    const int BUFMAX = 1024;
    char tempBuf[BUFMAX];
    va_list args;   
@@ -450,7 +450,7 @@ struct FunctionDeclStmtNode : StmtNode
    void setPackage(StringTableEntry packageName);
 };
 
-extern StmtNode *statementList;
+extern TORQUE_THREAD_LOCAL StmtNode *statementList;
 extern void createFunction(const char *fnName, VarNode *args, StmtNode *statements);
 extern ExprEvalState gEvalState;
 extern bool lookupFunction(const char *fnName, VarNode **args, StmtNode **statements);
@@ -786,6 +786,50 @@ U32 VarNode::compile(U32 *codeStream, U32 ip, TypeReq type)
    if(type == TypeReqNone)
       return ip;
 
+   // plain locals go through the frame's slot cache, same size as the
+   // OP_SETCURVAR/OP_LOADVAR pair
+   S32 slot = (!arrayIndex && CodeBlock::smInFunction && varName[0] == '%') ? getLocalSlot(varName) : -1;
+   if(slot >= 0)
+   {
+      switch(type)
+      {
+      case TypeReqUInt:
+         codeStream[ip++] = OP_LOADLOCAL_UINT;
+         break;
+      case TypeReqFloat:
+         codeStream[ip++] = OP_LOADLOCAL_FLT;
+         break;
+      case TypeReqString:
+         codeStream[ip++] = OP_LOADLOCAL_STR;
+         break;
+      }
+      codeStream[ip] = STEtoU32(varName, ip);
+      ip++;
+      codeStream[ip++] = slot;
+      return ip;
+   }
+
+   // plain globals resolve once per site, see CodeBlock::globalCache
+   if(!arrayIndex && varName[0] == '$')
+   {
+      switch(type)
+      {
+      case TypeReqUInt:
+         codeStream[ip++] = OP_LOADGLOBAL_UINT;
+         break;
+      case TypeReqFloat:
+         codeStream[ip++] = OP_LOADGLOBAL_FLT;
+         break;
+      case TypeReqString:
+         codeStream[ip++] = OP_LOADGLOBAL_STR;
+         break;
+      }
+      codeStream[ip] = STEtoU32(varName, ip);
+      ip++;
+      codeStream[ip++] = 0;
+      return ip;
+   }
+
    codeStream[ip++] = arrayIndex ? OP_LOADIMMED_IDENT : OP_SETCURVAR;
    codeStream[ip] = STEtoU32(varName, ip);
    ip++;
@@ -1025,6 +1069,49 @@ U32 AssignExprNode::precompile(TypeReq type)
 U32 AssignExprNode::compile(U32 *codeStream, U32 ip, TypeReq type)
 {
    ip = expr->compile(codeStream, ip, subType);
+   S32 slot = (!arrayIndex && CodeBlock::smInFunction && varName[0] == '%') ? getLocalSlot(varName) : -1;
+   if(slot >= 0)
+   {
+      switch(subType)
+      {
+      case TypeReqString:
+         codeStream[ip++] = OP_SAVELOCAL_STR;
+         break;
+      case TypeReqUInt:
+         codeStream[ip++] = OP_SAVELOCAL_UINT;
+         break;
+      case TypeReqFloat:
+         codeStream[ip++] = OP_SAVELOCAL_FLT;
+         break;
+      }
+      codeStream[ip] = STEtoU32(varName, ip);
+      ip++;
+      codeStream[ip++] = slot;
+      if(type != subType)
+         codeStream[ip++] = conversionOp(subType, type);
+      return ip;
+   }
+   if(!arrayIndex && varName[0] == '$')
+   {
+      switch(subType)
+      {
+      case TypeReqString:
+         codeStream[ip++] = OP_SAVEGLOBAL_STR;
+         break;
+      case TypeReqUInt:
+         codeStream[ip++] = OP_SAVEGLOBAL_UINT;
+         break;
+      case TypeReqFloat:
+         codeStream[ip++] = OP_SAVEGLOBAL_FLT;
+         break;
+      }
+      codeStream[ip] = STEtoU32(varName, ip);
+      ip++;
+      codeStream[ip++] = 0;
+      if(type != subType)
+         codeStream[ip++] = conversionOp(subType, type);
+      return ip;
+   }
    if(arrayIndex)
    {
       if(subType == TypeReqString)
@@ -1668,6 +1755,7 @@ U32 FunctionDeclStmtNode::compileStmt(U32 *codeStream, U32 ip, U32, U32)
       ip++;
    }
    CodeBlock::smInFunction = true;
+   resetLocalSlots();
    ip = compileBlock(stmts, codeStream, ip, 0, 0);
 
    #ifdef TORQUE_EXTRA_BREAKLINES      
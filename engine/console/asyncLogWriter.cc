@@ -0,0 +1,267 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "console/asyncLogWriter.h"
+#include "console/console.h"
+#include "console/consoleTypes.h"
+#include "platform/platformAtomic.h"
+
+AsyncLogWriter *AsyncLogWriter::smThread = NULL;
+MPSCQueue<AsyncLogWriter::Record*, AsyncLogWriter::QueueSize> AsyncLogWriter::smQueue;
+AsyncLogWriter::File AsyncLogWriter::smFiles[AsyncLogWriter::MaxFiles];
+volatile U32 AsyncLogWriter::smFileUsed[AsyncLogWriter::MaxFiles];
+
+volatile U32 AsyncLogWriter::smQueuedBytes = 0;
+volatile U32 AsyncLogWriter::smQueued = 0;
+volatile U32 AsyncLogWriter::smDone = 0;
+volatile U32 AsyncLogWriter::smDropped = 0;
+volatile U32 AsyncLogWriter::smWritten = 0;
+S32          AsyncLogWriter::smQueueKB = 1024;
+
+AsyncLogWriter::AsyncLogWriter() : Thread(0, 0, false)
+{
+   mStopping = false;
+}
+
+//--------------------------------------------------------------------------
+
+void AsyncLogWriter::create()
+{
+   Con::addVariable("Con::logQueueKB", TypeS32, &smQueueKB);
+   Con::addVariable("Con::logLinesWritten", TypeS32, (void *) &smWritten);
+   Con::addVariable("Con::logLinesDropped", TypeS32, (void *) &smDropped);
+
+#ifdef TORQUE_MULTITHREAD
+   if(smThread)
+      return;
+
+   smThread = new AsyncLogWriter;
+   smThread->start();
+#endif
+}
+
+void AsyncLogWriter::destroy()
+{
+   if(!smThread)
+      return;
+
+   // Stops after writing what's left; the files stay open, and anything
+   // logged from here on is written in place.
+   smThread->mStopping = true;
+   smThread->join();
+   delete smThread;
+   smThread = NULL;
+}
+
+//--------------------------------------------------------------------------
+
+AsyncLogWriter::Record *AsyncLogWriter::allocRecord(U32 op, S32 file, U32 mode, U32 size)
+{
+   Record *rec = (Record *) dMalloc(sizeof(Record) + size + 1);
+   rec->op   = op;
+   rec->file = file;
+   rec->mode = mode;
+   rec->size = size;
+   rec->getData()[size] = 0;
+   return rec;
+}
+
+void AsyncLogWriter::queue(Record *rec, bool canDrop)
+{
+   if(!smThread)
+   {
+      process(rec);
+      endBatch();
+      return;
+   }
+
+   U32 bytes = sizeof(Record) + rec->size;
+   U32 queuedBytes = dFetchAndAdd(smQueuedBytes, bytes);
+   if(canDrop)
+   {
+      if(queuedBytes + bytes > U32(getMax(smQueueKB, 1)) * 1024 || !smQueue.push(rec))
+      {
+         dFetchAndAdd(smQueuedBytes, U32(-S32(bytes)));
+         dFetchAndAdd(smDropped, 1);
+         dFree(rec);
+         return;
+      }
+   }
+   else
+   {
+      while(!smQueue.push(rec))
+         Platform::sleep(1);
+   }
+   dFetchAndAdd(smQueued, 1);
+}
+
+//--------------------------------------------------------------------------
+
+bool AsyncLogWriter::openStream(File &file, bool truncate)
+{
+   if(truncate)
+      file.stream.open(file.fileName, FileStream::Write);
+   else
+   {
+      file.stream.open(file.fileName, FileStream::ReadWrite);
+      file.stream.setPosition(file.stream.getStreamSize());
+   }
+   return file.stream.getStatus() == Stream::Ok || file.stream.getStatus() == Stream::EOS;
+}
+
+void AsyncLogWriter::process(Record *rec)
+{
+   File &file = smFiles[rec->file];
+
+   switch(rec->op)
+   {
+      case OpOpen:
+         file.fileName = (char *) dMalloc(rec->size + 1);
+         dStrcpy(file.fileName, rec->getData());
+         file.mode = rec->mode;
+         file.touched = false;
+         file.droppedNoted = dAtomicRead(smDropped);
+         if(file.mode != AppendEachWrite)
+            openStream(file, file.mode == Truncate);
+         break;
+
+      case OpClose:
+         file.stream.close();
+         dFree(file.fileName);
+         file.fileName = NULL;
+         dAtomicWrite(smFileUsed[rec->file], 0);
+         break;
+
+      case OpWrite:
+      {
+         if(file.mode == AppendEachWrite && !file.touched)
+            openStream(file, false);
+         file.touched = true;
+
+         Stream::Status status = file.stream.getStatus();
+         if(status != Stream::Ok && status != Stream::EOS)
+            break;
+
+         U32 dropped = dAtomicRead(smDropped);
+         if(dropped != file.droppedNoted)
+         {
+            char note[64];
+            dSprintf(note, sizeof(note), "*** %d log lines dropped ***\r\n", dropped - file.droppedNoted);
+            file.stream.write(dStrlen(note), note);
+            file.droppedNoted = dropped;
+         }
+
+         file.stream.write(rec->size, rec->getData());
+         dFetchAndAdd(smWritten, 1);
+         break;
+      }
+   }
+
+   dFree(rec);
+}
+
+void AsyncLogWriter::endBatch()
+{
+   for(U32 i = 0; i < MaxFiles; i++)
+   {
+      File &file = smFiles[i];
+      if(!file.touched)
+         continue;
+
+      if(file.mode == AppendEachWrite)
+         file.stream.close();
+      else
+         file.stream.flush();
+      file.touched = false;
+   }
+}
+
+void AsyncLogWriter::drain()
+{
+   U32 count = 0;
+   Record *rec;
+   while(smQueue.pop(rec))
+   {
+      U32 bytes = sizeof(Record) + rec->size;
+      process(rec);
+      dFetchAndAdd(smQueuedBytes, U32(-S32(bytes)));
+      count++;
+   }
+
+   if(count)
+   {
+      endBatch();
+      dFetchAndAdd(smDone, count);
+   }
+}
+
+void AsyncLogWriter::run(S32)
+{
+   while(!mStopping)
+   {
+      drain();
+      Platform::sleep(FlushInterval);
+   }
+   drain();
+}
+
+//--------------------------------------------------------------------------
+
+S32 AsyncLogWriter::openFile(const char *fileName, OpenMode mode)
+{
+   S32 id = -1;
+   for(U32 i = 0; i < MaxFiles && id == -1; i++)
+      if(dCompareAndSwap(smFileUsed[i], 0, 1))
+         id = i;
+   if(id == -1)
+      return -1;
+
+   U32 len = dStrlen(fileName);
+   Record *rec = allocRecord(OpOpen, id, mode, len);
+   dMemcpy(rec->getData(), fileName, len);
+   queue(rec, false);
+   return id;
+}
+
+void AsyncLogWriter::closeFile(S32 file)
+{
+   if(file < 0)
+      return;
+
+   queue(allocRecord(OpClose, file, 0, 0), false);
+}
+
+void AsyncLogWriter::write(S32 file, const char *data, U32 size)
+{
+   if(file < 0)
+      return;
+
+   Record *rec = allocRecord(OpWrite, file, 0, size);
+   dMemcpy(rec->getData(), data, size);
+   queue(rec, true);
+}
+
+void AsyncLogWriter::writeLine(S32 file, const char *line)
+{
+   if(file < 0)
+      return;
+
+   U32 len = dStrlen(line);
+   Record *rec = allocRecord(OpWrite, file, 0, len + 2);
+   dMemcpy(rec->getData(), line, len);
+   rec->getData()[len] = '\r';
+   rec->getData()[len + 1] = '\n';
+   queue(rec, true);
+}
+
+void AsyncLogWriter::flush()
+{
+   if(!smThread)
+      return;
+
+   U32 target = dAtomicRead(smQueued);
+   while(S32(dAtomicRead(smDone) - target) < 0)
+      Platform::sleep(1);
+}
@@ -0,0 +1,131 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _ASYNCLOGWRITER_H_
+#define _ASYNCLOGWRITER_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _PLATFORMTHREAD_H_
+#include "platform/platformThread.h"
+#endif
+#ifndef _TRINGBUFFER_H_
+#include "core/tRingBuffer.h"
+#endif
+#ifndef _FILESTREAM_H_
+#include "core/fileStream.h"
+#endif
+
+/// Writes the log files from a thread of its own.
+///
+/// Con::printf() and the ConsoleLoggers queue their lines here instead of
+/// writing the file in place, and every few milliseconds the thread takes
+/// everything queued, writes it a file at a time, and flushes, so disk
+/// stalls land on the writer instead of the tick.
+///
+/// Any thread may queue.  The queue is bounded, both in lines and in
+/// bytes ($Con::logQueueKB), and a line that doesn't fit is dropped and
+/// counted; the files get a note of how many lines went missing.  Opening
+/// and closing files never drop, they wait for room.
+///
+/// Without TORQUE_MULTITHREAD, or before create() and after destroy(),
+/// everything is written right away on the calling thread.
+class AsyncLogWriter : public Thread
+{
+  public:
+   enum OpenMode
+   {
+      Truncate,         ///< Start the file over.
+      Append,           ///< Add to the end.
+      AppendEachWrite   ///< Append, and close the file after every batch.
+   };
+
+   enum Constants
+   {
+      MaxFiles      = 32,
+      QueueSize     = 8192,   ///< Lines; a power of two.
+      FlushInterval = 10      ///< ms between batches.
+   };
+
+  private:
+   enum Op
+   {
+      OpOpen,
+      OpClose,
+      OpWrite
+   };
+
+   /// What gets queued, with size bytes of data after it: a file name
+   /// for OpOpen, the text for OpWrite.
+   struct Record
+   {
+      U32 op;
+      S32 file;
+      U32 mode;
+      U32 size;
+
+      char *getData() { return (char *)(this + 1); }
+   };
+
+   /// Only touched by whoever writes, the thread or the caller.
+   struct File
+   {
+      FileStream stream;
+      char *fileName;
+      U32 mode;
+      bool touched;           ///< Written this batch.
+      U32 droppedNoted;       ///< smDropped when we last said so.
+   };
+
+   static AsyncLogWriter *smThread;
+   static MPSCQueue<Record*, QueueSize> smQueue;
+   static File smFiles[MaxFiles];
+   static volatile U32 smFileUsed[MaxFiles];
+
+   /// @name Counters
+   /// @{
+   static volatile U32 smQueuedBytes;
+   static volatile U32 smQueued;    ///< Records pushed, ever.
+   static volatile U32 smDone;      ///< Records written and flushed, ever.
+   static volatile U32 smDropped;
+   static volatile U32 smWritten;
+   static S32 smQueueKB;
+   /// @}
+
+   volatile bool mStopping;
+
+   AsyncLogWriter();
+
+   static Record *allocRecord(U32 op, S32 file, U32 mode, U32 size);
+   static void queue(Record *rec, bool canDrop);
+
+   /// Runs on whoever writes.
+   static void process(Record *rec);
+   static void endBatch();
+   static bool openStream(File &file, bool truncate);
+
+   /// Writes everything queued; the thread's side.
+   void drain();
+
+  public:
+   static void create();
+   static void destroy();
+
+   /// Returns the file's id, or -1 if there are too many open.
+   static S32  openFile(const char *fileName, OpenMode mode);
+   static void closeFile(S32 file);
+
+   /// Queues the line, with "\r\n" after it.
+   static void writeLine(S32 file, const char *line);
+   static void write(S32 file, const char *data, U32 size);
+
+   /// Waits for everything queued so far to be on disk.
+   static void flush();
+
+   void run(S32 arg);
+};
+
+#endif
@@ -79,4 +79,4 @@ typedef union {
 #define	UNARY	320
 
 
-extern YYSTYPE CMDlval;
+extern TORQUE_THREAD_LOCAL YYSTYPE CMDlval;
@@ -10,11 +10,11 @@
 
 using namespace Compiler;
 
-bool           CodeBlock::smInFunction = false;
-U32            CodeBlock::smBreakLineCount = 0;
-CodeBlock *    CodeBlock::smCodeBlockList = NULL;
-CodeBlock *    CodeBlock::smCurrentCodeBlock = NULL;
-ConsoleParser *CodeBlock::smCurrentParser = NULL;
+TORQUE_THREAD_LOCAL bool           CodeBlock::smInFunction = false;
+TORQUE_THREAD_LOCAL U32            CodeBlock::smBreakLineCount = 0;
+CodeBlock *                        CodeBlock::smCodeBlockList = NULL;
+CodeBlock *                        CodeBlock::smCurrentCodeBlock = NULL;
+TORQUE_THREAD_LOCAL ConsoleParser *CodeBlock::smCurrentParser = NULL;
 
 //-------------------------------------------------------------------------
 
@@ -300,6 +300,7 @@ void CodeBlock::calcBreakList()
 
 bool CodeBlock::read(StringTableEntry fileName, Stream &st)
 {
+   MemoryTagScope tagScope(Memory::TagScript);
    name = fileName;
 
    //
@@ -396,8 +397,51 @@ bool CodeBlock::read(StringTableEntry fileName, Stream &st)
 }
 
 
+/// Write only stream that appends to a Vector, for compiling a DSO in memory.
+class DSOBufferStream : public Stream
+{
+   Vector<U8> &mBuffer;
+
+  protected:
+   bool _read(const U32, void *) { return false; }
+   bool _write(const U32 numBytes, const void *buffer)
+   {
+      U32 pos = mBuffer.size();
+      mBuffer.setSize(pos + numBytes);
+      dMemcpy(mBuffer.address() + pos, buffer, numBytes);
+      return true;
+   }
+
+  public:
+   DSOBufferStream(Vector<U8> &buffer) : mBuffer(buffer) { setStatus(Ok); }
+
+   bool hasCapability(const Capability cap) const { return cap == StreamWrite; }
+   U32  getPosition() const              { return mBuffer.size(); }
+   bool setPosition(const U32)           { return false; }
+   U32  getStreamSize()                  { return mBuffer.size(); }
+};
+
 bool CodeBlock::compile(const char *codeFileName, StringTableEntry fileName, const char *script)
 {
+   Vector<U8> dso;
+   if(!compileToBuffer(fileName, script, dso))
+      return false;
+   return writeDSO(codeFileName, dso);
+}
+
+bool CodeBlock::writeDSO(const char *codeFileName, const Vector<U8> &dso)
+{
+   FileStream st;
+   if(!ResourceManager->openFileForWrite(st, codeFileName)) 
+      return false;
+   st.write(dso.size(), dso.address());
+   st.close();
+   return true;
+}
+
+bool CodeBlock::compileToBuffer(StringTableEntry fileName, const char *script, Vector<U8> &dso)
+{
+   MemoryTagScope tagScope(Memory::TagScript);
    gSyntaxError = false;
 
    consoleAllocReset();
@@ -421,9 +465,8 @@ bool CodeBlock::compile(const char *codeFileName, StringTableEntry fileName, con
       return false;
    }   
 
-   FileStream st;
-   if(!ResourceManager->openFileForWrite(st, codeFileName)) 
-      return false;
+   dso.clear();
+   DSOBufferStream st(dso);
    st.write(U32(Con::DSOVersion));
 
    // Reset all our value tables...
@@ -485,13 +528,14 @@ bool CodeBlock::compile(const char *codeFileName, StringTableEntry fileName, con
    getIdentTable().write(st);
 
    consoleAllocReset();
-   st.close();
 
    return true;
 }
 
 const char *CodeBlock::compileExec(StringTableEntry fileName, const char *string, bool noCalls, int setFrame)
 {
+   // the compile is charged to scripts, not what the code does when run
+   U32 prevTag = Memory::setCurrentTag(Memory::TagScript);
    STEtoU32 = evalSTEtoU32;
    consoleAllocReset();
 
@@ -514,6 +558,7 @@ const char *CodeBlock::compileExec(StringTableEntry fileName, const char *string
    if(!statementList)
    {
       delete this;
+      Memory::setCurrentTag(prevTag);
       return "";
    }
 
@@ -547,6 +592,7 @@ const char *CodeBlock::compileExec(StringTableEntry fileName, const char *string
    if(lastIp != codeSize)
       Con::warnf(ConsoleLogEntry::General, "precompile size mismatch");
 
+   Memory::setCurrentTag(prevTag);
    return exec(0, fileName, NULL, 0, 0, noCalls, NULL, setFrame);
 }
 
@@ -8,8 +8,10 @@
 
 #include "console/compiler.h"
 #include "console/consoleParser.h"
+#include "core/tVector.h"
 
 class Stream;
+class Namespace;
 
 /// Core TorqueScript code management class.
 ///
@@ -21,9 +23,13 @@ private:
    static CodeBlock* smCurrentCodeBlock;
    
 public:
-   static U32                       smBreakLineCount;
-   static bool                      smInFunction;
-   static Compiler::ConsoleParser * smCurrentParser;
+   /// @name Compiler state
+   /// Per thread, like the rest of the compiler's, see compileAll().
+   /// @{
+   static TORQUE_THREAD_LOCAL U32                       smBreakLineCount;
+   static TORQUE_THREAD_LOCAL bool                      smInFunction;
+   static TORQUE_THREAD_LOCAL Compiler::ConsoleParser * smCurrentParser;
+   /// @}
 
    static CodeBlock* getCurrentBlock()
    {
@@ -60,6 +66,47 @@ public:
    CodeBlock *nextFile;
    StringTableEntry mRoot;
 
+   /// Inline cache for one method call site.
+   ///
+   /// Method calls don't use the namespace operand of OP_CALLFUNC, so the
+   /// first time a site runs it stores its index + 1 there.  The lookup
+   /// is reused while the object's namespace and Namespace::mCacheSequence
+   /// both match.
+   struct MethodCache
+   {
+      Namespace *ns;       ///< Namespace the lookup was done in.
+      void *entry;         ///< Namespace::Entry found, may be NULL.
+      U32 sequence;        ///< Namespace::mCacheSequence at lookup time.
+   };
+   Vector<MethodCache> methodCache;
+
+   /// Resolved entry for one OP_LOADGLOBAL/OP_SAVEGLOBAL site.
+   ///
+   /// Like the method cache, the site stores its index + 1 in its cache
+   /// operand on first use.  The entry is reused until the global
+   /// Dictionary removes any variable, which bumps its sequence.
+   struct GlobalCache
+   {
+      void *entry;         ///< Dictionary::Entry, NULL if not resolved.
+      U32 sequence;        ///< Dictionary::getSequence() at lookup time.
+   };
+   Vector<GlobalCache> globalCache;
+
+   /// Field lookups of the OP_SETCURFIELD sites, by the class they were
+   /// done for.
+   ///
+   /// OP_SETCURFIELD has no spare operand, so the table is direct mapped
+   /// on the site's ip and an entry holds the ip it is for.  It's only
+   /// allocated once a field is accessed.
+   enum { FieldCacheSize = 64 };
+   struct FieldCache
+   {
+      U32 ip;                 ///< Operand ip of the site.
+      void *classRep;         ///< AbstractClassRep the lookup was done for.
+      const void *field;      ///< AbstractClassRep::Field found, may be NULL.
+   };
+   Vector<FieldCache> fieldCache;
+
 
    void addToCodeList();
    void removeFromCodeList();
@@ -85,6 +132,13 @@ public:
    bool read(StringTableEntry fileName, Stream &st);
    bool compile(const char *dsoName, StringTableEntry fileName, const char *script);
 
+   /// Compiles a script into an in memory DSO, without touching any file.
+   /// Safe to call on several threads at once when TORQUE_SUPPORTS_THREAD_LOCAL
+   /// is defined and the file uses the default parser; see compileAll().
+   bool compileToBuffer(StringTableEntry fileName, const char *script, Vector<U8> &dso);
+   /// Writes a DSO made by compileToBuffer() out to dsoName.
+   static bool writeDSO(const char *dsoName, const Vector<U8> &dso);
+
    void incRefCount();
    void decRefCount();
 
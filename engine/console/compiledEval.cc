@@ -20,6 +20,7 @@
 #include "sim/netStringTable.h"
 
 #include "console/stringStack.h"
+#include "core/frameStats.h"
 
 using namespace Compiler;
 
@@ -43,6 +44,30 @@ StringStack STR;
 U32 FLT = 0;
 U32 UINT = 0;
 
+/// Static field lookup for the OP_SETCURFIELD site at ip, through the
+/// code block's field cache.  NULL if obj has no static field by that name.
+static const AbstractClassRep::Field *findCachedField(CodeBlock *block, U32 ip, SimObject *obj, StringTableEntry name)
+{
+   AbstractClassRep *rep = obj->getClassRep();
+   if(!rep)
+      return NULL;
+
+   if(!block->fieldCache.size())
+   {
+      block->fieldCache.setSize(CodeBlock::FieldCacheSize);
+      dMemset(block->fieldCache.address(), 0, sizeof(CodeBlock::FieldCache) * CodeBlock::FieldCacheSize);
+   }
+
+   CodeBlock::FieldCache &cache = block->fieldCache[ip & (CodeBlock::FieldCacheSize - 1)];
+   if(cache.ip != ip || cache.classRep != rep)
+   {
+      cache.ip = ip;
+      cache.classRep = rep;
+      cache.field = rep->findField(name);
+   }
+   return (const AbstractClassRep::Field *) cache.field;
+}
+
 static const char *getNamespaceList(Namespace *ns)
 {
    U32 size = 1;
@@ -110,6 +135,38 @@ namespace Con
       dSprintf(ret, 32, "%d", arg);
       return ret;
    }
+
+   S32 readIntArg(const char **argv, S32 index)
+   {
+      S32 value;
+      if(STR.getNativeIntArg(argv, index, &value))
+         return value;
+      return dAtoi(argv[index]);
+   }
+
+   F32 readFloatArg(const char **argv, S32 index)
+   {
+      F64 value;
+      if(STR.getNativeArg(argv, index, &value))
+         return F32(value);
+      return dAtof(argv[index]);
+   }
+
+   bool readBoolArg(const char **argv, S32 index)
+   {
+      F64 value;
+      if(STR.getNativeArg(argv, index, &value))
+         return value != 0;
+      return dAtob(argv[index]);
+   }
+
+   SimObject *readObjectArg(const char **argv, S32 index)
+   {
+      S32 value;
+      if(STR.getNativeIntArg(argv, index, &value))
+         return Sim::findObject(SimObjectId(value));
+      return Sim::findObject(argv[index]);
+   }
 }
 
 //------------------------------------------------------------
@@ -137,6 +194,44 @@ inline void ExprEvalState::setCurVarNameCreate(StringTableEntry name)
    }
 }
 
+inline void ExprEvalState::setCurLocalVar(StringTableEntry name, U32 slot, bool create)
+{
+   if(stack.size())
+   {
+      currentVariable = stack.last()->lookupSlot(name, slot, create);
+      if(!currentVariable && gWarnUndefinedScriptVariables)
+         Con::warnf(ConsoleLogEntry::Script, "Variable referenced before assignment: %s", name);
+   }
+   else if(create)
+      setCurVarNameCreate(name);
+   else
+      setCurVarName(name);
+}
+
+inline void ExprEvalState::setCurGlobalVar(StringTableEntry name, CodeBlock *code, U32 &cacheIndex, bool create)
+{
+   if(!cacheIndex)
+   {
+      code->globalCache.increment();
+      code->globalCache.last().entry = NULL;
+      cacheIndex = code->globalCache.size();
+   }
+
+   CodeBlock::GlobalCache &cache = code->globalCache[cacheIndex - 1];
+   if(cache.entry && cache.sequence == globalVars.getSequence())
+   {
+      currentVariable = (Dictionary::Entry *) cache.entry;
+      return;
+   }
+
+   if(create)
+      setCurVarNameCreate(name);
+   else
+      setCurVarName(name);
+   cache.entry = currentVariable;
+   cache.sequence = globalVars.getSequence();
+}
+
 //------------------------------------------------------------
 
 inline S32 ExprEvalState::getIntVariable()
@@ -203,6 +298,7 @@ const char *CodeBlock::exec(U32 ip, const char *functionName, Namespace *thisNam
    static char traceBuffer[1024];
    U32 i;
 
+   STAT_INC(ScriptCalls);
    incRefCount();
    F64 *curFloatTable;
    char *curStringTable;
@@ -250,7 +346,14 @@ const char *CodeBlock::exec(U32 ip, const char *functionName, Namespace *thisNam
       {
          StringTableEntry var = U32toSTE(code[ip + i + 6]);
          gEvalState.setCurVarNameCreate(var);
-         gEvalState.setStringVariable(argv[i+1]);
+
+         // Integers print back exactly as they were passed, so keep them
+         // native and save the next consumer a parse.
+         F64 native;
+         if(STR.getNativeArg(argv, i + 1, &native) && STR.mArgTypes[i + 1] == StringStack::NativeInt)
+            gEvalState.setIntVariable(S32(native));
+         else
+            gEvalState.setStringVariable(argv[i+1]);
       }
       ip = ip + fnArgc + 6;
       curFloatTable = functionFloats;
@@ -291,6 +394,7 @@ const char *CodeBlock::exec(U32 ip, const char *functionName, Namespace *thisNam
    StringTableEntry fnNamespace, fnPackage;
    SimObject *currentNewObject = 0;
    StringTableEntry curField;
+   U32 curFieldIp = 0;
    SimObject *curObject;
    SimObject *saveObject=NULL;
    Namespace::Entry *nsEntry;
@@ -380,7 +484,9 @@ breakContinue:
             if(!currentNewObject)
             {
                // Well, looks like we have to create a new object.
+               U32 prevTag = Memory::setCurrentTag(Memory::TagScript);
                ConsoleObject *object = ConsoleObject::create(callArgv[1]);
+               Memory::setCurrentTag(prevTag);
 
                // Deal with failure!
                if(!object)
@@ -733,6 +839,96 @@ breakContinue:
             gEvalState.setCurVarNameCreate(var);
             break;
 
+         case OP_LOADLOCAL_UINT:
+            gEvalState.setCurLocalVar(U32toSTE(code[ip]), code[ip+1], false);
+            ip += 2;
+            intStack[UINT+1] = gEvalState.getIntVariable();
+            UINT++;
+            break;
+
+         case OP_LOADLOCAL_FLT:
+            gEvalState.setCurLocalVar(U32toSTE(code[ip]), code[ip+1], false);
+            ip += 2;
+            floatStack[FLT+1] = gEvalState.getFloatVariable();
+            FLT++;
+            break;
+
+         case OP_LOADLOCAL_STR:
+            gEvalState.setCurLocalVar(U32toSTE(code[ip]), code[ip+1], false);
+            ip += 2;
+            STR.setStringValue(gEvalState.getStringVariable());
+            if(gEvalState.currentVariable)
+            {
+               if(gEvalState.currentVariable->type == Dictionary::Entry::TypeInternalInt)
+                  STR.setNativeValue(StringStack::NativeInt, S32(gEvalState.currentVariable->ival));
+               else if(gEvalState.currentVariable->type == Dictionary::Entry::TypeInternalFloat)
+                  STR.setNativeValue(StringStack::NativeFloat, gEvalState.currentVariable->fval);
+            }
+            break;
+
+         case OP_SAVELOCAL_UINT:
+            gEvalState.setCurLocalVar(U32toSTE(code[ip]), code[ip+1], true);
+            ip += 2;
+            gEvalState.setIntVariable(intStack[UINT]);
+            break;
+
+         case OP_SAVELOCAL_FLT:
+            gEvalState.setCurLocalVar(U32toSTE(code[ip]), code[ip+1], true);
+            ip += 2;
+            gEvalState.setFloatVariable(floatStack[FLT]);
+            break;
+
+         case OP_SAVELOCAL_STR:
+            gEvalState.setCurLocalVar(U32toSTE(code[ip]), code[ip+1], true);
+            ip += 2;
+            gEvalState.setStringVariable(STR.getStringValue());
+            break;
+
+         case OP_LOADGLOBAL_UINT:
+            gEvalState.setCurGlobalVar(U32toSTE(code[ip]), this, code[ip+1], false);
+            ip += 2;
+            intStack[UINT+1] = gEvalState.getIntVariable();
+            UINT++;
+            break;
+
+         case OP_LOADGLOBAL_FLT:
+            gEvalState.setCurGlobalVar(U32toSTE(code[ip]), this, code[ip+1], false);
+            ip += 2;
+            floatStack[FLT+1] = gEvalState.getFloatVariable();
+            FLT++;
+            break;
+
+         case OP_LOADGLOBAL_STR:
+            gEvalState.setCurGlobalVar(U32toSTE(code[ip]), this, code[ip+1], false);
+            ip += 2;
+            STR.setStringValue(gEvalState.getStringVariable());
+            if(gEvalState.currentVariable)
+            {
+               if(gEvalState.currentVariable->type == Dictionary::Entry::TypeInternalInt)
+                  STR.setNativeValue(StringStack::NativeInt, S32(gEvalState.currentVariable->ival));
+               else if(gEvalState.currentVariable->type == Dictionary::Entry::TypeInternalFloat)
+                  STR.setNativeValue(StringStack::NativeFloat, gEvalState.currentVariable->fval);
+            }
+            break;
+
+         case OP_SAVEGLOBAL_UINT:
+            gEvalState.setCurGlobalVar(U32toSTE(code[ip]), this, code[ip+1], true);
+            ip += 2;
+            gEvalState.setIntVariable(intStack[UINT]);
+            break;
+
+         case OP_SAVEGLOBAL_FLT:
+            gEvalState.setCurGlobalVar(U32toSTE(code[ip]), this, code[ip+1], true);
+            ip += 2;
+            gEvalState.setFloatVariable(floatStack[FLT]);
+            break;
+
+         case OP_SAVEGLOBAL_STR:
+            gEvalState.setCurGlobalVar(U32toSTE(code[ip]), this, code[ip+1], true);
+            ip += 2;
+            gEvalState.setStringVariable(STR.getStringValue());
+            break;
+
          case OP_SETCURVAR_ARRAY:
             var = STR.getSTValue();
             gEvalState.setCurVarName(var);
@@ -756,6 +952,14 @@ breakContinue:
          case OP_LOADVAR_STR:
             val = gEvalState.getStringVariable();
             STR.setStringValue(val);
+            // remember numeric variables so native callbacks can skip the parse
+            if(gEvalState.currentVariable)
+            {
+               if(gEvalState.currentVariable->type == Dictionary::Entry::TypeInternalInt)
+                  STR.setNativeValue(StringStack::NativeInt, S32(gEvalState.currentVariable->ival));
+               else if(gEvalState.currentVariable->type == Dictionary::Entry::TypeInternalFloat)
+                  STR.setNativeValue(StringStack::NativeFloat, gEvalState.currentVariable->fval);
+            }
             break;
 
          case OP_SAVEVAR_UINT:
@@ -780,6 +984,7 @@ breakContinue:
 
          case OP_SETCURFIELD:
             curField = U32toSTE(code[ip]);
+            curFieldIp = ip;
             curFieldArray[0] = 0;
             ip++;
             break;
@@ -790,7 +995,7 @@ breakContinue:
 
          case OP_LOADFIELD_UINT:
             if(curObject)
-               intStack[UINT+1] = U32(dAtoi(curObject->getDataField(curField, curFieldArray)));
+               intStack[UINT+1] = U32(dAtoi(curObject->getDataField(curField, curFieldArray, findCachedField(this, curFieldIp, curObject, curField))));
             else
                intStack[UINT+1] = 0;
             UINT++;
@@ -798,7 +1003,7 @@ breakContinue:
 
          case OP_LOADFIELD_FLT:
             if(curObject)
-               floatStack[FLT+1] = dAtof(curObject->getDataField(curField, curFieldArray));
+               floatStack[FLT+1] = dAtof(curObject->getDataField(curField, curFieldArray, findCachedField(this, curFieldIp, curObject, curField)));
             else
                floatStack[FLT+1] = 0;
             FLT++;
@@ -806,7 +1011,7 @@ breakContinue:
 
          case OP_LOADFIELD_STR:
             if(curObject)
-               val = curObject->getDataField(curField, curFieldArray);
+               val = curObject->getDataField(curField, curFieldArray, findCachedField(this, curFieldIp, curObject, curField));
             else
                val = "";
             STR.setStringValue(val);
@@ -815,18 +1020,18 @@ breakContinue:
          case OP_SAVEFIELD_UINT:
             STR.setIntValue(intStack[UINT]);
             if(curObject)
-               curObject->setDataField(curField, curFieldArray, STR.getStringValue());
+               curObject->setDataField(curField, curFieldArray, STR.getStringValue(), findCachedField(this, curFieldIp, curObject, curField));
             break;
 
          case OP_SAVEFIELD_FLT:
             STR.setFloatValue(floatStack[FLT]);
             if(curObject)
-               curObject->setDataField(curField, curFieldArray, STR.getStringValue());
+               curObject->setDataField(curField, curFieldArray, STR.getStringValue(), findCachedField(this, curFieldIp, curObject, curField));
             break;
 
          case OP_SAVEFIELD_STR:
             if(curObject)
-               curObject->setDataField(curField, curFieldArray, STR.getStringValue());
+               curObject->setDataField(curField, curFieldArray, STR.getStringValue(), findCachedField(this, curFieldIp, curObject, curField));
             break;
 
          case OP_STR_TO_UINT:
@@ -955,7 +1160,25 @@ breakContinue:
                }
                ns = gEvalState.thisObject->getNamespace();
                if(ns)
-                  nsEntry = ns->lookup(fnName);
+               {
+                  U32 &cacheIndex = code[ip-2];
+                  if(!cacheIndex)
+                  {
+                     methodCache.increment();
+                     methodCache.last().ns = NULL;
+                     cacheIndex = methodCache.size();
+                  }
+                  MethodCache &cache = methodCache[cacheIndex - 1];
+                  if(cache.ns == ns && cache.sequence == Namespace::mCacheSequence)
+                     nsEntry = (Namespace::Entry *) cache.entry;
+                  else
+                  {
+                     nsEntry = ns->lookup(fnName);
+                     cache.ns = ns;
+                     cache.entry = nsEntry;
+                     cache.sequence = Namespace::mCacheSequence;
+                  }
+               }
                else
                   nsEntry = NULL;
             }
@@ -41,11 +41,17 @@ namespace Compiler
 
    //------------------------------------------------------------
 
-   CompilerStringTable *gCurrentStringTable, gGlobalStringTable, gFunctionStringTable;
-   CompilerFloatTable  *gCurrentFloatTable,  gGlobalFloatTable,  gFunctionFloatTable;
-   DataChunker          gConsoleAllocator;
-   CompilerIdentTable   gIdentTable;
-   CodeBlock           *gCurBreakBlock;
+   // All of the compiler's state is per thread, so compileAll() can
+   // compile scripts in parallel.
+   static TORQUE_THREAD_LOCAL CompilerStringTable *gCurrentStringTable;
+   static TORQUE_THREAD_LOCAL CompilerStringTable  gGlobalStringTable;
+   static TORQUE_THREAD_LOCAL CompilerStringTable  gFunctionStringTable;
+   static TORQUE_THREAD_LOCAL CompilerFloatTable  *gCurrentFloatTable;
+   static TORQUE_THREAD_LOCAL CompilerFloatTable   gGlobalFloatTable;
+   static TORQUE_THREAD_LOCAL CompilerFloatTable   gFunctionFloatTable;
+   static TORQUE_THREAD_LOCAL DataChunker         *gConsoleAllocator;
+   static TORQUE_THREAD_LOCAL CompilerIdentTable   gIdentTable;
+   static TORQUE_THREAD_LOCAL CodeBlock           *gCurBreakBlock;
 
    //------------------------------------------------------------
 
@@ -67,11 +73,11 @@ namespace Compiler
       return 0;
    }
 
-   U32 (*STEtoU32)(StringTableEntry ste, U32 ip) = evalSTEtoU32;
+   TORQUE_THREAD_LOCAL U32 (*STEtoU32)(StringTableEntry ste, U32 ip) = evalSTEtoU32;
 
    //------------------------------------------------------------
 
-   bool gSyntaxError = false;
+   TORQUE_THREAD_LOCAL bool gSyntaxError = false;
 
    //------------------------------------------------------------
 
@@ -95,6 +101,25 @@ namespace Compiler
          gGlobalStringTable.add(ident);
    }
 
+   static TORQUE_THREAD_LOCAL StringTableEntry gLocalSlots[Dictionary::MaxLocalSlots];
+   static TORQUE_THREAD_LOCAL S32 gLocalSlotCount;
+
+   void resetLocalSlots()
+   {
+      gLocalSlotCount = 0;
+   }
+
+   S32 getLocalSlot(StringTableEntry name)
+   {
+      for(S32 i = 0; i < gLocalSlotCount; i++)
+         if(gLocalSlots[i] == name)
+            return i;
+      if(gLocalSlotCount >= Dictionary::MaxLocalSlots)
+         return -1;
+      gLocalSlots[gLocalSlotCount] = name;
+      return gLocalSlotCount++;
+   }
+
    void resetTables()
    {
       setCurrentStringTable(&gGlobalStringTable);
@@ -106,8 +131,19 @@ namespace Compiler
       getIdentTable().reset();
    }
 
-   void *consoleAlloc(U32 size) { return gConsoleAllocator.alloc(size);  }
-   void consoleAllocReset()     { gConsoleAllocator.freeBlocks(); }
+   static DataChunker &getConsoleAllocator()
+   {
+      // Thread locals can't have constructors, and the worker threads
+      // live as long as the pool, so each one's allocator is never freed.
+      if(!gConsoleAllocator)
+         gConsoleAllocator = new DataChunker;
+      return *gConsoleAllocator;
+   }
+
+   void *consoleAlloc(U32 size) { return getConsoleAllocator().alloc(size);  }
+   // Keeps enough blocks for a typical script, so compiling file after
+   //  file doesn't go back to new, without holding on to a huge one's.
+   void consoleAllocReset()     { getConsoleAllocator().reset(256 * 1024); }
 
 }
 
@@ -232,7 +268,7 @@ void CompilerIdentTable::reset()
 
 void CompilerIdentTable::add(StringTableEntry ste, U32 ip)
 {
-   U32 index = gGlobalStringTable.add(ste, false);
+   U32 index = getGlobalStringTable().add(ste, false);
    Entry *newEntry = (Entry *) consoleAlloc(sizeof(Entry));
    newEntry->offset = index;
    newEntry->ip = ip;
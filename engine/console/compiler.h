@@ -122,6 +122,27 @@ namespace Compiler
 
       OP_BREAK,
 
+      // Added in DSO version 37.  These fuse a variable select and a
+      // load/save for a plain local, and carry a slot number the frame
+      // uses to cache the variable's dictionary entry.  Operands are the
+      // variable name and slot.
+      OP_LOADLOCAL_UINT,   ///< OP_SETCURVAR + OP_LOADVAR_UINT
+      OP_LOADLOCAL_FLT,    ///< OP_SETCURVAR + OP_LOADVAR_FLT
+      OP_LOADLOCAL_STR,    ///< OP_SETCURVAR + OP_LOADVAR_STR
+      OP_SAVELOCAL_UINT,   ///< OP_SETCURVAR_CREATE + OP_SAVEVAR_UINT
+      OP_SAVELOCAL_FLT,    ///< OP_SETCURVAR_CREATE + OP_SAVEVAR_FLT
+      OP_SAVELOCAL_STR,    ///< OP_SETCURVAR_CREATE + OP_SAVEVAR_STR
+
+      // Added in DSO version 38.  The same fusion for a plain global;
+      // operands are the variable name and a cache index, 0 in compiled
+      // code, that the first execution fills in.  See CodeBlock::globalCache.
+      OP_LOADGLOBAL_UINT,  ///< OP_SETCURVAR + OP_LOADVAR_UINT
+      OP_LOADGLOBAL_FLT,   ///< OP_SETCURVAR + OP_LOADVAR_FLT
+      OP_LOADGLOBAL_STR,   ///< OP_SETCURVAR + OP_LOADVAR_STR
+      OP_SAVEGLOBAL_UINT,  ///< OP_SETCURVAR_CREATE + OP_SAVEVAR_UINT
+      OP_SAVEGLOBAL_FLT,   ///< OP_SETCURVAR_CREATE + OP_SAVEVAR_FLT
+      OP_SAVEGLOBAL_STR,   ///< OP_SETCURVAR_CREATE + OP_SAVEVAR_STR
+
       OP_INVALID
    };
 
@@ -198,7 +219,7 @@ namespace Compiler
       return *((StringTableEntry *) &u);
    }
 
-   extern U32 (*STEtoU32)(StringTableEntry ste, U32 ip);
+   extern TORQUE_THREAD_LOCAL U32 (*STEtoU32)(StringTableEntry ste, U32 ip);
 
    U32 evalSTEtoU32(StringTableEntry ste, U32);
    U32 compileSTEtoU32(StringTableEntry ste, U32 ip);
@@ -219,6 +240,15 @@ namespace Compiler
 
    void precompileIdent(StringTableEntry ident);
 
+   /// Forget the local variable slots handed out so far; called at the
+   /// start of each function body.
+   void resetLocalSlots();
+
+   /// Slot for a local variable in the function being compiled, or -1 if
+   /// the function has run out of slots and the variable should be
+   /// compiled with the by-name opcodes.
+   S32 getLocalSlot(StringTableEntry name);
+
    CodeBlock *getBreakCodeBlock();
    void setBreakCodeBlock(CodeBlock *cb);
 
@@ -229,7 +259,7 @@ namespace Compiler
    void *consoleAlloc(U32 size);
    void consoleAllocReset();
 
-   extern bool gSyntaxError;
+   extern TORQUE_THREAD_LOCAL bool gSyntaxError;
 };
 
 #endif
@@ -17,12 +17,13 @@
 #include "console/simBase.h"
 #include "console/compiler.h"
 #include "console/stringStack.h"
+#include "console/asyncLogWriter.h"
 #include <stdarg.h>
 
 extern StringStack STR;
 
 ExprEvalState gEvalState;
-StmtNode *statementList;
+TORQUE_THREAD_LOCAL StmtNode *statementList;
 ConsoleConstructor *ConsoleConstructor::first = NULL;
 bool gWarnUndefinedScriptVariables;
 
@@ -161,7 +162,7 @@ static Vector<ConsoleLogEntry> consoleLog(__FILE__, __LINE__);
 static bool consoleLogLocked;
 static bool logBufferEnabled=true;
 static S32 printLevel = 10;
-static FileStream consoleLogFile;
+static S32 consoleLogFile = -1;
 static const char *defLogFileName = "console.log";
 static S32 consoleLogMode = 0;
 static bool active = false;
@@ -240,6 +241,9 @@ void init()
    addVariable("Con::printLevel", TypeS32, &printLevel);
    addVariable("Con::warnUndefinedVariables", TypeBool, &gWarnUndefinedScriptVariables);
 
+   // The log files are written from a thread of their own.
+   AsyncLogWriter::create();
+
    // Current script file name and root
    Con::addVariable( "Con::File", TypeString, &gCurrentFile );
    Con::addVariable( "Con::Root", TypeString, &gCurrentRoot );
@@ -258,7 +262,9 @@ void shutdown()
    AssertFatal(active == true, "Con::shutdown should only be called once.");
    active = false;
 
-   consoleLogFile.close();
+   AsyncLogWriter::closeFile(consoleLogFile);
+   consoleLogFile = -1;
+   AsyncLogWriter::destroy();
    Namespace::shutdown();
 }
 
@@ -407,67 +413,73 @@ U32 tabComplete(char* inputBuffer, U32 cursorPos, U32 maxResultLength, bool forw
 static void log(const char *string)
 {
    // Bail if we ain't logging.
-   if (!consoleLogMode) 
+   if (!consoleLogMode || consoleLogFile == -1) 
    {
       return;
    }
 
-   // In mode 1, we open, append, close on each log write.
-   if ((consoleLogMode & 0x3) == 1) 
+   // If this is the first write...
+   if (newLogFile) 
    {
-      consoleLogFile.open(defLogFileName, FileStream::ReadWrite);
-   }
-
-   // Write to the log if its status is hunky-dory.
-   if ((consoleLogFile.getStatus() == Stream::Ok) || (consoleLogFile.getStatus() == Stream::EOS)) 
-   {
-      consoleLogFile.setPosition(consoleLogFile.getStreamSize());
-      // If this is the first write...
-      if (newLogFile) 
+      // Make a header.
+      Platform::LocalTime lt;
+      Platform::getLocalTime(lt);
+      char buffer[128];
+      dSprintf(buffer, sizeof(buffer), "//-------------------------- %d/%d/%d -- %02d:%02d:%02d -----\r\n",
+            lt.month + 1,
+            lt.monthday,
+            lt.year + 1900,
+            lt.hour,
+            lt.min,
+            lt.sec);
+      AsyncLogWriter::write(consoleLogFile, buffer, dStrlen(buffer));
+      newLogFile = false;
+      if (consoleLogMode & 0x4) 
       {
-         // Make a header.
-         Platform::LocalTime lt;
-         Platform::getLocalTime(lt);
-         char buffer[128];
-         dSprintf(buffer, sizeof(buffer), "//-------------------------- %d/%d/%d -- %02d:%02d:%02d -----\r\n",
-               lt.month + 1,
-               lt.monthday,
-               lt.year + 1900,
-               lt.hour,
-               lt.min,
-               lt.sec);
-         consoleLogFile.write(dStrlen(buffer), buffer);
-         newLogFile = false;
-         if (consoleLogMode & 0x4) 
-         {
-            // Dump anything that has been printed to the console so far.
-            consoleLogMode -= 0x4;
-            U32 size, line;
-            ConsoleLogEntry *log;
-            getLockLog(log, size);
-            for (line = 0; line < size; line++) 
-            {
-               consoleLogFile.write(dStrlen(log[line].mString), log[line].mString);
-               consoleLogFile.write(2, "\r\n");
-            }
-            unlockLog();
-         }
+         // Dump anything that has been printed to the console so far.
+         consoleLogMode -= 0x4;
+         U32 size, line;
+         ConsoleLogEntry *log;
+         getLockLog(log, size);
+         for (line = 0; line < size; line++) 
+            AsyncLogWriter::writeLine(consoleLogFile, log[line].mString);
+         unlockLog();
       }
-      // Now write what we came here to write.
-      consoleLogFile.write(dStrlen(string), string);
-      consoleLogFile.write(2, "\r\n");
-   }
-
-   if ((consoleLogMode & 0x3) == 1) 
-   {
-      consoleLogFile.close();
    }
+   // Now write what we came here to write.
+   AsyncLogWriter::writeLine(consoleLogFile, string);
 }
 
 //------------------------------------------------------------------------------
 
+static TORQUE_THREAD_LOCAL bool gThreadQuiet = false;
+static TORQUE_THREAD_LOCAL bool gThreadDropped = false;
+
+void beginThreadQuiet()
+{
+   gThreadQuiet = true;
+   gThreadDropped = false;
+}
+
+bool endThreadQuiet()
+{
+   gThreadQuiet = false;
+   return gThreadDropped;
+}
+
+bool isThreadQuiet()
+{
+   return gThreadQuiet;
+}
+
 static void _printf(ConsoleLogEntry::Level level, ConsoleLogEntry::Type type, const char* fmt, va_list argptr)
 {
+   if(gThreadQuiet)
+   {
+      gThreadDropped = true;
+      return;
+   }
+
    char buffer[4096];
    U32 offset = 0;
    if(gEvalState.traceOn && gEvalState.stack.size())
@@ -897,6 +909,27 @@ const char *execute(S32 argc, const char *argv[])
 #endif
 }
 
+//------------------------------------------------------------------------------
+const char *execute(FunctionCache &cache, S32 argc, const char *argv[])
+{
+#ifdef TORQUE_MULTITHREAD
+   if(!isMainThread())
+      return execute(argc, argv);
+#endif
+   StringTableEntry funcName = argv[0];
+   if(cache.name != funcName || cache.sequence != Namespace::mCacheSequence)
+   {
+      cache.name = funcName;
+      cache.entry = Namespace::global()->lookup(funcName);
+      cache.sequence = Namespace::mCacheSequence;
+   }
+
+   // let the usual path complain about it
+   if(!cache.entry)
+      return execute(argc, argv);
+   return ((Namespace::Entry *) cache.entry)->execute(argc, argv, &gEvalState);
+}
+
 //------------------------------------------------------------------------------
 const char *execute(SimObject *object, S32 argc, const char *argv[])
 {
@@ -980,13 +1013,17 @@ void setLogMode(S32 newMode)
          // Enabling logging when it was previously disabled.
          newLogFile = true;
       }
-      if ((consoleLogMode & 0x3) == 2) {
-         // Changing away from mode 2, must close logfile.
-         consoleLogFile.close();
+      // Whatever the old mode had open goes.
+      AsyncLogWriter::closeFile(consoleLogFile);
+      consoleLogFile = -1;
+
+      if ((newMode & 0x3) == 1) {
+         // Mode 1 appends, and closes after every batch of writes.
+         consoleLogFile = AsyncLogWriter::openFile(defLogFileName, AsyncLogWriter::AppendEachWrite);
       }
       else if ((newMode & 0x3) == 2) {
          // Starting mode 2, must open logfile.
-         consoleLogFile.open(defLogFileName, FileStream::Write);
+         consoleLogFile = AsyncLogWriter::openFile(defLogFileName, AsyncLogWriter::Truncate);
       }
       consoleLogMode = newMode;
    }
@@ -172,7 +172,11 @@ namespace Con
       /// 12/29/04 - BJG - 33->34 Removed some opcodes, part of namespace upgrade.
       /// 12/30/04 - BJG - 34->35 Reordered some things, further general shuffling.
       /// 11/03/05 - BJG - 35->36 Integrated new debugger code.
-      DSOVersion = 36,
+      ///          36->37 Local variable slot opcodes.  They were added
+      ///          after the existing ones, so 36 still loads.
+      ///          37->38 Global variable opcodes, also appended.
+      DSOVersion = 38,
+      MinDSOVersion = 36,   ///< Oldest DSO we can still run.
 
       MaxLineLength = 512,  ///< Maximum length of a line of console input.
       MaxDataTypes = 256    ///< Maximum number of registered data types.
@@ -472,6 +476,13 @@ namespace Con
    /// @see Con::errorf()
    void errorf(ConsoleLogEntry::Type type, const char *_format, ...);
 
+   /// Stops printing on the calling thread.  This is for work done off the
+   /// main thread that can simply be redone on it when it has something
+   /// to say; endThreadQuiet() returns whether anything was dropped.
+   void beginThreadQuiet();
+   bool endThreadQuiet();
+   bool isThreadQuiet();
+
    /// @}
 
    /// Returns true when called from the main thread, false otherwise
@@ -499,6 +510,21 @@ namespace Con
    /// @see execute(S32 argc, const char* argv[])
    const char *executef(S32 argc, ...);
 
+   /// Where execute(FunctionCache &, ...) keeps its lookup of a function.
+   struct FunctionCache
+   {
+      StringTableEntry name;
+      void *entry;
+      U32 sequence;
+      FunctionCache() { name = NULL; entry = NULL; sequence = 0; }
+   };
+
+   /// Same as execute(S32 argc, const char* argv[]), for callers that call
+   /// the same function over and over.  argv[0] must be a StringTableEntry;
+   /// the global function it names is looked up once and kept in cache
+   /// until the name changes or functions or packages are (re)defined.
+   const char *execute(FunctionCache &cache, S32 argc, const char* argv[]);
+
    /// Call a Torque Script member function of a SimObject from C/C++ code.
    /// @param object    Object on which to execute the method call.
    /// @param argc      Number of elements in the argv parameter (must be >2, see argv)
@@ -547,6 +573,36 @@ namespace Con
    char *getIntArg  (S32 arg);
    /// @}
 
+   /// @name Native Arguments
+   ///
+   /// When the interpreter calls a console function it still builds the
+   /// usual argv strings, but it also remembers which arguments came from
+   /// numbers: literals, arithmetic and int/float variables.  These read
+   /// argv[index] as the given type, using that number directly rather
+   /// than parsing the string when it's available.  Floats come back at
+   /// full precision instead of the 6 digits the string holds, but only
+   /// from readFloatArg() and readBoolArg(): readIntArg() and readObjectArg()
+   /// use the number only if it was an integer, and otherwise parse argv
+   /// as before, so an int read of 2.3 * 100 is still 230.
+   ///
+   /// Calls made through Con::execute() just parse argv.  Read the
+   /// arguments before calling back into script, since the next call
+   /// reuses the same tables, just as it reuses argv.
+   ///
+   /// @code
+   ///      ConsoleFunction( mSqrt, F32, 2, 2, "(float v)")
+   ///      {
+   ///         return mSqrt(Con::readFloatArg(argv, 1));
+   ///      }
+   /// @endcode
+   /// @{
+
+   S32        readIntArg   (const char **argv, S32 index);
+   F32        readFloatArg (const char **argv, S32 index);
+   bool       readBoolArg  (const char **argv, S32 index);
+   SimObject *readObjectArg(const char **argv, S32 index);
+   /// @}
+
    /// @name Namespaces
    /// @{
 
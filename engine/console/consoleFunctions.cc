@@ -10,6 +10,7 @@
 #include "core/resManager.h"
 #include "core/fileStream.h"
 #include "console/compiler.h"
+#include "core/threadPool.h"
 #include "platform/event.h"
 #include "platform/gameInterface.h"
 #include "platform/platformInput.h"
@@ -1006,7 +1007,7 @@ ConsoleFunction(exec, bool, 2, 4, "exec(fileName [, nocalls [,journalScript]])")
       {
       // Check the version!
       compiledStream->read(&version);
-      if(version != Con::DSOVersion)
+      if(version < Con::MinDSOVersion || version > Con::DSOVersion)
       {
          Con::warnf("exec: Found an old DSO (%s, ver %d < %d), ignoring.", nameBuffer, version, Con::DSOVersion);
          ResourceManager->closeStream(compiledStream);
@@ -1120,6 +1121,145 @@ ConsoleFunction(exec, bool, 2, 4, "exec(fileName [, nocalls [,journalScript]])")
    return ret;
 }
 
+//--------------------------------------------------------------------------
+
+/// A script compileAll() is bringing up to date.
+struct ScriptCompileJob
+{
+   StringTableEntry scriptName;
+   StringTableEntry dsoName;
+   char            *script;
+   Vector<U8>       dso;
+   bool             redo;   ///< Compile it again on the main thread.
+};
+
+/// Finds the DSO exec() would load for scriptName, and returns true if it
+/// is missing or older than the script.
+static bool needsCompile(StringTableEntry scriptName, char *dsoName, U32 dsoNameSize)
+{
+   const char *ext = dStrrchr(scriptName, '.');
+   if(!ext || !dStricmp(ext, ".mis") || !dStricmp(ext, ".dso") || !dStricmp(ext, ".edso"))
+      return false;
+
+   const char *edExt = dStrchr(scriptName, '.');
+   bool isEditorScript = !dStricmp(edExt, ".ed.cs") || !dStricmp(edExt, ".ed.gui");
+   dStrcpyl(dsoName, dsoNameSize, scriptName, isEditorScript ? ".edso" : ".dso", NULL);
+
+   ResourceObject *rScr = ResourceManager->find(scriptName);
+   ResourceObject *rCom = ResourceManager->find(dsoName);
+   if(!rScr)
+      return false;
+   if(!rCom)
+      return true;
+
+   FileTime comModifyTime, scrModifyTime;
+   rCom->getFileTimes(NULL, &comModifyTime);
+   rScr->getFileTimes(NULL, &scrModifyTime);
+   if(Platform::compareFileTimes(comModifyTime, scrModifyTime) < 0)
+      return true;
+
+   Stream *compiledStream = ResourceManager->openStream(dsoName);
+   if(!compiledStream)
+      return true;
+   U32 version = 0;
+   compiledStream->read(&version);
+   ResourceManager->closeStream(compiledStream);
+   return version < Con::MinDSOVersion || version > Con::DSOVersion;
+}
+
+static void compileScriptBatch(U32 start, U32 end, void *userData)
+{
+   ScriptCompileJob **jobs = (ScriptCompileJob **) userData;
+   for(U32 i = start; i < end; i++)
+   {
+      ScriptCompileJob &job = *jobs[i];
+      if(job.redo)
+         continue;
+
+      // Anything the compiler has to say is dropped here and the file is
+      // compiled again on the main thread, so it's reported in order.
+      Con::beginThreadQuiet();
+      CodeBlock code;
+      bool compiled = code.compileToBuffer(job.scriptName, job.script, job.dso);
+      job.redo = Con::endThreadQuiet() || !compiled;
+   }
+}
+
+ConsoleFunction(compileAll, S32, 2, 2, "(string pattern) Compiles every script matching pattern "
+                "whose DSO is missing or out of date, spread over the thread pool, and returns how many "
+                "were compiled.  Nothing is executed; exec() then loads the fresh DSOs.")
+{
+   argc;
+   if(Con::getBoolVariable("Scripts::ignoreDSOs") || Game->isJournalReading() || Game->isJournalWriting())
+      return 0;
+   if(!Con::expandScriptFilename(scriptFilenameBuffer, sizeof(scriptFilenameBuffer), argv[1]))
+      return 0;
+
+   // Find what's stale and read it in.
+   Vector<ScriptCompileJob *> jobList;
+   const char *fn;
+   char nameBuffer[512];
+   for(ResourceObject *match = ResourceManager->findMatch(scriptFilenameBuffer, &fn, NULL); match;
+       match = ResourceManager->findMatch(scriptFilenameBuffer, &fn, match))
+   {
+      StringTableEntry scriptName = StringTable->insert(fn);
+      if(!needsCompile(scriptName, nameBuffer, sizeof(nameBuffer)))
+         continue;
+
+      Stream *s = ResourceManager->openStream(scriptName);
+      if(!s)
+         continue;
+      U32 scriptSize = ResourceManager->getSize(scriptName);
+      char *script = new char[scriptSize + 1];
+      s->read(scriptSize, script);
+      ResourceManager->closeStream(s);
+      script[scriptSize] = 0;
+
+      ScriptCompileJob *job = new ScriptCompileJob;
+      job->scriptName = scriptName;
+      job->dsoName    = StringTable->insert(nameBuffer);
+      job->script     = script;
+      // Only the default parser's state is thread local.
+      job->redo       = Compiler::getParserForFile(scriptName) != Compiler::getParserForFile(NULL);
+      jobList.push_back(job);
+   }
+
+   if(jobList.empty())
+      return 0;
+
+   // Compile to memory in parallel...
+#ifdef TORQUE_SUPPORTS_THREAD_LOCAL
+   if(gThreadPool)
+      gThreadPool->parallelFor(jobList.size(), compileScriptBatch, jobList.address());
+   else
+#endif
+      for(U32 i = 0; i < jobList.size(); i++)
+         jobList[i]->redo = true;
+
+   // ...then write them out in order, and redo the ones that had something to say.
+   S32 count = 0;
+   for(U32 i = 0; i < jobList.size(); i++)
+   {
+      ScriptCompileJob &job = *jobList[i];
+      Con::printf("Compiling %s...", job.scriptName);
+      bool ok;
+      if(job.redo)
+      {
+         CodeBlock *code = new CodeBlock();
+         ok = code->compile(job.dsoName, job.scriptName, job.script);
+         delete code;
+      }
+      else
+         ok = CodeBlock::writeDSO(job.dsoName, job.dso);
+
+      if(ok)
+         count++;
+      delete [] job.script;
+      delete jobList[i];
+   }
+   return count;
+}
+
 ConsoleFunction(eval, const char *, 2, 2, "eval(consoleString)")
 {
    argc;
@@ -261,8 +261,12 @@ void Dictionary::remove(Dictionary::Entry *ent)
       walk = &((*walk)->nextEntry);
 
    *walk = (ent->nextEntry);
+   for(U32 i = 0; i < MaxLocalSlots; i++)
+      if(hashTable->slots[i] == ent)
+         hashTable->slots[i] = NULL;
    delete ent;
    hashTable->count--;
+   hashTable->sequence++;
 }
 
 Dictionary::Dictionary()
@@ -297,11 +301,13 @@ void Dictionary::setState(ExprEvalState *state, Dictionary* ref)
       hashTable = new HashTableData;
       hashTable->owner = this;
       hashTable->count = 0;
+      hashTable->sequence = 0;
       hashTable->size = ST_INIT_SIZE;
       hashTable->data = new Entry *[hashTable->size];
    
       for(S32 i = 0; i < hashTable->size; i++)
          hashTable->data[i] = NULL;
+      dMemset(hashTable->slots, 0, sizeof(hashTable->slots));
    }
 }
 
@@ -333,6 +339,8 @@ void Dictionary::reset()
    }
    hashTable->size = ST_INIT_SIZE;
    hashTable->count = 0;
+   hashTable->sequence++;
+   dMemset(hashTable->slots, 0, sizeof(hashTable->slots));
 }
 
 
@@ -227,6 +227,11 @@ public:
         void setStringValue(const char *value);
     };
 
+    enum
+    {
+        MaxLocalSlots = 32,   ///< Per function local variable slots, see Compiler::getLocalSlot.
+    };
+
 private:
     struct HashTableData
     {
@@ -234,6 +239,8 @@ private:
         S32 size;
         S32 count;
         Entry **data;
+        Entry *slots[MaxLocalSlots];  ///< Entries cached by the slot opcodes, checked by name.
+        U32 sequence;                 ///< Bumped whenever an entry is freed.
     };
 
     HashTableData *hashTable;
@@ -249,6 +256,23 @@ public:
     ~Dictionary();
     Entry *lookup(StringTableEntry name);
     Entry *add(StringTableEntry name);
+
+    /// lookup()/add() through a slot cache.  Frames shared through
+    /// pushFrameRef() may run code with different slot numbering, so a
+    /// cached entry is only used if its name matches.
+    Entry *lookupSlot(StringTableEntry name, U32 slot, bool create)
+    {
+        Entry *ent = hashTable->slots[slot];
+        if(ent && ent->name == name)
+            return ent;
+        ent = create ? add(name) : lookup(name);
+        hashTable->slots[slot] = ent;
+        return ent;
+    }
+    /// Changes whenever an entry is freed, so an Entry pointer looked up
+    /// while it had some value stays valid while it keeps it.
+    U32 getSequence() const { return hashTable->sequence; }
+
     void setState(ExprEvalState *state, Dictionary* ref=NULL);
     void remove(Entry *);
     void reset();
@@ -291,6 +315,8 @@ public:
     Vector<Dictionary *> stack;
     void setCurVarName(StringTableEntry name);
     void setCurVarNameCreate(StringTableEntry name);
+    void setCurLocalVar(StringTableEntry name, U32 slot, bool create);
+    void setCurGlobalVar(StringTableEntry name, CodeBlock *code, U32 &cacheIndex, bool create);
     S32 getIntVariable();
     F64 getFloatVariable();
     const char *getStringVariable();
@@ -17,6 +17,7 @@ ConsoleLogger::ConsoleLogger()
    mFilename = NULL;
    mLogging = false;
    mAppend = false;
+   mFile = -1;
 }
 
 //-----------------------------------------------------------------------------
@@ -24,6 +25,7 @@ ConsoleLogger::ConsoleLogger()
 ConsoleLogger::ConsoleLogger( const char *fileName, bool append )
 {
    mLogging = false;
+   mFile = -1;
 
    mLevel = ConsoleLogEntry::Normal;
    mFilename = StringTable->insert( fileName );
@@ -119,8 +121,13 @@ bool ConsoleLogger::attach()
    if( mLogging )
       return false;
 
-   // Open the filestream
-   mStream.open( mFilename, ( mAppend ? FileStream::WriteAppend : FileStream::Write ) );
+   // Open the file; the log writer's thread does the writing
+   mFile = AsyncLogWriter::openFile( mFilename, ( mAppend ? AsyncLogWriter::Append : AsyncLogWriter::Truncate ) );
+   if( mFile == -1 )
+   {
+      Con::errorf( "ConsoleLogger failed to attach: too many log files open." );
+      return false;
+   }
 
    // Add this to list of active loggers
    mActiveLoggers.push_back( this );
@@ -146,8 +153,10 @@ bool ConsoleLogger::detach()
    if( !mLogging )
       return false;
 
-   // Close filestream
-   mStream.close();
+   // Close the file, and wait for it so the log can be read straight away
+   AsyncLogWriter::closeFile( mFile );
+   AsyncLogWriter::flush();
+   mFile = -1;
 
    // Remove this object from the list of active loggers
    for( int i = 0; i < mActiveLoggers.size(); i++ ) 
@@ -195,7 +204,7 @@ void ConsoleLogger::log( const char *consoleLine )
       }
    }
 
-   mStream.writeLine( (U8 *)consoleLine );
+   AsyncLogWriter::writeLine( mFile, consoleLine );
 }
 
 //-----------------------------------------------------------------------------
@@ -5,7 +5,7 @@
 
 #include "console/simBase.h"
 #include "console/console.h"
-#include "core/fileStream.h"
+#include "console/asyncLogWriter.h"
 
 #ifndef _CONSOLE_LOGGER_H_
 #define _CONSOLE_LOGGER_H_
@@ -18,7 +18,7 @@ class ConsoleLogger : public SimObject
 
    private:
       bool mLogging;                   ///< True if it is currently consuming and logging
-      FileStream mStream;              ///< File stream this object writes to
+      S32 mFile;                       ///< AsyncLogWriter file this object writes to
       static bool smInitialized;                ///< This is for use with the default constructor
       bool mAppend;                    ///< If false, it will clear the file before logging to it.
       StringTableEntry mFilename;      ///< The file name to log to.
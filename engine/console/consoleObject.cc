@@ -22,8 +22,24 @@ U32                                AbstractClassRep::classCRC[NetClassGroupsCoun
 bool                               AbstractClassRep::initialized = false;
 
 //--------------------------------------
+static inline U32 hashFieldName(StringTableEntry name)
+{
+   // StringTableEntries are at least 4 byte aligned.
+   U32 key = U32(dsize_t(name) >> 2);
+   return key ^ (key >> 9) ^ (key >> 17);
+}
+
 const AbstractClassRep::Field *AbstractClassRep::findField(StringTableEntry name) const
 {
+   if(mFieldHash.size())
+   {
+      U32 mask = mFieldHash.size() - 1;
+      for(U32 slot = hashFieldName(name) & mask; mFieldHash[slot] != -1; slot = (slot + 1) & mask)
+         if(mFieldList[mFieldHash[slot]].pFieldname == name)
+            return &mFieldList[mFieldHash[slot]];
+      return NULL;
+   }
+
    for(U32 i = 0; i < mFieldList.size(); i++)
       if(mFieldList[i].pFieldname == name)
          return &mFieldList[i];
@@ -31,6 +47,40 @@ const AbstractClassRep::Field *AbstractClassRep::findField(StringTableEntry name
    return NULL;
 }
 
+void AbstractClassRep::buildFieldHash()
+{
+   mFieldHash.clear();
+   if(!mFieldList.size())
+      return;
+
+   // Keep it at most half full.
+   U32 size = 8;
+   while(size < mFieldList.size() * 2)
+      size <<= 1;
+   mFieldHash.setSize(size);
+   for(U32 i = 0; i < size; i++)
+      mFieldHash[i] = -1;
+
+   U32 mask = size - 1;
+   for(U32 i = 0; i < mFieldList.size(); i++)
+   {
+      StringTableEntry name = mFieldList[i].pFieldname;
+      U32 slot = hashFieldName(name) & mask;
+      bool duplicate = false;
+      for(; mFieldHash[slot] != -1; slot = (slot + 1) & mask)
+      {
+         // Like the linear search, the first field by a name wins.
+         if(mFieldList[mFieldHash[slot]].pFieldname == name)
+         {
+            duplicate = true;
+            break;
+         }
+      }
+      if(!duplicate)
+         mFieldHash[slot] = i;
+   }
+}
+
 //--------------------------------------
 void AbstractClassRep::registerClassRep(AbstractClassRep* in_pRep)
 {
@@ -118,6 +168,7 @@ void AbstractClassRep::initialize()
       // So if we have things in it, copy it over...
       if (sg_tempFieldList.size() != 0)
          walk->mFieldList = sg_tempFieldList;
+      walk->buildFieldHash();
 
       // And of course delete it every round.
       sg_tempFieldList.clear();
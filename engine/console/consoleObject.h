@@ -160,6 +160,7 @@ public:
    AbstractClassRep() 
    {
       VECTOR_SET_ASSOCIATION(mFieldList);
+      VECTOR_SET_ASSOCIATION(mFieldHash);
       parentClass  = NULL;
    }
    virtual ~AbstractClassRep() { }
@@ -250,8 +251,20 @@ public:
 
    bool mDynamicGroupExpand;
 
+   /// Finds the field named fieldName, which must be a StringTableEntry.
+   ///
+   /// Uses mFieldHash once initialize() has built it.
    const Field *findField(StringTableEntry fieldName) const;
 
+protected:
+   /// Open addressed table of indices into mFieldList, keyed on the name
+   /// pointer; -1 marks an empty slot.  Its size is a power of two.
+   Vector<S32> mFieldHash;
+
+   void buildFieldHash();
+
+public:
+
    /// @}
 
    /// @name Abstract Class Database
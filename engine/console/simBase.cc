@@ -40,47 +40,185 @@ namespace Sim
 
 //---------------------------------------------------------------------------
 
+SimObject *const SimObjectList::Removed = (SimObject *) 1;
+
+static inline U32 hashObjectPtr(SimObject *obj)
+{
+   U32 key = U32(dsize_t(obj) >> 3);
+   return key ^ (key >> 11) ^ (key >> 19);
+}
+
+bool SimObjectList::useIndex()
+{
+   if(!mIndex.size())
+   {
+      if(size() < IndexThreshold)
+         return false;
+      buildIndex();
+      return true;
+   }
+
+   // Keep it until the list is well under the threshold, so a list
+   // hovering around it doesn't rebuild over and over.
+   if(size() < IndexThreshold / 2)
+   {
+      mIndex.clear();
+      mIndexUsed = mIndexCount = 0;
+      return false;
+   }
+
+   if(mIndexCount != size())
+      buildIndex();
+   return true;
+}
+
+void SimObjectList::buildIndex()
+{
+   // Rebuilt once a quarter full, counting deleted slots.
+   U32 capacity = 64;
+   while(capacity < U32(size()) * 4)
+      capacity <<= 1;
+
+   mIndex.setSize(capacity);
+   dMemset(mIndex.address(), 0, capacity * sizeof(IndexSlot));
+   mIndexUsed = mIndexCount = 0;
+
+   for(S32 i = 0; i < size(); i++)
+      if(!findSlot((*this)[i]))
+         indexAdd((*this)[i], i);
+}
+
+SimObjectList::IndexSlot *SimObjectList::findSlot(SimObject *obj)
+{
+   U32 mask = mIndex.size() - 1;
+   for(U32 i = hashObjectPtr(obj) & mask; mIndex[i].obj; i = (i + 1) & mask)
+      if(mIndex[i].obj == obj)
+         return &mIndex[i];
+   return NULL;
+}
+
+void SimObjectList::indexAdd(SimObject *obj, S32 pos)
+{
+   if((mIndexUsed + 1) * 4 > mIndex.size())
+   {
+      // obj is already in the vector, so the rebuild picks it up.
+      buildIndex();
+      return;
+   }
+
+   U32 mask = mIndex.size() - 1;
+   U32 i = hashObjectPtr(obj) & mask;
+   while(mIndex[i].obj && mIndex[i].obj != Removed)
+      i = (i + 1) & mask;
+
+   if(!mIndex[i].obj)
+      mIndexUsed++;
+   mIndex[i].obj = obj;
+   mIndex[i].pos = pos;
+   mIndexCount++;
+}
+
+S32 SimObjectList::findPos(SimObject *obj)
+{
+   if(!useIndex())
+   {
+      iterator ptr = find(begin(),end(),obj);
+      return ptr != end() ? ptr - begin() : -1;
+   }
+
+   IndexSlot *slot = findSlot(obj);
+   if(!slot)
+      return -1;
+
+   // Erases only move entries down, so look back from where it went in
+   // first; anything else that moved it means looking forward too.
+   S32 hint = getMin(slot->pos, size() - 1);
+   for(S32 i = hint; i >= 0; i--)
+      if((*this)[i] == obj)
+         return i;
+   for(S32 i = hint + 1; i < size(); i++)
+      if((*this)[i] == obj)
+         return i;
+
+   AssertFatal(false, "SimObjectList::findPos - index is out of date!");
+   return -1;
+}
+
+void SimObjectList::erasePos(S32 pos)
+{
+   SimObject *obj = (*this)[pos];
+   erase(begin() + pos);
+
+   if(mIndex.size())
+   {
+      IndexSlot *slot = findSlot(obj);
+      if(slot)
+      {
+         slot->obj = Removed;
+         mIndexCount--;
+      }
+   }
+}
+
+bool SimObjectList::contains(SimObject* obj)
+{
+   if(useIndex())
+      return findSlot(obj) != NULL;
+   return find(begin(),end(),obj) != end();
+}
+
 void SimObjectList::pushBack(SimObject* obj)
 {
-   if (find(begin(),end(),obj) == end())
+   if (!contains(obj))
+   {
       push_back(obj);
+      if (mIndex.size())
+         indexAdd(obj, size() - 1);
+   }
 }	
 
 void SimObjectList::pushBackForce(SimObject* obj)
 {
-   iterator itr = find(begin(),end(),obj);
-   if (itr == end()) 
+   S32 pos = findPos(obj);
+   if (pos == -1) 
    {
       push_back(obj);
+      if (mIndex.size())
+         indexAdd(obj, size() - 1);
    }
    else 
    {
       // Move to the back...
       //
-      SimObject* pBack = *itr;
-      removeStable(pBack);
-      push_back(pBack);
+      erase(begin() + pos);
+      push_back(obj);
+      if (mIndex.size())
+         findSlot(obj)->pos = size() - 1;
    }
 }	
 
 void SimObjectList::pushFront(SimObject* obj)
 {
-   if (find(begin(),end(),obj) == end())
+   if (!contains(obj))
+   {
       push_front(obj);
+      if (mIndex.size())
+         indexAdd(obj, 0);
+   }
 }	
 
 void SimObjectList::remove(SimObject* obj)
 {
-   iterator ptr = find(begin(),end(),obj);
-   if (ptr != end()) 
-      erase(ptr);
+   S32 pos = findPos(obj);
+   if (pos != -1) 
+      erasePos(pos);
 }
 
 void SimObjectList::removeStable(SimObject* obj)
 {
-   iterator ptr = find(begin(),end(),obj);
-   if (ptr != end()) 
-      erase(ptr);
+   S32 pos = findPos(obj);
+   if (pos != -1) 
+      erasePos(pos);
 }
 
 S32 QSORT_CALLBACK SimObjectList::compareId(const void* a,const void* b)
@@ -98,99 +236,149 @@ void SimObjectList::sortId()
 //---------------------------------------------------------------------------
 //---------------------------------------------------------------------------
 
-SimFieldDictionary::Entry *SimFieldDictionary::mFreeList = NULL;
-
-static Chunker<SimFieldDictionary::Entry> fieldChunker;
+static FreeListPool<SimFieldDictionary::Entry> fieldPool;
 
 SimFieldDictionary::Entry *SimFieldDictionary::allocEntry()
 {
-   if(mFreeList)
-   {
-      Entry *ret = mFreeList;
-      mFreeList = ret->next;
-      return ret;
-   }
-   else
-      return fieldChunker.alloc();
+   return fieldPool.alloc();
 }
 
 void SimFieldDictionary::freeEntry(SimFieldDictionary::Entry *ent)
 {
-   ent->next = mFreeList;
-   mFreeList = ent;
+   if(ent->value != ent->inlineValue)
+      dFree(ent->value);
+   fieldPool.free(ent);
+}
+
+void SimFieldDictionary::setEntryValue(Entry *ent, const char *value)
+{
+   // The value may be the entry's own, or part of it.
+   U32 len = dStrlen(value) + 1;
+   char *old = ent->value != ent->inlineValue ? ent->value : NULL;
+   if(len <= InlineValueSize)
+   {
+      dMemmove(ent->inlineValue, value, len);
+      ent->value = ent->inlineValue;
+   }
+   else
+   {
+      ent->value = (char *) dMalloc(len);
+      dMemcpy(ent->value, value, len);
+   }
+   if(old)
+      dFree(old);
 }
 
 SimFieldDictionary::SimFieldDictionary()
 {
-   for(U32 i = 0; i < HashTableSize; i++)
-      mHashTable[i] = 0;
+   mTable = NULL;
+   mTableSize = 0;
+   mTableShift = 32;
+   mCount = 0;
 
    mVersion = 0;
 }
 
 SimFieldDictionary::~SimFieldDictionary()
 {
-   for(U32 i = 0; i < HashTableSize; i++)
-   {
-      for(Entry *walk = mHashTable[i]; walk;)
-      {
-         Entry *temp = walk;
-         walk = temp->next;
+   for(U32 i = 0; i < mTableSize; i++)
+      if(mTable[i])
+         freeEntry(mTable[i]);
+   dFree(mTable);
+}
 
-         dFree(temp->value);
-         freeEntry(temp);
-      }
-   }
+U32 SimFieldDictionary::findSlot(StringTableEntry slotName) const
+{
+   U32 mask = mTableSize - 1;
+   U32 slot = getHomeSlot(slotName);
+   while(mTable[slot] && mTable[slot]->slotName != slotName)
+      slot = (slot + 1) & mask;
+   return slot;
 }
 
-void SimFieldDictionary::setFieldValue(StringTableEntry slotName, const char *value)
+void SimFieldDictionary::resizeTable(U32 newSize)
 {
-   U32 bucket = HashPointer(slotName) % HashTableSize;
-   Entry **walk = &mHashTable[bucket];
-   while(*walk && (*walk)->slotName != slotName)
-      walk = &((*walk)->next);
+   Entry **oldTable = mTable;
+   U32 oldSize = mTableSize;
+
+   mTableSize = newSize;
+   mTableShift = 32;
+   for(U32 size = newSize; size > 1; size >>= 1)
+      mTableShift--;
+   mTable = (Entry **) dMalloc(newSize * sizeof(Entry *));
+   dMemset(mTable, 0, newSize * sizeof(Entry *));
 
-   Entry *field = *walk;
+   for(U32 i = 0; i < oldSize; i++)
+      if(oldTable[i])
+         mTable[findSlot(oldTable[i]->slotName)] = oldTable[i];
+   dFree(oldTable);
+}
+
+void SimFieldDictionary::setFieldValue(StringTableEntry slotName, const char *value)
+{
    if(!*value)
    {
-      if(field)
-      {
-         mVersion++;
+      if(!mCount)
+         return;
+
+      U32 slot = findSlot(slotName);
+      Entry *field = mTable[slot];
+      if(!field)
+         return;
+
+      mVersion++;
+      mCount--;
+      freeEntry(field);
+      mTable[slot] = NULL;
 
-         dFree(field->value);
-         *walk = field->next;
-         freeEntry(field);
+      // Shift back the entries after it that would no longer be found,
+      // rather than leaving a tombstone.
+      U32 mask = mTableSize - 1;
+      U32 hole = slot;
+      for(U32 next = (slot + 1) & mask; mTable[next]; next = (next + 1) & mask)
+      {
+         U32 home = getHomeSlot(mTable[next]->slotName);
+         if(((next - home) & mask) >= ((next - hole) & mask))
+         {
+            mTable[hole] = mTable[next];
+            mTable[next] = NULL;
+            hole = next;
+         }
       }
+      return;
    }
-   else
+
+   if(mTable)
    {
+      Entry *field = mTable[findSlot(slotName)];
       if(field)
       {
-         dFree(field->value);
-         field->value = dStrdup(value);
-      }
-      else
-      {
-         mVersion++;
-
-         field = allocEntry();
-         field->value = dStrdup(value);
-         field->slotName = slotName;
-         field->next = NULL;
-         *walk = field;
+         setEntryValue(field, value);
+         return;
       }
    }
+
+   if((mCount + 1) * 2 > mTableSize)
+      resizeTable(mTableSize ? mTableSize * 2 : MinTableSize);
+
+   mVersion++;
+   mCount++;
+
+   Entry *field = allocEntry();
+   field->slotName = slotName;
+   field->value = field->inlineValue;
+   field->next = NULL;
+   setEntryValue(field, value);
+   mTable[findSlot(slotName)] = field;
 }
 
 const char *SimFieldDictionary::getFieldValue(StringTableEntry slotName)
 {
-   U32 bucket = HashPointer(slotName) % HashTableSize;
-
-   for(Entry *walk = mHashTable[bucket];walk;walk = walk->next)
-      if(walk->slotName == slotName)
-         return walk->value;
+   if(!mCount)
+      return NULL;
 
-   return NULL;
+   Entry *field = mTable[findSlot(slotName)];
+   return field ? field->value : NULL;
 }
 
 //---------------------------------------------------------------------------
@@ -225,8 +413,8 @@ void SimFieldDictionary::assignFrom(SimFieldDictionary *dict)
 {
    mVersion++;
 
-   for(U32 i = 0; i < HashTableSize; i++)
-      for(Entry *walk = dict->mHashTable[i];walk; walk = walk->next)
+   for(U32 i = 0; i < dict->mTableSize; i++)
+      if(Entry *walk = dict->mTable[i])
          setFieldValue(walk->slotName, walk->value);
 }
 
@@ -234,9 +422,9 @@ void SimFieldDictionary::writeFields(SimObject *obj, Stream &stream, U32 tabStop
 {
    const AbstractClassRep::FieldList &list = obj->getFieldList();
    
-   for(U32 i = 0; i < HashTableSize; i++)
+   for(U32 t = 0; t < mTableSize; t++)
    {
-      for(Entry *walk = mHashTable[i];walk; walk = walk->next)
+      if(Entry *walk = mTable[t])
       {
          // make sure we haven't written this out yet:
          U32 i;
@@ -276,9 +464,9 @@ void SimFieldDictionary::printFields(SimObject *obj)
    char expandedBuffer[4096];
    Vector<Entry *> flist(__FILE__, __LINE__);
 
-   for(U32 i = 0; i < HashTableSize; i++)
+   for(U32 t = 0; t < mTableSize; t++)
    {
-      for(Entry *walk = mHashTable[i];walk; walk = walk->next)
+      if(Entry *walk = mTable[t])
       {
          // make sure we haven't written this out yet:
          U32 i;
@@ -306,7 +494,7 @@ void SimFieldDictionary::printFields(SimObject *obj)
 SimFieldDictionaryIterator::SimFieldDictionaryIterator(SimFieldDictionary * dictionary)
 {
    mDictionary = dictionary;
-   mHashIndex = -1;
+   mIndex = -1;
    mEntry = 0;
    operator++();
 }
@@ -316,11 +504,9 @@ SimFieldDictionary::Entry* SimFieldDictionaryIterator::operator++()
    if(!mDictionary)
       return(mEntry);
 
-   if(mEntry)
-      mEntry = mEntry->next;
-
-   while(!mEntry && (mHashIndex < (SimFieldDictionary::HashTableSize-1)))
-      mEntry = mDictionary->mHashTable[++mHashIndex];
+   mEntry = NULL;
+   while(!mEntry && (mIndex + 1 < S32(mDictionary->mTableSize)))
+      mEntry = mDictionary->mTable[++mIndex];
 
    return(mEntry);
 }
@@ -543,19 +729,19 @@ ConsoleFunction(isObject, bool, 2, 2, "isObject(object)")
    if (!dStrcmp(argv[1], "0") || !dStrcmp(argv[1], ""))
       return false;
    else
-      return (Sim::findObject(argv[1]) != NULL);
+      return (Con::readObjectArg(argv, 1) != NULL);
 }
 
 ConsoleFunction(cancel,void,2,2,"cancel(eventId)")
 {
    argc;
-   Sim::cancelEvent(dAtoi(argv[1]));
+   Sim::cancelEvent(Con::readIntArg(argv, 1));
 }
 
 ConsoleFunction(isEventPending, bool, 2, 2, "isEventPending(%scheduleId);")
 {
    argc;
-   return Sim::isEventPending(dAtoi(argv[1]));
+   return Sim::isEventPending(Con::readIntArg(argv, 1));
 }
 
 ConsoleFunction(getEventTimeLeft, S32, 2, 2, "getEventTimeLeft(scheduleId) Get the time left in ms until this event will trigger.")
@@ -860,11 +1046,15 @@ const char *SimObject::tabComplete(const char *prevText, S32 baseLen, bool fForw
 }
 
 void SimObject::setDataField(StringTableEntry slotName, const char *array, const char *value)
+{
+   setDataField(slotName, array, value, mFlags.test(ModStaticFields) ? findField(slotName) : NULL);
+}
+
+void SimObject::setDataField(StringTableEntry slotName, const char *array, const char *value, const AbstractClassRep::Field *fld)
 {
    // first search the static fields if enabled
    if(mFlags.test(ModStaticFields))
    {
-      const AbstractClassRep::Field *fld = findField(slotName);
       if(fld)
       {
       if( fld->type == AbstractClassRep::DepricatedFieldType ||
@@ -938,12 +1128,16 @@ void  SimObject::dumpClassHierarchy()
 }
 
 const char *SimObject::getDataField(StringTableEntry slotName, const char *array)
+{
+   return getDataField(slotName, array, mFlags.test(ModStaticFields) ? findField(slotName) : NULL);
+}
+
+const char *SimObject::getDataField(StringTableEntry slotName, const char *array, const AbstractClassRep::Field *fld)
 {
    if(mFlags.test(ModStaticFields))
    {
       S32 array1 = array ? dAtoi(array) : -1;
-      const AbstractClassRep::Field *fld = findField(slotName);
-   
+
       if(fld)
       {
          if(array1 == -1 && fld->elementCount == 1)
@@ -1106,26 +1300,18 @@ ConsoleMethod(SimObject, isChildOfGroup, bool, 3,3," returns true, if we are in
 }
 //---------------------------------------------------------------------------
 
-static Chunker<SimObject::Notify> notifyChunker(128000);
-SimObject::Notify *SimObject::mNotifyFreeList = NULL;
+static FreeListPool<SimObject::Notify> notifyPool(128000);
 
 SimObject::Notify *SimObject::allocNotify()
 {
-   if(mNotifyFreeList)
-   {
-      SimObject::Notify *ret = mNotifyFreeList;
-      mNotifyFreeList = ret->next;
-      return ret;
-   }
-   return notifyChunker.alloc();
+   return notifyPool.alloc();
 }
 
 void SimObject::freeNotify(SimObject::Notify* note)
 {
    AssertFatal(note->type != SimObject::Notify::Invalid, "Invalid notify");
    note->type = SimObject::Notify::Invalid;
-   note->next = mNotifyFreeList;
-   mNotifyFreeList = note;
+   notifyPool.free(note);
 }
 
 //------------------------------------------------------------------------------
@@ -1734,7 +1920,7 @@ void SimGroup::addObject(SimObject* obj)
          obj->mGroup->removeObject(obj);
       nameDictionary.insert(obj);
       obj->mGroup = this;
-      objectList.push_back(obj); // force it into the object list
+      objectList.pushBack(obj);  // force it into the object list
                                  // doesn't get a delete notify
       obj->onGroupAdd();
    }
@@ -72,14 +72,53 @@ typedef U32 SimObjectId;
 /// A vector of SimObjects.
 ///
 /// As this inherits from VectorPtr, it has the full range of vector methods.
+///
+/// Once a list grows past IndexThreshold entries it keeps a hash of its
+/// members, so the duplicate checks in pushBack() and friends and the
+/// search in remove() don't walk the list.  Each member's slot also holds
+/// the position it was added at, which remove() checks first and then
+/// searches back from, since erasing only moves later entries down.
+/// Order is never changed by the index.
+///
+/// The hash only tracks membership, so reordering the vector directly
+/// (sorting, erase() and insert() of the same object) is fine.  If the
+/// vector's size stops matching the hash, because something was added or
+/// removed behind its back, it is rebuilt on the next use.
 class SimObjectList: public VectorPtr<SimObject*>
 {
    static S32 QSORT_CALLBACK compareId(const void* a,const void* b);
+
+   enum
+   {
+      IndexThreshold = 32
+   };
+
+   struct IndexSlot
+   {
+      SimObject *obj;      ///< NULL if empty, Removed if deleted.
+      S32 pos;             ///< Position at insertion.
+   };
+   Vector<IndexSlot> mIndex;
+   S32 mIndexUsed;         ///< Slots that aren't empty, deleted ones included.
+   S32 mIndexCount;        ///< Members in the hash.
+
+   static SimObject *const Removed;
+
+   bool useIndex();
+   void buildIndex();
+   IndexSlot *findSlot(SimObject *obj);
+   void indexAdd(SimObject *obj, S32 pos);
+   S32  findPos(SimObject *obj);
+   void erasePos(S32 pos);
+
   public:
+   SimObjectList() { mIndexUsed = mIndexCount = 0; }
+
    void pushBack(SimObject*);       ///< Add the SimObject* to the end of the list, unless it's already in the list.
    void pushBackForce(SimObject*);  ///< Add the SimObject* to the end of the list, moving it there if it's already present in the list.
    void pushFront(SimObject*);      ///< Add the SimObject* to the start of the list.
    void remove(SimObject*);         ///< Remove the SimObject* from the list; may disrupt order of the list.
+   bool contains(SimObject*);       ///< Is the SimObject* in the list?
 
    SimObject* at(S32 index) const {  if(index >= 0 && index < size()) return (*this)[index]; return NULL; }
    /// Remove the SimObject* from the list; guaranteed to preserve list order.
@@ -109,7 +148,8 @@ class SimObjectList: public VectorPtr<SimObject*>
 class SimEvent
 {
   public:
-   SimEvent *nextEvent;     ///< Linked list details - pointer to next item in the list.
+   SimEvent *nextHashEvent; ///< Next event in the same sequence number hash bucket.
+   S32 heapIndex;           ///< Position in the event queue heap.
    SimTime startTime;       ///< When the event was posted.
    SimTime time;            ///< When the event is scheduled to occur.
    U32 sequenceCount;       ///< Unique ID. These are assigned sequentially based on order
@@ -194,27 +234,51 @@ public:
 
 //---------------------------------------------------------------------------
 /// Dictionary to keep track of dynamic fields on SimObject.
+///
+/// The entries are found through an open addressed table of pointers,
+/// linearly probed, so a lookup is usually one or two compares without
+/// chasing a chain.  The entries themselves come from a pool and don't move,
+/// so an Entry pointer stays good until that field is removed.  Short values
+/// are kept in the entry instead of being allocated.
 class SimFieldDictionary
 {
    friend class SimFieldDictionaryIterator;
 
   public:
+   enum
+   {
+      InlineValueSize = 24          ///< Values this long, with the terminator, aren't allocated.
+   };
+
    struct Entry
    {
       StringTableEntry slotName;
-      char *value;
-      Entry *next;
+      char *value;                  ///< Points at inlineValue or an allocation.
+      Entry *next;                  ///< Only used by the pool.
+      char inlineValue[InlineValueSize];
    };
   private:
    enum
    {
-      HashTableSize = 19
+      MinTableSize = 8
    };
-   Entry *mHashTable[HashTableSize];
+   Entry **mTable;                  ///< NULL until the first field is set.
+   U32 mTableSize;                  ///< Power of two, at most half full.
+   U32 mTableShift;                 ///< 32 - log2(mTableSize).
+   U32 mCount;
 
-   static Entry *mFreeList;
    static void freeEntry(Entry *entry);
    static Entry *allocEntry();
+   static void setEntryValue(Entry *entry, const char *value);
+
+   U32 getHomeSlot(StringTableEntry slotName) const
+   {
+      // Fibonacci hashing, string table pointers only differ in the low bits.
+      return (U32(dsize_t(slotName) >> 2) * 2654435769U) >> mTableShift;
+   }
+   /// Slot holding slotName, or the empty slot it would go in.
+   U32 findSlot(StringTableEntry slotName) const;
+   void resizeTable(U32 newSize);
 
    /// In order to efficiently detect when a dynamic field has been
    /// added or deleted, we increment this every time we add or
@@ -236,7 +300,7 @@ public:
 class SimFieldDictionaryIterator
 {
    SimFieldDictionary *          mDictionary;
-   S32                           mHashIndex;
+   S32                           mIndex;
    SimFieldDictionary::Entry *   mEntry;
 
   public:
@@ -502,7 +566,6 @@ class SimObject: public ConsoleObject
    /// Helper functions for notification code.
    /// @{
 
-   static SimObject::Notify *mNotifyFreeList;
    static SimObject::Notify *allocNotify();     ///< Get a free Notify structure.
    static void freeNotify(SimObject::Notify*);  ///< Mark a Notify structure as free.
 
@@ -528,6 +591,13 @@ protected:
    ///                      (if field is an array); if NULL, it is ignored.
    const char *getDataField(StringTableEntry slotName, const char *array);
 
+   /// Same as getDataField(slotName, array), but with the static field
+   /// already looked up.
+   ///
+   /// @param   fld         findField(slotName) for this object's class; NULL
+   ///                      if it has no static field by that name.
+   const char *getDataField(StringTableEntry slotName, const char *array, const AbstractClassRep::Field *fld);
+
    /// Set the value of a field on the object.
    ///
    /// See @ref simobject_console "here" for a detailed discussion of what this
@@ -538,6 +608,10 @@ protected:
    /// @param   value       Value to store.
    void setDataField(StringTableEntry slotName, const char *array, const char *value);
 
+   /// Same as setDataField(slotName, array, value), with fld as for
+   /// getDataField().
+   void setDataField(StringTableEntry slotName, const char *array, const char *value, const AbstractClassRep::Field *fld);
+
    /// Get reference to the dictionary containing dynamic fields.
    ///
    /// See @ref simobject_console "here" for a detailed discussion of what this
@@ -1338,6 +1412,8 @@ namespace Sim
    void advanceTime(SimTime delta);
    SimTime getCurrentTime();
    SimTime getTargetTime();
+   /// Ms until the next posted event is due, at most maxTime.
+   SimTime getTimeToNextEvent(SimTime maxTime);
 
    /// a target time of 0 on an event means current event
    U32 postEvent(SimObject*, SimEvent*, U32 targetTime);
@@ -5,6 +5,8 @@
 
 #include "platform/platform.h"
 #include "platform/platformMutex.h"
+#include "platform/platformAtomic.h"
+#include "core/tRingBuffer.h"
 #include "console/simBase.h"
 #include "core/stringTable.h"
 #include "console/console.h"
@@ -29,13 +31,150 @@ namespace Sim
 
 //---------------------------------------------------------------------------
 // event queue variables:
+//
+// Pending events live in a binary min-heap ordered by time, then by
+// sequence number so events posted for the same time still fire in the
+// order they were posted.  Each event also sits in a small hash keyed by
+// its sequence number, which is what cancellation and the pending tests
+// look it up by.
+//
+// Events posted from other threads don't touch the heap; they go through
+// a lock-free queue that the main thread folds into the heap whenever it
+// looks at it, so a worker never waits for the main thread to finish
+// processing events.
 
 SimTime gCurrentTime;
 SimTime gTargetTime;
 
 void *gEventQueueMutex;
-SimEvent *gEventQueue;
-U32 gEventSequence;
+Vector<SimEvent *> gEventQueue;
+volatile U32 gEventSequence;
+
+enum { ThreadEventQueueSize = 1024 };
+static MPSCQueue<SimEvent *, ThreadEventQueueSize> gThreadEventQueue;
+
+enum { EventHashSize = 4096 };
+static SimEvent *gEventHash[EventHashSize];
+
+S32 gEventQueueDepth;      ///< $Stats::simEventQueueDepth
+S32 gEventQueuePeakDepth;  ///< $Stats::simEventQueuePeakDepth
+
+//---------------------------------------------------------------------------
+// event heap
+
+static inline bool eventBefore(const SimEvent *a, const SimEvent *b)
+{
+   if(a->time != b->time)
+      return a->time < b->time;
+   return a->sequenceCount < b->sequenceCount;
+}
+
+static inline void eventHeapPlace(SimEvent *event, U32 index)
+{
+   gEventQueue[index] = event;
+   event->heapIndex = index;
+}
+
+static void eventHeapSiftUp(U32 index)
+{
+   SimEvent *event = gEventQueue[index];
+   while(index)
+   {
+      U32 parent = (index - 1) >> 1;
+      if(!eventBefore(event, gEventQueue[parent]))
+         break;
+      eventHeapPlace(gEventQueue[parent], index);
+      index = parent;
+   }
+   eventHeapPlace(event, index);
+}
+
+static void eventHeapSiftDown(U32 index)
+{
+   SimEvent *event = gEventQueue[index];
+   U32 count = gEventQueue.size();
+   for(;;)
+   {
+      U32 child = (index << 1) + 1;
+      if(child >= count)
+         break;
+      if(child + 1 < count && eventBefore(gEventQueue[child + 1], gEventQueue[child]))
+         child++;
+      if(!eventBefore(gEventQueue[child], event))
+         break;
+      eventHeapPlace(gEventQueue[child], index);
+      index = child;
+   }
+   eventHeapPlace(event, index);
+}
+
+static void eventHashInsert(SimEvent *event)
+{
+   SimEvent **bucket = &gEventHash[event->sequenceCount & (EventHashSize - 1)];
+   event->nextHashEvent = *bucket;
+   *bucket = event;
+}
+
+static void eventHashRemove(SimEvent *event)
+{
+   SimEvent **walk = &gEventHash[event->sequenceCount & (EventHashSize - 1)];
+   while(*walk != event)
+      walk = &((*walk)->nextHashEvent);
+   *walk = event->nextHashEvent;
+}
+
+static void eventHeapInsert(SimEvent *event)
+{
+   gEventQueue.push_back(event);
+   eventHeapSiftUp(gEventQueue.size() - 1);
+   eventHashInsert(event);
+
+   gEventQueueDepth = gEventQueue.size();
+   if(gEventQueueDepth > gEventQueuePeakDepth)
+      gEventQueuePeakDepth = gEventQueueDepth;
+}
+
+/// Moves events posted from other threads into the heap.  Main thread only,
+/// with gEventQueueMutex held.
+static void drainThreadEvents()
+{
+   SimEvent *event;
+   while(gThreadEventQueue.pop(event))
+   {
+      // The poster read the time without the lock and may be a little behind.
+      if(event->time < gCurrentTime)
+         event->time = gCurrentTime;
+      eventHeapInsert(event);
+   }
+}
+
+static SimEvent *findEvent(U32 eventSequence)
+{
+   drainThreadEvents();
+   for(SimEvent *walk = gEventHash[eventSequence & (EventHashSize - 1)]; walk; walk = walk->nextHashEvent)
+      if(walk->sequenceCount == eventSequence)
+         return walk;
+   return NULL;
+}
+
+/// Takes an event out of the queue without deleting it.
+static void removeEvent(SimEvent *event)
+{
+   eventHashRemove(event);
+
+   U32 index = event->heapIndex;
+   SimEvent *last = gEventQueue.last();
+   gEventQueue.decrement();
+   gEventQueueDepth = gEventQueue.size();
+   if(last == event)
+      return;
+
+   eventHeapPlace(last, index);
+   if(index && eventBefore(last, gEventQueue[(index - 1) >> 1]))
+      eventHeapSiftUp(index);
+   else
+      eventHeapSiftDown(index);
+}
 
 //---------------------------------------------------------------------------
 // event queue init/shutdown
@@ -45,21 +184,26 @@ static void initEventQueue()
    gCurrentTime = 0;
    gTargetTime = 0;
    gEventSequence = 1;
-   gEventQueue = NULL;
+   gEventQueue.clear();
+   dMemset(gEventHash, 0, sizeof(gEventHash));
+   gEventQueueDepth = 0;
+   gEventQueuePeakDepth = 0;
    gEventQueueMutex = Mutex::createMutex();
+
+   Con::addVariable("Stats::simEventQueueDepth",     TypeS32, &gEventQueueDepth);
+   Con::addVariable("Stats::simEventQueuePeakDepth", TypeS32, &gEventQueuePeakDepth);
 }
 
 static void shutdownEventQueue()
 {
    // Delete all pending events
    Mutex::lockMutex(gEventQueueMutex);
-   SimEvent *walk = gEventQueue;
-   while(walk)
-   {
-      SimEvent *temp = walk->nextEvent;
-      delete walk;
-      walk = temp;
-   }
+   drainThreadEvents();
+   for(U32 i = 0; i < gEventQueue.size(); i++)
+      delete gEventQueue[i];
+   gEventQueue.clear();
+   dMemset(gEventHash, 0, sizeof(gEventHash));
+   gEventQueueDepth = 0;
    Mutex::unlockMutex(gEventQueueMutex);
    Mutex::destroyMutex(gEventQueueMutex);
 }
@@ -69,40 +213,37 @@ static void shutdownEventQueue()
 
 U32 postEvent(SimObject *destObject, SimEvent* event,U32 time)
 {
-	AssertFatal(time >= getCurrentTime(),
+	AssertFatal(time >= getCurrentTime() || !Con::isMainThread(),
 		"Sim::postEvent: Cannot go back in time. (flux capacitor unavailable -- BJG)");
    AssertFatal(destObject, "Destination object for event doesn't exist.");
 
-   Mutex::lockMutex(gEventQueueMutex);
-
    event->time = time;
    event->destObject = destObject;
 
    if(!destObject)
    {
       delete event;
-
-      Mutex::unlockMutex(gEventQueueMutex);
-
       return InvalidEventId;
    }
-   event->sequenceCount = gEventSequence++;
-   SimEvent **walk = &gEventQueue;
-   SimEvent *current;
-   
-   while((current = *walk) != NULL && (current->time < event->time))
-      walk = &(current->nextEvent);
-   
-   // [tom, 6/24/2005] This ensures that SimEvents are dispatched in the same order that they are posted.
-   // This is needed to ensure Con::threadSafeExecute() executes script code in the correct order.
-   while((current = *walk) != NULL && (current->time == event->time))
-      walk = &(current->nextEvent);
-   
-   event->nextEvent = current;
-   *walk = event;
-
-   U32 seqCount = event->sequenceCount;
+   // [tom, 6/24/2005] Events with the same time must be dispatched in the same order
+   // that they are posted.  This is needed to ensure Con::threadSafeExecute() executes
+   // script code in the correct order; the heap breaks time ties on sequenceCount.
+   U32 seqCount = dFetchAndAdd(gEventSequence, 1);
+   event->sequenceCount = seqCount;
+
+#ifdef TORQUE_MULTITHREAD
+   if(!Con::isMainThread())
+   {
+      // Only wait if the main thread has fallen a thousand events behind.
+      while(!gThreadEventQueue.push(event))
+         Platform::sleep(1);
+      return seqCount;
+   }
+#endif
 
+   Mutex::lockMutex(gEventQueueMutex);
+   drainThreadEvents();
+   eventHeapInsert(event);
    Mutex::unlockMutex(gEventQueueMutex);
 
    return seqCount;
@@ -115,20 +256,11 @@ void cancelEvent(U32 eventSequence)
 {
    Mutex::lockMutex(gEventQueueMutex);
 
-   SimEvent **walk = &gEventQueue;
-   SimEvent *current;
-   
-   while((current = *walk) != NULL)
+   SimEvent *event = findEvent(eventSequence);
+   if(event)
    {
-      if(current->sequenceCount == eventSequence)
-      {
-         *walk = current->nextEvent;
-         delete current;
-         Mutex::unlockMutex(gEventQueueMutex);
-         return;
-      }
-      else
-         walk = &(current->nextEvent);
+      removeEvent(event);
+      delete event;
    }
 
    Mutex::unlockMutex(gEventQueueMutex);
@@ -137,20 +269,31 @@ void cancelEvent(U32 eventSequence)
 static void cancelPendingEvents(SimObject *obj)
 {
    Mutex::lockMutex(gEventQueueMutex);
+   drainThreadEvents();
 
-   SimEvent **walk = &gEventQueue;
-   SimEvent *current;
-   
-   while((current = *walk) != NULL)
+   // Compact out the object's events, then rebuild the heap in one go
+   // instead of fixing it up per removal.
+   U32 count = 0;
+   for(U32 i = 0; i < gEventQueue.size(); i++)
    {
-      if(current->destObject == obj)
+      SimEvent *event = gEventQueue[i];
+      if(event->destObject == obj)
       {
-         *walk = current->nextEvent;
-         delete current;
+         eventHashRemove(event);
+         delete event;
       }
       else
-         walk = &(current->nextEvent);
+         eventHeapPlace(event, count++);
    }
+
+   if(count != gEventQueue.size())
+   {
+      gEventQueue.setSize(count);
+      for(S32 i = S32(count >> 1) - 1; i >= 0; i--)
+         eventHeapSiftDown(i);
+      gEventQueueDepth = count;
+   }
+
    Mutex::unlockMutex(gEventQueueMutex);
 }
 
@@ -160,48 +303,45 @@ static void cancelPendingEvents(SimObject *obj)
 bool isEventPending(U32 eventSequence)
 {
    Mutex::lockMutex(gEventQueueMutex);
-
-   for(SimEvent *walk = gEventQueue; walk; walk = walk->nextEvent)
-      if(walk->sequenceCount == eventSequence)
-      {
-         Mutex::unlockMutex(gEventQueueMutex);
-         return true;
-      }
+   bool pending = findEvent(eventSequence) != NULL;
    Mutex::unlockMutex(gEventQueueMutex);
-   return false;
+   return pending;
 }
 
 U32 getEventTimeLeft(U32 eventSequence)
 {
    Mutex::lockMutex(gEventQueueMutex);
 
-   for(SimEvent *walk = gEventQueue; walk; walk = walk->nextEvent)
-      if(walk->sequenceCount == eventSequence)
-      {
-         SimTime t = walk->time - getCurrentTime();
-         Mutex::unlockMutex(gEventQueueMutex);
-         return t;
-      }
+   SimEvent *event = findEvent(eventSequence);
+   SimTime t = event ? event->time - getCurrentTime() : 0;
 
    Mutex::unlockMutex(gEventQueueMutex);
 
-   return 0;   
+   return t;   
 }
 
 U32 getScheduleDuration(U32 eventSequence)
 {
-   for(SimEvent *walk = gEventQueue; walk; walk = walk->nextEvent)
-      if(walk->sequenceCount == eventSequence)
-         return (walk->time-walk->startTime);
-   return 0;
+   Mutex::lockMutex(gEventQueueMutex);
+
+   SimEvent *event = findEvent(eventSequence);
+   SimTime t = event ? event->time - event->startTime : 0;
+
+   Mutex::unlockMutex(gEventQueueMutex);
+
+   return t;
 }
 
 U32 getTimeSinceStart(U32 eventSequence)
 {
-   for(SimEvent *walk = gEventQueue; walk; walk = walk->nextEvent)
-      if(walk->sequenceCount == eventSequence)
-         return (getCurrentTime()-walk->startTime);
-   return 0;
+   Mutex::lockMutex(gEventQueueMutex);
+
+   SimEvent *event = findEvent(eventSequence);
+   SimTime t = event ? getCurrentTime() - event->startTime : 0;
+
+   Mutex::unlockMutex(gEventQueueMutex);
+
+   return t;
 }
 
 //---------------------------------------------------------------------------
@@ -213,10 +353,11 @@ void advanceToTime(SimTime targetTime)
 
    Mutex::lockMutex(gEventQueueMutex);
    gTargetTime = targetTime;
-   while(gEventQueue && gEventQueue->time <= targetTime)
+   drainThreadEvents();
+   while(gEventQueue.size() && gEventQueue[0]->time <= targetTime)
    {
-      SimEvent *event = gEventQueue;
-      gEventQueue = gEventQueue->nextEvent;
+      SimEvent *event = gEventQueue[0];
+      removeEvent(event);
       AssertFatal(event->time >= gCurrentTime,
 			"SimEventQueue::pop: Cannot go back in time (flux capacitor not installed - BJG).");
       gCurrentTime = event->time;
@@ -225,6 +366,9 @@ void advanceToTime(SimTime targetTime)
       if(!obj->isDeleted())
          event->process(obj);
       delete event;
+
+      // Pick up anything a worker posted while that event ran.
+      drainThreadEvents();
    }
 	gCurrentTime = targetTime;
    Mutex::unlockMutex(gEventQueueMutex);
@@ -237,11 +381,9 @@ void advanceTime(SimTime delta)
 
 U32 getCurrentTime()
 {
-   Mutex::lockMutex(gEventQueueMutex);
-   SimTime t = gCurrentTime;
-   Mutex::unlockMutex(gEventQueueMutex);
-
-   return t;
+   // Workers call this to timestamp their events, so it mustn't wait on
+   // the queue lock while the main thread is processing events.
+   return dAtomicRead(gCurrentTime);
 }
 
 U32 getTargetTime()
@@ -249,6 +391,22 @@ U32 getTargetTime()
    return gTargetTime;
 }
 
+U32 getTimeToNextEvent(U32 maxTime)
+{
+   Mutex::lockMutex(gEventQueueMutex);
+   drainThreadEvents();
+
+   SimTime t = maxTime;
+   if(gEventQueue.size())
+   {
+      SimTime eventTime = gEventQueue[0]->time;
+      t = eventTime <= gCurrentTime ? 0 : getMin(maxTime, eventTime - gCurrentTime);
+   }
+
+   Mutex::unlockMutex(gEventQueueMutex);
+   return t;
+}
+
 //---------------------------------------------------------------------------
 //---------------------------------------------------------------------------
 
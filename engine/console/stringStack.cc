@@ -12,14 +12,22 @@ void StringStack::getArgcArgv(StringTableEntry name, U32 *argc, const char ***in
 
    *in_argv = mArgV;
    mArgV[0] = name;
+   mArgTypes[0] = NativeNone;
    
    for(U32 i = 0; i < argCount; i++)
+   {
       mArgV[i+1] = mBuffer + mStartOffsets[startStack + i];
+      mArgTypes[i+1] = mStartTypes[startStack + i];
+      mArgValues[i+1] = mStartValues[startStack + i];
+   }
    argCount++;
+   for(U32 i = argCount; i < MaxArgs; i++)
+      mArgTypes[i] = NativeNone;
    
    mStartStackSize = startStack - 1;
    *argc = argCount;
 
    mStart = mStartOffsets[mStartStackSize];
    mLen = 0;
+   mTopType = NativeNone;
 }
\ No newline at end of file
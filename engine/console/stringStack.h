@@ -22,11 +22,31 @@ struct StringStack
       MaxArgs = 20,
       ReturnBufferSpace = 512
    };
+
+   /// What a stack entry was built from.
+   ///
+   /// Entries set from a number remember it, so native callbacks can get
+   /// their arguments back without parsing the string.
+   ///
+   /// @see Con::getIntArg
+   enum NativeType {
+      NativeNone,
+      NativeInt,
+      NativeFloat
+   };
+
    char *mBuffer;
    U32   mBufferSize;
    const char *mArgV[MaxArgs];
+   U8  mArgTypes[MaxArgs];
+   F64 mArgValues[MaxArgs];
    U32 mFrameOffsets[MaxStackDepth];
    U32 mStartOffsets[MaxStackDepth];
+   U8  mStartTypes[MaxStackDepth];
+   F64 mStartValues[MaxStackDepth];
+
+   U8  mTopType;     ///< NativeType of the top of the stack.
+   F64 mTopValue;
 
    U32 mNumFrames;
    U32 mArgc;
@@ -43,7 +63,8 @@ struct StringStack
    {
       if(size > mBufferSize)
       {
-         mBufferSize = size + 2048;
+         // grow geometrically, deep recursion otherwise reallocs every few calls
+         mBufferSize = getMax(size + 2048, mBufferSize * 2);
          mBuffer = (char *) dRealloc(mBuffer, mBufferSize);
       }
    }
@@ -51,7 +72,7 @@ struct StringStack
    {
       if(size > mArgBufferSize)
       {
-         mArgBufferSize = size + 2048;
+         mArgBufferSize = getMax(size + 2048, mArgBufferSize * 2);
          mArgBuffer = (char *) dRealloc(mArgBuffer, mArgBufferSize);
       }
    }
@@ -64,6 +85,8 @@ struct StringStack
       mLen = 0;
       mStartStackSize = 0;
       mFunctionOffset = 0;
+      mTopType = NativeNone;
+      mTopValue = 0;
       validateBufferSize(8192);
       validateArgBufferSize(2048);
    }
@@ -74,6 +97,8 @@ struct StringStack
       validateBufferSize(mStart + 32);
       dSprintf(mBuffer + mStart, 32, "%d", i);
       mLen = dStrlen(mBuffer + mStart);
+      mTopType = NativeInt;
+      mTopValue = S32(i);
    }
 
    /// Set the top of the stack to be a float value.
@@ -82,6 +107,15 @@ struct StringStack
       validateBufferSize(mStart + 32);
       dSprintf(mBuffer + mStart, 32, "%g", v);
       mLen = dStrlen(mBuffer + mStart);
+      mTopType = NativeFloat;
+      mTopValue = v;
+   }
+
+   /// Note the number the string on top of the stack was formatted from.
+   void setNativeValue(NativeType type, F64 v)
+   {
+      mTopType = type;
+      mTopValue = v;
    }
 
    /// Return a temporary buffer we can use to return data.
@@ -121,6 +155,7 @@ struct StringStack
    /// Set a string value on the top of the stack.
    void setStringValue(const char *s)
    {
+      mTopType = NativeNone;
       if(!s)
       {
          mLen = 0;
@@ -144,6 +179,8 @@ struct StringStack
    /// Get an integer representation of the top of the stack.
    inline U32 getIntValue()
    {
+      if(mTopType == NativeInt)
+         return U32(S32(mTopValue));
       return dAtoi(mBuffer + mStart);
    }
 
@@ -167,6 +204,9 @@ struct StringStack
    ///       properly push the stack.
    void advance()
    {
+      mStartTypes[mStartStackSize] = mTopType;
+      mStartValues[mStartStackSize] = mTopValue;
+      mTopType = NativeNone;
       mStartOffsets[mStartStackSize++] = mStart;
       mStart += mLen;
       mLen = 0;
@@ -179,6 +219,9 @@ struct StringStack
    ///       properly push the stack.
    void advanceChar(char c)
    {
+      mStartTypes[mStartStackSize] = mTopType;
+      mStartValues[mStartStackSize] = mTopValue;
+      mTopType = NativeNone;
       mStartOffsets[mStartStackSize++] = mStart;
       mStart += mLen;
       mBuffer[mStart] = c;
@@ -196,6 +239,7 @@ struct StringStack
    inline void setLen(U32 newlen)
    {
       mLen = newlen;
+      mTopType = NativeNone;
    }
 
    /// Pop the start stack.
@@ -203,6 +247,7 @@ struct StringStack
    {
       mStart = mStartOffsets[--mStartStackSize];
       mLen = dStrlen(mBuffer + mStart);
+      mTopType = NativeNone;
    }
 
    // Terminate the current string, and pop the start stack.
@@ -211,6 +256,7 @@ struct StringStack
       mBuffer[mStart] = 0;
       mStart = mStartOffsets[--mStartStackSize];
       mLen   = dStrlen(mBuffer + mStart);
+      mTopType = NativeNone;
    }
 
    /// Compare 1st and 2nd items on stack, consuming them in the process,
@@ -227,6 +273,7 @@ struct StringStack
       // Put an empty string on the top of the stack.
       mLen = 0;
       mBuffer[mStart] = 0;
+      mTopType = NativeNone;
 
       return ret;
    }
@@ -235,6 +282,7 @@ struct StringStack
    void pushFrame()
    {
       mFrameOffsets[mNumFrames++] = mStartStackSize;
+      mStartTypes[mStartStackSize] = NativeNone;
       mStartOffsets[mStartStackSize++] = mStart;
       mStart += ReturnBufferSpace;
       validateBufferSize(0);
@@ -242,6 +290,28 @@ struct StringStack
 
    /// Get the arguments for a function call from the stack.
    void getArgcArgv(StringTableEntry name, U32 *argc, const char ***in_argv);
+
+   /// Get the number an argument from the last getArgcArgv() was pushed
+   /// as, if it was.  Returns false for strings, or if argv didn't come
+   /// from us.
+   bool getNativeArg(const char **argv, S32 index, F64 *value)
+   {
+      if(argv != mArgV || index <= 0 || index >= MaxArgs || mArgTypes[index] == NativeNone)
+         return false;
+      *value = mArgValues[index];
+      return true;
+   }
+
+   /// As getNativeArg(), but only for arguments pushed as integers.  A float
+   /// is left to be parsed from argv, whose 6 digit text can round to a
+   /// different integer than the full value truncates to.
+   bool getNativeIntArg(const char **argv, S32 index, S32 *value)
+   {
+      if(argv != mArgV || index <= 0 || index >= MaxArgs || mArgTypes[index] != NativeInt)
+         return false;
+      *value = S32(mArgValues[index]);
+      return true;
+   }
 };
 
 #endif
\ No newline at end of file
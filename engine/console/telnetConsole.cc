@@ -7,6 +7,9 @@
 #include "platform/event.h"
 #include "console/telnetConsole.h"
 #include "platform/gameInterface.h"
+#include "core/frameStats.h"
+#include "platform/platformMutex.h"
+#include "console/consoleTypes.h"
 
 TelnetConsole *TelConsole = NULL;
 
@@ -37,6 +40,15 @@ ConsoleFunction( telnetSetParameters, void, 4, 5, "(int port, string consolePass
    }
 }
 
+ConsoleFunction( telnetSetStatsInterval, void, 2, 2, "(int ms)"
+                "Send the telnet clients a \"stats\" line with every frame stat, counters as their "
+                "average per second.\n\n"
+                "@param ms Time between lines (0 to stop).")
+{
+   if (TelConsole)
+      TelConsole->setStatsInterval(dAtoi(argv[1]));
+}
+
 static void telnetCallback(ConsoleLogEntry::Level level, const char *consoleLine)
 {
    level;
@@ -52,6 +64,11 @@ TelnetConsole::TelnetConsole()
    mAcceptPort = -1;
    mClientList = NULL;
    mRemoteEchoEnabled = false;
+   mStatsInterval = 0;
+   mLastStatsTime = 0;
+   mOutputMutex = Mutex::createMutex();
+   mLinesDropped = 0;
+   Con::addVariable("Telnet::linesDropped", TypeS32, &mLinesDropped);
 }
 
 TelnetConsole::~TelnetConsole()
@@ -68,6 +85,7 @@ TelnetConsole::~TelnetConsole()
       delete walk;
       walk = temp;
    }
+   Mutex::destroyMutex(mOutputMutex);
 }
 
 void TelnetConsole::setTelnetParameters(S32 port, const char *telnetPassword, const char *listenPassword, bool remoteEcho)
@@ -95,18 +113,60 @@ void TelnetConsole::setTelnetParameters(S32 port, const char *telnetPassword, co
    dStrncpy(mListenPassword, listenPassword, PasswordMaxLength);
 }
 
+void TelnetConsole::setStatsInterval(S32 interval)
+{
+   mStatsInterval = interval > 0 ? interval : 0;
+   mLastStatsTime = Platform::getRealMilliseconds();
+}
+
 void TelnetConsole::processConsoleLine(const char *consoleLine)
 {
    if (mClientList==NULL) return;  // just escape early.  don't even do another step...
 
-   // ok, spew this line out to all our subscribers...
-   S32 len = dStrlen(consoleLine)+1;
+   // ok, queue this line up for all our subscribers...
+   S32 len = dStrlen(consoleLine);
+   MutexHandle m;
+   m.lock(mOutputMutex);
    for(TelnetClient *walk = mClientList; walk; walk = walk->nextClient)
    {
       if(walk->state == FullAccessConnected || walk->state == ReadOnlyConnected)
       {
-         Net::send(walk->socket, (const unsigned char*)consoleLine, len);
-         Net::send(walk->socket, (const unsigned char*)"\r\n", 2);
+         // A client that isn't keeping up loses lines, not memory.
+         if(walk->output.size() + len + 2 > MaxOutputBytes)
+         {
+            walk->dropped++;
+            mLinesDropped++;
+            continue;
+         }
+         U32 start = walk->output.size();
+         walk->output.increment(len + 2);
+         dMemcpy(walk->output.address() + start, consoleLine, len);
+         walk->output[start + len] = '\r';
+         walk->output[start + len + 1] = '\n';
+      }
+   }
+}
+
+void TelnetConsole::flushOutput()
+{
+   MutexHandle m;
+   m.lock(mOutputMutex);
+   for(TelnetClient *walk = mClientList; walk; walk = walk->nextClient)
+   {
+      if(walk->socket == InvalidSocket)
+         continue;
+
+      if(walk->dropped)
+      {
+         char note[64];
+         dSprintf(note, sizeof(note), "*** %d console lines dropped ***\r\n", walk->dropped);
+         Net::send(walk->socket, (const unsigned char*)note, dStrlen(note));
+         walk->dropped = 0;
+      }
+      if(walk->output.size())
+      {
+         Net::send(walk->socket, (const unsigned char*)walk->output.address(), walk->output.size());
+         walk->output.clear();
       }
    }
 }
@@ -130,12 +190,15 @@ void TelnetConsole::process()
          cl->socket = newConnection;
          cl->curPos = 0;
          cl->state = PasswordTryOne;
+         cl->dropped = 0;
 
          Net::setBlocking(newConnection, false);
 
          char *connectMessage = "Torque Telnet Remote Console\r\n\r\nEnter Password:";
 
          Net::send(cl->socket, (const unsigned char*)connectMessage, dStrlen(connectMessage)+1);
+         MutexHandle m;
+         m.lock(mOutputMutex);
          cl->nextClient = mClientList;
          mClientList = cl;
       }
@@ -259,16 +322,38 @@ void TelnetConsole::process()
          Net::send(client->socket, (const unsigned char*)reply, replyPos);
    }
 
-   TelnetClient ** walk = &mClientList;
-   TelnetClient *cl;
-   while((cl = *walk) != NULL)
    {
-      if(cl->socket == InvalidSocket)
+      MutexHandle m;
+      m.lock(mOutputMutex);
+      TelnetClient ** walk = &mClientList;
+      TelnetClient *cl;
+      while((cl = *walk) != NULL)
       {
-         *walk = cl->nextClient;
-         delete cl;
+         if(cl->socket == InvalidSocket)
+         {
+            *walk = cl->nextClient;
+            delete cl;
+         }
+         else
+            walk = &cl->nextClient;
       }
-      else
-         walk = &cl->nextClient;
    }
+
+   // Stream the stats, for watching dedicated servers.
+   if(mStatsInterval && mClientList)
+   {
+      U32 now = Platform::getRealMilliseconds();
+      if(now - mLastStatsTime >= mStatsInterval)
+      {
+         mLastStatsTime = now;
+
+         char line[Con::MaxLineLength];
+         dStrcpy(line, "stats ");
+         FrameStats::getLine(line + 6, sizeof(line) - 6, true);
+         processConsoleLine(line);
+      }
+   }
+
+   // Send everything printed since the last frame, in one go per client.
+   flushOutput();
 }
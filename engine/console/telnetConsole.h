@@ -9,6 +9,9 @@
 #ifndef _CONSOLE_H_
 #include "console/console.h"
 #endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
 
 /// Telnet admin console.
 ///
@@ -40,10 +43,13 @@ class TelnetConsole
    S32 mAcceptPort;
 
    enum {
-      PasswordMaxLength = 32  ///< Maximum length of the telnet and listen passwords.
+      PasswordMaxLength = 32,    ///< Maximum length of the telnet and listen passwords.
+      MaxOutputBytes    = 65536  ///< Console output held per client between sends.
    };
 
    bool mRemoteEchoEnabled;
+   S32 mStatsInterval;     ///< ms between frame stats lines, 0 for none.
+   U32 mLastStatsTime;
    char mTelnetPassword[PasswordMaxLength+1];
    char mListenPassword[PasswordMaxLength+1];
    ConsoleEvent mPostEvent;
@@ -69,9 +75,18 @@ class TelnetConsole
       S32 curPos;
       S32 state;                       ///< State of the client.
                                        ///  @see TelnetConsole::State
+      Vector<char> output;             ///< Console lines waiting for the next send.
+      S32 dropped;                     ///< Lines that didn't fit in output.
       TelnetClient *nextClient;
    };
    TelnetClient *mClientList;
+
+   /// Guards the clients' output, which any thread can print to.
+   void *mOutputMutex;
+   S32 mLinesDropped;      ///< $Telnet::linesDropped
+
+   /// Sends each client its console output, in one go.
+   void flushOutput();
    TelnetConsole();
    ~TelnetConsole();
 
@@ -89,7 +104,14 @@ public:
    /// @param    remoteEcho     Enable/disable echoing input back to the client
    void setTelnetParameters(S32 port, const char *telnetPassword, const char *listenPassword, bool remoteEcho = false);
 
-   /// Callback to handle a line from the console.
+   /// Send the connected clients a line with all the frame stats every
+   /// interval ms, or stop if it's 0.
+   ///
+   /// @see FrameStats
+   void setStatsInterval(S32 interval);
+
+   /// Callback to handle a line from the console.  The line is queued
+   /// for the clients, and sent with the rest at the end of process().
    ///
    /// @note This is used internally by the class; you
    ///       shouldn't need to call it.
@@ -4,6 +4,14 @@
 //-----------------------------------------------------------------------------
 
 #include "core/bitRender.h"
+#include "platform/platform.h"
+
+// The expand and blur have SSE2 versions, built wherever the compiler knows
+// about SSE2 and used when the CPU reports it.
+#if defined(TORQUE_CPU_X86) && (defined(TORQUE_COMPILER_VISUALC) || defined(__SSE2__))
+#  define BITRENDER_USE_SSE2
+#  include <emmintrin.h>
+#endif
 
 U32 openTable[32] =  { 0xFFFFFFFF,0xFFFFFFFE,0xFFFFFFFC,0xFFFFFFF8,
                        0xFFFFFFF0,0xFFFFFFE0,0xFFFFFFC0,0xFFFFFF80,
@@ -29,430 +37,13 @@ struct DrawStruct
    S16 num;
 };
 
-void BitRender::render_strips(const U8 * draw, S32 numDraw, S32 szDraw, const U16 * indices, const Point2I * points, S32 dim, U32 * bits)
-{
-   const U8 * drawEnd = draw + numDraw*szDraw;
-
-   // loop through strips...
-   for (; draw<drawEnd; draw += szDraw)
-   {
-      const DrawStruct * drawStruct = (DrawStruct*)draw;
-      const U16 * icurrent = indices + drawStruct->start;
-      const U16 * iend     = icurrent + drawStruct->num;
-
-      const Point2I * vv0 = points + *(icurrent++);
-      const Point2I * vv1;
-      const Point2I * vv2 = points + *(icurrent++);
-      const Point2I **nextPt = &vv1;
-
-      while (icurrent<iend)
-      {
-         *nextPt = vv2;
-         nextPt = (const Point2I**)( (dsize_t)nextPt ^ (dsize_t)&vv0 ^ (dsize_t)&vv1 );
-         vv2 = points + *(icurrent++);
-
-         // skip degenerate triangles...
-         if (vv0==vv1 || vv1==vv2 || vv2==vv0)
-            continue;
-         // following copied from BitRender::render...indented to highlight this fact, no function to indentation
-         {
-            const Point2I * v0 = vv0;
-            const Point2I * v1 = vv1;
-            const Point2I * v2 = vv2;
-
-            AssertFatal( v0->x>=0 && v0->x<dim && v0->y>=0 && v0->y<dim,"BitRender::render: v0 out of range");
-            AssertFatal( v1->x>=0 && v1->x<dim && v1->y>=0 && v1->y<dim,"BitRender::render: v1 out of range");
-            AssertFatal( v2->x>=0 && v2->x<dim && v2->y>=0 && v2->y<dim,"BitRender::render: v2 out of range");
-
-            // back-face cull
-            if ((v0->x-v1->x)*(v2->y-v1->y) > (v0->y-v1->y)*(v2->x-v1->x))
-               continue;
-
-            // rotate so that v0 holds topmost y coord
-            // Note: The particular inequalities used ( <=, <, then <=) are important.
-            //       They guarantee that if there are two verts on the top row, that
-            //       they will be vert v0 and v1 (also could be three).
-            if (v1->y <= v2->y)
-            {
-               if (v1->y < v0->y)
-               {
-                  const Point2I * tmp = v0;
-                  v0 = v1;
-                  v1 = v2;
-                  v2 = tmp;
-               }
-            }
-            else
-            {
-               if (v2->y <= v0->y)
-               {
-                  const Point2I * tmp = v0;
-                  v0 = v2;
-                  v2 = v1;
-                  v1 = tmp;
-               }
-            }
-
-            // all the control variables we have to set up...
-            S32 leftDeltaY, xLeftInc, xLeftErrInc, xLeftDir, xLeft, xLeftErr = 0;
-            S32 rightDeltaY, xRightInc, xRightErrInc, xRightDir, xRight, xRightErr = 0;
-            S32 * changeThisDelta;
-            S32 * changeThisInc;
-            S32 * changeThisErrInc;
-            S32 * changeThisDir;
-            S32 toThisDelta;
-            S32 toThisInc;
-            S32 toThisErrInc;
-            S32 toThisDir;
-            S32 ySwitch;
-            S32 yBottom;
-
-            // check for special case where top row holds two verts
-            if (v0->y==v1->y)
-            {
-               leftDeltaY = v2->y-v0->y;
-               rightDeltaY = v2->y-v1->y;
-               ySwitch = v2->y;
-               yBottom = v2->y;
-
-               if (v1->y==v2->y)
-               {
-                  // special-special case where top row holds all three verts
-                  xLeft = getMin(getMin(v0->x,v1->x),v2->x);
-                  xRight = getMax(getMax(v0->x,v1->x),v2->x);
-						xLeftInc = xRightInc = 0;
-                  xLeftErrInc = xRightErrInc = 0;
-						xLeftDir = xRightDir = 1;
-               }
-               else
-               {
-                  // standard-special case...v2 on different row from v0 and v1
-                  xLeft = v0->x;
-                  xLeftInc = (v2->x-v0->x) / leftDeltaY;
-                  xLeftErrInc = (v2->x-v0->x) - leftDeltaY*xLeftInc;
-                  xLeftDir = v2->x-v0->x > 0 ? 1 : -1;
-
-                  xRight = v1->x;
-                  xRightInc = (v2->x-v1->x) / rightDeltaY;
-                  xRightErrInc = (v2->x-v1->x) - rightDeltaY*xRightInc;
-                  xRightDir = v2->x-v1->x > 0 ? 1 : -1;
-               }
-
-               // set these variables to avoid a crash...
-               changeThisDelta = &toThisDelta;
-               changeThisInc = &toThisInc;
-               changeThisErrInc = &toThisErrInc;
-               changeThisDir = &toThisDir;
-            }
-            else
-            {
-               leftDeltaY = v2->y-v0->y;
-               xLeftInc = (v2->x-v0->x) / leftDeltaY;
-               xLeftErrInc = (v2->x-v0->x) - leftDeltaY*xLeftInc;
-               xLeftDir = v2->x-v0->x > 0 ? 1 : -1;
-
-               rightDeltaY = v1->y-v0->y;
-               xRightInc = (v1->x-v0->x) / rightDeltaY;
-               xRightErrInc = (v1->x-v0->x) - rightDeltaY*xRightInc;
-               xRightDir = v1->x-v0->x > 0 ? 1 : -1;
-
-               xLeft = xRight = v0->x;
-
-               if (v1->y<v2->y)
-               {
-                  // right edge bends
-                  changeThisDelta = &rightDeltaY;
-                  changeThisInc = &xRightInc;
-                  changeThisErrInc = &xRightErrInc;
-                  changeThisDir = &xRightDir;
-                  toThisDelta = v2->y-v1->y;
-                  toThisInc = (v2->x-v1->x) / toThisDelta;
-                  toThisErrInc = (v2->x-v1->x) - toThisDelta * toThisInc;
-                  toThisDir = v2->x-v1->x > 0 ? 1 : -1;
-                  ySwitch = v1->y-1;
-                  yBottom = v2->y;
-               }
-               else
-               {
-                  // left edge bends
-                  changeThisDelta = &leftDeltaY;
-                  changeThisInc = &xLeftInc;
-                  changeThisErrInc = &xLeftErrInc;
-                  changeThisDir = &xLeftDir;
-                  toThisDelta = v1->y-v2->y;
-                  toThisInc = toThisDelta ? (v1->x-v2->x) / toThisDelta : 0;
-                  toThisErrInc = toThisDelta ? (v1->x-v2->x) - toThisDelta * toThisInc : 0;
-                  toThisDir = v1->x-v2->x > 0 ? 1 : -1;
-                  ySwitch = v2->y-1;
-                  yBottom = v1->y;
-               }
-            }
-            xLeftErrInc *= xLeftDir;
-            xRightErrInc *= xRightDir;
-            toThisErrInc *= toThisDir;
-
-            U32 * rowStart = bits + v0->y * (dim>>5);
-            for (S32 y=v0->y; y<=yBottom;)
-            {
-               do
-               {
-                  AssertFatal(xLeft<=xRight,"BitRender::render");
-
-                  U32 open  = openTable[xLeft&31];
-                  U32 close = closeTable[xRight&31];
-                  if ( (xLeft^xRight) & ~31)
-                  {
-                     U32 * x = rowStart+(xLeft>>5);
-                     *x |= open;
-                     U32 * xEnd = rowStart+(xRight>>5);
-                     while (++x<xEnd)
-                        *x |= 0xFFFFFFFF;
-                     *x |= close;
-                  }
-                  else
-                     rowStart[xLeft>>5] |= open & close;
-
-                  xLeft     += xLeftInc;
-                  xLeftErr  += xLeftErrInc;
-                  if (xLeftErr >= leftDeltaY)
-                  {
-                     xLeft += xLeftDir;
-                     xLeftErr -= leftDeltaY;
-                  }
-
-                  xRight     += xRightInc;
-                  xRightErr  += xRightErrInc;
-                  if (xRightErr >= rightDeltaY)
-                  {
-                     xRight += xRightDir;
-                     xRightErr -= rightDeltaY;
-                  }
-
-                  rowStart += dim>>5;
-
-               } while (y++<ySwitch);
-
-               ySwitch=yBottom; // get here at most twice
-               *changeThisDelta = toThisDelta;
-               *changeThisInc = toThisInc;
-               *changeThisErrInc = toThisErrInc;
-               *changeThisDir = toThisDir;
-            }
-
-         }
-      }
-   }
-}
-
-void BitRender::render_tris(const U8 * draw, S32 numDraw, S32 szDraw, const U16 * indices, const Point2I * points, S32 dim, U32 * bits)
+/// Fills one triangle into the bitmap, a span per row, with the open and
+/// close masks covering 32 pixels per write.  Assumes coords are in range.
+static inline void fillTriangle(const Point2I * v0, const Point2I * v1, const Point2I * v2, S32 dim, U32 * bits)
 {
-   const U8 * drawEnd = draw + numDraw*szDraw;
-
-   // loop through strips...
-   for (; draw<drawEnd; draw += szDraw)
-   {
-      const DrawStruct * drawStruct = (DrawStruct*)draw;
-      const U16 * icurrent = indices  + drawStruct->start;
-      const U16 * iend     = icurrent + drawStruct->num;
-
-      while (icurrent<iend)
-      {
-         const Point2I * v0 = points + *(icurrent++);
-         const Point2I * v1 = points + *(icurrent++);
-         const Point2I * v2 = points + *(icurrent++);
-
-         // following copied from BitRender::render...indented to highlight this fact, no function to indentation
-         {
-            AssertFatal( v0->x>=0 && v0->x<dim && v0->y>=0 && v0->y<dim,"BitRender::render: v0 out of range");
-            AssertFatal( v1->x>=0 && v1->x<dim && v1->y>=0 && v1->y<dim,"BitRender::render: v1 out of range");
-            AssertFatal( v2->x>=0 && v2->x<dim && v2->y>=0 && v2->y<dim,"BitRender::render: v2 out of range");
-
-            // back-face cull
-            if ((v0->x-v1->x)*(v2->y-v1->y) > (v0->y-v1->y)*(v2->x-v1->x))
-               continue;
-
-            // rotate so that v0 holds topmost y coord
-            // Note: The particular inequalities used ( <=, <, then <=) are important.
-            //       They guarantee that if there are two verts on the top row, that
-            //       they will be vert v0 and v1 (also could be three).
-            if (v1->y <= v2->y)
-            {
-               if (v1->y < v0->y)
-               {
-                  const Point2I * tmp = v0;
-                  v0 = v1;
-                  v1 = v2;
-                  v2 = tmp;
-               }
-            }
-            else
-            {
-               if (v2->y <= v0->y)
-               {
-                  const Point2I * tmp = v0;
-                  v0 = v2;
-                  v2 = v1;
-                  v1 = tmp;
-               }
-            }
-
-            // all the control variables we have to set up...
-            S32 leftDeltaY, xLeftInc, xLeftErrInc, xLeftDir, xLeft, xLeftErr = 0;
-            S32 rightDeltaY, xRightInc, xRightErrInc, xRightDir, xRight, xRightErr = 0;
-            S32 * changeThisDelta;
-            S32 * changeThisInc;
-            S32 * changeThisErrInc;
-            S32 * changeThisDir;
-            S32 toThisDelta;
-            S32 toThisInc;
-            S32 toThisErrInc;
-            S32 toThisDir;
-            S32 ySwitch;
-            S32 yBottom;
-
-            // check for special case where top row holds two verts
-            if (v0->y==v1->y)
-            {
-               leftDeltaY = v2->y-v0->y;
-               rightDeltaY = v2->y-v1->y;
-               ySwitch = v2->y;
-               yBottom = v2->y;
-
-               if (v1->y==v2->y)
-               {
-                  // special-special case where top row holds all three verts
-                  xLeft = getMin(getMin(v0->x,v1->x),v2->x);
-                  xRight = getMax(getMax(v0->x,v1->x),v2->x);
-                  xLeftInc = xRightInc = 0;
-                  xLeftErrInc = xRightErrInc = 0;
-                  xLeftDir = xRightDir = 1;
-               }
-               else
-               {
-                  // standard-special case...v2 on different row from v0 and v1
-                  xLeft = v0->x;
-                  xLeftInc = (v2->x-v0->x) / leftDeltaY;
-                  xLeftErrInc = (v2->x-v0->x) - leftDeltaY*xLeftInc;
-                  xLeftDir = v2->x-v0->x > 0 ? 1 : -1;
-
-                  xRight = v1->x;
-                  xRightInc = (v2->x-v1->x) / rightDeltaY;
-                  xRightErrInc = (v2->x-v1->x) - rightDeltaY*xRightInc;
-                  xRightDir = v2->x-v1->x > 0 ? 1 : -1;
-               }
-
-               // set these variables to avoid a crash...
-               changeThisDelta = &toThisDelta;
-               changeThisInc = &toThisInc;
-               changeThisErrInc = &toThisErrInc;
-               changeThisDir = &toThisDir;
-            }
-            else
-            {
-               leftDeltaY = v2->y-v0->y;
-               xLeftInc = (v2->x-v0->x) / leftDeltaY;
-               xLeftErrInc = (v2->x-v0->x) - leftDeltaY*xLeftInc;
-               xLeftDir = v2->x-v0->x > 0 ? 1 : -1;
-
-               rightDeltaY = v1->y-v0->y;
-               xRightInc = (v1->x-v0->x) / rightDeltaY;
-               xRightErrInc = (v1->x-v0->x) - rightDeltaY*xRightInc;
-               xRightDir = v1->x-v0->x > 0 ? 1 : -1;
-
-               xLeft = xRight = v0->x;
-
-               if (v1->y<v2->y)
-               {
-                  // right edge bends
-                  changeThisDelta = &rightDeltaY;
-                  changeThisInc = &xRightInc;
-                  changeThisErrInc = &xRightErrInc;
-                  changeThisDir = &xRightDir;
-                  toThisDelta = v2->y-v1->y;
-                  toThisInc = (v2->x-v1->x) / toThisDelta;
-                  toThisErrInc = (v2->x-v1->x) - toThisDelta * toThisInc;
-                  toThisDir = v2->x-v1->x > 0 ? 1 : -1;
-                  ySwitch = v1->y-1;
-                  yBottom = v2->y;
-               }
-               else
-               {
-                  // left edge bends
-                  changeThisDelta = &leftDeltaY;
-                  changeThisInc = &xLeftInc;
-                  changeThisErrInc = &xLeftErrInc;
-                  changeThisDir = &xLeftDir;
-                  toThisDelta = v1->y-v2->y;
-                  toThisInc = toThisDelta ? (v1->x-v2->x) / toThisDelta : 0;
-                  toThisErrInc = toThisDelta ? (v1->x-v2->x) - toThisDelta * toThisInc : 0;
-                  toThisDir = v1->x-v2->x > 0 ? 1 : -1;
-                  ySwitch = v2->y-1;
-                  yBottom = v1->y;
-               }
-            }
-            xLeftErrInc *= xLeftDir;
-            xRightErrInc *= xRightDir;
-            toThisErrInc *= toThisDir;
-
-            U32 * rowStart = bits + v0->y * (dim>>5);
-            for (S32 y=v0->y; y<=yBottom;)
-            {
-               do
-               {
-                  AssertFatal(xLeft<=xRight,"BitRender::render");
-
-                  U32 open  = openTable[xLeft&31];
-                  U32 close = closeTable[xRight&31];
-                  if ( (xLeft^xRight) & ~31)
-                  {
-                     U32 * x = rowStart+(xLeft>>5);
-                     *x |= open;
-                     U32 * xEnd = rowStart+(xRight>>5);
-                     while (++x<xEnd)
-                        *x |= 0xFFFFFFFF;
-                     *x |= close;
-                  }
-                  else
-                     rowStart[xLeft>>5] |= open & close;
-
-                  xLeft     += xLeftInc;
-                  xLeftErr  += xLeftErrInc;
-                  if (xLeftErr >= leftDeltaY)
-                  {
-                     xLeft += xLeftDir;
-                     xLeftErr -= leftDeltaY;
-                  }
-
-                  xRight     += xRightInc;
-                  xRightErr  += xRightErrInc;
-                  if (xRightErr >= rightDeltaY)
-                  {
-                     xRight += xRightDir;
-                     xRightErr -= rightDeltaY;
-                  }
-
-                  rowStart += dim>>5;
-
-               } while (y++<ySwitch);
-
-               ySwitch=yBottom; // get here at most twice
-               *changeThisDelta = toThisDelta;
-               *changeThisInc = toThisInc;
-               *changeThisErrInc = toThisErrInc;
-               *changeThisDir = toThisDir;
-            }
-
-         }
-      }
-   }
-}
-
-// assumes coords are in range
-void BitRender::render(const Point2I * v0, const Point2I * v1, const Point2I * v2, S32 dim, U32 * bits)
-{
-   AssertFatal( v0->x>=0 && v0->x<dim && v0->y>=0 && v0->y<dim,"BitRender::render: v0 out of range");
-   AssertFatal( v1->x>=0 && v1->x<dim && v1->y>=0 && v1->y<dim,"BitRender::render: v1 out of range");
-   AssertFatal( v2->x>=0 && v2->x<dim && v2->y>=0 && v2->y<dim,"BitRender::render: v2 out of range");
+   AssertFatal( v0->x>=0 && v0->x<dim && v0->y>=0 && v0->y<dim,"BitRender::fillTriangle: v0 out of range");
+   AssertFatal( v1->x>=0 && v1->x<dim && v1->y>=0 && v1->y<dim,"BitRender::fillTriangle: v1 out of range");
+   AssertFatal( v2->x>=0 && v2->x<dim && v2->y>=0 && v2->y<dim,"BitRender::fillTriangle: v2 out of range");
 
    // back-face cull
    if ((v0->x-v1->x)*(v2->y-v1->y) > (v0->y-v1->y)*(v2->x-v1->x))
@@ -510,7 +101,9 @@ void BitRender::render(const Point2I * v0, const Point2I * v1, const Point2I * v
          // special-special case where top row holds all three verts
          xLeft = getMin(getMin(v0->x,v1->x),v2->x);
          xRight = getMax(getMax(v0->x,v1->x),v2->x);
+         xLeftInc = xRightInc = 0;
          xLeftErrInc = xRightErrInc = 0;
+         xLeftDir = xRightDir = 1;
       }
       else
       {
@@ -584,7 +177,7 @@ void BitRender::render(const Point2I * v0, const Point2I * v1, const Point2I * v
    {
       do
       {
-         AssertFatal(xLeft<=xRight,"BitRender::render");
+         AssertFatal(xLeft<=xRight,"BitRender::fillTriangle");
 
          U32 open  = openTable[xLeft&31];
          U32 close = closeTable[xRight&31];
@@ -628,6 +221,63 @@ void BitRender::render(const Point2I * v0, const Point2I * v1, const Point2I * v
    }
 }
 
+void BitRender::render_strips(const U8 * draw, S32 numDraw, S32 szDraw, const U16 * indices, const Point2I * points, S32 dim, U32 * bits)
+{
+   const U8 * drawEnd = draw + numDraw*szDraw;
+
+   // loop through strips...
+   for (; draw<drawEnd; draw += szDraw)
+   {
+      const DrawStruct * drawStruct = (DrawStruct*)draw;
+      const U16 * icurrent = indices + drawStruct->start;
+      const U16 * iend     = icurrent + drawStruct->num;
+
+      const Point2I * vv0 = points + *(icurrent++);
+      const Point2I * vv1;
+      const Point2I * vv2 = points + *(icurrent++);
+      const Point2I **nextPt = &vv1;
+
+      while (icurrent<iend)
+      {
+         *nextPt = vv2;
+         nextPt = (const Point2I**)( (dsize_t)nextPt ^ (dsize_t)&vv0 ^ (dsize_t)&vv1 );
+         vv2 = points + *(icurrent++);
+
+         // skip degenerate triangles...
+         if (vv0==vv1 || vv1==vv2 || vv2==vv0)
+            continue;
+         fillTriangle(vv0,vv1,vv2,dim,bits);
+      }
+   }
+}
+
+void BitRender::render_tris(const U8 * draw, S32 numDraw, S32 szDraw, const U16 * indices, const Point2I * points, S32 dim, U32 * bits)
+{
+   const U8 * drawEnd = draw + numDraw*szDraw;
+
+   // loop through strips...
+   for (; draw<drawEnd; draw += szDraw)
+   {
+      const DrawStruct * drawStruct = (DrawStruct*)draw;
+      const U16 * icurrent = indices  + drawStruct->start;
+      const U16 * iend     = icurrent + drawStruct->num;
+
+      while (icurrent<iend)
+      {
+         const Point2I * v0 = points + *(icurrent++);
+         const Point2I * v1 = points + *(icurrent++);
+         const Point2I * v2 = points + *(icurrent++);
+         fillTriangle(v0,v1,v2,dim,bits);
+      }
+   }
+}
+
+// assumes coords are in range
+void BitRender::render(const Point2I * v0, const Point2I * v1, const Point2I * v2, S32 dim, U32 * bits)
+{
+   fillTriangle(v0,v1,v2,dim,bits);
+}
+
 // These macros currently define how black the shadows get
 // Set the shift factor to zero results in totally black
 // shadows.  Be nice to have this dynamic...
@@ -664,8 +314,118 @@ U8 bitTable[16][4] =
    SF32(255,255,255,255), // 15
 };
 
+#if defined(BITRENDER_USE_SSE2)
+//--------------------------------------------------------------------------
+// SSE2 versions of the expand and blur.  Both give the same bytes as the C
+// code, a bitmap word (32 pixels) at a time.
+
+/// Turns the 32 bits of a bitmap word into 32 bytes of 0xFF or 0, pixel 0
+/// first; bytes 0-15 in lo and 16-31 in hi.
+static inline void expandBits(U32 bits, __m128i & lo, __m128i & hi)
+{
+   const __m128i select = _mm_set_epi8(-128,64,32,16,8,4,2,1,-128,64,32,16,8,4,2,1);
+
+   // each byte of bits out to eight lanes...
+   __m128i v = _mm_cvtsi32_si128(bits);
+   v = _mm_unpacklo_epi8(v,v);
+   v = _mm_unpacklo_epi16(v,v);
+   lo = _mm_unpacklo_epi32(v,v);
+   hi = _mm_unpackhi_epi32(v,v);
+
+   // ...and each lane keeps its own bit
+   lo = _mm_cmpeq_epi8(_mm_and_si128(lo,select),select);
+   hi = _mm_cmpeq_epi8(_mm_and_si128(hi,select),select);
+}
+
+static void bitTo8Bit_sse2(const U32 * bits, U32 * eightBits, S32 dim)
+{
+   dim *= dim>>5;
+   __m128i * dst = (__m128i*)eightBits;
+   for (S32 i=0; i<dim; i++)
+   {
+      __m128i lo, hi;
+      expandBits(bits[i],lo,hi);
+      _mm_storeu_si128(dst++,lo);
+      _mm_storeu_si128(dst++,hi);
+   }
+}
+
+/// Adds the expanded masks of bits, weighted, into lo and hi.
+static inline void addBits(U32 bits, __m128i weight, __m128i & lo, __m128i & hi)
+{
+   __m128i maskLo, maskHi;
+   expandBits(bits,maskLo,maskHi);
+   lo = _mm_add_epi8(lo,_mm_and_si128(maskLo,weight));
+   hi = _mm_add_epi8(hi,_mm_and_si128(maskHi,weight));
+}
+
+/// The blur of the C version below, reading the bitmap as one long row of
+/// pixels the way it does: the rows above and below weigh 1 2 1 and the
+/// row itself 2 3 2, in 17ths, so a covered pixel sums to 255 and no lane
+/// can carry into the next.
+static void bitTo8Bit_3_sse2(const U32 * bits, U32 * eightBits, S32 dim)
+{
+   const __m128i edge   = _mm_set1_epi8(17);
+   const __m128i middle = _mm_set1_epi8(34);
+   const __m128i center = _mm_set1_epi8(51);
+
+   S32 rowWords = dim>>5;
+   S32 numWords = (dim-2) * rowWords;
+   const U32 * up  = bits;
+   const U32 * mid = bits + rowWords;
+   const U32 * dn  = bits + rowWords*2;
+
+   // clear out first row of dest
+   dMemset(eightBits,0,dim);
+   __m128i * dst = (__m128i*)(eightBits + (dim>>2));
+
+   // the first pixel has nothing on its left, and nothing past the end of
+   // the bitmap is read
+   U32 prevUp = 0, prevMid = 0, prevDn = 0;
+   for (S32 i=0; i<numWords; i++)
+   {
+      U32 curUp  = up[i];
+      U32 curMid = mid[i];
+      U32 curDn  = dn[i];
+      U32 nextUp  = up[i+1];
+      U32 nextMid = mid[i+1];
+      U32 nextDn  = i+1<numWords ? dn[i+1] : 0;
+
+      __m128i lo = _mm_setzero_si128();
+      __m128i hi = _mm_setzero_si128();
+      addBits((curUp<<1)  | (prevUp>>31),  edge,   lo, hi);
+      addBits(curUp,                       middle, lo, hi);
+      addBits((curUp>>1)  | (nextUp<<31),  edge,   lo, hi);
+      addBits((curMid<<1) | (prevMid>>31), middle, lo, hi);
+      addBits(curMid,                      center, lo, hi);
+      addBits((curMid>>1) | (nextMid<<31), middle, lo, hi);
+      addBits((curDn<<1)  | (prevDn>>31),  edge,   lo, hi);
+      addBits(curDn,                       middle, lo, hi);
+      addBits((curDn>>1)  | (nextDn<<31),  edge,   lo, hi);
+      _mm_storeu_si128(dst++,lo);
+      _mm_storeu_si128(dst++,hi);
+
+      prevUp  = curUp;
+      prevMid = curMid;
+      prevDn  = curDn;
+   }
+
+   // the C version stops 16 pixels short of the penultimate row's end;
+   // clear those and the last row of dest
+   dMemset((U8*)dst - 16,0,16 + dim);
+}
+#endif
+
 void BitRender::bitTo8Bit(U32 * bits, U32 * eightBits, S32 dim)
 {
+#if defined(BITRENDER_USE_SSE2)
+   if (Platform::SystemInfo.processor.properties & CPU_PROP_SSE2)
+   {
+      bitTo8Bit_sse2(bits,eightBits,dim);
+      return;
+   }
+#endif
+
    dim *= dim>>5;
    for (S32 i=0; i<dim; i++)
    {
@@ -919,6 +679,14 @@ void BitRender::bitTo8Bit_3(U32 * bits, U32 * eightBits, S32 dim)
 		*eightBits++ = 0L;
 
 #else // the old windows implementation, which isn't working on Mac right now.
+#if defined(BITRENDER_USE_SSE2)
+   if (Platform::SystemInfo.processor.properties & CPU_PROP_SSE2)
+   {
+      bitTo8Bit_3_sse2(bits,eightBits,dim);
+      return;
+   }
+#endif
+
    // clear out first row of dest
    U32 * end32 = eightBits + (dim>>2);
    do { *eightBits++=0; } while (eightBits<end32);
@@ -11,6 +11,8 @@
 #include "math/mathIO.h"
 #include "platform/event.h"
 #include "console/consoleObject.h"
+#include "core/resManager.h"
+#include "core/fileStream.h"
 
 static BitStream gPacketStream(NULL, 0);
 static U8 gPacketBuffer[MaxPacketDataSize];
@@ -74,8 +76,6 @@ class HuffmanProcessor
    static const U32 csm_charFreqs[256];
    bool   m_tablesBuilt;
 
-   void buildTables();
-
    struct HuffNode {
       U32 pop;
 
@@ -110,16 +110,45 @@ class HuffmanProcessor
 
    void generateCodes(BitStream&, S32, S32);
 
+   const U32* m_charFreqs;
+   U32        m_ownFreqs[256];
+
   public:
-   HuffmanProcessor() : m_tablesBuilt(false) { }
+   HuffmanProcessor() : m_tablesBuilt(false), m_charFreqs(csm_charFreqs) { }
+   HuffmanProcessor(const U32 freqs[256]) : m_tablesBuilt(false), m_charFreqs(m_ownFreqs)
+   {
+      dMemcpy(m_ownFreqs, freqs, sizeof(m_ownFreqs));
+   }
+
+   U32 getCRC() { return calculateCRC(m_charFreqs, sizeof(m_ownFreqs)); }
+   bool isBuilt() const { return m_tablesBuilt; }
+   void buildTables();
 
    static HuffmanProcessor g_huffProcessor;
+   static HuffmanProcessor* smTables[BitStream::MaxHuffmanTables];
+
+   /// Falls back to the built in table for unknown ids.
+   static HuffmanProcessor* getTable(U32 id)
+   {
+      return (id < BitStream::MaxHuffmanTables && smTables[id]) ? smTables[id] : &g_huffProcessor;
+   }
+
+   static bool smTraining;
+   static U32  smTrainingFreqs[256];
+   static void train(const char* buffer, S32 len)
+   {
+      for (S32 i = 0; i < len; i++)
+         smTrainingFreqs[(U8)buffer[i]]++;
+   }
 
    bool readHuffBuffer(BitStream* pStream, char* out_pBuffer);
    bool writeHuffBuffer(BitStream* pStream, const char* out_pBuffer, S32 maxLen);
 };
 
 HuffmanProcessor HuffmanProcessor::g_huffProcessor;
+HuffmanProcessor* HuffmanProcessor::smTables[BitStream::MaxHuffmanTables] = { &HuffmanProcessor::g_huffProcessor };
+bool HuffmanProcessor::smTraining = false;
+U32  HuffmanProcessor::smTrainingFreqs[256];
 
 void BitStream::setBuffer(void *bufPtr, S32 size, S32 maxSize)
 {
@@ -132,6 +161,7 @@ void BitStream::setBuffer(void *bufPtr, S32 size, S32 maxSize)
    maxWriteBitNum = maxSize << 3;
    error = false;
    mCompressRelative = false;
+   mHuffmanTable = 0;
 }
 
 U32 BitStream::getPosition() const
@@ -194,6 +224,34 @@ void BitStream::writeBits(S32 bitCount, const void *bitPtr)
       AssertFatal(false, "Out of range write");
       return;
    }
+
+   // Fast path: merge the whole run into one 64 bit word.  Bits past the
+   // end of the run in its last byte are cleared, later bytes are left
+   // alone, same as the byte loop below.
+   if(bitCount <= MaxWordBits && (bitNum >> 3) + 8 <= bufSize)
+   {
+      U8 *stPtr = dataPtr + (bitNum >> 3);
+      S32 upShift = bitNum & 0x7;
+      S32 endBit  = ((upShift + bitCount + 7) >> 3) << 3;
+
+      U64 src = 0;
+      dMemcpy(&src, bitPtr, (bitCount + 7) >> 3);
+      src = convertLEndianToHost(src) & ((U64(1) << bitCount) - 1);
+
+      U64 keep = (U64(1) << upShift) - 1;
+      if(endBit < 64)
+         keep |= ~U64(0) << endBit;
+
+      U64 word;
+      dMemcpy(&word, stPtr, 8);
+      word = convertLEndianToHost(word);
+      word = convertHostToLEndian((word & keep) | (src << upShift));
+      dMemcpy(stPtr, &word, 8);
+
+      bitNum += bitCount;
+      return;
+   }
+
    const U8 *ptr = (U8 *) bitPtr;
    U8 *stPtr = dataPtr + (bitNum >> 3);
    U8 *endPtr = dataPtr + ((bitCount + bitNum - 1) >> 3);
@@ -261,6 +319,19 @@ void BitStream::readBits(S32 bitCount, void *bitPtr)
    U8 *stPtr = dataPtr + (bitNum >> 3);
    S32 byteCount = (bitCount + 7) >> 3;
 
+   // Fast path: one 64 bit load covers the run.  Like the byte loop this
+   // also hands back whatever bits follow the run in its last byte.
+   if(bitCount <= MaxWordBits && (bitNum >> 3) + 8 <= bufSize)
+   {
+      U64 word;
+      dMemcpy(&word, stPtr, 8);
+      word = convertHostToLEndian(convertLEndianToHost(word) >> (bitNum & 0x7));
+      dMemcpy(bitPtr, &word, byteCount);
+
+      bitNum += bitCount;
+      return;
+   }
+
    U8 *ptr = (U8 *) bitPtr;
 
    S32 downShift = bitNum & 0x7;
@@ -289,6 +360,24 @@ bool BitStream::_write(U32 size, const void *dataPtr)
    return true;
 }
 
+void BitStream::writeBundle(U64 bits, S32 bitCount)
+{
+   AssertFatal(bitCount > 0 && bitCount <= 64, "BitStream::writeBundle: bad bit count");
+   bits = convertHostToLEndian(bits);
+   writeBits(bitCount, &bits);
+}
+
+U64 BitStream::readBundle(S32 bitCount)
+{
+   AssertFatal(bitCount > 0 && bitCount <= 64, "BitStream::readBundle: bad bit count");
+   U64 bits = 0;
+   readBits(bitCount, &bits);
+   bits = convertLEndianToHost(bits);
+   if(bitCount < 64)
+      bits &= (U64(1) << bitCount) - 1;
+   return bits;
+}
+
 S32 BitStream::readInt(S32 bitCount)
 {
    S32 ret = 0;
@@ -343,19 +432,68 @@ S32 BitStream::readSignedInt(S32 bitCount)
       return readInt(bitCount - 1);
 }
 
+//----------------------------------------------------------------------------
+// Packing helpers for the bundled writers below.  These produce the same bits
+// writeSignedFloat()/writeSignedInt() would.
+
+static inline U64 bundleMask(S32 bitCount)
+{
+   return (U64(1) << bitCount) - 1;
+}
+
+static inline U64 packSignedFloat(F32 f, S32 bitCount)
+{
+   return U64(U32(S32(((f + 1) * .5) * ((1 << bitCount) - 1)))) & bundleMask(bitCount);
+}
+
+static inline F32 unpackSignedFloat(U64 bits, S32 bitCount)
+{
+   return S32(bits & bundleMask(bitCount)) * 2 / F32((1 << bitCount) - 1) - 1.0f;
+}
+
+static inline U64 packSignedInt(S32 value, S32 bitCount)
+{
+   if(value < 0)
+      return 1 | ((U64(U32(-value)) & bundleMask(bitCount - 1)) << 1);
+   return (U64(U32(value)) & bundleMask(bitCount - 1)) << 1;
+}
+
+static inline S32 unpackSignedInt(U64 bits, S32 bitCount)
+{
+   S32 value = S32((bits >> 1) & bundleMask(bitCount - 1));
+   return (bits & 1) ? -value : value;
+}
+
 void BitStream::writeNormalVector(const Point3F& vec, S32 bitCount)
 {
    F32 phi   = mAtan(vec.x, vec.y) / M_PI;
    F32 theta = mAtan(vec.z, mSqrt(vec.x*vec.x + vec.y*vec.y)) / (M_PI/2.0);
 
+   if(bitCount * 2 + 1 <= 64)
+   {
+      writeBundle(packSignedFloat(phi, bitCount+1) |
+                  (packSignedFloat(theta, bitCount) << (bitCount+1)), bitCount * 2 + 1);
+      return;
+   }
+
    writeSignedFloat(phi, bitCount+1);
    writeSignedFloat(theta, bitCount);
 }
 
 void BitStream::readNormalVector(Point3F *vec, S32 bitCount)
 {
-   F32 phi   = readSignedFloat(bitCount+1) * M_PI;
-   F32 theta = readSignedFloat(bitCount) * (M_PI/2.0);
+   F32 phi, theta;
+   if(bitCount * 2 + 1 <= 64)
+   {
+      U64 bits = readBundle(bitCount * 2 + 1);
+      phi   = unpackSignedFloat(bits, bitCount+1) * M_PI;
+      theta = unpackSignedFloat(bits >> (bitCount+1), bitCount) * (M_PI/2.0);
+   }
+   else
+   {
+      phi   = readSignedFloat(bitCount+1) * M_PI;
+      theta = readSignedFloat(bitCount) * (M_PI/2.0);
+   }
 
    vec->x = mSin(phi)*mCos(theta);
    vec->y = mCos(phi)*mCos(theta);
@@ -377,26 +515,37 @@ Point3F BitStream::dumbDownNormal(const Point3F& vec, S32 bitCount)
 
 void BitStream::writeNormalVector(const Point3F& vec, S32 angleBitCount, S32 zBitCount)
 {
-   writeSignedFloat( vec.z, zBitCount );
-
    // don't need to write x and y if they are both zero, which we can assess
    // by checking for |z| == 1
+   F32 angle = 0.0f;
    if(!IsEqual(mFabs(vec.z), 1.0f))
+      angle = mAtan(vec.x,vec.y) / M_2PI;
+
+   if(zBitCount + angleBitCount <= 64)
    {
-      writeSignedFloat( mAtan(vec.x,vec.y) / M_2PI, angleBitCount );
-   }
-   else
-   {
-      // angle won't matter...
-      writeSignedFloat(0.0f,angleBitCount);
+      writeBundle(packSignedFloat(vec.z, zBitCount) |
+                  (packSignedFloat(angle, angleBitCount) << zBitCount), zBitCount + angleBitCount);
+      return;
    }
+
+   writeSignedFloat( vec.z, zBitCount );
+   writeSignedFloat( angle, angleBitCount );
 }
 
 void BitStream::readNormalVector(Point3F * vec, S32 angleBitCount, S32 zBitCount)
 {
-   vec->z = readSignedFloat(zBitCount);
-
-   F32 angle = M_2PI * readSignedFloat(angleBitCount);
+   F32 angle;
+   if(zBitCount + angleBitCount <= 64)
+   {
+      U64 bits = readBundle(zBitCount + angleBitCount);
+      vec->z = unpackSignedFloat(bits, zBitCount);
+      angle = M_2PI * unpackSignedFloat(bits >> zBitCount, angleBitCount);
+   }
+   else
+   {
+      vec->z = readSignedFloat(zBitCount);
+      angle = M_2PI * readSignedFloat(angleBitCount);
+   }
    F32 mult = mSqrt(1.0f - vec->z * vec->z);
    vec->x = mult * mSin(angle);
    vec->y = mult * mCos(angle);
@@ -409,14 +558,24 @@ void BitStream::writeAffineTransform(const MatrixF& matrix)
 
    Point3F pos;
    matrix.getColumn(3, &pos);
-   mathWrite(*this, pos);
 
    QuatF q(matrix);
    q.normalize();
-   write(q.x);
-   write(q.y);
-   write(q.z);
-   writeFlag(q.w < 0.0);
+
+   // Position, the quat's x, y and z, then the sign of w: one run of 193 bits,
+   // laid out just like the individual writes.
+   F32 words[6];
+   words[0] = convertHostToLEndian(pos.x);
+   words[1] = convertHostToLEndian(pos.y);
+   words[2] = convertHostToLEndian(pos.z);
+   words[3] = convertHostToLEndian(q.x);
+   words[4] = convertHostToLEndian(q.y);
+   words[5] = convertHostToLEndian(q.z);
+
+   U8 buffer[sizeof(words) + 1];
+   dMemcpy(buffer, words, sizeof(words));
+   buffer[sizeof(words)] = q.w < 0.0;
+   writeBits(sizeof(words) * 8 + 1, buffer);
 }
 
 void BitStream::readAffineTransform(MatrixF* matrix)
@@ -424,12 +583,19 @@ void BitStream::readAffineTransform(MatrixF* matrix)
    Point3F pos;
    QuatF   q;
 
-   mathRead(*this, &pos);
-   read(&q.x);
-   read(&q.y);
-   read(&q.z);
+   F32 words[6];
+   U8 buffer[sizeof(words) + 1];
+   readBits(sizeof(words) * 8 + 1, buffer);
+   dMemcpy(words, buffer, sizeof(words));
+
+   pos.x = convertLEndianToHost(words[0]);
+   pos.y = convertLEndianToHost(words[1]);
+   pos.z = convertLEndianToHost(words[2]);
+   q.x = convertLEndianToHost(words[3]);
+   q.y = convertLEndianToHost(words[4]);
+   q.z = convertLEndianToHost(words[5]);
    q.w = mSqrt(1.0 - getMin(F32(((q.x * q.x) + (q.y * q.y) + (q.z * q.z))), 1.f));
-   if (readFlag())
+   if (buffer[sizeof(words)] & 1)
       q.w = -q.w;
 
    q.setMatrix(matrix);
@@ -478,17 +644,19 @@ void BitStream::writeCompressedPoint(const Point3F& p,F32 scale)
    else
       type = 3;
 
-   writeInt(type, 2);
-
    if (type != 3)
    {
-      type = gBitCounts[type];
-      writeSignedInt(S32(vec.x * invScale),type);
-      writeSignedInt(S32(vec.y * invScale),type);
-      writeSignedInt(S32(vec.z * invScale),type);
+      // Type and all three axes fit in a single bundle (at most 62 bits).
+      U32 bits = gBitCounts[type];
+      writeBundle(type |
+                  (packSignedInt(S32(vec.x * invScale), bits) << 2) |
+                  (packSignedInt(S32(vec.y * invScale), bits) << (2 + bits)) |
+                  (packSignedInt(S32(vec.z * invScale), bits) << (2 + bits * 2)),
+                  2 + bits * 3);
    }
    else
    {
+      writeInt(type, 2);
       write(p.x);
       write(p.y);
       write(p.z);
@@ -508,10 +676,11 @@ void BitStream::readCompressedPoint(Point3F* p,F32 scale)
    }
    else
    {
-      type = gBitCounts[type];
-      p->x = readSignedInt(type);
-      p->y = readSignedInt(type);
-      p->z = readSignedInt(type);
+      U32 bits = gBitCounts[type];
+      U64 axes = readBundle(bits * 3);
+      p->x = unpackSignedInt(axes, bits);
+      p->y = unpackSignedInt(axes >> bits, bits);
+      p->z = unpackSignedInt(axes >> (bits * 2), bits);
 
       p->x = mCompressPoint.x + p->x * scale;
       p->y = mCompressPoint.y + p->y * scale;
@@ -576,17 +745,18 @@ void InfiniteBitStream::writeToStream(Stream &s)
 
 void BitStream::readString(char buf[256])
 {
+   HuffmanProcessor* huff = HuffmanProcessor::getTable(mHuffmanTable);
    if(stringBuffer)
    {
       if(readFlag())
       {
          S32 offset = readInt(8);
-         HuffmanProcessor::g_huffProcessor.readHuffBuffer(this, stringBuffer + offset);
+         huff->readHuffBuffer(this, stringBuffer + offset);
          dStrcpy(buf, stringBuffer);
          return;
       }
    }
-   HuffmanProcessor::g_huffProcessor.readHuffBuffer(this, buf);
+   huff->readHuffBuffer(this, buf);
    if(stringBuffer)
       dStrcpy(stringBuffer, buf);
 }
@@ -595,6 +765,7 @@ void BitStream::writeString(const char *string, S32 maxLen)
 {
    if(!string)
       string = "";
+   HuffmanProcessor* huff = HuffmanProcessor::getTable(mHuffmanTable);
    if(stringBuffer)
    {
       S32 j;
@@ -606,11 +777,129 @@ void BitStream::writeString(const char *string, S32 maxLen)
       if(writeFlag(j > 2))
       {
          writeInt(j, 8);
-         HuffmanProcessor::g_huffProcessor.writeHuffBuffer(this, string + j, maxLen - j);
+         huff->writeHuffBuffer(this, string + j, maxLen - j);
          return;
       }
    }
-   HuffmanProcessor::g_huffProcessor.writeHuffBuffer(this, string, maxLen);
+   huff->writeHuffBuffer(this, string, maxLen);
+}
+
+//------------------------------------------------------------------------------
+
+void BitStream::setHuffmanTable(U32 id)
+{
+   AssertFatal(isHuffmanTableValid(id), "BitStream::setHuffmanTable: no such table.");
+   mHuffmanTable = id;
+}
+
+void BitStream::initHuffmanTables()
+{
+   if(!HuffmanProcessor::g_huffProcessor.isBuilt())
+      HuffmanProcessor::g_huffProcessor.buildTables();
+}
+
+bool BitStream::registerHuffmanTable(U32 id, const U32 freqs[256])
+{
+   // Table 0 is what every connection starts out with, it can't change.
+   if(id == 0 || id >= MaxHuffmanTables)
+      return false;
+
+   // Connections, and the threads building their packets, may be using an
+   // installed table at any time, so an id is only ever set once.  Loading
+   // the same table again is harmless.
+   HuffmanProcessor* table = new HuffmanProcessor(freqs);
+   if(HuffmanProcessor::smTables[id])
+   {
+      bool same = HuffmanProcessor::smTables[id]->getCRC() == table->getCRC();
+      delete table;
+      return same;
+   }
+
+   // Built here, so readers never build it lazily on another thread.
+   table->buildTables();
+   HuffmanProcessor::smTables[id] = table;
+   return true;
+}
+
+bool BitStream::isHuffmanTableValid(U32 id)
+{
+   return id < MaxHuffmanTables && HuffmanProcessor::smTables[id] != NULL;
+}
+
+U32 BitStream::getHuffmanTableCRC(U32 id)
+{
+   return isHuffmanTableValid(id) ? HuffmanProcessor::smTables[id]->getCRC() : 0;
+}
+
+void BitStream::setHuffmanTraining(bool enable)
+{
+   if(enable && !HuffmanProcessor::smTraining)
+      dMemset(HuffmanProcessor::smTrainingFreqs, 0, sizeof(HuffmanProcessor::smTrainingFreqs));
+   HuffmanProcessor::smTraining = enable;
+}
+
+void BitStream::getHuffmanTrainingFreqs(U32 freqs[256])
+{
+   dMemcpy(freqs, HuffmanProcessor::smTrainingFreqs, sizeof(HuffmanProcessor::smTrainingFreqs));
+}
+
+//------------------------------------------------------------------------------
+
+static const U32 csmHuffmanFileVersion = 1;
+
+ConsoleFunction(loadHuffmanTable, bool, 3, 3, "(int id, string file)"
+                "Load a string compression table saved by saveHuffmanTraining() as table id (1-15). "
+                "Client and server must both load it for connections to use it.")
+{
+   U32 id = dAtoi(argv[1]);
+   Stream *stream = ResourceManager->openStream(argv[2]);
+   if(!stream)
+   {
+      Con::errorf("loadHuffmanTable: could not open '%s'.", argv[2]);
+      return false;
+   }
+
+   U32 version;
+   U32 freqs[256];
+   stream->read(&version);
+   for(U32 i = 0; i < 256; i++)
+      stream->read(&freqs[i]);
+   bool ok = stream->getStatus() != Stream::IOError && version == csmHuffmanFileVersion;
+   ResourceManager->closeStream(stream);
+
+   if(!ok || !BitStream::registerHuffmanTable(id, freqs))
+   {
+      Con::errorf("loadHuffmanTable: bad table '%s' or id %d.", argv[2], id);
+      return false;
+   }
+   return true;
+}
+
+ConsoleFunction(startHuffmanTraining, void, 1, 1, "()"
+                "Start counting the characters of every network string, e.g. while playing back demos.")
+{
+   BitStream::setHuffmanTraining(true);
+}
+
+ConsoleFunction(stopHuffmanTraining, void, 1, 1, "()"
+                "Stop counting network string characters; the counts are kept for saveHuffmanTraining().")
+{
+   BitStream::setHuffmanTraining(false);
+}
+
+ConsoleFunction(saveHuffmanTraining, bool, 2, 2, "(string file)"
+                "Write the trained character counts as a table for loadHuffmanTable().")
+{
+   FileStream stream;
+   if(!ResourceManager->openFileForWrite(stream, argv[1]))
+      return false;
+
+   U32 freqs[256];
+   BitStream::getHuffmanTrainingFreqs(freqs);
+   stream.write(csmHuffmanFileVersion);
+   for(U32 i = 0; i < 256; i++)
+      stream.write(freqs[i]);
+   return true;
 }
 
 void HuffmanProcessor::buildTables()
@@ -628,7 +917,7 @@ void HuffmanProcessor::buildTables()
    for (i = 0; i < 256; i++) {
       HuffLeaf& rLeaf = m_huffLeaves[i];
 
-      rLeaf.pop    = csm_charFreqs[i] + 1;
+      rLeaf.pop    = m_charFreqs[i] + 1;
       rLeaf.symbol = U8(i);
 
       dMemset(&rLeaf.code, 0, sizeof(rLeaf.code));
@@ -728,8 +1017,7 @@ S16 HuffmanProcessor::determineIndex(HuffWrap& rWrap)
 
 bool HuffmanProcessor::readHuffBuffer(BitStream* pStream, char* out_pBuffer)
 {
-   if (m_tablesBuilt == false)
-      buildTables();
+   AssertFatal(m_tablesBuilt, "HuffmanProcessor::readHuffBuffer: tables not built, call BitStream::initHuffmanTables().");
 
    if (pStream->readFlag()) {
       S32 len = pStream->readInt(8);
@@ -749,12 +1037,16 @@ bool HuffmanProcessor::readHuffBuffer(BitStream* pStream, char* out_pBuffer)
          }
       }
       out_pBuffer[len] = '\0';
+      if (smTraining)
+         train(out_pBuffer, len);
       return true;
    } else {
       // Uncompressed string...
       U32 len = pStream->readInt(8);
       pStream->read(len, out_pBuffer);
       out_pBuffer[len] = '\0';
+      if (smTraining)
+         train(out_pBuffer, len);
       return true;
    }
 }
@@ -767,8 +1059,7 @@ bool HuffmanProcessor::writeHuffBuffer(BitStream* pStream, const char* out_pBuff
       return true;
    }
 
-   if (m_tablesBuilt == false)
-      buildTables();
+   AssertFatal(m_tablesBuilt, "HuffmanProcessor::writeHuffBuffer: tables not built, call BitStream::initHuffmanTables().");
 
    S32 len = out_pBuffer ? dStrlen(out_pBuffer) : 0;
    AssertWarn(len <= 255, "String TOO long for writeString");
@@ -776,6 +1067,9 @@ bool HuffmanProcessor::writeHuffBuffer(BitStream* pStream, const char* out_pBuff
    if (len > maxLen)
       len = maxLen;
 
+   if (smTraining)
+      train(out_pBuffer, len);
+
    S32 numBits = 0;
    S32 i;
    for (i = 0; i < len; i++)
@@ -33,6 +33,10 @@ class HuffmanProcessor;
 class BitStream : public Stream
 {
 protected:
+   /// Longest run writeBits()/readBits() move as a single 64 bit word; the
+   /// run plus its starting bit offset has to fit.
+   enum { MaxWordBits = 56 };
+
    U8 *dataPtr;
    S32  bitNum;
    S32  bufSize;
@@ -42,9 +46,45 @@ protected:
    char *stringBuffer;
    bool mCompressRelative;
    Point3F mCompressPoint;
+   U8   mHuffmanTable;
 
    friend class HuffmanProcessor;
 public:
+   /// @name String Compression Tables
+   ///
+   /// Strings are Huffman coded with one of up to MaxHuffmanTables tables.
+   /// Table 0 is built in; the others are loaded by the game (see
+   /// loadHuffmanTable()) and negotiated per connection, so both ends of a
+   /// stream must agree on the table it was written with.
+   /// @{
+
+   enum
+   {
+      HuffmanTableBits = 4,
+      MaxHuffmanTables = 1 << HuffmanTableBits,
+   };
+
+   /// Select the table readString()/writeString() use.  Reset to 0 by setBuffer().
+   void setHuffmanTable(U32 id);
+   U32  getHuffmanTable() const { return mHuffmanTable; }
+
+   /// Build table 0.  Called once at startup, before any stream is read or
+   /// written; no table is built on first use.
+   static void initHuffmanTables();
+   /// Install table id (1 or above) built from 256 symbol frequencies.  An
+   /// id can't be replaced once set; false unless it's unused, or already
+   /// holds the same table.
+   static bool registerHuffmanTable(U32 id, const U32 freqs[256]);
+   static bool isHuffmanTableValid(U32 id);
+   /// CRC of a table's frequencies, for checking both ends have the same one.
+   static U32  getHuffmanTableCRC(U32 id);
+
+   /// While training, every string read or written is counted into a
+   /// frequency table that can be saved and shipped as a new table.
+   static void setHuffmanTraining(bool enable);
+   static void getHuffmanTrainingFreqs(U32 freqs[256]);
+   /// @}
+
    static BitStream *getPacketStream(U32 writeSize = 0);
    static void sendPacketStream(const NetAddress *addr);
 
@@ -109,6 +149,15 @@ public:
    void writeSignedInt(S32 value, S32 bitCount);
    S32  readSignedInt(S32 bitCount);
 
+   /// Write up to 64 bits of pre-packed fields in one go.
+   ///
+   /// Fields packed LSB first, i.e. the first field in the low bits, end up
+   /// on the wire exactly as the equivalent run of writeInt()/writeFlag()
+   /// calls would, so the two can be mixed freely.  Saves the per-call
+   /// overhead and bounds check when writing fixed-width groups.
+   void writeBundle(U64 bits, S32 bitCount);
+   U64  readBundle(S32 bitCount);
+
    void writeRangedU32(U32 value, U32 rangeStart, U32 rangeEnd);
    U32  readRangedU32(U32 rangeStart, U32 rangeEnd);
 
@@ -224,6 +273,108 @@ public:
    }
 };
 
+//------------------------------------------------------------------------------
+/// Gathers fixed width fields into one word and writes them with a single
+/// BitStream::writeBundle().
+///
+/// The widths are template arguments, so the masks and shifts fold into
+/// straight line code instead of going through writeInt() with a run time
+/// bit count per field.  Fields land on the wire exactly as the same run of
+/// writeInt()/writeFlag()/writeSignedFloat()... calls would put them, and
+/// BitUnpacker reads them back the same way, so a packUpdate() can switch
+/// a group of fields over without touching the other end of the format.
+///
+/// @code
+///    BitPacker bits;
+///    bits.writeFlag(mFalling);
+///    bits.writeInt<NumStateBits>(mState);
+///    bits.flush(stream);
+///
+///    BitUnpacker bits(stream, 1 + NumStateBits);
+///    mFalling = bits.readFlag();
+///    mState = bits.readInt<NumStateBits>();
+/// @endcode
+class BitPacker
+{
+   U64 mBits;
+   S32 mCount;
+
+   template<S32 Bits> void put(U64 value)
+   {
+      AssertFatal(Bits > 0 && Bits <= 32 && mCount + Bits <= 64, "BitPacker: field doesn't fit");
+      mBits |= (value & ((U64(1) << Bits) - 1)) << mCount;
+      mCount += Bits;
+   }
+
+public:
+   BitPacker() : mBits(0), mCount(0) {}
+
+   bool writeFlag(bool val)
+   {
+      put<1>(val ? 1 : 0);
+      return val;
+   }
+   template<S32 Bits> void writeInt(S32 value)
+   {
+      put<Bits>(U32(value));
+   }
+   template<S32 Bits> void writeSignedInt(S32 value)
+   {
+      writeFlag(value < 0);
+      put<Bits - 1>(U32(value < 0 ? -value : value));
+   }
+   /// [0, 1], as writeFloat().
+   template<S32 Bits> void writeFloat(F32 f)
+   {
+      put<Bits>(U32(S32(f * ((1 << Bits) - 1))));
+   }
+   /// [-1, 1], as writeSignedFloat().
+   template<S32 Bits> void writeSignedFloat(F32 f)
+   {
+      put<Bits>(U32(S32(((f + 1) * .5) * ((1 << Bits) - 1))));
+   }
+
+   S32 getBitCount() const { return mCount; }
+
+   /// Write what's been gathered and start over.
+   void flush(BitStream *stream)
+   {
+      if(mCount)
+         stream->writeBundle(mBits, mCount);
+      mBits = 0;
+      mCount = 0;
+   }
+};
+
+/// Reads fields written by a BitPacker, or the equivalent run of writes,
+/// out of one BitStream::readBundle() of their total width.
+class BitUnpacker
+{
+   U64 mBits;
+
+   template<S32 Bits> U32 take()
+   {
+      AssertFatal(Bits > 0 && Bits <= 32, "BitUnpacker: bad field width");
+      U32 value = U32(mBits & ((U64(1) << Bits) - 1));
+      mBits >>= Bits;
+      return value;
+   }
+
+public:
+   BitUnpacker(BitStream *stream, S32 bitCount) : mBits(stream->readBundle(bitCount)) {}
+
+   bool readFlag()                          { return take<1>() != 0; }
+   template<S32 Bits> S32 readInt()         { return S32(take<Bits>()); }
+   template<S32 Bits> S32 readSignedInt()
+   {
+      bool neg = readFlag();
+      S32 value = S32(take<Bits - 1>());
+      return neg ? -value : value;
+   }
+   template<S32 Bits> F32 readFloat()       { return take<Bits>() / F32((1 << Bits) - 1); }
+   template<S32 Bits> F32 readSignedFloat() { return S32(take<Bits>()) * 2 / F32((1 << Bits) - 1) - 1.0f; }
+};
+
 //------------------------------------------------------------------------------
 //-------------------------------------- INLINES
 //
@@ -12,9 +12,13 @@
 DataChunker::DataChunker(S32 size)
 {
    chunkSize          = size;
+   spareBlocks        = NULL;
    curBlock           = new DataBlock(size);
    curBlock->next     = NULL;
    curBlock->curIndex = 0;
+   numBlocks          = 1;
+   bytesUsed          = 0;
+   highWaterMark      = 0;
 }
 
 DataChunker::~DataChunker()
@@ -22,18 +26,52 @@ DataChunker::~DataChunker()
    freeBlocks();
 }
 
+void DataChunker::newBlock()
+{
+   DataBlock *temp = spareBlocks;
+   if(temp)
+      spareBlocks = temp->next;
+   else
+   {
+      temp = new DataBlock(chunkSize);
+      numBlocks++;
+   }
+   temp->next = curBlock;
+   temp->curIndex = 0;
+   curBlock = temp;
+}
+
 void *DataChunker::alloc(S32 size)
+{
+   return alloc(size, 4);
+}
+
+void *DataChunker::alloc(S32 size, S32 align)
 {
    AssertFatal(size <= chunkSize, "Data chunk too large.");
-   if(!curBlock || size + curBlock->curIndex > chunkSize)
+   AssertFatal(align > 0 && (align & (align - 1)) == 0, "DataChunker::alloc: alignment must be a power of two.");
+
+   // Everything stays at least dword aligned.
+   if(align < 4)
+      align = 4;
+
+   S32 pad = 0;
+   if(curBlock)
+      pad = S32(-dsize_t(curBlock->data + curBlock->curIndex) & (align - 1));
+   if(!curBlock || pad + size + curBlock->curIndex > chunkSize)
    {
-      DataBlock *temp = new DataBlock(chunkSize);
-      temp->next = curBlock;
-      temp->curIndex = 0;
-      curBlock = temp;
+      newBlock();
+      pad = S32(-dsize_t(curBlock->data) & (align - 1));
+      AssertFatal(pad + size <= chunkSize, "Data chunk too large for its alignment.");
    }
-   void *ret = curBlock->data + curBlock->curIndex;
-   curBlock->curIndex += (size + 3) & ~3; // dword align
+
+   void *ret = curBlock->data + curBlock->curIndex + pad;
+   S32 used = pad + ((size + 3) & ~3); // dword align
+   curBlock->curIndex += used;
+
+   bytesUsed += used;
+   if(bytesUsed > highWaterMark)
+      highWaterMark = bytesUsed;
    return ret;
 }
 
@@ -55,5 +93,61 @@ void DataChunker::freeBlocks()
       delete curBlock;
       curBlock = temp;
    }
+   while(spareBlocks)
+   {
+      DataBlock *temp = spareBlocks->next;
+      delete spareBlocks;
+      spareBlocks = temp;
+   }
+   numBlocks = 0;
+   bytesUsed = 0;
 }
 
+void DataChunker::reset(U32 keepBytes)
+{
+   bytesUsed = 0;
+   if(curBlock)
+   {
+      // Keep the newest block current, the rest wait in the spares.
+      while(curBlock->next)
+      {
+         DataBlock *temp = curBlock->next;
+         curBlock->next = temp->next;
+         temp->next = spareBlocks;
+         spareBlocks = temp;
+      }
+      curBlock->curIndex = 0;
+   }
+
+   while(spareBlocks && numBlocks * U32(chunkSize) > keepBytes)
+   {
+      DataBlock *temp = spareBlocks->next;
+      delete spareBlocks;
+      spareBlocks = temp;
+      numBlocks--;
+   }
+}
+
+DataChunker::Marker DataChunker::getMarker() const
+{
+   Marker marker;
+   marker.block = curBlock;
+   marker.index = curBlock ? curBlock->curIndex : 0;
+   marker.used  = bytesUsed;
+   return marker;
+}
+
+void DataChunker::rollback(const Marker &marker)
+{
+   while(curBlock != marker.block)
+   {
+      AssertFatal(curBlock, "DataChunker::rollback: marker isn't from this chunker.");
+      DataBlock *temp = curBlock;
+      curBlock = temp->next;
+      temp->next = spareBlocks;
+      spareBlocks = temp;
+   }
+   if(curBlock)
+      curBlock->curIndex = marker.index;
+   bytesUsed = marker.used;
+}
@@ -23,6 +23,12 @@
 /// Note that new/free/realloc WILL NOT WORK on memory gotten from the
 /// DataChunker. This also only grows (you can call freeBlocks to deallocate
 /// and reset things).
+///
+/// For scratch memory that's filled and thrown away over and over, reset()
+/// and rollback() hand the memory back without freeing the blocks, so the
+/// chunker settles at its high water mark and stops allocating.  A
+/// DataChunker isn't locked; code used from several threads keeps one per
+/// thread in a ThreadStorage.
 class DataChunker
 {
   public:
@@ -43,9 +49,22 @@ class DataChunker
       ~DataBlock();
    };
    DataBlock *curBlock;
+   DataBlock *spareBlocks;    ///< Kept by reset(), used before new ones.
    S32 chunkSize;
+   U32 numBlocks;             ///< Including the spares.
+   U32 bytesUsed;             ///< Handed out since the last reset, padding included.
+   U32 highWaterMark;         ///< Most bytesUsed has been.
+
+   void newBlock();
 
   public:
+   /// A point to go back to with rollback().
+   struct Marker
+   {
+      DataBlock *block;
+      S32        index;
+      U32        used;
+   };
 
    /// Return a pointer to a chunk of memory from a pre-allocated block.
    ///
@@ -56,11 +75,38 @@ class DataChunker
    ///                  an assertion will occur.
    void *alloc(S32 size);
 
+   /// Like alloc(), but aligned to align bytes, a power of two.
+   void *alloc(S32 size, S32 align);
+
    /// Free all allocated memory blocks.
    ///
    /// This invalidates all pointers returned from alloc().
    void freeBlocks();
 
+   /// Throw away everything allocated but keep the blocks for reuse.
+   ///
+   /// Like freeBlocks() this invalidates all pointers returned from alloc(),
+   /// but code that fills a chunker up again, say once per light, doesn't
+   /// go back to new for it.
+   ///
+   /// @param   keepBytes   Spare blocks past this much memory are freed, so
+   ///                      one huge use doesn't pin its memory for good.
+   void reset(U32 keepBytes = U32(-1));
+
+   /// Where the next allocation would come from.
+   Marker getMarker() const;
+
+   /// Give back everything allocated since the marker was taken,
+   /// keeping the blocks.  Markers taken after it are invalidated.
+   void rollback(const Marker &marker);
+
+   /// @name Statistics
+   /// @{
+   U32 getBytesUsed() const      { return bytesUsed; }
+   U32 getHighWaterMark() const  { return highWaterMark; }
+   U32 getBytesReserved() const  { return numBlocks * chunkSize; }
+   /// @}
+
    /// Initialize using blocks of a given size.
    ///
    /// One new block is allocated at constructor-time.
@@ -77,9 +123,16 @@ template<class T>
 class Chunker: private DataChunker
 {
 public:
+   typedef DataChunker::Marker Marker;
+
    Chunker(S32 size = DataChunker::ChunkSize) : DataChunker(size) {};
    T* alloc()  { return reinterpret_cast<T*>(DataChunker::alloc(S32(sizeof(T)))); }
    void clear()  { freeBlocks(); };
+   void reset()  { DataChunker::reset(); };
+
+   Marker getMarker() const              { return DataChunker::getMarker(); }
+   void rollback(const Marker &marker)   { DataChunker::rollback(marker); }
+   U32 getHighWaterMark() const          { return DataChunker::getHighWaterMark(); }
 };
 
 template<class T>
@@ -131,5 +184,50 @@ public:
    }
 };
 
+//----------------------------------------------------------------------------
+/// Pool of small objects of type T that are allocated and freed all the time.
+///
+/// Elements come out of DataChunker blocks, and freed elements go on a free
+/// list for the next alloc().  The list is intrusive: it's threaded through
+/// T's own next member, so T must have a T *next, and the rest of a freed
+/// element is left alone.  Unlike FreeListChunker, the blocks are kept when
+/// everything has been freed, since a pool like this is about to be used
+/// again.
+///
+/// alloc() returns raw memory; nothing is constructed or destructed.
+template<class T>
+class FreeListPool: private DataChunker
+{
+   T  *mFreeList;
+   U32 mNumAllocated;
+
+public:
+   FreeListPool(S32 size = DataChunker::ChunkSize) : DataChunker(size)
+   {
+      mFreeList = NULL;
+      mNumAllocated = 0;
+   }
+
+   T *alloc()
+   {
+      mNumAllocated++;
+      if(!mFreeList)
+         return reinterpret_cast<T*>(DataChunker::alloc(S32(sizeof(T))));
+      T *ret = mFreeList;
+      mFreeList = ret->next;
+      return ret;
+   }
+
+   void free(T *elem)
+   {
+      AssertFatal(mNumAllocated, "FreeListPool::free: nothing to free.");
+      mNumAllocated--;
+      elem->next = mFreeList;
+      mFreeList = elem;
+   }
+
+   /// Elements allocated and not yet freed.
+   U32 getNumAllocated() const { return mNumAllocated; }
+};
 
 #endif
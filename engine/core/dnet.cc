@@ -39,6 +39,7 @@ ConsoleFunction(DNetSetLogging, void, 2, 2, "(bool enabled)")
 ConnectionProtocol::ConnectionProtocol()
 {
    mLastSeqRecvd = 0;
+   mHandlingSeq = 0;
    mHighestAckedSeq = 0;
    mLastSendSeq = 0; // start sending at 1
    mAckMask = 0;
@@ -225,7 +226,10 @@ void ConnectionProtocol::processRawPacket(BitStream *pstream)
    keepAlive(); // notification that the connection is ok
 
    if(mLastSeqRecvd != pkSequenceNumber && pkPacketType == DataPacket)
+   {
+      mHandlingSeq = pkSequenceNumber;
       handlePacket(pstream);
+   }
 
    mLastSeqRecvd = pkSequenceNumber;
 }
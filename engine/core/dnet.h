@@ -31,6 +31,7 @@ class ConnectionProtocol
 protected:
    U32 mLastSeqRecvdAtSend[32];
    U32 mLastSeqRecvd;
+   U32 mHandlingSeq;          ///< Sequence number of the data packet being handled.
    U32 mHighestAckedSeq;
    U32 mLastSendSeq;
    U32 mAckMask;
@@ -4,18 +4,106 @@
 //-----------------------------------------------------------------------------
 
 #include "core/frameAllocator.h"
+#include "platform/platformMutex.h"
 #include "console/console.h"
 
-U8*   FrameAllocator::smBuffer = NULL;
-U32   FrameAllocator::smWaterMark = 0;
-U32   FrameAllocator::smHighWaterMark = 0;
+FrameAllocator::Instance *FrameAllocator::smMainInstance = NULL;
+FrameAllocator::Instance *FrameAllocator::smInstanceList = NULL;
+void                     *FrameAllocator::smInstanceMutex = NULL;
+U32                       FrameAllocator::smWorkerPageSize = 256 << 10;
+#ifdef TORQUE_MULTITHREAD
+ThreadStorage             FrameAllocator::smThreadInstance;
+#endif
+
+static FrameAllocator::Page *newPage(U32 base, U32 size)
+{
+   FrameAllocator::Page *page = (FrameAllocator::Page *) dMalloc(sizeof(FrameAllocator::Page) + size);
+   page->next = NULL;
+   page->prev = NULL;
+   page->base = base;
+   page->size = size;
+   return page;
+}
+
+FrameAllocator::Instance *FrameAllocator::createInstance(U32 pageSize)
+{
+   Instance *inst = new Instance;
+   inst->first = inst->current = inst->last = newPage(0, pageSize);
+   inst->waterMark = 0;
+   inst->pageSize = pageSize;
+   inst->maxWaterMark = 0;
+
+   if(smInstanceMutex)
+      Mutex::lockMutex(smInstanceMutex);
+   inst->nextInstance = smInstanceList;
+   smInstanceList = inst;
+   if(smInstanceMutex)
+      Mutex::unlockMutex(smInstanceMutex);
+   return inst;
+}
+
+void FrameAllocator::nextPage(Instance *inst, U32 allocSize)
+{
+   // The rest of the current page is left unused until the water mark is
+   // set back below it.  Pages already in the chain that are too small for
+   // this allocation are skipped the same way.
+   do
+   {
+      if(!inst->current->next)
+      {
+         Page *page = newPage(inst->last->getEnd(), getMax(inst->pageSize, allocSize));
+         page->prev = inst->last;
+         inst->last->next = page;
+         inst->last = page;
+      }
+      inst->current = inst->current->next;
+   } while(inst->current->size < allocSize);
+
+   inst->waterMark = inst->current->base;
+}
+
+void FrameAllocator::init(const U32 frameSize)
+{
+   AssertFatal(smMainInstance == NULL, "Error, already initialized");
+   smInstanceMutex = Mutex::createMutex();
+   smMainInstance = createInstance(frameSize);
+#ifdef TORQUE_MULTITHREAD
+   smThreadInstance.set(smMainInstance);
+#endif
+}
+
+void FrameAllocator::destroy()
+{
+   AssertFatal(smMainInstance != NULL, "Error, not initialized");
+
+   // The worker threads are gone by now, so their allocators go too.
+   while(smInstanceList)
+   {
+      Instance *inst = smInstanceList;
+      smInstanceList = inst->nextInstance;
+      while(inst->first)
+      {
+         Page *page = inst->first;
+         inst->first = page->next;
+         dFree(page);
+      }
+      delete inst;
+   }
+   smMainInstance = NULL;
+#ifdef TORQUE_MULTITHREAD
+   smThreadInstance.set(NULL);
+#endif
+
+   Mutex::destroyMutex(smInstanceMutex);
+   smInstanceMutex = NULL;
+}
 
 #if defined(TORQUE_DEBUG)
 
 ConsoleFunction(getMaxFrameAllocation, S32, 1,1, "getMaxFrameAllocation();")
 {
    argc, argv;
-   return sgMaxFrameAllocation;
+   return FrameAllocator::getMaxWaterMark();
 }
 
 #endif
@@ -10,6 +10,10 @@
 #include "platform/platform.h"
 #endif
 
+#ifndef _PLATFORMTHREAD_H_
+#include "platform/platformThread.h"
+#endif
+
 /// Temporary memory pool for per-frame allocations.
 ///
 /// In the course of rendering a frame, it is often necessary to allocate
@@ -26,93 +30,142 @@
 ///   // Free frameAllocator memory
 ///   FrameAllocator::setWaterMark(waterMark);
 /// @endcode
+///
+/// Every thread has its own allocator, so worker thread jobs can use it
+/// (and FrameAllocatorMarker and FrameTemp) as freely as the main thread.
+/// The main thread's is set up by init(); a worker's is created the first
+/// time the worker allocates, with pages of smWorkerPageSize bytes.
+///
+/// An allocator is a chain of pages.  When an allocation doesn't fit in
+/// the rest of the current page it moves on to the next page, adding one
+/// big enough if there isn't one, so allocations never fail.  Water marks
+/// count through the pages in order, so a water mark still names a point
+/// in the chain, and restoring it goes back to the page it was taken on.
+/// Pages are kept for reuse until destroy().
 class FrameAllocator
 {
-   static U8*   smBuffer;
-   static U32   smHighWaterMark;
-   static U32   smWaterMark;
-
   public:
-   inline static void init(const U32 frameSize);
-   inline static void destroy();
+   /// A page in an allocator's chain; the memory follows the header.
+   struct Page
+   {
+      Page *next;
+      Page *prev;
+      U32   base;                   ///< Water mark of the first byte.
+      U32   size;
 
-   inline static void* alloc(const U32 allocSize);
+      U8 *getData() { return (U8 *) (this + 1); }
+      U32 getEnd()  { return base + size; }
+   };
 
-   inline static void setWaterMark(const U32);
-   inline static U32  getWaterMark();
-   inline static U32  getHighWaterMark();
-};
-
-#if defined(TORQUE_DEBUG)
-static S32 sgMaxFrameAllocation = 0;
+   /// A thread's allocator.
+   struct Instance
+   {
+      Page     *first;
+      Page     *current;
+      Page     *last;
+      U32       waterMark;
+      U32       pageSize;           ///< Minimum size of new pages.
+      U32       maxWaterMark;       ///< Highest water mark reached.
+      Instance *nextInstance;
+   };
+
+   static U32 smWorkerPageSize;     ///< Page size of worker thread allocators.
+
+  private:
+   static Instance *smMainInstance;
+   static Instance *smInstanceList;
+   static void     *smInstanceMutex;
+#ifdef TORQUE_MULTITHREAD
+   static ThreadStorage smThreadInstance;
 #endif
 
-void FrameAllocator::init(const U32 frameSize)
-{
-   AssertFatal(smBuffer == NULL, "Error, already initialized");
-   smBuffer = new U8[frameSize];
-   smWaterMark = 0;
-   smHighWaterMark = frameSize;
-}
+   static Instance *createInstance(U32 pageSize);
+   /// Moves to a page with allocSize bytes free, the slow part of alloc().
+   static void nextPage(Instance *inst, U32 allocSize);
 
-void FrameAllocator::destroy()
-{
-   AssertFatal(smBuffer != NULL, "Error, not initialized");
+  public:
+   static void init(const U32 frameSize);
+   static void destroy();
+
+   /// Get the calling thread's allocator.
+   inline static Instance *getInstance();
+
+   inline static void* alloc(const U32 allocSize) { return alloc(getInstance(), allocSize); }
+   inline static void  setWaterMark(const U32 waterMark) { setWaterMark(getInstance(), waterMark); }
+   inline static U32   getWaterMark() { return getInstance()->waterMark; }
+   /// End of the pages already allocated; allocating past it adds a page.
+   inline static U32   getHighWaterMark() { return getInstance()->last->getEnd(); }
+   /// Highest water mark the main thread has reached.
+   static U32 getMaxWaterMark() { return smMainInstance ? smMainInstance->maxWaterMark : 0; }
+
+   /// @name Instance access
+   /// For callers that have already looked up their thread's allocator.
+   /// @{
+   inline static void* alloc(Instance *inst, const U32 allocSize);
+   inline static void  setWaterMark(Instance *inst, const U32 waterMark);
+   static U32 getWaterMark(Instance *inst) { return inst->waterMark; }
+   /// @}
+};
 
-   delete [] smBuffer;
-   smBuffer = NULL;
-   smWaterMark = 0;
-   smHighWaterMark = 0;
+FrameAllocator::Instance *FrameAllocator::getInstance()
+{
+#ifdef TORQUE_MULTITHREAD
+   Instance *inst = (Instance *) smThreadInstance.get();
+   if(!inst)
+   {
+      inst = createInstance(smWorkerPageSize);
+      smThreadInstance.set(inst);
+   }
+   return inst;
+#else
+   AssertFatal(smMainInstance != NULL, "Error, not initialized");
+   return smMainInstance;
+#endif
 }
 
-
-void* FrameAllocator::alloc(const U32 allocSize)
+void* FrameAllocator::alloc(Instance *inst, const U32 allocSize)
 {
    U32 _allocSize = allocSize;
 #if defined(FRAMEALLOCATOR_DEBUG_GUARD)
    _allocSize+=4;
 #endif
-   AssertFatal(smBuffer != NULL, "Error, no buffer!");
-   AssertFatal(smWaterMark + _allocSize <= smHighWaterMark, "Error alloc too large, increase frame size!");
+   if(inst->waterMark + _allocSize > inst->current->getEnd())
+      nextPage(inst, _allocSize);
 
-   U8* p = &smBuffer[smWaterMark];
-   smWaterMark += _allocSize;
+   U8* p = inst->current->getData() + (inst->waterMark - inst->current->base);
+   inst->waterMark += _allocSize;
 
 #if defined(TORQUE_DEBUG)
-   if (smWaterMark > sgMaxFrameAllocation)
-      sgMaxFrameAllocation = smWaterMark;
+   if (inst->waterMark > inst->maxWaterMark)
+      inst->maxWaterMark = inst->waterMark;
 #endif
 
 #if defined(FRAMEALLOCATOR_DEBUG_GUARD)
-   U32 *flag = (U32*) &smBuffer[smWaterMark-4];
-   *flag = 0xdeadbeef ^ smWaterMark;
+   U32 *flag = (U32*) (p + _allocSize - 4);
+   *flag = 0xdeadbeef ^ inst->waterMark;
 #endif
    return p;
 }
 
 
-void FrameAllocator::setWaterMark(const U32 waterMark)
+void FrameAllocator::setWaterMark(Instance *inst, const U32 waterMark)
 {
-   AssertFatal(waterMark < smHighWaterMark, "Error, invalid waterMark");
+   AssertFatal(waterMark <= inst->last->getEnd(), "Error, invalid waterMark");
 
 #if defined(FRAMEALLOCATOR_DEBUG_GUARD)
-   if(smWaterMark >= 4 )
+   if(inst->waterMark >= inst->current->base + 4)
    {
-      U32 *flag = (U32*) &smBuffer[smWaterMark-4];
-      AssertFatal( *flag == 0xdeadbeef ^ smWaterMark, "FrameAllocator guard overwritten!");
+      U32 *flag = (U32*) (inst->current->getData() + (inst->waterMark - inst->current->base) - 4);
+      AssertFatal( *flag == 0xdeadbeef ^ inst->waterMark, "FrameAllocator guard overwritten!");
    }
 #endif
-   smWaterMark = waterMark;
-}
-
-U32 FrameAllocator::getWaterMark()
-{
-   return smWaterMark;
-}
-
-U32 FrameAllocator::getHighWaterMark()
-{
-   return smHighWaterMark;
+   // Onto the page the mark was taken on; a mark at the start of a page
+   // can belong to the end of the one before, either will do.
+   while(waterMark < inst->current->base)
+      inst->current = inst->current->prev;
+   while(waterMark > inst->current->getEnd())
+      inst->current = inst->current->next;
+   inst->waterMark = waterMark;
 }
 
 /// Helper class to deal with FrameAllocator usage.
@@ -132,22 +185,24 @@ U32 FrameAllocator::getHighWaterMark()
 /// don't have to remember to reset the FrameAllocator on every posssible branch.
 class FrameAllocatorMarker
 {
+   FrameAllocator::Instance *mInstance;
    U32 mMarker;
 
 public:
    FrameAllocatorMarker()
    {
-      mMarker = FrameAllocator::getWaterMark();
+      mInstance = FrameAllocator::getInstance();
+      mMarker = FrameAllocator::getWaterMark(mInstance);
    }
 
    ~FrameAllocatorMarker()
    {
-      FrameAllocator::setWaterMark(mMarker);
+      FrameAllocator::setWaterMark(mInstance, mMarker);
    }
 
    void* alloc(const U32 allocSize) const
    {
-      return FrameAllocator::alloc(allocSize);
+      return FrameAllocator::alloc(mInstance, allocSize);
    }
 };
 
@@ -181,6 +236,7 @@ template<class T>
 class FrameTemp
 {
 protected:
+   FrameAllocator::Instance *mInstance;
    U32 mWaterMark;
    T *mMemory;
 
@@ -203,14 +259,15 @@ public:
    FrameTemp( const U32 count = 1 )
    {
       AssertFatal( count > 0, "Allocating a FrameTemp with less than one instance" );
-      mWaterMark = FrameAllocator::getWaterMark();
-      mMemory = static_cast<T *>( FrameAllocator::alloc( sizeof( T ) * count ) );
+      mInstance = FrameAllocator::getInstance();
+      mWaterMark = FrameAllocator::getWaterMark( mInstance );
+      mMemory = static_cast<T *>( FrameAllocator::alloc( mInstance, sizeof( T ) * count ) );
    }
 
    /// Destructor restores the watermark
    ~FrameTemp()
    {
-      FrameAllocator::setWaterMark( mWaterMark );
+      FrameAllocator::setWaterMark( mInstance, mWaterMark );
    }
 
    /// NOTE: This will return the memory, NOT perform a ones-complement
@@ -0,0 +1,169 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "core/frameStats.h"
+#include "platform/platformMutex.h"
+#include "console/console.h"
+
+FrameStats::Stat         FrameStats::smStats[FrameStats::MaxStats];
+U32                      FrameStats::smNumStats = 0;
+FrameStats::ThreadSlots *FrameStats::smSlotList = NULL;
+ThreadStorage            FrameStats::smThreadSlots;
+void                    *FrameStats::smMutex = Mutex::createMutex();
+U32                      FrameStats::smWindowStartMs = 0;
+
+//-----------------------------------------------------------------------------
+
+FrameStats::ThreadSlots *FrameStats::allocSlots()
+{
+   ThreadSlots *slots = new ThreadSlots;
+   dMemset(slots->mCount, 0, sizeof(slots->mCount));
+
+   MutexHandle m;
+   m.lock(smMutex);
+
+   slots->mNext = smSlotList;
+   smSlotList = slots;
+   smThreadSlots.set(slots);
+
+   return slots;
+}
+
+FrameStats::Stat *FrameStats::getStat(const char *name, Type type)
+{
+   MutexHandle m;
+   m.lock(smMutex);
+
+   for(U32 i = 0; i < smNumStats; i++)
+   {
+      if(!dStrcmp(smStats[i].mName, name))
+      {
+         AssertFatal(smStats[i].mType == type, avar("FrameStats::getStat - '%s' is used as both a counter and a gauge.", name));
+         return &smStats[i];
+      }
+   }
+
+   // Out of slots; lump the rest in with the last one so we keep going.
+   AssertFatal(smNumStats < MaxStats, avar("FrameStats::getStat - too many stats, can't add '%s'.", name));
+   if(smNumStats == MaxStats)
+      return &smStats[MaxStats - 1];
+
+   Stat &stat = smStats[smNumStats];
+   stat.mName        = name;
+   stat.mID          = smNumStats;
+   stat.mType        = type;
+   stat.mGauge       = 0;
+   stat.mTotal       = 0;
+   stat.mFrame       = 0;
+   stat.mRate        = 0;
+   stat.mWindowStart = 0;
+   smNumStats++;
+
+   return &stat;
+}
+
+FrameStats::Stat *FrameStats::findStat(const char *name)
+{
+   MutexHandle m;
+   m.lock(smMutex);
+
+   for(U32 i = 0; i < smNumStats; i++)
+      if(!dStricmp(smStats[i].mName, name))
+         return &smStats[i];
+
+   return NULL;
+}
+
+void FrameStats::endFrame()
+{
+   MutexHandle m;
+   m.lock(smMutex);
+
+   U32 now = Platform::getRealMilliseconds();
+   U32 elapsed = now - smWindowStartMs;
+   bool newWindow = elapsed >= RateWindow;
+
+   for(U32 i = 0; i < smNumStats; i++)
+   {
+      Stat &stat = smStats[i];
+      if(stat.mType == Gauge)
+      {
+         stat.mFrame = stat.mGauge;
+         continue;
+      }
+
+      // The other threads may be adding as we go, which only means some
+      // of their counts show up next frame. The unsigned totals wrap, but
+      // the differences don't care.
+      U32 total = 0;
+      for(ThreadSlots *walk = smSlotList; walk; walk = walk->mNext)
+         total += walk->mCount[stat.mID];
+
+      stat.mFrame = total - stat.mTotal;
+      stat.mTotal = total;
+
+      if(newWindow)
+      {
+         stat.mRate        = F32(stat.mTotal - stat.mWindowStart) * 1000.0f / F32(elapsed);
+         stat.mWindowStart = stat.mTotal;
+      }
+   }
+
+   if(newWindow)
+      smWindowStartMs = now;
+}
+
+void FrameStats::getLine(char *buffer, U32 size, bool rates)
+{
+   MutexHandle m;
+   m.lock(smMutex);
+
+   U32 len = 0;
+   buffer[0] = 0;
+   for(U32 i = 0; i < smNumStats; i++)
+   {
+      const Stat &stat = smStats[i];
+      S32 n;
+      if(rates && stat.mType == Counter)
+         n = dSprintf(buffer + len, size - len, "%s%s %.1f", len ? " " : "", stat.mName, stat.mRate);
+      else
+         n = dSprintf(buffer + len, size - len, "%s%s %d", len ? " " : "", stat.mName, stat.mFrame);
+
+      // Stop at the last stat that fits.
+      if(n < 0 || len + n >= size)
+      {
+         buffer[len] = 0;
+         break;
+      }
+      len += n;
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction(getFrameStat, S32, 2, 2, "(string name) - Returns the stat's count for the last frame, or the gauge's value.")
+{
+   FrameStats::Stat *stat = FrameStats::findStat(argv[1]);
+   return stat ? stat->mFrame : 0;
+}
+
+ConsoleFunction(getFrameStatRate, F32, 2, 2, "(string name) - Returns the counter's average per second, over the last second.")
+{
+   FrameStats::Stat *stat = FrameStats::findStat(argv[1]);
+   return stat ? stat->mRate : 0;
+}
+
+ConsoleFunction(dumpFrameStats, void, 1, 1, "() - Prints all the counters and gauges.")
+{
+   Con::printf("Stat                         Frame        Per Sec        Total");
+   for(U32 i = 0; i < FrameStats::getNumStats(); i++)
+   {
+      const FrameStats::Stat &stat = FrameStats::getStatByIndex(i);
+      if(stat.mType == FrameStats::Counter)
+         Con::printf("%-24s %9d %14.1f %12u", stat.mName, stat.mFrame, stat.mRate, stat.mTotal);
+      else
+         Con::printf("%-24s %9d        (gauge)", stat.mName, stat.mFrame);
+   }
+}
@@ -0,0 +1,128 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _FRAMESTATS_H_
+#define _FRAMESTATS_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _PLATFORMTHREAD_H_
+#include "platform/platformThread.h"
+#endif
+
+/// @name Frame Stats
+///
+/// Named counters and gauges, cheap enough to leave on in shipping
+/// builds.
+///
+/// @code
+/// STAT_INC(GhostsSent);            // counters add up over the frame
+/// STAT_ADD(BytesSent, size);
+/// STAT_SET(Connections, count);    // gauges keep their last value
+/// @endcode
+///
+/// Any number of places can use the same name, and counters can be hit
+/// from any thread: each thread adds to its own slots, which are summed
+/// up at the end of the frame. Scripts get at the results through
+/// getFrameStat() and dumpFrameStats(), GuiFrameStatsCtrl draws them, and
+/// telnetSetStatsInterval() sends them to the telnet console clients.
+///
+/// @{
+
+#define STAT_ADD(name, n) \
+   { static FrameStats::Stat *stat##name = FrameStats::getStat(#name, FrameStats::Counter); \
+     FrameStats::add(stat##name, n); }
+
+#define STAT_INC(name) STAT_ADD(name, 1)
+
+#define STAT_SET(name, v) \
+   { static FrameStats::Stat *stat##name = FrameStats::getStat(#name, FrameStats::Gauge); \
+     stat##name->mGauge = (v); }
+
+/// @}
+
+class FrameStats
+{
+public:
+   enum Constants
+   {
+      MaxStats   = 128,
+      RateWindow = 1000,   ///< ms over which the per second rates are measured.
+   };
+
+   enum Type
+   {
+      Counter,
+      Gauge
+   };
+
+   struct Stat
+   {
+      const char *mName;
+      U32  mID;            ///< Index of our slot in each thread's table.
+      Type mType;
+
+      /// Set directly by STAT_SET(), there being nothing to add up.
+      volatile S32 mGauge;
+
+      /// @name Results
+      /// Updated by endFrame().
+      /// @{
+      U32 mTotal;          ///< Counter total since startup.
+      U32 mFrame;          ///< Counter total for the last frame, or the gauge.
+      F32 mRate;           ///< Counter per second, over the last RateWindow.
+      /// @}
+
+      U32 mWindowStart;    ///< mTotal when the current rate window started.
+   };
+
+private:
+   /// One per thread that has counted anything, never freed, so the
+   /// counts of finished threads stay in the totals.
+   struct ThreadSlots
+   {
+      U32 mCount[MaxStats];
+      ThreadSlots *mNext;
+   };
+
+   static Stat smStats[MaxStats];
+   static U32 smNumStats;
+
+   static ThreadSlots *smSlotList;
+   static ThreadStorage smThreadSlots;
+   static void *smMutex;
+
+   static U32 smWindowStartMs;
+
+   static ThreadSlots *allocSlots();
+
+public:
+   /// Look up or register a stat. Returns the same one for every call
+   /// with a name; the macros call this once per use.
+   static Stat *getStat(const char *name, Type type);
+
+   /// Look up a stat without registering it, or NULL.
+   static Stat *findStat(const char *name);
+
+   static inline void add(Stat *stat, U32 n)
+   {
+      ThreadSlots *slots = (ThreadSlots*)smThreadSlots.get();
+      if(!slots)
+         slots = allocSlots();
+      slots->mCount[stat->mID] += n;
+   }
+
+   /// Sum up the threads' counts. Called once a frame by the main loop.
+   static void endFrame();
+
+   /// Write "name value ..." for all the stats into buffer.
+   static void getLine(char *buffer, U32 size, bool rates);
+
+   static U32 getNumStats() { return smNumStats; }
+   static const Stat &getStatByIndex(U32 i) { return smStats[i]; }
+};
+
+#endif
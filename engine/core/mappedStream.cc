@@ -0,0 +1,28 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "core/mappedStream.h"
+
+MappedStream::MappedStream(void* mapping, const void* data, U32 size)
+ : Parent(size, const_cast<void*>(data), true, false)
+{
+   mMapping = mapping;
+}
+
+MappedStream::~MappedStream()
+{
+   Platform::unmapFile(mMapping);
+   mMapping = NULL;
+}
+
+MappedStream* MappedStream::open(const char* fileName, U32 offset, U32 size)
+{
+   const void* data;
+   void* mapping = Platform::mapFile(fileName, offset, size, data);
+   if (!mapping)
+      return NULL;
+   return new MappedStream(mapping, data, size);
+}
@@ -0,0 +1,38 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _MAPPEDSTREAM_H_
+#define _MAPPEDSTREAM_H_
+
+//Includes
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _MEMSTREAM_H_
+#include "core/memstream.h"
+#endif
+
+/// Read only stream over a memory mapped view of a file.
+///
+/// Handed out by the ResManager for loose files and stored (uncompressed)
+/// zip entries so loaders can read, or with readDirect() parse in place,
+/// without copying the file through a FileStream buffer first.
+class MappedStream : public MemStream
+{
+   typedef MemStream Parent;
+
+   void* mMapping;
+
+   MappedStream(void* mapping, const void* data, U32 size);
+
+  public:
+   ~MappedStream();
+
+   /// Map size bytes of the file starting at offset, or the rest of the file
+   /// if size is 0.  Returns NULL if the platform can't map the file.
+   static MappedStream* open(const char* fileName, U32 offset = 0, U32 size = 0);
+};
+
+#endif //_MAPPEDSTREAM_H_
@@ -81,6 +81,19 @@ bool MemStream::setPosition(const U32 in_newPosition)
    return true;
 }
 
+const void* MemStream::readDirect(const U32 in_numBytes)
+{
+   AssertFatal(getStatus() != Closed, "Attempted read from a closed stream");
+
+   if (hasCapability(StreamRead) == false || (m_currentPosition + in_numBytes) > cm_bufferSize)
+      return NULL;
+
+   const void* pCurrent = (const void*)((const U8*)m_pBufferBase + m_currentPosition);
+   m_currentPosition += in_numBytes;
+   setStatus(Ok);
+   return pCurrent;
+}
+
 bool MemStream::_read(const U32 in_numBytes, void *out_pBuffer)
 {
    AssertFatal(getStatus() != Closed, "Attempted read from a closed stream");
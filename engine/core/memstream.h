@@ -40,6 +40,7 @@ class MemStream : public Stream {
    // Mandatory overrides from Stream
   public:
    U32  getStreamSize();
+   const void* readDirect(const U32 in_numBytes);
 };
 
 #endif //_MEMSTREAM_H_
@@ -4,6 +4,8 @@
 //-----------------------------------------------------------------------------
 
 #include "platform/platform.h"
+#include "platform/platformAtomic.h"
+#include "platform/platformMutex.h"
 #include "core/resManager.h"
 #include "core/tAlgorithm.h"
 
@@ -13,11 +15,11 @@
 ResDictionary::ResDictionary()
 {
    entryCount = 0;
-   hashTableSize = 1023; //DefaultTableSize;
-   hashTable = new ResourceObject *[hashTableSize];
-   S32 i;
-   for(i = 0; i < hashTableSize; i++)
-      hashTable[i] = NULL;
+   mUsed = 0;
+   mVersion = 0;
+   mReaders = 0;
+   mTable = newTable(DefaultTableSize);
+   mWriteMutex = Mutex::createMutex();
 }
 
 ResDictionary::~ResDictionary()
@@ -25,98 +27,225 @@ ResDictionary::~ResDictionary()
    // we assume the resources are purged before we destroy
    // the dictionary
 
-   delete[] hashTable;
+   for(S32 i = 0; i < mRetiredObjects.size(); i++)
+      delete mRetiredObjects[i];
+
+   Table *table = mTable;
+   mRetired.push_back(table);
+   for(S32 i = 0; i < mRetired.size(); i++)
+   {
+      delete [] mRetired[i]->slots;
+      delete mRetired[i];
+   }
+   Mutex::destroyMutex(mWriteMutex);
 }
 
-S32 ResDictionary::hash(StringTableEntry path, StringTableEntry file)
+U32 ResDictionary::hash(StringTableEntry path, StringTableEntry name)
 {
-   return ((S32)((((dsize_t)path) >> 2) + (((dsize_t)file) >> 2) )) % hashTableSize;
+   U32 h = U32(dsize_t(path) >> 2) * 0x9E3779B1 ^ U32(dsize_t(name) >> 2);
+   h ^= h >> 15;
+   h *= 0x85EBCA6B;
+   h ^= h >> 13;
+   return h;
+}
+
+ResDictionary::Table *ResDictionary::newTable(U32 size)
+{
+   Table *table = new Table;
+   table->size = size;
+   table->slots = new Slot[size];
+   dMemset(table->slots, 0, size * sizeof(Slot));
+   return table;
+}
+
+ResDictionary::Slot *ResDictionary::findSlot(Table *table, U32 h, StringTableEntry path, StringTableEntry name)
+{
+   U32 mask = table->size - 1;
+   for(U32 i = h & mask; ; i = (i + 1) & mask)
+   {
+      Slot *slot = &table->slots[i];
+      if(!slot->name)
+         return slot;
+      if(slot->hash == h && slot->name == name && slot->path == path)
+         return slot;
+   }
+}
+
+ResDictionary::Slot *ResDictionary::addSlot(StringTableEntry path, StringTableEntry name)
+{
+   U32 h = hash(path, name);
+   Slot *slot = findSlot(mTable, h, path, name);
+   if(slot->name)
+      return slot;
+
+   if((mUsed + 1) * 100 > mTable->size * MaxLoad)
+   {
+      rebuild();
+      slot = findSlot(mTable, h, path, name);
+   }
+   slot->hash = h;
+   slot->path = path;
+   slot->name = name;
+   slot->head = NULL;
+   mUsed++;
+   return slot;
+}
+
+void ResDictionary::rebuild()
+{
+   // Only the slots that still hold objects come along.  Sized so it's at
+   // most half of MaxLoad full after.
+   Table *old = mTable;
+   U32 live = 0;
+   for(U32 i = 0; i < old->size; i++)
+      if(old->slots[i].head)
+         live++;
+
+   U32 size = old->size;
+   while((live + 1) * 200 > size * MaxLoad)
+      size *= 2;
+
+   Table *table = newTable(size);
+   for(U32 i = 0; i < old->size; i++)
+   {
+      const Slot &from = old->slots[i];
+      if(from.head)
+         *findSlot(table, from.hash, from.path, from.name) = from;
+   }
+   mUsed = live;
+
+   // Finds still looking at the old table finish there, then see the
+   // version change and look again.
+   mRetired.push_back(old);
+   mTable = table;
 }
 
+void ResDictionary::beginWrite()
+{
+   Mutex::lockMutex(mWriteMutex);
+   dAtomicWrite(mVersion, mVersion + 1);
+   dMemoryBarrier();
+}
+
+void ResDictionary::endWrite()
+{
+   dAtomicWrite(mVersion, mVersion + 1);
+   Mutex::unlockMutex(mWriteMutex);
+}
+
+//----------------------------------------------------------------------------
+
 void ResDictionary::insert(ResourceObject *obj, StringTableEntry path, StringTableEntry file)
 {
+   beginWrite();
    obj->name = file;
    obj->path = path;
 
-   S32 idx = hash(path, file);
-   obj->nextEntry = hashTable[idx];
-   hashTable[idx] = obj;
+   Slot *slot = addSlot(path, file);
+   obj->nextEntry = slot->head;
+   slot->head = obj;
    entryCount++;
+   endWrite();
+}
+
+ResourceObject* ResDictionary::lookup(StringTableEntry path, StringTableEntry name, Match match,
+                                      StringTableEntry zipPath, StringTableEntry zipName, U32 flags)
+{
+   // Counted before anything is read, so retire() knows we may be holding
+   // an object it was given.
+   dFetchAndAdd(mReaders, 1);
+
+   U32 h = hash(path, name);
+   for(;;)
+   {
+      U32 version = dAtomicRead(mVersion);
+      if(version & 1)
+         continue;
 
-   if(entryCount > hashTableSize) {
-      ResourceObject *head = NULL, *temp, *walk;
-      for(idx = 0; idx < hashTableSize;idx++) {
-         walk = hashTable[idx];
-         while(walk)
-         {
-            temp = walk->nextEntry;
-            walk->nextEntry = head;
-            head = walk;
-            walk = temp;
-         }
+      ResourceObject *ret = NULL;
+      for(ResourceObject *walk = findSlot(mTable, h, path, name)->head; walk; walk = walk->nextEntry)
+      {
+         if(match == MatchZip && (walk->zipName != zipName || walk->zipPath != zipPath))
+            continue;
+         if(match == MatchFlags && U32(walk->flags) != flags)
+            continue;
+         ret = walk;
+         break;
       }
-      delete[] hashTable;
-      hashTableSize = 2 * hashTableSize - 1;
-      hashTable = new ResourceObject *[hashTableSize];
-      for(idx = 0; idx < hashTableSize; idx++)
-         hashTable[idx] = NULL;
-      walk = head;
-      while(walk)
+
+      dMemoryBarrier();
+      if(dAtomicRead(mVersion) == version)
       {
-         temp = walk->nextEntry;
-         idx = hash(walk);
-         walk->nextEntry = hashTable[idx];
-         hashTable[idx] = walk;
-         walk = temp;
+         dFetchAndAdd(mReaders, U32(-1));
+         return ret;
       }
    }
 }
 
+void ResDictionary::retire(ResourceObject *obj)
+{
+   Mutex::lockMutex(mWriteMutex);
+   mRetiredObjects.push_back(obj);
+
+   // Finds that start from here on can't reach anything on the list, it's
+   // all been removed.  If none are running now, none hold any of it.
+   dMemoryBarrier();
+   if(dAtomicRead(mReaders) == 0)
+   {
+      for(S32 i = 0; i < mRetiredObjects.size(); i++)
+         delete mRetiredObjects[i];
+      mRetiredObjects.clear();
+   }
+   Mutex::unlockMutex(mWriteMutex);
+}
+
 ResourceObject* ResDictionary::find(StringTableEntry path, StringTableEntry name)
 {
-   for(ResourceObject *walk = hashTable[hash(path, name)]; walk; walk = walk->nextEntry)
-      if(walk->name == name && walk->path == path)
-         return walk;
-   return NULL;
+   return lookup(path, name, MatchName, NULL, NULL, 0);
 }
 
 ResourceObject* ResDictionary::find(StringTableEntry path, StringTableEntry name, StringTableEntry zipPath, StringTableEntry zipName)
 {
-   for(ResourceObject *walk = hashTable[hash(path, name)]; walk; walk = walk->nextEntry)
-      if(walk->name == name && walk->path == path && walk->zipName == zipName && walk->zipPath == zipPath)
-         return walk;
-   return NULL;
+   return lookup(path, name, MatchZip, zipPath, zipName, 0);
 }
 
 ResourceObject* ResDictionary::find(StringTableEntry path, StringTableEntry name, U32 flags)
 {
-   for(ResourceObject *walk = hashTable[hash(path, name)]; walk; walk = walk->nextEntry)
-      if(walk->name == name && walk->path == path && U32(walk->flags) == flags)
-         return walk;
-   return NULL;
+   return lookup(path, name, MatchFlags, NULL, NULL, flags);
 }
 
 void ResDictionary::pushBehind(ResourceObject *resObj, S32 flagMask)
 {
-   remove(resObj);
+   beginWrite();
+   unlink(resObj);
    entryCount++;
-   ResourceObject **walk = &hashTable[hash(resObj)];
+   ResourceObject **walk = &addSlot(resObj->path, resObj->name)->head;
    for(; *walk; walk = &(*walk)->nextEntry)
    {
       if(!((*walk)->flags & flagMask))
       {
          resObj->nextEntry = *walk;
          *walk = resObj;
+         endWrite();
          return;
       }
    }
    resObj->nextEntry = NULL;
    *walk = resObj;
+   endWrite();
 }
 
 void ResDictionary::remove(ResourceObject *resObj)
 {
-   for(ResourceObject **walk = &hashTable[hash(resObj)]; *walk; walk = &(*walk)->nextEntry)
+   beginWrite();
+   unlink(resObj);
+   endWrite();
+}
+
+void ResDictionary::unlink(ResourceObject *resObj)
+{
+   Slot *slot = findSlot(mTable, hash(resObj->path, resObj->name), resObj->path, resObj->name);
+   for(ResourceObject **walk = &slot->head; *walk; walk = &(*walk)->nextEntry)
    {
       if(*walk == resObj)
       {
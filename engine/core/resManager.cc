@@ -4,6 +4,9 @@
 //-----------------------------------------------------------------------------
 
 #include "platform/platform.h"
+#include "platform/platformThread.h"
+#include "platform/platformMutex.h"
+#include "platform/platformSemaphore.h"
 #include "core/tVector.h"
 #include "core/stream.h"
 
@@ -12,6 +15,7 @@
 #include "core/zipAggregate.h"
 #include "core/zipHeaders.h"
 #include "core/resizeStream.h"
+#include "core/mappedStream.h"
 #include "core/frameAllocator.h"
 
 #include "core/resManager.h"
@@ -25,6 +29,9 @@
 ResManager *ResourceManager = NULL;
 
 char *ResManager::smExcludedDirectories = ".svn;CVS";
+S32 ResManager::smMapFileThreshold = 64 * 1024;
+char *ResManager::smIndexCacheFile = "resIndex.cache";
+S32 ResManager::smMemoryBudget = 0;
 
 //------------------------------------------------------------------------------
 ResourceObject::ResourceObject ()
@@ -33,10 +40,15 @@ ResourceObject::ResourceObject ()
   prev = NULL;
   lockCount = 0;
   mInstance = NULL;
+  mInstanceSize = 0;
+  mAccessMark = 0;
 }
 
 void ResourceObject::destruct ()
 {
+   if (mInstance && ResourceManager)
+      ResourceManager->untrackInstance (this);
+
    // If the resource was not loaded because of an error, the resource
    // pointer will be NULL
    SAFE_DELETE(mInstance);
@@ -60,6 +72,21 @@ ResManager::ResManager ()
    timeoutList.prev = NULL;
    registeredList = NULL;
    mLoggingMissingFiles = false;
+   mLoggingAccess = false;
+   mAccessLogSerial = 0;
+
+   mAsyncQueueHead = 0;
+   mAsyncMutex = Mutex::createMutex();
+   mAsyncSemaphore = Semaphore::createSemaphore(0);
+   mAsyncThread = NULL;
+   mAsyncShuttingDown = false;
+
+   mIndexLoaded = false;
+   mIndexDirty = false;
+
+   mLoadedBytes = 0;
+   mLoadedCount = 0;
+   mEvictedCount = 0;
 }
 
 void ResManager::fileIsMissing(const char *fileName)
@@ -126,6 +153,22 @@ void ResourceObject::getFileTimes (FileTime * createTime, FileTime * modifyTime)
 
 ResManager::~ResManager ()
 {
+   // Anything still in flight gets finished without callbacks so the
+   // instances and locks are cleaned up with everything else.
+   stopAsyncLoader();
+   while (mAsyncLoads.size())
+   {
+      AsyncLoad *load = mAsyncLoads.last();
+      waitForAsyncLoad(load);
+      finishAsyncLoad(load, false);
+   }
+   Semaphore::destroySemaphore(mAsyncSemaphore);
+   Mutex::destroyMutex(mAsyncMutex);
+
+   // CRCs taken since setModPaths() are only written out here.
+   saveIndexCache();
+   clearIndexCache();
+
    purge ();
    // volume list should be gone.
 
@@ -147,27 +190,81 @@ ResManager::~ResManager ()
    }
 }
 
-#ifdef TORQUE_DEBUG
 void ResManager::dumpLoadedResources ()
 {
+   S32 unlockedBytes = 0, unlockedCount = 0;
    ResourceObject *walk = resourceList.nextResource;
    while (walk != NULL)
    {
       if (walk->mInstance != NULL)
       {
-         Con::errorf ("LoadedRes: %s/%s (%d)", walk->path, walk->name,
-             walk->lockCount);
+         Con::errorf ("LoadedRes: %s/%s (%d) %d bytes", walk->path, walk->name,
+             walk->lockCount, walk->mInstanceSize);
+         if (!walk->lockCount)
+         {
+            unlockedBytes += walk->mInstanceSize;
+            unlockedCount++;
+         }
       }
       walk = walk->nextResource;
    }
+
+   Con::printf ("Resources: %d loaded, %d bytes (%d unlocked, %d bytes)",
+      mLoadedCount, mLoadedBytes, unlockedCount, unlockedBytes);
+   if (smMemoryBudget > 0)
+      Con::printf ("Resources: budget %d bytes, %d evicted", smMemoryBudget, mEvictedCount);
+   else
+      Con::printf ("Resources: no budget, %d evicted", mEvictedCount);
 }
 
-ConsoleFunction(dumpResourceStats, void, 1, 1, "Dump information about resources. Debug only!")
+ConsoleFunction(dumpResourceStats, void, 1, 1, "Dump information about loaded resources and the memory budget.")
 {
    ResourceManager->dumpLoadedResources();
 }
 
-#endif
+//------------------------------------------------------------------------------
+
+void ResManager::trackInstance (ResourceObject * obj)
+{
+   AssertFatal (obj->mInstance, "ResManager::trackInstance: no instance.");
+
+   U32 size = obj->mInstance->getResourceSize ();
+   obj->mInstanceSize = size ? size : obj->fileSize;
+   mLoadedBytes += obj->mInstanceSize;
+   mLoadedCount++;
+
+   enforceMemoryBudget ();
+}
+
+void ResManager::untrackInstance (ResourceObject * obj)
+{
+   mLoadedBytes -= obj->mInstanceSize;
+   mLoadedCount--;
+   obj->mInstanceSize = 0;
+}
+
+void ResManager::enforceMemoryBudget ()
+{
+   if (smMemoryBudget <= 0 || mLoadedBytes <= smMemoryBudget)
+      return;
+
+   ResourceObject *obj = &timeoutList;
+   while (obj->next)
+      obj = obj->next;
+
+   // Walk back from the least recently released.
+   while (obj != &timeoutList && mLoadedBytes > smMemoryBudget)
+   {
+      ResourceObject *temp = obj;
+      obj = obj->prev;
+      temp->unlink ();
+      if (temp->mInstance)
+         mEvictedCount++;
+      temp->destruct ();
+      if (temp->flags & ResourceObject::Added)
+         freeResource (temp);
+   }
+}
 
 //------------------------------------------------------------------------------
 
@@ -178,6 +275,11 @@ void ResManager::create ()
    ResourceManager = new ResManager;
 
    Con::addVariable("Pref::ResourceManager::excludedDirectories", TypeString, &smExcludedDirectories);
+   Con::addVariable("Pref::ResourceManager::mapFileThreshold", TypeS32, &smMapFileThreshold);
+   Con::addVariable("Pref::ResourceManager::indexCacheFile", TypeString, &smIndexCacheFile);
+   Con::addVariable("Pref::ResourceManager::memoryBudget", TypeS32, &smMemoryBudget);
+   Con::addVariable("Stats::resourceBytes", TypeS32, &ResourceManager->mLoadedBytes);
+   Con::addVariable("Stats::resourceEvictions", TypeS32, &ResourceManager->mEvictedCount);
 }
 
 
@@ -198,6 +300,7 @@ void ResManager::setFileNameEcho (bool on)
    echoFileNames = on;
 }
 
+
 //------------------------------------------------------------------------------
 
 bool ResManager::isValidWriteFileName (const char *fn)
@@ -257,6 +360,30 @@ static const char * buildPath (StringTableEntry path, StringTableEntry file)
 
 //------------------------------------------------------------------------------
 
+void ResManager::startAccessLog ()
+{
+   mAccessLog.clear ();
+   mAccessLogSerial++;
+   mLoggingAccess = true;
+}
+
+void ResManager::stopAccessLog (Vector<StringTableEntry> &list)
+{
+   mLoggingAccess = false;
+   list = mAccessLog;
+   mAccessLog.clear ();
+}
+
+void ResManager::noteAccess (ResourceObject *obj)
+{
+   if (!mLoggingAccess || obj->mAccessMark == mAccessLogSerial || !Thread::isMainThread ())
+      return;
+   obj->mAccessMark = mAccessLogSerial;
+   mAccessLog.push_back (StringTable->insert (buildPath (obj->path, obj->name)));
+}
+
+//------------------------------------------------------------------------------
+
 static void getPaths (const char *fullPath, StringTableEntry & path,
    StringTableEntry & fileName)
 {
@@ -281,6 +408,47 @@ static void getPaths (const char *fullPath, StringTableEntry & path,
 
 bool ResManager::scanZip (ResourceObject * zipObject)
 {
+   // Replay the contents from the index if the zip hasn't changed.
+   IndexZip *cached = NULL;
+   FileTime modifyTime;
+   if (mIndexLoaded)
+   {
+      if (!Platform::getFileTimes (buildPath (zipObject->zipPath, zipObject->zipName), NULL, &modifyTime))
+         dMemset (&modifyTime, 0, sizeof (modifyTime));
+
+      cached = findIndexZip (zipObject->zipPath, zipObject->zipName);
+      if (cached && cached->size == zipObject->fileSize &&
+            !Platform::compareFileTimes (cached->modifyTime, modifyTime))
+      {
+         for (U32 i = 0; i < cached->entries.size (); i++)
+         {
+            const IndexZipEntry &entry = cached->entries[i];
+            ResourceObject *ro = createZipResource (entry.path, entry.name,
+               zipObject->zipPath, zipObject->zipName);
+
+            ro->flags = ResourceObject::VolumeBlock;
+            ro->fileSize = entry.fileSize;
+            ro->compressedFileSize = entry.compressedFileSize;
+            ro->fileOffset = entry.fileOffset;
+
+            dictionary.pushBehind (ro, ResourceObject::File);
+         }
+         return true;
+      }
+
+      if (!cached)
+      {
+         cached = new IndexZip;
+         cached->path = zipObject->zipPath;
+         cached->name = zipObject->zipName;
+         mIndexZips.push_back (cached);
+      }
+      cached->size = zipObject->fileSize;
+      cached->modifyTime = modifyTime;
+      cached->entries.clear ();
+      mIndexDirty = true;
+   }
+
   // now open the volume and add all its resources to the dictionary
    ZipAggregate zipAggregate;
    if (zipAggregate.
@@ -306,6 +474,17 @@ bool ResManager::scanZip (ResourceObject * zipObject)
       ro->fileOffset = rEntry.fileOffset;
 
       dictionary.pushBehind (ro, ResourceObject::File);
+
+      if (cached)
+      {
+         cached->entries.increment ();
+         IndexZipEntry &entry = cached->entries.last ();
+         entry.path = ro->path;
+         entry.name = ro->name;
+         entry.fileSize = ro->fileSize;
+         entry.compressedFileSize = ro->compressedFileSize;
+         entry.fileOffset = ro->fileOffset;
+      }
    }
    zipAggregate.closeAggregate ();
 
@@ -314,37 +493,458 @@ bool ResManager::scanZip (ResourceObject * zipObject)
 
 //------------------------------------------------------------------------------
 
+void ResManager::addDiskResource (StringTableEntry path, StringTableEntry file, U32 size)
+{
+   // Create a resource for this file...
+   //
+   ResourceObject *ro = createResource (path, file);
+   dictionary.pushBehind (ro, ResourceObject::File);
+
+   ro->flags = ResourceObject::File;
+   ro->fileOffset = 0;
+   ro->fileSize = size;
+   ro->compressedFileSize = size;
+
+   // see if it's a zip
+   const char *extension = dStrrchr (ro->name, '.');
+   if (extension && !dStricmp (extension, ".zip"))
+   {
+      // Copy the path and files names to the zips resource object
+      ro->zipName = file;
+      ro->zipPath = path;
+      scanZip(ro);
+   }
+}
+
+static bool isIndexSubPath (const char *path, const char *dir, U32 dirLen)
+{
+   return !dStrnicmp (path, dir, dirLen) && (path[dirLen] == 0 || path[dirLen] == '/');
+}
+
 void ResManager::searchPath (const char *path)
 {
    AssertFatal (path != NULL, "No path to dump?");
 
-   Vector < Platform::FileInfo > fileInfoVec;
-   Platform::dumpPath (path, fileInfoVec);
+   if (!mIndexLoaded)
+   {
+      Vector < Platform::FileInfo > fileInfoVec;
+      Platform::dumpPath (path, fileInfoVec);
 
+      for (U32 i = 0; i < fileInfoVec.size (); i++)
+      {
+         Platform::FileInfo & rInfo = fileInfoVec[i];
+         addDiskResource (rInfo.pFullPath, rInfo.pFileName, rInfo.fileSize);
+      }
+      return;
+   }
+
+   StringTableEntry rootPath = StringTable->insert (path);
+   IndexRoot *root = findIndexRoot (rootPath);
+   if (!root)
+   {
+      root = new IndexRoot;
+      root->path = rootPath;
+      mIndexRoots.push_back (root);
+      rescanIndexDir (root, rootPath);
+   }
+   else
+   {
+      // Any directory that was added to, removed from or renamed has a new
+      // modify time; rescan the subtree under each one that did.
+      Vector<StringTableEntry> changed;
+      for (U32 i = 0; i < root->dirs.size (); i++)
+      {
+         FileTime modifyTime;
+         if (!Platform::getFileTimes (root->dirs[i].path, NULL, &modifyTime) ||
+               Platform::compareFileTimes (root->dirs[i].modifyTime, modifyTime))
+            changed.push_back (root->dirs[i].path);
+      }
+
+      // Directories come parent first, and a rescanned parent covers
+      // everything below it.
+      Vector<StringTableEntry> rescanned;
+      for (U32 i = 0; i < changed.size (); i++)
+      {
+         bool covered = false;
+         for (U32 j = 0; j < rescanned.size () && !covered; j++)
+            covered = isIndexSubPath (changed[i], rescanned[j], dStrlen (rescanned[j]));
+         if (covered)
+            continue;
+
+         rescanIndexDir (root, changed[i]);
+         rescanned.push_back (changed[i]);
+      }
+   }
+
+   for (U32 i = 0; i < root->files.size (); i++)
+   {
+      const IndexFile &file = root->files[i];
+      addDiskResource (file.path, file.name, file.size);
+   }
+}
+
+//------------------------------------------------------------------------------
+
+ResManager::IndexRoot * ResManager::findIndexRoot (StringTableEntry path)
+{
+   for (U32 i = 0; i < mIndexRoots.size (); i++)
+      if (mIndexRoots[i]->path == path)
+         return mIndexRoots[i];
+   return NULL;
+}
+
+ResManager::IndexZip * ResManager::findIndexZip (StringTableEntry path, StringTableEntry name)
+{
+   for (U32 i = 0; i < mIndexZips.size (); i++)
+      if (mIndexZips[i]->path == path && mIndexZips[i]->name == name)
+         return mIndexZips[i];
+   return NULL;
+}
+
+void ResManager::rescanIndexDir (IndexRoot * root, const char *dir)
+{
+   // Copy it, dir may be one of the entries about to be dropped.
+   char dirBuf[1024];
+   dStrncpy (dirBuf, dir, sizeof (dirBuf) - 1);
+   dirBuf[sizeof (dirBuf) - 1] = 0;
+   U32 dirLen = dStrlen (dirBuf);
+
+   for (S32 i = root->dirs.size () - 1; i >= 0; i--)
+      if (isIndexSubPath (root->dirs[i].path, dirBuf, dirLen))
+         root->dirs.erase (i);
+   for (S32 i = root->files.size () - 1; i >= 0; i--)
+      if (isIndexSubPath (root->files[i].path, dirBuf, dirLen))
+         root->files.erase (i);
+
+   Vector<StringTableEntry> dirs;
+   Platform::dumpDirectories (dirBuf, dirs, -1, false);
+
+   // dumpDirectories resets the exclusion list when it's done.
+   initExcludedDirectories ();
+
+   for (U32 i = 0; i < dirs.size (); i++)
+   {
+      root->dirs.increment ();
+      IndexDir &entry = root->dirs.last ();
+      entry.path = dirs[i];
+      if (!Platform::getFileTimes (dirs[i], NULL, &entry.modifyTime))
+         dMemset (&entry.modifyTime, 0, sizeof (entry.modifyTime));
+   }
+
+   Vector < Platform::FileInfo > fileInfoVec;
+   Platform::dumpPath (dirBuf, fileInfoVec);
    for (U32 i = 0; i < fileInfoVec.size (); i++)
    {
-      Platform::FileInfo & rInfo = fileInfoVec[i];
+      root->files.increment ();
+      IndexFile &entry = root->files.last ();
+      entry.path = fileInfoVec[i].pFullPath;
+      entry.name = fileInfoVec[i].pFileName;
+      entry.size = fileInfoVec[i].fileSize;
+   }
 
-      // Create a resource for this file...
-      //
-      ResourceObject *ro = createResource (rInfo.pFullPath, rInfo.pFileName);
-      dictionary.pushBehind (ro, ResourceObject::File);
+   mIndexDirty = true;
+}
+
+//------------------------------------------------------------------------------
+
+static const U32 csmIndexCacheVersion = 2;
+static const U32 csmIndexMaxString = 1023;
+
+// Every read of the index goes through these, which fail on anything short
+// of the whole value with the stream still Ok, so a truncated index, even
+// one that stops cleanly at EOS, is never taken as valid.
+static bool readIndex (Stream & stream, U32 size, void *data)
+{
+   return stream.read (size, data) && stream.getStatus () == Stream::Ok;
+}
+
+template <class T> static inline bool readIndex (Stream & stream, T *value)
+{
+   return readIndex (stream, sizeof (T), value);
+}
+
+static bool readIndexString (Stream & stream, StringTableEntry *string)
+{
+   char buf[csmIndexMaxString + 1];
+   U32 len;
+   if (!readIndex (stream, &len) || len > csmIndexMaxString || !readIndex (stream, len, buf))
+      return false;
+   buf[len] = 0;
+   *string = buf[0] ? StringTable->insert (buf) : NULL;
+   return true;
+}
+
+/// A count of elements that each take at least minSize bytes; one the rest
+/// of the file couldn't hold is garbage and mustn't size a Vector.
+static bool readIndexCount (Stream & stream, U32 minSize, U32 *count)
+{
+   if (!readIndex (stream, count))
+      return false;
+   return *count <= (stream.getStreamSize () - stream.getPosition ()) / minSize;
+}
+
+static void writeIndexString (Stream & stream, StringTableEntry string)
+{
+   stream.writeLongString (csmIndexMaxString, string ? string : "");
+}
+
+static S32 QSORT_CALLBACK compareIndexCrcs (const void *a, const void *b)
+{
+   // path is the first member of an IndexCrc
+   StringTableEntry pa = *(const StringTableEntry *) a;
+   StringTableEntry pb = *(const StringTableEntry *) b;
+   return pa < pb ? -1 : (pa > pb ? 1 : 0);
+}
+
+void ResManager::loadIndexCache ()
+{
+   mIndexLoaded = smIndexCacheFile && smIndexCacheFile[0];
+   if (!mIndexLoaded)
+      return;
+
+   FileStream stream;
+   if (!Platform::getFileTimes (smIndexCacheFile, NULL, NULL) || !stream.open (smIndexCacheFile, FileStream::Read))
+      return;
+
+   U32 version;
+   if (!readIndex (stream, &version) || version != csmIndexCacheVersion)
+      return;
+
+   // A truncated or garbled index is no better than none.
+   if (!readIndexCache (stream))
+   {
+      Con::warnf ("ResManager: ignoring bad resource index '%s'.", smIndexCacheFile);
+      clearIndexCache ();
+      mIndexLoaded = true;
+      return;
+   }
 
-      ro->flags = ResourceObject::File;
-      ro->fileOffset = 0;
-      ro->fileSize = rInfo.fileSize;
-      ro->compressedFileSize = rInfo.fileSize;
+   // The order is by string table address, which changes between runs.
+   dQsort (mIndexCrcs.address (), mIndexCrcs.size (), sizeof (IndexCrc), compareIndexCrcs);
+}
+
+bool ResManager::readIndexCache (Stream & stream)
+{
+   const U32 stringSize = sizeof (U32);
+
+   U32 count;
+   if (!readIndexCount (stream, stringSize + 2 * sizeof (U32), &count))
+      return false;
+   for (U32 i = 0; i < count; i++)
+   {
+      IndexRoot *root = new IndexRoot;
+      mIndexRoots.push_back (root);
+
+      U32 num;
+      if (!readIndexString (stream, &root->path) ||
+          !readIndexCount (stream, stringSize + sizeof (FileTime), &num))
+         return false;
+      root->dirs.setSize (num);
+      for (U32 j = 0; j < num; j++)
+         if (!readIndexString (stream, &root->dirs[j].path) ||
+             !readIndex (stream, &root->dirs[j].modifyTime))
+            return false;
+
+      if (!readIndexCount (stream, 2 * stringSize + sizeof (U32), &num))
+         return false;
+      root->files.setSize (num);
+      for (U32 j = 0; j < num; j++)
+         if (!readIndexString (stream, &root->files[j].path) ||
+             !readIndexString (stream, &root->files[j].name) ||
+             !readIndex (stream, &root->files[j].size))
+            return false;
+   }
+
+   if (!readIndexCount (stream, 2 * stringSize + sizeof (U32) + sizeof (FileTime) + sizeof (U32), &count))
+      return false;
+   for (U32 i = 0; i < count; i++)
+   {
+      IndexZip *zip = new IndexZip;
+      mIndexZips.push_back (zip);
+
+      U32 num;
+      if (!readIndexString (stream, &zip->path) ||
+          !readIndexString (stream, &zip->name) ||
+          !readIndex (stream, &zip->size) ||
+          !readIndex (stream, &zip->modifyTime) ||
+          !readIndexCount (stream, 2 * stringSize + 3 * sizeof (S32), &num))
+         return false;
+      zip->entries.setSize (num);
+      for (U32 j = 0; j < num; j++)
+      {
+         IndexZipEntry &entry = zip->entries[j];
+         if (!readIndexString (stream, &entry.path) ||
+             !readIndexString (stream, &entry.name) ||
+             !readIndex (stream, &entry.fileSize) ||
+             !readIndex (stream, &entry.compressedFileSize) ||
+             !readIndex (stream, &entry.fileOffset))
+            return false;
+      }
+   }
+
+   if (!readIndexCount (stream, stringSize + sizeof (U32) + sizeof (FileTime) + sizeof (U32), &count))
+      return false;
+   mIndexCrcs.setSize (count);
+   for (U32 i = 0; i < count; i++)
+   {
+      IndexCrc &entry = mIndexCrcs[i];
+      if (!readIndexString (stream, &entry.path) ||
+          !readIndex (stream, &entry.size) ||
+          !readIndex (stream, &entry.modifyTime) ||
+          !readIndex (stream, &entry.crc))
+         return false;
+   }
+   return true;
+}
+
+void ResManager::saveIndexCache ()
+{
+   if (!mIndexLoaded || !mIndexDirty)
+      return;
+
+   mIndexDirty = false;
 
-      // see if it's a zip
-      const char *extension = dStrrchr (ro->name, '.');
-      if (extension && !dStricmp (extension, ".zip"))
+   FileStream stream;
+   if (!stream.open (smIndexCacheFile, FileStream::Write))
+      return;
+
+   stream.write (csmIndexCacheVersion);
+
+   stream.write (U32 (mIndexRoots.size ()));
+   for (U32 i = 0; i < mIndexRoots.size (); i++)
+   {
+      IndexRoot *root = mIndexRoots[i];
+      writeIndexString (stream, root->path);
+
+      stream.write (U32 (root->dirs.size ()));
+      for (U32 j = 0; j < root->dirs.size (); j++)
       {
-         // Copy the path and files names to the zips resource object
-         ro->zipName = rInfo.pFileName;
-         ro->zipPath = rInfo.pFullPath;
-         scanZip(ro);
+         writeIndexString (stream, root->dirs[j].path);
+         stream.write (sizeof (FileTime), &root->dirs[j].modifyTime);
       }
+
+      stream.write (U32 (root->files.size ()));
+      for (U32 j = 0; j < root->files.size (); j++)
+      {
+         writeIndexString (stream, root->files[j].path);
+         writeIndexString (stream, root->files[j].name);
+         stream.write (root->files[j].size);
+      }
+   }
+
+   stream.write (U32 (mIndexZips.size ()));
+   for (U32 i = 0; i < mIndexZips.size (); i++)
+   {
+      IndexZip *zip = mIndexZips[i];
+      writeIndexString (stream, zip->path);
+      writeIndexString (stream, zip->name);
+      stream.write (zip->size);
+      stream.write (sizeof (FileTime), &zip->modifyTime);
+
+      stream.write (U32 (zip->entries.size ()));
+      for (U32 j = 0; j < zip->entries.size (); j++)
+      {
+         const IndexZipEntry &entry = zip->entries[j];
+         writeIndexString (stream, entry.path);
+         writeIndexString (stream, entry.name);
+         stream.write (entry.fileSize);
+         stream.write (entry.compressedFileSize);
+         stream.write (entry.fileOffset);
+      }
+   }
+
+   stream.write (U32 (mIndexCrcs.size ()));
+   for (U32 i = 0; i < mIndexCrcs.size (); i++)
+   {
+      const IndexCrc &entry = mIndexCrcs[i];
+      writeIndexString (stream, entry.path);
+      stream.write (entry.size);
+      stream.write (sizeof (FileTime), &entry.modifyTime);
+      stream.write (entry.crc);
+   }
+}
+
+void ResManager::clearIndexCache ()
+{
+   for (U32 i = 0; i < mIndexRoots.size (); i++)
+      delete mIndexRoots[i];
+   mIndexRoots.clear ();
+
+   for (U32 i = 0; i < mIndexZips.size (); i++)
+      delete mIndexZips[i];
+   mIndexZips.clear ();
+   mIndexCrcs.clear ();
+
+   mIndexLoaded = false;
+   mIndexDirty = false;
+}
+
+//------------------------------------------------------------------------------
+
+S32 ResManager::findIndexCrc (StringTableEntry path)
+{
+   S32 lo = 0, hi = mIndexCrcs.size ();
+   while (lo < hi)
+   {
+      S32 mid = (lo + hi) >> 1;
+      if (mIndexCrcs[mid].path < path)
+         lo = mid + 1;
+      else
+         hi = mid;
    }
+   return lo;
+}
+
+static bool getCrcFileTime (ResourceObject * obj, FileTime & modifyTime)
+{
+   // A zip entry changes only with its zip.
+   if (obj->flags & ResourceObject::VolumeBlock)
+      return Platform::getFileTimes (buildPath (obj->zipPath, obj->zipName), NULL, &modifyTime);
+   return Platform::getFileTimes (buildPath (obj->path, obj->name), NULL, &modifyTime);
+}
+
+bool ResManager::getCachedCrc (ResourceObject * obj, U32 & crc)
+{
+   if (!mIndexLoaded || !Thread::isMainThread ())
+      return false;
+
+   StringTableEntry path = StringTable->insert (buildPath (obj->path, obj->name));
+   S32 i = findIndexCrc (path);
+   if (i == mIndexCrcs.size () || mIndexCrcs[i].path != path)
+      return false;
+
+   FileTime modifyTime;
+   const IndexCrc &entry = mIndexCrcs[i];
+   if (entry.size != obj->fileSize || !getCrcFileTime (obj, modifyTime) ||
+         Platform::compareFileTimes (entry.modifyTime, modifyTime))
+      return false;
+
+   crc = entry.crc;
+   return true;
+}
+
+void ResManager::setCachedCrc (ResourceObject * obj, U32 crc)
+{
+   if (!mIndexLoaded || !Thread::isMainThread ())
+      return;
+
+   FileTime modifyTime;
+   if (!getCrcFileTime (obj, modifyTime))
+      return;
+
+   StringTableEntry path = StringTable->insert (buildPath (obj->path, obj->name));
+   S32 i = findIndexCrc (path);
+   if (i == mIndexCrcs.size () || mIndexCrcs[i].path != path)
+   {
+      mIndexCrcs.insert (i);
+      mIndexCrcs[i].path = path;
+   }
+
+   IndexCrc &entry = mIndexCrcs[i];
+   entry.size = obj->fileSize;
+   entry.modifyTime = modifyTime;
+   entry.crc = crc;
+   mIndexDirty = true;
 }
 
 
@@ -445,6 +1045,9 @@ void ResManager::setModPaths (U32 numPaths, const char **paths)
    // Set up exclusions.
    initExcludedDirectories();
 
+   if (!mIndexLoaded)
+      loadIndexCache();
+
    // Make sure invalid paths are not processed
    Vector<const char*> validPaths;
 
@@ -469,6 +1072,8 @@ void ResManager::setModPaths (U32 numPaths, const char **paths)
       validPaths.push_back(paths[i]);
    }
 
+   saveIndexCache();
+
    Platform::clearExcludedDirectories();
 
    if (!pathLen)
@@ -619,9 +1224,19 @@ const char *ResManager::getBasePath ()
 
 //------------------------------------------------------------------------------
 
-void ResManager::registerExtension (const char *name, RESOURCE_CREATE_FN create_fn)
+void ResManager::registerExtension (const char *name, RESOURCE_CREATE_FN create_fn, bool concurrent)
 {
-   AssertFatal (!getCreateFunction (name),
+   addExtension (name, create_fn, NULL, concurrent);
+}
+
+void ResManager::registerExtension (const char *name, RESOURCE_CREATE_FILE_FN create_fn, bool concurrent)
+{
+   addExtension (name, NULL, create_fn, concurrent);
+}
+
+void ResManager::addExtension (const char *name, RESOURCE_CREATE_FN create_fn, RESOURCE_CREATE_FILE_FN create_file_fn, bool concurrent)
+{
+   AssertFatal (!findExtension (name),
            "ResourceManager::registerExtension: file extension already registered.");
 
    const char *extension = dStrrchr (name, '.');
@@ -631,13 +1246,15 @@ void ResManager::registerExtension (const char *name, RESOURCE_CREATE_FN create_
    RegisteredExtension *add = new RegisteredExtension;
    add->mExtension = StringTable->insert (extension);
    add->mCreateFn = create_fn;
+   add->mCreateFileFn = create_file_fn;
+   add->mConcurrent = concurrent;
    add->next = registeredList;
    registeredList = add;
 }
 
 //------------------------------------------------------------------------------
 
-RESOURCE_CREATE_FN ResManager::getCreateFunction (const char *name)
+ResManager::RegisteredExtension * ResManager::findExtension (const char *name)
 {
    const char * s = dStrrchr (name, '.');
    if (!s)
@@ -647,12 +1264,18 @@ RESOURCE_CREATE_FN ResManager::getCreateFunction (const char *name)
    while (itr)
    {
       if (dStricmp (s, itr->mExtension) == 0)
-         return (itr->mCreateFn);
+         return (itr);
       itr = itr->next;
    }
    return (NULL);
 }
 
+RESOURCE_CREATE_FN ResManager::getCreateFunction (const char *name)
+{
+   RegisteredExtension * ext = findExtension (name);
+   return ext ? ext->mCreateFn : NULL;
+}
+
 
 //------------------------------------------------------------------------------
 
@@ -670,6 +1293,23 @@ void ResManager::unlock (ResourceObject * obj)
       obj->linkAfter (&timeoutList);
 }
 
+ResourceInstance * ResManager::detachInstance (ResourceObject * obj)
+{
+   if (!obj)
+      return NULL;
+
+   ResourceInstance *ret = NULL;
+   if (obj->lockCount == 1 && obj->mInstance && !findAsyncLoad (obj))
+   {
+      noteAccess (obj);
+      untrackInstance (obj);
+      ret = obj->mInstance;
+      obj->mInstance = NULL;
+   }
+   unlock (obj);
+   return ret;
+}
+
 //------------------------------------------------------------------------------
 // gets the crc of the file, ignores the stream type
 
@@ -687,6 +1327,11 @@ bool ResManager::getCrc (const char *fileName, U32 & crcVal,
       if (obj->lockCount)
          return false;
 
+      // an unchanged file has the crc it had last time
+      bool fromStart = crcInitialVal == INITIAL_CRC_VALUE;
+      if (fromStart && getCachedCrc (obj, crcVal))
+         return true;
+
       // get rid of the resource
       // have to make sure user can't have it sitting around in the resource cache
 
@@ -711,6 +1356,8 @@ bool ResManager::getCrc (const char *fileName, U32 & crcVal,
 
       // get the crc value
       crcVal = calculateCRC (buffer, obj->fileSize, crcInitialVal);
+      if (fromStart)
+         setCachedCrc (obj, crcVal);
       if (waterMark == 0xFFFFFFFF)
          delete[]buffer;
       else
@@ -731,6 +1378,7 @@ ResourceObject *ResManager::load (const char *fileName, bool computeCRC)
    ResourceObject *obj = find (fileName);
    if (!obj)
       return NULL;
+   noteAccess (obj);
 
    // if no one has a lock on this, but it's loaded and it needs to
    // be CRC'd, delete it and reload it.
@@ -740,6 +1388,24 @@ ResourceObject *ResManager::load (const char *fileName, bool computeCRC)
    obj->lockCount++;
    obj->unlink ();      // remove from purge list
 
+   // If it's being loaded in the background, take that result now rather
+   // than reading it twice.  The callbacks still go out with the next pump.
+   AsyncLoad *pending = findAsyncLoad (obj);
+   if (pending && pending->mStream && !obj->mInstance)
+   {
+      waitForAsyncLoad (pending);
+      closeStream (pending->mStream);
+      pending->mStream = NULL;
+      obj->crc = pending->mCRC;
+      if (pending->mInstance)
+      {
+         pending->mInstance->mSourceResource = obj;
+         obj->mInstance = pending->mInstance;
+         pending->mInstance = NULL;
+         trackInstance (obj);
+      }
+   }
+
    if (!obj->mInstance)
    {
       obj->mInstance = loadInstance (obj, computeCRC);
@@ -748,6 +1414,7 @@ ResourceObject *ResManager::load (const char *fileName, bool computeCRC)
          obj->lockCount--;
          return NULL;
       }
+      trackInstance (obj);
    }
    return obj;
 }
@@ -768,12 +1435,8 @@ ResourceInstance * ResManager::loadInstance (const char *fileName, bool computeC
 
 static const char *alwaysCRCList = ".ter.dif.dts";
 
-ResourceInstance * ResManager::loadInstance (ResourceObject * obj, bool computeCRC)
+ResourceInstance * ResManager::constructInstance (ResourceObject * obj, Stream * stream, bool computeCRC, U32 & crc)
 {
-   Stream *stream = openStream (obj);
-   if (!stream)
-      return NULL;
-
    if (!computeCRC)
    {
       const char *x = dStrrchr (obj->name, '.');
@@ -782,20 +1445,38 @@ ResourceInstance * ResManager::loadInstance (ResourceObject * obj, bool computeC
    }
 
    if (computeCRC)
-      obj->crc = calculateCRCStream (stream, InvalidCRC);
+   {
+      if (!getCachedCrc (obj, crc))
+      {
+         crc = calculateCRCStream (stream, InvalidCRC);
+         setCachedCrc (obj, crc);
+      }
+   }
    else
-      obj->crc = InvalidCRC;
+      crc = InvalidCRC;
 
-   RESOURCE_CREATE_FN createFunction = ResourceManager->getCreateFunction (obj->name);
+   RegisteredExtension *ext = findExtension (obj->name);
 
-   if(!createFunction)
+   if(!ext)
    {
        AssertWarn( false, "ResourceObject::construct: NULL resource create function.");
        Con::errorf("ResourceObject::construct: NULL resource create function for '%s'.", obj->name);
        return NULL;
    }
 
-   ResourceInstance *ret = createFunction (*stream);
+   if (ext->mCreateFileFn)
+      return ext->mCreateFileFn (*stream, obj);
+   return ext->mCreateFn (*stream);
+}
+
+ResourceInstance * ResManager::loadInstance (ResourceObject * obj, bool computeCRC)
+{
+   noteAccess (obj);
+   Stream *stream = openStream (obj);
+   if (!stream)
+      return NULL;
+
+   ResourceInstance *ret = constructInstance (obj, stream, computeCRC, obj->crc);
    if(ret)
       ret->mSourceResource = obj;
    closeStream (stream);
@@ -804,6 +1485,276 @@ ResourceInstance * ResManager::loadInstance (ResourceObject * obj, bool computeC
 
 //------------------------------------------------------------------------------
 
+class ResLoaderThread : public Thread
+{
+   ResManager* mManager;
+
+  public:
+   ResLoaderThread(ResManager* manager) : Thread(0, 0, false)
+   {
+      mManager = manager;
+   }
+
+   void run(S32)
+   {
+      while (ResManager::AsyncLoad* load = mManager->getNextAsyncLoad())
+         mManager->processAsyncLoad(load);
+   }
+};
+
+ResManager::AsyncLoad * ResManager::findAsyncLoad (ResourceObject * obj)
+{
+   for (U32 i = 0; i < mAsyncLoads.size(); i++)
+      if (mAsyncLoads[i]->mObject == obj)
+         return mAsyncLoads[i];
+   return NULL;
+}
+
+bool ResManager::isLoadPending (const char *fileName)
+{
+   if (!mAsyncLoads.size ())
+      return false;
+   ResourceObject *obj = find (fileName);
+   return obj && findAsyncLoad (obj);
+}
+
+bool ResManager::loadAsync (const char *fileName, RESOURCE_ASYNC_FN callback, void *userData, bool computeCRC)
+{
+   AssertFatal(Thread::isMainThread(), "ResManager::loadAsync: may only be called from the main thread.");
+
+   ResourceObject *obj = find (fileName);
+   if (!obj)
+      return false;
+
+   AsyncCallback cb;
+   cb.mCallback = callback;
+   cb.mUserData = userData;
+
+   // Piggyback on a load that's already in flight.
+   AsyncLoad *load = findAsyncLoad (obj);
+   if (load)
+   {
+      obj->lockCount++;
+      load->mCallbacks.push_back(cb);
+      return true;
+   }
+
+   // Same CRC rule as load(): an unlocked instance has to be reloaded.
+   if (!obj->lockCount && computeCRC && obj->mInstance)
+      obj->destruct ();
+
+   obj->lockCount++;
+   obj->unlink ();      // remove from purge list
+
+   load = new AsyncLoad;
+   load->mObject = obj;
+   load->mStream = NULL;
+   load->mComputeCRC = computeCRC;
+   load->mCRC = InvalidCRC;
+   load->mInstance = NULL;
+   load->mState = AsyncLoad::Done;
+   load->mCallbacks.push_back(cb);
+   mAsyncLoads.push_back(load);
+
+   // Already resident, the callback just waits for the next pump.
+   if (obj->mInstance)
+      return true;
+
+   // Opening touches the dictionary and zip headers, so do it here and
+   // leave only the reading and construction to the loader.  That isn't a
+   // use of the file yet, so it stays out of the access log.
+   bool logging = mLoggingAccess;
+   mLoggingAccess = false;
+   load->mStream = openStream (obj);
+   mLoggingAccess = logging;
+   if (!load->mStream)
+      return true;
+
+   load->mState = AsyncLoad::Queued;
+
+   // Types that can be built side by side go to the job system, so a batch
+   // of them (textures, say) decodes on every core.
+   RegisteredExtension *ext = findExtension (obj->name);
+   if (ext && ext->mConcurrent && gThreadPool && gThreadPool->isThreaded ())
+   {
+      load->mJob.mManager = this;
+      load->mJob.mLoad = load;
+      gThreadPool->queueWorkItem (&load->mJob, &load->mJobCounter);
+      return true;
+   }
+
+#ifdef TORQUE_MULTITHREAD
+   if (!mAsyncThread)
+   {
+      mAsyncThread = new ResLoaderThread(this);
+      mAsyncThread->start();
+   }
+
+   Mutex::lockMutex(mAsyncMutex);
+   mAsyncQueue.push_back(load);
+   Mutex::unlockMutex(mAsyncMutex);
+   Semaphore::releaseSemaphore(mAsyncSemaphore);
+#else
+   load->mState = AsyncLoad::Loading;
+   processAsyncLoad(load);
+#endif
+   return true;
+}
+
+ResManager::AsyncLoad * ResManager::getNextAsyncLoad ()
+{
+   for (;;)
+   {
+      Semaphore::acquireSemaphore(mAsyncSemaphore);
+      if (mAsyncShuttingDown)
+         return NULL;
+
+      Mutex::lockMutex(mAsyncMutex);
+      AssertFatal(mAsyncQueueHead < mAsyncQueue.size(), "ResManager::getNextAsyncLoad: semaphore out of sync with queue.");
+      AsyncLoad *load = mAsyncQueue[mAsyncQueueHead++];
+      if (mAsyncQueueHead == mAsyncQueue.size())
+      {
+         mAsyncQueue.clear();
+         mAsyncQueueHead = 0;
+      }
+
+      // A blocking load() may have claimed it in the meantime.
+      bool claimed = load->mState == AsyncLoad::Queued;
+      if (claimed)
+         load->mState = AsyncLoad::Loading;
+      Mutex::unlockMutex(mAsyncMutex);
+
+      if (claimed)
+         return load;
+   }
+}
+
+bool ResManager::claimAsyncLoad (AsyncLoad * load)
+{
+   Mutex::lockMutex(mAsyncMutex);
+   bool claimed = load->mState == AsyncLoad::Queued;
+   if (claimed)
+      load->mState = AsyncLoad::Loading;
+   Mutex::unlockMutex(mAsyncMutex);
+   return claimed;
+}
+
+void ResManager::AsyncJob::process ()
+{
+   // A blocking load() may have taken it first.
+   if (mManager->claimAsyncLoad(mLoad))
+      mManager->processAsyncLoad(mLoad);
+}
+
+void ResManager::processAsyncLoad (AsyncLoad * load)
+{
+   ResourceInstance *inst = constructInstance (load->mObject, load->mStream, load->mComputeCRC, load->mCRC);
+
+   Mutex::lockMutex(mAsyncMutex);
+   load->mInstance = inst;
+   load->mState = AsyncLoad::Done;
+   Mutex::unlockMutex(mAsyncMutex);
+}
+
+void ResManager::waitForAsyncLoad (AsyncLoad * load)
+{
+   if (claimAsyncLoad(load))
+   {
+      processAsyncLoad(load);
+      return;
+   }
+
+   for (;;)
+   {
+      Mutex::lockMutex(mAsyncMutex);
+      bool done = load->mState == AsyncLoad::Done;
+      Mutex::unlockMutex(mAsyncMutex);
+      if (done)
+         return;
+      Platform::sleep(1);
+   }
+}
+
+void ResManager::finishAsyncLoad (AsyncLoad * load, bool doCallbacks)
+{
+   ResourceObject *obj = load->mObject;
+
+   for (U32 i = 0; i < mAsyncLoads.size(); i++)
+      if (mAsyncLoads[i] == load)
+      {
+         mAsyncLoads.erase_fast(i);
+         break;
+      }
+
+   if (load->mStream)
+   {
+      closeStream (load->mStream);
+      obj->crc = load->mCRC;
+      if (load->mInstance)
+      {
+         AssertFatal(!obj->mInstance, "ResManager::finishAsyncLoad: resource loaded behind our back.");
+         load->mInstance->mSourceResource = obj;
+         obj->mInstance = load->mInstance;
+         trackInstance (obj);
+      }
+   }
+
+   // Every caller owns one lock; failed loads give theirs back.
+   for (U32 i = 0; i < load->mCallbacks.size(); i++)
+   {
+      if (!obj->mInstance || !doCallbacks)
+      {
+         unlock (obj);
+         if (doCallbacks && load->mCallbacks[i].mCallback)
+            load->mCallbacks[i].mCallback(NULL, load->mCallbacks[i].mUserData);
+      }
+      else if (load->mCallbacks[i].mCallback)
+         load->mCallbacks[i].mCallback(obj, load->mCallbacks[i].mUserData);
+   }
+
+   // A job may still be on its way out of the pool, or not have run at all
+   // if a blocking load() took the work.
+   if (gThreadPool && !load->mJobCounter.isDone())
+      gThreadPool->waitForCounter(&load->mJobCounter);
+   delete load;
+}
+
+void ResManager::processAsyncLoads ()
+{
+   // Callbacks may queue more loads, so only finish what's done right now.
+   Vector<AsyncLoad*> done;
+   Mutex::lockMutex(mAsyncMutex);
+   for (U32 i = 0; i < mAsyncLoads.size(); i++)
+      if (mAsyncLoads[i]->mState == AsyncLoad::Done)
+         done.push_back(mAsyncLoads[i]);
+   Mutex::unlockMutex(mAsyncMutex);
+
+   for (U32 i = 0; i < done.size(); i++)
+      finishAsyncLoad(done[i], true);
+
+   enforceMemoryBudget();
+}
+
+void ResManager::stopAsyncLoader ()
+{
+   if (!mAsyncThread)
+      return;
+
+   mAsyncShuttingDown = true;
+   Semaphore::releaseSemaphore(mAsyncSemaphore);
+   mAsyncThread->join();
+   delete mAsyncThread;
+   mAsyncThread = NULL;
+   mAsyncShuttingDown = false;
+
+   Mutex::lockMutex(mAsyncMutex);
+   mAsyncQueue.clear();
+   mAsyncQueueHead = 0;
+   Mutex::unlockMutex(mAsyncMutex);
+}
+
+//------------------------------------------------------------------------------
+
 Stream * ResManager::openStream (const char *fileName)
 {
    ResourceObject *obj = find (fileName);
@@ -822,6 +1773,7 @@ Stream * ResManager::openStream (ResourceObject * obj)
 
    if (echoFileNames)
       Con::printf ("FILE ACCESS: %s/%s", obj->path, obj->name);
+   noteAccess (obj);
 
    // used for openStream stream access
    FileStream *diskStream = NULL;
@@ -829,6 +1781,19 @@ Stream * ResManager::openStream (ResourceObject * obj)
    // if disk file
    if (obj->flags & (ResourceObject::File))
    {
+      // Big files are cheaper to map than to copy through the FileStream
+      // buffer.  The size is from the last directory scan, the mapping
+      // itself always covers the whole file.
+      if (smMapFileThreshold > 0 && obj->fileSize >= smMapFileThreshold)
+      {
+         MappedStream *mapped = MappedStream::open (buildPath (obj->path, obj->name));
+         if (mapped)
+         {
+            obj->fileSize = mapped->getStreamSize ();
+            return mapped;
+         }
+      }
+
       diskStream = new FileStream;
       if( !diskStream->open (buildPath (obj->path, obj->name), FileStream::Read) )
       {
@@ -861,6 +1826,18 @@ Stream * ResManager::openStream (ResourceObject * obj)
       if (zlfHeader.m_header.compressionMethod == ZipLocalFileHeader::Stored
             || obj->fileSize == 0)
       {
+         // Stored entries can be mapped straight out of the archive.
+         if (smMapFileThreshold > 0 && obj->fileSize >= smMapFileThreshold)
+         {
+            MappedStream *mapped = MappedStream::open (buildPath (obj->zipPath, obj->zipName),
+               diskStream->getPosition (), obj->fileSize);
+            if (mapped)
+            {
+               delete diskStream;
+               return mapped;
+            }
+         }
+
          // Just read straight from the stream...
          ResizeFilterStream *strm = new ResizeFilterStream;
          strm->attachStream (diskStream);
@@ -986,6 +1963,7 @@ bool ResManager::add (const char *name, ResourceInstance * addInstance,
    obj->mInstance = addInstance;
    addInstance->mSourceResource = obj;
    obj->lockCount = extraLock ? 2 : 1;
+   trackInstance (obj);
    unlock (obj);
    return true;
 }
@@ -1217,7 +2195,7 @@ void ResManager::freeResource (ResourceObject * ro)
    if (ro->nextResource)
       ro->nextResource->prevResource = ro->prevResource;
    dictionary.remove (ro);
-   delete ro;
+   dictionary.retire (ro);
 }
 
 //------------------------------------------------------------------------------
@@ -31,6 +31,9 @@
 #ifndef _CRC_H_
 #include "core/crc.h"
 #endif
+#ifndef _THREADPOOL_H_
+#include "core/threadPool.h"
+#endif
 
 class Stream;
 class FileStream;
@@ -42,6 +45,7 @@ extern ResManager *ResourceManager;
 
 //------------------------------------------------------------------------------
 class ResourceObject;
+class ResLoaderThread;
 
 /// The base class for all resources.
 ///
@@ -94,11 +98,27 @@ public:
 
    ResourceInstance() { mSourceResource = NULL; }
    virtual ~ResourceInstance() {}
+
+   /// Approximate number of bytes this instance holds, counted against the
+   /// ResManager memory budget.  Returning 0 means the size of the source
+   /// file is used instead.
+   virtual U32 getResourceSize() const { return 0; }
 };
 
 
 typedef ResourceInstance* (*RESOURCE_CREATE_FN)(Stream &stream);
 
+/// Create function that is also told which resource it's reading, for types
+/// that keep something alongside the file (see TSShape's baked images).
+/// It may be called off the main thread for a loadAsync().
+typedef ResourceInstance* (*RESOURCE_CREATE_FILE_FN)(Stream &stream, ResourceObject *obj);
+
+/// Completion callback for ResManager::loadAsync().
+///
+/// Called on the main thread with the locked resource object, or NULL if the
+/// load failed. The lock belongs to the callee, same as a return from load().
+typedef void (*RESOURCE_ASYNC_FN)(ResourceObject *obj, void *userData);
+
 
 //------------------------------------------------------------------------------
 #define InvalidCRC 0xFFFFFFFF
@@ -154,6 +174,8 @@ public:
                                  ///  this may be NULL or garbage.
    S32 lockCount;                ///< Lock count; used to control load/unload of resource from memory.
    U32 crc;                      ///< CRC of resource.
+   U32 mInstanceSize;            ///< Bytes mInstance was counted as against the memory budget.
+   U32 mAccessMark;              ///< Serial of the last access log this was recorded in.
 
    ResourceObject();
    ~ResourceObject() { unlink(); }
@@ -267,16 +289,70 @@ public:
 class ResDictionary
 {
    /// @name Hash Table
+   ///
+   /// Open addressed with linear probing.  Each slot holds one path and name
+   /// and the objects under it, linked through nextEntry in the order find()
+   /// returns them.  Paths and names are StringTableEntries, which are
+   /// already folded for case, so their pointers are the key, hashed once
+   /// into the slot.  A slot keeps its key when its objects are removed;
+   /// the table is rebuilt with just the live slots once MaxLoad percent
+   /// are taken, and doubles if that's still too full.
+   ///
+   /// Changes are serialized by mWriteMutex.  The finds take no lock: they
+   /// look again if a change was made while they looked, and tables that
+   /// were outgrown are kept until the dictionary goes.  Objects are freed
+   /// through retire(), which holds them until no find that started before
+   /// they were removed can still be walking them, so a find on another
+   /// thread never walks freed memory.
    /// @{
 
-   enum { DefaultTableSize = 1029 };
+   enum
+   {
+      DefaultTableSize = 1024,   ///< Power of two.
+      MaxLoad = 70
+   };
+
+   struct Slot
+   {
+      U32 hash;
+      StringTableEntry path;
+      StringTableEntry name;     ///< NULL for an empty slot.
+      ResourceObject *head;
+   };
 
-   ResourceObject **hashTable;
+   struct Table
+   {
+      U32 size;                  ///< Power of two.
+      Slot *slots;
+   };
+
+   Table *volatile mTable;
+   Vector<Table*> mRetired;
+   Vector<ResourceObject*> mRetiredObjects;
+   volatile U32 mReaders;        ///< Finds in progress.
+   U32 mUsed;                    ///< Slots with a key, whether or not they hold objects.
    S32 entryCount;
-   S32 hashTableSize;
-   DataChunker memPool;
-   S32 hash(StringTableEntry path, StringTableEntry name);
-   S32 hash(ResourceObject *obj) { return hash(obj->path, obj->name); }
+   volatile U32 mVersion;        ///< Odd while a change is being made.
+   void *mWriteMutex;
+
+   static U32 hash(StringTableEntry path, StringTableEntry name);
+   static Table *newTable(U32 size);
+   static Slot *findSlot(Table *table, U32 hash, StringTableEntry path, StringTableEntry name);
+   Slot *addSlot(StringTableEntry path, StringTableEntry name);
+   void rebuild();
+   void unlink(ResourceObject *obj);
+
+   void beginWrite();
+   void endWrite();
+
+   enum Match
+   {
+      MatchName,
+      MatchZip,
+      MatchFlags
+   };
+   ResourceObject *lookup(StringTableEntry path, StringTableEntry name, Match match,
+                          StringTableEntry zipPath, StringTableEntry zipName, U32 flags);
    /// @}
 
 public:
@@ -286,10 +362,13 @@ public:
    /// Add a ResourceObject to the dictionary.
    void insert(ResourceObject *obj, StringTableEntry path, StringTableEntry file);
 
+   /// Delete a removed object once no find can still be looking at it.
+   void retire(ResourceObject *obj);
+
    /// @name Find
    /// These functions search the hash table for an individual resource.  If the resource has
    /// already been loaded, it will find the resource and return its object.  If not,
-   /// it will return NULL.
+   /// it will return NULL.  They're safe to call from any thread.
    /// @{
 
    ResourceObject* find(StringTableEntry path, StringTableEntry file);
@@ -356,20 +435,220 @@ private:
    void searchPath(const char *pathStart);
    bool setModZip(const char* path);
 
+   /// Create the resource for a file found on disk, scanning it if it's a zip.
+   void addDiskResource(StringTableEntry path, StringTableEntry file, U32 size);
+
+   /// @name Resource Index Cache
+   ///
+   /// Walking every mod directory and zip at startup is slow on big content
+   /// trees, so the results are kept on disk in smIndexCacheFile.  A mod path
+   /// is replayed from the index as long as none of its directories have a
+   /// newer modify time; a directory that changed gets its subtree rescanned.
+   /// Zips are revalidated by their own size and modify time.
+   ///
+   /// The index also remembers file CRCs, so getCrc() and CRC'd loads don't
+   /// reread files that haven't changed; those are written at shutdown.
+   /// @{
+
+   struct IndexDir
+   {
+      StringTableEntry path;
+      FileTime         modifyTime;
+   };
+
+   struct IndexFile
+   {
+      StringTableEntry path;
+      StringTableEntry name;
+      U32              size;
+   };
+
+   struct IndexZipEntry
+   {
+      StringTableEntry path;
+      StringTableEntry name;
+      S32              fileSize;
+      S32              compressedFileSize;
+      S32              fileOffset;
+   };
+
+   struct IndexRoot
+   {
+      StringTableEntry  path;
+      Vector<IndexDir>  dirs;
+      Vector<IndexFile> files;
+   };
+
+   struct IndexZip
+   {
+      StringTableEntry      path;
+      StringTableEntry      name;
+      U32                   size;
+      FileTime              modifyTime;
+      Vector<IndexZipEntry> entries;
+   };
+
+   /// The CRC of a file as of its size and modify time; for a zip entry
+   /// the time is the zip's.  Kept sorted on path.
+   struct IndexCrc
+   {
+      StringTableEntry path;
+      U32              size;
+      FileTime         modifyTime;
+      U32              crc;
+   };
+
+   Vector<IndexRoot*> mIndexRoots;
+   Vector<IndexZip*>  mIndexZips;
+   Vector<IndexCrc>   mIndexCrcs;
+   bool               mIndexLoaded;
+   bool               mIndexDirty;
+
+   IndexRoot* findIndexRoot(StringTableEntry path);
+   IndexZip*  findIndexZip(StringTableEntry path, StringTableEntry name);
+
+   /// Replace everything the root knows about dir and below with a fresh walk.
+   void rescanIndexDir(IndexRoot *root, const char *dir);
+
+   /// Index of path in mIndexCrcs, or of where it would go.
+   S32  findIndexCrc(StringTableEntry path);
+
+   /// Look up the CRC of obj, from INITIAL_CRC_VALUE, if it hasn't changed
+   /// since it was stored.  Only the main thread uses the CRC cache.
+   bool getCachedCrc(ResourceObject *obj, U32 &crc);
+   void setCachedCrc(ResourceObject *obj, U32 crc);
+
+   void loadIndexCache();
+   /// False, partway through, on any short or garbled read.
+   bool readIndexCache(Stream &stream);
+   void saveIndexCache();
+   void clearIndexCache();
+   /// @}
+
    struct RegisteredExtension
    {
       StringTableEntry     mExtension;
-      RESOURCE_CREATE_FN   mCreateFn;
-      RegisteredExtension  *next;
+      RESOURCE_CREATE_FN      mCreateFn;
+      RESOURCE_CREATE_FILE_FN mCreateFileFn;
+      bool                    mConcurrent;  ///< Create function may run on several threads at once.
+      RegisteredExtension     *next;
    };
 
+   Vector<StringTableEntry> mAccessLog;            ///< Full paths, in the order of first use.
+   U32  mAccessLogSerial;                          ///< Bumped by each startAccessLog().
+   bool mLoggingAccess;
+   void noteAccess(ResourceObject *obj);           ///< Called when a resource is opened or loaded.
+
    Vector<char *> mMissingFileList;                ///< List of missing files.
    bool mLoggingMissingFiles;                      ///< Are there any missing files?
    void fileIsMissing(const char *fileName);       ///< Called when a file is missing.
 
    RegisteredExtension *registeredList;
+   RegisteredExtension* findExtension(const char *name);
+   void addExtension(const char *name, RESOURCE_CREATE_FN create_fn, RESOURCE_CREATE_FILE_FN create_file_fn, bool concurrent);
 
    static char *smExcludedDirectories;
+
+   /// Loose files and stored zip entries at least this big are memory mapped
+   /// rather than read through a FileStream; 0 disables mapping.
+   static S32 smMapFileThreshold;
+
+   /// File the resource index is cached in; empty disables the cache.
+   static char *smIndexCacheFile;
+
+   /// @name Memory Budget
+   ///
+   /// Unlocked resources sit on timeoutList, most recently released first.
+   /// When the loaded instances add up to more than smMemoryBudget bytes the
+   /// oldest of them are freed, much like a purge() of just the tail.
+   /// @{
+
+   friend class ResourceObject;
+
+   static S32 smMemoryBudget;          ///< Bytes; 0 means unlimited.
+   S32        mLoadedBytes;            ///< Sum of mInstanceSize over every loaded resource.
+   S32        mLoadedCount;
+   S32        mEvictedCount;           ///< Resources freed to stay in budget.
+
+   /// Account for a newly installed obj->mInstance and trim to budget.
+   void trackInstance(ResourceObject *obj);
+   /// Called by ResourceObject::destruct() before the instance goes away.
+   void untrackInstance(ResourceObject *obj);
+   /// @}
+
+   /// @name Background Loading
+   /// @{
+
+   struct AsyncCallback
+   {
+      RESOURCE_ASYNC_FN mCallback;
+      void              *mUserData;
+   };
+
+   struct AsyncLoad;
+
+   /// Runs a load of a concurrent type on the job system.
+   struct AsyncJob : public ThreadPool::WorkItem
+   {
+      ResManager *mManager;
+      AsyncLoad  *mLoad;
+      void process();
+   };
+
+   struct AsyncLoad
+   {
+      enum State
+      {
+         Queued,     ///< Waiting for the loader thread or a job.
+         Loading,    ///< Being constructed, by the loader or a blocking load().
+         Done,       ///< mInstance is valid (or NULL on failure), ready to finish.
+      };
+
+      ResourceObject        *mObject;
+      Stream                *mStream;      ///< Opened on the main thread, closed when finished.
+      bool                  mComputeCRC;
+      U32                   mCRC;
+      ResourceInstance      *mInstance;
+      volatile S32          mState;
+      Vector<AsyncCallback> mCallbacks;    ///< One per loadAsync() call, each holds a lock.
+      AsyncJob              mJob;
+      ThreadPool::Counter   mJobCounter;   ///< Nonzero while mJob is queued or running.
+   };
+
+   friend class ResLoaderThread;
+
+   Vector<AsyncLoad*> mAsyncLoads;         ///< Everything in flight; main thread only.
+   Vector<AsyncLoad*> mAsyncQueue;         ///< Handed to the loader thread, guarded by mAsyncMutex.
+   U32                mAsyncQueueHead;
+   void               *mAsyncMutex;
+   void               *mAsyncSemaphore;    ///< Signaled once per queued load.
+   ResLoaderThread    *mAsyncThread;
+   bool               mAsyncShuttingDown;
+
+   AsyncLoad* findAsyncLoad(ResourceObject *obj);
+
+   /// Read the stream and run the create function.  Safe to call off the main thread.
+   void processAsyncLoad(AsyncLoad *load);
+
+   /// Block until the load has its instance, doing the work here if the loader
+   /// thread hasn't picked it up yet.
+   void waitForAsyncLoad(AsyncLoad *load);
+
+   /// Install the instance and fire (or, on shutdown, drop) the callbacks.
+   void finishAsyncLoad(AsyncLoad *load, bool doCallbacks);
+
+   /// Called by the loader thread; returns NULL when shutting down.
+   AsyncLoad* getNextAsyncLoad();
+
+   /// Take a queued load for this thread; false if someone else has it.
+   bool claimAsyncLoad(AsyncLoad *load);
+
+   void stopAsyncLoader();
+   /// @}
+
+   /// Compute the CRC if needed and run the create function for the stream.
+   ResourceInstance* constructInstance(ResourceObject *obj, Stream *stream, bool computeCRC, U32 &crc);
+
    ResManager();
 public:
    RESOURCE_CREATE_FN getCreateFunction( const char *name );
@@ -396,8 +675,23 @@ public:
    bool getMissingFileList(Vector<char *> &list);     ///< Gets which files are missing
    void clearMissingFileList();                       ///< Clears the missing file list
 
-   /// Tells the resource manager what to do with a resource that it loads
-   void registerExtension(const char *extension, RESOURCE_CREATE_FN create_fn);
+   /// Record the resources loaded or opened on the main thread from now on,
+   /// each once, in the order they're first used.  Background loads only
+   /// count once someone loads, opens or detaches the result.
+   void startAccessLog();
+   /// Stop recording and hand back the full paths.
+   void stopAccessLog(Vector<StringTableEntry> &list);
+
+   /// Is there a create function for this kind of file?
+   bool canConstruct(const char *fileName) { return findExtension(fileName) != NULL; }
+
+   /// Tells the resource manager what to do with a resource that it loads.
+   ///
+   /// If concurrent is set the create function may be run on several
+   /// threads at once, and background loads of the type are spread over
+   /// the job system instead of waiting their turn on the loader thread.
+   void registerExtension(const char *extension, RESOURCE_CREATE_FN create_fn, bool concurrent = false);
+   void registerExtension(const char *extension, RESOURCE_CREATE_FILE_FN create_fn, bool concurrent = false);
 
    S32 getSize(const char* filename);                 ///< Gets the size of the file
    const char* getFullPath(const char * filename, char * path, U32 pathLen);  ///< Gets the full path of the file
@@ -406,6 +700,32 @@ public:
    const char* getBasePath();                         ///< Gets the base path
 
    ResourceObject* load(const char * fileName, bool computeCRC = false);   ///< loads an instance of an object
+
+   /// Load a resource in the background.
+   ///
+   /// The file is read and the resource constructed on a loader thread (or
+   /// a job, for concurrent types, see registerExtension()), the callback is made from processAsyncLoads() once it's done.  Each call
+   /// takes a lock just like load(), and hands it to the callback.  Requests
+   /// for a resource that is already in flight share the one load; a
+   /// blocking load() of it simply waits for the result.
+   ///
+   /// @returns false if the file is unknown (the callback is not made).
+   bool loadAsync(const char *fileName, RESOURCE_ASYNC_FN callback, void *userData = NULL, bool computeCRC = false);
+
+   /// Finish completed background loads and make their callbacks.  Called
+   /// once a frame from the main loop.
+   void processAsyncLoads();
+
+   /// Number of background loads not yet finished.
+   U32 getNumAsyncLoads() const { return mAsyncLoads.size(); }
+
+   /// Is a background load of the file still in flight?
+   bool isLoadPending(const char *fileName);
+
+   /// Free least recently used unlocked resources until the loaded total
+   /// fits in $Pref::ResourceManager::memoryBudget.  Runs automatically after
+   /// loads and once a frame from processAsyncLoads().
+   void enforceMemoryBudget();
    Stream*  openStream(const char * fileName);        ///< Opens a stream for an object
    Stream*  openStream(ResourceObject *object);       ///< Opens a stream for an object
    void     closeStream(Stream *stream);              ///< Closes the stream
@@ -414,6 +734,13 @@ public:
    /// the object is added to the timeoutList for deletion upon call of flush.
    void unlock( ResourceObject* );
 
+   /// Take the constructed instance out of a resource that no one else has
+   /// locked, for callers that want their own copy the way loadInstance()
+   /// gives one.  The caller's lock is released either way.
+   ///
+   /// @returns NULL if it isn't loaded or someone else holds a lock.
+   ResourceInstance* detachInstance( ResourceObject* );
+
    /// Add a new resource instance
    bool add(const char* name, ResourceInstance *addInstance, bool extraLock = false);
 
@@ -452,9 +779,7 @@ public:
    /// Opens a file for writing!
    bool openFileForWrite(FileStream &fs, const char *fileName, U32 accessMode = 1);
 
-#ifdef TORQUE_DEBUG
-   void dumpLoadedResources();                        ///< Dumps all loaded resources to the console.
-#endif
+   void dumpLoadedResources();                        ///< Dumps all loaded resources and memory stats to the console.
 };
 
 template<class T> inline void Resource<T>::unlock()
@@ -99,6 +99,11 @@ class Stream {
    /// Gets the size of the stream
    virtual U32  getStreamSize() = 0;
 
+   /// Returns a pointer to the next in_numBytes of the stream and skips past
+   /// them, or NULL if the stream isn't memory backed or is too short.  The
+   /// data is only valid while the stream is open and must not be written.
+   virtual const void* readDirect(const U32 in_numBytes) { return NULL; }
+
    /// Reads a line from the stream.
    /// @param buffer buffer to be read into
    /// @param bufferSize max size of the buffer.  Will not read more than the "bufferSize"
@@ -5,9 +5,10 @@
 
 #include "platform/platform.h"
 #include "core/stringTable.h"
+#include "platform/platformMutex.h"
 
 _StringTable *StringTable = NULL;
-const U32 _StringTable::csm_stInitSize = 29;
+const U32 _StringTable::csm_stInitSize = 64;
 
 //---------------------------------------------------------------
 //
@@ -62,19 +63,31 @@ U32 _StringTable::hashStringn(const char* str, S32 len)
 //--------------------------------------
 _StringTable::_StringTable()
 {
-   buckets = (Node **) dMalloc(csm_stInitSize * sizeof(Node *));
-   for(U32 i = 0; i < csm_stInitSize; i++) {
-      buckets[i] = 0;
-   }
+   if (sgInitTable)
+      initTolowerTable();
 
-   numBuckets = csm_stInitSize;
+   mCapacity = csm_stInitSize;
+   mShift = 32 - getBinLog2(mCapacity);
+   mSlots = (Slot *) dMalloc(mCapacity * sizeof(Slot));
+   dMemset(mSlots, 0, mCapacity * sizeof(Slot));
    itemCount = 0;
+
+   mOldSlots = NULL;
+   mOldCapacity = 0;
+   mOldShift = 0;
+   mOldCount = 0;
+   mMigrateIndex = 0;
+   mMigrateLeft = 0;
+
+   mMutex = Mutex::createMutex();
 }
 
 //--------------------------------------
 _StringTable::~_StringTable()
 {
-   dFree(buckets);
+   dFree(mSlots);
+   dFree(mOldSlots);
+   Mutex::destroyMutex(mMutex);
 }
 
 
@@ -96,109 +109,176 @@ void _StringTable::destroy()
 
 
 //--------------------------------------
-StringTableEntry _StringTable::insert(const char* val, const bool  caseSens)
+StringTableEntry _StringTable::find(Slot *slots, U32 capacity, U32 shift, U32 hash, const char *val, S32 len, bool caseSens)
 {
-   Node **walk, *temp;
-   U32 key = hashString(val);
-   walk = &buckets[key % numBuckets];
-   while((temp = *walk) != NULL)   {
-      if(caseSens && !dStrcmp(temp->val, val))
-         return temp->val;
-      else if(!caseSens && !dStricmp(temp->val, val))
-         return temp->val;
-      walk = &(temp->next);
+   U32 mask = capacity - 1;
+   for(U32 i = slotIndex(hash, shift); slots[i].val; i = (i + 1) & mask)
+   {
+      if(slots[i].hash != hash)
+         continue;
+      const char *str = slots[i].val;
+      if(caseSens ? dStrncmp(str, val, len) : dStrnicmp(str, val, len))
+         continue;
+      if(str[len] == 0)
+         return str;
    }
-   char *ret = 0;
-   if(!*walk) {
-      *walk = (Node *) mempool.alloc(sizeof(Node));
-      (*walk)->next = 0;
-      (*walk)->val = (char *) mempool.alloc(dStrlen(val) + 1);
-      dStrcpy((*walk)->val, val);
-      ret = (*walk)->val;
-      itemCount ++;
+   return NULL;
+}
+
+void _StringTable::place(U32 hash, char *val)
+{
+   U32 mask = mCapacity - 1;
+   U32 i = slotIndex(hash, mShift);
+   while(mSlots[i].val)
+      i = (i + 1) & mask;
+   mSlots[i].hash = hash;
+   mSlots[i].val = val;
+}
+
+void _StringTable::migrateRun(U32 index)
+{
+   U32 mask = mOldCapacity - 1;
+   if(!mOldSlots[index].val)
+      return;
+
+   // back up to the start of the run so it moves whole and in order
+   while(mOldSlots[(index - 1) & mask].val)
+      index = (index - 1) & mask;
+
+   while(mOldSlots[index].val)
+   {
+      place(mOldSlots[index].hash, mOldSlots[index].val);
+      mOldSlots[index].val = NULL;
+      mOldCount--;
+      index = (index + 1) & mask;
    }
-   if(itemCount > 2 * numBuckets) {
-      resize(4 * numBuckets - 1);
+}
+
+void _StringTable::migrateStep()
+{
+   // a few old slots per insert finishes long before the new table fills
+   for(U32 i = 0; i < 16 && mMigrateLeft; i++, mMigrateLeft--)
+   {
+      migrateRun(mMigrateIndex);
+      mMigrateIndex = (mMigrateIndex + 1) & (mOldCapacity - 1);
    }
-   return ret;
+
+   if(!mOldCount)
+   {
+      dFree(mOldSlots);
+      mOldSlots = NULL;
+      mOldCapacity = 0;
+      mMigrateLeft = 0;
+   }
+}
+
+void _StringTable::finishMigration()
+{
+   while(mOldSlots)
+   {
+      mMigrateLeft = mOldCapacity;
+      migrateStep();
+   }
+}
+
+//--------------------------------------
+StringTableEntry _StringTable::insertHashed(const char *val, S32 len, U32 hash, bool caseSens)
+{
+   MutexHandle handle;
+   handle.lock(mMutex);
+
+   if(mOldSlots)
+   {
+      // anything matching this string has to move before we can add to
+      // the new table, or case insensitive matches could change
+      migrateRun(slotIndex(hash, mOldShift));
+      migrateStep();
+   }
+
+   StringTableEntry ret = mOldSlots ? find(mOldSlots, mOldCapacity, mOldShift, hash, val, len, caseSens) : NULL;
+   if(!ret)
+      ret = find(mSlots, mCapacity, mShift, hash, val, len, caseSens);
+   if(ret)
+      return ret;
+
+   char *str = (char *) mempool.alloc(len + 1);
+   dMemcpy(str, val, len);
+   str[len] = 0;
+   place(hash, str);
+   itemCount++;
+
+   if(itemCount * 2 > mCapacity)
+      resize(mCapacity * 2);
+   return str;
+}
+
+StringTableEntry _StringTable::insert(const char* val, const bool  caseSens)
+{
+   return insertHashed(val, dStrlen(val), hashString(val), caseSens);
 }
 
 //--------------------------------------
 StringTableEntry _StringTable::insertn(const char* src, S32 len, const bool  caseSens)
 {
-   char val[256];
    AssertFatal(len < 255, "Invalid string to insertn");
-   dStrncpy(val, src, len);
-   val[len] = 0;
-   return insert(val, caseSens);
+   S32 realLen = 0;
+   while(realLen < len && src[realLen])
+      realLen++;
+   return insertHashed(src, realLen, hashStringn(src, realLen), caseSens);
 }
 
 //--------------------------------------
 StringTableEntry _StringTable::lookup(const char* val, const bool  caseSens)
 {
-   Node **walk, *temp;
-   U32 key = hashString(val);
-   walk = &buckets[key % numBuckets];
-   while((temp = *walk) != NULL)   {
-      if(caseSens && !dStrcmp(temp->val, val))
-            return temp->val;
-      else if(!caseSens && !dStricmp(temp->val, val))
-         return temp->val;
-      walk = &(temp->next);
-   }
-   return NULL;
+   return lookupn(val, dStrlen(val), caseSens);
 }
 
 //--------------------------------------
 StringTableEntry _StringTable::lookupn(const char* val, S32 len, const bool  caseSens)
 {
-   Node **walk, *temp;
-   U32 key = hashStringn(val, len);
-   walk = &buckets[key % numBuckets];
-   while((temp = *walk) != NULL) {
-      if(caseSens && !dStrncmp(temp->val, val, len) && temp->val[len] == 0)
-         return temp->val;
-      else if(!caseSens && !dStrnicmp(temp->val, val, len) && temp->val[len] == 0)
-         return temp->val;
-      walk = &(temp->next);
-   }
-   return NULL;
+   S32 realLen = 0;
+   while(realLen < len && val[realLen])
+      realLen++;
+   U32 hash = hashStringn(val, realLen);
+
+   MutexHandle handle;
+   handle.lock(mMutex);
+
+   // old table first, it holds the earlier inserts
+   StringTableEntry ret = mOldSlots ? find(mOldSlots, mOldCapacity, mOldShift, hash, val, realLen, caseSens) : NULL;
+   if(!ret)
+      ret = find(mSlots, mCapacity, mShift, hash, val, realLen, caseSens);
+   return ret;
 }
 
 //--------------------------------------
 void _StringTable::resize(const U32 newSize)
 {
-   Node *head = NULL, *walk, *temp;
-   U32 i;
-   // reverse individual bucket lists
-   // we do this because new strings are added at the end of bucket
-   // lists so that case sens strings are always after their
-   // corresponding case insens strings
-
-   for(i = 0; i < numBuckets; i++) {
-      walk = buckets[i];
-      while(walk)
-      {
-         temp = walk->next;
-         walk->next = head;
-         head = walk;
-         walk = temp;
-      }
-   }
-   buckets = (Node **) dRealloc(buckets, newSize * sizeof(Node));
-   for(i = 0; i < newSize; i++) {
-      buckets[i] = 0;
-   }
-   numBuckets = newSize;
-   walk = head;
-   while(walk) {
-      U32 key;
-      Node *temp = walk;
-
-      walk = walk->next;
-      key = hashString(temp->val);
-      temp->next = buckets[key % newSize];
-      buckets[key % newSize] = temp;
-   }
-}
+   MutexHandle handle;
+   handle.lock(mMutex);
+
+   // one migration at a time
+   finishMigration();
+
+   U32 capacity = getNextPow2(getMax(newSize, U32(2)));
+   if(capacity <= mCapacity)
+      return;
 
+   mOldSlots = mSlots;
+   mOldCapacity = mCapacity;
+   mOldShift = mShift;
+   mOldCount = itemCount;
+
+   mCapacity = capacity;
+   mShift = 32 - getBinLog2(mCapacity);
+   mSlots = (Slot *) dMalloc(mCapacity * sizeof(Slot));
+   dMemset(mSlots, 0, mCapacity * sizeof(Slot));
+
+   // sweep from an empty slot so the sweep only ever sees whole runs
+   mMigrateIndex = 0;
+   while(mOldSlots[mMigrateIndex].val)
+      mMigrateIndex++;
+   mMigrateLeft = mOldCapacity;
+   if(!mOldCount)
+      finishMigration();
+}
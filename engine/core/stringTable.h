@@ -62,17 +62,45 @@ private:
    /// @name Implementation details
    /// @{
 
-   /// This is internal to the _StringTable class.
-   struct Node
+   /// The table is open addressed with linear probing.  Each slot keeps
+   /// the string's case insensitive hash next to the pointer, so probes
+   /// only touch string memory on a likely match.
+   ///
+   /// Growing allocates a bigger table and migrates a few runs of the old
+   /// one on every insert rather than rehashing everything at once.  An
+   /// insert first moves the old run its string hashes to; since runs
+   /// move whole and in order, strings that differ only by case keep
+   /// their insertion order, which is what case insensitive matches
+   /// depend on.
+   struct Slot
    {
-      char *val;
-      Node *next;
+      U32   hash;
+      char *val;     ///< NULL if the slot is empty.
    };
 
-   Node**      buckets;
-   U32         numBuckets;
+   Slot*       mSlots;
+   U32         mCapacity;        ///< Always a power of two.
+   U32         mShift;           ///< 32 - log2(mCapacity)
    U32         itemCount;
+
+   Slot*       mOldSlots;        ///< Table being migrated from, or NULL.
+   U32         mOldCapacity;
+   U32         mOldShift;
+   U32         mOldCount;        ///< Strings still in mOldSlots.
+   U32         mMigrateIndex;    ///< Next old slot the background sweep visits.
+   U32         mMigrateLeft;     ///< Old slots left to sweep.
+
    DataChunker mempool;
+   void*       mMutex;           ///< Inserts and lookups may come from loader threads.
+
+   static U32 slotIndex(U32 hash, U32 shift) { return (hash * 2654435761U) >> shift; }
+
+   StringTableEntry find(Slot *slots, U32 capacity, U32 shift, U32 hash, const char *val, S32 len, bool caseSens);
+   void place(U32 hash, char *val);
+   void migrateRun(U32 index);
+   void migrateStep();
+   void finishMigration();
+   StringTableEntry insertHashed(const char *val, S32 len, U32 hash, bool caseSens);
 
   protected:
    static const U32 csm_stInitSize;
@@ -128,6 +156,8 @@ private:
    /// is called automatically by the StringTable when the table is
    /// full past a certain threshhold.
    ///
+   /// The strings are moved over incrementally by later inserts.
+   ///
    /// @param newSize   Number of new items to allocate space for.
    void             resize(const U32 newSize);
 
@@ -0,0 +1,158 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _TRINGBUFFER_H_
+#define _TRINGBUFFER_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _PLATFORMATOMIC_H_
+#include "platform/platformAtomic.h"
+#endif
+
+/// Fixed size lock-free queue with a single producer and a single consumer.
+///
+/// One thread may call push() and one other thread may call pop(); neither
+/// ever blocks.  push() fails when the queue is full, so the producer decides
+/// whether to drop, retry or fall back to something else.
+///
+/// Size must be a power of two.  Elements are copied in and out, so T is
+/// usually a pointer or a small struct.
+///
+/// @code
+///   SPSCQueue<Request*, 64> queue;
+///
+///   // producer thread
+///   if(!queue.push(req))
+///      ...
+///
+///   // consumer thread
+///   Request *req;
+///   while(queue.pop(req))
+///      ...
+/// @endcode
+template<class T, U32 Size>
+class SPSCQueue
+{
+   enum { Mask = Size - 1 };
+
+   T mBuffer[Size];
+
+   /// Free running counters; only the producer writes mTail and only the
+   /// consumer writes mHead.  They're kept apart so the two threads don't
+   /// fight over one cache line.
+   volatile U32 mHead;
+   U8           mPad[60];
+   volatile U32 mTail;
+
+  public:
+   SPSCQueue() : mHead(0), mTail(0)
+   {
+      AssertFatal((Size & Mask) == 0, "SPSCQueue: size must be a power of two.");
+   }
+
+   /// Producer side; returns false if the queue is full.
+   bool push(const T &item)
+   {
+      U32 tail = mTail;
+      if(tail - dAtomicRead(mHead) == Size)
+         return false;
+      mBuffer[tail & Mask] = item;
+      dAtomicWrite(mTail, tail + 1);
+      return true;
+   }
+
+   /// Consumer side; returns false if the queue is empty.
+   bool pop(T &item)
+   {
+      U32 head = mHead;
+      if(dAtomicRead(mTail) == head)
+         return false;
+      item = mBuffer[head & Mask];
+      dAtomicWrite(mHead, head + 1);
+      return true;
+   }
+
+   /// Only exact when called from the producer or consumer with the other idle.
+   bool isEmpty() const { return dAtomicRead(mTail) == dAtomicRead(mHead); }
+};
+
+/// Fixed size lock-free queue with any number of producers and a single
+/// consumer.
+///
+/// Producers claim a slot with a compare-and-swap on the tail and then
+/// publish it through the slot's sequence number, so a producer that is
+/// preempted mid-push only holds up the consumer at that slot, it never
+/// blocks the other producers.  Interface and restrictions are the same as
+/// SPSCQueue.
+template<class T, U32 Size>
+class MPSCQueue
+{
+   enum { Mask = Size - 1 };
+
+   struct Cell
+   {
+      /// Equals the push index when the cell is free and push index + 1
+      /// once the item has been written.
+      volatile U32 sequence;
+      T            item;
+   };
+
+   Cell mBuffer[Size];
+
+   volatile U32 mHead;
+   U8           mPad[60];
+   volatile U32 mTail;
+
+  public:
+   MPSCQueue() : mHead(0), mTail(0)
+   {
+      AssertFatal((Size & Mask) == 0, "MPSCQueue: size must be a power of two.");
+      for(U32 i = 0; i < Size; i++)
+         mBuffer[i].sequence = i;
+   }
+
+   /// Safe from any thread; returns false if the queue is full.
+   bool push(const T &item)
+   {
+      U32 pos = dAtomicRead(mTail);
+      Cell *cell;
+      for(;;)
+      {
+         cell = &mBuffer[pos & Mask];
+         S32 diff = S32(dAtomicRead(cell->sequence) - pos);
+         if(diff == 0)
+         {
+            if(dCompareAndSwap(mTail, pos, pos + 1))
+               break;
+            pos = dAtomicRead(mTail);
+         }
+         else if(diff < 0)
+            return false;
+         else
+            pos = dAtomicRead(mTail);
+      }
+      cell->item = item;
+      dAtomicWrite(cell->sequence, pos + 1);
+      return true;
+   }
+
+   /// Consumer side; returns false if the queue is empty or the next item
+   /// is still being written.
+   bool pop(T &item)
+   {
+      U32 pos = mHead;
+      Cell *cell = &mBuffer[pos & Mask];
+      if(dAtomicRead(cell->sequence) != pos + 1)
+         return false;
+      item = cell->item;
+      dAtomicWrite(cell->sequence, pos + Size);
+      mHead = pos + 1;
+      return true;
+   }
+};
+
+#endif
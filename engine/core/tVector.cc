@@ -5,16 +5,28 @@
 
 #include "core/tVector.h"
 
+/// Number of elements to make room for when a vector of aSize needs
+/// newCount: at least VectorGrowthDivisor's share more than it had when
+/// growing, rounded up to whole blocks.
+static U32 vectorCapacity(U32 aSize, U32 newCount)
+{
+   U32 want = newCount;
+   if (newCount > aSize && want < aSize + aSize / VectorGrowthDivisor)
+      want = aSize + aSize / VectorGrowthDivisor;
+   U32 blocks = want / VectorBlockSize;
+   if (want % VectorBlockSize)
+      blocks++;
+   return blocks * VectorBlockSize;
+}
+
 #ifdef TORQUE_DEBUG_GUARD
 bool VectorResize(U32 *aSize, U32 *aCount, void **arrayPtr, U32 newCount, U32 elemSize,
                   const char* fileName,
                   const U32   lineNum)
 {
    if (newCount > 0) {
-      U32 blocks = newCount / VectorBlockSize;
-      if (newCount % VectorBlockSize)
-         blocks++;
-      S32 mem_size = blocks * VectorBlockSize * elemSize;
+      U32 capacity = vectorCapacity(*aSize, newCount);
+      S32 mem_size = capacity * elemSize;
 
       if (*arrayPtr != NULL)
       {
@@ -28,7 +40,7 @@ bool VectorResize(U32 *aSize, U32 *aCount, void **arrayPtr, U32 newCount, U32 el
       }
 
       *aCount = newCount;
-      *aSize = blocks * VectorBlockSize;
+      *aSize = capacity;
       return true;
    }
 
@@ -48,15 +60,13 @@ bool VectorResize(U32 *aSize, U32 *aCount, void **arrayPtr, U32 newCount, U32 el
 {
    if (newCount > 0)
    {
-      U32 blocks = newCount / VectorBlockSize;
-      if (newCount % VectorBlockSize)
-         blocks++;
-      S32 mem_size = blocks * VectorBlockSize * elemSize;
+      U32 capacity = vectorCapacity(*aSize, newCount);
+      S32 mem_size = capacity * elemSize;
       *arrayPtr = *arrayPtr ? dRealloc(*arrayPtr,mem_size) :
          dMalloc(mem_size);
 
       *aCount = newCount;
-      *aSize = blocks * VectorBlockSize;
+      *aSize = capacity;
       return true;
    }
 
@@ -18,6 +18,11 @@
 /// Size of memory blocks to allocate at a time for vectors.
 #define VectorBlockSize 16
 
+/// A vector that has to grow gets at least this much more room, as a
+/// fraction of what it had (1/VectorGrowthDivisor), so push_back()ing n
+/// elements one at a time reallocates O(log n) times rather than n/16.
+#define VectorGrowthDivisor 2
+
 #ifdef TORQUE_DEBUG_GUARD
 extern bool VectorResize(U32 *aSize, U32 *aCount, void **arrayPtr, U32 newCount, U32 elemSize,
                          const char* fileName,
@@ -49,8 +54,10 @@ extern bool VectorResize(U32 *aSize, U32 *aCount, void **arrayPtr, U32 newCount,
 /// it's elements.  This means don't use this template for elements
 /// (classes) that need these operations.  This template is intended
 /// to be used for simple structures that have no constructors or
-/// destructors.
+/// destructors.  Elements are relocated with a plain memory copy
+/// when the array grows.
 ///
+/// @see SmallVector
 /// @nosubgrouping
 template<class T>
 class Vector
@@ -59,6 +66,7 @@ class Vector
    U32 mElementCount;
    U32 mArraySize;
    T*  mArray;
+   bool mInlineArray;   ///< mArray is a SmallVector's own storage, not a heap block.
 
 #ifdef TORQUE_DEBUG_GUARD
    const char* mFileAssociation;
@@ -145,6 +153,17 @@ class Vector
 
    void set(void * addr, U32 sz);
 
+   /// Append count elements, growing the array at most once.
+   void append(const T* array, U32 count);
+
+   /// Is the vector still using a SmallVector's inline storage?
+   bool isInline() const { return mInlineArray; }
+
+   /// Exchange contents, storage and all, with another vector.  Nothing
+   /// is copied or allocated, unless one of them is using a SmallVector's
+   /// inline storage, which can't change hands.
+   void swap(Vector& p);
+
    /// Merge another vector into this one.
    ///
    /// @author BJW 8/20/97
@@ -155,7 +174,8 @@ class Vector
 
 template<class T> inline Vector<T>::~Vector()
 {
-   dFree(mArray);
+   if (!mInlineArray)
+      dFree(mArray);
 }
 
 template<class T> inline Vector<T>::Vector(const U32 initialSize)
@@ -168,6 +188,7 @@ template<class T> inline Vector<T>::Vector(const U32 initialSize)
    mArray        = 0;
    mElementCount = 0;
    mArraySize    = 0;
+   mInlineArray  = false;
    if(initialSize)
       reserve(initialSize);
 }
@@ -187,6 +208,7 @@ template<class T> inline Vector<T>::Vector(const U32 initialSize,
    mArray        = 0;
    mElementCount = 0;
    mArraySize    = 0;
+   mInlineArray  = false;
    if(initialSize)
       reserve(initialSize);
 }
@@ -205,6 +227,7 @@ template<class T> inline Vector<T>::Vector(const char* fileName,
    mArray        = 0;
    mElementCount = 0;
    mArraySize    = 0;
+   mInlineArray  = false;
 }
 
 template<class T> inline Vector<T>::Vector(const Vector& p)
@@ -215,6 +238,9 @@ template<class T> inline Vector<T>::Vector(const Vector& p)
 #endif
 
    mArray = 0;
+   mElementCount = 0;
+   mArraySize = 0;
+   mInlineArray = false;
    resize(p.mElementCount);
    if (p.mElementCount)
       dMemcpy(mArray,p.mArray,mElementCount * sizeof(value_type));
@@ -323,6 +349,29 @@ template<class T> inline void Vector<T>::compact()
    resize(mElementCount);
 }
 
+template<class T> inline void Vector<T>::swap(Vector<T>& p)
+{
+   if (mInlineArray || p.mInlineArray)
+   {
+      Vector<T> temp(*this);
+      *this = p;
+      p = temp;
+      return;
+   }
+
+   U32 count = mElementCount;
+   U32 size = mArraySize;
+   T*  array = mArray;
+
+   mElementCount = p.mElementCount;
+   mArraySize = p.mArraySize;
+   mArray = p.mArray;
+
+   p.mElementCount = count;
+   p.mArraySize = size;
+   p.mArray = array;
+}
+
 
 //-----------------------------------------------------------------------------
 
@@ -457,29 +506,89 @@ template<class T> inline void Vector<T>::set(void * addr, U32 sz)
       dMemcpy(address(),addr,sz*sizeof(T));
 }
 
+template<class T> inline void Vector<T>::append(const T* array, U32 count)
+{
+   if (count) {
+      U32 oldsize = mElementCount;
+      increment(count);
+      dMemcpy(&mArray[oldsize], array, count * sizeof(T));
+   }
+}
+
 //-----------------------------------------------------------------------------
 
 template<class T> inline bool Vector<T>::resize(U32 ecount)
 {
+   T* inlineArray = NULL;
+   // increment() raises mElementCount before calling us, so only what fits
+   // in the old storage is really there.
+   U32 count = getMin(mElementCount, mArraySize);
+   if (mInlineArray) {
+      if (ecount <= mArraySize) {
+         mElementCount = ecount;
+         return true;
+      }
+      // Outgrown the inline storage, move to the heap.
+      inlineArray = mArray;
+      mArray = NULL;
+      mInlineArray = false;
+   }
+
 #ifdef TORQUE_DEBUG_GUARD
-   return VectorResize(&mArraySize, &mElementCount, (void**) &mArray, ecount, sizeof(T),
-                       mFileAssociation, mLineAssociation);
+   bool ret = VectorResize(&mArraySize, &mElementCount, (void**) &mArray, ecount, sizeof(T),
+                           mFileAssociation, mLineAssociation);
 #else
-   return VectorResize(&mArraySize, &mElementCount, (void**) &mArray, ecount, sizeof(T));
+   bool ret = VectorResize(&mArraySize, &mElementCount, (void**) &mArray, ecount, sizeof(T));
 #endif
+
+   if (inlineArray && count)
+      dMemcpy(mArray, inlineArray, count * sizeof(T));
+   return ret;
 }
 
 // BJW 8/20/97
 // code to merge a vector into this one
 template<class T> inline void Vector<T>::merge(const Vector& p)
 {
-   if (p.size()) {
-      S32 oldsize = size();
-      resize(oldsize + p.size());
-      dMemcpy( &mArray[oldsize], p.address(), p.size() * sizeof(T) );
-   }
+   append(p.address(), p.size());
 }
 
+//-----------------------------------------------------------------------------
+/// A Vector with room for N elements inside it.
+///
+/// Until it holds more than N elements a SmallVector never touches the
+/// heap, which makes it the thing for short lived lists that are usually
+/// small, like the ones built on the stack for each query or frame.  Past
+/// N it moves to the heap and grows like any other Vector.  It is a
+/// Vector, so it can be passed to anything that takes one; just keep in
+/// mind that swap()ing it while it's inline copies the elements.
+///
+/// @code
+///   SmallVector<SceneRenderImage*, 64> images;
+/// @endcode
+template<class T, U32 N>
+class SmallVector : public Vector<T>
+{
+   T mInlineStorage[N];
+
+   void useInlineStorage()
+   {
+      this->mArray = mInlineStorage;
+      this->mArraySize = N;
+      this->mInlineArray = true;
+   }
+
+  public:
+   SmallVector()                                      { useInlineStorage(); }
+   SmallVector(const char* fileName, const U32 lineNum)
+      : Vector<T>(fileName, lineNum)                  { useInlineStorage(); }
+   SmallVector(const SmallVector& p)                  { useInlineStorage(); Vector<T>::operator=(p); }
+   SmallVector(const Vector<T>& p)                    { useInlineStorage(); Vector<T>::operator=(p); }
+
+   SmallVector& operator=(const SmallVector& p)       { Vector<T>::operator=(p); return *this; }
+   SmallVector& operator=(const Vector<T>& p)         { Vector<T>::operator=(p); return *this; }
+};
+
 //-----------------------------------------------------------------------------
 /// Template for vectors of pointers.
 template <class T>
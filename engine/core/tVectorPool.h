@@ -0,0 +1,105 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _TVECTORPOOL_H_
+#define _TVECTORPOOL_H_
+
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+#ifndef _PLATFORMTHREAD_H_
+#include "platform/platformThread.h"
+#endif
+
+/// Per-thread pool of Vector storage for short lived objects.
+///
+/// Query objects like ClippedPolyList are usually built on the stack, used
+/// once and thrown away, which used to mean allocating and freeing each of
+/// their Vectors every time.  Instead they acquire() their Vectors'
+/// storage when they're constructed and release() it, emptied but with its
+/// capacity, when they're destroyed.  Once a thread's pool has seen its
+/// busiest query, the same buffers go round and round without touching the
+/// heap.
+///
+/// Each thread has a pool of its own, so worker threads need no locking.
+/// Buffers are swapped in and out with Vector::swap(), so a Vector that
+/// acquires should be empty and unreserved, and T follows Vector's rules.
+/// A SmallVector's inline storage is never taken into the pool.
+///
+/// @code
+///   ClippedPolyList::ClippedPolyList()
+///   {
+///      VectorPool<ClippedPolyList::Vertex>::acquire(mVertexList);
+///   }
+///   ClippedPolyList::~ClippedPolyList()
+///   {
+///      VectorPool<ClippedPolyList::Vertex>::release(mVertexList);
+///   }
+/// @endcode
+template<class T>
+class VectorPool
+{
+   struct Node
+   {
+      Vector<T> vector;
+      Node*     next;
+   };
+
+   /// Nodes holding a buffer, and nodes kept for buffers yet to come back.
+   struct Pool
+   {
+      Node* full;
+      Node* empty;
+   };
+
+   static ThreadStorage smPool;
+
+   static Pool* getPool()
+   {
+      Pool* pool = (Pool*) smPool.get();
+      if (!pool) {
+         pool = new Pool;
+         pool->full = pool->empty = NULL;
+         smPool.set(pool);
+      }
+      return pool;
+   }
+
+  public:
+   /// Gives vec the storage of a released vector, if there is one.
+   static void acquire(Vector<T>& vec)
+   {
+      Pool* pool = getPool();
+      Node* node = pool->full;
+      if (!node)
+         return;
+      pool->full = node->next;
+      vec.swap(node->vector);
+      node->next = pool->empty;
+      pool->empty = node;
+   }
+
+   /// Takes vec's storage back for the next acquire(), leaving vec empty.
+   static void release(Vector<T>& vec)
+   {
+      if (!vec.capacity() || vec.isInline())
+         return;
+
+      Pool* pool = getPool();
+      Node* node = pool->empty;
+      if (node)
+         pool->empty = node->next;
+      else
+         node = new Node;
+      vec.clear();
+      node->vector.swap(vec);
+      node->next = pool->full;
+      pool->full = node;
+   }
+};
+
+template<class T> ThreadStorage VectorPool<T>::smPool;
+
+#endif
@@ -7,6 +7,14 @@
 #include "math/mMath.h"
 #include "util/safeDelete.h"
 #include "platform/profiler.h"
+#include "dgl/dgl.h"
+
+#if defined(TORQUE_CPU_X86) && (defined(TORQUE_COMPILER_VISUALC) || defined(__SSE2__))
+#  define THEORA_USE_SSE2
+#  include <emmintrin.h>
+#endif
+
+extern bool sgDisableSubImage;
 
 //-----------------------------------------------------------------------------
 
@@ -158,11 +166,18 @@ void TheoraTexture::init()
    mTheoraFile = NULL;
    mTextureHandle = NULL;
    mMagicalTrevor.reset();
+
+   for(U32 i = 0; i < 3; i++)
+      mFrames[i] = NULL;
+   mFrameWidth = mFrameHeight = 0;
+   freeFrames();
+   mFrameMutex = Mutex::createMutex();
 }
 
 TheoraTexture::~TheoraTexture()
 {
    destroyTexture();
+   Mutex::destroyMutex(mFrameMutex);
 }
 
 // tears down anything the texture has
@@ -221,6 +236,7 @@ void TheoraTexture::destroyTexture(bool restartOgg)
 
    // Set us to a null state.
    mReady = false;
+   freeFrames();
 
    //SAFE_DELETE(mTextureHandle);
 }
@@ -494,14 +510,21 @@ bool TheoraTexture::parseHeaders()
 
 bool TheoraTexture::createVideoBuffers()
 {
-   // Set up our texture.
-   const GBitmap *bmp = new GBitmap(
-                        getMax((U32)mTheoraInfo.frame_width, (U32)mTheoraInfo.width),
-                        getMax((U32)mTheoraInfo.frame_height, (U32)mTheoraInfo.height),
-                        false, GBitmap::RGB);
+   // Set up our texture, the size of the picture; it's black until the
+   // first frame comes in.
+   mFrameWidth  = mTheoraInfo.frame_width;
+   mFrameHeight = mTheoraInfo.frame_height;
+
+   GBitmap *bmp = new GBitmap(mFrameWidth, mFrameHeight, false, GBitmap::RGB);
+   dMemset(bmp->getAddress(0, 0), 0, bmp->byteSize);
 
    mTextureHandle = new TextureHandle(NULL, bmp, true);
 
+   // and the frames the play thread converts into
+   freeFrames();
+   for(U32 i = 0; i < 3; i++)
+      mFrames[i] = (U8 *) dMalloc(mFrameWidth * mFrameHeight * 4);
+
    // generate yuv conversion lookup tables
    generateLookupTables();
    return true;
@@ -566,6 +589,77 @@ static S32 sAdjY[256];
 static U8  sClampBuff[1024];
 static U8* sClamp = sClampBuff + 384;
 
+
+/// Converts a row of 4:2:0 YUV to RGBA.
+static void convertRow_c(U8 *dst, const U8 *pY, const U8 *pU, const U8 *pV, U32 width)
+{
+   for(U32 x = 0; x < width; x++)
+   {
+      const S32 Y = sAdjY[pY[x]];
+      const U8 u = pU[x >> 1];
+      const U8 v = pV[x >> 1];
+      *dst++ = sClamp[Y + sAdjCrr[v]];
+      *dst++ = sClamp[Y - (sAdjCrg[v] + sAdjCbg[u])];
+      *dst++ = sClamp[Y + sAdjCbb[u]];
+      *dst++ = 0xFF;
+   }
+}
+
+#ifdef THEORA_USE_SSE2
+/// Same arithmetic as the tables, eight pixels at a time.
+static void convertRow_sse2(U8 *dst, const U8 *pY, const U8 *pU, const U8 *pV, U32 width)
+{
+   const __m128i zero     = _mm_setzero_si128();
+   const __m128i y16      = _mm_set1_epi16(16);
+   const __m128i c128     = _mm_set1_epi16(128);
+   const __m128i yScale   = _mm_set1_epi16(298);
+   // (coefficient, rounding) pairs for _mm_madd_epi16 against (c - 128, 1)
+   const __m128i crrScale = _mm_set1_epi32((128 << 16) | 409);
+   const __m128i crgScale = _mm_set1_epi32((128 << 16) | 208);
+   const __m128i cbgScale = _mm_set1_epi32((128 << 16) | 100);
+   const __m128i cbbScale = _mm_set1_epi32((128 << 16) | 516);
+   const __m128i one      = _mm_set1_epi16(1);
+   const __m128i alpha    = _mm_set1_epi8(-1);
+
+   U32 x = 0;
+   for(; x + 8 <= width; x += 8)
+   {
+      // (298 * (y - 16)) >> 8, from the high and low halves of the product
+      __m128i y = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(pY + x)), zero), y16);
+      __m128i yLo = _mm_mullo_epi16(y, yScale);
+      __m128i yHi = _mm_mulhi_epi16(y, yScale);
+      y = _mm_or_si128(_mm_slli_epi16(yHi, 8), _mm_srli_epi16(yLo, 8));
+
+      // (scale * (c - 128) + 128) >> 8 for the four chroma samples
+      __m128i u = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(*(const S32 *)(pU + (x >> 1))), zero), c128);
+      __m128i v = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(*(const S32 *)(pV + (x >> 1))), zero), c128);
+      u = _mm_unpacklo_epi16(u, one);
+      v = _mm_unpacklo_epi16(v, one);
+      __m128i crr = _mm_packs_epi32(_mm_srai_epi32(_mm_madd_epi16(v, crrScale), 8), zero);
+      __m128i cbb = _mm_packs_epi32(_mm_srai_epi32(_mm_madd_epi16(u, cbbScale), 8), zero);
+      __m128i cg  = _mm_add_epi16(_mm_packs_epi32(_mm_srai_epi32(_mm_madd_epi16(v, crgScale), 8), zero),
+                                  _mm_packs_epi32(_mm_srai_epi32(_mm_madd_epi16(u, cbgScale), 8), zero));
+
+      // each chroma sample covers two pixels
+      crr = _mm_unpacklo_epi16(crr, crr);
+      cbb = _mm_unpacklo_epi16(cbb, cbb);
+      cg  = _mm_unpacklo_epi16(cg, cg);
+
+      __m128i r = _mm_packus_epi16(_mm_add_epi16(y, crr), zero);
+      __m128i g = _mm_packus_epi16(_mm_sub_epi16(y, cg), zero);
+      __m128i b = _mm_packus_epi16(_mm_add_epi16(y, cbb), zero);
+
+      __m128i rg = _mm_unpacklo_epi8(r, g);
+      __m128i ba = _mm_unpacklo_epi8(b, alpha);
+      _mm_storeu_si128((__m128i *)(dst + x * 4),      _mm_unpacklo_epi16(rg, ba));
+      _mm_storeu_si128((__m128i *)(dst + x * 4 + 16), _mm_unpackhi_epi16(rg, ba));
+   }
+
+   if(x < width)
+      convertRow_c(dst + x * 4, pY + x, pU + (x >> 1), pV + (x >> 1), width - x);
+}
+#endif
+
 // precalculate adjusted YUV values for faster RGB conversion
 void TheoraTexture::generateLookupTables()
 {
@@ -588,63 +682,57 @@ void TheoraTexture::generateLookupTables()
    }
 }
 
-void TheoraTexture::drawFrame()
+void TheoraTexture::convertFrame()
 {
    yuv_buffer yuv;
 
    // decode a frame! (into yuv)
    theora_decode_YUVout(&mTheoraState, &yuv);
 
-   // get destination buffer (and 1 row offset)
-   GBitmap *bmp = mTextureHandle->getBitmap();
-   U8* dst0 = bmp->getAddress(0, 0);
-   U8 *dst1 = dst0 + bmp->getWidth() * bmp->bytesPerPixel;
+   // the picture is a frame_width x frame_height window into the planes
+   const U8 *pY = yuv.y + yuv.y_stride * mTheoraInfo.offset_y + mTheoraInfo.offset_x;
+   const U8 *pU = yuv.u + yuv.uv_stride * (mTheoraInfo.offset_y >> 1) + (mTheoraInfo.offset_x >> 1);
+   const U8 *pV = yuv.v + yuv.uv_stride * (mTheoraInfo.offset_y >> 1) + (mTheoraInfo.offset_x >> 1);
 
-   // find picture offset
-   const S32 pictOffset  = yuv.y_stride * mTheoraInfo.offset_y + mTheoraInfo.offset_x;
-
-   const U8 *pY0, *pY1, *pU, *pV;
+   void (*convertRow)(U8 *, const U8 *, const U8 *, const U8 *, U32) = convertRow_c;
+#ifdef THEORA_USE_SSE2
+   if(Platform::SystemInfo.processor.properties & CPU_PROP_SSE2)
+      convertRow = convertRow_sse2;
+#endif
 
-   for(S32 y = 0; y < yuv.y_height; y += 2)
+   U8 *dst = mFrames[mWriteFrame];
+   for(U32 y = 0; y < mFrameHeight; y++)
    {
-      // set pointers into yuv buffers (2 lines for y)
-      pY0 = yuv.y + pictOffset + y * (yuv.y_stride);
-      pY1 = yuv.y + pictOffset + (y | 1) * (yuv.y_stride);
-      pU = yuv.u + ((pictOffset + y * (yuv.uv_stride)) >> 1);
-      pV = yuv.v + ((pictOffset + y * (yuv.uv_stride)) >> 1);
+      const U32 uvOffset = (y >> 1) * yuv.uv_stride;
+      convertRow(dst, pY, pU + uvOffset, pV + uvOffset, mFrameWidth);
 
-      for(S32 x = 0; x < yuv.y_width; x += 2)
-      {
-         // convert a 2x2 block over
-
-         // speed up G conversion a very very small amount ;)
-         const S32 G = sAdjCrg[*pV] + sAdjCbg[*pU];
-
-         // pixel 0x0
-         *dst0++ = sClamp[sAdjY[*pY0] + sAdjCrr[*pV]];
-         *dst0++ = sClamp[sAdjY[*pY0] - G];
-         *dst0++ = sClamp[sAdjY[*pY0++] + sAdjCbb[*pU]];
-
-         // pixel 1x0
-         *dst0++ = sClamp[sAdjY[*pY0] + sAdjCrr[*pV]];
-         *dst0++ = sClamp[sAdjY[*pY0] - G];
-         *dst0++ = sClamp[sAdjY[*pY0++] + sAdjCbb[*pU]];
-
-         // pixel 0x1
-         *dst1++ = sClamp[sAdjY[*pY1] + sAdjCrr[*pV]];
-         *dst1++ = sClamp[sAdjY[*pY1] - G];
-         *dst1++ = sClamp[sAdjY[*pY1++] + sAdjCbb[*pU]];
-
-         // pixel 1x1
-         *dst1++ = sClamp[sAdjY[*pY1] + sAdjCrr[*pV++]];
-         *dst1++ = sClamp[sAdjY[*pY1] - G];
-         *dst1++ = sClamp[sAdjY[*pY1++] + sAdjCbb[*pU++]];
-      }
+      dst += mFrameWidth * 4;
+      pY  += yuv.y_stride;
+   }
+}
 
-      // shift the destination pointers a row (loop incs 2 at a time)
-      dst0 = dst1;
-      dst1 += bmp->getWidth() * bmp->bytesPerPixel;
+void TheoraTexture::presentFrame()
+{
+   MutexHandle handle;
+   handle.lock(mFrameMutex);
+
+   U32 frame = mReadyFrame;
+   mReadyFrame = mWriteFrame;
+   mWriteFrame = frame;
+   mReadySequence++;
+}
+
+void TheoraTexture::freeFrames()
+{
+   for(U32 i = 0; i < 3; i++)
+   {
+      dFree(mFrames[i]);
+      mFrames[i] = NULL;
    }
+   mWriteFrame = 0;
+   mReadyFrame = 1;
+   mUploadFrame = 2;
+   mReadySequence = mUploadSequence = 0;
 }
 
 bool TheoraTexture::play()
@@ -704,6 +792,10 @@ bool TheoraTexture::playLoop()
          isAudioActive = true;
       }
 
+      // convert the frame while there's time, then hand it over when it's due
+      if(fMoreVideo)
+         convertFrame();
+
       // if we're set for the next frame, sleep
       /*S32 t = (int)((double) 1000 * (dVBuffTime - getTheoraTime()));
       if(t>0)
@@ -716,7 +808,8 @@ bool TheoraTexture::playLoop()
       }
 
       // time to draw the frame!
-      drawFrame();
+      if(fMoreVideo)
+         presentFrame();
 
       // keep track of the last frame time
       dLastFrame = getTheoraTime();
@@ -954,7 +1047,7 @@ U32 TheoraTexture::getGLName()
 {
    if(mTextureHandle)
    {
-      mTextureHandle->refresh();
+      refresh();
       return mTextureHandle->getGLName();
    }
    return 0;
@@ -963,6 +1056,41 @@ U32 TheoraTexture::getGLName()
 // copies the newest texture data to openGL video memory
 void TheoraTexture::refresh()
 {
-   if(mTextureHandle)
+   if(!mTextureHandle || !mFrames[0])
+      return;
+
+   {
+      MutexHandle handle;
+      handle.lock(mFrameMutex);
+
+      // nothing new since the last upload
+      if(mReadySequence == mUploadSequence)
+         return;
+
+      U32 frame = mUploadFrame;
+      mUploadFrame = mReadyFrame;
+      mReadyFrame = frame;
+      mUploadSequence = mReadySequence;
+   }
+
+   const U8 *src = mFrames[mUploadFrame];
+   TextureObject *to = *mTextureHandle;
+   if(sgDisableSubImage || !to->texGLName)
+   {
+      // through the bitmap, the whole texture
+      GBitmap *bmp = mTextureHandle->getBitmap();
+      U8 *dst = bmp->getAddress(0, 0);
+      for(U32 i = 0; i < mFrameWidth * mFrameHeight; i++, src += 4, dst += 3)
+      {
+         dst[0] = src[0];
+         dst[1] = src[1];
+         dst[2] = src[2];
+      }
       mTextureHandle->refresh();
+      return;
+   }
+
+   // just the picture, into the corner of the padded texture
+   glBindTexture(GL_TEXTURE_2D, to->texGLName);
+   glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, mFrameWidth, mFrameHeight, GL_RGBA, GL_UNSIGNED_BYTE, src);
 }
@@ -88,8 +88,31 @@ private:
    /// function is responsible for making sure they're present and valid.
 	void generateLookupTables();
 	void destroyTexture(bool restartOgg = false);
-	
-	void drawFrame();
+
+   /// @name Frames
+   ///
+   /// The play thread converts each frame into one of three RGBA buffers
+   /// before it's due, and swaps it in as the ready one when it is.
+   /// refresh() swaps the ready one out and uploads it with
+   /// glTexSubImage2D, only when there's a new one, so neither side waits
+   /// on the other or sees a half written frame.
+   /// @{
+   U8*            mFrames[3];
+   U32            mFrameWidth;
+   U32            mFrameHeight;
+   U32            mWriteFrame;      ///< The play thread's.
+   U32            mReadyFrame;      ///< Newest converted, not uploaded yet.
+   U32            mUploadFrame;     ///< refresh()'s.
+   U32            mReadySequence;   ///< Bumped by presentFrame().
+   U32            mUploadSequence;  ///< mReadySequence when last uploaded.
+   void*          mFrameMutex;
+
+   /// Decodes the current frame into the write buffer.
+   void convertFrame();
+   /// Makes the write buffer the ready one.
+   void presentFrame();
+   void freeFrames();
+   /// @}
 
 	bool readyVideo(const F64 lastFrame, F64 &vBuffTime);
 	bool readyAudio();
@@ -0,0 +1,471 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "platform/platformThread.h"
+#include "platform/platformMutex.h"
+#include "platform/platformSemaphore.h"
+#include "platform/profiler.h"
+#include "console/console.h"
+#include "console/consoleTypes.h"
+#include "core/threadPool.h"
+
+ThreadPool* gThreadPool = NULL;
+S32 ThreadPool::smNumThreads = -1;
+
+//----------------------------------------------------------------------------
+
+/// Fixed size work-stealing deque (Chase & Lev).
+///
+/// The owning thread pushes and pops at the bottom; any other thread may
+/// steal from the top.  Only a pop racing a steal for the last item needs
+/// a compare-and-swap.
+class ThreadPoolQueue
+{
+   enum
+   {
+      Size = 1024,
+      Mask = Size - 1,
+   };
+
+   ThreadPool::WorkItem* mItems[Size];
+   volatile U32 mTop;
+   U8           mPad[60];
+   volatile U32 mBottom;
+
+  public:
+   ThreadPoolQueue() : mTop(0), mBottom(0) {}
+
+   /// Owner only; false if full.
+   bool push(ThreadPool::WorkItem* item)
+   {
+      U32 bottom = mBottom;
+      if (bottom - dAtomicRead(mTop) >= Size)
+         return false;
+      mItems[bottom & Mask] = item;
+      dAtomicWrite(mBottom, bottom + 1);
+      return true;
+   }
+
+   /// Owner only.
+   ThreadPool::WorkItem* pop()
+   {
+      U32 bottom = mBottom - 1;
+      mBottom = bottom;
+      dMemoryBarrier();
+      U32 top = mTop;
+
+      if (S32(bottom - top) < 0)
+      {
+         mBottom = top;
+         return NULL;
+      }
+
+      ThreadPool::WorkItem* item = mItems[bottom & Mask];
+      if (bottom != top)
+         return item;
+
+      // Last one; a thief may be after it too.
+      if (!dCompareAndSwap(mTop, top, top + 1))
+         item = NULL;
+      mBottom = top + 1;
+      return item;
+   }
+
+   /// Any thread.
+   ThreadPool::WorkItem* steal()
+   {
+      U32 top = dAtomicRead(mTop);
+      dMemoryBarrier();
+      U32 bottom = dAtomicRead(mBottom);
+      if (S32(bottom - top) <= 0)
+         return NULL;
+
+      ThreadPool::WorkItem* item = mItems[top & Mask];
+      if (!dCompareAndSwap(mTop, top, top + 1))
+         return NULL;
+      return item;
+   }
+};
+
+//----------------------------------------------------------------------------
+
+class ThreadPoolWorker : public Thread
+{
+   ThreadPool* mPool;
+   S32         mIndex;
+
+  public:
+   ThreadPoolWorker(ThreadPool* pool, S32 index) : Thread(0, 0, false)
+   {
+      mPool = pool;
+      mIndex = index;
+   }
+
+   void run(S32)
+   {
+      mPool->mQueueIndex.set((void*)(dsize_t)(mIndex + 1));
+
+      while (!mPool->mShuttingDown)
+      {
+         if (ThreadPool::WorkItem* item = mPool->findWork(mIndex))
+         {
+            mPool->runItem(item);
+            continue;
+         }
+
+         // Say we're going to sleep before the last look, so anyone who
+         // queues something after it knows to wake us.
+         dFetchAndAdd(mPool->mNumSleeping, 1);
+         if (ThreadPool::WorkItem* item = mPool->findWork(mIndex))
+         {
+            dFetchAndAdd(mPool->mNumSleeping, U32(-1));
+            mPool->runItem(item);
+            continue;
+         }
+         Semaphore::acquireSemaphore(mPool->mWakeSemaphore);
+         dFetchAndAdd(mPool->mNumSleeping, U32(-1));
+      }
+   }
+};
+
+
+//----------------------------------------------------------------------------
+
+ThreadPool::ThreadPool()
+{
+   mNumShared = 0;
+   mNumSleeping = 0;
+   mShuttingDown = false;
+   mSharedMutex = Mutex::createMutex();
+   mWaitingMutex = Mutex::createMutex();
+   mWakeSemaphore = Semaphore::createSemaphore(0);
+   mQueues.push_back(new ThreadPoolQueue);
+}
+
+ThreadPool::~ThreadPool()
+{
+   AssertFatal(mAllItems.isDone(), "ThreadPool::~ThreadPool: destroyed with work still pending.");
+   stopWorkers();
+   for (U32 i = 0; i < mQueues.size(); i++)
+      delete mQueues[i];
+   Semaphore::destroySemaphore(mWakeSemaphore);
+   Mutex::destroyMutex(mWaitingMutex);
+   Mutex::destroyMutex(mSharedMutex);
+}
+
+void ThreadPool::create()
+{
+   AssertFatal(gThreadPool == NULL, "ThreadPool::create: already created.");
+   gThreadPool = new ThreadPool;
+   Con::addVariable("ThreadPool::numThreads", TypeS32, &smNumThreads);
+}
+
+void ThreadPool::destroy()
+{
+   // Background loads may still have jobs queued.
+   if (gThreadPool)
+      gThreadPool->waitForAllItems();
+   delete gThreadPool;
+   gThreadPool = NULL;
+}
+
+
+//----------------------------------------------------------------------------
+
+S32 ThreadPool::getDesiredThreads()
+{
+   if (smNumThreads >= 0)
+      return smNumThreads;
+   U32 numCores = Platform::SystemInfo.processor.numCores;
+   return numCores > 1 ? S32(numCores - 1) : 0;
+}
+
+void ThreadPool::startWorkers()
+{
+#ifdef TORQUE_MULTITHREAD
+   S32 numThreads = getDesiredThreads();
+   for (S32 i = 0; i < numThreads; i++)
+      mQueues.push_back(new ThreadPoolQueue);
+   for (S32 i = 0; i < numThreads; i++)
+   {
+      ThreadPoolWorker* worker = new ThreadPoolWorker(this, i + 1);
+      mWorkers.push_back(worker);
+      worker->start();
+   }
+#endif
+}
+
+void ThreadPool::stopWorkers()
+{
+   if (mWorkers.empty())
+      return;
+
+   // Wake everyone up with the shutdown flag set; the workers fall out of
+   // their run loop.
+   mShuttingDown = true;
+   for (U32 i = 0; i < mWorkers.size(); i++)
+      Semaphore::releaseSemaphore(mWakeSemaphore);
+   for (U32 i = 0; i < mWorkers.size(); i++)
+   {
+      mWorkers[i]->join();
+      delete mWorkers[i];
+   }
+   mWorkers.clear();
+   for (U32 i = 1; i < mQueues.size(); i++)
+      delete mQueues[i];
+   mQueues.setSize(1);
+   mShuttingDown = false;
+}
+
+bool ThreadPool::isThreaded()
+{
+#ifdef TORQUE_MULTITHREAD
+   return !mWorkers.empty() || getDesiredThreads() > 0;
+#else
+   return false;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+
+S32 ThreadPool::getQueueIndex()
+{
+   if (Con::isMainThread())
+      return 0;
+   return S32((dsize_t)mQueueIndex.get()) - 1;
+}
+
+void ThreadPool::wakeWorkers()
+{
+   // Pairs with the sleep announcement in ThreadPoolWorker::run(); the
+   // item must be visible before we look at the sleeper count.
+   dMemoryBarrier();
+   if (dAtomicRead(mNumSleeping))
+      Semaphore::releaseSemaphore(mWakeSemaphore);
+}
+
+void ThreadPool::submit(WorkItem* item)
+{
+   if (mWorkers.empty())
+   {
+      // Nobody to hand it to, just do it now.
+      runItem(item);
+      return;
+   }
+
+   S32 index = getQueueIndex();
+   if (index < 0 || !mQueues[index]->push(item))
+   {
+      Mutex::lockMutex(mSharedMutex);
+      mShared.push_back(item);
+      dFetchAndAdd(mNumShared, 1);
+      Mutex::unlockMutex(mSharedMutex);
+   }
+   wakeWorkers();
+}
+
+ThreadPool::WorkItem* ThreadPool::findWork(S32 queueIndex)
+{
+   WorkItem* item = NULL;
+   if (queueIndex >= 0 && (item = mQueues[queueIndex]->pop()) != NULL)
+      return item;
+
+   if (dAtomicRead(mNumShared))
+   {
+      Mutex::lockMutex(mSharedMutex);
+      if (mShared.size())
+      {
+         item = mShared.last();
+         mShared.decrement();
+         dFetchAndAdd(mNumShared, U32(-1));
+      }
+      Mutex::unlockMutex(mSharedMutex);
+      if (item)
+         return item;
+   }
+
+   // Start with the next queue along so thieves spread out.
+   U32 numQueues = mQueues.size();
+   U32 start = queueIndex >= 0 ? queueIndex + 1 : 0;
+   for (U32 i = 0; i < numQueues; i++)
+   {
+      U32 victim = (start + i) % numQueues;
+      if (S32(victim) != queueIndex && (item = mQueues[victim]->steal()) != NULL)
+         return item;
+   }
+   return NULL;
+}
+
+void ThreadPool::runItem(WorkItem* item)
+{
+   // Grab this first, the owner may free the item as soon as it's signaled.
+   Counter* counter = item->mCounter;
+
+   PROFILE_START(ThreadPool_WorkItem);
+   item->process();
+   PROFILE_END();
+
+   if (counter)
+      signal(counter);
+   signal(&mAllItems);
+}
+
+void ThreadPool::signal(Counter* counter)
+{
+   // The owner may free or reuse the counter once isDone(), which holds off
+   // until mSignaling drops.  That has to be the last touch of it here.
+   dFetchAndAdd(counter->mSignaling, 1);
+   if (dFetchAndAdd(counter->mValue, U32(-1)) != 1)
+   {
+      dFetchAndAdd(counter->mSignaling, U32(-1));
+      return;
+   }
+
+   // Reached zero, release everything that was waiting on it.
+   Mutex::lockMutex(mWaitingMutex);
+   WorkItem* waiting = counter->mWaiting;
+   counter->mWaiting = NULL;
+   Mutex::unlockMutex(mWaitingMutex);
+   dFetchAndAdd(counter->mSignaling, U32(-1));
+
+   while (waiting)
+   {
+      WorkItem* next = waiting->mNextWaiting;
+      waiting->mNextWaiting = NULL;
+      submit(waiting);
+      waiting = next;
+   }
+}
+
+void ThreadPool::queueWorkItem(WorkItem* item, Counter* counter)
+{
+   if (mWorkers.empty() && isThreaded())
+      startWorkers();
+
+   item->mCounter = counter;
+   if (counter)
+      dFetchAndAdd(counter->mValue, 1);
+   dFetchAndAdd(mAllItems.mValue, 1);
+
+   submit(item);
+}
+
+void ThreadPool::queueWorkItemAfter(WorkItem* item, Counter* dependency, Counter* counter)
+{
+   if (mWorkers.empty() && isThreaded())
+      startWorkers();
+
+   item->mCounter = counter;
+   if (counter)
+      dFetchAndAdd(counter->mValue, 1);
+   dFetchAndAdd(mAllItems.mValue, 1);
+
+   // Checking under the lock means signal() either sees us on the list or
+   // we see the count already at zero.  Only the count: once it's zero the
+   // list is, or is about to be, taken, mSignaling or not.
+   Mutex::lockMutex(mWaitingMutex);
+   bool ready = dAtomicRead(dependency->mValue) == 0;
+   if (!ready)
+   {
+      item->mNextWaiting = dependency->mWaiting;
+      dependency->mWaiting = item;
+   }
+   Mutex::unlockMutex(mWaitingMutex);
+
+   if (ready)
+      submit(item);
+}
+
+void ThreadPool::waitForCounter(Counter* counter)
+{
+   PROFILE_START(ThreadPool_Wait);
+
+   // Help out rather than sit idle.
+   S32 index = getQueueIndex();
+   while (!counter->isDone())
+   {
+      if (WorkItem* item = findWork(index))
+         runItem(item);
+      else
+         Platform::sleep(0);
+   }
+
+   PROFILE_END();
+}
+
+void ThreadPool::waitForAllItems()
+{
+   AssertFatal(Con::isMainThread(), "ThreadPool::waitForAllItems: may only be called from the main thread.");
+   waitForCounter(&mAllItems);
+}
+
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+struct ParallelForItem : public ThreadPool::WorkItem
+{
+   ThreadPool::ParallelForFn fn;
+   void* userData;
+   U32 start;
+   U32 end;
+
+   void process()
+   {
+      fn(start, end, userData);
+   }
+};
+
+}
+
+void ThreadPool::parallelFor(U32 count, ParallelForFn fn, void* userData, U32 minBatch)
+{
+   if (!count)
+      return;
+
+   if (mWorkers.empty() && isThreaded())
+      startWorkers();
+
+   // A few batches per thread so that one slow batch doesn't leave the
+   // others idle.
+   U32 numBatches = (mWorkers.size() + 1) * 4;
+   if (minBatch < 1)
+      minBatch = 1;
+   if (numBatches > (count + minBatch - 1) / minBatch)
+      numBatches = (count + minBatch - 1) / minBatch;
+   if (numBatches <= 1)
+   {
+      fn(0, count, userData);
+      return;
+   }
+
+   PROFILE_START(ThreadPool_ParallelFor);
+
+   U32 batchSize = (count + numBatches - 1) / numBatches;
+   Vector<ParallelForItem> items;
+   items.setSize(numBatches);
+
+   Counter counter;
+   U32 numItems = 0;
+   for (U32 start = 0; start < count; start += batchSize)
+   {
+      ParallelForItem& item = items[numItems++];
+      constructInPlace(&item);
+      item.fn = fn;
+      item.userData = userData;
+      item.start = start;
+      item.end = getMin(start + batchSize, count);
+      queueWorkItem(&item, &counter);
+   }
+   waitForCounter(&counter);
+
+   for (U32 i = 0; i < numItems; i++)
+      destructInPlace(&items[i]);
+
+   PROFILE_END();
+}
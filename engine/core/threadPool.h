@@ -0,0 +1,159 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _THREADPOOL_H_
+#define _THREADPOOL_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _PLATFORMATOMIC_H_
+#include "platform/platformAtomic.h"
+#endif
+#ifndef _PLATFORMTHREAD_H_
+#include "platform/platformThread.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+
+class ThreadPoolWorker;
+class ThreadPoolQueue;
+
+/// Engine wide job system with work-stealing worker threads.
+///
+/// Work is described by WorkItem subclasses.  The simplest use is fork/join
+/// from the main thread, e.g. ticking a set of unrelated objects:
+///
+/// @code
+///   ThreadPool::Counter done;
+///   for (U32 i = 0; i < numBatches; i++)
+///      gThreadPool->queueWorkItem(&batches[i], &done);
+///   gThreadPool->waitForCounter(&done);
+/// @endcode
+///
+/// A Counter counts its items still to run and can be waited on by itself,
+/// from any thread and from inside other items.  Always wait on your own
+/// counter: the pool also carries long background jobs (texture decodes,
+/// terrain blends, path searches) that a barrier mustn't wait for.  An item can also be held back until a counter reaches zero with
+/// queueWorkItemAfter(), which is how dependency chains are built.  For
+/// loops over independent elements there is parallelFor().
+///
+/// Every worker and the main thread has its own queue.  Items queued from a
+/// worker (or the main thread) go to the front of its own queue, and idle
+/// threads steal from the back of the others, so the system balances itself
+/// without a shared lock.  Any thread that waits keeps running items rather
+/// than blocking.  Items queued from other threads go on a shared list.
+///
+/// The pool never takes ownership of the work items, so they can live on
+/// the stack or in a Vector for as long as they are pending.
+///
+/// Worker threads are started lazily the first time work is queued, using
+/// the $ThreadPool::numThreads console variable; the default of -1 means one
+/// fewer than Platform::SystemInfo.processor.numCores.  If TORQUE_MULTITHREAD
+/// is not defined, or the pool was configured with no threads, the items are
+/// simply processed on the calling thread when they are queued.
+class ThreadPool
+{
+   friend class ThreadPoolWorker;
+
+  public:
+   struct WorkItem;
+
+   /// Number of items still to run.  Zero when idle; safe to reuse or free
+   /// then.
+   struct Counter
+   {
+      volatile U32 mValue;
+      volatile U32 mSignaling;  ///< Signals in progress, see ThreadPool::signal().
+      WorkItem*    mWaiting;    ///< Held by queueWorkItemAfter(), guarded by the pool.
+
+      Counter() : mValue(0), mSignaling(0), mWaiting(NULL) {}
+
+      /// mValue first: a signal that took it to zero is still counted in
+      /// mSignaling until it has stopped touching the counter.
+      bool isDone() const { return dAtomicRead(mValue) == 0 && dAtomicRead(mSignaling) == 0; }
+   };
+
+   /// A single unit of work.
+   struct WorkItem
+   {
+      Counter*  mCounter;       ///< Set by the pool, signaled when process() returns.
+      WorkItem* mNextWaiting;   ///< Link in a Counter's waiting list.
+
+      WorkItem() : mCounter(NULL), mNextWaiting(NULL) {}
+      virtual ~WorkItem() {}
+
+      /// Do the work. This is called from a worker thread, so it must
+      /// not touch anything that isn't safe to use concurrently.
+      virtual void process() = 0;
+   };
+
+   /// Callback for parallelFor(), handles elements [start, end).
+   typedef void (*ParallelForFn)(U32 start, U32 end, void* userData);
+
+  private:
+   Vector<ThreadPoolWorker*> mWorkers;
+   Vector<ThreadPoolQueue*>  mQueues;       ///< [0] is the main thread's, then one per worker.
+   ThreadStorage             mQueueIndex;   ///< Worker index + 1 on worker threads.
+
+   Vector<WorkItem*>         mShared;       ///< Items from other threads or overflow.
+   volatile U32              mNumShared;
+   void*                     mSharedMutex;
+   void*                     mWaitingMutex; ///< Guards Counter::mWaiting lists.
+
+   Counter                   mAllItems;     ///< Everything queued, drained by destroy().
+   volatile U32              mNumSleeping;
+   void*                     mWakeSemaphore;
+   volatile bool             mShuttingDown;
+
+   void startWorkers();
+   void stopWorkers();
+   S32  getDesiredThreads();
+
+   /// Own queue of the calling thread, or -1 if it doesn't have one.
+   S32  getQueueIndex();
+   void submit(WorkItem* item);
+   WorkItem* findWork(S32 queueIndex);
+   void runItem(WorkItem* item);
+   void signal(Counter* counter);
+   void wakeWorkers();
+
+   /// Runs items until everything queued has been processed.  Only for
+   /// shutdown, see destroy().
+   void waitForAllItems();
+
+  public:
+   /// Number of worker threads to spawn when the pool starts, -1 for one
+   /// per core after the first.
+   static S32 smNumThreads;
+
+   ThreadPool();
+   ~ThreadPool();
+
+   static void create();
+   static void destroy();
+
+   /// Returns true if queued work will really run concurrently.
+   bool isThreaded();
+   U32  getNumThreads() { return mWorkers.size(); }
+
+   /// Queue an item, counting it in counter if one is given.  Safe from any thread.
+   void queueWorkItem(WorkItem* item, Counter* counter = NULL);
+
+   /// Like queueWorkItem(), but the item doesn't start until dependency is done.
+   void queueWorkItemAfter(WorkItem* item, Counter* dependency, Counter* counter = NULL);
+
+   /// Runs queued items on the calling thread until counter reaches zero.
+   void waitForCounter(Counter* counter);
+
+   /// Calls fn over [0, count) in batches of at least minBatch elements
+   /// spread over the pool, and returns when they are all done.
+   void parallelFor(U32 count, ParallelForFn fn, void* userData, U32 minBatch = 1);
+};
+
+extern ThreadPool* gThreadPool;
+
+#endif
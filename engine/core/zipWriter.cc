@@ -0,0 +1,233 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "zlib.h"
+#include "core/zipWriter.h"
+#include "core/resManager.h"
+#include "console/console.h"
+
+static const char *csStoredExts[] =
+{
+   ".ogg", ".jpg", ".jpeg", ".png", ".gif", ".zip", ".gz", ".mp3"
+};
+
+//-----------------------------------------------------------------------------
+
+ZipWriter::ZipWriter()
+{
+   mOpen = false;
+   VECTOR_SET_ASSOCIATION(mEntries);
+   VECTOR_SET_ASSOCIATION(mNames);
+}
+
+ZipWriter::~ZipWriter()
+{
+   if(mOpen)
+      close();
+}
+
+bool ZipWriter::open(const char *fileName)
+{
+   AssertFatal(!mOpen, "ZipWriter::open: already open.");
+   if(!mStream.open(fileName, FileStream::Write))
+      return false;
+   mEntries.clear();
+   mNames.clear();
+   mOpen = true;
+   return true;
+}
+
+U32 ZipWriter::getMethodFor(const char *fileName)
+{
+   const char *ext = dStrrchr(fileName, '.');
+   if(ext)
+      for(U32 i = 0; i < sizeof(csStoredExts) / sizeof(csStoredExts[0]); i++)
+         if(!dStricmp(ext, csStoredExts[i]))
+            return Stored;
+   return Deflated;
+}
+
+//-----------------------------------------------------------------------------
+
+ZipWriter::Entry &ZipWriter::newEntry(const char *name, U16 method, U16 modTime, U16 modDate)
+{
+   U32 len = dStrlen(name);
+   mEntries.increment();
+   Entry &entry = mEntries.last();
+   entry.nameOffset  = mNames.size();
+   entry.nameLength  = U16(len);
+   entry.method      = method;
+   entry.modTime     = modTime;
+   entry.modDate     = modDate;
+   entry.localOffset = mStream.getPosition();
+
+   mNames.setSize(entry.nameOffset + len);
+   dMemcpy(mNames.address() + entry.nameOffset, name, len);
+   return entry;
+}
+
+void ZipWriter::writeLocalHeader(const Entry &entry)
+{
+   mStream.write(U32(0x04034b50));
+   mStream.write(U16(20));                // version to extract
+   mStream.write(U16(0));                 // flags
+   mStream.write(entry.method);
+   mStream.write(entry.modTime);
+   mStream.write(entry.modDate);
+   mStream.write(entry.crc);
+   mStream.write(entry.compressedSize);
+   mStream.write(entry.uncompressedSize);
+   mStream.write(entry.nameLength);
+   mStream.write(U16(0));                 // extra field
+   mStream.write(entry.nameLength, mNames.address() + entry.nameOffset);
+}
+
+bool ZipWriter::addFile(const char *name, const void *data, U32 size, U32 method,
+                        U16 modTime, U16 modDate)
+{
+   AssertFatal(mOpen, "ZipWriter::addFile: not open.");
+
+   U32 crc = crc32(0, (const Bytef *) data, size);
+
+   U8 *packed = NULL;
+   U32 packedSize = 0;
+   if(method == Deflated && size)
+   {
+      uLong bound = compressBound(size);
+      packed = new U8[bound];
+
+      z_stream zs;
+      dMemset(&zs, 0, sizeof(zs));
+      deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+      zs.next_in   = (Bytef *) data;
+      zs.avail_in  = size;
+      zs.next_out  = packed;
+      zs.avail_out = bound;
+      S32 ret = deflate(&zs, Z_FINISH);
+      packedSize = zs.total_out;
+      deflateEnd(&zs);
+
+      // Not worth an inflate on every read.
+      if(ret != Z_STREAM_END || packedSize >= size)
+      {
+         delete [] packed;
+         packed = NULL;
+      }
+   }
+
+   Entry &entry = newEntry(name, packed ? Deflated : Stored, modTime, modDate);
+   entry.crc              = crc;
+   entry.uncompressedSize = size;
+   entry.compressedSize   = packed ? packedSize : size;
+   writeLocalHeader(entry);
+
+   bool ok = mStream.write(entry.compressedSize, packed ? packed : data);
+   delete [] packed;
+   return ok;
+}
+
+bool ZipWriter::addRawEntry(const char *name, Stream &from, U32 method, U32 crc,
+                            U32 compressedSize, U32 uncompressedSize,
+                            U16 modTime, U16 modDate)
+{
+   AssertFatal(mOpen, "ZipWriter::addRawEntry: not open.");
+
+   Entry &entry = newEntry(name, U16(method), modTime, modDate);
+   entry.crc              = crc;
+   entry.compressedSize   = compressedSize;
+   entry.uncompressedSize = uncompressedSize;
+   writeLocalHeader(entry);
+
+   U8 buffer[16384];
+   U32 bytes = compressedSize;
+   while(bytes)
+   {
+      U32 chunk = getMin(bytes, U32(sizeof(buffer)));
+      if(!from.read(chunk, buffer) || !mStream.write(chunk, buffer))
+         return false;
+      bytes -= chunk;
+   }
+   return true;
+}
+
+bool ZipWriter::close()
+{
+   if(!mOpen)
+      return false;
+   mOpen = false;
+
+   U32 dirStart = mStream.getPosition();
+   for(U32 i = 0; i < mEntries.size(); i++)
+   {
+      const Entry &entry = mEntries[i];
+      mStream.write(U32(0x02014b50));
+      mStream.write(U16(20));             // version made by
+      mStream.write(U16(20));             // version to extract
+      mStream.write(U16(0));              // flags
+      mStream.write(entry.method);
+      mStream.write(entry.modTime);
+      mStream.write(entry.modDate);
+      mStream.write(entry.crc);
+      mStream.write(entry.compressedSize);
+      mStream.write(entry.uncompressedSize);
+      mStream.write(entry.nameLength);
+      mStream.write(U16(0));              // extra field
+      mStream.write(U16(0));              // comment
+      mStream.write(U16(0));              // disk number
+      mStream.write(U16(0));              // internal attributes
+      mStream.write(U32(0));              // external attributes
+      mStream.write(entry.localOffset);
+      mStream.write(entry.nameLength, mNames.address() + entry.nameOffset);
+   }
+   U32 dirSize = mStream.getPosition() - dirStart;
+
+   mStream.write(U32(0x06054b50));
+   mStream.write(U16(0));
+   mStream.write(U16(0));
+   mStream.write(U16(mEntries.size()));
+   mStream.write(U16(mEntries.size()));
+   mStream.write(dirSize);
+   mStream.write(dirStart);
+   mStream.write(U16(0));
+
+   bool ok = mStream.getStatus() == Stream::Ok;
+   mStream.close();
+   return ok;
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction(createZip, bool, 3, 0, "(string zipFile, string file, ...) - "
+                "Write the files to a new zip, stored if they're already compressed "
+                "(.ogg, .jpg, .png...) and deflated otherwise.")
+{
+   ZipWriter writer;
+   if(!writer.open(argv[1]))
+   {
+      Con::errorf("createZip: unable to write %s.", argv[1]);
+      return false;
+   }
+
+   for(S32 i = 2; i < argc; i++)
+   {
+      Stream *stream = ResourceManager->openStream(argv[i]);
+      if(!stream)
+      {
+         Con::warnf("createZip: unable to open %s.", argv[i]);
+         continue;
+      }
+
+      U32 size = stream->getStreamSize();
+      U8 *data = new U8[size ? size : 1];
+      bool ok = stream->read(size, data);
+      ResourceManager->closeStream(stream);
+
+      if(!ok || !writer.addFile(argv[i], data, size, ZipWriter::getMethodFor(argv[i])))
+         Con::warnf("createZip: error adding %s.", argv[i]);
+      delete [] data;
+   }
+
+   return writer.close();
+}
@@ -0,0 +1,84 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _ZIPWRITER_H_
+#define _ZIPWRITER_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+#ifndef _FILESTREAM_H_
+#include "core/fileStream.h"
+#endif
+
+/// Writes a zip file the ResManager can mount.
+///
+/// Entries are written in the order they're added, each with a plain local
+/// header (no data descriptor), and close() writes the central directory.
+/// Deflated entries that don't come out smaller are stored instead.
+///
+/// Files that are already compressed (getMethodFor()) gain nothing from
+/// deflate and cost an inflate every read, so the tools here store them
+/// and deflate the rest.
+class ZipWriter
+{
+  public:
+   enum Method
+   {
+      Stored   = 0,
+      Deflated = 8
+   };
+
+  private:
+   struct Entry
+   {
+      U32 nameOffset;      ///< Into mNames.
+      U16 nameLength;
+      U16 method;
+      U16 modTime;
+      U16 modDate;
+      U32 crc;
+      U32 compressedSize;
+      U32 uncompressedSize;
+      U32 localOffset;
+   };
+
+   FileStream    mStream;
+   Vector<Entry> mEntries;
+   Vector<char>  mNames;
+   bool          mOpen;
+
+   Entry &newEntry(const char *name, U16 method, U16 modTime, U16 modDate);
+   void writeLocalHeader(const Entry &entry);
+
+  public:
+   ZipWriter();
+   ~ZipWriter();
+
+   bool open(const char *fileName);
+
+   /// Writes the central directory and closes the file.
+   bool close();
+
+   /// Add a file from memory.
+   bool addFile(const char *name, const void *data, U32 size, U32 method,
+                U16 modTime = 0, U16 modDate = 0);
+
+   /// Copy an entry's data, already compressed with method, from another
+   /// zip stream positioned at the start of it.
+   bool addRawEntry(const char *name, Stream &from, U32 method, U32 crc,
+                    U32 compressedSize, U32 uncompressedSize,
+                    U16 modTime = 0, U16 modDate = 0);
+
+   U32 getNumEntries() const { return mEntries.size(); }
+
+   /// Stored for .ogg, .jpg, .png and the like, Deflated for everything else.
+   static U32 getMethodFor(const char *fileName);
+};
+
+#endif
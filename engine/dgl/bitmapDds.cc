@@ -0,0 +1,127 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "dgl/gBitmap.h"
+#include "core/stream.h"
+#include "platform/platform.h"
+
+// structures mirror those written by the DirectX texture tools
+
+struct DDSPIXELFORMAT {
+   U32 dwSize;
+   U32 dwFlags;
+   U32 dwFourCC;
+   U32 dwRGBBitCount;
+   U32 dwRBitMask;
+   U32 dwGBitMask;
+   U32 dwBBitMask;
+   U32 dwABitMask;
+};
+
+struct DDSHEADER {
+   U32 dwSize;
+   U32 dwFlags;
+   U32 dwHeight;
+   U32 dwWidth;
+   U32 dwPitchOrLinearSize;
+   U32 dwDepth;
+   U32 dwMipMapCount;
+   U32 dwReserved1[11];
+   DDSPIXELFORMAT ddspf;
+   U32 dwCaps;
+   U32 dwCaps2;
+   U32 dwCaps3;
+   U32 dwCaps4;
+   U32 dwReserved2;
+};
+
+#define DDS_MAGIC             0x20534444  // "DDS "
+#define DDS_MAKEFOURCC(a, b, c, d) (U32(a) | (U32(b) << 8) | (U32(c) << 16) | (U32(d) << 24))
+
+// dwFlags
+#define DDSD_MIPMAPCOUNT      0x00020000
+// ddspf.dwFlags
+#define DDPF_ALPHAPIXELS      0x00000001
+#define DDPF_FOURCC           0x00000004
+// dwCaps2
+#define DDSCAPS2_CUBEMAP      0x00000200
+#define DDSCAPS2_VOLUME       0x00200000
+
+
+//------------------------------------------------------------------------------
+//-------------------------------------- Supplimentary I/O
+//
+
+/// Reads a DXT1, DXT3 or DXT5 .dds file, with whatever mips it was saved
+/// with.  The blocks are kept as they are for glCompressedTexImage2DARB(),
+/// so only 2D pow2 textures are accepted.
+bool GBitmap::readDDS(Stream& stream)
+{
+   U32 magic;
+   stream.read(&magic);
+   if (magic != DDS_MAGIC)
+      return false;
+
+   DDSHEADER header;
+   stream.read(&header.dwSize);
+   stream.read(&header.dwFlags);
+   stream.read(&header.dwHeight);
+   stream.read(&header.dwWidth);
+   stream.read(&header.dwPitchOrLinearSize);
+   stream.read(&header.dwDepth);
+   stream.read(&header.dwMipMapCount);
+   for (U32 i = 0; i < 11; i++)
+      stream.read(&header.dwReserved1[i]);
+   stream.read(&header.ddspf.dwSize);
+   stream.read(&header.ddspf.dwFlags);
+   stream.read(&header.ddspf.dwFourCC);
+   stream.read(&header.ddspf.dwRGBBitCount);
+   stream.read(&header.ddspf.dwRBitMask);
+   stream.read(&header.ddspf.dwGBitMask);
+   stream.read(&header.ddspf.dwBBitMask);
+   stream.read(&header.ddspf.dwABitMask);
+   stream.read(&header.dwCaps);
+   stream.read(&header.dwCaps2);
+   stream.read(&header.dwCaps3);
+   stream.read(&header.dwCaps4);
+   stream.read(&header.dwReserved2);
+
+   if (stream.getStatus() != Stream::Ok ||
+       header.dwSize != 124 || header.ddspf.dwSize != 32)
+      return false;
+
+   // uncompressed, cube and volume files go through the regular formats
+   if (!(header.ddspf.dwFlags & DDPF_FOURCC) ||
+       (header.dwCaps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME)))
+      return false;
+
+   BitmapFormat fmt;
+   switch (header.ddspf.dwFourCC)
+   {
+      case DDS_MAKEFOURCC('D', 'X', 'T', '1'):
+         fmt = (header.ddspf.dwFlags & DDPF_ALPHAPIXELS) ? DXT1A : DXT1;
+         break;
+      case DDS_MAKEFOURCC('D', 'X', 'T', '3'):
+         fmt = DXT3;
+         break;
+      case DDS_MAKEFOURCC('D', 'X', 'T', '5'):
+         fmt = DXT5;
+         break;
+      default:
+         return false;
+   }
+
+   if (header.dwWidth == 0 || header.dwHeight == 0 ||
+       !isPow2(header.dwWidth) || !isPow2(header.dwHeight))
+      return false;
+
+   U32 numMips = 1;
+   if ((header.dwFlags & DDSD_MIPMAPCOUNT) && header.dwMipMapCount > 1)
+      numMips = header.dwMipMapCount;
+
+   // the levels are stored largest first, so any we don't keep are at the end
+   allocateCompressedBitmap(header.dwWidth, header.dwHeight, numMips, fmt);
+   return stream.read(byteSize, pBits);
+}
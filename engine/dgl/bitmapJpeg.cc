@@ -9,6 +9,7 @@
 #include "dgl/gPalette.h"
 #include "dgl/gBitmap.h"
 
+#include <setjmp.h>
 #include "jpeglib.h"
 
 U32 gJpegQuality = 90;
@@ -61,29 +62,58 @@ static int jpegErrorFn(void *client_data)
 }
 
 
+//-------------------------------------- The library reaches the stream
+//                                        through these; they're set once
+//                                        here rather than by each read and
+//                                        write, so they aren't written while
+//                                        another thread is decoding.
+static struct JpegStreamFns
+{
+   JpegStreamFns()
+   {
+      JFREAD  = jpegReadDataFn;
+      JFWRITE = jpegWriteDataFn;
+      JFFLUSH = jpegFlushDataFn;
+      JFERROR = jpegErrorFn;
+   }
+} sgJpegStreamFns;
+
+
+//-------------------------------------- The standard error_exit ends the
+//                                        process; jump back to the read or
+//                                        write that failed instead.
+struct JpegErrorMgr
+{
+   jpeg_error_mgr pub;
+   jmp_buf        jump;
+};
+
+static void jpegErrorExitFn(j_common_ptr cinfo)
+{
+   JpegErrorMgr *err = (JpegErrorMgr*)cinfo->err;
+   longjmp(err->jump, 1);
+}
+
+
 //--------------------------------------
 bool GBitmap::readJPEG(Stream &stream)
 {
-   JFREAD  = jpegReadDataFn;
-   JFERROR = jpegErrorFn;
-
    jpeg_decompress_struct cinfo;
-   jpeg_error_mgr jerr;
+   JpegErrorMgr jerr;
 
    // We set up the normal JPEG error routines, then override error_exit.
-   //cinfo.err = jpeg_std_error(&jerr.pub);
-   //jerr.pub.error_exit = my_error_exit;
-
-   // if (setjmp(jerr.setjmp_buffer))
-   // {
-   //    // If we get here, the JPEG code has signaled an error.
-   //    // We need to clean up the JPEG object, close the input file, and return.
-   //    jpeg_destroy_decompress(&cinfo);
-   //    return false;
-   // }
+   cinfo.err = jpeg_std_error(&jerr.pub);
+   jerr.pub.error_exit = jpegErrorExitFn;
 
+   if (setjmp(jerr.jump))
+   {
+      // If we get here, the JPEG code has signaled an error.
+      // We need to clean up the JPEG object and return.
+      jpeg_destroy_decompress(&cinfo);
+      deleteImage();
+      return false;
+   }
 
-   cinfo.err = jpeg_std_error(&jerr);    // set up the normal JPEG error routines.
    cinfo.client_data = (void*)&stream;       // set the stream into the client_data
 
    // Now we can initialize the JPEG decompression object.
@@ -148,17 +178,19 @@ bool GBitmap::writeJPEG(Stream& stream) const
    if (height >= MAX_HEIGHT)
       return false;
 
-   // Bind our own stream writing, error, and memory flush functions
-   // to the jpeg library interface
-   JFWRITE = jpegWriteDataFn;
-   JFFLUSH = jpegFlushDataFn;
-   JFERROR = jpegErrorFn;
-
    // Allocate and initialize our jpeg compression structure and error manager
    jpeg_compress_struct cinfo;
-   jpeg_error_mgr jerr;
+   JpegErrorMgr jerr;
+
+   cinfo.err = jpeg_std_error(&jerr.pub);   // set up the normal JPEG error routines,
+   jerr.pub.error_exit = jpegErrorExitFn;   // but come back here on errors.
+
+   if (setjmp(jerr.jump))
+   {
+      jpeg_destroy_compress(&cinfo);
+      return false;
+   }
 
-   cinfo.err = jpeg_std_error(&jerr);    // set up the normal JPEG error routines.
    cinfo.client_data = (void*)&stream;   // set the stream into the client_data
    jpeg_create_compress(&cinfo);         // allocates a small amount of memory
 
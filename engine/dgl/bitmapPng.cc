@@ -25,38 +25,35 @@ static png_byte DGL_CHUNK_dcCf[5] = { 100, 99, 67, 102, '\0' };
 static png_byte DGL_CHUNK_dcCs[5] = { 100, 99, 67, 115, '\0' };
 
 static const U32 csgMaxRowPointers = 1 << GBitmap::c_maxMipLevels - 1; ///< 2^11 = 2048, 12 mip levels (see c_maxMipLievels)
-static png_bytep sRowPointers[csgMaxRowPointers];
-
-//-------------------------------------- Instead of using the user_ptr,
-//                                        we use a global pointer, we
-//                                        need to ensure that only one thread
-//                                        at once may be using the variable.
-//                                       NOTE: Removed mutex for g_varAccess.
-//                                        may have to re-thread safe this.
-static Stream* sg_pStream = NULL;
 
 //-------------------------------------- Replacement I/O for standard LIBPng
 //                                        functions.  we don't wanna use
 //                                        FILE*'s...
-static void pngReadDataFn(png_structp  /*png_ptr*/,
+//                                       The stream is the io_ptr, and
+//                                        nothing else is shared between
+//                                        calls, so bitmaps can be read on
+//                                        several threads at once.
+static void pngReadDataFn(png_structp png_ptr,
                           png_bytep   data,
                           png_size_t  length)
 {
-   AssertFatal(sg_pStream != NULL, "No stream?");
+   Stream *stream = (Stream *) png_get_io_ptr(png_ptr);
+   AssertFatal(stream != NULL, "No stream?");
 
-   bool success = sg_pStream->read(length, data);
-   AssertFatal(success, "PNG read catastrophic error!");
+   if (!stream->read(length, data))
+      png_error(png_ptr, "read past the end of the stream");
 }
 
 
 //--------------------------------------
-static void pngWriteDataFn(png_structp /*png_ptr*/,
+static void pngWriteDataFn(png_structp png_ptr,
                            png_bytep   data,
                            png_size_t  length)
 {
-   AssertFatal(sg_pStream != NULL, "No stream?");
+   Stream *stream = (Stream *) png_get_io_ptr(png_ptr);
+   AssertFatal(stream != NULL, "No stream?");
 
-   sg_pStream->write(length, data);
+   stream->write(length, data);
 }
 
 
@@ -79,10 +76,13 @@ static void pngFreeFn(png_structp /*png_ptr*/, png_voidp /*mem*/)
 
 
 //--------------------------------------
-static void pngFatalErrorFn(png_structp     /*png_ptr*/,
+static void pngFatalErrorFn(png_structp     png_ptr,
                             png_const_charp pMessage)
 {
-   AssertISV(false, avar("Error reading PNG file:\n %s", pMessage));
+   // Back out to the setjmp() in readPNG or _writePNG; this may be on a
+   //  loader thread, so leave the reporting to the caller.
+   AssertWarn(false, avar("Error in PNG file:\n %s", pMessage));
+   longjmp(png_ptr->jmpbuf, 1);
 }
 
 
@@ -158,8 +158,16 @@ bool GBitmap::readPNG(Stream& io_rStream)
       return false;
    }
 
-   sg_pStream = &io_rStream;
-   png_set_read_fn(png_ptr, NULL, pngReadDataFn);
+   // Where errors in the file land.  The frame allocator holds everything
+   //  libpng allocated, so going back to the water mark frees it.
+   if (setjmp(png_ptr->jmpbuf))
+   {
+      FrameAllocator::setWaterMark(prevWaterMark);
+      deleteImage();
+      return false;
+   }
+
+   png_set_read_fn(png_ptr, &io_rStream, pngReadDataFn);
 
    // Read off the info on the image.
    png_set_sig_bytes(png_ptr, cs_headerBytesChecked);
@@ -251,7 +259,7 @@ bool GBitmap::readPNG(Stream& io_rStream)
 
    // Set up the row pointers...
    AssertISV(height <= csgMaxRowPointers, "Error, cannot load pngs taller than 2048 pixels!");
-   png_bytep* rowPointers = sRowPointers;
+   png_bytep* rowPointers = (png_bytep*) FrameAllocator::alloc(height * sizeof(png_bytep));
    U8* pBase = (U8*)getBits();
    for (U32 i = 0; i < height; i++)
       rowPointers[i] = pBase + (i * rowBytes);
@@ -265,8 +273,6 @@ bool GBitmap::readPNG(Stream& io_rStream)
    png_read_end(png_ptr, NULL);
    png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
 
-   sg_pStream = NULL;
-
    // Ok, the image is read in, now we need to finish up the initialization,
    //  which means: setting up the detailing members, init'ing the palette
    //  key, etc...
@@ -277,6 +283,29 @@ bool GBitmap::readPNG(Stream& io_rStream)
    return true;
 }
 
+//--------------------------------------------------------------------------
+bool GBitmap::skipPNG(Stream& io_rStream)
+{
+   U8 header[8];
+   if (!io_rStream.read(sizeof(header), header) || png_check_sig(header, sizeof(header)) == 0)
+      return false;
+
+   // Step over the chunks, and the IEND chunk's CRC, as readPNG would,
+   //  without inflating anything.
+   for (;;)
+   {
+      U8 chunk[8];
+      if (!io_rStream.read(sizeof(chunk), chunk))
+         return false;
+
+      U32 length = (U32(chunk[0]) << 24) | (U32(chunk[1]) << 16) | (U32(chunk[2]) << 8) | U32(chunk[3]);
+      if (!io_rStream.setPosition(io_rStream.getPosition() + length + 4))
+         return false;
+      if (dMemcmp(chunk + 4, "IEND", 4) == 0)
+         return io_rStream.getStatus() != Stream::IOError;
+   }
+}
+
 
 //--------------------------------------------------------------------------
 bool GBitmap::_writePNG(Stream&   stream,
@@ -319,8 +348,11 @@ bool GBitmap::_writePNG(Stream&   stream,
       return false;
    }
 
-   sg_pStream = &stream;
-   png_set_write_fn(png_ptr, NULL, pngWriteDataFn, pngFlushDataFn);
+   // The callers reset the frame allocator.
+   if (setjmp(png_ptr->jmpbuf))
+      return false;
+
+   png_set_write_fn(png_ptr, &stream, pngWriteDataFn, pngFlushDataFn);
 
    // Set the compression level, image filters, and compression strategy...
    png_ptr->flags        |= PNG_FLAG_ZLIB_CUSTOM_STRATEGY;
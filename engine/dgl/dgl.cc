@@ -256,6 +256,8 @@ U32 dglDrawText(const GFont*   font,
    return dglDrawTextN(font, ptDraw, in_string, dStrlen((const UTF8 *) in_string), colorTable, maxColorIndex, rot);
 }
 
+namespace {
+
 struct TextVertex
 {
    Point2F p;
@@ -271,82 +273,88 @@ struct TextVertex
    }
 };
 
-//------------------------------------------------------------------------------
-
-U32 dglDrawTextN(const GFont*    font,
-                 const Point2I&  ptDraw,
-                 const UTF8*     in_string,
-                 U32             n,
-                 const ColorI*   colorTable,
-                 const U32       maxColorIndex,
-                 F32             rot)
+/// The quads of a string that come from one font sheet.
+struct TextBatch
 {
-   PROFILE_START(DrawText_UTF8);
-   
-   U32 len = dStrlen(in_string) + 1;
-   FrameTemp<UTF16> ubuf(len);
-   convertUTF8toUTF16(in_string, ubuf, len);
-   U32 tmp = dglDrawTextN(font, ptDraw, ubuf, n, colorTable, maxColorIndex, rot);
-
-   PROFILE_END();
-
-   return tmp;
-}
-
-//-----------------------------------------------------------------------------
+   TextureObject *texture;
+   U32            first;         ///< First vertex.
+   U32            count;
+};
 
-U32 dglDrawTextN(const GFont*    font,
-                 const Point2I&  ptDraw,
-                 const UTF16*    in_string,
-                 U32             n,
-                 const ColorI*   colorTable,
-                 const U32       maxColorIndex,
-                 F32             rot)
+enum TextRunConstants
 {
-   // return on zero length strings
-   if( n < 1 )
-      return ptDraw.x;
-      
-   PROFILE_START(DrawText);
-
-   FrameTemp<TextVertex> vert(4*n);
-
-   glDisable(GL_LIGHTING);
+   TextRunCacheSize     = 512,   ///< Slots, direct mapped on the string hash.
+   MaxCachedTextLength  = 256,   ///< Longer strings are laid out every time.
+   TextColorTableSize   = 10     ///< Entries the color codes can reach.
+};
 
-   glEnable(GL_TEXTURE_2D);
-   glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-   glEnable(GL_BLEND);
+/// A laid out string: its quads, relative to where it's drawn and batched
+/// by font sheet, along with everything that went into laying it out.
+struct TextRun
+{
+   const GFont         *font;
+   U32                  hash;
+   Vector<UTF16>        text;
+   ColorI               startColor;
+   ColorI               anchorColor;
+   ColorI               startStackColor;
+   const ColorI        *colorTable;
+   U32                  maxColorIndex;
+   bool                 usesColorTable;   ///< Has color codes; then tableColors matter too.
+   ColorI               tableColors[TextColorTableSize];
+
+   U32                  width;
+   ColorI               endColor;         ///< The modulation color codes leave behind.
+   ColorI               endStackColor;
+   Vector<TextVertex>   verts;
+   Vector<TextBatch>    batches;
+
+   TextRun() { font = NULL; }
+};
 
-   glEnableClientState ( GL_VERTEX_ARRAY );
-   glVertexPointer     ( 2, GL_FLOAT, sizeof(TextVertex), &(vert[0].p) );
+TextRun *sgTextRuns[TextRunCacheSize];
+TextRun  sgUncachedTextRun;
+bool     sgTextRunCallbackRegistered = false;
 
-   glEnableClientState ( GL_COLOR_ARRAY );
-   glColorPointer      ( 4, GL_UNSIGNED_BYTE, sizeof(TextVertex), &(vert[0].c) );
+Vector<TextVertex>      sgTextQuads;       ///< Scratch quads in string order.
+Vector<TextureObject *> sgTextQuadSheets;  ///< The sheet of each.
 
-   glEnableClientState ( GL_TEXTURE_COORD_ARRAY );
-   glTexCoordPointer   ( 2, GL_FLOAT, sizeof(TextVertex), &(vert[0].t) );
+} // namespace {}
 
-   MatrixF rotMatrix;
-   if ( rot != 0.0f )
-      rotMatrix.set( EulerF( 0.0f, 0.0f, mDegToRad( rot ) ) );
+void dglFlushTextCache(const GFont *font)
+{
+   for(U32 i = 0; i < TextRunCacheSize; i++)
+      if(sgTextRuns[i] && (!font || sgTextRuns[i]->font == font))
+         sgTextRuns[i]->font = NULL;
+}
 
-   const Point3F offset( ptDraw.x, ptDraw.y, 0.0f );
+static void textRunTextureCB(const U32, void *)
+{
+   dglFlushTextCache(NULL);
+}
 
-   const ColorI  *currentColor = &sg_bitmapModulation;
-   S32         currentPt = 0;
+/// Lays out n characters of in_string the way dglDrawTextN() draws them,
+/// with the first character's origin at 0,0, into run's quads.  Leaves the
+/// modulation color wherever the color codes put it.
+static void layoutTextRun(TextRun &run, const UTF16 *in_string, U32 n)
+{
+   const GFont *font = run.font;
+   const ColorI *colorTable = run.colorTable;
+   const U32 maxColorIndex = run.maxColorIndex;
 
-   F32 invTexWidth;
-   F32 invTexHeight;
+   sgTextQuads.clear();
+   sgTextQuadSheets.clear();
+   run.usesColorTable = false;
 
+   ColorI      currentColor = sg_bitmapModulation;
+   F32         invTexWidth = 0;
+   F32         invTexHeight = 0;
    TextureObject *lastTexture = NULL;
 
    const U32	fontBaseline = font->getBaseline();
    const PlatformFont::CharInfo &tabci = font->getCharInfo( dT(' ') );
    const U32	fontTabIncrement = tabci.xIncrement * GFont::TabWidthInSpaces;
 
-   // first build the point, color, and coord arrays
-
    U32         nCharCount = 0;
    Point2I     pt( 0, 0 );
    UTF16       c;
@@ -387,13 +395,14 @@ U32 dglDrawTextN(const GFont*    font,
                0x9 
                };
 
+               run.usesColorTable = true;
                U8 remapped = remap[c];
                // Ignore if the color is greater than the specified max index:
                if ( remapped <= maxColorIndex )
                {
                   const ColorI &clr = colorTable[remapped];
                   sg_bitmapModulation = clr;
-                  currentColor = &clr;
+                  currentColor = clr;
                }
             }
             continue;
@@ -402,7 +411,7 @@ U32 dglDrawTextN(const GFont*    font,
          // reset color?
          case 15:
          {
-            currentColor = &sg_textAnchorColor;
+            currentColor = sg_textAnchorColor;
             sg_bitmapModulation = sg_textAnchorColor;
             continue;
          }
@@ -417,7 +426,7 @@ U32 dglDrawTextN(const GFont*    font,
          // pop color:
          case 17:
          {
-            currentColor = &sg_stackColor;
+            currentColor = sg_stackColor;
             sg_bitmapModulation = sg_stackColor;
             continue;
          }
@@ -447,12 +456,6 @@ U32 dglDrawTextN(const GFont*    font,
       TextureObject *newObj = font->getTextureHandle(ci.bitmapIndex);
       if(newObj != lastTexture)
       {
-         if(currentPt)
-         {
-            glBindTexture(GL_TEXTURE_2D, lastTexture->texGLName);
-            glDrawArrays( GL_QUADS, 0, currentPt );
-            currentPt = 0;
-         }
          lastTexture = newObj;
          invTexWidth = 1.0f / lastTexture->texWidth;
          invTexHeight = 1.0f / lastTexture->texHeight;
@@ -472,46 +475,237 @@ U32 dglDrawTextN(const GFont*    font,
          F32 screenTop    = pt.y;
          F32 screenBottom = screenTop + ci.height;
 
-         if ( rot == 0.0f )
-         {			 
-            vert[currentPt++].set( screenLeft + offset.x, screenBottom + offset.y, texLeft, texBottom, *currentColor );
-            vert[currentPt++].set( screenRight + offset.x, screenBottom + offset.y, texRight, texBottom, *currentColor );
-            vert[currentPt++].set( screenRight + offset.x, screenTop + offset.y, texRight, texTop, *currentColor );
-            vert[currentPt++].set( screenLeft + offset.x, screenTop + offset.y, texLeft, texTop, *currentColor );
-         }
-         else
-         {
-            Point3F point( screenLeft, screenBottom, 0.0f );
-            rotMatrix.mulP( point );
-            point += offset;
-            vert[currentPt++].set( point.x, point.y, texLeft, texBottom, *currentColor );
-
-            point.set( screenRight,  screenBottom, 0.0f );
-            rotMatrix.mulP( point );
-            point += offset;
-            vert[currentPt++].set( point.x, point.y, texRight, texBottom, *currentColor );
-
-            point.set( screenRight,  screenTop, 0.0f );
-            rotMatrix.mulP( point );
-            point += offset;
-            vert[currentPt++].set( point.x, point.y, texRight, texTop, *currentColor );
-
-            point.set( screenLeft, screenTop, 0.0f );
-            rotMatrix.mulP( point );
-            point += offset;
-            vert[currentPt++].set( point.x, point.y, texLeft, texTop, *currentColor );
-         }
+         sgTextQuads.increment(4);
+         TextVertex *quad = sgTextQuads.end() - 4;
+         quad[0].set( screenLeft, screenBottom, texLeft, texBottom, currentColor );
+         quad[1].set( screenRight, screenBottom, texRight, texBottom, currentColor );
+         quad[2].set( screenRight, screenTop, texRight, texTop, currentColor );
+         quad[3].set( screenLeft, screenTop, texLeft, texTop, currentColor );
+         sgTextQuadSheets.push_back(lastTexture);
 
          pt.x += ci.xIncrement - ci.xOrigin;
       }
       else
          pt.x += ci.xIncrement;
    }
+
+   AssertFatal(pt.x >= 0, "How did this happen?");
+   run.width = pt.x;
+   run.endColor = sg_bitmapModulation;
+   run.endStackColor = sg_stackColor;
+
+   // One batch per sheet, the quads of each in string order, so a string
+   // that flips between sheets still takes a draw call per sheet
+   // rather than one per switch.
+   run.batches.clear();
+   TextBatch *batch = NULL;
+   for(U32 q = 0; q < sgTextQuadSheets.size(); q++)
+   {
+      if(!batch || batch->texture != sgTextQuadSheets[q])
+      {
+         batch = NULL;
+         for(U32 b = 0; b < run.batches.size(); b++)
+            if(run.batches[b].texture == sgTextQuadSheets[q])
+               batch = &run.batches[b];
+         if(!batch)
+         {
+            run.batches.increment();
+            batch = &run.batches.last();
+            batch->texture = sgTextQuadSheets[q];
+            batch->first = 0;
+            batch->count = 0;
+         }
+      }
+      batch->count += 4;
+   }
+
+   U32 first = 0;
+   for(U32 b = 0; b < run.batches.size(); b++)
+   {
+      run.batches[b].first = first;
+      first += run.batches[b].count;
+      run.batches[b].count = 0;
+   }
+
+   if(run.batches.size() <= 1)
+   {
+      run.verts = sgTextQuads;
+      if(run.batches.size())
+         run.batches[0].count = sgTextQuads.size();
+      return;
+   }
+
+   run.verts.setSize(first);
+   batch = NULL;
+   for(U32 q = 0; q < sgTextQuadSheets.size(); q++)
+   {
+      if(!batch || batch->texture != sgTextQuadSheets[q])
+         for(U32 b = 0; b < run.batches.size(); b++)
+            if(run.batches[b].texture == sgTextQuadSheets[q])
+               batch = &run.batches[b];
+      dMemcpy(&run.verts[batch->first + batch->count], &sgTextQuads[q * 4], 4 * sizeof(TextVertex));
+      batch->count += 4;
+   }
+}
+
+/// Finds the laid out run for the string, laying it out if it isn't
+/// cached or was laid out with different colors.
+static TextRun *findTextRun(const GFont *font, const UTF16 *in_string, U32 n,
+                            const ColorI *colorTable, U32 maxColorIndex)
+{
+   if(!sgTextRunCallbackRegistered)
+   {
+      TextureManager::registerEventCallback(textRunTextureCB, NULL);
+      sgTextRunCallbackRegistered = true;
+   }
+
+   U32 len = 0;
+   U32 hash = 2166136261u;
+   while(len < n && in_string[len])
+   {
+      hash = (hash ^ in_string[len]) * 16777619u;
+      len++;
+   }
+
+   TextRun *run;
+   if(len > MaxCachedTextLength)
+      run = &sgUncachedTextRun;
+   else
+   {
+      TextRun *&slot = sgTextRuns[hash & (TextRunCacheSize - 1)];
+      if(!slot)
+         slot = new TextRun;
+      run = slot;
+
+      if(run->font == font && run->hash == hash && run->text.size() == len &&
+         run->colorTable == colorTable && run->maxColorIndex == maxColorIndex &&
+         run->startColor == sg_bitmapModulation && run->anchorColor == sg_textAnchorColor &&
+         run->startStackColor == sg_stackColor &&
+         !dMemcmp(run->text.address(), in_string, len * sizeof(UTF16)))
+      {
+         U32 tableSize = getMin(maxColorIndex + 1, U32(TextColorTableSize));
+         if(!run->usesColorTable || !dMemcmp(run->tableColors, colorTable, tableSize * sizeof(ColorI)))
+         {
+            sg_bitmapModulation = run->endColor;
+            sg_stackColor = run->endStackColor;
+            return run;
+         }
+      }
+   }
+
+   run->font = font;
+   run->hash = hash;
+   run->text.setSize(len);
+   dMemcpy(run->text.address(), in_string, len * sizeof(UTF16));
+   run->colorTable = colorTable;
+   run->maxColorIndex = maxColorIndex;
+   run->startColor = sg_bitmapModulation;
+   run->anchorColor = sg_textAnchorColor;
+   run->startStackColor = sg_stackColor;
+
+   layoutTextRun(*run, in_string, len);
+
+   if(run->usesColorTable)
+      dMemcpy(run->tableColors, colorTable, getMin(maxColorIndex + 1, U32(TextColorTableSize)) * sizeof(ColorI));
+   return run;
+}
+
+//------------------------------------------------------------------------------
+
+U32 dglDrawTextN(const GFont*    font,
+                 const Point2I&  ptDraw,
+                 const UTF8*     in_string,
+                 U32             n,
+                 const ColorI*   colorTable,
+                 const U32       maxColorIndex,
+                 F32             rot)
+{
+   PROFILE_START(DrawText_UTF8);
    
-   if(currentPt)
+   U32 len = dStrlen(in_string) + 1;
+   FrameTemp<UTF16> ubuf(len);
+   convertUTF8toUTF16(in_string, ubuf, len);
+   U32 tmp = dglDrawTextN(font, ptDraw, ubuf, n, colorTable, maxColorIndex, rot);
+
+   PROFILE_END();
+
+   return tmp;
+}
+
+//-----------------------------------------------------------------------------
+
+U32 dglDrawTextN(const GFont*    font,
+                 const Point2I&  ptDraw,
+                 const UTF16*    in_string,
+                 U32             n,
+                 const ColorI*   colorTable,
+                 const U32       maxColorIndex,
+                 F32             rot)
+{
+   // return on zero length strings
+   if( n < 1 )
+      return ptDraw.x;
+      
+   PROFILE_START(DrawText);
+
+   // Glyphs that came in since the last draw go on the sheets first, and
+   //  the sheets go up before anything is drawn from them.
+   GFont *mutableFont = const_cast<GFont *>(font);
+   mutableFont->commitGlyphs();
+   TextRun *run = findTextRun(font, in_string, n, colorTable, maxColorIndex);
+   mutableFont->flushSheets();
+   if(run->verts.empty())
+   {
+      PROFILE_END();
+      return run->width;
+   }
+
+   const TextVertex *verts = run->verts.address();
+   FrameTemp<TextVertex> rotated(rot != 0.0f ? run->verts.size() : 1);
+   if ( rot != 0.0f )
+   {
+      MatrixF rotMatrix;
+      rotMatrix.set( EulerF( 0.0f, 0.0f, mDegToRad( rot ) ) );
+      const Point3F offset( ptDraw.x, ptDraw.y, 0.0f );
+
+      for(U32 i = 0; i < run->verts.size(); i++)
+      {
+         Point3F point( verts[i].p.x, verts[i].p.y, 0.0f );
+         rotMatrix.mulP( point );
+         point += offset;
+         rotated[i] = verts[i];
+         rotated[i].p.set( point.x, point.y );
+      }
+      verts = rotated;
+   }
+   else
+   {
+      glMatrixMode(GL_MODELVIEW);
+      glPushMatrix();
+      glTranslatef(ptDraw.x, ptDraw.y, 0.0f);
+   }
+
+   glDisable(GL_LIGHTING);
+
+   glEnable(GL_TEXTURE_2D);
+   glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+   glEnable(GL_BLEND);
+
+   glEnableClientState ( GL_VERTEX_ARRAY );
+   glVertexPointer     ( 2, GL_FLOAT, sizeof(TextVertex), &(verts[0].p) );
+
+   glEnableClientState ( GL_COLOR_ARRAY );
+   glColorPointer      ( 4, GL_UNSIGNED_BYTE, sizeof(TextVertex), &(verts[0].c) );
+
+   glEnableClientState ( GL_TEXTURE_COORD_ARRAY );
+   glTexCoordPointer   ( 2, GL_FLOAT, sizeof(TextVertex), &(verts[0].t) );
+
+   for(U32 i = 0; i < run->batches.size(); i++)
    {
-      glBindTexture(GL_TEXTURE_2D, lastTexture->texGLName);
-      glDrawArrays( GL_QUADS, 0, currentPt );
+      const TextBatch &batch = run->batches[i];
+      glBindTexture(GL_TEXTURE_2D, batch.texture->texGLName);
+      glDrawArrays( GL_QUADS, batch.first, batch.count );
    }
 
    glDisableClientState ( GL_VERTEX_ARRAY );
@@ -521,12 +715,12 @@ U32 dglDrawTextN(const GFont*    font,
    glDisable(GL_BLEND);
    glDisable(GL_TEXTURE_2D);
 
-   pt.x += ptDraw.x; // DAW: Account for the fact that we removed the drawing point from the text start at the beginning.
+   if ( rot == 0.0f )
+      glPopMatrix();
 
-   AssertFatal(pt.x >= ptDraw.x, "How did this happen?");
    PROFILE_END();
 
-   return pt.x - ptDraw.x;
+   return run->width;
 }
 
 
@@ -132,6 +132,11 @@ U32 dglDrawText(const GFont *font, const Point2I &ptDraw, const UTF8 *in_string,
 U32 dglDrawTextN(const GFont *font, const Point2I &ptDraw, const UTF16 *in_string, U32 n, const ColorI *colorTable = NULL, const U32 maxColorIndex = 9, F32 rot = 0.f);
 /// Converts UTF8 text to UTF16, and calls the UTF16 version of dglDrawTextN
 U32 dglDrawTextN(const GFont *font, const Point2I &ptDraw, const UTF8  *in_string, U32 n, const ColorI *colorTable = NULL, const U32 maxColorIndex = 9, F32 rot = 0.f);
+/// The text functions keep the quads of the strings they've drawn, batched
+/// by font sheet, and just replay them when the same string is drawn again
+/// with the same font and colors.  This forgets the strings drawn with
+/// font, or all of them.
+void dglFlushTextCache(const GFont *font = NULL);
 /// @}
 // -=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- //
 // Drawing primitives
@@ -279,6 +284,41 @@ bool dglCheckState(const S32 mvDepth, const S32 pDepth,
                    const S32* vp);
 
 
+/// @defgroup dgl_state State Cache
+/// A shadow of the GL state that gets set over and over: blend, depth and
+/// alpha test state, the common enables, the client arrays, and for each
+/// texture unit its binding, env mode and GL_TEXTURE_2D enable.  The cache
+/// sits in the GL entry points themselves, where the platform loads them
+/// as pointers, so every caller goes through it and a call that wouldn't
+/// change anything never reaches the driver.
+/// @{
+
+/// Registers $pref::OpenGL::stateCache and the metrics variables,
+/// $OpenGL::stateCalls and $OpenGL::stateCallsFiltered.
+void dglStateConsoleInit();
+/// Hooks the cache into the entry points of a freshly loaded context,
+/// with all the state unknown.  Does nothing if $pref::OpenGL::stateCache
+/// is off or the platform calls GL directly.
+void dglInstallStateCache();
+/// Forgets the shadowed state, for when something set it behind the cache.
+void dglInvalidateStateCache();
+/// Zeroes the counters, once a frame like dglClearPrimMetrics().
+void dglClearStateMetrics();
+
+/// @}
+
+/// @defgroup dgl_gputimer GPU Timer
+/// Times PROFILE_GPU_START() blocks for the profiler, with GL_EXT_timer_query
+/// where the device has it.
+/// @{
+
+/// Hands the timer to the profiler, and keeps its queries in step with the
+/// GL context.
+void dglGpuTimerInit();
+void dglGpuTimerDestroy();
+
+/// @}
+
 // -=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- //
 // Advanced hardware functionality.
 
@@ -0,0 +1,152 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "dgl/dgl.h"
+#include "dgl/gTexManager.h"
+#include "platform/profiler.h"
+
+#ifdef TORQUE_ENABLE_PROFILER
+
+#ifndef GL_TIME_ELAPSED_EXT
+#define GL_TIME_ELAPSED_EXT                  0x88BF
+#endif
+
+namespace {
+
+/// GL_EXT_timer_query queries, from a fixed pool.  Results are read with
+/// the 32 bit getters, which is enough nanoseconds for any one block.
+class GLGpuTimer : public ProfilerGpuTimer
+{
+   enum
+   {
+      NumQueries = 256
+   };
+
+   GLuint mQueries[NumQueries];
+   bool   mHaveQueries;
+
+   /// Slots whose queries are free, and which belong to the current
+   /// context. A slot handed out before the context went is collected as
+   /// lost.
+   Vector<S32> mFree;
+   U32 mGeneration;
+   U32 mSlotGeneration[NumQueries];
+
+public:
+   U32 mCallbackKey;
+
+   GLGpuTimer()
+   {
+      mHaveQueries = false;
+      mGeneration  = 0;
+      mCallbackKey = U32(-1);
+      dMemset(mSlotGeneration, 0, sizeof(mSlotGeneration));
+   }
+
+   void deleteQueries()
+   {
+      if (mHaveQueries)
+         glDeleteQueriesARB(NumQueries, mQueries);
+      mHaveQueries = false;
+      mFree.clear();
+      mGeneration++;
+   }
+
+   S32 begin()
+   {
+      if (!dglDoesSupportTimerQuery())
+         return -1;
+
+      if (!mHaveQueries)
+      {
+         glGenQueriesARB(NumQueries, mQueries);
+         mHaveQueries = true;
+         for (S32 i = NumQueries - 1; i >= 0; i--)
+            mFree.push_back(i);
+      }
+      if (mFree.empty())
+         return -1;
+
+      S32 slot = mFree.last();
+      mFree.pop_back();
+      mSlotGeneration[slot] = mGeneration;
+      glBeginQueryARB(GL_TIME_ELAPSED_EXT, mQueries[slot]);
+      return slot;
+   }
+
+   void end(S32 slot)
+   {
+      if (mSlotGeneration[slot] == mGeneration)
+         glEndQueryARB(GL_TIME_ELAPSED_EXT);
+   }
+
+   bool collect(S32 slot, F64 &ms)
+   {
+      if (mSlotGeneration[slot] != mGeneration)
+      {
+         ms = -1;
+         return true;
+      }
+
+      GLuint query = mQueries[slot];
+      GLint available = 0;
+      glGetQueryObjectivARB(query, GL_QUERY_RESULT_AVAILABLE_ARB, &available);
+      if (!available)
+         return false;
+
+      GLuint ns = 0;
+      glGetQueryObjectuivARB(query, GL_QUERY_RESULT_ARB, &ns);
+      ms = F64(ns) / 1000000.0;
+      mFree.push_back(slot);
+      return true;
+   }
+};
+
+GLGpuTimer *sGpuTimer = NULL;
+
+void gpuTimerTextureEvent(const U32 eventCode, void *)
+{
+   // The GL context goes away with the textures.
+   if (eventCode == TextureManager::BeginZombification)
+      sGpuTimer->deleteQueries();
+}
+
+} // namespace {}
+
+void dglGpuTimerInit()
+{
+   if (sGpuTimer)
+      return;
+
+   sGpuTimer = new GLGpuTimer;
+   sGpuTimer->mCallbackKey = TextureManager::registerEventCallback(gpuTimerTextureEvent, NULL);
+   if (gProfiler)
+      gProfiler->setGpuTimer(sGpuTimer);
+}
+
+void dglGpuTimerDestroy()
+{
+   if (!sGpuTimer)
+      return;
+
+   if (gProfiler)
+      gProfiler->setGpuTimer(NULL);
+   TextureManager::unregisterEventCallback(sGpuTimer->mCallbackKey);
+   sGpuTimer->deleteQueries();
+   delete sGpuTimer;
+   sGpuTimer = NULL;
+}
+
+#else
+
+void dglGpuTimerInit()
+{
+}
+
+void dglGpuTimerDestroy()
+{
+}
+
+#endif
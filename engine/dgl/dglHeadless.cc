@@ -0,0 +1,131 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+// The headless build (TORQUE_HEADLESS) leaves dgl/, gui/ and editor/ out.
+// The simulation code still calls into them from its render paths, which a
+// server without a canvas never runs, so these stand-ins only have to link
+// and do nothing.  Textures never load: every handle stays NULL.
+
+#include "dgl/dgl.h"
+#include "dgl/gTexManager.h"
+#include "dgl/gBitmap.h"
+#include "gui/core/guiCanvas.h"
+
+//--------------------------------------------------------------------------
+// gui and editor
+
+GuiCanvas *Canvas = NULL;
+bool gEditingMission = false;
+
+//--------------------------------------------------------------------------
+// dgl
+
+bool gDGLRender = false;
+
+void dglDrawBillboard(const Point3F &, F32, F32) {}
+void dglWireCube(const Point3F &, const Point3F &) {}
+
+void dglLoadMatrix(const MatrixF *) {}
+void dglMultMatrix(const MatrixF *) {}
+void dglGetModelview(MatrixF *m)  { m->identity(); }
+void dglGetProjection(MatrixF *m) { m->identity(); }
+
+F32  dglGetPixelScale() { return 1.0f; }
+F32  dglProjectRadius(F32, F32 radius) { return radius; }
+
+void dglSetViewport(const RectI &) {}
+void dglGetViewport(RectI *outViewport) { outViewport->set(0, 0, 0, 0); }
+void dglSetFrustum(F64, F64, F64, F64, F64, F64, bool) {}
+void dglGetFrustum(F64 *left, F64 *right, F64 *bottom, F64 *top, F64 *nearDist, F64 *farDist)
+{
+   *left = *bottom = -1.0;
+   *right = *top = *nearDist = *farDist = 1.0;
+}
+bool dglIsOrtho() { return false; }
+bool dglPointToScreen(const Point3F &, Point3F &screenPoint)
+{
+   screenPoint.set(0, 0, 0);
+   return false;
+}
+
+bool dglIsInCanonicalState() { return true; }
+void dglSetCanonicalState() {}
+void dglGetTransformState(S32 *mvDepth, S32 *pDepth, S32 *t0Depth, F32 *, S32 *t1Depth, F32 *, S32 *)
+{
+   *mvDepth = *pDepth = *t0Depth = *t1Depth = 0;
+}
+bool dglCheckState(const S32, const S32, const S32, const F32 *, const S32, const F32 *, const S32 *)
+{
+   return true;
+}
+void dglStateConsoleInit() {}
+void dglClearStateMetrics() {}
+void dglGpuTimerInit() {}
+void dglGpuTimerDestroy() {}
+
+//--------------------------------------------------------------------------
+// TextureManager
+
+bool sgForcePalettedTexture = false;
+bool sgForce16BitTexture    = false;
+
+bool        TextureManager::smTextureManagerActive = false;
+bool        TextureManager::smIsZombie = false;
+bool        TextureManager::smUseSmallTextures = false;
+U32         TextureManager::smFrame = 0;
+S32         TextureManager::smResidentBytes = 0;
+const char *TextureManager::csmTexturePrefix = "";
+#ifdef TORQUE_GATHER_METRICS
+U32         TextureManager::smTextureSpaceLoaded = 0;
+U32         TextureManager::smTextureCacheMisses = 0;
+F32         TextureManager::getResidentFraction() { return 0.0f; }
+void        TextureManager::dumpStats() {}
+#endif
+
+void TextureManager::create() {}
+void TextureManager::preDestroy() {}
+void TextureManager::destroy() {}
+void TextureManager::makeZombie() {}
+void TextureManager::resurrect() {}
+void TextureManager::flush() {}
+void TextureManager::processFrame() {}
+
+TextureObject *TextureManager::loadTexture(const char *, TextureHandleType, bool, bool)
+{
+   return NULL;
+}
+
+TextureObject *TextureManager::registerTexture(const char *, const GBitmap *, bool)
+{
+   return NULL;
+}
+
+TextureObject *TextureManager::registerTexture(const char *, GBitmap *, TextureHandleType, bool)
+{
+   return NULL;
+}
+
+void TextureManager::freeTexture(TextureObject *) {}
+bool TextureManager::createGLName(GBitmap *, bool, U32, TextureHandleType, TextureObject *, bool)
+{
+   return false;
+}
+void TextureManager::refresh(TextureObject *) {}
+void TextureManager::refresh(TextureObject *, GBitmap *) {}
+void TextureManager::queueUpload(TextureObject *) {}
+
+U32  TextureManager::registerEventCallback(TextureEventCallback, void *) { return 0; }
+void TextureManager::unregisterEventCallback(const U32) {}
+
+GBitmap *TextureManager::loadBitmapInstance(const char *, bool, bool) { return NULL; }
+void TextureManager::addPrefetchedBitmap(ResourceObject *) {}
+void TextureManager::releasePrefetchedBitmaps() {}
+bool TextureManager::isTextureLoaded(const char *) { return false; }
+
+#if defined(TORQUE_DEBUG)
+void TextureHandle::lock() {}
+void TextureHandle::unlock() {}
+#endif
+void TextureHandle::setClamp(const bool) {}
@@ -0,0 +1,406 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "dgl/dgl.h"
+#include "console/console.h"
+#include "console/consoleTypes.h"
+
+static bool sStateCacheEnabled = true;
+static S32  sStateCalls = 0;
+static S32  sStateCallsFiltered = 0;
+
+void dglStateConsoleInit()
+{
+   Con::addVariable("pref::OpenGL::stateCache", TypeBool, &sStateCacheEnabled);
+   Con::addVariable("OpenGL::stateCalls", TypeS32, &sStateCalls);
+   Con::addVariable("OpenGL::stateCallsFiltered", TypeS32, &sStateCallsFiltered);
+}
+
+void dglClearStateMetrics()
+{
+   sStateCalls = sStateCallsFiltered = 0;
+}
+
+#ifdef TORQUE_GL_FUNCTION_POINTERS
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+enum
+{
+   MaxUnits = 4,
+   Unknown  = 0xFFFFFFFF   ///< Neither a GLenum, a flag, nor a texture we'll see.
+};
+
+enum Cap
+{
+   CapBlend,
+   CapDepthTest,
+   CapAlphaTest,
+   CapCullFace,
+   CapLighting,
+   CapFog,
+   NumCaps
+};
+
+enum ClientArray
+{
+   ArrayVertex,
+   ArrayNormal,
+   ArrayColor,
+   ArrayFogCoord,
+   NumArrays
+};
+
+struct TexUnit
+{
+   U32 binding;
+   U32 envMode;
+   U32 enabled;
+   U32 texCoordArray;
+};
+
+struct State
+{
+   U32 caps[NumCaps];
+   U32 arrays[NumArrays];
+   U32 blendSrc, blendDst;
+   U32 depthMask;
+   U32 depthFunc;
+   U32 alphaFunc;
+   F32 alphaRef;
+   U32 activeUnit;
+   U32 clientUnit;
+   TexUnit units[MaxUnits];
+
+   /// Set between glNewList() and glEndList(), when every call has to be
+   /// recorded.  Only GL_COMPILE_AND_EXECUTE lists still update the shadow.
+   bool compiling;
+   bool executing;
+};
+
+State gState;
+bool  gMultitexture = false;
+
+void (GLAPIENTRY *realEnable)(GLenum);
+void (GLAPIENTRY *realDisable)(GLenum);
+void (GLAPIENTRY *realEnableClientState)(GLenum);
+void (GLAPIENTRY *realDisableClientState)(GLenum);
+void (GLAPIENTRY *realBlendFunc)(GLenum, GLenum);
+void (GLAPIENTRY *realDepthMask)(GLboolean);
+void (GLAPIENTRY *realDepthFunc)(GLenum);
+void (GLAPIENTRY *realAlphaFunc)(GLenum, GLclampf);
+void (GLAPIENTRY *realBindTexture)(GLenum, GLuint);
+void (GLAPIENTRY *realDeleteTextures)(GLsizei, const GLuint *);
+void (GLAPIENTRY *realTexEnvi)(GLenum, GLenum, GLint);
+void (GLAPIENTRY *realTexEnvf)(GLenum, GLenum, GLfloat);
+void (GLAPIENTRY *realActiveTextureARB)(GLenum);
+void (GLAPIENTRY *realClientActiveTextureARB)(GLenum);
+void (GLAPIENTRY *realPopAttrib)(void);
+void (GLAPIENTRY *realPopClientAttrib)(void);
+void (GLAPIENTRY *realNewList)(GLuint, GLenum);
+void (GLAPIENTRY *realEndList)(void);
+void (GLAPIENTRY *realCallList)(GLuint);
+void (GLAPIENTRY *realCallLists)(GLsizei, GLenum, const GLvoid *);
+
+void forgetServerState()
+{
+   for (U32 i = 0; i < NumCaps; i++)
+      gState.caps[i] = Unknown;
+   gState.blendSrc = gState.blendDst = Unknown;
+   gState.depthMask = Unknown;
+   gState.depthFunc = Unknown;
+   gState.alphaFunc = Unknown;
+   gState.alphaRef = 0.0f;
+   gState.activeUnit = gMultitexture ? U32(Unknown) : 0;
+   for (U32 i = 0; i < MaxUnits; i++)
+   {
+      gState.units[i].binding = Unknown;
+      gState.units[i].envMode = Unknown;
+      gState.units[i].enabled = Unknown;
+   }
+}
+
+void forgetClientState()
+{
+   for (U32 i = 0; i < NumArrays; i++)
+      gState.arrays[i] = Unknown;
+   gState.clientUnit = gMultitexture ? U32(Unknown) : 0;
+   for (U32 i = 0; i < MaxUnits; i++)
+      gState.units[i].texCoordArray = Unknown;
+}
+
+/// Updates shadow to value and says whether the call has to go to GL.
+inline bool setShadow(U32 *shadow, U32 value)
+{
+   if (gState.compiling)
+   {
+      sStateCalls++;
+      if (shadow)
+         *shadow = gState.executing ? value : U32(Unknown);
+      return true;
+   }
+   if (shadow && *shadow == value)
+   {
+      sStateCallsFiltered++;
+      return false;
+   }
+   sStateCalls++;
+   if (shadow)
+      *shadow = value;
+   return true;
+}
+
+TexUnit *activeUnit()
+{
+   return gState.activeUnit < MaxUnits ? &gState.units[gState.activeUnit] : NULL;
+}
+
+U32 *findCap(GLenum cap)
+{
+   switch (cap)
+   {
+      case GL_BLEND:       return &gState.caps[CapBlend];
+      case GL_DEPTH_TEST:  return &gState.caps[CapDepthTest];
+      case GL_ALPHA_TEST:  return &gState.caps[CapAlphaTest];
+      case GL_CULL_FACE:   return &gState.caps[CapCullFace];
+      case GL_LIGHTING:    return &gState.caps[CapLighting];
+      case GL_FOG:         return &gState.caps[CapFog];
+      case GL_TEXTURE_2D:
+      {
+         TexUnit *unit = activeUnit();
+         return unit ? &unit->enabled : NULL;
+      }
+   }
+   return NULL;
+}
+
+U32 *findArray(GLenum array)
+{
+   switch (array)
+   {
+      case GL_VERTEX_ARRAY:         return &gState.arrays[ArrayVertex];
+      case GL_NORMAL_ARRAY:         return &gState.arrays[ArrayNormal];
+      case GL_COLOR_ARRAY:          return &gState.arrays[ArrayColor];
+      case GL_FOG_COORDINATE_ARRAY_EXT:  return &gState.arrays[ArrayFogCoord];
+      case GL_TEXTURE_COORD_ARRAY:
+         return gState.clientUnit < MaxUnits ? &gState.units[gState.clientUnit].texCoordArray : NULL;
+   }
+   return NULL;
+}
+
+//------------------------------------------------------------------------------
+
+void GLAPIENTRY cacheEnable(GLenum cap)
+{
+   if (setShadow(findCap(cap), 1))
+      realEnable(cap);
+}
+
+void GLAPIENTRY cacheDisable(GLenum cap)
+{
+   if (setShadow(findCap(cap), 0))
+      realDisable(cap);
+}
+
+void GLAPIENTRY cacheEnableClientState(GLenum array)
+{
+   if (setShadow(findArray(array), 1))
+      realEnableClientState(array);
+}
+
+void GLAPIENTRY cacheDisableClientState(GLenum array)
+{
+   if (setShadow(findArray(array), 0))
+      realDisableClientState(array);
+}
+
+void GLAPIENTRY cacheBlendFunc(GLenum sfactor, GLenum dfactor)
+{
+   // Both factors are one piece of state as far as filtering goes.
+   bool same = gState.blendSrc == sfactor && gState.blendDst == dfactor;
+   if (setShadow(same ? &gState.blendDst : NULL, dfactor))
+   {
+      gState.blendSrc = (gState.compiling && !gState.executing) ? U32(Unknown) : U32(sfactor);
+      gState.blendDst = (gState.compiling && !gState.executing) ? U32(Unknown) : U32(dfactor);
+      realBlendFunc(sfactor, dfactor);
+   }
+}
+
+void GLAPIENTRY cacheDepthMask(GLboolean flag)
+{
+   if (setShadow(&gState.depthMask, flag ? 1 : 0))
+      realDepthMask(flag);
+}
+
+void GLAPIENTRY cacheDepthFunc(GLenum func)
+{
+   if (setShadow(&gState.depthFunc, func))
+      realDepthFunc(func);
+}
+
+void GLAPIENTRY cacheAlphaFunc(GLenum func, GLclampf ref)
+{
+   bool same = gState.alphaFunc == func && gState.alphaRef == ref;
+   if (setShadow(same ? &gState.alphaFunc : NULL, func))
+   {
+      gState.alphaFunc = (gState.compiling && !gState.executing) ? U32(Unknown) : U32(func);
+      gState.alphaRef = ref;
+      realAlphaFunc(func, ref);
+   }
+}
+
+void GLAPIENTRY cacheBindTexture(GLenum target, GLuint texture)
+{
+   TexUnit *unit = activeUnit();
+   if (setShadow(target == GL_TEXTURE_2D && unit ? &unit->binding : NULL, texture))
+      realBindTexture(target, texture);
+}
+
+void GLAPIENTRY cacheDeleteTextures(GLsizei n, const GLuint *textures)
+{
+   // Deleting a bound texture binds zero in its place.
+   sStateCalls++;
+   for (S32 i = 0; i < n; i++)
+      for (U32 j = 0; j < MaxUnits; j++)
+         if (gState.units[j].binding == textures[i])
+            gState.units[j].binding = 0;
+   realDeleteTextures(n, textures);
+}
+
+void GLAPIENTRY cacheTexEnvi(GLenum target, GLenum pname, GLint param)
+{
+   TexUnit *unit = activeUnit();
+   bool mode = target == GL_TEXTURE_ENV && pname == GL_TEXTURE_ENV_MODE && unit;
+   if (setShadow(mode ? &unit->envMode : NULL, param))
+      realTexEnvi(target, pname, param);
+}
+
+void GLAPIENTRY cacheTexEnvf(GLenum target, GLenum pname, GLfloat param)
+{
+   TexUnit *unit = activeUnit();
+   bool mode = target == GL_TEXTURE_ENV && pname == GL_TEXTURE_ENV_MODE && unit;
+   if (setShadow(mode ? &unit->envMode : NULL, GLint(param)))
+      realTexEnvf(target, pname, param);
+}
+
+void GLAPIENTRY cacheActiveTextureARB(GLenum texture)
+{
+   if (setShadow(&gState.activeUnit, texture - GL_TEXTURE0_ARB))
+      realActiveTextureARB(texture);
+}
+
+void GLAPIENTRY cacheClientActiveTextureARB(GLenum texture)
+{
+   if (setShadow(&gState.clientUnit, texture - GL_TEXTURE0_ARB))
+      realClientActiveTextureARB(texture);
+}
+
+void GLAPIENTRY cachePopAttrib(void)
+{
+   sStateCalls++;
+   realPopAttrib();
+   forgetServerState();
+}
+
+void GLAPIENTRY cachePopClientAttrib(void)
+{
+   sStateCalls++;
+   realPopClientAttrib();
+   forgetClientState();
+}
+
+void GLAPIENTRY cacheNewList(GLuint list, GLenum mode)
+{
+   gState.compiling = true;
+   gState.executing = mode == GL_COMPILE_AND_EXECUTE;
+   realNewList(list, mode);
+}
+
+void GLAPIENTRY cacheEndList(void)
+{
+   realEndList();
+   gState.compiling = false;
+   gState.executing = false;
+}
+
+// A list can set anything, so it's all unknown once one has run.
+void GLAPIENTRY cacheCallList(GLuint list)
+{
+   realCallList(list);
+   forgetServerState();
+   forgetClientState();
+}
+
+void GLAPIENTRY cacheCallLists(GLsizei n, GLenum type, const GLvoid *lists)
+{
+   realCallLists(n, type, lists);
+   forgetServerState();
+   forgetClientState();
+}
+
+} // namespace
+
+/// Swaps fn for its cached version, keeping what it was in real##fn, unless
+/// it's hooked already.
+#define DGL_HOOK(fn) \
+   if (gl##fn && gl##fn != cache##fn) { real##fn = gl##fn; gl##fn = cache##fn; }
+
+void dglInstallStateCache()
+{
+   if (!sStateCacheEnabled)
+      return;
+
+   gMultitexture = dglDoesSupportARBMultitexture() && glActiveTextureARB && glClientActiveTextureARB;
+   dglInvalidateStateCache();
+
+   DGL_HOOK(Enable);
+   DGL_HOOK(Disable);
+   DGL_HOOK(EnableClientState);
+   DGL_HOOK(DisableClientState);
+   DGL_HOOK(BlendFunc);
+   DGL_HOOK(DepthMask);
+   DGL_HOOK(DepthFunc);
+   DGL_HOOK(AlphaFunc);
+   DGL_HOOK(BindTexture);
+   DGL_HOOK(DeleteTextures);
+   DGL_HOOK(TexEnvi);
+   DGL_HOOK(TexEnvf);
+   DGL_HOOK(PopAttrib);
+   DGL_HOOK(PopClientAttrib);
+   DGL_HOOK(NewList);
+   DGL_HOOK(EndList);
+   DGL_HOOK(CallList);
+   DGL_HOOK(CallLists);
+   if (gMultitexture)
+   {
+      DGL_HOOK(ActiveTextureARB);
+      DGL_HOOK(ClientActiveTextureARB);
+   }
+}
+
+#undef DGL_HOOK
+
+void dglInvalidateStateCache()
+{
+   forgetServerState();
+   forgetClientState();
+   gState.compiling = false;
+   gState.executing = false;
+}
+
+#else
+
+// GL is called directly, there is nothing to hook.
+void dglInstallStateCache()
+{
+}
+
+void dglInvalidateStateCache()
+{
+}
+
+#endif
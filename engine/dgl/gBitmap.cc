@@ -12,6 +12,15 @@
 #include "util/safeDelete.h"
 #include "math/mRect.h"
 #include "console/console.h"
+#include "core/threadPool.h"
+#include "platform/profiler.h"
+
+// The SSE2 kernels use intrinsics, so they're built wherever the compiler
+// knows about SSE2, and installed at run time by bitmapInstallSSE2().
+#if defined(TORQUE_CPU_X86) && (defined(TORQUE_COMPILER_VISUALC) || defined(__SSE2__))
+#  define BITMAP_USE_SSE2
+#  include <emmintrin.h>
+#endif
 
 const U32 GBitmap::csFileVersion   = 3;
 U32       GBitmap::sBitmapIdSource = 0;
@@ -193,6 +202,38 @@ void GBitmap::allocateBitmap(const U32 in_width, const U32 in_height, const bool
    }
 }
 
+//--------------------------------------------------------------------------
+void GBitmap::allocateCompressedBitmap(const U32 in_width, const U32 in_height, const U32 in_numMipLevels, const BitmapFormat in_format)
+{
+   AssertFatal(in_format >= DXT1 && in_format <= DXT5, "GBitmap::allocateCompressedBitmap: not a compressed format");
+   AssertFatal(isPow2(in_width) == true && isPow2(in_height) == true, "GBitmap::allocateCompressedBitmap: w/h must be pow2");
+
+   deleteImage();
+
+   internalFormat = in_format;
+   width          = in_width;
+   height         = in_height;
+   bytesPerPixel  = 0;
+
+   // enough for the getMipSize() calls below
+   numMipLevels = c_maxMipLevels;
+
+   U32 levels = 1;
+   while (levels < in_numMipLevels && levels < c_maxMipLevels &&
+          ((width >> (levels - 1)) > 1 || (height >> (levels - 1)) > 1))
+      levels++;
+
+   byteSize = 0;
+   for (U32 i = 0; i < levels; i++)
+   {
+      mipLevelOffsets[i] = byteSize;
+      byteSize += getMipSize(i);
+   }
+   numMipLevels = levels;
+
+   pBits = new U8[byteSize];
+}
+
 
 //--------------------------------------------------------------------------
 void bitmapExtrude5551_c(const void *srcMip, void *mip, U32 srcHeight, U32 srcWidth)
@@ -387,15 +428,334 @@ void bitmapExtrudeRGBA_c(const void *srcMip, void *mip, U32 srcHeight, U32 srcWi
    }
 }
 
+//--------------------------------------------------------------------------
+void bitmapConvertRGB_to_RGBA_c(const U8 *rgb, const U8 *alpha, U8 *dst, U32 pixels)
+{
+   for(U32 j = 0; j < pixels; j++)
+   {
+      dst[0] = rgb[0];
+      dst[1] = rgb[1];
+      dst[2] = rgb[2];
+      dst[3] = alpha ? alpha[j] : 255;
+      rgb += 3;
+      dst += 4;
+   }
+}
+
+
+#if defined(BITMAP_USE_SSE2)
+//--------------------------------------------------------------------------
+// SSE2 versions of the kernels.  They do the same integer math as the C
+// ones, so the results are the same to the byte; widths the vector loops
+// don't cover fall back to the C code.
+
+/// Splits eight packed RGB pixels into registers with pixel i in the low
+/// dword of px[i].  The fourth byte of each is the next pixel's red.
+static inline void loadRGBPixels(const U8 *p, __m128i px[8])
+{
+   __m128i lo = _mm_loadu_si128((const __m128i *) p);
+   __m128i hi = _mm_loadl_epi64((const __m128i *) (p + 16));
+
+   px[0] = lo;
+   px[1] = _mm_srli_si128(lo, 3);
+   px[2] = _mm_srli_si128(lo, 6);
+   px[3] = _mm_srli_si128(lo, 9);
+   px[4] = _mm_srli_si128(lo, 12);
+   px[5] = _mm_or_si128(_mm_srli_si128(lo, 15), _mm_slli_si128(hi, 1));
+   px[6] = _mm_srli_si128(hi, 2);
+   px[7] = _mm_srli_si128(hi, 5);
+}
+
+/// Puts the low dwords of a, b, c and d together in one register.
+static inline __m128i gatherDwords(__m128i a, __m128i b, __m128i c, __m128i d)
+{
+   return _mm_unpacklo_epi64(_mm_unpacklo_epi32(a, b), _mm_unpacklo_epi32(c, d));
+}
+
+//--------------------------------------------------------------------------
+static void bitmapExtrudeRGB_sse2(const void *srcMip, void *mip, U32 srcHeight, U32 srcWidth)
+{
+   if (srcWidth < 8)
+   {
+      bitmapExtrudeRGB_c(srcMip, mip, srcHeight, srcWidth);
+      return;
+   }
+
+   const U8 *src = (const U8 *) srcMip;
+   U8 *dst = (U8 *) mip;
+   U32 rowBytes = srcWidth * 3;
+   U32 stride = srcHeight != 1 ? rowBytes : 0;
+
+   U32 width  = srcWidth >> 1;
+   U32 height = srcHeight >> 1;
+   if (height == 0) height = 1;
+
+   const __m128i zero     = _mm_setzero_si128();
+   const __m128i two      = _mm_set1_epi16(2);
+   const __m128i evenMask = _mm_set_epi32(0, 0x00FFFFFF, 0, 0x00FFFFFF);
+   const __m128i oddMask  = _mm_set_epi32(0x00FFFFFF, 0, 0x00FFFFFF, 0);
+
+   for(U32 y = 0; y < height; y++)
+   {
+      const U8 *row0 = src + y * 2 * rowBytes;
+      const U8 *row1 = row0 + stride;
+
+      U32 x = 0;
+      for(; x + 4 <= width; x += 4)
+      {
+         __m128i p[8], q[8];
+         loadRGBPixels(row0 + x * 6, p);
+         loadRGBPixels(row1 + x * 6, q);
+
+         __m128i even0 = gatherDwords(p[0], p[2], p[4], p[6]);
+         __m128i odd0  = gatherDwords(p[1], p[3], p[5], p[7]);
+         __m128i even1 = gatherDwords(q[0], q[2], q[4], q[6]);
+         __m128i odd1  = gatherDwords(q[1], q[3], q[5], q[7]);
+
+         __m128i sumLo = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(even0, zero), _mm_unpacklo_epi8(odd0, zero)),
+                                       _mm_add_epi16(_mm_unpacklo_epi8(even1, zero), _mm_unpacklo_epi8(odd1, zero)));
+         __m128i sumHi = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(even0, zero), _mm_unpackhi_epi8(odd0, zero)),
+                                       _mm_add_epi16(_mm_unpackhi_epi8(even1, zero), _mm_unpackhi_epi8(odd1, zero)));
+         sumLo = _mm_srli_epi16(_mm_add_epi16(sumLo, two), 2);
+         sumHi = _mm_srli_epi16(_mm_add_epi16(sumHi, two), 2);
+
+         // four RGBX pixels, squeezed down to twelve bytes
+         __m128i out = _mm_packus_epi16(sumLo, sumHi);
+         out = _mm_or_si128(_mm_and_si128(out, evenMask), _mm_srli_epi64(_mm_and_si128(out, oddMask), 8));
+         out = _mm_or_si128(_mm_move_epi64(out), _mm_slli_si128(_mm_srli_si128(out, 8), 6));
+
+         _mm_storel_epi64((__m128i *) dst, out);
+         U32 last = _mm_cvtsi128_si32(_mm_srli_si128(out, 8));
+         dMemcpy(dst + 8, &last, 4);
+         dst += 12;
+      }
+
+      for(; x < width; x++)
+      {
+         const U8 *a = row0 + x * 6;
+         const U8 *c = row1 + x * 6;
+         for(U32 k = 0; k < 3; k++)
+            *dst++ = (U32(a[k]) + U32(a[k+3]) + U32(c[k]) + U32(c[k+3]) + 2) >> 2;
+      }
+   }
+}
+
+//--------------------------------------------------------------------------
+static void bitmapExtrudeRGBA_sse2(const void *srcMip, void *mip, U32 srcHeight, U32 srcWidth)
+{
+   if (srcWidth < 8)
+   {
+      bitmapExtrudeRGBA_c(srcMip, mip, srcHeight, srcWidth);
+      return;
+   }
+
+   const U8 *src = (const U8 *) srcMip;
+   U8 *dst = (U8 *) mip;
+   U32 rowBytes = srcWidth * 4;
+   U32 stride = srcHeight != 1 ? rowBytes : 0;
+
+   U32 width  = srcWidth >> 1;
+   U32 height = srcHeight >> 1;
+   if (height == 0) height = 1;
+
+   const __m128i zero = _mm_setzero_si128();
+   const __m128i two  = _mm_set1_epi16(2);
+
+   for(U32 y = 0; y < height; y++)
+   {
+      const U8 *row0 = src + y * 2 * rowBytes;
+      const U8 *row1 = row0 + stride;
+
+      U32 x = 0;
+      for(; x + 4 <= width; x += 4)
+      {
+         __m128i a0 = _mm_loadu_si128((const __m128i *) (row0 + x * 8));
+         __m128i b0 = _mm_loadu_si128((const __m128i *) (row0 + x * 8 + 16));
+         __m128i a1 = _mm_loadu_si128((const __m128i *) (row1 + x * 8));
+         __m128i b1 = _mm_loadu_si128((const __m128i *) (row1 + x * 8 + 16));
+
+         // vertical sums of source pixels 0,1 / 2,3 / 4,5 / 6,7
+         __m128i va = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(a1, zero));
+         __m128i vb = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(a1, zero));
+         __m128i vc = _mm_add_epi16(_mm_unpacklo_epi8(b0, zero), _mm_unpacklo_epi8(b1, zero));
+         __m128i vd = _mm_add_epi16(_mm_unpackhi_epi8(b0, zero), _mm_unpackhi_epi8(b1, zero));
+
+         __m128i d01 = _mm_add_epi16(_mm_unpacklo_epi64(va, vb), _mm_unpackhi_epi64(va, vb));
+         __m128i d23 = _mm_add_epi16(_mm_unpacklo_epi64(vc, vd), _mm_unpackhi_epi64(vc, vd));
+         d01 = _mm_srli_epi16(_mm_add_epi16(d01, two), 2);
+         d23 = _mm_srli_epi16(_mm_add_epi16(d23, two), 2);
+
+         _mm_storeu_si128((__m128i *) dst, _mm_packus_epi16(d01, d23));
+         dst += 16;
+      }
+
+      for(; x < width; x++)
+      {
+         const U8 *a = row0 + x * 8;
+         const U8 *c = row1 + x * 8;
+         for(U32 k = 0; k < 4; k++)
+            *dst++ = (U32(a[k]) + U32(a[k+4]) + U32(c[k]) + U32(c[k+4]) + 2) >> 2;
+      }
+   }
+}
+
+//--------------------------------------------------------------------------
+static void bitmapConvertRGB_to_5551_sse2(U8 *src, U32 pixels)
+{
+   U16 *dst = (U16 *)src;
+
+   const __m128i rMask = _mm_set1_epi32(0x0000F8);
+   const __m128i gMask = _mm_set1_epi32(0x00F800);
+   const __m128i bMask = _mm_set1_epi32(0xF80000);
+   const __m128i one   = _mm_set1_epi32(1);
+
+   // In place: each group is read before it's written, and the writes
+   // never catch up with the next group's reads.
+   U32 j = 0;
+   for(; j + 8 <= pixels; j += 8)
+   {
+      __m128i p[8];
+      loadRGBPixels(src, p);
+
+      __m128i v[2];
+      v[0] = gatherDwords(p[0], p[1], p[2], p[3]);
+      v[1] = gatherDwords(p[4], p[5], p[6], p[7]);
+      for(U32 k = 0; k < 2; k++)
+      {
+         __m128i r = _mm_slli_epi32(_mm_and_si128(v[k], rMask), 8);
+         __m128i g = _mm_srli_epi32(_mm_and_si128(v[k], gMask), 5);
+         __m128i b = _mm_srli_epi32(_mm_and_si128(v[k], bMask), 18);
+         v[k] = _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, one));
+
+         // sign extend so the saturating pack keeps the bits
+         v[k] = _mm_srai_epi32(_mm_slli_epi32(v[k], 16), 16);
+      }
+
+      _mm_storeu_si128((__m128i *) dst, _mm_packs_epi32(v[0], v[1]));
+      src += 24;
+      dst += 8;
+   }
+
+   for(; j < pixels; j++)
+   {
+      U32 r = src[0] >> 3;
+      U32 g = src[1] >> 3;
+      U32 b = src[2] >> 3;
+
+      *dst++ = (b << 1) | (g << 6) | (r << 11) | 1;
+      src += 3;
+   }
+}
+
+//--------------------------------------------------------------------------
+static void bitmapConvertRGB_to_RGBA_sse2(const U8 *rgb, const U8 *alpha, U8 *dst, U32 pixels)
+{
+   const __m128i zero      = _mm_setzero_si128();
+   const __m128i rgbMask   = _mm_set1_epi32(0x00FFFFFF);
+   const __m128i solid     = _mm_set1_epi32(0xFF000000);
+
+   U32 j = 0;
+   for(; j + 8 <= pixels; j += 8)
+   {
+      __m128i p[8];
+      loadRGBPixels(rgb, p);
+
+      __m128i aLo = solid;
+      __m128i aHi = solid;
+      if (alpha)
+      {
+         // alpha j into the top byte of dword j
+         __m128i a = _mm_unpacklo_epi8(zero, _mm_loadl_epi64((const __m128i *) (alpha + j)));
+         aLo = _mm_unpacklo_epi16(zero, a);
+         aHi = _mm_unpackhi_epi16(zero, a);
+      }
+
+      __m128i lo = _mm_and_si128(gatherDwords(p[0], p[1], p[2], p[3]), rgbMask);
+      __m128i hi = _mm_and_si128(gatherDwords(p[4], p[5], p[6], p[7]), rgbMask);
+      _mm_storeu_si128((__m128i *) dst,        _mm_or_si128(lo, aLo));
+      _mm_storeu_si128((__m128i *) (dst + 16), _mm_or_si128(hi, aHi));
+
+      rgb += 24;
+      dst += 32;
+   }
+
+   if (j < pixels)
+      bitmapConvertRGB_to_RGBA_c(rgb, alpha ? alpha + j : NULL, dst, pixels - j);
+}
+#endif
+
 void (*bitmapExtrude5551)(const void *srcMip, void *mip, U32 height, U32 width) = bitmapExtrude5551_c;
 void (*bitmapExtrudeRGB)(const void *srcMip, void *mip, U32 srcHeight, U32 srcWidth) = bitmapExtrudeRGB_c;
 void (*bitmapExtrudeRGBA)(const void *srcMip, void *mip, U32 srcHeight, U32 srcWidth) = bitmapExtrudeRGBA_c;
 void (*bitmapExtrudePaletted)(const void *srcMip, void *mip, U32 srcHeight, U32 srcWidth) = bitmapExtrudePaletted_c;
+void (*bitmapConvertRGB_to_RGBA)(const U8 *rgb, const U8 *alpha, U8 *dst, U32 pixels) = bitmapConvertRGB_to_RGBA_c;
+
+
+//--------------------------------------------------------------------------
+namespace {
+
+/// Big levels are split into bands of rows, one per job.
+struct ExtrudeJob
+{
+   void (*extrude)(const void *srcMip, void *mip, U32 srcHeight, U32 srcWidth);
+   const U8 *src;
+   U8       *dst;
+   U32       srcWidth;
+   U32       bytesPerPixel;
+};
+
+void extrudeRows(U32 start, U32 end, void *userData)
+{
+   // destination rows [start, end) come from source rows [2 * start, 2 * end)
+   const ExtrudeJob *job = (const ExtrudeJob *) userData;
+   U32 srcRowBytes = job->srcWidth * job->bytesPerPixel;
+   job->extrude(job->src + start * 2 * srcRowBytes,
+                job->dst + start * (srcRowBytes >> 1),
+                (end - start) * 2,
+                job->srcWidth);
+}
+
+/// Levels with at least this many source pixels go to the thread pool.
+const U32 csParallelExtrudePixels = 512 * 512;
+
+void extrudeLevel(void (*extrude)(const void *srcMip, void *mip, U32 srcHeight, U32 srcWidth),
+                  const U8 *src, U8 *dst, U32 srcHeight, U32 srcWidth, U32 bytesPerPixel)
+{
+   if (gThreadPool && gThreadPool->isThreaded() &&
+       srcWidth >= 2 && srcHeight >= 2 && srcWidth * srcHeight >= csParallelExtrudePixels)
+   {
+      ExtrudeJob job;
+      job.extrude       = extrude;
+      job.src           = src;
+      job.dst           = dst;
+      job.srcWidth      = srcWidth;
+      job.bytesPerPixel = bytesPerPixel;
+      gThreadPool->parallelFor(srcHeight >> 1, extrudeRows, &job, 16);
+   }
+   else
+      extrude(src, dst, srcHeight, srcWidth);
+}
+
+} // namespace {}
+
+void bitmapInstallSSE2()
+{
+#if defined(BITMAP_USE_SSE2)
+   bitmapExtrudeRGB         = bitmapExtrudeRGB_sse2;
+   bitmapExtrudeRGBA        = bitmapExtrudeRGBA_sse2;
+   bitmapConvertRGB_to_5551 = bitmapConvertRGB_to_5551_sse2;
+   bitmapConvertRGB_to_RGBA = bitmapConvertRGB_to_RGBA_sse2;
+#endif
+}
 
 
 //--------------------------------------------------------------------------
 void GBitmap::extrudeMipLevels(bool clearBorders)
 {
+   // compressed bitmaps bring their mips with them
+   if(isCompressed())
+      return;
+
    if(numMipLevels == 1)
       allocateBitmap(getWidth(), getHeight(), true, getFormat());
 
@@ -413,14 +773,14 @@ void GBitmap::extrudeMipLevels(bool clearBorders)
       case RGB:
       {
          for(U32 i = 1; i < numMipLevels; i++)
-            bitmapExtrudeRGB(getBits(i - 1), getWritableBits(i), getHeight(i-1), getWidth(i-1));
+            extrudeLevel(bitmapExtrudeRGB, getBits(i - 1), getWritableBits(i), getHeight(i-1), getWidth(i-1), 3);
          break;
       }
 
       case RGBA:
       {
          for(U32 i = 1; i < numMipLevels; i++)
-            bitmapExtrudeRGBA(getBits(i - 1), getWritableBits(i), getHeight(i-1), getWidth(i-1));
+            extrudeLevel(bitmapExtrudeRGBA, getBits(i - 1), getWritableBits(i), getHeight(i-1), getWidth(i-1), 4);
          break;
       }
 
@@ -471,7 +831,7 @@ void GBitmap::extrudeMipLevelsDetail()
       allocateBitmap(getWidth(), getHeight(), true, getFormat());
 
    for (i = 1; i < numMipLevels; i++) {
-      bitmapExtrudeRGB(getBits(i - 1), getWritableBits(i), getHeight(i-1), getWidth(i-1));
+      extrudeLevel(bitmapExtrudeRGB, getBits(i - 1), getWritableBits(i), getHeight(i-1), getWidth(i-1), 3);
    }
 
    // Ok, now that we have the levels extruded, we need to move the lower miplevels
@@ -591,6 +951,8 @@ bool GBitmap::getColor(const U32 x, const U32 y, ColorI& rColor) const
       return false;
    if (internalFormat == Palettized && pPalette == NULL)
       return false;
+   if (isCompressed())
+      return false;
 
    const U8* pLoc = getAddress(x, y);
 
@@ -636,6 +998,8 @@ bool GBitmap::setColor(const U32 x, const U32 y, ColorI& rColor)
       return false;
    if (internalFormat == Palettized && pPalette == NULL)
       return false;
+   if (isCompressed())
+      return false;
 
    U8* pLoc = getAddress(x, y);
 
@@ -805,6 +1169,11 @@ bool GBitmap::read(Stream& io_rStream)
      case RGB565:
      case RGB5551:    bytesPerPixel = 2;
       break;
+     case DXT1:
+     case DXT1A:
+     case DXT3:
+     case DXT5:       bytesPerPixel = 0;
+      break;
      default:
       AssertFatal(false, "GBitmap::GBitmap: misunderstood format specifier");
       break;
@@ -859,6 +1228,9 @@ bool GBitmap::write(Stream& io_rStream) const
 
 
 //-------------------------------------- GFXBitmap
+// Image files are only ever loaded as textures, which a headless build
+// doesn't have; it only keeps the PNG code, for the lightmaps in interiors.
+#ifndef TORQUE_HEADLESS
 ResourceInstance* constructBitmapJPEG(Stream &stream)
 {
    GBitmap* bmp = new GBitmap;
@@ -918,6 +1290,19 @@ ResourceInstance* constructBitmapGIF(Stream &stream)
       return NULL;
    }
 }
+ResourceInstance* constructBitmapDDS(Stream &stream)
+{
+   GBitmap *bmp = new GBitmap;
+   if(bmp->readDDS(stream))
+      return bmp;
+   else
+   {
+      delete bmp;
+      return NULL;
+   }
+}
+#endif
+
 ResourceInstance* constructBitmapDBM(Stream &stream)
 {
    GBitmap* bmp = new GBitmap;
@@ -28,6 +28,7 @@ extern ResourceInstance* constructBitmapPNG(Stream& stream);
 extern ResourceInstance* constructBitmapJPEG(Stream& stream);
 extern ResourceInstance* constructBitmapGIF(Stream& stream);
 extern ResourceInstance* constructBitmapDBM(Stream& stream);
+extern ResourceInstance* constructBitmapDDS(Stream& stream);
 
 
 //------------------------------------------------------------------------------
@@ -49,7 +50,11 @@ class GBitmap: public ResourceInstance
       Alpha      = 4,
       RGB565     = 5,
       RGB5551    = 6,
-      Luminance  = 7
+      Luminance  = 7,
+      DXT1       = 8,   ///< S3TC compressed, no alpha
+      DXT1A      = 9,   ///< S3TC compressed, 1 bit alpha
+      DXT3       = 10,  ///< S3TC compressed, explicit alpha
+      DXT5       = 11   ///< S3TC compressed, interpolated alpha
    };
 
    enum Constants {
@@ -69,11 +74,20 @@ class GBitmap: public ResourceInstance
            const BitmapFormat in_format = RGB);
    virtual ~GBitmap();
 
+   U32 getResourceSize() const { return sizeof(GBitmap) + byteSize; }
+
    void allocateBitmap(const U32  in_width,
                        const U32  in_height,
                        const bool in_extrudeMipLevels = false,
                        const BitmapFormat in_format = RGB);
 
+   /// Allocates a block compressed bitmap with in_numMipLevels levels,
+   /// clamped to the full chain.  Width and height must be pow2.
+   void allocateCompressedBitmap(const U32 in_width,
+                                 const U32 in_height,
+                                 const U32 in_numMipLevels,
+                                 const BitmapFormat in_format);
+
    void extrudeMipLevels(bool clearBorders = false);
    void extrudeMipLevelsDetail();
 
@@ -87,6 +101,13 @@ class GBitmap: public ResourceInstance
    U32          getWidth(const U32 in_mipLevel  = 0) const;
    U32          getHeight(const U32 in_mipLevel = 0) const;
 
+   /// True for the DXT formats.  Their bits are 4x4 blocks, so getAddress()
+   /// and the pixel accessors don't apply, and the mips come from the file.
+   bool         isCompressed() const;
+
+   /// Size of a mip level in bytes.
+   U32          getMipSize(const U32 in_mipLevel = 0) const;
+
    U8*         getAddress(const S32 in_x, const S32 in_y, const U32 mipLevel = U32(0));
    const U8*   getAddress(const S32 in_x, const S32 in_y, const U32 mipLevel = U32(0)) const;
 
@@ -130,6 +151,8 @@ class GBitmap: public ResourceInstance
    bool writeJPEG(Stream& io_rStream) const;
 
    bool readPNG(Stream& io_rStream);               // located in bitmapPng.cc
+   /// Moves the stream past a PNG without decoding it.  It must be positionable.
+   static bool skipPNG(Stream& io_rStream);
    bool writePNG(Stream& io_rStream, const bool compressHard = false) const;
    bool writePNGUncompressed(Stream& io_rStream) const;
 
@@ -142,6 +165,8 @@ class GBitmap: public ResourceInstance
    bool readGIF(Stream& io_rStream);               // located in bitmapGIF.cc
    bool writeGIF(Stream& io_rStream) const;        // located in bitmapGIF.cc
 
+   bool readDDS(Stream& io_rStream);               // located in bitmapDds.cc
+
    bool read(Stream& io_rStream);
    bool write(Stream& io_rStream) const;
 
@@ -187,6 +212,22 @@ inline U32 GBitmap::getHeight(const U32 in_mipLevel) const
    return (retVal != 0) ? retVal : 1;
 }
 
+inline bool GBitmap::isCompressed() const
+{
+   return internalFormat >= DXT1;
+}
+
+inline U32 GBitmap::getMipSize(const U32 in_mipLevel) const
+{
+   if (isCompressed())
+   {
+      U32 blocks = ((getWidth(in_mipLevel) + 3) >> 2) * ((getHeight(in_mipLevel) + 3) >> 2);
+      return blocks * (internalFormat <= DXT1A ? 8 : 16);
+   }
+
+   return getWidth(in_mipLevel) * getHeight(in_mipLevel) * bytesPerPixel;
+}
+
 inline const GPalette* GBitmap::getPalette() const
 {
    AssertFatal(getFormat() == Palettized,
@@ -226,9 +267,18 @@ inline const U8* GBitmap::getAddress(const S32 in_x, const S32 in_y, const U32 m
 
 extern void (*bitmapExtrude5551)(const void *srcMip, void *mip, U32 height, U32 width);
 extern void (*bitmapExtrudeRGB)(const void *srcMip, void *mip, U32 height, U32 width);
+extern void (*bitmapExtrudeRGBA)(const void *srcMip, void *mip, U32 height, U32 width);
 extern void (*bitmapConvertRGB_to_5551)(U8 *src, U32 pixels);
 extern void (*bitmapExtrudePaletted)(const void *srcMip, void *mip, U32 height, U32 width);
 
+/// Interleaves packed RGB and an optional alpha plane into RGBA; with no
+/// alpha the pixels are opaque.
+extern void (*bitmapConvertRGB_to_RGBA)(const U8 *rgb, const U8 *alpha, U8 *dst, U32 pixels);
+
 void bitmapExtrudeRGB_c(const void *srcMip, void *mip, U32 height, U32 width);
 
+/// Points the RGB and RGBA kernels above at SSE2 versions, where the compiler
+/// can build them.  Called during platform init when the CPU has SSE2.
+void bitmapInstallSSE2();
+
 #endif //_GBITMAP_H_
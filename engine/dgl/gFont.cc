@@ -7,6 +7,7 @@
 #include "platform/platformFont.h"
 #include "platform/profiler.h"
 #include "platform/platformMutex.h"
+#include "platform/platformThread.h"
 #include "console/console.h"
 #include "core/stream.h"
 #include "dgl/gBitmap.h"
@@ -14,14 +15,36 @@
 #include "core/findMatch.h"
 #include "dgl/gTexManager.h"
 #include "dgl/gFont.h"
+#include "dgl/dgl.h"
 #include "util/safeDelete.h"
 #include "core/frameAllocator.h"
 #include "core/unicode.h"
+#include "platform/platformAtomic.h"
 #include "zlib.h"
 #include "ctype.h"  // Needed for isupper and tolower
 
 S32 GFont::smSheetIdCount = 0;
 const U32 GFont::csm_fileVersion = 3;
+bool GFont::smBackgroundGlyphs = true;
+void *GFont::smGlyphMutex = NULL;
+
+/// Rasterizes one glyph on the thread pool.  The font commits the result
+/// on the main thread, see GFont::commitGlyphs().
+struct GFont::GlyphJob : public ThreadPool::WorkItem
+{
+   GFont                  *font;
+   UTF16                   ch;
+   PlatformFont::CharInfo  info;
+   volatile U32            done;
+
+   void process()
+   {
+      Mutex::lockMutex(GFont::smGlyphMutex);
+      info = font->mPlatformFont->getCharInfo(ch);
+      Mutex::unlockMutex(GFont::smGlyphMutex);
+      dAtomicWrite(done, 1);
+   }
+};
 
 ConsoleFunction(populateFontCacheString, void, 4, 4, "(faceName, size, string) - "
                 "Populate the font cache for the specified font with characters from the specified string.")
@@ -412,12 +435,25 @@ GFont::GFont()
    mSize = 0;
    mCharSet = 0;
    mNeedSave = false;
-   
-   mMutex = Mutex::createMutex();
+
+   dMemset(&mPlaceholder, 0, sizeof(mPlaceholder));
+   mPlaceholder.bitmapIndex = -1;
+
+   if(!smGlyphMutex)
+      smGlyphMutex = Mutex::createMutex();
 }
 
 GFont::~GFont()
 {
+   // Let the jobs finish with the platform font, and take their bitmaps.
+   if(mGlyphJobs.size())
+   {
+      gThreadPool->waitForCounter(&mGlyphCounter);
+      commitGlyphs();
+   }
+
+   dglFlushTextCache(this);
+
    if(mNeedSave)
    {
       FileStream stream;
@@ -436,8 +472,6 @@ GFont::~GFont()
    }
 
    SAFE_DELETE(mPlatformFont);
-   
-   Mutex::destroyMutex(mMutex);
 }
 
 void GFont::dumpInfo()
@@ -475,7 +509,7 @@ bool GFont::loadCharInfo(const UTF16 ch)
 
     if(mPlatformFont && mPlatformFont->isValidChar(ch))
     {
-        Mutex::lockMutex(mMutex); // the CharInfo returned by mPlatformFont is static data, must protect from changes.
+        Mutex::lockMutex(smGlyphMutex); // the CharInfo returned by mPlatformFont is static data, must protect from changes.
         PlatformFont::CharInfo &ci = mPlatformFont->getCharInfo(ch);
         if(ci.bitmapData)
             addBitmap(ci);
@@ -485,13 +519,92 @@ bool GFont::loadCharInfo(const UTF16 ch)
         
         mNeedSave = true;
 
-        Mutex::unlockMutex(mMutex);
+        Mutex::unlockMutex(smGlyphMutex);
         return true;
     }
 
     return false;
 }
 
+void GFont::queueGlyph(const UTF16 ch)
+{
+   if(!mPlatformFont->isValidChar(ch))
+      return;
+
+   if(!mPlaceholder.xIncrement)
+      mPlaceholder.xIncrement = mHeight;
+
+   GlyphJob *job = new GlyphJob;
+   job->font = this;
+   job->ch   = ch;
+   job->done = 0;
+   mGlyphJobs.push_back(job);
+   mRemapTable[ch] = PendingGlyph;
+   gThreadPool->queueWorkItem(job, &mGlyphCounter);
+}
+
+void GFont::commitGlyphs()
+{
+   bool committed = false;
+   for(S32 i = 0; i < mGlyphJobs.size(); )
+   {
+      GlyphJob *job = mGlyphJobs[i];
+      if(!dAtomicRead(job->done))
+      {
+         i++;
+         continue;
+      }
+
+      if(job->info.bitmapData)
+         addBitmap(job->info);
+      mCharInfoList.push_back(job->info);
+      mRemapTable[job->ch] = mCharInfoList.size() - 1;
+      mNeedSave = true;
+      committed = true;
+
+      delete job;
+      mGlyphJobs.erase_fast(i);
+   }
+
+   // The runs drawn with placeholders have the wrong advances.
+   if(committed)
+      dglFlushTextCache(this);
+}
+
+void GFont::markDirty(S32 sheet, const RectI &rect)
+{
+   while(mDirtyRects.size() <= sheet)
+   {
+      mDirtyRects.increment();
+      mDirtyRects.last().set(0, 0, 0, 0);
+   }
+
+   RectI &dirty = mDirtyRects[sheet];
+   if(dirty.extent.x == 0 || dirty.extent.y == 0)
+   {
+      dirty = rect;
+      return;
+   }
+
+   Point2I lo(getMin(dirty.point.x, rect.point.x), getMin(dirty.point.y, rect.point.y));
+   Point2I hi(getMax(dirty.point.x + dirty.extent.x, rect.point.x + rect.extent.x),
+              getMax(dirty.point.y + dirty.extent.y, rect.point.y + rect.extent.y));
+   dirty.set(lo, hi - lo);
+}
+
+void GFont::flushSheets()
+{
+   for(S32 i = 0; i < mDirtyRects.size(); i++)
+   {
+      RectI &dirty = mDirtyRects[i];
+      if(dirty.extent.x == 0 || dirty.extent.y == 0 || i >= mTextureSheets.size())
+         continue;
+
+      mTextureSheets[i].refreshRect(dirty);
+      dirty.set(0, 0, 0, 0);
+   }
+}
+
 void GFont::addBitmap(PlatformFont::CharInfo &charInfo)
 {
    U32 nextCurX = U32(mCurX + charInfo.width ); /*7) & ~0x3;*/
@@ -548,7 +661,9 @@ void GFont::addBitmap(PlatformFont::CharInfo &charInfo)
       for(x = 0;x < charInfo.width;x++)
          *bmp->getAddress(x + charInfo.xOffset, y + charInfo.yOffset) = charInfo.bitmapData[y * charInfo.width + x];
 
-   mTextureSheets[mCurSheet].refresh();
+   // Uploaded along with the rest of the frame's glyphs in flushSheets(),
+   //  rather than the whole sheet for every character.
+   markDirty(mCurSheet, RectI(charInfo.xOffset, charInfo.yOffset, charInfo.width, charInfo.height));
 }
 
 void GFont::addSheet()
@@ -585,7 +700,12 @@ const PlatformFont::CharInfo &GFont::getCharInfo(const UTF16 in_charIndex) const
     if(mRemapTable[in_charIndex] == -1)
     {
 		// getCharInfo() is const to the outside world, so we cast away the const here
-        const_cast<GFont *>(this)->loadCharInfo(in_charIndex);
+        GFont *font = const_cast<GFont *>(this);
+        if(smBackgroundGlyphs && mPlatformFont && gThreadPool && gThreadPool->isThreaded() &&
+           Thread::isMainThread())
+           font->queueGlyph(in_charIndex);
+        else
+           font->loadCharInfo(in_charIndex);
     }
 
     AssertFatal(mRemapTable[in_charIndex] != -1, "No remap info for this character");
@@ -594,6 +714,8 @@ const PlatformFont::CharInfo &GFont::getCharInfo(const UTF16 in_charIndex) const
     
    if(mRemapTable[in_charIndex] == -1)
       return getDefaultCharInfo();
+   else if(mRemapTable[in_charIndex] == PendingGlyph)
+      return mPlaceholder;
    else
       return mCharInfoList[mRemapTable[in_charIndex]];
 }
@@ -924,6 +1046,13 @@ bool GFont::read(Stream& io_rStream)
 
 bool GFont::write(Stream& stream)
 {
+    // Glyphs still rasterizing go in with the rest.
+    if(mGlyphJobs.size())
+    {
+       gThreadPool->waitForCounter(&mGlyphCounter);
+       commitGlyphs();
+    }
+
     // Handle versioning
     stream.write(csm_fileVersion);
 
@@ -1083,6 +1212,7 @@ void GFont::importStrip(const char *fileName, U32 padding, U32 kerning)
    // Wipe our texture sheets.
    mCurSheet = mCurX = mCurY = 0;
    mTextureSheets.clear();
+   mDirtyRects.clear();
 
    //  Now, load the font strip.
    GBitmap *strip = GBitmap::load(fileName);
@@ -26,6 +26,10 @@
 #include "core/resManager.h"
 #endif
 
+#ifndef _THREADPOOL_H_
+#include "core/threadPool.h"
+#endif
+
 #include "dgl/gTexManager.h"
 
 extern ResourceInstance* constructFont(Stream& stream);
@@ -48,6 +52,10 @@ public:
       TextureSheetSize = 256,
    };
 
+   /// $pref::Font::backgroundGlyphs - rasterize missing glyphs on the
+   /// thread pool, drawing a blank of the font's height until they're in.
+   static bool smBackgroundGlyphs;
+
 
    // Enumerations and structures available to derived classes
 private:
@@ -72,7 +80,27 @@ private:
    Vector<PlatformFont::CharInfo>  mCharInfoList;       // - List of character info structures, must
                                           //    be accessed through the getCharInfo(U32)
                                           //    function to account for remapping...
-   S32             mRemapTable[65536];    // - Index remapping
+   S32             mRemapTable[65536];    // - Index remapping, -1 if not loaded,
+                                          //    PendingGlyph while a job has it
+
+   /// Part of each sheet's bitmap that changed since it was last uploaded,
+   /// with an extent of 0 if none.  flushSheets() uploads them.
+   Vector<RectI> mDirtyRects;
+
+   /// @name Background glyphs
+   /// @{
+   enum { PendingGlyph = -2 };
+   struct GlyphJob;
+   Vector<GlyphJob*>   mGlyphJobs;
+   ThreadPool::Counter mGlyphCounter;
+   PlatformFont::CharInfo mPlaceholder;   ///< Stands in for a pending glyph.
+
+   /// The platform fonts hand back a CharInfo of their own static data,
+   /// shared by every font, so rasterizing is one at a time.
+   static void *smGlyphMutex;
+
+   void queueGlyph(const UTF16 ch);
+   /// @}
 public:
    GFont();
    virtual ~GFont();
@@ -82,8 +110,7 @@ protected:
     void addBitmap(PlatformFont::CharInfo &charInfo);
     void addSheet(void);
     void assignSheet(S32 sheetNum, GBitmap *bmp);
-
-    void *mMutex;
+    void markDirty(S32 sheet, const RectI &rect);
 
 public:
    static Resource<GFont> create(const char *faceName, U32 size, const char *cacheDirectory, U32 charset = TGE_ANSI_CHARSET);
@@ -93,6 +120,15 @@ public:
        return mTextureSheets[index];
    }
 
+   /// Uploads the parts of the sheets new glyphs went into.  Call before
+   /// drawing from them.
+   void flushSheets();
+
+   /// Puts the glyphs that finished rasterizing in the background into the
+   /// sheets, on the main thread.  Text laid out with their placeholders
+   /// is flushed from the dgl text cache.
+   void commitGlyphs();
+
    /// While this is const to the outside world, it calls loadCharInfo() to load char info as it is used
    const PlatformFont::CharInfo& getCharInfo(const UTF16 in_charIndex) const;
    
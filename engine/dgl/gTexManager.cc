@@ -11,11 +11,21 @@
 #include "dgl/gBitmap.h"
 #include "dgl/gPalette.h"
 #include "dgl/gTexManager.h"
+#include "math/mRect.h"
 #include "console/console.h"
 #include "console/consoleInternal.h"
 #include "console/consoleTypes.h"
 #include "dgl/gChunkedTexManager.h"
 #include "util/safeDelete.h"
+#include "platform/profiler.h"
+#include "core/frameStats.h"
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT   0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT  0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT  0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT  0x83F3
+#endif
 
 //------------------------------------------------------------------------------
 
@@ -37,6 +47,9 @@ bool TextureManager::smUseSmallTextures = false;
 bool TextureManager::smIsZombie = false;
 bool TextureManager::smTextureManagerActive = false;
 
+U32  TextureManager::smFrame = 0;
+S32  TextureManager::smResidentBytes = 0;
+
 //--------------------------------------------------------------------------
 //-------------------------------------- Texture detailing control variables
 //                                        0: Highest
@@ -70,6 +83,23 @@ F32    sgTextureAnisotropy    = 0.0; // default aniso, when available.  not sure
 bool   sgDisableSubImage      = false;
 bool   sgTextureTrilinear      = false;
 
+bool   sgLoadDDS                = true;
+bool   sgTextureStreaming       = false;
+S32    sgTextureUploadKB        = 1024;
+S32    sgTexturePlaceholderSize = 32;
+S32    sgTextureBudget          = 0;    // MB, 0 for no budget
+S32    sgTextureEvictFrames     = 60;
+
+/// Textures waiting for TextureManager::uploadFullTexture().
+Vector<TextureObject*> sgUploadQueue(__FILE__, __LINE__);
+
+/// Types that use a precompressed .dds when there is one.  They're the ones
+/// whose bits aren't touched after loading.
+bool allowsCompressed(TextureHandleType type)
+{
+   return type == MeshTexture || type == InteriorTexture || type == SkyTexture;
+}
+
 // valid texture extensions
 #define EXT_ARRAY_SIZE 6
 static const char* extArray[EXT_ARRAY_SIZE] = { "", ".jpg", ".png", ".gif", ".bmp", "" };
@@ -169,6 +199,7 @@ struct TextureDictionary
 
    static void insert(TextureObject *object);
    static TextureObject *find(StringTableEntry name, TextureHandleType type, bool clamp);
+   static TextureObject *find(StringTableEntry name);
    static void remove(TextureObject *object);
    static S32 clearHolds();
 };
@@ -193,6 +224,14 @@ void TextureDictionary::create()
 
    Con::addVariable("$pref::OpenGL::textureTrilinear",     TypeBool, &sgTextureTrilinear);
    Con::addVariable("$pref::OpenGL::textureAnisotropy",    TypeF32,  &sgTextureAnisotropy);
+
+   Con::addVariable("$pref::OpenGL::loadDDS",                TypeBool, &sgLoadDDS);
+   Con::addVariable("$pref::OpenGL::textureStreaming",       TypeBool, &sgTextureStreaming);
+   Con::addVariable("$pref::OpenGL::textureUploadKB",        TypeS32,  &sgTextureUploadKB);
+   Con::addVariable("$pref::OpenGL::texturePlaceholderSize", TypeS32,  &sgTexturePlaceholderSize);
+   Con::addVariable("$pref::OpenGL::textureBudget",          TypeS32,  &sgTextureBudget);
+   Con::addVariable("$pref::OpenGL::textureEvictFrames",     TypeS32,  &sgTextureEvictFrames);
+   Con::addVariable("$OpenGL::textureResidentBytes",         TypeS32,  &TextureManager::smResidentBytes);
 }
 
 
@@ -207,6 +246,16 @@ TextureObject *TextureDictionary::find(StringTableEntry name, TextureHandleType
    return walk;
 }
 
+TextureObject *TextureDictionary::find(StringTableEntry name)
+{
+   U32 key = HashPointer(name) % smHashTableSize;
+   TextureObject *walk = smTable[key];
+   for(; walk; walk = walk->hashNext)
+      if(walk->texFileName == name)
+         break;
+   return walk;
+}
+
 
 //--------------------------------------
 void TextureDictionary::remove(TextureObject *object)
@@ -374,6 +423,7 @@ void TextureManager::destroy()
 {
    AssertISV(smTextureManagerActive, "TextureManager::destroy - nothing to destroy!");
 
+   releasePrefetchedBitmaps();
    TextureDictionary::destroy();
 
    AssertFatal(sgEventCallbacks.size() == 0,
@@ -422,6 +472,10 @@ void TextureManager::makeZombie()
       probe->texGLName      = 0;
       probe->smallTexGLName = 0;
 
+      smResidentBytes      -= probe->residentBytes;
+      probe->residentBytes  = 0;
+      probe->lowRes         = false;
+
       probe = probe->next;
    }
 
@@ -479,7 +533,7 @@ void TextureManager::resurrect()
 
       // Ok, what we have here is the object, with the right name, we need to load the
       // bitmap, and register the texture
-      GBitmap *bmp = loadBitmapInstance(probe->texFileName);
+      GBitmap *bmp = loadBitmapInstance(probe->texFileName, true, allowsCompressed(probe->type));
       AssertISV(bmp != NULL, "Error resurrecting the texture cache.\n"
                 "Possible cause: a bitmap was deleted during the course of gameplay.");
 
@@ -579,24 +633,33 @@ GBitmap* TextureManager::createPaddedBitmap(GBitmap* pBitmap)
 
 
 //------------------------------------------------------------------------------
-GBitmap* TextureManager::createMipBitmap(const GBitmap* pBitmap)
+GBitmap* TextureManager::createMipBitmap(const GBitmap* pBitmap, U32 firstMip)
 {
    AssertFatal(pBitmap != NULL, "Error, no bitmap");
-   AssertFatal(pBitmap->getNumMipLevels() != 1, "Error, no mips to maintain");
+   AssertFatal(firstMip < pBitmap->getNumMipLevels(), "Error, no mips to maintain");
 
-   GBitmap* pRetBitmap = new GBitmap(pBitmap->getWidth(1),
-                                     pBitmap->getHeight(1),
-                                     true,
-                                     pBitmap->getFormat());
+   U32 numMips = pBitmap->getNumMipLevels() - firstMip;
 
-   for (U32 i = 1; i < pBitmap->getNumMipLevels(); i++)
+   GBitmap* pRetBitmap = new GBitmap;
+   if (pBitmap->isCompressed())
+      pRetBitmap->allocateCompressedBitmap(pBitmap->getWidth(firstMip),
+                                           pBitmap->getHeight(firstMip),
+                                           numMips,
+                                           pBitmap->getFormat());
+   else
+      pRetBitmap->allocateBitmap(pBitmap->getWidth(firstMip),
+                                 pBitmap->getHeight(firstMip),
+                                 numMips > 1,
+                                 pBitmap->getFormat());
+
+   AssertFatal(pRetBitmap->getNumMipLevels() == numMips, "Error, mip chain doesn't end at 1x1");
+
+   for (U32 i = firstMip; i < pBitmap->getNumMipLevels(); i++)
    {
-      void* pDest      = pRetBitmap->getWritableBits(i - 1);
+      void* pDest      = pRetBitmap->getWritableBits(i - firstMip);
       const void* pSrc = pBitmap->getBits(i);
 
-      dMemcpy(pDest, pSrc, (pBitmap->getWidth(i)  *
-                            pBitmap->getHeight(i) *
-                            pBitmap->bytesPerPixel));
+      dMemcpy(pDest, pSrc, pBitmap->getMipSize(i));
    }
 
    return pRetBitmap;
@@ -616,6 +679,20 @@ void TextureManager::freeTexture(TextureObject *to)
    if((gDGLRender || sgResurrect) && to->smallTexGLName)
       glDeleteTextures(1, (const GLuint*)&to->smallTexGLName);
 
+   if (to->uploadQueued)
+   {
+      for (U32 i = 0; i < sgUploadQueue.size(); i++)
+      {
+         if (sgUploadQueue[i] == to)
+         {
+            sgUploadQueue.erase(i);
+            break;
+         }
+      }
+   }
+   smResidentBytes -= to->residentBytes;
+
+   SAFE_DELETE( to->placeholder );
    SAFE_DELETE( to->bitmap );
    TextureDictionary::remove(to);
    SAFE_DELETE( to );
@@ -623,12 +700,26 @@ void TextureManager::freeTexture(TextureObject *to)
 
 
 //------------------------------------------------------------------------------
-static void getSourceDestByteFormat(GBitmap *pBitmap, U32 *sourceFormat, U32 *destFormat, U32 *byteFormat)
+static void getSourceDestByteFormat(GBitmap *pBitmap, U32 *sourceFormat, U32 *destFormat, U32 *byteFormat, bool compress = false)
 {
    *byteFormat = GL_UNSIGNED_BYTE;
 
    switch(pBitmap->getFormat()) 
    {
+      // already compressed, uploaded as is
+      case GBitmap::DXT1:
+         *sourceFormat = *destFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+         return;
+      case GBitmap::DXT1A:
+         *sourceFormat = *destFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+         return;
+      case GBitmap::DXT3:
+         *sourceFormat = *destFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+         return;
+      case GBitmap::DXT5:
+         *sourceFormat = *destFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+         return;
+
       case GBitmap::Intensity:
          *sourceFormat = GL_INTENSITY;
          break;
@@ -669,9 +760,9 @@ static void getSourceDestByteFormat(GBitmap *pBitmap, U32 *sourceFormat, U32 *de
       else
          *destFormat = GL_COLOR_INDEX8_EXT;
 
-      if (pBitmap->getNumMipLevels() > 1 &&
+      if (((pBitmap->getNumMipLevels() > 1 && sgAllowTexCompression) || compress) &&
           pBitmap->getFormat() != GBitmap::Palettized &&
-          (sgAllowTexCompression && dglDoesSupportTextureCompression()))
+          dglDoesSupportTextureCompression())
       {
          if (*sourceFormat == GL_RGB)
             *destFormat = GL_COMPRESSED_RGB_ARB;
@@ -711,10 +802,11 @@ void TextureManager::refresh(TextureObject *to)
    if (!(gDGLRender || sgResurrect))
       return;
 
+   STAT_INC(TextureUploads);
    U32 sourceFormat, destFormat, byteFormat;
    GBitmap *pBitmap = to->bitmap;
 
-   getSourceDestByteFormat(pBitmap, &sourceFormat, &destFormat, &byteFormat);
+   getSourceDestByteFormat(pBitmap, &sourceFormat, &destFormat, &byteFormat, to->compress);
 
    if (!to->texGLName)
       glGenTextures(1,&to->texGLName);
@@ -826,14 +918,51 @@ void TextureManager::refresh(TextureObject *to)
       delete pDL;
 }
 
+void TextureManager::refreshRect(TextureObject *to, const RectI &rect)
+{
+   if (!(gDGLRender || sgResurrect))
+      return;
+
+   GBitmap *pBitmap = to->bitmap;
+   AssertFatal(pBitmap, "TextureManager::refreshRect: the bitmap wasn't kept.");
+
+   bool singleLevel = to->type == BitmapTexture ||
+                      to->type == BitmapKeepTexture ||
+                      to->type == BitmapNoDownloadTexture;
+   if (sgDisableSubImage || !to->texGLName || !singleLevel ||
+       to->texWidth != pBitmap->getWidth() || to->texHeight != pBitmap->getHeight() ||
+       pBitmap->getFormat() == GBitmap::Palettized || pBitmap->getFormat() >= GBitmap::DXT1)
+   {
+      refresh(to);
+      return;
+   }
+
+   STAT_INC(TextureUploads);
+   U32 sourceFormat, destFormat, byteFormat;
+   getSourceDestByteFormat(pBitmap, &sourceFormat, &destFormat, &byteFormat, to->compress);
+
+   glBindTexture(GL_TEXTURE_2D, to->texGLName);
+   glPixelStorei(GL_UNPACK_ROW_LENGTH, pBitmap->getWidth());
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   glTexSubImage2D(GL_TEXTURE_2D, 0,
+                   rect.point.x, rect.point.y,
+                   rect.extent.x, rect.extent.y,
+                   sourceFormat,
+                   byteFormat,
+                   pBitmap->getAddress(rect.point.x, rect.point.y));
+   glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
 void TextureManager::refresh(TextureObject *to, GBitmap* bmp)
 {
    if (!(gDGLRender || sgResurrect)) return;
 
+   STAT_INC(TextureUploads);
    U32 sourceFormat, destFormat, byteFormat;
    GBitmap* pBitmap = bmp;
 
-   getSourceDestByteFormat(pBitmap, &sourceFormat, &destFormat, &byteFormat);
+   getSourceDestByteFormat(pBitmap, &sourceFormat, &destFormat, &byteFormat, to->compress);
 
    if (!to->texGLName)
       glGenTextures(1,&to->texGLName);
@@ -946,21 +1075,64 @@ void TextureManager::refresh(TextureObject *to, GBitmap* bmp)
 }
 
 //--------------------------------------
+/// Downloads mips [firstMip, endMip) of pDL into the bound texture, and
+/// returns their size.
+static U32 downloadMips(GBitmap *pDL, U32 firstMip, U32 endMip,
+                        U32 sourceFormat, U32 destFormat, U32 byteFormat)
+{
+   STAT_INC(TextureUploads);
+   U32 bytes = 0;
+   for (U32 i = firstMip; i < endMip; i++)
+   {
+      if (pDL->isCompressed())
+      {
+         glCompressedTexImage2DARB(GL_TEXTURE_2D,
+                                   i - firstMip,
+                                   destFormat,
+                                   pDL->getWidth(i), pDL->getHeight(i),
+                                   0,
+                                   pDL->getMipSize(i),
+                                   pDL->getBits(i));
+      }
+      else
+      {
+         glTexImage2D(GL_TEXTURE_2D,
+                      i - firstMip,
+                      destFormat,
+                      pDL->getWidth(i), pDL->getHeight(i),
+                      0,
+                      sourceFormat,
+                      byteFormat,
+                      pDL->getBits(i));
+      }
+      bytes += pDL->getMipSize(i);
+   }
+
+   // A .dds can stop short of 1x1
+   U32 lastMip = endMip - 1;
+   if (endMip - firstMip > 1 && (pDL->getWidth(lastMip) > 1 || pDL->getHeight(lastMip) > 1))
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, lastMip - firstMip);
+
+   return bytes;
+}
+
 bool TextureManager::createGLName(GBitmap*          pBitmap,
                                   bool              clampToEdge,
                                   U32               firstMip,
                                   TextureHandleType type,
-                                  TextureObject*    to)
+                                  TextureObject*    to,
+                                  bool              smallTexture)
 {
    if (!(gDGLRender || sgResurrect))
       return 0;
 
-   glGenTextures(1, &to->texGLName);
+   if (!to->texGLName)
+      glGenTextures(1, &to->texGLName);
    glBindTexture(GL_TEXTURE_2D, to->texGLName);
 
    U32 sourceFormat, destFormat, byteFormat;
 
-   getSourceDestByteFormat(pBitmap, &sourceFormat, &destFormat, &byteFormat);
+   getSourceDestByteFormat(pBitmap, &sourceFormat, &destFormat, &byteFormat, to->compress);
 
    GBitmap *pDL = createPaddedBitmap(pBitmap);
 
@@ -982,17 +1154,7 @@ bool TextureManager::createGLName(GBitmap*          pBitmap,
                       pDL->getPalette()->getColors());
    }
 
-   for (U32 i = firstMip; i < maxDownloadMip; i++)
-   {
-      glTexImage2D(GL_TEXTURE_2D,
-                   i - firstMip,
-                   destFormat,
-                   pDL->getWidth(i), pDL->getHeight(i),
-                   0,
-                   sourceFormat,
-                   byteFormat,
-                   pDL->getBits(i));
-   }
+   U32 bytes = downloadMips(pDL, firstMip, maxDownloadMip, sourceFormat, destFormat, byteFormat);
 
    if(to->filterNearest)
    {
@@ -1031,10 +1193,12 @@ bool TextureManager::createGLName(GBitmap*          pBitmap,
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, clamp);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, clamp);
 
-   if ((type == InteriorTexture || type == MeshTexture) &&
+   if (smallTexture &&
+       (type == InteriorTexture || type == MeshTexture) &&
        (pDL->getNumMipLevels() - firstMip) > 4)
    {
-      glGenTextures(1, &to->smallTexGLName);
+      if (!to->smallTexGLName)
+         glGenTextures(1, &to->smallTexGLName);
       glBindTexture(GL_TEXTURE_2D, to->smallTexGLName);
 
       if (pDL->getFormat() == GBitmap::Palettized)
@@ -1047,17 +1211,7 @@ bool TextureManager::createGLName(GBitmap*          pBitmap,
                          pDL->getPalette()->getColors());
       }
 
-      for (U32 i = firstMip + 4; i < maxDownloadMip; i++)
-      {
-         glTexImage2D(GL_TEXTURE_2D,
-                      i - (firstMip + 4),
-                      destFormat,
-                      pDL->getWidth(i), pDL->getHeight(i),
-                      0,
-                      sourceFormat,
-                      byteFormat,
-                      pDL->getBits(i));
-      }
+      bytes += downloadMips(pDL, firstMip + 4, maxDownloadMip, sourceFormat, destFormat, byteFormat);
 
       glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
       if (sgTextureTrilinear)
@@ -1081,6 +1235,9 @@ bool TextureManager::createGLName(GBitmap*          pBitmap,
    if(pDL != pBitmap)
       delete pDL;
 
+   smResidentBytes   += S32(bytes) - S32(to->residentBytes);
+   to->residentBytes  = bytes;
+
    return to->texGLName != 0;
 }
 
@@ -1089,6 +1246,7 @@ bool TextureManager::createGLName(GBitmap*          pBitmap,
 //------------------------------------------------------------------------------
 TextureObject* TextureManager::registerTexture(const char* textureName, const GBitmap* data, bool clampToEdge)
 {
+   MemoryTagScope tagScope(Memory::TagTexture);
     //WARNING: since there's no texture type here, there's no way to tell
     //if it is an inverted bump texture, which would cause it NOT to invert!
     //but, this appears to only be used for RegisteredTextures
@@ -1160,6 +1318,7 @@ TextureObject* TextureManager::registerTexture(const char* textureName, const GB
 //--------------------------------------
 TextureObject* TextureManager::registerTexture(const char* textureName, GBitmap* bmp, TextureHandleType type, bool clampToEdge)
 {
+   MemoryTagScope tagScope(Memory::TagTexture);
    //Get this done and out of the way first - if it's an inverted texture,
    //then invert it!  Do it in this function because resurrect() calls this directly
    if( type == InvertedBumpTexture )
@@ -1283,14 +1442,36 @@ TextureObject* TextureManager::registerTexture(const char* textureName, GBitmap*
       smTextureSpaceLoaded += ret->textureSpace;
 #endif
 
+      ret->firstMip      = firstMip;
+      ret->lowRes        = false;
+      ret->lastUsedFrame = smFrame;
+      SAFE_DELETE(ret->placeholder);
+
       if(ret->type != BitmapNoDownloadTexture)
-         createGLName(bmp, clampToEdge, firstMip, ret->type, ret);
+      {
+         U32 placeholderMip = getPlaceholderMip(ret, bmp, firstMip);
+         if (placeholderMip != firstMip)
+            ret->placeholder = createMipBitmap(bmp, placeholderMip);
+
+         if (ret->placeholder && sgTextureStreaming)
+         {
+            createGLName(ret->placeholder, clampToEdge, 0, ret->type, ret, false);
+            ret->lowRes = true;
+            queueUpload(ret);
+         }
+         else
+            createGLName(bmp, clampToEdge, firstMip, ret->type, ret);
+      }
    }
 
    if (ret->type == BitmapKeepTexture || ret->type == BitmapNoDownloadTexture) 
    {
       // do nothing
    }
+   else if (ret->lowRes && ret->uploadQueued)
+   {
+      // Kept for uploadFullTexture()
+   }
    else if (ret->type == TerrainTexture) 
    {
       // Don't delete the bitmap
@@ -1307,14 +1488,65 @@ TextureObject* TextureManager::registerTexture(const char* textureName, GBitmap*
 
 
 //--------------------------------------
-GBitmap *TextureManager::loadBitmapInstance(const char *textureName, bool recurse /* = true */)
+static Vector<ResourceObject *> sgPrefetchedBitmaps;
+
+void TextureManager::addPrefetchedBitmap(ResourceObject *obj)
+{
+   sgPrefetchedBitmaps.push_back(obj);
+}
+
+void TextureManager::releasePrefetchedBitmaps()
+{
+   for (U32 i = 0; i < sgPrefetchedBitmaps.size(); i++)
+      ResourceManager->unlock(sgPrefetchedBitmaps[i]);
+   sgPrefetchedBitmaps.clear();
+}
+
+bool TextureManager::isTextureLoaded(const char *textureName)
+{
+   return smTextureManagerActive && TextureDictionary::find(StringTable->insert(textureName)) != NULL;
+}
+
+static GBitmap *claimPrefetchedBitmap(const char *fileName)
+{
+   if (!sgPrefetchedBitmaps.size())
+      return NULL;
+
+   ResourceObject *obj = ResourceManager->find(fileName);
+   if (!obj)
+      return NULL;
+
+   for (U32 i = 0; i < sgPrefetchedBitmaps.size(); i++)
+      if (sgPrefetchedBitmaps[i] == obj)
+      {
+         sgPrefetchedBitmaps.erase_fast(i);
+         return (GBitmap*)ResourceManager->detachInstance(obj);
+      }
+   return NULL;
+}
+
+//--------------------------------------
+GBitmap *TextureManager::loadBitmapInstance(const char *textureName, bool recurse /* = true */, bool allowCompressed /* = false */)
 {
    char fileNameBuffer[512];
    dStrcpy(fileNameBuffer, textureName);
    GBitmap *bmp = NULL;
 
-   // Loop through the supported extensions to find the file.
+   allowCompressed = allowCompressed && sgLoadDDS &&
+                     dglDoesSupportS3TC() && dglDoesSupportTextureCompression();
+
+   // A precompressed file comes with its mips and goes straight to the card,
+   // so it wins over the other formats.
    U32 len = dStrlen(fileNameBuffer);
+   if (allowCompressed)
+   {
+      dStrcpy(fileNameBuffer + len, ".dds");
+      bmp = claimPrefetchedBitmap(fileNameBuffer);
+      if (!bmp)
+         bmp = (GBitmap*)ResourceManager->loadInstance(fileNameBuffer);
+   }
+
+   // Loop through the supported extensions to find the file.
    for (U32 i = 0; i < EXT_ARRAY_SIZE && bmp == NULL; i++)
    {
 
@@ -1323,7 +1555,16 @@ GBitmap *TextureManager::loadBitmapInstance(const char *textureName, bool recurs
       else
          dStrcpy(fileNameBuffer + len, extArray[i]);
 
-      bmp = (GBitmap*)ResourceManager->loadInstance(fileNameBuffer);
+      bmp = claimPrefetchedBitmap(fileNameBuffer);
+      if (!bmp)
+         bmp = (GBitmap*)ResourceManager->loadInstance(fileNameBuffer);
+
+      // Named with its .dds extension, but not somewhere it can be used
+      if (bmp && bmp->isCompressed() && !allowCompressed)
+      {
+         Con::warnf("TextureManager: can't use compressed texture %s here.", fileNameBuffer);
+         SAFE_DELETE(bmp);
+      }
 
       // CAF: if a jpg, and RGB, look for file.alpha.jpg as alpha channel
       if ( (!sgForcePalettedTexture || !dglDoesSupportPalettedTexture()) && !dStricmp(extArray[i],".jpg") && bmp && bmp->getFormat()==GBitmap::RGB)
@@ -1335,19 +1576,7 @@ GBitmap *TextureManager::loadBitmapInstance(const char *textureName, bool recurs
          if (bmpAlpha && bmpAlpha->getWidth() == w && bmpAlpha->getHeight() == h && bmpAlpha->bytesPerPixel==1)
          {
             GBitmap * bmp2 = new GBitmap(w,h,false,GBitmap::RGBA);
-            U8 * rgbBits = bmp->getWritableBits();
-            U8 * alphaBits = bmpAlpha->getWritableBits();
-            U8 * bmpBits = bmp2->getWritableBits();
-            for (S32 wi=0; wi<w; wi++)
-            {
-               for (S32 hi=0; hi<h; hi++)
-               {
-                  bmpBits[wi*4 + hi*4*w + 0] = rgbBits[wi*3 + hi*3*w + 0];
-                  bmpBits[wi*4 + hi*4*w + 1] = rgbBits[wi*3 + hi*3*w + 1];
-                  bmpBits[wi*4 + hi*4*w + 2] = rgbBits[wi*3 + hi*3*w + 2];
-                  bmpBits[wi*4 + hi*4*w + 3] = alphaBits[wi + hi*w];
-               }
-            }
+            bitmapConvertRGB_to_RGBA(bmp->getBits(), bmpAlpha->getBits(), bmp2->getWritableBits(), w * h);
             delete bmpAlpha;
             delete bmp;
             bmp = bmp2;
@@ -1369,7 +1598,7 @@ GBitmap *TextureManager::loadBitmapInstance(const char *textureName, bool recurs
          {
             parent[1] = 0;
             dStrcat(fileNameBuffer, name);
-            return loadBitmapInstance(fileNameBuffer);
+            return loadBitmapInstance(fileNameBuffer, true, allowCompressed);
          }
       }
    }
@@ -1380,6 +1609,7 @@ GBitmap *TextureManager::loadBitmapInstance(const char *textureName, bool recurs
 
 TextureObject *TextureManager::loadTexture(const char* textureName, TextureHandleType type, bool clampToEdge, bool checkOnly /* = false */)
 {
+   MemoryTagScope tagScope(Memory::TagTexture);
    // Catch if we're trying to load a blank texture...
    if(!textureName || dStrlen(textureName) == 0)
       return NULL;
@@ -1394,7 +1624,7 @@ TextureObject *TextureManager::loadTexture(const char* textureName, TextureHandl
    {
       // Ok, no hit - is it in the current dir? If so then let's grab it
       // and use it.
-      bmp = loadBitmapInstance(textureName, false);
+      bmp = loadBitmapInstance(textureName, false, allowsCompressed(type));
 
       if(bmp)
          return registerTexture(textureName, bmp, type, clampToEdge);
@@ -1432,7 +1662,7 @@ TextureObject *TextureManager::loadTexture(const char* textureName, TextureHandl
       return NULL;
 
    // Ok, no success so let's try actually loading a texture.
-   bmp = loadBitmapInstance(textureName);
+   bmp = loadBitmapInstance(textureName, true, allowsCompressed(type));
 
    if(!bmp)
    {
@@ -1444,6 +1674,133 @@ TextureObject *TextureManager::loadTexture(const char* textureName, TextureHandl
 }
 
 
+//--------------------------------------
+U32 TextureManager::getPlaceholderMip(TextureObject *to, GBitmap *bmp, U32 firstMip)
+{
+   // Only types that reload the same way they were loaded
+   if (!(sgTextureStreaming || sgTextureBudget > 0) ||
+       !to->texFileName ||
+       (to->type != MeshTexture && to->type != InteriorTexture) ||
+       bmp->getFormat() == GBitmap::Palettized)
+      return firstMip;
+
+   U32 maxSize = getMax(sgTexturePlaceholderSize, 1);
+   for (U32 i = firstMip; i < bmp->getNumMipLevels(); i++)
+      if (bmp->getWidth(i) <= maxSize && bmp->getHeight(i) <= maxSize)
+         return i;
+
+   return firstMip;
+}
+
+void TextureManager::queueUpload(TextureObject *to)
+{
+   if (to->uploadQueued)
+      return;
+
+   to->uploadQueued = true;
+   sgUploadQueue.push_back(to);
+}
+
+U32 TextureManager::uploadFullTexture(TextureObject *to)
+{
+   if (!to->lowRes)
+      return 0;
+
+   GBitmap *bmp = to->bitmap;
+   if (!bmp)
+   {
+      // Evicted, so read it back in
+      bmp = loadBitmapInstance(to->texFileName, true, allowsCompressed(to->type));
+      if (!bmp)
+      {
+         // stick with the placeholder rather than trying every frame
+         Con::warnf("TextureManager: unable to reload texture %s", to->texFileName);
+         to->lowRes = false;
+         return 0;
+      }
+      bmp->extrudeMipLevels();
+   }
+
+   U32 firstMip = getMin(to->firstMip, bmp->getNumMipLevels() - 1);
+   createGLName(bmp, to->clamp, firstMip, to->type, to);
+   to->lowRes = false;
+
+   delete bmp;
+   to->bitmap = NULL;
+
+   // Nothing will evict it, so the placeholder isn't needed any more
+   if (sgTextureBudget <= 0)
+      SAFE_DELETE(to->placeholder);
+
+   return to->residentBytes;
+}
+
+static S32 QSORT_CALLBACK compareLastUsed(const void *a, const void *b)
+{
+   const TextureObject *ta = *((const TextureObject **) a);
+   const TextureObject *tb = *((const TextureObject **) b);
+   return S32(ta->lastUsedFrame - tb->lastUsedFrame);
+}
+
+void TextureManager::evictTextures(U32 budget)
+{
+   Vector<TextureObject*> candidates;
+
+   for (TextureObject *probe = TextureDictionary::smTOList; probe; probe = probe->next)
+   {
+      if (probe->placeholder && !probe->lowRes && probe->texGLName &&
+          probe->lastUsedFrame + sgTextureEvictFrames < smFrame)
+         candidates.push_back(probe);
+   }
+
+   dQsort(candidates.address(), candidates.size(), sizeof(TextureObject*), compareLastUsed);
+
+   for (U32 i = 0; i < candidates.size() && U32(smResidentBytes) > budget; i++)
+   {
+      // A new GL name, so the driver lets go of the big mips
+      TextureObject *to = candidates[i];
+      glDeleteTextures(1, &to->texGLName);
+      to->texGLName = 0;
+
+      createGLName(to->placeholder, to->clamp, 0, to->type, to, false);
+      to->lowRes = true;
+   }
+}
+
+void TextureManager::processFrame()
+{
+   smFrame++;
+
+   if (!gDGLRender || smIsZombie || !smTextureManagerActive)
+      return;
+
+   PROFILE_START(TextureManager_processFrame);
+
+   // Always at least one, however big
+   U32 uploadBudget = U32(getMax(sgTextureUploadKB, 1)) * 1024;
+   U32 uploaded = 0;
+   while (sgUploadQueue.size() && uploaded < uploadBudget)
+   {
+      TextureObject *to = sgUploadQueue.front();
+      sgUploadQueue.pop_front();
+      to->uploadQueued = false;
+
+      uploaded += uploadFullTexture(to);
+   }
+
+   // Walking the textures isn't free, so the budget is only checked every
+   // few frames
+   if (sgTextureBudget > 0 && (smFrame & 15) == 0)
+   {
+      U32 budget = U32(sgTextureBudget) << 20;
+      if (U32(smResidentBytes) > budget)
+         evictTextures(budget);
+   }
+
+   PROFILE_END();
+}
+
+
 //--------------------------------------
 
 void TextureHandle::setFilterNearest()
@@ -20,6 +20,8 @@
 
 //-------------------------------------- Forward Decls.
 class GBitmap;
+class ResourceObject;
+class RectI;
 
 //------------------------------------------------------------------------------
 //-------------------------------------- TextureHandle
@@ -60,6 +62,12 @@ enum TextureHandleType
 class TextureObject
 {
   public:
+   TextureObject()
+      : compress(false), lastUsedFrame(0), residentBytes(0), firstMip(0),
+        placeholder(NULL), lowRes(false), uploadQueued(false)
+   {
+   }
+
    TextureObject *next;
    TextureObject *prev;
    TextureObject *hashNext;
@@ -92,6 +100,21 @@ class TextureObject
    bool              clamp;
    bool              holding;
    S32               refCount;
+
+   /// Have GL compress it even without mips and $pref::OpenGL::allowCompression.
+   /// Only for textures nothing subimages into.
+   bool              compress;
+
+   /// @name Streaming
+   /// See TextureManager::processFrame().
+   /// @{
+   U32      lastUsedFrame;    ///< TextureManager::smFrame the texture was last asked for.
+   U32      residentBytes;    ///< Size of the mips downloaded to GL.
+   U32      firstMip;         ///< Top mip of the full download, from the detail level.
+   GBitmap *placeholder;      ///< The small mips, kept so the texture can drop back to them.
+   bool     lowRes;           ///< Only the placeholder is in GL.
+   bool     uploadQueued;     ///< Waiting in the upload queue for its full mips.
+   /// @}
 };
 
 typedef void (*TextureEventCallback)(const U32 eventCode, void *userData);
@@ -120,19 +143,45 @@ struct TextureManager
    /// Deletes the texture data and removes the texture from the texture dictionary hash table and OpenGL
    static void           freeTexture(TextureObject *to);
 
-   /// Creates the OpenGL texture and sets all related GL states.
-   static bool           createGLName(GBitmap *pb, bool clampToEdge, U32 firstMip, TextureHandleType type, TextureObject* obj);
+   /// Creates the OpenGL texture and sets all related GL states.  An existing
+   /// GL name on obj is reused.
+   static bool           createGLName(GBitmap *pb, bool clampToEdge, U32 firstMip, TextureHandleType type, TextureObject* obj, bool smallTexture = true);
 
    static void           refresh(TextureObject *to);
    static void           refresh(TextureObject *to, GBitmap*);
+   /// Uploads only rect of the texture's bitmap, which it must have kept.
+   /// Anything that doesn't go up as a single unpadded level is refreshed
+   /// whole.
+   static void           refreshRect(TextureObject *to, const RectI &rect);
    
-   static GBitmap*       createMipBitmap(const GBitmap* pBitmap);
+   /// Copies the mips from firstMip down into a new bitmap.
+   static GBitmap*       createMipBitmap(const GBitmap* pBitmap, U32 firstMip = 1);
 
    /// Just in case the texture specified does not have sides of power-of-2,
    /// this function will copy the texture data into a new texture that IS power-of-2
    /// and fill in the empty areas with the adjacent pixel
    static GBitmap*       createPaddedBitmap(GBitmap* pBitmap);
 
+   /// @name Streaming
+   /// @{
+
+   static U32            smFrame;
+
+   /// If the texture can stream, returns the mip it starts out with in GL
+   /// and keeps as its placeholder, otherwise returns firstMip.
+   static U32            getPlaceholderMip(TextureObject *to, GBitmap *bmp, U32 firstMip);
+
+   static void           queueUpload(TextureObject *to);
+
+   /// Downloads the full mips of a queued texture, reloading the bitmap if it
+   /// was evicted.  Returns the bytes downloaded.
+   static U32            uploadFullTexture(TextureObject *to);
+
+   /// Drops textures that haven't been used lately to their placeholder
+   /// until smResidentBytes is under budget.
+   static void           evictTextures(U32 budget);
+   /// @}
+
 
   public:
    static void create();
@@ -183,7 +232,34 @@ struct TextureManager
 
    static void setSmallTexturesActive(const bool t) { smUseSmallTextures = t;    }
    static bool areSmallTexturesActive()             { return smUseSmallTextures; }
-   static GBitmap *loadBitmapInstance(const char *textureName, bool recurse = true);
+   /// Loads the named bitmap, trying the known extensions.  With
+   /// allowCompressed a precompressed .dds is used first when S3TC is
+   /// supported; otherwise compressed bitmaps are not returned.
+   static GBitmap *loadBitmapInstance(const char *textureName, bool recurse = true, bool allowCompressed = false);
+
+   /// Hand over a bitmap resource that was loaded ahead of time, along with
+   /// its lock.  loadBitmapInstance() takes the decoded bitmap instead of
+   /// reading the file again; releasePrefetchedBitmaps() unlocks the rest.
+   static void addPrefetchedBitmap(ResourceObject *obj);
+   static void releasePrefetchedBitmaps();
+
+   /// Is there a texture loaded from this name, of any type?
+   static bool isTextureLoaded(const char *textureName);
+
+   /// Once a frame, before rendering.  Moves queued textures up to their full
+   /// mips, at most $pref::OpenGL::textureUploadKB per frame, and keeps the
+   /// textures under $pref::OpenGL::textureBudget.
+   ///
+   /// With $pref::OpenGL::textureStreaming, mesh and interior textures are
+   /// first downloaded with only the mips no bigger than
+   /// $pref::OpenGL::texturePlaceholderSize, and get the rest from here.
+   /// When over budget, textures not bound for
+   /// $pref::OpenGL::textureEvictFrames frames go back to those mips, oldest
+   /// first, and are reloaded when they're used again.
+   static void processFrame();
+
+   /// Estimated bytes of texture in GL, all types.
+   static S32 smResidentBytes;
 
 #ifdef TORQUE_GATHER_METRICS
    static U32 smTextureSpaceLoaded;
@@ -407,6 +483,11 @@ class TextureHandle
       TextureManager::refresh(object, bmp);
    }
 
+   void refreshRect(const RectI &rect)
+   {
+      TextureManager::refreshRect(object, rect);
+   }
+
    operator TextureObject*()        { return object; }
    /// Returns the texture's filename if it exists
    const char* getName() const      { return (object ? object->texFileName      : NULL); }
@@ -435,6 +516,10 @@ inline U32 TextureHandle::getGLName() const
    if (!object)
       return 0;
 
+   object->lastUsedFrame = TextureManager::smFrame;
+   if (object->lowRes && !object->uploadQueued)
+      TextureManager::queueUpload(object);
+
    U32 useName = object->texGLName;
    if (TextureManager::areSmallTexturesActive() && object->smallTexGLName != 0)
       useName = object->smallTexGLName;
@@ -457,6 +542,10 @@ inline U32 TextureHandle::getGLName() const
    if (!object)
       return 0;
 
+   object->lastUsedFrame = TextureManager::smFrame;
+   if (object->lowRes && !object->uploadQueued)
+      TextureManager::queueUpload(object);
+
    U32 useName = object->texGLName;
    if (TextureManager::areSmallTexturesActive() && object->smallTexGLName != 0)
       useName = object->smallTexGLName;
@@ -5,6 +5,7 @@
 
 #include "dgl/stripCache.h"
 #include "platform/platformGL.h"
+#include "core/frameStats.h"
 
 void StripCache::emitStrip(const U32 start, const U32 count, const ColorI& color)
 {
@@ -44,6 +45,7 @@ void StripCache::flushCache()
 
    for (U32 i = 0; i < currStrip; i++) {
       glColor4ubv(stripColors[i]);
+      STAT_INC(DrawCalls);
       glDrawElements(GL_TRIANGLE_STRIP, stripStarts[i+1] - stripStarts[i],
                      GL_UNSIGNED_INT, &stripIndices[stripStarts[i]]);
    }
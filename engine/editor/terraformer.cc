@@ -16,12 +16,227 @@
 #include "game/gameConnection.h"
 
 #include "editor/guiTerrPreviewCtrl.h"
+#include "core/threadPool.h"
 
 IMPLEMENT_CONOBJECT(Terraformer);
 
 S32* Heightfield::zoneOffset = NULL;
 U32  Heightfield::instance = 0;
 
+//------------------------------------------------------------------------------
+// Row jobs.  Each of these reads one field and writes another, so the rows
+// can go to the thread pool in any order and come out the same.
+
+namespace {
+
+void runRows(U32 rows, ThreadPool::ParallelForFn fn, void *job)
+{
+   if (gThreadPool)
+      gThreadPool->parallelFor(rows, fn, job, 4);
+   else
+      fn(0, rows, job);
+}
+
+enum SmoothMode
+{
+   SmoothAll,
+   SmoothBelowWater,
+   SmoothRidges
+};
+
+struct SmoothJob
+{
+   Heightfield *src;
+   Heightfield *dst;
+   U32 size;
+   U32 mode;
+   F32 matrixM;
+   F32 matrixE;
+   F32 matrixC;
+   F32 water;
+   F32 threshold;
+};
+
+void smoothRows(U32 start, U32 end, void *userData)
+{
+   //  0  1  2
+   //  3 x,y 5
+   //  6  7  8
+   // read straight from the three rows, wrapping x only at the edges,
+   // instead of going through Heightfield::block() for every sample
+   const SmoothJob *job = (const SmoothJob *) userData;
+   const Heightfield *a = job->src;
+   const U32 mask = a->mask;
+
+   for (U32 y = start; y < end; y++)
+   {
+      const F32 *up  = &a->data[((y - 1) & mask) << a->shift];
+      const F32 *mid = &a->data[y << a->shift];
+      const F32 *dn  = &a->data[((y + 1) & mask) << a->shift];
+      F32 *out = &job->dst->data[y << a->shift];
+
+      for (U32 x = 0; x < job->size; x++)
+      {
+         U32 xl = (x - 1) & mask;
+         U32 xr = (x + 1) & mask;
+         F32 center = mid[x];
+
+         if (job->mode == SmoothBelowWater && center > job->water)
+         {
+            out[x] = center;
+            continue;
+         }
+
+         F32 corners = up[xl] + up[xr] + dn[xl] + dn[xr];
+         F32 edges   = up[x] + mid[xl] + mid[xr] + dn[x];
+
+         if (job->mode == SmoothRidges)
+         {
+            // if this height deviates too much from its neighboors smooth it!
+            F32 ave = (up[xl] + up[x] + up[xr] +
+                       mid[xl] +        mid[xr] +
+                       dn[xl] + dn[x] + dn[xr]) / 8.0f;
+            if (mFabs(ave - center) <= job->threshold)
+            {
+               out[x] = center;
+               continue;
+            }
+         }
+
+         out[x] = (corners * job->matrixC) + (edges * job->matrixE) + (center * job->matrixM);
+      }
+   }
+}
+
+struct TurbulenceJob
+{
+   Noise2D     *noise;
+   Heightfield *src;
+   Heightfield *dst;
+   U32 size;
+   U32 mask;
+   F32 scale;
+   F32 v;
+   F32 r;
+   U32 f;
+};
+
+void turbulenceRows(U32 start, U32 end, void *userData)
+{
+   const TurbulenceJob *job = (const TurbulenceJob *) userData;
+   for (U32 y = start; y < end; y++)
+   {
+      F32 fy = (F32)y * job->scale;
+      for (U32 x = 0; x < job->size; x++)
+      {
+         F32 fx = (F32)x * job->scale;
+         F32 t  = job->noise->turbulence(fx, fy, 32) * job->v;
+         F32 dx = job->r * mSin( t );
+         F32 dy = job->r * mCos( t );
+         job->dst->val(x, y) = job->src->val((S32)(x + dx) & job->mask, (S32)(y + dy) & job->mask);
+      }
+   }
+}
+
+void canyonRows(U32 start, U32 end, void *userData)
+{
+   const TurbulenceJob *job = (const TurbulenceJob *) userData;
+   for (U32 y = start; y < end; y++)
+   {
+      F32 fy = (F32)y/(F32)job->size;
+      for (U32 x = 0; x < job->size; x++)
+      {
+         F32 fx = (F32)x/(F32)job->size;
+         F32 t  = job->noise->turbulence(fx, fy, 32) * job->v;
+         job->dst->val(x, y) = mCos( fx*M_2PI*job->f + t );
+      }
+   }
+}
+
+enum { SinusIterations = 31 };
+
+struct SinusJob
+{
+   Noise2D     *noise;
+   Heightfield *dst;
+   U32 size;
+   U32 numWaves;
+   F32 invBlockSize;
+   F32 period[SinusIterations];
+   F32 scale[SinusIterations];
+   F32 xOffset[SinusIterations];
+   F32 yOffset[SinusIterations];
+   F32 interval[SinusIterations];
+};
+
+void sinusRows(U32 start, U32 end, void *userData)
+{
+   const SinusJob *job = (const SinusJob *) userData;
+   for (U32 y = start; y < end; y++)
+   {
+      F32 *row = &job->dst->val(0, y);
+      for (U32 x = 0; x < job->size; x++)
+         row[x] = 0;
+
+      for (U32 i = 0; i < job->numWaves; i++)
+      {
+         F32 cosy = mCos(y * job->period[i] + job->yOffset[i]);
+         F32 sqInterval = job->invBlockSize * job->interval[i];
+         for (U32 x = 0; x < job->size; x++)
+         {
+            F32 sinx = mSin(x * job->period[i] + job->xOffset[i]);
+            row[x] += job->scale[i] * (sinx + cosy) * job->noise->getValue(x * sqInterval, y * sqInterval, (S32)job->interval[i]);
+         }
+      }
+   }
+}
+
+struct FlowJob
+{
+   Heightfield *a;
+   U32 *o;
+   U32 size;
+   U32 mask;
+};
+
+void flowRows(U32 start, U32 end, void *userData)
+{
+   const FlowJob *job = (const FlowJob *) userData;
+   Heightfield *a = job->a;
+   for (S32 y = start; y < end; y++)
+   {
+      for (S32 x = 0; x < job->size; x++)
+      {
+         U32 srcOffset = a->offset(x,y);
+         F32 height    = a->val(srcOffset);
+         job->o[srcOffset] = srcOffset;
+         for (S32 y1=y-1; y1 <= y+1; y1++)
+         {
+            F32 maxDelta = 0.0f;
+            S32 ywrap = y1 & job->mask;
+            for (S32 x1=x-1; x1 <= x+1; x1++)
+            {
+               if (x1 != x && y1 != y)
+               {
+                  U32 adjOffset  = a->offset(x1 & job->mask, ywrap);
+                  F32 &adjHeight = a->val(adjOffset);
+                  F32 delta   = height - adjHeight;
+                  if (x1 != x || y1 != y)
+                     delta *= 1.414213562f;    // compensate for diagonals
+                  if (delta > maxDelta)
+                  {
+                     maxDelta = delta;
+                     job->o[srcOffset] = adjOffset;
+                  }
+               }
+            }
+         }
+      }
+   }
+}
+
+} // namespace
+
 //------------------------------------------------------------------------------
 Heightfield::Heightfield(U32 r, U32 sz)
 {
@@ -98,6 +313,7 @@ Heightfield& Heightfield::operator=(const Heightfield &src)
 //------------------------------------------------------------------------------
 Terraformer::Terraformer()
 {
+   mLastProgress = 0;
    setTerrainInfo(256, 8.0f, 100.f, 300.0f, 0.0f);
    setShift(Point2F(0,0));
 }
@@ -179,6 +395,20 @@ void Terraformer::getMinMax(U32 r, F32 *fmin, F32 *fmax)
    }
 }
 
+//------------------------------------------------------------------------------
+void Terraformer::progress(U32 pass, U32 passes)
+{
+   // The editor has nothing to draw while an operation runs, but a script
+   //  can update a progress bar and repaint the canvas from here.
+   U32 time = Platform::getRealMilliseconds();
+   if (pass < passes && time - mLastProgress < 100)
+      return;
+   mLastProgress = time;
+
+   if (isMethod("onProgress"))
+      Con::executef(this, 2, "onProgress", Con::getFloatArg(F32(pass) / F32(passes)));
+}
+
 //------------------------------------------------------------------------------
 void Terraformer::clearRegister(U32 r)
 {
@@ -485,28 +715,23 @@ bool Terraformer::smooth(U32 r_src, U32 r_dst, F32 factor, U32 iterations)
    F32 matrixE = (1.0f-matrixM) * (1.0f/12.0f) * 2.0f;
    F32 matrixC = matrixE * 0.5f;
 
+   SmoothJob job;
+   job.size    = blockSize;
+   job.mode    = SmoothAll;
+   job.matrixM = matrixM;
+   job.matrixE = matrixE;
+   job.matrixC = matrixC;
+
    *a = *src;
    for (U32 i=0; i<iterations; i++)
    {
-      for (S32 y=0; y<blockSize; y++)
-      {
-         for (S32 x=0; x<blockSize; x++)
-         {
-            F32 array[9];
-            a->block(x,y,array);
-            //  0  1  2
-            //  3 x,y 5
-            //  6  7  8
-
-            b->val( x, y ) =
-               ((array[0]+array[2]+array[6]+array[8]) * matrixC) +
-               ((array[1]+array[3]+array[5]+array[7]) * matrixE) +
-               (array[4] * matrixM);
-         }
-      }
+      job.src = a;
+      job.dst = b;
+      runRows(blockSize, smoothRows, &job);
       Heightfield *tmp = a;
       a = b;
       b = tmp;
+      progress(i + 1, iterations);
    }
    *dst = *a;
 
@@ -542,33 +767,23 @@ bool Terraformer::smoothWater(U32 r_src, U32 r_dst, F32 factor, U32 iterations)
    F32 matrixC = matrixE * 0.5f;
 
 
+   SmoothJob job;
+   job.size    = blockSize;
+   job.mode    = SmoothBelowWater;
+   job.matrixM = matrixM;
+   job.matrixE = matrixE;
+   job.matrixC = matrixC;
+   job.water   = water;
+
    for (U32 i=0; i<iterations; i++)
    {
-      for (S32 y=0; y<blockSize; y++)
-      {
-         for (S32 x=0; x<blockSize; x++)
-         {
-            F32 value = a->val( x,  y);
-            if (value <= water)
-            {
-               F32 array[9];
-               a->block(x,y,array);
-               //  0  1  2
-               //  3 x,y 5
-               //  6  7  8
-
-               b->val( x, y ) =
-                  ((array[0]+array[2]+array[6]+array[8]) * matrixC) +
-                  ((array[1]+array[3]+array[5]+array[7]) * matrixE) +
-                  (array[4] * matrixM);
-            }
-            else
-               b->val( x, y ) = value;
-         }
-      }
+      job.src = a;
+      job.dst = b;
+      runRows(blockSize, smoothRows, &job);
       Heightfield *tmp = a;
       a = b;
       b = tmp;
+      progress(i + 1, iterations);
    }
    *dst = *a;
    return true;
@@ -606,39 +821,24 @@ bool Terraformer::smoothRidges(U32 r_src, U32 r_dst, F32 factor, U32 iterations,
    F32 matrixE = (1.0f-matrixM) * (1.0f/12.0f) * 2.0f;
    F32 matrixC = matrixE * 0.5f;
 
+   SmoothJob job;
+   job.size      = blockSize;
+   job.mode      = SmoothRidges;
+   job.matrixM   = matrixM;
+   job.matrixE   = matrixE;
+   job.matrixC   = matrixC;
+   job.threshold = threshold;
+
    *a = *src;
    for (U32 i=0; i<iterations; i++)
    {
-      for (S32 y=0; y<blockSize; y++)
-      {
-         for (S32 x=0; x<blockSize; x++)
-         {
-            F32 array[9];
-            a->block(x,y,array);
-            //  0  1  2
-            //  3 x,y 5
-            //  6  7  8
-
-            F32 center = array[4];
-            F32 ave = (array[0]+array[1]+array[2]+
-                       array[3]+         array[5]+
-                       array[6]+array[7]+array[8]) / 8.0f;
-
-            // if this height deviates too much from its neighboors smooth it!
-            if (mFabs(ave-center) > threshold)
-            {
-               b->val( x, y ) =
-                  ((array[0]+array[2]+array[6]+array[8]) * matrixC) +
-                  ((array[1]+array[3]+array[5]+array[7]) * matrixE) +
-                  (center * matrixM);
-            }
-            else
-               b->val( x, y ) = center;
-         }
-      }
+      job.src = a;
+      job.dst = b;
+      runRows(blockSize, smoothRows, &job);
       Heightfield *tmp = a;
       a = b;
       b = tmp;
+      progress(i + 1, iterations);
    }
    *dst = *a;
 
@@ -736,30 +936,26 @@ bool Terraformer::sinus(U32 r, const Filter &filter, U32 seed)
    random.setSeed(seed);
    noise.setSeed(seed);
 
-   U32 iterations = 31;
-   for(U32 k = 0; k < blockSize * blockSize; k++)
-      dst->val(k) = 0;
+   // The waves are drawn up front, in the same order as ever, so the rows
+   //  can each add all of them.
+   SinusJob job;
+   job.noise        = &noise;
+   job.dst          = dst;
+   job.size         = blockSize;
+   job.numWaves     = 0;
+   job.invBlockSize = invBlockSize;
 
+   U32 iterations = SinusIterations;
    for(S32 i = 0; i < iterations; i += 2)
    {
-      F32 period = M_2PI * (i + 1) * invBlockSize;
-      F32 scale = filter.getValue(i / F32(iterations - 1));
-      F32 xOffset = random.randF() * M_2PI;
-      F32 yOffset = random.randF() * M_2PI;
-
-      F32 interval = i + 2;
-      F32 sqInterval = invBlockSize * interval;
-
-      for(S32 y = 0; y < blockSize; y++)
-      {
-         F32 cosy = mCos(y * period + yOffset);
-         for(S32 x = 0; x < blockSize; x++)
-         {
-            F32 sinx = mSin(x * period + xOffset);
-            dst->val(x, y) += scale * (sinx + cosy) * noise.getValue(x * sqInterval, y * sqInterval, (S32)interval);
-         }
-      }
+      U32 w = job.numWaves++;
+      job.period[w]   = M_2PI * (i + 1) * invBlockSize;
+      job.scale[w]    = filter.getValue(i / F32(iterations - 1));
+      job.xOffset[w]  = random.randF() * M_2PI;
+      job.yOffset[w]  = random.randF() * M_2PI;
+      job.interval[w] = i + 2;
    }
+   runRows(blockSize, sinusRows, &job);
    return true;
 }
 
@@ -855,17 +1051,13 @@ bool Terraformer::canyonFractal(U32 r, U32 f, F32 v, U32 seed)
    Heightfield *dst = getRegister(r);
    noise.setSeed(seed);
 
-   v *= 40; // just a magic number
-   for (S32 y=0; y<blockSize; y++)
-   {
-      F32 fy = (F32)y/(F32)blockSize;
-      for (S32 x=0; x<blockSize; x++)
-      {
-         F32 fx = (F32)x/(F32)blockSize;
-         F32 t  = noise.turbulence(fx, fy, 32) * v;
-         dst->val(x, y) = mCos( fx*M_2PI*f + t );
-      }
-   }
+   TurbulenceJob job;
+   job.noise = &noise;
+   job.dst   = dst;
+   job.size  = blockSize;
+   job.v     = v * 40; // just a magic number
+   job.f     = f;
+   runRows(blockSize, canyonRows, &job);
    return true;
 }
 
@@ -883,20 +1075,24 @@ bool Terraformer::turbulence(U32 r_src, U32 r_dst, F32 v, F32 r)
       return true;
    }
 
-   v *= 20; // just a magic number
-   F32 scale = 1.0f/(F32)blockSize;
-   for (S32 y=0; y<blockSize; y++)
+   // The rows read around themselves, so they need a copy to read from
+   //  when this is done in place.
+   if (src == dst)
    {
-      F32 fy = (F32)y * scale;
-      for (S32 x=0; x<blockSize; x++)
-      {
-         F32 fx = (F32)x * scale;
-         F32 t  = noise.turbulence(fx, fy, 32) * v;
-         F32 dx  = r * mSin( t );
-         F32 dy  = r * mCos( t );
-         dst->val(x, y) = src->val(wrap((S32)(x + dx)), wrap((S32)(y + dy)));
-      }
+      src = getScratch(0);
+      *src = *dst;
    }
+
+   TurbulenceJob job;
+   job.noise = &noise;
+   job.src   = src;
+   job.dst   = dst;
+   job.size  = blockSize;
+   job.mask  = blockMask;
+   job.scale = 1.0f/(F32)blockSize;
+   job.v     = v * 20; // just a magic number
+   job.r     = r;
+   runRows(blockSize, turbulenceRows, &job);
    return true;
 }
 
@@ -969,6 +1165,7 @@ bool Terraformer::erodeThermal(U32 r_src, U32 r_dst, F32 slope, F32 materialLoss
       }
       for (S32 k=0; k < (blockSize*blockSize); k++)
          a->val(k) += r->val(k);
+      progress(i + 1, iterations);
    }
    *dst = *a;
    return true;
@@ -1005,40 +1202,19 @@ bool Terraformer::erodeHydraulic(U32 r_src, U32 r_dst, U32 iterations, const Fil
    for (S32 k=0; k < (blockSize*blockSize); k++)
       c->val(k) = 0.0f;
 
+   FlowJob job;
+   job.o    = o;
+   job.size = blockSize;
+   job.mask = blockMask;
+
    for (int i=0; i<iterations; i++)
    {
       b = a;
 
-      for (S32 y=0; y<blockSize; y++)
-      {
-         for (S32 x=0; x<blockSize; x++)
-         {
-            U32 srcOffset = a->offset(x,y);
-            F32 height    = a->val(srcOffset);
-            o[srcOffset]  = srcOffset;
-            for (S32 y1=y-1; y1 <= y+1; y1++)
-            {
-               F32 maxDelta = 0.0f;
-               S32 ywrap = wrap(y1);
-               for (S32 x1=x-1; x1 <= x+1; x1++)
-               {
-                  if (x1 != x && y1 != y)
-                  {
-                     U32 adjOffset  = a->offset(wrap(x1), ywrap);
-                     F32 &adjHeight = a->val(adjOffset);
-                     F32 delta   = height - adjHeight;
-                     if (x1 != x || y1 != y)
-                        delta *= 1.414213562f;    // compensate for diagonals
-                     if (delta > maxDelta)
-                     {
-                        maxDelta = delta;
-                        o[srcOffset] = adjOffset;
-                     }
-                  }
-               }
-            }
-         }
-      }
+      // where each height flows to only depends on a, so that goes by
+      //  rows; moving the material scatters, so it stays on this thread
+      job.a = a;
+      runRows(blockSize, flowRows, &job);
       for (S32 j=0; j < (blockSize*blockSize); j++)
       {
          F32 &s = a->val(j);
@@ -1059,6 +1235,7 @@ bool Terraformer::erodeHydraulic(U32 r_src, U32 r_dst, U32 iterations, const Fil
       Heightfield *tmp = a;
       a = b;
       b = tmp;
+      progress(i + 1, iterations);
    }
    *dst = *b;
    //*dst = *c;
@@ -87,8 +87,14 @@ private:
    F32 worldWater;
    Point2F mShift;
 
+   U32 mLastProgress;   ///< Real time of the last onProgress() call.
+
    S32 wrap(S32 p);
 
+   /// Calls onProgress(%fraction) on the script object, at most ten times
+   /// a second, between the passes of the long operations.
+   void progress(U32 pass, U32 passes);
+
    Heightfield* getRegister(U32 r);
    Heightfield* getScratch(U32 r);
    void getMinMax(U32 r, F32 *fmin, F32 *fmax);
@@ -5,6 +5,103 @@
 
 #include "editor/terraformerNoise.h"
 #include "editor/terraformer.h"
+#include "core/frameAllocator.h"
+#include "core/threadPool.h"
+
+namespace {
+
+enum { MaxOctaves = 6 };
+
+/// Octaves worked out up front so each row can run them all.
+struct FractalJob
+{
+   Noise2D    *noise;
+   Heightfield *dst;
+   Heightfield *sig;
+   U32 size;
+   U32 numOctaves;
+   F32 scale[MaxOctaves];
+   U32 interval[MaxOctaves];
+   F32 weight[MaxOctaves];
+};
+
+void runRows(U32 rows, ThreadPool::ParallelForFn fn, void *job)
+{
+   if (gThreadPool)
+      gThreadPool->parallelFor(rows, fn, job, 4);
+   else
+      fn(0, rows, job);
+}
+
+void fBmRows(U32 start, U32 end, void *userData)
+{
+   FractalJob *job = (FractalJob *) userData;
+   FrameTemp<F32> noise(job->size);
+   for (U32 y = start; y < end; y++)
+   {
+      F32 *row = &job->dst->val(0, y);
+      for (U32 x = 0; x < job->size; x++)
+         row[x] = 0.0f;
+
+      for (U32 o = 0; o < job->numOctaves; o++)
+      {
+         job->noise->getRow(noise, job->size, job->scale[o], (F32)y * job->scale[o], job->interval[o]);
+         F32 exp = job->weight[o];
+         for (U32 x = 0; x < job->size; x++)
+            row[x] += noise[x] * exp;
+      }
+   }
+}
+
+void rigidMultiFractalRows(U32 start, U32 end, void *userData)
+{
+   const F32 offset = 1.0f;
+   const F32 gain   = 2.0f;
+
+   FractalJob *job = (FractalJob *) userData;
+   FrameTemp<F32> noise(job->size);
+   for (U32 y = start; y < end; y++)
+   {
+      F32 *result = &job->dst->val(0, y);
+      F32 *signal = &job->sig->val(0, y);
+
+      // first octave
+      job->noise->getRow(noise, job->size, job->scale[0], (F32)y * job->scale[0], job->interval[0]);
+      for (U32 x = 0; x < job->size; x++)
+      {
+         F32 s = mFabs(noise[x]);   // get absolute value of signal (this creates the ridges)
+         s = offset - s;            // invert and translate (note that "offset" should be ~= 1.0)
+         s *= s + 0.1;              // square the signal, to increase "sharpness" of ridges
+         result[x] = s;
+         signal[x] = s;
+      }
+
+      // remaining octaves
+      for (U32 o = 1; o < job->numOctaves; o++)
+      {
+         job->noise->getRow(noise, job->size, job->scale[o], (F32)y * job->scale[o], job->interval[o]);
+         F32 exp = job->weight[o];
+         for (U32 x = 0; x < job->size; x++)
+         {
+            // weight successive contributions by previous signal
+            F32 weight = mClampF(signal[x] * gain, 0.0f, 1.0f);
+
+            F32 s = mFabs(noise[x]);
+            s = offset - s;
+            s *= s + 0.2;
+            // weight the contribution
+            s *= weight;
+            result[x] += s * exp;
+            signal[x] = s;
+         }
+      }
+
+      for (U32 x = 0; x < job->size; x++)
+         result[x] = (result[x] - 1.0f) / 2.0f;
+   }
+}
+
+} // namespace
 
 
 //--------------------------------------
@@ -113,27 +210,26 @@ void Noise2D::fBm(Heightfield *dst, U32 size, U32 interval, F32 h, F32 octaves)
       frequency *= lacunarity;
    }
 
-   // initialize dst
-   for (S32 k=0; k < (size*size); k++)
-      dst->val(k) = 0.0f;
+   // Rows are independent, and each one runs the octaves in the same
+   //  order the whole field used to, so the result doesn't change.
+   FractalJob job;
+   job.noise = this;
+   job.dst   = dst;
+   job.sig   = NULL;
+   job.size  = size;
+   job.numOctaves = 0;
 
    F32 scale = 1.0f / (F32)size * interval;
    for (S32 o=0; o<octaves; o++)
    {
-      F32 exp = exponent_array[o];
-      for (S32 y=0; y<size; y++)
-      {
-         F32 fy = (F32)y * scale;
-         for (S32 x=0; x<size; x++)
-         {
-            F32 fx = (F32)x * scale;
-            F32 noise = getValue(fx, fy, interval);
-            dst->val(x, y) += noise * exp;
-         }
-      }
+      job.scale[o]    = scale;
+      job.interval[o] = interval;
+      job.weight[o]   = exponent_array[o];
+      job.numOctaves++;
       scale    *= lacunarity;
       interval  = (U32)(interval * lacunarity);
    }
+   runRows(size, fBmRows, &job);
 }
 
 
@@ -144,8 +240,6 @@ void Noise2D::rigidMultiFractal(Heightfield *dst, Heightfield *sig, U32 size, U3
    F32 H = getMin(1.0f, getMax(0.0f, h));
    octaves = getMin(5.0f, getMax(1.0f, octaves));
    F32 lacunarity = 2.0f;
-   F32 offset     = 1.0f;
-   F32 gain       = 2.0f;
 
    F32 exponent_array[32];
 
@@ -159,65 +253,28 @@ void Noise2D::rigidMultiFractal(Heightfield *dst, Heightfield *sig, U32 size, U3
       frequency *= lacunarity;
    }
 
-   F32 scale = 1.0f / (F32)size * interval;
+   // The signal only carries from one octave to the next of the same
+   //  height, so this goes row by row too.
+   FractalJob job;
+   job.noise = this;
+   job.dst   = dst;
+   job.sig   = sig;
+   job.size  = size;
+   job.numOctaves = 0;
 
-   //--------------------------------------
-   // compute first octave
-   for (S32 y=0; y<size; y++)
+   F32 scale = 1.0f / (F32)size * interval;
+   for (S32 o=0; o<octaves; o++)
    {
-      F32 fy = (F32)y * scale;
-      for (S32 x=0; x<size; x++)
-      {
-         F32 fx = (F32)x * scale;
+      job.scale[o]    = scale;
+      job.interval[o] = interval;
+      job.weight[o]   = exponent_array[o];
+      job.numOctaves++;
 
-         F32 signal = mFabs(getValue(fx,fy,interval));   // get absolute value of signal (this creates the ridges)
-         //signal = mSqrt(signal);
-         signal = offset - signal;  // invert and translate (note that "offset" should be ~= 1.0)
-         signal *= signal + 0.1;          // square the signal, to increase "sharpness" of ridges
-
-         // assign initial values
-         dst->val(x, y) = signal;
-         sig->val(x, y) = signal;
-      }
-   }
-
-   //--------------------------------------
-   // compute remaining octaves
-   for (S32 o=1; o<octaves; o++)
-   {
       // increase the frequency
       scale    *= lacunarity;
       interval  = (U32)(interval * lacunarity);
-      F32 exp   = exponent_array[o];
-
-      for (S32 y=0; y<size; y++)
-      {
-         F32 fy = (F32)y * scale;
-         for (S32 x=0; x<size; x++)
-         {
-            F32 fx = (F32)x * scale;
-            U32 index  = dst->offset(x,y);
-            F32 result = dst->val(index);
-            F32 signal = sig->val(index);
-
-            // weight successive contributions by previous signal
-            F32 weight = mClampF(signal * gain, 0.0f, 1.0f);
-
-            signal = mFabs(getValue( fx, fy, interval ));
-
-            signal = offset - signal;
-            signal *= signal + 0.2;
-            // weight the contribution
-            signal *= weight;
-            result += signal * exp;
-
-            dst->val(index) = result;
-            sig->val(index) = signal;
-         }
-      }
    }
-   for (S32 k=0; k < (size*size); k++)
-      dst->val(k) = (dst->val(k)-1.0f)/2.0f;
+   runRows(size, rigidMultiFractalRows, &job);
 }
 
 
@@ -255,6 +312,38 @@ inline F32 Noise2D::dot(const F32 *q, F32 rx, F32 ry)
 
 
 
+//--------------------------------------
+void Noise2D::getRow(F32 *dst, U32 size, F32 scale, F32 y, S32 interval)
+{
+   // Same as getValue(), with everything that only depends on y hoisted.
+   S32 by0, by1;
+   F32 ry0, ry1;
+   setup(y, by0, by1, ry0, ry1);
+   by0 = by0 % interval;
+   by1 = by1 % interval;
+   F32 sy = curve(ry0);
+
+   for (U32 x = 0; x < size; x++)
+   {
+      S32 bx0, bx1;
+      F32 rx0, rx1;
+      setup((F32)x * scale, bx0, bx1, rx0, rx1);
+      bx0 = bx0 % interval;
+      bx1 = bx1 % interval;
+
+      S32 i = mPermutation[ bx0 ];
+      S32 j = mPermutation[ bx1 ];
+      F32 sx = curve(rx0);
+
+      F32 a = lerp(sx, dot(mGradient[ mPermutation[ i + by0 ] ], rx0, ry0),
+                       dot(mGradient[ mPermutation[ j + by0 ] ], rx1, ry0));
+      F32 b = lerp(sx, dot(mGradient[ mPermutation[ i + by1 ] ], rx0, ry1),
+                       dot(mGradient[ mPermutation[ j + by1 ] ], rx1, ry1));
+      dst[x] = lerp(sy, a, b);
+   }
+}
+
+
 //--------------------------------------
 F32 Noise2D::getValue(F32 x, F32 y, S32 interval)
 {
@@ -48,6 +48,9 @@ public:
    U32  getSeed();
 
    F32  getValue(F32 u, F32 v, S32 interval);
+   /// getValue() of x * scale, y for x in [0, size), with the row's terms
+   /// worked out once.  Only reads the tables, so rows can run in parallel.
+   void getRow(F32 *dst, U32 size, F32 scale, F32 y, S32 interval);
    void fBm(Heightfield *dst, U32 size, U32 interval, F32 h, F32 octave=5.0f);
    void rigidMultiFractal(Heightfield *dst, Heightfield *signal, U32 size, U32 interval, F32 h, F32 octave=5.0f);
    F32  turbulence(F32 x, F32 y, F32 freq);
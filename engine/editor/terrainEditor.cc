@@ -326,8 +326,8 @@ TerrainEditor::TerrainEditor() :
    mUndoSel(0),
    mRebuildEmpty(false),
    mRebuildTextures(false),
-   mGridUpdateMin(255, 255),
-   mGridUpdateMax(0, 0)
+   mGridUpdateMin(S32_MAX, S32_MAX),
+   mGridUpdateMax(S32_MIN, S32_MIN)
 {
    VECTOR_SET_ASSOCIATION(mActions);
    VECTOR_SET_ASSOCIATION(mUndoList);
@@ -569,38 +569,66 @@ F32 TerrainEditor::getGridHeight(const Point2I & gPos)
    return(fixedToFloat(mTerrainBlock->getHeight(cPos.x, cPos.y)));
 }
 
-void TerrainEditor::gridUpdateComplete()
+void TerrainEditor::markGridUpdate(const Point2I & gPos)
 {
-   if(mGridUpdateMin.x <= mGridUpdateMax.x)
-      mTerrainBlock->updateGrid(mGridUpdateMin, mGridUpdateMax);
-   mGridUpdateMin.set(256,256);
-   mGridUpdateMax.set(0,0);
+   mGridUpdateMin.setMin(gPos);
+   mGridUpdateMax.setMax(gPos);
 }
 
-void TerrainEditor::materialUpdateComplete()
+void TerrainEditor::applyGridUpdate(bool heights, bool materials)
 {
-   if(mGridUpdateMin.x <= mGridUpdateMax.x)
+   if(mGridUpdateMin.x > mGridUpdateMax.x)
+      return;
+
+   // bring the min into the block, the max may go past its edge and the
+   // updates wrap it.  no wider than the block, though
+   Point2I min, max;
+   Point2I shift(mGridUpdateMin.x & ~TerrainBlock::BlockMask, mGridUpdateMin.y & ~TerrainBlock::BlockMask);
+   min = mGridUpdateMin - shift;
+   max = mGridUpdateMax - shift;
+   if(max.x - min.x >= TerrainBlock::BlockMask)
+   {
+      min.x = 0;
+      max.x = TerrainBlock::BlockMask;
+   }
+   if(max.y - min.y >= TerrainBlock::BlockMask)
    {
-      TerrainBlock * clientTerrain = getClientTerrain();
-      clientTerrain->updateGridMaterials(mGridUpdateMin, mGridUpdateMax);
-      mTerrainBlock->updateGrid(mGridUpdateMin, mGridUpdateMax);
+      min.y = 0;
+      max.y = TerrainBlock::BlockMask;
    }
-   mGridUpdateMin.set(256,256);
-   mGridUpdateMax.set(0,0);
+
+   mGridUpdateMin.set(S32_MAX, S32_MAX);
+   mGridUpdateMax.set(S32_MIN, S32_MIN);
+
+   // the grid is in the terrain file, which the client block shares, but
+   // each block has its own chunk buffers and collision cache
+   TerrainBlock * clientTerrain = getClientTerrain();
+   if(heights)
+   {
+      mTerrainBlock->updateGrid(min, max);
+      if(clientTerrain && clientTerrain != mTerrainBlock)
+         clientTerrain->flushGridRect(min, max);
+   }
+   if(materials && clientTerrain)
+      clientTerrain->updateGridMaterials(min, max);
+}
+
+void TerrainEditor::gridUpdateComplete()
+{
+   applyGridUpdate(true, false);
+}
+
+void TerrainEditor::materialUpdateComplete()
+{
+   // painting leaves the heights alone
+   applyGridUpdate(false, true);
 }
 
 void TerrainEditor::setGridHeight(const Point2I & gPos, const F32 height)
 {
    Point2I cPos;
    gridToCenter(gPos, cPos);
-   if(cPos.x < mGridUpdateMin.x)
-      mGridUpdateMin.x = cPos.x;
-   if(cPos.y < mGridUpdateMin.y)
-      mGridUpdateMin.y = cPos.y;
-   if(cPos.x > mGridUpdateMax.x)
-      mGridUpdateMax.x = cPos.x;
-   if(cPos.y > mGridUpdateMax.y)
-      mGridUpdateMax.y = cPos.y;
+   markGridUpdate(gPos);
 
    mTerrainBlock->setHeight(cPos, height);
 }
@@ -950,14 +978,16 @@ bool TerrainEditor::processUndo(Vector<Selection *> & src, Vector<Selection *> &
    src.pop_front();
 
    Selection * save = new Selection;
+   bool materialChanged = false;
    for(U32 i = 0; i < task->size(); i++)
    {
       GridInfo info;
       getGridInfo((*task)[i].mGridPos, info);
       save->add(info);
       setGridInfo((*task)[i]);
+      materialChanged |= (*task)[i].mMaterialChanged;
    }
-   gridUpdateComplete();
+   applyGridUpdate(true, materialChanged);
 
    delete task;
    addUndo(dest, save);
@@ -168,8 +168,14 @@ class TerrainEditor : public EditTSCtrl
 	private:	
       typedef EditTSCtrl Parent;
       TerrainBlock * mTerrainBlock;
+
+      /// Bounds of the points changed since the last update, in grid
+      /// coords rather than wrapped ones, so a brush over the edge of the
+      /// block doesn't cover the whole width.
       Point2I  mGridUpdateMin;
       Point2I  mGridUpdateMax;
+      void markGridUpdate(const Point2I & gPos);
+      void applyGridUpdate(bool heights, bool materials);
       U32 mMouseDownSeq;
 
       Point3F                    mMousePos;
@@ -204,22 +204,38 @@ WorldEditor::Selection::~Selection()
    unregisterObject();
 }
 
+// index of the first entry in mSorted not below obj
+S32 WorldEditor::Selection::findSorted(SimObject * obj)
+{
+   S32 lo = 0, hi = mSorted.size();
+   while(lo < hi)
+   {
+      S32 mid = (lo + hi) >> 1;
+      if(mSorted[mid] < obj)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   return(lo);
+}
+
 bool WorldEditor::Selection::objInSet(SceneObject * obj)
 {
-   for(U32 i = 0; i < mObjectList.size(); i++)
-      if(mObjectList[i] == (SimObject*)obj)
-         return(true);
-   return(false);
+   S32 index = findSorted(obj);
+   return(index < mSorted.size() && mSorted[index] == (SimObject*)obj);
 }
 
 bool WorldEditor::Selection::addObject(SceneObject * obj)
 {
-   if(objInSet(obj))
+   S32 index = findSorted(obj);
+   if(index < mSorted.size() && mSorted[index] == (SimObject*)obj)
       return(false);
 
    mCentroidValid = false;
 
-   mObjectList.pushBack(obj);
+   mSorted.insert(index);
+   mSorted[index] = obj;
+   mObjectList.push_back(obj);
    deleteNotify(obj);
 
    if(mAutoSelect)
@@ -235,12 +251,20 @@ bool WorldEditor::Selection::addObject(SceneObject * obj)
 
 bool WorldEditor::Selection::removeObject(SceneObject * obj)
 {
-   if(!objInSet(obj))
+   S32 index = findSorted(obj);
+   if(index == mSorted.size() || mSorted[index] != (SimObject*)obj)
       return(false);
 
    mCentroidValid = false;
 
-   mObjectList.remove(obj);
+   // from the back, clear() takes them off the end
+   mSorted.erase(index);
+   for(S32 i = mObjectList.size() - 1; i >= 0; i--)
+      if(mObjectList[i] == (SimObject*)obj)
+      {
+         mObjectList.erase(i);
+         break;
+      }
    clearNotify(obj);
 
    if(mAutoSelect)
@@ -258,7 +282,7 @@ bool WorldEditor::Selection::removeObject(SceneObject * obj)
 void WorldEditor::Selection::clear()
 {
    while(mObjectList.size())
-      removeObject((SceneObject*)mObjectList[0]);
+      removeObject((SceneObject*)mObjectList.last());
 }
 
 void WorldEditor::Selection::onDeleteNotify(SimObject * obj)
@@ -495,6 +519,21 @@ WorldEditor::SelectionState * WorldEditor::createUndo(Selection & sel)
    return(sState);
 }
 
+// drops the entries of objects that are still as the state has them, once
+// the edit it was made for is over.  false if there's nothing left to undo
+bool WorldEditor::trimUndo(SelectionState * sState)
+{
+   for(S32 i = sState->mEntries.size() - 1; i >= 0; i--)
+   {
+      SelectionState::Entry & entry = sState->mEntries[i];
+      SceneObject * obj = dynamic_cast<SceneObject*>(Sim::findObject(entry.mObjId));
+      if(obj && obj->getScale() == entry.mScale &&
+         !dMemcmp((const F32*)obj->getTransform(), (const F32*)entry.mMatrix, sizeof(F32) * 16))
+         sState->mEntries.erase_fast(i);
+   }
+   return(sState->mEntries.size() != 0);
+}
+
 void WorldEditor::addUndo(Vector<SelectionState *> & list, SelectionState * sel)
 {
    AssertFatal(sel, "WorldEditor::addUndo - invalid selection");
@@ -1771,6 +1810,7 @@ WorldEditor::WorldEditor()
    //
    mHitInfo.obj = 0;
    mHitObject = mHitInfo.obj;
+   mHoverPickPending = false;
 
    //
    mDefaultMode = mCurrentMode = Move;
@@ -1862,41 +1902,53 @@ void WorldEditor::on3DMouseMove(const Gui3DMouseEvent & event)
    else
       mCurrentMode = Move;
 
-   setCursor(ArrowCursor);
-   mHitInfo.obj = 0;
-
    //
    mUsingAxisGizmo = false;
+   mHoverPickPending = false;
    if(collideAxisGizmo(event))
    {
       setCursor(HandCursor);
+      mHitInfo.obj = 0;
       mUsingAxisGizmo = true;
       mHitMousePos = event.mousePoint;
       mHitCentroid = mSelected.getCentroid();
       mHitRotation = extractEuler(mSelected[0]->getTransform());
-      mHitObject = mSelected[0];
+      mHitObject = mHitInfo.obj;
    }
    else
    {
-      CollisionInfo info;
-      if(collide(event, info) && !objClassIgnored(info.obj))
-      {
-         setCursor(HandCursor);
-         mHitInfo = info;
-      }
+      // the ray against everything waits for the next frame, so all the
+      // moves in between cost one
+      mHoverPickPending = true;
    }
 
-   //
-   mHitObject = mHitInfo.obj;
-
    mLastMouseEvent = event;
 }
 
+void WorldEditor::updateHoverPick()
+{
+   if(!mHoverPickPending)
+      return;
+   mHoverPickPending = false;
+
+   setCursor(ArrowCursor);
+   mHitInfo.obj = 0;
+
+   CollisionInfo info;
+   if(collide(mLastMouseEvent, info) && !objClassIgnored(info.obj))
+   {
+      setCursor(HandCursor);
+      mHitInfo = info;
+   }
+   mHitObject = mHitInfo.obj;
+}
+
 void WorldEditor::on3DMouseDown(const Gui3DMouseEvent & event)
 {
    mMouseDown = true;
    mMouseDragged = false;
    mLastRotation = 0.f;
+   mHoverPickPending = false;
 
    mouseLock();
 
@@ -2043,6 +2095,13 @@ void WorldEditor::on3DMouseUp(const Gui3DMouseEvent & event)
       return;
    }
 
+   // the drag's undo state only needs what the drag changed
+   if(mMouseDragged && mUndoList.size() && !trimUndo(mUndoList.front()))
+   {
+      delete mUndoList.front();
+      mUndoList.pop_front();
+   }
+
    if (mMouseDragged && mSelected.size())
    {
       if(mSelected.size())
@@ -2483,6 +2542,7 @@ void WorldEditor::on3DMouseEnter(const Gui3DMouseEvent &)
 
 void WorldEditor::on3DMouseLeave(const Gui3DMouseEvent &)
 {
+   mHoverPickPending = false;
    setCursor(DefaultCursor);
 }
 
@@ -2522,6 +2582,8 @@ void WorldEditor::renderScene(const RectI & updateRect)
    
    sgRelightFilter::sgRenderAllowedObjects(this);
 
+   updateHoverPick();
+
 
    // Render the paths
    renderPaths(Sim::findObject("MissionGroup"));
@@ -70,6 +70,11 @@ class WorldEditor : public EditTSCtrl
             SimObjectList  mObjectList;
             bool           mAutoSelect;
 
+            /// mObjectList by address, for objInSet(), which the drag
+            /// selection calls for every object on screen every frame.
+            Vector<SimObject*> mSorted;
+            S32            findSorted(SimObject *);
+
             void           updateCentroid();
 
          public:
@@ -135,6 +140,7 @@ class WorldEditor : public EditTSCtrl
       };
 
       SelectionState * createUndo(Selection &);
+      bool trimUndo(SelectionState *);
       void addUndo(Vector<SelectionState *> & list, SelectionState * sel);
       bool processUndo(Vector<SelectionState *> & src, Vector<SelectionState *> & dest);
       void clearUndo(Vector<SelectionState *> & list);
@@ -161,6 +167,7 @@ class WorldEditor : public EditTSCtrl
    private:
       SceneObject * getControlObject();
       bool collide(const Gui3DMouseEvent & event, CollisionInfo & info);
+      void updateHoverPick();
 
       // render methods
       //void renderObjectBox(SceneObject * obj, const ColorI & col);
@@ -222,6 +229,7 @@ class WorldEditor : public EditTSCtrl
       EulerF                     mHitRotation;
       bool                       mMouseDragged;
       Gui3DMouseEvent            mLastMouseEvent;
+      bool                       mHoverPickPending;   ///< mLastMouseEvent still needs picking
       F32                        mLastRotation;
 
       //
@@ -0,0 +1,215 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "game/aiPerception.h"
+#include "game/aiPlayer.h"
+#include "console/console.h"
+#include "console/consoleTypes.h"
+#include "platform/profiler.h"
+
+Vector<AIPlayer*>    AIPerception::smBots;
+U32                  AIPerception::smCursor = 0;
+Vector<AIPerception::Look>   AIPerception::smLooks;
+Vector<AIPerception::Update> AIPerception::smUpdates;
+Vector<RayQuery>     AIPerception::smRays;
+Vector<RayInfo>      AIPerception::smResults;
+Vector<SceneObject*> AIPerception::smCandidates;
+
+S32 AIPerception::smRaysPerTick = 64;
+U32 AIPerception::smSightMask = InteriorObjectType | StaticShapeObjectType |
+                                StaticObjectType | TerrainObjectType;
+
+//-----------------------------------------------------------------------------
+
+void AIPerception::consoleInit()
+{
+   Con::addVariable("$AIPerception::raysPerTick", TypeS32, &smRaysPerTick);
+}
+
+void AIPerception::addBot(AIPlayer *bot)
+{
+   // Spread over the interval by id, so bots made together don't look together.
+   bot->mSensorNextUpdate = Sim::getCurrentTime() + (bot->getId() * 97) % bot->mSensorInterval;
+   smBots.push_back(bot);
+}
+
+void AIPerception::removeBot(AIPlayer *bot)
+{
+   for(U32 i = 0; i < smBots.size(); i++)
+      if(smBots[i] == bot)
+      {
+         smBots.erase(i);
+         if(smCursor > i)
+            smCursor--;
+         break;
+      }
+   if(smCursor >= smBots.size())
+      smCursor = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void AIPerception::findCandidate(SceneObject *obj, void *key)
+{
+   ((Vector<SceneObject*> *) key)->push_back(obj);
+}
+
+U32 AIPerception::gatherLooks(AIPlayer *bot)
+{
+   MatrixF eyeMat;
+   bot->getEyeTransform(&eyeMat);
+   Point3F eye, forward;
+   eyeMat.getColumn(3, &eye);
+   eyeMat.getColumn(1, &forward);
+
+   F32 range = bot->mSensorRange;
+   Box3F box(eye - Point3F(range, range, range), eye + Point3F(range, range, range));
+   smCandidates.clear();
+   if(bot->mSensorMask)
+      gServerContainer.findObjects(box, bot->mSensorMask, findCandidate, &smCandidates);
+
+   // The aim object is looked for wherever it is.
+   SceneObject *aim = bot->mAimObject;
+   if(aim)
+      smCandidates.push_back(aim);
+
+   U32 first = smLooks.size();
+   for(U32 i = 0; i < smCandidates.size(); i++)
+   {
+      SceneObject *obj = smCandidates[i];
+      if(obj == bot)
+         continue;
+
+      Point3F center = obj->getBoxCenter();
+      Point3F dir = center - eye;
+      F32 dist = dir.len();
+      bool sensed = (obj->getType() & bot->mSensorMask) && dist <= range &&
+         (bot->mSensorFovCos <= -1.0f || dist < 0.001f || mDot(dir, forward) >= bot->mSensorFovCos * dist);
+
+      // The aim object was added twice if it was found too.
+      bool isAim = obj == aim;
+      if(isAim && i != smCandidates.size() - 1)
+         continue;
+      if(!sensed && !isAim)
+         continue;
+
+      smLooks.increment();
+      Look &look = smLooks.last();
+      look.target = obj->getId();
+      look.sensed = sensed;
+      look.aim = isAim;
+
+      smRays.increment();
+      smRays.last().start = eye;
+      smRays.last().end = center;
+   }
+   return smLooks.size() - first;
+}
+
+void AIPerception::deliver(const Update &update)
+{
+   AIPlayer *bot;
+   if(!Sim::findObject(update.bot, bot) || !bot->mSensorEnabled)
+      return;
+
+   Vector<SimObjectId> visible, seen, lost;
+   S32 aimInLOS = -1;
+   for(U32 i = update.first; i < update.first + update.count; i++)
+   {
+      const Look &look = smLooks[i];
+      SceneObject *hit = smResults[i].object;
+      bool clear = !hit || hit->getId() == look.target;
+      if(look.aim)
+         aimInLOS = clear;
+      if(look.sensed && clear)
+         visible.push_back(look.target);
+   }
+
+   for(U32 i = 0; i < visible.size(); i++)
+   {
+      bool found = false;
+      for(U32 j = 0; j < bot->mSensorVisible.size() && !found; j++)
+         found = bot->mSensorVisible[j] == visible[i];
+      if(!found)
+         seen.push_back(visible[i]);
+   }
+   for(U32 i = 0; i < bot->mSensorVisible.size(); i++)
+   {
+      bool found = false;
+      for(U32 j = 0; j < visible.size() && !found; j++)
+         found = visible[j] == bot->mSensorVisible[i];
+      if(!found)
+         lost.push_back(bot->mSensorVisible[i]);
+   }
+   bot->mSensorVisible = visible;
+
+   // Any callback can delete the bot, so look it up again before each.
+   SimObjectId botId = update.bot;
+   if(aimInLOS != -1 && bool(aimInLOS) != bot->mTargetInLOS)
+   {
+      bot->mTargetInLOS = aimInLOS;
+      bot->throwCallback(aimInLOS ? "onTargetEnterLOS" : "onTargetExitLOS");
+   }
+   for(U32 i = 0; i < lost.size() && Sim::findObject(botId, bot); i++)
+      Con::executef(bot->getDataBlock(), 3, "onSensorLose", bot->scriptThis(), Con::getIntArg(lost[i]));
+   for(U32 i = 0; i < seen.size() && Sim::findObject(botId, bot); i++)
+      Con::executef(bot->getDataBlock(), 3, "onSensorSee", bot->scriptThis(), Con::getIntArg(seen[i]));
+}
+
+void AIPerception::processTick()
+{
+   if(smBots.empty())
+      return;
+
+   PROFILE_START(AIPerception);
+
+   // Bots in turn from where the last tick stopped, as long as the
+   // budget lasts.  A bot's looks all go in the same tick.
+   SimTime now = Sim::getCurrentTime();
+   S32 budget = getMax(smRaysPerTick, 1);
+   U32 count = smBots.size();
+   U32 n;
+   for(n = 0; n < count && budget > 0; n++)
+   {
+      AIPlayer *bot = smBots[(smCursor + n) % count];
+      if(now < bot->mSensorNextUpdate)
+         continue;
+
+      U32 first = smLooks.size();
+      U32 looks = gatherLooks(bot);
+      if(S32(looks) > budget && first)
+      {
+         smLooks.setSize(first);
+         smRays.setSize(first);
+         break;
+      }
+      budget -= looks;
+      bot->mSensorNextUpdate = now + bot->mSensorInterval;
+
+      smUpdates.increment();
+      smUpdates.last().bot = bot->getId();
+      smUpdates.last().first = first;
+      smUpdates.last().count = looks;
+   }
+   smCursor = (smCursor + n) % count;
+
+   if(smRays.size())
+   {
+      smResults.setSize(smRays.size());
+      for(U32 i = 0; i < smResults.size(); i++)
+         constructInPlace(&smResults[i]);
+      gServerContainer.castRays(smRays.address(), smRays.size(), smSightMask, smResults.address());
+   }
+
+   for(U32 i = 0; i < smUpdates.size(); i++)
+      deliver(smUpdates[i]);
+
+   smLooks.clear();
+   smUpdates.clear();
+   smRays.clear();
+   smResults.clear();
+
+   PROFILE_END();
+}
@@ -0,0 +1,84 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _AIPERCEPTION_H_
+#define _AIPERCEPTION_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+#ifndef _SIMBASE_H_
+#include "console/simBase.h"
+#endif
+#ifndef _SCENEOBJECT_H_
+#include "sim/sceneObject.h"
+#endif
+
+class AIPlayer;
+
+/// Runs the sensors of the server's AIPlayers, a few at a time.
+///
+/// An AIPlayer with a sensor (AIPlayer::setSensor()) looks for objects of
+/// its type mask within range and view cone every interval ms.  Rather than
+/// every bot testing on every tick, the bots come up in turn, starting from
+/// where the last tick left off, until the tick has used its
+/// $AIPerception::raysPerTick.  A bot that's due but doesn't fit waits for
+/// the next tick, and the bots start at different points of their interval
+/// so they don't all fall due together.
+///
+/// All the sight rays of a tick go through one Container::castRays() batch
+/// against the static geometry.  What a bot starts or stops seeing is
+/// handed to its datablock as onSensorSee(%bot, %obj) and
+/// onSensorLose(%bot, %obj), so scripts don't have to poll.  The bot's aim
+/// object is always looked for and drives onTargetEnterLOS/ExitLOS, in
+/// place of the test AIPlayer::getAIMove() makes every tick without one.
+class AIPerception
+{
+   /// One sight ray and who it's for.  Ids rather than pointers, the
+   /// callbacks can delete anything.
+   struct Look
+   {
+      SimObjectId target;
+      bool sensed;            ///< In the sensor's mask and range, not just aimed at.
+      bool aim;
+   };
+
+   /// The looks of one bot's update are contiguous, [first, first + count).
+   struct Update
+   {
+      SimObjectId bot;
+      U32 first;
+      U32 count;
+   };
+
+   static Vector<AIPlayer*>     smBots;
+   static U32                   smCursor;        ///< Where the next tick starts.
+   static Vector<Look>          smLooks;
+   static Vector<Update>        smUpdates;
+   static Vector<RayQuery>      smRays;
+   static Vector<RayInfo>       smResults;
+   static Vector<SceneObject*>  smCandidates;
+
+   static void findCandidate(SceneObject *obj, void *key);
+   static U32  gatherLooks(AIPlayer *bot);
+   static void deliver(const Update &update);
+
+  public:
+   static S32 smRaysPerTick;     ///< $AIPerception::raysPerTick
+   static U32 smSightMask;       ///< What blocks the view.
+
+   static void consoleInit();
+
+   static void addBot(AIPlayer *bot);
+   static void removeBot(AIPlayer *bot);
+
+   /// Runs the sensors that are due, within the tick's ray budget.
+   static void processTick();
+};
+
+#endif
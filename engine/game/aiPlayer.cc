@@ -7,6 +7,8 @@
 #include "core/realComp.h"
 #include "math/mMatrix.h"
 #include "game/moveManager.h"
+#include "game/navGraph.h"
+#include "game/aiPerception.h"
 
 IMPLEMENT_CO_NETOBJECT_V1(AIPlayer);
 
@@ -26,6 +28,16 @@ AIPlayer::AIPlayer()
    mTargetInLOS = false;
    mAimOffset = Point3F(0.0f, 0.0f, 0.0f);
 
+   mPathQuery = 0;
+   mPathSlowdown = true;
+
+   mSensorEnabled = false;
+   mSensorRange = 0.0f;
+   mSensorFovCos = -1.0f;
+   mSensorInterval = 0;
+   mSensorMask = 0;
+   mSensorNextUpdate = 0;
+
    mTypeMask |= AIObjectType;
 }
 
@@ -34,6 +46,46 @@ AIPlayer::AIPlayer()
  */
 AIPlayer::~AIPlayer()
 {
+   if (mPathQuery)
+      NavGraph::cancelQuery(mPathQuery);
+}
+
+void AIPlayer::onRemove()
+{
+   clearSensor();
+   Parent::onRemove();
+}
+
+/**
+ * Starts the sensor, or changes its settings
+ *
+ * @param range    How far the bot can see
+ * @param fov      Width of the view cone in degrees, 360 for all round
+ * @param interval Ms between looks
+ * @param mask     Types of object to look for
+ */
+void AIPlayer::setSensor( F32 range, F32 fov, U32 interval, U32 mask )
+{
+   mSensorRange = getMax( 0.0f, range );
+   mSensorFovCos = (fov >= 360.0f)? -1.0f: mCos( mDegToRad( getMax( 0.0f, fov ) * 0.5f ) );
+   mSensorInterval = getMax( interval, U32(TickMs) );
+   mSensorMask = mask;
+   if (!mSensorEnabled && isServerObject()) {
+      mSensorEnabled = true;
+      AIPerception::addBot( this );
+   }
+}
+
+/**
+ * Stops the sensor
+ */
+void AIPlayer::clearSensor()
+{
+   if (mSensorEnabled) {
+      mSensorEnabled = false;
+      AIPerception::removeBot( this );
+   }
+   mSensorVisible.clear();
 }
 
 /**
@@ -52,6 +104,7 @@ void AIPlayer::setMoveSpeed( F32 speed )
 void AIPlayer::stopMove()
 {
    mMoveState = ModeStop;
+   clearPath();
 }
 
 /**
@@ -77,6 +130,55 @@ void AIPlayer::setMoveDestination( const Point3F &location, bool slowdown )
    mMoveSlowdown = slowdown;
 }
 
+/**
+ * Asks the NavGraph for a way to the location; the bot starts along it
+ * once the search is done.  Without a graph it heads straight there.
+ *
+ * @param location Point to run to
+ * @param slowdown Slow down as the bot nears the end of the path
+ */
+void AIPlayer::setPathDestination( const Point3F &location, bool slowdown )
+{
+   clearPath();
+   mPathSlowdown = slowdown;
+   mPathQuery = NavGraph::findPathAsync( getPosition(), location, NavGraph::ReceiverAIPlayer, getId() );
+   if (!mPathQuery)
+      setMoveDestination( location, slowdown );
+}
+
+/**
+ * Called by the NavGraph when a path search is done
+ */
+void AIPlayer::onPathResult( S32 queryId, bool found, const Vector<Point3F> &points )
+{
+   if (queryId != mPathQuery)
+      return;
+   mPathQuery = 0;
+
+   if (!found || points.empty()) {
+      throwCallback( "onPathFailed" );
+      return;
+   }
+
+   // Kept in reverse so the next waypoint comes off the back.
+   mPath.setSize(points.size() - 1);
+   for (U32 i = 0; i < mPath.size(); i++)
+      mPath[i] = points[points.size() - 1 - i];
+   setMoveDestination( points[0], mPath.empty() && mPathSlowdown );
+   throwCallback( "onPathFound" );
+}
+
+/**
+ * Forgets the path and any search for one
+ */
+void AIPlayer::clearPath()
+{
+   if (mPathQuery)
+      NavGraph::cancelQuery(mPathQuery);
+   mPathQuery = 0;
+   mPath.clear();
+}
+
 /**
  * Sets the object the bot is targeting
  *
@@ -215,8 +317,16 @@ bool AIPlayer::getAIMove(Move *movePtr)
 
       // Check if we should mMove, or if we are 'close enough'
       if (mFabs(xDiff) < mMoveTolerance && mFabs(yDiff) < mMoveTolerance) {
-         mMoveState = ModeStop;
-         throwCallback("onReachDestination");
+         if (mPath.size()) {
+            // On to the next waypoint; only the last one is the destination.
+            mMoveDestination = mPath.last();
+            mPath.pop_back();
+            mMoveSlowdown = mPath.empty() && mPathSlowdown;
+         }
+         else {
+            mMoveState = ModeStop;
+            throwCallback("onReachDestination");
+         }
       }
       else {
          // Build move direction in world space
@@ -272,8 +382,9 @@ bool AIPlayer::getAIMove(Move *movePtr)
 
    // Test for target location in sight if it's an object. The LOS is
    // run from the eye position to the center of the object's bounding,
-   // which is not very accurate.
-   if (mAimObject) {
+   // which is not very accurate.  With a sensor it's left to the
+   // perception scheduler.
+   if (mAimObject && !mSensorEnabled) {
       MatrixF eyeMat;
       getEyeTransform(&eyeMat);
       eyeMat.getColumn(3,&location);
@@ -345,9 +456,56 @@ ConsoleMethod( AIPlayer, setMoveDestination, void, 3, 4, "(Point3F goal, bool sl
    Point3F v( 0.0f, 0.0f, 0.0f );
    dSscanf( argv[2], "%g %g %g", &v.x, &v.y, &v.z );
    bool slowdown = (argc > 3)? dAtob(argv[3]): true;
+   object->clearPath();
    object->setMoveDestination( v, slowdown);
 }
 
+ConsoleMethod( AIPlayer, setPathDestination, void, 3, 4, "(Point3F goal, bool slowDown=true)"
+              "Finds a path to the location through the navigation graph and follows it.  "
+              "The search runs in the background; onPathFound or onPathFailed is called on "
+              "the datablock when it's done, and onReachDestination at the end of the path.")
+{
+   Point3F v( 0.0f, 0.0f, 0.0f );
+   dSscanf( argv[2], "%g %g %g", &v.x, &v.y, &v.z );
+   bool slowdown = (argc > 3)? dAtob(argv[3]): true;
+   object->setPathDestination( v, slowdown );
+}
+
+ConsoleMethod( AIPlayer, getPathLength, S32, 2, 2, "()"
+              "Returns how many waypoints are left after the current move destination.")
+{
+   return object->getPathLength();
+}
+
+ConsoleMethod( AIPlayer, setSensor, void, 3, 6, "( float range, [float fov=360], [int intervalMs=500], [bitset mask=Player] )"
+              "Has the bot look for objects of the mask within range and view cone every interval ms.  "
+              "onSensorSee(%this, %bot, %obj) and onSensorLose(%this, %bot, %obj) are called on the "
+              "datablock as objects come into and go out of sight.")
+{
+   F32 fov = (argc > 3)? dAtof( argv[3] ): 360.0f;
+   U32 interval = (argc > 4)? dAtoi( argv[4] ): 500;
+   U32 mask = (argc > 5)? dAtoi( argv[5] ): PlayerObjectType;
+   object->setSensor( dAtof( argv[2] ), fov, interval, mask );
+}
+
+ConsoleMethod( AIPlayer, clearSensor, void, 2, 2, "()"
+              "Stops the bot's sensor.")
+{
+   object->clearSensor();
+}
+
+ConsoleMethod( AIPlayer, getVisibleObjects, const char *, 2, 2, "()"
+              "Returns the objects the sensor saw on its last look, space separated.")
+{
+   const Vector<SimObjectId> &visible = object->getVisibleObjects();
+   char *returnBuffer = Con::getReturnBuffer( visible.size() * 11 + 1 );
+   returnBuffer[0] = 0;
+   U32 len = 0;
+   for (U32 i = 0; i < visible.size(); i++)
+      len += dSprintf( returnBuffer + len, 12, i? " %d": "%d", visible[i] );
+   return returnBuffer;
+}
+
 ConsoleMethod( AIPlayer, getMoveDestination, const char *, 2, 2, "()"
               "Returns the point the AI is set to move to.")
 {
@@ -404,3 +562,61 @@ ConsoleMethod( AIPlayer, getAimObject, S32, 2, 2, "()"
    return obj? obj->getId(): -1;
 }
 
+
+ConsoleMethod( AIPlayer, checkLOS, const char *, 3, 4, "( string objects, [bitset mask] )"
+              "Checks line of sight from the bot's eye to the center of each object in the "
+              "space separated list.\n\n"
+              "All the rays are cast as a single batch, which is much cheaper than casting "
+              "them one at a time from script.  The default mask is the same static geometry "
+              "used for the aim object LOS test.\n\n"
+              "@returns A space separated list with a 1 for each visible object and a 0 for "
+              "each blocked or unknown object.")
+{
+   U32 mask = InteriorObjectType | StaticShapeObjectType | StaticObjectType | TerrainObjectType;
+   if (argc > 3)
+      mask = dAtoi(argv[3]);
+
+   MatrixF eyeMat;
+   object->getEyeTransform(&eyeMat);
+   Point3F eye;
+   eyeMat.getColumn(3, &eye);
+
+   // Collect the targets that exist, remembering where they came from
+   // in the list so unknowns can be reported as not visible.
+   Vector<RayQuery> rays;
+   Vector<bool> found;
+   char* buffer = dStrdup(argv[2]);
+   for (char* tok = dStrtok(buffer, " \t\n"); tok; tok = dStrtok(NULL, " \t\n"))
+   {
+      SceneObject* target;
+      found.push_back(Sim::findObject(tok, target));
+      if (found.last())
+      {
+         rays.increment();
+         rays.last().start = eye;
+         rays.last().end   = target->getBoxCenter();
+      }
+   }
+   dFree(buffer);
+
+   Vector<RayInfo> results;
+   results.setSize(rays.size());
+   for (U32 i = 0; i < results.size(); i++)
+      constructInPlace(&results[i]);
+
+   // Don't let the bot block its own view.
+   object->disableCollision();
+   if (rays.size())
+      object->getContainer()->castRays(rays.address(), rays.size(), mask, results.address());
+   object->enableCollision();
+
+   char *returnBuffer = Con::getReturnBuffer(found.size() * 2 + 1);
+   returnBuffer[0] = 0;
+   U32 ray = 0;
+   for (U32 i = 0; i < found.size(); i++)
+   {
+      bool visible = found[i] && results[ray++].object == NULL;
+      dStrcat(returnBuffer, i ? (visible ? " 1" : " 0") : (visible ? "1" : "0"));
+   }
+   return returnBuffer;
+}
@@ -14,6 +14,7 @@
 class AIPlayer : public Player {
 
 	typedef Player Parent;
+	friend class AIPerception;
 
 public:
 	enum MoveState {
@@ -37,6 +38,19 @@ private:
 
       Point3F mAimOffset;
 
+      Vector<Point3F> mPath;              // Waypoints still to go after mMoveDestination
+      S32 mPathQuery;                     // NavGraph query we're waiting on, or 0
+      bool mPathSlowdown;                 // Slowdown at the end of the path
+
+      // Sensor, run by the AIPerception scheduler
+      bool mSensorEnabled;
+      F32 mSensorRange;
+      F32 mSensorFovCos;                  // Cosine of half the view cone, -1 all round
+      U32 mSensorInterval;                // Ms between looks
+      U32 mSensorMask;                    // Types of object to look for
+      SimTime mSensorNextUpdate;
+      Vector<SimObjectId> mSensorVisible; // What the last look saw
+
       // Utility Methods
       void throwCallback( const char *name );
 public:
@@ -45,6 +59,8 @@ public:
 		AIPlayer();
       ~AIPlayer();
 
+      void onRemove();
+
 		virtual bool getAIMove( Move *move );
 
 		// Targeting and aiming sets/gets
@@ -64,6 +80,17 @@ public:
 		Point3F getMoveDestination() const { return mMoveDestination; }
 		void stopMove();
 
+		// Pathing through the NavGraph
+		void setPathDestination( const Point3F &location, bool slowdown );
+		void onPathResult( S32 queryId, bool found, const Vector<Point3F> &points );
+		void clearPath();
+		U32 getPathLength() const { return mPath.size(); }
+
+		// Sensor
+		void setSensor( F32 range, F32 fov, U32 interval, U32 mask );
+		void clearSensor();
+		const Vector<SimObjectId> &getVisibleObjects() const { return mSensorVisible; }
+
 };
 
 #endif
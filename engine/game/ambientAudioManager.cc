@@ -12,6 +12,11 @@
 
 AmbientAudioManager     gAmbientAudioManager;
 
+bool AmbientAudioManager::smCullEmitters = true;
+F32  AmbientAudioManager::smCullSpeed = 50.f;
+S32  AmbientAudioManager::smNumActiveEmitters = 0;
+S32  AmbientAudioManager::smNumCulledEmitters = 0;
+
 //------------------------------------------------------------------------------
 AmbientAudioManager::AmbientAudioManager()
 {
@@ -19,6 +24,12 @@ AmbientAudioManager::AmbientAudioManager()
    mInteriorAudioHandle = NULL_AUDIOHANDLE;
    mPowerAudioHandle = NULL_AUDIOHANDLE;
    mLastAlarmState = false;
+
+   mGridRange = 0.f;
+   mCullPass = 0;
+   mCullingOff = false;
+   mLastListener.set(0.f, 0.f, 0.f);
+   mLastCullTime = 0;
 }
 
 //------------------------------------------------------------------------------
@@ -33,10 +44,12 @@ void AmbientAudioManager::addEmitter(AudioEmitter * emitter)
 {
    mEmitters.push_back(emitter);
    updateEmitter(emitter);
+   fileEmitter(emitter);
 }
 
 void AmbientAudioManager::removeEmitter(AudioEmitter * emitter)
 {
+   unfileEmitter(emitter);
    for(U32 i = 0; i < mEmitters.size(); i++)
       if(mEmitters[i] == emitter)
       {
@@ -45,6 +58,213 @@ void AmbientAudioManager::removeEmitter(AudioEmitter * emitter)
       }
 }
 
+void AmbientAudioManager::refreshEmitter(AudioEmitter * emitter)
+{
+   if(!emitter->isProperlyAdded())
+      return;
+
+   unfileEmitter(emitter);
+
+   // may not be cullable anymore
+   if(emitter->mCulled && !canCull(emitter))
+      setEmitterActive(emitter, true);
+   fileEmitter(emitter);
+}
+
+//------------------------------------------------------------------------------
+// Emitter culling
+//------------------------------------------------------------------------------
+bool AmbientAudioManager::canCull(AudioEmitter * emitter)
+{
+   // one shots and 2d sounds are left alone
+   const Audio::Description * desc = emitter->getDescription();
+   return(desc && desc->mIs3D && desc->mIsLooping);
+}
+
+U32 AmbientAudioManager::getBucket(const Point3F & pos)
+{
+   S32 x = S32(mFloor(pos.x / F32(GridCellSize)));
+   S32 y = S32(mFloor(pos.y / F32(GridCellSize)));
+   return((U32(x) * 73856093 ^ U32(y) * 19349663) & (GridBuckets - 1));
+}
+
+void AmbientAudioManager::fileEmitter(AudioEmitter * emitter)
+{
+   if(!canCull(emitter))
+      return;
+
+   emitter->mFiled = true;
+   emitter->mCullRange = emitter->getDescription()->mMaxDistance;
+   emitter->mGridBucket = getBucket(emitter->getPosition());
+   mGrid[emitter->mGridBucket].push_back(emitter);
+   mGridRange = getMax(mGridRange, emitter->mCullRange);
+
+   if(!emitter->mCulled)
+      mActive.push_back(emitter);
+
+   // sort it out now, rather than have it play a frame
+   if(smCullEmitters)
+   {
+      Point3F listener;
+      alxGetListenerPoint3F(AL_POSITION, &listener);
+      checkEmitter(emitter, listener, Platform::getRealMilliseconds(), true);
+   }
+}
+
+void AmbientAudioManager::unfileEmitter(AudioEmitter * emitter)
+{
+   if(!emitter->mFiled)
+      return;
+   emitter->mFiled = false;
+
+   Vector<AudioEmitter*> & bucket = mGrid[emitter->mGridBucket];
+   for(U32 i = 0; i < bucket.size(); i++)
+      if(bucket[i] == emitter)
+      {
+         bucket.erase_fast(i);
+         break;
+      }
+
+   if(!emitter->mCulled)
+   {
+      for(U32 i = 0; i < mActive.size(); i++)
+         if(mActive[i] == emitter)
+         {
+            mActive.erase_fast(i);
+            break;
+         }
+   }
+}
+
+void AmbientAudioManager::setEmitterActive(AudioEmitter * emitter, bool active)
+{
+   if(active == !emitter->mCulled)
+      return;
+
+   if(active)
+   {
+      emitter->mCulled = false;
+      if(emitter->mFiled)
+         mActive.push_back(emitter);
+
+      emitter->mDirty.set(AudioEmitter::SourceMask);
+      emitter->update();
+      updateEmitter(emitter);
+   }
+   else
+   {
+      for(U32 i = 0; i < mActive.size(); i++)
+         if(mActive[i] == emitter)
+         {
+            mActive.erase_fast(i);
+            break;
+         }
+
+      emitter->mCulled = true;
+      emitter->stopSource();
+   }
+}
+
+void AmbientAudioManager::checkEmitter(AudioEmitter * emitter, const Point3F & listener, U32 time, bool force)
+{
+   F32 dist = (emitter->getPosition() - listener).len();
+
+   if(!emitter->mCulled)
+   {
+      // a bit past the edge, so standing on it doesn't flip it on and off
+      if(dist > emitter->mCullRange * 1.1f + 2.f)
+      {
+         setEmitterActive(emitter, false);
+         emitter->mNextCullCheck = time;
+      }
+      return;
+   }
+
+   if(!force && S32(time - emitter->mNextCullCheck) < 0)
+      return;
+
+   if(dist <= emitter->mCullRange)
+      setEmitterActive(emitter, true);
+   else
+   {
+      // no need to look again until the listener could be in range
+      F32 delay = (dist - emitter->mCullRange) * 1000.f / getMax(smCullSpeed, 1.f);
+      emitter->mNextCullCheck = time + U32(getMin(delay, F32(MaxCheckDelay)));
+   }
+}
+
+void AmbientAudioManager::cullEmitters()
+{
+   if(!smCullEmitters)
+   {
+      if(!mCullingOff)
+      {
+         for(U32 i = 0; i < GridBuckets; i++)
+            for(U32 j = 0; j < mGrid[i].size(); j++)
+               setEmitterActive(mGrid[i][j], true);
+         mCullingOff = true;
+      }
+      smNumActiveEmitters = mActive.size();
+      smNumCulledEmitters = 0;
+      return;
+   }
+   mCullingOff = false;
+
+   U32 time = Platform::getRealMilliseconds();
+   Point3F listener;
+   alxGetListenerPoint3F(AL_POSITION, &listener);
+
+   // warped (respawn, camera cut...), the check times don't hold
+   F32 elapsed = F32(time - mLastCullTime) * 0.001f;
+   bool force = (listener - mLastListener).len() > smCullSpeed * elapsed + 10.f;
+   mLastListener = listener;
+   mLastCullTime = time;
+
+   // the ones playing
+   for(S32 i = mActive.size() - 1; i >= 0; i--)
+      checkEmitter(mActive[i], listener, time, false);
+
+   // and the rest in the cells that could be in range
+   mCullPass++;
+   S32 x0 = S32(mFloor((listener.x - mGridRange) / F32(GridCellSize)));
+   S32 x1 = S32(mFloor((listener.x + mGridRange) / F32(GridCellSize)));
+   S32 y0 = S32(mFloor((listener.y - mGridRange) / F32(GridCellSize)));
+   S32 y1 = S32(mFloor((listener.y + mGridRange) / F32(GridCellSize)));
+
+   static Vector<U32> buckets;
+   buckets.clear();
+   if((x1 - x0 + 1) * (y1 - y0 + 1) >= GridBuckets)
+   {
+      for(U32 i = 0; i < GridBuckets; i++)
+         buckets.push_back(i);
+   }
+   else
+   {
+      for(S32 x = x0; x <= x1; x++)
+         for(S32 y = y0; y <= y1; y++)
+            buckets.push_back(getBucket(Point3F((x + 0.5f) * GridCellSize, (y + 0.5f) * GridCellSize, 0.f)));
+   }
+
+   for(U32 i = 0; i < buckets.size(); i++)
+   {
+      Vector<AudioEmitter*> & bucket = mGrid[buckets[i]];
+      for(S32 j = bucket.size() - 1; j >= 0; j--)
+      {
+         AudioEmitter * emitter = bucket[j];
+         if(emitter->mCullPass == mCullPass || !emitter->mCulled)
+            continue;
+         emitter->mCullPass = mCullPass;
+         checkEmitter(emitter, listener, time, force);
+      }
+   }
+
+   U32 filed = 0;
+   for(U32 i = 0; i < GridBuckets; i++)
+      filed += mGrid[i].size();
+   smNumActiveEmitters = mActive.size();
+   smNumCulledEmitters = filed - mActive.size();
+}
+
 bool AmbientAudioManager::getOutsideScale(F32 * pScale, InteriorInstance ** pInterior)
 {
    GameConnection * gc = dynamic_cast<GameConnection*>(NetConnection::getConnectionToServer());
@@ -115,6 +335,8 @@ void AmbientAudioManager::stopInteriorAudio()
 //---------------------------------------------------------------------------
 void AmbientAudioManager::update()
 {
+   cullEmitters();
+
    if(!bool(mInteriorInstance) && (mInteriorAudioHandle != NULL_AUDIOHANDLE))
       stopInteriorAudio();
 
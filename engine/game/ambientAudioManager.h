@@ -23,6 +23,16 @@ class InteriorInstance;
 /// AudioEmitter::onAdd() and AudioEmitter::onRemove(). update() is called in
 /// clientProcess(), and gAmbientAudioManager stores the global reference to the
 /// AmbientAudioManager.
+///
+/// It also keeps looping 3D emitters out of the sound library while the
+/// listener is beyond their max distance, so a mission with hundreds of
+/// them only pays for the few in earshot.  Those emitters are filed in a
+/// grid by position, and update() only looks at the cells around the
+/// listener.  One found out of range isn't looked at again until the
+/// listener could have got there at $pref::Audio::emitterCullSpeed, so
+/// the far ones are checked less often than the near ones.  Emitters in
+/// range have their source, and lose it once the listener is a good bit
+/// past the max distance. $pref::Audio::cullEmitters turns this off.
 class AmbientAudioManager
 {
 
@@ -43,14 +53,47 @@ class AmbientAudioManager
       void updateEmitter(AudioEmitter *);
       void stopInteriorAudio();
 
+      /// @name Emitter Culling
+      /// @{
+      enum {
+         GridBuckets    = 256,      ///< Power of two.
+         GridCellSize   = 64,       ///< Meters.
+         MaxCheckDelay  = 2000,     ///< ms, in case the listener warps.
+      };
+
+      Vector<AudioEmitter*>   mGrid[GridBuckets];  ///< Cullable emitters, hashed by cell.
+      Vector<AudioEmitter*>   mActive;             ///< Cullable emitters that have a source.
+      F32                     mGridRange;          ///< Largest cull range in the grid.
+      U32                     mCullPass;
+      bool                    mCullingOff;         ///< Everything was turned on.
+      Point3F                 mLastListener;
+      U32                     mLastCullTime;
+
+      static bool canCull(AudioEmitter *);
+      static U32 getBucket(const Point3F &);
+      void fileEmitter(AudioEmitter *);
+      void unfileEmitter(AudioEmitter *);
+      void setEmitterActive(AudioEmitter *, bool);
+      void checkEmitter(AudioEmitter *, const Point3F &, U32, bool);
+      void cullEmitters();
+      /// @}
+
    public:
       SimObjectPtr<AudioProfile>       mPowerUpProfile;
       SimObjectPtr<AudioProfile>       mPowerDownProfile;
 
+      static bool smCullEmitters;         ///< $pref::Audio::cullEmitters
+      static F32  smCullSpeed;            ///< $pref::Audio::emitterCullSpeed, m/s
+      static S32  smNumActiveEmitters;    ///< $Audio::activeEmitters
+      static S32  smNumCulledEmitters;    ///< $Audio::culledEmitters
+
       AmbientAudioManager();
 
       void addEmitter(AudioEmitter*);
       void removeEmitter(AudioEmitter*);
+
+      /// Called when an emitter moved or changed its description.
+      void refreshEmitter(AudioEmitter*);
       void update();
 };
 
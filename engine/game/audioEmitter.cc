@@ -60,6 +60,13 @@ AudioEmitter::AudioEmitter(bool client)
 
    mEnableVisualFeedback = true;
    mAnimRotAngle=0.f;
+
+   mCulled = false;
+   mFiled = false;
+   mGridBucket = 0;
+   mCullRange = 0.f;
+   mCullPass = 0;
+   mNextCullCheck = 0;
 }
 
 Audio::Description AudioEmitter::smDefaultDescription;
@@ -67,7 +74,7 @@ Audio::Description AudioEmitter::smDefaultDescription;
 //------------------------------------------------------------------------------
 void AudioEmitter::processLoopEvent()
 {
-   if(mLoopCount == 0)
+   if(mLoopCount == 0 || mCulled)
       return;
    else if(mLoopCount > 0)
       mLoopCount--;
@@ -97,6 +104,51 @@ void AudioEmitter::processLoopEvent()
    update();
 }
 
+//------------------------------------------------------------------------------
+void AudioEmitter::findDataBlocks()
+{
+   // profile:
+   if(mDirty.test(Profile))
+   {
+      if(!mAudioProfileId)
+         mAudioProfile = 0;
+      else
+         mAudioProfile = dynamic_cast<AudioProfile*>(Sim::findObject(mAudioProfileId));
+   }
+
+   // description:
+   if(mDirty.test(Description))
+   {
+      if(!mAudioDescriptionId)
+         mAudioDescription = 0;
+      else
+         mAudioDescription = dynamic_cast<AudioDescription*>(Sim::findObject(mAudioDescriptionId));
+   }
+}
+
+const Audio::Description * AudioEmitter::getDescription()
+{
+   if(mUseProfileDescription && mAudioProfile)
+      return(mAudioProfile->getDescription());
+   else if(mAudioDescription)
+      return(mAudioDescription->getDescription());
+   return(&mDescription);
+}
+
+void AudioEmitter::stopSource()
+{
+   if(mEventID)
+   {
+      Sim::cancelEvent(mEventID);
+      mEventID = 0;
+   }
+   if(mAudioHandle != NULL_AUDIOHANDLE)
+   {
+      alxStop(mAudioHandle);
+      mAudioHandle = NULL_AUDIOHANDLE;
+   }
+}
+
 //------------------------------------------------------------------------------
 bool AudioEmitter::update()
 {
@@ -106,6 +158,14 @@ bool AudioEmitter::update()
    if(mDirty.test(LoopCount))
       mLoopCount = mDescription.mLoopCount;
 
+   // out of the listener's range (see AmbientAudioManager): the dirty
+   // flags are kept and the source is made when it comes back
+   if(mCulled)
+   {
+      findDataBlocks();
+      return(true);
+   }
+
    // updating source?
    if(mDirty.test(SourceMask|UseProfileDescription) || (!mUseProfileDescription &&
       ((mDescription.mIsLooping && mDirty.test(LoopingMask)) || mDirty.test(IsLooping|Is3D|AudioType))))
@@ -116,23 +176,7 @@ bool AudioEmitter::update()
          mAudioHandle = NULL_AUDIOHANDLE;
       }
 
-      // profile:
-      if(mDirty.test(Profile))
-      {
-         if(!mAudioProfileId)
-            mAudioProfile = 0;
-         else
-            mAudioProfile = dynamic_cast<AudioProfile*>(Sim::findObject(mAudioProfileId));
-      }
-
-      // description:
-      if(mDirty.test(Description))
-      {
-         if(!mAudioDescriptionId)
-            mAudioDescription = 0;
-         else
-            mAudioDescription = dynamic_cast<AudioDescription*>(Sim::findObject(mAudioDescriptionId));
-      }
+      findDataBlocks();
 
       MatrixF transform = getTransform();
 
@@ -228,15 +272,7 @@ bool AudioEmitter::update()
       }
 
       // grab the description
-      const Audio::Description * desc = 0;
-
-      if(mUseProfileDescription && mAudioProfile)
-         desc = mAudioProfile->getDescription();
-      else if(mAudioDescription)
-         desc = mAudioDescription->getDescription();
-      else
-         desc = &mDescription;
-
+      const Audio::Description * desc = getDescription();
       if(!desc)
          return(true);
 
@@ -361,7 +397,7 @@ bool AudioEmitter::prepRenderImage(SceneState * state, const U32 stateKey, const
    setLastState(state, stateKey);
    if(gEditingMission && state->isObjectRendered(this))
    {
-      SceneRenderImage * image = new SceneRenderImage;
+      SceneRenderImage * image = SceneState::newRenderImage<SceneRenderImage>();
       image->obj = this;
       state->insertRenderImage(image);
    }
@@ -935,7 +971,12 @@ void AudioEmitter::unpackData(NetConnection *, BitStream * stream)
 
    // update the emitter now?
    if(!initialUpdate)
+   {
       update();
+
+      // it may have moved, or changed range
+      gAmbientAudioManager.refreshEmitter(this);
+   }
 }
 
 void AudioEmitter::unpackUpdate(NetConnection * con, BitStream * stream)
@@ -76,6 +76,25 @@ class AudioEmitter : public SceneObject
       BitSet32                   mDirty;
       bool readDirtyFlag(BitStream *, U32);
 
+      /// @name Culling
+      /// Kept by the AmbientAudioManager.
+      /// @{
+      bool                             mCulled;          ///< Out of range, no source.
+      bool                             mFiled;           ///< In the manager's grid.
+      U32                              mGridBucket;
+      F32                              mCullRange;
+      U32                              mCullPass;
+      U32                              mNextCullCheck;   ///< Real ms.
+      /// @}
+
+      /// Looks up the profile and description if they're dirty.
+      void findDataBlocks();
+
+      /// The description the source is played with, NULL if none yet.
+      const Audio::Description * getDescription();
+
+      void stopSource();
+
    public:
 
       AudioEmitter(bool client = false);
@@ -15,6 +15,7 @@ BadWordFilter::BadWordFilter()
    dStrcpy(defaultReplaceStr, "knqwrtlzs");
    filterTables.push_back(new FilterTable);
    curOffset = 0;
+   machineDirty = true;
 }
 
 BadWordFilter::~BadWordFilter()
@@ -54,6 +55,7 @@ BadWordFilter::FilterTable::FilterTable()
 {
    for(U32 i = 0; i < 26; i++)
       nextState[i] = TerminateNotFound;
+   terminal = false;
 }
 
 bool BadWordFilter::addBadWord(const char *cword)
@@ -62,7 +64,7 @@ bool BadWordFilter::addBadWord(const char *cword)
    // prescan the word to see if it has any skip chars
    const U8 *word = (const U8 *) cword;
    const U8 *walk = word;
-   if(dStrlen(cword) > MaxBadwordLength)
+   if(!*word || dStrlen(cword) > MaxBadwordLength)
       return false;
    while(*walk)
    {
@@ -72,36 +74,84 @@ bool BadWordFilter::addBadWord(const char *cword)
    }
    while(*word)
    {
-      U8 remap = remapTable[*word] - 'A';
-      U16 state = curFilterTable->nextState[remap];
-
-      if(state < TerminateNotFound)
-      {
-         // this character is already in the state table...
-         curFilterTable = filterTables[state];
-      }
-      else if(state == TerminateFound)
+      if(curFilterTable->terminal)
       {
          // a subset of this word is already in the table...
          // exit out.
          return false;
       }
-      else if(state == TerminateNotFound)
+
+      U8 remap = remapTable[*word] - 'A';
+      U16 state = curFilterTable->nextState[remap];
+
+      if(state == TerminateNotFound)
       {
-         if(word[1])
-         {
-            curFilterTable->nextState[remap] = filterTables.size();
-            filterTables.push_back(new FilterTable);
-            curFilterTable = filterTables[filterTables.size() - 1];
-         }
-         else
-            curFilterTable->nextState[remap] = TerminateFound;
+         if(filterTables.size() >= TerminateNotFound)
+            return false;
+         state = filterTables.size();
+         curFilterTable->nextState[remap] = state;
+         filterTables.push_back(new FilterTable);
       }
+      curFilterTable = filterTables[state];
       word++;
    }
+   if(curFilterTable->terminal)
+      return false;
+
+   // Longer words starting with this one can stay, this one matches first.
+   curFilterTable->terminal = true;
+   machineDirty = true;
    return true;
 }
 
+void BadWordFilter::compile()
+{
+   if(!machineDirty)
+      return;
+   machineDirty = false;
+
+   // Breadth first, so a node's failure state, which is shallower, has
+   // its row filled in by the time the node's is.
+   U32 numTables = filterTables.size();
+   machine.setSize(numTables * 26);
+   matchLength.setSize(numTables);
+
+   Vector<U16> fail(numTables);
+   Vector<U8> depth(numTables);
+   Vector<U16> queue(numTables);
+   fail.setSize(numTables);
+   depth.setSize(numTables);
+   queue.setSize(numTables);
+
+   fail[0] = 0;
+   depth[0] = 0;
+   matchLength[0] = 0;
+   U32 head = 0, tail = 0;
+   queue[tail++] = 0;
+   while(head < tail)
+   {
+      U32 cur = queue[head++];
+      FilterTable *curFilterTable = filterTables[cur];
+      U16 *row = &machine[cur * 26];
+      const U16 *failRow = &machine[fail[cur] * 26];
+      for(U32 i = 0; i < 26; i++)
+      {
+         U16 next = curFilterTable->nextState[i];
+         if(next == TerminateNotFound)
+         {
+            row[i] = cur ? failRow[i] : 0;
+            continue;
+         }
+
+         row[i] = next;
+         fail[next] = cur ? failRow[i] : 0;
+         depth[next] = depth[cur] + 1;
+         matchLength[next] = filterTables[next]->terminal ? depth[next] : matchLength[fail[next]];
+         queue[tail++] = next;
+      }
+   }
+}
+
 bool BadWordFilter::setDefaultReplaceStr(const char *str)
 {
    U32 len = dStrlen(str);
@@ -115,76 +165,50 @@ void BadWordFilter::filterString(char *cstring, const char *replaceStr)
 {
    if(!replaceStr)
       replaceStr = defaultReplaceStr;
-   U8 *string = (U8 *) cstring;
+   compile();
+
+   // The last MaxBadwordLength letters seen; skip chars don't count.
    U8 *starts[MaxBadwordLength];
-   U8 *curStart = string;
+   U32 count = 0;
+   U32 state = 0;
    U32 replaceLen = dStrlen(replaceStr);
-   while(*curStart)
+   for(U8 *walk = (U8 *) cstring; *walk; walk++)
    {
-      FilterTable *curFilterTable = filterTables[0];
-      S32 index = 0;
-      U8 *walk = curStart;
-      while(*walk)
+      U8 remap = remapTable[*walk];
+      if(remap == '-')
+         continue;
+
+      starts[count++ & (MaxBadwordLength - 1)] = walk;
+      state = machine[state * 26 + remap - 'A'];
+
+      // Replace the longest word ending here and start over after it.
+      U32 len = matchLength[state];
+      if(len)
       {
-         U8 remap = remapTable[*walk];
-         if(remap != '-')
+         for(U32 i = count - len; i < count; i++)
          {
-            starts[index++] = walk;
-            U16 table = curFilterTable->nextState[remap - 'A'];
-            if(table < TerminateNotFound)
-               curFilterTable = filterTables[table];
-            else if(table == TerminateNotFound)
-            {
-               curStart++;
-               break;
-            }
-            else // terminate found
-            {
-               for(U32 i = 0; i < index; i++)
-               {
-                  starts[i][0] = (U8 )replaceStr[curOffset % replaceLen];
-                  curOffset += randomJunk[curOffset & (MaxBadwordLength - 1)];
-               }
-               curStart = walk + 1;
-               break;
-            }
+            starts[i & (MaxBadwordLength - 1)][0] = (U8 )replaceStr[curOffset % replaceLen];
+            curOffset += randomJunk[curOffset & (MaxBadwordLength - 1)];
          }
-         walk++;
+         state = 0;
       }
-      if(!*walk)
-         curStart++;
    }
 }
 
 bool BadWordFilter::containsBadWords(const char *cstring)
 {
-   U8 *string = (U8 *) cstring;
-   U8 *curStart = string;
-   while(*curStart)
+   compile();
+
+   U32 state = 0;
+   for(const U8 *walk = (const U8 *) cstring; *walk; walk++)
    {
-      FilterTable *curFilterTable = filterTables[0];
-      S32 index = 0;
-      U8 *walk = curStart;
-      while(*walk)
-      {
-         U8 remap = remapTable[*walk];
-         if(remap != '-')
-         {
-            U16 table = curFilterTable->nextState[remap - 'A'];
-            if(table < TerminateNotFound)
-               curFilterTable = filterTables[table];
-            else if(table == TerminateNotFound)
-            {
-               curStart++;
-               break;
-            }
-            else // terminate found
-               return true;
-         }
-         walk++;
-      }
-      if(!*walk)
-         curStart++;
+      U8 remap = remapTable[*walk];
+      if(remap == '-')
+         continue;
+
+      state = machine[state * 26 + remap - 'A'];
+      if(matchLength[state])
+         return true;
    }
    return false;
 }
@@ -10,17 +10,29 @@
 class BadWordFilter
 {
 private:
+   /// A node of the word trie.
    struct FilterTable
    {
       U16 nextState[26]; // only 26 alphabetical chars.
+      bool terminal;     ///< A word ends here.
       FilterTable();
    };
    friend struct FilterTable;
    Vector<FilterTable*> filterTables;
 
+   /// @name Matcher
+   /// The trie compiled into an Aho-Corasick automaton, so a string is
+   /// filtered in one pass instead of a trie walk from every character.
+   /// Rebuilt by compile() the first time it's needed after a word is added.
+   /// @{
+   Vector<U16> machine;      ///< 26 next states per trie node, filled in with the failure links.
+   Vector<U8>  matchLength;  ///< Per node, the length of the longest word ending there, or 0.
+   bool        machineDirty;
+   void compile();
+   /// @}
+
    enum {
       TerminateNotFound = 0xFFFE,
-      TerminateFound = 0xFFFF,
       MaxBadwordLength = 32,
    };
    char defaultReplaceStr[32];
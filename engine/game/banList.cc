@@ -13,6 +13,133 @@ BanList gBanList;
 
 //------------------------------------------------------------------------------
 
+BanList::BanList()
+{
+   mNumRanges = 0;
+   rebuildIndex();
+}
+
+//------------------------------------------------------------------------------
+
+bool BanList::parseAddress(const char *TA, U32 &address, U32 &prefixBits)
+{
+   if(!TA || dStrnicmp(TA, "ip:", 3))
+      return false;
+
+   const char *walk = TA + 3;
+   address = 0;
+   prefixBits = 0;
+   for(U32 i = 0; i < 4; i++)
+   {
+      if(i && *walk++ != '.')
+         return false;
+      if(*walk == '*')
+      {
+         // the rest is wild
+         address <<= 8 * (4 - i);
+         return true;
+      }
+      if(!dIsdigit(*walk))
+         return false;
+
+      U32 octet = 0;
+      while(dIsdigit(*walk))
+         octet = octet * 10 + (*walk++ - '0');
+      if(octet > 255)
+         return false;
+      address = (address << 8) | octet;
+      prefixBits += 8;
+   }
+
+   if(*walk == '/')
+   {
+      walk++;
+      if(!dIsdigit(*walk))
+         return false;
+      prefixBits = dAtoi(walk);
+      if(prefixBits > 32)
+         return false;
+      while(dIsdigit(*walk))
+         walk++;
+   }
+   return !*walk || *walk == ':';
+}
+
+//------------------------------------------------------------------------------
+
+void BanList::indexBan(S32 index)
+{
+   // stay at no more than one ban per bucket
+   if(list.size() > mIdBuckets.size())
+   {
+      rebuildIndex();
+      return;
+   }
+
+   BanInfo &b = list[index];
+   S32 &idHead = mIdBuckets[hashKey(b.uniqueId, mIdBuckets.size())];
+   b.nextId = idHead;
+   idHead = index;
+
+   b.nextAddress = -1;
+   if(!b.prefixBits)
+      return;
+
+   if(b.prefixBits == 32)
+   {
+      S32 &addressHead = mAddressBuckets[hashKey(b.address, mAddressBuckets.size())];
+      b.nextAddress = addressHead;
+      addressHead = index;
+      return;
+   }
+
+   // walk down the range's bits, adding nodes as they're missing
+   S32 node = 0;
+   for(U32 i = 0; i < b.prefixBits; i++)
+   {
+      U32 bit = (b.address >> (31 - i)) & 1;
+      if(mTrie[node].child[bit] == -1)
+      {
+         mTrie[node].child[bit] = mTrie.size();
+         mTrie.increment();
+         mTrie.last().child[0] = mTrie.last().child[1] = mTrie.last().ban = -1;
+      }
+      node = mTrie[node].child[bit];
+   }
+   b.nextAddress = mTrie[node].ban;
+   mTrie[node].ban = index;
+   mNumRanges++;
+}
+
+void BanList::rebuildIndex()
+{
+   U32 numBuckets = 64;
+   while(numBuckets < list.size())
+      numBuckets <<= 1;
+
+   mIdBuckets.setSize(numBuckets);
+   mAddressBuckets.setSize(numBuckets);
+   for(U32 i = 0; i < numBuckets; i++)
+      mIdBuckets[i] = mAddressBuckets[i] = -1;
+
+   mTrie.setSize(1);
+   mTrie[0].child[0] = mTrie[0].child[1] = mTrie[0].ban = -1;
+   mNumRanges = 0;
+
+   for(S32 i = 0; i < list.size(); i++)
+      indexBan(i);
+}
+
+void BanList::removeIndex(S32 index)
+{
+   // the chains are by index, which the erase shifts; removals are rare
+   // next to lookups, so just start over
+   list.erase(index);
+   rebuildIndex();
+}
+
+//------------------------------------------------------------------------------
+
 void BanList::addBan(S32 uniqueId, const char *TA, S32 banTime)
 {
    S32 curTime = Platform::getTime();
@@ -21,18 +148,18 @@ void BanList::addBan(S32 uniqueId, const char *TA, S32 banTime)
       return;
 
    // make sure this bastard isn't already banned on this server
-   Vector<BanInfo>::iterator i;
-   for(i = list.begin();i != list.end();i++)
+   for(S32 i = mIdBuckets[hashKey(uniqueId, mIdBuckets.size())]; i != -1; i = list[i].nextId)
    {
-      if(uniqueId == i->uniqueId)
+      if(uniqueId == list[i].uniqueId)
       {
-         i->bannedUntil = banTime;
+         list[i].bannedUntil = banTime;
          return;
       }
    }
 
    BanInfo b;
-   dStrcpy(b.transportAddress, TA);
+   dStrncpy(b.transportAddress, TA, sizeof(b.transportAddress) - 3);
+   b.transportAddress[sizeof(b.transportAddress) - 3] = 0;
    b.uniqueId = uniqueId;
    b.bannedUntil = banTime;
 
@@ -46,7 +173,11 @@ void BanList::addBan(S32 uniqueId, const char *TA, S32 banTime)
       }
    }
 
+   if(!parseAddress(b.transportAddress, b.address, b.prefixBits))
+      b.address = b.prefixBits = 0;
+
    list.push_back(b);
+   indexBan(list.size() - 1);
 }
 
 //------------------------------------------------------------------------------
@@ -65,12 +196,11 @@ void BanList::addBanRelative(S32 uniqueId, const char *TA, S32 numSeconds)
 
 void BanList::removeBan(S32 uniqueId, const char *)
 {
-   Vector<BanInfo>::iterator i;
-   for(i = list.begin();i != list.end();i++)
+   for(S32 i = mIdBuckets[hashKey(uniqueId, mIdBuckets.size())]; i != -1; i = list[i].nextId)
    {
-      if(uniqueId == i->uniqueId)
+      if(uniqueId == list[i].uniqueId)
       {
-         list.erase(i);
+         removeIndex(i);
          return;
       }
    }
@@ -78,23 +208,58 @@ void BanList::removeBan(S32 uniqueId, const char *)
 
 //------------------------------------------------------------------------------
 
-bool BanList::isBanned(S32 uniqueId, const char *)
+bool BanList::isBanned(S32 uniqueId, const char *TA)
 {
    S32 curTime = Platform::getTime();
 
-   Vector<BanInfo>::iterator i;
-   for(i = list.begin();i != list.end();)
+   // Expired bans come out as they're found.
+   S32 expired = -1;
+   bool banned = false;
+
+   for(S32 i = mIdBuckets[hashKey(uniqueId, mIdBuckets.size())]; i != -1 && !banned; i = list[i].nextId)
    {
-      if(i->bannedUntil != 0 && i->bannedUntil < curTime)
-      {
-         list.erase(i);
+      if(uniqueId != list[i].uniqueId)
          continue;
+      if(isExpired(list[i], curTime))
+         expired = i;
+      else
+         banned = true;
+   }
+
+   U32 address, prefixBits;
+   if(!banned && expired == -1 && parseAddress(TA, address, prefixBits) && prefixBits == 32)
+   {
+      for(S32 i = mAddressBuckets[hashKey(address, mAddressBuckets.size())]; i != -1 && !banned; i = list[i].nextAddress)
+      {
+         if(address != list[i].address)
+            continue;
+         if(isExpired(list[i], curTime))
+            expired = i;
+         else
+            banned = true;
       }
-      else if(uniqueId == i->uniqueId)
-         return true;
-      i++;
+
+      // every range on the way down the address' bits covers it
+      S32 node = mNumRanges ? 0 : -1;
+      for(U32 bit = 0; node != -1 && !banned; bit++)
+      {
+         for(S32 i = mTrie[node].ban; i != -1 && !banned; i = list[i].nextAddress)
+         {
+            if(isExpired(list[i], curTime))
+               expired = i;
+            else
+               banned = true;
+         }
+         node = bit < 32 ? mTrie[node].child[(address >> (31 - bit)) & 1] : -1;
+      }
+   }
+
+   if(!banned && expired != -1)
+   {
+      removeIndex(expired);
+      return isBanned(uniqueId, TA);
    }
-   return false;
+   return banned;
 }
 
 //------------------------------------------------------------------------------
@@ -14,6 +14,12 @@
 #endif
 
 /// Helper class to keep track of bans.
+///
+/// A ban is on a unique id and, for IP transport addresses, on the address
+/// or a range of them: "IP:1.2.3.4:*", "IP:1.2.3.*" or "IP:1.2.0.0/16".
+/// isBanned() looks up ids and exact addresses in hash tables and ranges in
+/// a binary trie on the address bits, so it costs the same with ten bans as
+/// with ten thousand.
 class BanList : public SimObject
 {
    typedef SimObject Parent;
@@ -24,11 +30,16 @@ public:
       S32      uniqueId;
       char     transportAddress[128];
       S32      bannedUntil;
+
+      U32      address;       ///< Host order.
+      U32      prefixBits;    ///< Of address that count; 0 if it's no IP ban.
+      S32      nextId;        ///< Next in its mIdBuckets chain, or -1.
+      S32      nextAddress;   ///< Next in its mAddressBuckets or trie chain, or -1.
    };
 
    Vector<BanInfo> list;
 
-   BanList(){}
+   BanList();
    ~BanList(){}
 
    void addBan(S32 uniqueId, const char *TA, S32 banTime);
@@ -38,6 +49,33 @@ public:
    bool isTAEq(const char *bannedTA, const char *TA);
    void exportToFile(const char *fileName);
 
+   /// Parses an "IP:" transport address into address and prefix length.
+   /// A '*' octet or a "/bits" suffix makes a range; any port is ignored.
+   static bool parseAddress(const char *TA, U32 &address, U32 &prefixBits);
+
+private:
+   /// A node of the range trie; child[bit] is the next bit down.
+   struct TrieNode
+   {
+      S32 child[2];
+      S32 ban;                ///< First ban on this exact range, or -1.
+   };
+
+   Vector<S32> mIdBuckets;         ///< Heads of the uniqueId chains.
+   Vector<S32> mAddressBuckets;    ///< Heads of the exact address chains.
+   Vector<TrieNode> mTrie;         ///< Ranges; node 0 is the root.
+   S32 mNumRanges;
+
+   static U32 hashKey(U32 key, U32 numBuckets) { key *= 2654435761U; return (key ^ (key >> 16)) & (numBuckets - 1); }
+
+   /// Links list[index] into the indexes, growing the hash tables as needed.
+   void indexBan(S32 index);
+   void rebuildIndex();
+   void removeIndex(S32 index);
+   bool isExpired(const BanInfo &ban, S32 curTime) const { return ban.bannedUntil != 0 && ban.bannedUntil < curTime; }
+
+public:
+
    DECLARE_CONOBJECT(BanList);
 };
 
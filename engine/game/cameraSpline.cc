@@ -39,7 +39,9 @@ CameraSpline::CameraSpline()
    mFront = NULL;
    mSize = 0;
    mIsMapDirty = true;
+   mIsIndexDirty = true;
    VECTOR_SET_ASSOCIATION(mTimeMap);
+   VECTOR_SET_ASSOCIATION(mKnotIndex);
 }
 
 
@@ -69,14 +71,22 @@ void CameraSpline::push_back(Knot *w)
    }
    ++mSize;
    mIsMapDirty = true;
+   mIsIndexDirty = true;
 }
 
 CameraSpline::Knot* CameraSpline::getKnot(S32 i)
 {
-   Knot *k = mFront;
-   while(i--)
-      k = k->next;
-   return k;
+   if (mIsIndexDirty)
+   {
+      mKnotIndex.setSize(mSize);
+      Knot *k = mFront;
+      for (S32 j = 0; j < mSize; j++, k = k->next)
+         mKnotIndex[j] = k;
+      mIsIndexDirty = false;
+   }
+
+   // Past the end wraps around, as walking the list would.
+   return (mSize > 0) ? mKnotIndex[i % mSize] : NULL;
 }
 
 CameraSpline::Knot* CameraSpline::remove(Knot *w)
@@ -92,6 +102,7 @@ CameraSpline::Knot* CameraSpline::remove(Knot *w)
    }
    --mSize;
    mIsMapDirty = true;
+   mIsIndexDirty = true;
    return w;
 }
 
@@ -201,14 +212,45 @@ F32 CameraSpline::advanceDist(F32 t, F32 meters)
 }
 
 
+S32 CameraSpline::findTime(F32 t)
+{
+   // Both keys only grow along the map, so a binary search finds the same
+   // entry the linear walk did.
+   S32 lo = 1, hi = mTimeMap.size() - 1;
+   while (lo < hi)
+   {
+      S32 mid = (lo + hi) >> 1;
+      if (mTimeMap[mid].mTime < t)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   return lo;
+}
+
+
+S32 CameraSpline::findDistance(F32 d)
+{
+   S32 lo = 1, hi = mTimeMap.size() - 1;
+   while (lo < hi)
+   {
+      S32 mid = (lo + hi) >> 1;
+      if (mTimeMap[mid].mDistance < d)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   return lo;
+}
+
+
 F32 CameraSpline::getDistance(F32 t)
 {
    if (mSize <= 1)
       return 0;
 
    // Find the nodes spanning the time
-   Vector<TimeMap>::iterator end = mTimeMap.begin() + 1, start;
-   for (; end < (mTimeMap.end() - 1) && end->mTime < t; end++)  {  }
+   Vector<TimeMap>::iterator end = mTimeMap.begin() + findTime(t), start;
    start = end - 1;
 
    // Interpolate between the two nodes
@@ -223,8 +265,7 @@ F32 CameraSpline::getTime(F32 d)
       return 0;
 
    // Find nodes spanning the distance
-   Vector<TimeMap>::iterator end = mTimeMap.begin() + 1, start;
-   for (; end < (mTimeMap.end() - 1) && end->mDistance < d; end++) {  }
+   Vector<TimeMap>::iterator end = mTimeMap.begin() + findDistance(d), start;
    start = end - 1;
 
    // Check for duplicate points..
@@ -55,7 +55,7 @@ public:
    Knot* back()   { return (mFront == NULL) ? NULL : mFront->prev; }
 
    void push_back(Knot *w);
-   void push_front(Knot *w) { push_back(w); mFront = w; mIsMapDirty = true; }
+   void push_front(Knot *w) { push_back(w); mFront = w; mIsMapDirty = true; mIsIndexDirty = true; }
 
    Knot* getKnot(S32 i);
    Knot* next(Knot *k) { return (k->next == mFront) ? k : k->next; }
@@ -75,6 +75,11 @@ private:
    Knot *mFront;
    S32 mSize;
    bool mIsMapDirty;
+   bool mIsIndexDirty;
+
+   /// The knots in order, so value() doesn't walk the list for every
+   /// sample of the time map.
+   Vector<Knot*> mKnotIndex;
 
    struct TimeMap {
       F32 mTime;
@@ -83,6 +88,10 @@ private:
 
    Vector<TimeMap> mTimeMap;
    void buildTimeMap();
+
+   /// First entry of the time map at or past t (or distance d), never 0.
+   S32 findTime(F32 t);
+   S32 findDistance(F32 d);
 };
 
 
@@ -0,0 +1,198 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "game/dataBlockCache.h"
+#include "game/gameConnection.h"
+#include "console/console.h"
+#include "console/consoleTypes.h"
+#include "core/fileStream.h"
+#include "core/crc.h"
+
+Vector<DataBlockCache::Entry> DataBlockCache::smEntries;
+Vector<U8>    DataBlockCache::smData;
+S32           DataBlockCache::smBuckets[DataBlockCache::NumBuckets];
+bool          DataBlockCache::smLoaded = false;
+bool          DataBlockCache::smDirty = false;
+bool          DataBlockCache::smEnabled = true;
+const char   *DataBlockCache::smFileName = NULL;
+S32           DataBlockCache::smMaxEntries = 8192;
+
+static const U32 csCacheFileMagic = 0x43424444;    // "DDBC"
+
+//-----------------------------------------------------------------------------
+
+void DataBlockCache::consoleInit()
+{
+   smFileName = StringTable->insert("cache/dataBlocks.dbc");
+
+   Con::addVariable("$pref::Net::dataBlockCache",     TypeBool,   &smEnabled);
+   Con::addVariable("$pref::Net::dataBlockCacheFile", TypeString, &smFileName);
+   Con::addVariable("$pref::Net::dataBlockCacheSize", TypeS32,    &smMaxEntries);
+}
+
+U32 DataBlockCache::computeHash(const U8 *data, U32 bitCount)
+{
+   return calculateCRC(data, (bitCount + 7) >> 3);
+}
+
+//-----------------------------------------------------------------------------
+
+void DataBlockCache::addEntry(U32 hash, U32 classId, U32 bitCount, const U8 *data, bool used)
+{
+   U32 bytes = (bitCount + 7) >> 3;
+
+   smEntries.increment();
+   Entry &entry   = smEntries.last();
+   entry.hash     = hash;
+   entry.classId  = classId;
+   entry.bitCount = bitCount;
+   entry.offset   = smData.size();
+   entry.used     = used;
+
+   U32 bucket = hash & (NumBuckets - 1);
+   entry.next = smBuckets[bucket];
+   smBuckets[bucket] = smEntries.size() - 1;
+
+   smData.setSize(entry.offset + bytes);
+   dMemcpy(smData.address() + entry.offset, data, bytes);
+}
+
+S32 DataBlockCache::findEntry(U32 hash, U32 classId, U32 bitCount)
+{
+   for(S32 i = smBuckets[hash & (NumBuckets - 1)]; i != -1; i = smEntries[i].next)
+   {
+      const Entry &entry = smEntries[i];
+      if(entry.hash == hash && entry.classId == classId && entry.bitCount == bitCount)
+         return i;
+   }
+   return -1;
+}
+
+void DataBlockCache::load()
+{
+   smLoaded = true;
+   smEntries.clear();
+   smData.clear();
+   for(U32 i = 0; i < NumBuckets; i++)
+      smBuckets[i] = -1;
+
+   FileStream stream;
+   if(!stream.open(smFileName, FileStream::Read))
+      return;
+
+   // Bits from another protocol or class list won't unpack the same way.
+   U32 magic, version, protocol, classCRC, count;
+   if(!stream.read(&magic) || !stream.read(&version) || !stream.read(&protocol) ||
+      !stream.read(&classCRC) || !stream.read(&count) ||
+      magic != csCacheFileMagic || version != FileVersion ||
+      protocol != GameConnection::CurrentProtocolVersion ||
+      classCRC != AbstractClassRep::getClassCRC(NetClassGroupGame))
+   {
+      Con::printf("Discarding datablock cache %s.", smFileName);
+      return;
+   }
+
+   U8 buffer[MaxPacketDataSize];
+   for(U32 i = 0; i < count; i++)
+   {
+      U32 hash;
+      U16 classId, bitCount;
+      if(!stream.read(&hash) || !stream.read(&classId) || !stream.read(&bitCount))
+         break;
+
+      U32 bytes = (bitCount + 7) >> 3;
+      if(bytes > sizeof(buffer) || !stream.read(bytes, buffer))
+         break;
+
+      if(findEntry(hash, classId, bitCount) == -1)
+         addEntry(hash, classId, bitCount, buffer, false);
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+const U8 *DataBlockCache::find(U32 hash, U32 classId, U32 bitCount)
+{
+   if(!isEnabled())
+      return NULL;
+   if(!smLoaded)
+      load();
+
+   S32 index = findEntry(hash, classId, bitCount);
+   if(index == -1)
+      return NULL;
+
+   Entry &entry = smEntries[index];
+   entry.used = true;
+   return smData.address() + entry.offset;
+}
+
+void DataBlockCache::insert(U32 hash, U32 classId, U32 bitCount, const U8 *data)
+{
+   if(!isEnabled() || ((bitCount + 7) >> 3) > MaxPacketDataSize)
+      return;
+   if(!smLoaded)
+      load();
+
+   S32 index = findEntry(hash, classId, bitCount);
+   if(index != -1)
+   {
+      smEntries[index].used = true;
+      return;
+   }
+
+   addEntry(hash, classId, bitCount, data, true);
+   smDirty = true;
+}
+
+void DataBlockCache::flush()
+{
+   if(!smDirty || !isEnabled())
+      return;
+   smDirty = false;
+
+   Platform::createPath(smFileName);
+
+   FileStream stream;
+   if(!stream.open(smFileName, FileStream::Write))
+   {
+      Con::warnf("Unable to write the datablock cache %s.", smFileName);
+      return;
+   }
+
+   // When it's full, keep what this session used and drop the oldest of the
+   // rest; entries are in the order they were first added.
+   U32 maxEntries = getMax(smMaxEntries, 0);
+   U32 numUsed = 0;
+   for(U32 i = 0; i < smEntries.size(); i++)
+      if(smEntries[i].used)
+         numUsed++;
+   U32 numUnused = smEntries.size() - numUsed;
+   U32 skipUnused = 0;
+   if(smEntries.size() > maxEntries)
+      skipUnused = getMin(numUnused, smEntries.size() - maxEntries);
+   U32 count = smEntries.size() - skipUnused;
+
+   stream.write(csCacheFileMagic);
+   stream.write(U32(FileVersion));
+   stream.write(GameConnection::CurrentProtocolVersion);
+   stream.write(AbstractClassRep::getClassCRC(NetClassGroupGame));
+   stream.write(count);
+
+   for(U32 i = 0; i < smEntries.size(); i++)
+   {
+      const Entry &entry = smEntries[i];
+      if(!entry.used && skipUnused)
+      {
+         skipUnused--;
+         continue;
+      }
+      stream.write(entry.hash);
+      stream.write(U16(entry.classId));
+      stream.write(U16(entry.bitCount));
+      stream.write((entry.bitCount + 7) >> 3, smData.address() + entry.offset);
+   }
+   stream.close();
+}
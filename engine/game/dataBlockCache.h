@@ -0,0 +1,77 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _DATABLOCKCACHE_H_
+#define _DATABLOCKCACHE_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+
+/// Client side cache of the packed datablocks servers have sent.
+///
+/// Before the server sends its datablocks it sends a manifest with the
+/// class, size and content hash of each one (DataBlockManifestEvent).  The
+/// client answers with the ones it already has here
+/// (DataBlockCacheHitsEvent), and the server only sends the rest.  The
+/// cached datablocks are unpacked from their saved bits, in order, as if
+/// they had just arrived.
+///
+/// The cache is kept in $pref::Net::dataBlockCacheFile and holds up to
+/// $pref::Net::dataBlockCacheSize datablocks; the ones used this session
+/// are kept first when it's full.  It's thrown away whenever the protocol
+/// version or the network classes change, since the bits would no longer
+/// unpack the same way.
+class DataBlockCache
+{
+   struct Entry
+   {
+      U32  hash;
+      U32  classId;
+      U32  bitCount;
+      U32  offset;      ///< Into smData.
+      S32  next;        ///< Next entry in the same bucket, or -1.
+      bool used;        ///< Used or added this session.
+   };
+
+   enum Constants {
+      NumBuckets = 1024,
+      FileVersion = 1
+   };
+
+   static Vector<Entry> smEntries;
+   static Vector<U8>    smData;
+   static S32           smBuckets[NumBuckets];
+   static bool          smLoaded;
+   static bool          smDirty;
+
+   static void load();
+   static void addEntry(U32 hash, U32 classId, U32 bitCount, const U8 *data, bool used);
+   static S32  findEntry(U32 hash, U32 classId, U32 bitCount);
+
+  public:
+   static bool        smEnabled;      ///< $pref::Net::dataBlockCache
+   static const char *smFileName;     ///< $pref::Net::dataBlockCacheFile
+   static S32         smMaxEntries;   ///< $pref::Net::dataBlockCacheSize
+
+   static void consoleInit();
+
+   static bool isEnabled() { return smEnabled && smFileName && smFileName[0]; }
+
+   /// Hash of a packed datablock; the bits past bitCount must be zero.
+   static U32 computeHash(const U8 *data, U32 bitCount);
+
+   /// Returns the cached bits, or NULL if we don't have them.
+   static const U8 *find(U32 hash, U32 classId, U32 bitCount);
+   static void insert(U32 hash, U32 classId, U32 bitCount, const U8 *data);
+
+   /// Writes the cache out if anything was added.
+   static void flush();
+};
+
+#endif
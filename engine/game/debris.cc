@@ -509,7 +509,7 @@ bool Debris::onAdd()
 
    if( mDataBlock->shape )
    {
-      mShape = new TSShapeInstance( mDataBlock->shape, true);
+      mShape = mDataBlock->shapePool.alloc( mDataBlock->shape, true);
    }
 
    if( mPart )
@@ -562,6 +562,12 @@ bool Debris::onAdd()
 //----------------------------------------------------------------------------
 void Debris::onRemove()
 {
+   if( mShape )
+   {
+      mDataBlock->shapePool.free( mShape );
+      mShape = NULL;
+   }
+
    for( int i=0; i<DebrisData::DDC_NUM_EMITTERS; i++ )
    {
       if( mEmitterList[i] )
@@ -837,7 +843,7 @@ bool Debris::prepRenderImage(SceneState* state, const U32 stateKey,
          DetailManager::selectPotentialDetails(mPart,dist,invScale);
       }
 
-      SceneRenderImage* image = new SceneRenderImage;
+      SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
       image->obj = this;
       image->isTranslucent = true;
       image->sortType = SceneRenderImage::Point;
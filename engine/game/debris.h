@@ -9,6 +9,9 @@
 #ifndef _GAMEBASE_H_
 #include "game/gameBase.h"
 #endif
+#ifndef _TSSHAPEINSTANCEPOOL_H_
+#include "ts/tsShapeInstancePool.h"
+#endif
 
 class ParticleEmitterData;
 class ParticleEmitter;
@@ -60,6 +63,10 @@ struct DebrisData : public GameBaseData
    const char* shapeName;
    Resource<TSShape> shape;
 
+   /// Instances of shape left by debris that's gone.  Declared after the
+   /// shape so it's emptied first.
+   TSShapeInstancePool shapePool;
+
    StringTableEntry  textureName;
    TextureHandle     texture;
 
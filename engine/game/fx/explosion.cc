@@ -753,6 +753,13 @@ bool Explosion::onAdd()
 
 void Explosion::onRemove()
 {
+   if( mExplosionInstance )
+   {
+      mDataBlock->explosionShapePool.free( mExplosionInstance );
+      mExplosionInstance = NULL;
+      mExplosionThread   = NULL;
+   }
+
    for( int i=0; i<ExplosionData::EC_NUM_EMITTERS; i++ )
    {
       if( mEmitterList[i] )
@@ -806,7 +813,7 @@ bool Explosion::prepRenderImage(SceneState* state, const U32 stateKey,
          mFog = 0.0;
       }
 
-      SceneRenderImage* image = new SceneRenderImage;
+      SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
       image->obj              = this;
       image->isTranslucent    = true;
       image->sortType         = SceneRenderImage::Point;
@@ -936,6 +943,14 @@ void Explosion::registerLights(LightManager * lightManager, bool lightingScene)
 
 
 //--------------------------------------------------------------------------
+// Counting time is all a tick does, until the one that explodes (effects,
+// sounds, camera shake) or deletes the explosion.
+bool Explosion::isParallelTickSafe()
+{
+   U32 next = mCurrMS + TickMs;
+   return next < mEndingMS && (mActive || S32(next) <= mDelayMS);
+}
+
 void Explosion::processTick(const Move*)
 {
    mCurrMS += TickMs;
@@ -1078,9 +1093,14 @@ bool Explosion::explode()
 
    if (bool(mDataBlock->explosionShape) && mDataBlock->explosionAnimation != -1)
    {
-      mExplosionInstance = new TSShapeInstance(mDataBlock->explosionShape, true);
+      mExplosionInstance = mDataBlock->explosionShapePool.alloc(mDataBlock->explosionShape, true);
 
-      mExplosionThread   = mExplosionInstance->addThread();
+      // a reused instance still has its thread, and the last one's fade
+      mExplosionInstance->setAlphaAlways(1.0f);
+      if(mExplosionInstance->threadCount())
+         mExplosionThread = mExplosionInstance->getThread(0);
+      else
+         mExplosionThread = mExplosionInstance->addThread();
       mExplosionInstance->setSequence(mExplosionThread, mDataBlock->explosionAnimation, 0);
       mExplosionInstance->setTimeScale(mExplosionThread, mDataBlock->playSpeed);
 
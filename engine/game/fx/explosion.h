@@ -12,6 +12,9 @@
 #ifndef _TSSHAPE_H_
 #include "ts/tsShape.h"
 #endif
+#ifndef _TSSHAPEINSTANCEPOOL_H_
+#include "ts/tsShapeInstancePool.h"
+#endif
 
 class ParticleEmitter;
 class ParticleEmitterData;
@@ -52,6 +55,10 @@ class ExplosionData : public GameBaseData {
    Resource<TSShape> explosionShape;
    S32               explosionAnimation;
 
+   /// Instances of explosionShape left by finished explosions.  Declared
+   /// after the shape so it's emptied first.
+   TSShapeInstancePool explosionShapePool;
+
    ParticleEmitterData*    emitterList[EC_NUM_EMITTERS];
    S32                     emitterIDList[EC_NUM_EMITTERS];
 
@@ -143,6 +150,7 @@ class Explosion : public GameBase
    bool explode();
 
    void processTick(const Move *move);
+   bool isParallelTickSafe();
    void advanceTime(F32 dt);
    void updateEmitters( F32 dt );
    void launchDebris( Point3F &axis );
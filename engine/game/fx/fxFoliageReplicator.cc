@@ -20,6 +20,8 @@
 #include "sceneGraph/sceneGraph.h"
 #include "fxFoliageReplicator.h"
 #include "platform/profiler.h"
+#include "core/threadPool.h"
+#include "dgl/gTexManager.h"
 
 //------------------------------------------------------------------------------
 //
@@ -84,6 +86,103 @@ static F32						mCosTable[720];
 static F32						mSinTable[720];
 
 
+//------------------------------------------------------------------------------
+//
+// Vertex Program.
+//
+//------------------------------------------------------------------------------
+//
+// Builds each billboard corner from the item position and the camera axes,
+// sways the top corners, sets the luminance and fades by distance.  Phases
+// are in the trig table units (720 per turn), the sines come from a Taylor
+// series over [-pi, pi].
+//
+//	local[0]	Camera right.
+//	local[1]	Camera up.
+//	local[2]	Camera position.
+//	local[3]	Sway time, light phase offset, sway phase offset.
+//	local[4]	Sway magnitude side, front.
+//	local[5]	Luminance mid point, magnitude, ground alpha, fog alpha.
+//	local[6]	View closest, fade-out gradient, view distance, fade-in gradient.
+//
+static const char sFoliageProgram[] =
+	"!!ARBvp1.0\n"
+	"ATTRIB iPos = vertex.position;\n"
+	"ATTRIB iTex = vertex.texcoord[0];\n"
+	"ATTRIB iCorner = vertex.texcoord[1];\n"
+	"PARAM mvp[4] = { state.matrix.mvp };\n"
+	"PARAM right = program.local[0];\n"
+	"PARAM up = program.local[1];\n"
+	"PARAM eye = program.local[2];\n"
+	"PARAM times = program.local[3];\n"
+	"PARAM sway = program.local[4];\n"
+	"PARAM lum = program.local[5];\n"
+	"PARAM fade = program.local[6];\n"
+	"PARAM k = { 0.0013888889, 0.25, 6.2831853, 1.0 };\n"
+	"PARAM c = { -0.16666667, 0.0083333333, -0.00019841270, 0.0000027557319 };\n"
+	"PARAM h = { 0.5, 0.0, 0.0, 0.0 };\n"
+	"TEMP a, t, ang, ang2, s, d, p;\n"
+	// Sway and light phases, in turns.
+	"MAD a.x, iCorner.w, times.x, iCorner.z;\n"
+	"ADD a.x, a.x, times.z;\n"
+	"ADD a.y, iTex.w, times.y;\n"
+	"MUL a.xy, a, k.x;\n"
+	// sin(sway), cos(sway) and cos(light), wrapped to [-pi, pi).
+	"MOV t.x, a.x;\n"
+	"ADD t.y, a.x, k.y;\n"
+	"ADD t.z, a.y, k.y;\n"
+	"ADD t.xyz, t, h.x;\n"
+	"FRC t.xyz, t;\n"
+	"SUB t.xyz, t, h.x;\n"
+	"MUL ang.xyz, t, k.z;\n"
+	"MUL ang2.xyz, ang, ang;\n"
+	"MAD s.xyz, ang2, c.w, c.z;\n"
+	"MAD s.xyz, s, ang2, c.y;\n"
+	"MAD s.xyz, s, ang2, c.x;\n"
+	"MAD s.xyz, s, ang2, k.w;\n"
+	"MUL s.xyz, s, ang;\n"
+	// Corner offset, swaying the top only.
+	"MUL d.x, sway.x, s.y;\n"
+	"MUL d.y, sway.y, s.x;\n"
+	"MUL d.xy, d, iTex.z;\n"
+	"ADD d.x, d.x, iCorner.x;\n"
+	"MAD p.xyz, right, d.x, iPos;\n"
+	"MAD p.xyz, up, d.y, p;\n"
+	"ADD p.z, p.z, iCorner.y;\n"
+	"MOV p.w, k.w;\n"
+	"DP4 result.position.x, mvp[0], p;\n"
+	"DP4 result.position.y, mvp[1], p;\n"
+	"DP4 result.position.z, mvp[2], p;\n"
+	"DP4 result.position.w, mvp[3], p;\n"
+	// Fade out close up and in at the view distance, capped by the fog.
+	"SUB t.xyz, iPos, eye;\n"
+	"DP3 t.w, t, t;\n"
+	"RSQ t.w, t.w;\n"
+	"RCP t.w, t.w;\n"
+	"SUB a.z, fade.x, t.w;\n"
+	"MAD a.z, -a.z, fade.y, k.w;\n"
+	"SUB a.w, t.w, fade.z;\n"
+	"MAD a.w, -a.w, fade.w, k.w;\n"
+	"MIN a.z, a.z, a.w;\n"
+	"MIN a.z, a.z, lum.w;\n"
+	"MAX a.z, a.z, h.y;\n"
+	"MAX a.w, lum.z, iTex.z;\n"
+	"MIN result.color.w, a.z, a.w;\n"
+	"MAD result.color.xyz, lum.y, s.z, lum.x;\n"
+	"SWZ result.texcoord[0], iTex, x, y, 0, 1;\n"
+	"END\n";
+
+// Phases are rebased into the vertices before the time loses precision.
+#define FXFOLIAGE_REBASE_TIME	600.0f
+
+bool fxFoliageReplicator::smUseVertexProgram	= true;
+bool fxFoliageReplicator::smUseBufferObjects	= true;
+U32  fxFoliageReplicator::smBufferGeneration	= 1;
+U32  fxFoliageReplicator::smBufferCallbackKey	= (U32)-1;
+U32  fxFoliageReplicator::smProgram				= 0;
+U32  fxFoliageReplicator::smProgramGeneration	= 0;
+
+
 //------------------------------------------------------------------------------
 //
 // Class: fxFoliageRenderList
@@ -210,19 +309,25 @@ inline void fxFoliageRenderList::DrawQuadBox(const Box3F& QuadBox, const ColorF
 
 void fxFoliageRenderList::CompileVisibleSet(const fxFoliageQuadrantNode* pNode, const MatrixF& RenderTransform, const bool UseDebug)
 {
+	// Skip nodes without any billboards.
+	if (!pNode->CullBoxValid) return;
+
 	// Attempt to trivially reject the Node.
 	//
+	// NOTE:-	The cull box holds every billboard the node owns, so whole leaves
+	//			are accepted or rejected here and nothing is tested per item.
+	//
 	// Is any of the quadrant visible?
-	if (IsQuadrantVisible(pNode->QuadrantBox, RenderTransform))
+	if (IsQuadrantVisible(pNode->CullBox, RenderTransform))
 	{
 		// Draw the Quad Box (Debug Only).
-		if (UseDebug) DrawQuadBox(pNode->QuadrantBox, ColorF(0,.8,.1,.2));
+		if (UseDebug) DrawQuadBox(pNode->CullBox, ColorF(0,.8,.1,.2));
 
 		// Yes, so are we at sub-level 0?
 		if (pNode->Level == 0)
 		{
-			// Yes, so merge visible object set with node render list.
-			mVisObjectSet.merge(pNode->RenderList);
+			// Yes, so add the leaf to the visible set.
+			mVisLeaves.push_back(const_cast<fxFoliageQuadrantNode*>(pNode));
 		}
 		else
 		{
@@ -234,7 +339,7 @@ void fxFoliageRenderList::CompileVisibleSet(const fxFoliageQuadrantNode* pNode,
 	else
 	{
 		// Draw the Quad Box (Debug Only).
-		if (UseDebug) DrawQuadBox(pNode->QuadrantBox, ColorF(0,.1,8,.2));
+		if (UseDebug) DrawQuadBox(pNode->CullBox, ColorF(0,.1,8,.2));
 	}
 
 	return;
@@ -345,8 +450,11 @@ fxFoliageReplicator::fxFoliageReplicator()
 	// Reset Billboards Acquired.
 	mBillboardsAcquired = 0;
 
-	// Reset Frame Serial ID.
-	mFrameSerialID = 0;
+	// Reset Batches.
+	mVertexBuffer = 0;
+	mBufferGeneration = 0;
+	mBatchesDirty = false;
+	mAnimationTime = 0.0f;
 }
 
 //------------------------------------------------------------------------------
@@ -437,17 +545,29 @@ void fxFoliageReplicator::initPersistFields()
 
 //------------------------------------------------------------------------------
 
+void fxFoliageReplicator::consoleInit()
+{
+	Con::addVariable("$pref::Foliage::vertexProgram",		TypeBool, &smUseVertexProgram);
+	Con::addVariable("$pref::Foliage::vertexBufferObjects",	TypeBool, &smUseBufferObjects);
+
+	smBufferCallbackKey = TextureManager::registerEventCallback(BufferTextureEvent, NULL);
+}
+
+//------------------------------------------------------------------------------
+
+void fxFoliageReplicator::BufferTextureEvent(const U32 eventCode, void*)
+{
+	// The buffers and the program die with the context, so forget them and
+	// let each replicator upload its batches again when it's next drawn.
+	if (eventCode == TextureManager::BeginZombification)
+		smBufferGeneration++;
+}
+
+//------------------------------------------------------------------------------
+
 void fxFoliageReplicator::CreateFoliage(void)
 {
-	F32				HypX, HypY;
-	F32				Angle;
-	U32				RelocationRetry;
 	Point3F			FoliagePosition;
-	Point3F			FoliageStart;
-	Point3F			FoliageEnd;
-	Point3F			FoliageScale;
-	bool			CollisionResult;
-	RayInfo			RayEvent;
 
 	// Let's get a minimum bounding volume.
 	Point3F	MinPoint( -0.5, -0.5, -0.5 );
@@ -571,6 +691,12 @@ void fxFoliageReplicator::CreateFoliage(void)
 	//			a complete subset of billboards enclosed by the visible box.
 	//
 	//
+	//	5.		Each billboard is then given to exactly one leaf and the leaves are packed, in tree order,
+	//			into a static vertex batch (a buffer object when available).  The leaves grow a cull box
+	//			around the billboards they own so a visible leaf is drawn as a single range of the batch
+	//			with the swaying and fading done by a vertex program.  Without one, the visible leaves
+	//			are expanded on the CPU into a single vertex array each frame.
+	//
 	//	Using the above algorithm we can now generate *massive* quantities of billboards and (using the
 	//	appropriate 'mCullResolution') only visible blocks of billboards will be processed.
 	//
@@ -632,95 +758,23 @@ void fxFoliageReplicator::CreateFoliage(void)
 		mTrigTableInitialised = true;
 	}
 
+	// Find the Foliage a home.
+	Vector<Point3F> FoliagePositions;
+	PlaceFoliage(FoliagePositions);
+
 	// Add Foliage.
-	for (U32 idx = 0; idx < mFieldData.mFoliageCount; idx++)
+	for (U32 idx = 0; idx < FoliagePositions.size(); idx++)
 	{
 		fxFoliageItem*	pFoliageItem;
 
-		// Reset Relocation Retry.
-		RelocationRetry = mFieldData.mFoliageRetries;
-
-		// Find it a home ...
-		do
-		{
-
-			// Calculate a random offset
-			HypX	= RandomGen.randF(mFieldData.mInnerRadiusX, mFieldData.mOuterRadiusX);
-			HypY	= RandomGen.randF(mFieldData.mInnerRadiusY, mFieldData.mOuterRadiusY);
-			Angle	= RandomGen.randF(0, M_2PI);
-
-			// Calculate the new position.
-			Point3F randomShapePosLocal;
-			randomShapePosLocal.x = HypX * mCos(Angle);
-			randomShapePosLocal.y = HypY * mSin(Angle);
-
-			// Transform into world space coordinates
-			Point3F shapePosWorld;
-			MatrixF objToWorld = getRenderTransform();
-			objToWorld.mulP(randomShapePosLocal, &shapePosWorld);
-			FoliagePosition = shapePosWorld;
-
-			// Initialise RayCast Search Start/End Positions.
-			FoliageStart = FoliageEnd = FoliagePosition;
-			FoliageStart.z = 2000.f;
-			FoliageEnd.z= -2000.f;
-
-			// Perform Ray Cast Collision on Client.
-			CollisionResult = gClientContainer.castRay(	FoliageStart, FoliageEnd, FXFOLIAGEREPLICATOR_COLLISION_MASK, &RayEvent);
-
-			// Did we hit anything?
-			if (CollisionResult)
-			{
-				// For now, let's pretend we didn't get a collision.
-				CollisionResult = false;
-
-				// Yes, so get it's type.
-				U32 CollisionType = RayEvent.object->getTypeMask();
-
-				// Check Illegal Placements, fail if we hit a disallowed type.
-				if (((CollisionType & TerrainObjectType) && !mFieldData.mAllowOnTerrain)	||
-					((CollisionType & InteriorObjectType) && !mFieldData.mAllowOnInteriors)	||
-					((CollisionType & StaticTSObjectType) && !mFieldData.mAllowStatics)	||
-					((CollisionType & WaterObjectType) && !mFieldData.mAllowOnWater) ) continue;
-
-				// If we collided with water and are not allowing on the water surface then let's find the
-				// terrain underneath and pass this on as the original collision else fail.
-				if ((CollisionType & WaterObjectType) && !mFieldData.mAllowWaterSurface &&
-					!gClientContainer.castRay( FoliageStart, FoliageEnd, FXFOLIAGEREPLICATOR_NOWATER_COLLISION_MASK, &RayEvent)) continue;
-
-				// We passed with flying colour so carry on.
-				CollisionResult = true;
-			}
-
-			// Invalidate if we are below Allowed Terrain Angle.
-			if (RayEvent.normal.z < mSin(mDegToRad(90.0f-mFieldData.mAllowedTerrainSlope))) CollisionResult = false;
-
-		// Wait until we get a collision.
-		} while(!CollisionResult && --RelocationRetry);
-
-		// Check for Relocation Problem.
-		if (RelocationRetry > 0)
-		{
-			// Adjust Impact point.
-			RayEvent.point.z += mFieldData.mOffsetZ;
-
-			// Set New Position.
-			FoliagePosition = RayEvent.point;
-		}
-		else
-		{
-			// Warning.
-			Con::warnf(ConsoleLogEntry::General, "fxFoliageReplicator - Could not find satisfactory position for Foliage!");
-
-			// Skip to next.
-			continue;
-		}
+		// Fetch the Position.
+		FoliagePosition = FoliagePositions[idx];
 
 		// Create our Foliage Item.
 		pFoliageItem = new fxFoliageItem;
 
-		// Reset Frame Serial.
-		pFoliageItem->LastFrameSerialID = 0;
+		// Not in a batch yet.
+		pFoliageItem->Owner = NULL;
 
 		// Reset Transform.
 		pFoliageItem->Transform.identity();
@@ -913,6 +967,9 @@ void fxFoliageReplicator::CreateFoliage(void)
 	// Let's start this thing going by recursing it's children.
 	ProcessNodeChildren(pNewNode, &CullList);
 
+	// Pack the leaves into the static batches.
+	BuildBatches();
+
 	// Calculate Elapsed Time and take new Timestamp.
 	F32 ElapsedTime = (Platform::getRealMilliseconds() - mStartCreationTime) * 0.001f;
 
@@ -928,6 +985,7 @@ void fxFoliageReplicator::CreateFoliage(void)
 	F32 MemoryAllocated = (mNextAllocatedNodeIdx-1) * sizeof(fxFoliageQuadrantNode);
 	MemoryAllocated		+=	mCurrentFoliageCount * sizeof(fxFoliageItem);
 	MemoryAllocated		+=	mCurrentFoliageCount * sizeof(fxFoliageItem*);
+	MemoryAllocated		+=	mBatchVerts.size() * sizeof(fxFoliageVertex);
 	Con::printf("fxFoliageReplicator - Approx. %0.2fMb allocated.", MemoryAllocated / 1048576.0f);
 
 	// ----------------------------------------------------------------------------------------------------------------------
@@ -938,6 +996,123 @@ void fxFoliageReplicator::CreateFoliage(void)
 
 //------------------------------------------------------------------------------
 
+void fxFoliageReplicator::PlaceFoliage(Vector<Point3F>& Positions)
+{
+	// NOTE:-	The placement rays are cast in rounds.  Each round picks a new random spot
+	//			for every billboard still looking for a home and casts them all through the
+	//			container as one batch.  The container can't be used from other threads so
+	//			this stays on the main thread; the retry limit is per billboard as before.
+	const MatrixF	objToWorld	= getRenderTransform();
+	const F32		MinNormalZ	= mSin(mDegToRad(90.0f-mFieldData.mAllowedTerrainSlope));
+	const U32		Rounds		= getMax(mFieldData.mFoliageRetries, (U32)1);
+
+	Vector<U32>			Pending;
+	Vector<U8>			Placed;
+	Vector<RayQuery>	Rays;
+	Vector<RayInfo>		Hits;
+	Vector<U32>			WaterHits;
+	Vector<RayQuery>	WaterRays;
+	Vector<RayInfo>		WaterInfo;
+
+	Positions.setSize(mFieldData.mFoliageCount);
+	Placed.setSize(mFieldData.mFoliageCount);
+	Pending.setSize(mFieldData.mFoliageCount);
+	for (U32 idx = 0; idx < mFieldData.mFoliageCount; idx++)
+	{
+		Placed[idx] = false;
+		Pending[idx] = idx;
+	}
+
+	for (U32 Round = 0; Round < Rounds && Pending.size(); Round++)
+	{
+		Rays.setSize(Pending.size());
+		Hits.setSize(Pending.size());
+
+		for (U32 i = 0; i < Pending.size(); i++)
+		{
+			// Calculate a random offset
+			F32 HypX	= RandomGen.randF(mFieldData.mInnerRadiusX, mFieldData.mOuterRadiusX);
+			F32 HypY	= RandomGen.randF(mFieldData.mInnerRadiusY, mFieldData.mOuterRadiusY);
+			F32 Angle	= RandomGen.randF(0, M_2PI);
+
+			// Transform into world space coordinates
+			Point3F shapePosWorld;
+			objToWorld.mulP(Point3F(HypX * mCos(Angle), HypY * mSin(Angle), 0), &shapePosWorld);
+
+			// Initialise RayCast Search Start/End Positions.
+			Rays[i].start = Rays[i].end = shapePosWorld;
+			Rays[i].start.z = 2000.f;
+			Rays[i].end.z = -2000.f;
+		}
+
+		// Perform Ray Cast Collisions on Client.
+		gClientContainer.castRays(Rays.address(), Rays.size(), FXFOLIAGEREPLICATOR_COLLISION_MASK, Hits.address());
+
+		// Check Illegal Placements, fail if we hit a disallowed type.
+		WaterHits.clear();
+		for (U32 i = 0; i < Pending.size(); i++)
+		{
+			if (!Hits[i].object) continue;
+
+			U32 CollisionType = Hits[i].object->getTypeMask();
+			if (((CollisionType & TerrainObjectType) && !mFieldData.mAllowOnTerrain)	||
+				((CollisionType & InteriorObjectType) && !mFieldData.mAllowOnInteriors)	||
+				((CollisionType & StaticTSObjectType) && !mFieldData.mAllowStatics)	||
+				((CollisionType & WaterObjectType) && !mFieldData.mAllowOnWater) )
+			{
+				Hits[i].object = NULL;
+				continue;
+			}
+
+			// If we collided with water and are not allowing on the water surface then we
+			// need whatever is underneath instead.
+			if ((CollisionType & WaterObjectType) && !mFieldData.mAllowWaterSurface)
+				WaterHits.push_back(i);
+		}
+
+		// Find what's under the water, all in one go as well.
+		if (WaterHits.size())
+		{
+			WaterRays.setSize(WaterHits.size());
+			WaterInfo.setSize(WaterHits.size());
+			for (U32 i = 0; i < WaterHits.size(); i++)
+				WaterRays[i] = Rays[WaterHits[i]];
+
+			gClientContainer.castRays(WaterRays.address(), WaterRays.size(), FXFOLIAGEREPLICATOR_NOWATER_COLLISION_MASK, WaterInfo.address());
+
+			for (U32 i = 0; i < WaterHits.size(); i++)
+				Hits[WaterHits[i]] = WaterInfo[i];
+		}
+
+		// Keep anything within the Allowed Terrain Angle, the rest try again next round.
+		U32 Remaining = 0;
+		for (U32 i = 0; i < Pending.size(); i++)
+		{
+			if (Hits[i].object && Hits[i].normal.z >= MinNormalZ)
+			{
+				// Adjust Impact point.
+				Positions[Pending[i]] = Hits[i].point + Point3F(0, 0, mFieldData.mOffsetZ);
+				Placed[Pending[i]] = true;
+			}
+			else
+				Pending[Remaining++] = Pending[i];
+		}
+		Pending.setSize(Remaining);
+	}
+
+	// Check for Relocation Problem.
+	if (Pending.size())
+		Con::warnf(ConsoleLogEntry::General, "fxFoliageReplicator - Could not find satisfactory position for %d Foliage!", Pending.size());
+
+	// Drop the homeless, keeping the rest in order.
+	U32 Count = 0;
+	for (U32 idx = 0; idx < mFieldData.mFoliageCount; idx++)
+		if (Placed[idx]) Positions[Count++] = Positions[idx];
+	Positions.setSize(Count);
+}
+
+//------------------------------------------------------------------------------
+
 Box3F fxFoliageReplicator::FetchQuadrant(Box3F Box, U32 Quadrant)
 {
 	Box3F QuadrantBox;
@@ -1041,6 +1216,227 @@ void fxFoliageReplicator::ProcessQuadrant(fxFoliageQuadrantNode* pParentNode, fx
 
 //------------------------------------------------------------------------------
 
+void fxFoliageReplicator::CollectLeaves(fxFoliageQuadrantNode* pNode)
+{
+	// Tree order keeps neighbouring leaves next to each other in the batches.
+	if (pNode->Level == 0)
+	{
+		mFoliageLeaves.push_back(pNode);
+		return;
+	}
+
+	for (U32 q = 0; q < 4; q++)
+		if (pNode->QuadrantChildNode[q]) CollectLeaves(pNode->QuadrantChildNode[q]);
+}
+
+//------------------------------------------------------------------------------
+
+bool fxFoliageReplicator::UpdateCullBox(fxFoliageQuadrantNode* pNode)
+{
+	pNode->CullBoxValid = false;
+
+	// Are we at sub-level 0?
+	if (pNode->Level == 0)
+	{
+		// Yes, so bound the billboards we own.
+		//
+		// NOTE:-	The billboards turn to face the camera so allow for the width
+		//			in every direction, plus whatever the swaying can add.
+		const F32 Sway = mFieldData.mSwayOn ? mFabs(mFieldData.mSwayMagnitudeSide) + mFabs(mFieldData.mSwayMagnitudeFront) : 0.0f;
+
+		for (U32 i = 0; i < pNode->RenderList.size(); i++)
+		{
+			const fxFoliageItem* pFoliageItem = pNode->RenderList[i];
+			const Point3F Position = pFoliageItem->Transform.getPosition();
+			const F32 Radius = pFoliageItem->Width / 2.0f + Sway;
+
+			const Point3F ItemMin = Position - Point3F(Radius, Radius, Radius);
+			const Point3F ItemMax = Position + Point3F(Radius, Radius, pFoliageItem->Height + Radius);
+
+			if (pNode->CullBoxValid)
+			{
+				pNode->CullBox.min.setMin(ItemMin);
+				pNode->CullBox.max.setMax(ItemMax);
+			}
+			else
+			{
+				pNode->CullBox.min = ItemMin;
+				pNode->CullBox.max = ItemMax;
+				pNode->CullBoxValid = true;
+			}
+		}
+	}
+	else
+	{
+		// No, so bound the children.
+		for (U32 q = 0; q < 4; q++)
+		{
+			fxFoliageQuadrantNode* pChild = pNode->QuadrantChildNode[q];
+			if (!pChild || !UpdateCullBox(pChild)) continue;
+
+			if (pNode->CullBoxValid)
+			{
+				pNode->CullBox.min.setMin(pChild->CullBox.min);
+				pNode->CullBox.max.setMax(pChild->CullBox.max);
+			}
+			else
+			{
+				pNode->CullBox = pChild->CullBox;
+				pNode->CullBoxValid = true;
+			}
+		}
+	}
+
+	return pNode->CullBoxValid;
+}
+
+//------------------------------------------------------------------------------
+
+void fxFoliageReplicator::BuildBatches(void)
+{
+	PROFILE_START(FoliageRep_BuildBatches);
+
+	// Fetch the leaves.
+	mFoliageLeaves.clear();
+	CollectLeaves(mFoliageQuadTree[0]);
+
+	// Give every billboard to a single leaf.
+	//
+	// NOTE:-	A billboard overlapping a quadrant boundary is listed by every leaf it
+	//			touches.  It goes to the leaf holding its position (or else the first
+	//			leaf listing it) and that leaf's cull box grows to cover it, so it's
+	//			only ever drawn once and still shows when just the neighbour is visible.
+	for (U32 Pass = 0; Pass < 2; Pass++)
+	{
+		for (U32 l = 0; l < mFoliageLeaves.size(); l++)
+		{
+			fxFoliageQuadrantNode* pLeaf = mFoliageLeaves[l];
+			const Box3F& QuadBox = pLeaf->QuadrantBox;
+
+			for (U32 i = 0; i < pLeaf->RenderList.size(); i++)
+			{
+				fxFoliageItem* pFoliageItem = pLeaf->RenderList[i];
+				if (pFoliageItem->Owner) continue;
+
+				const Point3F Position = pFoliageItem->Transform.getPosition();
+				if (Pass == 1 ||
+					(Position.x >= QuadBox.min.x && Position.x <= QuadBox.max.x &&
+					 Position.y >= QuadBox.min.y && Position.y <= QuadBox.max.y))
+					pFoliageItem->Owner = pLeaf;
+			}
+		}
+	}
+
+	// Keep just the owned billboards and lay the leaves out in the batches.
+	U32 Billboards = 0;
+	for (U32 l = 0; l < mFoliageLeaves.size(); l++)
+	{
+		fxFoliageQuadrantNode* pLeaf = mFoliageLeaves[l];
+
+		U32 Count = 0;
+		for (U32 i = 0; i < pLeaf->RenderList.size(); i++)
+			if (pLeaf->RenderList[i]->Owner == pLeaf) pLeaf->RenderList[Count++] = pLeaf->RenderList[i];
+		pLeaf->RenderList.setSize(Count);
+
+		pLeaf->BatchStart = Billboards;
+		Billboards += Count;
+	}
+
+	// Bound the Quad-tree.
+	UpdateCullBox(mFoliageQuadTree[0]);
+
+	// Fill the Batches.
+	mBatchVerts.setSize(Billboards * 4);
+	FillBatches();
+
+	PROFILE_END();
+}
+
+//------------------------------------------------------------------------------
+
+void fxFoliageReplicator::FillLeafBatches(U32 start, U32 end, void* userData)
+{
+	fxFoliageReplicator* pReplicator = static_cast<fxFoliageReplicator*>(userData);
+	const tagFieldData& FieldData = pReplicator->mFieldData;
+
+	// Synchronised animation comes from the program parameters alone.
+	const bool SwayAsync	= FieldData.mSwayOn && !FieldData.mSwaySync;
+	const bool LightAsync	= FieldData.mLightOn && !FieldData.mLightSync;
+
+	for (U32 l = start; l < end; l++)
+	{
+		const fxFoliageQuadrantNode* pLeaf = pReplicator->mFoliageLeaves[l];
+		fxFoliageVertex* pVert = &pReplicator->mBatchVerts[pLeaf->BatchStart * 4];
+
+		for (U32 i = 0; i < pLeaf->RenderList.size(); i++, pVert += 4)
+		{
+			const fxFoliageItem* pFoliageItem = pLeaf->RenderList[i];
+
+			// Fetch Width/Height.
+			const F32 Width		= pFoliageItem->Width / 2.0f;
+			const F32 Height	= pFoliageItem->Height;
+
+			// Fetch Flipped Flag.
+			const F32 LeftTexPos	= pFoliageItem->Flipped ? 1.0f : 0.0f;
+			const F32 RightTexPos	= 1.0f - LeftTexPos;
+
+			// Fetch the Phases.
+			const F32 SwayPhase		= SwayAsync ? pFoliageItem->SwayPhase : 0.0f;
+			const F32 SwayRate		= SwayAsync ? pFoliageItem->SwayTimeRatio : 0.0f;
+			const F32 LightPhase	= LightAsync ? pFoliageItem->LightPhase : 0.0f;
+
+			// Top left, top right, bottom right and bottom left.
+			pVert[0].TexCoord.set(LeftTexPos,  0, 1, LightPhase);
+			pVert[0].Corner.set(-Width, Height, SwayPhase, SwayRate);
+			pVert[1].TexCoord.set(RightTexPos, 0, 1, LightPhase);
+			pVert[1].Corner.set(+Width, Height, SwayPhase, SwayRate);
+			pVert[2].TexCoord.set(RightTexPos, 1, 0, LightPhase);
+			pVert[2].Corner.set(+Width, 0, SwayPhase, SwayRate);
+			pVert[3].TexCoord.set(LeftTexPos,  1, 0, LightPhase);
+			pVert[3].Corner.set(-Width, 0, SwayPhase, SwayRate);
+
+			for (U32 v = 0; v < 4; v++)
+				pVert[v].Position = pFoliageItem->Transform.getPosition();
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+
+void fxFoliageReplicator::FillBatches(void)
+{
+	// The leaves don't share any vertices so they can be filled in parallel.
+	gThreadPool->parallelFor(mFoliageLeaves.size(), FillLeafBatches, this, 8);
+
+	// Upload them again when they're next drawn.
+	mBatchesDirty = true;
+}
+
+//------------------------------------------------------------------------------
+
+void fxFoliageReplicator::RebaseAnimation(void)
+{
+	// Fold the elapsed time into the phases before it loses precision.
+	for (U32 idx = 0; idx < mCurrentFoliageCount; idx++)
+	{
+		fxFoliageItem* pFoliageItem = mReplicatedFoliage[idx];
+
+		if (mFieldData.mSwayOn && !mFieldData.mSwaySync)
+			pFoliageItem->SwayPhase = mFmod(pFoliageItem->SwayPhase + pFoliageItem->SwayTimeRatio * mAnimationTime, 720.0f);
+
+		if (mFieldData.mLightOn && !mFieldData.mLightSync)
+			pFoliageItem->LightPhase = mFmod(pFoliageItem->LightPhase + pFoliageItem->LightTimeRatio * mAnimationTime, 720.0f);
+	}
+
+	// Restart the clock.
+	mAnimationTime = 0.0f;
+
+	// Store the new phases in the batches.
+	FillBatches();
+}
+
+//------------------------------------------------------------------------------
+
 void fxFoliageReplicator::SyncFoliageReplicators(void)
 {
 	// Check Host.
@@ -1119,7 +1515,20 @@ void fxFoliageReplicator::DestroyFoliage(void)
 	mReplicatedFoliage.clear();
 
 	// Clear the Frustum Render Set Vector.
-	mFrustumRenderSet.mVisObjectSet.clear();
+	mFrustumRenderSet.mVisLeaves.clear();
+
+	// Release the Batches.
+	if (mBufferGeneration == smBufferGeneration && mVertexBuffer)
+	{
+		GLuint Buffer = mVertexBuffer;
+		glDeleteBuffersARB(1, &Buffer);
+	}
+	mVertexBuffer = 0;
+	mBufferGeneration = 0;
+	mBatchesDirty = false;
+	mFoliageLeaves.clear();
+	mBatchVerts.clear();
+	mAnimationTime = 0.0f;
 
 
 	// Reset Foliage Count.
@@ -1263,7 +1672,7 @@ bool fxFoliageReplicator::prepRenderImage(SceneState* state, const U32 stateKey,
    if (state->isObjectRendered(this))
    {	
 		// Yes, so get a SceneRenderImage.
-		SceneRenderImage* image = new SceneRenderImage;
+		SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
 		// Populate it.
 		image->obj = this;
 		image->sortType = SceneRenderImage::Point;
@@ -1278,6 +1687,387 @@ bool fxFoliageReplicator::prepRenderImage(SceneState* state, const U32 stateKey,
 
 //------------------------------------------------------------------------------
 
+bool fxFoliageReplicator::BindProgram(void)
+{
+	// Can we sway on the card?
+	if (!smUseVertexProgram || !dglDoesSupportVertexProgram() || !dglDoesSupportARBMultitexture()) return false;
+
+	// Load the program into this context.
+	if (smProgramGeneration != smBufferGeneration)
+	{
+		// Anything from an older generation went with its context.
+		smProgramGeneration = smBufferGeneration;
+
+		GLuint Program;
+		glGenProgramsARB(1, &Program);
+		glBindProgramARB(GL_VERTEX_PROGRAM_ARB, Program);
+		glProgramStringARB(GL_VERTEX_PROGRAM_ARB, GL_PROGRAM_FORMAT_ASCII_ARB, dStrlen(sFoliageProgram), sFoliageProgram);
+
+		// Fall back to the CPU until the next context if the driver won't have it.
+		GLint ErrorPosition = -1;
+		glGetIntegerv(GL_PROGRAM_ERROR_POSITION_ARB, &ErrorPosition);
+		if (ErrorPosition != -1)
+		{
+			Con::errorf("fxFoliageReplicator - Vertex program failed at %d: %s", ErrorPosition, (const char*)glGetString(GL_PROGRAM_ERROR_STRING_ARB));
+			glBindProgramARB(GL_VERTEX_PROGRAM_ARB, 0);
+			glDeleteProgramsARB(1, &Program);
+			Program = 0;
+		}
+		smProgram = Program;
+	}
+	else if (smProgram)
+	{
+		glBindProgramARB(GL_VERTEX_PROGRAM_ARB, smProgram);
+	}
+
+	return smProgram != 0;
+}
+
+//------------------------------------------------------------------------------
+
+bool fxFoliageReplicator::BindBatchBuffer(void)
+{
+	// Are we using Buffer Objects?
+	if (!smUseBufferObjects || !dglDoesSupportVertexBufferObject() || mBatchVerts.empty()) return false;
+
+	if (mBufferGeneration != smBufferGeneration)
+	{
+		// Anything from an older generation went with its context.
+		GLuint Buffer;
+		glGenBuffersARB(1, &Buffer);
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB, Buffer);
+		glBufferDataARB(GL_ARRAY_BUFFER_ARB, mBatchVerts.size() * sizeof(fxFoliageVertex), mBatchVerts.address(), GL_STATIC_DRAW_ARB);
+
+		mVertexBuffer = Buffer;
+		mBufferGeneration = smBufferGeneration;
+		mBatchesDirty = false;
+	}
+	else
+	{
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB, mVertexBuffer);
+
+		// Have the phases been rebased?
+		if (mBatchesDirty)
+		{
+			glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, 0, mBatchVerts.size() * sizeof(fxFoliageVertex), mBatchVerts.address());
+			mBatchesDirty = false;
+		}
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------
+
+static void GetBoxDistances(const Box3F& Box, const Point3F& Point, F32& Nearest, F32& Farthest)
+{
+	Point3F Near, Far;
+	for (U32 i = 0; i < 3; i++)
+	{
+		F32 ToMin = Point[i] - Box.min[i];
+		F32 ToMax = Box.max[i] - Point[i];
+		Near[i] = ToMin < 0 ? ToMin : (ToMax < 0 ? ToMax : 0);
+		Far[i]	= getMax(mFabs(ToMin), mFabs(ToMax));
+	}
+	Nearest = Near.len();
+	Farthest = Far.len();
+}
+
+//------------------------------------------------------------------------------
+
+void fxFoliageReplicator::RenderBatchesProgram(SceneState* state)
+{
+	// Calculate some constants.
+	const F32	MinimumViewDistance		= mFieldData.mViewClosest - mFieldData.mFadeOutRegion;
+	const F32	MaximumViewDistance		= mFieldData.mViewDistance + mFieldData.mFadeInRegion;
+	const F32	LuminanceMidPoint		= (mFieldData.mMinLuminance + mFieldData.mMaxLuminance) / 2.0f;
+	const F32	LuminanceMagnitude		= mFieldData.mMaxLuminance - LuminanceMidPoint;
+	const Point3F&	CameraPosition		= state->getCameraPosition();
+
+	// Fetch the Camera axes for the billboarding.
+	MatrixF ModelView;
+	Point3F Right, Up;
+	dglGetModelview(&ModelView);
+	ModelView.inverse();
+	ModelView.getColumn(0, &Right);
+	ModelView.getColumn(1, &Up);
+
+	// Light and Sway phase offsets.
+	F32 LightOffset = 0.0f;
+	if (mFieldData.mLightOn)
+		LightOffset = mFieldData.mLightSync ? mGlobalLightPhase : (719.0f / mFieldData.mLightTime) * mAnimationTime;
+	const F32 SwayOffset = (mFieldData.mSwayOn && mFieldData.mSwaySync) ? mGlobalSwayPhase : 0.0f;
+
+	// Setup the Program.
+	glEnable(GL_VERTEX_PROGRAM_ARB);
+	glProgramLocalParameter4fARB(GL_VERTEX_PROGRAM_ARB, 0, Right.x, Right.y, Right.z, 0);
+	glProgramLocalParameter4fARB(GL_VERTEX_PROGRAM_ARB, 1, Up.x, Up.y, Up.z, 0);
+	glProgramLocalParameter4fARB(GL_VERTEX_PROGRAM_ARB, 2, CameraPosition.x, CameraPosition.y, CameraPosition.z, 1);
+	glProgramLocalParameter4fARB(GL_VERTEX_PROGRAM_ARB, 3, mAnimationTime, LightOffset, SwayOffset, 0);
+	if (mFieldData.mSwayOn)
+		glProgramLocalParameter4fARB(GL_VERTEX_PROGRAM_ARB, 4, mFieldData.mSwayMagnitudeSide, mFieldData.mSwayMagnitudeFront, 0, 0);
+	else
+		glProgramLocalParameter4fARB(GL_VERTEX_PROGRAM_ARB, 4, 0, 0, 0, 0);
+	glProgramLocalParameter4fARB(GL_VERTEX_PROGRAM_ARB, 6, mFieldData.mViewClosest, mFadeOutGradient, mFieldData.mViewDistance, mFadeInGradient);
+
+	// Setup the Batches.
+	const U8* pBase = BindBatchBuffer() ? NULL : (const U8*)mBatchVerts.address();
+	const GLsizei Stride = sizeof(fxFoliageVertex);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, Stride, pBase + Offset(Position, fxFoliageVertex));
+	glClientActiveTextureARB(GL_TEXTURE1_ARB);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glTexCoordPointer(4, GL_FLOAT, Stride, pBase + Offset(Corner, fxFoliageVertex));
+	glClientActiveTextureARB(GL_TEXTURE0_ARB);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glTexCoordPointer(4, GL_FLOAT, Stride, pBase + Offset(TexCoord, fxFoliageVertex));
+
+	// Draw runs of neighbouring leaves, which only break for the fog.
+	Vector<fxFoliageQuadrantNode*>& Leaves = mFrustumRenderSet.mVisLeaves;
+	U32 RunStart = 0;
+	U32 RunCount = 0;
+	F32 RunFog = 0.0f;
+
+	for (U32 l = 0; l <= Leaves.size(); l++)
+	{
+		F32 FogAlpha = 0.0f;
+		fxFoliageQuadrantNode* pLeaf = NULL;
+
+		if (l < Leaves.size())
+		{
+			pLeaf = Leaves[l];
+			if (pLeaf->RenderList.empty()) continue;
+
+			// Trivially reject the leaf if it's beyond the SceneGraphs visible distance or out of range.
+			F32 Nearest, Farthest;
+			GetBoxDistances(pLeaf->CullBox, CameraPosition, Nearest, Farthest);
+			if (Nearest > state->getVisibleDistance() || Nearest > MaximumViewDistance || Farthest < MinimumViewDistance) continue;
+
+			// Calculate Fog Alpha, at the nearest point so the fog never hides a visible billboard.
+			Point3F Center;
+			pLeaf->CullBox.getCenter(&Center);
+			FogAlpha = 1.0f - state->getHazeAndFog(Nearest, Center.z - CameraPosition.z);
+
+			// Trivially reject the leaf if it's totally transparent.
+			if (FogAlpha < FXFOLIAGE_ALPHA_EPSILON) continue;
+
+			// Can we add it to the run?
+			if (RunCount && pLeaf->BatchStart == RunStart + RunCount && FogAlpha == RunFog)
+			{
+				RunCount += pLeaf->RenderList.size();
+				continue;
+			}
+		}
+
+		// Draw the Run.
+		if (RunCount)
+		{
+			glProgramLocalParameter4fARB(GL_VERTEX_PROGRAM_ARB, 5,
+				mFieldData.mLightOn ? LuminanceMidPoint : 1.0f,
+				mFieldData.mLightOn ? LuminanceMagnitude : 0.0f,
+				mFieldData.mGroundAlpha, RunFog);
+			glDrawArrays(GL_QUADS, RunStart * 4, RunCount * 4);
+		}
+
+		// Start a new one.
+		if (pLeaf)
+		{
+			RunStart	= pLeaf->BatchStart;
+			RunCount	= pLeaf->RenderList.size();
+			RunFog		= FogAlpha;
+		}
+	}
+
+	// Restore rendering state.
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glClientActiveTextureARB(GL_TEXTURE1_ARB);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glClientActiveTextureARB(GL_TEXTURE0_ARB);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	if (!pBase && !mBatchVerts.empty()) glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+	glDisable(GL_VERTEX_PROGRAM_ARB);
+}
+
+//------------------------------------------------------------------------------
+
+// A billboard corner expanded on the CPU.
+struct fxFoliageDrawVertex
+{
+	Point3F		Position;
+	Point2F		TexCoord;
+	U8			Colour[4];
+};
+
+static Vector<fxFoliageDrawVertex> sFoliageDrawVerts;
+
+void fxFoliageReplicator::RenderBatchesImmediate(SceneState* state)
+{
+	// Calculate some constants.
+	const F32	ClippedViewDistance		= mFieldData.mViewDistance;
+	const F32	MinimumViewDistance		= mFieldData.mViewClosest - mFieldData.mFadeOutRegion;
+	const F32	MaximumViewDistance		= ClippedViewDistance + mFieldData.mFadeInRegion;
+	const F32	LuminanceMidPoint		= (mFieldData.mMinLuminance + mFieldData.mMaxLuminance) / 2.0f;
+	const F32	LuminanceMagnitude		= mFieldData.mMaxLuminance - LuminanceMidPoint;
+	const Point3F&	CameraPosition		= state->getCameraPosition();
+	const Point3F	ZAxis(0, 0, 1);
+
+	// Fetch the Camera axes for the billboarding.
+	MatrixF ModelView;
+	Point3F Right, Up;
+	dglGetModelview(&ModelView);
+	ModelView.inverse();
+	ModelView.getColumn(0, &Right);
+	ModelView.getColumn(1, &Up);
+
+	// Sway Luminance.
+	F32	Luminance = 1.0f;
+
+	// Reset Sway Offsets.
+	F32	SwayOffsetX = 0.0f;
+	F32	SwayOffsetY = 0.0f;
+
+	// Is Swaying On and *in* Sync?
+	if (mFieldData.mSwayOn && mFieldData.mSwaySync)
+	{
+		// Yes, so calculate Global Sway Offset.
+		SwayOffsetX = mFieldData.mSwayMagnitudeSide * mCosTable[(U32)mGlobalSwayPhase];
+		SwayOffsetY = mFieldData.mSwayMagnitudeFront * mSinTable[(U32)mGlobalSwayPhase];
+	}
+
+	// Is Light On and *in* Sync?
+	if (mFieldData.mLightOn && mFieldData.mLightSync)
+	{
+		// Yes, so calculate Global Light Luminance.
+		Luminance = LuminanceMidPoint + LuminanceMagnitude * mCosTable[(U32)mGlobalLightPhase];
+	}
+
+	// Expand the visible Billboards into one vertex array.
+	sFoliageDrawVerts.clear();
+
+	Vector<fxFoliageQuadrantNode*>& Leaves = mFrustumRenderSet.mVisLeaves;
+	for (U32 l = 0; l < Leaves.size(); l++)
+	{
+		const fxFoliageQuadrantNode* pLeaf = Leaves[l];
+
+		for (U32 idx = 0; idx < pLeaf->RenderList.size(); idx++)
+		{
+			const fxFoliageItem* pFoliageItem = pLeaf->RenderList[idx];
+			const Point3F Position = pFoliageItem->Transform.getPosition();
+			F32 ItemAlpha;
+
+			// Calculate Distance to Item.
+			F32 Distance = (Position - CameraPosition).len();
+
+			// Trivially reject the billboard if it's beyond the SceneGraphs visible distance.
+			if (Distance > state->getVisibleDistance())	continue;
+
+			// Calculate Fog Alpha.
+			F32 FogAlpha = 1.0f - state->getHazeAndFog(Distance, Position.z - CameraPosition.z);
+
+			// Trivially reject the billboard if it's totally transparent.
+			if (FogAlpha < FXFOLIAGE_ALPHA_EPSILON) continue;
+
+			// Can we trivially accept the billboard?
+			if (Distance < MinimumViewDistance || Distance > MaximumViewDistance) continue;
+
+			// Yes, so are we fading out?
+			if (Distance < mFieldData.mViewClosest)
+			{
+				// Yes, so set fade-out.
+				ItemAlpha = 1.0f - ((mFieldData.mViewClosest - Distance) * mFadeOutGradient);
+			}
+			// No, so are we fading in?
+			else if (Distance > ClippedViewDistance)
+			{
+				// Yes, so set fade-in
+				ItemAlpha = 1.0f - ((Distance - ClippedViewDistance) * mFadeInGradient);
+			}
+			// No, so set full.
+			else
+			{
+				ItemAlpha = 1.0f;
+			}
+
+			// Clamp upper-limit to Fog Alpha.
+			if (ItemAlpha > FogAlpha) ItemAlpha = FogAlpha;
+
+			// Is Swaying On and *not* in Sync?
+			if (mFieldData.mSwayOn && !mFieldData.mSwaySync)
+			{
+				// Yes, so calculate Sway Offset.
+				U32 SwayPhase = (U32)mFmod(pFoliageItem->SwayPhase + pFoliageItem->SwayTimeRatio * mAnimationTime, 720.0f) % 720;
+				SwayOffsetX = mFieldData.mSwayMagnitudeSide * mCosTable[SwayPhase];
+				SwayOffsetY = mFieldData.mSwayMagnitudeFront * mSinTable[SwayPhase];
+			}
+
+			// Is Light On and *not* in Sync?
+			if (mFieldData.mLightOn && !mFieldData.mLightSync)
+			{
+				// Yes, so calculate Light Luminance.
+				U32 LightPhase = (U32)mFmod(pFoliageItem->LightPhase + pFoliageItem->LightTimeRatio * mAnimationTime, 720.0f) % 720;
+				Luminance = LuminanceMidPoint + LuminanceMagnitude * mCosTable[LightPhase];
+			}
+
+			// Fetch Width/Height.
+			const F32 Width		= pFoliageItem->Width / 2.0f;
+			const F32 Height	= pFoliageItem->Height;
+
+			// Fetch Flipped Flag.
+			const F32 LeftTexPos	= pFoliageItem->Flipped ? 1.0f : 0.0f;
+			const F32 RightTexPos	= 1.0f - LeftTexPos;
+
+			// Set the Colours, with the Ground Blend at the bottom.
+			const U8 Lum		= (U8)(mClampF(Luminance, 0, 1) * 255);
+			const U8 TopAlpha	= (U8)(mClampF(ItemAlpha, 0, 1) * 255);
+			const U8 BaseAlpha	= (U8)(mClampF(getMin(mFieldData.mGroundAlpha, ItemAlpha), 0, 1) * 255);
+
+			// Draw Billboard.
+			const Point3F Top = Position + Up * SwayOffsetY + ZAxis * Height;
+
+			sFoliageDrawVerts.increment(4);
+			fxFoliageDrawVertex* pVert = &sFoliageDrawVerts.last() - 3;
+
+			pVert[0].Position = Top + Right * (-Width + SwayOffsetX);
+			pVert[0].TexCoord.set(LeftTexPos, 0);
+			pVert[1].Position = Top + Right * (+Width + SwayOffsetX);
+			pVert[1].TexCoord.set(RightTexPos, 0);
+			pVert[2].Position = Position + Right * Width;
+			pVert[2].TexCoord.set(RightTexPos, 1);
+			pVert[3].Position = Position - Right * Width;
+			pVert[3].TexCoord.set(LeftTexPos, 1);
+
+			for (U32 v = 0; v < 4; v++)
+			{
+				pVert[v].Colour[0] = pVert[v].Colour[1] = pVert[v].Colour[2] = Lum;
+				pVert[v].Colour[3] = v < 2 ? TopAlpha : BaseAlpha;
+			}
+		}
+	}
+
+	// Anything to draw?
+	if (sFoliageDrawVerts.empty()) return;
+
+	// Draw the Billboards.
+	const GLsizei Stride = sizeof(fxFoliageDrawVertex);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(3, GL_FLOAT, Stride, &sFoliageDrawVerts[0].Position);
+	glTexCoordPointer(2, GL_FLOAT, Stride, &sFoliageDrawVerts[0].TexCoord);
+	glColorPointer(4, GL_UNSIGNED_BYTE, Stride, sFoliageDrawVerts[0].Colour);
+
+	glDrawArrays(GL_QUADS, 0, sFoliageDrawVerts.size());
+
+	// Restore rendering state.
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glColor4f(1, 1, 1, 1);
+}
+
+//------------------------------------------------------------------------------
+
 void fxFoliageReplicator::renderObject(SceneState* state, SceneRenderImage*)
 {
    PROFILE_START(FoliageRep_renderObject);
@@ -1371,37 +2161,10 @@ void fxFoliageReplicator::renderObject(SceneState* state, SceneRenderImage*)
 	// Draw Foliage.
 	if (!mFieldData.mHideFoliage && mCurrentFoliageCount)
 	{
-		// Calculate some constants.
-		const F32	ClippedViewDistance		= mFieldData.mViewDistance;
-		const F32	MinimumViewDistance		= mFieldData.mViewClosest - mFieldData.mFadeOutRegion;
-		const F32	MaximumViewDistance		= ClippedViewDistance + mFieldData.mFadeInRegion;
-		const F32	LuminanceMidPoint		= (mFieldData.mMinLuminance + mFieldData.mMaxLuminance) / 2.0f;
-		const F32	LuminanceMagnitude		= mFieldData.mMaxLuminance - LuminanceMidPoint;
-
-		// Billboard Details.
-		MatrixF			ModelView;
-		Point4F			Position;
-		const Point4F	XRotation(1,0,0,0);
-		const Point4F	YRotation(0,1,0,0);
-		Point4F			ZRotation;
-		F32				LeftTexPos;
-		F32				RightTexPos;
-
-		// Sway Luminance.
-		F32	Luminance = 1.0f;
-
-		// Reset Sway Offsets.
-		F32	SwayOffsetX = 0.0f;
-		F32	SwayOffsetY = 0.0f;
-
 		// Is Swaying On and *in* Sync?
 		if (mFieldData.mSwayOn && mFieldData.mSwaySync)
 		{
-			// Yes, so calculate Global Sway Offset.
-			SwayOffsetX = mFieldData.mSwayMagnitudeSide * mCosTable[(U32)mGlobalSwayPhase];
-			SwayOffsetY = mFieldData.mSwayMagnitudeFront * mSinTable[(U32)mGlobalSwayPhase];
-
-			// Animate Global Sway Phase (Modulus).
+			// Yes, so animate Global Sway Phase (Modulus).
 			mGlobalSwayPhase = mGlobalSwayPhase + (mGlobalSwayTimeRatio * ElapsedTime);
 			if (mGlobalSwayPhase >= 720.0f) mGlobalSwayPhase -= 720.0f;
 		}
@@ -1409,20 +2172,21 @@ void fxFoliageReplicator::renderObject(SceneState* state, SceneRenderImage*)
 		// Is Light On and *in* Sync?
 		if (mFieldData.mLightOn && mFieldData.mLightSync)
 		{
-			// Yes, so calculate Global Light Luminance.
-			Luminance = LuminanceMidPoint + LuminanceMagnitude * mCosTable[(U32)mGlobalLightPhase];
-
-			// Animate Global Light Phase (Modulus).
+			// Yes, so animate Global Light Phase (Modulus).
 			mGlobalLightPhase = mGlobalLightPhase + (mGlobalLightTimeRatio * ElapsedTime);
 			if (mGlobalLightPhase >= 720.0f) mGlobalLightPhase -= 720.0f;
 		}
 
+		// Animate the unsynchronised phases.
+		mAnimationTime += ElapsedTime;
+		if (mAnimationTime > FXFOLIAGE_REBASE_TIME) RebaseAnimation();
+
+		// Clear the Visible Leaves.
+		mFrustumRenderSet.mVisLeaves.clear();
+
 		// Are we using culling?
 		if (mFieldData.mUseCulling)
 		{
-			// Yes, so clear the Render Object Set.
-			mFrustumRenderSet.mVisObjectSet.clear();
-
 			// Calculate nearest Clipping Far-Plane.
 			//
 			// NOTE:-	Here we want the nearest plane to which we want to clip.
@@ -1450,21 +2214,12 @@ void fxFoliageReplicator::renderObject(SceneState* state, SceneRenderImage*)
 		}
 		else
 		{
-			// No, so clear the Render Object Set.
-			mFrustumRenderSet.mVisObjectSet.clear();
-
-			// Handle *all* objects ... potential eeek!
-			mFrustumRenderSet.mVisObjectSet.merge(mReplicatedFoliage);
+			// No, so handle *all* leaves ... potential eeek!
+			mFrustumRenderSet.mVisLeaves.merge(mFoliageLeaves);
 		}
 
-		// Increase Frame Serial ID.
-		mFrameSerialID++;
-
-		// Reset Foliage Processed Counter.
-		U32 FoliageProcessed = 0;
-
-		// Only process if we have any trivially visible objects.
-		if (mFrustumRenderSet.mVisObjectSet.size() > 0)
+		// Only process if we have any trivially visible leaves.
+		if (mFrustumRenderSet.mVisLeaves.size() > 0)
 		{
 			// Setup Render State.
 			glEnable            ( GL_TEXTURE_2D );
@@ -1476,142 +2231,11 @@ void fxFoliageReplicator::renderObject(SceneState* state, SceneRenderImage*)
 			glEnable			( GL_CULL_FACE );
 			glAlphaFunc			( GL_GREATER, mFieldData.mAlphaCutoff );
 
-			// Step through Foliage.
-			for (U32 idx = 0; idx < mFrustumRenderSet.mVisObjectSet.size(); idx++)
-			{
-				fxFoliageItem*	pFoliageItem;
-				F32				Width, Height;
-				F32				Distance;
-				F32				ItemAlpha;
-				F32				FogAlpha;
-			
-				// Fetch the Foliage Item.
-				pFoliageItem = mFrustumRenderSet.mVisObjectSet[idx];
-
-				// Check to see if we've already rendered this object.
-				//
-				// NOTE:-	We need to do this as objects can overlap over quad-tree boundaries and are
-				//			therefore picked up.  We don't want to remove these duplicates otherwise the
-				//			overlapping billboards would be contained within a single quad-block only
-				//			and could possibly be culled even though they are visible in the adjacent
-				//			quad-block.  In other words, billboards are *not* treated as a point but rather
-				//			a psuedo volume which stops them popping-up when the central point is visible.
-				//
-				//			We also mark the billboard as rendered even if it results in being culled
-				//			further on as this stops it being rendered further this frame.
-				//
-				// Has the item been rendered this frame?
-				if (pFoliageItem->LastFrameSerialID != mFrameSerialID)
-				{
-					// No, so flag as rendered this frame.
-					pFoliageItem->LastFrameSerialID = mFrameSerialID;
-
-					// Increase Foliage Processed Counter.
-					FoliageProcessed++;
-
-					// Is Swaying On and *not* in Sync?
-					if (mFieldData.mSwayOn && !mFieldData.mSwaySync)
-					{
-						// Yes, so calculate Sway Offset.
-						SwayOffsetX = mFieldData.mSwayMagnitudeSide * mCosTable[(U32)pFoliageItem->SwayPhase];
-						SwayOffsetY = mFieldData.mSwayMagnitudeFront * mSinTable[(U32)pFoliageItem->SwayPhase];
-
-						// Animate Sway Phase (Modulus).
-						pFoliageItem->SwayPhase = pFoliageItem->SwayPhase + (pFoliageItem->SwayTimeRatio * ElapsedTime);
-						if (pFoliageItem->SwayPhase >= 720.0f) pFoliageItem->SwayPhase -= 720.0f;
-					}
-
-					// Is Light On and *not* in Sync?
-					if (mFieldData.mLightOn && !mFieldData.mLightSync)
-					{
-						// Yes, so calculate Light Luminance.
-						Luminance = LuminanceMidPoint + LuminanceMagnitude * mCosTable[(U32)pFoliageItem->LightPhase];
-
-						// Animate Light Phase (Modulus).
-						pFoliageItem->LightPhase = pFoliageItem->LightPhase + (pFoliageItem->LightTimeRatio * ElapsedTime);
-						if (pFoliageItem->LightPhase >= 720.0f) pFoliageItem->LightPhase -= 720.0f;
-					}
-
-					// Calculate Distance to Item.
-					Distance = (pFoliageItem->Transform.getPosition() - state->getCameraPosition()).len();
-
-					// Trivially reject the billboard if it's beyond the SceneGraphs visible distance.
-					if (Distance > state->getVisibleDistance())	continue;
-
-					// Calculate Fog Alpha.
-					FogAlpha = 1.0f - state->getHazeAndFog(Distance, pFoliageItem->Transform.getPosition().z - state->getCameraPosition().z);
-
-					// Trivially reject the billboard if it's totally transparent.
-					if (FogAlpha < FXFOLIAGE_ALPHA_EPSILON) continue;
-
-					// Can we trivially accept the billboard?
-					if (Distance >= MinimumViewDistance && Distance <= MaximumViewDistance)
-					{
-						// Yes, so are we fading out?
-						if (Distance < mFieldData.mViewClosest)
-						{
-							// Yes, so set fade-out.
-							ItemAlpha = 1.0f - ((mFieldData.mViewClosest - Distance) * mFadeOutGradient);
-						}
-						// No, so are we fading in?
-						else if (Distance > ClippedViewDistance)
-						{
-							// Yes, so set fade-in
-							ItemAlpha = 1.0f - ((Distance - ClippedViewDistance) * mFadeInGradient);
-						}
-						// No, so set full.
-						else
-						{
-							ItemAlpha = 1.0f;
-						}
-
-						// Clamp upper-limit to Fog Alpha.
-						if (ItemAlpha > FogAlpha) ItemAlpha = FogAlpha;
-
-						// Store our Modelview.
-						glPushMatrix();
-
-						// Perform Spherical Billboarding.
-						dglMultMatrix(&pFoliageItem->Transform);
-						dglGetModelview(&ModelView);
-						ModelView.setColumn(0, XRotation);
-						ModelView.setColumn(1, YRotation);
-						dglLoadMatrix(&ModelView);
-
-						// Fetch Width/Height.
-						Width	= pFoliageItem->Width / 2.0f;
-						Height	= pFoliageItem->Height;
-
-						// Fetch Flipped Flag.
-						LeftTexPos	= pFoliageItem->Flipped ? 1.0f : 0.0f;
-						RightTexPos	= 1.0f - LeftTexPos;
-
-						// Draw Billboard.
-						glBegin(GL_QUADS);
-							// Set Blend Function.
-							glColor4f(Luminance,Luminance,Luminance, ItemAlpha);
-
-							// Draw Top part of billboard.
-							glTexCoord2f	(LeftTexPos,0);
-							glVertex3f		(-Width+SwayOffsetX,SwayOffsetY,Height);
-							glTexCoord2f	(RightTexPos,0);
-							glVertex3f		(+Width+SwayOffsetX,SwayOffsetY,Height);
-
-							// Set Ground Blend.
-							if (mFieldData.mGroundAlpha < 1.0f) glColor4f(Luminance, Luminance, Luminance, mFieldData.mGroundAlpha < ItemAlpha ? mFieldData.mGroundAlpha : ItemAlpha);
-
-							// Draw bottom part of billboard.
-							glTexCoord2f	(RightTexPos,1);
-							glVertex3f		(+Width,0,0);
-							glTexCoord2f	(LeftTexPos,1);
-							glVertex3f		(-Width,0,0);
-						glEnd();
-
-						// Restore our Modelview.
-						glPopMatrix();
-					}
-				}
-			}
+			// Draw the Billboards, on the card when we can.
+			if (BindProgram())
+				RenderBatchesProgram(state);
+			else
+				RenderBatchesImmediate(state);
 
 			// Restore rendering state.
 			glTexEnvi			( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE );
@@ -1620,13 +2244,6 @@ void fxFoliageReplicator::renderObject(SceneState* state, SceneRenderImage*)
 			glDisable			( GL_BLEND );
 			glDisable			( GL_TEXTURE_2D );
 		}
-
-		// Dump Debug Information (Uncomment this if needed).
-		//
-		// NOTE:-	Here we show the number of objects rendered compared to the potential objects in the viewing frustum.
-		//			Remember that the difference is simply billboards that intersect quad-tree boundaries.
-		//
-		//if (mFieldData.mUseDebugInfo) Con::printf("fxFoliageReplicator - %d of %d Foliage Items Processed", FoliageProcessed, mFrustumRenderSet.mVisObjectSet.size());
 	}
 
 	// Restore out nice and friendly canonical state.
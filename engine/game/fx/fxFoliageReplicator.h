@@ -26,6 +26,8 @@
 
 
 
+class fxFoliageQuadrantNode;
+
 //------------------------------------------------------------------------------
 // Class: fxFoliageItem
 //------------------------------------------------------------------------------
@@ -41,7 +43,20 @@ public:
    F32         SwayTimeRatio;
    F32         LightPhase;
    F32         LightTimeRatio;
-   U32         LastFrameSerialID;
+   fxFoliageQuadrantNode*  Owner;   // Leaf that batches this billboard.
+};
+
+
+//------------------------------------------------------------------------------
+// Class: fxFoliageVertex
+//------------------------------------------------------------------------------
+// One corner of a billboard in the static batches.  The vertex program
+// builds the corner from the item position using the camera axes.
+struct fxFoliageVertex
+{
+   Point3F     Position;      // Item position.
+   Point4F     TexCoord;      // u, v, top (0 or 1), light phase.
+   Point4F     Corner;        // Side offset, height, sway phase, sway rate.
 };
 
 
@@ -73,7 +88,10 @@ public:
    U32                  Level;
    Box3F               QuadrantBox;
    fxFoliageQuadrantNode*   QuadrantChildNode[4];
-   Vector<fxFoliageItem*>   RenderList;
+   Vector<fxFoliageItem*>   RenderList;       // Billboards owned by this leaf.
+   Box3F               CullBox;          // Bounds of the billboards below this node.
+   bool                  CullBoxValid;
+   U32                  BatchStart;       // First billboard of this leaf in the batches.
 
    fxFoliageQuadrantNode()
    {
@@ -95,7 +113,7 @@ public:
    Box3F               mBox;            // Clipping Box.
    PlaneF               ViewPlanes[5];      // Clipping View-Planes.
 
-   Vector<fxFoliageItem*>   mVisObjectSet;      // Visible Object Set.
+   Vector<fxFoliageQuadrantNode*>   mVisLeaves;   // Visible Leaves.
    F32                  mHeightLerp;      // Height Lerp.
 
 public:
@@ -124,6 +142,20 @@ protected:
    void ProcessQuadrant(fxFoliageQuadrantNode* pParentNode, fxFoliageCulledList* pCullList, U32 Quadrant);
    void ProcessNodeChildren(fxFoliageQuadrantNode* pParentNode, fxFoliageCulledList* pCullList);
 
+   void PlaceFoliage(Vector<Point3F>& Positions);
+   void CollectLeaves(fxFoliageQuadrantNode* pNode);
+   bool UpdateCullBox(fxFoliageQuadrantNode* pNode);
+   void BuildBatches(void);
+   void FillBatches(void);
+   void RebaseAnimation(void);
+   bool BindBatchBuffer(void);
+   void RenderBatchesProgram(SceneState* state);
+   void RenderBatchesImmediate(SceneState* state);
+
+   static void FillLeafBatches(U32 start, U32 end, void* userData);
+   static bool BindProgram(void);
+   static void BufferTextureEvent(const U32 eventCode, void*);
+
    enum {   FoliageReplicationMask   = (1 << 0) };
 
 
@@ -135,6 +167,12 @@ protected:
    Vector<fxFoliageQuadrantNode*>   mFoliageQuadTree;
    Vector<fxFoliageItem*>           mReplicatedFoliage;
    fxFoliageRenderList              mFrustumRenderSet;
+   Vector<fxFoliageQuadrantNode*>   mFoliageLeaves;             // Leaves, in tree order.
+   Vector<fxFoliageVertex>          mBatchVerts;                // Static batches, 4 per billboard.
+   U32                              mVertexBuffer;
+   U32                              mBufferGeneration;
+   bool                             mBatchesDirty;              // Buffer needs uploading again.
+   F32                              mAnimationTime;             // Seconds since the phases were rebased.
 
    MRandomLCG                 RandomGen;
    F32                        mFadeInGradient;
@@ -144,7 +182,6 @@ protected:
    F32                        mGlobalSwayTimeRatio;
    F32                        mGlobalLightPhase;
    F32                        mGlobalLightTimeRatio;
-   U32                        mFrameSerialID;
 
    U32                        mQuadTreeLevels;            // Quad-Tree Levels.
    U32                        mPotentialFoliageNodes;     // Potential Foliage Nodes.
@@ -177,6 +214,14 @@ public:
 
    // ConObject.
    static void initPersistFields();
+   static void consoleInit();
+
+   static bool smUseVertexProgram;     // $pref::Foliage::vertexProgram
+   static bool smUseBufferObjects;     // $pref::Foliage::vertexBufferObjects
+   static U32  smBufferGeneration;
+   static U32  smBufferCallbackKey;
+   static U32  smProgram;
+   static U32  smProgramGeneration;
 
    // Field Data.
    class tagFieldData
@@ -380,6 +380,12 @@ void fxLight::initPersistFields()
 
 //------------------------------------------------------------------------------
 
+// Nothing but GameBase's own tick, the attach check is disabled.
+bool fxLight::isParallelTickSafe()
+{
+	return true;
+}
+
 void fxLight::processTick(const Move* m)
 {
 	// Process Parent.
@@ -1217,7 +1223,7 @@ bool fxLight::prepRenderImage(SceneState* state, const U32 stateKey, const U32 s
    if (state->isObjectRendered(this))
    {	
 		// Yes, so get a SceneRenderImage.
-		SceneRenderImage* image = new SceneRenderImage;
+		SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
 		// Populate it.
 		image->obj = this;
 		image->isTranslucent = true;
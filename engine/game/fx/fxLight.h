@@ -183,6 +183,7 @@ public:
    // GameBase.
    bool onNewDataBlock(GameBaseData* dptr);
    void processTick(const Move*);
+   bool isParallelTickSafe();
 
    // SceneObject
    bool prepRenderImage(SceneState* state, const U32 stateKey, const U32 startZone, const bool modifyBaseZoneState);
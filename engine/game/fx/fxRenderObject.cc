@@ -563,7 +563,7 @@ bool fxRenderObject::prepRenderImage(	SceneState* state, const U32 stateKey, con
    if (state->isObjectRendered(this))
    {	   
 		// Yes, so get a SceneRenderImage.
-		SceneRenderImage* image = new SceneRenderImage;
+		SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
 		// Populate it.
 		image->obj = this;
 		image->isTranslucent = false;
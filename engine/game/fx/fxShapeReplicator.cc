@@ -645,7 +645,7 @@ bool fxShapeReplicator::prepRenderImage(SceneState* state, const U32 stateKey, c
    if (state->isObjectRendered(this))
    {
         // Yes, so get a SceneRenderImage.
-        SceneRenderImage* image = new SceneRenderImage;
+        SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
         // Populate it.
         image->obj = this;
         image->sortType = SceneRenderImage::Normal;
@@ -781,7 +781,7 @@ U32 fxShapeReplicator::packUpdate(NetConnection * con, U32 mask, BitStream * str
 		   stream->writeInt(maxcount, SG_TSSTATIC_MAX_LIGHT_SHIFT);
 		   for(U32 i=0; i<maxcount; i++)
 		   {
-			   stream->writeInt(lightIds[i], NetConnection::GhostIdBitSize);
+			   con->packGhostIndex(stream, lightIds[i]);
 		   }
 	   }
 	   else
@@ -791,7 +791,7 @@ U32 fxShapeReplicator::packUpdate(NetConnection * con, U32 mask, BitStream * str
 		   stream->writeInt(maxcount, SG_TSSTATIC_MAX_LIGHT_SHIFT);
 		   for(U32 i=0; i<maxcount; i++)
 		   {
-			   stream->writeInt(lightIds[i], NetConnection::GhostIdBitSize);
+			   con->packGhostIndex(stream, lightIds[i]);
 		   }
 	   }
    }
@@ -855,7 +855,7 @@ void fxShapeReplicator::unpackUpdate(NetConnection * con, BitStream * stream)
 	   lightIds.clear();
 	   for(U32 i=0; i<count; i++)
 	   {
-		   S32 id = stream->readInt(NetConnection::GhostIdBitSize);
+		   S32 id = con->unpackGhostIndex(stream);
 		   lightIds.push_back(id);
 	   }
    }
@@ -38,7 +38,7 @@ private:
    typedef SceneObject         Parent;
 
 public:
-   fxShapeReplicatedStatic() {};
+   fxShapeReplicatedStatic() { mAllowInstancing = true; };
    ~fxShapeReplicatedStatic() {};
    void touchNetFlags(const U32 m, bool setflag = true) { if (setflag) mNetFlags.set(m); else mNetFlags.clear(m); };
    TSShape* getShape(void) { return mShapeInstance->getShape(); };
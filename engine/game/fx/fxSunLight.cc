@@ -1658,7 +1658,7 @@ bool fxSunLight::prepRenderImage(SceneState* state, const U32 stateKey, const U3
    if (state->isObjectRendered(this))
    {
       // Yes, so get a SceneRenderImage.
-      SceneRenderImage* image = new SceneRenderImage;
+      SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
       // Populate it.
       image->obj = this;
       image->isTranslucent = true;
@@ -1667,7 +1667,7 @@ bool fxSunLight::prepRenderImage(SceneState* state, const U32 stateKey, const U3
       state->insertRenderImage(image);
 
       // Yes, so get a SceneRenderImage.
-      image = new SceneRenderImage;
+      image = SceneState::newRenderImage<SceneRenderImage>();
       // Populate it.
       image->obj = this;
       image->isTranslucent = true;
@@ -1961,34 +1961,17 @@ bool fxSunLight::TestLOS(const Point3F& ObjectPosition)
                      ItemObjectType |
                      PlayerObjectType;
 
-   // Stop Collisions with our Control Object (in first person).
-   if (ControlObj->isFirstPerson()) ControlObj->disableCollision();
+   // Size of the sun's core for an occlusion query, a few pixels across.
+   F32 radius = ((endPos - eyePos).len() / dglGetPixelScale()) * 2.0f;
 
-   // Store old Object Box.
-   Box3F OldObjBox = mObjBox;
-
-   // Set LOS Test Object Box.
-   mObjBox.min.set( -0.5, -0.5, -0.5 );
-   mObjBox.max.set(  0.5,  0.5,  0.5 );
-   // Reset the World Box.
-   resetWorldBox();
-   setRenderTransform(mObjToWorld);
-
-   // Perform a ray cast on the client container database.
-   RayInfo info;
-   bool los = !gClientContainer.castRay(eyePos, endPos, losMask, &info);
-
-   // Restore old Object Box.
-   mObjBox = OldObjBox;
-   // Reset the World Box.
-   resetWorldBox();
-   setRenderTransform(mObjToWorld);
-
-   // Continue Collisions with our Control Object (in first person).
-   if (ControlObj->isFirstPerson()) ControlObj->enableCollision();
+   // Queue the test for the end of the frame, ignoring our Control Object
+   // in first person.  We get last frame's answer, which is fine, the
+   // flare fades anyway.
+   mSunVisibility.request(eyePos, endPos, losMask,
+                          ControlObj->isFirstPerson() ? ControlObj : NULL, radius);
 
    // Return LOS result.
-   return los;
+   return mSunVisibility.isVisible();
 };
 
 //------------------------------------------------------------------------------
@@ -10,6 +10,9 @@
 #ifndef _SCENEOBJECT_H_
 #include "sim/sceneObject.h"
 #endif
+#ifndef _VISIBILITYQUERY_H_
+#include "sceneGraph/visibilityQuery.h"
+#endif
 
 
 //------------------------------------------------------------------------------
@@ -45,6 +48,7 @@ protected:
    S32                  mLastRenderTime;
    F32                  mLocalFlareScale;
    Point3F              mSunlightPosition;            // Sunlight Frame Position.
+   VisibilityQuery      mSunVisibility;               // Local flare LOS, a frame late.
 
 public:
    fxSunLight();
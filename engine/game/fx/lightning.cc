@@ -26,6 +26,36 @@ IMPLEMENT_CO_NETOBJECT_V1(Lightning);
 
 MRandomLCG sgLightningRand;
 
+namespace {
+
+struct BoltVertex
+{
+   Point3F point;
+   Point2F texCoord;
+   U8      color[4];
+};
+
+/// The strips of every bolt of a Lightning, joined with degenerate
+/// triangles into one.
+Vector<BoltVertex> sBoltVerts;
+
+/// Seconds between moves of the minor nodes, which make the bolt crackle.
+const F32 BoltJitterInterval = 0.03f;
+
+inline void addBoltVertex(const Point3F &point, F32 u, F32 v, const ColorI &color)
+{
+   sBoltVerts.increment();
+   BoltVertex &vert = sBoltVerts.last();
+   vert.point = point;
+   vert.texCoord.set(u, v);
+   vert.color[0] = color.red;
+   vert.color[1] = color.green;
+   vert.color[2] = color.blue;
+   vert.color[3] = color.alpha;
+}
+
+} // namespace {}
+
 ConsoleMethod( Lightning, warningFlashes, void, 2, 2, "")
 {
    if (object->isServerObject()) object->warningFlashes();
@@ -126,7 +156,7 @@ void LightningStrikeEvent::pack(NetConnection* con, BitStream* stream)
       return;
    }
    stream->writeFlag(true);
-   stream->writeRangedU32(U32(id), 0, NetConnection::MaxGhostCount);
+   con->packGhostIndex(stream, id);
    stream->writeFloat(mStart.x, PositionalBits);
    stream->writeFloat(mStart.y, PositionalBits);
 
@@ -138,7 +168,7 @@ void LightningStrikeEvent::pack(NetConnection* con, BitStream* stream)
       else
       {
          stream->writeFlag(true);
-         stream->writeRangedU32(U32(ghostIndex), 0, NetConnection::MaxGhostCount);
+         con->packGhostIndex(stream, ghostIndex);
       }
    }
    else
@@ -149,7 +179,7 @@ void LightningStrikeEvent::unpack(NetConnection* con, BitStream* stream)
 {
    if(!stream->readFlag())
       return;
-   S32 mClientId = stream->readRangedU32(0, NetConnection::MaxGhostCount);
+   S32 mClientId = con->unpackGhostIndex(stream);
    mLightning = NULL;
    NetObject* pObject = con->resolveGhost(mClientId);
    if (pObject)
@@ -161,7 +191,7 @@ void LightningStrikeEvent::unpack(NetConnection* con, BitStream* stream)
    if( stream->readFlag() )
    {
       // target id
-      S32 mTargetID    = stream->readRangedU32(0, NetConnection::MaxGhostCount);
+      S32 mTargetID    = con->unpackGhostIndex(stream);
 
       NetObject* pObject = con->resolveGhost(mTargetID);
       if( pObject != NULL )
@@ -416,7 +446,7 @@ bool Lightning::prepRenderImage(SceneState* state, const U32 stateKey,
    // This should be sufficient for most objects that don't manage zones, and
    //  don't need to return a specialized RenderImage...
    if (state->isObjectRendered(this)) {
-      SceneRenderImage* image = new SceneRenderImage;
+      SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
       image->obj = this;
       image->isTranslucent = true;
       image->sortType = SceneRenderImage::EndSort;
@@ -471,30 +501,47 @@ void Lightning::renderObject(SceneState* state, SceneRenderImage*)
       }
    }
 
+   // Every bolt shares the texture and state, so they all go in one strip.
+   sBoltVerts.clear();
    Strike* walk = mStrikeListHead;
    while (walk != NULL) {
 
-      glBindTexture(GL_TEXTURE_2D, mDataBlock->strikeTextures[0].getGLName());
-
       for( U32 i=0; i<3; i++ )
       {
+         ColorF boltColor = color;
          if( walk->bolt[i].isFading )
          {
             F32 alpha = 1.0f - walk->bolt[i].percentFade;
             if( alpha < 0.0f ) alpha = 0.0f;
-            glColor4f( fadeColor.red, fadeColor.green, fadeColor.blue, alpha );
+            boltColor.set( fadeColor.red, fadeColor.green, fadeColor.blue, alpha );
          }
-         else
-         {
-            glColor4fv( color );
-         }
-         walk->bolt[i].render( state->getCameraPosition() );
+         boltColor.clamp();
+         walk->bolt[i].batch( state->getCameraPosition(), boltColor );
       }
 
 
       walk = walk->next;
    }
 
+   if( sBoltVerts.size() )
+   {
+      glBindTexture(GL_TEXTURE_2D, mDataBlock->strikeTextures[0].getGLName());
+
+      const U8* base = (const U8*) sBoltVerts.address();
+      glEnableClientState(GL_VERTEX_ARRAY);
+      glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+      glEnableClientState(GL_COLOR_ARRAY);
+      glVertexPointer(3, GL_FLOAT, sizeof(BoltVertex), base + Offset(point, BoltVertex));
+      glTexCoordPointer(2, GL_FLOAT, sizeof(BoltVertex), base + Offset(texCoord, BoltVertex));
+      glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(BoltVertex), base + Offset(color, BoltVertex));
+
+      glDrawArrays(GL_TRIANGLE_STRIP, 0, sBoltVerts.size());
+
+      glDisableClientState(GL_COLOR_ARRAY);
+      glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+      glDisableClientState(GL_VERTEX_ARRAY);
+   }
+
    glDepthMask( GL_TRUE );
 
    glDisable(GL_FOG);
@@ -551,6 +598,16 @@ void Lightning::scheduleThunder(Strike* newStrike)
 
 
 //--------------------------------------------------------------------------
+// A strike posts events to the clients; the ticks between only count
+// time, and the client's do nothing.
+bool Lightning::isParallelTickSafe()
+{
+   if(isClientObject())
+      return true;
+   S32 msBetweenStrikes = (S32)(60.0 / strikesPerMinute * 1000.0);
+   return S32(mLastThink + TickMs) <= msBetweenStrikes;
+}
+
 void Lightning::processTick(const Move* move)
 {
    Parent::processTick(move);
@@ -928,6 +985,7 @@ LightningBolt::LightningBolt()
    elapsedTime = 0.0f;
    lifetime = 1.0f;
    startRender = false;
+   jitterTime = 0.0f;
 }
 
 //--------------------------------------------------------------------------
@@ -982,97 +1040,104 @@ void LightningBolt::NodeManager::generateNodes()
 
 
 //--------------------------------------------------------------------------
-// Render bolt
+// Batch bolt
 //--------------------------------------------------------------------------
-void LightningBolt::render( const Point3F &camPos )
+void LightningBolt::batch( const Point3F &camPos, const ColorI &color )
 {
    if( !startRender )
    {
       return;
    }
 
-   if( !isFading )
+   if( mStrip.size() )
    {
-      generateMinorNodes();
-   }
-
-   glBegin( GL_TRIANGLE_STRIP );
-
-   U32 i;
-   for( i=0; i<mMinorNodes.size(); i++ )
-   {
-      if( i+1 == mMinorNodes.size() )
+      // A degenerate pair joins this strip to the one before.
+      bool join = sBoltVerts.size() != 0;
+      if( join )
       {
-         renderSegment( mMinorNodes[i], camPos, true );
+         BoltVertex last = sBoltVerts.last();
+         sBoltVerts.push_back( last );
       }
-      else
+
+      for( U32 i=0; i<mStrip.size(); i++ )
       {
-         renderSegment( mMinorNodes[i], camPos, false );
-      }
-   }
+         const StripPoint &strip = mStrip[i];
 
-   glEnd();
+         Point3F dirFromCam = strip.point - camPos;
+         Point3F crossVec;
+         mCross(dirFromCam, strip.dir, &crossVec);
+         crossVec.normalize();
+         crossVec *= width * 0.5f;
 
+         addBoltVertex( strip.point - crossVec, strip.u, 1.0f, color );
+         if( join )
+         {
+            BoltVertex first = sBoltVerts.last();
+            sBoltVerts.push_back( first );
+            join = false;
+         }
+         addBoltVertex( strip.point + crossVec, strip.u, 0.0f, color );
+      }
+   }
 
    LightningBolt *curBolt = NULL;
    for( curBolt = splitList.next( curBolt ); curBolt; curBolt = splitList.next( curBolt ) )
    {
-      if( isFading )
-      {
-         curBolt->isFading = true;
-      }
-      curBolt->render( camPos );
+      curBolt->batch( camPos, color );
    }
-
-
 }
 
 //--------------------------------------------------------------------------
-// Render segment
+// Build strip - the points of the minor nodes the strip goes through,
+// each segment leaving off its last point for the next one's first
 //--------------------------------------------------------------------------
-void LightningBolt::renderSegment( NodeManager &segment, const Point3F &camPos, bool renderLastPoint )
+void LightningBolt::buildStrip()
 {
-   F32 totalLen = 0;
-   for( int i=0; i<segment.numNodes; i++ )
-   {
-      Point3F  curPoint = segment.nodeList[i].point;
+   mStrip.clear();
 
-      Point3F  nextPoint;
-      Point3F  segDir;
+   for( U32 s=0; s<mMinorNodes.size(); s++ )
+   {
+      const NodeManager &segment = mMinorNodes[s];
+      bool lastSegment = (s+1 == mMinorNodes.size());
 
-      if( i == (segment.numNodes-1) )
+      for( U32 i=0; i<segment.numNodes; i++ )
       {
-         if( renderLastPoint )
+         VectorF segDir;
+         if( i == segment.numNodes-1 )
          {
-            segDir = curPoint - segment.nodeList[i-1].point;
+            if( !lastSegment )
+            {
+               continue;
+            }
+            segDir = segment.nodeList[i].point - segment.nodeList[i-1].point;
          }
          else
          {
-            continue;
+            segDir = segment.nodeList[i+1].point - segment.nodeList[i].point;
          }
-      }
-      else
-      {
-         nextPoint = segment.nodeList[i+1].point;
-         segDir = nextPoint - curPoint;
-      }
-      totalLen = segDir.len();
-      segDir.normalizeSafe();
-
+         segDir.normalizeSafe();
 
-      Point3F dirFromCam = curPoint - camPos;
-      Point3F crossVec;
-      mCross(dirFromCam, segDir, &crossVec);
-      crossVec.normalize();
-      crossVec *= width * 0.5f;
+         mStrip.increment();
+         StripPoint &strip = mStrip.last();
+         strip.point = segment.nodeList[i].point;
+         strip.dir   = segDir;
+         strip.u     = F32(i);
+      }
+   }
+}
 
-      glTexCoord2f( i, 1.0f );
-      glVertex3fv( curPoint - crossVec );
+//--------------------------------------------------------------------------
+// Jitter
+//--------------------------------------------------------------------------
+void LightningBolt::jitter()
+{
+   generateMinorNodes();
 
-      glTexCoord2f( i, 0.0f );
-      glVertex3fv( curPoint + crossVec );
+   LightningBolt *curBolt = NULL;
+   for( curBolt = splitList.next( curBolt ); curBolt; curBolt = splitList.next( curBolt ) )
+   {
+      curBolt->jitter();
    }
-
 }
 
 //----------------------------------------------------------------------------
@@ -1132,6 +1197,8 @@ void LightningBolt::generateMinorNodes()
       mMinorNodes.increment(1);
       mMinorNodes[i] = segment;
    }
+
+   buildStrip();
 }
 
 //----------------------------------------------------------------------------
@@ -1226,4 +1293,16 @@ void LightningBolt::update( F32 dt )
       isFading = false;
       elapsedTime = 0.0f;
    }
+
+   // The bolt crackles until it starts to fade, at a steady rate
+   // rather than once a frame.
+   if( startRender && !isFading )
+   {
+      jitterTime += dt;
+      if( jitterTime >= BoltJitterInterval )
+      {
+         jitterTime = 0.0f;
+         jitter();
+      }
+   }
 }
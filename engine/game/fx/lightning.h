@@ -88,8 +88,19 @@ struct LightningBolt
       void generateNodes();
    };
 
+   /// A point of the strip drawn along mMinorNodes, with the direction
+   /// the strip leaves it in.  Only the width, turned to face the camera,
+   /// is left to work out each frame.
+   struct StripPoint
+   {
+      Point3F  point;
+      VectorF  dir;
+      F32      u;
+   };
+
    NodeManager mMajorNodes;
    Vector< NodeManager > mMinorNodes;
+   Vector< StripPoint > mStrip;     ///< Rebuilt with mMinorNodes.
    LList< LightningBolt > splitList;
 
    F32      lifetime;
@@ -99,6 +110,7 @@ struct LightningBolt
    F32      percentFade;
    bool     startRender;
    F32      renderTime;
+   F32      jitterTime;       ///< Since the minor nodes last moved.
 
    F32      width;
    F32      chanceOfSplit;
@@ -115,10 +127,14 @@ struct LightningBolt
 
    void  createSplit( const Point3F &startPoint, const Point3F &endPoint, U32 depth, F32 width );
    F32   findHeight( Point3F &point, SceneGraph* sceneManager );
-   void  render( const Point3F &camPos );
-   void  renderSegment( NodeManager &segment, const Point3F &camPos, bool renderLastPoint );
+   /// Adds the strips of this bolt and its splits to the batch Lightning
+   /// draws once all of its bolts are in.
+   void  batch( const Point3F &camPos, const ColorI &color );
    void  generate();
    void  generateMinorNodes();
+   void  buildStrip();
+   /// Moves the minor nodes of this bolt and its splits.
+   void  jitter();
    void  startSplits();
    void  update( F32 dt );
 
@@ -175,6 +191,7 @@ class Lightning : public GameBase
 
    // Time management
    void processTick(const Move *move);
+   bool isParallelTickSafe();
    void interpolateTick(F32 delta);
    void advanceTime(F32 dt);
 
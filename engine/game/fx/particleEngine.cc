@@ -15,47 +15,26 @@
 #include "platform/profiler.h"
 #include "lightingSystem/sgLighting.h"
 
-extern bool gEditingMission;
+// The particle update only needs SSE1 float ops, so it's built wherever
+// the compiler knows about SSE and used when the CPU reports it.
+#if defined(TORQUE_CPU_X86) && (defined(TORQUE_COMPILER_VISUALC) || defined(__SSE__))
+#  define PARTICLE_ENGINE_USE_SSE
+#  include <xmmintrin.h>
+#endif
 
-class PEngine;
+extern bool gEditingMission;
 
 //--------------------------------------------------------------------------
 //-------------------------------------- Internal global data
 //
 namespace {
 
-PEngine*   sgParticleEngine = NULL;
+bool       sgParticleEngineInit = false;
+bool       sgUseSSE = false;
 MRandomLCG sgRandom(0x1);
 
 } // namespace {}
 
-
-
-//--------------------------------------------------------------------------
-//-------------------------------------- Internal classes
-//
-struct Particle;
-class PEngine
-{
-   // Interface for emitters.
-   static const U32  csmBlockSize;
-   Vector<Particle*> mAllocatedBlocks;
-   Particle*         mFreeList;
-
-  public:
-   void updateParticles(Particle* particles, ParticleEmitter &emitter, const U32 ms);
-   void updateSingleParticle(Particle* particle, ParticleEmitter &emitter, const U32 ms);
-
-   Particle* allocateParticle(ParticleEmitter*);
-   void      releaseParticle(Particle*);
-
-  public:
-   PEngine();
-   ~PEngine();
-};
-
-const U32 PEngine::csmBlockSize = 512;
-
 #define MaxParticleSize 50.0f
 
 //--------------------------------------------------------------------------
@@ -726,8 +705,6 @@ ParticleEmitter::ParticleEmitter()
    mDeleteWhenEmpty  = false;
    mDeleteOnTick     = false;
 
-   mParticleListHead = NULL;
-
    mInternalClock    = 0;
    mNextParticleTime = 0;
 
@@ -740,7 +717,9 @@ ParticleEmitter::ParticleEmitter()
 
 ParticleEmitter::~ParticleEmitter()
 {
-   AssertFatal(mParticleListHead == NULL, "Error, particles remain in emitter after remove?");
+   AssertFatal(getParticleCount() == 0, "Error, particles remain in emitter after remove?");
+   for (U32 i = 0; i < mStores.size(); i++)
+      delete mStores[i];
 }
 
 //--------------------------------------------------------------------------
@@ -772,21 +751,9 @@ void ParticleEmitter::onRemove()
 {
    whiteTexture = NULL;
 
-   Particle* pProbe = mParticleListHead;
-
-   if(sgParticleEngine)
-   {
-      while (pProbe != NULL)
-      {
-         Particle* pRemove = pProbe;
-         pProbe = pProbe->nextInList;
-
-         pRemove->nextInList = NULL;
-         sgParticleEngine->releaseParticle(pRemove);
-      }
-   }
-
-   mParticleListHead = NULL;
+   for (U32 i = 0; i < mStores.size(); i++)
+      delete mStores[i];
+   mStores.clear();
 
    if (mSceneManager != NULL)
    {
@@ -821,12 +788,17 @@ bool ParticleEmitter::prepRenderImage(SceneState* state, const U32 stateKey,
    //  don't need to return a specialized RenderImage...
    if (state->isObjectRendered(this))
    {
-      SceneRenderImage* image = new SceneRenderImage;
+      SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
       image->obj = this;
       image->isTranslucent = true;
       image->sortType = SceneRenderImage::Point;
       state->setImageRefPoint(this, image);
 
+      // Emitters can be drawn together if they're in just the one zone,
+      //  the same one, so they have the same projection.
+      if (mZoneRefHead && !mZoneRefHead->nextInObj)
+         image->batchKey = mZoneRefHead->zone + 1;
+
       state->insertRenderImage(image);
    }
 
@@ -834,10 +806,208 @@ bool ParticleEmitter::prepRenderImage(SceneState* state, const U32 stateKey,
 }
 
 
+//--------------------------------------------------------------------------
+//-------------------------------------- Batched rendering
+//
+namespace {
+
+/// Collects the quads of any number of emitters and draws each run that
+/// shares a texture and blend mode with a single call.
+///
+/// The vertices go through a streaming vertex buffer where there is one:
+/// each draw is written after the last, and when the buffer is full it's
+/// given fresh storage and filled from the start again, so the driver never
+/// has to wait for the GPU to finish with what's in flight.
+class ParticleBatch
+{
+   struct Vertex
+   {
+      Point3F point;
+      Point2F texCoord;
+      U8      color[4];
+   };
+
+   enum Constants
+   {
+      MaxQuads         = 4096,         ///< Per draw, to keep the indices 16 bit.
+      StreamBufferSize = 1024 * 1024   ///< Bytes of streaming buffer.
+   };
+
+   static Vector<Vertex> smVerts;
+   static Vector<U16>    smIndices;
+   static U32            smTexture;
+   static bool           smInvAlpha;
+
+   static GLuint         smStreamBuffer;
+   static U32            smStreamOffset;
+   static U32            smStreamGeneration;   ///< smGeneration smStreamBuffer was made in.
+   static U32            smCallbackKey;
+
+   static void textureEvent(const U32 eventCode, void *userData);
+
+  public:
+   static U32            smGeneration;
+
+   /// $pref::Particles::vertexBufferObjects
+   static bool           smUseBufferObjects;
+
+   static void init();
+   static void destroy();
+
+   /// Queues a quad, drawing what's queued first if it's of another
+   /// texture or blend mode.
+   static void addQuad(U32 texture, bool invAlpha, const Point3F *corners, const ColorF &color);
+
+   /// Draws what's queued.
+   static void flush();
+};
+
+Vector<ParticleBatch::Vertex> ParticleBatch::smVerts(__FILE__, __LINE__);
+Vector<U16>    ParticleBatch::smIndices(__FILE__, __LINE__);
+U32            ParticleBatch::smTexture          = 0;
+bool           ParticleBatch::smInvAlpha         = false;
+GLuint         ParticleBatch::smStreamBuffer     = 0;
+U32            ParticleBatch::smStreamOffset     = 0;
+U32            ParticleBatch::smStreamGeneration = 0;
+U32            ParticleBatch::smCallbackKey      = (U32)-1;
+U32            ParticleBatch::smGeneration       = 1;
+bool           ParticleBatch::smUseBufferObjects = true;
+
+/// The corners of every quad, as ParticleEmitter::getParticleQuad() gives them.
+const Point2F sgQuadTexCoords[4] = { Point2F(0.0f, 1.0f), Point2F(1.0f, 1.0f),
+                                     Point2F(1.0f, 0.0f), Point2F(0.0f, 0.0f) };
+
+void ParticleBatch::init()
+{
+   Con::addVariable("$pref::Particles::vertexBufferObjects", TypeBool, &smUseBufferObjects);
+   smCallbackKey = TextureManager::registerEventCallback(textureEvent, NULL);
+
+   // Two triangles a quad.
+   smIndices.setSize(MaxQuads * 6);
+   for (U32 i = 0; i < MaxQuads; i++)
+   {
+      U16* index = &smIndices[i * 6];
+      U16  first = U16(i * 4);
+      index[0] = first;
+      index[1] = first + 1;
+      index[2] = first + 2;
+      index[3] = first;
+      index[4] = first + 2;
+      index[5] = first + 3;
+   }
+   smVerts.reserve(MaxQuads * 4);
+}
+
+void ParticleBatch::destroy()
+{
+   if (smCallbackKey != (U32)-1)
+      TextureManager::unregisterEventCallback(smCallbackKey);
+   smCallbackKey = (U32)-1;
+
+   // The context may already be gone, so the buffer is just forgotten.
+   smGeneration++;
+   smVerts.clear();
+   smVerts.compact();
+   smIndices.clear();
+   smIndices.compact();
+}
+
+void ParticleBatch::textureEvent(const U32 eventCode, void *)
+{
+   // The buffer dies with the context.
+   if (eventCode == TextureManager::BeginZombification)
+      smGeneration++;
+}
+
+void ParticleBatch::addQuad(U32 texture, bool invAlpha, const Point3F *corners, const ColorF &color)
+{
+   if (smVerts.size() && (texture != smTexture || invAlpha != smInvAlpha || smVerts.size() == MaxQuads * 4))
+      flush();
+   smTexture  = texture;
+   smInvAlpha = invAlpha;
+
+   U8 rgba[4];
+   rgba[0] = U8(mClampF(color.red,   0.0f, 1.0f) * 255.0f + 0.5f);
+   rgba[1] = U8(mClampF(color.green, 0.0f, 1.0f) * 255.0f + 0.5f);
+   rgba[2] = U8(mClampF(color.blue,  0.0f, 1.0f) * 255.0f + 0.5f);
+   rgba[3] = U8(mClampF(color.alpha, 0.0f, 1.0f) * 255.0f + 0.5f);
+
+   smVerts.increment(4);
+   Vertex* vert = &smVerts[smVerts.size() - 4];
+   for (U32 i = 0; i < 4; i++)
+   {
+      vert[i].point    = corners[i];
+      vert[i].texCoord = sgQuadTexCoords[i];
+      dMemcpy(vert[i].color, rgba, sizeof(rgba));
+   }
+}
+
+void ParticleBatch::flush()
+{
+   U32 numVerts = smVerts.size();
+   if (numVerts == 0)
+      return;
+
+   PROFILE_START(ParticleBatch_flush);
+
+   glBindTexture(GL_TEXTURE_2D, smTexture);
+   glBlendFunc(GL_SRC_ALPHA, smInvAlpha ? GL_ONE_MINUS_SRC_ALPHA : GL_ONE);
+
+   const U8* base  = (const U8*) smVerts.address();
+   U32       bytes = numVerts * sizeof(Vertex);
+   bool streaming  = smUseBufferObjects && dglDoesSupportVertexBufferObject() && bytes <= StreamBufferSize;
+   if (streaming)
+   {
+      if (smStreamGeneration != smGeneration)
+      {
+         glGenBuffersARB(1, &smStreamBuffer);
+         glBindBufferARB(GL_ARRAY_BUFFER_ARB, smStreamBuffer);
+         glBufferDataARB(GL_ARRAY_BUFFER_ARB, StreamBufferSize, NULL, GL_STREAM_DRAW_ARB);
+         smStreamOffset     = 0;
+         smStreamGeneration = smGeneration;
+      }
+      else
+         glBindBufferARB(GL_ARRAY_BUFFER_ARB, smStreamBuffer);
+
+      if (smStreamOffset + bytes > StreamBufferSize)
+      {
+         // Orphan the old storage, the GPU may still be drawing from it.
+         glBufferDataARB(GL_ARRAY_BUFFER_ARB, StreamBufferSize, NULL, GL_STREAM_DRAW_ARB);
+         smStreamOffset = 0;
+      }
+      glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, smStreamOffset, bytes, base);
+      base = (const U8*) (dsize_t) smStreamOffset;
+      smStreamOffset += bytes;
+   }
+
+   glEnableClientState(GL_VERTEX_ARRAY);
+   glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+   glEnableClientState(GL_COLOR_ARRAY);
+   glVertexPointer(3, GL_FLOAT, sizeof(Vertex), base + Offset(point, Vertex));
+   glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), base + Offset(texCoord, Vertex));
+   glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), base + Offset(color, Vertex));
+
+   glDrawElements(GL_TRIANGLES, numVerts / 4 * 6, GL_UNSIGNED_SHORT, smIndices.address());
+
+   glDisableClientState(GL_COLOR_ARRAY);
+   glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+   glDisableClientState(GL_VERTEX_ARRAY);
+   if (streaming)
+      glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+
+   smVerts.clear();
+
+   PROFILE_END();
+}
+
+} // namespace {}
+
+
 struct SortParticle
 {
-   Particle* p;
-   F32       k;
+   ParticleStore* store;
+   U32            index;
+   F32            k;
 };
 
 int QSORT_CALLBACK cmpSortParticles(const void* p1, const void* p2)
@@ -853,16 +1023,22 @@ int QSORT_CALLBACK cmpSortParticles(const void* p1, const void* p2)
       return -1;
 }
 
-void ParticleEmitter::renderObject(SceneState* state, SceneRenderImage*)
+void ParticleEmitter::renderObject(SceneState* state, SceneRenderImage* image)
 {
-   PROFILE_START(ParticleEmitter_render);
+   renderObjectBatch(state, &image, 1);
+}
+
+void ParticleEmitter::renderObjectBatch(SceneState* state, SceneRenderImage** images, U32 count)
+{
+   PROFILE_GPU_START(ParticleEmitter_render);
 
    AssertFatal(dglIsInCanonicalState(), "Error, GL not in canonical state on entry");
 
    RectI viewport;
    dglGetViewport(&viewport);
 
-   // Uncomment this if this is a "simple" (non-zone managing) object
+   // The emitters of a batch share a zone, and their particles are all in
+   //  world space, so they can all be drawn with the first one's setup.
    glMatrixMode(GL_PROJECTION);
    glPushMatrix();
    state->setupObjectProjection(this);
@@ -874,27 +1050,11 @@ void ParticleEmitter::renderObject(SceneState* state, SceneRenderImage*)
    MatrixF modelview;
    dglGetModelview(&modelview);
 
-   Point3F x, y, viewvec;
-   modelview.getRow(0, &x);
-   modelview.getRow(2, &y);
-   modelview.getRow(1, &viewvec);
-
-   MatrixF camView;
-   modelview.transposeTo( (F32*) &camView );
-
-   // DMMFIX: slow!
-   //
-   static Vector<SortParticle> orderedVector(__FILE__, __LINE__);
-   orderedVector.clear();
-
-   Particle* pProbe = mParticleListHead;
-   while (pProbe)
-   {
-      orderedVector.increment();
-      orderedVector.last().p = pProbe;
-      orderedVector.last().k = mDot(pProbe->pos, viewvec);
-      pProbe = pProbe->nextInList;
-   }
+   RenderView view;
+   modelview.getRow(0, &view.right);
+   modelview.getRow(2, &view.up);
+   modelview.getRow(1, &view.forward);
+   view.camPos = state->getCameraPosition();
 
    glEnable(GL_BLEND);
    glEnable(GL_TEXTURE_2D);
@@ -902,94 +1062,121 @@ void ParticleEmitter::renderObject(SceneState* state, SceneRenderImage*)
    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
    glDepthMask(GL_FALSE);
 
-   const U32   orderedVecSize = orderedVector.size();
-   bool        allowlighting = false;
-   
-   for(U32 i=0; i<orderedVecSize; i++)
-   {
-      if(!orderedVector[i].p->dataBlock->allowLighting)
-	     continue;
-      allowlighting = true;
-	  break;
-   }
+   for (U32 i = 0; i < count; i++)
+      static_cast<ParticleEmitter*>(images[i]->obj)->renderParticles(view);
+   ParticleBatch::flush();
 
-   setupParticleLighting(allowlighting);
+   glDisable(GL_TEXTURE_2D);
+   glDisable(GL_BLEND);
+   glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+   glDepthMask(GL_TRUE);
+
+   glMatrixMode(GL_MODELVIEW);
+   glPopMatrix();
+   glMatrixMode(GL_PROJECTION);
+   glPopMatrix();
+   glMatrixMode(GL_MODELVIEW);
+   dglSetViewport(viewport);
+
+   AssertFatal(dglIsInCanonicalState(), "Error, GL not in canonical state on exit");
+
+   PROFILE_GPU_END();
+}
+
+void ParticleEmitter::renderParticles(const RenderView& view)
+{
+   static Vector<SortParticle> orderedVector(__FILE__, __LINE__);
+   orderedVector.clear();
 
-   Point3F basePoints[4];
-   basePoints[0].set(-1.0f, 0.0f, -1.0f);
-   basePoints[1].set( 1.0f, 0.0f, -1.0f);
-   basePoints[2].set( 1.0f, 0.0f,  1.0f);
-   basePoints[3].set(-1.0f, 0.0f,  1.0f);
+   orderedVector.reserve(getParticleCount());
+   bool allowlighting = false;
+   for (U32 s = 0; s < mStores.size(); s++)
+   {
+      ParticleStore* store = mStores[s];
+      if (store->empty())
+         continue;
+      allowlighting |= store->dataBlock->allowLighting;
+
+      const F32* posX = store->stream(ParticleStore::PosX);
+      const F32* posY = store->stream(ParticleStore::PosY);
+      const F32* posZ = store->stream(ParticleStore::PosZ);
+      for (U32 i = 0; i < store->size(); i++)
+      {
+         orderedVector.increment();
+         orderedVector.last().store = store;
+         orderedVector.last().index = i;
+         orderedVector.last().k = posX[i] * view.forward.x + posY[i] * view.forward.y + posZ[i] * view.forward.z;
+      }
+   }
 
-   const F32 spinFactor = (1.0f/1000.0f) * (1.0f/360.0f) * M_PI_F * 2.0f;
+   const U32 orderedVecSize = orderedVector.size();
+   if (orderedVecSize == 0)
+      return;
 
+   // Lit particles take their color from the texture environment, so they
+   //  are drawn one at a time, after anything batched so far.
+   setupParticleLighting(allowlighting);
    bool prevInvAlpha = false;
-   S32	boundTexture = -1;		// used to limit calls to glBindTexture
+   U32  boundTexture = 0;
+   if (allowLighting)
+   {
+      ParticleBatch::flush();
+      glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+   }
 
+   Particle particle;
    for (U32 i = 0; i < orderedVecSize; i++)
    {
-      const Particle* particle = orderedVector[i].p;
+      orderedVector[i].store->get(orderedVector[i].index, &particle);
+      const ParticleData* data = particle.dataBlock;
+
+      U32 texNum = 0;
+      if (data->animateTexture)
+      {
+         texNum = (U32)(particle.currentAge * (1.0f/1000.0f) * data->framesPerSec);
+         texNum %= data->numFrames;
+      }
+      U32 texture = data->textureList[texNum].getGLName();
+
+      Point3F corners[4];
+      if (!getParticleQuad(particle, view, corners))
+         continue;
+
+      if (!allowLighting)
+      {
+         ParticleBatch::addQuad(texture, data->useInvAlpha, corners, particle.color);
+         continue;
+      }
 
       //  Set our blend mode, where appropriate.
-      if (particle->dataBlock->useInvAlpha != prevInvAlpha)
+      if (data->useInvAlpha != prevInvAlpha)
       {
-         if (particle->dataBlock->useInvAlpha)
+         if (data->useInvAlpha)
             glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
          else
             glBlendFunc(GL_SRC_ALPHA, GL_ONE);
 
-         prevInvAlpha = particle->dataBlock->useInvAlpha;
+         prevInvAlpha = data->useInvAlpha;
       }
 
-      if( particle->dataBlock->animateTexture )
+      if (texture != boundTexture)
       {
-         U32 texNum = (U32)(particle->currentAge * (1.0f/1000.0f) * particle->dataBlock->framesPerSec);
-         texNum %= particle->dataBlock->numFrames;
-	     if ( boundTexture != texNum )
-         {
-            glBindTexture(GL_TEXTURE_2D, particle->dataBlock->textureList[texNum].getGLName());
-			boundTexture = texNum;
-		 }
-      }
-      else
-      {
-	     if ( boundTexture != 0 )
-         {
-			glBindTexture(GL_TEXTURE_2D, particle->dataBlock->textureList[0].getGLName());
-			boundTexture = 0;
-		 }
+         glBindTexture(GL_TEXTURE_2D, texture);
+         boundTexture = texture;
       }
 
-      if( mDataBlock->orientParticles )
-      {
-         renderOrientedParticle( *particle, state->getCameraPosition() );
-      }
-      else
+      lightParticle(particle);
+
+      glBegin(GL_QUADS);
+      for (U32 k = 0; k < 4; k++)
       {
-         renderBillboardParticle( *particle, basePoints, camView, spinFactor );
+         glTexCoord2fv(sgQuadTexCoords[k]);
+         glVertex3fv(corners[k]);
       }
-
+      glEnd();
    }
 
-
    resetParticleLighting();
-
-
-   glDisable(GL_TEXTURE_2D);
-   glDisable(GL_BLEND);
-   glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
-   glDepthMask(GL_TRUE);
-
-   glMatrixMode(GL_MODELVIEW);
-   glPopMatrix();
-   glMatrixMode(GL_PROJECTION);
-   glPopMatrix();
-   glMatrixMode(GL_MODELVIEW);
-   dglSetViewport(viewport);
-
-   AssertFatal(dglIsInCanonicalState(), "Error, GL not in canonical state on exit");
-
-   PROFILE_END();
 }
 
 void ParticleEmitter::setupParticleLighting(bool allowlighting)
@@ -1092,53 +1279,35 @@ void ParticleEmitter::lightParticle(const Particle &part)
 }
 
 //--------------------------------------------------------------------------
-inline void ParticleEmitter::renderBillboardParticle( const Particle &part, const Point3F *basePnts,
-                                                      const MatrixF &camView, const F32 spinFactor )
+bool ParticleEmitter::getParticleQuad(const Particle &part, const RenderView &view, Point3F *corners)
 {
-   lightParticle(part);
-
-   glBegin(GL_QUADS);
+   F32 width = part.size * 0.5f;
 
-      F32 width     = part.size * 0.5f;
+   if (!mDataBlock->orientParticles)
+   {
+      // Facing the camera, spun about the view direction.
+      const F32 spinFactor = (1.0f/1000.0f) * (1.0f/360.0f) * M_PI_F * 2.0f;
       F32 spinAngle = part.spinSpeed * part.currentAge * spinFactor;
 
       F32 sy, cy;
       mSinCos(spinAngle, sy, cy);
-      Point3F points[4];
-
-      for( int i=0; i<4; i++ )
-      {
-         points[i].x = cy * basePnts[i].x - sy * basePnts[i].z;
-         points[i].y = basePnts[i].y;
-         points[i].z = sy * basePnts[i].x + cy * basePnts[i].z;
-         camView.mulP( points[i] );
-         points[i] *= width;
-         points[i] += part.pos;
-      }
-
-      glTexCoord2f(0.0f, 1.0f);
-      glVertex3fv(points[0]);
-      glTexCoord2f(1.0f, 1.0f);
-      glVertex3fv(points[1]);
-      glTexCoord2f(1.0f, 0.0f);
-      glVertex3fv(points[2]);
-      glTexCoord2f(0.0f, 0.0f);
-      glVertex3fv(points[3]);
-
-   glEnd();
-}
+      Point3F right = (view.right * cy + view.up * sy) * width;
+      Point3F up    = (view.up * cy - view.right * sy) * width;
+
+      corners[0] = part.pos - right - up;
+      corners[1] = part.pos + right - up;
+      corners[2] = part.pos + right + up;
+      corners[3] = part.pos - right + up;
+      return true;
+   }
 
-//--------------------------------------------------------------------------
-inline void ParticleEmitter::renderOrientedParticle( const Particle &part, const Point3F &camPos )
-{
    Point3F dir;
-
    if( mDataBlock->orientOnVelocity )
    {
       // don't render oriented particle if it has no velocity
       if( part.vel.magnitudeSafe() == 0.0f )
-	     return;
-		 
+         return false;
+
       dir = part.vel;
    }
    else
@@ -1146,57 +1315,54 @@ inline void ParticleEmitter::renderOrientedParticle( const Particle &part, const
       dir = part.orientDir;
    }
 
-   Point3F dirFromCam = part.pos - camPos;
+   // Facing the camera, stretched along dir.
+   Point3F dirFromCam = part.pos - view.camPos;
    Point3F crossDir;
    mCross( dirFromCam, dir, &crossDir );
    crossDir.normalize();
    dir.normalize();
 
+   dir *= width;
+   crossDir *= width;
+   Point3F start = part.pos - dir;
+   Point3F end = part.pos + dir;
 
-   lightParticle(part);
-
-   glBegin(GL_QUADS);
-
-      F32 width = part.size * 0.5f;
-
-      dir *= width;
-      crossDir *= width;
-      Point3F start = part.pos - dir;
-      Point3F end = part.pos + dir;
-
-
-      glTexCoord2f(0.0f, 0.0f);
-      glVertex3fv( start + crossDir );
-
-      glTexCoord2f(0.0f, 1.0f);
-      glVertex3fv( start - crossDir );
-
-      glTexCoord2f(1.0f, 1.0f);
-      glVertex3fv( end - crossDir );
-
-      glTexCoord2f(1.0f, 0.0f);
-      glVertex3fv( end + crossDir );
-
-   glEnd();
+   corners[0] = start - crossDir;
+   corners[1] = end - crossDir;
+   corners[2] = end + crossDir;
+   corners[3] = start + crossDir;
+   return true;
 }
 
-
 //--------------------------------------------------------------------------
-void ParticleEmitter::stealParticle(Particle* steal)
+ColorF ParticleEmitter::getCollectiveColor()
 {
-   Particle** ppParticle = &mParticleListHead;
-   while (*ppParticle) 
-   {
-      if (*ppParticle == steal) 
-      {
-         *ppParticle = (*ppParticle)->nextInList;
-         steal->nextInList = NULL;
-         return;
-      }
+   U32 count = 0;
+   ColorF color(0.0f, 0.0f, 0.0f);
 
-      ppParticle = &((*ppParticle)->nextInList);
+   for (U32 s = 0; s < mStores.size(); s++)
+   {
+      const ParticleStore* store = mStores[s];
+      const F32* r = store->stream(ParticleStore::ColorR);
+      const F32* g = store->stream(ParticleStore::ColorG);
+      const F32* b = store->stream(ParticleStore::ColorB);
+      const F32* a = store->stream(ParticleStore::ColorA);
+      for (U32 i = 0; i < store->size(); i++)
+         color += ColorF(r[i], g[i], b[i], a[i]);
+      count += store->size();
    }
-   AssertFatal(false, "Trying to steal a particle that doesn't belong to this emitter!");
+
+   if(count > 0)
+      color /= count;
+   return color;
+}
+
+U32 ParticleEmitter::getParticleCount() const
+{
+   U32 count = 0;
+   for (U32 s = 0; s < mStores.size(); s++)
+      count += mStores[s]->size();
+   return count;
 }
 
 //--------------------------------------------------------------------------
@@ -1286,23 +1452,10 @@ void ParticleEmitter::emitParticles(const Point3F& start,
          // Create particle at the correct position
          Point3F pos;
          pos.interpolate(start, end, F32(currTime) / F32(numMilliseconds));
-         addParticle(pos, axis, velocity, axisx);
+         ParticleStore* store = addParticle(pos, axis, velocity, axisx);
          updatedBBox |= updateBBox(pos);
 
-         U32 advanceMS = numMilliseconds - currTime;
-         if (advanceMS > mParticleListHead->totalLifetime) 
-         {
-            // Well, shoot, why did we create this in the first place?
-            Particle* old     = mParticleListHead;
-            mParticleListHead = old->nextInList;
-            old->nextInList   = NULL;
-            sgParticleEngine->releaseParticle(old);
-         } 
-         else 
-         {
-            if (advanceMS != 0)
-               sgParticleEngine->updateSingleParticle(mParticleListHead, *this, advanceMS);
-         }
+         advanceNewParticle(store, numMilliseconds - currTime);
          mNextParticleTime = 0;
       }
    }
@@ -1331,68 +1484,81 @@ void ParticleEmitter::emitParticles(const Point3F& start,
       // Create particle at the correct position
       Point3F pos;
       pos.interpolate(start, end, F32(currTime) / F32(numMilliseconds));
-      addParticle(pos, axis, velocity, axisx);
+      ParticleStore* store = addParticle(pos, axis, velocity, axisx);
       updatedBBox |= updateBBox(pos);
 
-      // NOTE: We are assuming that the just added particle is at the head of our
-      //  list.  If that changes, so must this...
-      U32 advanceMS = numMilliseconds - currTime;
-      if (mDataBlock->overrideAdvance == false && advanceMS != 0) 
-      {
-         if (advanceMS > mParticleListHead->totalLifetime) 
-         {
-            // Well, shoot, why did we create this in the first place?
-            Particle* old     = mParticleListHead;
-            mParticleListHead = old->nextInList;
-            old->nextInList   = NULL;
-            sgParticleEngine->releaseParticle(old);
-         } 
-         else 
-         {
-            if (advanceMS != 0)
-               sgParticleEngine->updateSingleParticle(mParticleListHead, *this, advanceMS);
-         }
-      }
+      if (mDataBlock->overrideAdvance == false)
+         advanceNewParticle(store, numMilliseconds - currTime);
    }
 
    if(updatedBBox)
       mNeedTransformUpdate = true;
 
-   if (mParticleListHead != NULL && mSceneManager == NULL) 
+   addToScene();
+
+   mLastPosition = end;
+   mHasLastPosition = true;
+}
+
+void ParticleEmitter::advanceNewParticle(ParticleStore* store, U32 advanceMS)
+{
+   if (advanceMS == 0)
+      return;
+
+   U32 index = store->size() - 1;
+   if (advanceMS > U32(store->stream(ParticleStore::Lifetime)[index]))
+   {
+      // Well, shoot, why did we create this in the first place?
+      store->pop();
+   }
+   else
+      updateParticles(store, index, index + 1, advanceMS);
+}
+
+void ParticleEmitter::addToScene()
+{
+   if (mSceneManager == NULL && getParticleCount() != 0)
    {
       gClientSceneGraph->addObjectToScene(this);
       gClientContainer.addObject(this);
       gClientProcessList.addObject(this);
    }
-
-   mLastPosition = end;
-   mHasLastPosition = true;
 }
 
 bool ParticleEmitter::updateBBox(const Point3F &position)
 {
    //PROFILE_START(ParticleEmitter_updateBBox);
 
-   // This can be majorly optimized in the future
-   Particle* pProbe = mParticleListHead;
-
-   if (pProbe)
+   bool first = true;
+   for (U32 s = 0; s < mStores.size(); s++)
    {
-      F32 delta = 0.5f;
-      Point3F deltaPoint(delta, delta, delta);
-
-      mObjBox.min.set(pProbe->pos - deltaPoint);
-      mObjBox.max.set(pProbe->pos + deltaPoint);
-
-      pProbe = pProbe->nextInList;
-   }
+      const ParticleStore* store = mStores[s];
+      if (store->empty())
+         continue;
+
+      const F32* posX = store->stream(ParticleStore::PosX);
+      const F32* posY = store->stream(ParticleStore::PosY);
+      const F32* posZ = store->stream(ParticleStore::PosZ);
+      if (first)
+      {
+         F32 delta = 0.5f;
+         Point3F deltaPoint(delta, delta, delta);
+         Point3F pos(posX[0], posY[0], posZ[0]);
 
-   while (pProbe)
-   {
-      mObjBox.min.setMin(pProbe->pos);
-      mObjBox.max.setMax(pProbe->pos);
+         mObjBox.min.set(pos - deltaPoint);
+         mObjBox.max.set(pos + deltaPoint);
+         first = false;
+      }
 
-      pProbe = pProbe->nextInList;
+      for (U32 i = 0; i < store->size(); i++)
+      {
+         mObjBox.min.x = getMin(mObjBox.min.x, posX[i]);
+         mObjBox.min.y = getMin(mObjBox.min.y, posY[i]);
+         mObjBox.min.z = getMin(mObjBox.min.z, posZ[i]);
+         mObjBox.max.x = getMax(mObjBox.max.x, posX[i]);
+         mObjBox.max.y = getMax(mObjBox.max.y, posY[i]);
+         mObjBox.max.z = getMax(mObjBox.max.z, posZ[i]);
+      }
    }
 
    //PROFILE_END();
@@ -1453,12 +1619,7 @@ void ParticleEmitter::emitParticles(const Point3F& rCenter,
    resetWorldBox();
 
    // Make sure we're part of the world
-   if (mParticleListHead != NULL && mSceneManager == NULL) 
-   {
-      gClientSceneGraph->addObjectToScene(this);
-      gClientContainer.addObject(this);
-      gClientProcessList.addObject(this);
-   }
+   addToScene();
    
    mHasLastPosition = false;
 }
@@ -1475,14 +1636,34 @@ void ParticleEmitter::setTransform(const MatrixF & mat)
 }
 
 //--------------------------------------------------------------------------
-void ParticleEmitter::addParticle(const Point3F& pos,
-                                  const Point3F& axis,
-                                  const Point3F& vel,
-                                  const Point3F& axisx)
+ParticleStore* ParticleEmitter::getStore(ParticleData* dataBlock)
 {
-   Particle* pNew    = sgParticleEngine->allocateParticle(this);
-   pNew->nextInList  = mParticleListHead;
-   mParticleListHead = pNew;
+   ParticleStore* store = NULL;
+   for (U32 i = 0; i < mStores.size(); i++)
+   {
+      if (mStores[i]->dataBlock == dataBlock)
+         return mStores[i];
+      if (!store && mStores[i]->empty())
+         store = mStores[i];
+   }
+
+   if (!store)
+   {
+      store = new ParticleStore;
+      mStores.push_back(store);
+   }
+   store->dataBlock = dataBlock;
+   return store;
+}
+
+ParticleStore* ParticleEmitter::addParticle(const Point3F& pos,
+                                            const Point3F& axis,
+                                            const Point3F& vel,
+                                            const Point3F& axisx)
+{
+   Particle  particle;
+   Particle* pNew = &particle;
+   dMemset(pNew, 0, sizeof(Particle));
 
    Point3F ejectionAxis = axis;
    F32 theta = (mDataBlock->thetaMax - mDataBlock->thetaMin) * sgRandom.randF() +
@@ -1514,10 +1695,21 @@ void ParticleEmitter::addParticle(const Point3F& pos,
    // Select a datablock for this particle
    U32 dBlockIndex = (U32)(mCeil(sgRandom.randF() * F32(mDataBlock->particleDataBlocks.size())) - 1);
    mDataBlock->particleDataBlocks[dBlockIndex]->initializeParticle(pNew, vel);
+
+   ParticleStore* store = getStore(pNew->dataBlock);
+   store->add(particle);
+   return store;
 }
 
 
 //--------------------------------------------------------------------------
+// A tick only moves the emitter, which rebins it in the Container, or
+// deletes it.  Otherwise there's nothing to do.
+bool ParticleEmitter::isParallelTickSafe()
+{
+   return !mNeedTransformUpdate && !mDeleteOnTick;
+}
+
 void ParticleEmitter::processTick(const Move*)
 {
    if(mNeedTransformUpdate)
@@ -1541,33 +1733,140 @@ void ParticleEmitter::advanceTime(F32 dt)
    if (numMSToUpdate == 0)
       return;
 
-   Particle** ppProbe = &mParticleListHead;
-   while (*ppProbe != NULL) 
-   {
-      (*ppProbe)->currentAge += numMSToUpdate;
-      
-      if ((*ppProbe)->currentAge >= (*ppProbe)->totalLifetime) 
-      {
-         // Remove this particle
-         Particle* remove   = *ppProbe;
-         *ppProbe           = remove->nextInList;
-         remove->nextInList = NULL;
-         sgParticleEngine->releaseParticle(remove);
-      } 
-      else 
-      {
-         ppProbe = &((*ppProbe)->nextInList);
-      }
-   }
+   for (U32 i = 0; i < mStores.size(); i++)
+      mStores[i]->advanceAge(numMSToUpdate);
 
-   if (mParticleListHead == NULL && mDeleteWhenEmpty) 
+   if (getParticleCount() == 0 && mDeleteWhenEmpty) 
    {
       mDeleteOnTick = true;
    }
    else 
    {
-      if (numMSToUpdate != 0 && mParticleListHead)
-         sgParticleEngine->updateParticles(mParticleListHead, *this, numMSToUpdate);
+      for (U32 i = 0; i < mStores.size(); i++)
+         if (!mStores[i]->empty())
+            updateParticles(mStores[i], 0, mStores[i]->size(), numMSToUpdate);
+   }
+}
+
+//--------------------------------------------------------------------------
+void ParticleEmitter::updateParticles(ParticleStore* store, U32 start, U32 end, const U32 ms)
+{
+   AssertFatal(start < end && end <= store->size(), "ParticleEmitter::updateParticles: Error, bad particle range");
+   AssertFatal(ms != 0, "ParticleEmitter::updateParticles: error, no time to update?");
+
+   const ParticleData* data = store->dataBlock;
+   const F32 dt   = F32(ms) / 1000.0f;
+   const F32 drag = data->dragCoefficient;
+
+   // Wind and gravity push every particle in the store the same way.
+   const Point3F force = Point3F(0.0f, 0.0f, -9.81f) * data->gravityCoefficient -
+                         ParticleEngine::windVelocity * data->windCoefficient;
+
+   // The color and size keys make a piecewise linear function of the
+   // particle's age: the first key, plus each segment's change weighted by
+   // how far through the segment the particle is.  A segment of no length
+   // is a step.
+   enum { NumChannels = 5, NumSegments = 3 };
+   const ColorF* colors = mDataBlock->useEmitterColors ? this->colors : data->colors;
+   const F32*    sizes  = mDataBlock->useEmitterSizes  ? this->sizes  : data->sizes;
+   F32 keys[NumChannels][NumSegments + 1];
+   for (U32 k = 0; k <= NumSegments; k++)
+   {
+      keys[0][k] = colors[k].red;
+      keys[1][k] = colors[k].green;
+      keys[2][k] = colors[k].blue;
+      keys[3][k] = colors[k].alpha;
+      keys[4][k] = sizes[k];
+   }
+   F32 segStart[NumSegments], segScale[NumSegments];
+   for (U32 k = 0; k < NumSegments; k++)
+   {
+      F32 length  = data->times[k + 1] - data->times[k];
+      segStart[k] = data->times[k];
+      segScale[k] = length > 0.0f ? 1.0f / length : 1e30f;
+   }
+
+   F32* posX = store->stream(ParticleStore::PosX);
+   F32* posY = store->stream(ParticleStore::PosY);
+   F32* posZ = store->stream(ParticleStore::PosZ);
+   F32* velX = store->stream(ParticleStore::VelX);
+   F32* velY = store->stream(ParticleStore::VelY);
+   F32* velZ = store->stream(ParticleStore::VelZ);
+   const F32* accX = store->stream(ParticleStore::AccX);
+   const F32* accY = store->stream(ParticleStore::AccY);
+   const F32* accZ = store->stream(ParticleStore::AccZ);
+   const F32* age  = store->stream(ParticleStore::Age);
+   const F32* life = store->stream(ParticleStore::Lifetime);
+   F32* channels[NumChannels];
+   for (U32 c = 0; c < NumChannels; c++)
+      channels[c] = store->stream(ParticleStore::ColorR + c);
+
+   U32 i = start;
+
+#if defined(PARTICLE_ENGINE_USE_SSE)
+   if (sgUseSSE)
+   {
+      const __m128 vdt    = _mm_set1_ps(dt);
+      const __m128 vdrag  = _mm_set1_ps(drag);
+      const __m128 vfx    = _mm_set1_ps(force.x);
+      const __m128 vfy    = _mm_set1_ps(force.y);
+      const __m128 vfz    = _mm_set1_ps(force.z);
+      const __m128 zero   = _mm_setzero_ps();
+      const __m128 one    = _mm_set1_ps(1.0f);
+
+      for (; i + 4 <= end; i += 4)
+      {
+         __m128 vx = _mm_loadu_ps(velX + i);
+         __m128 vy = _mm_loadu_ps(velY + i);
+         __m128 vz = _mm_loadu_ps(velZ + i);
+         vx = _mm_add_ps(vx, _mm_mul_ps(_mm_add_ps(_mm_sub_ps(_mm_loadu_ps(accX + i), _mm_mul_ps(vx, vdrag)), vfx), vdt));
+         vy = _mm_add_ps(vy, _mm_mul_ps(_mm_add_ps(_mm_sub_ps(_mm_loadu_ps(accY + i), _mm_mul_ps(vy, vdrag)), vfy), vdt));
+         vz = _mm_add_ps(vz, _mm_mul_ps(_mm_add_ps(_mm_sub_ps(_mm_loadu_ps(accZ + i), _mm_mul_ps(vz, vdrag)), vfz), vdt));
+         _mm_storeu_ps(velX + i, vx);
+         _mm_storeu_ps(velY + i, vy);
+         _mm_storeu_ps(velZ + i, vz);
+         _mm_storeu_ps(posX + i, _mm_add_ps(_mm_loadu_ps(posX + i), _mm_mul_ps(vx, vdt)));
+         _mm_storeu_ps(posY + i, _mm_add_ps(_mm_loadu_ps(posY + i), _mm_mul_ps(vy, vdt)));
+         _mm_storeu_ps(posZ + i, _mm_add_ps(_mm_loadu_ps(posZ + i), _mm_mul_ps(vz, vdt)));
+
+         __m128 t = _mm_div_ps(_mm_loadu_ps(age + i), _mm_loadu_ps(life + i));
+         __m128 w[NumSegments];
+         for (U32 k = 0; k < NumSegments; k++)
+         {
+            __m128 f = _mm_mul_ps(_mm_sub_ps(t, _mm_set1_ps(segStart[k])), _mm_set1_ps(segScale[k]));
+            w[k] = _mm_min_ps(_mm_max_ps(f, zero), one);
+         }
+         for (U32 c = 0; c < NumChannels; c++)
+         {
+            __m128 value = _mm_set1_ps(keys[c][0]);
+            for (U32 k = 0; k < NumSegments; k++)
+               value = _mm_add_ps(value, _mm_mul_ps(w[k], _mm_set1_ps(keys[c][k + 1] - keys[c][k])));
+            _mm_storeu_ps(channels[c] + i, value);
+         }
+      }
+   }
+#endif
+
+   for (; i < end; i++)
+   {
+      velX[i] += (accX[i] - velX[i] * drag + force.x) * dt;
+      velY[i] += (accY[i] - velY[i] * drag + force.y) * dt;
+      velZ[i] += (accZ[i] - velZ[i] * drag + force.z) * dt;
+      posX[i] += velX[i] * dt;
+      posY[i] += velY[i] * dt;
+      posZ[i] += velZ[i] * dt;
+
+      F32 t = age[i] / life[i];
+      F32 w[NumSegments];
+      for (U32 k = 0; k < NumSegments; k++)
+         w[k] = mClampF((t - segStart[k]) * segScale[k], 0.0f, 1.0f);
+      for (U32 c = 0; c < NumChannels; c++)
+      {
+         F32 value = keys[c][0];
+         for (U32 k = 0; k < NumSegments; k++)
+            value += w[k] * (keys[c][k + 1] - keys[c][k]);
+         channels[c][i] = value;
+      }
    }
 }
 
@@ -1580,140 +1879,142 @@ Point3F windVelocity(0.f, 0.f, 0.f);
 
 void init()
 {
-   AssertFatal(sgParticleEngine == NULL, "ParticleEngine::init: engine already initialized");
+   AssertFatal(!sgParticleEngineInit, "ParticleEngine::init: engine already initialized");
 
-   sgParticleEngine = new PEngine;
+#if defined(PARTICLE_ENGINE_USE_SSE)
+   sgUseSSE = (Platform::SystemInfo.processor.properties & CPU_PROP_SSE) != 0;
+#endif
+   ParticleBatch::init();
+   sgParticleEngineInit = true;
 }
 
 void destroy()
 {
-   AssertFatal(sgParticleEngine != NULL, "ParticleEngine::destroy: engine not initialized");
+   AssertFatal(sgParticleEngineInit, "ParticleEngine::destroy: engine not initialized");
 
-   delete sgParticleEngine;
-   sgParticleEngine = NULL;
+   ParticleBatch::destroy();
+   sgParticleEngineInit = false;
 }
 
 } // namespace ParticleEngine
 
 //--------------------------------------------------------------------------
-PEngine::PEngine()
+ParticleStore::ParticleStore()
 {
-   mFreeList = NULL;
+   dataBlock = NULL;
+   mBlock    = NULL;
+   mCount    = 0;
+   mCapacity = 0;
+   for (U32 s = 0; s < NumStreams; s++)
+      mStreams[s] = NULL;
 }
 
-
-PEngine::~PEngine()
+ParticleStore::~ParticleStore()
 {
-   mFreeList = NULL;
-   for (U32 i = 0; i < mAllocatedBlocks.size(); i++)
-   {
-      delete [] mAllocatedBlocks[i];
-      mAllocatedBlocks[i] = NULL;
-   }
+   dFree(mBlock);
 }
 
-//--------------------------------------------------------------------------
-Particle* PEngine::allocateParticle(ParticleEmitter* emitter)
+void ParticleStore::grow()
 {
-   if (mFreeList == NULL)
+   // All the streams live in one block, each mCapacity floats long.
+   U32 capacity = mCapacity ? mCapacity * 2 : 16;
+   F32* block = (F32*) dMalloc(capacity * NumStreams * sizeof(F32));
+   for (U32 s = 0; s < NumStreams; s++)
    {
-      // Add a new block to the free list...
-      mAllocatedBlocks.push_back(new Particle[csmBlockSize]);
-      Particle* pArray = mAllocatedBlocks.last();
-      for (U32 i = 0; i < csmBlockSize - 1; i++)
-         pArray[i].nextInEngine = &pArray[i + 1];
-      pArray[csmBlockSize - 1].nextInEngine = NULL;
-      mFreeList = &pArray[0];
+      F32* stream = block + s * capacity;
+      if (mCount)
+         dMemcpy(stream, mStreams[s], mCount * sizeof(F32));
+      mStreams[s] = stream;
    }
-   AssertFatal(mFreeList != NULL, "Error, must have a free list here!");
-
-   Particle* pParticle = mFreeList;
-   mFreeList = pParticle->nextInEngine;
-
-   dMemset(pParticle, 0, sizeof(Particle));
-   pParticle->nextInEngine = NULL;
-   pParticle->currentOwner = emitter;
-
-   return pParticle;
+   dFree(mBlock);
+   mBlock    = block;
+   mCapacity = capacity;
 }
 
-void PEngine::releaseParticle(Particle* release)
+void ParticleStore::add(const Particle& part)
 {
-   release->nextInEngine = mFreeList;
-   mFreeList = release;
+   AssertFatal(part.dataBlock == dataBlock, "ParticleStore::add: particle is from another data block");
+   if (mCount == mCapacity)
+      grow();
+
+   U32 i = mCount++;
+   mStreams[PosX][i]     = part.pos.x;
+   mStreams[PosY][i]     = part.pos.y;
+   mStreams[PosZ][i]     = part.pos.z;
+   mStreams[VelX][i]     = part.vel.x;
+   mStreams[VelY][i]     = part.vel.y;
+   mStreams[VelZ][i]     = part.vel.z;
+   mStreams[AccX][i]     = part.acc.x;
+   mStreams[AccY][i]     = part.acc.y;
+   mStreams[AccZ][i]     = part.acc.z;
+   mStreams[DirX][i]     = part.orientDir.x;
+   mStreams[DirY][i]     = part.orientDir.y;
+   mStreams[DirZ][i]     = part.orientDir.z;
+   mStreams[Age][i]      = F32(part.currentAge);
+   mStreams[Lifetime][i] = F32(part.totalLifetime);
+   mStreams[ColorR][i]   = part.color.red;
+   mStreams[ColorG][i]   = part.color.green;
+   mStreams[ColorB][i]   = part.color.blue;
+   mStreams[ColorA][i]   = part.color.alpha;
+   mStreams[Size][i]     = part.size;
+   mStreams[Spin][i]     = part.spinSpeed;
 }
 
-
-//--------------------------------------------------------------------------
-void PEngine::updateParticles(Particle* particles, ParticleEmitter &emitter, const U32 ms)
+void ParticleStore::get(U32 i, Particle* part) const
 {
-   AssertFatal(particles != NULL, "PEngine::updateParticles: Error, must have particles to process in this function");
-   AssertFatal(ms != 0, "PEngine::updateParticles: error, no time to update?");
-
-   Particle* pProbe = particles;
-   while (pProbe != NULL) 
-   {
-      updateSingleParticle(pProbe, emitter, ms);
-      pProbe = pProbe->nextInList;
-   }
+   AssertFatal(i < mCount, "ParticleStore::get: index out of range");
+   part->pos.set(mStreams[PosX][i], mStreams[PosY][i], mStreams[PosZ][i]);
+   part->vel.set(mStreams[VelX][i], mStreams[VelY][i], mStreams[VelZ][i]);
+   part->acc.set(mStreams[AccX][i], mStreams[AccY][i], mStreams[AccZ][i]);
+   part->orientDir.set(mStreams[DirX][i], mStreams[DirY][i], mStreams[DirZ][i]);
+   part->currentAge    = U32(mStreams[Age][i]);
+   part->totalLifetime = U32(mStreams[Lifetime][i]);
+   part->dataBlock     = dataBlock;
+   part->color.set(mStreams[ColorR][i], mStreams[ColorG][i], mStreams[ColorB][i], mStreams[ColorA][i]);
+   part->size          = mStreams[Size][i];
+   part->spinSpeed     = mStreams[Spin][i];
 }
 
-void PEngine::updateSingleParticle(Particle* particle, ParticleEmitter &emitter, const U32 ms)
+void ParticleStore::advanceAge(U32 ms)
 {
-   AssertFatal(particle != NULL, "PEngine::updateSingleParticle: Error, must have a particle to process in this function");
-   AssertFatal(ms != 0, "PEngine::updateSingleParticle: error, no time to update?");
-
-   F32 t = F32(ms) / 1000.0f;
+   F32* age      = mStreams[Age];
+   F32* lifetime = mStreams[Lifetime];
+   const F32 delta = F32(ms);
 
-   Point3F a = particle->acc;
-   a -= particle->vel        * particle->dataBlock->dragCoefficient;
-   a -= ParticleEngine::windVelocity * particle->dataBlock->windCoefficient;
-   a += Point3F(0.0f, 0.0f, -9.81f) * particle->dataBlock->gravityCoefficient;
-
-   particle->vel += a * t;
-   particle->pos += particle->vel * t;
-
-   // Now update the particle's color
-   t = F32(particle->currentAge) / F32(particle->totalLifetime);
-   AssertFatal(t <= 1.0f, "Out out bounds filter function for particle.");
-
-   for (U32 i = 1; i < 4; i++) 
+   U32 firstDead = mCount;
+   for (U32 i = 0; i < mCount; i++)
    {
-      if (particle->dataBlock->times[i] >= t) 
-      {
-         F32 firstPart = t - particle->dataBlock->times[i-1];
-         F32 total     = particle->dataBlock->times[i] -
-                         particle->dataBlock->times[i-1];
-
-         firstPart /= total;
-
-         if( emitter.getDataBlock()->useEmitterColors )
-         {
-            particle->color.interpolate(emitter.colors[i-1], emitter.colors[i], firstPart);
-         }
-         else
-         {
-            particle->color.interpolate(particle->dataBlock->colors[i-1],
-                                        particle->dataBlock->colors[i],
-                                        firstPart);
-         }
+      age[i] += delta;
+      if (age[i] >= lifetime[i] && firstDead == mCount)
+         firstDead = i;
+   }
+   if (firstDead == mCount)
+      return;
 
-         if( emitter.getDataBlock()->useEmitterSizes )
-         {
-            particle->size = (emitter.sizes[i-1] * (1.0f - firstPart)) +
-                             (emitter.sizes[i]   * firstPart);
-         }
-         else
-         {
-            particle->size = (particle->dataBlock->sizes[i-1] * (1.0f - firstPart)) +
-                             (particle->dataBlock->sizes[i]   * firstPart);
-         }
+   // Compact each stream past the first dead particle, leaving the age
+   // and lifetime streams, which say who lives, until last.
+   U32 live = firstDead;
+   for (U32 s = 0; s < NumStreams; s++)
+   {
+      if (s == Age || s == Lifetime)
+         continue;
+
+      F32* data = mStreams[s];
+      live = firstDead;
+      for (U32 i = firstDead; i < mCount; i++)
+         if (age[i] < lifetime[i])
+            data[live++] = data[i];
+   }
 
-         return;
+   live = firstDead;
+   for (U32 i = firstDead; i < mCount; i++)
+      if (age[i] < lifetime[i])
+      {
+         age[live]      = age[i];
+         lifetime[live] = lifetime[i];
+         live++;
       }
-   }
-   particle->color = particle->dataBlock->colors[ParticleEngine::PC_COLOR_KEYS - 1];
-   particle->size  = particle->dataBlock->sizes[ParticleEngine::PC_SIZE_KEYS - 1];
+   mCount = live;
 }
 
 
@@ -23,7 +23,7 @@ namespace ParticleEngine {
       PC_SIZE_KEYS = 4,
    };
 
-   /// Initalize the particle engine
+   /// Initalize the particle engine, and pick the particle update for the CPU
    void init();
 
    /// Destroy the particle engine
@@ -109,6 +109,10 @@ class ParticleData : public SimDataBlock
    static void  initPersistFields();
 };
 
+/// A single particle, as it's set up and rendered.
+///
+/// Emitters don't keep their particles like this; it's only a view of one
+/// particle of a ParticleStore.
 struct Particle
 {
    Point3F  pos;     // current instantaneous position
@@ -120,16 +124,67 @@ struct Particle
    ParticleData* dataBlock;       // datablock that contains global parameters for
                                   //  this instance
 
-   Particle* nextInList;   // Managed by the current owning emitter
    U32       currentAge;
 
-   Particle*        nextInEngine; // Managed by the global engine object
-   ParticleEmitter* currentOwner;
    ColorF           color;
    F32              size;
    F32              spinSpeed;
 };
 
+/// The particles of an emitter that share a ParticleData.
+///
+/// The particles are kept as a structure of arrays, one stream of floats
+/// per component, so ParticleEmitter::updateParticles() runs down each
+/// stream four particles at a time, and dead particles are compacted out
+/// of the streams rather than unlinked from a list.  Ages and lifetimes
+/// are whole milliseconds, which floats hold exactly.
+class ParticleStore
+{
+  public:
+   enum Streams
+   {
+      PosX, PosY, PosZ,
+      VelX, VelY, VelZ,
+      AccX, AccY, AccZ,
+      DirX, DirY, DirZ,
+      Age, Lifetime,
+      ColorR, ColorG, ColorB, ColorA,
+      Size, Spin,
+      NumStreams
+   };
+
+   ParticleData* dataBlock;   ///< Of every particle in the store
+
+   ParticleStore();
+   ~ParticleStore();
+
+   U32  size() const          { return mCount; }
+   bool empty() const         { return mCount == 0; }
+
+   F32*       stream(U32 s)         { return mStreams[s]; }
+   const F32* stream(U32 s) const   { return mStreams[s]; }
+
+   /// Appends a particle, which becomes particle size() - 1.
+   void add(const Particle& part);
+   /// Unpacks particle index.
+   void get(U32 index, Particle* part) const;
+   /// Drops the last particle.
+   void pop()                 { mCount--; }
+   void clear()               { mCount = 0; }
+
+   /// Ages every particle by ms, and compacts out the ones whose lifetime
+   /// is up, keeping the rest in order.
+   void advanceAge(U32 ms);
+
+  private:
+   F32* mBlock;
+   U32  mCount;
+   U32  mCapacity;
+   F32* mStreams[NumStreams];
+
+   void grow();
+};
+
 
 //--------------------------------------
 class ParticleEmitterData : public GameBaseData 
@@ -183,7 +238,6 @@ DECLARE_CONSOLETYPE(ParticleEmitterData)
 class ParticleEmitter : public GameBase
 {
    typedef GameBase Parent;
-   friend class PEngine;
 
   public:
    ParticleEmitter();
@@ -195,23 +249,12 @@ class ParticleEmitter : public GameBase
    void setupParticleLighting(bool allowlighting);
    void resetParticleLighting();
    void lightParticle(const Particle &part);
-   ColorF getCollectiveColor()
-   {
-	   U32 count = 0;
-	   ColorF color(0.0f, 0.0f, 0.0f);
-	   Particle *particle = mParticleListHead;
-
-	   while(particle)
-	   {
-		   color += particle->color;
-		   particle = particle->nextInList;
-		   count++;
-	   }
-
-	   if(count > 0)
-		   color /= count;
-	   return color;
-   }
+
+   /// The average color of the particles
+   ColorF getCollectiveColor();
+
+   /// Number of live particles
+   U32 getParticleCount() const;
 
    /// Sets sizes of particles based on sizelist provided
    /// @param   sizeList   List of sizes
@@ -267,20 +310,45 @@ class ParticleEmitter : public GameBase
    /// @param   axis
    /// @param   vel   Initial velocity
    /// @param   axisx
-   void addParticle(const Point3F &pos, const Point3F &axis, const Point3F &vel, const Point3F &axisx);
+   /// @returns The store the particle was added to, as its last particle
+   ParticleStore* addParticle(const Point3F &pos, const Point3F &axis, const Point3F &vel, const Point3F &axisx);
 
-   /// Renders a particle facing the camera with a spin factor
-   /// @param   part   Particle
-   /// @param   basePnts   Base points for the quad the particle is rendered on
-   /// @param   camView   Camera view matrix
-   /// @param   spinFactor   0.0-1.0 modifyer for
-   void renderBillboardParticle( const Particle &part, const Point3F *basePnts, const MatrixF &camView, const F32 spinFactor );
+   /// Returns the store for particles of a data block, reusing an empty
+   /// store if there's none for it yet.
+   ParticleStore* getStore(ParticleData* dataBlock);
+
+   /// Moves and recolors particles [start, end) of a store by ms
+   void updateParticles(ParticleStore* store, U32 start, U32 end, U32 ms);
+
+   /// Advances the particle just emitted into a store by advanceMS, the
+   /// rest of the update, dropping it if it would already be dead.
+   void advanceNewParticle(ParticleStore* store, U32 advanceMS);
 
-   /// Renders a particle which will face the camera but spin itself to look
-   /// like it is facing a particular velocity.
+   /// Adds the emitter to the scene, once it has particles
+   void addToScene();
+
+   /// The camera, as the particles are drawn
+   struct RenderView
+   {
+      Point3F right;       ///< Camera axes in world space
+      Point3F up;
+      Point3F forward;
+      Point3F camPos;
+   };
+
+   /// Works out the corners of the quad a particle is drawn on: facing the
+   /// camera, and either spun by the particle's spin or, for oriented
+   /// particles, stretched along its velocity or direction.  The corners
+   /// go with the texture coordinates (0,1) (1,1) (1,0) (0,0).
    /// @param   part   Particle
-   /// @param   camPos   Camera position
-   void renderOrientedParticle( const Particle &part, const Point3F &camPos );
+   /// @param   view   Camera
+   /// @param   corners   Returns the four corners
+   /// @returns false if the particle shouldn't be drawn
+   bool getParticleQuad( const Particle &part, const RenderView &view, Point3F *corners );
+
+   /// Draws the particles back to front: into the shared batch, or one at
+   /// a time when they're lit.
+   void renderParticles( const RenderView &view );
 
    /// Updates the bounding box for the particle system
    bool updateBBox(const Point3F &position);
@@ -291,6 +359,7 @@ class ParticleEmitter : public GameBase
    void onRemove();
 
    void processTick(const Move *move);
+   bool isParallelTickSafe();
    void advanceTime(F32 dt);
 
    // Rendering
@@ -298,12 +367,10 @@ class ParticleEmitter : public GameBase
    bool prepRenderImage(SceneState *state, const U32 stateKey, const U32 startZone, const bool modifyBaseZoneState);
    void renderObject(SceneState *state, SceneRenderImage *image);
 
-   // PEngine interface
-  private:
-   /// Removes the provided particle from the system and lets the caller of the
-   /// function assume control of it
-   /// @param   part   Particle
-   void stealParticle(Particle *part);
+   /// Draws emitters that are next to each other in the depth sort together,
+   /// so runs of particles with the same texture and blend mode, from any of
+   /// them, go in one draw call.
+   void renderObjectBatch(SceneState *state, SceneRenderImage **images, U32 count);
 
   private:
    ParticleEmitterData* mDataBlock;
@@ -312,7 +379,8 @@ class ParticleEmitter : public GameBase
    /// on ticks, to minimize calls to setTransform.
    bool      mNeedTransformUpdate;
 
-   Particle* mParticleListHead;
+   /// A store for each particle data block in use
+   Vector<ParticleStore*> mStores;
 
    U32       mInternalClock;
 
@@ -26,6 +26,9 @@ const U32   Precipitation::csmDropsPerSide = 4;                  ///< How many d
 const F32   Precipitation::csmDropsPerSideF = csmDropsPerSide;   ///< How many drops are on a side of the material texture
 const U32   Precipitation::csmFramesPerSide = 2;                 ///< How many frames are on a side of a splash animation
 const F32   Precipitation::csmFramesPerSideF = csmFramesPerSide; ///< How many frames are on a side of a splash animation
+const F32   Precipitation::csmNoCutoff = -1e6f;                  ///< Cutoff where there's nothing to hit
+
+S32 Precipitation::smRaysPerTick = 64;
 
 IMPLEMENT_CO_NETOBJECT_V1(Precipitation);
 IMPLEMENT_CO_DATABLOCK_V1(PrecipitationData);
@@ -117,8 +120,9 @@ Precipitation::Precipitation()
    mTypeMask |= ProjectileObjectType;
    mNetFlags.set(Ghostable|ScopeAlways);
 
-   mDropHead = NULL;
-   mSplashHead = NULL;
+   mHeightCells = NULL;
+   mCellSize = 0.0f;
+   mRefreshCursor = 0;
    mNumDrops = 5000;
    mPercentage = 1.0f;
 
@@ -211,6 +215,12 @@ Precipitation::~Precipitation()
    // Cleanup our buffers
    delete [] texCoords;
    delete [] splashCoords;
+   delete [] mHeightCells;
+}
+
+void Precipitation::consoleInit()
+{
+   Con::addVariable("$pref::precipitationRaysPerTick", TypeS32, &smRaysPerTick);
 }
 
 void Precipitation::inspectPostApply()
@@ -412,226 +422,226 @@ void Precipitation::fillDropList()
 
    F32 density = Con::getFloatVariable("$pref::precipitationDensity", 1.0f);
    U32 newDropCount = (U32)(mNumDrops * mPercentage * density);
-   U32 dropCount = 0;
-   if (mDropHead)
-   {
-      Raindrop* curr = mDropHead;
-      while (curr)
-      {
-         dropCount++;
-         curr = curr->next;
-         if (dropCount == newDropCount && curr)
-         {
-            //delete the remaining drops
-            Raindrop* next = curr->next;
-            curr->next = NULL;
-            while (next)
-            {
-               Raindrop* last = next;
-               next = next->next;
-               last->next = NULL;
-               destroySplash(last);
-               delete last;
-            }
-            break;
-         }
-      }
-   }
+   U32 dropCount = mDropPos.size();
+   if (newDropCount == dropCount)
+      return;
 
-   if (dropCount < newDropCount)
-   {
-      //move to the end
-      Raindrop* curr = mDropHead;
-      if (curr)
-      {
-         while (curr->next)
-            curr = curr->next;
-      }
-      else
-      {
-         mDropHead = curr = new Raindrop;
-         spawnNewDrop(curr);
-         dropCount++;
-      }
+   mDropPos.setSize(newDropCount);
+   mDropRenderPos.setSize(newDropCount);
+   mDropVelocity.setSize(newDropCount);
+   mDropMass.setSize(newDropCount);
+   mDropTime.setSize(newDropCount);
+   mDropTexIndex.setSize(newDropCount);
+   mDropFlags.setSize(newDropCount);
 
-      //and add onto it
-      while (dropCount < newDropCount)
-      {
-         curr->next = new Raindrop;
-         curr = curr->next;
-         spawnNewDrop(curr);
-         dropCount++;
-      }
-   }
+   for (U32 i = dropCount; i < newDropCount; i++)
+      spawnNewDrop(i);
 }
 
 void Precipitation::killDropList()
 {
    AssertFatal(isClientObject(), "Precipitation is doing stuff on the server - BAD!");
 
-   Raindrop* curr = mDropHead;
-   while (curr)
-   {
-      Raindrop* next = curr->next;
-      delete curr;
-      curr = next;
-   }
-   mDropHead = NULL;
+   mDropPos.clear();
+   mDropRenderPos.clear();
+   mDropVelocity.clear();
+   mDropMass.clear();
+   mDropTime.clear();
+   mDropTexIndex.clear();
+   mDropFlags.clear();
+   mSplashes.clear();
 }
 
-void Precipitation::spawnDrop(Raindrop *drop)
+void Precipitation::spawnDrop(U32 i)
 {
-   PROFILE_START(PrecipSpawnDrop);
    AssertFatal(isClientObject(), "Precipitation is doing stuff on the server - BAD!");
 
-   drop->velocity = Platform::getRandom() * (mMaxSpeed - mMinSpeed) + mMinSpeed;
+   mDropVelocity[i] = Platform::getRandom() * (mMaxSpeed - mMinSpeed) + mMinSpeed;
 
-   drop->position.x = Platform::getRandom() * mBoxWidth - (mBoxWidth / 2.0f);
-   drop->position.y = Platform::getRandom() * mBoxWidth - (mBoxWidth / 2.0f);
+   mDropPos[i].x = Platform::getRandom() * mBoxWidth - (mBoxWidth / 2.0f);
+   mDropPos[i].y = Platform::getRandom() * mBoxWidth - (mBoxWidth / 2.0f);
 
-   drop->texCoordIndex = (U32)(Platform::getRandom() * (csmDropsPerSideF*csmDropsPerSideF - 0.5f));
-   drop->valid = true;
-   drop->time = Platform::getRandom() * M_2PI_F;
-   drop->mass = Platform::getRandom() * (mMaxMass - mMinMass) + mMinMass;
-   PROFILE_END();
-}
-
-void Precipitation::spawnNewDrop(Raindrop *drop)
-{
-   AssertFatal(isClientObject(), "Precipitation is doing stuff on the server - BAD!");
-
-   spawnDrop(drop);
-   drop->position.z = Platform::getRandom() * mBoxHeight - (mBoxHeight / 2.0f);
+   mDropTexIndex[i] = (U8)(Platform::getRandom() * (csmDropsPerSideF*csmDropsPerSideF - 0.5f));
+   mDropFlags[i] = DropValid;
+   mDropTime[i] = Platform::getRandom() * M_2PI_F;
+   mDropMass[i] = Platform::getRandom() * (mMaxMass - mMinMass) + mMinMass;
 }
 
-void Precipitation::findDropCutoff(Raindrop *drop)
+void Precipitation::spawnNewDrop(U32 i)
 {
-   PROFILE_START(PrecipFindDropCutoff);
    AssertFatal(isClientObject(), "Precipitation is doing stuff on the server - BAD!");
 
-   if (mDoCollision)
-   {
-      VectorF velocity = getWindVelocity() / drop->mass - VectorF(0.0f, 0.0f, drop->velocity);
-      velocity.normalize();
-
-      Point3F end   = drop->position + 100.0f * velocity;
-      Point3F start = drop->position - 500.0f * velocity;
-
-      RayInfo rInfo;
-      if (getContainer()->castRay(start, end, dropHitMask, &rInfo))
-      {
-         drop->hitPos = rInfo.point;
-         drop->hitType = rInfo.object->getTypeMask();
-      }
-      else
-         drop->hitPos.set(0.0f,0.0f,-1000.0f);
-
-      drop->valid = drop->position.z > drop->hitPos.z;
-   }
-   else
-   {
-      drop->hitPos.set(0.0f,0.0f,-1000.0f);
-      drop->valid = true;
-   }
-   PROFILE_END();
+   spawnDrop(i);
+   mDropPos[i].z = Platform::getRandom() * mBoxHeight - (mBoxHeight / 2.0f);
+   mDropRenderPos[i] = mDropPos[i];
 }
 
-inline void Precipitation::wrapDrop(Raindrop *drop, Box3F &box)
+inline bool Precipitation::wrapDrop(U32 i, const Box3F &box)
 {
-   bool recalcCutoff = false;
+   bool wrapped = false;
 
    const Point3F	&boxMin = box.min;
    const Point3F	&boxMax = box.max;
-   Point3F			&position = drop->position;
-   
+   Point3F			&position = mDropPos[i];
+
    if (position.x < boxMin.x)
-   {		
+   {
       position.x = boxMin.x + (mBoxWidth - mFmod( (boxMin.x - position.x), mBoxWidth ) );
-	  
-      recalcCutoff = true;
+      wrapped = true;
    }
    else if (position.x > boxMax.x)
    {
       position.x = boxMax.x - (mBoxWidth - mFmod( (position.x - boxMin.x), mBoxWidth ) );
-	  
-      recalcCutoff = true;
+      wrapped = true;
    }
 
    if (position.y < boxMin.y)
    {
       position.y = boxMin.y + (mBoxWidth - mFmod( (boxMin.y - position.y), mBoxWidth ) );
-	  
-      recalcCutoff = true;
+      wrapped = true;
    }
    else if (position.y > boxMax.y)
    {
       position.y = boxMax.y - (mBoxWidth - mFmod( (position.y - boxMin.y), mBoxWidth ) );
-	  
-      recalcCutoff = true;
+      wrapped = true;
    }
 
    if (position.z < boxMin.z)
    {
-      spawnDrop(drop);
-	  
+      spawnDrop(i);
+
       position.x += boxMin.x;
       position.y += boxMin.y;
-	  
-      position.z = boxMin.z + (mBoxHeight - mFmod( (boxMin.z - position.z), mBoxHeight ) );
 
-      recalcCutoff = true;
+      position.z = boxMin.z + (mBoxHeight - mFmod( (boxMin.z - position.z), mBoxHeight ) );
+      wrapped = true;
    }
    else if (position.z > boxMax.z)
    {
       position.z = boxMax.z - (mBoxHeight - mFmod( (position.z - boxMin.z), mBoxHeight ) );
-	  
-      recalcCutoff = true;
+      wrapped = true;
    }
-   
-   if (recalcCutoff)
-      findDropCutoff(drop);
+
+   return wrapped;
+}
+
+//--------------------------------------------------------------------------
+// Height cache
+//--------------------------------------------------------------------------
+void Precipitation::resetHeightCache()
+{
+   if (!mHeightCells)
+      mHeightCells = new HeightCell[HeightCacheSize * HeightCacheSize];
+   for (U32 i = 0; i < HeightCacheSize * HeightCacheSize; i++)
+      mHeightCells[i].valid = false;
+   mRefreshCursor = 0;
+}
+
+void Precipitation::castHeightCell(HeightCell &cell, S32 x, S32 y, F32 top, F32 bottom)
+{
+   Point3F start((x + 0.5f) * mCellSize, (y + 0.5f) * mCellSize, top);
+   Point3F end(start.x, start.y, bottom);
+
+   RayInfo rInfo;
+   if (getContainer()->castRay(start, end, dropHitMask, &rInfo))
+      cell.z = rInfo.point.z;
+   else
+      cell.z = csmNoCutoff;
+   cell.x = x;
+   cell.y = y;
+   cell.valid = true;
 }
 
-void Precipitation::createSplash(Raindrop *drop)
+void Precipitation::updateHeightCache(const Box3F &box)
 {
-   PROFILE_START(PrecipCreateSplash);
-   if (drop != mSplashHead && !(drop->nextSplashDrop || drop->prevSplashDrop))
+   if (!mDoCollision)
+      return;
+
+   PROFILE_START(PrecipHeightCache);
+
+   F32 cellSize = mBoxWidth / HeightCacheSpan;
+   if (!mHeightCells || cellSize != mCellSize)
    {
-      if (!mSplashHead)
-      {
-         mSplashHead = drop;
-         drop->prevSplashDrop = NULL;
-         drop->nextSplashDrop = NULL;
-      }
-      else
+      mCellSize = cellSize;
+      resetHeightCache();
+   }
+
+   // Cast from well above the box, so drops under a roof stop at it.
+   const F32 top    = box.max.z + 500.0f;
+   const F32 bottom = box.min.z - 100.0f;
+
+   const S32 x0 = (S32) mFloor(box.min.x / mCellSize);
+   const S32 y0 = (S32) mFloor(box.min.y / mCellSize);
+   const S32 x1 = (S32) mFloor(box.max.x / mCellSize);
+   const S32 y1 = (S32) mFloor(box.max.y / mCellSize);
+   const U32 mask = HeightCacheSize - 1;
+
+   // The box's cells we don't have, center first, so the rain near the
+   // camera lands soonest.
+   S32 budget = getMax(smRaysPerTick, 1);
+   const S32 cx = (x0 + x1) >> 1;
+   const S32 cy = (y0 + y1) >> 1;
+   const S32 rings = getMax(x1 - x0, y1 - y0) / 2 + 1;
+   for (S32 r = 0; r <= rings && budget > 0; r++)
+   {
+      for (S32 y = cy - r; y <= cy + r && budget > 0; y++)
       {
-         mSplashHead->prevSplashDrop = drop;
-         drop->nextSplashDrop = mSplashHead;
-         drop->prevSplashDrop = NULL;
-         mSplashHead = drop;
+         if (y < y0 || y > y1)
+            continue;
+
+         // Just the ring's edge: every cell on the top and bottom rows,
+         // the two ends of the rest.
+         S32 step = (y == cy - r || y == cy + r) ? 1 : getMax(2 * r, 1);
+         for (S32 x = cx - r; x <= cx + r && budget > 0; x += step)
+         {
+            if (x < x0 || x > x1)
+               continue;
+
+            HeightCell &cell = mHeightCells[((y & mask) * HeightCacheSize) + (x & mask)];
+            if (cell.valid && cell.x == x && cell.y == y)
+               continue;
+
+            castHeightCell(cell, x, y, top, bottom);
+            budget--;
+         }
       }
    }
 
-   drop->animStartTime = Platform::getVirtualMilliseconds();
+   // Then recast the ones we do have, in turn, to pick up things that
+   // have come and gone.
+   for (U32 n = 0; n < HeightCacheSize * HeightCacheSize && budget > 0; n++)
+   {
+      HeightCell &cell = mHeightCells[mRefreshCursor];
+      mRefreshCursor = (mRefreshCursor + 1) % (HeightCacheSize * HeightCacheSize);
+      if (!cell.valid || cell.x < x0 || cell.x > x1 || cell.y < y0 || cell.y > y1)
+         continue;
+
+      castHeightCell(cell, cell.x, cell.y, top, bottom);
+      budget--;
+   }
+
    PROFILE_END();
 }
 
-void Precipitation::destroySplash(Raindrop *drop)
+F32 Precipitation::getDropCutoff(const Point3F &pos)
 {
-   PROFILE_START(PrecipDestroySplash);
-
-   if (drop->nextSplashDrop)
-      drop->nextSplashDrop->prevSplashDrop = drop->prevSplashDrop;
-   if (drop->prevSplashDrop)
-      drop->prevSplashDrop->nextSplashDrop = drop->nextSplashDrop;
-
-   drop->nextSplashDrop = NULL;
-   drop->prevSplashDrop = NULL;
-
-   if (drop == mSplashHead)
-      mSplashHead = NULL;
+   if (!mDoCollision || !mHeightCells)
+      return csmNoCutoff;
+
+   const S32 x = (S32) mFloor(pos.x / mCellSize);
+   const S32 y = (S32) mFloor(pos.y / mCellSize);
+   const U32 mask = HeightCacheSize - 1;
+   const HeightCell &cell = mHeightCells[((y & mask) * HeightCacheSize) + (x & mask)];
+   return (cell.valid && cell.x == x && cell.y == y) ? cell.z : csmNoCutoff;
+}
 
-   PROFILE_END();
+void Precipitation::createSplash(const Point3F &pos)
+{
+   mSplashes.increment();
+   Splash &splash = mSplashes.last();
+   splash.pos = pos;
+   splash.startTime = Platform::getVirtualMilliseconds();
+   splash.frame = 0;
 }
 
 //--------------------------------------------------------------------------
@@ -669,33 +679,24 @@ void Precipitation::interpolateTick(F32 delta)
    const F32		dt = 1.0f-delta;
    const VectorF	startTurbulence = dt * getWindVelocity();
    const F32		dtTurbulenceSpeed = dt * mTurbulenceSpeed;
-   
-   register Raindrop* curr = mDropHead;
 
-   while (curr)
+   const U32 count = mDropPos.size();
+   for (U32 i = 0; i < count; i++)
    {
-      if (!curr->toRender)
-      {
-         curr = curr->next;
+      if (!(mDropFlags[i] & DropRender))
          continue;
-      }
 
+      Point3F &renderPos = mDropRenderPos[i];
       if (mUseTurbulence)
       {
-         F32 renderTime = curr->time + dtTurbulenceSpeed;
-         
-		 VectorF	turbulence = startTurbulence + VectorF(mSin(renderTime), mCos(renderTime), 0.0f) * mMaxTurbulence;
-         
-		 curr->renderPosition = curr->position + turbulence / curr->mass;
+         F32 renderTime = mDropTime[i] + dtTurbulenceSpeed;
+         VectorF turbulence = startTurbulence + VectorF(mSin(renderTime), mCos(renderTime), 0.0f) * mMaxTurbulence;
+         renderPos = mDropPos[i] + turbulence / mDropMass[i];
       }
-	  else
-      {
-		curr->renderPosition = curr->position + startTurbulence / curr->mass;
-	  }
-
-      curr->renderPosition.z -= dt * curr->velocity;
+      else
+         renderPos = mDropPos[i] + startTurbulence / mDropMass[i];
 
-      curr = curr->next;
+      renderPos.z -= dt * mDropVelocity[i];
    }
    PROFILE_END();
 }
@@ -754,62 +755,62 @@ void Precipitation::processTick(const Move *)
    const VectorF windVel = getWindVelocity();
    const F32 fovDot = camObj->getCameraFov() * (1.0f / 180.0f);
    const bool	useFunkyEffectThingy = (mSplashHandle.getGLName() != 0);
-   Raindrop* curr = mDropHead;
 
-   while (curr)
+   updateHeightCache(box);
+
+   const U32 count = mDropPos.size();
+   for (U32 i = 0; i < count; i++)
    {
       //update position
       if (mUseTurbulence)
-         curr->time += mTurbulenceSpeed;
-      curr->position += windVel / curr->mass;
-      curr->position.z -= curr->velocity;
+         mDropTime[i] += mTurbulenceSpeed;
+      Point3F &pos = mDropPos[i];
+      pos += windVel / mDropMass[i];
+      pos.z -= mDropVelocity[i];
 
-      //wrap position
-      wrapDrop(curr, box);
+      //wrap position, a drop that moved starts again from wherever it is now
+      bool wrapped = wrapDrop(i, box);
+      U8 flags = mDropFlags[i];
+      F32 cutoff = getDropCutoff(pos);
 
-      if (curr->valid && (curr->position.z < curr->hitPos.z))
+      if (wrapped)
       {
-		curr->valid = false;
-
-		// Bump back so we don't spawn splashes where they ought not
-		// be. It might be better to revisit this and use the hitPos.
-		curr->position -= windVel / curr->mass;
-		curr->position.z += curr->velocity;
+         if (pos.z > cutoff)
+            flags |= DropValid;
+         else
+            flags &= ~DropValid;
+      }
+      else if ((flags & DropValid) && pos.z < cutoff)
+      {
+         flags &= ~DropValid;
 
-		//do some funky effect thingy for hitting something
-		if (useFunkyEffectThingy)
-		   createSplash(curr);
+         //do some funky effect thingy for hitting something
+         if (useFunkyEffectThingy)
+            createSplash(Point3F(pos.x, pos.y, cutoff));
       }
 
       //render test
-	  curr->toRender = false;
-	  if ( curr->valid )
-      {
-		const VectorF lookVec = curr->position - camPos;
-		curr->toRender = (mDot(lookVec, camDir) > fovDot);
-	  }
-
-      curr = curr->next;
+      flags &= ~DropRender;
+      if ((flags & DropValid) && mDot(pos - camPos, camDir) > fovDot)
+         flags |= DropRender;
+      mDropFlags[i] = flags;
    }
 
    //update splashes
    const U32 currTime = Platform::getVirtualMilliseconds();
    const F32 invSplashMS = (1.0f / mDataBlock->mSplashMS);
 
-   curr = mSplashHead;
-   while (curr)
+   for (S32 i = mSplashes.size() - 1; i >= 0; i--)
    {
-      F32 pct = (F32)(currTime - curr->animStartTime) * invSplashMS;
+      Splash &splash = mSplashes[i];
+      F32 pct = (F32)(currTime - splash.startTime) * invSplashMS;
       if (pct >= 1.0f)
       {
-         Raindrop *next = curr->nextSplashDrop;
-         destroySplash(curr);
-         curr = next;
+         mSplashes.erase_fast(i);
          continue;
       }
 
-      curr->splashIndex = (U32)((csmFramesPerSideF*csmFramesPerSideF) * pct);
-      curr = curr->nextSplashDrop;
+      splash.frame = (U32)((csmFramesPerSideF*csmFramesPerSideF) * pct);
    }
    PROFILE_END();
 }
@@ -827,7 +828,7 @@ bool Precipitation::prepRenderImage(SceneState* state, const U32 stateKey,
    // This should be sufficient for most objects that don't manage zones, and
    //  don't need to return a specialized RenderImage...
    if (state->isObjectRendered(this)) {
-      SceneRenderImage* image = new SceneRenderImage;
+      SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
       image->obj = this;
       image->isTranslucent = true;
       image->sortType = SceneRenderImage::EndSort;
@@ -882,7 +883,48 @@ struct PrecipVert
 };
 
 static Vector<PrecipVert>	renderPrecipVerts(__FILE__, __LINE__);
-static Vector<U16>			pvIndices(__FILE__, __LINE__);
+
+/// Draws the first count quads of renderPrecipVerts with tex.
+static void drawPrecipQuads(U32 count, U32 tex)
+{
+   glEnable(GL_BLEND);
+   glDepthMask(GL_FALSE);
+   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+   glEnable(GL_TEXTURE_2D);
+   glBindTexture(GL_TEXTURE_2D, tex);
+
+   glEnableClientState(GL_VERTEX_ARRAY);
+   glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+
+   glColor3f(1.0f, 1.0f, 1.0f);
+
+   glVertexPointer( 3, GL_FLOAT, sizeof( PrecipVert ), &(renderPrecipVerts[0].vert) );
+   glTexCoordPointer( 2, GL_FLOAT, sizeof( PrecipVert ), &(renderPrecipVerts[0].texCoord) );
+
+   glDrawArrays( GL_QUADS, 0, count * 4 );
+
+   glDisableClientState(GL_VERTEX_ARRAY);
+   glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+   glDisable(GL_TEXTURE_2D);
+   glDepthMask(GL_TRUE);
+   glDisable(GL_BLEND);
+}
+
+/// Writes a billboard's corners, in the order of its texture piece.
+static inline void setPrecipQuad(PrecipVert *verts, const Point3F &pos, const VectorF &right,
+                                 const VectorF &up, const Point2F *texCoordPoint)
+{
+   verts[0].vert = pos + right - up;
+   verts[0].texCoord = texCoordPoint[3];
+   verts[1].vert = pos - right - up;
+   verts[1].texCoord = texCoordPoint[2];
+   verts[2].vert = pos - right + up;
+   verts[2].texCoord = texCoordPoint[1];
+   verts[3].vert = pos + right + up;
+   verts[3].texCoord = texCoordPoint[0];
+}
 
 void Precipitation::renderPrecip(SceneState *state)
 {
@@ -896,52 +938,49 @@ void Precipitation::renderPrecip(SceneState *state)
 
    PROFILE_START(PrecipRenderPrecip);
 
-   renderPrecipVerts.clear();
-   pvIndices.clear();
+   const U32 count = mDropPos.size();
+   renderPrecipVerts.setSize(count * 4);
    U32 vertCount = 0;
 
    const Point3F camPos = state->getCameraPosition();
    const VectorF camVel = camObj->getVelocity();
    const VectorF windVel = getWindVelocity();
+   const F32 dropSize = mDataBlock->mDropSize;
 
-   Raindrop *curr = mDropHead;
+   // True billboards all face the same way.
+   VectorF right;
+   VectorF up;
+   if (mDataBlock->mUseTrueBillboards)
+   {
+      state->mModelview.getRow(0,&right);
+      state->mModelview.getRow(2,&up);
+      right.normalize();
+      up.normalize();
+      right *= dropSize;
+      up *= dropSize;
+   }
 
-   while ( curr )
+   for (U32 i = 0; i < count; i++)
    {
-      if (!curr->toRender)
-      {
-         curr = curr->next;
+      if (!(mDropFlags[i] & DropRender))
          continue;
-      }
 
-      const Point3F pos = curr->renderPosition;
-      
-      VectorF right;
-      VectorF up;
+      const Point3F &pos = mDropRenderPos[i];
 
-      // two forms of billboards - true billboards (1st codeblock)
-      // or axis-aligned with velocity (2nd codeblock)
       // the axis-aligned billboards are aligned with the velocity
       // of the raindrop, and tilted slightly towards the camera
-      if (mDataBlock->mUseTrueBillboards)
+      if (!mDataBlock->mUseTrueBillboards)
       {
-         state->mModelview.getRow(0,&right);
-         state->mModelview.getRow(2,&up);
-         right.normalize();
-         up.normalize();
-      }
-      else
-      {
-	     VectorF orthoDir = (camPos - pos);
+         VectorF orthoDir = (camPos - pos);
 
-         VectorF velocity = windVel / curr->mass;
+         VectorF velocity = windVel / mDropMass[i];
          if (mRotateWithCamVel && camVel != VectorF( 0.0f, 0.0f, 0.0f ))
          {
             const F32 distance = orthoDir.len();
             velocity -= camVel / (distance > 2.0f ? distance : 2.0f) * 0.3f;
          }
 
-         velocity.z -= curr->velocity;
+         velocity.z -= mDropVelocity[i];
          velocity.normalize();
          orthoDir.normalize();
 
@@ -949,111 +988,26 @@ void Precipitation::renderPrecip(SceneState *state)
          right.normalize();
          up = mCross(orthoDir, right) * 0.5f - velocity * 0.5f;
          up.normalize();
+         right *= dropSize;
+         up *= dropSize;
       }
-      right *= mDataBlock->mDropSize;
-      up *= mDataBlock->mDropSize;
-	  
-      renderPrecipVerts.increment(4);
-      pvIndices.increment(6);
-      PrecipVert *verts = &(renderPrecipVerts[vertCount * 4]);
-      U16 *ind = &(pvIndices[vertCount * 6]);
-  
-      const Point2F	*texCoordPoint = &(texCoords[4*curr->texCoordIndex]);
-      
-      verts[0].vert = pos + right - up;
-      verts[0].texCoord = texCoordPoint[3];
-      ind[0] = vertCount * 4;
-      ind[5] = vertCount * 4;
-
-      verts[1].vert = pos - right - up;
-      verts[1].texCoord = texCoordPoint[2];
-      ind[1] = vertCount * 4 + 1;
-
-      verts[2].vert = pos - right + up;
-      verts[2].texCoord = texCoordPoint[1];
-      ind[2] = vertCount * 4 + 2;
-      ind[3] = vertCount * 4 + 2;
-
-      verts[3].vert = pos + right + up;
-      verts[3].texCoord = texCoordPoint[0];
-      ind[4] = vertCount * 4 + 3;
 
+      setPrecipQuad(&renderPrecipVerts[vertCount * 4], pos, right, up,
+                    &texCoords[4 * mDropTexIndex[i]]);
       vertCount++;
-	 
-      //debug collision render
-      //if (curr->cutoffHeight != -1000)
-      //{
-      //   VectorF windVel = getWindVelocity();
-      //   VectorF velocity = windVel / curr->mass - VectorF(0, 0, curr->velocity);
-      //   velocity.normalize();
-
-      //   Point3F start = curr->position;// - 10000 * velocity;
-      //   F32 height = start.z - curr->cutoffHeight;
-      //   F32 t = height / velocity.z;
-      //   Point3F end = start - t * velocity;
-
-      //   glDisable(GL_TEXTURE_2D);
-      //   glDisable(GL_BLEND);
-
-      //   glBegin(GL_LINES);
-      //   glColor3f(1.0, 0.0, 0.0);
-      //   glVertex3fv(&(start.x));
-      //   glColor3f(0.0, 1.0, 0.0);
-      //   glVertex3fv(&(end.x));
-      //   glEnd();
-
-      //   glBegin(GL_TRIANGLE_FAN);
-      //   glColor3f(0.0,0.0,1.0);
-      //   glVertex3fv(&((end - right + up).x));
-      //   glVertex3fv(&((end + right + up).x));
-      //   glVertex3fv(&((end + right - up).x));
-      //   glVertex3fv(&((end - right - up).x));
-      //   glEnd();
-
-      //   glEnable(GL_TEXTURE_2D);
-      //   glEnable(GL_BLEND);
-      //}
-      //end debug collision render
-
-      curr = curr->next;
-   }
-   
-   if ( vertCount == 0 )
-   {
-      PROFILE_END();
-	  return;
    }
 
-   glEnable(GL_BLEND);
-   glDepthMask(GL_FALSE);
-   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-   glEnable(GL_TEXTURE_2D);
-   glBindTexture(GL_TEXTURE_2D, mDropHandle.getGLName());
-
-   glEnableClientState(GL_VERTEX_ARRAY);
-   glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-
-   glColor3f(1.0f, 1.0f, 1.0f);
-   
-   glVertexPointer( 3, GL_FLOAT, sizeof( PrecipVert ), &(renderPrecipVerts[0].vert) );
-   glTexCoordPointer( 2, GL_FLOAT, sizeof( PrecipVert ), &(renderPrecipVerts[0].texCoord) );
-	  
-   glDrawElements( GL_TRIANGLES, pvIndices.size(), GL_UNSIGNED_SHORT, pvIndices.address() );
-
-   glDisable(GL_TEXTURE_2D);
-
-   glDepthMask(GL_TRUE);
-   glDisable(GL_BLEND);
-
-   glDisableClientState(GL_VERTEX_ARRAY);
-   glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+   if (vertCount)
+      drawPrecipQuads(vertCount, mDropHandle.getGLName());
 
    PROFILE_END();
 }
 
 void Precipitation::renderSplashes(SceneState *state)
 {
+   if (mSplashes.empty())
+      return;
+
    PROFILE_START(PrecipRenderSplash);
 
    //setup the billboard
@@ -1065,69 +1019,13 @@ void Precipitation::renderSplashes(SceneState *state)
    right *= mDataBlock->mSplashSize;
    up *= mDataBlock->mSplashSize;
 
-   renderPrecipVerts.clear();
-   pvIndices.clear();
-   U32 vertCount = 0;
-
-   Raindrop *curr = mSplashHead;
-   while (curr)
-   {
-      renderPrecipVerts.increment(4);
-      pvIndices.increment(6);
-      PrecipVert *verts = &(renderPrecipVerts[vertCount * 4]);
-      U16 *ind = &(pvIndices[vertCount * 6]);
-  
-      const Point2F	*texCoordPoint = &(splashCoords[4*curr->splashIndex]);
-      
-      verts[0].vert = curr->hitPos + right - up;
-      verts[0].texCoord = texCoordPoint[3];
-      ind[0] = vertCount * 4;
-      ind[5] = vertCount * 4;
-
-      verts[1].vert = curr->hitPos - right - up;
-      verts[1].texCoord = texCoordPoint[2];
-      ind[1] = vertCount * 4 + 1;
-
-      verts[2].vert = curr->hitPos - right + up;
-      verts[2].texCoord = texCoordPoint[1];
-      ind[2] = vertCount * 4 + 2;
-      ind[3] = vertCount * 4 + 2;
-
-      verts[3].vert = curr->hitPos + right + up;
-      verts[3].texCoord = texCoordPoint[0];
-      ind[4] = vertCount * 4 + 3;
-
-      vertCount++;
-
-      curr = curr->nextSplashDrop;
-   }
-   
-   if ( vertCount == 0 )
-   {
-      PROFILE_END();
-	  return;
-   }
-   
-   glEnable(GL_TEXTURE_2D);
-   glBindTexture(GL_TEXTURE_2D, mSplashHandle.getGLName());
-   glEnable(GL_BLEND);
-   glDepthMask(GL_FALSE);
-
-   glEnableClientState(GL_VERTEX_ARRAY);
-   glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-
-   glColor3f(1.0f, 1.0f, 1.0f);
-  
-   glVertexPointer( 3, GL_FLOAT, sizeof( PrecipVert ), &(renderPrecipVerts[0].vert) );
-   glTexCoordPointer( 2, GL_FLOAT, sizeof( PrecipVert ), &(renderPrecipVerts[0].texCoord) );
-  
-   glDrawElements( GL_TRIANGLES, pvIndices.size(), GL_UNSIGNED_SHORT, pvIndices.address() );
+   const U32 count = mSplashes.size();
+   renderPrecipVerts.setSize(count * 4);
+   for (U32 i = 0; i < count; i++)
+      setPrecipQuad(&renderPrecipVerts[i * 4], mSplashes[i].pos, right, up,
+                    &splashCoords[4 * mSplashes[i].frame]);
 
-   glDisableClientState(GL_VERTEX_ARRAY);
-   glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-   glDisable(GL_BLEND);
-   glDepthMask(GL_TRUE);
-   glDisable(GL_TEXTURE_2D);
+   drawPrecipQuads(count, mSplashHandle.getGLName());
 
    PROFILE_END();
 }
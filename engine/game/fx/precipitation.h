@@ -8,6 +8,7 @@
 
 #include "game/gameBase.h"
 #include "audio/audioDataBlock.h"
+#include "core/tVector.h"
 
 //--------------------------------------------------------------------------
 /// Precipitation datablock.
@@ -35,50 +36,21 @@ class PrecipitationData : public GameBaseData {
 };
 DECLARE_CONSOLETYPE(PrecipitationData)
 
-struct Raindrop
-{
-   F32 velocity;           ///< How fast the drop is falling downwards
-   Point3F position;       ///< Position of the drop
-   Point3F renderPosition; ///< Interpolated render-position of the drop
-   F32 time;               ///< Time into the turbulence function
-   F32 mass;               ///< Mass of drop used for how much turbulence/wind effects the drop
-
-   U32 texCoordIndex;      ///< Which piece of the material will be used
-
-   bool toRender;          ///< Don't want to render all drops, just the ones that pass a few tests
-   bool valid;             ///< Drop becomes invalid after hitting something.  Just keep updating
-                           ///<   the position of it, but don't render until it hits the bottom
-                           ///<   of the renderbox and respawns
-
-   Point3F hitPos;         ///< Point at which the drop will collide with something
-
-   Raindrop *nextSplashDrop; ///< Linked list cruft for easily adding/removing stuff from the splash list
-   Raindrop *prevSplashDrop; ///< Same as next but previous!
-   SimTime animStartTime;    ///< Animation time tracker
-   U32 splashIndex;          ///< Texture index for which frame of the splash to render
-   U32 hitType;              ///< What kind of object the drop will hit
-
-   Raindrop* next;         ///< linked list cruft
-
-   Raindrop()
-   :  velocity( 0.0f ),
-      time( 0.0f ),
-      mass( 1.0f ),
-      texCoordIndex( 0 ),
-      toRender( false ),
-      valid( true ),
-	  hitPos( 0.0f, 0.0f, 0.0f ),
-      nextSplashDrop( NULL ),
-      prevSplashDrop( NULL ),
-      animStartTime( 0 ),
-      splashIndex( 0 ),
-      hitType( 0 ),
-      next( NULL )
-   {
-   }
-};
-
 //--------------------------------------------------------------------------
+/// Rain, snow and the like around the camera.
+///
+/// The drops live in a box that follows the camera, and wrap round it when
+/// they leave it, so only the drops near the camera are ever simulated.
+/// Their state is kept as a structure of arrays, one Vector per field, so
+/// the per tick update just streams through them.
+///
+/// Rather than cast a ray for each drop that wraps, drops collide with a
+/// height cache: a grid over the box, each cell holding the top of whatever
+/// a drop falling there would hit.  The cells are on a world aligned grid,
+/// held in a toroidal array, so the box moving only uncovers a strip of new
+/// cells.  Those are cast a few at a time ($pref::precipitationRaysPerTick)
+/// and, with what's left over, the old ones are recast in turn.  Until its
+/// cell is cast a drop falls through.
 class Precipitation : public GameBase
 {
   private:
@@ -90,9 +62,48 @@ class Precipitation : public GameBase
    const static F32   csmDropsPerSideF;      ///< How many drops are on a side of the material texture
    const static U32   csmFramesPerSide;      ///< How many frames are on a side of a splash animation
    const static F32   csmFramesPerSideF;     ///< How many frames are on a side of a splash animation
+   const static F32   csmNoCutoff;           ///< Cutoff where there's nothing to hit
    
-   Raindrop *mDropHead;    ///< Drop linked list head
-   Raindrop *mSplashHead;  ///< Splash linked list head
+   enum DropFlags
+   {
+      DropValid  = BIT(0),    ///< Hasn't hit anything yet.  Invalid drops keep
+                              ///< falling, unrendered, till they respawn at the top.
+      DropRender = BIT(1),    ///< Passed the view test this tick.
+   };
+
+   /// The drops.  Drop i is element i of each.
+   Vector<Point3F> mDropPos;
+   Vector<Point3F> mDropRenderPos;  ///< Interpolated, for rendering.
+   Vector<F32>     mDropVelocity;   ///< How fast it falls.
+   Vector<F32>     mDropMass;       ///< How much wind and turbulence move it.
+   Vector<F32>     mDropTime;       ///< Time into the turbulence function.
+   Vector<U8>      mDropTexIndex;   ///< Which piece of the drop texture.
+   Vector<U8>      mDropFlags;
+
+   struct Splash
+   {
+      Point3F pos;
+      U32     startTime;
+      U32     frame;              ///< Which piece of the splash texture.
+   };
+   Vector<Splash>  mSplashes;
+
+   enum
+   {
+      HeightCacheSize = 64,       ///< Cells on a side of the toroidal array.
+      HeightCacheSpan = 32,       ///< Cells across the box.
+   };
+
+   struct HeightCell
+   {
+      S32 x, y;                   ///< World cell it holds, if valid.
+      F32 z;                      ///< Where a drop stops.
+      bool valid;
+   };
+   HeightCell *mHeightCells;
+   F32         mCellSize;
+   U32         mRefreshCursor;    ///< Next cell to recast.
+
    Point2F  *texCoords;    ///< texture coords for rain texture
    Point2F  *splashCoords; ///< texture coordinates for splash texture
 
@@ -137,15 +148,18 @@ class Precipitation : public GameBase
    void interpolateTick(F32 delta);
 
    VectorF getWindVelocity();
-   void fillDropList();                      ///< Adds/removes drops from the list to have the right # of drops
-   void killDropList();                      ///< Deletes the entire drop list
-   void spawnDrop(Raindrop *drop);           ///< Fills drop info with random velocity, x/y positions, and mass
-   void spawnNewDrop(Raindrop *drop);        ///< Same as spawnDrop except also does z position
-   void findDropCutoff(Raindrop *drop);      ///< Casts a ray to see if/when a drop will collide
-   inline void wrapDrop(Raindrop *drop, Box3F &box); ///< Wraps a drop within the specified box
+   void fillDropList();                      ///< Adds/removes drops to have the right # of drops
+   void killDropList();                      ///< Deletes all the drops and splashes
+   void spawnDrop(U32 i);                    ///< Fills drop info with random velocity, x/y positions, and mass
+   void spawnNewDrop(U32 i);                 ///< Same as spawnDrop except also does z position
+   inline bool wrapDrop(U32 i, const Box3F &box); ///< Wraps a drop within the specified box, true if it moved
+
+   void resetHeightCache();
+   void updateHeightCache(const Box3F &box); ///< Casts this tick's share of the cells
+   void castHeightCell(HeightCell &cell, S32 x, S32 y, F32 top, F32 bottom);
+   F32  getDropCutoff(const Point3F &pos);   ///< Height a drop here stops at
 
-   void createSplash(Raindrop *drop);        ///< Adds a drop to the splash list
-   void destroySplash(Raindrop *drop);       ///< Removes a drop from the splash list
+   void createSplash(const Point3F &pos);
 
 
   protected:
@@ -159,9 +173,11 @@ class Precipitation : public GameBase
    void renderSplashes(SceneState *state);
 
   public:
+   static S32 smRaysPerTick;     ///< $pref::precipitationRaysPerTick
 
    Precipitation();
    ~Precipitation();
+   static void consoleInit();
    void inspectPostApply();
 
    enum
@@ -421,7 +421,7 @@ bool Splash::prepRenderImage(SceneState* state, const U32 stateKey,
    {
       mFog = 0.0;
 
-      SceneRenderImage* image = new SceneRenderImage;
+      SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
       image->obj = this;
       image->isTranslucent = true;
       image->sortType = SceneRenderImage::Point;
@@ -460,6 +460,14 @@ void Splash::renderObject(SceneState* state, SceneRenderImage*)
 //--------------------------------------------------------------------------
 // Process tick
 //--------------------------------------------------------------------------
+// Only counts time, except for the server tick that deletes the splash.
+bool Splash::isParallelTickSafe()
+{
+   if(isClientObject())
+      return true;
+   return mCurrMS + TickMs < mEndingMS + mDataBlock->ringLifetime * 1000;
+}
+
 void Splash::processTick(const Move*)
 {
    mCurrMS += TickMs;
@@ -150,6 +150,7 @@ protected:
    bool        onAdd();
    void        onRemove();
    void        processTick(const Move *move);
+   bool        isParallelTickSafe();
    void        advanceTime(F32 dt);
    void        updateEmitters( F32 dt );
    void        updateWave( F32 dt );
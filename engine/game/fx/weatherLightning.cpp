@@ -17,6 +17,57 @@ IMPLEMENT_CO_NETOBJECT_V1(WeatherLightning);
 
 MRandomLCG sgRandomGen;
 
+namespace {
+
+struct BoltVertex
+{
+   Point3F point;
+   Point2F texCoord;
+   U8      color[4];
+};
+
+struct BoltQuad
+{
+   U32 texture;       ///< GL name, what the quads are drawn in runs of.
+   U32 index;         ///< Into sBoltVerts, four apart.
+};
+
+/// The quads of every bolt of a WeatherLightning, drawn a texture at a time.
+Vector<BoltVertex> sBoltVerts;
+Vector<BoltQuad>   sBoltQuads;
+Vector<BoltVertex> sBoltSorted;
+
+void addBoltQuad(TextureHandle *texture, const Point3F *points, F32 alpha)
+{
+   static const F32 texCoords[4][2] = { { 0, 0 }, { 0, 1 }, { 1, 1 }, { 1, 0 } };
+   U8 a = U8(mClampF(alpha, 0.0f, 1.0f) * 255.0f + 0.5f);
+
+   sBoltQuads.increment();
+   sBoltQuads.last().texture = texture->getGLName();
+   sBoltQuads.last().index = sBoltVerts.size();
+
+   for (U32 i = 0; i < 4; i++)
+   {
+      sBoltVerts.increment();
+      BoltVertex &vert = sBoltVerts.last();
+      vert.point = points[i];
+      vert.texCoord.set(texCoords[i][0], texCoords[i][1]);
+      vert.color[0] = vert.color[1] = vert.color[2] = 255;
+      vert.color[3] = a;
+   }
+}
+
+S32 QSORT_CALLBACK cmpBoltQuad(const void* p1, const void* p2)
+{
+   const BoltQuad* q1 = (const BoltQuad*) p1;
+   const BoltQuad* q2 = (const BoltQuad*) p2;
+   if (q1->texture != q2->texture)
+      return q1->texture < q2->texture ? -1 : 1;
+   return S32(q1->index) - S32(q2->index);
+}
+
+} // namespace {}
+
 S32 QSORT_CALLBACK cmpWLSounds(const void* p1, const void* p2)
 {
    U32 i1 = *((const S32*)p1);
@@ -329,7 +380,7 @@ bool WeatherLightning::prepRenderImage(SceneState* state, const U32 stateKey, co
    //  don't need to return a specialized RenderImage...
    if(state->isObjectRendered(this))
    {
-      SceneRenderImage* image = new SceneRenderImage;
+      SceneRenderImage* image = state->newRenderImage<SceneRenderImage>();
       image->obj = this;
       image->isTranslucent = true;
       image->sortType = SceneRenderImage::EndSort;
@@ -339,7 +390,7 @@ bool WeatherLightning::prepRenderImage(SceneState* state, const U32 stateKey, co
    return false;
 }
 
-void WeatherLightningBolt::render(const Point3F &camPos)
+void WeatherLightningBolt::batch(const Point3F &camPos)
 {
    Point3F perpVec;
    Point3F lightUp = startPoint - endPoint;
@@ -350,10 +401,6 @@ void WeatherLightningBolt::render(const Point3F &camPos)
    mCross(perpVec, lightUp, &frontVec);
    frontVec.normalize();
    
-   glEnable(GL_DEPTH_TEST);
-   glDepthMask(GL_FALSE);
-   glDepthFunc(GL_LEQUAL);
-   
    //
    // strike texture
    //
@@ -369,7 +416,6 @@ void WeatherLightningBolt::render(const Point3F &camPos)
          strikeAlpha = 1.0;
       else
          strikeAlpha = 1.0 - ((currentAge - (2.0 * strikeTime / 3.0)) / (strikeTime / 3.0));
-      glColor4f(1.0f, 1.0f, 1.0f, strikeAlpha);
       
       // generate texture coords
       Point3F points[4];
@@ -378,19 +424,7 @@ void WeatherLightningBolt::render(const Point3F &camPos)
       points[1] = startPoint + perpVec * width;
       points[2] = endPoint   + perpVec * width;
       points[3] = endPoint   - perpVec * width;
-      
-      // bind and draw texture
-      glBindTexture(GL_TEXTURE_2D, strikeTexture->getGLName());
-      glBegin(GL_TRIANGLE_FAN);
-         glTexCoord2f(0, 0); glVertex3fv(points[0]);
-         glTexCoord2f(0, 1); glVertex3fv(points[1]);
-         glTexCoord2f(1, 1); glVertex3fv(points[2]);
-         glTexCoord2f(1, 0); glVertex3fv(points[3]);
-         //glTexCoord2f(0, 0); glVertex3fv(points[0]);
-         //glTexCoord2f(1, 0); glVertex3fv(points[1]);
-         //glTexCoord2f(1, 1); glVertex3fv(points[2]);
-         //glTexCoord2f(0, 1); glVertex3fv(points[3]);
-      glEnd();
+      addBoltQuad(strikeTexture, points, strikeAlpha);
    
    //
    // fuzzy texture
@@ -404,7 +438,6 @@ void WeatherLightningBolt::render(const Point3F &camPos)
          constAlpha = 1.0 - ((currentAge - (strikeTime / 2.0)) / (strikeTime / 6.0));
       else
          constAlpha = 0.0;
-      glColor4f(1.0, 1.0, 1.0, constAlpha);
       
       // generate texture coords
       width *= 4;
@@ -414,53 +447,18 @@ void WeatherLightningBolt::render(const Point3F &camPos)
       points[3] = endPoint   - perpVec * width;
       
       if(constAlpha != 0.0)
-      {
-         // bind and draw texture
-         glBindTexture(GL_TEXTURE_2D, fuzzyTexture->getGLName());
-         glBegin(GL_TRIANGLE_FAN);
-            glTexCoord2f(0, 0); glVertex3fv(points[0]);
-            glTexCoord2f(0, 1); glVertex3fv(points[1]);
-            glTexCoord2f(1, 1); glVertex3fv(points[2]);
-            glTexCoord2f(1, 0); glVertex3fv(points[3]);
-            //glTexCoord2f(0, 0); glVertex3fv(points[0]);
-            //glTexCoord2f(1, 0); glVertex3fv(points[1]);
-            //glTexCoord2f(1, 1); glVertex3fv(points[2]);
-            //glTexCoord2f(0, 1); glVertex3fv(points[3]);
-         glEnd();
-         
-         glDepthMask(GL_TRUE);
-      }
+         addBoltQuad(fuzzyTexture, points, constAlpha);
    
    //
    // flash texture
    //
    
-      // setup alpha value
-      glColor4f(1.0f, 1.0f, 1.0f, strikeAlpha);
-      
       // generate texture coords
       points[0] = startPoint - perpVec * width + frontVec * width;
       points[1] = startPoint - perpVec * width - frontVec * width;
       points[2] = startPoint + perpVec * width - frontVec * width;
       points[3] = startPoint + perpVec * width + frontVec * width;
-
-      // bind and draw texture
-      glBindTexture(GL_TEXTURE_2D, flashTexture->getGLName());
-      glBegin(GL_TRIANGLE_FAN);
-         glTexCoord2f(0, 0); glVertex3fv(points[0]);
-         glTexCoord2f(0, 1); glVertex3fv(points[1]);
-         glTexCoord2f(1, 1); glVertex3fv(points[2]);
-         glTexCoord2f(1, 0); glVertex3fv(points[3]);
-         //glTexCoord2f(0, 0); glVertex3fv(points[0]);
-         //glTexCoord2f(1, 0); glVertex3fv(points[1]);
-         //glTexCoord2f(1, 1); glVertex3fv(points[2]);
-         //glTexCoord2f(0, 1); glVertex3fv(points[3]);
-      glEnd();
-      
-   //
-   // finished
-   //
-   glDepthMask(GL_TRUE);
+      addBoltQuad(flashTexture, points, strikeAlpha);
 }
 
 void WeatherLightning::renderObject(SceneState* state, SceneRenderImage*)
@@ -490,10 +488,45 @@ void WeatherLightning::renderObject(SceneState* state, SceneRenderImage*)
       glEnable(GL_BLEND);
       glBlendFunc(GL_SRC_ALPHA, GL_ONE);
       glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-         
+      glEnable(GL_DEPTH_TEST);
+      glDepthMask(GL_FALSE);
+      glDepthFunc(GL_LEQUAL);
+
+      sBoltVerts.clear();
+      sBoltQuads.clear();
       for(U32 i = 0; i < mActiveBolts.size(); i++)
-         mActiveBolts[i]->render(camPos);
+         mActiveBolts[i]->batch(camPos);
+
+      // It's all added, so the order doesn't matter; one run per texture.
+      dQsort(sBoltQuads.address(), sBoltQuads.size(), sizeof(BoltQuad), cmpBoltQuad);
+      sBoltSorted.setSize(sBoltVerts.size());
+      for(U32 i = 0; i < sBoltQuads.size(); i++)
+         dMemcpy(&sBoltSorted[i * 4], &sBoltVerts[sBoltQuads[i].index], 4 * sizeof(BoltVertex));
+
+      const U8* base = (const U8*) sBoltSorted.address();
+      glEnableClientState(GL_VERTEX_ARRAY);
+      glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+      glEnableClientState(GL_COLOR_ARRAY);
+      glVertexPointer(3, GL_FLOAT, sizeof(BoltVertex), base + Offset(point, BoltVertex));
+      glTexCoordPointer(2, GL_FLOAT, sizeof(BoltVertex), base + Offset(texCoord, BoltVertex));
+      glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(BoltVertex), base + Offset(color, BoltVertex));
+
+      for(U32 start = 0; start < sBoltQuads.size(); )
+      {
+         U32 end = start + 1;
+         while(end < sBoltQuads.size() && sBoltQuads[end].texture == sBoltQuads[start].texture)
+            end++;
+
+         glBindTexture(GL_TEXTURE_2D, sBoltQuads[start].texture);
+         glDrawArrays(GL_QUADS, start * 4, (end - start) * 4);
+         start = end;
+      }
 
+      glDisableClientState(GL_COLOR_ARRAY);
+      glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+      glDisableClientState(GL_VERTEX_ARRAY);
+
+      glDepthMask(GL_TRUE);
       glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
       glDisable(GL_BLEND);
       glDisable(GL_TEXTURE_2D);
@@ -509,6 +542,15 @@ void WeatherLightning::renderObject(SceneState* state, SceneRenderImage*)
    }
 }
 
+// As with Lightning, only the strike ticks touch anything else.
+bool WeatherLightning::isParallelTickSafe()
+{
+   if(isClientObject())
+      return true;
+   S32 msBetweenStrikes = (S32)(60.0 / strikesPerMinute * 1000.0);
+   return S32(lastThink + TickMs) <= msBetweenStrikes;
+}
+
 void WeatherLightning::processTick(const Move *move)
 {
    Parent::processTick(move);
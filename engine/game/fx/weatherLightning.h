@@ -106,7 +106,9 @@ struct WeatherLightningBolt
    TextureHandle* flashTexture;
    TextureHandle* fuzzyTexture;
    
-   void render(const Point3F &camPos);
+   /// Adds the strike, glow and flash quads of the bolt to the batch
+   /// WeatherLightning draws once all of its bolts are in.
+   void batch(const Point3F &camPos);
 };
 
 class WeatherLightning : public GameBase
@@ -141,6 +143,7 @@ class WeatherLightning : public GameBase
 
    // simulation
    void processTick(const Move *move);
+   bool isParallelTickSafe();
    void advanceTime(F32 dt);
    
    // grab random textures
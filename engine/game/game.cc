@@ -34,6 +34,9 @@
 #include "game/ambientAudioManager.h"
 #include "core/frameAllocator.h"
 #include "sceneGraph/detailManager.h"
+#include "sceneGraph/occlusionCuller.h"
+#include "sceneGraph/visibilityQuery.h"
+#include "sceneGraph/boxCuller.h"
 #include "gui/controls/guiMLTextCtrl.h"
 #include "platform/profiler.h"
 #include "game/fx/underLava.h"
@@ -51,6 +54,7 @@ F32 gMovementSpeed = 1;
 //--------------------------------------------------------------------------
 ConsoleFunctionGroupBegin( GameFunctions, "General game functionality.");
 
+#ifndef TORQUE_HEADLESS
 ConsoleFunction(screenShot, void, 3, 3, "(string file, string format)"
                 "Take a screenshot.\n\n"
                 "@param format One of JPEG or PNG.")
@@ -86,6 +90,7 @@ ConsoleFunction(screenShot, void, 3, 3, "(string file, string format)"
    delete [] pixels;
    delete bitmap;
 }
+#endif
 
 ConsoleFunction(lightScene, bool, 1, 3, "(script_function completeCallback=NULL, string mode=\"\")"
                 "Relight the scene.\n\n"
@@ -447,6 +452,7 @@ ConsoleFunction( getControlObjectSpeed, const char*, 1, 1, "Get speed (but not v
 }
 
 //--------------------------------------------------------------------------
+#ifndef TORQUE_HEADLESS
 ConsoleFunction( panoramaScreenShot, void, 3, 3, "(string file, string format)"
                 "Take a panoramic screenshot.\n\n"
                 "@param format This is either JPEG or PNG.")
@@ -510,6 +516,7 @@ ConsoleFunction( panoramaScreenShot, void, 3, 3, "(string file, string format)"
 
    delete [] pixels;
 }
+#endif
 
 ConsoleFunctionGroupEnd( GameFunctions );
 
@@ -536,7 +543,26 @@ void GameInit()
 #endif
 
    Con::addVariable("$pref::TS::autoDetail", TypeF32, &DetailManager::smDetailScale);
+   Con::addVariable("$pref::TS::detailBudget", TypeS32, &DetailManager::smPolyBudget);
+   Con::addVariable("$pref::TS::detailTargetMs", TypeF32, &DetailManager::smTargetFrameMs);
+   Con::addVariable("$pref::TS::detailBudgetHysteresis", TypeF32, &DetailManager::smHysteresis);
    Con::addVariable("$pref::visibleDistanceMod", TypeF32, &SceneGraph::smVisibleDistanceMod);
+   Con::addVariable("$pref::SceneGraph::parallelPrep", TypeBool, &SceneGraph::smParallelPrep);
+   Con::addVariable("$pref::SceneGraph::parallelPrepMinObjects", TypeS32, &SceneGraph::smParallelPrepMinObjects);
+   Con::addVariable("$pref::SceneGraph::scopeWithBins", TypeBool, &SceneGraph::smScopeWithBins);
+   Con::addVariable("$pref::SceneGraph::batchCulling", TypeBool, &BoxCuller::smEnabled);
+   Con::addVariable("$pref::SceneGraph::occlusionCulling", TypeBool, &OcclusionCuller::smEnabled);
+   Con::addVariable("$pref::SceneGraph::occlusionRequeryFrames", TypeS32, &OcclusionCuller::smVisibleRequeryFrames);
+   Con::addVariable("$pref::SceneGraph::occlusionCameraCut", TypeF32, &OcclusionCuller::smCameraCutDistance);
+   Con::addVariable("OcclusionCuller::numCulled", TypeS32, &OcclusionCuller::smNumCulled);
+   Con::addVariable("OcclusionCuller::numQueries", TypeS32, &OcclusionCuller::smNumQueries);
+   Con::addVariable("$pref::VisibilityQuery::occlusionQueries", TypeBool, &VisibilityQuery::smUseOcclusionQueries);
+   Con::addVariable("VisibilityQuery::numRays", TypeS32, &VisibilityQuery::smNumRays);
+   Con::addVariable("VisibilityQuery::numQueries", TypeS32, &VisibilityQuery::smNumQueries);
+   Con::addVariable("$pref::Audio::cullEmitters", TypeBool, &AmbientAudioManager::smCullEmitters);
+   Con::addVariable("$pref::Audio::emitterCullSpeed", TypeF32, &AmbientAudioManager::smCullSpeed);
+   Con::addVariable("Audio::activeEmitters", TypeS32, &AmbientAudioManager::smNumActiveEmitters);
+   Con::addVariable("Audio::culledEmitters", TypeS32, &AmbientAudioManager::smNumCulledEmitters);
 
    // updated every frame
    Con::addVariable("cameraFov", TypeF32, &sConsoleCameraFov);
@@ -549,7 +575,9 @@ const U32 AudioUpdatePeriod = 125;  ///< milliseconds between audio updates.
 
 bool clientProcess(U32 timeDelta)
 {
+#ifndef TORQUE_HEADLESS
    ShowTSShape::advanceTime(timeDelta);
+#endif
    ITickable::advanceTime(timeDelta);
 
    bool ret = gClientProcessList.advanceClientTime(timeDelta);
@@ -569,7 +597,10 @@ bool clientProcess(U32 timeDelta)
    // determine if were lagging
    GameConnection* connection = GameConnection::getConnectionToServer();
    if(connection)
+   {
       connection->detectLag();
+      connection->processDataBlockPreloads();
+   }
 
    // alxUpdate is somewhat expensive and does not need to be updated constantly,
    // though it does need to be updated in real time
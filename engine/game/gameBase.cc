@@ -145,11 +145,19 @@ GameBase::GameBase()
    mProcessLink.next = mProcessLink.prev = this;
    mAfterObject = 0;
    mProcessTag = 0;
+   mTickGroup = 0;
+   mTickedInParallel = false;
+   mDeferTickPhysics = false;
+   mSleeping = false;
+   mRestTicks = 0;
    mLastDelta = 0;
    mDataBlock = 0;
    mProcessTick = true;
    mNameTag = "";
    mControllingClient = 0;
+   mSnapshotHead = 0;
+   mSnapshotCount = 0;
+   mSnapshotPending = false;
 }
 
 GameBase::~GameBase()
@@ -461,6 +469,9 @@ U32 GameBase::packUpdate(NetConnection *, U32 mask, BitStream *stream)
 
 void GameBase::unpackUpdate(NetConnection *con, BitStream *stream)
 {
+   // The subclasses unpack their state after this.
+   mSnapshotPending = smSnapshotDelay > 0;
+
    if (stream->readFlag()) {
       VectorF scale;
       mathRead( *stream, &scale );
@@ -500,6 +511,130 @@ IMPLEMENT_CONSOLETYPE(GameBaseData)
 IMPLEMENT_GETDATATYPE(GameBaseData)
 IMPLEMENT_SETDATATYPE(GameBaseData)
 
+//----------------------------------------------------------------------------
+
+S32 GameBase::smSleepTicks = 0;
+
+void GameBase::updateSleep(bool atRest)
+{
+   if (!atRest || smSleepTicks <= 0) {
+      mRestTicks = 0;
+      return;
+   }
+   if (mRestTicks < smSleepTicks)
+      mRestTicks++;
+   if (mRestTicks >= smSleepTicks && !mSleeping && canSleep()) {
+      mSleeping = true;
+      onSleep();
+   }
+}
+
+void GameBase::wakeUp()
+{
+   mRestTicks = 0;
+   if (!mSleeping)
+      return;
+
+   mSleeping = false;
+   Vector<GameBase*> woken;
+   woken.push_back(this);
+   wakeObjects(woken);
+}
+
+void GameBase::wakeTouching(const Box3F &box)
+{
+   if (!mContainer)
+      return;
+
+   Vector<GameBase*> woken;
+   mContainer->findObjects(box, GameBaseObjectType, findSleepingCallback, &woken);
+   wakeObjects(woken);
+}
+
+void GameBase::findSleepingCallback(SceneObject *obj, void *key)
+{
+   // Cleared as they're found so each is only queued once
+   GameBase *gb = static_cast<GameBase*>(obj);
+   if (gb->mSleeping) {
+      gb->mSleeping = false;
+      gb->mRestTicks = 0;
+      ((Vector<GameBase*>*)key)->push_back(gb);
+   }
+}
+
+void GameBase::wakeObjects(Vector<GameBase*> &woken)
+{
+   // Worked through as a queue rather than recursively, a pile of
+   // sleepers can be deep.
+   while (woken.size()) {
+      GameBase *obj = woken.last();
+      woken.pop_back();
+
+      Box3F box = obj->getWorldBox();
+      box.min -= Point3F(0.1f, 0.1f, 0.1f);
+      box.max += Point3F(0.1f, 0.1f, 0.1f);
+      if (obj->mContainer)
+         obj->mContainer->findObjects(box, GameBaseObjectType, findSleepingCallback, &woken);
+      obj->onWake();
+   }
+}
+
+//----------------------------------------------------------------------------
+
+S32 GameBase::smSnapshotDelay = 0;
+
+void GameBase::addSnapshot(const MatrixF &mat)
+{
+   mSnapshotPending = false;
+   SimTime time = gClientProcessList.getLastTime();
+
+   // Updates in the same frame replace each other.
+   if (!mSnapshotCount || mSnapshots[mSnapshotHead].time != time) {
+      mSnapshotHead = (mSnapshotHead + 1) % SnapshotCount;
+      if (mSnapshotCount < SnapshotCount)
+         mSnapshotCount++;
+   }
+   Snapshot &snap = mSnapshots[mSnapshotHead];
+   snap.time = time;
+   mat.getColumn(3, &snap.pos);
+   snap.rot.set(mat);
+}
+
+bool GameBase::interpolateSnapshots(SimTime time)
+{
+   if (mSnapshotCount < 2)
+      return false;
+
+   // Walk back from the newest to the pair around time, or the oldest.
+   const Snapshot *newer = &mSnapshots[mSnapshotHead];
+   const Snapshot *older = newer;
+   F32 t = 0;
+   if (time < newer->time) {
+      for (U32 i = 1; i < mSnapshotCount; i++) {
+         older = &mSnapshots[(mSnapshotHead + SnapshotCount - i) % SnapshotCount];
+         if (time >= older->time)
+            break;
+         newer = older;
+      }
+      if (time > older->time)
+         t = F32(time - older->time) / F32(newer->time - older->time);
+   }
+
+   Point3F pos;
+   pos.interpolate(older->pos, newer->pos, t);
+   QuatF rot;
+   rot.interpolate(older->rot, newer->rot, t);
+
+   MatrixF mat;
+   rot.setMatrix(&mat);
+   mat.setColumn(3, pos);
+   setRenderTransform(mat);
+   return true;
+}
+
+
+//----------------------------------------------------------------------------
+
 void GameBase::initPersistFields()
 {
    Parent::initPersistFields();
@@ -515,4 +650,9 @@ void GameBase::consoleInit()
 #ifdef TORQUE_DEBUG
    Con::addVariable("GameBase::boundingBox", TypeBool, &gShowBoundingBox);
 #endif
+   Con::addVariable("ProcessList::parallelTicks", TypeBool, &ProcessList::smParallelTicks);
+   Con::addVariable("ProcessList::parallelMinObjects", TypeS32, &ProcessList::smParallelMinObjects);
+   Con::addVariable("ProcessList::parallelPhysics", TypeBool, &ProcessList::smParallelPhysics);
+   Con::addVariable("GameBase::sleepTicks", TypeS32, &smSleepTicks);
+   Con::addVariable("GameBase::snapshotDelay", TypeS32, &smSnapshotDelay);
 }
@@ -168,12 +168,25 @@ class GameBase : public SceneObject
    U32  mProcessTag;                      ///< Tag used to sort objects for processing.
    Link mProcessLink;                     ///< Ordered process queue link.
    SimObjectPtr<GameBase> mAfterObject;
+   U32  mTickGroup;                       ///< Scratch index used when building parallel tick groups.
+   bool mTickedInParallel;                ///< Already ticked by a worker this tick.
    /// @}
 
+   bool mSleeping;
+   S32  mRestTicks;                       ///< Ticks at rest in a row, up to smSleepTicks.
+
+   static void findSleepingCallback(SceneObject *obj, void *key);
+   static void wakeObjects(Vector<GameBase*> &woken);
+
    // Control interface
    GameConnection* mControllingClient;
    //GameBase* mControllingObject;
 
+  protected:
+   /// Set by the ProcessList for a tick whose physics it will run.
+   /// @see canDeferTickPhysics
+   bool mDeferTickPhysics;
+
   public:
    static bool gShowBoundingBox;    ///< Should we render bounding boxes?
   protected:
@@ -273,6 +286,122 @@ class GameBase : public SceneObject
    /// Removes this object from the tick-processing list
    void removeFromProcessList() { plUnlink(); }
 
+   /// Can this object's processTick(0) run on a worker thread?
+   ///
+   /// Only consulted when $ProcessList::parallelTicks is enabled. An object
+   /// that returns true promises that an unmoved tick does not call into
+   /// script, create or delete SimObjects, or touch the Container or any
+   /// other object outside of its own tick group.  The default is false,
+   /// which keeps the object (and everything grouped with it) serial.
+   ///
+   /// @see ProcessList
+   virtual bool isParallelTickSafe() { return false; }
+
+   /// @name Deferred Physics
+   ///
+   /// With $ProcessList::parallelPhysics set, an object that says it can
+   /// defer its physics gets mDeferTickPhysics set before its processTick(0).
+   /// It then stops short of stepping its physics, and once every object
+   /// has ticked the list calls tickPhysics() for it on the thread pool,
+   /// followed by finishTickPhysics() back on the main thread.
+   ///
+   /// tickPhysics() may only touch the object itself and the objects it
+   /// reports from getTickPhysicsContacts(); objects whose contacts overlap
+   /// are stepped one after another, in list order, on the same thread.
+   /// Script calls, Container updates and anything else with side effects
+   /// wait for finishTickPhysics().
+   ///
+   /// @see ProcessList
+   /// @{
+
+   /// Can this tick's physics be deferred?  Only asked on a tick without a move.
+   virtual bool canDeferTickPhysics() { return false; }
+
+   /// Adds every non-static object the deferred step may collide with.
+   virtual void getTickPhysicsContacts(Vector<SceneObject*> &contacts) {}
+
+   /// Runs the deferred physics step, on a worker thread.
+   virtual void tickPhysics() {}
+
+   /// Finishes a deferred tick on the main thread.
+   virtual void finishTickPhysics() {}
+   /// @}
+
+   /// @name Sleeping
+   ///
+   /// A server object that has been at rest for $GameBase::sleepTicks ticks
+   /// in a row, and says it can sleep, is skipped by the ProcessList until
+   /// something wakes it.  It doesn't move while asleep, so it sends no
+   /// updates either.  Moving objects wake the sleepers they touch and a
+   /// woken object wakes the sleepers touching it in turn, so a pile comes
+   /// back all at once.  A sleepTicks of 0, the default, turns sleeping off.
+   /// @{
+
+   static S32 smSleepTicks;
+
+   bool isSleeping() { return mSleeping; }
+
+   /// Called once a tick by objects that can sleep, with whether they were
+   /// at rest for all of it.
+   void updateSleep(bool atRest);
+
+   /// Wakes the object, and the sleeping objects touching it if it was asleep.
+   void wakeUp();
+
+   /// Wakes every sleeping object overlapping box.
+   void wakeTouching(const Box3F &box);
+
+   /// Can the object stop ticking?  Asked once it has been at rest long enough.
+   virtual bool canSleep() { return false; }
+
+  protected:
+   virtual void onSleep() {}
+   virtual void onWake() {}
+
+  public:
+   /// @}
+
+   /// @name Snapshot Interpolation
+   ///
+   /// With $GameBase::snapshotDelay above 0, a client draws the ghosts it
+   /// doesn't control that many ms in the past, going between the states it
+   /// was sent rather than extrapolating and correcting from the newest.
+   /// The objects still simulate in the present; only the render transform
+   /// lags.  Each state is stamped with the client time it arrived at, so
+   /// the delay has to cover the time between updates and their jitter.
+   /// Past the newest state the object holds still.
+   /// @{
+
+   static S32 smSnapshotDelay;
+
+   /// Records the state an update brought.  Classes that don't set their
+   /// transform straight from the update (warping to it, say) call this with
+   /// what they unpacked; the rest have their transform recorded afterwards.
+   void addSnapshot(const MatrixF &mat);
+
+   /// Sets the render transform from the states around client time.
+   /// Returns false if there aren't two states to go between.
+   bool interpolateSnapshots(SimTime time);
+
+   /// Can the render transform come from the snapshots?
+   virtual bool canUseSnapshots() { return true; }
+
+  private:
+   struct Snapshot
+   {
+      SimTime time;
+      Point3F pos;
+      QuatF rot;
+   };
+   enum { SnapshotCount = 8 };
+   Snapshot mSnapshots[SnapshotCount];
+   U32  mSnapshotHead;                    ///< Newest entry.
+   U32  mSnapshotCount;
+   bool mSnapshotPending;                 ///< An update came in without addSnapshot().
+
+  public:
+   /// @}
+
    /// Processes a move event and updates object state once every 32 milliseconds.
    ///
    /// This takes place both on the client and server, every 32 milliseconds (1 tick).
@@ -355,6 +484,23 @@ class GameBase : public SceneObject
 #define TickMask    (TickMs - 1)
 
 /// List to keep track of GameBases to process.
+///
+/// Objects are ticked in dependency order (see GameBase::processAfter).  When
+/// $ProcessList::parallelTicks is set, the ordered list is split into tick
+/// groups: objects connected by processAfter() links (mount chains, control
+/// and orbit relationships) always share a group.  Groups made up entirely
+/// of objects that are parallel tick safe, and that have no controlling
+/// client, are ticked on the thread pool; every other object is ticked
+/// serially in list order afterwards, exactly as before.  Clearing the
+/// variable restores fully serial ticking, which is handy for bisecting
+/// determinism problems.
+///
+/// $ProcessList::parallelPhysics works the other way around, for objects
+/// that can't tick off the main thread but whose physics can (see
+/// GameBase::canDeferTickPhysics()).  They tick serially as usual, minus
+/// the physics step, then the steps run on the thread pool in islands of
+/// objects that may touch each other, then each object finishes its tick
+/// serially in list order.
 class ProcessList
 {
    GameBase head;
@@ -366,10 +512,36 @@ class ProcessList
    bool mDirty;
    static bool mDebugControlSync;
 
+   /// @name Parallel Ticking
+   /// @{
+   Vector<GameBase*> mTickObjects;        ///< Process list snapshot, indexed by GameBase::mTickGroup.
+   Vector<S32>       mTickParent;         ///< Union-find forest over mTickObjects.
+   Vector<GameBase*> mParallelObjects;    ///< Parallel safe objects, grouped, in list order.
+   Vector<U32>       mParallelGroupEnd;   ///< One past the last object of each group.
+
+   S32  findTickGroup(S32 index);
+   void buildTickGroups();
+   void groupParallelObjects(const Vector<bool> &serial);
+   void runParallelGroups(bool physics);
+   void advanceObjectsParallel();
+   /// @}
+
+   /// @name Parallel Physics
+   /// @{
+   Vector<SimObjectId> mPhysicsIds;       ///< Objects asked to defer their physics this tick.
+
+   void buildPhysicsIslands();
+   void advancePhysicsParallel();
+   /// @}
+
    void orderList();
    void advanceObjects();
 
 public:
+   static bool smParallelTicks;           ///< Tick independent groups on the thread pool.
+   static S32  smParallelMinObjects;      ///< Don't bother going parallel below this many objects.
+   static bool smParallelPhysics;         ///< Step deferred physics on the thread pool.
+
    SimTime getLastTime() { return mLastTime; }
    ProcessList(bool isServer);
    void markDirty()  { mDirty = true; }
@@ -18,19 +18,26 @@
 #include "game/gameConnectionEvents.h"
 #include "game/auth.h"
 #include "util/safeDelete.h"
+#include "game/timeDemo.h"
+#include "game/dataBlockCache.h"
+#include "game/missionLoadPipeline.h"
 
 //----------------------------------------------------------------------------
 #define MAX_MOVE_PACKET_SENDS 4
 
 #define ControlRequestTime 5000
 
-const U32 GameConnection::CurrentProtocolVersion = 12;
-const U32 GameConnection::MinRequiredProtocolVersion = 12;
+const U32 GameConnection::CurrentProtocolVersion = 20;
+const U32 GameConnection::MinRequiredProtocolVersion = 20;
 
 //----------------------------------------------------------------------------
 
 IMPLEMENT_CONOBJECT(GameConnection);
 S32 GameConnection::mLagThresholdMS = 0;
+S32 GameConnection::smMinMoveSends = 2;
+S32 GameConnection::smMaxMoveSends = 6;
+S32 GameConnection::smCorrectionSmoothTime = 100;
+F32 GameConnection::smCorrectionSnapDistance = 2.0f;
 
 //----------------------------------------------------------------------------
 GameConnection::GameConnection()
@@ -43,9 +50,17 @@ GameConnection::GameConnection()
    mFirstMoveIndex = 0;
    mMoveCredit = MaxMoveCount;
    mDataBlockModifiedKey = 0;
+   mDataBlockPreloadWaiting = false;
+   mDataBlockPreloadHadNew = false;
    mMaxDataBlockModifiedKey = 0;
+   mDataBlockManifestSequence = 0;
+   mDataBlockManifestStart = 0;
+   mDataBlockManifestTotal = 0;
+   mDataBlockCacheNext = 0;
+   mDataBlockSendStart = U32_MAX;
    mAuthInfo = NULL;
    mLastControlObjectChecksum = 0;
+   resetPrediction();
    mConnectArgc = 0;
    for(U32 i = 0; i < MaxConnectArgs; i++)
       mConnectArgv[i] = 0;
@@ -354,6 +369,7 @@ void GameConnection::setControlObject(ShapeBase *obj)
 
    // Okay, set our control object.
    mControlObject = obj;
+   resetPrediction();
    if(mCameraObject.isNull())
       setScopeObject(mControlObject);
 }
@@ -664,7 +680,7 @@ bool GameConnection::readDemoStartBlock(BitStream *stream)
 
    while(mDataBlockLoadList.size())
    {
-      preloadNextDataBlock(false);
+      preloadNextDataBlock(false, true);
       if(mErrorBuffer[0])
          return false;
    }
@@ -731,6 +747,8 @@ bool GameConnection::readDemoStartBlock(BitStream *stream)
 
 void GameConnection::demoPlaybackComplete()
 {
+   TimeDemo::stop();
+
    static const char *demoPlaybackArgv[1] = { "demoPlaybackComplete" };
    Sim::postCurrentEvent(Sim::getRootGroup(), new SimConsoleEvent(1, demoPlaybackArgv, false));
    Parent::demoPlaybackComplete();
@@ -775,16 +793,15 @@ void GameConnection::readPacket(BitStream *bstream)
          {
             // the control object is dirty...
             // so we get an update:
-            mLastClientMove = mLastMoveAck;
             bool callScript = false;
             if(mControlObject.isNull())
                callScript = true;
 
-            S32 gIndex = bstream->readInt(NetConnection::GhostIdBitSize);
+            S32 gIndex = unpackGhostIndex(bstream);
             ShapeBase* obj = static_cast<ShapeBase*>(resolveGhost(gIndex));
             if (mControlObject != obj)
                setControlObject(obj);
-            obj->readPacketData(this, bstream);
+            readControlCorrection(obj, bstream);
 
             if(callScript)
                Con::executef(this, 2, "initialControlSet");
@@ -802,7 +819,7 @@ void GameConnection::readPacket(BitStream *bstream)
 
       if (bstream->readFlag())
       {
-            S32 gIndex = bstream->readInt(NetConnection::GhostIdBitSize);
+            S32 gIndex = unpackGhostIndex(bstream);
             ShapeBase* obj = static_cast<ShapeBase*>(resolveGhost(gIndex));
             setCameraObject(obj);
             obj->readPacketData(this, bstream);
@@ -866,12 +883,109 @@ void GameConnection::readPacket(BitStream *bstream)
    bstream->setStringBuffer(NULL);
 }
 
+U32 GameConnection::getControlObjectChecksum()
+{
+   if(!mControlObject)
+      return 0;
+
+   mControlObject->interpolateTick(0);
+   U32 sum = mControlObject->getPacketDataChecksum(this);
+   mControlObject->interpolateTick(gClientProcessList.getLastInterpDelta());
+   applyCorrectionOffset();
+   return sum;
+}
+
+//----------------------------------------------------------------------------
+
+void GameConnection::resetPrediction()
+{
+   for (U32 i = 0; i < PredictionHistory; i++)
+      mPredicted[i].id = U32_MAX;
+   mCorrectionPending = false;
+   mCorrectionOffset.set(0, 0, 0);
+   mCorrectionTime = 0;
+   mCorrectionSpan = 0;
+}
+
+void GameConnection::readControlCorrection(ShapeBase *obj, BitStream *bstream)
+{
+   // Hold on to the state the pending moves predicted, at the tick.
+   Point3F drawn = obj->getRenderPosition();
+   obj->interpolateTick(0);
+
+   static U8 buffer[1500];
+   BitStream predicted(buffer, sizeof(buffer));
+   obj->writePacketData(this, &predicted);
+
+   obj->readPacketData(this, bstream);
+
+   // If the server got to the same state for the move it acked, the moves
+   // since would replay to what we already have.
+   const PredictedMove &ack = mPredicted[mLastMoveAck & (PredictionHistory - 1)];
+   if (obj == mControlObject && ack.id == mLastMoveAck &&
+       ack.checksum == obj->getPacketDataChecksum(this))
+   {
+      BitStream restore(buffer, sizeof(buffer));
+      obj->readPacketData(this, &restore);
+      obj->interpolateTick(gClientProcessList.getLastInterpDelta());
+      applyCorrectionOffset();
+      return;
+   }
+
+   // Replay the moves since the ack.  What they record from here on
+   // replaces the old predictions.
+   mLastClientMove = mLastMoveAck;
+   for (U32 i = 0; i < PredictionHistory; i++)
+      mPredicted[i].id = U32_MAX;
+   mCorrectionFrom = drawn;
+   mCorrectionPending = true;
+}
+
+void GameConnection::applyCorrectionOffset()
+{
+   if (mCorrectionTime <= 0 || !mControlObject)
+      return;
+
+   MatrixF mat = mControlObject->getRenderTransform();
+   Point3F pos;
+   mat.getColumn(3, &pos);
+   pos += mCorrectionOffset * (mCorrectionTime / mCorrectionSpan);
+   mat.setColumn(3, pos);
+   mControlObject->setRenderTransform(mat);
+}
+
+void GameConnection::smoothCorrection(F32 dt)
+{
+   if (!mControlObject)
+      return;
+
+   if (mCorrectionPending)
+   {
+      // The replay is done, start from where it was drawn before.
+      mCorrectionPending = false;
+      Point3F offset = mCorrectionFrom - mControlObject->getRenderPosition();
+      if (smCorrectionSmoothTime > 0 && offset.len() < smCorrectionSnapDistance)
+      {
+         mCorrectionOffset = offset;
+         mCorrectionSpan = mCorrectionTime = smCorrectionSmoothTime / 1000.0f;
+         dt = 0;
+      }
+      else
+         mCorrectionTime = 0;
+   }
+
+   if (mCorrectionTime > 0)
+   {
+      mCorrectionTime -= dt;
+      applyCorrectionOffset();
+   }
+}
+
 void GameConnection::writePacket(BitStream *bstream, PacketNotify *note)
 {
-   char stringBuf[256];
    bstream->clearCompressionPoint();
-   stringBuf[0] = 0;
-   bstream->setStringBuffer(stringBuf);
+   mWriteStringBuf[0] = 0;
+   bstream->setStringBuffer(mWriteStringBuf);
 
    GamePacketNotify *gnote = (GamePacketNotify *) note;
 
@@ -879,13 +993,7 @@ void GameConnection::writePacket(BitStream *bstream, PacketNotify *note)
    if (isConnectionToServer())
    {
       bstream->writeFlag(mCameraPos == 0);
-      U32 sum = 0;
-      if(mControlObject)
-      {
-         mControlObject->interpolateTick(0);
-         sum = mControlObject->getPacketDataChecksum(this);
-         mControlObject->interpolateTick(gClientProcessList.getLastInterpDelta());
-      }
+      U32 sum = getControlObjectChecksum();
       // if we're recording, we want to make sure that we get periodic updates of the
       // control object "just in case" - ie if the math copro is different between the
       // recording machine (SIMD vs FPU), we get periodic corrections
@@ -955,7 +1063,7 @@ void GameConnection::writePacket(BitStream *bstream, PacketNotify *note)
 #ifdef TORQUE_DEBUG_NET
             Con::printf("packetDataChecksum disagree!");
 #endif
-            bstream->writeInt(gIndex, NetConnection::GhostIdBitSize);
+            packGhostIndex(bstream, gIndex);
             mControlObject->writePacketData(this, bstream);
          }
          else
@@ -977,7 +1085,7 @@ void GameConnection::writePacket(BitStream *bstream, PacketNotify *note)
          gIndex = getGhostIndex(mCameraObject);
          if (bstream->writeFlag(gIndex != -1))
          {
-            bstream->writeInt(gIndex, NetConnection::GhostIdBitSize);
+            packGhostIndex(bstream, gIndex);
             mCameraObject->writePacketData(this, bstream);
          }
       }
@@ -1001,9 +1109,9 @@ void GameConnection::writePacket(BitStream *bstream, PacketNotify *note)
       DEBUG_LOG(("PKLOG %d PINGCAMSTATE: %d", getId(), bstream->getCurPos() - startPos));
    }
 
+   // The compression point and string buffer stay set for the ghost
+   // updates, finishPacket() clears them.
    Parent::writePacket(bstream, note);
-   bstream->clearCompressionPoint();
-   bstream->setStringBuffer(NULL);
 }
 
 
@@ -1090,6 +1198,7 @@ void GameConnection::doneScopingScene()
 
 void GameConnection::preloadDataBlock(SimDataBlock *db)
 {
+   MissionLoadPipeline::prefetchDataBlock(db);
    mDataBlockLoadList.push_back(db);
    if(mDataBlockLoadList.size() == 1)
       preloadNextDataBlock(true);
@@ -1105,18 +1214,36 @@ void GameConnection::fileDownloadSegmentComplete()
    Parent::fileDownloadSegmentComplete();
 }
 
-void GameConnection::preloadNextDataBlock(bool hadNewFiles)
+void GameConnection::processDataBlockPreloads()
 {
+   if(mDataBlockPreloadWaiting && mDataBlockLoadList.size() &&
+      MissionLoadPipeline::isDataBlockReady(mDataBlockLoadList[0]))
+      preloadNextDataBlock(mDataBlockPreloadHadNew);
+}
+
+void GameConnection::preloadNextDataBlock(bool hadNewFiles, bool force)
+{
+   mDataBlockPreloadWaiting = false;
    if(!mDataBlockLoadList.size())
       return;
    while(mDataBlockLoadList.size())
    {
+      SimDataBlock *object = mDataBlockLoadList[0];
+
+      // Its files are still coming in; the datablocks behind it get to
+      // queue theirs in the meantime, so the reads overlap.
+      if(object && !force && !MissionLoadPipeline::isDataBlockReady(object))
+      {
+         mDataBlockPreloadWaiting = true;
+         mDataBlockPreloadHadNew = hadNewFiles;
+         return;
+      }
+
       // only check for new files if this is the first load, or if new
       // files were downloaded from the server.
       if(hadNewFiles)
          ResourceManager->setMissingFileLogging(true);
       ResourceManager->clearMissingFileList();
-      SimDataBlock *object = mDataBlockLoadList[0];
       if(!object)
       {
          // a null object is used to signify that the last ghost in the list is down
@@ -1208,6 +1335,11 @@ void GameConnection::handleConnectionMessage(U32 message, U32 sequence, U32 ghos
    {
       if(message == DataBlocksDone)
       {
+         // Whatever is left of the manifest comes out of the cache.
+         createCachedDataBlocks(U32_MAX);
+         mDataBlockManifest.clear();
+         DataBlockCache::flush();
+
          mDataBlockLoadList.push_back(NULL);
          mDataBlockSequence = sequence;
          if(mDataBlockLoadList.size() == 1)
@@ -1227,31 +1359,153 @@ void GameConnection::handleConnectionMessage(U32 message, U32 sequence, U32 ghos
 
 //----------------------------------------------------------------------------
 
-ConsoleMethod( GameConnection, transmitDataBlocks, void, 3, 3, "(int sequence)")
+void GameConnection::transmitDataBlocks(U32 sequence)
 {
-   object->setDataBlockSequence(dAtoi(argv[2]));
+   setDataBlockSequence(sequence);
    SimDataBlockGroup *g = Sim::getDataBlockGroup();
 
    // find the first one we haven't sent:
    U32 i, groupCount = g->size();
-   S32 key = object->getDataBlockModifiedKey();
+   S32 key = getDataBlockModifiedKey();
    for(i = 0; i < groupCount; i++)
       if(( (SimDataBlock *)(*g)[i])->getModifiedKey() > key)
          break;
    if (i == groupCount) {
-      object->sendConnectionMessage(GameConnection::DataBlocksDone, object->getDataBlockSequence());
+      sendConnectionMessage(DataBlocksDone, sequence);
       return;
    }
-   object->setMaxDataBlockModifiedKey(key);
+   setMaxDataBlockModifiedKey(key);
+
+   // Send the manifest of the rest; the client answers with the ones it
+   // has cached and sendDataBlocks() ships the others off.
+   mDataBlockSendList.clear();
+   mDataBlockSendStart = i;
+   for(U32 start = i; start < groupCount; start += DataBlockManifestEvent::MaxEntries)
+   {
+      U32 end = getMin(start + U32(DataBlockManifestEvent::MaxEntries), groupCount);
+      DataBlockManifestEvent *evt = new DataBlockManifestEvent(sequence, start, groupCount, start == i, end == groupCount);
+      for(U32 j = start; j < end; j++)
+      {
+         SimDataBlock *data = (SimDataBlock *)(*g)[j];
+         evt->addEntry(data, data->getClassId(getNetClassGroup()), data->getModifiedKey() > key);
+      }
+      postNetEvent(evt);
+   }
+}
+
+void GameConnection::sendDataBlocks(U32 sequence, const Vector<U8> &hits)
+{
+   // Ignore answers to an older transmit, or a second answer.
+   SimDataBlockGroup *g = Sim::getDataBlockGroup();
+   U32 groupCount = g->size();
+   if(sequence != mDataBlockSequence || mDataBlockSendStart >= groupCount)
+      return;
 
-   // Ship the rest off...
-   U32 max = getMin(i + DataBlockQueueCount, groupCount);
-   for (;i < max; i++) {
+   // The skipped blocks count as sent for the modified key.  Anything
+   // added to the group since the manifest went out just gets sent.
+   S32 key = getDataBlockModifiedKey();
+   S32 maxKey = getMaxDataBlockModifiedKey();
+   mDataBlockSendList.clear();
+   for(U32 i = mDataBlockSendStart; i < groupCount; i++)
+   {
       SimDataBlock *data = (SimDataBlock *)(*g)[i];
-      object->postNetEvent(new SimDataBlockEvent(data, i, groupCount, object->getDataBlockSequence()));
+      if(data->getModifiedKey() <= key)
+         continue;
+
+      U32 pos = i - mDataBlockSendStart;
+      if(pos < hits.size() && hits[pos])
+         maxKey = getMax(maxKey, data->getModifiedKey());
+      else
+         mDataBlockSendList.push_back(i);
+   }
+   setMaxDataBlockModifiedKey(maxKey);
+   mDataBlockSendStart = U32_MAX;
+
+   if(!mDataBlockSendList.size())
+   {
+      setDataBlockModifiedKey(maxKey);
+      sendConnectionMessage(DataBlocksDone, sequence);
+      return;
+   }
+
+   // Ship the first few off, notifyDelivered() sends the rest.
+   U32 max = getMin(U32(DataBlockQueueCount), U32(mDataBlockSendList.size()));
+   for(U32 pos = 0; pos < max; pos++)
+   {
+      U32 index = mDataBlockSendList[pos];
+      SimDataBlock *data = (SimDataBlock *)(*g)[index];
+      postNetEvent(new SimDataBlockEvent(data, index, groupCount, sequence, pos));
+   }
+}
+
+void GameConnection::receiveDataBlockManifest(U32 sequence, U32 start, U32 total, bool first, bool last,
+                                              const Vector<DataBlockManifestEntry> &entries)
+{
+   if(first)
+   {
+      mDataBlockManifest.clear();
+      mDataBlockManifestSequence = sequence;
+      mDataBlockManifestStart = start;
+      mDataBlockManifestTotal = total;
+      mDataBlockCacheNext = 0;
+   }
+   if(sequence != mDataBlockManifestSequence || start != mDataBlockManifestStart + mDataBlockManifest.size())
+   {
+      setLastError("Invalid datablock manifest.");
+      return;
+   }
+
+   for(U32 i = 0; i < entries.size(); i++)
+   {
+      mDataBlockManifest.push_back(entries[i]);
+      DataBlockManifestEntry &entry = mDataBlockManifest.last();
+      entry.cached = entry.modified && DataBlockCache::find(entry.hash, entry.classId, entry.bitCount) != NULL;
+   }
+   if(!last)
+      return;
+
+   DataBlockCacheHitsEvent *evt = new DataBlockCacheHitsEvent(sequence);
+   for(U32 i = 0; i < mDataBlockManifest.size(); i++)
+      evt->addHit(mDataBlockManifest[i].cached);
+   postNetEvent(evt);
+}
+
+void GameConnection::createCachedDataBlocks(U32 end)
+{
+   while(mDataBlockCacheNext < mDataBlockManifest.size() &&
+         mDataBlockManifestStart + mDataBlockCacheNext < end)
+   {
+      U32 index = mDataBlockManifestStart + mDataBlockCacheNext;
+      const DataBlockManifestEntry &entry = mDataBlockManifest[mDataBlockCacheNext++];
+      if(!entry.cached)
+         continue;
+
+      const U8 *bits = DataBlockCache::find(entry.hash, entry.classId, entry.bitCount);
+      SimObject *ptr = bits ? (SimObject *) ConsoleObject::create(getNetClassGroup(), NetClassTypeDataBlock, entry.classId) : NULL;
+      SimDataBlock *obj = dynamic_cast<SimDataBlock *>(ptr);
+      if(!obj)
+      {
+         delete ptr;
+         setLastError("Invalid cached datablock.");
+         return;
+      }
+
+      U8 buffer[MaxPacketDataSize];
+      dMemset(buffer, 0, sizeof(buffer));
+      dMemcpy(buffer, bits, (entry.bitCount + 7) >> 3);
+      BitStream stream(buffer, MaxPacketDataSize);
+      obj->unpackData(&stream);
+
+      if(!SimDataBlockEvent::addDataBlock(this, entry.id, obj, index, mDataBlockManifestTotal))
+         delete obj;
    }
 }
 
+ConsoleMethod( GameConnection, transmitDataBlocks, void, 3, 3, "(int sequence)")
+{
+   object->transmitDataBlocks(dAtoi(argv[2]));
+}
+
 ConsoleMethod( GameConnection, activateGhosting, void, 2, 2, "")
 {
    object->activateGhosting();
@@ -1371,7 +1625,12 @@ ConsoleMethod( GameConnection, delete, void, 2, 3, "(string reason=NULL) Disconn
 void GameConnection::consoleInit()
 {
    Con::addVariable("Pref::Net::LagThreshold", TypeS32, &mLagThresholdMS);
+   Con::addVariable("Pref::Net::MinMoveSends", TypeS32, &smMinMoveSends);
+   Con::addVariable("Pref::Net::MaxMoveSends", TypeS32, &smMaxMoveSends);
+   Con::addVariable("Pref::Net::CorrectionSmoothTime", TypeS32, &smCorrectionSmoothTime);
+   Con::addVariable("Pref::Net::CorrectionSnapDistance", TypeF32, &smCorrectionSnapDistance);
    Con::addVariable("specialFog", TypeBool, &SceneGraph::useSpecial);
+   DataBlockCache::consoleInit();
 }
 
 ConsoleMethod(GameConnection, startRecording, void, 3, 3, "(string fileName)records the network connection to a demo file.")
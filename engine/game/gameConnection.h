@@ -80,6 +80,8 @@ private:
    /// @{
 
    ///
+   /// How many packets each move goes out in, from the packet loss.
+   U32 getMoveSendCount();
    void moveWritePacket(BitStream *bstream);
    void moveReadPacket(BitStream *bstream);
    /// @}
@@ -111,6 +113,17 @@ public:
       DataBlocksDownloadDone,
    };
 
+   /// A datablock in the server's manifest, see DataBlockCache.
+   struct DataBlockManifestEntry
+   {
+      SimObjectId id;
+      U32  classId;
+      U32  hash;
+      U32  bitCount;
+      bool modified;    ///< Changed since the last transmit; the rest aren't resent.
+      bool cached;      ///< Client side, we have it in the cache.
+   };
+
    /// Set connection arguments; these are passed to the server when we connect.
    void setConnectArgs(U32 argc, const char **argv);
 
@@ -165,15 +178,67 @@ protected:
    U32 mLastControlObjectChecksum;
 
    Vector<SimDataBlock *> mDataBlockLoadList;
+   bool mDataBlockPreloadWaiting;   ///< Head of the list waits on its prefetches.
+   bool mDataBlockPreloadHadNew;    ///< hadNew for when it resumes.
+
+   /// @name Datablock cache
+   /// @{
+   Vector<DataBlockManifestEntry> mDataBlockManifest;  ///< Client side, from the server's manifest.
+   U32 mDataBlockManifestSequence;
+   U32 mDataBlockManifestStart;     ///< Group index of the first manifest entry.
+   U32 mDataBlockManifestTotal;
+   U32 mDataBlockCacheNext;         ///< Next manifest entry to create from the cache.
+   Vector<U32> mDataBlockSendList;  ///< Server side, the group indices the client didn't have.
+   U32 mDataBlockSendStart;
+   /// @}
 
    MoveList    mMoveList;
    bool        mAIControlled;
    AuthInfo *  mAuthInfo;
 
    static S32  mLagThresholdMS;
+   static S32  smMinMoveSends;   ///< Pref::Net::MinMoveSends
+   static S32  smMaxMoveSends;   ///< Pref::Net::MaxMoveSends
    S32         mLastPacketTime;
    bool        mLagging;
 
+   /// String buffer of the packet being written.  Deferred ghost updates are
+   /// written after writePacket() returns, so it can't live on its stack;
+   /// NetConnection::finishPacket() takes it off the stream.
+   char        mWriteStringBuf[256];
+
+   /// @name Prediction
+   ///
+   /// The client keeps the checksum of the control object's state after each
+   /// move it predicts.  A correction that matches the prediction for the
+   /// move it acks puts back the predicted state instead of replaying every
+   /// move since.  A correction that doesn't is replayed, and the jump it
+   /// makes is eased out of the render transform over
+   /// $Pref::Net::CorrectionSmoothTime ms, unless it's further than
+   /// $Pref::Net::CorrectionSnapDistance.
+   /// @{
+   struct PredictedMove
+   {
+      U32 id;                    ///< Move index the state is after, U32_MAX if none.
+      U32 checksum;
+   };
+   enum { PredictionHistory = 64 };   ///< Power of two, more than MaxMoveCount.
+   PredictedMove mPredicted[PredictionHistory];
+
+   bool     mCorrectionPending;   ///< A correction is being replayed.
+   Point3F  mCorrectionFrom;      ///< Where the control object was drawn before it.
+   Point3F  mCorrectionOffset;
+   F32      mCorrectionTime;      ///< Seconds left to ease out mCorrectionOffset.
+   F32      mCorrectionSpan;
+
+   static S32  smCorrectionSmoothTime;    ///< Pref::Net::CorrectionSmoothTime
+   static F32  smCorrectionSnapDistance;  ///< Pref::Net::CorrectionSnapDistance
+
+   void resetPrediction();
+   void readControlCorrection(ShapeBase *obj, BitStream *bstream);
+   void applyCorrectionOffset();
+   /// @}
+
    /// @name Flashing
    ////
    /// Note, these variables are not networked, they are for the local connection only.
@@ -193,6 +258,9 @@ protected:
 
    void readPacket      (BitStream *bstream);
    void writePacket     (BitStream *bstream, PacketNotify *note);
+   /// Checksum of the control object's state, sent to the server so it
+   /// only sends control object updates when the client disagrees.
+   virtual U32 getControlObjectChecksum();
    void packetReceived  (PacketNotify *note);
    void packetDropped   (PacketNotify *note);
    void connectionError (const char *errorString);
@@ -208,7 +276,13 @@ public:
    void handleConnectionMessage(U32 message, U32 sequence, U32 ghostCount);
    void preloadDataBlock(SimDataBlock *block);
    void fileDownloadSegmentComplete();
-   void preloadNextDataBlock(bool hadNew);
+   /// Preloads the datablocks in mDataBlockLoadList, in order.  Unless
+   /// forced, stops at one whose files are still loading in the background
+   /// (MissionLoadPipeline::isDataBlockReady()) and picks up from there in
+   /// processDataBlockPreloads().
+   void preloadNextDataBlock(bool hadNew, bool force = false);
+   /// Called every client frame.
+   void processDataBlockPreloads();
    static void consoleInit();
 
    void setDisconnectReason(const char *reason);
@@ -248,6 +322,20 @@ public:
    /// @name Datablock management
    /// @{
 
+   /// Sends the datablocks modified since the last transmit, or just
+   /// their manifest if the client may have some of them cached.
+   void transmitDataBlocks(U32 sequence);
+   /// Server side, sends the datablocks the client doesn't have cached.
+   void sendDataBlocks(U32 sequence, const Vector<U8> &hits);
+   const Vector<U32> &getDataBlockSendList() { return mDataBlockSendList; }
+
+   /// Client side, notes which datablocks in the manifest are cached and
+   /// answers the server once it's all arrived.
+   void receiveDataBlockManifest(U32 sequence, U32 start, U32 total, bool first, bool last,
+                                 const Vector<DataBlockManifestEntry> &entries);
+   /// Client side, creates the cached datablocks before group index end.
+   void createCachedDataBlocks(U32 end);
+
    S32  getDataBlockModifiedKey     ()  { return mDataBlockModifiedKey; }
    void setDataBlockModifiedKey     (S32 key)  { mDataBlockModifiedKey = key; }
    S32  getMaxDataBlockModifiedKey  ()  { return mMaxDataBlockModifiedKey; }
@@ -275,6 +363,10 @@ public:
    void           collectMove(U32 simTime);
    virtual bool   areMovesPending();
    void           incMoveCredit(U32 count);
+
+   /// Eases the control object out of the last correction, by dt seconds.
+   /// Called by the client process list once the objects are interpolated.
+   void           smoothCorrection(F32 dt);
    /// @}
 
    /// @name Authentication
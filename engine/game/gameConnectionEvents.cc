@@ -15,12 +15,18 @@
 #include "game/gameConnection.h"
 #include "game/shapeBase.h"
 #include "game/gameConnectionEvents.h"
+#include "game/dataBlockCache.h"
 
 //--------------------------------------------------------------------------
 IMPLEMENT_CO_CLIENTEVENT_V1(SimDataBlockEvent);
 IMPLEMENT_CO_CLIENTEVENT_V1(Sim2DAudioEvent);
 IMPLEMENT_CO_CLIENTEVENT_V1(Sim3DAudioEvent);
 IMPLEMENT_CO_CLIENTEVENT_V1(SetMissionCRCEvent);
+IMPLEMENT_CO_CLIENTEVENT_V1(DataBlockManifestEvent);
+IMPLEMENT_CO_SERVEREVENT_V1(DataBlockCacheHitsEvent);
+
+// Enough for the bits of the largest datablock that fits in a packet.
+static const U32 csDataBlockBitCountBits = 14;
 
 
 //----------------------------------------------------------------------------
@@ -29,12 +35,13 @@ SimDataBlockEvent::~SimDataBlockEvent()
 {
    delete mObj;
 }
-SimDataBlockEvent::SimDataBlockEvent(SimDataBlock* obj, U32 index, U32 total, U32 missionSequence)
+SimDataBlockEvent::SimDataBlockEvent(SimDataBlock* obj, U32 index, U32 total, U32 missionSequence, U32 sendPos)
 {
    mObj = NULL;
    mIndex = index;
    mTotal = total;
    mMissionSequence = missionSequence;
+   mSendPos = sendPos;
    mProcess = false;
 
    if(obj)
@@ -69,20 +76,37 @@ void SimDataBlockEvent::notifyDelivered(NetConnection *conn, bool )
    if(gc->getDataBlockSequence() != mMissionSequence)
       return;
 
-   U32 nextIndex = mIndex + DataBlockQueueCount;
+   // Only the blocks the client didn't have cached are in the send list.
+   const Vector<U32> &sendList = gc->getDataBlockSendList();
+   U32 nextPos = mSendPos + DataBlockQueueCount;
    SimDataBlockGroup *g = Sim::getDataBlockGroup();
 
-   if(mIndex == g->size() - 1)
+   if(mSendPos == sendList.size() - 1)
    {
       gc->setDataBlockModifiedKey(gc->getMaxDataBlockModifiedKey());
       gc->sendConnectionMessage(GameConnection::DataBlocksDone, mMissionSequence);
    }
-   if(g->size() <= nextIndex)
+   if(sendList.size() <= nextPos)
    {
       return;
    }
+   U32 nextIndex = sendList[nextPos];
    SimDataBlock *blk = (SimDataBlock *) (*g)[nextIndex];
-   gc->postNetEvent(new SimDataBlockEvent(blk, nextIndex, g->size(), mMissionSequence));
+   gc->postNetEvent(new SimDataBlockEvent(blk, nextIndex, g->size(), mMissionSequence, nextPos));
+}
+
+U32 SimDataBlockEvent::packDataBlock(SimDataBlock *obj, U8 *buffer)
+{
+   dMemset(buffer, 0, MaxPacketDataSize);
+   BitStream stream(buffer, MaxPacketDataSize);
+   obj->packData(&stream);
+
+   // Clear anything past the last bit so the hash is stable.
+   U32 bitCount = stream.getCurPos();
+   if(bitCount & 7)
+      buffer[bitCount >> 3] &= (1 << (bitCount & 7)) - 1;
+   dMemset(buffer + ((bitCount + 7) >> 3), 0, MaxPacketDataSize - ((bitCount + 7) >> 3));
+   return bitCount;
 }
 
 void SimDataBlockEvent::pack(NetConnection *conn, BitStream *bstream)
@@ -103,7 +127,11 @@ void SimDataBlockEvent::pack(NetConnection *conn, BitStream *bstream)
       bstream->writeClassId(classId, NetClassTypeDataBlock, conn->getNetClassGroup());
       bstream->writeInt(mIndex, DataBlockObjectIdBitSize);
       bstream->writeInt(mTotal, DataBlockObjectIdBitSize + 1);
-      obj->packData(bstream);
+
+      U8 buffer[MaxPacketDataSize];
+      U32 bitCount = packDataBlock(obj, buffer);
+      bstream->writeInt(bitCount, csDataBlockBitCountBits);
+      bstream->writeBits(bitCount, buffer);
    }
 }
 
@@ -117,10 +145,26 @@ void SimDataBlockEvent::unpack(NetConnection *cptr, BitStream *bstream)
       mIndex = bstream->readInt(DataBlockObjectIdBitSize);
       mTotal = bstream->readInt(DataBlockObjectIdBitSize + 1);
 
+      U8 buffer[MaxPacketDataSize];
+      dMemset(buffer, 0, sizeof(buffer));
+      U32 bitCount = bstream->readInt(csDataBlockBitCountBits);
+      if(bitCount > MaxPacketDataSize << 3)
+      {
+         cptr->setLastError("Invalid packet in SimDataBlockEvent::unpack()");
+         return;
+      }
+      bstream->readBits(bitCount, buffer);
+      if(bitCount & 7)
+         buffer[bitCount >> 3] &= (1 << (bitCount & 7)) - 1;
+
       SimObject* ptr = (SimObject *) ConsoleObject::create(cptr->getNetClassGroup(), NetClassTypeDataBlock, classId);
       if ((mObj = dynamic_cast<SimDataBlock*>(ptr)) != 0) {
          //Con::printf(" - SimDataBlockEvent: unpacking event of type: %s", mObj->getClassName());
-         mObj->unpackData(bstream);
+         BitStream stream(buffer, MaxPacketDataSize);
+         mObj->unpackData(&stream);
+
+         if(!cptr->isPlayingBack())
+            DataBlockCache::insert(DataBlockCache::computeHash(buffer, bitCount), classId, bitCount, buffer);
       }
       else
       {
@@ -140,7 +184,11 @@ void SimDataBlockEvent::write(NetConnection *cptr, BitStream *bstream)
       bstream->writeClassId(classId, NetClassTypeDataBlock, cptr->getNetClassGroup());
       bstream->writeInt(mIndex, DataBlockObjectIdBitSize);
       bstream->writeInt(mTotal, DataBlockObjectIdBitSize + 1);
-      mObj->packData(bstream);
+
+      U8 buffer[MaxPacketDataSize];
+      U32 bitCount = packDataBlock(mObj, buffer);
+      bstream->writeInt(bitCount, csDataBlockBitCountBits);
+      bstream->writeBits(bitCount, buffer);
    }
 }
 
@@ -148,41 +196,174 @@ void SimDataBlockEvent::process(NetConnection *cptr)
 {
    if(mProcess)
    {
-      //call the console function to set the number of blocks to be sent
-      Con::executef(3, "onDataBlockObjectReceived", Con::getIntArg(mIndex), Con::getIntArg(mTotal));
+      GameConnection *conn = dynamic_cast<GameConnection *>(cptr);
+      if(!conn)
+         return;
+
+      // The cached blocks in front of this one go in first, in order.
+      conn->createCachedDataBlocks(mIndex);
+      if(addDataBlock(conn, id, mObj, mIndex, mTotal))
+         mObj = NULL;
+   }
+}
 
-      SimDataBlock* obj = NULL;
-      char *errorBuffer = NetConnection::getErrorBuffer();
+bool SimDataBlockEvent::addDataBlock(GameConnection *conn, SimObjectId id, SimDataBlock *obj, U32 index, U32 total)
+{
+   //call the console function to set the number of blocks to be sent
+   Con::executef(3, "onDataBlockObjectReceived", Con::getIntArg(index), Con::getIntArg(total));
 
-      if( Sim::findObject( id,obj ) && dStrcmp( obj->getClassName(),mObj->getClassName() ) == 0 )
-      {
-         U8 buf[1500];
-         BitStream stream(buf, 1500);
-         mObj->packData(&stream);
-         stream.setPosition(0);
-         obj->unpackData(&stream);
-         obj->preload(false, errorBuffer);
-      }
-      else
+   SimDataBlock* existing = NULL;
+   char *errorBuffer = NetConnection::getErrorBuffer();
+
+   if( Sim::findObject( id,existing ) && dStrcmp( existing->getClassName(),obj->getClassName() ) == 0 )
+   {
+      U8 buf[MaxPacketDataSize];
+      BitStream stream(buf, MaxPacketDataSize);
+      obj->packData(&stream);
+      stream.setPosition(0);
+      existing->unpackData(&stream);
+      existing->preload(false, errorBuffer);
+      return false;
+   }
+
+   if( existing != NULL )
+   {
+      Con::warnf( "A '%s' datablock with id: %d already existed. Clobbering it with new '%s' datablock from server.", existing->getClassName(), id, obj->getClassName() );
+      existing->deleteObject();
+   }
+
+   obj->registerObject(id);
+   conn->addObject(obj);
+   conn->preloadDataBlock(obj);
+   return true;
+}
+
+
+//----------------------------------------------------------------------------
+
+DataBlockManifestEvent::DataBlockManifestEvent(U32 sequence, U32 start, U32 total, bool first, bool last)
+{
+   mSequence = sequence;
+   mStart = start;
+   mTotal = total;
+   mFirst = first;
+   mLast = last;
+}
+
+void DataBlockManifestEvent::addEntry(SimDataBlock *obj, U32 classId, bool modified)
+{
+   mEntries.increment();
+   GameConnection::DataBlockManifestEntry &entry = mEntries.last();
+   entry.id       = obj->getId();
+   entry.classId  = classId;
+   entry.bitCount = 0;
+   entry.hash     = 0;
+   entry.modified = modified;
+   entry.cached   = false;
+
+   if(modified)
+   {
+      U8 buffer[MaxPacketDataSize];
+      entry.bitCount = SimDataBlockEvent::packDataBlock(obj, buffer);
+      entry.hash     = DataBlockCache::computeHash(buffer, entry.bitCount);
+   }
+}
+
+void DataBlockManifestEvent::pack(NetConnection *conn, BitStream *bstream)
+{
+   bstream->write(mSequence);
+   bstream->writeInt(mStart, DataBlockObjectIdBitSize + 1);
+   bstream->writeInt(mTotal, DataBlockObjectIdBitSize + 1);
+   bstream->writeFlag(mFirst);
+   bstream->writeFlag(mLast);
+   bstream->writeRangedU32(mEntries.size(), 0, MaxEntries);
+   for(U32 i = 0; i < mEntries.size(); i++)
+   {
+      const GameConnection::DataBlockManifestEntry &entry = mEntries[i];
+      if(!bstream->writeFlag(entry.modified))
+         continue;
+      bstream->writeInt(entry.id - DataBlockObjectIdFirst, DataBlockObjectIdBitSize);
+      bstream->writeClassId(entry.classId, NetClassTypeDataBlock, conn->getNetClassGroup());
+      bstream->writeInt(entry.bitCount, csDataBlockBitCountBits);
+      bstream->write(entry.hash);
+   }
+}
+
+void DataBlockManifestEvent::write(NetConnection *conn, BitStream *bstream)
+{
+   pack(conn, bstream);
+}
+
+void DataBlockManifestEvent::unpack(NetConnection *conn, BitStream *bstream)
+{
+   bstream->read(&mSequence);
+   mStart = bstream->readInt(DataBlockObjectIdBitSize + 1);
+   mTotal = bstream->readInt(DataBlockObjectIdBitSize + 1);
+   mFirst = bstream->readFlag();
+   mLast = bstream->readFlag();
+   U32 count = bstream->readRangedU32(0, MaxEntries);
+   mEntries.setSize(count);
+   for(U32 i = 0; i < count; i++)
+   {
+      GameConnection::DataBlockManifestEntry &entry = mEntries[i];
+      entry.cached   = false;
+      entry.modified = bstream->readFlag();
+      if(!entry.modified)
       {
-         if( obj != NULL )
-         {
-            Con::warnf( "A '%s' datablock with id: %d already existed. Clobbering it with new '%s' datablock from server.", obj->getClassName(), id, mObj->getClassName() );
-            obj->deleteObject();
-         }
-
-         bool reg = mObj->registerObject(id);
-         cptr->addObject(mObj);
-         GameConnection *conn = dynamic_cast<GameConnection *>(cptr);
-         if(conn)
-         {
-            conn->preloadDataBlock(mObj);
-            mObj = NULL;
-         }
+         entry.id = 0;
+         entry.classId = entry.bitCount = entry.hash = 0;
+         continue;
       }
+      entry.id       = bstream->readInt(DataBlockObjectIdBitSize) + DataBlockObjectIdFirst;
+      entry.classId  = bstream->readClassId(NetClassTypeDataBlock, conn->getNetClassGroup());
+      entry.bitCount = bstream->readInt(csDataBlockBitCountBits);
+      bstream->read(&entry.hash);
    }
 }
 
+void DataBlockManifestEvent::process(NetConnection *conn)
+{
+   GameConnection *gc = dynamic_cast<GameConnection *>(conn);
+   if(gc)
+      gc->receiveDataBlockManifest(mSequence, mStart, mTotal, mFirst, mLast, mEntries);
+}
+
+//----------------------------------------------------------------------------
+
+DataBlockCacheHitsEvent::DataBlockCacheHitsEvent(U32 sequence)
+{
+   mSequence = sequence;
+}
+
+void DataBlockCacheHitsEvent::pack(NetConnection *, BitStream *bstream)
+{
+   bstream->write(mSequence);
+   bstream->writeInt(mHits.size(), DataBlockObjectIdBitSize + 1);
+   for(U32 i = 0; i < mHits.size(); i++)
+      bstream->writeFlag(mHits[i]);
+}
+
+void DataBlockCacheHitsEvent::write(NetConnection *conn, BitStream *bstream)
+{
+   pack(conn, bstream);
+}
+
+void DataBlockCacheHitsEvent::unpack(NetConnection *, BitStream *bstream)
+{
+   bstream->read(&mSequence);
+   U32 count = bstream->readInt(DataBlockObjectIdBitSize + 1);
+   mHits.setSize(count);
+   for(U32 i = 0; i < count; i++)
+      mHits[i] = bstream->readFlag();
+}
+
+void DataBlockCacheHitsEvent::process(NetConnection *conn)
+{
+   GameConnection *gc = dynamic_cast<GameConnection *>(conn);
+   if(gc)
+      gc->sendDataBlocks(mSequence, mHits);
+}
+
 
 //----------------------------------------------------------------------------
 
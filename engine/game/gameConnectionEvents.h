@@ -21,10 +21,23 @@ class SimDataBlockEvent : public NetEvent
    U32 mIndex;
    U32 mTotal;
    U32 mMissionSequence;
+   U32 mSendPos;     ///< Position in the connection's datablock send list.
    bool mProcess;
   public:
    ~SimDataBlockEvent();
-   SimDataBlockEvent(SimDataBlock* obj = NULL, U32 index = 0, U32 total = 0, U32 missionSequence = 0);
+   SimDataBlockEvent(SimDataBlock* obj = NULL, U32 index = 0, U32 total = 0, U32 missionSequence = 0, U32 sendPos = 0);
+
+   /// Packs a datablock on its own, without the packet's string
+   /// compression, so the bits only depend on the datablock and can be
+   /// hashed and cached.  Returns the bit count; the rest of the buffer
+   /// is zeroed.
+   static U32 packDataBlock(SimDataBlock *obj, U8 *buffer);
+
+   /// Adds a datablock unpacked from the server, from an event or the
+   /// cache.  Returns false if an existing datablock was updated instead,
+   /// in which case the caller still owns obj.
+   static bool addDataBlock(GameConnection *conn, SimObjectId id, SimDataBlock *obj, U32 index, U32 total);
+
    void pack(NetConnection *, BitStream *bstream);
    void write(NetConnection *, BitStream *bstream);
    void unpack(NetConnection *cptr, BitStream *bstream);
@@ -36,6 +49,54 @@ class SimDataBlockEvent : public NetEvent
    DECLARE_CONOBJECT(SimDataBlockEvent);
 };
 
+/// The class, size and hash of the datablocks the server is about to send,
+/// so the client can say which ones it already has in its DataBlockCache.
+class DataBlockManifestEvent : public NetEvent
+{
+   typedef NetEvent Parent;
+
+   U32 mSequence;
+   U32 mStart;
+   U32 mTotal;
+   bool mFirst;
+   bool mLast;
+   Vector<GameConnection::DataBlockManifestEntry> mEntries;
+
+  public:
+   enum Constants {
+      MaxEntries = 64
+   };
+
+   DataBlockManifestEvent(U32 sequence = 0, U32 start = 0, U32 total = 0, bool first = false, bool last = false);
+   void addEntry(SimDataBlock *obj, U32 classId, bool modified);
+
+   void pack(NetConnection *, BitStream *bstream);
+   void write(NetConnection *, BitStream *bstream);
+   void unpack(NetConnection *, BitStream *bstream);
+   void process(NetConnection *);
+   DECLARE_CONOBJECT(DataBlockManifestEvent);
+};
+
+/// The client's answer to the manifest: a flag for each datablock from the
+/// manifest's first index on, set if it came out of the cache.
+class DataBlockCacheHitsEvent : public NetEvent
+{
+   typedef NetEvent Parent;
+
+   U32 mSequence;
+   Vector<U8> mHits;
+
+  public:
+   DataBlockCacheHitsEvent(U32 sequence = 0);
+   void addHit(bool hit) { mHits.push_back(hit); }
+
+   void pack(NetConnection *, BitStream *bstream);
+   void write(NetConnection *, BitStream *bstream);
+   void unpack(NetConnection *, BitStream *bstream);
+   void process(NetConnection *);
+   DECLARE_CONOBJECT(DataBlockCacheHitsEvent);
+};
+
 class Sim2DAudioEvent: public NetEvent
 {
   private:
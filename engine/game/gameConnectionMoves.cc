@@ -38,8 +38,6 @@ F32 MoveManager::mRollRightSpeed = 0;
 U32 MoveManager::mTriggerCount[MaxTriggerKeys] = { 0, };
 U32 MoveManager::mPrevTriggerCount[MaxTriggerKeys] = { 0, };
 
-#define MAX_MOVE_PACKET_SENDS 4
-
 const Move NullMove =
 {
    16,16,16,
@@ -175,6 +173,80 @@ void Move::unpack(BitStream *stream)
       trigger[i] = stream->readFlag();
 }
 
+void Move::packDelta(BitStream *stream, const Move &prev)
+{
+   // The angles are per move deltas, usually zero rather than a repeat of
+   // the last one, and already cost a bit each when they are.
+   if(stream->writeFlag(pyaw != 0))
+      stream->writeInt(pyaw, 16);
+   if(stream->writeFlag(ppitch != 0))
+      stream->writeInt(ppitch, 16);
+   if(stream->writeFlag(proll != 0))
+      stream->writeInt(proll, 16);
+
+   if(stream->writeFlag(px != prev.px || py != prev.py || pz != prev.pz))
+   {
+      stream->writeInt(px, 6);
+      stream->writeInt(py, 6);
+      stream->writeInt(pz, 6);
+   }
+
+   bool buttonsChanged = freeLook != prev.freeLook;
+   for(U32 i = 0; i < MaxTriggerKeys; i++)
+      buttonsChanged |= trigger[i] != prev.trigger[i];
+   if(stream->writeFlag(buttonsChanged))
+   {
+      stream->writeFlag(freeLook);
+      for(U32 i = 0; i < MaxTriggerKeys; i++)
+         stream->writeFlag(trigger[i]);
+   }
+}
+
+void Move::unpackDelta(BitStream *stream, const Move &prev)
+{
+   pyaw   = stream->readFlag() ? stream->readInt(16) : 0;
+   ppitch = stream->readFlag() ? stream->readInt(16) : 0;
+   proll  = stream->readFlag() ? stream->readInt(16) : 0;
+
+   if(stream->readFlag())
+   {
+      px = stream->readInt(6);
+      py = stream->readInt(6);
+      pz = stream->readInt(6);
+   }
+   else
+   {
+      px = prev.px;
+      py = prev.py;
+      pz = prev.pz;
+   }
+   unclamp();
+
+   if(stream->readFlag())
+   {
+      freeLook = stream->readFlag();
+      for(U32 i = 0; i < MaxTriggerKeys; i++)
+         trigger[i] = stream->readFlag();
+   }
+   else
+   {
+      freeLook = prev.freeLook;
+      for(U32 i = 0; i < MaxTriggerKeys; i++)
+         trigger[i] = prev.trigger[i];
+   }
+}
+
+bool Move::isPackedEqual(const Move &other) const
+{
+   if(pyaw != other.pyaw || ppitch != other.ppitch || proll != other.proll ||
+      px != other.px || py != other.py || pz != other.pz || freeLook != other.freeLook)
+      return false;
+   for(U32 i = 0; i < MaxTriggerKeys; i++)
+      if(trigger[i] != other.trigger[i])
+         return false;
+   return true;
+}
+
 bool GameConnection::getNextMove(Move &curMove)
 {
    if(mMoveList.size() > MaxMoveQueueSize)
@@ -257,6 +329,13 @@ void GameConnection::clearMoves(U32 count)
 {
    if (isConnectionToServer()) {
       mLastClientMove += count;
+
+      // Note what the moves predicted, to check the server's state against.
+      if (count && mControlObject) {
+         PredictedMove &p = mPredicted[mLastClientMove & (PredictionHistory - 1)];
+         p.id = mLastClientMove;
+         p.checksum = mControlObject->getPacketDataChecksum(this);
+      }
    }
    else {
       AssertFatal(count <= mMoveList.size(),"GameConnection: Clearing too many moves");
@@ -299,6 +378,22 @@ bool GameConnection::isBacklogged()
 }
 
 
+U32 GameConnection::getMoveSendCount()
+{
+   // Enough sends that a move is lost in all of them less than once in a
+   // thousand at the current loss; the loss is an average, so keep a floor.
+   U32 maxSends = getMax(smMaxMoveSends, 1);
+   U32 sends = mClamp(smMinMoveSends, 1, maxSends);
+   F32 loss = getPacketLoss();
+   F32 allLost = mPow(loss, F32(sends));
+   while(sends < maxSends && allLost > 0.001f)
+   {
+      sends++;
+      allLost *= loss;
+   }
+   return sends;
+}
+
 void GameConnection::moveWritePacket(BitStream *bstream)
 {
    Move* move;
@@ -307,9 +402,10 @@ void GameConnection::moveWritePacket(BitStream *bstream)
    count = mMoveList.size();
    move = mMoveList.address();
    U32 start = mLastMoveAck;
+   U32 maxSends = getMoveSendCount();
    U32 offset;
    for(offset = 0; offset < count; offset++)
-      if(move[offset].sendCount < MAX_MOVE_PACKET_SENDS)
+      if(move[offset].sendCount < maxSends)
          break;
    if(offset == count && count != 0)
       offset--;
@@ -321,10 +417,28 @@ void GameConnection::moveWritePacket(BitStream *bstream)
       count = MaxMoveCount;
    bstream->writeInt(start,32);
    bstream->writeInt(count,MoveCountBits);
-   for (int i = 0; i < count; i++)
+
+   // Each move is packed against the one before it in the same packet, the
+   // first against NullMove, since the server may not have any other.  A
+   // run of identical moves (standing still, holding a key) goes as a count.
+   const Move *prev = &NullMove;
+   for (U32 i = 0; i < count; )
    {
-      move[offset + i].sendCount++;
-      move[offset + i].pack(bstream);
+      Move &mv = move[offset + i];
+      mv.packDelta(bstream, *prev);
+      mv.sendCount++;
+      prev = &mv;
+      i++;
+
+      U32 run = 0;
+      while (i + run < count && move[offset + i + run].isPackedEqual(mv))
+      {
+         move[offset + i + run].sendCount++;
+         run++;
+      }
+      if (bstream->writeFlag(run != 0))
+         bstream->writeInt(run - 1, MoveCountBits);
+      i += run;
    }
 }
 
@@ -334,19 +448,30 @@ void GameConnection::moveReadPacket(BitStream *bstream)
    U32 start = bstream->readInt(32);
    U32 count = bstream->readInt(MoveCountBits);
 
+   // The moves are delta packed against each other, so they all have to
+   // be read before any can be skipped.
+   Move moves[1 << MoveCountBits];
+   const Move *prev = &NullMove;
+   for (U32 i = 0; i < count; )
+   {
+      moves[i].unpackDelta(bstream, *prev);
+      prev = &moves[i++];
+      if (bstream->readFlag())
+         for (U32 run = bstream->readInt(MoveCountBits) + 1; run && i < count; run--)
+            moves[i++] = *prev;
+   }
+
    // Skip forward (must be starting up), or over the moves
    // we already have.
    int skip = mLastMoveAck - start;
    if (skip < 0) {
       mLastMoveAck = start;
+      skip = 0;
       //mMoveList.clear();
    }
    else {
-      Move tmp;
       if (skip > count)
          skip = count;
-      for (int i = 0; i < skip; i++)
-         tmp.unpack(bstream);
       start += skip;
       count = count - skip;
    }
@@ -354,11 +479,10 @@ void GameConnection::moveReadPacket(BitStream *bstream)
    // Put the rest on the move list.
    int index = mMoveList.size();
    mMoveList.increment(count);
-   while (index < mMoveList.size())
+   for (U32 i = 0; i < count; i++, index++)
    {
-      mMoveList[index].unpack(bstream);
+      mMoveList[index] = moves[skip + i];
       mMoveList[index].id = start++;
-      index ++;
    }
 
    mLastMoveAck += count;
@@ -7,8 +7,13 @@
 #include "game/gameConnection.h"
 #include "game/gameBase.h"
 #include "game/shapeBase.h"
+#include "game/projectileBatch.h"
+#include "game/navGraph.h"
+#include "game/aiPerception.h"
 #include "platform/profiler.h"
 #include "console/consoleTypes.h"
+#include "core/threadPool.h"
+#include "collision/convex.h"
 
 //----------------------------------------------------------------------------
 
@@ -16,6 +21,9 @@ ProcessList gClientProcessList(false);
 ProcessList gServerProcessList(true);
 
 bool ProcessList::mDebugControlSync = false;
+bool ProcessList::smParallelTicks = false;
+S32  ProcessList::smParallelMinObjects = 32;
+bool ProcessList::smParallelPhysics = false;
 
 ProcessList::ProcessList(bool isServer)
 {
@@ -82,7 +90,12 @@ bool ProcessList::advanceServerTime(SimTime timeDelta)
    bool ret = mLastTick != targetTick;
    // Advance all the objects
    for (; mLastTick != targetTick; mLastTick += TickMs)
+   {
+      // Paths and sightings since the last tick go out before the bots move.
+      NavGraph::processQueries();
+      AIPerception::processTick();
       advanceObjects();
+   }
 
    // Credit all the connections with the elapsed ticks.
    SimGroup *g = Sim::getClientGroup();
@@ -187,6 +200,25 @@ bool ProcessList::advanceClientTime(SimTime timeDelta)
          obj = obj->mProcessLink.next)
       if (obj->mProcessTick)
          obj->interpolateTick(dt);
+   ProjectileBatch::interpolateBatch(dt);
+   if (connection)
+      connection->smoothCorrection(F32(timeDelta) / 1000);
+
+   // Draw the ghosts we don't control in the past, from the states they
+   // were sent, over what interpolateTick() made of them.
+   if (GameBase::smSnapshotDelay > 0)
+   {
+      SimTime renderTime = targetTime - getMin(targetTime, SimTime(GameBase::smSnapshotDelay));
+      GameBase* controlObj = connection ? connection->getControlObject() : 0;
+      for (GameBase* obj = head.mProcessLink.next; obj != &head;
+            obj = obj->mProcessLink.next)
+      {
+         if (obj->mSnapshotPending)
+            obj->addSnapshot(obj->getTransform());
+         if (obj != controlObj && obj->canUseSnapshots())
+            obj->interpolateSnapshots(renderTime);
+      }
+   }
 
    // Inform objects of total elapsed delta so they can advance
    // client side animations.
@@ -207,6 +239,12 @@ void ProcessList::advanceObjects()
 {
    PROFILE_START(AdvanceObjects);
 
+   if (smParallelTicks && gThreadPool && gThreadPool->isThreaded())
+      advanceObjectsParallel();
+
+   bool deferPhysics = smParallelPhysics && gThreadPool && gThreadPool->isThreaded();
+   mPhysicsIds.clear();
+
    // A little link list shuffling is done here to avoid problems
    // with objects being deleted from within the process method.
    GameBase list;
@@ -217,6 +255,12 @@ void ProcessList::advanceObjects()
       obj->plUnlink();
       obj->plLinkBefore(&head);
 
+      // Already taken care of by a worker thread
+      if (obj->mTickedInParallel) {
+         obj->mTickedInParallel = false;
+         continue;
+      }
+
       // Each object is either advanced a single tick, or if it's
       // being controlled by a client, ticked once for each pending move.
       if (obj->mTypeMask & GameBaseObjectType) {
@@ -238,8 +282,292 @@ void ProcessList::advanceObjects()
             continue;
          }
       }
-      if (obj->mProcessTick)
+      if (obj->mProcessTick && !obj->mSleeping) {
+         // Noted by id, the tick may delete the object
+         if (deferPhysics && obj->canDeferTickPhysics()) {
+            obj->mDeferTickPhysics = true;
+            mPhysicsIds.push_back(obj->getId());
+         }
          obj->processTick(0);
+      }
+   }
+
+   if (mPhysicsIds.size())
+      advancePhysicsParallel();
+
+   ProjectileBatch::tickBatch(mIsServer);
+   PROFILE_END();
+}
+
+
+//----------------------------------------------------------------------------
+
+S32 ProcessList::findTickGroup(S32 index)
+{
+   // Union-find with path halving
+   while (mTickParent[index] != index) {
+      mTickParent[index] = mTickParent[mTickParent[index]];
+      index = mTickParent[index];
+   }
+   return index;
+}
+
+void ProcessList::buildTickGroups()
+{
+   mTickObjects.clear();
+   mTickParent.clear();
+   mParallelObjects.clear();
+   mParallelGroupEnd.clear();
+
+   // Snapshot the (already ordered) list, each object starting
+   // out in a group of its own.
+   for (GameBase* obj = head.mProcessLink.next; obj != &head;
+         obj = obj->mProcessLink.next) {
+      obj->mTickGroup = mTickObjects.size();
+      mTickParent.push_back(mTickObjects.size());
+      mTickObjects.push_back(obj);
+   }
+
+   // Merge along processAfter() links, which covers mount chains
+   // as well as control and orbit relationships.
+   for (S32 i = 0; i < mTickObjects.size(); i++) {
+      GameBase* after = mTickObjects[i]->mAfterObject;
+      if (!after || after->mTickGroup >= mTickObjects.size() ||
+            mTickObjects[after->mTickGroup] != after)
+         continue;
+      S32 a = findTickGroup(i);
+      S32 b = findTickGroup(after->mTickGroup);
+      if (a != b)
+         // Keep the earliest object as the root so group order
+         // follows the process list.
+         mTickParent[getMax(a, b)] = getMin(a, b);
+   }
+
+   // A group may only run on a worker if every member is safe.
+   // Anything with a controlling client consumes moves and stays
+   // on the main thread with the rest of its connection.
+   Vector<bool> serial;
+   serial.setSize(mTickObjects.size());
+   for (S32 i = 0; i < mTickObjects.size(); i++)
+      serial[i] = false;
+   for (S32 i = 0; i < mTickObjects.size(); i++) {
+      GameBase* obj = mTickObjects[i];
+      if (obj->getControllingClient() || !obj->isParallelTickSafe())
+         serial[findTickGroup(i)] = true;
+   }
+   groupParallelObjects(serial);
+}
+
+void ProcessList::groupParallelObjects(const Vector<bool> &serial)
+{
+   // Bucket the parallel objects by group, keeping list order
+   // inside each group.  Roots are the first object of their group,
+   // so visiting roots in order yields groups in list order.
+   Vector<S32> groupSlot;
+   groupSlot.setSize(mTickObjects.size());
+   U32 numGroups = 0;
+   for (S32 i = 0; i < mTickObjects.size(); i++) {
+      S32 root = findTickGroup(i);
+      groupSlot[i] = -1;
+      if (root == i && !serial[i])
+         groupSlot[i] = numGroups++;
+   }
+   if (!numGroups)
+      return;
+
+   mParallelGroupEnd.setSize(numGroups);
+   for (U32 g = 0; g < numGroups; g++)
+      mParallelGroupEnd[g] = 0;
+   for (S32 i = 0; i < mTickObjects.size(); i++) {
+      S32 slot = groupSlot[findTickGroup(i)];
+      if (slot >= 0 && mTickObjects[i]->mProcessTick && !mTickObjects[i]->mSleeping)
+         mParallelGroupEnd[slot]++;
+   }
+   U32 total = 0;
+   for (U32 g = 0; g < numGroups; g++) {
+      total += mParallelGroupEnd[g];
+      mParallelGroupEnd[g] = total;
+   }
+
+   // Fill each bucket back to front so objects land in list order.
+   mParallelObjects.setSize(total);
+   for (S32 i = mTickObjects.size() - 1; i >= 0; i--) {
+      S32 slot = groupSlot[findTickGroup(i)];
+      if (slot >= 0 && mTickObjects[i]->mProcessTick && !mTickObjects[i]->mSleeping)
+         mParallelObjects[--mParallelGroupEnd[slot]] = mTickObjects[i];
+   }
+   // The decrement pass left each entry at its group start, so
+   // shift down by one to turn them back into group ends.
+   for (U32 g = 0; g < numGroups - 1; g++)
+      mParallelGroupEnd[g] = mParallelGroupEnd[g + 1];
+   mParallelGroupEnd[numGroups - 1] = total;
+}
+
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/// A run of whole tick groups handed to one worker.
+struct TickBatch : public ThreadPool::WorkItem
+{
+   GameBase** objects;
+   U32 count;
+   bool physics;
+
+   void process()
+   {
+      PROFILE_START(AdvanceObjectsBatch);
+      if (physics)
+         for (U32 i = 0; i < count; i++)
+            objects[i]->tickPhysics();
+      else
+         for (U32 i = 0; i < count; i++)
+            objects[i]->processTick(0);
+      PROFILE_END();
    }
+};
+
+/// Working list entry of a deferred physics step, sorted by object.
+struct PhysicsContact
+{
+   SceneObject* object;
+   S32 index;
+};
+
+S32 QSORT_CALLBACK comparePhysicsContacts(const void* a, const void* b)
+{
+   const PhysicsContact* ca = (const PhysicsContact*)a;
+   const PhysicsContact* cb = (const PhysicsContact*)b;
+   if (ca->object != cb->object)
+      return (ca->object < cb->object)? -1: 1;
+   return ca->index - cb->index;
+}
+
+}
+
+void ProcessList::runParallelGroups(bool physics)
+{
+   // Split into a few batches per thread so that one expensive
+   // group doesn't leave the other workers idle.  Batches always
+   // end on a group boundary.
+   U32 numBatches = (gThreadPool->getNumThreads() + 1) * 4;
+   U32 batchSize = (mParallelObjects.size() + numBatches - 1) / numBatches;
+
+   Vector<TickBatch> batches;
+   batches.reserve(mParallelGroupEnd.size());
+   U32 start = 0;
+   for (U32 g = 0; g < mParallelGroupEnd.size(); g++) {
+      U32 end = mParallelGroupEnd[g];
+      if (end - start >= batchSize || g == mParallelGroupEnd.size() - 1) {
+         batches.increment();
+         constructInPlace(&batches.last());
+         batches.last().objects = &mParallelObjects[start];
+         batches.last().count = end - start;
+         batches.last().physics = physics;
+         start = end;
+      }
+   }
+
+   ThreadPool::Counter done;
+   for (U32 i = 0; i < batches.size(); i++)
+      gThreadPool->queueWorkItem(&batches[i], &done);
+   gThreadPool->waitForCounter(&done);
+}
+
+void ProcessList::advanceObjectsParallel()
+{
+   PROFILE_START(AdvanceObjectsParallel);
+
+   buildTickGroups();
+   if (mParallelObjects.size() < smParallelMinObjects || mParallelObjects.size() == 0) {
+      PROFILE_END();
+      return;
+   }
+
+   // Flag first, the serial pass skips these objects.
+   for (U32 i = 0; i < mParallelObjects.size(); i++)
+      mParallelObjects[i]->mTickedInParallel = true;
+
+   runParallelGroups(false);
+   PROFILE_END();
+}
+
+
+//----------------------------------------------------------------------------
+
+void ProcessList::buildPhysicsIslands()
+{
+   mTickObjects.clear();
+   mTickParent.clear();
+   mParallelObjects.clear();
+   mParallelGroupEnd.clear();
+
+   // Objects deleted since they were noted, or that didn't defer
+   // after all, are left out.
+   for (S32 i = 0; i < mPhysicsIds.size(); i++) {
+      GameBase* obj = dynamic_cast<GameBase*>(Sim::findObject(mPhysicsIds[i]));
+      if (obj && obj->mDeferTickPhysics) {
+         obj->mTickGroup = mTickObjects.size();
+         mTickParent.push_back(mTickObjects.size());
+         mTickObjects.push_back(obj);
+      }
+   }
+
+   // Every step is listed as touching itself.  Sorting the lists by
+   // object then lines up the steps that touch the same object, or
+   // each other, and those are merged into one island.
+   Vector<PhysicsContact> contacts;
+   Vector<SceneObject*> list;
+   for (S32 i = 0; i < mTickObjects.size(); i++) {
+      list.clear();
+      list.push_back(mTickObjects[i]);
+      mTickObjects[i]->getTickPhysicsContacts(list);
+      for (S32 j = 0; j < list.size(); j++) {
+         contacts.increment();
+         contacts.last().object = list[j];
+         contacts.last().index = i;
+      }
+   }
+   if (contacts.size())
+      dQsort(contacts.address(), contacts.size(), sizeof(PhysicsContact), comparePhysicsContacts);
+   for (S32 k = 1; k < contacts.size(); k++) {
+      if (contacts[k].object != contacts[k - 1].object)
+         continue;
+      S32 a = findTickGroup(contacts[k].index);
+      S32 b = findTickGroup(contacts[k - 1].index);
+      if (a != b)
+         mTickParent[getMax(a, b)] = getMin(a, b);
+   }
+
+   Vector<bool> serial;
+   serial.setSize(mTickObjects.size());
+   for (S32 i = 0; i < mTickObjects.size(); i++)
+      serial[i] = false;
+   groupParallelObjects(serial);
+}
+
+void ProcessList::advancePhysicsParallel()
+{
+   PROFILE_START(AdvancePhysicsParallel);
+
+   buildPhysicsIslands();
+   if (mParallelObjects.size()) {
+      Convex::setThreaded(true);
+      runParallelGroups(true);
+      Convex::setThreaded(false);
+   }
+
+   // Finish in list order.  Script called from one object's finish
+   // may delete another, so they're looked up again.
+   for (S32 i = 0; i < mPhysicsIds.size(); i++) {
+      GameBase* obj = dynamic_cast<GameBase*>(Sim::findObject(mPhysicsIds[i]));
+      if (obj && obj->mDeferTickPhysics) {
+         obj->mDeferTickPhysics = false;
+         obj->finishTickPhysics();
+      }
+   }
+   mPhysicsIds.clear();
+
    PROFILE_END();
 }
@@ -307,6 +307,7 @@ void Item::setVelocity(const VectorF& vel)
    setMaskBits(PositionMask);
    mAtRest = false;
    mAtRestCounter = 0;
+   wakeUp();
 }
 
 void Item::applyImpulse(const Point3F&,const VectorF& vec)
@@ -381,6 +382,25 @@ void Item::processTick(const Move* move)
          delta.posVec.set(0,0,0);
       }
    }
+
+   if (isServerObject())
+      updateSleep(mAtRest);
+}
+
+bool Item::canSleep()
+{
+   // The collision timeout counts down in processTick()
+   return !mCollisionObject && Parent::canSleep();
+}
+
+void Item::onWake()
+{
+   // Whatever we were resting on may have moved
+   if (!mStatic)
+   {
+      mAtRest = false;
+      mAtRestCounter = 0;
+   }
 }
 
 void Item::interpolateTick(F32 dt)
@@ -418,6 +438,7 @@ void Item::setTransform(const MatrixF& mat)
       mAtRest = false;
       mAtRestCounter = 0;
    }
+   wakeUp();
    setMaskBits(RotationMask | PositionMask | NoWarpMask);
 }
 
@@ -442,6 +463,15 @@ void Item::updateWorkingCollisionSet(const U32 mask, const F32 dt)
    convexBox.min -= Point3F(l, l, l);
    convexBox.max += Point3F(l, l, l);
 
+   // Wake anything asleep in our path
+   if (isServerObject())
+   {
+      Box3F wakeBox = getWorldBox();
+      wakeBox.min -= Point3F(len, len, len);
+      wakeBox.max += Point3F(len, len, len);
+      wakeTouching(wakeBox);
+   }
+
    // Check containment
    {
       if (mWorkingQueryBox.min.x != -1e9)
@@ -848,7 +878,7 @@ U32 Item::packUpdate(NetConnection *connection, U32 mask, BitStream *stream)
    {
       S32 gIndex = connection->getGhostIndex(mCollisionObject);
       if (stream->writeFlag(gIndex != -1))
-         stream->writeInt(gIndex,NetConnection::GhostIdBitSize);
+         connection->packGhostIndex(stream, gIndex);
    }
    else
       stream->writeFlag(false);
@@ -892,7 +922,7 @@ void Item::unpackUpdate(NetConnection *connection, BitStream *stream)
 
    if (stream->readFlag())
    {
-      S32 gIndex = stream->readInt(NetConnection::GhostIdBitSize);
+      S32 gIndex = connection->unpackGhostIndex(stream);
       setCollisionTimeout(static_cast<ShapeBase*>(connection->resolveGhost(gIndex)));
    }
 
@@ -113,6 +113,7 @@ class Item: public ShapeBase
    bool buildPolyList(AbstractPolyList* polyList, const Box3F &box, const SphereF &sphere);
    void buildConvex(const Box3F& box, Convex* convex);
    void onDeleteNotify(SimObject*);
+   void onWake();
 
    bool prepRenderImage(SceneState *state, const U32 stateKey, const U32 startZone, const bool modifyBaseZoneState);
 
@@ -145,6 +146,7 @@ class Item: public ShapeBase
    ShapeBase* getCollisionObject()   { return mCollisionObject; };
 
    void processTick(const Move *move);
+   bool canSleep();
    void interpolateTick(F32 delta);
    void setTransform(const MatrixF &mat);
    void renderImage(SceneState *state, SceneRenderImage *image);
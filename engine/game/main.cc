@@ -39,6 +39,9 @@
 #include "terrain/terrRender.h"
 #include "editor/terraformer.h"
 #include "sceneGraph/sceneGraph.h"
+#include "sceneGraph/sceneState.h"
+#include "sceneGraph/occlusionCuller.h"
+#include "sceneGraph/visibilityQuery.h"
 #include "dgl/materialList.h"
 #include "sceneGraph/sceneRoot.h"
 #include "game/moveManager.h"
@@ -52,11 +55,20 @@
 #include "game/demoGame.h"
 #include "sim/decalManager.h"
 #include "core/frameAllocator.h"
+#include "core/threadPool.h"
 #include "sceneGraph/detailManager.h"
 #include "interior/interiorLMManager.h"
 #include "game/version.h"
 #include "platform/profiler.h"
+#include "core/frameStats.h"
+#include "game/timeDemo.h"
+#include "game/soakTest.h"
+#include "game/missionLoadPipeline.h"
+#include "game/serverReplay.h"
+#include "game/navGraph.h"
+#include "game/aiPerception.h"
 #include "game/shapeBase.h"
+#include "game/shadow.h"
 #include "game/objectTypes.h"
 #include "game/net/serverQuery.h"
 #include "game/badWordFilter.h"
@@ -67,7 +79,7 @@ DemoNetInterface GameNetInterface;
 #endif
 
 extern ResourceInstance *constructTerrainFile(Stream &stream);
-extern ResourceInstance *constructTSShape(Stream &);
+extern ResourceInstance *constructTSShape(Stream &, ResourceObject *);
 
 
 ConsoleFunctionGroupBegin( Platform , "General platform functions.");
@@ -116,7 +128,7 @@ static bool initLibraries()
    // asserts should be created FIRST
    PlatformAssert::create();
 
-   FrameAllocator::init(3 << 20);      // 3 meg frame allocator buffer
+   FrameAllocator::init(3 << 20);      // 3 meg first page for the main thread
 
 //   // Cryptographic pool next
 //   CryptRandomPool::init();
@@ -126,13 +138,16 @@ static bool initLibraries()
    ResManager::create();
 
    // Register known file types here
-   ResourceManager->registerExtension(".jpg", constructBitmapJPEG);
-   ResourceManager->registerExtension(".png", constructBitmapPNG);
+#ifndef TORQUE_HEADLESS
+   ResourceManager->registerExtension(".jpg", constructBitmapJPEG, true);
+   ResourceManager->registerExtension(".png", constructBitmapPNG, true);
    ResourceManager->registerExtension(".gif", constructBitmapGIF);
    ResourceManager->registerExtension(".dbm", constructBitmapDBM);
    ResourceManager->registerExtension(".bmp", constructBitmapBMP);
    ResourceManager->registerExtension(".bm8", constructBitmapBM8);
+   ResourceManager->registerExtension(".dds", constructBitmapDDS);
    ResourceManager->registerExtension(".uft", constructFont);
+#endif
    ResourceManager->registerExtension(".dif", constructInteriorDIF);
    ResourceManager->registerExtension(".ter", constructTerrainFile);
    ResourceManager->registerExtension(".dts", constructTSShape);
@@ -141,6 +156,8 @@ static bool initLibraries()
 
    Con::init();
    NetStringTable::create();
+   BitStream::initHuffmanTables();
+   ThreadPool::create();
 
    TelnetConsole::create();
    TelnetDebugger::create();
@@ -149,6 +166,9 @@ static bool initLibraries()
    Math::init();
    Platform::init();    // platform specific initialization
    InteriorLMManager::init();
+   OcclusionCuller::init();
+   VisibilityQuery::init();
+   dglGpuTimerInit();
    InteriorInstance::init();
    TSShapeInstance::init();
    RedBook::init();
@@ -169,6 +189,9 @@ static void shutdownLibraries()
    TSShapeInstance::destroy();
    InteriorInstance::destroy();
    InteriorLMManager::destroy();
+   OcclusionCuller::destroy();
+   VisibilityQuery::destroy();
+   dglGpuTimerDestroy();
 
    TextureManager::preDestroy();
 
@@ -176,6 +199,7 @@ static void shutdownLibraries()
    TelnetDebugger::destroy();
    TelnetConsole::destroy();
 
+   ThreadPool::destroy();
    NetStringTable::destroy();
    Con::shutdown();
 
@@ -184,6 +208,8 @@ static void shutdownLibraries()
 
    _StringTable::destroy();
 
+   SceneState::destroyRenderImagePools();
+
    // asserts should be destroyed LAST
    FrameAllocator::destroy();
 
@@ -209,6 +235,11 @@ static F32 gTimeScale = 1.0;
 static U32 gTimeAdvance = 0;
 static U32 gFrameSkip = 0;
 static U32 gFrameCount = 0;
+static bool gServerWaitForTraffic = true;
+static S32 gMaxFps = 0;          ///< $pref::Video::maxFps, 0 for no limit.
+static S32 gFrameSpinUs = 1500;  ///< $pref::Video::frameSpinUs
+static U64 gNextFrameUs = 0;
+static U32 gLastTimeEventMs = 0;
 
 // Executes an entry script; can be controlled by command-line options.
 bool runEntryScript (int argc, const char **argv)
@@ -260,6 +291,10 @@ bool runEntryScript (int argc, const char **argv)
    return true;
 }
 
+/// Set by the torqueBench harness when it is linked in; DemoGame::main()
+/// runs it in place of the main loop.
+S32 (*gBenchmarkMain)(S32 argc, const char **argv) = NULL;
+
 /// Initalize game, run the specified startup script
 bool initGame(int argc, const char **argv)
 {
@@ -268,6 +303,26 @@ bool initGame(int argc, const char **argv)
    Con::addVariable("timeScale", TypeF32, &gTimeScale);
    Con::addVariable("timeAdvance", TypeS32, &gTimeAdvance);
    Con::addVariable("frameSkip", TypeS32, &gFrameSkip);
+#ifndef TORQUE_HEADLESS
+   Con::addVariable("pref::Video::limitRenderAhead", TypeBool, &GuiCanvas::smLimitRenderAhead);
+#endif
+   Con::addVariable("pref::Video::maxFps", TypeS32, &gMaxFps);
+   Con::addVariable("pref::Video::frameSpinUs", TypeS32, &gFrameSpinUs);
+   Con::addVariable("pref::Server::waitForTraffic", TypeBool, &gServerWaitForTraffic);
+   Memory::consoleInit();
+   TimeDemo::consoleInit();
+   MissionLoadPipeline::consoleInit();
+   ServerReplay::consoleInit();
+   serverQueryConsoleInit();
+   NavGraph::consoleInit();
+   AIPerception::consoleInit();
+   dglStateConsoleInit();
+#ifndef TORQUE_HEADLESS
+   Con::addVariable("pref::Font::backgroundGlyphs", TypeBool, &GFont::smBackgroundGlyphs);
+#endif
+#ifdef TORQUE_ENABLE_PROFILER
+   Profiler::consoleInit();
+#endif
 
    // Stuff game types into the console
    Con::setIntVariable("$TypeMasks::StaticObjectType",         StaticObjectType);
@@ -306,7 +361,9 @@ bool initGame(int argc, const char **argv)
    TerrainRender::init();
    netInit();
    GameInit();
+#ifndef TORQUE_HEADLESS
    ShowInit();
+#endif
    MoveManager::init();
 
    Sim::init();
@@ -337,6 +394,10 @@ bool initGame(int argc, const char **argv)
 
    SimChunk::initChunkMappings();
 
+   // the benchmark harness runs instead of the scripts
+   if(gBenchmarkMain)
+      return true;
+
    // run the entry script and return.
    return runEntryScript(argc, argv);
 }
@@ -346,6 +407,8 @@ void shutdownGame()
 {
    //exec the script onExit() function
    Con::executef(1, "onExit");
+   ServerReplay::stop();
+   NavGraph::clear();
 
    BadWordFilter::destroy();
    ParticleEngine::destroy();
@@ -377,6 +440,58 @@ void shutdownGame()
 extern bool gDGLRender;
 bool gShuttingDown   = false;
 
+/// How long a dedicated server can block on its sockets before the next
+/// tick or scheduled event is due, in real ms.
+/// Holds the main loop to $pref::Video::maxFps.
+///
+/// Frames are paced against a deadline one interval after the last, so
+/// uneven sleeps don't add up.  The wait sleeps until frameSpinUs before
+/// the deadline, since the OS may wake us late, and spins the rest.  It
+/// runs at the top of the loop so input is read after the wait, as close
+/// to the frame as possible.
+static void limitFrameRate()
+{
+   if(gMaxFps <= 0 || !Canvas || !gDGLRender || gTimeAdvance ||
+      Game->isJournalReading() || ServerReplay::isReplaying() || TimeDemo::isRunning())
+   {
+      gNextFrameUs = 0;
+      return;
+   }
+
+   PROFILE_START(FrameLimiter);
+   U64 interval = 1000000 / U32(gMaxFps);
+   U64 now = Platform::getRealMicroseconds();
+
+   // a frame that ran long resets the pace rather than being caught up
+   if(!gNextFrameUs || now > gNextFrameUs + interval)
+      gNextFrameUs = now;
+
+   U64 spin = U64(getMax(gFrameSpinUs, 0));
+   while(now < gNextFrameUs)
+   {
+      U64 left = gNextFrameUs - now;
+      if(left > spin)
+         Platform::sleepMicroseconds(U32(left - spin));
+      now = Platform::getRealMicroseconds();
+   }
+   gNextFrameUs += interval;
+   PROFILE_END();
+}
+
+static U32 getServerWaitMs()
+{
+   U32 sinceTick = gServerProcessList.getLastTime() & TickMask;
+   U32 wait = Sim::getTimeToNextEvent(TickMs - sinceTick);
+   if(gTimeScale <= 0.0f)
+      wait = TickMs;
+   else if(gTimeScale != 1.0f)
+      wait = U32(wait / gTimeScale);
+
+   // Less what's gone by since the last frame's time was taken.
+   U32 spent = Platform::getRealMilliseconds() - gLastTimeEventMs;
+   return spent < wait ? wait - spent : 0;
+}
+
 /// Main loop of the game
 int DemoGame::main(int argc, const char **argv)
 {
@@ -426,6 +541,15 @@ int DemoGame::main(int argc, const char **argv)
       return 0;
    }
 
+   if(gBenchmarkMain)
+   {
+      S32 ret = gBenchmarkMain(argc, argv);
+      shutdownGame();
+      shutdownLibraries();
+      gShuttingDown = true;
+      return ret;
+   }
+
 #ifdef IHVBUILD
    char* pPrint = new char[dStrlen(sgVerPrintString) + 1];
    for (U32 pi = 0; pi < dStrlen(sgVerPrintString); pi++)
@@ -443,8 +567,24 @@ int DemoGame::main(int argc, const char **argv)
             PROFILE_START(JournalMain);
       Game->journalProcess();
             PROFILE_END();
+
+      limitFrameRate();
+
+      // A dedicated server sleeps on its sockets until a packet comes in or
+      // there's a tick to run, rather than spinning the loop.
+      bool waitForTraffic = gServerWaitForTraffic && !gTimeAdvance &&
+                            !Game->isJournalReading() && !ServerReplay::isReplaying() &&
+                            Con::getBoolVariable("$Server::Dedicated");
+      Game->setWaitingForTraffic(waitForTraffic);
+      if(waitForTraffic)
+      {
+            PROFILE_START(NetWaitMain);
+         Net::waitForTraffic(getServerWaitMs());
+            PROFILE_END();
+      }
             PROFILE_START(NetProcessMain);
-      Net::process();      // read in all events
+      if(!ServerReplay::isReplaying())
+         Net::process();   // read in all events
             PROFILE_END();
             PROFILE_START(PlatformProcessMain);
       Platform::process(); // keys, etc.
@@ -456,7 +596,10 @@ int DemoGame::main(int argc, const char **argv)
       TelDebugger->process();
             PROFILE_END();
             PROFILE_START(TimeManagerProcessMain);
-      TimeManager::process(); // guaranteed to produce an event
+      if(ServerReplay::isReplaying())
+         ServerReplay::process();   // the recorded packets and frame time
+      else
+         TimeManager::process(); // guaranteed to produce an event
             PROFILE_END();
             PROFILE_START(GameProcessEvents);
       Game->processEvents(); // process all non-sim posted events.
@@ -612,6 +755,7 @@ void DemoGame::processConsoleEvent(ConsoleEvent *event)
    char *argv[2];
    argv[0] = "eval";
    argv[1] = event->data;
+   ServerReplay::recordConsole(event);
    Sim::postCurrentEvent(Sim::getRootGroup(), new SimConsoleEvent(2, const_cast<const char**>(argv), false));
 }
 
@@ -619,6 +763,8 @@ void DemoGame::processConsoleEvent(ConsoleEvent *event)
 void DemoGame::processTimeEvent(TimeEvent *event)
 {
    PROFILE_START(ProcessTimeEvent);
+   ServerReplay::beginFrame(event);
+   gLastTimeEventMs = Platform::getRealMilliseconds();
    U32 elapsedTime = event->elapsedTime;
    // cap the elapsed time to one second
    // if it's more than that we're probably in a bad catch-up situation
@@ -628,13 +774,16 @@ void DemoGame::processTimeEvent(TimeEvent *event)
 
    U32 timeDelta;
 
-   if(gTimeAdvance)
+   if(TimeDemo::isRunning())
+      timeDelta = TickMs;
+   else if(gTimeAdvance)
       timeDelta = gTimeAdvance;
    else
       timeDelta = (U32) (elapsedTime * gTimeScale);
 
    Platform::advanceTime(elapsedTime);
    bool tickPass;
+   U64 serverStart = Platform::getRealMicroseconds();
    PROFILE_START(ServerProcess);
    tickPass = serverProcess(timeDelta);
    PROFILE_END();
@@ -643,20 +792,29 @@ void DemoGame::processTimeEvent(TimeEvent *event)
    if(tickPass)
       GNet->processServer();
    PROFILE_END();
+   if(tickPass && SoakTest::isRunning())
+      SoakTest::serverFrame(U32(Platform::getRealMicroseconds() - serverStart));
 
    PROFILE_START(SimAdvanceTime);
    Sim::advanceTime(timeDelta);
    PROFILE_END();
 
+   PROFILE_START(ResourceAsyncLoads);
+   ResourceManager->processAsyncLoads();
+   PROFILE_END();
+
    PROFILE_START(ClientProcess);
    tickPass = clientProcess(timeDelta);
    PROFILE_END();
+   if(SoakTest::isRunning())
+      SoakTest::advanceTime(timeDelta);
    PROFILE_START(ClientNetProcess);
    if(tickPass)
       GNet->processClient();
    PROFILE_END();
    
    sgObjectShadowMonitor::sgCleanupUnused();
+   Shadow::startFrame();
 
    if(Canvas && gDGLRender)
    {
@@ -664,14 +822,23 @@ void DemoGame::processTimeEvent(TimeEvent *event)
       if(gFrameSkip && gFrameCount % gFrameSkip)
          preRenderOnly = true;
 
+      TextureManager::processFrame();
+
       PROFILE_START(RenderFrame);
       ShapeBase::incRenderFrame();
       Canvas->renderFrame(preRenderOnly);
       PROFILE_END();
       gFrameCount++;
+
+      if(TimeDemo::isRunning())
+         TimeDemo::endFrame();
    }
    GNet->checkTimeouts();
    fpsUpdate();
+   Memory::processMetrics();
+   STAT_SET(FrameMs, elapsedTime);
+   FrameStats::endFrame();
+   ServerReplay::endFrame();
    PROFILE_END();
 
    // Update the console time
@@ -720,5 +887,6 @@ void DemoGame::textureResurrect()
 /// Process recieved net-packets
 void DemoGame::processPacketReceiveEvent(PacketReceiveEvent * prEvent)
 {
+   ServerReplay::recordPacket(prEvent);
    GNet->processPacketReceiveEvent(prEvent);
 }
@@ -0,0 +1,710 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "game/missionLoadPipeline.h"
+#include "console/console.h"
+#include "console/consoleTypes.h"
+#include "console/simBase.h"
+#include "core/resManager.h"
+#include "core/stringTable.h"
+#include "core/fileStream.h"
+#include "core/zipHeaders.h"
+#include "core/zipSubStream.h"
+#include "core/zipWriter.h"
+#include "dgl/gTexManager.h"
+#include "dgl/materialList.h"
+#include "interior/interiorRes.h"
+#include "interior/interior.h"
+#include "terrain/terrData.h"
+#include "ts/tsShape.h"
+
+bool                    MissionLoadPipeline::smRunning = false;
+StringTableEntry        MissionLoadPipeline::smMissionFile = NULL;
+U64                     MissionLoadPipeline::smStartUs = 0;
+U64                     MissionLoadPipeline::smStageStartUs = 0;
+Vector<MissionLoadPipeline::Stage> MissionLoadPipeline::smStages;
+Vector<ResourceObject*> MissionLoadPipeline::smRequested;
+Vector<ResourceObject*> MissionLoadPipeline::smHeld;
+U32                     MissionLoadPipeline::smQueued = 0;
+U32                     MissionLoadPipeline::smLoaded = 0;
+U32                     MissionLoadPipeline::smFailed = 0;
+U32                     MissionLoadPipeline::smBytes = 0;
+bool                    MissionLoadPipeline::smPrefetch = true;
+bool                    MissionLoadPipeline::smAccessLog = true;
+const char             *MissionLoadPipeline::smAccessLogPath = NULL;
+S32                     MissionLoadPipeline::smLastLoadMs = 0;
+
+// The order TextureManager::loadBitmapInstance() tries them in.
+static const char *csBitmapExts[] = { "", ".jpg", ".png", ".gif", ".bmp" };
+
+static bool hasExtension(const char *fileName, const char *ext)
+{
+   const char *dot = dStrrchr(fileName, '.');
+   return dot && !dStrchr(dot, '/') && !dStricmp(dot, ext);
+}
+
+static bool hasBitmapExtension(const char *fileName)
+{
+   for(U32 i = 1; i < sizeof(csBitmapExts) / sizeof(csBitmapExts[0]); i++)
+      if(hasExtension(fileName, csBitmapExts[i]))
+         return true;
+   return false;
+}
+
+/// Expand a ~/ or ./ path the way exec() does for the file that holds it.
+static void expandPath(char *buffer, U32 size, const char *holder, const char *src)
+{
+   const char *slash = NULL;
+   if(!dStrncmp(src, "~/", 2))
+      slash = dStrchr(holder, '/');
+   else if(!dStrncmp(src, "./", 2))
+      slash = dStrrchr(holder, '/');
+
+   if(!slash)
+   {
+      dStrncpy(buffer, src, size - 1);
+      buffer[size - 1] = '\0';
+      return;
+   }
+   dSprintf(buffer, size, "%.*s%s", S32(slash - holder), holder, src + 1);
+}
+
+//-----------------------------------------------------------------------------
+
+void MissionLoadPipeline::consoleInit()
+{
+   smAccessLogPath = StringTable->insert("cache/access");
+
+   Con::addVariable("$pref::MissionLoad::prefetch",      TypeBool,   &smPrefetch);
+   Con::addVariable("$pref::MissionLoad::accessLog",     TypeBool,   &smAccessLog);
+   Con::addVariable("$pref::MissionLoad::accessLogPath", TypeString, &smAccessLogPath);
+   Con::addVariable("$MissionLoad::lastLoadMs",          TypeS32,    &smLastLoadMs);
+}
+
+void MissionLoadPipeline::start(const char *missionFile)
+{
+   missionFile = StringTable->insert(missionFile);
+   if(smRunning && smMissionFile == missionFile)
+      return;
+   if(smRunning)
+      finish();
+
+   smRunning = true;
+   smMissionFile = missionFile;
+   smStages.clear();
+   smQueued = smLoaded = smFailed = smBytes = 0;
+   smStartUs = Platform::getRealMicroseconds();
+   beginStage("prefetch");
+
+   if(smAccessLog)
+      ResourceManager->startAccessLog();
+
+   if(smPrefetch)
+   {
+      prefetchAccessLog(missionFile);
+
+      SimDataBlockGroup *group = Sim::getDataBlockGroup();
+      for(SimSet::iterator itr = group->begin(); itr != group->end(); itr++)
+         prefetchDataBlock(static_cast<SimDataBlock *>(*itr));
+      scanMission(missionFile);
+   }
+}
+
+void MissionLoadPipeline::endStage()
+{
+   if(!smStages.size())
+      return;
+   U64 now = Platform::getRealMicroseconds();
+   Stage &stage = smStages.last();
+   stage.ms = U32((now - smStageStartUs) / 1000);
+   stage.filesDone = smLoaded + smFailed - stage.filesDone;
+   smStageStartUs = now;
+}
+
+void MissionLoadPipeline::beginStage(const char *name)
+{
+   if(!smRunning)
+      return;
+   endStage();
+
+   smStages.increment();
+   Stage &stage = smStages.last();
+   stage.name = StringTable->insert(name);
+   stage.ms = 0;
+   stage.filesDone = smLoaded + smFailed;
+   smStageStartUs = Platform::getRealMicroseconds();
+}
+
+void MissionLoadPipeline::finish()
+{
+   if(!smRunning)
+      return;
+   endStage();
+   smRunning = false;
+
+   U64 totalUs = Platform::getRealMicroseconds() - smStartUs;
+   smLastLoadMs = S32(totalUs / 1000);
+
+   Con::printf("Mission load of %s: %.2f s", smMissionFile, F64(totalUs) / 1000000.0);
+   for(U32 i = 0; i < smStages.size(); i++)
+      Con::printf("   %-16s %7.2f s, %d prefetches done", smStages[i].name,
+                  smStages[i].ms / 1000.0, smStages[i].filesDone);
+   Con::printf("   prefetched %d of %d files, %d KB; %d failed, %d still loading",
+               smLoaded, smQueued, smBytes / 1024, smFailed, smQueued - smLoaded - smFailed);
+
+   // What the loads didn't take is left to the memory budget.
+   for(U32 i = 0; i < smHeld.size(); i++)
+      ResourceManager->unlock(smHeld[i]);
+   smHeld.clear();
+   smRequested.clear();
+   TextureManager::releasePrefetchedBitmaps();
+
+   if(smAccessLog)
+      writeAccessLog();
+}
+
+//-----------------------------------------------------------------------------
+
+void MissionLoadPipeline::getAccessLogName(const char *missionFile, char *buffer, U32 size)
+{
+   dSprintf(buffer, size, "%s/", smAccessLogPath);
+   U32 len = dStrlen(buffer);
+   for(const char *walk = missionFile; *walk && len < size - 5; walk++)
+      buffer[len++] = (*walk == '/' || *walk == ':' || *walk == '\\') ? '_' : *walk;
+   dStrcpy(buffer + len, ".txt");
+}
+
+void MissionLoadPipeline::prefetchAccessLog(const char *missionFile)
+{
+   char fileName[512];
+   getAccessLogName(missionFile, fileName, sizeof(fileName));
+
+   FileStream stream;
+   if(!stream.open(fileName, FileStream::Read))
+      return;
+
+   char line[512];
+   while(stream.getStatus() == Stream::Ok)
+   {
+      stream.readLine((U8 *) line, sizeof(line));
+      if(!line[0])
+         continue;
+
+      // Only what can be built on the loader thread; scripts and the files
+      // read through streams are in the log for repackZipInAccessOrder().
+      if(hasBitmapExtension(line) || hasExtension(line, ".dds"))
+      {
+         if(!TextureManager::isActive())
+            continue;
+         char textureName[512];
+         dStrcpy(textureName, line);
+         *dStrrchr(textureName, '.') = '\0';
+         if(!TextureManager::isTextureLoaded(textureName))
+            prefetch(line);
+      }
+      else if(ResourceManager->canConstruct(line))
+         prefetch(line);
+   }
+}
+
+void MissionLoadPipeline::writeAccessLog()
+{
+   Vector<StringTableEntry> files;
+   ResourceManager->stopAccessLog(files);
+   if(!files.size() || !smAccessLogPath || !smAccessLogPath[0])
+      return;
+
+   char fileName[512];
+   getAccessLogName(smMissionFile, fileName, sizeof(fileName));
+   Platform::createPath(fileName);
+
+   FileStream stream;
+   if(!stream.open(fileName, FileStream::Write))
+   {
+      Con::warnf("Unable to write the mission access log %s.", fileName);
+      return;
+   }
+   for(U32 i = 0; i < files.size(); i++)
+   {
+      stream.write(dStrlen(files[i]), files[i]);
+      stream.write(U8('\n'));
+   }
+   stream.close();
+}
+
+//-----------------------------------------------------------------------------
+
+bool MissionLoadPipeline::prefetch(const char *fileName)
+{
+   ResourceObject *obj = ResourceManager->find(fileName);
+   if(!obj)
+      return false;
+   for(U32 i = 0; i < smRequested.size(); i++)
+      if(smRequested[i] == obj)
+         return true;
+   smRequested.push_back(obj);
+
+   if(!ResourceManager->loadAsync(fileName, prefetchLoaded))
+      return false;
+   smQueued++;
+   return true;
+}
+
+bool MissionLoadPipeline::prefetchTexture(const char *textureName, bool recurse)
+{
+   if(!TextureManager::isActive() || !textureName || !textureName[0])
+      return false;
+
+   // Already on the card from an earlier load, nothing to read.
+   if(TextureManager::isTextureLoaded(textureName))
+      return true;
+
+   char buffer[512];
+   dStrncpy(buffer, textureName, sizeof(buffer) - 16);
+   buffer[sizeof(buffer) - 16] = '\0';
+   U32 len = dStrlen(buffer);
+
+   // Precompressed textures are only used where the card and the texture
+   // type allow it, which isn't known here; leave those to the load.
+   dStrcpy(buffer + len, ".dds");
+   if(ResourceManager->find(buffer))
+      return true;
+
+   for(U32 i = 0; i < sizeof(csBitmapExts) / sizeof(csBitmapExts[0]); i++)
+   {
+      dStrcpy(buffer + len, csBitmapExts[i]);
+      if((i || hasBitmapExtension(buffer)) && ResourceManager->find(buffer))
+         return prefetch(buffer);
+   }
+
+   // On up through the parent directories, but never the root, as
+   // loadBitmapInstance() does.
+   buffer[len] = '\0';
+   char *name = dStrrchr(buffer, '/');
+   if(!recurse || !name)
+      return false;
+   *name++ = '\0';
+   char *parent = dStrrchr(buffer, '/');
+   if(!parent)
+      return false;
+
+   char next[512];
+   dSprintf(next, sizeof(next), "%.*s/%s", S32(parent - buffer), buffer, name);
+   return prefetchTexture(next, true);
+}
+
+void MissionLoadPipeline::prefetchMaterialList(const char *fileName)
+{
+   ResourceObject *obj = ResourceManager->find(fileName);
+   if(!obj)
+      return;
+   Stream *stream = ResourceManager->openStream(obj);
+   if(!stream)
+      return;
+
+   // A .dml is one texture name per line, relative to the file.
+   MaterialList list;
+   if(list.read(*stream))
+      for(U32 i = 0; i < list.size(); i++)
+      {
+         const char *name = list.getMaterialName(i);
+         if(!name || !name[0])
+            continue;
+         char buffer[512];
+         dSprintf(buffer, sizeof(buffer), "%s/%s", obj->path, name);
+         prefetchTexture(buffer, true);
+      }
+   ResourceManager->closeStream(stream);
+}
+
+void MissionLoadPipeline::prefetchFileName(const char *fileName)
+{
+   if(!fileName || !fileName[0])
+      return;
+
+   if(hasExtension(fileName, ".dts") || hasExtension(fileName, ".dif") ||
+      hasExtension(fileName, ".ter"))
+      prefetch(fileName);
+   else if(hasExtension(fileName, ".dml"))
+      prefetchMaterialList(fileName);
+   else if(hasBitmapExtension(fileName))
+      prefetchTexture(fileName, false);
+   else if(!dStrchr(fileName, '.') || dStrrchr(fileName, '/') > dStrrchr(fileName, '.'))
+      prefetchTexture(fileName, true);
+}
+
+U32 MissionLoadPipeline::preloadTextures(S32 count, const char **names)
+{
+   if(!smRunning || !smPrefetch)
+      return 0;
+
+   U32 found = 0;
+   for(S32 i = 0; i < count; i++)
+      if(prefetchTexture(names[i], true))
+         found++;
+   return found;
+}
+
+void MissionLoadPipeline::prefetchDataBlock(SimDataBlock *db)
+{
+   if(!smRunning || !smPrefetch || !db)
+      return;
+
+   const AbstractClassRep::FieldList &fields = db->getClassRep()->mFieldList;
+   for(U32 i = 0; i < fields.size(); i++)
+   {
+      const AbstractClassRep::Field &field = fields[i];
+      if(field.type != TypeFilename)
+         continue;
+      for(S32 j = 0; j < field.elementCount; j++)
+         prefetchFileName(*(StringTableEntry *) ((U8 *) db + field.offset + j * sizeof(StringTableEntry)));
+   }
+}
+
+bool MissionLoadPipeline::isDataBlockReady(SimDataBlock *db)
+{
+   if(!db || !ResourceManager->getNumAsyncLoads())
+      return true;
+
+   const AbstractClassRep::FieldList &fields = db->getClassRep()->mFieldList;
+   for(U32 i = 0; i < fields.size(); i++)
+   {
+      const AbstractClassRep::Field &field = fields[i];
+      if(field.type != TypeFilename)
+         continue;
+      for(S32 j = 0; j < field.elementCount; j++)
+      {
+         const char *fileName = *(StringTableEntry *) ((U8 *) db + field.offset + j * sizeof(StringTableEntry));
+         if(!fileName || !fileName[0])
+            continue;
+
+         // Textures are picked up by the texture manager as they come in,
+         // and their decodes are cheap next to a shape's.
+         if((hasExtension(fileName, ".dts") || hasExtension(fileName, ".dif") ||
+             hasExtension(fileName, ".ter")) && ResourceManager->isLoadPending(fileName))
+            return false;
+      }
+   }
+   return true;
+}
+
+void MissionLoadPipeline::scanMission(const char *missionFile)
+{
+   Stream *stream = ResourceManager->openStream(missionFile);
+   if(!stream)
+      return;
+
+   U32 size = stream->getStreamSize();
+   char *text = new char[size + 1];
+   bool ok = stream->read(size, text);
+   ResourceManager->closeStream(stream);
+   if(!ok)
+   {
+      delete [] text;
+      return;
+   }
+   text[size] = '\0';
+
+   // Every quoted string that names a file we know how to load; the field
+   // names don't matter.
+   char value[256], fileName[512];
+   for(const char *walk = dStrchr(text, '"'); walk; walk = dStrchr(walk + 1, '"'))
+   {
+      const char *start = walk + 1;
+      const char *end = start;
+      while(*end && *end != '"' && *end != '\n')
+      {
+         if(*end == '\\' && end[1])
+            end++;
+         end++;
+      }
+      if(*end != '"')
+         break;
+      walk = end;
+
+      U32 len = end - start;
+      if(!len || len >= sizeof(value) || !dStrchr(start, '.') || dStrchr(start, '.') > end)
+         continue;
+      dStrncpy(value, start, len);
+      value[len] = '\0';
+
+      expandPath(fileName, sizeof(fileName), missionFile, value);
+      if(dStrchr(fileName, '.') && !dStrchr(fileName, '\\'))
+         prefetchFileName(fileName);
+   }
+   delete [] text;
+}
+
+//-----------------------------------------------------------------------------
+
+void MissionLoadPipeline::prefetchLoaded(ResourceObject *obj, void *)
+{
+   if(!obj)
+   {
+      if(smRunning)
+         smFailed++;
+      return;
+   }
+   if(!smRunning)
+   {
+      ResourceManager->unlock(obj);
+      return;
+   }
+   smLoaded++;
+   smBytes += obj->fileSize;
+
+   char buffer[512];
+   if(hasExtension(obj->name, ".dts"))
+   {
+      TSShape *shape = static_cast<TSShape *>(obj->mInstance);
+      if(shape->materialList)
+         for(U32 i = 0; i < shape->materialList->size(); i++)
+         {
+            const char *name = shape->materialList->getMaterialName(i);
+            if(!name || !name[0])
+               continue;
+            dSprintf(buffer, sizeof(buffer), "%s/%s", obj->path, name);
+            prefetchTexture(buffer, true);
+         }
+   }
+   else if(hasExtension(obj->name, ".dif"))
+   {
+      InteriorResource *res = static_cast<InteriorResource *>(obj->mInstance);
+      for(U32 d = 0; d < res->getNumDetailLevels(); d++)
+      {
+         MaterialList *list = res->getDetailLevel(d)->getMaterialList();
+         for(U32 i = 0; list && i < list->size(); i++)
+         {
+            const char *name = list->getMaterialName(i);
+            if(!name || !name[0])
+               continue;
+            dSprintf(buffer, sizeof(buffer), "%s/%s", obj->path, name);
+            prefetchTexture(buffer, true);
+         }
+      }
+   }
+   else if(hasExtension(obj->name, ".ter"))
+   {
+      // Tried as named first, then next to the terrain; see
+      // TerrainBlock::buildMaterialMap().
+      TerrainFile *file = static_cast<TerrainFile *>(obj->mInstance);
+      for(U32 i = 0; i < TerrainBlock::MaterialGroups; i++)
+      {
+         const char *name = file->mMaterialFileName[i];
+         if(!name || !name[0])
+            break;
+         dSprintf(buffer, sizeof(buffer), "%s/%s", obj->path, name);
+         if(!prefetchTexture(name, true))
+            prefetchTexture(buffer, true);
+      }
+   }
+   else
+   {
+      // A bitmap; the texture loads take the decoded copy.
+      TextureManager::addPrefetchedBitmap(obj);
+      return;
+   }
+   smHeld.push_back(obj);
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction(startMissionLoad, void, 2, 2, "(string missionFile) - Start timing a mission load "
+                "and prefetch the files the mission and the datablocks use.")
+{
+   MissionLoadPipeline::start(argv[1]);
+}
+
+ConsoleFunction(missionLoadStage, void, 2, 2, "(string name) - Start timing the next stage of the mission load.")
+{
+   MissionLoadPipeline::beginStage(argv[1]);
+}
+
+ConsoleFunction(endMissionLoad, void, 1, 1, "() - Report the mission load times and release the prefetched files.")
+{
+   MissionLoadPipeline::finish();
+}
+
+ConsoleFunction(isMissionLoadRunning, bool, 1, 1, "() - Is a mission load being timed?")
+{
+   return MissionLoadPipeline::isRunning();
+}
+
+ConsoleFunction(preloadTextures, S32, 2, 0, "(string texture, ...) - Decode the named textures in the "
+                "background for the running mission load.  Returns how many were found.")
+{
+   if(!MissionLoadPipeline::isRunning())
+   {
+      Con::warnf("preloadTextures: no mission load is running.");
+      return 0;
+   }
+   return MissionLoadPipeline::preloadTextures(argc - 1, argv + 1);
+}
+
+//-----------------------------------------------------------------------------
+
+struct ZipRepackEntry
+{
+   char name[ZipDirFileHeader::MaxFileNameLength + 1];
+   U32 localOffset;
+   U16 method;
+   U16 modTime;
+   U16 modDate;
+   U32 crc;
+   U32 compressedSize;
+   U32 uncompressedSize;
+   bool placed;
+};
+
+/// Rewrite a zip with the entries named in the access logs first, in the
+/// order they were first read, and the rest after them as they were.
+/// Entries whose compression already suits them (ZipWriter::getMethodFor())
+/// are copied as they are; the rest are inflated or deflated to suit.
+static bool repackZip(const char *zipFile, const char *outFile, S32 numLogs, const char **logs)
+{
+   FileStream in;
+   if(!in.open(zipFile, FileStream::Read))
+   {
+      Con::errorf("repackZipInAccessOrder: unable to open %s.", zipFile);
+      return false;
+   }
+
+   // Same as ZipAggregate, a zip file comment isn't supported.
+   ZipEOCDRecord eocd;
+   if(!in.setPosition(in.getStreamSize() - sizeof(ZipEOCDRecord::EOCDRecord)) ||
+      !eocd.readFromStream(in) || !in.setPosition(eocd.m_record.cdOffset))
+   {
+      Con::errorf("repackZipInAccessOrder: %s isn't a zip file.", zipFile);
+      return false;
+   }
+
+   Vector<ZipRepackEntry> entries;
+   for(U32 i = 0; i < eocd.m_record.numCDEntriesTotal; i++)
+   {
+      ZipDirFileHeader header;
+      if(!header.readFromStream(in))
+      {
+         Con::errorf("repackZipInAccessOrder: bad directory in %s.", zipFile);
+         return false;
+      }
+
+      entries.increment();
+      ZipRepackEntry &entry = entries.last();
+      dStrcpy(entry.name, header.m_pFileName);
+      entry.localOffset      = header.m_header.relativeOffsetOfLocalHeader;
+      entry.method           = header.m_header.compressionMethod;
+      entry.modTime          = header.m_header.lastModTime;
+      entry.modDate          = header.m_header.lastModDate;
+      entry.crc              = header.m_header.crc32;
+      entry.compressedSize   = header.m_header.compressedSize;
+      entry.uncompressedSize = header.m_header.uncompressedSize;
+      entry.placed           = false;
+   }
+
+   // The logged files that live in this zip give the order.
+   Vector<U32> order;
+   for(S32 l = 0; l < numLogs; l++)
+   {
+      FileStream log;
+      if(!log.open(logs[l], FileStream::Read))
+      {
+         Con::warnf("repackZipInAccessOrder: unable to open %s.", logs[l]);
+         continue;
+      }
+      char line[512], volume[512];
+      while(log.getStatus() == Stream::Ok)
+      {
+         log.readLine((U8 *) line, sizeof(line));
+         ResourceObject *obj = line[0] ? ResourceManager->find(line) : NULL;
+         if(!obj || !(obj->flags & ResourceObject::VolumeBlock))
+            continue;
+         dSprintf(volume, sizeof(volume), "%s/%s", obj->zipPath, obj->zipName);
+         if(dStricmp(volume, zipFile))
+            continue;
+         for(U32 i = 0; i < entries.size(); i++)
+            if(entries[i].localOffset == U32(obj->fileOffset) && !entries[i].placed)
+            {
+               entries[i].placed = true;
+               order.push_back(i);
+               break;
+            }
+      }
+   }
+   U32 numOrdered = order.size();
+   for(U32 i = 0; i < entries.size(); i++)
+      if(!entries[i].placed)
+         order.push_back(i);
+
+   ZipWriter out;
+   if(!out.open(outFile))
+   {
+      Con::errorf("repackZipInAccessOrder: unable to write %s.", outFile);
+      return false;
+   }
+
+   U32 numChanged = 0;
+   for(U32 i = 0; i < order.size(); i++)
+   {
+      const ZipRepackEntry &entry = entries[order[i]];
+      ZipLocalFileHeader header;
+      if(!in.setPosition(entry.localOffset) || !header.readFromStream(in))
+      {
+         Con::errorf("repackZipInAccessOrder: bad entry in %s.", zipFile);
+         return false;
+      }
+
+      U32 method = ZipWriter::getMethodFor(entry.name);
+      bool known = (entry.method == ZipWriter::Stored || entry.method == ZipWriter::Deflated);
+      bool ok;
+      if(method == entry.method || !known)
+         ok = out.addRawEntry(entry.name, in, entry.method, entry.crc, entry.compressedSize,
+                              entry.uncompressedSize, entry.modTime, entry.modDate);
+      else
+      {
+         U8 *data = new U8[entry.uncompressedSize ? entry.uncompressedSize : 1];
+         if(entry.method == ZipWriter::Deflated)
+         {
+            ZipSubRStream zipStream;
+            zipStream.attachStream(&in);
+            zipStream.setUncompressedSize(entry.uncompressedSize);
+            ok = zipStream.read(entry.uncompressedSize, data);
+            zipStream.detachStream();
+         }
+         else
+            ok = in.read(entry.uncompressedSize, data);
+
+         if(ok)
+            ok = out.addFile(entry.name, data, entry.uncompressedSize, method,
+                             entry.modTime, entry.modDate);
+         delete [] data;
+         numChanged++;
+      }
+
+      if(!ok)
+      {
+         Con::errorf("repackZipInAccessOrder: error copying %s from %s.", entry.name, zipFile);
+         out.close();
+         return false;
+      }
+   }
+
+   if(!out.close())
+   {
+      Con::errorf("repackZipInAccessOrder: error writing %s.", outFile);
+      return false;
+   }
+
+   Con::printf("Repacked %s to %s, %d of %d entries in access order, %d recompressed.",
+               zipFile, outFile, numOrdered, order.size(), numChanged);
+   return true;
+}
+
+ConsoleFunction(repackZipInAccessOrder, bool, 4, 0, "(string zipFile, string outFile, string accessLog, ...) - "
+                "Write a copy of zipFile with the files named in the mission access logs first, "
+                "in the order they were first read.  Already compressed files (.ogg, .jpg, .png...) "
+                "are stored, the rest deflated.")
+{
+   return repackZip(argv[1], argv[2], argc - 3, argv + 3);
+}
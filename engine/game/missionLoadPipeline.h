@@ -0,0 +1,116 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _MISSIONLOADPIPELINE_H_
+#define _MISSIONLOADPIPELINE_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+
+class ResourceObject;
+class SimDataBlock;
+
+/// Overlaps the disk reads of a mission load with the rest of it.
+///
+/// startMissionLoad() scans the mission file and the datablocks for the
+/// shapes, interiors, terrains, skies and textures they name, and queues
+/// them all with ResManager::loadAsync() so they're read and constructed on
+/// the loader thread while the mission objects are created, the datablocks
+/// are sent and the ghosts arrive.  Once a shape, interior or terrain is in,
+/// the textures of its materials are queued too; PNGs and JPEGs decode on
+/// the job system, several at once.  A blocking load of a file
+/// that's still in flight just waits for it, so nothing is read twice.
+///
+/// The prefetched resources stay locked until endMissionLoad(), so the
+/// purgeResources() calls between the load phases don't throw them away.
+/// Textures go to the texture manager, which hands the decoded bitmaps to
+/// the texture loads (TextureManager::addPrefetchedBitmap()).
+///
+/// The scripts mark the stages with missionLoadStage(); endMissionLoad()
+/// prints the time spent in each and how many files were prefetched.
+///
+/// With $pref::MissionLoad::accessLog each load also records the files it
+/// actually used, in the order of first use (ResManager::startAccessLog()),
+/// to a log per mission in $pref::MissionLoad::accessLogPath.  The next
+/// load of that mission prefetches what the log names first, in that order,
+/// before falling back to the scan.  repackZipInAccessOrder() uses the
+/// logs to rewrite a zip with its entries in the order they're read.
+///
+/// $pref::MissionLoad::prefetch turns the prefetching off, the timings are
+/// kept either way.
+class MissionLoadPipeline
+{
+   struct Stage
+   {
+      StringTableEntry name;
+      U32 ms;
+      U32 filesDone;       ///< Prefetches that finished during the stage.
+   };
+
+   static bool                    smRunning;
+   static StringTableEntry        smMissionFile;
+   static U64                     smStartUs;
+   static U64                     smStageStartUs;
+   static Vector<Stage>           smStages;
+   static Vector<ResourceObject*> smRequested;  ///< Everything queued, to skip repeats.
+   static Vector<ResourceObject*> smHeld;       ///< Loaded, locked until finish().
+   static U32                     smQueued;
+   static U32                     smLoaded;
+   static U32                     smFailed;
+   static U32                     smBytes;
+
+   static void endStage();
+   static bool prefetch(const char *fileName);
+   static bool prefetchTexture(const char *textureName, bool recurse);
+   static void prefetchMaterialList(const char *fileName);
+   static void prefetchFileName(const char *fileName);
+   static void scanMission(const char *missionFile);
+   static void getAccessLogName(const char *missionFile, char *buffer, U32 size);
+   static void prefetchAccessLog(const char *missionFile);
+   static void writeAccessLog();
+   static void prefetchLoaded(ResourceObject *obj, void *userData);
+
+  public:
+   static bool smPrefetch;       ///< $pref::MissionLoad::prefetch
+   static bool smAccessLog;      ///< $pref::MissionLoad::accessLog
+   static const char *smAccessLogPath;  ///< $pref::MissionLoad::accessLogPath
+   static S32  smLastLoadMs;     ///< $MissionLoad::lastLoadMs
+
+   static void consoleInit();
+
+   static bool isRunning() { return smRunning; }
+
+   /// Start timing a load of missionFile and queue what it needs.  Does
+   /// nothing if that mission is already being loaded, so the server and a
+   /// local client can both call it.
+   static void start(const char *missionFile);
+
+   /// End the current stage and start timing the next.
+   static void beginStage(const char *name);
+
+   /// Print the report and release the prefetched resources.
+   static void finish();
+
+   /// Queue the files a datablock names.  Called for every datablock when
+   /// the load starts, and on the client as they arrive.
+   static void prefetchDataBlock(SimDataBlock *db);
+
+   /// Are the shapes, interiors and terrains the datablock names done
+   /// loading in the background?  The client holds off its preload() until
+   /// they are, instead of blocking on each in turn.
+   static bool isDataBlockReady(SimDataBlock *db);
+
+   /// Queue textures by name, as a TextureHandle would look them up; they
+   /// decode side by side on the job system.  Only while a load is running,
+   /// since what the loads don't use is released by finish().  Returns how
+   /// many were found.
+   static U32 preloadTextures(S32 count, const char **names);
+};
+
+#endif
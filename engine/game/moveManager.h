@@ -28,6 +28,11 @@ struct Move
 
    void pack(BitStream *stream);
    void unpack(BitStream *stream);
+   /// Pack only what changed since prev, which the reader must already have.
+   void packDelta(BitStream *stream, const Move &prev);
+   void unpackDelta(BitStream *stream, const Move &prev);
+   /// True if this packs to the same bits as other.
+   bool isPackedEqual(const Move &other) const;
    void clamp();
    void unclamp();
 };
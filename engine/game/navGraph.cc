@@ -0,0 +1,557 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "game/navGraph.h"
+#include "game/aiPlayer.h"
+#include "game/missionArea.h"
+#include "console/console.h"
+#include "console/consoleTypes.h"
+#include "sim/sceneObject.h"
+#include "platform/profiler.h"
+
+Vector<NavGraph::Node>   NavGraph::smNodes;
+Vector<S32>              NavGraph::smLinks;
+Vector<S32>              NavGraph::smCells;
+Point2F                  NavGraph::smOrigin(0, 0);
+F32                      NavGraph::smSpacing = 1;
+S32                      NavGraph::smCellsX = 0;
+S32                      NavGraph::smCellsY = 0;
+
+Vector<NavGraph::Query*> NavGraph::smQueries;
+Vector<NavGraph::Query*> NavGraph::smFreeQueries;
+S32                      NavGraph::smNextQueryId = 1;
+NavGraph::CacheEntry     NavGraph::smCache[NavGraph::CacheSize];
+
+S32 NavGraph::smSliceExpansions = 256;
+S32 NavGraph::smMaxQueries = 8;
+F32 NavGraph::smMaxSlope = 45;
+F32 NavGraph::smStepHeight = 0.75f;
+F32 NavGraph::smClearance = 2.0f;
+
+static const U32 csFloorMask = InteriorObjectType | StaticShapeObjectType |
+                               StaticObjectType | TerrainObjectType;
+static const F32 csTopZ = 2048.0f;
+static const F32 csBottomZ = -2048.0f;
+
+//-----------------------------------------------------------------------------
+
+void NavGraph::consoleInit()
+{
+   Con::addVariable("$NavGraph::sliceExpansions", TypeS32, &smSliceExpansions);
+   Con::addVariable("$NavGraph::maxQueries",      TypeS32, &smMaxQueries);
+   Con::addVariable("$NavGraph::maxSlope",        TypeF32, &smMaxSlope);
+   Con::addVariable("$NavGraph::stepHeight",      TypeF32, &smStepHeight);
+   Con::addVariable("$NavGraph::clearance",       TypeF32, &smClearance);
+
+   for(U32 i = 0; i < CacheSize; i++)
+      smCache[i].startNode = InvalidNode;
+}
+
+S32 NavGraph::getCell(const Point3F &pos)
+{
+   S32 x = mClamp(S32(mFloor((pos.x - smOrigin.x) / smSpacing)), 0, smCellsX - 1);
+   S32 y = mClamp(S32(mFloor((pos.y - smOrigin.y) / smSpacing)), 0, smCellsY - 1);
+   return y * smCellsX + x;
+}
+
+bool NavGraph::canLink(const Node &a, const Node &b)
+{
+   // Climbs up to the slope, plus a step.
+   Point3F delta = b.pos - a.pos;
+   F32 run = mSqrt(delta.x * delta.x + delta.y * delta.y);
+   if(mFabs(delta.z) > smStepHeight + run * mTan(mDegToRad(smMaxSlope)))
+      return false;
+
+   // Anything lower than a step can be walked over.
+   Point3F knee(0, 0, smStepHeight);
+   RayInfo info;
+   return !gServerContainer.castRay(a.pos + knee, b.pos + knee, csFloorMask, &info);
+}
+
+//-----------------------------------------------------------------------------
+
+void NavGraph::build(const RectF &area, F32 spacing)
+{
+   clear();
+
+   U32 startMs = Platform::getRealMilliseconds();
+   smSpacing = getMax(spacing, 0.5f);
+   smOrigin  = area.point;
+   smCellsX  = getMax(S32(area.extent.x / smSpacing), 1);
+   smCellsY  = getMax(S32(area.extent.y / smSpacing), 1);
+   smCells.setSize(smCellsX * smCellsY);
+
+   // Every floor each ray goes through, as long as there's room to stand.
+   F32 minNormalZ = mCos(mDegToRad(smMaxSlope));
+   for(S32 y = 0; y < smCellsY; y++)
+   {
+      for(S32 x = 0; x < smCellsX; x++)
+      {
+         S32 cell = y * smCellsX + x;
+         smCells[cell] = InvalidNode;
+
+         Point3F from(smOrigin.x + (x + 0.5f) * smSpacing, smOrigin.y + (y + 0.5f) * smSpacing, csTopZ);
+         Point3F to(from.x, from.y, csBottomZ);
+         for(U32 layer = 0; layer < MaxLayers && from.z > to.z; layer++)
+         {
+            RayInfo info;
+            if(!gServerContainer.castRay(from, to, csFloorMask, &info))
+               break;
+
+            Point3F floor = info.point;
+            RayInfo dummy;
+            if(info.normal.z >= minNormalZ &&
+               !gServerContainer.castRay(floor + Point3F(0, 0, 0.1f), floor + Point3F(0, 0, smClearance),
+                                         csFloorMask, &dummy))
+            {
+               smNodes.increment();
+               Node &node = smNodes.last();
+               node.pos = floor;
+               node.firstLink = 0;
+               node.numLinks = 0;
+               node.nextInCell = smCells[cell];
+               smCells[cell] = smNodes.size() - 1;
+            }
+
+            // A floor closer than that to the one above can't be stood on.
+            from.z = floor.z - smClearance;
+         }
+      }
+   }
+
+   // Links to the nodes in the eight cells around.
+   for(S32 y = 0; y < smCellsY; y++)
+   {
+      for(S32 x = 0; x < smCellsX; x++)
+      {
+         for(S32 n = smCells[y * smCellsX + x]; n != InvalidNode; n = smNodes[n].nextInCell)
+         {
+            Node &node = smNodes[n];
+            node.firstLink = smLinks.size();
+            for(S32 ny = getMax(y - 1, 0); ny <= getMin(y + 1, smCellsY - 1); ny++)
+               for(S32 nx = getMax(x - 1, 0); nx <= getMin(x + 1, smCellsX - 1); nx++)
+               {
+                  if(nx == x && ny == y)
+                     continue;
+                  for(S32 m = smCells[ny * smCellsX + nx]; m != InvalidNode; m = smNodes[m].nextInCell)
+                     if(canLink(node, smNodes[m]))
+                     {
+                        smLinks.push_back(m);
+                        node.numLinks++;
+                     }
+               }
+         }
+      }
+   }
+
+   Con::printf("NavGraph: %d nodes, %d links over %dx%d cells in %d ms.", smNodes.size(),
+               smLinks.size(), smCellsX, smCellsY, Platform::getRealMilliseconds() - startMs);
+}
+
+void NavGraph::waitForQueries()
+{
+   if(!gThreadPool)
+      return;
+   for(U32 i = 0; i < smQueries.size(); i++)
+      gThreadPool->waitForCounter(&smQueries[i]->counter);
+}
+
+void NavGraph::clear()
+{
+   waitForQueries();
+
+   // Nobody hears about queries on a graph that's gone.
+   for(U32 i = 0; i < smQueries.size(); i++)
+      delete smQueries[i];
+   smQueries.clear();
+   for(U32 i = 0; i < smFreeQueries.size(); i++)
+      delete smFreeQueries[i];
+   smFreeQueries.clear();
+
+   for(U32 i = 0; i < CacheSize; i++)
+   {
+      smCache[i].startNode = InvalidNode;
+      smCache[i].path.clear();
+   }
+
+   smNodes.clear();
+   smLinks.clear();
+   smCells.clear();
+   smCellsX = smCellsY = 0;
+}
+
+S32 NavGraph::findNearestNode(const Point3F &pos)
+{
+   if(!isBuilt())
+      return InvalidNode;
+
+   S32 cell = getCell(pos);
+   S32 cx = cell % smCellsX;
+   S32 cy = cell / smCellsX;
+
+   // Rings out from the cell until something turns up.
+   S32 best = InvalidNode;
+   F32 bestScore = 0;
+   for(S32 ring = 0; ring <= 2 && best == InvalidNode; ring++)
+   {
+      for(S32 y = getMax(cy - ring, 0); y <= getMin(cy + ring, smCellsY - 1); y++)
+         for(S32 x = getMax(cx - ring, 0); x <= getMin(cx + ring, smCellsX - 1); x++)
+            for(S32 n = smCells[y * smCellsX + x]; n != InvalidNode; n = smNodes[n].nextInCell)
+            {
+               // A floor well overhead is a poor match for one underfoot.
+               Point3F delta = smNodes[n].pos - pos;
+               if(delta.z > smStepHeight)
+                  delta.z *= 4;
+               F32 score = delta.lenSquared();
+               if(best == InvalidNode || score < bestScore)
+               {
+                  best = n;
+                  bestScore = score;
+               }
+            }
+   }
+   return best;
+}
+
+//-----------------------------------------------------------------------------
+
+void NavGraph::Query::begin()
+{
+   U32 count = smNodes.size();
+   if(visitTag.size() != count)
+   {
+      cost.setSize(count);
+      parent.setSize(count);
+      visitTag.setSize(count);
+      dMemset(visitTag.address(), 0, count * sizeof(U32));
+      tag = 0;
+   }
+   if(++tag == 0)
+   {
+      dMemset(visitTag.address(), 0, count * sizeof(U32));
+      tag = 1;
+   }
+
+   open.clear();
+   path.clear();
+   visitTag[startNode] = tag;
+   cost[startNode] = 0;
+   parent[startNode] = InvalidNode;
+   pushOpen(startNode, (smNodes[goalNode].pos - smNodes[startNode].pos).len());
+   status = Searching;
+}
+
+void NavGraph::Query::pushOpen(S32 node, F32 estimate)
+{
+   open.increment();
+   U32 i = open.size() - 1;
+   while(i)
+   {
+      U32 up = (i - 1) >> 1;
+      if(open[up].estimate <= estimate)
+         break;
+      open[i] = open[up];
+      i = up;
+   }
+   open[i].estimate = estimate;
+   open[i].node = node;
+}
+
+S32 NavGraph::Query::popOpen()
+{
+   if(open.empty())
+      return InvalidNode;
+
+   S32 node = open[0].node;
+   Open last = open.last();
+   open.decrement();
+   U32 count = open.size();
+   U32 i = 0;
+   while(count)
+   {
+      U32 child = i * 2 + 1;
+      if(child >= count)
+         break;
+      if(child + 1 < count && open[child + 1].estimate < open[child].estimate)
+         child++;
+      if(last.estimate <= open[child].estimate)
+         break;
+      open[i] = open[child];
+      i = child;
+   }
+   if(count)
+      open[i] = last;
+   return node;
+}
+
+void NavGraph::Query::process()
+{
+   if(status == Waiting)
+      begin();
+
+   const Point3F &goalPos = smNodes[goalNode].pos;
+   for(S32 expanded = 0; expanded < smSliceExpansions && status == Searching; expanded++)
+   {
+      S32 node = popOpen();
+      if(node == InvalidNode)
+      {
+         status = Failed;
+         break;
+      }
+      if(node == goalNode)
+      {
+         for(S32 n = goalNode; n != InvalidNode; n = parent[n])
+            path.push_front(n);
+         status = Found;
+         break;
+      }
+
+      // The heap keeps entries for nodes found cheaper since; skip those.
+      const Node &cur = smNodes[node];
+      for(U32 i = 0; i < cur.numLinks; i++)
+      {
+         S32 next = smLinks[cur.firstLink + i];
+         F32 nextCost = cost[node] + (smNodes[next].pos - cur.pos).len();
+         if(visitTag[next] == tag && cost[next] <= nextCost)
+            continue;
+         visitTag[next] = tag;
+         cost[next] = nextCost;
+         parent[next] = node;
+         pushOpen(next, nextCost + (goalPos - smNodes[next].pos).len());
+      }
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+NavGraph::CacheEntry &NavGraph::getCacheEntry(S32 startNode, S32 goalNode)
+{
+   U32 hash = U32(startNode) * 2654435761u ^ U32(goalNode);
+   return smCache[(hash ^ (hash >> 16)) & (CacheSize - 1)];
+}
+
+S32 NavGraph::findPathAsync(const Point3F &start, const Point3F &goal,
+                            Receiver receiver, SimObjectId receiverId)
+{
+   if(!isBuilt())
+      return 0;
+
+   Query *query;
+   if(smFreeQueries.size())
+   {
+      query = smFreeQueries.last();
+      smFreeQueries.pop_back();
+   }
+   else
+      query = new Query;
+
+   query->id = smNextQueryId++;
+   query->receiver = receiver;
+   query->receiverId = receiverId;
+   query->start = start;
+   query->goal = goal;
+   query->startNode = findNearestNode(start);
+   query->goalNode = findNearestNode(goal);
+   query->status = Query::Waiting;
+   query->cancelled = false;
+   query->path.clear();
+
+   // Found before, it's delivered on the next tick without a search.
+   if(query->startNode != InvalidNode && query->goalNode != InvalidNode)
+   {
+      CacheEntry &entry = getCacheEntry(query->startNode, query->goalNode);
+      if(entry.startNode == query->startNode && entry.goalNode == query->goalNode)
+      {
+         query->path = entry.path;
+         query->status = Query::Found;
+      }
+   }
+
+   smQueries.push_back(query);
+   return query->id;
+}
+
+bool NavGraph::findPath(const Point3F &start, const Point3F &goal, Vector<Point3F> &points)
+{
+   points.clear();
+   if(!isBuilt())
+      return false;
+
+   Query query;
+   query.startNode = findNearestNode(start);
+   query.goalNode = findNearestNode(goal);
+   if(query.startNode == InvalidNode || query.goalNode == InvalidNode)
+      return false;
+   query.status = Query::Waiting;
+   query.tag = 0;
+   while(query.status == Query::Waiting || query.status == Query::Searching)
+      query.process();
+   if(query.status != Query::Found)
+      return false;
+
+   for(U32 i = 0; i < query.path.size(); i++)
+      points.push_back(smNodes[query.path[i]].pos);
+   points.push_back(goal);
+   return true;
+}
+
+void NavGraph::cancelQuery(S32 id)
+{
+   for(U32 i = 0; i < smQueries.size(); i++)
+      if(smQueries[i]->id == id)
+         smQueries[i]->cancelled = true;
+}
+
+void NavGraph::deliver(Query *query, bool found)
+{
+   Vector<Point3F> points;
+   if(found)
+   {
+      CacheEntry &entry = getCacheEntry(query->startNode, query->goalNode);
+      entry.startNode = query->startNode;
+      entry.goalNode = query->goalNode;
+      entry.path = query->path;
+
+      for(U32 i = 0; i < query->path.size(); i++)
+         points.push_back(smNodes[query->path[i]].pos);
+      points.push_back(query->goal);
+   }
+
+   if(query->receiver == ReceiverAIPlayer)
+   {
+      AIPlayer *bot;
+      if(Sim::findObject(query->receiverId, bot))
+         bot->onPathResult(query->id, found, points);
+      return;
+   }
+
+   SimObject *obj = Sim::findObject(query->receiverId);
+   if(!obj)
+      return;
+
+   char *pathBuffer = (char *) dMalloc(points.size() * 48 + 1);
+   pathBuffer[0] = 0;
+   U32 len = 0;
+   for(U32 i = 0; i < points.size(); i++)
+      len += dSprintf(pathBuffer + len, 48, i ? " %g %g %g" : "%g %g %g",
+                      points[i].x, points[i].y, points[i].z);
+   Con::executef(obj, 3, "onPathResult", Con::getIntArg(query->id), pathBuffer);
+   dFree(pathBuffer);
+}
+
+void NavGraph::processQueries()
+{
+   if(smQueries.empty())
+      return;
+
+   PROFILE_START(NavGraphQueries);
+
+   // Deliver what's done, in the order it was asked for, and give the
+   // rest another slice each.
+   S32 running = 0;
+   for(U32 i = 0; i < smQueries.size(); )
+   {
+      Query *query = smQueries[i];
+      if(!query->counter.isDone())
+      {
+         running++;
+         i++;
+         continue;
+      }
+
+      bool done = query->status == Query::Found || query->status == Query::Failed;
+      if(done || query->cancelled)
+      {
+         smQueries.erase(i);
+         if(!query->cancelled)
+         {
+            // Starting or ending off the graph can't be searched.
+            if(query->startNode == InvalidNode || query->goalNode == InvalidNode)
+               query->status = Query::Failed;
+            deliver(query, query->status == Query::Found);
+         }
+         smFreeQueries.push_back(query);
+         continue;
+      }
+
+      if(running < smMaxQueries)
+      {
+         running++;
+         if(query->startNode == InvalidNode || query->goalNode == InvalidNode)
+            query->status = Query::Failed;
+         else if(gThreadPool)
+            gThreadPool->queueWorkItem(query, &query->counter);
+         else
+            query->process();
+      }
+      i++;
+   }
+
+   PROFILE_END();
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction(navGraphBuild, void, 1, 3, "([float spacing], [string area]) - Build the "
+                "navigation graph from the server's terrain and interiors, sampling the "
+                "\"x y width height\" area, by default the mission area, every spacing meters (2).")
+{
+   F32 spacing = (argc > 1) ? dAtof(argv[1]) : 2.0f;
+
+   RectF area;
+   if(argc > 2)
+      dSscanf(argv[2], "%g %g %g %g", &area.point.x, &area.point.y, &area.extent.x, &area.extent.y);
+   else
+   {
+      const MissionArea *obj = MissionArea::getServerObject();
+      const RectI &rect = obj ? const_cast<MissionArea *>(obj)->getArea() : MissionArea::smMissionArea;
+      area.point.set(F32(rect.point.x), F32(rect.point.y));
+      area.extent.set(F32(rect.extent.x), F32(rect.extent.y));
+   }
+   NavGraph::build(area, spacing);
+}
+
+ConsoleFunction(navGraphClear, void, 1, 1, "() - Free the navigation graph.")
+{
+   NavGraph::clear();
+}
+
+ConsoleFunction(navGraphGetNodeCount, S32, 1, 1, "() - Nodes in the navigation graph.")
+{
+   return NavGraph::getNodeCount();
+}
+
+ConsoleFunction(navGraphFindPath, const char *, 3, 4, "(Point3F start, Point3F goal, [SimObject receiver]) - "
+                "Without a receiver, search right away and return the path as a list of points, "
+                "or \"\" if there's none.  With one, queue the search and return its id; "
+                "receiver.onPathResult(id, path) is called when it's done.")
+{
+   Point3F start(0, 0, 0), goal(0, 0, 0);
+   dSscanf(argv[1], "%g %g %g", &start.x, &start.y, &start.z);
+   dSscanf(argv[2], "%g %g %g", &goal.x, &goal.y, &goal.z);
+
+   if(argc > 3)
+   {
+      SimObject *receiver = Sim::findObject(argv[3]);
+      if(!receiver)
+         return "0";
+      char *idBuffer = Con::getReturnBuffer(16);
+      dSprintf(idBuffer, 16, "%d", NavGraph::findPathAsync(start, goal, NavGraph::ReceiverScript,
+                                                           receiver->getId()));
+      return idBuffer;
+   }
+
+   Vector<Point3F> points;
+   if(!NavGraph::findPath(start, goal, points))
+      return "";
+
+   char *returnBuffer = Con::getReturnBuffer(points.size() * 48 + 1);
+   returnBuffer[0] = 0;
+   U32 len = 0;
+   for(U32 i = 0; i < points.size(); i++)
+      len += dSprintf(returnBuffer + len, 48, i ? " %g %g %g" : "%g %g %g",
+                      points[i].x, points[i].y, points[i].z);
+   return returnBuffer;
+}
@@ -0,0 +1,173 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _NAVGRAPH_H_
+#define _NAVGRAPH_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+#ifndef _MPOINT_H_
+#include "math/mPoint.h"
+#endif
+#ifndef _MRECT_H_
+#include "math/mRect.h"
+#endif
+#ifndef _SIMBASE_H_
+#include "console/simBase.h"
+#endif
+#ifndef _THREADPOOL_H_
+#include "core/threadPool.h"
+#endif
+
+/// Walkable graph of the server's mission, with A* path queries.
+///
+/// build() drops rays down a grid over an area and keeps every floor they
+/// hit that's flat enough and has room to stand, terrain and interiors
+/// alike, so a cell can have a node on each storey.  Nodes in neighbouring
+/// cells are linked when the step between them is small enough and nothing
+/// is in the way at knee height.
+///
+/// Path queries are queued with findPathAsync() and searched on the thread
+/// pool, at most $NavGraph::sliceExpansions nodes per query per tick, so a
+/// long search never holds up a tick.  $NavGraph::maxQueries run at once,
+/// the rest wait their turn.  Finished paths are kept in a small cache by
+/// their start and goal nodes and handed out again without a search.
+/// Results are delivered on the main thread, to the AIPlayer that asked
+/// (AIPlayer::setPathDestination()) or to a script callback.
+///
+/// The graph only reads itself while searching, so building or clearing it
+/// waits for the searches in flight first.
+class NavGraph
+{
+  public:
+   enum Constants {
+      MaxLayers = 4,          ///< Floors per cell.
+      CacheSize = 256,
+      InvalidNode = -1
+   };
+
+   /// Who wants to hear about a finished query.
+   enum Receiver {
+      ReceiverAIPlayer,       ///< AIPlayer::onPathResult().
+      ReceiverScript          ///< %obj.onPathResult(%queryId, %path)
+   };
+
+  private:
+   struct Node
+   {
+      Point3F pos;
+      U32 firstLink;
+      U8  numLinks;
+      S32 nextInCell;         ///< Next node up the same cell's column.
+   };
+
+   struct Query : public ThreadPool::WorkItem
+   {
+      enum Status {
+         Waiting,
+         Searching,
+         Found,
+         Failed
+      };
+
+      S32 id;
+      Receiver receiver;
+      SimObjectId receiverId;
+      S32 startNode;
+      S32 goalNode;
+      Point3F start;
+      Point3F goal;
+      volatile Status status;
+      bool cancelled;         ///< Dropped once the slice in flight is done.
+      ThreadPool::Counter counter;
+
+      /// Search state, per node.
+      Vector<F32> cost;
+      Vector<S32> parent;
+      Vector<U32> visitTag;
+      U32 tag;
+
+      /// Open list, a binary heap on estimated total cost.
+      struct Open
+      {
+         F32 estimate;
+         S32 node;
+      };
+      Vector<Open> open;
+      Vector<S32> path;
+
+      void begin();
+      void pushOpen(S32 node, F32 estimate);
+      S32  popOpen();
+      void process();
+   };
+
+   struct CacheEntry
+   {
+      S32 startNode;
+      S32 goalNode;
+      Vector<S32> path;
+   };
+
+   static Vector<Node>   smNodes;
+   static Vector<S32>    smLinks;
+   static Vector<S32>    smCells;        ///< First node of each cell's column, or InvalidNode.
+   static Point2F        smOrigin;
+   static F32            smSpacing;
+   static S32            smCellsX;
+   static S32            smCellsY;
+
+   static Vector<Query*> smQueries;      ///< Waiting or searching, in the order they came.
+   static Vector<Query*> smFreeQueries;
+   static S32            smNextQueryId;
+   static CacheEntry     smCache[CacheSize];
+
+   static S32  getCell(const Point3F &pos);
+   static bool canLink(const Node &a, const Node &b);
+   static void waitForQueries();
+   static CacheEntry &getCacheEntry(S32 startNode, S32 goalNode);
+   static void deliver(Query *query, bool found);
+
+  public:
+   static S32 smSliceExpansions;   ///< $NavGraph::sliceExpansions
+   static S32 smMaxQueries;        ///< $NavGraph::maxQueries
+   static F32 smMaxSlope;          ///< $NavGraph::maxSlope, degrees.
+   static F32 smStepHeight;        ///< $NavGraph::stepHeight
+   static F32 smClearance;         ///< $NavGraph::clearance, room to stand.
+
+   static void consoleInit();
+
+   /// Samples the area (x, y, width, height) every spacing meters.
+   static void build(const RectF &area, F32 spacing);
+   static void clear();
+
+   static bool isBuilt() { return smNodes.size() != 0; }
+   static U32  getNodeCount() { return smNodes.size(); }
+
+   /// The node closest to pos, preferring the floor below it.
+   static S32 findNearestNode(const Point3F &pos);
+   static const Point3F &getNodePos(S32 node) { return smNodes[node].pos; }
+
+   /// Queues a search; the result goes to the receiver from processQueries().
+   /// Returns the query id, or 0 if there's no graph.
+   static S32 findPathAsync(const Point3F &start, const Point3F &goal,
+                            Receiver receiver, SimObjectId receiverId);
+
+   /// Searches right away, on the calling thread.
+   static bool findPath(const Point3F &start, const Point3F &goal, Vector<Point3F> &points);
+
+   /// Forgets a query that hasn't been delivered yet.
+   static void cancelQuery(S32 id);
+
+   /// Delivers finished queries and starts the next slice of the rest.
+   /// Called once a server tick.
+   static void processQueries();
+};
+
+#endif
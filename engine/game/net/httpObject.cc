@@ -175,6 +175,7 @@ void HTTPObject::onConnected()
    send((U8*)buffer, dStrlen(buffer));
    mParseState = ParsingStatusLine;
    mChunkedEncoding = false;
+   mContentLength = U32(-1);
 }
 
 void HTTPObject::onConnectFailed()
@@ -210,10 +211,17 @@ bool HTTPObject::processLine(U8 *line)
    {
       if(!dStricmp((char *) line, "transfer-encoding: chunked"))
          mChunkedEncoding = true;
+      if(!dStrnicmp((char *) line, "content-length:", 15))
+         mContentLength = dAtoi((char *) line + 15);
       if(line[0] == 0)
       {
          if(mChunkedEncoding)
             mParseState = ParsingChunkHeader;
+         else if(mReceiveMode != ReceiveLines && mContentLength == 0)
+         {
+            mParseState = ProcessingDone;
+            finishReceive();
+         }
          else
             mParseState = ProcessingBody;
          return true;
@@ -242,6 +250,7 @@ bool HTTPObject::processLine(U8 *line)
          {
             mParseState = ProcessingDone;
             finishLastLine();
+            finishReceive();
          }
       }
    }
@@ -254,6 +263,13 @@ bool HTTPObject::processLine(U8 *line)
 
 U32 HTTPObject::onDataReceive(U8 *buffer, U32 bufferLen)
 {
+   // the body goes straight to the buffer or file
+   if(mReceiveMode != ReceiveLines)
+   {
+      receiveData(buffer, bufferLen);
+      return bufferLen;
+   }
+
    U32 start = 0;
    parseLine(buffer, &start, bufferLen);
    return start;
@@ -281,6 +297,19 @@ U32 HTTPObject::onReceive(U8 *buffer, U32 bufferLen)
          }
          return ret;
       }
+      else if(!mChunkedEncoding && mReceiveMode != ReceiveLines && mContentLength != U32(-1))
+      {
+         // with a length we know when it's done, without waiting for the
+         // server to hang up
+         U32 ret = onDataReceive(buffer, getMin(bufferLen, mContentLength));
+         mContentLength -= ret;
+         if(mContentLength == 0)
+         {
+            mParseState = ProcessingDone;
+            finishReceive();
+         }
+         return ret;
+      }
       else
       {
          U32 ret = onDataReceive(buffer, bufferLen);
@@ -33,11 +33,16 @@ private:
    S32 mArgc;
    char *mArgv[MaxRemoteCommandArgs + 1];
    StringHandle mTagv[MaxRemoteCommandArgs + 1];
+   U32 mChannel;
    static char mBuf[1024];
 public:
-   RemoteCommandEvent(S32 argc=0, const char **argv=NULL, NetConnection *conn = NULL)
+   /// A channel makes it a latest value command, see commandToClientLatest().
+   RemoteCommandEvent(S32 argc=0, const char **argv=NULL, NetConnection *conn = NULL, U32 channel = 0)
    {
       mArgc = argc;
+      mChannel = channel;
+      if(channel)
+         mGuaranteeType = Unguaranteed;
       for(S32 i = 0; i < argc; i++)
       {
          if(argv[i][0] == StringTagPrefixByte)
@@ -71,6 +76,11 @@ public:
          dFree(mArgv[i+1]);
    }
 
+   U32 getChannel() const
+   {
+      return mChannel;
+   }
+
    virtual void pack(NetConnection* conn, BitStream *bstream)
    {
       bstream->writeInt(mArgc, CommandArgsBits);
@@ -128,7 +138,10 @@ public:
 				 return;
 			 }
 		  }
-		  const char *rmtCommandName = dStrchr(mArgv[1], ' ') + 1;
+		  const char *rmtCommandName = dStrchr(mArgv[1], ' ');
+		  if(!rmtCommandName)
+			 return;
+		  rmtCommandName++;
 		  if(conn->isConnectionToServer())
 		  {
 			 dStrcpy(mBuf, "clientCmd");
@@ -162,7 +175,7 @@ char RemoteCommandEvent::mBuf[1024];
 
 IMPLEMENT_CO_NETEVENT_V1(RemoteCommandEvent);
 
-static void sendRemoteCommand(NetConnection *conn, S32 argc, const char **argv)
+static void sendRemoteCommand(NetConnection *conn, S32 argc, const char **argv, const char *channel = NULL)
 {
    if(U8(argv[0][0]) != StringTagPrefixByte)
    {
@@ -178,7 +191,27 @@ static void sendRemoteCommand(NetConnection *conn, S32 argc, const char **argv)
    }
    for(i = 0; i < argc; i++)
       conn->validateSendString(argv[i]);
-   RemoteCommandEvent *cevt = new RemoteCommandEvent(argc, argv, conn);
+
+   // Unguaranteed events go ahead of the string events in a packet, so a
+   // latest value command waits for its tags to be known on the other side
+   // and goes ordered until then.
+   U32 channelKey = 0;
+   if(channel)
+   {
+      channelKey = _StringTable::hashString(channel) | 1;
+      for(i = 0; i < argc && channelKey; i++)
+      {
+         if(argv[i][0] != StringTagPrefixByte)
+            continue;
+         StringHandle tag(dAtoi(argv[i] + 1));
+         bool isOnOtherSide;
+         conn->checkString(tag, &isOnOtherSide);
+         if(!isOnOtherSide)
+            channelKey = 0;
+      }
+   }
+
+   RemoteCommandEvent *cevt = new RemoteCommandEvent(argc, argv, conn, channelKey);
    conn->postNetEvent(cevt);
 }
 
@@ -201,6 +234,26 @@ ConsoleFunction( commandToClient, void, 3, RemoteCommandEvent::MaxRemoteCommandA
    sendRemoteCommand(conn, argc - 2, argv + 2);
 }
 
+ConsoleFunction( commandToServerLatest, void, 3, RemoteCommandEvent::MaxRemoteCommandArgs + 2, "(string channel, string func, ...)"
+                "Send a command to the server that may be dropped or replaced by a newer one on the same channel "
+                "that's sent before it goes out.  For values that change all the time, where only the last matters.")
+{
+   NetConnection *conn = NetConnection::getConnectionToServer();
+   if(!conn)
+      return;
+   sendRemoteCommand(conn, argc - 2, argv + 2, argv[1]);
+}
+
+ConsoleFunction( commandToClientLatest, void, 4, RemoteCommandEvent::MaxRemoteCommandArgs + 3, "(NetConnection client, string channel, string func, ...)"
+                "Like commandToClient(), but unguaranteed, and a newer command on the same channel replaces one "
+                "that hasn't been sent yet.  For HUD updates and the like that are sent every tick.")
+{
+   NetConnection *conn;
+   if(!Sim::findObject(argv[1], conn))
+      return;
+   sendRemoteCommand(conn, argc - 3, argv + 3, argv[2]);
+}
+
 ConsoleFunction(removeTaggedString, void, 2, 2, "(int tag)")
 {
    gNetStringTable->removeString(dAtoi(argv[1]+1), true);
@@ -85,6 +85,7 @@
 #include "core/resManager.h"
 #include "core/bitStream.h"
 #include "console/console.h"
+#include "console/consoleTypes.h"
 #include "console/simBase.h"
 #include "game/banList.h"
 #include "game/version.h"
@@ -107,6 +108,7 @@ static const S32 gPacketRetryCount = 4;
 static const S32 gPacketTimeout = 1000;
 static const S32 gMaxConcurrentPings = 10;
 static const S32 gMaxConcurrentQueries = 2;
+static const U32 gListUpdateInterval = 1000;
 static const S32 gPingRetryCount = 4;
 static const S32 gPingTimeout = 800;
 static const S32 gQueryRetryCount = 4;
@@ -122,6 +124,12 @@ static bool gGotFirstListPacket = false;
 static U32 gServerPingCount = 0;
 static U32 gServerQueryCount = 0;
 static U32 gHeartbeatSeq = 0;
+static U32 gLastListUpdate = 0;
+
+// Fast query mode, $pref::Net::fastServerQuery:
+static bool sgFastQuery = false;
+static S32 sgFastMaxPings = 200;
+static S32 sgFastMaxQueries = 50;
 
 ConsoleFunctionGroupBegin( ServerQuery, "Functions which allow you to query the LAN or a master server for online games.");
 
@@ -143,6 +151,71 @@ static Vector<Ping> gQueryList(__FILE__, __LINE__);
 
 //-----------------------------------------------------------------------------
 
+/// Hashed lookup of list indices by address.  A full master list is well
+/// over a thousand servers, and every response looked itself up in the
+/// server and finished lists with a linear scan.
+struct AddressIndex
+{
+   enum { NumBuckets = 1024 };   // Power of two
+
+   struct Entry
+   {
+      NetAddress address;
+      S32 index;
+      S32 next;
+   };
+
+   Vector<Entry> entries;
+   S32 buckets[NumBuckets];
+
+   AddressIndex() { clear(); }
+
+   void clear()
+   {
+      entries.clear();
+      for ( U32 i = 0; i < NumBuckets; i++ )
+         buckets[i] = -1;
+   }
+
+   static U32 hash( const NetAddress* addr )
+   {
+      // The same fields Net::compareAddresses() always checks.
+      U32 h = addr->type * 31 + addr->port;
+      for ( U32 i = 0; i < 4; i++ )
+         h = h * 31 + addr->netNum[i];
+      return h & ( NumBuckets - 1 );
+   }
+
+   S32 find( const NetAddress* addr ) const
+   {
+      for ( S32 i = buckets[hash( addr )]; i != -1; i = entries[i].next )
+         if ( Net::compareAddresses( addr, &entries[i].address ) )
+            return entries[i].index;
+      return -1;
+   }
+
+   /// Keeps the first index given for an address, like a linear scan.
+   void insert( const NetAddress* addr, S32 index )
+   {
+      if ( find( addr ) != -1 )
+         return;
+
+      U32 bucket = hash( addr );
+      entries.increment();
+      Entry &entry = entries.last();
+      entry.address = *addr;
+      entry.index = index;
+      entry.next = buckets[bucket];
+      buckets[bucket] = entries.size() - 1;
+   }
+};
+
+static AddressIndex gServerIndex;      // gServerList
+static AddressIndex gFinishedIndex;    // gFinishedList
+static bool gServerIndexDirty = false; // rebuilt on the next lookup
+
+//-----------------------------------------------------------------------------
+
 struct PacketStatus
 {
    U8  index;
@@ -242,8 +315,10 @@ static void pushPingRequest( const NetAddress *addr );
 static void pushPingBroadcast( const NetAddress *addr );
 static void pushServerFavorites();
 static bool pickMasterServer();
-static S32 findPingEntry( Vector<Ping> &v, const NetAddress* addr );
+static S32 findPingEntry( Vector<Ping> &v, const NetAddress* addr, S32 window );
 static bool addressFinished( const NetAddress* addr );
+static void markAddressFinished( const NetAddress* addr );
+static void rebuildFinishedIndex();
 static ServerInfo* findServerInfo( const NetAddress* addr );
 static ServerInfo* findOrCreateServerInfo( const NetAddress* addr );
 static void removeServerInfo( const NetAddress* addr );
@@ -258,6 +333,8 @@ static void processServerListPackets( U32 session );
 static void processHeartbeat(U32);
 static void updatePingProgress();
 static void updateQueryProgress();
+static S32 getMaxConcurrentPings();
+static S32 getMaxConcurrentQueries();
 Vector<MasterInfo>* getMasterServerList();
 bool pickMasterServer();
 void clearServerList();
@@ -557,6 +634,7 @@ void querySingleServer( const NetAddress* addr, U8 /*flags*/ )
       if ( Net::compareAddresses( addr, &gFinishedList[i] ) )
       {
          gFinishedList.erase( i );
+         rebuildFinishedIndex();
          break;
       }
    }
@@ -626,7 +704,7 @@ void stopServerQuery()
       {
          while ( gPingList.size() )
          {
-            gFinishedList.push_back( gPingList[0].address );
+            markAddressFinished( &gPingList[0].address );
             gPingList.erase( U32( 0 ) );
          }
       }
@@ -804,6 +882,15 @@ bool pickMasterServer()
 
 //-----------------------------------------------------------------------------
 
+void serverQueryConsoleInit()
+{
+   Con::addVariable( "$pref::Net::fastServerQuery", TypeBool, &sgFastQuery );
+   Con::addVariable( "$pref::Net::fastQueryMaxPings", TypeS32, &sgFastMaxPings );
+   Con::addVariable( "$pref::Net::fastQueryMaxQueries", TypeS32, &sgFastMaxQueries );
+}
+
+//-----------------------------------------------------------------------------
+
 void clearServerList()
 {
    gPacketStatusList.clear();
@@ -811,6 +898,9 @@ void clearServerList()
    gFinishedList.clear();
    gPingList.clear();
    gQueryList.clear();
+   gServerIndex.clear();
+   gFinishedIndex.clear();
+   gServerIndexDirty = false;
    gServerPingCount = gServerQueryCount = 0;
 
    gPingSession++;
@@ -927,11 +1017,19 @@ static void pushServerFavorites()
 
 //-----------------------------------------------------------------------------
 
-static S32 findPingEntry( Vector<Ping> &v, const NetAddress* addr )
+static S32 findPingEntry( Vector<Ping> &v, const NetAddress* addr, S32 window )
 {
-   for ( U32 i = 0; i < v.size(); i++ )
+   // Requests are only sent from the front of the list and erasing ahead
+   // of them only moves them closer, so a response is nearly always for
+   // one of the first window entries.
+   S32 count = v.size();
+   S32 front = getMin( window, count );
+   for ( S32 i = 0; i < front; i++ )
+      if ( Net::compareAddresses( addr, &v[i].address ) )
+         return i;
+   for ( S32 i = front; i < count; i++ )
       if ( Net::compareAddresses( addr, &v[i].address ) )
-         return S32( i );
+         return i;
    return -1;
 }
 
@@ -939,20 +1037,37 @@ static S32 findPingEntry( Vector<Ping> &v, const NetAddress* addr )
 
 static bool addressFinished( const NetAddress* addr )
 {
+   return gFinishedIndex.find( addr ) != -1;
+}
+
+static void markAddressFinished( const NetAddress* addr )
+{
+   gFinishedIndex.insert( addr, gFinishedList.size() );
+   gFinishedList.push_back( *addr );
+}
+
+static void rebuildFinishedIndex()
+{
+   gFinishedIndex.clear();
    for ( U32 i = 0; i < gFinishedList.size(); i++ )
-      if ( Net::compareAddresses( addr, &gFinishedList[i] ) )
-         return true;
-   return false;
+      gFinishedIndex.insert( &gFinishedList[i], i );
 }
 
 //-----------------------------------------------------------------------------
 
 static ServerInfo* findServerInfo( const NetAddress* addr )
 {
-   for ( U32 i = 0; i < gServerList.size(); i++ )
-      if ( Net::compareAddresses( addr, &gServerList[i].address ) )
-         return &gServerList[i];
-   return NULL;
+   // Erasing shifts the indices, so the index is rebuilt lazily.
+   if ( gServerIndexDirty )
+   {
+      gServerIndex.clear();
+      for ( U32 i = 0; i < gServerList.size(); i++ )
+         gServerIndex.insert( &gServerList[i].address, i );
+      gServerIndexDirty = false;
+   }
+
+   S32 index = gServerIndex.find( addr );
+   return index != -1 ? &gServerList[index] : NULL;
 }
 
 //-----------------------------------------------------------------------------
@@ -966,6 +1081,7 @@ static ServerInfo* findOrCreateServerInfo( const NetAddress* addr )
    ServerInfo si;
    si.address = *addr;
    gServerList.push_back( si );
+   gServerIndex.insert( addr, gServerList.size() - 1 );
 
    return &gServerList.last();
 }
@@ -979,6 +1095,7 @@ static void removeServerInfo( const NetAddress* addr )
       if ( Net::compareAddresses( addr, &gServerList[i].address ) )
       {
          gServerList.erase( i );
+         gServerIndexDirty = true;
          gServerBrowserDirty = true;
       }
    }
@@ -1014,6 +1131,7 @@ void addFakeServers( S32 howMany )
       newServer.status = ServerInfo::Status_Responded;
 
       gServerList.push_back( newServer );
+      gServerIndex.insert( &newServer.address, gServerList.size() - 1 );
       sNumFakeServers++;
    }
 
@@ -1188,7 +1306,8 @@ static void processPingsAndQueries( U32 session, bool schedule )
    U8 flags = ServerFilter::OnlineQuery;
    bool waitingForMaster = ( sActiveFilter.type == ServerFilter::Normal ) && !gGotFirstListPacket && sgServerQueryActive;
 
-   for ( i = 0; i < gPingList.size() && i < gMaxConcurrentPings; )
+   U32 maxPings = getMaxConcurrentPings();
+   for ( i = 0; i < gPingList.size() && i < maxPings; )
    {
       Ping &p = gPingList[i];
 
@@ -1211,7 +1330,7 @@ static void processPingsAndQueries( U32 session, bool schedule )
                gServerBrowserDirty = true;
             }
 
-            gFinishedList.push_back( p.address );
+            markAddressFinished( &p.address );
             gPingList.erase( i );
 
             if ( !waitingForMaster )
@@ -1237,10 +1356,13 @@ static void processPingsAndQueries( U32 session, bool schedule )
          i++;
    }
 
-   if ( !gPingList.size() && !waitingForMaster )
+   // In fast mode the servers that have answered their ping are queried
+   // while the rest are still being pinged.
+   if ( ( !gPingList.size() || sgFastQuery ) && !waitingForMaster )
    {
       // Start the query phase:
-      for ( U32 i = 0; i < gQueryList.size() && i < gMaxConcurrentQueries; )
+      U32 maxQueries = getMaxConcurrentQueries();
+      for ( U32 i = 0; i < gQueryList.size() && i < maxQueries; )
       {
          Ping &p = gQueryList[i];
          if ( p.time + gPingTimeout < time )
@@ -1289,6 +1411,16 @@ static void processPingsAndQueries( U32 session, bool schedule )
       // the next ping.
       if (schedule)
          Sim::postEvent( Sim::getRootGroup(), new ProcessPingEvent( session ), Sim::getTargetTime() + 1 );
+
+      // Fill the list in as the answers come, rather than all at the end.
+      if ( sgFastQuery && gServerBrowserDirty && time - gLastListUpdate >= gListUpdateInterval )
+      {
+         gLastListUpdate = time;
+         gServerBrowserDirty = false;
+         char msg[64];
+         dSprintf( msg, sizeof( msg ), "%d servers found...", gServerList.size() );
+         Con::executef( 4, "onServerQueryStatus", "update", msg, "0" );
+      }
    }
    else
    {
@@ -1401,6 +1533,18 @@ static void updatePingProgress()
 
 //-----------------------------------------------------------------------------
 
+static S32 getMaxConcurrentPings()
+{
+   return sgFastQuery ? getMax( sgFastMaxPings, 1 ) : gMaxConcurrentPings;
+}
+
+static S32 getMaxConcurrentQueries()
+{
+   return sgFastQuery ? getMax( sgFastMaxQueries, 1 ) : gMaxConcurrentQueries;
+}
+
+//-----------------------------------------------------------------------------
+
 static void updateQueryProgress()
 {
    if ( gPingList.size() )
@@ -1660,7 +1804,7 @@ static void handleGamePingResponse( const NetAddress* address, BitStream* stream
    if( !gPingList.size() )
       return;
 
-   S32 index = findPingEntry( gPingList, address );
+   S32 index = findPingEntry( gPingList, address, getMaxConcurrentPings() );
    if( index == -1 )
    {
       // an anonymous ping response - if it's not already timed
@@ -1691,7 +1835,7 @@ static void handleGamePingResponse( const NetAddress* address, BitStream* stream
    {
       // Version is different, so remove it from consideration:
       Con::printf( "Server %s is a different version.", addrString );
-      gFinishedList.push_back( *address );
+      markAddressFinished( address );
       gPingList.erase( index );
       if ( si )
       {
@@ -1709,7 +1853,7 @@ static void handleGamePingResponse( const NetAddress* address, BitStream* stream
    if ( temp32 < GameConnection::MinRequiredProtocolVersion )
    {
       Con::printf( "Protocol for server %s does not meet minimum protocol.", addrString );
-      gFinishedList.push_back( *address );
+      markAddressFinished( address );
       gPingList.erase( index );
       if ( si )
       {
@@ -1726,7 +1870,7 @@ static void handleGamePingResponse( const NetAddress* address, BitStream* stream
    if ( GameConnection::CurrentProtocolVersion < temp32 )
    {
       Con::printf( "You do not meet the minimum protocol for server %s.", addrString );
-      gFinishedList.push_back( *address );
+      markAddressFinished( address );
       gPingList.erase( index );
       if ( si )
       {
@@ -1747,7 +1891,7 @@ static void handleGamePingResponse( const NetAddress* address, BitStream* stream
    {
       // Ping is too high, so remove this server from consideration:
       Con::printf( "Server %s filtered out by maximum ping.", addrString );
-      gFinishedList.push_back( *address );
+      markAddressFinished( address );
       gPingList.erase( index );
       if ( si )
          removeServerInfo( address );
@@ -1763,7 +1907,7 @@ static void handleGamePingResponse( const NetAddress* address, BitStream* stream
      && ( temp32 != getVersionNumber() ) )
    {
       Con::printf( "Server %s filtered out by version number.", addrString );
-      gFinishedList.push_back( *address );
+      markAddressFinished( address );
       gPingList.erase( index );
       if ( si )
          removeServerInfo( address );
@@ -1787,7 +1931,7 @@ static void handleGamePingResponse( const NetAddress* address, BitStream* stream
    }
 
    // Set the server up to be queried:
-   gFinishedList.push_back( *address );
+   markAddressFinished( address );
    p.key = 0;
    p.time = 0;
    p.tryCount = gQueryRetryCount;
@@ -1861,7 +2005,7 @@ static void handleGameInfoResponse( const NetAddress* address, BitStream* stream
    if ( !gQueryList.size() )
       return;
 
-   S32 index = findPingEntry( gQueryList, address );
+   S32 index = findPingEntry( gQueryList, address, getMaxConcurrentQueries() );
    if ( index == -1 )
       return;
 
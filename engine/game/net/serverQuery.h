@@ -105,6 +105,11 @@ struct ServerInfo
 
 extern Vector<ServerInfo> gServerList;
 extern bool gServerBrowserDirty;
+/// Registers the $pref::Net::fastServerQuery prefs.  In fast mode hundreds
+/// of pings and queries are kept in flight instead of ten and two, servers
+/// are queried as soon as they answer their ping, and onServerQueryStatus()
+/// gets an "update" about once a second with the servers found so far.
+extern void serverQueryConsoleInit();
 extern void clearServerList();
 extern void queryLanServers(U32 port, U8 flags, const char* gameType, const char* missionType,
       U8 minPlayers, U8 maxPlayers, U8 maxBots, U32 regionMask, U32 maxPing, U16 minCPU,
@@ -11,6 +11,8 @@
 #include "console/simBase.h"
 #include "console/consoleInternal.h"
 #include "game/demoGame.h"
+#include "core/fileStream.h"
+#include "core/resManager.h"
 
 TCPObject *TCPObject::table[TCPObject::TableSize] = {0, };
 
@@ -52,12 +54,21 @@ TCPObject::TCPObject()
    mTag = InvalidSocket;
    mNext = NULL;
    mState = Disconnected;
+
+   mReceiveMode = ReceiveLines;
+   mReceiveBuffer = NULL;
+   mReceiveSize = 0;
+   mReceiveCapacity = 0;
+   mReceiveFile = NULL;
+   mReceiveFileName = NULL;
 }
 
 TCPObject::~TCPObject()
 {
    disconnect();
    dFree(mBuffer);
+   dFree(mReceiveBuffer);
+   delete mReceiveFile;
 }
 
 bool TCPObject::processArguments(S32 argc, const char **argv)
@@ -94,6 +105,12 @@ bool TCPObject::onAdd()
 
 U32 TCPObject::onReceive(U8 *buffer, U32 bufferLen)
 {
+   if(mReceiveMode != ReceiveLines)
+   {
+      receiveData(buffer, bufferLen);
+      return bufferLen;
+   }
+
    // we got a raw buffer event
    // default action is to split the buffer into lines of text
    // and call processLine on each
@@ -147,6 +164,74 @@ void TCPObject::parseLine(U8 *buffer, U32 *start, U32 bufferLen)
       *start = i + 1;
 }
 
+bool TCPObject::setReceiveMode(ReceiveMode mode, const char *fileName)
+{
+   finishReceive();
+
+   mReceiveMode = ReceiveLines;
+   if(mode == ReceiveFile)
+   {
+      char filename[1024];
+      Con::expandScriptFilename(filename, sizeof(filename), fileName ? fileName : "");
+
+      FileStream *stream = new FileStream;
+      if(!fileName || !fileName[0] || !ResourceManager->openFileForWrite(*stream, filename, FileStream::Write))
+      {
+         Con::errorf("TCPObject::setReceiveMode - could not open '%s' for writing.", filename);
+         delete stream;
+         return false;
+      }
+      mReceiveFile = stream;
+      mReceiveFileName = StringTable->insert(filename);
+   }
+   mReceiveMode = mode;
+   mReceiveSize = 0;
+   return true;
+}
+
+void TCPObject::receiveData(const U8 *buffer, U32 bufferLen)
+{
+   if(mReceiveMode == ReceiveFile)
+   {
+      if(mReceiveFile)
+         mReceiveFile->write(bufferLen, buffer);
+   }
+   else
+   {
+      // room for the terminator script needs
+      if(mReceiveSize + bufferLen + 1 > mReceiveCapacity)
+      {
+         mReceiveCapacity = getMax(mReceiveCapacity * 2, getMax(mReceiveSize + bufferLen + 1, U32(4096)));
+         mReceiveBuffer = (U8 *) dRealloc(mReceiveBuffer, mReceiveCapacity);
+      }
+      dMemcpy(mReceiveBuffer + mReceiveSize, buffer, bufferLen);
+   }
+   mReceiveSize += bufferLen;
+}
+
+void TCPObject::finishReceive()
+{
+   char sizeBuf[16];
+   dSprintf(sizeBuf, sizeof(sizeBuf), "%d", mReceiveSize);
+
+   if(mReceiveMode == ReceiveBuffer && mReceiveSize)
+   {
+      // script sees up to the first 0, if the data has one
+      mReceiveBuffer[mReceiveSize] = 0;
+      mReceiveSize = 0;
+      Con::executef(this, 3, "onDataReceived", (const char *) mReceiveBuffer, sizeBuf);
+   }
+   else if(mReceiveMode == ReceiveFile && mReceiveFile)
+   {
+      mReceiveFile->close();
+      delete mReceiveFile;
+      mReceiveFile = NULL;
+      mReceiveSize = 0;
+      mReceiveMode = ReceiveLines;
+      Con::executef(this, 3, "onFileReceived", mReceiveFileName, sizeBuf);
+   }
+}
+
 void TCPObject::onConnectionRequest(const NetAddress *addr, U32 connectId)
 {
    char idBuf[16];
@@ -201,6 +286,7 @@ void TCPObject::finishLastLine()
 void TCPObject::onDisconnect()
 {
    finishLastLine();
+   finishReceive();
    mState = Disconnected;
    Con::executef(this, 1, "onDisconnect");
 }
@@ -238,6 +324,26 @@ ConsoleMethod( TCPObject, send, void, 3, 0, "(...)"
       object->send((const U8 *) argv[i], dStrlen(argv[i]));
 }
 
+ConsoleMethod( TCPObject, setReceiveMode, bool, 3, 4, "(string mode, string fileName=NULL)"
+              "How to handle what comes in: \"lines\" calls onLine(%line) for each line, "
+              "\"buffer\" calls onDataReceived(%data, %size) once when it's all in, "
+              "\"file\" writes it to fileName and calls onFileReceived(%fileName, %size).")
+{
+   TCPObject::ReceiveMode mode;
+   if(!dStricmp(argv[2], "lines"))
+      mode = TCPObject::ReceiveLines;
+   else if(!dStricmp(argv[2], "buffer"))
+      mode = TCPObject::ReceiveBuffer;
+   else if(!dStricmp(argv[2], "file"))
+      mode = TCPObject::ReceiveFile;
+   else
+   {
+      Con::errorf("TCPObject::setReceiveMode - unknown mode '%s'.", argv[2]);
+      return false;
+   }
+   return object->setReceiveMode(mode, argc > 3 ? argv[3] : NULL);
+}
+
 ConsoleMethod( TCPObject, listen, void, 3, 3, "(int port)"
               "Start listening on the specified ports for connections.")
 {
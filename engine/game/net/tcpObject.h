@@ -10,11 +10,32 @@
 #include "console/simBase.h"
 #endif
 
+class FileStream;
+
+/// A TCP connection scripts can use.
+///
+/// By default what comes in is split into lines, each handed to script in
+/// onLine().  For anything big that's a lot of script calls; the other
+/// receive modes skip them:
+///
+/// - ReceiveBuffer gathers everything into one buffer, handed to
+///   onDataReceived(%data, %size) in one call when the transfer's done.
+/// - ReceiveFile writes it all to a file as it comes, and calls
+///   onFileReceived(%fileName, %size) when it's done.
+///
+/// Done is on disconnect, or for an HTTPObject at the end of the body.
 class TCPObject : public SimObject
 {
 public:
    enum State {Disconnected, DNSResolved, Connected, Listening };
 
+   enum ReceiveMode
+   {
+      ReceiveLines,
+      ReceiveBuffer,
+      ReceiveFile
+   };
+
 private:
    NetSocket mTag;
    TCPObject *mNext;
@@ -28,6 +49,16 @@ protected:
    U32 mBufferSize;
    U16 mPort;
 
+   /// @name Bulk receive
+   /// @{
+   ReceiveMode mReceiveMode;
+   U8 *mReceiveBuffer;
+   U32 mReceiveSize;             ///< Bytes received this transfer.
+   U32 mReceiveCapacity;
+   FileStream *mReceiveFile;
+   StringTableEntry mReceiveFileName;
+   /// @}
+
 public:
    TCPObject();
    virtual ~TCPObject();
@@ -35,6 +66,19 @@ public:
    void parseLine(U8 *buffer, U32 *start, U32 bufferLen);
    void finishLastLine();
 
+   /// Switches how received data is handled, finishing whatever the last
+   /// mode had.  ReceiveFile needs a file name, and falls back to lines if
+   /// it can't be opened.
+   bool setReceiveMode(ReceiveMode mode, const char *fileName = NULL);
+   ReceiveMode getReceiveMode() { return mReceiveMode; }
+
+   /// Adds to the buffer or file in the bulk modes.
+   void receiveData(const U8 *buffer, U32 bufferLen);
+
+   /// Hands a bulk transfer to script.  A file is done after one; the mode
+   /// goes back to lines.
+   void finishReceive();
+
    static TCPObject *find(NetSocket tag);
 
    // onReceive gets called continuously until all bytes are processed
@@ -802,6 +802,7 @@ Player::Player()
    mConvex.init(this);
    mWorkingQueryBox.min.set(-1e9f, -1e9f, -1e9f);
    mWorkingQueryBox.max.set(-1e9f, -1e9f, -1e9f);
+   mContactCacheValid = false;
 
    mWeaponBackFraction = 0.0f;
 
@@ -828,6 +829,7 @@ bool Player::onAdd()
 
    mWorkingQueryBox.min.set(-1e9f, -1e9f, -1e9f);
    mWorkingQueryBox.max.set(-1e9f, -1e9f, -1e9f);
+   mContactCacheValid = false;
 
    addToScene();
 
@@ -905,6 +907,7 @@ void Player::onRemove()
 
    mWorkingQueryBox.min.set(-1e9f, -1e9f, -1e9f);
    mWorkingQueryBox.max.set(-1e9f, -1e9f, -1e9f);
+   mContactCacheValid = false;
 
    Parent::onRemove();
 }
@@ -2776,6 +2779,12 @@ void Player::findContact(bool* run,bool* jump,VectorF* contactNormal)
          serverParent = NULL;
    }
 
+   // The cached surfaces do if the box is still inside the cached one
+   // and the contact objects of the working list are where they were.
+   bool cacheValid = mContactCacheValid && serverParent == NULL &&
+                     mContactCacheBox.isContained(plistBox);
+   U32 cacheIndex = 0;
+
    // Build list from convex states here...
    CollisionWorkingList& rList = mConvex.getWorkingList();
    CollisionWorkingList* pList = rList.wLink.mNext;
@@ -2812,9 +2821,14 @@ void Player::findContact(bool* run,bool* jump,VectorF* contactNormal)
       }
       else if ((objectMask & mask) && !(objectMask & PhysicalZoneObjectType))
       {
-         Box3F convexBox = pConvex->getBoundingBox();
-         if (plistBox.isOverlapped(convexBox) && serverParent == NULL)
-            pConvex->getPolyList(&polyList);
+         if (cacheValid)
+         {
+            SceneObject* obj = pConvex->getObject();
+            if (cacheIndex >= mContactObjects.size() || mContactObjects[cacheIndex] != obj ||
+                dMemcmp(&mContactTransforms[cacheIndex], &obj->getTransform(), sizeof(MatrixF)) != 0)
+               cacheValid = false;
+            cacheIndex++;
+         }
       }
 
       pList = pList->wLink.mNext;
@@ -2831,6 +2845,28 @@ void Player::findContact(bool* run,bool* jump,VectorF* contactNormal)
       return;
    }
 
+   // A convex removed from the working list since the cache was built
+   // leaves the count short.
+   if (!cacheValid || cacheIndex != mContactObjects.size())
+      buildContactCache(plistBox);
+
+   // Clip the cached polys to this tick's box.
+   MatrixF identity(true);
+   polyList.setTransform(&identity, Point3F(1.0f, 1.0f, 1.0f));
+   U32 base = polyList.mVertexList.size();
+   for (U32 i = 0; i < mContactPolys.mVertexList.size(); i++)
+      polyList.addPoint(mContactPolys.mVertexList[i]);
+   for (U32 i = 0; i < mContactPolys.mPolyList.size(); i++)
+   {
+      const ConcretePolyList::Poly& poly = mContactPolys.mPolyList[i];
+      polyList.setObject(poly.object);
+      polyList.begin(poly.material, poly.surfaceKey);
+      for (U32 j = 0; j < poly.vertexCount; j++)
+         polyList.vertex(base + mContactPolys.mIndexList[poly.vertexStart + j]);
+      polyList.plane(poly.plane);
+      polyList.end();
+   }
+
    if (!polyList.isEmpty())
    {
       // Pick flattest surface
@@ -2860,6 +2896,47 @@ void Player::findContact(bool* run,bool* jump,VectorF* contactNormal)
    mContactInfo.jump = *jump;
 }
 
+void Player::buildContactCache(const Box3F &plistBox)
+{
+   PROFILE_START(Player_buildContactCache);
+
+   // Big enough for the next few ticks at the current speed.
+   F32 expand = mVelocity.len() * TickSec * ContactCacheTicks + 0.1f;
+   mContactCacheBox = plistBox;
+   mContactCacheBox.min -= Point3F(expand, expand, expand);
+   mContactCacheBox.max += Point3F(expand, expand, expand);
+
+   mContactPolys.clear();
+   mContactPolys.doConstruct();
+   mContactPolys.setInterestNormal(Point3F(0.0f, 0.0f, -1.0f));
+   mContactObjects.clear();
+   mContactTransforms.clear();
+
+   // The same convexes findContact() collects from, in the same order.
+   CollisionWorkingList& rList = mConvex.getWorkingList();
+   CollisionWorkingList* pList = rList.wLink.mNext;
+   U32 mask = isGhost() ? sClientCollisionContactMask : sServerCollisionContactMask;
+   for (; pList != &rList; pList = pList->wLink.mNext)
+   {
+      Convex* pConvex = pList->mConvex;
+      SceneObject* obj = pConvex->getObject();
+      U32 objectMask = obj->getTypeMask();
+      if (objectMask & (TriggerObjectType | CorpseObjectType | ItemObjectType))
+         continue;
+      if (!(objectMask & mask) || (objectMask & PhysicalZoneObjectType))
+         continue;
+
+      mContactObjects.push_back(obj);
+      mContactTransforms.push_back(obj->getTransform());
+
+      if (mContactCacheBox.isOverlapped(pConvex->getBoundingBox()))
+         pConvex->getPolyList(&mContactPolys);
+   }
+   mContactCacheValid = true;
+
+   PROFILE_END();
+}
+
 //----------------------------------------------------------------------------
 
 void Player::checkMissionArea()
@@ -3415,6 +3492,7 @@ void Player::updateWorkingCollisionSet()
       mConvex.updateWorkingList(mWorkingQueryBox,
          isGhost() ? sClientCollisionContactMask : sServerCollisionContactMask);
       enableCollision();
+      mContactCacheValid = false;
    }
 }
 
@@ -3451,7 +3529,7 @@ void Player::writePacketData(GameConnection *connection, BitStream *stream)
    if (mControlObject) {
       S32 gIndex = connection->getGhostIndex(mControlObject);
       if (stream->writeFlag(gIndex != -1)) {
-         stream->writeInt(gIndex,NetConnection::GhostIdBitSize);
+         connection->packGhostIndex(stream, gIndex);
          mControlObject->writePacketData(connection, stream);
       }
    }
@@ -3496,7 +3574,7 @@ void Player::readPacketData(GameConnection *connection, BitStream *stream)
    delta.rot = rot;
 
    if (stream->readFlag()) {
-      S32 gIndex = stream->readInt(NetConnection::GhostIdBitSize);
+      S32 gIndex = connection->unpackGhostIndex(stream);
       ShapeBase* obj = static_cast<ShapeBase*>(connection->resolveGhost(gIndex));
       setControlObject(obj);
       obj->readPacketData(connection, stream);
@@ -3515,10 +3593,12 @@ U32 Player::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
    if (stream->writeFlag(mask & ActionMask &&
          mActionAnimation.action != PlayerData::NullAnimation &&
          mActionAnimation.action >= PlayerData::NumTableActionAnims)) {
-      stream->writeInt(mActionAnimation.action,PlayerData::ActionAnimBits);
-      stream->writeFlag(mActionAnimation.holdAtEnd);
-      stream->writeFlag(mActionAnimation.atEnd);
-      stream->writeFlag(mActionAnimation.firstPerson);
+      BitPacker bits;
+      bits.writeInt<PlayerData::ActionAnimBits>(mActionAnimation.action);
+      bits.writeFlag(mActionAnimation.holdAtEnd);
+      bits.writeFlag(mActionAnimation.atEnd);
+      bits.writeFlag(mActionAnimation.firstPerson);
+      bits.flush(stream);
       if (!mActionAnimation.atEnd) {
          // If somewhere in middle on initial update, must send position-
          F32   where = mShapeInstance->getPos(mActionAnimation.thread);
@@ -3543,15 +3623,19 @@ U32 Player::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
 
    if (stream->writeFlag(mask & MoveMask))
    {
-      stream->writeFlag(mFalling);
-
-      stream->writeInt(mState,NumStateBits);
-      if (stream->writeFlag(mState == RecoverState))
-         stream->writeInt(mRecoverTicks,PlayerData::RecoverDelayBits);
+      BitPacker bits;
+      bits.writeFlag(mFalling);
+      bits.writeInt<NumStateBits>(mState);
+      if (bits.writeFlag(mState == RecoverState))
+         bits.writeInt<PlayerData::RecoverDelayBits>(mRecoverTicks);
+      bits.flush(stream);
 
       Point3F pos;
       getTransform().getColumn(3,&pos);
-      stream->writeCompressedPoint(pos);
+      // centimeter fixed point, so consecutive updates delta well
+      con->packDeltaInt(stream, PosXDeltaField, U32(S32(mFloor(pos.x * 100.0f + 0.5f))), PositionBits, PositionDeltaBits);
+      con->packDeltaInt(stream, PosYDeltaField, U32(S32(mFloor(pos.y * 100.0f + 0.5f))), PositionBits, PositionDeltaBits);
+      con->packDeltaInt(stream, PosZDeltaField, U32(S32(mFloor(pos.z * 100.0f + 0.5f))), PositionBits, PositionDeltaBits);
       F32 len = mVelocity.len();
       if(stream->writeFlag(len > 0.02f))
       {
@@ -3563,17 +3647,25 @@ U32 Player::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
             len = 8191;
          stream->writeInt((S32)len, 13);
       }
-      stream->writeFloat(mRot.z / M_2PI_F, 7);
-      stream->writeSignedFloat(mHead.x / mDataBlock->maxLookAngle, 6);
-      stream->writeSignedFloat(mHead.z / mDataBlock->maxLookAngle, 6);
+      con->packDeltaFloat(stream, RotDeltaField, mRot.z / M_2PI_F, RotBits, RotDeltaBits);
+      bits.writeSignedFloat<6>(mHead.x / mDataBlock->maxLookAngle);
+      bits.writeSignedFloat<6>(mHead.z / mDataBlock->maxLookAngle);
+      bits.flush(stream);
       delta.move.pack(stream);
       stream->writeFlag(!(mask & NoWarpMask));
    }
    // Ghost need energy to predict reliably
-   stream->writeFloat(getEnergyLevel() / mDataBlock->maxEnergy,EnergyLevelBits);
+   con->packDeltaFloat(stream, EnergyDeltaField, mClampF(getEnergyLevel() / mDataBlock->maxEnergy, 0.0f, 1.0f), EnergyLevelBits, EnergyDeltaBits);
    return retMask;
 }
 
+bool Player::isParallelPackSafe(U32 mask)
+{
+   // ShapeBase packs string handles through the connection's string table,
+   // everything else is a straight read of our state.
+   return !(mask & (NameMask | SkinMask | ImageMask));
+}
+
 void Player::unpackUpdate(NetConnection *con, BitStream *stream)
 {
    Parent::unpackUpdate(con,stream);
@@ -3583,10 +3675,11 @@ void Player::unpackUpdate(NetConnection *con, BitStream *stream)
 
    // Server specified action animation
    if (stream->readFlag()) {
-      U32 action = stream->readInt(PlayerData::ActionAnimBits);
-      bool hold = stream->readFlag();
-      bool atEnd = stream->readFlag();
-      bool fsp = stream->readFlag();
+      BitUnpacker bits(stream, PlayerData::ActionAnimBits + 3);
+      U32 action = bits.readInt<PlayerData::ActionAnimBits>();
+      bool hold = bits.readFlag();
+      bool atEnd = bits.readFlag();
+      bool fsp = bits.readFlag();
 
       F32   animPos = -1.0f;
       if (!atEnd && stream->readFlag())
@@ -3636,10 +3729,11 @@ void Player::unpackUpdate(NetConnection *con, BitStream *stream)
 
    if (stream->readFlag()) {
       mPredictionCount = sMaxPredictionTicks;
-      mFalling = stream->readFlag();
+      BitUnpacker bits(stream, 1 + NumStateBits + 1);
+      mFalling = bits.readFlag();
 
-      ActionState actionState = (ActionState)stream->readInt(NumStateBits);
-      if (stream->readFlag()) {
+      ActionState actionState = (ActionState)bits.readInt<NumStateBits>();
+      if (bits.readFlag()) {
          mRecoverTicks = stream->readInt(PlayerData::RecoverDelayBits);
          setState(actionState, mRecoverTicks);
       }
@@ -3647,7 +3741,9 @@ void Player::unpackUpdate(NetConnection *con, BitStream *stream)
          setState(actionState);
 
       Point3F pos,rot;
-      stream->readCompressedPoint(&pos);
+      pos.x = S32(con->unpackDeltaInt(stream, PosXDeltaField, PositionBits, PositionDeltaBits)) * 0.01f;
+      pos.y = S32(con->unpackDeltaInt(stream, PosYDeltaField, PositionBits, PositionDeltaBits)) * 0.01f;
+      pos.z = S32(con->unpackDeltaInt(stream, PosZDeltaField, PositionBits, PositionDeltaBits)) * 0.01f;
       F32 speed = mVelocity.len();
       if(stream->readFlag())
       {
@@ -3660,14 +3756,21 @@ void Player::unpackUpdate(NetConnection *con, BitStream *stream)
       }
       
       rot.y = rot.x = 0.0f;
-      rot.z = stream->readFloat(7) * M_2PI_F;
-      mHead.x = stream->readSignedFloat(6) * mDataBlock->maxLookAngle;
-      mHead.z = stream->readSignedFloat(6) * mDataBlock->maxLookAngle;
+      rot.z = con->unpackDeltaFloat(stream, RotDeltaField, RotBits, RotDeltaBits) * M_2PI_F;
+      BitUnpacker head(stream, 6 + 6);
+      mHead.x = head.readSignedFloat<6>() * mDataBlock->maxLookAngle;
+      mHead.z = head.readSignedFloat<6>() * mDataBlock->maxLookAngle;
       delta.move.unpack(stream);
 
       delta.head = mHead;
       delta.headVec.set(0.0f, 0.0f, 0.0f);
 
+      // The state the server sent, not where the warp has us.
+      MatrixF snapMat;
+      snapMat.set(EulerF(0.0f, 0.0f, rot.z));
+      snapMat.setColumn(3, pos);
+      addSnapshot(snapMat);
+
       if (stream->readFlag() && isProperlyAdded())
       {
          // Determin number of ticks to warp based on the average
@@ -3727,7 +3830,7 @@ void Player::unpackUpdate(NetConnection *con, BitStream *stream)
          setPosition(pos,rot);
       }
    }
-   F32 energy = stream->readFloat(EnergyLevelBits) * mDataBlock->maxEnergy;
+   F32 energy = con->unpackDeltaFloat(stream, EnergyDeltaField, EnergyLevelBits, EnergyDeltaBits) * mDataBlock->maxEnergy;
    setEnergyLevel(energy);
 }
 
@@ -12,6 +12,9 @@
 #ifndef _BOXCONVEX_H_
 #include "collision/boxConvex.h"
 #endif
+#ifndef _CONCRETEPOLYLIST_H_
+#include "collision/concretePolyList.h"
+#endif
 
 class ParticleEmitter;
 class ParticleEmitterData;
@@ -301,6 +304,20 @@ protected:
       RecoverState,
       NumStateBits = 3
    };
+
+   /// Move state sent as deltas against the last acked update.
+   enum PlayerDeltaFields {
+      PosXDeltaField = Parent::NextFreeDeltaField,
+      PosYDeltaField,
+      PosZDeltaField,
+      RotDeltaField,
+      EnergyDeltaField,
+      PositionBits = 32,
+      PositionDeltaBits = 10,  ///< +/- 5.12m in 1cm units
+      RotBits = 7,
+      RotDeltaBits = 3,
+      EnergyDeltaBits = 3
+   };
    ActionState mState;              ///< What is the player doing? @see ActionState
    bool mFalling;                   ///< Falling in mid-air?
    S32  mJumpDelay;                 ///< Delay till next jump
@@ -383,6 +400,25 @@ protected:
    Box3F          mWorkingQueryBox;
 
   protected:
+   /// @name Contact Cache
+   /// findContact() gathers the surfaces around the feet for a box a few
+   /// ticks of movement bigger than it needs, so the ticks of a packet
+   /// of moves only clip the cached polys to their own box.  The cache
+   /// is dropped when the feet leave the box, the working list is
+   /// rebuilt, or an object in the working list moves.
+   /// @{
+   enum {
+      ContactCacheTicks = 4      ///< Ticks of movement the cached box allows for.
+   };
+   ConcretePolyList     mContactPolys;
+   Box3F                mContactCacheBox;
+   bool                 mContactCacheValid;
+   Vector<SceneObject*> mContactObjects;     ///< Contact objects of the working list when cached, in list order.
+   Vector<MatrixF>      mContactTransforms;  ///< ...and their transforms at the time.
+
+   void buildContactCache(const Box3F &plistBox);
+   /// @}
+
    void setState(ActionState state, U32 ticks=0);
    void updateState();
 
@@ -516,6 +552,7 @@ public:
    void readPacketData (GameConnection *conn, BitStream *stream);
    U32  packUpdate  (NetConnection *conn, U32 mask, BitStream *stream);
    void unpackUpdate(NetConnection *conn,           BitStream *stream);
+   bool isParallelPackSafe(U32 mask);
 };
 
 
@@ -998,7 +998,7 @@ U32 Projectile::packUpdate(NetConnection* con, U32 mask, BitStream* stream)
          S32 ghostIndex = con->getGhostIndex(mSourceObject);
          if (stream->writeFlag(ghostIndex != -1))
          {
-            stream->writeRangedU32(U32(ghostIndex), 0, NetConnection::MaxGhostCount);
+            con->packGhostIndex(stream, ghostIndex);
             stream->writeRangedU32(U32(mSourceObjectSlot),
                                    0, ShapeBase::MaxMountedImages - 1);
          }
@@ -1053,7 +1053,7 @@ void Projectile::unpackUpdate(NetConnection* con, BitStream* stream)
       mCurrTick = stream->readRangedU32(0, MaxLivingTicks);
       if (stream->readFlag())
       {
-         mSourceObjectId   = stream->readRangedU32(0, NetConnection::MaxGhostCount);
+         mSourceObjectId   = con->unpackGhostIndex(stream);
          mSourceObjectSlot = stream->readRangedU32(0, ShapeBase::MaxMountedImages - 1);
 
          NetObject* pObject = con->resolveGhost(mSourceObjectId);
@@ -1122,7 +1122,7 @@ bool Projectile::prepRenderImage(SceneState* state, const U32 stateKey,
    // This should be sufficient for most objects that don't manage zones, and
    //  don't need to return a specialized RenderImage...
    if (state->isObjectRendered(this)) {
-      SceneRenderImage* image = new SceneRenderImage;
+      SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
       image->obj = this;
       image->isTranslucent = true;
       image->sortType = SceneRenderImage::Point;
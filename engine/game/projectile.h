@@ -118,6 +118,7 @@ DECLARE_CONSOLETYPE(ProjectileData)
 class Projectile : public GameBase
 {
    typedef GameBase Parent;
+   friend class ProjectileBatch;
 
 public:
    // Initial conditions
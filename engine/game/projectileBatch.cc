@@ -0,0 +1,579 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "dgl/dgl.h"
+#include "platform/profiler.h"
+#include "console/consoleTypes.h"
+#include "core/bitStream.h"
+#include "math/mathIO.h"
+#include "math/mathUtils.h"
+#include "sceneGraph/sceneGraph.h"
+#include "sceneGraph/sceneState.h"
+#include "sim/netConnection.h"
+#include "sim/decalManager.h"
+#include "terrain/waterBlock.h"
+#include "ts/tsShapeInstance.h"
+#include "game/gameConnection.h"
+#include "game/shapeBase.h"
+#include "game/projectile.h"
+#include "game/fx/explosion.h"
+#include "game/projectileBatch.h"
+
+IMPLEMENT_CONOBJECT(ProjectileBatch);
+
+ProjectileBatch* ProjectileBatch::smServerBatch = NULL;
+ProjectileBatch* ProjectileBatch::smClientBatch = NULL;
+
+
+//--------------------------------------------------------------------------
+/// Starts a batched projectile on the client.
+class ProjectileSpawnEvent : public NetEvent
+{
+   typedef NetEvent Parent;
+
+  public:
+   ProjectileData*         mData;
+   Point3F                 mPosition;
+   Point3F                 mVelocity;
+   SimObjectPtr<NetObject> mSource;    ///< The source on the server, its ghost on the client.
+
+   ProjectileSpawnEvent();
+
+   void pack(NetConnection*, BitStream*);
+   void write(NetConnection*, BitStream*);
+   void unpack(NetConnection*, BitStream*);
+   void process(NetConnection*);
+
+   DECLARE_CONOBJECT(ProjectileSpawnEvent);
+};
+IMPLEMENT_CO_CLIENTEVENT_V1(ProjectileSpawnEvent);
+
+ProjectileSpawnEvent::ProjectileSpawnEvent()
+{
+   // a late projectile is worse than a missing one
+   mGuaranteeType = Unguaranteed;
+   mData = NULL;
+   mPosition.set(0, 0, 0);
+   mVelocity.set(0, 0, 0);
+}
+
+void ProjectileSpawnEvent::pack(NetConnection* con, BitStream* stream)
+{
+   stream->writeRangedU32(mData->getId(), DataBlockObjectIdFirst, DataBlockObjectIdLast);
+   mathWrite(*stream, mPosition);
+   mathWrite(*stream, mVelocity);
+
+   S32 ghostIndex = bool(mSource) ? con->getGhostIndex(mSource) : -1;
+   if (stream->writeFlag(ghostIndex != -1))
+      con->packGhostIndex(stream, ghostIndex);
+}
+
+void ProjectileSpawnEvent::write(NetConnection* con, BitStream* stream)
+{
+   pack(con, stream);
+}
+
+void ProjectileSpawnEvent::unpack(NetConnection* con, BitStream* stream)
+{
+   SimObjectId id = stream->readRangedU32(DataBlockObjectIdFirst, DataBlockObjectIdLast);
+   mData = dynamic_cast<ProjectileData*>(Sim::findObject(id));
+   mathRead(*stream, &mPosition);
+   mathRead(*stream, &mVelocity);
+
+   if (stream->readFlag())
+      mSource = con->resolveGhost(con->unpackGhostIndex(stream));
+}
+
+void ProjectileSpawnEvent::process(NetConnection*)
+{
+   if (!mData)
+      return;
+
+   ProjectileBatch* batch = ProjectileBatch::getBatch(false);
+   if (batch)
+      batch->addProjectile(mData, mPosition, mVelocity, bool(mSource) ? mSource->getId() : 0);
+}
+
+
+//--------------------------------------------------------------------------
+ProjectileBatch::ProjectileBatch()
+{
+   mTypeMask |= ProjectileObjectType;
+   mServer = true;
+   mRenderDelta = 0;
+}
+
+ProjectileBatch::~ProjectileBatch()
+{
+}
+
+ProjectileBatch* ProjectileBatch::getBatch(bool server)
+{
+   ProjectileBatch*& batch = server ? smServerBatch : smClientBatch;
+   if (batch)
+      return batch;
+
+   ProjectileBatch* newBatch = new ProjectileBatch;
+   newBatch->mServer = server;
+   if (!newBatch->registerObject())
+   {
+      Con::errorf(ConsoleLogEntry::General, "ProjectileBatch::getBatch: couldn't register the batch");
+      delete newBatch;
+      return NULL;
+   }
+   batch = newBatch;
+   return batch;
+}
+
+bool ProjectileBatch::onAdd()
+{
+   if (!Parent::onAdd())
+      return false;
+
+   // the projectiles can be anywhere; the server's copy doesn't render
+   // and only uses the container for its rays
+   setGlobalBounds();
+   resetWorldBox();
+   if (!mServer)
+   {
+      gClientContainer.addObject(this);
+      gClientSceneGraph->addObjectToScene(this);
+   }
+   return true;
+}
+
+void ProjectileBatch::onRemove()
+{
+   removeFromScene();
+
+   for (U32 i = 0; i < mKinds.size(); i++)
+      delete mKinds[i].shape;
+   mKinds.clear();
+
+   if (smServerBatch == this)
+      smServerBatch = NULL;
+   if (smClientBatch == this)
+      smClientBatch = NULL;
+
+   Parent::onRemove();
+}
+
+void ProjectileBatch::onDeleteNotify(SimObject *object)
+{
+   for (U32 k = 0; k < mKinds.size(); k++)
+   {
+      if (mKinds[k].data != object)
+         continue;
+
+      for (S32 i = mPosition.size() - 1; i >= 0; i--)
+         if (mKind[i] == k)
+            removeProjectile(i);
+
+      delete mKinds[k].shape;
+      mKinds[k].shape = NULL;
+      mKinds[k].data = NULL;
+   }
+
+   Parent::onDeleteNotify(object);
+}
+
+
+//--------------------------------------------------------------------------
+U32 ProjectileBatch::getKind(ProjectileData* data)
+{
+   S32 freeKind = -1;
+   for (U32 k = 0; k < mKinds.size(); k++)
+   {
+      if (mKinds[k].data == data)
+         return k;
+      if (!mKinds[k].data && freeKind == -1)
+         freeKind = k;
+   }
+
+   if (freeKind == -1)
+   {
+      freeKind = mKinds.size();
+      mKinds.increment();
+   }
+
+   Kind &kind = mKinds[freeKind];
+   kind.data = data;
+   kind.shape = NULL;
+   if (!mServer && bool(data->projectileShape))
+   {
+      kind.shape = new TSShapeInstance(data->projectileShape, true);
+      kind.shape->animate();
+   }
+   deleteNotify(data);
+   return freeKind;
+}
+
+bool ProjectileBatch::addProjectile(ProjectileData* data, const Point3F &pos, const Point3F &vel, SimObjectId source)
+{
+   if (mPosition.size() >= MaxProjectiles)
+      return false;
+
+   mPosition.push_back(pos);
+   mLastPosition.push_back(pos);
+   mVelocity.push_back(vel);
+   mKind.push_back(getKind(data));
+   mTick.push_back(0);
+   mSource.push_back(source);
+   return true;
+}
+
+void ProjectileBatch::removeProjectile(U32 index)
+{
+   // the order doesn't matter, so the last one fills the hole
+   mPosition.erase_fast(index);
+   mLastPosition.erase_fast(index);
+   mVelocity.erase_fast(index);
+   mKind.erase_fast(index);
+   mTick.erase_fast(index);
+   mSource.erase_fast(index);
+}
+
+F32 ProjectileBatch::getFadeValue(U32 index, F32 delta)
+{
+   ProjectileData* data = mKinds[mKind[index]].data;
+
+   F32 time = F32(mTick[index]) - delta;
+   if (time > data->fadeDelay)
+      return 1.0 - ((time - data->fadeDelay) / F32(data->lifetime));
+   return 1.0;
+}
+
+bool ProjectileBatch::pointInWater(const Point3F &point)
+{
+   SimpleQueryList sql;
+   if (mServer)
+      gServerSceneGraph->getWaterObjectList(sql);
+   else
+      gClientSceneGraph->getWaterObjectList(sql);
+
+   for (U32 i = 0; i < sql.mList.size(); i++)
+   {
+      WaterBlock* pBlock = dynamic_cast<WaterBlock*>(sql.mList[i]);
+      if (pBlock && pBlock->isPointSubmergedSimple( point ))
+         return true;
+   }
+   return false;
+}
+
+
+//--------------------------------------------------------------------------
+void ProjectileBatch::tickBatch(bool server)
+{
+   ProjectileBatch* batch = server ? smServerBatch : smClientBatch;
+   if (batch && batch->mPosition.size())
+      batch->processTick();
+}
+
+void ProjectileBatch::interpolateBatch(F32 delta)
+{
+   if (smClientBatch)
+      smClientBatch->interpolateTick(delta);
+}
+
+void ProjectileBatch::processTick()
+{
+   PROFILE_START(ProjectileBatch_processTick);
+
+   const F32 tickSec = F32(TickMs) / 1000.0f;
+   const U32 mask = Projectile::csmDynamicCollisionMask | Projectile::csmStaticCollisionMask;
+   Container* container = mServer ? &gServerContainer : &gClientContainer;
+
+   for (S32 i = mPosition.size() - 1; i >= 0; i--)
+   {
+      ProjectileData* data = mKinds[mKind[i]].data;
+      if (++mTick[i] >= data->lifetime)
+      {
+         removeProjectile(i);
+         continue;
+      }
+      if (mSource[i] && mTick[i] > Projectile::SourceIdTimeoutTicks)
+         mSource[i] = 0;
+   }
+
+   U32 count = mPosition.size();
+   mRays.setSize(count);
+   mHits.setSize(count);
+   for (U32 i = 0; i < count; i++)
+   {
+      ProjectileData* data = mKinds[mKind[i]].data;
+      if (data->isBallistic)
+         mVelocity[i].z -= 9.81 * data->gravityMod * tickSec;
+
+      mLastPosition[i] = mPosition[i];
+      mRays[i].start = mPosition[i];
+      mRays[i].end = mPosition[i] + mVelocity[i] * tickSec;
+   }
+   container->castRays(mRays.address(), count, mask, mHits.address());
+
+   // Backwards, so the ones that explode can be removed as we go.
+   mImpacts.clear();
+   for (S32 i = count - 1; i >= 0; i--)
+   {
+      RayInfo &hit = mHits[i];
+
+      // A ray that only hit its own source is cast again without it,
+      // same as Projectile does with the source's collision disabled.
+      if (hit.object && mSource[i] && hit.object->getId() == mSource[i])
+      {
+         SceneObject* source = hit.object;
+         source->disableCollision();
+         if (!container->castRay(mRays[i].start, mRays[i].end, mask, &hit))
+            hit.object = NULL;
+         source->enableCollision();
+      }
+
+      if (!hit.object)
+      {
+         mPosition[i] = mRays[i].end;
+         continue;
+      }
+
+      ProjectileData* data = mKinds[mKind[i]].data;
+      if (mTick[i] > data->armingDelay)
+      {
+         mImpacts.increment();
+         Impact &impact = mImpacts.last();
+         impact.data = data;
+         impact.point = hit.point;
+         impact.normal = hit.normal;
+         impact.object = hit.object->getId();
+         impact.objectType = hit.object->getType();
+         impact.source = mSource[i];
+         removeProjectile(i);
+      }
+      else if (data->isBallistic)
+      {
+         // bounce, off the surface with friction and elasticity
+         Point3F bounceVel = mVelocity[i] - hit.normal * (mDot(mVelocity[i], hit.normal) * 2.0);
+         Point3F tangent = bounceVel - hit.normal * mDot(bounceVel, hit.normal);
+         mVelocity[i] = (bounceVel - tangent * data->bounceFriction) * data->bounceElasticity;
+         mPosition[i] = hit.point + hit.normal * 0.05;
+      }
+      else
+         mPosition[i] = mRays[i].end;
+   }
+
+   for (U32 i = 0; i < mImpacts.size(); i++)
+      explode(mImpacts[i]);
+
+   PROFILE_END();
+}
+
+void ProjectileBatch::interpolateTick(F32 delta)
+{
+   mRenderDelta = delta;
+}
+
+void ProjectileBatch::explode(const Impact &impact)
+{
+   ProjectileData* data = impact.data;
+   Point3F p = impact.point;
+   Point3F n = impact.normal;
+
+   if (mServer)
+   {
+      char *sourceArg = Con::getArgBuffer(32);
+      char *posArg = Con::getArgBuffer(64);
+      char *normalArg = Con::getArgBuffer(64);
+
+      dSprintf(sourceArg, 32, "%d", impact.source);
+      dSprintf(posArg, 64, "%g %g %g", p.x, p.y, p.z);
+      dSprintf(normalArg, 64, "%g %g %g", n.x, n.y, n.z);
+
+      if (Sim::findObject(impact.object))
+         Con::executef(data, 6, "onCollision",
+            sourceArg,
+            Con::getIntArg(impact.object),
+            Con::getFloatArg(1.0),
+            posArg,
+            normalArg);
+
+      Point3F explosionPos = p + (n*0.01);
+      char buffer[128];
+      dSprintf(buffer, sizeof(buffer), "%g %g %g", explosionPos.x, explosionPos.y, explosionPos.z);
+      Con::executef(data, 4, "onExplode", sourceArg, buffer, Con::getFloatArg(1.0));
+      return;
+   }
+
+   Explosion* pExplosion = NULL;
+   if (data->waterExplosion && pointInWater(p))
+   {
+      pExplosion = new Explosion;
+      pExplosion->onNewDataBlock(data->waterExplosion);
+   }
+   else if (data->explosion)
+   {
+      pExplosion = new Explosion;
+      pExplosion->onNewDataBlock(data->explosion);
+   }
+
+   if (pExplosion)
+   {
+      MatrixF xform(true);
+      xform.setPosition(p);
+      pExplosion->setTransform(xform);
+      pExplosion->setInitialState(p, n);
+      pExplosion->setCollideType(impact.objectType);
+      if (pExplosion->registerObject() == false)
+      {
+         Con::errorf(ConsoleLogEntry::General, "ProjectileBatch(%s)::explode: couldn't register explosion",
+                     data->getName() );
+         delete pExplosion;
+      }
+   }
+
+   if (data->decalCount > 0 && (impact.objectType & (TerrainObjectType | InteriorObjectType)))
+   {
+      // randomly choose a decal between 0 and (decal count - 1)
+      U32 idx = (U32)(mCeil(data->decalCount * Platform::getRandom()) - 1.0f);
+      DecalManager *decalMngr = gClientSceneGraph->getCurrentDecalManager();
+      if (data->decals[idx] != NULL && decalMngr)
+         decalMngr->addDecal(p, n, data->decals[idx]);
+   }
+}
+
+
+//--------------------------------------------------------------------------
+bool ProjectileBatch::fire(ProjectileData* data, const Point3F &pos, const Point3F &vel, SceneObject* source)
+{
+   ProjectileBatch* batch = getBatch(true);
+   if (!batch || !batch->addProjectile(data, pos, vel, source ? source->getId() : 0))
+      return false;
+
+   // Clients that can't see any of the flight never hear of it.
+   F32 range = gServerSceneGraph->getVisibleDistance() +
+               vel.len() * data->lifetime * (F32(TickMs) / 1000.0f);
+
+   SimGroup* g = Sim::getClientGroup();
+   for (SimGroup::iterator itr = g->begin(); itr != g->end(); itr++)
+   {
+      GameConnection* con = dynamic_cast<GameConnection*>(*itr);
+      ShapeBase* camera = con ? con->getCameraObject() : NULL;
+      if (!camera || (camera->getPosition() - pos).lenSquared() > range * range)
+         continue;
+
+      ProjectileSpawnEvent* event = new ProjectileSpawnEvent;
+      event->mData = data;
+      event->mPosition = pos;
+      event->mVelocity = vel;
+      event->mSource = source;
+      con->postNetEvent(event);
+   }
+   return true;
+}
+
+
+//--------------------------------------------------------------------------
+bool ProjectileBatch::prepRenderImage(SceneState* state, const U32 stateKey,
+                                      const U32 /*startZone*/, const bool /*modifyBaseState*/)
+{
+   if (isLastState(state, stateKey))
+      return false;
+   setLastState(state, stateKey);
+
+   if (mPosition.size() == 0)
+      return false;
+
+   // One image for the lot, drawn after the sorted translucent ones.
+   SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
+   image->obj = this;
+   image->isTranslucent = true;
+   image->sortType = SceneRenderImage::EndSort;
+   state->insertRenderImage(image);
+
+   return false;
+}
+
+void ProjectileBatch::renderObject(SceneState* state, SceneRenderImage*)
+{
+   AssertFatal(dglIsInCanonicalState(), "Error, GL not in canonical state on entry");
+
+   PROFILE_START(ProjectileBatch_renderObject);
+
+   RectI viewport;
+   glMatrixMode(GL_PROJECTION);
+   glPushMatrix();
+   dglGetViewport(&viewport);
+   state->setupBaseProjection();
+
+   glMatrixMode(GL_MODELVIEW);
+   for (U32 i = 0; i < mPosition.size(); i++)
+   {
+      Kind &kind = mKinds[mKind[i]];
+      F32 fade = getFadeValue(i, mRenderDelta);
+      if (!kind.shape || fade <= (1.0/255.0))
+         continue;
+
+      ProjectileData* data = kind.data;
+      Point3F pos = mPosition[i] + (mLastPosition[i] - mPosition[i]) * mRenderDelta;
+
+      glPushMatrix();
+      if (data->faceViewer)
+      {
+         Point3F targetVector = state->getCameraPosition() - pos;
+         targetVector.normalize();
+
+         MatrixF explOrient = MathUtils::createOrientFromDir( targetVector );
+         explOrient.setPosition( pos );
+         dglMultMatrix( &explOrient );
+      }
+      else
+         glTranslatef(pos.x, pos.y, pos.z);
+      glScalef( data->scale.x, data->scale.y, data->scale.z );
+
+      Point3F cameraOffset = pos - state->getCameraPosition();
+      F32 fogAmount = state->getHazeAndFog(cameraOffset.len(), cameraOffset.z);
+
+      // the instance is shared, so the alpha is set for every projectile
+      kind.shape->selectCurrentDetail();
+      if (fade == 1.0)
+      {
+         kind.shape->setupFog(fogAmount, state->getFogColor());
+         kind.shape->setAlphaAlways(1.0);
+      }
+      else
+      {
+         kind.shape->setupFog(0.0, state->getFogColor());
+         kind.shape->setAlphaAlways(fade * (1.0 - fogAmount));
+      }
+      kind.shape->render();
+      glPopMatrix();
+   }
+
+   glDisable(GL_BLEND);
+   glDisable(GL_TEXTURE_2D);
+   glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+
+   glMatrixMode(GL_PROJECTION);
+   glPopMatrix();
+   glMatrixMode(GL_MODELVIEW);
+   dglSetViewport(viewport);
+
+   PROFILE_END();
+
+   AssertFatal(dglIsInCanonicalState(), "Error, GL not in canonical state on exit");
+}
+
+
+//--------------------------------------------------------------------------
+ConsoleMethod(ProjectileData, fireBatched, bool, 4, 5, "(Point3F pos, Point3F vel, SceneObject source=0)"
+              "Fires a batched projectile of this datablock on the server.")
+{
+   Point3F pos(0, 0, 0);
+   Point3F vel(0, 0, 0);
+   dSscanf(argv[2], "%g %g %g", &pos.x, &pos.y, &pos.z);
+   dSscanf(argv[3], "%g %g %g", &vel.x, &vel.y, &vel.z);
+
+   SceneObject* source = NULL;
+   if (argc == 5)
+      Sim::findObject(argv[4], source);
+
+   return ProjectileBatch::fire(object, pos, vel, source);
+}
@@ -0,0 +1,137 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _PROJECTILEBATCH_H_
+#define _PROJECTILEBATCH_H_
+
+#ifndef _SCENEOBJECT_H_
+#include "sim/sceneObject.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+
+class ProjectileData;
+class TSShapeInstance;
+class NetConnection;
+
+/// Lightweight projectiles, advanced together instead of as one
+/// Projectile object each.
+///
+/// ProjectileData::fireBatched() adds a projectile to the server's batch
+/// and sends its datablock, position and velocity to every client whose
+/// camera is close enough to see it, as an unguaranteed
+/// ProjectileSpawnEvent.  Each client adds it to its own batch and
+/// simulates it from there with the same code as the server, so there is
+/// no ghost and no per projectile update traffic.  The client's copy
+/// starts when the event arrives and only plays the explosion; the
+/// server's copy is the one that calls onCollision() and onExplode().
+///
+/// The batch keeps its projectiles in parallel arrays and casts the
+/// tick's rays in one Container::castRays() call.  It follows the same
+/// rules as Projectile: gravity for isBallistic, bounces before
+/// armingDelay, the source object is ignored for the first
+/// Projectile::SourceIdTimeoutTicks, and the projectile goes away at
+/// lifetime.  Since there's no projectile object, scripts get the source
+/// object id, or 0, instead of the projectile in onCollision() and
+/// onExplode().  Batched projectiles render their shape and play their
+/// explosion and decals; they have no particle emitters, lights or
+/// sounds.
+///
+/// There is one batch for the server and one for the client, created by
+/// the first projectile.  ProcessList ticks them after its objects.
+class ProjectileBatch : public SceneObject
+{
+   typedef SceneObject Parent;
+
+   /// A datablock in use by the batch.
+   struct Kind
+   {
+      ProjectileData*  data;
+      TSShapeInstance* shape;    ///< Client only, shared by the kind's projectiles.
+   };
+   Vector<Kind> mKinds;
+
+   /// @name Projectiles
+   /// One entry per projectile in each, in no particular order.
+   /// @{
+   Vector<Point3F>     mPosition;
+   Vector<Point3F>     mLastPosition;   ///< Position at the previous tick, for interpolation.
+   Vector<Point3F>     mVelocity;
+   Vector<U16>         mKind;
+   Vector<U16>         mTick;           ///< Ticks since the projectile was fired.
+   Vector<SimObjectId> mSource;         ///< 0 once it times out.
+   /// @}
+
+   /// An armed hit, exploded once every projectile has moved, since
+   /// the scripts may delete the objects the other rays hit.
+   struct Impact
+   {
+      ProjectileData* data;
+      Point3F         point;
+      Point3F         normal;
+      SimObjectId     object;
+      U32             objectType;
+      SimObjectId     source;
+   };
+
+   /// @name Tick Scratch
+   /// @{
+   Vector<RayQuery> mRays;
+   Vector<RayInfo>  mHits;
+   Vector<Impact>   mImpacts;
+   /// @}
+
+   bool mServer;
+   F32  mRenderDelta;                   ///< Back delta of the last interpolateTick().
+
+   static ProjectileBatch* smServerBatch;
+   static ProjectileBatch* smClientBatch;
+
+   U32  getKind(ProjectileData* data);
+   void removeProjectile(U32 index);
+   F32  getFadeValue(U32 index, F32 delta);
+   bool pointInWater(const Point3F &point);
+
+   void processTick();
+   void interpolateTick(F32 delta);
+   void explode(const Impact &impact);
+
+  protected:
+   bool onAdd();
+   void onRemove();
+   void onDeleteNotify(SimObject *object);
+
+   bool prepRenderImage(SceneState *state, const U32 stateKey, const U32 startZone, const bool modifyBaseZoneState = false);
+   void renderObject(SceneState *state, SceneRenderImage *image);
+
+  public:
+   enum Constants {
+      MaxProjectiles = 4096
+   };
+
+   ProjectileBatch();
+   ~ProjectileBatch();
+
+   /// The server's or the client's batch, created if need be.
+   static ProjectileBatch* getBatch(bool server);
+
+   /// Adds a projectile, returns false if the batch is full.
+   bool addProjectile(ProjectileData* data, const Point3F &pos, const Point3F &vel, SimObjectId source);
+   U32  getNumProjectiles() { return mPosition.size(); }
+
+   /// Fires a projectile on the server and tells the clients that can see it.
+   static bool fire(ProjectileData* data, const Point3F &pos, const Point3F &vel, SceneObject* source);
+
+   /// @name Process List Hooks
+   /// @{
+   static void tickBatch(bool server);
+   static void interpolateBatch(F32 delta);
+   /// @}
+
+   DECLARE_CONOBJECT(ProjectileBatch);
+};
+
+#endif
@@ -478,6 +478,7 @@ RigidShape::RigidShape()
 
    mDisableMove = false; // start frozen by default
    restCount = 0;
+   mDeferredImpact.set(0,0,0);
 
    inLiquid = false;
    waterWakeHandle = 0;
@@ -620,6 +621,10 @@ void RigidShape::onRemove()
 
 void RigidShape::processTick(const Move* move)
 {     
+   // Only stays set if we get as far as the physics
+   bool deferPhysics = mDeferTickPhysics;
+   mDeferTickPhysics = false;
+
    Parent::processTick(move);
 
    // Warp to catch up to server
@@ -662,22 +667,97 @@ void RigidShape::processTick(const Move* move)
       mDelta.posVec = mRigid.linPosition;
       mDelta.rot[0] = mRigid.angPosition;
 
-      // Update the physics based on the integration rate
-      S32 count = mDataBlock->integration;
+      // Update the physics based on the integration rate.  The
+      // process list may want to run the steps itself, later.
       updateWorkingCollisionSet(getCollisionMask());
-      for (U32 i = 0; i < count; i++)
-         updatePos(TickSec / count);
-
-      // Wrap up interpolation info
-      mDelta.pos     = mRigid.linPosition;
-      mDelta.posVec -= mRigid.linPosition;
-      mDelta.rot[1]  = mRigid.angPosition;
-
-      // Update container database
-      setPosition(mRigid.linPosition, mRigid.angPosition);
-      setMaskBits(PositionMask);
-      updateContainer();
+      if (deferPhysics) 
+      {
+         mDeferTickPhysics = true;
+         return;
+      }
+      tickPhysics();
+      updateTickPosition();
+   }
+}
+
+void RigidShape::updateTickPosition()
+{
+   // Wrap up interpolation info
+   mDelta.pos     = mRigid.linPosition;
+   mDelta.posVec -= mRigid.linPosition;
+   mDelta.rot[1]  = mRigid.angPosition;
+
+   // Update container database
+   setPosition(mRigid.linPosition, mRigid.angPosition);
+   setMaskBits(PositionMask);
+   updateContainer();
+
+   if (isServerObject())
+      updateSleep(mRigid.atRest);
+}
+
+
+//----------------------------------------------------------------------------
+
+bool RigidShape::canDeferTickPhysics()
+{
+   // Mounted objects tick after us and need our new position, and a
+   // client's moves are applied one at a time.
+   return isServerObject() && !getControllingClient() &&
+      !getMountList() && !isMounted();
+}
+
+void RigidShape::getTickPhysicsContacts(Vector<SceneObject*> &contacts)
+{
+   // Terrain, interiors and static shapes don't move, and the convex
+   // state lists they share are locked.
+   CollisionWorkingList& wl = mConvex.getWorkingList();
+   for (CollisionWorkingList* itr = wl.wLink.mNext; itr != &wl; itr = itr->wLink.mNext) 
+   {
+      SceneObject* obj = itr->mConvex->getObject();
+      if (!(obj->getTypeMask() & Container::csmStaticCollisionMask))
+         contacts.push_back(obj);
+   }
+}
+
+void RigidShape::tickPhysics()
+{
+   S32 count = mDataBlock->integration;
+   for (U32 i = 0; i < count; i++)
+      updatePos(TickSec / count);
+}
+
+void RigidShape::finishTickPhysics()
+{
+   // The script side of the steps, once per tick rather than once per
+   // step.  Triggers go first as they may queue collisions.
+   for (S32 i = 0; i < mDeferredCollisions.size(); i++) 
+   {
+      ShapeBase* obj = dynamic_cast<ShapeBase*>(Sim::findObject(mDeferredCollisions[i].object));
+      if (obj)
+         queueCollision(obj, mDeferredCollisions[i].vector);
    }
+   mDeferredCollisions.clear();
+
+   checkTriggers();
+   notifyCollision();
+
+   if (mDeferredImpact.len() > mDataBlock->minImpactSpeed)
+      onImpact(mDeferredImpact);
+   mDeferredImpact.set(0,0,0);
+
+   if (!inLiquid && mWaterCoverage != 0.0f) 
+   {
+      Con::executef(mDataBlock,4,"onEnterLiquid",scriptThis(), Con::getFloatArg(mWaterCoverage), Con::getIntArg(mLiquidType));
+      inLiquid = true;
+   }
+   else if (inLiquid && mWaterCoverage == 0.0f) 
+   {
+      Con::executef(mDataBlock,3,"onLeaveLiquid",scriptThis(), Con::getIntArg(mLiquidType));
+      inLiquid = false;
+   }
+
+   updateTickPosition();
 }
 
 void RigidShape::interpolateTick(F32 dt)
@@ -854,6 +934,7 @@ void RigidShape::applyImpulse(const Point3F &pos, const Point3F &impulse)
    Point3F r;
    mRigid.getOriginVector(pos,&r);
    mRigid.applyImpulse(r, impulse);
+   wakeUp();
 }
 
 
@@ -888,6 +969,14 @@ void RigidShape::setTransform(const MatrixF& newMat)
    Parent::setTransform(newMat);
    mRigid.atRest = false;
    mContacts.count = 0;
+   wakeUp();
+}
+
+void RigidShape::onWake()
+{
+   // Whatever we were resting on may have moved
+   mRigid.atRest = false;
+   restCount = 0;
 }
 
 
@@ -944,7 +1033,17 @@ void RigidShape::updatePos(F32 dt)
       mRigid.integrate(dt);
 
    // Deal with client and server scripting, sounds, etc.
-   if (isServerObject()) 
+   if (mDeferTickPhysics) 
+   {
+      // Keep the biggest impact for finishTickPhysics()
+      if (collided) 
+      {
+         VectorF collVec = mRigid.linVelocity - origVelocity;
+         if (collVec.lenSquared() > mDeferredImpact.lenSquared())
+            mDeferredImpact = collVec;
+      }
+   }
+   else if (isServerObject()) 
    {
 
       // Check triggers and other objects that we normally don't
@@ -1122,7 +1221,7 @@ bool RigidShape::resolveCollision(Rigid&  ns,CollisionList& cList)
                if (!isGhost() && c.object->getTypeMask() & ShapeBaseObjectType) 
                {
                   ShapeBase* col = static_cast<ShapeBase*>(c.object);
-                  queueCollision(col,v - col->getVelocity());
+                  queuePhysicsCollision(col,v - col->getVelocity());
                }
             }
          }
@@ -1247,6 +1346,16 @@ void RigidShape::updateWorkingCollisionSet(const U32 mask)
    convexBox.min -= Point3F(l, l, l);
    convexBox.max += Point3F(l, l, l);
 
+   // Wake anything asleep in our path
+   if (isServerObject() && !mRigid.atRest)
+   {
+      F32 step = mRigid.linVelocity.len() * TickSec;
+      Box3F wakeBox = getWorldBox();
+      wakeBox.min -= Point3F(step, step, step);
+      wakeBox.max += Point3F(step, step, step);
+      wakeTouching(wakeBox);
+   }
+
    disableCollision();
    mConvex.updateWorkingList(convexBox, mask);
    enableCollision();
@@ -1265,6 +1374,19 @@ void RigidShape::checkTriggers()
    gServerContainer.findObjects(bbox,sTriggerMask,findCallback,this);
 }
 
+void RigidShape::queuePhysicsCollision(ShapeBase* obj, const VectorF& vec)
+{
+   // The collision timeouts come from a shared free list
+   if (mDeferTickPhysics) 
+   {
+      mDeferredCollisions.increment();
+      mDeferredCollisions.last().object = obj->getId();
+      mDeferredCollisions.last().vector = vec;
+   }
+   else
+      queueCollision(obj,vec);
+}
+
 /** The callback used in by the checkTriggers() method.
 The checkTriggers method uses a container search which will
 invoke this callback on each obj that matches.
@@ -190,6 +190,17 @@ class RigidShape: public ShapeBase
    ShapeBaseConvex mConvex;
    int restCount;
 
+   /// @name Deferred physics
+   /// What a step run on a worker holds back for finishTickPhysics().
+   /// @{
+   struct DeferredCollision {
+      SimObjectId object;
+      VectorF vector;
+   };
+   Vector<DeferredCollision> mDeferredCollisions;
+   VectorF mDeferredImpact;         ///< Largest impact during the step
+   /// @}
+
    ParticleEmitter *mDustEmitterList[RigidShapeData::VC_NUM_DUST_EMITTERS];
    ParticleEmitter *mSplashEmitterList[RigidShapeData::VC_NUM_SPLASH_EMITTERS];
 
@@ -204,9 +215,15 @@ class RigidShape: public ShapeBase
    void checkTriggers();
    static void findCallback(SceneObject* obj,void * key);
 
+   /// queueCollision() that waits for finishTickPhysics() in a deferred step.
+   void queuePhysicsCollision(ShapeBase* obj, const VectorF& vec);
+   /// Copies the integrated rigid state into the interpolation data and transform.
+   void updateTickPosition();
+
    void setPosition(const Point3F& pos,const QuatF& rot);
    void setRenderPosition(const Point3F& pos,const QuatF& rot);
    void setTransform(const MatrixF& mat);
+   void onWake();
 
 //   virtual bool collideBody(const MatrixF& mat,Collision* info) = 0;
    void updateMove(const Move* move);
@@ -238,6 +255,17 @@ public:
    void processTick(const Move *move);
    bool onAdd();
    void onRemove();
+
+   /// @name Deferred physics
+   /// Server shapes with nothing mounted can have their physics steps
+   /// run on the thread pool.
+   /// @see GameBase::canDeferTickPhysics
+   /// @{
+   bool canDeferTickPhysics();
+   void getTickPhysicsContacts(Vector<SceneObject*> &contacts);
+   void tickPhysics();
+   void finishTickPhysics();
+   /// @}
    
    /// Interpolates between move ticks @see processTick
    /// @param   dt   Change in time between the last call and this call to the function
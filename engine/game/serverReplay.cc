@@ -0,0 +1,360 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "game/serverReplay.h"
+#include "platform/gameInterface.h"
+#include "platform/profiler.h"
+#include "core/fileStream.h"
+#include "console/console.h"
+#include "console/consoleTypes.h"
+#include "math/mRandom.h"
+#include "sim/netConnection.h"
+#include "sim/netInterface.h"
+
+ServerReplay::Mode   ServerReplay::smMode = ServerReplay::Off;
+FileStream          *ServerReplay::smStream = NULL;
+char                 ServerReplay::smFileName[256];
+U64                  ServerReplay::smFrameStartUs = 0;
+U64                  ServerReplay::smReplayStartUs = 0;
+U32                  ServerReplay::smSimTime = 0;
+S32                  ServerReplay::smDivergedFrame = -1;
+Vector<ServerReplay::Frame> ServerReplay::smFrames;
+bool                 ServerReplay::smProfile = false;
+
+static const U32 csReplayFileMagic = 0x4c505253;    // "SRPL"
+
+static S32 QSORT_CALLBACK cmpReplayFrame(const void *a, const void *b)
+{
+   // Slowest first.
+   U32 ta = *(const U32 *) a;
+   U32 tb = *(const U32 *) b;
+   return (ta > tb) ? -1 : ((ta < tb) ? 1 : 0);
+}
+
+//-----------------------------------------------------------------------------
+
+void ServerReplay::consoleInit()
+{
+   Con::addVariable("$serverReplay::profile", TypeBool, &smProfile);
+}
+
+void ServerReplay::applySeed(U32 seed)
+{
+   MRandomLCG::setGlobalRandSeed(seed);
+   GNet->seedRandomData(seed);
+}
+
+bool ServerReplay::startRecording(const char *fileName)
+{
+   stop();
+
+   smStream = new FileStream;
+   if(!smStream->open(fileName, FileStream::Write))
+   {
+      Con::errorf("Server recording: unable to write %s.", fileName);
+      delete smStream;
+      smStream = NULL;
+      return false;
+   }
+
+   dStrncpy(smFileName, fileName, sizeof(smFileName) - 1);
+   smFileName[sizeof(smFileName) - 1] = '\0';
+
+   U32 seed = Platform::getRealMilliseconds();
+   smStream->write(csReplayFileMagic);
+   smStream->write(U32(FileVersion));
+   smStream->write(seed);
+   applySeed(seed);
+
+   smMode = Recording;
+   Con::printf("Server recording to %s.", smFileName);
+   return true;
+}
+
+bool ServerReplay::startReplay(const char *fileName)
+{
+   stop();
+
+   smStream = new FileStream;
+   U32 magic, version, seed;
+   if(!smStream->open(fileName, FileStream::Read) ||
+      !smStream->read(&magic) || !smStream->read(&version) || !smStream->read(&seed) ||
+      magic != csReplayFileMagic || version != FileVersion)
+   {
+      Con::errorf("Server replay: %s isn't a server recording.", fileName);
+      delete smStream;
+      smStream = NULL;
+      return false;
+   }
+
+   dStrncpy(smFileName, fileName, sizeof(smFileName) - 1);
+   smFileName[sizeof(smFileName) - 1] = '\0';
+   applySeed(seed);
+
+   smFrames.clear();
+   smSimTime = 0;
+   smDivergedFrame = -1;
+   smReplayStartUs = Platform::getRealMicroseconds();
+   smMode = Replaying;
+   Game->setNetReplay(true);
+
+#ifdef TORQUE_ENABLE_PROFILER
+   if(smProfile)
+      gProfiler->enable(true);
+#endif
+
+   Con::printf("Server replay of %s started.", smFileName);
+   return true;
+}
+
+void ServerReplay::stop()
+{
+   if(smMode == Off)
+      return;
+
+   if(smMode == Replaying)
+   {
+      Game->setNetReplay(false);
+      writeReport();
+
+#ifdef TORQUE_ENABLE_PROFILER
+      if(smProfile)
+      {
+         char profileFile[sizeof(smFileName) + 16];
+         dSprintf(profileFile, sizeof(profileFile), "%s.profile.txt", smFileName);
+         gProfiler->dumpToFile(profileFile);
+         gProfiler->enable(false);
+      }
+#endif
+   }
+   else
+      Con::printf("Server recording %s closed.", smFileName);
+
+   smMode = Off;
+   smStream->close();
+   delete smStream;
+   smStream = NULL;
+   smFrames.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+void ServerReplay::recordPacket(const PacketReceiveEvent *event)
+{
+   if(smMode != Recording)
+      return;
+
+   U16 size = event->size - PacketReceiveEventHeaderSize;
+   const NetAddress &address = event->sourceAddress;
+   smStream->write(U8(RecordPacket));
+   smStream->write(S32(address.type));
+   smStream->write(sizeof(address.netNum), address.netNum);
+   smStream->write(sizeof(address.nodeNum), address.nodeNum);
+   smStream->write(address.port);
+   smStream->write(size);
+   smStream->write(size, event->data);
+}
+
+void ServerReplay::recordConsole(const ConsoleEvent *event)
+{
+   if(smMode != Recording)
+      return;
+
+   U16 len = dStrlen(event->data);
+   smStream->write(U8(RecordConsole));
+   smStream->write(len);
+   smStream->write(len, event->data);
+}
+
+void ServerReplay::beginFrame(const TimeEvent *event)
+{
+   if(smMode == Off)
+      return;
+
+   if(smMode == Recording)
+   {
+      smStream->write(U8(RecordTime));
+      smStream->write(event->elapsedTime);
+   }
+   smSimTime += event->elapsedTime;
+   smFrameStartUs = Platform::getRealMicroseconds();
+}
+
+void ServerReplay::endFrame()
+{
+   if(smMode == Off)
+      return;
+
+   U32 frameUs = U32(Platform::getRealMicroseconds() - smFrameStartUs);
+   if(smMode == Recording)
+   {
+      smStream->write(U8(RecordCheck));
+      smStream->write(U32(gRandGen.getSeed()));
+      smStream->write(frameUs);
+      smStream->flush();
+      return;
+   }
+
+   // The recorded time and the check come with the next process().
+   smFrames.increment();
+   Frame &frame = smFrames.last();
+   frame.recordedUs = 0;
+   frame.replayUs = frameUs;
+   frame.simTime = smSimTime;
+}
+
+//-----------------------------------------------------------------------------
+
+void ServerReplay::process()
+{
+   if(smMode != Replaying)
+      return;
+
+   // Everything up to the next time event is posted ahead of it, so each
+   // frame sees just the packets it had when it was recorded.
+   for(;;)
+   {
+      U8 type;
+      if(!smStream->read(&type))
+      {
+         stop();
+         Platform::postQuitMessage(0);
+         return;
+      }
+
+      switch(type)
+      {
+         case RecordCheck:
+         {
+            U32 state, recordedUs;
+            smStream->read(&state);
+            smStream->read(&recordedUs);
+            if(smFrames.size())
+               smFrames.last().recordedUs = recordedUs;
+            if(smDivergedFrame == -1 && state != U32(gRandGen.getSeed()))
+            {
+               smDivergedFrame = smFrames.size() - 1;
+               Con::warnf("Server replay: diverged from the recording at frame %d, %d ms in.",
+                          smDivergedFrame, smSimTime);
+            }
+            continue;
+         }
+
+         case RecordPacket:
+         {
+            PacketReceiveEvent event;
+            S32 addressType;
+            U16 size;
+            smStream->read(&addressType);
+            event.sourceAddress.type = addressType;
+            smStream->read(sizeof(event.sourceAddress.netNum), event.sourceAddress.netNum);
+            smStream->read(sizeof(event.sourceAddress.nodeNum), event.sourceAddress.nodeNum);
+            smStream->read(&event.sourceAddress.port);
+            if(!smStream->read(&size) || size > MaxPacketDataSize)
+               break;
+            smStream->read(size, event.data);
+            event.size = PacketReceiveEventHeaderSize + size;
+            Game->postEvent(event);
+            continue;
+         }
+
+         case RecordConsole:
+         {
+            ConsoleEvent event;
+            U16 len;
+            if(!smStream->read(&len) || len >= MaxConsoleLineSize)
+               break;
+            smStream->read(len, event.data);
+            event.data[len] = '\0';
+            event.size = ConsoleEventHeaderSize + len + 1;
+            Game->postEvent(event);
+            continue;
+         }
+
+         case RecordTime:
+         {
+            TimeEvent event;
+            smStream->read(&event.elapsedTime);
+            Game->postEvent(event);
+            return;
+         }
+      }
+
+      // An unknown record or a size that can't be right.
+      Con::errorf("Server replay: %s is damaged.", smFileName);
+      stop();
+      Platform::postQuitMessage(0);
+      return;
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+void ServerReplay::writeReport()
+{
+   U32 frames = smFrames.size();
+   F64 seconds = (Platform::getRealMicroseconds() - smReplayStartUs) / 1000000.0;
+   F64 recordedSeconds = smSimTime / 1000.0;
+
+   F64 replayUs = 0, recordedUs = 0;
+   for(U32 i = 0; i < frames; i++)
+   {
+      replayUs   += smFrames[i].replayUs;
+      recordedUs += smFrames[i].recordedUs;
+   }
+
+   Con::printf("Server replay: %d frames, %.2f s recorded, replayed in %.2f s.",
+               frames, recordedSeconds, seconds);
+   if(!frames)
+      return;
+   Con::printf("   frame ms: replayed %.3f, recorded %.3f on average.",
+               replayUs / frames / 1000.0, recordedUs / frames / 1000.0);
+   if(smDivergedFrame != -1)
+      Con::warnf("   diverged at frame %d, timings after it don't match the recording.", smDivergedFrame);
+
+   // Slowest replayed frames; (replay us, index) pairs sort on the first.
+   Vector<U32> order;
+   order.setSize(frames * 2);
+   for(U32 i = 0; i < frames; i++)
+   {
+      order[i * 2]     = smFrames[i].replayUs;
+      order[i * 2 + 1] = i;
+   }
+   dQsort(order.address(), frames, sizeof(U32) * 2, cmpReplayFrame);
+
+   Con::printf("   slowest frames:");
+   for(U32 i = 0; i < getMin(frames, U32(SlowFrameCount)); i++)
+   {
+      const Frame &frame = smFrames[order[i * 2 + 1]];
+      Con::printf("      frame %6d at %8.2f s: replayed %.2f ms, recorded %.2f ms",
+                  order[i * 2 + 1], frame.simTime / 1000.0,
+                  frame.replayUs / 1000.0, frame.recordedUs / 1000.0);
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction(startServerRecording, bool, 2, 2, "(string fileName) - Record the packets, console "
+                "input and frame times the server gets, for startServerReplay().  Start it before "
+                "the server is created.")
+{
+   char fileName[256];
+   Con::expandScriptFilename(fileName, sizeof(fileName), argv[1]);
+   return ServerReplay::startRecording(fileName);
+}
+
+ConsoleFunction(startServerReplay, bool, 2, 2, "(string fileName) - Feed the server a recording "
+                "as fast as it will go, report the frame times and quit.  Start it before the "
+                "server is created.")
+{
+   char fileName[256];
+   Con::expandScriptFilename(fileName, sizeof(fileName), argv[1]);
+   return ServerReplay::startReplay(fileName);
+}
+
+ConsoleFunction(stopServerReplay, void, 1, 1, "() - Close the server recording, or end the replay.")
+{
+   ServerReplay::stop();
+}
@@ -0,0 +1,108 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _SERVERREPLAY_H_
+#define _SERVERREPLAY_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _EVENT_H_
+#include "platform/event.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+
+class FileStream;
+
+/// Records what a server is fed so a session can be replayed elsewhere.
+///
+/// Unlike the journal this only keeps what drives the server: the packets
+/// that arrive with their sources, lines typed into the console and the
+/// elapsed time of each frame, so it works on a dedicated server and the
+/// file doesn't depend on the window or the input devices.  The global
+/// random seed and the connect challenge data are seeded from the file
+/// header, so the replayed server makes the same choices.
+///
+/// A replay runs the recorded frames back to back with nothing sent to the
+/// network (GameInterface::isNetReplaying()), as fast as the box can go, and
+/// reports the slowest frames against how long they took when recorded.  The
+/// state of the random generator is checked after every frame, and the first
+/// frame where it differs is reported.  With $serverReplay::profile the
+/// profiler runs for the replay and is dumped next to the recording.
+///
+/// The server has to be started the same way both times, with the recording
+/// or replay started before it is created; a local client or the telnet
+/// console aren't recorded.
+class ServerReplay
+{
+   enum Constants {
+      FileVersion = 1,
+      SlowFrameCount = 10
+   };
+
+   enum RecordType {
+      RecordTime = 1,   ///< Elapsed ms, starts a frame.
+      RecordCheck,      ///< Random state and the frame's us, ends a frame.
+      RecordPacket,
+      RecordConsole
+   };
+
+   enum Mode {
+      Off,
+      Recording,
+      Replaying
+   };
+
+   struct Frame
+   {
+      U32 recordedUs;
+      U32 replayUs;
+      U32 simTime;      ///< Ms since the recording started.
+   };
+
+   static Mode          smMode;
+   static FileStream   *smStream;
+   static char          smFileName[256];
+   static U64           smFrameStartUs;
+   static U64           smReplayStartUs;
+   static U32           smSimTime;
+   static S32           smDivergedFrame;
+   static Vector<Frame> smFrames;
+
+   static void applySeed(U32 seed);
+   static void writeReport();
+
+  public:
+   static bool smProfile;      ///< $serverReplay::profile
+
+   static void consoleInit();
+
+   static bool isRecording() { return smMode == Recording; }
+   static bool isReplaying() { return smMode == Replaying; }
+
+   static bool startRecording(const char *fileName);
+   static bool startReplay(const char *fileName);
+   /// Closes the recording, or ends the replay with its report.
+   static void stop();
+
+   /// @name Recording
+   /// Called by DemoGame as the events are processed.
+   /// @{
+   static void recordPacket(const PacketReceiveEvent *event);
+   static void recordConsole(const ConsoleEvent *event);
+   /// @}
+
+   /// Around DemoGame::processTimeEvent(), recording or replaying.
+   static void beginFrame(const TimeEvent *event);
+   static void endFrame();
+
+   /// Replaying: post the next recorded frame's events, in place of
+   /// Net::process() and TimeManager::process().  Quits at the end.
+   static void process();
+};
+
+#endif
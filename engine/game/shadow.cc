@@ -12,6 +12,7 @@
 #include "interior/interiorInstance.h"
 #include "lightingSystem/sgLighting.h"
 #include "lightingSystem/sgObjectShadows.h"
+#include "console/consoleTypes.h"
 
 DepthSortList Shadow::smDepthSortList;
 TextureHandle* Shadow::smGenericShadowTexture = NULL;
@@ -26,6 +27,11 @@ F32 Shadow::smLightLenSkew = 0.0f;
 F32 Shadow::smGenericRadiusSkew = 0.4f; // shrink radius of shape when it always uses generic shadow...
 bool Shadow::smAlwaysUseGenericBmp = false;
 F32 Shadow::smGlobalShadowDetail = 1.0f;
+S32 Shadow::smBakesPerFrame = 8;
+S32 Shadow::smBakeCacheSize = 32;
+S32 Shadow::smBakeCacheKB = 1024;
+S32 Shadow::smBakesLastFrame = 0;
+Vector<Shadow::BakePart> Shadow::smBakeParts(__FILE__, __LINE__);
 
 Vector<U32> gShadowBits(__FILE__, __LINE__);
 Box3F gShadowBox;
@@ -96,6 +102,281 @@ Shadow::PixelSizeDetail sgShadowDetailGeneric[] =
    {     0.0f,   0,  0, 0, true }
 };
 
+//--------------------------------------------------------------
+// Shadow bitmap atlas and bake cache
+//--------------------------------------------------------------
+
+namespace
+{
+   enum
+   {
+      AtlasPageSize = 512,
+      BakeHashSize  = 256
+   };
+
+   /// An atlas texture cut into equal slots of one bitmap size.  The
+   /// texture manager keeps the bitmap, so a resurrected page comes back
+   /// with the shadows that were in it.
+   struct AtlasPage
+   {
+      S32 dim;
+      GBitmap *bitmap;
+      TextureHandle texture;
+      Vector<U16> freeSlots;
+   };
+
+   Vector<AtlasPage *> sgAtlasPages;
+   Vector<U8> sgBakeScratch;
+
+   bool allocAtlasSlot(S32 dim, AtlasPage **page, U16 *slot)
+   {
+      for(U32 i = 0; i < sgAtlasPages.size(); i++)
+      {
+         AtlasPage *p = sgAtlasPages[i];
+         if(p->dim == dim && !p->freeSlots.empty())
+         {
+            *page = p;
+            *slot = p->freeSlots.last();
+            p->freeSlots.decrement();
+            return true;
+         }
+      }
+
+      AtlasPage *p = new AtlasPage;
+      p->dim = dim;
+      p->bitmap = new GBitmap(AtlasPageSize, AtlasPageSize, false, GBitmap::Luminance);
+      dMemset(p->bitmap->getWritableBits(), 0, AtlasPageSize * AtlasPageSize);
+      p->texture.set(NULL, p->bitmap);
+      // bitmap now owned by texture manager, so we don't delete it
+      U32 perRow = AtlasPageSize / dim;
+      for(S32 s = perRow * perRow - 1; s >= 0; s--)
+         p->freeSlots.push_back(U16(s));
+      sgAtlasPages.push_back(p);
+
+      *page = p;
+      *slot = p->freeSlots.last();
+      p->freeSlots.decrement();
+      return true;
+   }
+
+   void freeAtlasSlot(AtlasPage *page, U16 slot)
+   {
+      page->freeSlots.push_back(slot);
+      U32 perRow = AtlasPageSize / page->dim;
+      if(page->freeSlots.size() < perRow * perRow)
+         return;
+
+      // empty, give the texture back
+      for(U32 i = 0; i < sgAtlasPages.size(); i++)
+         if(sgAtlasPages[i] == page)
+         {
+            sgAtlasPages.erase_fast(i);
+            break;
+         }
+      delete page;
+   }
+
+   inline void hashKey(U32 &hash, S32 value)
+   {
+      hash = (hash ^ U32(value)) * 16777619;
+   }
+
+   inline S32 quantize(F32 value, F32 invStep)
+   {
+      return S32(mFloor(value * invStep + 0.5f));
+   }
+}
+
+/// One rasterized shadow bitmap in an atlas slot, shared by every shadow
+/// whose shapes are in the same pose relative to the light.
+struct Shadow::Bake
+{
+   U32 key;
+   S32 dim;
+   S32 blur;
+   U32 refCount;
+   AtlasPage *page;
+   U16 slot;
+   Bake *hashNext;
+   Bake *lruPrev;    ///< Unused bakes, kept in case the pose comes back.
+   Bake *lruNext;
+};
+
+static Shadow::Bake *sgBakeHash[BakeHashSize];
+static Shadow::Bake sgBakeLRU = { 0, 0, 0, 0, NULL, 0, NULL, &sgBakeLRU, &sgBakeLRU };   // sentinel, most recently released first
+static S32 sgUnusedBakes = 0;
+static S32 sgUnusedBakeBytes = 0;
+static S32 sgBakesThisFrame = 0;
+static F32 sgBakeThreshold = 0.0f;
+static Vector<F32> sgBakeRequests(__FILE__, __LINE__);
+
+static S32 QSORT_CALLBACK cmpBakeRequest(const void *a, const void *b)
+{
+   F32 sa = *(const F32 *) a;
+   F32 sb = *(const F32 *) b;
+   return (sa > sb) ? -1 : ((sa < sb) ? 1 : 0);
+}
+
+static void unlinkUnusedBake(Shadow::Bake *bake)
+{
+   bake->lruPrev->lruNext = bake->lruNext;
+   bake->lruNext->lruPrev = bake->lruPrev;
+   bake->lruPrev = bake->lruNext = NULL;
+   sgUnusedBakes--;
+   sgUnusedBakeBytes -= bake->dim * bake->dim;
+}
+
+static void deleteBake(Shadow::Bake *bake)
+{
+   Shadow::Bake **walk = &sgBakeHash[bake->key & (BakeHashSize - 1)];
+   while(*walk != bake)
+      walk = &(*walk)->hashNext;
+   *walk = bake->hashNext;
+
+   if(bake->lruNext)
+      unlinkUnusedBake(bake);
+   freeAtlasSlot(bake->page, bake->slot);
+   delete bake;
+}
+
+static void flushUnusedBakes(S32 keep, S32 keepBytes)
+{
+   while(sgUnusedBakes > keep || (sgUnusedBakes && sgUnusedBakeBytes > keepBytes))
+      deleteBake(sgBakeLRU.lruPrev);
+}
+
+void Shadow::consoleInit()
+{
+   Con::addVariable("$pref::Shadows::bakesPerFrame", TypeS32, &smBakesPerFrame);
+   Con::addVariable("$pref::Shadows::bakeCacheSize", TypeS32, &smBakeCacheSize);
+   Con::addVariable("$pref::Shadows::bakeCacheKB", TypeS32, &smBakeCacheKB);
+   Con::addVariable("$Stats::shadowBakes", TypeS32, &smBakesLastFrame);
+}
+
+/// Decides whether a shadow whose pose isn't baked yet gets a bitmap drawn
+/// this frame.  The budget goes to the largest shadows: a shadow gets one
+/// if it's at least as large as the smallest of the ones that would have
+/// fit the budget last frame.
+bool Shadow::grantBake(F32 pixelSize)
+{
+   sgBakeRequests.push_back(pixelSize);
+   if(smBakesPerFrame > 0 && (sgBakesThisFrame >= smBakesPerFrame || pixelSize < sgBakeThreshold))
+      return false;
+
+   sgBakesThisFrame++;
+   return true;
+}
+
+void Shadow::startFrame()
+{
+   smBakesLastFrame = sgBakesThisFrame;
+   sgBakesThisFrame = 0;
+
+   sgBakeThreshold = 0.0f;
+   if(smBakesPerFrame > 0 && sgBakeRequests.size() > smBakesPerFrame)
+   {
+      dQsort(sgBakeRequests.address(), sgBakeRequests.size(), sizeof(F32), cmpBakeRequest);
+      sgBakeThreshold = sgBakeRequests[smBakesPerFrame - 1];
+   }
+   sgBakeRequests.clear();
+}
+
+void Shadow::releaseBake(Bake *bake)
+{
+   if(!bake || --bake->refCount)
+      return;
+
+   bake->lruNext = sgBakeLRU.lruNext;
+   bake->lruPrev = &sgBakeLRU;
+   sgBakeLRU.lruNext->lruPrev = bake;
+   sgBakeLRU.lruNext = bake;
+   sgUnusedBakes++;
+   sgUnusedBakeBytes += bake->dim * bake->dim;
+   flushUnusedBakes(getMax(smBakeCacheSize, S32(0)), getMax(smBakeCacheKB, S32(0)) * 1024);
+}
+
+/// Hashes what the bitmap would be drawn from: each shape's detail, mesh
+/// visibility and frames, and its nodes in bitmap space to about half a
+/// texel.
+U32 Shadow::getBakeKey()
+{
+   U32 hash = 2166136261;
+   hashKey(hash, mSettings.bmpDim);
+   hashKey(hash, mSettings.blur);
+
+   for(U32 i = 0; i < smBakeParts.size(); i++)
+   {
+      const BakePart &part = smBakeParts[i];
+      TSShapeInstance *si = part.shapeInstance;
+      hashKey(hash, S32(dsize_t(si->getShape())));
+      hashKey(hash, part.detail);
+
+      si->animate();
+      for(U32 j = 0; j < si->mMeshObjects.size(); j++)
+      {
+         const TSShapeInstance::MeshObjectInstance &mesh = si->mMeshObjects[j];
+         hashKey(hash, mesh.visible > 0.01f ? mesh.frame : -1);
+      }
+
+      // the columns are in texels per shape unit, so this is half a
+      // texel at the shape's radius
+      F32 invRotStep = 2.0f * getMax(si->getShape()->radius, 0.01f);
+      MatrixF node;
+      for(U32 j = 0; j < si->mNodeTransforms.size(); j++)
+      {
+         node.mul(part.mat, si->mNodeTransforms[j]);
+         const F32 *m = node;
+         for(U32 k = 0; k < 12; k++)
+            hashKey(hash, quantize(m[k], (k & 3) == 3 ? 2.0f : invRotStep));
+      }
+      if(si->mNodeTransforms.empty())
+      {
+         const F32 *m = part.mat;
+         for(U32 k = 0; k < 12; k++)
+            hashKey(hash, quantize(m[k], (k & 3) == 3 ? 2.0f : invRotStep));
+      }
+   }
+   return hash;
+}
+
+void Shadow::bake(Bake *bake)
+{
+   gShadowBits.setSize(mSettings.bmpDim * (mSettings.bmpDim>>5));
+   dMemset(gShadowBits.address(),0,mSettings.bmpDim*(mSettings.bmpDim>>3)); // dMemset deals in bytes not words, hence the shift by 3 not 5
+
+   for(U32 i = 0; i < smBakeParts.size(); i++)
+   {
+      const BakePart &part = smBakeParts[i];
+      part.shapeInstance->setCurrentDetail(part.detail);
+      part.shapeInstance->animate();
+      part.shapeInstance->renderShadow(part.detail,part.mat,mSettings.bmpDim,gShadowBits.address());
+   }
+
+   sgBakeScratch.setSize(mSettings.bmpDim * mSettings.bmpDim);
+   if (mSettings.blur==1)
+      // blur
+      BitRender::bitTo8Bit_3(gShadowBits.address(),(U32*)sgBakeScratch.address(),mSettings.bmpDim);
+   else
+      // non-blur version:
+      BitRender::bitTo8Bit(gShadowBits.address(),(U32*)sgBakeScratch.address(),mSettings.bmpDim);
+
+   // into the page's copy for a resurrection, and the texture
+   AtlasPage *page = bake->page;
+   U32 perRow = AtlasPageSize / page->dim;
+   U32 x = (bake->slot % perRow) * page->dim;
+   U32 y = (bake->slot / perRow) * page->dim;
+   U8 *dst = page->bitmap->getAddress(x, y);
+   for(S32 row = 0; row < page->dim; row++)
+      dMemcpy(dst + row * AtlasPageSize, &sgBakeScratch[row * page->dim], page->dim);
+
+   glBindTexture(GL_TEXTURE_2D, page->texture.getGLName());
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, page->dim, page->dim, GL_LUMINANCE, GL_UNSIGNED_BYTE, sgBakeScratch.address());
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+//--------------------------------------------------------------
+
 Shadow::PixelSizeDetail *sgShadowDetailList[] = {sgShadowDetailHighest, sgShadowDetailHigh,
 	sgShadowDetailMedium, sgShadowDetailLow, sgShadowDetailLowest, sgShadowDetailDamnNearOff,
 	sgShadowDetailGeneric};
@@ -117,11 +398,19 @@ void Shadow::setGlobalShadowDetailLevel(F32 d)
 
 Shadow::Shadow()
 {
-   mBitmap = NULL;
+   mBake = NULL;
+   mPixelSize = 0.0f;
    mRadius = 0.0f;
    mSettings.alwaysUseGenericBmp = false;
    mSettings.noAnimate = false;
    mSettings.noMove = false;
+   mSettings.bmpDim = 0;
+   mSettings.blur = 0;
+   mSettings.lastBmpTime = 0;
+   mSettings.needBmp = false;
+   mSourcePos.set(0.0f, 0.0f, 0.0f);
+   mSourceLightDir.set(0.0f, 0.0f, 0.0f);
+   mSourceScale.set(0.0f, 0.0f, 0.0f);
 
    setDefaultDetailTables();
 
@@ -142,9 +431,11 @@ Shadow::~Shadow()
 {
    AssertFatal(smInstanceCount > 0, "Error, more destructors than constructors?");
    smInstanceCount--;
+   releaseBake(mBake);
    if (smInstanceCount == 0) {
       delete smGenericShadowTexture;
       smGenericShadowTexture = NULL;
+      flushUnusedBakes(0, 0);
    }
 }
 
@@ -279,29 +570,60 @@ void Shadow::setRadius(TSShapeInstance * shapeInstance, const Point3F & scale)
 
 void Shadow::beginRenderToBitmap()
 {
-   AssertFatal(mBitmap,"Shadow::beginRenderToBitmap had no bitmap to render to!");
-
-   // clean slate...
-   gShadowBits.setSize(mSettings.bmpDim * (mSettings.bmpDim>>5));
-   dMemset(gShadowBits.address(),0,mSettings.bmpDim*(mSettings.bmpDim>>3)); // dMemset deals in bytes not words, hence the shift by 3 not 5
+   AssertFatal(mSettings.needBmp,"Shadow::beginRenderToBitmap: no bitmap needed.");
+   smBakeParts.clear();
 }
 
 void Shadow::endRenderToBitmap()
 {
-   // copy to bitmap
-   if (mSettings.blur==1)
-      // blur
-      BitRender::bitTo8Bit_3(gShadowBits.address(),(U32*)mBitmap->getWritableBits(),mSettings.bmpDim);
+   U32 key = getBakeKey();
+   if(mBake && mBake->key == key && mBake->dim == mSettings.bmpDim && mBake->blur == mSettings.blur)
+      return;
+
+   Bake *bake = sgBakeHash[key & (BakeHashSize - 1)];
+   while(bake && (bake->key != key || bake->dim != mSettings.bmpDim || bake->blur != mSettings.blur))
+      bake = bake->hashNext;
+
+   if(bake)
+   {
+      if(!bake->refCount++)
+         unlinkUnusedBake(bake);
+   }
    else
-      // non-blur version:
-      BitRender::bitTo8Bit(gShadowBits.address(),(U32*)mBitmap->getWritableBits(),mSettings.bmpDim);
+   {
+      // over budget, keep the old bitmap (or the generic one) for now
+      if(!grantBake(mPixelSize))
+      {
+         // try again next frame, whether or not the shape animates
+         mSettings.lastBmpTime = 0;
+         mSourceScale.set(0.0f, 0.0f, 0.0f);
+         return;
+      }
 
-   mShadowTexture.refresh();
+      AtlasPage *page;
+      U16 slot;
+      allocAtlasSlot(mSettings.bmpDim, &page, &slot);
+
+      bake = new Bake;
+      bake->key = key;
+      bake->dim = mSettings.bmpDim;
+      bake->blur = mSettings.blur;
+      bake->refCount = 1;
+      bake->page = page;
+      bake->slot = slot;
+      bake->lruPrev = bake->lruNext = NULL;
+      bake->hashNext = sgBakeHash[key & (BakeHashSize - 1)];
+      sgBakeHash[key & (BakeHashSize - 1)] = bake;
+      this->bake(bake);
+   }
+
+   releaseBake(mBake);
+   mBake = bake;
 }
 
 void Shadow::renderToBitmap(TSShapeInstance * shapeInstance, const MatrixF & transform, const Point3F & pos, Point3F scale)
 {
-   AssertFatal(mBitmap,"Shadow::renderToShadow: must call beginRenderToBitmap first");
+   AssertFatal(mSettings.needBmp,"Shadow::renderToShadow: must call beginRenderToBitmap first");
 
    MatrixF mat;
    mat.mul(mWorldToLight,transform);
@@ -325,8 +647,12 @@ void Shadow::renderToBitmap(TSShapeInstance * shapeInstance, const MatrixF & tra
    p.z += halfDim;
    mat.setColumn(3,p); // shape center now falls on bitmap center...
 
-   shapeInstance->animate();
-   shapeInstance->renderShadow(shapeInstance->getCurrentDetail(),mat,mSettings.bmpDim,gShadowBits.address());
+   // drawn in endRenderToBitmap if this pose isn't baked already
+   smBakeParts.increment();
+   BakePart &part = smBakeParts.last();
+   part.shapeInstance = shapeInstance;
+   part.detail = shapeInstance->getCurrentDetail();
+   part.mat = mat;
 }
 
 //--------------------------------------------------------------
@@ -345,10 +671,23 @@ bool Shadow::prepare(const Point3F & pos, Point3F lightDir, F32 shadowLen, const
 
    detectShadowDetailSizeChange();
 
+   // has anything the cached partition and bitmap came from changed?
+   // Only matters for shadows that would otherwise keep them.
+   bool sourceChanged = false;
+   if (mSettings.noMove || mSettings.noAnimate)
+   {
+      F32 posTol = 0.01f * getMax(mRadius, 0.1f);
+      sourceChanged = (pos - mSourcePos).lenSquared() > posTol * posTol ||
+                      mDot(lightDir, mSourceLightDir) < 0.99995f ||
+                      scale != mSourceScale;
+   }
+   Point3F sourceLightDir = lightDir;
+
    // --------------------------------------
    // 0.
    F32 maxScale = getMax(scale.x,getMax(scale.y,scale.z));
    F32 pixelSize = dglProjectRadius(dist/maxScale,shapeInstance->getShape()->radius) * dglGetPixelScale() * TSShapeInstance::smDetailAdjust;
+   mPixelSize = pixelSize;
    F32 smallest = getMax(Shadow::smSmallestVisibleSize,shapeInstance->getShape()->mSmallestVisibleSize);
    if (pixelSize * Shadow::smShapeDetailScale < smallest)
       return false;
@@ -373,7 +712,7 @@ bool Shadow::prepare(const Point3F & pos, Point3F lightDir, F32 shadowLen, const
    const PixelSizeDetail * psd;
    findPixelSizeDetail(pixelSize,&psd);
 
-   if (!mSettings.noMove || mPartition.empty())
+   if (!mSettings.noMove || mPartition.empty() || sourceChanged)
    {
       // --------------------------------------
       // 1.
@@ -392,6 +731,10 @@ bool Shadow::prepare(const Point3F & pos, Point3F lightDir, F32 shadowLen, const
       if (psd->genericShadowBmp || mSettings.alwaysUseGenericBmp || smAlwaysUseGenericBmp)
          radius *= smGenericRadiusSkew;
       buildPartition(pos,lightDir,radius,shadowLen);
+
+      mSourcePos = pos;
+      mSourceLightDir = sourceLightDir;
+      mSourceScale = scale;
    }
    updatePartition(fogAmount);
    if (mPartition.empty())
@@ -403,27 +746,23 @@ bool Shadow::prepare(const Point3F & pos, Point3F lightDir, F32 shadowLen, const
    // do we need a new bitmap?  anim rate, bmp dim, generic vs generated
    mSettings.needBmp = false;
    if (mSettings.alwaysUseGenericBmp || smAlwaysUseGenericBmp || psd->genericShadowBmp)
+   {
       // use generic bitmap -- get rid of old bmp if it's there
-      mBitmap = NULL;
+      releaseBake(mBake);
+      mBake = NULL;
+   }
    else
    {
       U32 time = Platform::getVirtualMilliseconds();
       bool expired = time-mSettings.lastBmpTime > psd->frameExpiration;
-      bool propertyChange = !mBitmap || psd->bmpDim!=mSettings.bmpDim || psd->blur!=mSettings.blur;
-      if ( (expired && !mSettings.noAnimate) || propertyChange)
+      bool propertyChange = !mBake || psd->bmpDim!=mSettings.bmpDim || psd->blur!=mSettings.blur;
+      if ( (expired && !mSettings.noAnimate) || propertyChange || sourceChanged)
       {
-         // need to generate a new bmp
+         // need to generate a new bmp, unless it's baked already
          mSettings.blur = psd->blur;
+         mSettings.bmpDim = psd->bmpDim;
          mSettings.lastBmpTime = Platform::getVirtualMilliseconds();
          mSettings.needBmp = true;
-
-         if (mSettings.bmpDim!=psd->bmpDim || !mBitmap)
-         {
-            // allocate new bitmap...register texture (no need to delete old one, owned by texture handle)
-            mSettings.bmpDim = psd->bmpDim;
-            mBitmap = new GBitmap(mSettings.bmpDim,mSettings.bmpDim,false,GBitmap::Luminance);
-            mShadowTexture.set(NULL,mBitmap);
-         }
       }
    }
 
@@ -538,8 +877,21 @@ void Shadow::render()
    glDepthMask(GL_FALSE);
    glBlendFunc(GL_ZERO,GL_ONE_MINUS_SRC_COLOR);
    glTexEnvf(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_MODULATE);
-   if (mBitmap)
-      glBindTexture(GL_TEXTURE_2D, mShadowTexture.getGLName());
+   if (mBake)
+   {
+      // map the bitmap onto the bake's slot, half a texel in so the
+      // neighbors don't bleed in
+      AtlasPage *page = mBake->page;
+      U32 perRow = AtlasPageSize / page->dim;
+      F32 invSize = 1.0f / F32(AtlasPageSize);
+      glBindTexture(GL_TEXTURE_2D, page->texture.getGLName());
+      glMatrixMode(GL_TEXTURE);
+      glPushMatrix();
+      glTranslatef(((mBake->slot % perRow) * page->dim + 0.5f) * invSize,
+                   ((mBake->slot / perRow) * page->dim + 0.5f) * invSize, 0.0f);
+      glScalef((page->dim - 1) * invSize, (page->dim - 1) * invSize, 1.0f);
+      glMatrixMode(GL_MODELVIEW);
+   }
    else {
       AssertFatal(smGenericShadowTexture != NULL, "Error, shadow texture not initialized!");
       glBindTexture(GL_TEXTURE_2D, smGenericShadowTexture->getGLName());
@@ -581,6 +933,12 @@ void Shadow::render()
    if (lockArrays)
       glUnlockArraysEXT();
    glPopMatrix();
+   if (mBake)
+   {
+      glMatrixMode(GL_TEXTURE);
+      glPopMatrix();
+      glMatrixMode(GL_MODELVIEW);
+   }
 
    // reset gl enviromnet
    glDisable(GL_TEXTURE_2D);
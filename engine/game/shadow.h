@@ -15,10 +15,42 @@
 
 class GBitmap;
 
+/// A blob or shape shadow projected onto the terrain and interiors.
+///
+/// Shape shadows are rasterized into bitmaps that live in shared atlas
+/// textures.  A bake is keyed on everything that goes into it (the shapes,
+/// their pose in light space, the bitmap size and blur) so shadows that
+/// haven't changed, or that match another shadow's, reuse its bitmap.  No
+/// more than $pref::Shadows::bakesPerFrame new bitmaps are drawn a frame,
+/// the largest shadows on screen first; the others keep their old bitmap
+/// until there's room.
+///
+/// Shadows that can't move or animate keep their partition and bitmap
+/// until the shape's position or scale, or the light, changes.  Unused
+/// bakes are kept up to $pref::Shadows::bakeCacheSize of them and
+/// $pref::Shadows::bakeCacheKB of atlas space.
 class Shadow
 {
-   GBitmap * mBitmap;
-   TextureHandle mShadowTexture;
+public:
+   struct Bake;
+
+private:
+   struct BakePart
+   {
+      TSShapeInstance *shapeInstance;
+      S32 detail;
+      MatrixF mat;      ///< Shape to bitmap space.
+   };
+
+   Bake * mBake;
+   F32 mPixelSize;
+
+   /// What the partition and bitmap were last made for, so a shadow that
+   /// doesn't move or animate still notices when its shape or light does.
+   Point3F mSourcePos;
+   Point3F mSourceLightDir;
+   Point3F mSourceScale;
+
    F32 mRadius;
    F32 mInvShadowDistance;
    MatrixF mLightToWorld;
@@ -59,6 +91,17 @@ class Shadow
 
    static F32 smGlobalShadowDetail;
 
+   static S32 smBakesPerFrame;
+   static S32 smBakeCacheSize;
+   static S32 smBakeCacheKB;
+   static S32 smBakesLastFrame;
+   static Vector<BakePart> smBakeParts;
+
+   static bool grantBake(F32 pixelSize);
+   static void releaseBake(Bake *);
+   U32 getBakeKey();
+   void bake(Bake *);
+
    static void collisionCallback(SceneObject*,void *);
 
    S32 sgLastShadowDetailSize;
@@ -99,6 +142,10 @@ public:
 
    static DistanceDetail smDefaultDistanceDetails[];
 
+   static void consoleInit();
+   /// Hands out the next frame's bitmap budget.
+   static void startFrame();
+
 private:
 
    const DistanceDetail * mDistanceDetails;
@@ -120,10 +167,11 @@ public:
    Shadow();
    ~Shadow();
 
+   /// Shapes passed to renderToBitmap() between these only go into the
+   /// bitmap if endRenderToBitmap() finds no bake of the same pose.
    void beginRenderToBitmap();
    void endRenderToBitmap();
    void renderToBitmap(TSShapeInstance *, const MatrixF &, const Point3F & center, Point3F scale);
-   GBitmap * getBitmap() { return mBitmap; }
 
    void setRadius(F32 radius);
    void setRadius(TSShapeInstance *, const Point3F & scale);
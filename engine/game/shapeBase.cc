@@ -38,6 +38,7 @@ bool ShapeBase::gRenderEnvMaps = true;
 F32  ShapeBase::sWhiteoutDec = 0.007;
 F32  ShapeBase::sDamageFlashDec = 0.007;
 U32  ShapeBase::sLastRenderFrame = 0;
+bool ShapeBase::sSkipHiddenAnimation = true;
 
 static const char *sDamageStateName[] =
 {
@@ -638,6 +639,7 @@ ShapeBase::ShapeBase()
    mDamageThread = 0;
    mHulkThread = 0;
    mLastRenderFrame = 0;
+   mHiddenAnimTime = 0;
    mLastRenderDistance = 0;
 
    mCloaked    = false;
@@ -774,6 +776,10 @@ void ShapeBase::onRemove()
 void ShapeBase::onSceneRemove()
 {
    mConvexList->nukeList();
+
+   // Anything asleep on top of us has lost its support
+   if (isServerObject())
+      wakeTouching(getWorldBox());
    Parent::onSceneRemove();
 }
 
@@ -995,15 +1001,51 @@ void ShapeBase::processTick(const Move* move)
    }
 }
 
+bool ShapeBase::canSleep()
+{
+   if (!isServerObject() || getControllingClient() || mControllingObject ||
+       isMounted() || mMount.list || mFading)
+      return false;
+
+   for (S32 i = 0; i < MaxMountedImages; i++)
+      if (mMountedImageList[i].dataBlock)
+         return false;
+   for (S32 i = 0; i < MaxScriptThreads; i++)
+      if (mScriptThread[i].sequence != -1 && mScriptThread[i].state == Thread::Play)
+         return false;
+   for (S32 i = 0; i < MaxSoundThreads; i++)
+      if (mSoundThread[i].play)
+         return false;
+
+   if (mDamageState == Enabled && mDataBlock->inheritEnergyFromMount == false &&
+       ((mRechargeRate > 0 && mEnergy < mDataBlock->maxEnergy) ||
+        (mRechargeRate < 0 && mEnergy > 0)))
+      return false;
+   if (mDataBlock->isInvincible == false &&
+       ((mRepairRate > 0 && mDamage > 0) || mRepairRate < 0 || mRepairReserve > 0))
+      return false;
+
+   return mDamageFlash <= 0 && mWhiteOut <= 0;
+}
+
 void ShapeBase::advanceTime(F32 dt)
 {
    // On the client, the shape threads and images are
-   // advanced at framerate.
-   advanceThreads(dt);
+   // advanced at framerate.  Only the triggered ones if
+   // we're out of sight.
+   U32 which = AdvanceAll;
+   if (canSkipAnimation()) {
+      mHiddenAnimTime += dt;
+      which = AdvanceTriggered;
+   }
+   else
+      catchUpAnimation();
+
+   advanceThreads(dt,which);
    updateAudioPos();
    for (int i = 0; i < MaxMountedImages; i++)
       if (mMountedImageList[i].dataBlock)
-         updateImageAnimation(i,dt);
+         updateImageAnimation(i,dt,which);
 
    // Cloaking takes 0.5 seconds
    if (mCloaked && mCloakLevel != 1.0) {
@@ -1211,6 +1253,7 @@ void ShapeBase::setEnergyLevel(F32 energy)
 
 void ShapeBase::setDamageLevel(F32 damage)
 {
+   wakeUp();
    if (!mDataBlock->isInvincible) {
       F32 store = mDamage;
       mDamage = mClampF(damage, 0.f, mDataBlock->maxDamage);
@@ -1315,6 +1358,7 @@ void ShapeBase::applyRepair(F32 amount)
    // Repair increases the repair reserve
    if (amount > 0 && ((mRepairReserve += amount) > mDamage))
       mRepairReserve = mDamage;
+   wakeUp();
 }
 
 void ShapeBase::applyDamage(F32 amount)
@@ -1515,6 +1559,8 @@ void ShapeBase::mountObject(ShapeBase* obj,U32 node)
 //      return;
    if (obj->mMount.object)
       obj->unmount();
+   wakeUp();
+   obj->wakeUp();
 
    // Since the object is mounting to us, nothing should be colliding with it for a while
    obj->mConvexList->nukeList();
@@ -1945,6 +1991,7 @@ void ShapeBase::playAudio(U32 slot,AudioProfile* profile)
    AssertFatal(slot < MaxSoundThreads,"ShapeBase::playSound: Incorrect argument");
    Sound& st = mSoundThread[slot];
    if (profile && (!st.play || st.profile != profile)) {
+      wakeUp();
       setMaskBits(SoundMaskN << slot);
       st.play = true;
       st.profile = profile;
@@ -2012,8 +2059,10 @@ bool ShapeBase::setThreadSequence(U32 slot,S32 seq,bool reset)
    Thread& st = mScriptThread[slot];
    if (st.thread && st.sequence == seq && st.state == Thread::Play)
       return true;
+   catchUpAnimation();
 
    if (seq < MaxSequenceIndex) {
+      wakeUp();
       setMaskBits(ThreadMaskN << slot);
       st.sequence = seq;
       if (reset) {
@@ -2035,6 +2084,7 @@ bool ShapeBase::setThreadSequence(U32 slot,S32 seq,bool reset)
 
 void ShapeBase::updateThread(Thread& st)
 {
+   catchUpAnimation();
    switch (st.state) {
       case Thread::Stop:
          mShapeInstance->setTimeScale(st.thread,1);
@@ -2088,6 +2138,7 @@ bool ShapeBase::playThread(U32 slot)
 {
    Thread& st = mScriptThread[slot];
    if (st.sequence != -1 && st.state != Thread::Play) {
+      wakeUp();
       setMaskBits(ThreadMaskN << slot);
       st.state = Thread::Play;
       updateThread(st);
@@ -2124,12 +2175,16 @@ void ShapeBase::startSequenceSound(Thread& thread)
    stopThreadSound(thread);
 }
 
-void ShapeBase::advanceThreads(F32 dt)
+void ShapeBase::advanceThreads(F32 dt, U32 which)
 {
+   const TSShape* shape = mShapeInstance->getShape();
    for (U32 i = 0; i < MaxScriptThreads; i++) {
       Thread& st = mScriptThread[i];
       if (st.thread) {
-         if (!mShapeInstance->getShape()->sequences[st.sequence].isCyclic() && !st.atEnd &&
+         if (which != AdvanceAll &&
+             (shape->sequences[st.sequence].numTriggers != 0) != (which == AdvanceTriggered))
+            continue;
+         if (!shape->sequences[st.sequence].isCyclic() && !st.atEnd &&
              (st.forward? mShapeInstance->getPos(st.thread) >= 1.0:
               mShapeInstance->getPos(st.thread) <= 0)) {
             st.atEnd = true;
@@ -2145,6 +2200,32 @@ void ShapeBase::advanceThreads(F32 dt)
    }
 }
 
+bool ShapeBase::canSkipAnimation()
+{
+   if (!sSkipHiddenAnimation || !isGhost() || didRenderLastRender())
+      return false;
+
+   // The control object and whatever it's mounted on are always
+   // animated, first person or not.
+   GameConnection* con = GameConnection::getConnectionToServer();
+   ShapeBase* co = con? con->getControlObject(): NULL;
+   return !co || (co != this && co->getObjectMount() != this);
+}
+
+void ShapeBase::catchUpAnimation()
+{
+   if (mHiddenAnimTime == 0)
+      return;
+
+   // Cleared first, the thread updates below come back here.
+   F32 dt = mHiddenAnimTime;
+   mHiddenAnimTime = 0;
+   advanceThreads(dt,AdvanceUntriggered);
+   for (int i = 0; i < MaxMountedImages; i++)
+      if (mMountedImageList[i].dataBlock)
+         updateImageAnimation(i,dt,AdvanceUntriggered);
+}
+
 
 //----------------------------------------------------------------------------
 
@@ -2193,6 +2274,7 @@ bool ShapeBase::prepRenderImage(SceneState* state, const U32 stateKey,
    if (state->isObjectRendered(this))
    {
       mLastRenderFrame = sLastRenderFrame;
+      catchUpAnimation();
       // get shape detail and fog information...we might not even need to be drawn
       Point3F cameraOffset;
       getRenderTransform().getColumn(3,&cameraOffset);
@@ -2225,7 +2307,7 @@ bool ShapeBase::prepRenderImage(SceneState* state, const U32 stateKey,
 
             if (mCloakLevel == 0.0f && image.shapeInstance->hasSolid() && mFadeVal == 1.0f)
             {
-               ShapeImageRenderImage* rimage = new ShapeImageRenderImage;
+               ShapeImageRenderImage* rimage = SceneState::newRenderImage<ShapeImageRenderImage>();
                rimage->obj = this;
                rimage->mSBase = this;
                rimage->mIndex = i;
@@ -2237,7 +2319,7 @@ bool ShapeBase::prepRenderImage(SceneState* state, const U32 stateKey,
             if ((mCloakLevel != 0.0f || mFadeVal != 1.0f || mShapeInstance->hasTranslucency()) ||
                 (mMount.object == NULL))
             {
-               ShapeImageRenderImage* rimage = new ShapeImageRenderImage;
+               ShapeImageRenderImage* rimage = SceneState::newRenderImage<ShapeImageRenderImage>();
                rimage->obj = this;
                rimage->mSBase = this;
                rimage->mIndex = i;
@@ -2253,7 +2335,7 @@ bool ShapeBase::prepRenderImage(SceneState* state, const U32 stateKey,
 
       if (mCloakLevel == 0.0f && mShapeInstance->hasSolid() && mFadeVal == 1.0f)
       {
-         SceneRenderImage* image = new SceneRenderImage;
+         SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
          image->obj = this;
          image->isTranslucent = false;
          image->textureSortKey = mSkinHash ^ (U32)(dsize_t)(mDataBlock);
@@ -2263,7 +2345,7 @@ bool ShapeBase::prepRenderImage(SceneState* state, const U32 stateKey,
       if ((mCloakLevel != 0.0f || mFadeVal != 1.0f || mShapeInstance->hasTranslucency()) ||
           (mMount.object == NULL))
       {
-         SceneRenderImage* image = new SceneRenderImage;
+         SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
          image->obj = this;
          image->isTranslucent = true;
          image->sortType = SceneRenderImage::Point;
@@ -2647,13 +2729,24 @@ void ShapeBase::buildConvex(const Box3F& box, Convex* convex)
    if (realBox.isOverlapped(getObjBox()) == false)
       return;
 
-   for (U32 i = 0; i < mDataBlock->collisionDetails.size(); i++)
+   // The detail boxes go to world space a batch at a time.
+   Box3F worldBoxes[ShapeBaseData::MaxCollisionShapes];
+   U32 numDetails = mDataBlock->collisionDetails.size();
+   for (U32 i = 0; i < numDetails; i++)
    {
-         Box3F newbox = mDataBlock->collisionBounds[i];
-         newbox.min.convolve(mObjScale);
-         newbox.max.convolve(mObjScale);
-         mObjToWorld.mul(newbox);
-         if (box.isOverlapped(newbox) == false)
+         U32 slot = i % ShapeBaseData::MaxCollisionShapes;
+         if (slot == 0)
+         {
+            U32 count = getMin(numDetails - i, U32(ShapeBaseData::MaxCollisionShapes));
+            for (U32 j = 0; j < count; j++)
+            {
+               worldBoxes[j] = mDataBlock->collisionBounds[i + j];
+               worldBoxes[j].min.convolve(mObjScale);
+               worldBoxes[j].max.convolve(mObjScale);
+            }
+            m_matF_x_box_array(mObjToWorld, worldBoxes[0].min, count);
+         }
+         if (box.isOverlapped(worldBoxes[slot]) == false)
             continue;
 
          // See if this hull exists in the working set already...
@@ -2878,7 +2971,7 @@ U32 ShapeBase::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
       return retMask;
 
    if (stream->writeFlag(mask & DamageMask)) {
-      stream->writeFloat(mClampF(mDamage / mDataBlock->maxDamage, 0.f, 1.f), DamageLevelBits);
+      con->packDeltaFloat(stream, DamageDeltaField, mClampF(mDamage / mDataBlock->maxDamage, 0.f, 1.f), DamageLevelBits, DamageDeltaBits);
       stream->writeInt(mDamageState,NumDamageStateBits);
       stream->writeNormalVector( damageDir, 8 );
    }
@@ -2887,10 +2980,12 @@ U32 ShapeBase::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
       for (int i = 0; i < MaxScriptThreads; i++) {
          Thread& st = mScriptThread[i];
          if (stream->writeFlag(st.sequence != -1 && (mask & (ThreadMaskN << i)))) {
-            stream->writeInt(st.sequence,ThreadSequenceBits);
-            stream->writeInt(st.state,2);
-            stream->writeFlag(st.forward);
-            stream->writeFlag(st.atEnd);
+            BitPacker bits;
+            bits.writeInt<ThreadSequenceBits>(st.sequence);
+            bits.writeInt<2>(st.state);
+            bits.writeFlag(st.forward);
+            bits.writeFlag(st.atEnd);
+            bits.flush(stream);
          }
       }
    }
@@ -2913,12 +3008,14 @@ U32 ShapeBase::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
                stream->writeInt(image.dataBlock->getId() - DataBlockObjectIdFirst,
                                 DataBlockObjectIdBitSize);
             con->packStringHandleU(stream, image.skinNameHandle);
-            stream->writeFlag(image.wet);
-            stream->writeFlag(image.ammo);
-            stream->writeFlag(image.loaded);
-            stream->writeFlag(image.target);
-            stream->writeFlag(image.triggerDown);
-            stream->writeInt(image.fireCount,3);
+            BitPacker bits;
+            bits.writeFlag(image.wet);
+            bits.writeFlag(image.ammo);
+            bits.writeFlag(image.loaded);
+            bits.writeFlag(image.target);
+            bits.writeFlag(image.triggerDown);
+            bits.writeInt<3>(image.fireCount);
+            bits.flush(stream);
             if (mask & InitialUpdateMask)
                stream->writeFlag(isImageFiring(i));
          }
@@ -2965,7 +3062,7 @@ U32 ShapeBase::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
          S32 gIndex = con->getGhostIndex(mMount.object);
          if (stream->writeFlag(gIndex != -1)) {
             stream->writeFlag(true);
-            stream->writeInt(gIndex,NetConnection::GhostIdBitSize);
+            con->packGhostIndex(stream, gIndex);
             stream->writeInt(mMount.node,ShapeBaseData::NumMountPointBits);
          }
          else
@@ -2992,7 +3089,7 @@ void ShapeBase::unpackUpdate(NetConnection *con, BitStream *stream)
       return;
 
    if (stream->readFlag()) {
-      mDamage = mClampF(stream->readFloat(DamageLevelBits) * mDataBlock->maxDamage, 0.f, mDataBlock->maxDamage);
+      mDamage = mClampF(con->unpackDeltaFloat(stream, DamageDeltaField, DamageLevelBits, DamageDeltaBits) * mDataBlock->maxDamage, 0.f, mDataBlock->maxDamage);
       DamageState prevState = mDamageState;
       mDamageState = DamageState(stream->readInt(NumDamageStateBits));
       stream->readNormalVector( &damageDir, 8 );
@@ -3006,10 +3103,11 @@ void ShapeBase::unpackUpdate(NetConnection *con, BitStream *stream)
       for (S32 i = 0; i < MaxScriptThreads; i++) {
          if (stream->readFlag()) {
             Thread& st = mScriptThread[i];
-            U32 seq = stream->readInt(ThreadSequenceBits);
-            st.state = stream->readInt(2);
-            st.forward = stream->readFlag();
-            st.atEnd = stream->readFlag();
+            BitUnpacker bits(stream, ThreadSequenceBits + 2 + 2);
+            U32 seq = bits.readInt<ThreadSequenceBits>();
+            st.state = bits.readInt<2>();
+            st.forward = bits.readFlag();
+            st.atEnd = bits.readFlag();
             if (st.sequence != seq)
                setThreadSequence(i,seq,false);
             else
@@ -3048,17 +3146,19 @@ void ShapeBase::unpackUpdate(NetConnection *con, BitStream *stream)
 
             StringHandle skinDesiredNameHandle = con->unpackStringHandleU(stream);
 
-            image.wet = stream->readFlag();
+            BitUnpacker bits(stream, 5 + 3);
 
-            image.ammo = stream->readFlag();
+            image.wet = bits.readFlag();
 
-            image.loaded = stream->readFlag();
+            image.ammo = bits.readFlag();
 
-            image.target = stream->readFlag();
+            image.loaded = bits.readFlag();
 
-            image.triggerDown = stream->readFlag();
+            image.target = bits.readFlag();
 
-            int count = stream->readInt(3);
+            image.triggerDown = bits.readFlag();
+
+            int count = bits.readInt<3>();
 
             if ((image.dataBlock != imageData) || (image.skinNameHandle != skinDesiredNameHandle)) {
 
@@ -3159,7 +3259,7 @@ void ShapeBase::unpackUpdate(NetConnection *con, BitStream *stream)
 
    if (stream->readFlag()) {
       if (stream->readFlag()) {
-         S32 gIndex = stream->readInt(NetConnection::GhostIdBitSize);
+         S32 gIndex = con->unpackGhostIndex(stream);
          ShapeBase* obj = dynamic_cast<ShapeBase*>(con->resolveGhost(gIndex));
          S32 node = stream->readInt(ShapeBaseData::NumMountPointBits);
          if(!obj)
@@ -3213,6 +3313,7 @@ void ShapeBase::setCloakedState(bool cloaked)
 void ShapeBase::setHidden(bool hidden)
 {
    if (hidden != mHidden) {
+      wakeUp();
       // need to set a mask bit to make the ghost manager delete copies of this object
       // hacky, but oh well.
       setMaskBits(CloakMask);
@@ -3292,15 +3393,8 @@ Point3F ShapeBaseConvex::support(const VectorF& v) const
       pShapeBase->mShapeInstance->getShape()->getAccelerator(pShapeBase->mDataBlock->collisionDetails[hullId]);
    AssertFatal(pAccel != NULL, "Error, no accel!");
 
-   F32 currMaxDP = mDot(pAccel->vertexList[0], v);
-   U32 index = 0;
-   for (U32 i = 1; i < pAccel->numVerts; i++) {
-      F32 dp = mDot(pAccel->vertexList[i], v);
-      if (dp > currMaxDP) {
-         currMaxDP = dp;
-         index = i;
-      }
-   }
+   U32 index = m_point3F_bulk_max_dot(&v.x, &pAccel->vertexList[0].x,
+                                      pAccel->numVerts, sizeof(Point3F), NULL);
 
    return pAccel->vertexList[index];
 }
@@ -3315,16 +3409,9 @@ void ShapeBaseConvex::getFeatures(const MatrixF& mat, const VectorF& n, ConvexFe
       pShapeBase->mShapeInstance->getShape()->getAccelerator(pShapeBase->mDataBlock->collisionDetails[hullId]);
    AssertFatal(pAccel != NULL, "Error, no accel!");
 
-   F32 currMaxDP = mDot(pAccel->vertexList[0], n);
-   U32 index = 0;
+   U32 index = m_point3F_bulk_max_dot(&n.x, &pAccel->vertexList[0].x,
+                                      pAccel->numVerts, sizeof(Point3F), NULL);
    U32 i;
-   for (i = 1; i < pAccel->numVerts; i++) {
-      F32 dp = mDot(pAccel->vertexList[i], n);
-      if (dp > currMaxDP) {
-         currMaxDP = dp;
-         index = i;
-      }
-   }
 
    const U8* emitString = pAccel->emitStrings[index];
    U32 currPos = 0;
@@ -3378,6 +3465,7 @@ bool ShapeBase::isInvincible()
 
 void ShapeBase::startFade( F32 fadeTime, F32 fadeDelay, bool fadeOut )
 {
+   wakeUp();
    setMaskBits(CloakMask);
    mFadeElapsedTime = 0;
    mFading = true;
@@ -4069,4 +4157,6 @@ void ShapeBase::consoleInit()
    Con::addVariable("SB::DFDec", TypeF32, &sDamageFlashDec);
    Con::addVariable("SB::WODec", TypeF32, &sWhiteoutDec);
    Con::addVariable("pref::environmentMaps", TypeBool, &gRenderEnvMaps);
+   Con::addVariable("pref::ShapeBase::skipHiddenAnimation", TypeBool, &sSkipHiddenAnimation);
+   Shadow::consoleInit();
 }
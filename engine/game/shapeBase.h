@@ -550,6 +550,7 @@ public:
       EnergyLevelBits = 5,
       DamageLevelBits = 6,
       DamageStateBits = 2,
+      DamageDeltaBits = 3,             ///< Damage change sent against the acked baseline.
       // The thread and image limits should not be changed without
       // also changing the ShapeBaseMasks enum values declared
       // further down.
@@ -571,6 +572,13 @@ public:
       NumDamageStateBits = 2,   ///< Should be log2 of the number of states.
    };
 
+   /// Delta compressed fields, see NetConnection::packDeltaInt.  Subclasses
+   /// number their own fields from NextFreeDeltaField.
+   enum DeltaFields {
+      DamageDeltaField,
+      NextFreeDeltaField
+   };
+
 private:
    ShapeBaseData*    mDataBlock;                ///< Datablock
    //GameConnection*   mControllingClient;        ///< Controlling client
@@ -852,6 +860,30 @@ protected:
    static U32 sLastRenderFrame;
    U32 mLastRenderFrame;
    F32 mLastRenderDistance;
+
+   /// @name Hidden Animation
+   ///
+   /// On the client, the threads and image animations of a shape that wasn't
+   /// rendered last frame aren't advanced; the time is saved up and applied
+   /// in one step when the shape is rendered again, or before anything
+   /// changes its threads.  Threads playing sequences with triggers always
+   /// advance, since triggers drive footsteps, sounds and particles.
+   /// @{
+
+   enum AnimAdvance {
+      AdvanceAll,          ///< Every thread.
+      AdvanceTriggered,    ///< Only threads with triggers; a hidden frame.
+      AdvanceUntriggered   ///< Only threads without; catching up.
+   };
+   static bool sSkipHiddenAnimation;   ///< $pref::ShapeBase::skipHiddenAnimation
+   F32 mHiddenAnimTime;                ///< Time the untriggered threads are behind.
+
+   /// Can untriggered threads stop advancing this frame?
+   bool canSkipAnimation();
+
+   /// Brings the untriggered threads up to date.
+   void catchUpAnimation();
+   /// @}
    U32 mSkinHash;
 
 
@@ -896,7 +928,9 @@ protected:
    /// Advance animation on a image
    /// @param   imageSlot   Image slot id
    /// @param   dt          Change in time since last animation update
-   void updateImageAnimation(U32 imageSlot, F32 dt);
+   /// @param   which       Which threads to advance; sounds and particles
+   ///                      are only updated when not catching up
+   void updateImageAnimation(U32 imageSlot, F32 dt, U32 which = AdvanceAll);
 
    /// Advance state of image
    /// @param   imageSlot   Image slot id
@@ -947,6 +981,7 @@ public:
    ~ShapeBase();
 
    TSShapeInstance* getShapeInstance() { return mShapeInstance; }
+   TSShapeInstance* getRenderShapeInstance() { return mShapeInstance; }
 
    /// @name Network state masks
    /// @{
@@ -1025,7 +1060,7 @@ public:
    /// Sets the rate at which the object regenerates damage.
    ///
    /// @param  rate  Repair rate in units/second.
-   void setRepairRate(F32 rate) { mRepairRate = rate; }
+   void setRepairRate(F32 rate) { mRepairRate = rate; wakeUp(); }
 
    /// Returns damage amount.
    F32  getDamageLevel()  { return mDamage; }
@@ -1056,7 +1091,7 @@ public:
 
    /// Sets the rate at which the energy replentishes itself
    /// @param   rate   Rate at which energy restores
-   void setRechargeRate(F32 rate) { mRechargeRate = rate; }
+   void setRechargeRate(F32 rate) { mRechargeRate = rate; wakeUp(); }
 
    /// Returns the amount of energy in the object
    F32  getEnergyLevel();
@@ -1121,8 +1156,9 @@ public:
    void stopThreadSound(Thread& thread);
 
    /// Advance all animation threads attached to this shapebase
-   /// @param   dt   Change in time from last call to this function
-   void advanceThreads(F32 dt);
+   /// @param   dt      Change in time from last call to this function
+   /// @param   which   Which threads to advance, see AnimAdvance
+   void advanceThreads(F32 dt, U32 which = AdvanceAll);
    /// @}
 
    /// @name Cloaking
@@ -1173,6 +1209,9 @@ public:
    /// Returns true if this object is mounted to anything at all
    bool isMounted() { return mMount.object != 0; }
 
+   /// Mounted objects follow their mount.
+   bool canUseSnapshots() { return !isMounted(); }
+
    /// Returns the number of object mounted along with this
    S32 getMountedObjectCount();
 
@@ -1509,6 +1548,10 @@ public:
    void processTick(const Move *move);
    void advanceTime(F32 dt);
 
+   /// Only once there's nothing left for processTick() to do: no mounts, images,
+   /// playing threads or sounds, fades, or energy and repair still changing.
+   bool canSleep();
+
    /// @name Rendering
    /// @{
 
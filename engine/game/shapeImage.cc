@@ -739,6 +739,7 @@ ShapeBase::MountedImage::~MountedImage()
 
 bool ShapeBase::mountImage(ShapeBaseImageData* imageData,U32 imageSlot,bool loaded,StringHandle &skinNameHandle)
 {
+   wakeUp();
    MountedImage& image = mMountedImageList[imageSlot];
    if (image.dataBlock) {
       if ((image.dataBlock == imageData) && (image.skinNameHandle == skinNameHandle)) {
@@ -1466,6 +1467,7 @@ void ShapeBase::setImageState(U32 imageSlot, U32 newState,bool force)
    if (!mMountedImageList[imageSlot].dataBlock)
       return;
    MountedImage& image = mMountedImageList[imageSlot];
+   catchUpAnimation();
 
 
    // The client never enters the initial fire state on its own, but it
@@ -1744,21 +1746,37 @@ void ShapeBase::updateImageState(U32 imageSlot,F32 dt)
 
 //----------------------------------------------------------------------------
 
-void ShapeBase::updateImageAnimation(U32 imageSlot, F32 dt)
+void ShapeBase::updateImageAnimation(U32 imageSlot, F32 dt, U32 which)
 {
    if (!mMountedImageList[imageSlot].dataBlock)
       return;
    MountedImage& image = mMountedImageList[imageSlot];
 
    // Advance animation threads
-   if (image.ambientThread)
-      image.shapeInstance->advanceTime(dt,image.ambientThread);
-   if (image.animThread)
-      image.shapeInstance->advanceTime(dt,image.animThread);
-   if (image.spinThread)
-      image.shapeInstance->advanceTime(dt,image.spinThread);
-   if (image.flashThread)
-      image.shapeInstance->advanceTime(dt,image.flashThread);
+   if (which == AdvanceAll) {
+      if (image.ambientThread)
+         image.shapeInstance->advanceTime(dt,image.ambientThread);
+      if (image.animThread)
+         image.shapeInstance->advanceTime(dt,image.animThread);
+      if (image.spinThread)
+         image.shapeInstance->advanceTime(dt,image.spinThread);
+      if (image.flashThread)
+         image.shapeInstance->advanceTime(dt,image.flashThread);
+   }
+   else {
+      TSThread* threads[4] = { image.ambientThread, image.animThread,
+                               image.spinThread, image.flashThread };
+      const TSShape* shape = image.shapeInstance->getShape();
+      for (U32 t = 0; t < 4; t++)
+         if (threads[t] &&
+             (shape->sequences[image.shapeInstance->getSequence(threads[t])].numTriggers != 0) ==
+             (which == AdvanceTriggered))
+            image.shapeInstance->advanceTime(dt,threads[t]);
+
+      // The sound and particles were kept up while we were hidden.
+      if (which == AdvanceUntriggered)
+         return;
+   }
 
    // Update any playing sound.
    if (image.animSound)
@@ -247,7 +247,7 @@ bool ShowTSShape::prepRenderImage(SceneState* state, const U32 stateKey,
       return false;
    setLastState(state, stateKey);
 
-   SceneRenderImage* image = new SceneRenderImage;
+   SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
    image->obj = this;
    image->isTranslucent = true;
    image->sortType = SceneRenderImage::EndSort;
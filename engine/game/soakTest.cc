@@ -0,0 +1,402 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "game/soakTest.h"
+#include "game/shapeBase.h"
+#include "game/gameBase.h"
+#include "game/moveManager.h"
+#include "core/bitStream.h"
+#include "core/fileStream.h"
+#include "console/console.h"
+#include "console/simBase.h"
+#include "game/version.h"
+
+IMPLEMENT_CONOBJECT(SoakBotConnection);
+
+bool         SoakTest::smRunning = false;
+bool         SoakTest::smMeasuring = false;
+U32          SoakTest::smElapsed = 0;
+U32          SoakTest::smWarmup = 0;
+U32          SoakTest::smDuration = 0;
+U64          SoakTest::smServerUs = 0;
+Vector<U32>  SoakTest::smFrameUs;
+char         SoakTest::smReportFile[256];
+Vector< SimObjectPtr<SoakBotConnection> > SoakTest::smBots;
+
+static S32 QSORT_CALLBACK cmpFrameTime(const void *a, const void *b)
+{
+   U32 ta = *(const U32 *) a;
+   U32 tb = *(const U32 *) b;
+   return (ta < tb) ? -1 : ((ta > tb) ? 1 : 0);
+}
+
+static inline F32 moveClamp(F32 v)
+{
+   // Same as the AIConnection, moves only take rotations of 0 -> M_2PI.
+   F32 a = mClampF(v, -M_PI, M_PI);
+   return (a < 0) ? a + M_2PI : a;
+}
+
+//-----------------------------------------------------------------------------
+// SoakBotConnection
+//-----------------------------------------------------------------------------
+
+SoakBotConnection::SoakBotConnection()
+{
+   mTimeCredit = 0;
+   mTurnRate = 0;
+   mStrafe = 0;
+   resetCounters();
+}
+
+void SoakBotConnection::onConnectionEstablished(bool isInitiator)
+{
+   AssertFatal(isInitiator, "SoakBotConnection::onConnectionEstablished: bots only connect.");
+
+   // Like GameConnection, but this isn't the connection to the server, and
+   // the ghosts aren't read.
+   setGhostFrom(false);
+   setGhostTo(false);
+   setSendingEvents(true);
+   setTranslatesStrings(true);
+   setIsConnectionToServer();
+}
+
+bool SoakBotConnection::connectToServer(const char *name)
+{
+   // Same handshake as NetConnection::connectLocal().
+   GameConnection *server = new GameConnection;
+   const char *error = NULL;
+   BitStream *stream = BitStream::getPacketStream();
+
+   setConnectArgs(1, &name);
+   server->registerObject();
+   server->setIsLocalClientConnection();
+
+   server->setSequence(0);
+   setSequence(0);
+   setRemoteConnectionObject(server);
+   server->setRemoteConnectionObject(this);
+
+   stream->setPosition(0);
+   writeConnectRequest(stream);
+   stream->setPosition(0);
+   if(!server->readConnectRequest(stream, &error))
+   {
+      Con::errorf("SoakBotConnection: %s was refused: %s", name, error ? error : "Unknown Error");
+      server->deleteObject();
+      return false;
+   }
+
+   stream->setPosition(0);
+   server->writeConnectAccept(stream);
+   stream->setPosition(0);
+   if(!readConnectAccept(stream, &error))
+   {
+      Con::errorf("SoakBotConnection: %s was refused: %s", name, error ? error : "Unknown Error");
+      server->deleteObject();
+      return false;
+   }
+
+   onConnectionEstablished(true);
+   server->onConnectionEstablished(false);
+   setEstablished();
+   server->setEstablished();
+   setConnectSequence(0);
+   server->setConnectSequence(0);
+   return true;
+}
+
+void SoakBotConnection::enterGame()
+{
+   GameConnection *server = getServerSide();
+   if(!server)
+      return;
+
+   // What the mission download ends with, minus the downloads.
+   server->activateGhosting();
+   sendConnectionMessage(ReadyForNormalGhosts, server->getGhostingSequence());
+   Con::executef(server, 1, "onClientEnterGame");
+}
+
+void SoakBotConnection::advanceTime(U32 timeDelta)
+{
+   for(mTimeCredit += timeDelta; mTimeCredit >= TickMs; mTimeCredit -= TickMs)
+   {
+      // Wander: run forward, turning and strafing for a while at a time,
+      // shooting and jumping every so often.
+      if(mRandom.randF() < 0.03f)
+         mTurnRate = mRandom.randF(-0.08f, 0.08f);
+      if(mRandom.randF() < 0.02f)
+         mStrafe = mRandom.randF(-1, 1);
+
+      Move mv = NullMove;
+      mv.y = 1;
+      mv.x = mStrafe;
+      mv.yaw = moveClamp(mTurnRate);
+      mv.trigger[0] = mRandom.randF() < 0.1f;
+      mv.trigger[2] = mRandom.randF() < 0.02f;
+      mv.clamp();
+
+      if(isBacklogged())
+         continue;
+
+      // A real client runs the move on its control object right away.
+      pushMove(mv);
+      clearMoves(1);
+   }
+}
+
+U32 SoakBotConnection::getControlObjectChecksum()
+{
+   // Predicting as well as a real client as far as the server can tell.
+   GameConnection *server = getServerSide();
+   ShapeBase *obj = server ? server->getControlObject() : NULL;
+   return obj ? obj->getPacketDataChecksum(server) : 0;
+}
+
+void SoakBotConnection::readPacket(BitStream *bstream)
+{
+   mBytesReceived += bstream->getReadByteSize();
+   mPacketsReceived++;
+
+   // Just the move ack, as GameConnection::readPacket() reads it.
+   mLastMoveAck = bstream->readInt(32);
+   if(mLastMoveAck < mFirstMoveIndex)
+      mLastMoveAck = mFirstMoveIndex;
+   if(mLastMoveAck > mLastClientMove)
+      mLastClientMove = mLastMoveAck;
+   while(mFirstMoveIndex < mLastMoveAck)
+   {
+      AssertFatal(mMoveList.size(), "Popping off too many moves!");
+      mMoveList.pop_front();
+      mFirstMoveIndex++;
+   }
+}
+
+void SoakBotConnection::writePacket(BitStream *bstream, PacketNotify *note)
+{
+   Parent::writePacket(bstream, note);
+   mBytesSent += (bstream->getCurPos() + 7) >> 3;
+   mPacketsSent++;
+}
+
+//-----------------------------------------------------------------------------
+// SoakTest
+//-----------------------------------------------------------------------------
+
+bool SoakTest::start(U32 numBots, U32 seconds, const char *reportFile)
+{
+   if(smRunning)
+      stop();
+
+   if(!Sim::getGhostAlwaysSet()->size())
+   {
+      Con::errorf("Soak test: no mission is running.");
+      return false;
+   }
+
+   dStrncpy(smReportFile, reportFile, sizeof(smReportFile) - 1);
+   smReportFile[sizeof(smReportFile) - 1] = '\0';
+
+   for(U32 i = 0; i < numBots; i++)
+   {
+      char name[32];
+      dSprintf(name, sizeof(name), "SoakBot%d", i);
+
+      SoakBotConnection *bot = new SoakBotConnection;
+      bot->registerObject();
+      Sim::getRootGroup()->addObject(bot);
+      if(!bot->connectToServer(name))
+      {
+         bot->deleteObject();
+         break;
+      }
+      bot->enterGame();
+      smBots.push_back(bot);
+   }
+
+   smElapsed = 0;
+   smWarmup = WarmupMs;
+   smDuration = seconds * 1000;
+   smMeasuring = false;
+   smRunning = true;
+
+   Con::printf("Soak test started with %d bots, writing %s.", smBots.size(), smReportFile);
+   return smBots.size() == numBots;
+}
+
+void SoakTest::startMeasuring()
+{
+   smMeasuring = true;
+   smElapsed = 0;
+   smServerUs = 0;
+   smFrameUs.clear();
+
+   for(U32 i = 0; i < smBots.size(); i++)
+   {
+      SoakBotConnection *bot = smBots[i];
+      if(!bot)
+         continue;
+      bot->resetCounters();
+      if(GameConnection *server = bot->getServerSide())
+         server->resetGhostLatency();
+   }
+}
+
+void SoakTest::stop()
+{
+   if(!smRunning)
+      return;
+
+   smRunning = false;
+   if(smMeasuring)
+      writeReport();
+   else
+      Con::warnf("Soak test: stopped before it started measuring.");
+
+   for(U32 i = 0; i < smBots.size(); i++)
+   {
+      SoakBotConnection *bot = smBots[i];
+      if(!bot)
+         continue;
+      if(GameConnection *server = bot->getServerSide())
+      {
+         server->setDisconnectReason("Soak test over.");
+         server->deleteObject();
+      }
+      bot->deleteObject();
+   }
+   smBots.clear();
+
+   Con::executef(2, "onSoakTestComplete", smReportFile);
+}
+
+void SoakTest::serverFrame(U32 us)
+{
+   if(!smMeasuring)
+      return;
+   smServerUs += us;
+   smFrameUs.push_back(us);
+}
+
+void SoakTest::advanceTime(U32 timeDelta)
+{
+   for(U32 i = 0; i < smBots.size(); i++)
+      if(SoakBotConnection *bot = smBots[i])
+         bot->advanceTime(timeDelta);
+
+   smElapsed += timeDelta;
+   if(!smMeasuring)
+   {
+      if(smElapsed >= smWarmup)
+         startMeasuring();
+   }
+   else if(smElapsed >= smDuration)
+      stop();
+}
+
+//-----------------------------------------------------------------------------
+
+void SoakTest::writeReport()
+{
+   U32 frames = smFrameUs.size();
+   U32 ticks = smElapsed / TickMs;
+   if(!frames || !ticks)
+   {
+      Con::warnf("Soak test: the server didn't tick.");
+      return;
+   }
+
+   // The bots that are still connected; any the server dropped don't count.
+   U32 clients = 0;
+   F64 bytesSent = 0, bytesReceived = 0, packetsSent = 0, packetsReceived = 0;
+   U32 updates = 0, latencyTotal = 0, latencyMax = 0;
+   for(U32 i = 0; i < smBots.size(); i++)
+   {
+      SoakBotConnection *bot = smBots[i];
+      GameConnection *server = bot ? bot->getServerSide() : NULL;
+      if(!server)
+         continue;
+
+      clients++;
+      bytesSent       += bot->mBytesSent;
+      bytesReceived   += bot->mBytesReceived;
+      packetsSent     += bot->mPacketsSent;
+      packetsReceived += bot->mPacketsReceived;
+
+      U32 count, total, max;
+      server->getGhostLatency(&count, &total, &max);
+      updates      += count;
+      latencyTotal += total;
+      latencyMax    = getMax(latencyMax, max);
+   }
+
+   Vector<U32> sorted(smFrameUs);
+   dQsort(sorted.address(), frames, sizeof(U32), cmpFrameTime);
+
+   F64 seconds      = smElapsed / 1000.0;
+   F64 tickMs       = smServerUs / 1000.0 / ticks;
+   F64 frameMean    = smServerUs / 1000.0 / frames;
+   F64 frameMedian  = sorted[frames / 2] / 1000.0;
+   F64 frameP99     = sorted[getMin(frames * 99 / 100, frames - 1)] / 1000.0;
+   F64 frameMax     = sorted[frames - 1] / 1000.0;
+   F64 perClient    = clients ? 1.0 / (clients * seconds) : 0;
+   F64 upBps        = bytesSent * perClient;
+   F64 downBps      = bytesReceived * perClient;
+   F64 upPacket     = packetsSent ? bytesSent / packetsSent : 0;
+   F64 downPacket   = packetsReceived ? bytesReceived / packetsReceived : 0;
+   F64 latencyMean  = updates ? F64(latencyTotal) / updates : 0;
+
+   Con::printf("Soak test: %d clients for %.1f s, %d ticks, server %.3f ms per tick (frames: median %.3f, 99%% %.3f, max %.3f ms).",
+               clients, seconds, ticks, tickMs, frameMedian, frameP99, frameMax);
+   Con::printf("   per client: up %.0f B/s (%.1f B/packet), down %.0f B/s (%.1f B/packet); ghost latency mean %.1f ms, max %d ms over %d updates.",
+               upBps, upPacket, downBps, downPacket, latencyMean, latencyMax, updates);
+
+   FileStream fws;
+   if(!fws.open(smReportFile, FileStream::Write))
+   {
+      Con::errorf("Soak test: unable to write %s.", smReportFile);
+      return;
+   }
+
+   char buf[1024];
+   dSprintf(buf, sizeof(buf),
+            "{\n\"version\":\"%s\",\n\"compiled\":\"%s\",\n"
+            "\"clients\":%d,\n\"seconds\":%.3f,\n\"ticks\":%d,\n\"serverTickMs\":%.4f,\n"
+            "\"serverFrameMs\":{\"frames\":%d,\"mean\":%.4f,\"median\":%.4f,\"p99\":%.4f,\"max\":%.4f},\n"
+            "\"perClient\":{\"upBytesPerSec\":%.1f,\"downBytesPerSec\":%.1f,"
+            "\"upBytesPerPacket\":%.2f,\"downBytesPerPacket\":%.2f},\n"
+            "\"ghostLatencyMs\":{\"updates\":%d,\"mean\":%.3f,\"max\":%d}\n}\n",
+            getVersionString(), getCompileTimeString(),
+            clients, seconds, ticks, tickMs,
+            frames, frameMean, frameMedian, frameP99, frameMax,
+            upBps, downBps, upPacket, downPacket,
+            updates, latencyMean, latencyMax);
+   fws.write(dStrlen(buf), buf);
+   fws.close();
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction(startSoakTest, bool, 4, 4, "(int numBots, int seconds, string reportFile) - "
+                "Connect numBots bot clients to the running mission and measure the server "
+                "for the given number of seconds, after a few seconds' warmup.  The report "
+                "is written to reportFile and onSoakTestComplete(reportFile) is called when it ends.")
+{
+   char fileName[256];
+   Con::expandScriptFilename(fileName, sizeof(fileName), argv[3]);
+   return SoakTest::start(getMax(dAtoi(argv[1]), 1), getMax(dAtoi(argv[2]), 1), fileName);
+}
+
+ConsoleFunction(stopSoakTest, void, 1, 1, "() - Stop the soak test, write its report and disconnect the bots.")
+{
+   SoakTest::stop();
+}
+
+ConsoleFunction(isSoakTestRunning, bool, 1, 1, "() - Is a soak test running?")
+{
+   return SoakTest::isRunning();
+}
@@ -0,0 +1,113 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _SOAKTEST_H_
+#define _SOAKTEST_H_
+
+#ifndef _GAMECONNECTION_H_
+#include "game/gameConnection.h"
+#endif
+#ifndef _MRANDOM_H_
+#include "math/mRandom.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+
+/// A fake client for soak testing a server.
+///
+/// The bot is connected to a server side GameConnection in the same process
+/// the way NetConnection::connectLocal() connects the local client, so every
+/// packet goes through the real packet writing, reading and notify path
+/// (including the parallel packet build), just without a socket.  It sends
+/// a synthetic move each tick, and a control object checksum matching the
+/// server's so it only gets the control object updates a real
+/// client would.  It never reads past the move ack in the server's packets,
+/// so it needs neither the datablocks nor a scene, and only counts the bytes.
+class SoakBotConnection : public GameConnection
+{
+   typedef GameConnection Parent;
+
+   MRandomLCG mRandom;
+   U32        mTimeCredit;
+   F32        mTurnRate;
+   F32        mStrafe;
+
+  protected:
+   void readPacket(BitStream *bstream);
+   void writePacket(BitStream *bstream, PacketNotify *note);
+   U32  getControlObjectChecksum();
+
+  public:
+   U32 mBytesSent;
+   U32 mBytesReceived;
+   U32 mPacketsSent;
+   U32 mPacketsReceived;
+
+   SoakBotConnection();
+   DECLARE_CONOBJECT(SoakBotConnection);
+
+   void onConnectionEstablished(bool isInitiator);
+
+   /// Connect to a new server side connection, which runs the script
+   /// onConnectRequest and onConnect like any other client.
+   bool connectToServer(const char *name);
+
+   /// Skip the mission download and drop straight into the game: start
+   /// ghosting as if the ghost always objects had arrived, and call the
+   /// script onClientEnterGame.
+   void enterGame();
+
+   /// The server's end of the connection, if it's still around.
+   GameConnection *getServerSide() { return static_cast<GameConnection *>(getRemoteConnectionObject()); }
+
+   /// Queue a move for every tick that has elapsed.
+   void advanceTime(U32 timeDelta);
+
+   void resetCounters() { mBytesSent = mBytesReceived = mPacketsSent = mPacketsReceived = 0; }
+};
+
+/// Soak tests a server with bot clients.
+///
+/// startSoakTest() connects the bots to the running mission and lets them
+/// play for a few seconds before measuring, so the joins don't count.  The
+/// report is a JSON file with the server time per tick (serverProcess()
+/// and GNet->processServer(), as timed in DemoGame::processTimeEvent), the
+/// bytes per client each way and the ghost update latency: the time from
+/// an object's state changing to the update being written, which grows
+/// once the packets can't keep up with the objects.
+class SoakTest
+{
+   static bool         smRunning;
+   static bool         smMeasuring;
+   static U32          smElapsed;
+   static U32          smWarmup;
+   static U32          smDuration;
+   static U64          smServerUs;
+   static Vector<U32>  smFrameUs;
+   static char         smReportFile[256];
+   static Vector< SimObjectPtr<SoakBotConnection> > smBots;
+
+   static void startMeasuring();
+   static void writeReport();
+
+  public:
+   enum Constants {
+      WarmupMs = 5000
+   };
+
+   static bool isRunning() { return smRunning; }
+
+   static bool start(U32 numBots, U32 seconds, const char *reportFile);
+   /// Writes the report and disconnects the bots.
+   static void stop();
+
+   /// Called with the time the server took each frame it ticked.
+   static void serverFrame(U32 us);
+   /// Called each frame before the client packets are sent.
+   static void advanceTime(U32 timeDelta);
+};
+
+#endif
@@ -0,0 +1,186 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "game/timeDemo.h"
+#include "platform/platformGL.h"
+#include "platform/profiler.h"
+#include "core/fileStream.h"
+#include "console/console.h"
+#include "console/consoleTypes.h"
+#include "game/version.h"
+
+bool         TimeDemo::smRunning = false;
+U64          TimeDemo::smLastFrameTime = 0;
+Vector<U32>  TimeDemo::smFrameUs;
+Vector<U32>  TimeDemo::smGpuUs;
+char         TimeDemo::smReportFile[256];
+bool         TimeDemo::smProfile = false;
+
+static S32 QSORT_CALLBACK cmpFrameTime(const void *a, const void *b)
+{
+   U32 ta = *(const U32 *) a;
+   U32 tb = *(const U32 *) b;
+   return (ta < tb) ? -1 : ((ta > tb) ? 1 : 0);
+}
+
+//-----------------------------------------------------------------------------
+
+void TimeDemo::consoleInit()
+{
+   Con::addVariable("$timeDemo::profile", TypeBool, &smProfile);
+}
+
+void TimeDemo::start(const char *reportFile)
+{
+   if(smRunning)
+      stop();
+
+   dStrncpy(smReportFile, reportFile, sizeof(smReportFile) - 1);
+   smReportFile[sizeof(smReportFile) - 1] = '\0';
+
+   smFrameUs.clear();
+   smGpuUs.clear();
+   smLastFrameTime = Platform::getRealMicroseconds();
+   smRunning = true;
+
+#ifdef TORQUE_ENABLE_PROFILER
+   if(smProfile)
+      gProfiler->enable(true);
+#endif
+
+   Con::printf("Time demo started, writing %s.", smReportFile);
+}
+
+void TimeDemo::stop()
+{
+   if(!smRunning)
+      return;
+
+   smRunning = false;
+   writeReport();
+
+#ifdef TORQUE_ENABLE_PROFILER
+   if(smProfile)
+   {
+      char profileFile[sizeof(smReportFile) + 16];
+      dSprintf(profileFile, sizeof(profileFile), "%s.profile.txt", smReportFile);
+      gProfiler->dumpToFile(profileFile);
+      gProfiler->enable(false);
+   }
+#endif
+}
+
+void TimeDemo::endFrame()
+{
+   // What the GPU still has to do once the CPU is done with the frame.
+   U64 submitted = Platform::getRealMicroseconds();
+   glFinish();
+   U64 now = Platform::getRealMicroseconds();
+
+   smFrameUs.push_back(U32(now - smLastFrameTime));
+   smGpuUs.push_back(U32(now - submitted));
+   smLastFrameTime = now;
+}
+
+//-----------------------------------------------------------------------------
+
+void TimeDemo::writeReport()
+{
+   U32 frames = smFrameUs.size();
+   if(!frames)
+   {
+      Con::warnf("Time demo: no frames were rendered.");
+      return;
+   }
+
+   F64 totalUs = 0, gpuUs = 0;
+   U32 histogram[HistogramBuckets];
+   dMemset(histogram, 0, sizeof(histogram));
+   for(U32 i = 0; i < frames; i++)
+   {
+      totalUs += smFrameUs[i];
+      gpuUs   += smGpuUs[i];
+      histogram[getMin(smFrameUs[i] / 1000, U32(HistogramBuckets - 1))]++;
+   }
+
+   // Sorted copy for the percentiles and the lows.
+   Vector<U32> sorted(smFrameUs);
+   dQsort(sorted.address(), frames, sizeof(U32), cmpFrameTime);
+
+   F64 lowFps[2];
+   const U32 lowDivisor[2] = { 100, 1000 };
+   for(U32 l = 0; l < 2; l++)
+   {
+      U32 count = getMax(frames / lowDivisor[l], U32(1));
+      F64 slowUs = 0;
+      for(U32 i = frames - count; i < frames; i++)
+         slowUs += sorted[i];
+      lowFps[l] = slowUs > 0 ? 1000000.0 * count / slowUs : 0;
+   }
+
+   F64 meanMs   = totalUs / frames / 1000.0;
+   F64 medianMs = sorted[frames / 2] / 1000.0;
+   F64 p99Ms    = sorted[getMin(frames * 99 / 100, frames - 1)] / 1000.0;
+   F64 p999Ms   = sorted[getMin(frames * 999 / 1000, frames - 1)] / 1000.0;
+   F64 maxMs    = sorted[frames - 1] / 1000.0;
+   F64 gpuMs    = gpuUs / frames / 1000.0;
+   F64 cpuMs    = meanMs - gpuMs;
+   F64 seconds  = totalUs / 1000000.0;
+   F64 avgFps   = seconds > 0 ? frames / seconds : 0;
+
+   Con::printf("Time demo: %d frames in %.2f s, %.1f fps, 1%% low %.1f fps, 0.1%% low %.1f fps.",
+               frames, seconds, avgFps, lowFps[0], lowFps[1]);
+   Con::printf("   frame ms: mean %.2f, median %.2f, 99%% %.2f, 99.9%% %.2f, max %.2f; cpu %.2f, gpu %.2f.",
+               meanMs, medianMs, p99Ms, p999Ms, maxMs, cpuMs, gpuMs);
+
+   FileStream fws;
+   if(!fws.open(smReportFile, FileStream::Write))
+   {
+      Con::errorf("Time demo: unable to write %s.", smReportFile);
+      return;
+   }
+
+   char buf[1024];
+   dSprintf(buf, sizeof(buf),
+            "{\n\"version\":\"%s\",\n\"compiled\":\"%s\",\n"
+            "\"frames\":%d,\n\"seconds\":%.3f,\n\"averageFps\":%.2f,\n"
+            "\"low1Fps\":%.2f,\n\"low01Fps\":%.2f,\n"
+            "\"frameMs\":{\"mean\":%.3f,\"median\":%.3f,\"p99\":%.3f,\"p999\":%.3f,\"max\":%.3f},\n"
+            "\"cpuMs\":%.3f,\n\"gpuMs\":%.3f,\n\"histogramMs\":[",
+            getVersionString(), getCompileTimeString(),
+            frames, seconds, avgFps, lowFps[0], lowFps[1],
+            meanMs, medianMs, p99Ms, p999Ms, maxMs, cpuMs, gpuMs);
+   fws.write(dStrlen(buf), buf);
+
+   for(U32 i = 0; i < HistogramBuckets; i++)
+   {
+      dSprintf(buf, sizeof(buf), i ? ",%d" : "%d", histogram[i]);
+      fws.write(dStrlen(buf), buf);
+   }
+
+   const char *footer = "]\n}\n";
+   fws.write(dStrlen(footer), footer);
+   fws.close();
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction(startTimeDemo, void, 2, 2, "(string reportFile) - Time the demo being played back, "
+                "one tick per frame, and write a report to reportFile when it ends.")
+{
+   char fileName[256];
+   Con::expandScriptFilename(fileName, sizeof(fileName), argv[1]);
+   TimeDemo::start(fileName);
+}
+
+ConsoleFunction(stopTimeDemo, void, 1, 1, "() - Stop the time demo and write its report.")
+{
+   TimeDemo::stop();
+}
+
+ConsoleFunction(isTimeDemoRunning, bool, 1, 1, "() - Is a time demo running?")
+{
+   return TimeDemo::isRunning();
+}
@@ -0,0 +1,62 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _TIMEDEMO_H_
+#define _TIMEDEMO_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+
+/// Times demo playback for benchmarking the client.
+///
+/// While a time demo runs, DemoGame::processTimeEvent() advances the
+/// client by exactly one tick per frame, so a recording plays back as fast
+/// as it can be rendered and every run renders the same frames.  Each
+/// frame ends with a glFinish(); the time spent in it is reported as the
+/// GPU time, and the rest of the frame as the CPU time.
+///
+/// The scripts start a time demo with startTimeDemo() once playDemo()
+/// succeeds; it stops when the playback completes, or on stopTimeDemo().
+/// The report is a JSON file with the frame count, average fps, the frame
+/// time mean, median, 99th and 99.9th percentiles and max, the 1% and 0.1%
+/// lows (the fps of the slowest 1% and 0.1% of the frames), the mean CPU
+/// and GPU times and a histogram of frame times in 1 ms buckets.  With
+/// $timeDemo::profile set in a profiler build, the profiler runs during
+/// the demo and the main thread's blocks are dumped next to the report,
+/// as <report>.profile.txt.
+class TimeDemo
+{
+   static bool         smRunning;
+   static U64          smLastFrameTime;
+   static Vector<U32>  smFrameUs;
+   static Vector<U32>  smGpuUs;
+   static char         smReportFile[256];
+
+   static void writeReport();
+
+  public:
+   enum Constants {
+      HistogramBuckets = 100        ///< 1 ms each, the last also has the longer frames.
+   };
+
+   static bool smProfile;           ///< $timeDemo::profile
+
+   static void consoleInit();
+
+   static bool isRunning() { return smRunning; }
+
+   static void start(const char *reportFile);
+   /// Writes the report.
+   static void stop();
+
+   /// Called at the end of each rendered frame.
+   static void endFrame();
+};
+
+#endif
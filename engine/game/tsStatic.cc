@@ -34,6 +34,7 @@ TSStatic::TSStatic()
    mShapeName        = "";
    mShapeInstance    = NULL;
    mShadow           = NULL;
+   mAllowInstancing  = false;
 
    mTypeMask |= ShadowCasterObjectType;
    
@@ -55,6 +56,10 @@ void TSStatic::initPersistFields()
    addGroup("Media");
    addField("shapeName", TypeFilename, Offset(mShapeName, TSStatic));
    endGroup("Media");
+
+   addGroup("Rendering");
+   addField("allowInstancing", TypeBool, Offset(mAllowInstancing, TSStatic));
+   endGroup("Rendering");
    
    addGroup("Lighting");
    addField("receiveSunLight", TypeBool, Offset(receiveSunLight, SceneObject));
@@ -205,16 +210,18 @@ bool TSStatic::prepRenderImage(SceneState* state, const U32 stateKey,
 
       if (mShapeInstance->hasSolid())
       {
-         SceneRenderImage* image = new SceneRenderImage;
+         SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
          image->obj = this;
          image->isTranslucent = false;
          image->textureSortKey = mShapeHash;
+         if (canRenderInstanced(state))
+            image->batchKey = mShapeHash ? mShapeHash : 1;
          state->insertRenderImage(image);
       }
 
       if (mShapeInstance->hasTranslucency())
       {
-         SceneRenderImage* image = new SceneRenderImage;
+         SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
          image->obj = this;
          image->isTranslucent = true;
          image->sortType = SceneRenderImage::Point;
@@ -350,6 +357,162 @@ void TSStatic::renderObject(SceneState* state, SceneRenderImage* image)
    PROFILE_END();
 }
 
+//--------------------------------------------------------------------------
+namespace {
+
+/// A copy picked for instanced rendering in TSStatic::renderObjectBatch().
+struct InstanceEntry
+{
+   TSStatic*         obj;
+   SceneRenderImage* image;
+   TSShape*          shape;
+   S32               detail;
+   S32               fogStep;
+};
+
+Vector<InstanceEntry> sgInstanceEntries(__FILE__, __LINE__);
+Vector<MatrixF>       sgInstanceMatrices(__FILE__, __LINE__);
+
+/// Fog is shared by a batch, so it is rounded to this many steps.
+const F32 sgInstanceFogSteps = 32.0f;
+
+S32 QSORT_CALLBACK cmpInstanceEntries(const void* p1, const void* p2)
+{
+   const InstanceEntry* e1 = (const InstanceEntry*)p1;
+   const InstanceEntry* e2 = (const InstanceEntry*)p2;
+
+   if (e1->shape != e2->shape)
+      return e1->shape < e2->shape ? -1 : 1;
+   if (e1->detail != e2->detail)
+      return e1->detail - e2->detail;
+   return e1->fogStep - e2->fogStep;
+}
+
+} // namespace {}
+
+bool TSStatic::canRenderInstanced(SceneState* /*state*/) const
+{
+   // Batches share one light setup and one projection, so only copies
+   // outside, with no light group of their own, are candidates.
+   return mAllowInstancing && TSShapeInstance::smAllowInstancing &&
+          lightIds.empty() && getNumCurrZones() == 1 && getCurrZone(0) == 0 &&
+          !GameBase::gShowBoundingBox;
+}
+
+void TSStatic::renderObjectBatch(SceneState* state, SceneRenderImage** images, U32 count)
+{
+   PROFILE_START(TSStatic_renderObjectBatch);
+
+   // Pick each copy's detail and fog.  Billboards, copies fading between
+   //  details and copies small enough for small textures need the full path.
+   sgInstanceEntries.clear();
+   U32 i;
+   for (i = 0; i < count; i++)
+   {
+      TSStatic* obj = static_cast<TSStatic*>(images[i]->obj);
+      TSShapeInstance* si = obj->mShapeInstance;
+      if (!DetailManager::selectCurrentDetail(si))
+         continue;
+
+      TSShape* shape = si->getShape();
+      S32 dl = si->getCurrentDetail();
+      F32 intraDL = si->getCurrentIntraDetail();
+
+      F32 axis = (obj->getObjBox().len_x() + obj->getObjBox().len_y() + obj->getObjBox().len_z()) / 3.0;
+      F32 dist = (obj->getRenderWorldBox().getClosestPoint(state->getCameraPosition()) - state->getCameraPosition()).len();
+      bool small = dist != 0 && dglProjectRadius(dist, axis) / 25 < (1.0 / 16.0);
+
+      if (small || shape->details[dl].subShapeNum < 0 ||
+          intraDL <= shape->alphaIn[dl] + shape->alphaOut[dl])
+      {
+         obj->renderObject(state, images[i]);
+         continue;
+      }
+
+      Point3F cameraOffset;
+      obj->mObjToWorld.getColumn(3,&cameraOffset);
+      cameraOffset -= state->getCameraPosition();
+      F32 fogAmount = state->getHazeAndFog(cameraOffset.len(),cameraOffset.z);
+
+      sgInstanceEntries.increment();
+      InstanceEntry& entry = sgInstanceEntries.last();
+      entry.obj     = obj;
+      entry.image   = images[i];
+      entry.shape   = shape;
+      entry.detail  = dl;
+      entry.fogStep = S32(fogAmount * sgInstanceFogSteps + 0.5f);
+   }
+
+   if (sgInstanceEntries.size() > 1)
+      dQsort(sgInstanceEntries.address(), sgInstanceEntries.size(), sizeof(InstanceEntry), cmpInstanceEntries);
+
+   for (i = 0; i < sgInstanceEntries.size(); )
+   {
+      const InstanceEntry& first = sgInstanceEntries[i];
+      U32 end = i + 1;
+      while (end < sgInstanceEntries.size() && cmpInstanceEntries(&first, &sgInstanceEntries[end]) == 0)
+         end++;
+
+      TSStatic* proto = first.obj;
+      if (end - i == 1)
+      {
+         // nothing to share with
+         proto->renderObject(state, first.image);
+         i = end;
+         continue;
+      }
+
+      sgInstanceMatrices.setSize(end - i);
+      for (U32 j = i; j < end; j++)
+      {
+         TSStatic* obj = sgInstanceEntries[j].obj;
+         MatrixF& mat = sgInstanceMatrices[j - i];
+         mat = obj->mObjToWorld;
+         mat.scale(obj->mObjScale);
+      }
+
+      RectI viewport;
+      glMatrixMode(GL_PROJECTION);
+      glPushMatrix();
+      dglGetViewport(&viewport);
+
+      // lighting and projection come from the first copy of the batch
+      gClientSceneGraph->getLightManager()->sgSetupLights(proto);
+      state->setupObjectProjection(proto);
+
+      glMatrixMode(GL_MODELVIEW);
+
+      TSShapeInstance* si = proto->mShapeInstance;
+      si->setEnvironmentMap(state->getEnvironmentMap());
+      si->setEnvironmentMapOn(true,1);
+      si->setAlphaAlways(1.0);
+
+      TSShapeInstance::smNoRenderNonTranslucent = false;
+      TSShapeInstance::smNoRenderTranslucent    = true;
+
+      si->setupFog(F32(first.fogStep) / sgInstanceFogSteps,state->getFogColor());
+      si->animate();
+      si->renderInstanced(first.detail,si->getCurrentIntraDetail(),
+                          sgInstanceMatrices.address(),sgInstanceMatrices.size());
+
+      TSShapeInstance::smNoRenderNonTranslucent = false;
+      TSShapeInstance::smNoRenderTranslucent    = false;
+
+      gClientSceneGraph->getLightManager()->sgResetLights();
+
+      dglSetCanonicalState();
+
+      glMatrixMode(GL_PROJECTION);
+      glPopMatrix();
+      glMatrixMode(GL_MODELVIEW);
+      dglSetViewport(viewport);
+
+      i = end;
+   }
+
+   PROFILE_END();
+}
+
 U32 TSStatic::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
 {
    U32 retMask = Parent::packUpdate(con, mask, stream);
@@ -367,6 +530,7 @@ U32 TSStatic::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
 	   stream->write(customAmbientLighting);
 	   stream->writeFlag(receiveLMLighting);
       stream->writeFlag(useLightingOcclusion);
+      stream->writeFlag(mAllowInstancing);
 
 	   if(isServerObject())
 	   {
@@ -377,7 +541,7 @@ U32 TSStatic::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
 		   stream->writeInt(maxcount, SG_TSSTATIC_MAX_LIGHT_SHIFT);
 		   for(U32 i=0; i<maxcount; i++)
 		   {
-			   stream->writeInt(lightIds[i], NetConnection::GhostIdBitSize);
+			   con->packGhostIndex(stream, lightIds[i]);
 		   }
 	   }
 	   else
@@ -387,7 +551,7 @@ U32 TSStatic::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
 		   stream->writeInt(maxcount, SG_TSSTATIC_MAX_LIGHT_SHIFT);
 		   for(U32 i=0; i<maxcount; i++)
 		   {
-			   stream->writeInt(lightIds[i], NetConnection::GhostIdBitSize);
+			   con->packGhostIndex(stream, lightIds[i]);
 		   }
 	   }
    }
@@ -419,12 +583,13 @@ void TSStatic::unpackUpdate(NetConnection *con, BitStream *stream)
 	   stream->read(&customAmbientLighting);
 	   receiveLMLighting = stream->readFlag();
       useLightingOcclusion = stream->readFlag();
+      mAllowInstancing = stream->readFlag();
 
 	   U32 count = stream->readInt(SG_TSSTATIC_MAX_LIGHT_SHIFT);
 	   lightIds.clear();
 	   for(U32 i=0; i<count; i++)
 	   {
-		   S32 id = stream->readInt(NetConnection::GhostIdBitSize);
+		   S32 id = con->unpackGhostIndex(stream);
 		   lightIds.push_back(id);
 	   }
    }
@@ -597,15 +762,8 @@ Point3F TSStaticConvex::support(const VectorF& v) const
       pStatic->mShapeInstance->getShape()->getAccelerator(pStatic->mCollisionDetails[hullId]);
    AssertFatal(pAccel != NULL, "Error, no accel!");
 
-   F32 currMaxDP = mDot(pAccel->vertexList[0], v);
-   U32 index = 0;
-   for (U32 i = 1; i < pAccel->numVerts; i++) {
-      F32 dp = mDot(pAccel->vertexList[i], v);
-      if (dp > currMaxDP) {
-         currMaxDP = dp;
-         index = i;
-      }
-   }
+   U32 index = m_point3F_bulk_max_dot(&v.x, &pAccel->vertexList[0].x,
+                                      pAccel->numVerts, sizeof(Point3F), NULL);
 
    return pAccel->vertexList[index];
 }
@@ -620,16 +778,9 @@ void TSStaticConvex::getFeatures(const MatrixF& mat, const VectorF& n, ConvexFea
       pStatic->mShapeInstance->getShape()->getAccelerator(pStatic->mCollisionDetails[hullId]);
    AssertFatal(pAccel != NULL, "Error, no accel!");
 
-   F32 currMaxDP = mDot(pAccel->vertexList[0], n);
-   U32 index = 0;
+   U32 index = m_point3F_bulk_max_dot(&n.x, &pAccel->vertexList[0].x,
+                                      pAccel->numVerts, sizeof(Point3F), NULL);
    U32 i;
-   for (i = 1; i < pAccel->numVerts; i++) {
-      F32 dp = mDot(pAccel->vertexList[i], n);
-      if (dp > currMaxDP) {
-         currMaxDP = dp;
-         index = i;
-      }
-   }
 
    const U8* emitString = pAccel->emitStrings[index];
    U32 currPos = 0;
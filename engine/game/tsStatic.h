@@ -92,10 +92,17 @@ class TSStatic : public SceneObject
    Vector<S32>            mCollisionDetails;
    Vector<S32>            mLOSDetails;
 
+   /// Copies of the same shape may be drawn together, sharing lighting and
+   /// fog, see renderObjectBatch().
+   bool              mAllowInstancing;
+
    // Rendering
   protected:
    bool prepRenderImage  ( SceneState *state, const U32 stateKey, const U32 startZone, const bool modifyBaseZoneState=false);
+   bool isParallelPrepSafe() const { return true; }
    void renderObject     ( SceneState *state, SceneRenderImage *image);
+   void renderObjectBatch( SceneState *state, SceneRenderImage **images, U32 count);
+   bool canRenderInstanced(SceneState *state) const;
    //void renderShadow     ( F32 dist, F32 fogAmount);
    void setTransform     ( const MatrixF &mat);
 
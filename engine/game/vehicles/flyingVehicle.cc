@@ -521,7 +521,7 @@ F32 FlyingVehicle::getHeight()
    ep.z = sp.z - r;
 
    disableCollision();
-   if (!mContainer->castRay(sp, ep, sCollisionMoveMask, &collision))
+   if (!castPhysicsRay(sp, ep, sCollisionMoveMask, &collision))
       collision.t = 1;
    enableCollision();
 
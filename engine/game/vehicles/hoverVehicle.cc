@@ -584,8 +584,8 @@ void HoverVehicle::updateForces(F32 /*dt*/)
    Point3F normal[2];
 
    for (j = 0; j < 2; j++) {
-      if (getContainer()->castRay(stabPoints[j].wsPoint, stabPoints[j].wsPoint + stabPoints[j].wsExtension * 2.0,
-                                  TerrainObjectType | InteriorObjectType | WaterObjectType, &rinfo)) {
+      if (castPhysicsRay(stabPoints[j].wsPoint, stabPoints[j].wsPoint + stabPoints[j].wsExtension * 2.0,
+                         TerrainObjectType | InteriorObjectType | WaterObjectType, &rinfo)) {
          reallyFloating = false;
 
          if (rinfo.t <= 0.5) {
@@ -464,6 +464,7 @@ Vehicle::Vehicle()
 
    mDisableMove = false;
    restCount = 0;
+   mDeferredImpact.set(0,0,0);
 
    inLiquid = false;
    waterWakeHandle = 0;
@@ -599,6 +600,10 @@ void Vehicle::onRemove()
 
 void Vehicle::processTick(const Move* move)
 {
+   // Only stays set if we get as far as the physics
+   bool deferPhysics = mDeferTickPhysics;
+   mDeferTickPhysics = false;
+
    Parent::processTick(move);
    
    // if we're not being controlled by a client, let the 
@@ -643,22 +648,89 @@ void Vehicle::processTick(const Move* move)
       mDelta.posVec = mRigid.linPosition;
       mDelta.rot[0] = mRigid.angPosition;
 
-      // Update the physics based on the integration rate
-      S32 count = mDataBlock->integration;
+      // Update the physics based on the integration rate.  The
+      // process list may want to run the steps itself, later.
       updateWorkingCollisionSet(getCollisionMask());
-      for (U32 i = 0; i < count; i++)
-         updatePos(TickSec / count);
-
-      // Wrap up interpolation info
-      mDelta.pos     = mRigid.linPosition;
-      mDelta.posVec -= mRigid.linPosition;
-      mDelta.rot[1]  = mRigid.angPosition;
-
-      // Update container database
-      setPosition(mRigid.linPosition, mRigid.angPosition);
-      setMaskBits(PositionMask);
-      updateContainer();
+      if (deferPhysics) {
+         mDeferTickPhysics = true;
+         return;
+      }
+      tickPhysics();
+      updateTickPosition();
+   }
+}
+
+void Vehicle::updateTickPosition()
+{
+   // Wrap up interpolation info
+   mDelta.pos     = mRigid.linPosition;
+   mDelta.posVec -= mRigid.linPosition;
+   mDelta.rot[1]  = mRigid.angPosition;
+
+   // Update container database
+   setPosition(mRigid.linPosition, mRigid.angPosition);
+   setMaskBits(PositionMask);
+   updateContainer();
+}
+
+
+//----------------------------------------------------------------------------
+
+bool Vehicle::canDeferTickPhysics()
+{
+   // Mounted objects tick after us and need our new position, and a
+   // client's moves are applied one at a time.
+   return isServerObject() && !getControllingClient() &&
+      !getMountList() && !isMounted();
+}
+
+void Vehicle::getTickPhysicsContacts(Vector<SceneObject*> &contacts)
+{
+   // Terrain, interiors and static shapes don't move, and the convex
+   // state lists they share are locked.
+   CollisionWorkingList& wl = mConvex.getWorkingList();
+   for (CollisionWorkingList* itr = wl.wLink.mNext; itr != &wl; itr = itr->wLink.mNext) {
+      SceneObject* obj = itr->mConvex->getObject();
+      if (!(obj->getTypeMask() & Container::csmStaticCollisionMask))
+         contacts.push_back(obj);
+   }
+}
+
+void Vehicle::tickPhysics()
+{
+   S32 count = mDataBlock->integration;
+   for (U32 i = 0; i < count; i++)
+      updatePos(TickSec / count);
+}
+
+void Vehicle::finishTickPhysics()
+{
+   // The script side of the steps, once per tick rather than once per
+   // step.  Triggers go first as they may queue collisions.
+   for (S32 i = 0; i < mDeferredCollisions.size(); i++) {
+      ShapeBase* obj = dynamic_cast<ShapeBase*>(Sim::findObject(mDeferredCollisions[i].object));
+      if (obj)
+         queueCollision(obj, mDeferredCollisions[i].vector);
    }
+   mDeferredCollisions.clear();
+
+   checkTriggers();
+   notifyCollision();
+
+   if (mDeferredImpact.len() > mDataBlock->minImpactSpeed)
+      onImpact(mDeferredImpact);
+   mDeferredImpact.set(0,0,0);
+
+   if (!inLiquid && mWaterCoverage != 0.0f) {
+      Con::executef(mDataBlock,4,"onEnterLiquid",scriptThis(), Con::getFloatArg(mWaterCoverage), Con::getIntArg(mLiquidType));
+      inLiquid = true;
+   }
+   else if (inLiquid && mWaterCoverage == 0.0f) {
+      Con::executef(mDataBlock,3,"onLeaveLiquid",scriptThis(), Con::getIntArg(mLiquidType));
+      inLiquid = false;
+   }
+
+   updateTickPosition();
 }
 
 void Vehicle::interpolateTick(F32 dt)
@@ -962,7 +1034,16 @@ void Vehicle::updatePos(F32 dt)
       mRigid.integrate(dt);
 
    // Deal with client and server scripting, sounds, etc.
-   if (isServerObject()) {
+   if (mDeferTickPhysics) {
+
+      // Keep the biggest impact for finishTickPhysics()
+      if (collided) {
+         VectorF collVec = mRigid.linVelocity - origVelocity;
+         if (collVec.lenSquared() > mDeferredImpact.lenSquared())
+            mDeferredImpact = collVec;
+      }
+   }
+   else if (isServerObject()) {
 
       // Check triggers and other objects that we normally don't
       // collide with.  This function must be called before notifyCollision
@@ -1102,7 +1183,7 @@ bool Vehicle::resolveCollision(Rigid&  ns,CollisionList& cList)
                // Keep track of objects we collide with
                if (!isGhost() && c.object->getTypeMask() & ShapeBaseObjectType) {
                   ShapeBase* col = static_cast<ShapeBase*>(c.object);
-                  queueCollision(col,v - col->getVelocity());
+                  queuePhysicsCollision(col,v - col->getVelocity());
                }
             }
          }
@@ -1246,6 +1327,30 @@ void Vehicle::checkTriggers()
    gServerContainer.findObjects(bbox,sTriggerMask,findCallback,this);
 }
 
+void Vehicle::queuePhysicsCollision(ShapeBase* obj, const VectorF& vec)
+{
+   // The collision timeouts come from a shared free list
+   if (mDeferTickPhysics) {
+      mDeferredCollisions.increment();
+      mDeferredCollisions.last().object = obj->getId();
+      mDeferredCollisions.last().vector = vec;
+   }
+   else
+      queueCollision(obj,vec);
+}
+
+bool Vehicle::castPhysicsRay(const Point3F &start, const Point3F &end, U32 mask, RayInfo* info)
+{
+   // Container casts stamp the objects they visit, so deferred
+   // steps take turns.
+   if (!mDeferTickPhysics)
+      return mContainer->castRay(start, end, mask, info);
+   Convex::lockShared();
+   bool hit = mContainer->castRay(start, end, mask, info);
+   Convex::unlockShared();
+   return hit;
+}
+
 /** The callback used in by the checkTriggers() method.
    The checkTriggers method uses a container search which will
    invoke this callback on each obj that matches.
@@ -1320,17 +1425,23 @@ U32 Vehicle::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
 {
    U32 retMask = Parent::packUpdate(con, mask, stream);
 
-   stream->writeFlag(mJetting);
+   BitPacker bits;
+   bits.writeFlag(mJetting);
 
    // The rest of the data is part of the control object packet update.
    // If we're controlled by this client, we don't need to send it.
-   if (stream->writeFlag(getControllingClient() == con && !(mask & InitialUpdateMask)))
+   bool controlled = bits.writeFlag(getControllingClient() == con && !(mask & InitialUpdateMask));
+   if (controlled)
+   {
+      bits.flush(stream);
       return retMask;
+   }
 
    F32 yaw = (mSteering.x + mDataBlock->maxSteeringAngle) / (2 * mDataBlock->maxSteeringAngle);
    F32 pitch = (mSteering.y + mDataBlock->maxSteeringAngle) / (2 * mDataBlock->maxSteeringAngle);
-   stream->writeFloat(yaw,9);
-   stream->writeFloat(pitch,9);
+   bits.writeFloat<9>(yaw);
+   bits.writeFloat<9>(pitch);
+   bits.flush(stream);
    mDelta.move.pack(stream);
 
    if (stream->writeFlag(mask & PositionMask))
@@ -1369,13 +1480,15 @@ void Vehicle::unpackUpdate(NetConnection *con, BitStream *stream)
 {
    Parent::unpackUpdate(con,stream);
 
-   mJetting = stream->readFlag();
+   BitUnpacker bits(stream, 2);
+   mJetting = bits.readFlag();
 
-   if (stream->readFlag())
+   if (bits.readFlag())
       return;
 
-   F32 yaw = stream->readFloat(9);
-   F32 pitch = stream->readFloat(9);
+   BitUnpacker steering(stream, 9 + 9);
+   F32 yaw = steering.readFloat<9>();
+   F32 pitch = steering.readFloat<9>();
    mSteering.x = (2 * yaw * mDataBlock->maxSteeringAngle) - mDataBlock->maxSteeringAngle;
    mSteering.y = (2 * pitch * mDataBlock->maxSteeringAngle) - mDataBlock->maxSteeringAngle;
    mDelta.move.unpack(stream);
@@ -19,6 +19,7 @@
 class ParticleEmitter;
 class ParticleEmitterData;
 class ClippedPolyList;
+struct RayInfo;
 
 
 //----------------------------------------------------------------------------
@@ -174,6 +175,17 @@ class Vehicle: public ShapeBase
    ShapeBaseConvex mConvex;
    int restCount;
 
+   /// @name Deferred physics
+   /// What a step run on a worker holds back for finishTickPhysics().
+   /// @{
+   struct DeferredCollision {
+      SimObjectId object;
+      VectorF vector;
+   };
+   Vector<DeferredCollision> mDeferredCollisions;
+   VectorF mDeferredImpact;         ///< Largest impact during the step
+   /// @}
+
    ParticleEmitter *mDustEmitterList[VehicleData::VC_NUM_DUST_EMITTERS];
    ParticleEmitter *mDamageEmitterList[VehicleData::VC_NUM_DAMAGE_EMITTERS];
    ParticleEmitter *mSplashEmitterList[VehicleData::VC_NUM_SPLASH_EMITTERS];
@@ -189,6 +201,13 @@ class Vehicle: public ShapeBase
    void checkTriggers();
    static void findCallback(SceneObject* obj,void * key);
 
+   /// queueCollision() that waits for finishTickPhysics() in a deferred step.
+   void queuePhysicsCollision(ShapeBase* obj, const VectorF& vec);
+   /// Container ray cast that is safe to make from a deferred step.
+   bool castPhysicsRay(const Point3F &start, const Point3F &end, U32 mask, RayInfo* info);
+   /// Copies the integrated rigid state into the interpolation data and transform.
+   void updateTickPosition();
+
    void setPosition(const Point3F& pos,const QuatF& rot);
    void setRenderPosition(const Point3F& pos,const QuatF& rot);
    void setTransform(const MatrixF& mat);
@@ -227,6 +246,17 @@ public:
    bool onAdd();
    void onRemove();
 
+   /// @name Deferred physics
+   /// Server vehicles driven by AI, or not at all, with nothing mounted
+   /// can have their physics steps run on the thread pool.
+   /// @see GameBase::canDeferTickPhysics
+   /// @{
+   bool canDeferTickPhysics();
+   void getTickPhysicsContacts(Vector<SceneObject*> &contacts);
+   void tickPhysics();
+   void finishTickPhysics();
+   /// @}
+
    Point2F getSteering() {return mSteering;}
 
    /// Interpolates between move ticks @see processTick
@@ -27,6 +27,7 @@
 #include "dgl/materialPropertyMap.h"
 #include "terrain/terrData.h"
 #include "sceneGraph/detailManager.h"
+#include "platform/profiler.h"
 
 //----------------------------------------------------------------------------
 
@@ -38,6 +39,15 @@ static U32 sClientCollisionMask =
       VehicleObjectType    | VehicleBlockerObjectType |
       StaticTSObjectType;
 
+// Wheel contact objects that don't move, cached between ticks
+static U32 sWheelStaticMask =
+      TerrainObjectType    | InteriorObjectType       |
+      VehicleBlockerObjectType | StaticTSObjectType;
+
+// The cached box is padded by this, plus this many seconds of travel
+static F32 sWheelQueryPad = 2.0f;
+static F32 sWheelQueryPadTime = 0.25f;
+
 // Gravity constant
 static F32 sWheeledVehicleGravity = -20;
 
@@ -412,6 +422,8 @@ WheeledVehicle::WheeledVehicle()
    mSquealSound = 0;
    mTailLightThread = 0;
    mSteeringThread = 0;
+   mWheelQueryBox.min.set(0, 0, 0);
+   mWheelQueryBox.max.set(0, 0, 0);
 
    for (S32 i = 0; i < WheeledVehicleData::MaxWheels; i++) {
       mWheel[i].springThread = 0;
@@ -991,6 +1003,11 @@ void WheeledVehicle::extendWheels(bool clientHack)
    // Does a single ray cast down for now... this will have to be
    // changed to something a little more complicated to avoid getting
    // stuck in cracks.
+   RayQuery rays[WheeledVehicleData::MaxWheels];
+   F32 tireFraction[WheeledVehicleData::MaxWheels];
+   Wheel* rayWheel[WheeledVehicleData::MaxWheels];
+   U32 count = 0;
+
    Wheel* wend = &mWheel[mDataBlock->wheelCount];
    for (Wheel* wheel = mWheel; wheel < wend; wheel++) 
    {
@@ -1005,29 +1022,93 @@ void WheeledVehicle::extendWheels(bool clientHack)
          currMatrix.mulP(wheel->data->pos,&sp);
          currMatrix.mulV(VectorF(0,0,-wheel->spring->length),&vec);
          F32 ts = wheel->tire->radius / wheel->spring->length;
-         Point3F ep = sp + (vec * (1 + ts));
-         ts = ts / (1+ts);
+         rays[count].start = sp;
+         rays[count].end = sp + (vec * (1 + ts));
+         tireFraction[count] = ts / (1+ts);
+         rayWheel[count++] = wheel;
+      }
+   }
 
-         RayInfo rInfo;
-         if (mContainer->castRay(sp, ep, sClientCollisionMask & ~PlayerObjectType, &rInfo)) 
-         {
-            wheel->surface.contact  = true;
-            wheel->extension = (rInfo.t < ts)? 0: (rInfo.t - ts) / (1 - ts);
-            wheel->surface.normal   = rInfo.normal;
-            wheel->surface.pos      = rInfo.point;
-            wheel->surface.material = rInfo.material;
-            wheel->surface.object   = rInfo.object;
-         }
-         else 
-         {
-            wheel->surface.contact = false;
-            wheel->slipping = true;
-         }
+   RayInfo hits[WheeledVehicleData::MaxWheels];
+   if (count)
+      castWheelRays(rays, count, sClientCollisionMask & ~PlayerObjectType, hits);
+
+   for (U32 i = 0; i < count; i++)
+   {
+      Wheel* wheel = rayWheel[i];
+      const RayInfo& rInfo = hits[i];
+      F32 ts = tireFraction[i];
+      if (rInfo.object) 
+      {
+         wheel->surface.contact  = true;
+         wheel->extension = (rInfo.t < ts)? 0: (rInfo.t - ts) / (1 - ts);
+         wheel->surface.normal   = rInfo.normal;
+         wheel->surface.pos      = rInfo.point;
+         wheel->surface.material = rInfo.material;
+         wheel->surface.object   = rInfo.object;
+      }
+      else 
+      {
+         wheel->surface.contact = false;
+         wheel->slipping = true;
       }
    }
    enableCollision();
 }
 
+void WheeledVehicle::wheelObjectCallback(SceneObject* obj, void* key)
+{
+   reinterpret_cast<WheeledVehicle*>(key)->mWheelObjects.push_back(obj);
+}
+
+void WheeledVehicle::castWheelRays(const RayQuery* rays, U32 count, U32 mask, RayInfo* out)
+{
+   PROFILE_START(WheeledVehicle_CastWheelRays);
+
+   Box3F box(rays[0].start, rays[0].start);
+   for (U32 i = 0; i < count; i++)
+   {
+      box.min.setMin(rays[i].start);
+      box.min.setMin(rays[i].end);
+      box.max.setMax(rays[i].start);
+      box.max.setMax(rays[i].end);
+   }
+
+   // Container queries stamp the objects they visit, so deferred
+   // steps take turns.
+   if (mDeferTickPhysics)
+      Convex::lockShared();
+
+   // Gather the static set again once the wheels leave its box, or
+   // something in it has been deleted.
+   mWheelObjects.setSize(mWheelObjectIds.size());
+   bool rebuild = !mWheelQueryBox.isContained(box);
+   for (U32 i = 0; !rebuild && i < mWheelObjectIds.size(); i++)
+      rebuild = Sim::findObject(mWheelObjectIds[i]) != mWheelObjects[i];
+   if (rebuild)
+   {
+      F32 pad = sWheelQueryPad + getVelocity().len() * sWheelQueryPadTime;
+      mWheelQueryBox = box;
+      mWheelQueryBox.min -= Point3F(pad, pad, pad);
+      mWheelQueryBox.max += Point3F(pad, pad, pad);
+
+      mWheelObjects.clear();
+      mContainer->findObjects(mWheelQueryBox, mask & sWheelStaticMask, wheelObjectCallback, this);
+      mWheelObjectIds.setSize(mWheelObjects.size());
+      for (U32 i = 0; i < mWheelObjects.size(); i++)
+         mWheelObjectIds[i] = mWheelObjects[i]->getId();
+   }
+
+   mContainer->findObjects(box, mask & ~sWheelStaticMask, wheelObjectCallback, this);
+   mContainer->castRaysAgainst(mWheelObjects.address(), mWheelObjects.size(), rays, count, out);
+   mWheelObjects.setSize(mWheelObjectIds.size());
+
+   if (mDeferTickPhysics)
+      Convex::unlockShared();
+
+   PROFILE_END();
+}
+
 
 //----------------------------------------------------------------------------
 /** Update wheel steering and suspension threads.
@@ -1305,7 +1386,7 @@ bool WheeledVehicle::prepRenderImage(SceneState* state, const U32 stateKey,
 
             if (mCloakLevel == 0.0f && image.shapeInstance->hasSolid() && mFadeVal == 1.0f)
             {
-               ShapeImageRenderImage* rimage = new ShapeImageRenderImage;
+               ShapeImageRenderImage* rimage = SceneState::newRenderImage<ShapeImageRenderImage>();
                rimage->obj = this;
                rimage->mSBase = this;
                rimage->mIndex = i;
@@ -1317,7 +1398,7 @@ bool WheeledVehicle::prepRenderImage(SceneState* state, const U32 stateKey,
             if ((mCloakLevel != 0.0f || mFadeVal != 1.0f || mShapeInstance->hasTranslucency()) ||
                 (mMount.object == NULL))
             {
-               ShapeImageRenderImage* rimage = new ShapeImageRenderImage;
+               ShapeImageRenderImage* rimage = SceneState::newRenderImage<ShapeImageRenderImage>();
                rimage->obj = this;
                rimage->mSBase = this;
                rimage->mIndex = i;
@@ -1333,7 +1414,7 @@ bool WheeledVehicle::prepRenderImage(SceneState* state, const U32 stateKey,
 
       if (mCloakLevel == 0.0f && mShapeInstance->hasSolid() && mFadeVal == 1.0f)
       {
-         SceneRenderImage* image = new SceneRenderImage;
+         SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
          image->obj = this;
          image->isTranslucent = false;
          image->textureSortKey = mSkinHash ^ (U32)(dsize_t)(mDataBlock);
@@ -1343,7 +1424,7 @@ bool WheeledVehicle::prepRenderImage(SceneState* state, const U32 stateKey,
       if ((mCloakLevel != 0.0f || mFadeVal != 1.0f || mShapeInstance->hasTranslucency()) ||
           (mMount.object == NULL))
       {
-         SceneRenderImage* image = new SceneRenderImage;
+         SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
          image->obj = this;
          image->isTranslucent = true;
          image->sortType = SceneRenderImage::Point;
@@ -187,6 +187,21 @@ private:
    void renderImage(SceneState *state, SceneRenderImage *image);
    void extendWheels(bool clientHack = false);
 
+   /// @name Wheel contact
+   ///
+   /// The terrain, interiors and static shapes around the wheels are
+   /// gathered once, over a box padded around the wheel rays, and reused
+   /// while the rays stay inside it.  Anything that moves is gathered each
+   /// tick over just the rays.  All of the wheels are cast in one batch.
+   /// @{
+   Box3F mWheelQueryBox;
+   Vector<SceneObject*> mWheelObjects;       ///< The static set, then this cast's movers.
+   Vector<SimObjectId>  mWheelObjectIds;     ///< To notice the static set going away.
+
+   void castWheelRays(const RayQuery* rays, U32 count, U32 mask, RayInfo* out);
+   static void wheelObjectCallback(SceneObject* obj, void* key);
+   /// @}
+
    // Client sounds & particles
    void updateWheelThreads();
    void updateWheelParticles(F32 dt);
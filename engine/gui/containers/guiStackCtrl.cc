@@ -35,6 +35,7 @@ GuiStackControl::GuiStackControl()
 {
    mMinExtent.set(24, 24);
    mResizing = false;
+   mFrozen = false;
    mStackingType = stackingTypeVert;
    mStackVertSizing = vertStackTop;
    mStackHorizSizing = horizStackLeft;
@@ -74,10 +75,20 @@ void GuiStackControl::onSleep()
    Parent::onSleep();
 }
 
+void GuiStackControl::freeze(bool frozen)
+{
+   if(mFrozen == frozen)
+      return;
+
+   mFrozen = frozen;
+   if(!mFrozen)
+      updatePanes();
+}
+
 void GuiStackControl::updatePanes()
 {
    // Prevent recursion
-   if(mResizing) 
+   if(mResizing || mFrozen)
       return;
 
    // Set Resizing.
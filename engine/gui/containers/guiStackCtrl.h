@@ -22,6 +22,7 @@ class GuiStackControl : public GuiControl
 protected:
    typedef GuiControl Parent;
    bool             mResizing;
+   bool             mFrozen;
    S32              mPadding;
    S32 mStackHorizSizing;      ///< Set from horizSizingOptions.
    S32 mStackVertSizing;       ///< Set from vertSizingOptions.
@@ -50,6 +51,11 @@ public:
 
    void updatePanes();
 
+   /// Holds off restacking while a batch of children is added, so a stack
+   /// of n controls is laid out once rather than n times.  freeze(false)
+   /// restacks.
+   void freeze(bool frozen);
+
    void stackFromLeft();
    void stackFromRight();
    void stackFromTop();
@@ -53,12 +53,6 @@ ConsoleMethod( GuiMLTextCtrl, scrollToBottom, void, 2, 2, "Scroll to the top of
    object->scrollToBottom();
 }
 
-ConsoleFunction( StripMLControlChars, const char*, 2, 2, "(string val)"
-                "Strip TorqueML control characters from the specified string, returning a 'clean' version.")
-{
-   return GuiMLTextCtrl::stripControlChars(argv[1]);
-}
-
 ConsoleMethod(GuiMLTextCtrl,forceReflow,void,2,2,"forces the text control to reflow the text after new text is added, possibly resizing the control.")
 {
    if(!object->isAwake())
@@ -87,6 +81,10 @@ GuiMLTextCtrl::GuiMLTextCtrl()
    mBitmapRefList = 0;
    mFontList = 0;
    mDirty = true;
+   mDirtyFrom = 0;
+   mReflowWidth = 0;
+   mLineCount = 0;
+   mDiscardedLines = 0;
    mLineList = 0;
    mTagList = 0;
    mHitURL = 0;
@@ -142,7 +140,7 @@ bool GuiMLTextCtrl::onWake()
    if (Parent::onWake() == false)
       return false;
 
-   mDirty = true;
+   markDirty(0);
    return true;
 }
 
@@ -292,7 +290,15 @@ void GuiMLTextCtrl::freeLineBuffers()
    mBitmapRefList = NULL;
    mTagList = NULL;
    mHitURL = 0;
+   mCheckpoints.clear();
+   markDirty(0);
+}
+
+void GuiMLTextCtrl::markDirty(U32 from)
+{
    mDirty = true;
+   if(from < mDirtyFrom)
+      mDirtyFrom = from;
 }
 
 //--------------------------------------------------------------------------
@@ -310,7 +316,8 @@ void GuiMLTextCtrl::freeResources()
    mFontList = NULL;
    mBitmapList = NULL;
    mResourceChunker.freeBlocks();
-   mDirty = true;
+   mCheckpoints.clear();
+   markDirty(0);
 
    freeLineBuffers();
 }
@@ -346,7 +353,7 @@ void GuiMLTextCtrl::parentResized(const Point2I& oldParentExtent,
                                   const Point2I& newParentExtent)
 {
    Parent::parentResized(oldParentExtent, newParentExtent);
-   mDirty = true;
+   markDirty(0);
 }
 
 //--------------------------------------------------------------------------
@@ -404,7 +411,7 @@ void GuiMLTextCtrl::setText(const char* textBuffer, const U32 numChars)
    //after setting text, always set the cursor to the beginning
    setCursorPosition(0);
    clearSelection();
-   mDirty = true;
+   markDirty(0);
    scrollToTop();
 }
 
@@ -418,6 +425,9 @@ void GuiMLTextCtrl::addText(const char* textBuffer, const U32 numChars, bool ref
    dStrncpy(tmp, textBuffer, numChars);
    tmp[numChars] = 0;
 
+   // Only what's added needs laying out, whenever the reflow comes.
+   if(mTextBuffer.length() < mDirtyFrom)
+      mDirtyFrom = mTextBuffer.length();
    mTextBuffer.append(tmp);
 
    //after setting text, always set the cursor to the beginning
@@ -622,7 +632,7 @@ void GuiMLTextCtrl::onMouseDragged(const GuiEvent& event)
          mSelectionActive = true;
       }
       setCursorPosition(newSelection);
-      mDirty = true;
+      markDirty(mTextBuffer.length());
    }
 
    setUpdate();
@@ -700,7 +710,7 @@ void GuiMLTextCtrl::insertChars(const char* inputChars,
    }
 
    AssertFatal(mCursorPosition <= mTextBuffer.length(), "GuiMLTextCtrl::insertChars: bad cursor position");
-   mDirty = true;
+   markDirty(position);
 }
 
 //--------------------------------------------------------------------------
@@ -733,7 +743,7 @@ void GuiMLTextCtrl::deleteChars(const U32 rangeStart,
    }
 
    AssertFatal(mCursorPosition <= mTextBuffer.length(), "GuiMLTextCtrl::deleteChars: bad cursor position");
-   mDirty = true;
+   markDirty(rangeStart);
 }
 
 //--------------------------------------------------------------------------
@@ -967,6 +977,7 @@ void GuiMLTextCtrl::emitNewLine(U32 textStart)
    mLineInsert = &(l->next);
    mCurX = mCurLMargin;
    mCurTabStop = 0;
+   mLineCount++;
 
    if(mLineAtoms)
    {
@@ -1372,56 +1383,147 @@ GuiMLTextCtrl::Style *GuiMLTextCtrl::allocStyle(GuiMLTextCtrl::Style *style)
 }
 
 //--------------------------------------------------------------------------
-void GuiMLTextCtrl::reflow()
+void GuiMLTextCtrl::saveCheckpoint()
 {
-   AssertFatal(mAwake, "Can't reflow a sleeping control.");
-   freeLineBuffers();
-   mDirty = false;
-   mScanPos = 0;
+   // a bitmap still hanging over the next lines is more state than this
+   if(mBlockList != &mSentinel)
+      return;
 
-   mLineList = NULL;
-   mLineInsert = &mLineList;
+   // Styles are changed in place until they're used; make sure later
+   // tags leave the ones in effect here alone.
+   for(Style *style = mCurStyle; style; style = style->next)
+      style->used = true;
+
+   mCheckpoints.increment();
+   ReflowCheckpoint &cp = mCheckpoints.last();
+   cp.scanPos = mScanPos;
+   cp.lineStart = mLineStart;
+   cp.lineCount = mLineCount;
+   cp.lineInsert = mLineInsert;
+   cp.style = mCurStyle;
+   cp.tagList = mTagList;
+   cp.bitmapRefList = mBitmapRefList;
+   cp.tabStops = mTabStops;
+   cp.tabStopCount = mTabStopCount;
+   cp.url = mCurURL;
+   cp.lMargin = mCurLMargin;
+   cp.rMargin = mCurRMargin;
+   cp.justify = mCurJustify;
+   cp.y = mCurY;
+   cp.maxY = mMaxY;
+}
 
-   mCurStyle = allocStyle(NULL);
-   mCurStyle->font = allocFont((char *) mProfile->mFontType, dStrlen(mProfile->mFontType), mProfile->mFontSize);
-   if(!mCurStyle->font)
-      return;
-   mCurStyle->color = mProfile->mFontColor;
-   mCurStyle->shadowColor = mProfile->mFontColor;
-   mCurStyle->shadowOffset.set(0,0);
-   mCurStyle->linkColor = mProfile->mFontColors[GuiControlProfile::ColorUser0];
-   mCurStyle->linkColorHL = mProfile->mFontColors[GuiControlProfile::ColorUser1];
+bool GuiMLTextCtrl::resumeReflow(U32 width)
+{
+   if(width != mReflowWidth || mDirtyFrom == 0 || mCheckpoints.empty())
+      return false;
 
-   U32 width = mBounds.extent.x;
+   S32 i = mCheckpoints.size() - 1;
+   while(i >= 0 && mCheckpoints[i].scanPos > mDirtyFrom)
+      i--;
+   if(i < 0)
+      return false;
 
-   mCurLMargin = 0;
-   mCurRMargin = width;
-   mCurJustify = LeftJustify;
+   // The lines after the checkpoint stay in mViewChunker until the next
+   // full reflow; have one once they'd double its size.
+   const ReflowCheckpoint cp = mCheckpoints[i];
+   U32 discarded = mLineCount - cp.lineCount;
+   if(mDiscardedLines + discarded > cp.lineCount)
+      return false;
+   mDiscardedLines += discarded;
+   mCheckpoints.setSize(i + 1);
+
+   mScanPos = cp.scanPos;
+   mLineStart = cp.lineStart;
+   mLineCount = cp.lineCount;
+   mLineInsert = cp.lineInsert;
+   *mLineInsert = NULL;
+   mCurStyle = cp.style;
+   mTagList = cp.tagList;
+   mBitmapRefList = cp.bitmapRefList;
+   mTabStops = cp.tabStops;
+   mTabStopCount = cp.tabStopCount;
+   mCurTabStop = 0;
+   mCurURL = cp.url;
+   mCurLMargin = cp.lMargin;
+   mCurRMargin = cp.rMargin;
+   mCurJustify = cp.justify;
    mCurDiv = 0;
-   mCurY = 0;
-   mCurX = 0;
+   mCurY = cp.y;
+   mCurX = mCurLMargin;
    mCurClipX = 0;
+   mMaxY = cp.maxY;
    mLineAtoms = NULL;
    mLineAtomPtr = &mLineAtoms;
-
-   mSentinel.point.x = width;
-   mSentinel.point.y = 0;
-   mSentinel.extent.x = 0;
-   mSentinel.extent.y = 0x7FFFFF;
-   mSentinel.nextBlocker = NULL;
-   mLineStart = 0;
-   mEmitAtoms = 0;
-   mMaxY = 0;
+   mEmitAtoms = NULL;
    mEmitAtomPtr = &mEmitAtoms;
-
    mBlockList = &mSentinel;
+   mHitURL = 0;
+   return true;
+}
+
+void GuiMLTextCtrl::reflow()
+{
+   AssertFatal(mAwake, "Can't reflow a sleeping control.");
+   U32 width = mBounds.extent.x;
+
+   // Pick up from the paragraph the first change is in if we can.
+   bool resumed = resumeReflow(width);
+   mDirtyFrom = 0xFFFFFFFF;
+   mDirty = false;
+   if(!resumed)
+   {
+      freeLineBuffers();
+      mDirty = false;
+      mDirtyFrom = 0xFFFFFFFF;
+      mReflowWidth = width;
+      mLineCount = 0;
+      mDiscardedLines = 0;
+      mScanPos = 0;
+
+      mLineList = NULL;
+      mLineInsert = &mLineList;
+
+      mCurStyle = allocStyle(NULL);
+      mCurStyle->font = allocFont((char *) mProfile->mFontType, dStrlen(mProfile->mFontType), mProfile->mFontSize);
+      if(!mCurStyle->font)
+         return;
+      mCurStyle->color = mProfile->mFontColor;
+      mCurStyle->shadowColor = mProfile->mFontColor;
+      mCurStyle->shadowOffset.set(0,0);
+      mCurStyle->linkColor = mProfile->mFontColors[GuiControlProfile::ColorUser0];
+      mCurStyle->linkColorHL = mProfile->mFontColors[GuiControlProfile::ColorUser1];
+
+      mCurLMargin = 0;
+      mCurRMargin = width;
+      mCurJustify = LeftJustify;
+      mCurDiv = 0;
+      mCurY = 0;
+      mCurX = 0;
+      mCurClipX = 0;
+      mLineAtoms = NULL;
+      mLineAtomPtr = &mLineAtoms;
+
+      mSentinel.point.x = width;
+      mSentinel.point.y = 0;
+      mSentinel.extent.x = 0;
+      mSentinel.extent.y = 0x7FFFFF;
+      mSentinel.nextBlocker = NULL;
+      mLineStart = 0;
+      mEmitAtoms = 0;
+      mMaxY = 0;
+      mEmitAtomPtr = &mEmitAtoms;
+
+      mBlockList = &mSentinel;
+
+      mTabStops = 0;
+      mCurTabStop = 0;
+      mTabStopCount = 0;
+      mCurURL = 0;
+   }
 
    Font *nextFont;
    LineTag *nextTag;
-   mTabStops = 0;
-   mCurTabStop = 0;
-   mTabStopCount = 0;
-   mCurURL = 0;
    Style *newStyle;
 
    U32 textStart;
@@ -1444,6 +1546,7 @@ void GuiMLTextCtrl::reflow()
          processEmitAtoms();
          emitNewLine(textStart);
          mCurDiv = 0;
+         saveCheckpoint();
          continue;
       }
 
@@ -1893,230 +1996,3 @@ textemit:
    //make sure the cursor is still visible - this handles if we're a child of a scroll ctrl...
    ensureCursorOnScreen();
 }
-
-//-----------------------------------------------------------------------------
-char* GuiMLTextCtrl::stripControlChars(const char *inString)
-{
-   if (! bool(inString))
-      return NULL;
-   U32 maxBufLength = 64;
-   char *strippedBuffer = Con::getReturnBuffer(maxBufLength);
-   char *stripBufPtr = &strippedBuffer[0];
-   const char *bufPtr = (char *) inString;
-   U32 idx, sizidx;
-
-   for(;;)
-   {
-      //if we've reached the end of the string, or run out of room in the stripped Buffer...
-      if(*bufPtr == '\0' || (U32(stripBufPtr - strippedBuffer) >= maxBufLength - 1))
-         break;
-
-      if (*bufPtr == '\n')
-      {
-         U32 walked;
-         oneUTF8toUTF32(bufPtr,&walked);
-         bufPtr += walked; 
-         continue;
-      }
-      if(*bufPtr == '\t')
-      {
-         U32 walked;
-         oneUTF8toUTF32(bufPtr,&walked);
-         bufPtr += walked;
-         continue;
-      }
-      if(*bufPtr < 0x20 && *bufPtr >= 0)
-      {
-         U32 walked;
-         oneUTF8toUTF32(bufPtr,&walked);
-         bufPtr += walked;
-         continue;
-      }
-
-      if(*bufPtr == '<')
-      {
-         // it's probably some kind of tag:
-         if(!dStrnicmp(bufPtr + 1, "font:", 5))
-         {
-            // scan for the second colon...
-            // at each level it should drop out to the text case below...
-            idx = 6;
-            if(!scanforchar((char*)bufPtr, idx, ':'))
-               goto textemit;
-
-            sizidx = idx + 1;
-            if(!scanforchar((char*)bufPtr, sizidx, '>'))
-               goto textemit;
-
-            bufPtr += sizidx + 1;
-            continue;
-         }
-
-         if (!dStrnicmp(bufPtr + 1, "tag:", 4 ))
-         {
-            idx = 5;
-            if ( !scanforchar((char*)bufPtr, idx, '>' ))
-               goto textemit;
-
-            bufPtr += idx + 1;
-            continue;
-         }
-
-         if(!dStrnicmp(bufPtr + 1, "color:", 6))
-         {
-            idx = 7;
-            if(!scanforchar((char*)bufPtr, idx, '>'))
-               goto textemit;
-            if(idx != 13)
-               goto textemit;
-
-            bufPtr += 14;
-            continue;
-         }
-
-         if(!dStrnicmp(bufPtr +1, "bitmap:", 7))
-         {
-            idx = 8;
-            if(!scanforchar((char*)bufPtr, idx, '>'))
-               goto textemit;
-
-            bufPtr += idx + 1;
-            continue;
-         }
-
-         if(!dStrnicmp(bufPtr +1, "spush>", 6))
-         {
-            bufPtr += 7;
-            continue;
-         }
-
-         if(!dStrnicmp(bufPtr +1, "spop>", 5))
-         {
-            bufPtr += 6;
-            continue;
-         }
-
-         if(!dStrnicmp(bufPtr +1, "sbreak>", 7))
-         {
-            bufPtr += 8;
-            continue;
-         }
-
-         if(!dStrnicmp(bufPtr +1, "just:left>", 10))
-         {
-            bufPtr += 11;
-            continue;
-         }
-
-         if(!dStrnicmp(bufPtr +1, "just:right>", 11))
-         {
-            bufPtr += 12;
-            continue;
-         }
-
-         if(!dStrnicmp(bufPtr +1, "just:center>", 12))
-         {
-            bufPtr += 13;
-            continue;
-         }
-
-         if(!dStrnicmp(bufPtr +1, "a:", 2))
-         {
-            idx = 3;
-            if(!scanforchar((char*)bufPtr, idx, '>'))
-               goto textemit;
-
-            bufPtr += idx + 1;
-            continue;
-         }
-
-         if(!dStrnicmp(bufPtr+1, "/a>", 3))
-         {
-            bufPtr += 4;
-            continue;
-         }
-
-         if(!dStrnicmp(bufPtr + 1, "lmargin%:", 9))
-         {
-            idx = 10;
-            if(!scanforchar((char*)bufPtr, idx, '>'))
-               goto textemit;
-            bufPtr += idx + 1;
-            goto setleftmargin;
-         }
-
-         if(!dStrnicmp(bufPtr + 1, "lmargin:", 8))
-         {
-            idx = 9;
-            if(!scanforchar((char*)bufPtr, idx, '>'))
-               goto textemit;
-            bufPtr += idx + 1;
-setleftmargin:
-            continue;
-         }
-
-         if(!dStrnicmp(bufPtr + 1, "rmargin%:", 9))
-         {
-            idx = 10;
-            if(!scanforchar((char*)bufPtr, idx, '>'))
-               goto textemit;
-            bufPtr += idx + 1;
-            goto setrightmargin;
-         }
-
-         if(!dStrnicmp(bufPtr + 1, "rmargin:", 8))
-         {
-            idx = 9;
-            if(!scanforchar((char*)bufPtr, idx, '>'))
-               goto textemit;
-            bufPtr += idx + 1;
-setrightmargin:
-            continue;
-         }
-
-         if(!dStrnicmp(bufPtr + 1, "clip:", 5))
-         {
-            idx = 6;
-            if(!scanforchar((char*)bufPtr, idx, '>'))
-               goto textemit;
-            bufPtr += idx + 1;
-            continue;
-         }
-
-         if(!dStrnicmp(bufPtr + 1, "/clip>", 6))
-         {
-            bufPtr += 7;
-            continue;
-         }
-
-         if(!dStrnicmp(bufPtr + 1, "div:", 4))
-         {
-            idx = 5;
-            if(!scanforchar((char*)bufPtr, idx, '>'))
-               goto textemit;
-            bufPtr += idx + 1;
-            continue;
-         }
-
-         if(!dStrnicmp(bufPtr + 1, "tab:", 4))
-         {
-            idx = 5;
-            if(!scanforchar((char*)bufPtr, idx, '>'))
-               goto textemit;
-            bufPtr += idx + 1;
-            continue;
-         }
-      }
-
-      // default case:
-textemit:
-      *stripBufPtr++ = *bufPtr++;
-      while(*bufPtr != '\t' && *bufPtr != '<' && *bufPtr != '\n' && (*bufPtr >= 0x20 || *bufPtr < 0))
-         *stripBufPtr++ = *bufPtr++;
-   }
-
-   //we're finished - terminate the string
-   *stripBufPtr = '\0';
-   return strippedBuffer;
-}
-
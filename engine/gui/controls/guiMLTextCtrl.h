@@ -183,6 +183,40 @@ class GuiMLTextCtrl : public GuiControl
 
    URL *mHitURL;
 
+   /// The reflow state at the start of a paragraph with no bitmaps hanging
+   /// over it, which is all it takes to carry on from there when only
+   /// later text has changed.
+   struct ReflowCheckpoint
+   {
+      U32 scanPos;
+      U32 lineStart;
+      U32 lineCount;
+      Line **lineInsert;
+      Style *style;
+      LineTag *tagList;
+      BitmapRef *bitmapRefList;
+      U32 *tabStops;
+      U32 tabStopCount;
+      URL *url;
+      U32 lMargin;
+      U32 rMargin;
+      U32 justify;
+      U32 y;
+      U32 maxY;
+   };
+   Vector<ReflowCheckpoint> mCheckpoints;
+   U32 mDirtyFrom;         ///< First character changed since the last reflow.
+   U32 mReflowWidth;       ///< Width the checkpoints were laid out for.
+   U32 mLineCount;
+   U32 mDiscardedLines;    ///< Lines left in mViewChunker by resumed reflows.
+
+   /// Flags a reflow needed from the paragraph holding character from on.
+   void markDirty(U32 from);
+   void saveCheckpoint();
+   /// Restores the last checkpoint before mDirtyFrom, or returns false
+   /// if the reflow has to start over.
+   bool resumeReflow(U32 width);
+
    void freeLineBuffers();
    void freeResources();
 
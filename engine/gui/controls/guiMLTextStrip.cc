@@ -0,0 +1,252 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+// Kept apart from the rest of GuiMLTextCtrl since the server uses it too, on
+// player names, and the headless build has no gui.
+
+#include "gui/controls/guiMLTextCtrl.h"
+#include "console/console.h"
+#include "core/unicode.h"
+
+//--------------------------------------------------------------------------
+static bool scanforchar(const char *str, U32 &idx, char c)
+{
+   U32 startidx = idx;
+   while(str[idx] != c && str[idx] && str[idx] != ':' && str[idx] != '>' && str[idx] != '\n')
+      idx++;
+   return str[idx] == c && startidx != idx;
+}
+
+ConsoleFunction( StripMLControlChars, const char*, 2, 2, "(string val)"
+                "Strip TorqueML control characters from the specified string, returning a 'clean' version.")
+{
+   return GuiMLTextCtrl::stripControlChars(argv[1]);
+}
+
+//-----------------------------------------------------------------------------
+char* GuiMLTextCtrl::stripControlChars(const char *inString)
+{
+   if (! bool(inString))
+      return NULL;
+   U32 maxBufLength = 64;
+   char *strippedBuffer = Con::getReturnBuffer(maxBufLength);
+   char *stripBufPtr = &strippedBuffer[0];
+   const char *bufPtr = (char *) inString;
+   U32 idx, sizidx;
+
+   for(;;)
+   {
+      //if we've reached the end of the string, or run out of room in the stripped Buffer...
+      if(*bufPtr == '\0' || (U32(stripBufPtr - strippedBuffer) >= maxBufLength - 1))
+         break;
+
+      if (*bufPtr == '\n')
+      {
+         U32 walked;
+         oneUTF8toUTF32(bufPtr,&walked);
+         bufPtr += walked; 
+         continue;
+      }
+      if(*bufPtr == '\t')
+      {
+         U32 walked;
+         oneUTF8toUTF32(bufPtr,&walked);
+         bufPtr += walked;
+         continue;
+      }
+      if(*bufPtr < 0x20 && *bufPtr >= 0)
+      {
+         U32 walked;
+         oneUTF8toUTF32(bufPtr,&walked);
+         bufPtr += walked;
+         continue;
+      }
+
+      if(*bufPtr == '<')
+      {
+         // it's probably some kind of tag:
+         if(!dStrnicmp(bufPtr + 1, "font:", 5))
+         {
+            // scan for the second colon...
+            // at each level it should drop out to the text case below...
+            idx = 6;
+            if(!scanforchar((char*)bufPtr, idx, ':'))
+               goto textemit;
+
+            sizidx = idx + 1;
+            if(!scanforchar((char*)bufPtr, sizidx, '>'))
+               goto textemit;
+
+            bufPtr += sizidx + 1;
+            continue;
+         }
+
+         if (!dStrnicmp(bufPtr + 1, "tag:", 4 ))
+         {
+            idx = 5;
+            if ( !scanforchar((char*)bufPtr, idx, '>' ))
+               goto textemit;
+
+            bufPtr += idx + 1;
+            continue;
+         }
+
+         if(!dStrnicmp(bufPtr + 1, "color:", 6))
+         {
+            idx = 7;
+            if(!scanforchar((char*)bufPtr, idx, '>'))
+               goto textemit;
+            if(idx != 13)
+               goto textemit;
+
+            bufPtr += 14;
+            continue;
+         }
+
+         if(!dStrnicmp(bufPtr +1, "bitmap:", 7))
+         {
+            idx = 8;
+            if(!scanforchar((char*)bufPtr, idx, '>'))
+               goto textemit;
+
+            bufPtr += idx + 1;
+            continue;
+         }
+
+         if(!dStrnicmp(bufPtr +1, "spush>", 6))
+         {
+            bufPtr += 7;
+            continue;
+         }
+
+         if(!dStrnicmp(bufPtr +1, "spop>", 5))
+         {
+            bufPtr += 6;
+            continue;
+         }
+
+         if(!dStrnicmp(bufPtr +1, "sbreak>", 7))
+         {
+            bufPtr += 8;
+            continue;
+         }
+
+         if(!dStrnicmp(bufPtr +1, "just:left>", 10))
+         {
+            bufPtr += 11;
+            continue;
+         }
+
+         if(!dStrnicmp(bufPtr +1, "just:right>", 11))
+         {
+            bufPtr += 12;
+            continue;
+         }
+
+         if(!dStrnicmp(bufPtr +1, "just:center>", 12))
+         {
+            bufPtr += 13;
+            continue;
+         }
+
+         if(!dStrnicmp(bufPtr +1, "a:", 2))
+         {
+            idx = 3;
+            if(!scanforchar((char*)bufPtr, idx, '>'))
+               goto textemit;
+
+            bufPtr += idx + 1;
+            continue;
+         }
+
+         if(!dStrnicmp(bufPtr+1, "/a>", 3))
+         {
+            bufPtr += 4;
+            continue;
+         }
+
+         if(!dStrnicmp(bufPtr + 1, "lmargin%:", 9))
+         {
+            idx = 10;
+            if(!scanforchar((char*)bufPtr, idx, '>'))
+               goto textemit;
+            bufPtr += idx + 1;
+            goto setleftmargin;
+         }
+
+         if(!dStrnicmp(bufPtr + 1, "lmargin:", 8))
+         {
+            idx = 9;
+            if(!scanforchar((char*)bufPtr, idx, '>'))
+               goto textemit;
+            bufPtr += idx + 1;
+setleftmargin:
+            continue;
+         }
+
+         if(!dStrnicmp(bufPtr + 1, "rmargin%:", 9))
+         {
+            idx = 10;
+            if(!scanforchar((char*)bufPtr, idx, '>'))
+               goto textemit;
+            bufPtr += idx + 1;
+            goto setrightmargin;
+         }
+
+         if(!dStrnicmp(bufPtr + 1, "rmargin:", 8))
+         {
+            idx = 9;
+            if(!scanforchar((char*)bufPtr, idx, '>'))
+               goto textemit;
+            bufPtr += idx + 1;
+setrightmargin:
+            continue;
+         }
+
+         if(!dStrnicmp(bufPtr + 1, "clip:", 5))
+         {
+            idx = 6;
+            if(!scanforchar((char*)bufPtr, idx, '>'))
+               goto textemit;
+            bufPtr += idx + 1;
+            continue;
+         }
+
+         if(!dStrnicmp(bufPtr + 1, "/clip>", 6))
+         {
+            bufPtr += 7;
+            continue;
+         }
+
+         if(!dStrnicmp(bufPtr + 1, "div:", 4))
+         {
+            idx = 5;
+            if(!scanforchar((char*)bufPtr, idx, '>'))
+               goto textemit;
+            bufPtr += idx + 1;
+            continue;
+         }
+
+         if(!dStrnicmp(bufPtr + 1, "tab:", 4))
+         {
+            idx = 5;
+            if(!scanforchar((char*)bufPtr, idx, '>'))
+               goto textemit;
+            bufPtr += idx + 1;
+            continue;
+         }
+      }
+
+      // default case:
+textemit:
+      *stripBufPtr++ = *bufPtr++;
+      while(*bufPtr != '\t' && *bufPtr != '<' && *bufPtr != '\n' && (*bufPtr >= 0x20 || *bufPtr < 0))
+         *stripBufPtr++ = *bufPtr++;
+   }
+
+   //we're finished - terminate the string
+   *stripBufPtr = '\0';
+   return strippedBuffer;
+}
@@ -24,6 +24,10 @@ GuiTreeViewCtrl::Item::Item( GuiControlProfile *pProfile )
    mTabLevel            = 0;
    mIcon                = 0;
    mDataRenderWidth     = 0;
+   mTextWidth           = 0;
+   mTextWidthFont       = NULL;
+   mTextWidthName       = NULL;
+   mTextWidthInternalName = NULL;
    mScriptInfo.mText    = NULL;
    mScriptInfo.mValue   = NULL;
    mParent              = NULL;
@@ -82,6 +86,7 @@ void GuiTreeViewCtrl::Item::setText(char *txt)
    }
 
    mScriptInfo.mText = txt;
+   mTextWidthFont = NULL;
 
 
    // Update Render Data
@@ -159,6 +164,7 @@ void GuiTreeViewCtrl::Item::setObject(SimObject *obj)
    }
 
    mInspectorInfo.mObject = obj;
+   mTextWidthFont = NULL;
 
    // Update Render Data
    if( !mProfile.isNull() )
@@ -248,6 +254,31 @@ const S32 GuiTreeViewCtrl::Item::getDisplayTextWidth(GFont *font)
    return font->getStrWidth(buf);
 }
 
+S32 GuiTreeViewCtrl::Item::getCachedTextWidth(GFont *font)
+{
+   // An inspector item's text is its object's id, class and names, and
+   // only the names can change.
+   if(mState.test(InspectorData))
+   {
+      SimObject *obj = getObject();
+      StringTableEntry name = obj ? obj->getName() : NULL;
+      StringTableEntry internalName = obj ? obj->getInternalName() : NULL;
+      if(name != mTextWidthName || internalName != mTextWidthInternalName)
+      {
+         mTextWidthName = name;
+         mTextWidthInternalName = internalName;
+         mTextWidthFont = NULL;
+      }
+   }
+
+   if(font != mTextWidthFont)
+   {
+      mTextWidth = getDisplayTextWidth(font);
+      mTextWidthFont = font;
+   }
+   return mTextWidth;
+}
+
 const bool GuiTreeViewCtrl::Item::isParent() const
 {
    if(mState.test(VirtualParent))
@@ -596,7 +627,7 @@ void GuiTreeViewCtrl::buildItem( Item* item, U32 tabLevel, bool bForceFullUpdate
 
    if ( mProfile != NULL && !mProfile->mFont.isNull() )
    {
-      S32 width = ( tabLevel + 1 ) * mTabSize + item->getDisplayTextWidth(mProfile->mFont);
+      S32 width = ( tabLevel + 1 ) * mTabSize + item->getCachedTextWidth(mProfile->mFont);
       if ( mProfile->mBitmapArrayRects.size() > 0 )
          width += mProfile->mBitmapArrayRects[0].extent.x;
       
@@ -3419,6 +3450,13 @@ void GuiTreeViewCtrl::inspectorSearch(Item * item, Item * parent, SimSet * paren
       }
    }
 }
+static S32 QSORT_CALLBACK compareObjectIds(const void *a, const void *b)
+{
+   SimObjectId ia = *(const SimObjectId *) a;
+   SimObjectId ib = *(const SimObjectId *) b;
+   return (ia < ib) ? -1 : ((ia > ib) ? 1 : 0);
+}
+
 bool GuiTreeViewCtrl::onVirtualParentBuild(Item *item, bool bForceFullUpdate)
 {
    if(!item->mState.test(Item::InspectorData))
@@ -3442,23 +3480,31 @@ bool GuiTreeViewCtrl::onVirtualParentBuild(Item *item, bool bForceFullUpdate)
    if(!srcObj)
       return true;
 
-   SimSet::iterator i;
+   // Add the objects that aren't anywhere under the item yet (an object a
+   // script put deeper down stays there).  One pass over the subtree and a
+   // binary search per object, where searching the subtree for each
+   // object made an expanded group of thousands crawl.
+   Vector<SimObjectId> ids;
+   collectChildObjectIds(item, ids);
+   dQsort(ids.address(), ids.size(), sizeof(SimObjectId), compareObjectIds);
 
-   // This is slow but probably ok.
+   SimSet::iterator i;
    for(i = srcObj->begin(); i != srcObj->end(); i++)
    {
       SimObject *obj = *i;
+      SimObjectId id = obj->getId();
 
-      // If we can't find it, add it.
-      // unless it has a parent that is a child that is a script
-      Item *res = item->findChildByValue(obj);
-
-      bool foundChild = true;
-
-      // search the children. if any of them are the parent of the object then don't add it.
-      foundChild = childSearch(item,obj,foundChild);
+      S32 lo = 0, hi = ids.size();
+      while(lo < hi)
+      {
+         S32 mid = (lo + hi) >> 1;
+         if(ids[mid] < id)
+            lo = mid + 1;
+         else
+            hi = mid;
+      }
 
-      if(!res && foundChild)
+      if(lo == ids.size() || ids[lo] != id)
       {
          if (mDebug) Con::printf("adding something");
          addInspectorDataItem(item, obj);
@@ -3468,6 +3514,16 @@ bool GuiTreeViewCtrl::onVirtualParentBuild(Item *item, bool bForceFullUpdate)
    return true;
 }
 
+void GuiTreeViewCtrl::collectChildObjectIds(Item *item, Vector<SimObjectId> &ids)
+{
+   for(Item *walk = item->mChild; walk; walk = walk->mNext)
+   {
+      if(walk->isInspectorData() && walk->getObject())
+         ids.push_back(walk->getObject()->getId());
+      collectChildObjectIds(walk, ids);
+   }
+}
+
 bool GuiTreeViewCtrl::onVirtualParentExpand(Item *item)
 {
    // Do nothing...
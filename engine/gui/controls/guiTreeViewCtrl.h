@@ -54,6 +54,11 @@ class GuiTreeViewCtrl : public GuiArrayCtrl
                                                    /// onRenderCell function to optimize
                                                    /// for speed.
 
+         S32                     mTextWidth;             ///< getDisplayTextWidth() in mTextWidthFont,
+         GFont *                 mTextWidthFont;         ///  NULL if it needs measuring again.
+         StringTableEntry        mTextWidthName;         ///< For inspector data, the names it was
+         StringTableEntry        mTextWidthInternalName; ///  measured with.
+
 
          Item( GuiControlProfile *pProfile );
          ~Item();
@@ -82,6 +87,8 @@ class GuiTreeViewCtrl : public GuiArrayCtrl
          SimObject *getObject();
          const U32 getDisplayTextLength();
          const S32 getDisplayTextWidth(GFont *font);
+         /// getDisplayTextWidth(), only measured again when the text changes.
+         S32 getCachedTextWidth(GFont *font);
          void getDisplayText(U32 bufLen, char *buf);
          /// @}
 
@@ -384,6 +391,8 @@ protected:
 
       /// Returns false if the object is a child of one of the inner items.
       bool childSearch(Item * item, SimObject *obj, bool yourBaby);
+      /// Adds the ids of the objects of all the inspector items under item.
+      void collectChildObjectIds(Item *item, Vector<SimObjectId> &ids);
 
       /// Find immediately available inspector items (eg ones that aren't children of other inspector items)
       /// and then update their sets
@@ -206,7 +206,12 @@ void GuiArrayCtrl::onRender(Point2I offset, const RectI &updateRect)
    //save the original for clipping the row headers
    RectI origClipRect = clipRect;
 
-   for (j = 0; j < mSize.y; j++)
+   //start at the first visible row, big lists can have thousands above it
+   j = 0;
+   if (mCellSize.y > 0 && updateRect.point.y > offset.y)
+      j = getMax((updateRect.point.y - offset.y) / mCellSize.y - 1, 0);
+
+   for (; j < mSize.y; j++)
    {
       //skip until we get to a visible row
       if ((j + 1) * mCellSize.y + offset.y < updateRect.point.y)
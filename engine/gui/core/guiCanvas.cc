@@ -1143,6 +1143,12 @@ void GuiCanvas::maintainSizing()
 
 }
 
+#if defined(TORQUE_OS_WIN32)
+bool GuiCanvas::smLimitRenderAhead = true;
+#else
+bool GuiCanvas::smLimitRenderAhead = false;
+#endif
+
 void GuiCanvas::renderFrame(bool preRenderOnly, bool bufferSwap /* = true */)
 {
    PROFILE_START(CanvasPreRender);
@@ -1232,7 +1238,7 @@ void GuiCanvas::renderFrame(bool preRenderOnly, bool bufferSwap /* = true */)
          GuiControl *contentCtrl = static_cast<GuiControl*>(*i);
          dglSetClipRect(updateUnion);
          glDisable( GL_CULL_FACE );
-         contentCtrl->onRender(contentCtrl->getPosition(), updateUnion);
+         contentCtrl->renderControl(contentCtrl->getPosition(), updateUnion);
       }
 
 	  // Tooltip resource
@@ -1297,11 +1303,12 @@ void GuiCanvas::renderFrame(bool preRenderOnly, bool bufferSwap /* = true */)
    if( bufferSwap )
       swapBuffers();
 
-#if defined(TORQUE_OS_WIN32)
-   PROFILE_START(glFinish);
-   glFinish(); // This was changed to work with the D3D layer -pw
-   PROFILE_END();
-#endif
+   if( smLimitRenderAhead )
+   {
+      PROFILE_START(glFinish);
+      glFinish(); // This was changed to work with the D3D layer -pw
+      PROFILE_END();
+   }
 
 }
 
@@ -177,6 +177,12 @@ public:
    /// flip occured.
    virtual void swapBuffers();
 
+   /// Wait for the GPU after each swap, so the CPU never queues up more
+   /// than the frame it's drawing.  This caps input latency at the cost of
+   /// CPU/GPU overlap.  On by default on Win32, where the D3D layer needs
+   /// it, off elsewhere.
+   static bool smLimitRenderAhead;
+
    /// @}
 
    /// @name Canvas Content Management
@@ -7,8 +7,10 @@
 #include "console/console.h"
 #include "console/consoleInternal.h"
 #include "platform/event.h"
+#include "platform/profiler.h"
 #include "dgl/gBitmap.h"
 #include "dgl/dgl.h"
+#include "dgl/gTexManager.h"
 #include "sim/actionMap.h"
 #include "gui/core/guiCanvas.h"
 #include "gui/core/guiControl.h"
@@ -26,6 +28,10 @@ GuiEditCtrl *GuiControl::smEditorHandle = NULL;
 
 bool GuiControl::smDesignTime = false;
 
+bool GuiControl::smRenderCacheEnabled = true;
+bool GuiControl::smRecordingRenderCache = false;
+U32  GuiControl::smRenderCacheGeneration = 0;
+
 GuiControl::GuiControl()
 {
    mLayer = 0;
@@ -53,10 +59,15 @@ GuiControl::GuiControl()
    mTooltipProfile      = NULL;
    mTooltip             = StringTable->insert("");
    mTipHoverTime        = 1000;
+   mRenderCache         = false;
+   mRenderCacheList     = 0;
+   mRenderCacheGeneration = 0;
+   mRenderCacheDirty    = true;
 }
 
 GuiControl::~GuiControl()
 {
+   freeRenderCache();
 }
 
 bool GuiControl::onAdd()
@@ -148,6 +159,7 @@ void GuiControl::initPersistFields()
    addField("MinExtent",         TypePoint2I,      Offset(mMinExtent, GuiControl));
    addField("canSave",           TypeBool,         Offset(mCanSave, GuiControl));
    addField("Visible",           TypeBool,         Offset(mVisible, GuiControl));
+   addField("renderCache",       TypeBool,         Offset(mRenderCache, GuiControl));
    addDepricatedField("Modal");
    addDepricatedField("SetFirstResponder");
 
@@ -169,6 +181,12 @@ void GuiControl::initPersistFields()
    endGroup("I18N");
 }
 
+void GuiControl::consoleInit()
+{
+   Con::addVariable("$pref::Gui::renderCache", TypeBool, &smRenderCacheEnabled);
+   TextureManager::registerEventCallback(renderCacheTextureCB, NULL);
+}
+
 // -=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- //
 
 LangTable * GuiControl::getGUILangTable()
@@ -214,6 +232,7 @@ void GuiControl::addObject(SimObject *object)
       return;
 
 	Parent::addObject(object);
+   invalidateRenderCache();
 
    AssertFatal(!ctrl->isAwake(), "GuiControl::addObject: object is already awake before add");
    if(mAwake)
@@ -233,6 +252,7 @@ void GuiControl::removeObject(SimObject *object)
    if (mAwake)
       static_cast<GuiControl*>(object)->sleep();
 	Parent::removeObject(object);
+   invalidateRenderCache();
 }
 
 GuiControl *GuiControl::getParent()
@@ -333,6 +353,8 @@ void GuiControl::resize(const Point2I &newPosition, const Point2I &newExtent)
    setUpdate();
    }
    else {
+      if(newPosition != mBounds.point)
+         invalidateRenderCache();
       mBounds.point = newPosition;
    }
 }
@@ -524,14 +546,92 @@ void GuiControl::renderChildControls(Point2I offset, const RectI &updateRect)
          {
             dglSetClipRect(childClip);
             glDisable(GL_CULL_FACE);
-            ctrl->onRender(childPosition, childClip);
+            ctrl->renderControl(childPosition, childClip);
          }
       }
    }
 }
 
+//----------------------------------------------------------------
+
+void GuiControl::renderCacheTextureCB(const U32, void *)
+{
+   // Either way the texture names the lists bind are gone, and a
+   // resurrection may also come with a new GL context.
+   smRenderCacheGeneration++;
+}
+
+void GuiControl::freeRenderCache()
+{
+   // lists from an old context went with it
+   if(mRenderCacheList && mRenderCacheGeneration == smRenderCacheGeneration)
+      glDeleteLists(mRenderCacheList, 1);
+   mRenderCacheList = 0;
+   mRenderCacheDirty = true;
+}
+
+void GuiControl::invalidateRenderCache()
+{
+   for(GuiControl *ctrl = this; ctrl; ctrl = ctrl->getParent())
+      ctrl->mRenderCacheDirty = true;
+}
+
+void GuiControl::renderControl(Point2I offset, const RectI &updateRect)
+{
+   if(!mRenderCache || !smRenderCacheEnabled || smRecordingRenderCache || smDesignTime)
+   {
+      if(mRenderCacheList && !smRecordingRenderCache)
+         freeRenderCache();
+      onRender(offset, updateRect);
+      return;
+   }
+
+   if(mRenderCacheGeneration != smRenderCacheGeneration)
+   {
+      mRenderCacheList = 0;
+      mRenderCacheGeneration = smRenderCacheGeneration;
+   }
+
+   if(mRenderCacheList && !mRenderCacheDirty &&
+      offset == mRenderCacheOffset && updateRect == mRenderCacheClip)
+   {
+      PROFILE_START(GuiRenderCacheReplay);
+      glCallList(mRenderCacheList);
+      // the list leaves GL with the last clip rect it set
+      dglSetClipRect(updateRect);
+      PROFILE_END();
+      return;
+   }
+
+   if(!mRenderCacheList)
+      mRenderCacheList = glGenLists(1);
+   if(!mRenderCacheList)
+   {
+      onRender(offset, updateRect);
+      return;
+   }
+
+   // Cleared first, so a control that asks for an update while it renders
+   // is simply recorded again next frame.
+   mRenderCacheDirty = false;
+   mRenderCacheOffset = offset;
+   mRenderCacheClip = updateRect;
+
+   // Compile and execute, so anything uploaded while recording (font
+   // pages, say) takes effect now too.
+   PROFILE_START(GuiRenderCacheRecord);
+   smRecordingRenderCache = true;
+   glNewList(mRenderCacheList, GL_COMPILE_AND_EXECUTE);
+   onRender(offset, updateRect);
+   glEndList();
+   smRecordingRenderCache = false;
+   PROFILE_END();
+}
+
 void GuiControl::setUpdateRegion(Point2I pos, Point2I ext)
 {
+   invalidateRenderCache();
+
    Point2I upos = localToGlobalCoord(pos);
    GuiCanvas *root = getRoot();
    if (root)
@@ -594,6 +694,8 @@ void GuiControl::sleep()
    AssertFatal(mAwake, "GuiControl::sleep: should not be asleep here");
    if(mAwake)
       onSleep();
+
+   freeRenderCache();
 }
 
 void GuiControl::preRender()
@@ -721,6 +823,7 @@ void GuiControl::setControlProfile(GuiControlProfile *prof)
    mProfile = prof;
    if(mAwake)
       mProfile->incRefCount();
+   invalidateRenderCache();
 
 }
 
@@ -62,6 +62,18 @@ private:
    StringTableEntry mClassName;
    StringTableEntry mSuperClassName;
 
+   U32     mRenderCacheList;         ///< GL display list, 0 if none.
+   U32     mRenderCacheGeneration;   ///< smRenderCacheGeneration it was recorded in.
+   bool    mRenderCacheDirty;
+   Point2I mRenderCacheOffset;       ///< What it was recorded with.
+   RectI   mRenderCacheClip;
+
+   static U32  smRenderCacheGeneration; ///< Bumped whenever the GL lists and textures are lost.
+   static bool smRecordingRenderCache;  ///< Lists don't nest, children just go in the parent's.
+
+   static void renderCacheTextureCB(const U32 eventCode, void *userData);
+   void freeRenderCache();
+
 public:
 
     /// @name Control State
@@ -88,6 +100,21 @@ public:
     static bool smDesignTime; ///< static GuiControl boolean that specifies if the GUI Editor is active
     /// @}
 
+    /// @name Render Cache
+    ///
+    /// A control with renderCache set records its rendering, children and
+    /// all, in a GL display list and just replays it while nothing in it
+    /// changes.  This is meant for static subtrees drawn over a GuiTSCtrl,
+    /// like the chat history, scoreboards and menus, which would otherwise
+    /// be drawn from scratch every frame.  The list is recorded again when
+    /// the control or one of its children calls setUpdate(), is resized or
+    /// moved, or when the clip rect it's drawn with changes, so it must
+    /// not be set on anything that animates without telling anyone.
+    /// @{
+    bool    mRenderCache;
+    static bool smRenderCacheEnabled;   ///< $pref::Gui::renderCache
+    /// @}
+
     /// @name Design Time Editor Access
     /// @{
     static GuiEditCtrl *smEditorHandle; ///< static GuiEditCtrl pointer that gives controls access to editor-NULL if editor is closed
@@ -199,6 +226,7 @@ public:
     GuiControl();
     virtual ~GuiControl();
     static void initPersistFields();
+    static void consoleInit();
     /// @}
 
     /// @name Accessors
@@ -334,6 +362,15 @@ public:
     /// @param   updateRect   The screen area this control has drawing access to
     void renderChildControls(Point2I offset, const RectI &updateRect);
 
+    /// Renders the control through its render cache if it has one,
+    /// otherwise just calls onRender().
+    void renderControl(Point2I offset, const RectI &updateRect);
+
+    /// Marks the render cache of this control and its parents out of
+    /// date.  setUpdate() does this, call it directly when a control
+    /// changes without asking for a redraw.
+    void invalidateRenderCache();
+
     /// Sets the area (local coordinates) this control wants refreshed each frame
     /// @param   pos   UpperLeft point on rectangle of refresh area
     /// @param   ext   Extent of update rect
@@ -156,7 +156,7 @@ void GuiInspector::inspectObject( SimObject *object )
    // If the general group is still empty at this point, kill it.
    for(S32 i=0; i<mGroups.size(); i++)
    {
-      if(mGroups[i] == general && general->mStack->size() == 0)
+      if(mGroups[i] == general && !general->hasFields())
       {
          mGroups.erase(i);
          general->deleteObject();
@@ -487,6 +487,8 @@ void GuiInspectorField::resize( const Point2I &newPosition, const Point2I &newEx
 //
 IMPLEMENT_CONOBJECT(GuiInspectorGroup);
 
+Vector<StringTableEntry> GuiInspectorGroup::smCollapsedGroups;
+
 GuiInspectorGroup::GuiInspectorGroup()
 {
    mBounds.set(0,0,200,20);
@@ -503,6 +505,8 @@ GuiInspectorGroup::GuiInspectorGroup()
    mAnimateDestHeight   = mBarWidth.y;
    mAnimateStep         = 1;
    mCanSave             = false;
+   mStack               = NULL;
+   mFieldsDirty         = false;
 
    // Make sure we receive our ticks.
    setProcessTicks();
@@ -525,6 +529,12 @@ GuiInspectorGroup::GuiInspectorGroup( SimObjectPtr<SimObject> target, StringTabl
    mTarget              = target;
    mParent              = parent;
    mCanSave             = false;
+   mStack               = NULL;
+   mFieldsDirty         = false;
+
+   for( S32 i = 0; i < smCollapsedGroups.size(); i++ )
+      if( smCollapsedGroups[i] == mCaption )
+         mIsExpanded = false;
 }
 
 GuiInspectorGroup::~GuiInspectorGroup()
@@ -564,6 +574,9 @@ bool GuiInspectorGroup::onAdd()
    mStack->setField( "padding", "1.0" );
    mStack->resize( mBarWidth + Point2I(1,1), mBounds.extent - ( mBarWidth + Point2I(1,1) ) );
 
+   if( !mIsExpanded )
+      setHeight( mBarWidth.y );
+
    inspectGroup();
 
    return true;
@@ -586,7 +599,15 @@ void GuiInspectorGroup::onMouseDown( const GuiEvent &event )
    if( captionRect.pointInRect( globalToLocalCoord( event.mousePoint ) ) && !mIsAnimating )
    {
       if( !mIsExpanded )
+      {
+         // Build what was left for later first, the height depends on it.
+         if( mFieldsDirty )
+         {
+            mFieldsDirty = false;
+            buildFields();
+         }
          animateTo( getExpandedHeight() );
+      }
       else
          animateTo( mBarWidth.y );
    }
@@ -670,7 +691,15 @@ void GuiInspectorGroup::processTick()
          mBounds.extent.y -= mAnimateStep;
 
       if( !mIsAnimating )
+      {
          mIsExpanded = false;
+
+         bool bKnown = false;
+         for( S32 i = 0; i < smCollapsedGroups.size() && !bKnown; i++ )
+            bKnown = ( smCollapsedGroups[i] == mCaption );
+         if( !bKnown )
+            smCollapsedGroups.push_back( mCaption );
+      }
    }
    else // We're expanding ourself (Showing our contents)
    {
@@ -685,7 +714,12 @@ void GuiInspectorGroup::processTick()
          mBounds.extent.y += mAnimateStep;
 
       if( !mIsAnimating )
+      {
          mIsExpanded = true;
+         for( S32 i = 0; i < smCollapsedGroups.size(); i++ )
+            if( smCollapsedGroups[i] == mCaption )
+               smCollapsedGroups.erase_fast( i-- );
+      }
    }
 
    GuiControl* parent = getParent();
@@ -797,6 +831,61 @@ GuiInspectorField *GuiInspectorGroup::findField( StringTableEntry fieldName )
 }
 
 bool GuiInspectorGroup::inspectGroup()
+{
+   // We can't inspect a group without a target!
+   if( !mTarget )
+      return false;
+
+   // Nobody can see the fields of a collapsed group, so don't make or
+   // update any until it's opened.
+   if( !isShowingFields() )
+   {
+      mFieldsDirty = true;
+      return true;
+   }
+
+   mFieldsDirty = false;
+   return buildFields();
+}
+
+bool GuiInspectorGroup::hasFields()
+{
+   if( !mFieldsDirty )
+      return !mChildren.empty();
+
+   if( !mTarget )
+      return false;
+
+   // Same grouping rules as buildFields().
+   bool bNoGroup = ( dStricmp( mCaption, "General" ) == 0 );
+   bool bGrabItems = false;
+
+   AbstractClassRep::FieldList &fieldList = mTarget->getModifiableFieldList();
+   AbstractClassRep::FieldList::iterator itr;
+   for(itr = fieldList.begin(); itr != fieldList.end(); itr++)
+   {
+      if( itr->type == AbstractClassRep::StartGroupFieldType || itr->type == AbstractClassRep::EndGroupFieldType )
+      {
+         bool bStart = ( itr->type == AbstractClassRep::StartGroupFieldType );
+         if( bNoGroup == true )
+            bGrabItems = bStart;
+         else if( itr->pGroupname != NULL && dStricmp( itr->pGroupname, mCaption ) == 0 )
+            bGrabItems = bStart;
+         continue;
+      }
+
+      if( itr->type == AbstractClassRep::DepricatedFieldType )
+         continue;
+
+      // General takes what's outside every group, the rest what's inside theirs.
+      if( bNoGroup != bGrabItems )
+         return true;
+   }
+
+   return false;
+}
+
+bool GuiInspectorGroup::buildFields()
 {
    // We can't inspect a group without a target!
    if( !mTarget )
@@ -814,6 +903,9 @@ bool GuiInspectorGroup::inspectGroup()
    bool bGrabItems = false;
    bool bNewItems = false;
 
+   // Lay the stack out once when we're done, not once per new field.
+   mStack->freeze( true );
+
    for(itr = fieldList.begin(); itr != fieldList.end(); itr++)
    {
       if( itr->type == AbstractClassRep::StartGroupFieldType )
@@ -918,6 +1010,8 @@ bool GuiInspectorGroup::inspectGroup()
       }
    }
 
+   mStack->freeze( false );
+
    // If we've no new items, there's no need to resize anything!
    if( bNewItems == false && !mChildren.empty() )
       return true;
@@ -936,7 +1030,7 @@ bool GuiInspectorGroup::inspectGroup()
 //////////////////////////////////////////////////////////////////////////
 // GuiInspectorDynamicGroup - inspectGroup override
 //////////////////////////////////////////////////////////////////////////
-bool GuiInspectorDynamicGroup::inspectGroup()
+bool GuiInspectorDynamicGroup::buildFields()
 {
    // We can't inspect a group without a target!
    if( !mTarget )
@@ -947,6 +1041,8 @@ bool GuiInspectorDynamicGroup::inspectGroup()
    // over existent fields and making sure they still exist, if not, deleting them.
    clearFields();
 
+   mStack->freeze( true );
+
    // Then populate with fields
    SimFieldDictionary * fieldDictionary = mTarget->getFieldDictionary();
    for(SimFieldDictionaryIterator ditr(fieldDictionary); *ditr; ++ditr)
@@ -963,6 +1059,8 @@ bool GuiInspectorDynamicGroup::inspectGroup()
       }
    }
 
+   mStack->freeze( false );
+
    if( mIsExpanded && getHeight() != getExpandedHeight() )
       setHeight( getExpandedHeight() );
 
@@ -134,6 +134,12 @@ public:
    SimObjectPtr<GuiInspector>   mParent;
    Vector<GuiInspectorField*>          mChildren;
    GuiStackControl*                    mStack;
+   bool                                mFieldsDirty;  ///< Inspected while collapsed, fields are built on expand.
+
+   /// Captions of the groups the user has collapsed; those start collapsed
+   /// the next time any object is inspected, and never build their fields
+   /// until they're opened.
+   static Vector<StringTableEntry>     smCollapsedGroups;
 
    // Constructor/Destructor/Conobject Declaration
    GuiInspectorGroup();
@@ -167,7 +173,18 @@ public:
    SimObjectPtr<GuiInspector> getContentCtrl() { return mParent; };
 
    bool onAdd();
-   virtual bool inspectGroup();
+
+   /// Refreshes the fields if they're showing, otherwise leaves them to
+   /// be built when the group is expanded.
+   bool inspectGroup();
+
+   /// Builds or refreshes the field controls.
+   virtual bool buildFields();
+
+   /// True if the target has any fields for this group, built or not.
+   bool hasFields();
+
+   bool isShowingFields() { return mIsExpanded || ( mIsAnimating && !mCollapsing ); }
 
 };
 
@@ -209,10 +226,10 @@ public:
    GuiInspectorDynamicGroup( SimObjectPtr<SimObject> target, StringTableEntry groupName, SimObjectPtr<GuiInspector> parent ) : GuiInspectorGroup( target, groupName, parent) {};
    
    //////////////////////////////////////////////////////////////////////////
-   // inspectGroup is overridden in GuiInspectorDynamicGroup to inspect an 
+   // buildFields is overridden in GuiInspectorDynamicGroup to inspect an 
    // objects FieldDictionary (dynamic fields) instead of regular persistent
    // fields.
-   bool inspectGroup();
+   bool buildFields();
 
    // For scriptable dynamic field additions
    void addDynamicField();
@@ -0,0 +1,88 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "console/console.h"
+#include "console/consoleTypes.h"
+#include "dgl/dgl.h"
+#include "core/frameStats.h"
+
+#include "gui/game/guiFrameStatsCtrl.h"
+
+IMPLEMENT_CONOBJECT(GuiFrameStatsCtrl);
+
+GuiFrameStatsCtrl::GuiFrameStatsCtrl()
+{
+   mStats = StringTable->insert("");
+   mShowRates = false;
+}
+
+void GuiFrameStatsCtrl::initPersistFields()
+{
+   Parent::initPersistFields();
+   addField("stats",     TypeString, Offset(mStats,     GuiFrameStatsCtrl));
+   addField("showRates", TypeBool,   Offset(mShowRates, GuiFrameStatsCtrl));
+}
+
+bool GuiFrameStatsCtrl::isShown(const char *name)
+{
+   if(!mStats[0])
+      return true;
+
+   U32 len = dStrlen(name);
+   for(const char *walk = mStats; *walk; )
+   {
+      while(*walk == ' ')
+         walk++;
+
+      const char *end = walk;
+      while(*end && *end != ' ')
+         end++;
+
+      if(U32(end - walk) == len && !dStrnicmp(walk, name, len))
+         return true;
+
+      walk = end;
+   }
+   return false;
+}
+
+void GuiFrameStatsCtrl::onRender(Point2I offset, const RectI &updateRect)
+{
+   RectI ctrlRect(offset, mBounds.extent);
+
+   if(mProfile->mOpaque)
+      dglDrawRectFill(ctrlRect, mProfile->mFillColor);
+   if(mProfile->mBorder)
+      dglDrawRect(ctrlRect, mProfile->mBorderColor);
+
+   GFont *font = mProfile->mFont;
+   if(font)
+   {
+      dglSetBitmapModulation(mProfile->mFontColor);
+
+      Point2I pos = offset + mProfile->mTextOffset;
+      S32 valueX = pos.x + mBounds.extent.x / 2;
+      S32 bottom = offset.y + mBounds.extent.y - font->getHeight();
+
+      char buffer[64];
+      for(U32 i = 0; i < FrameStats::getNumStats() && pos.y <= bottom; i++)
+      {
+         const FrameStats::Stat &stat = FrameStats::getStatByIndex(i);
+         if(!isShown(stat.mName))
+            continue;
+
+         if(mShowRates && stat.mType == FrameStats::Counter)
+            dSprintf(buffer, sizeof(buffer), "%.1f", stat.mRate);
+         else
+            dSprintf(buffer, sizeof(buffer), "%d", stat.mFrame);
+
+         dglDrawText(font, pos, stat.mName);
+         dglDrawText(font, Point2I(valueX, pos.y), buffer);
+         pos.y += font->getHeight();
+      }
+   }
+
+   renderChildControls(offset, updateRect);
+}
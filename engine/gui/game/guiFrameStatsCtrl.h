@@ -0,0 +1,38 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _GUIFRAMESTATSCTRL_H_
+#define _GUIFRAMESTATSCTRL_H_
+
+#ifndef _GUICONTROL_H_
+#include "gui/core/guiControl.h"
+#endif
+
+/// Draws the frame stats, one per line, as "name  value".
+///
+/// Counters show their count for the last frame, or their average per
+/// second if showRates is set; gauges show their value.
+///
+/// @see FrameStats
+class GuiFrameStatsCtrl : public GuiControl
+{
+private:
+   typedef GuiControl Parent;
+
+   /// Space separated names of the stats to show, or empty for all.
+   StringTableEntry mStats;
+   bool mShowRates;
+
+   bool isShown(const char *name);
+
+public:
+   DECLARE_CONOBJECT(GuiFrameStatsCtrl);
+   GuiFrameStatsCtrl();
+   static void initPersistFields();
+
+   void onRender(Point2I offset, const RectI &updateRect);
+};
+
+#endif
@@ -180,6 +180,9 @@ void GuiMessageVectorCtrl::lineInserted(const U32 arg)
    resize(mBounds.point, Point2I(mBounds.extent.x, newHeight));
    if(fullyScrolled)
       pScroll->scrollTo(0, 0x7FFFFFFF);
+
+   // the height doesn't change for the first line
+   setUpdate();
 }
 
 
@@ -224,6 +227,7 @@ void GuiMessageVectorCtrl::lineDeleted(const U32 arg)
 
    U32 newHeight = (mProfile->mFont->getHeight() + mLineSpacingPixels) * getMax(numLines, U32(1));
    resize(mBounds.point, Point2I(mBounds.extent.x, newHeight));
+   setUpdate();
 }
 
 
@@ -6,6 +6,7 @@
 #include "platform/platform.h"
 #include "core/stream.h"
 #include "core/fileStream.h"
+#include "core/memstream.h"
 #include "core/resManager.h"
 #include "console/console.h"
 #include "console/consoleInternal.h"
@@ -19,6 +20,19 @@
 // LangFile Class
 //////////////////////////////////////////////////////////////////////////
 
+// Old .lso files are just the strings, length prefixed, so
+// the first byte of one is never going to be an 'L' followed by this.
+static const char csLangMagic[4] = { 'L', 'S', 'O', '2' };
+
+static U32 appendString(Vector<UTF8> &pool, const UTF8 *str)
+{
+	U32 offset = pool.size();
+	U32 len = dStrlen(str) + 1;
+	pool.setSize(offset + len);
+	dMemcpy(pool.address() + offset, str, len);
+	return offset;
+}
+
 LangFile::LangFile(const UTF8 *langName /* = NULL */)
 {
 	if(langName)
@@ -30,6 +44,11 @@ LangFile::LangFile(const UTF8 *langName /* = NULL */)
 		mLangName = NULL;
 
 	mLangFile = NULL;
+
+	mPool = NULL;
+	mOffsets = NULL;
+	mNumStrings = 0;
+	mMapStream = NULL;
 }
 
 LangFile::~LangFile()
@@ -45,13 +64,44 @@ LangFile::~LangFile()
 
 void LangFile::freeTable()
 {
+	if(mMapStream)
+	{
+		ResourceManager->closeStream(mMapStream);
+		mMapStream = NULL;
+	}
+	mStringPool.clear();
+	mStringOffsets.clear();
+	updateTable();
+}
+
+void LangFile::updateTable()
+{
+	mPool = mStringPool.address();
+	mOffsets = mStringOffsets.address();
+	mNumStrings = mStringOffsets.size();
+}
+
+void LangFile::makeWritable()
+{
+	if(! mMapStream)
+		return;
+
+	// Copy the mapped table out so it can be added to
+	Stream *mapStream = mMapStream;
+	mMapStream = NULL;
+
+	mStringPool.clear();
+	mStringOffsets.setSize(mNumStrings);
 	U32 i;
-	for(i = 0;i < mStringTable.size();i++)
+	for(i = 0;i < mNumStrings;i++)
 	{
-		if(mStringTable[i])
-			delete [] mStringTable[i];
+		if(mOffsets[i] == LANG_INVALID_ID)
+			mStringOffsets[i] = LANG_INVALID_ID;
+		else
+			mStringOffsets[i] = appendString(mStringPool, mPool + mOffsets[i]);
 	}
-	mStringTable.clear();
+	ResourceManager->closeStream(mapStream);
+	updateTable();
 }
 
 bool LangFile::load(const UTF8 *filename)
@@ -61,16 +111,107 @@ bool LangFile::load(const UTF8 *filename)
 
 	if(pS = ResourceManager->openStream((const char*)filename))
 	{
-		bRet = load(pS);
-		ResourceManager->closeStream(pS);
+		bRet = read(pS, true);
+		if(mMapStream != pS)
+			ResourceManager->closeStream(pS);
 	}
 	return bRet;
 }
 
 bool LangFile::load(Stream *s)
+{
+	return read(s, false);
+}
+
+bool LangFile::read(Stream *s, bool keepMapping)
 {
 	freeTable();
-	
+
+	char magic[4];
+	if(! s->read(sizeof(magic), magic))
+		return false;
+
+	if(dMemcmp(magic, csLangMagic, sizeof(magic)))
+	{
+		// An old .lso: put back what was taken for the tag and read it as
+		// it always was
+		U32 size = s->getStreamSize() - s->getPosition();
+		U8 *buffer = new U8 [size + sizeof(magic)];
+		dMemcpy(buffer, magic, sizeof(magic));
+		bool ok = s->read(size, buffer + sizeof(magic));
+		if(ok)
+		{
+			MemStream legacy(size + sizeof(magic), buffer, true, false);
+			ok = loadLegacy(&legacy);
+		}
+		delete [] buffer;
+		return ok;
+	}
+
+	U32 numStrings, poolSize;
+	if(! s->read(&numStrings) || ! s->read(&poolSize) || numStrings == 0)
+		return false;
+
+	const U32 *offsets = NULL;
+	const UTF8 *pool = NULL;
+
+#ifdef TORQUE_LITTLE_ENDIAN
+	// Mapped, and no endian flip needed, the table can be used in place
+	if(keepMapping)
+	{
+		U32 pos = s->getPosition();
+		offsets = (const U32 *)s->readDirect(numStrings * sizeof(U32));
+		if(offsets && ! (dsize_t(offsets) & 3))
+			pool = (const UTF8 *)s->readDirect(poolSize);
+		if(! pool)
+		{
+			s->setPosition(pos);
+			offsets = NULL;
+		}
+	}
+#endif
+
+	if(! pool)
+	{
+		mStringOffsets.setSize(numStrings);
+		U32 i;
+		for(i = 0;i < numStrings;i++)
+			if(! s->read(&mStringOffsets[i]))
+				return false;
+
+		mStringPool.setSize(poolSize);
+		if(! s->read(poolSize, mStringPool.address()))
+			return false;
+
+		offsets = mStringOffsets.address();
+		pool = mStringPool.address();
+	}
+
+	// Every string has to end inside the pool
+	bool valid = poolSize > 0 && pool[poolSize - 1] == 0;
+	U32 i;
+	for(i = 0;valid && i < numStrings;i++)
+		valid = offsets[i] == LANG_INVALID_ID || offsets[i] < poolSize;
+	if(! valid)
+	{
+		freeTable();
+		return false;
+	}
+
+	if(pool == mStringPool.address())
+		updateTable();
+	else
+	{
+		mPool = pool;
+		mOffsets = offsets;
+		mNumStrings = numStrings;
+		mMapStream = s;
+	}
+	return true;
+}
+
+bool LangFile::loadLegacy(Stream *s)
+{
 	while(s->getStatus() != Stream::EOS)
 	{
 		char buf[256];
@@ -100,38 +241,41 @@ bool LangFile::save(Stream *s)
 {
 	if(!isLoaded())
 		return false;
-	
+
+	makeWritable();
+
+	if(! s->write(sizeof(csLangMagic), csLangMagic))
+		return false;
+	if(! s->write(mNumStrings) || ! s->write(U32(mStringPool.size())))
+		return false;
+
 	U32 i;
-	for(i = 0;i < mStringTable.size();i++)
+	for(i = 0;i < mNumStrings;i++)
 	{
-		s->writeString((char*)mStringTable[i]);
+		if(! s->write(mStringOffsets[i]))
+			return false;
 	}
-	return true;
-}
-
-const UTF8 * LangFile::getString(U32 id)
-{
-	if(id == LANG_INVALID_ID || id >= mStringTable.size())
-		return NULL;
-	return mStringTable[id];
+	return s->write(mStringPool.size(), mStringPool.address());
 }
 
 U32 LangFile::addString(const UTF8 *str)
 {
-	UTF8 *newstr = new UTF8 [dStrlen(str) + 1];
-	dStrcpy(newstr, str);
-	mStringTable.push_back(newstr);
-	return mStringTable.size() - 1;
+	makeWritable();
+	mStringOffsets.push_back(appendString(mStringPool, str));
+	updateTable();
+	return mNumStrings - 1;
 }
 
 void LangFile::setString(U32 id, const UTF8 *str)
 {
-	if(id >= mStringTable.size())
-		mStringTable.setSize(id+1);
+	makeWritable();
+	U32 i;
+	for(i = mStringOffsets.size();i <= id;i++)
+		mStringOffsets.push_back(LANG_INVALID_ID);
 
-	UTF8 *newstr = new UTF8 [dStrlen(str) + 1];
-	dStrcpy(newstr, str);
-	mStringTable[id] = newstr;
+	// A replaced string's old copy just stays in the pool
+	mStringOffsets[id] = appendString(mStringPool, str);
+	updateTable();
 }
 
 void LangFile::setLangName(const UTF8 *newName)
@@ -166,7 +310,9 @@ bool LangFile::activateLanguage()
 
 void LangFile::deactivateLanguage()
 {
-	if(mLangFile && isLoaded())
+	// A mapped table only costs address space, so it's kept for when the
+	// language is switched back to
+	if(mLangFile && isLoaded() && ! mMapStream)
 		freeTable();
 }
 
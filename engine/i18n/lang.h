@@ -16,17 +16,42 @@
 
 #define LANG_INVALID_ID		0xffffffff		///!< Invalid ID. Used for returning failure
 
+class Stream;
+
 //////////////////////////////////////////////////////////////////////////
 /// \brief Class for working with language files
+///
+/// The strings are one pool of null terminated strings and a table of
+/// offsets into it, so getString() is an index.  A compiled .lso is the
+/// same thing: a magic tag, the string count, the pool size, the offsets
+/// (LANG_INVALID_ID for ids with no string) and then the pool.  When the
+/// ResManager hands out a memory mapped stream for it the table is used
+/// straight out of the mapping, and it stays mapped while the language is
+/// inactive, so switching back to it costs nothing.  Old .lso files of
+/// length prefixed strings still load.
 //////////////////////////////////////////////////////////////////////////
 class LangFile
 {
 protected:
-	Vector<UTF8 *> mStringTable;
+	const UTF8 *mPool;
+	const U32 *mOffsets;
+	U32 mNumStrings;
+
+	/// The pool and offsets when they're copied in or being built.
+	Vector<UTF8> mStringPool;
+	Vector<U32> mStringOffsets;
+
+	/// The mapped stream mPool and mOffsets point into, if they do.
+	Stream *mMapStream;
+
 	UTF8 * mLangName;
 	UTF8 * mLangFile;
 
 	void freeTable();
+	void makeWritable();
+	void updateTable();
+	bool read(Stream *s, bool keepMapping);
+	bool loadLegacy(Stream *s);
 
 public:
 	LangFile(const UTF8 *langName = NULL);
@@ -38,7 +63,12 @@ public:
 	bool load(Stream *s);
 	bool save(Stream *s);
 
-	const UTF8 * getString(U32 id);
+	const UTF8 * getString(U32 id) const
+	{
+		if(id >= mNumStrings || mOffsets[id] == LANG_INVALID_ID)
+			return NULL;
+		return mPool + mOffsets[id];
+	}
 	U32 addString(const UTF8 *str);
 	
 	// [tom, 4/22/2005] setString() added to help the language compiler a bit
@@ -52,9 +82,9 @@ public:
 	bool activateLanguage(void);
 	void deactivateLanguage(void);
 
-	bool isLoaded(void)						{ return mStringTable.size() > 0; }
+	bool isLoaded(void)						{ return mNumStrings > 0; }
 	
-	S32 getNumStrings(void)					{ return mStringTable.size(); }
+	S32 getNumStrings(void)					{ return mNumStrings; }
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -27,7 +27,16 @@ bool Interior::smRenderEnvironmentMaps = true;
 bool Interior::smUseVertexLighting     = false;
 bool Interior::smUseTexturedFog        = false;
 bool Interior::smLockArrays            = true;
+bool Interior::smUseVertexBuffers      = true;
+U32  Interior::smBufferGeneration      = 1;
 bool Interior::smLightingCastRays      = false;
+bool Interior::smWriteHullTree         = true;
+bool Interior::smUseLoadCache          = true;
+F32  Interior::smZoneCacheTolerance    = 0.01f;
+
+/// How far the rotation part of the modelview may drift and still use a
+/// cached zone traversal.
+static const F32 csmZoneCacheAngleTolerance = 0.0001f;
 
 // These are setup by setupActivePolyList
 U16*            sgActivePolyList      = NULL;
@@ -38,6 +47,10 @@ U16*            sgFogPolyList         = NULL;
 U32             sgFogPolyListSize     = 0;
 bool            sgFogActive           = false;
 
+// Zones the active polys came from, for the vertex buffer render
+U16*            sgActiveZoneList      = NULL;
+U32             sgActiveZoneListSize  = 0;
+
 // Always the same size as the mPoints array
 Point2F*        sgFogTexCoords        = NULL;
 
@@ -50,14 +63,6 @@ class PlaneRange
 
 namespace {
 
-struct PortalRenderInfo
-{
-   bool  render;
-
-   F64   frustum[4];
-   RectI viewport;
-};
-
 //-------------------------------------- Rendering state variables.
 Point3F sgCamPoint;
 F64     sgStoredFrustum[6];
@@ -245,6 +250,10 @@ Interior::Interior()
 
    mPreppedForRender = false;;
 
+   mVertexBufferObject = 0;
+   mIndexBufferObject  = 0;
+   mBufferGeneration   = 0;
+
    mSearchTag = 0;
 
    mLightMapBorderSize = 0;
@@ -277,6 +286,7 @@ Interior::Interior()
    VECTOR_SET_ASSOCIATION(mLightStates);
    VECTOR_SET_ASSOCIATION(mStateData);
    VECTOR_SET_ASSOCIATION(mStateDataBuffer);
+   VECTOR_SET_ASSOCIATION(mLightLayers);
    VECTOR_SET_ASSOCIATION(mNameBuffer);
    VECTOR_SET_ASSOCIATION(mConvexHulls);
    VECTOR_SET_ASSOCIATION(mConvexHullEmitStrings);
@@ -315,6 +325,8 @@ Interior::~Interior()
    delete mLightFalloff;
    mLightFalloff = NULL;
 
+   deleteBufferObjects();
+
    // remove from lightmap manager
    if(mLMHandle != LM_HANDLE(-1))
       gInteriorLMManager.removeInterior(mLMHandle);
@@ -329,6 +341,11 @@ Interior::~Interior()
       mEnvironMaps[i] = NULL;
    }
 
+   for (i = 0; i < mLightLayers.size(); i++) {
+      delete mLightLayers[i];
+      mLightLayers[i] = NULL;
+   }
+
    for (i = 0; i < mSubObjects.size(); i++) {
       delete mSubObjects[i];
       mSubObjects[i] = NULL;
@@ -372,6 +389,7 @@ bool Interior::prepForRendering(const char* path)
       return false;
 
    // lightmap manager steals the lightmaps here...
+   buildLightmapAtlasLayout();
    gInteriorLMManager.addInterior(mLMHandle, mLightmaps.size(), this);
    AssertFatal(!mLightmaps.size(), "Failed to process lightmaps");
 
@@ -428,6 +446,72 @@ void Interior::setupAveTexGenLength()
 }
 
 
+void Interior::buildLightmapAtlasLayout()
+{
+   mLMAtlasRects.setSize(mLightmaps.size());
+   mLMAtlasSizes.clear();
+   if (mLightmaps.size() == 0)
+      return;
+
+   // Tallest first, so the shelves waste as little as possible.  The
+   // lightmaps are padded to powers of two when they're downloaded, and
+   // their texgens are relative to the padded size, so that's what's packed.
+   Vector<U32> order(mLightmaps.size());
+   U32 i;
+   for (i = 0; i < mLightmaps.size(); i++)
+   {
+      AssertFatal(mLightmaps[i], "Interior::buildLightmapAtlasLayout: missing lightmap");
+      mLMAtlasRects[i].width  = getNextPow2(mLightmaps[i]->getWidth());
+      mLMAtlasRects[i].height = getNextPow2(mLightmaps[i]->getHeight());
+
+      U32 j = order.size();
+      order.increment();
+      while (j > 0 && mLMAtlasRects[order[j - 1]].height < mLMAtlasRects[i].height)
+      {
+         order[j] = order[j - 1];
+         j--;
+      }
+      order[j] = i;
+   }
+
+   S32 shelfX = 0;
+   S32 shelfY = 0;
+   S32 shelfHeight = 0;
+   mLMAtlasSizes.push_back(Point2I(0, 0));
+
+   for (i = 0; i < order.size(); i++)
+   {
+      LightmapAtlasRect& rRect = mLMAtlasRects[order[i]];
+
+      if (shelfX != 0 && shelfX + rRect.width > LightmapAtlasSize)
+      {
+         shelfY += shelfHeight;
+         shelfX = 0;
+         shelfHeight = 0;
+      }
+      if (shelfY != 0 && shelfY + rRect.height > LightmapAtlasSize)
+      {
+         mLMAtlasSizes.push_back(Point2I(0, 0));
+         shelfY = 0;
+      }
+
+      rRect.atlas = mLMAtlasSizes.size() - 1;
+      rRect.x     = shelfX;
+      rRect.y     = shelfY;
+
+      shelfX     += rRect.width;
+      shelfHeight = getMax(shelfHeight, S32(rRect.height));
+
+      Point2I& rSize = mLMAtlasSizes.last();
+      rSize.x = getMax(rSize.x, shelfX);
+      rSize.y = getMax(rSize.y, shelfY + S32(rRect.height));
+   }
+
+   for (i = 0; i < mLMAtlasSizes.size(); i++)
+      mLMAtlasSizes[i].set(getNextPow2(mLMAtlasSizes[i].x), getNextPow2(mLMAtlasSizes[i].y));
+}
+
+
 //--------------------------------------------------------------------------
 bool Interior::prepRender(SceneState*    state,
                           S32            containingZone,
@@ -437,7 +521,8 @@ bool Interior::prepRender(SceneState*    state,
                           const Point3F& objScale,
                           const bool     modifyBaseState,
                           const bool     dontRestrictOutside,
-                          const bool     flipClipPlanes)
+                          const bool     flipClipPlanes,
+                          InteriorZoneCache* zoneCache)
 {
    // Store off the viewport and frustum
    if (modifyBaseState || dontRestrictOutside ) {
@@ -475,17 +560,31 @@ bool Interior::prepRender(SceneState*    state,
    finalModelView.mul(OSToWS);
    finalModelView.scale(Point3F(objScale.x, objScale.y, objScale.z));
    sgProjMatrix.mul(finalModelView);
+   MatrixF osToEye = finalModelView;
 
    finalModelView.inverse();
    finalModelView.mulP(Point3F(0.0f, 0.0f, 0.0f), &sgCamPoint);
    sgWSToOSMatrix = finalModelView;
 
-   // do the zone traversal
+   // do the zone traversal, unless it's been done from here already
    if (mZones.size() == 0)
       return false;
 
    sgZoneRenderInfo.setSize(mZones.size());
-   zoneTraversal(baseZone, flipClipPlanes);
+   bool ortho = dglIsOrtho();
+   if (zoneCache && zoneCache->matches(sgCamPoint, osToEye, sgStoredFrustum, sgStoredViewport,
+                                       baseZone, flipClipPlanes, ortho, mZones.size()))
+   {
+      dMemcpy(sgZoneRenderInfo.address(), zoneCache->zones.address(),
+              mZones.size() * sizeof(PortalRenderInfo));
+   }
+   else
+   {
+      zoneTraversal(baseZone, flipClipPlanes);
+      if (zoneCache)
+         zoneCache->store(sgCamPoint, osToEye, sgStoredFrustum, sgStoredViewport,
+                          baseZone, flipClipPlanes, ortho, sgZoneRenderInfo);
+   }
 
    // Copy out the information for all zones but the outside zone.
    for (U32 i = 1; i < mZones.size(); i++) {
@@ -522,6 +621,50 @@ bool Interior::prepRender(SceneState*    state,
 }
 
 
+//------------------------------------------------------------------------------
+bool InteriorZoneCache::matches(const Point3F& cam, const MatrixF& mv, const F64* frust, const RectI& vp,
+                                S32 zone, bool flip, bool orthoView, U32 numZones) const
+{
+   if (!valid || zones.size() != numZones || baseZone != zone || flipClip != flip || ortho != orthoView)
+      return false;
+   if (viewport != vp)
+      return false;
+   for (U32 i = 0; i < 6; i++)
+      if (frustum[i] != frust[i])
+         return false;
+
+   F32 tolerance = Interior::smZoneCacheTolerance;
+   if ((camPoint - cam).lenSquared() > tolerance * tolerance)
+      return false;
+
+   const F32* a = modelview;
+   const F32* b = mv;
+   for (U32 row = 0; row < 3; row++)
+      for (U32 col = 0; col < 3; col++)
+         if (mFabs(a[MatrixF::idx(col, row)] - b[MatrixF::idx(col, row)]) > csmZoneCacheAngleTolerance)
+            return false;
+
+   return true;
+}
+
+void InteriorZoneCache::store(const Point3F& cam, const MatrixF& mv, const F64* frust, const RectI& vp,
+                              S32 zone, bool flip, bool orthoView, const Vector<PortalRenderInfo>& result)
+{
+   camPoint  = cam;
+   modelview = mv;
+   for (U32 i = 0; i < 6; i++)
+      frustum[i] = frust[i];
+   viewport  = vp;
+   baseZone  = zone;
+   flipClip  = flip;
+   ortho     = orthoView;
+
+   zones.setSize(result.size());
+   dMemcpy(zones.address(), result.address(), result.size() * sizeof(PortalRenderInfo));
+   valid = true;
+}
+
+
 void Interior::prepTempRender(SceneState*    state,
                               S32            containingZone,
                               S32            baseZone,
@@ -1108,6 +1251,7 @@ void Interior::setupActivePolyList(ZoneVisDeterminer& zoneDeterminer,
                                    const F32          worldZ,
                                    const Point3F&     scale)
 {
+   sgActiveZoneListSize = 0;
    if (mZones.size() == 0)
       return;
 
@@ -1128,6 +1272,8 @@ void Interior::setupActivePolyList(ZoneVisDeterminer& zoneDeterminer,
    ItrMergeStruct* mergeArray = (ItrMergeStruct*)FrameAllocator::alloc((mZones.size() * 2) * sizeof(ItrMergeStruct));
    U32 numMergeStructs = 0;
 
+   sgActiveZoneList = (U16*)FrameAllocator::alloc(mZones.size() * sizeof(U16));
+
    PROFILE_START(ISAPL_Merge);
    for (U32 i = 0; i < mZones.size(); i++)
    {
@@ -1137,6 +1283,8 @@ void Interior::setupActivePolyList(ZoneVisDeterminer& zoneDeterminer,
       if (mZones[i].surfaceCount == 0)
          continue;
 
+      sgActiveZoneList[sgActiveZoneListSize++] = i;
+
       // Setup the plane directionals
       for (U32 j = mZones[i].planeStart; j < mZones[i].planeStart + mZones[i].planeCount; j++) {
          if (getPlane(mZonePlanes[j]).distToPlane(rPoint) >= 0.0f)
@@ -1481,6 +1629,8 @@ void Interior::purgeLODData()
    mHullEmitStringIndices.clear();
    mHullSurfaceIndices.clear();
    mCoordBinIndices.clear();
+   mHullTree.clear();
+   mHullTreeIndices.clear();
    mConvexHullEmitStrings.clear();
    for (U32 i = 0; i < NumCoordBins * NumCoordBins; i++) {
       mCoordBins[i].binStart = 0;
@@ -2219,3 +2369,41 @@ void Interior::buildSurfaceZones()
 }
 
 
+
+//--------------------------------------------------------------------------
+TextureHandle* Interior::getLightLayer(const U32 stateData)
+{
+   AssertFatal(stateData < mStateData.size(), "Interior::getLightLayer: out of range state data");
+
+   if (mLightLayers.size() != mStateData.size())
+   {
+      mLightLayers.setSize(mStateData.size());
+      for (U32 i = 0; i < mLightLayers.size(); i++)
+         mLightLayers[i] = NULL;
+   }
+
+   if (mLightLayers[stateData] != NULL)
+      return mLightLayers[stateData];
+
+   const LightStateData& rData = mStateData[stateData];
+   if (rData.mapIndex == 0xFFFFFFFF)
+      return NULL;
+
+   const Surface& rSurface = mSurfaces[rData.surfaceIndex];
+   U32 width  = getNextPow2(rSurface.mapSizeX);
+   U32 height = getNextPow2(rSurface.mapSizeY);
+
+   GBitmap* pBitmap = new GBitmap(width, height, false, GBitmap::Luminance);
+   dMemset(pBitmap->getWritableBits(), 0, pBitmap->byteSize);
+
+   const U8* src = &mStateDataBuffer[rData.mapIndex];
+   for (U32 y = 0; y < rSurface.mapSizeY; y++)
+      dMemcpy(pBitmap->getAddress(0, y), src + y * rSurface.mapSizeX, rSurface.mapSizeX);
+
+   // '<interior>_light_<state data index>', the bitmap is kept so the
+   //  texture can come back after a device reset
+   char name[256];
+   dSprintf(name, sizeof(name), "%p_light_%d", this, stateData);
+   mLightLayers[stateData] = new TextureHandle(name, pBitmap, BitmapKeepTexture, true);
+   return mLightLayers[stateData];
+}
@@ -34,6 +34,12 @@
 #ifndef _MSPHERE_H_
 #include "math/mSphere.h"
 #endif
+#ifndef _MMATRIX_H_
+#include "math/mMatrix.h"
+#endif
+#ifndef _MRECT_H_
+#include "math/mRect.h"
+#endif
 #ifndef _CONVEX_H_
 #include "collision/convex.h"
 #endif
@@ -71,6 +77,24 @@ class LightInfo;
 class PlaneRange;
 class EditInteriorResource;
 
+//--------------------------------------------------------------------------
+/// Load time work saved next to a .dif, in <name>.dif.cache (see
+/// constructInteriorDIF): the decoded lightmaps and the hull tree of each
+/// interior, in the order they're read, so a load only has to step over
+/// the PNGs.  The cache carries the CRC of the .dif it came from and is
+/// rewritten whenever that doesn't match.  Only one of in or out is set.
+struct InteriorLoadCache
+{
+   enum Constants
+   {
+      Magic   = 0x43464944,   ///< "DIFC"
+      Version = 1
+   };
+
+   Stream* in;
+   Stream* out;
+};
+
 //--------------------------------------------------------------------------
 class InteriorConvex : public Convex
 {
@@ -154,6 +178,45 @@ struct ItrPaddedPoint
 //
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+/// What the zone traversal found for one zone: whether it's seen, and
+/// the frustum and viewport it's seen through.
+struct PortalRenderInfo
+{
+   bool  render;
+
+   F64   frustum[4];
+   RectI viewport;
+};
+
+/// An InteriorInstance's last zone traversal, and what it was from.
+///
+/// If the next Interior::prepRender() on it starts in the same zone, with
+/// the same frustum and viewport, and the camera has moved less than
+/// Interior::smZoneCacheTolerance (object space) and hardly turned, the
+/// zones it found are reused instead of walking the portals again.  The
+/// instance invalidates it when it moves.
+struct InteriorZoneCache
+{
+   bool     valid;
+   Point3F  camPoint;         ///< Object space.
+   MatrixF  modelview;        ///< Object to eye space, scale and all.
+   F64      frustum[6];
+   RectI    viewport;
+   S32      baseZone;
+   bool     flipClip;
+   bool     ortho;
+   Vector<PortalRenderInfo> zones;
+
+   InteriorZoneCache() : valid(false) { }
+   void invalidate()                  { valid = false; }
+
+   bool matches(const Point3F& cam, const MatrixF& mv, const F64* frust, const RectI& vp,
+                S32 zone, bool flip, bool orthoView, U32 numZones) const;
+   void store(const Point3F& cam, const MatrixF& mv, const F64* frust, const RectI& vp,
+              S32 zone, bool flip, bool orthoView, const Vector<PortalRenderInfo>& result);
+};
+
 //------------------------------------------------------------------------------
 class Interior
 {
@@ -205,7 +268,8 @@ public:
                    const Point3F& objScale,
                    const bool     modifyBaseState,
                    const bool     dontRestrictOutside,
-                   const bool     flipClipPlanes);
+                   const bool     flipClipPlanes,
+                   InteriorZoneCache* zoneCache = NULL);
    void prepTempRender(SceneState*    state,
                        S32            containingZone,
                        S32            baseZone,
@@ -228,6 +292,7 @@ public:
                         const Vector<ColorI>* alarmVLights);
    void renderARB(const bool useAlarmLighting, MaterialList* pMaterials, const LM_HANDLE instanceHandle);
    void renderARB_FC(const bool useAlarmLighting, MaterialList* pMaterials, const LM_HANDLE instanceHandle);
+   void renderBufferZones(MaterialList* pMaterials, const Vector<TextureHandle*>& atlases);
    void renderLights(LightInfo*     pInfo,
                      const MatrixF& transform,
                      const Point3F& scale,
@@ -252,6 +317,7 @@ public:
    bool getIntersectingVehicleHulls(const Box3F&, U16* hulls, U32* numHulls);
 
 protected:
+
    bool castRay_r(const U16, const U16, const Point3F&, const Point3F&, RayInfo*);
    void buildPolyList_r(InteriorPolytope& polytope,
                         SurfaceHash& hash);
@@ -300,6 +366,9 @@ public:
    {
       NumCoordBins   = 16,
 
+      HullTreeLeafSize = 4,
+      HullTreeMaxDepth = 32,
+
       BinsXY         = 0,
       BinsXZ         = 1,
       BinsYZ         = 2
@@ -311,17 +380,23 @@ public:
    static bool smUseVertexLighting;
    static bool smUseTexturedFog;
    static bool smLockArrays;
+   static bool smUseVertexBuffers;
    static U32  smFileVersion;
    static bool smLightingCastRays;
+   static bool smWriteHullTree;   ///< Save the hull tree in .difs; engines before it can't load them
+
+   static bool smUseLoadCache;    ///< $pref::Interior::loadCache, see InteriorLoadCache
+   static F32  smZoneCacheTolerance; ///< $pref::Interior::zoneCacheTolerance, see InteriorZoneCache
 
    //-------------------------------------- Persistence interface
-   bool read(Stream& stream);
+   bool read(Stream& stream, InteriorLoadCache* cache = NULL);
    bool write(Stream& stream) const;
 
    bool readVehicleCollision(Stream& stream);
    bool writeVehicleCollision(Stream& stream) const;
 
 protected:
+
    bool writePlaneVector(Stream&) const;
    bool readPlaneVector(Stream&);
    bool readLMapTexGen(Stream&, PlaneF&, PlaneF&);
@@ -582,11 +657,39 @@ protected:
       U32   binCount;
    };
 
+   /// Bounding volume tree over a set of convex hulls, built at load for
+   /// the hull queries.  Nodes are stored depth first: an inner node's
+   /// first child comes right after it and the second is at first.  A
+   /// leaf lists count hulls from the tree's indices, starting at first.
+   struct HullTreeNode
+   {
+      Box3F box;
+      U32   first;
+      U32   count;        ///< 0 for inner nodes
+   };
+
+   static Box3F hullBox(const ConvexHull& rHull)
+   {
+      return Box3F(rHull.minX, rHull.minY, rHull.minZ, rHull.maxX, rHull.maxY, rHull.maxZ);
+   }
+
+   static void buildHullTree(const Vector<ConvexHull>& hulls, Vector<HullTreeNode>& nodes, Vector<U16>& indices);
+   static void buildHullTree_r(const Vector<ConvexHull>& hulls, const Vector<Point3F>& centers,
+                               Vector<HullTreeNode>& nodes, Vector<U16>& indices,
+                               U32 start, U32 count, U32 depth);
+   static void queryHullTree(const Vector<ConvexHull>& hulls, const Vector<HullTreeNode>& nodes,
+                             const Vector<U16>& indices, const Box3F& query,
+                             U16* hullList, U32* numHulls);
+
+   bool readHullTree(Stream&);
+   static bool writeHullTree(Stream&, const Vector<HullTreeNode>&, const Vector<U16>&);
+
 protected:
    LM_HANDLE               mLMHandle;
 
 public:
    LM_HANDLE getLMHandle() {return(mLMHandle);}
+   MaterialList* getMaterialList() { return mMaterialList; }
 
    // SceneLighting::InteriorProxy interface
    const Surface & getSurface(const U32 surface) const;
@@ -674,12 +777,91 @@ protected:
 
    U32                     mNumTriggerableLights;        // Note: not persisted
 
+   /// @name Vertex Buffer Rendering
+   /// With ARB_vertex_buffer_object the lightmapped, multitextured render
+   /// draws whole zones out of one static vertex buffer instead of building
+   /// each visible surface on the cpu.  The lightmaps are packed into a few
+   /// large atlases when the interior is prepped, so a zone is a handful of
+   /// draws, one per base texture and atlas.  The buffers belong to the
+   /// Interior and are shared by every instance; the atlas textures belong
+   /// to the instance's lightmap set in the InteriorLMManager.
+   ///
+   /// Back faces are not culled on this path, and alarm lighting and fog
+   /// coordinate fogging still go through the per surface renders.
+   /// @{
+
+   /// Where a lightmap was placed in the atlases.
+   struct LightmapAtlasRect
+   {
+      U16 atlas;
+      U16 x;
+      U16 y;
+      U16 width;     ///< Size of the lightmap's texture, padded to a power of two.
+      U16 height;
+   };
+
+   /// Triangles of one zone with the same base texture and atlas.
+   struct BufferBatch
+   {
+      U32 indexStart;
+      U32 indexCount;
+      U16 textureIndex;
+      U16 atlas;
+   };
+
+   struct BufferZone
+   {
+      U32 batchStart;
+      U32 batchCount;
+   };
+
+   enum { LightmapAtlasSize = 1024 };
+
+   Vector<LightmapAtlasRect> mLMAtlasRects;     ///< One per lightmap.
+   Vector<Point2I>           mLMAtlasSizes;     ///< One per atlas.
+   Vector<BufferBatch>       mBufferBatches;
+   Vector<BufferZone>        mBufferZones;      ///< One per zone.
+
+   U32                     mVertexBufferObject;   ///< OutputPoints, one run per surface.
+   U32                     mIndexBufferObject;
+   U32                     mBufferGeneration;     ///< smBufferGeneration the buffers were made in.
+
+   /// Bumped by the InteriorLMManager when the GL context goes away;
+   /// buffers from an older generation are treated as not created.
+   static U32              smBufferGeneration;
+
+   /// Packs the lightmaps into atlases, must run before the
+   /// InteriorLMManager takes them.
+   void buildLightmapAtlasLayout();
+
+   /// True if buffer objects are on and supported at all.
+   static bool useBufferObjects();
+
+   /// Atlases to draw the instance with, or NULL if this render has to use
+   /// the per surface path.
+   Vector<TextureHandle*>* getBufferAtlases(const bool useAlarmLighting, const LM_HANDLE instanceHandle);
+
+   /// Binds the buffers, making them first if need be.
+   bool bindBufferObjects();
+   static void unbindBufferObjects();
+   void deleteBufferObjects();
+
+   /// @}
+
    // Persistent animated light structures
    Vector<AnimatedLight>   mAnimatedLights;
    Vector<LightState>      mLightStates;
    Vector<LightStateData>  mStateData;
    Vector<U8>              mStateDataBuffer;
 
+   /// The intensity maps of mStateData as textures, one per entry, made
+   /// the first time the entry is drawn as a light layer.
+   Vector<TextureHandle*>  mLightLayers;
+
+   /// Returns the texture of a state data entry's intensity map, or NULL if
+   /// it has none.  The map sits in the corner of a power of two texture.
+   TextureHandle* getLightLayer(const U32 stateData);
+
    Vector<char>            mNameBuffer;
 
    Vector<ConvexHull>      mConvexHulls;
@@ -694,6 +876,8 @@ protected:
    CoordBin                mCoordBins[NumCoordBins * NumCoordBins];
    Vector<U16>             mCoordBinIndices;
    U32                     mCoordBinMode;
+   Vector<HullTreeNode>    mHullTree;
+   Vector<U16>             mHullTreeIndices;
 
    Vector<ConvexHull>      mVehicleConvexHulls;
    Vector<U8>              mVehicleConvexHullEmitStrings;
@@ -709,6 +893,8 @@ protected:
    Vector<PlaneF>          mVehiclePlanes;
    Vector<U32>             mVehicleWindings;
    Vector<TriFan>          mVehicleWindingIndices;
+   Vector<HullTreeNode>    mVehicleHullTree;
+   Vector<U16>             mVehicleHullTreeIndices;
 
    VectorPtr<ConstructorSimpleMesh*> mStaticMeshes;
    
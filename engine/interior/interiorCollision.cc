@@ -175,11 +175,9 @@ void InteriorPolytope::buildBox(const Box3F& box, const MatrixF& transform, cons
    mVertexList[6].point = Point3F(box.max.x, box.max.y, box.max.z);
    mVertexList[7].point = Point3F(box.max.x, box.min.y, box.max.z);
    S32 i;
+   m_matF_x_point3F_array(transform, mVertexList[0].point, mVertexList[0].point, 8, sizeof(mVertexList[0]));
    for (i = 0; i < 8; i++) 
-   {
-      transform.mulP(mVertexList[i].point);
       mVertexList[i].side = 0;
-   }
 
    // Initial faces
    mFaceList.setSize(6);
@@ -1217,6 +1215,12 @@ bool Interior::getIntersectingHulls(const Box3F& query, U16* hulls, U32* numHull
 {
    AssertFatal(*numHulls == 0, "Error, some stuff in the hull vector already!");
 
+   if (mHullTree.size() != 0) 
+   {
+      queryHullTree(mConvexHulls, mHullTree, mHullTreeIndices, query, hulls, numHulls);
+      return *numHulls != 0;
+   }
+
    // This is paranoia, and I probably wouldn't do it if the tag was 32 bits, but
    //  a possible collision every 65k searches is just a little too small for comfort
    // DMM
@@ -1288,6 +1292,12 @@ bool Interior::getIntersectingVehicleHulls(const Box3F& query, U16* hulls, U32*
 {
    AssertFatal(*numHulls == 0, "Error, some stuff in the hull vector already!");
 
+   if (mVehicleHullTree.size() != 0) 
+   {
+      queryHullTree(mVehicleConvexHulls, mVehicleHullTree, mVehicleHullTreeIndices, query, hulls, numHulls);
+      return *numHulls != 0;
+   }
+
    for (U16 i = 0; i < mVehicleConvexHulls.size(); i++)
    {
       ConvexHull& rHull = mVehicleConvexHulls[i];
@@ -1302,6 +1312,139 @@ bool Interior::getIntersectingVehicleHulls(const Box3F& query, U16* hulls, U32*
    return *numHulls != 0;
 }
 
+
+//--------------------------------------------------------------------------
+void Interior::buildHullTree(const Vector<ConvexHull>& hulls, Vector<HullTreeNode>& nodes, Vector<U16>& indices)
+{
+   AssertFatal(hulls.size() <= 65536, "Interior::buildHullTree: too many hulls for U16 indices");
+
+   nodes.clear();
+   indices.setSize(hulls.size());
+   if (hulls.size() == 0)
+      return;
+
+   Vector<Point3F> centers(hulls.size());
+   centers.setSize(hulls.size());
+   for (U32 i = 0; i < hulls.size(); i++) 
+   {
+      indices[i] = i;
+      hullBox(hulls[i]).getCenter(&centers[i]);
+   }
+
+   // A median split tree has a little under 2n/leafSize nodes
+   nodes.reserve(2 * hulls.size() / HullTreeLeafSize + 1);
+   buildHullTree_r(hulls, centers, nodes, indices, 0, hulls.size(), 0);
+}
+
+void Interior::buildHullTree_r(const Vector<ConvexHull>& hulls, const Vector<Point3F>& centers,
+                               Vector<HullTreeNode>& nodes, Vector<U16>& indices,
+                               U32 start, U32 count, U32 depth)
+{
+   U32 node = nodes.size();
+   nodes.increment();
+
+   Box3F box = hullBox(hulls[indices[start]]);
+   Box3F centerBox(centers[indices[start]], centers[indices[start]], true);
+   for (U32 i = start + 1; i < start + count; i++) 
+   {
+      Box3F rBox = hullBox(hulls[indices[i]]);
+      box.min.setMin(rBox.min);
+      box.max.setMax(rBox.max);
+      centerBox.min.setMin(centers[indices[i]]);
+      centerBox.max.setMax(centers[indices[i]]);
+   }
+   nodes[node].box = box;
+
+   if (count <= HullTreeLeafSize || depth >= HullTreeMaxDepth - 1) 
+   {
+      nodes[node].first = start;
+      nodes[node].count = count;
+      return;
+   }
+
+   // Split at the median center along the widest axis of the centers
+   Point3F extent = centerBox.max - centerBox.min;
+   U32 axis = 0;
+   if (extent.y > extent[axis])
+      axis = 1;
+   if (extent.z > extent[axis])
+      axis = 2;
+
+   // Quickselect the median into place
+   U32 half = count / 2;
+   U32 lo = start, hi = start + count - 1;
+   U32 mid = start + half;
+   while (lo < hi) 
+   {
+      F32 pivot = centers[indices[(lo + hi) / 2]][axis];
+      U32 i = lo, j = hi;
+      while (i <= j) 
+      {
+         while (centers[indices[i]][axis] < pivot)
+            i++;
+         while (centers[indices[j]][axis] > pivot)
+            j--;
+         if (i <= j) 
+         {
+            U16 temp = indices[i];
+            indices[i] = indices[j];
+            indices[j] = temp;
+            i++;
+            if (j == 0)
+               break;
+            j--;
+         }
+      }
+      if (mid <= j)
+         hi = j;
+      else if (mid >= i)
+         lo = i;
+      else
+         break;
+   }
+
+   buildHullTree_r(hulls, centers, nodes, indices, start, half, depth + 1);
+   nodes[node].first = nodes.size();
+   nodes[node].count = 0;
+   buildHullTree_r(hulls, centers, nodes, indices, start + half, count - half, depth + 1);
+}
+
+void Interior::queryHullTree(const Vector<ConvexHull>& hulls, const Vector<HullTreeNode>& nodes,
+                             const Vector<U16>& indices, const Box3F& query,
+                             U16* hullList, U32* numHulls)
+{
+   // Each visit pushes at most two nodes, so the stack can't grow past
+   // one more than twice the depth
+   U32 stack[HullTreeMaxDepth * 2 + 1];
+   U32 stackSize = 0;
+   stack[stackSize++] = 0;
+
+   while (stackSize) 
+   {
+      U32 index = stack[--stackSize];
+      const HullTreeNode& rNode = nodes[index];
+      if (!query.isOverlapped(rNode.box))
+         continue;
+
+      if (rNode.count == 0) 
+      {
+         stack[stackSize++] = rNode.first;
+         stack[stackSize++] = index + 1;
+         continue;
+      }
+
+      for (U32 i = rNode.first; i < rNode.first + rNode.count; i++) 
+      {
+         U16 hullIndex = indices[i];
+         if (query.isOverlapped(hullBox(hulls[hullIndex]))) 
+         {
+            hullList[*numHulls] = hullIndex;
+            (*numHulls)++;
+         }
+      }
+   }
+}
+
 //--------------------------------------------------------------------------
 Box3F InteriorConvex::getBoundingBox() const
 {
@@ -1319,28 +1462,17 @@ Box3F InteriorConvex::getBoundingBox(const MatrixF& mat, const Point3F& scale) c
 
 Point3F InteriorConvex::support(const VectorF& v) const
 {
-   FrameAllocatorMarker fam;
-
    if (hullId >= 0)
    {
       AssertFatal(hullId < pInterior->mConvexHulls.size(), "Out of bounds hull!");
 
       const Interior::ConvexHull& rHull = pInterior->mConvexHulls[hullId];
 
-      F32* pDots = (F32*)fam.alloc(sizeof(F32) * rHull.hullCount);
-      m_point3F_bulk_dot_indexed(&v.x,
-                                 &pInterior->mPoints[0].point.x,
-                                 rHull.hullCount,
-                                 sizeof(ItrPaddedPoint),
-                                 &pInterior->mHullIndices[rHull.hullStart],
-                                 pDots);
-
-      U32 index = 0;
-      for (U32 i = 1; i < rHull.hullCount; i++) 
-      {
-         if (pDots[i] > pDots[index])
-            index = i;
-      }
+      U32 index = m_point3F_bulk_max_dot(&v.x,
+                                         &pInterior->mPoints[0].point.x,
+                                         rHull.hullCount,
+                                         sizeof(ItrPaddedPoint),
+                                         &pInterior->mHullIndices[rHull.hullStart]);
 
       return pInterior->mPoints[pInterior->mHullIndices[rHull.hullStart + index]].point;
    }
@@ -1351,20 +1483,11 @@ Point3F InteriorConvex::support(const VectorF& v) const
 
       const Interior::ConvexHull& rHull = pInterior->mVehicleConvexHulls[actualId];
 
-      F32* pDots = (F32*)fam.alloc(sizeof(F32) * rHull.hullCount);
-      m_point3F_bulk_dot_indexed(&v.x,
-                                 &pInterior->mVehiclePoints[0].point.x,
-                                 rHull.hullCount,
-                                 sizeof(ItrPaddedPoint),
-                                 &pInterior->mVehicleHullIndices[rHull.hullStart],
-                                 pDots);
-
-      U32 index = 0;
-      for (U32 i = 1; i < rHull.hullCount; i++) 
-      {
-         if (pDots[i] > pDots[index])
-            index = i;
-      }
+      U32 index = m_point3F_bulk_max_dot(&v.x,
+                                         &pInterior->mVehiclePoints[0].point.x,
+                                         rHull.hullCount,
+                                         sizeof(ItrPaddedPoint),
+                                         &pInterior->mVehicleHullIndices[rHull.hullStart]);
 
       return pInterior->mVehiclePoints[pInterior->mVehicleHullIndices[rHull.hullStart + index]].point;
    }
@@ -1403,8 +1526,8 @@ void InteriorConvex::getFeatures(const MatrixF& mat, const VectorF& n, ConvexFea
       U32 currPos = 0;
       const U8* pString = &pInterior->mConvexHullEmitStrings[pInterior->mHullEmitStringIndices[rHull.hullStart + spIndex]];
 
-      FrameAllocatorMarker fam;
-      U32* pRemaps = (U32*)fam.alloc(256 * sizeof(U32));
+      // On the stack, physics steps may run on worker threads
+      U32 pRemaps[256];
 
       // Ok, this is a piece of cake.  Lets dump the points first...
       U32 numPoints = pString[currPos++];
@@ -1491,8 +1614,8 @@ void InteriorConvex::getFeatures(const MatrixF& mat, const VectorF& n, ConvexFea
                               pInterior->mVehicleHullEmitStringIndices[rHull.hullStart + spIndex]
                            ];
 
-      FrameAllocatorMarker fam;
-      U32* pRemaps = (U32*)fam.alloc(256 * sizeof(U32));
+      // On the stack, physics steps may run on worker threads
+      U32 pRemaps[256];
 
       // Ok, this is a piece of cake.  Lets dump the points first...
       U32 numPoints = pString[currPos++];
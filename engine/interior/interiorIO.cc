@@ -24,7 +24,7 @@ int QSORT_CALLBACK cmpU32(const void* p1, const void* p2)
 //
 U32 Interior::smFileVersion = 13;
 
-bool Interior::read(Stream& stream)
+bool Interior::read(Stream& stream, InteriorLoadCache* cache)
 {
    AssertFatal(stream.hasCapability(Stream::StreamRead), "Interior::read: non-read capable stream passed");
    AssertFatal(stream.getStatus() == Stream::Ok, "Interior::read: Error, stream in inconsistent state");
@@ -298,8 +298,52 @@ bool Interior::read(Stream& stream)
    mLightmaps.setSize(vectorSize);
    mLightDirMaps.setSize(vectorSize);
    mLightmapKeep.setSize(vectorSize);
+
+   // The cache has them decoded, so the PNGs are only stepped over.
+   if (cache && cache->in)
+   {
+      U32 cachedCount;
+      if (!cache->in->read(&cachedCount) || cachedCount != vectorSize)
+         return false;
+   }
+   if (cache && cache->out)
+      cache->out->write(U32(vectorSize));
+
    for(i = 0; i < mLightmaps.size(); i++)
    {
+#ifdef TORQUE_HEADLESS
+      // Nothing draws in a headless build, so the lightmaps are stepped
+      //  over and left NULL.  Only prepForRendering() and the lighting
+      //  code, both client side, look at them.
+      if (!GBitmap::skipPNG(stream) ||
+          ((fileVersion == 1 || fileVersion >= 12) && !GBitmap::skipPNG(stream)))
+         return false;
+      if (cache && cache->in)
+      {
+         GBitmap scratch;
+         if (!scratch.read(*cache->in) || !scratch.read(*cache->in))
+            return false;
+      }
+      mLightmaps[i] = NULL;
+      mLightDirMaps[i] = NULL;
+      stream.read(&mLightmapKeep[i]);
+      continue;
+#endif
+
+      if (cache && cache->in)
+      {
+         if (!GBitmap::skipPNG(stream) ||
+             ((fileVersion == 1 || fileVersion >= 12) && !GBitmap::skipPNG(stream)))
+            return false;
+
+         mLightmaps[i] = new GBitmap;
+         mLightDirMaps[i] = new GBitmap;
+         mLightmaps[i]->read(*cache->in);
+         mLightDirMaps[i]->read(*cache->in);
+         stream.read(&mLightmapKeep[i]);
+         continue;
+      }
+
       mLightmaps[i] = new GBitmap;
       mLightmaps[i]->readPNG(stream);
 
@@ -326,6 +370,12 @@ bool Interior::read(Stream& stream)
       }
 
       stream.read(&mLightmapKeep[i]);
+
+      if (cache && cache->out)
+      {
+         mLightmaps[i]->write(*cache->out);
+         mLightDirMaps[i]->write(*cache->out);
+      }
    }
 
 
@@ -553,9 +603,24 @@ bool Interior::read(Stream& stream)
       //future expansion under current block (avoid using too
       //many of the above expansion slots by allowing nested
       //blocks)...
-      stream.read(&dummy); if (dummy != 0) return false;
+      stream.read(&dummy);
+      if (dummy == 1)
+      {
+         // The hull tree, saved so it needn't be built here
+         if (!readHullTree(stream))
+            return false;
+         stream.read(&dummy); if (dummy != 0) return false;
+      }
+      else if (dummy != 0)
+         return false;
    }
 
+   if (cache && cache->in && !readHullTree(*cache->in))
+      return false;
+   if (mHullTree.size() == 0)
+      buildHullTree(mConvexHulls, mHullTree, mHullTreeIndices);
+   if (cache && cache->out)
+      writeHullTree(*cache->out, mHullTree, mHullTreeIndices);
 
    // Setup the zone planes
    setupZonePlanes();
@@ -962,7 +1027,8 @@ bool Interior::write(Stream& stream) const
    //
    // Support for interior light map border sizes.
    //
-   if(mLightMapBorderSize > 0)
+   bool writeTree = smWriteHullTree && mConvexHulls.size() != 0;
+   if(mLightMapBorderSize > 0 || writeTree)
    {
       stream.write(U32(1));//flag new block...
       stream.write(U32(mLightMapBorderSize));//new block data..
@@ -970,6 +1036,20 @@ bool Interior::write(Stream& stream) const
       //future expansion under current block (avoid using too
       //many of the above expansion slots by allowing nested
       //blocks)...
+      if(writeTree)
+      {
+         stream.write(U32(1));
+         if(mHullTree.size() != 0)
+            writeHullTree(stream, mHullTree, mHullTreeIndices);
+         else
+         {
+            // Built in memory by the exporters, without a load
+            Vector<HullTreeNode> nodes;
+            Vector<U16> indices;
+            buildHullTree(mConvexHulls, nodes, indices);
+            writeHullTree(stream, nodes, indices);
+         }
+      }
       stream.write(U32(0));
    }
    else
@@ -1092,9 +1172,85 @@ bool Interior::readVehicleCollision(Stream& stream)
       stream.read(&mVehicleWindingIndices[i].windingCount);
    }
 
+   // There's nowhere to keep a tree in this block, vehicle hulls are few
+   buildHullTree(mVehicleConvexHulls, mVehicleHullTree, mVehicleHullTreeIndices);
+
    return true;
 }
 
+bool Interior::readHullTree(Stream& stream)
+{
+   U32 i;
+   U32 vectorSize;
+
+   stream.read(&vectorSize);
+   mHullTree.setSize(vectorSize);
+   for(i = 0; i < mHullTree.size(); i++)
+   {
+      mathRead(stream, &mHullTree[i].box);
+      stream.read(&mHullTree[i].first);
+      stream.read(&mHullTree[i].count);
+   }
+
+   stream.read(&vectorSize);
+   mHullTreeIndices.setSize(vectorSize);
+   for(i = 0; i < mHullTreeIndices.size(); i++)
+      stream.read(&mHullTreeIndices[i]);
+
+   if(stream.getStatus() != Stream::Ok)
+      return false;
+
+   // A tree that doesn't match the hulls, say from a file whose hulls
+   // were edited by an older tool, is dropped and built again.
+   bool valid = mHullTreeIndices.size() == mConvexHulls.size();
+   for(i = 0; valid && i < mHullTreeIndices.size(); i++)
+      valid = mHullTreeIndices[i] < mConvexHulls.size();
+   // Children always come after their parent, so depths can be handed
+   // down in one pass; queryHullTree()'s stack is sized by the max depth.
+   Vector<U8> depths(mHullTree.size());
+   depths.setSize(mHullTree.size());
+   if(depths.size())
+      depths[0] = 0;
+   for(i = 0; valid && i < mHullTree.size(); i++)
+   {
+      const HullTreeNode& rNode = mHullTree[i];
+      if(rNode.count == 0)
+      {
+         valid = rNode.first > i + 1 && rNode.first < mHullTree.size() &&
+                 depths[i] < HullTreeMaxDepth - 1;
+         if(valid)
+            depths[i + 1] = depths[rNode.first] = depths[i] + 1;
+      }
+      else
+         valid = rNode.first + rNode.count <= mHullTreeIndices.size();
+   }
+   if(!valid)
+   {
+      mHullTree.clear();
+      mHullTreeIndices.clear();
+   }
+   return true;
+}
+
+bool Interior::writeHullTree(Stream& stream, const Vector<HullTreeNode>& nodes, const Vector<U16>& indices)
+{
+   U32 i;
+
+   stream.write(nodes.size());
+   for(i = 0; i < nodes.size(); i++)
+   {
+      mathWrite(stream, nodes[i].box);
+      stream.write(nodes[i].first);
+      stream.write(nodes[i].count);
+   }
+
+   stream.write(indices.size());
+   for(i = 0; i < indices.size(); i++)
+      stream.write(indices[i]);
+
+   return stream.getStatus() == Stream::Ok;
+}
+
 bool Interior::writeVehicleCollision(Stream& stream) const
 {
    AssertFatal(stream.hasCapability(Stream::StreamWrite), "Interior::write: non-write capable stream passed");
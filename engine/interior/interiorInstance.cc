@@ -217,6 +217,7 @@ IMPLEMENT_CO_NETOBJECT_V1(InteriorInstance);
 //
 bool InteriorInstance::smDontRestrictOutside = false;
 bool InteriorInstance::smRenderDynamicLights = true;
+bool InteriorInstance::smUseLightLayers = true;
 U32  InteriorInstance::smLightUpdatePeriod = 66;  // 66 ms between updates
 F32  InteriorInstance::smDetailModification = 1.0f;
 
@@ -354,9 +355,15 @@ void InteriorInstance::consoleInit()
    Con::addVariable("pref::Interior::LightUpdatePeriod",    TypeS32,  &smLightUpdatePeriod);
    Con::addVariable("pref::Interior::ShowEnvironmentMaps",  TypeBool, &Interior::smRenderEnvironmentMaps);
    Con::addVariable("pref::Interior::DynamicLights",        TypeBool, &smRenderDynamicLights);
+   Con::addVariable("pref::Interior::lightLayers",          TypeBool, &smUseLightLayers);
+   Con::addVariable("pref::Interior::shareLightmaps",       TypeBool, &InteriorLMManager::smShareLightmaps);
+   Con::addVariable("pref::Interior::compressLightmaps",    TypeBool, &InteriorLMManager::smCompressLightmaps);
    Con::addVariable("pref::Interior::VertexLighting",       TypeBool, &Interior::smUseVertexLighting);
    Con::addVariable("pref::Interior::TexturedFog",          TypeBool, &Interior::smUseTexturedFog);
    Con::addVariable("pref::Interior::lockArrays",           TypeBool, &Interior::smLockArrays);
+   Con::addVariable("pref::Interior::vertexBufferObjects",  TypeBool, &Interior::smUseVertexBuffers);
+   Con::addVariable("pref::Interior::loadCache",            TypeBool, &Interior::smUseLoadCache);
+   Con::addVariable("pref::Interior::zoneCacheTolerance",   TypeF32,  &Interior::smZoneCacheTolerance);
 
    Con::addVariable("pref::Interior::detailAdjust", TypeF32, &InteriorInstance::smDetailModification);
 
@@ -491,6 +498,7 @@ bool InteriorInstance::onAdd()
 
    resetWorldBox();
    setRenderTransform(mObjToWorld);
+   mZoneCache.invalidate();
 
    // Setup mLightInfo structure
    mLightInfo.setSize(mInteriorRes->getNumDetailLevels());
@@ -508,6 +516,10 @@ bool InteriorInstance::onAdd()
       dMemset(rInfo.mStateDataInfo.address(), 0x00,
               sizeof(LightInfo::StateDataInfo) * rInfo.mStateDataInfo.size());
 
+      // The lightmaps start out with only the static light, which is what
+      //  the layers want
+      rInfo.mLayered = true;
+
       rInfo.mLights.setSize(pInterior->mAnimatedLights.size());
       for (U32 j = 0; j < rInfo.mLights.size(); j++)
       {
@@ -832,7 +844,7 @@ void InteriorInstance::renderObject(SceneState* state, SceneRenderImage* sceneIm
    if(gEditingMission && isHidden())
       return;
 
-   PROFILE_START(InteriorRenderObject);
+   PROFILE_GPU_START(InteriorRenderObject);
 
    PROFILE_START(IRO_GetZones);
    U32 storedWaterMark = FrameAllocator::getWaterMark();
@@ -975,6 +987,14 @@ void InteriorInstance::renderObject(SceneState* state, SceneRenderImage* sceneIm
       pInterior->render(mAlarmState, mMaterialMaps[interiorImage->mDetailLevel], mLMHandle,
                         mVertexColorsNormal[interiorImage->mDetailLevel],
                         mVertexColorsAlarm[interiorImage->mDetailLevel]);
+
+      LightInfo& rLightInfo = mLightInfo[interiorImage->mDetailLevel];
+      if (!Interior::smUseVertexLighting && rLightInfo.mLayered)
+      {
+         PROFILE_START(IRO_RenderLightLayers);
+         renderLightLayers(pInterior, rLightInfo, mMaterialMaps[interiorImage->mDetailLevel]);
+         PROFILE_END();
+      }
    }
 
    pInterior->clearFog();
@@ -1102,7 +1122,7 @@ void InteriorInstance::renderObject(SceneState* state, SceneRenderImage* sceneIm
    // Reset the small textures...
    TextureManager::setSmallTexturesActive(false);
 
-   PROFILE_END();
+   PROFILE_GPU_END();
 }
 
 
@@ -1322,11 +1342,12 @@ bool InteriorInstance::prepRenderImage(SceneState* state,   const U32 stateKey,
                                                                   mRenderObjToWorld, mObjScale,
                                                                   modifyBaseState & !smDontRestrictOutside,
                                                                   smDontRestrictOutside | multipleZones,
-                                                                  state->mFlipCull);
+                                                                  state->mFlipCull,
+                                                                  &mZoneCache);
    if (smDontRestrictOutside)
       continueOut = true;
 
-   InteriorRenderImage* image = new InteriorRenderImage;
+   InteriorRenderImage* image = SceneState::newRenderImage<InteriorRenderImage>();
    image->obj = this;
    image->mDetailLevel = detailLevel;
    image->mBaseZone    = realStartZone;
@@ -1441,6 +1462,7 @@ void InteriorInstance::setTransform(const MatrixF & mat)
    // Since the interior is a static object, it's render transform changes 1 to 1
    //  with it's collision transform
    setRenderTransform(mat);
+   mZoneCache.invalidate();
 
    // Notify subobjects that care about the transform change...
    if (bool(mInteriorRes))
@@ -1878,11 +1900,9 @@ void InteriorInstance::updateLightMap(Interior* pInterior, LightInfo& rLightInfo
       return;
 
    // Get the surface's original bitmap
-   TextureHandle* originalLMapHandle = ((mAlarmState == false) ?
-                                        gInteriorLMManager.getHandle(pInterior->getLMHandle(), mLMHandle,
-                                                                     pInterior->mNormalLMapIndices[surfaceIndex]) :
-                                        gInteriorLMManager.getHandle(pInterior->getLMHandle(), mLMHandle,
-                                                                     pInterior->mAlarmLMapIndices[surfaceIndex]));
+   U32 lightmapIndex = (mAlarmState == false) ? pInterior->mNormalLMapIndices[surfaceIndex] :
+                                                pInterior->mAlarmLMapIndices[surfaceIndex];
+   TextureHandle* originalLMapHandle = gInteriorLMManager.getHandle(pInterior->getLMHandle(), mLMHandle, lightmapIndex);
 
    const GBitmap* pOriginalLMap = originalLMapHandle->getBitmap();
    AssertFatal(pOriginalLMap != NULL, "error, no lightmap on the handle!");
@@ -1907,8 +1927,9 @@ void InteriorInstance::updateLightMap(Interior* pInterior, LightInfo& rLightInfo
       src += srcStep;
    }
 
-   // ...now we have the original lightmap, add in the animateds...
-   for (U32 i = 0; i < rSurface.lightCount; i++)
+   // ...now we have the original lightmap, add in the animateds, unless
+   //  they're drawn over it...
+   for (U32 i = 0; i < rSurface.lightCount && !rLightInfo.mLayered; i++)
    {
       const LightInfo::StateDataInfo& rInfo = rLightInfo.mStateDataInfo[rSurface.lightStateInfoStart + i];
 
@@ -1954,6 +1975,23 @@ void InteriorInstance::updateLightMap(Interior* pInterior, LightInfo& rLightInfo
                       GL_RGB, GL_UNSIGNED_BYTE,
                       pNewLightmap);
    }
+
+   // The vertex buffer render draws from the lightmap's copy in the atlas
+   Vector<TextureHandle*>* pAtlases = gInteriorLMManager.getAtlasHandles(pInterior->getLMHandle(), mLMHandle);
+   if (pAtlases != NULL && lightmapIndex < pInterior->mLMAtlasRects.size())
+   {
+      const Interior::LightmapAtlasRect& rRect = pInterior->mLMAtlasRects[lightmapIndex];
+      if (rRect.atlas < pAtlases->size())
+      {
+         glBindTexture(GL_TEXTURE_2D, (*pAtlases)[rRect.atlas]->getGLName());
+         glTexSubImage2D(GL_TEXTURE_2D,
+                         0,
+                         rRect.x + rSurface.mapOffsetX, rRect.y + rSurface.mapOffsetY,
+                         rSurface.mapSizeX,             rSurface.mapSizeY,
+                         GL_RGB, GL_UNSIGNED_BYTE,
+                         pNewLightmap);
+      }
+   }
 }
 
 
@@ -1965,6 +2003,15 @@ void InteriorInstance::downloadLightmaps(SceneState* /*state*/,
    extern U16* sgActivePolyList;
    extern U32  sgActivePolyListSize;
 
+   // Each way leaves the lightmaps the other can't use, the merged light or
+   //  none, so a switch redoes every lit surface
+   bool layered = useLightLayers();
+   if (layered != rLightInfo.mLayered)
+   {
+      rLightInfo.mLayered = layered;
+      rLightInfo.mSurfaceInvalid.set();
+   }
+
    for (U32 i = 0; i < sgActivePolyListSize; i++)
    {
       if (rLightInfo.mSurfaceInvalid.getSize() > 0 && rLightInfo.mSurfaceInvalid.test(sgActivePolyList[i]) == true)
@@ -22,6 +22,9 @@
 #ifndef _INTERIORLMMANAGER_H_
 #include "interior/interiorLMManager.h"
 #endif
+#ifndef _INTERIOR_H_
+#include "interior/interior.h"
+#endif
 
 #ifndef _BITVECTOR_H_
 #include "core/bitVector.h"
@@ -149,6 +152,7 @@ class InteriorInstance : public SceneObject
 
    static U32 smLightUpdatePeriod;
    static bool smRenderDynamicLights;
+   static bool smUseLightLayers;
 
    U32  mLightUpdatedTime;
    void setLightUpdatedTime(const U32);
@@ -240,6 +244,7 @@ public:
    StringTableEntry                     mInteriorFileName;     ///< File name of the interior this instance encapuslates
    U32                                  mInteriorFileHash;     ///< Hash for interior file name, used for sorting
    Resource<InteriorResource>           mInteriorRes;          ///< Interior managed by resource manager
+   InteriorZoneCache                    mZoneCache;            ///< Last zone traversal of the base detail
    Vector<MaterialList*>                mMaterialMaps;         ///< Materials for this interior
    StringTableEntry                     mSkinBase;             ///< Skin for this interior
 
@@ -318,12 +323,14 @@ public:
       struct StateDataInfo {
          ColorI curColor;
          U8*    curMap;
+         U32    curData;   ///< Entry of Interior::mStateData curMap came from
          bool   alarm;
       };
 
       Vector<Light> mLights;
       BitVector             mSurfaceInvalid;
       Vector<StateDataInfo> mStateDataInfo;
+      bool                  mLayered;   ///< Lightmaps hold only the static light, the lights are drawn over them
    };
    Vector<LightInfo>   mLightInfo;           ///< Light info, one per detail level
    LightUpdateGrouper* mUpdateGrouper;       ///< Designed to group net updates for lights to reduce traffic
@@ -361,6 +368,18 @@ public:
    /// @param   rLightInfo   Light to use
    void downloadLightmaps(SceneState *state, Interior *pInterior, LightInfo &rLightInfo);
 
+   /// True if the animated lights are drawn as layers over the static
+   /// lightmaps, rather than merged into them ($pref::Interior::lightLayers).
+   static bool useLightLayers();
+
+   /// Draws the animated lights on the visible surfaces, each light's
+   /// intensity map times its color and the base texture, added over what
+   /// the lightmap pass left.  A light changing is then just a new color.
+   /// @param   pInterior   Interior to draw
+   /// @param   rLightInfo  Light info of the detail level
+   /// @param   pMaterials  Base textures of the detail level
+   void renderLightLayers(Interior *pInterior, LightInfo &rLightInfo, MaterialList *pMaterials);
+
    /// This will set up a particular light in a particular detail level
    /// @param   detail   Detail level
    /// @param   lightIndex   Light to install
@@ -11,6 +11,7 @@
 #include "interior/interiorInstance.h"
 #include "interior/interior.h"
 #include "sceneGraph/sceneLighting.h"
+#include "core/crc.h"
 
 //------------------------------------------------------------------------------
 // Globals
@@ -31,10 +32,20 @@ namespace {
       dSprintf(buffer, sizeof(buffer), "%p_%d_lm_%d.png", interior, instance, lightmap);
       return(buffer);
    }
+
+   // '<instance info>_lmatlas_<atlas index>.png', instance handles get reused
+   const char * getAtlasName(void * instanceInfo, U32 atlas)
+   {
+      static char buffer[256];
+      dSprintf(buffer, sizeof(buffer), "%p_lmatlas_%d.png", instanceInfo, atlas);
+      return(buffer);
+   }
 }
 
 //------------------------------------------------------------------------------
 U32 InteriorLMManager::smTextureCallbackKey = U32(-1);
+bool InteriorLMManager::smShareLightmaps = true;
+bool InteriorLMManager::smCompressLightmaps = false;
 
 // D3D vertex buffers for Interiors are in here so they get dumped/reallocated
 // along with the lightmaps on the texture events
@@ -66,6 +77,9 @@ void InteriorLMManager::destroy()
       smTextureCallbackKey = U32(-1);
    }
 
+   // interiors can outlive the context at shutdown, don't let them touch it
+   Interior::smBufferGeneration++;
+
 	if (smMTVertexBuffer != -1)
 	{
 		if (dglDoesSupportVertexBuffer())
@@ -99,6 +113,9 @@ void InteriorLMManager::processTextureEvent(U32 eventCode)
       case TextureManager::BeginZombification:
          purgeGLTextures();
 
+         // the interiors upload their buffers again when they're next drawn
+         Interior::smBufferGeneration++;
+
 			if (smMTVertexBuffer != -1)
 			{
 				if (dglDoesSupportVertexBuffer())
@@ -216,6 +233,7 @@ void InteriorLMManager::removeInstance(LM_HANDLE interiorHandle, LM_HANDLE insta
    InstanceLMInfo * instInfo = itrInfo->mInstances[instanceHandle];
    for(U32 i = 0; i < instInfo->mLightmapHandles.size(); i++)
       delete instInfo->mLightmapHandles[i];
+   deleteAtlases(instInfo);
 
    // reset on last instance removal only (multi detailed shapes share the same instance handle)
    if(itrInfo->mInstances.size() == 1)
@@ -246,6 +264,7 @@ void InteriorLMManager::useBaseTextures(LM_HANDLE interiorHandle, LM_HANDLE inst
    Vector<TextureHandle*>& texHandles = getHandles(interiorHandle, instanceHandle);
    for(U32 i = 0; i < baseHandles.size(); i++)
       texHandles[i] = new TextureHandle(*baseHandles[i]);
+   deleteAtlases(mInteriors[interiorHandle]->mInstances[instanceHandle]);
 }
 
 //------------------------------------------------------------------------------
@@ -291,6 +310,7 @@ void InteriorLMManager::destroyTextures()
             delete instanceInfo->mLightmapHandles[k];
             instanceInfo->mLightmapHandles[k] = 0;
          }
+         deleteAtlases(instanceInfo);
       }
    }
 }
@@ -305,6 +325,11 @@ void InteriorLMManager::purgeGLTextures()
       for(S32 j = interiorInfo->mInstances.size() - 1; j >= 0; j--)
       {
          InstanceLMInfo * instanceInfo = interiorInfo->mInstances[j];
+
+         // the atlases have no bitmap to come back from, they're rebuilt
+         // with the lightmaps when the scene is relit
+         deleteAtlases(instanceInfo);
+
          for(S32 k = instanceInfo->mLightmapHandles.size() - 1; k >= 0; k--)
          {
             if(!instanceInfo->mLightmapHandles[k])
@@ -322,6 +347,9 @@ void InteriorLMManager::purgeGLTextures()
 
             purgeList.push_back(texObj->texGLName);
             texObj->texGLName = 0;
+
+            TextureManager::smResidentBytes -= texObj->residentBytes;
+            texObj->residentBytes = 0;
          }
       }
    }
@@ -347,6 +375,9 @@ void InteriorLMManager::downloadGLTextures(LM_HANDLE interiorHandle)
    needTexture.setSize(interiorInfo->mNumLightmaps);
    needTexture.clear();
 
+   if(smShareLightmaps)
+      shareLightmaps(interiorHandle);
+
    for(S32 j = interiorInfo->mInstances.size() - 1; j >= 0; j--)
    {
       InstanceLMInfo * instanceInfo = interiorInfo->mInstances[j];
@@ -370,7 +401,9 @@ void InteriorLMManager::downloadGLTextures(LM_HANDLE interiorHandle)
          if (texObj->texGLName)
             continue;
 
-         // Go ahead and download this set to GL
+         // Go ahead and download this set to GL.  The animated lights write
+         // into the kept ones, which rules out compressing them.
+         texObj->compress = smCompressLightmaps && !interiorInfo->mInterior->mLightmapKeep[k];
 #ifdef TORQUE_GATHER_METRICS
          texObj->textureSpace = texObj->downloadedWidth * texObj->downloadedHeight;
          TextureManager::smTextureSpaceLoaded += texObj->textureSpace;
@@ -378,6 +411,14 @@ void InteriorLMManager::downloadGLTextures(LM_HANDLE interiorHandle)
          TextureManager::createGLName(texObj->bitmap, texObj->clamp, 0, texObj->type, texObj);
       }
    }
+
+   // the vertex buffer render draws from atlases of the same lightmaps, they
+   // have to be made now while the bitmaps are still around
+   if(Interior::useBufferObjects())
+   {
+      for(U32 j = 0; j < interiorInfo->mInstances.size(); j++)
+         buildAtlases(interiorHandle, j);
+   }
 }
 
 bool InteriorLMManager::loadBaseLightmaps(LM_HANDLE interiorHandle, LM_HANDLE instanceHandle)
@@ -477,6 +518,208 @@ Vector<TextureHandle*> & InteriorLMManager::getHandles(LM_HANDLE interiorHandle,
    return(mInteriors[interiorHandle]->mInstances[instanceHandle]->mLightmapHandles);
 }
 
+//------------------------------------------------------------------------------
+bool InteriorLMManager::usesBaseLightmaps(InteriorLMInfo * interiorInfo, InstanceLMInfo * instanceInfo)
+{
+   InstanceLMInfo * baseInstanceInfo = interiorInfo->mInstances[0];
+   if(instanceInfo == baseInstanceInfo)
+      return(true);
+
+   for(U32 i = 0; i < instanceInfo->mLightmapHandles.size(); i++)
+   {
+      TextureHandle * texHandle = instanceInfo->mLightmapHandles[i];
+      if(!texHandle)
+         continue;
+
+      // useBaseTextures() hands out copies of the base handles
+      TextureHandle * baseHandle = baseInstanceInfo->mLightmapHandles[i];
+      if(!baseHandle || static_cast<TextureObject*>(*texHandle) != static_cast<TextureObject*>(*baseHandle))
+         return(false);
+   }
+   return(true);
+}
+
+bool InteriorLMManager::sharesLightmaps(InteriorLMInfo * interiorInfo, InstanceLMInfo * a, InstanceLMInfo * b)
+{
+   InstanceLMInfo * baseInstanceInfo = interiorInfo->mInstances[0];
+   for(U32 i = 0; i < a->mLightmapHandles.size(); i++)
+   {
+      // no handle of its own means the base lightmap, as in getHandle()
+      TextureHandle * handleA = a->mLightmapHandles[i] ? a->mLightmapHandles[i] : baseInstanceInfo->mLightmapHandles[i];
+      TextureHandle * handleB = b->mLightmapHandles[i] ? b->mLightmapHandles[i] : baseInstanceInfo->mLightmapHandles[i];
+      if(!handleA || !handleB || static_cast<TextureObject*>(*handleA) != static_cast<TextureObject*>(*handleB))
+         return(false);
+   }
+   return(true);
+}
+
+// one per distinct lightmap shareLightmaps() has seen
+struct SharedLightmap
+{
+   U32             crc;
+   TextureHandle * handle;
+};
+
+void InteriorLMManager::shareLightmaps(LM_HANDLE interiorHandle)
+{
+   InteriorLMInfo * interiorInfo = mInteriors[interiorHandle];
+   Interior * interior = interiorInfo->mInterior;
+
+   Vector<SharedLightmap> shared(interiorInfo->mInstances.size());
+
+   for(U32 k = 0; k < interiorInfo->mNumLightmaps; k++)
+   {
+      // the animated lights write into the kept ones, per instance
+      if(interior->mLightmapKeep[k])
+         continue;
+
+      shared.clear();
+      for(U32 j = 0; j < interiorInfo->mInstances.size(); j++)
+      {
+         InstanceLMInfo * instanceInfo = interiorInfo->mInstances[j];
+         TextureHandle * texHandle = instanceInfo->mLightmapHandles[k];
+         if(!texHandle)
+            continue;
+
+         TextureObject * texObj = *texHandle;
+         if(!texObj || !texObj->bitmap || texObj->bitmap->getFormat() != GBitmap::RGB)
+            continue;
+
+         const GBitmap * bitmap = texObj->bitmap;
+         U32 crc = calculateCRC(bitmap->getBits(), bitmap->byteSize);
+
+         U32 s;
+         for(s = 0; s < shared.size(); s++)
+         {
+            if(shared[s].crc != crc)
+               continue;
+
+            TextureObject * sharedObj = *shared[s].handle;
+            if(sharedObj == texObj)
+               break;
+
+            const GBitmap * sharedBitmap = sharedObj->bitmap;
+            if(sharedBitmap->getWidth() != bitmap->getWidth() || sharedBitmap->getHeight() != bitmap->getHeight() ||
+               dMemcmp(sharedBitmap->getBits(), bitmap->getBits(), bitmap->byteSize) != 0)
+               continue;
+
+            // same light, same texture; duplicateBaseLightmap() copies it
+            // again should the instance be relit
+            delete texHandle;
+            instanceInfo->mLightmapHandles[k] = new TextureHandle(*shared[s].handle);
+            deleteAtlases(instanceInfo);
+            break;
+         }
+
+         if(s == shared.size())
+         {
+            shared.increment();
+            shared.last().crc    = crc;
+            shared.last().handle = texHandle;
+         }
+      }
+   }
+}
+
+Vector<TextureHandle*> * InteriorLMManager::getAtlasHandles(LM_HANDLE interiorHandle, LM_HANDLE instanceHandle)
+{
+   AssertFatal(interiorHandle < mInteriors.size(), "InteriorLMManager::getAtlasHandles: invalid interior handle");
+   AssertFatal(instanceHandle < mInteriors[interiorHandle]->mInstances.size(), "InteriorLMManager::getAtlasHandles: invalid instance handle");
+
+   InteriorLMInfo * interiorInfo = mInteriors[interiorHandle];
+   InstanceLMInfo * instanceInfo = interiorInfo->mInstances[instanceHandle];
+   if(!instanceInfo->mAtlasHandles.size() && usesBaseLightmaps(interiorInfo, instanceInfo))
+      instanceInfo = interiorInfo->mInstances[0];
+
+   // or any other instance whose lightmaps it shares
+   for(U32 i = 1; i < interiorInfo->mInstances.size() && !instanceInfo->mAtlasHandles.size(); i++)
+   {
+      InstanceLMInfo * otherInfo = interiorInfo->mInstances[i];
+      if(otherInfo->mAtlasHandles.size() && sharesLightmaps(interiorInfo, instanceInfo, otherInfo))
+         instanceInfo = otherInfo;
+   }
+
+   if(!instanceInfo->mAtlasHandles.size())
+      return(NULL);
+   return(&instanceInfo->mAtlasHandles);
+}
+
+void InteriorLMManager::buildAtlases(LM_HANDLE interiorHandle, LM_HANDLE instanceHandle)
+{
+   AssertFatal(interiorHandle < mInteriors.size(), "InteriorLMManager::buildAtlases: invalid interior handle");
+   AssertFatal(instanceHandle < mInteriors[interiorHandle]->mInstances.size(), "InteriorLMManager::buildAtlases: invalid instance handle");
+
+   InteriorLMInfo * interiorInfo = mInteriors[interiorHandle];
+   InstanceLMInfo * instanceInfo = interiorInfo->mInstances[instanceHandle];
+   Interior * interior = interiorInfo->mInterior;
+
+   if(instanceInfo->mAtlasHandles.size() || !interior->mLMAtlasSizes.size())
+      return;
+   if(instanceHandle != 0 && usesBaseLightmaps(interiorInfo, instanceInfo))
+      return;
+
+   // one set of atlases per set of shared lightmaps
+   for(U32 j = 1; j < interiorInfo->mInstances.size(); j++)
+   {
+      InstanceLMInfo * otherInfo = interiorInfo->mInstances[j];
+      if(otherInfo->mAtlasHandles.size() && sharesLightmaps(interiorInfo, instanceInfo, otherInfo))
+         return;
+   }
+
+   U32 i;
+   for(i = 0; i < interiorInfo->mNumLightmaps; i++)
+   {
+      TextureHandle * texHandle = getHandle(interiorHandle, instanceHandle, i);
+      if(!texHandle || !texHandle->getBitmap() || texHandle->getBitmap()->getFormat() != GBitmap::RGB)
+         return;
+   }
+
+   Vector<GBitmap*> atlases(interior->mLMAtlasSizes.size());
+   for(i = 0; i < interior->mLMAtlasSizes.size(); i++)
+   {
+      const Point2I & size = interior->mLMAtlasSizes[i];
+      atlases.push_back(new GBitmap(size.x, size.y, false, GBitmap::RGB));
+      dMemset(atlases.last()->getWritableBits(), 0, atlases.last()->byteSize);
+   }
+
+   for(i = 0; i < interiorInfo->mNumLightmaps; i++)
+   {
+      const GBitmap * src = getBitmap(interiorHandle, instanceHandle, i);
+      const Interior::LightmapAtlasRect & rect = interior->mLMAtlasRects[i];
+      GBitmap * dest = atlases[rect.atlas];
+
+      U32 runSize = src->getWidth() * 3;
+      for(U32 y = 0; y < src->getHeight(); y++)
+         dMemcpy(dest->getAddress(rect.x, rect.y + y), src->getAddress(0, y), runSize);
+   }
+
+   for(i = 0; i < atlases.size(); i++)
+   {
+      TextureHandle * texHandle = new TextureHandle(getAtlasName(instanceInfo, i), atlases[i], BitmapNoDownloadTexture);
+      TextureObject * texObj = *texHandle;
+
+#ifdef TORQUE_GATHER_METRICS
+      texObj->textureSpace = texObj->downloadedWidth * texObj->downloadedHeight;
+      TextureManager::smTextureSpaceLoaded += texObj->textureSpace;
+#endif
+      TextureManager::createGLName(texObj->bitmap, texObj->clamp, 0, texObj->type, texObj);
+
+      // the animated lights update the atlas with subimages, so the copy
+      // isn't needed once it's down
+      delete texObj->bitmap;
+      texObj->bitmap = 0;
+
+      instanceInfo->mAtlasHandles.push_back(texHandle);
+   }
+}
+
+void InteriorLMManager::deleteAtlases(InstanceLMInfo * instanceInfo)
+{
+   for(U32 i = 0; i < instanceInfo->mAtlasHandles.size(); i++)
+      delete instanceInfo->mAtlasHandles[i];
+   instanceInfo->mAtlasHandles.clear();
+}
+
 //------------------------------------------------------------------------------
 U32 InteriorLMManager::getNumLightmaps(LM_HANDLE interiorHandle)
 {
@@ -493,6 +736,7 @@ void InteriorLMManager::deleteLightmap(LM_HANDLE interiorHandle, LM_HANDLE insta
 
    delete mInteriors[interiorHandle]->mInstances[instanceHandle]->mLightmapHandles[index];
    mInteriors[interiorHandle]->mInstances[instanceHandle]->mLightmapHandles[index] = 0;
+   deleteAtlases(mInteriors[interiorHandle]->mInstances[instanceHandle]);
 }
 
 void InteriorLMManager::clearLightmaps(LM_HANDLE interiorHandle, LM_HANDLE instanceHandle)
@@ -505,6 +749,7 @@ void InteriorLMManager::clearLightmaps(LM_HANDLE interiorHandle, LM_HANDLE insta
       delete mInteriors[interiorHandle]->mInstances[instanceHandle]->mLightmapHandles[i];
       mInteriors[interiorHandle]->mInstances[instanceHandle]->mLightmapHandles[i] = 0;
    }
+   deleteAtlases(mInteriors[interiorHandle]->mInstances[instanceHandle]);
 }
 
 //------------------------------------------------------------------------------
@@ -514,20 +759,29 @@ TextureHandle * InteriorLMManager::duplicateBaseLightmap(LM_HANDLE interiorHandl
    AssertFatal(instanceHandle < mInteriors[interiorHandle]->mInstances.size(), "InteriorLMManager::duplicateBaseLightmap: invalid instance handle");
    AssertFatal(index < mInteriors[interiorHandle]->mNumLightmaps, "InteriorLMManager::duplicateBaseLightmap: invalid texture index");
 
-   // already exists?
+   // already exists?  A lightmap shareLightmaps() handed to other instances
+   // gets copied before it's written, the others keep the texture.
    TextureHandle * texHandle = mInteriors[interiorHandle]->mInstances[instanceHandle]->mLightmapHandles[index];
+   GBitmap * src = NULL;
    if(texHandle && static_cast<TextureObject*>(*texHandle)->bitmap)
-      return(texHandle);
+   {
+      if(static_cast<TextureObject*>(*texHandle)->refCount == 1)
+         return(texHandle);
+      src = texHandle->getBitmap();
+   }
 
    AssertFatal(mInteriors[interiorHandle]->mInstances[0]->mLightmapHandles[index], "InteriorLMManager::duplicateBaseLightmap: invalid base handle");
 
    // copy it
-   GBitmap * src = mInteriors[interiorHandle]->mInstances[0]->mLightmapHandles[index]->getBitmap();
+   if(!src)
+      src = mInteriors[interiorHandle]->mInstances[0]->mLightmapHandles[index]->getBitmap();
    GBitmap * dest = new GBitmap(*src);
+   delete texHandle;
 
    // don't want this texture to be downloaded yet (SceneLighting will take care of that)
    TextureHandle * tHandle = new TextureHandle(getTextureName(mInteriors[interiorHandle]->mInterior, instanceHandle, index), dest, BitmapNoDownloadTexture);
    mInteriors[interiorHandle]->mInstances[instanceHandle]->mLightmapHandles[index] = tHandle;
+   deleteAtlases(mInteriors[interiorHandle]->mInstances[instanceHandle]);
    return(tHandle);
 }
 
@@ -29,6 +29,7 @@ class InteriorLMManager
          InteriorInstance *         mInstance;
          LM_HANDLE *                mHandlePtr;
          Vector<TextureHandle*>     mLightmapHandles;
+         Vector<TextureHandle*>     mAtlasHandles;    ///< Empty until built, see Interior::mLMAtlasRects.
       };
 
       struct InteriorLMInfo
@@ -46,10 +47,28 @@ class InteriorLMManager
       static S32                     smFTVertexBuffer;
       static S32                     smFMTVertexBuffer;
 
+      /// True if the instance draws with the base instance's lightmaps.
+      bool usesBaseLightmaps(InteriorLMInfo * interiorInfo, InstanceLMInfo * instanceInfo);
+
+      /// True if the two instances draw with the same lightmap textures.
+      bool sharesLightmaps(InteriorLMInfo * interiorInfo, InstanceLMInfo * a, InstanceLMInfo * b);
+
+      /// Points instances' lightmaps that came out the same as another's at
+      /// that one's texture, before they're downloaded.
+      void shareLightmaps(LM_HANDLE interiorHandle);
+
+      /// Copies the instance's lightmaps into the interior's atlas layout,
+      /// if they're all still on the cpu.
+      void buildAtlases(LM_HANDLE interiorHandle, LM_HANDLE instanceHandle);
+      void deleteAtlases(InstanceLMInfo * instanceInfo);
+
    public:
 
       static U32 smTextureCallbackKey;
 
+      static bool smShareLightmaps;      ///< $pref::Interior::shareLightmaps
+      static bool smCompressLightmaps;   ///< $pref::Interior::compressLightmaps
+
       InteriorLMManager();
       ~InteriorLMManager();
 
@@ -80,6 +99,10 @@ class InteriorLMManager
       TextureHandle *   getHandle(LM_HANDLE interiorHandle, LM_HANDLE instanceHandle, U32 index);
       Vector<TextureHandle*> & getHandles(LM_HANDLE interiorHandle, LM_HANDLE instanceHandle);
 
+      /// Lightmap atlases the instance draws with, NULL if they haven't been
+      /// built.  Instances sharing the base lightmaps share its atlases too.
+      Vector<TextureHandle*> * getAtlasHandles(LM_HANDLE interiorHandle, LM_HANDLE instanceHandle);
+
       // helper's
       TextureHandle * duplicateBaseLightmap(LM_HANDLE interiorHandle, LM_HANDLE instanceHandle, U32 index);
       GBitmap * getBitmap(LM_HANDLE interiorHandle, LM_HANDLE instanceHandle, U32 index);
@@ -8,6 +8,9 @@
 #include "interior/lightUpdateGrouper.h"
 #include "interior/interior.h"
 #include "math/mRandom.h"
+#include "dgl/dgl.h"
+#include "dgl/materialList.h"
+#include "lightingSystem/sgLightManager.h"
 
 void InteriorInstance::echoTriggerableLights()
 {
@@ -360,9 +363,130 @@ void InteriorInstance::installLight(const U32 detail, const U32 lightIndex)
       } else {
          rData.curMap = NULL;
       }
+      rData.curData  = i;
       rData.curColor = rLight.curColor;
       rData.alarm    = (rILight.flags & Interior::AlarmLight) != 0;
-      rLightInfo.mSurfaceInvalid.set(rIData.surfaceIndex);
+
+      // Drawn as a layer, the lightmap has nothing of the light to redo
+      if (!rLightInfo.mLayered)
+         rLightInfo.mSurfaceInvalid.set(rIData.surfaceIndex);
+   }
+}
+
+//--------------------------------------------------------------------------
+bool InteriorInstance::useLightLayers()
+{
+   return smUseLightLayers && Interior::smRenderMode == 0 && dglDoesSupportARBMultitexture();
+}
+
+void InteriorInstance::renderLightLayers(Interior* pInterior, LightInfo& rLightInfo, MaterialList* pMaterials)
+{
+   extern U16* sgActivePolyList;
+   extern U32  sgActivePolyListSize;
+
+   // lightmap + intensityMap * color, times the base texture, is the same
+   //  as the lightmap pass plus a pass of intensityMap * color * base.  The
+   //  sum saturates in the frame buffer rather than in the lightmap, and
+   //  isn't fogged, which is the only difference.
+   Vector<U32>* pLMapIndices = (mAlarmState == false) ? &pInterior->mNormalLMapIndices :
+                                                        &pInterior->mAlarmLMapIndices;
+   bool setup = false;
+   U32 currentlyBound0 = U32(-1);
+   U32 currentlyBound1 = U32(-1);
+
+   for (U32 i = 0; i < sgActivePolyListSize; i++)
+   {
+      U32 surfaceIndex = sgActivePolyList[i];
+      const Interior::Surface& rSurface = pInterior->mSurfaces[surfaceIndex];
+
+      for (U32 j = 0; j < rSurface.lightCount; j++)
+      {
+         const LightInfo::StateDataInfo& rInfo = rLightInfo.mStateDataInfo[rSurface.lightStateInfoStart + j];
+
+         // Only states that affect this surface, and that are lit at all
+         if (rInfo.curMap == NULL || rInfo.alarm != (mAlarmState != Normal))
+            continue;
+         if (rInfo.curColor.red == 0 && rInfo.curColor.green == 0 && rInfo.curColor.blue == 0)
+            continue;
+
+         TextureHandle* pLayer = pInterior->getLightLayer(rInfo.curData);
+         if (pLayer == NULL)
+            continue;
+
+         if (!setup)
+         {
+            setup = true;
+
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_ONE, GL_ONE);
+            glDepthMask(GL_FALSE);
+
+            // Intensity maps, times the light's color
+            glActiveTextureARB(GL_TEXTURE0_ARB);
+            glEnable(GL_TEXTURE_2D);
+            glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+            // Base textures, scaled as in the lightmap pass
+            glActiveTextureARB(GL_TEXTURE1_ARB);
+            glEnable(GL_TEXTURE_2D);
+            glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+            LightManager::sgSetupExposureRendering();
+            glActiveTextureARB(GL_TEXTURE0_ARB);
+         }
+
+         U32 baseName = pMaterials->getMaterial(rSurface.textureIndex).getGLName();
+         if (baseName != currentlyBound1)
+         {
+            glActiveTextureARB(GL_TEXTURE1_ARB);
+            glBindTexture(GL_TEXTURE_2D, baseName);
+            glActiveTextureARB(GL_TEXTURE0_ARB);
+            currentlyBound1 = baseName;
+         }
+
+         U32 layerName = pLayer->getGLName();
+         if (layerName != currentlyBound0)
+         {
+            glBindTexture(GL_TEXTURE_2D, layerName);
+            currentlyBound0 = layerName;
+         }
+
+         // The lightmap texgen reaches the surface's rect in its lightmap;
+         //  the intensity map is that rect in the corner of its own texture
+         TextureHandle* pLMap = gInteriorLMManager.getHandle(pInterior->getLMHandle(), mLMHandle,
+                                                             (*pLMapIndices)[surfaceIndex]);
+         F32 scaleX  = F32(pLMap->getWidth())  / F32(pLayer->getWidth());
+         F32 scaleY  = F32(pLMap->getHeight()) / F32(pLayer->getHeight());
+         F32 offsetX = -F32(rSurface.mapOffsetX) / F32(pLayer->getWidth());
+         F32 offsetY = -F32(rSurface.mapOffsetY) / F32(pLayer->getHeight());
+
+         const Interior::TexGenPlanes& rTexGen   = pInterior->mTexGenEQs[rSurface.texGenIndex];
+         const Interior::TexGenPlanes& rLMTexGen = pInterior->mLMTexGenEQs[surfaceIndex];
+
+         glColor4ub(rInfo.curColor.red, rInfo.curColor.green, rInfo.curColor.blue, 255);
+         glBegin(GL_TRIANGLE_STRIP);
+         for (U32 k = rSurface.windingStart; k < rSurface.windingStart + rSurface.windingCount; k++)
+         {
+            const Point3F& rPoint = pInterior->mPoints[pInterior->mWindings[k]].point;
+            glMultiTexCoord2fARB(GL_TEXTURE0_ARB, rLMTexGen.planeX.distToPlane(rPoint) * scaleX + offsetX,
+                                                  rLMTexGen.planeY.distToPlane(rPoint) * scaleY + offsetY);
+            glMultiTexCoord2fARB(GL_TEXTURE1_ARB, rTexGen.planeX.distToPlane(rPoint),
+                                                  rTexGen.planeY.distToPlane(rPoint));
+            glVertex3fv(rPoint);
+         }
+         glEnd();
+      }
+   }
+
+   if (setup)
+   {
+      glActiveTextureARB(GL_TEXTURE1_ARB);
+      LightManager::sgResetExposureRendering();
+      glActiveTextureARB(GL_TEXTURE0_ARB);
+      glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+
+      glDepthMask(GL_TRUE);
+      glDisable(GL_BLEND);
+      glBlendFunc(GL_ONE, GL_ZERO);
    }
 }
 
@@ -370,7 +370,7 @@ bool InteriorMap::prepRenderImage(	SceneState* state, const U32 stateKey, const
    if (state->isObjectRendered(this))
    {	
 		// Yes, so get a SceneRenderImage.
-		SceneRenderImage* image = new SceneRenderImage;
+		SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
 		// Populate it.
 		image->obj = this;
 		image->isTranslucent = false;
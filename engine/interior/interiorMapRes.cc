@@ -1022,6 +1022,7 @@ char* InteriorMapResource::getTextureName(U32 texIdx)
 
 ResourceInstance* constructInteriorMAP(Stream& stream)
 {
+   MemoryTagScope tagScope(Memory::TagInterior);
    InteriorMapResource* pResource = new InteriorMapResource;
 
    if (pResource->read(stream) == true)
@@ -19,6 +19,7 @@
 #include "core/bitVector.h"
 #include "dgl/stripCache.h"
 #include "platform/profiler.h"
+#include "core/frameStats.h"
 
 //!!!!!!!TBD -- there should be a platform fn called memMove!
 #include <string.h>
@@ -31,6 +32,8 @@ extern U16* sgFogPolyList;
 extern U32  sgFogPolyListSize;
 extern U16* sgEnvironPolyList;
 extern U32  sgEnvironPolyListSize;
+extern U16* sgActiveZoneList;
+extern U32  sgActiveZoneListSize;
 
 Point3F sgOSCamPosition;
 
@@ -262,9 +265,11 @@ void flushPrimitives(const U32* indices,
    if (Interior::smLockArrays && dglDoesSupportCompiledVertexArray())
    {
       glLockArraysEXT(0, vcount);
+      STAT_INC(DrawCalls);
       glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, indices);
       glUnlockArraysEXT();
    } else {
+      STAT_INC(DrawCalls);
       glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, indices);
    }
 }
@@ -282,9 +287,11 @@ void flushPrimitivesVB(const U32* indices,
    if (Interior::smLockArrays && dglDoesSupportCompiledVertexArray())
    {
       glLockArraysEXT(0, vcount);
+      STAT_INC(DrawCalls);
       glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, indices);
       glUnlockArraysEXT();
    } else {
+      STAT_INC(DrawCalls);
       glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, indices);
    }
 }
@@ -348,7 +355,10 @@ void Interior::render(const bool useAlarmLighting, MaterialList* pMaterials, con
    {
       if (smUseVertexLighting == false)
       {
-         if (useFogCoord())
+         // Without any fog to lay down the fog coordinates do nothing, and
+         // renderARB() can draw from the vertex buffers
+         if (useFogCoord() &&
+             (sgFogActive || getBufferAtlases(useAlarmLighting, instanceHandle) == NULL))
          {
             PROFILE_START(IRO_RenderARB_FC);
             renderARB_FC(useAlarmLighting, pMaterials, instanceHandle);
@@ -581,6 +591,7 @@ void Interior::render_vc_tf(const bool useAlarmLighting, MaterialList* pMaterial
          glLockArraysEXT(0, mPoints.size());
       for (U32 i = 0; i < sgActivePolyListSize; i++) {
          const Surface& rSurface = mSurfaces[sgActivePolyList[i]];
+         STAT_INC(DrawCalls);
          glDrawElements(GL_TRIANGLE_STRIP, rSurface.windingCount, GL_UNSIGNED_INT, &mWindings[rSurface.windingStart]);
       }
       if (dglDoesSupportCompiledVertexArray())
@@ -960,6 +971,7 @@ void Interior::renderARB_vc_tf(const bool useAlarmLighting, MaterialList* pMater
       for (U32 i = 0; i < sgActivePolyListSize; i++)
       {
          const Surface& rSurface = mSurfaces[sgActivePolyList[i]];
+         STAT_INC(DrawCalls);
          glDrawElements(GL_TRIANGLE_STRIP, rSurface.windingCount, GL_UNSIGNED_INT, &mWindings[rSurface.windingStart]);
       }
 
@@ -984,7 +996,12 @@ void Interior::renderARB(const bool useAlarmLighting, MaterialList* pMaterials,
    U32 i;
    Vector<U32>* pLMapIndices = useAlarmLighting ? &mAlarmLMapIndices : &mNormalLMapIndices;
 
-   OutputPoint* pFirstOutputPoint = (OutputPoint*)sgRenderBuffer;
+   // Whole zones come straight out of the vertex buffer when they can, the
+   // vertex pointers below are then offsets into it
+   Vector<TextureHandle*>* pAtlases = getBufferAtlases(useAlarmLighting, instanceHandle);
+   bool useBuffers = pAtlases != NULL && bindBufferObjects();
+
+   OutputPoint* pFirstOutputPoint = useBuffers ? NULL : (OutputPoint*)sgRenderBuffer;
    U32 currRenderBufferPoint = 0;
    U32 currIndexPoint        = 0;
 
@@ -1025,65 +1042,73 @@ void Interior::renderARB(const bool useAlarmLighting, MaterialList* pMaterials,
 
    // Draw the polys!
    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
-   for (i = 0; i < sgActivePolyListSize; i++) {
-      const Surface& rSurface = mSurfaces[sgActivePolyList[i]];
+   if (useBuffers)
+   {
+      renderBufferZones(pMaterials, *pAtlases);
+      unbindBufferObjects();
+   }
+   else
+   {
+      for (i = 0; i < sgActivePolyListSize; i++) {
+         const Surface& rSurface = mSurfaces[sgActivePolyList[i]];
 
-      // Setup the base texture...
-      U32 baseName = pMaterials->getMaterial(rSurface.textureIndex).getGLName();
-      if (baseName != currentlyBound1) {
-         flushPrimitives(sgRenderIndices, currIndexPoint, currRenderBufferPoint);
-         currIndexPoint        = 0;
-         currRenderBufferPoint = 0;
+         // Setup the base texture...
+         U32 baseName = pMaterials->getMaterial(rSurface.textureIndex).getGLName();
+         if (baseName != currentlyBound1) {
+            flushPrimitives(sgRenderIndices, currIndexPoint, currRenderBufferPoint);
+            currIndexPoint        = 0;
+            currRenderBufferPoint = 0;
 
-         glActiveTextureARB(GL_TEXTURE1_ARB);
-         glBindTexture(GL_TEXTURE_2D, baseName);
-         currentlyBound1 = baseName;
+            glActiveTextureARB(GL_TEXTURE1_ARB);
+            glBindTexture(GL_TEXTURE_2D, baseName);
+            currentlyBound1 = baseName;
          
-         detailMapping.sgBindDetailMap(rSurface.textureIndex);
+            detailMapping.sgBindDetailMap(rSurface.textureIndex);
          
-         glActiveTextureARB(GL_TEXTURE0_ARB);
-      }
+            glActiveTextureARB(GL_TEXTURE0_ARB);
+         }
 
-      // Setup the lightmap
-      baseName = (*pLMapIndices)[sgActivePolyList[i]];
-      if (baseName != currentlyBound0) {
-         flushPrimitives(sgRenderIndices, currIndexPoint, currRenderBufferPoint);
-         currIndexPoint        = 0;
-         currRenderBufferPoint = 0;
+         // Setup the lightmap
+         baseName = (*pLMapIndices)[sgActivePolyList[i]];
+         if (baseName != currentlyBound0) {
+            flushPrimitives(sgRenderIndices, currIndexPoint, currRenderBufferPoint);
+            currIndexPoint        = 0;
+            currRenderBufferPoint = 0;
 
-         U32 glName = gInteriorLMManager.getHandle(mLMHandle, instanceHandle, baseName)->getGLName();
-         AssertFatal(glName, "Interior::renderARB: invalid glName for texture handle");
+            U32 glName = gInteriorLMManager.getHandle(mLMHandle, instanceHandle, baseName)->getGLName();
+            AssertFatal(glName, "Interior::renderARB: invalid glName for texture handle");
 
-         glBindTexture(GL_TEXTURE_2D, glName);
-         currentlyBound0 = baseName;
-      }
+            glBindTexture(GL_TEXTURE_2D, glName);
+            currentlyBound0 = baseName;
+         }
 
-      if (currRenderBufferPoint + rSurface.windingCount >= 512 ||
-          currIndexPoint        + (rSurface.windingCount - 2) * 3 >= 2048) {
-         flushPrimitives(sgRenderIndices, currIndexPoint, currRenderBufferPoint);
-         currIndexPoint        = 0;
-         currRenderBufferPoint = 0;
-      }
-      if (rSurface.texGenIndex != currentTexGen)
-      {
-         currentTexGen = rSurface.texGenIndex;
-         memcpy(texGen0,  &mTexGenEQs[rSurface.texGenIndex], sizeof(F32)*8);
-      }
-      memcpy(texGen1, &mLMTexGenEQs[sgActivePolyList[i]], sizeof(F32)*8);
+         if (currRenderBufferPoint + rSurface.windingCount >= 512 ||
+             currIndexPoint        + (rSurface.windingCount - 2) * 3 >= 2048) {
+            flushPrimitives(sgRenderIndices, currIndexPoint, currRenderBufferPoint);
+            currIndexPoint        = 0;
+            currRenderBufferPoint = 0;
+         }
+         if (rSurface.texGenIndex != currentTexGen)
+         {
+            currentTexGen = rSurface.texGenIndex;
+            memcpy(texGen0,  &mTexGenEQs[rSurface.texGenIndex], sizeof(F32)*8);
+         }
+         memcpy(texGen1, &mLMTexGenEQs[sgActivePolyList[i]], sizeof(F32)*8);
 
-      emitPrimitive(&sgRenderBuffer[currRenderBufferPoint],
-                    &sgRenderIndices[currIndexPoint],
-                    &mWindings[rSurface.windingStart],
-                    rSurface.windingCount,
-                    currRenderBufferPoint,
-                    &mPoints[0]);
-      currRenderBufferPoint += rSurface.windingCount;
-      currIndexPoint        += (rSurface.windingCount - 2) * 3;
-      AssertFatal(currRenderBufferPoint < 512 && currIndexPoint < 2048, "Aw, crap.4");
+         emitPrimitive(&sgRenderBuffer[currRenderBufferPoint],
+                       &sgRenderIndices[currIndexPoint],
+                       &mWindings[rSurface.windingStart],
+                       rSurface.windingCount,
+                       currRenderBufferPoint,
+                       &mPoints[0]);
+         currRenderBufferPoint += rSurface.windingCount;
+         currIndexPoint        += (rSurface.windingCount - 2) * 3;
+         AssertFatal(currRenderBufferPoint < 512 && currIndexPoint < 2048, "Aw, crap.4");
+      }
+      flushPrimitives(sgRenderIndices, currIndexPoint, currRenderBufferPoint);
+      currIndexPoint        = 0;
+      currRenderBufferPoint = 0;
    }
-   flushPrimitives(sgRenderIndices, currIndexPoint, currRenderBufferPoint);
-   currIndexPoint        = 0;
-   currRenderBufferPoint = 0;
 
    detailMapping.sgDisableDetailMapping();
 
@@ -1117,6 +1142,7 @@ void Interior::renderARB(const bool useAlarmLighting, MaterialList* pMaterials,
          glLockArraysEXT(0, mPoints.size());
       for (U32 i = 0; i < sgActivePolyListSize; i++) {
          const Surface& rSurface = mSurfaces[sgActivePolyList[i]];
+         STAT_INC(DrawCalls);
          glDrawElements(GL_TRIANGLE_STRIP, rSurface.windingCount, GL_UNSIGNED_INT, &mWindings[rSurface.windingStart]);
       }
       if (dglDoesSupportCompiledVertexArray())
@@ -1208,6 +1234,244 @@ void Interior::renderARB(const bool useAlarmLighting, MaterialList* pMaterials,
 }
 
 
+//------------------------------------------------------------------------------
+bool Interior::useBufferObjects()
+{
+   return smUseVertexBuffers && dglDoesSupportVertexBufferObject();
+}
+
+Vector<TextureHandle*>* Interior::getBufferAtlases(const bool useAlarmLighting, const LM_HANDLE instanceHandle)
+{
+   // the alarm lightmaps would need their own set of atlas coordinates
+   if (!useBufferObjects() || useAlarmLighting || mLMAtlasSizes.size() == 0)
+      return NULL;
+
+   // the atlases are made when the lighting is downloaded
+   Vector<TextureHandle*>* pAtlases = gInteriorLMManager.getAtlasHandles(mLMHandle, instanceHandle);
+   if (pAtlases == NULL || pAtlases->size() != mLMAtlasSizes.size())
+      return NULL;
+
+   return pAtlases;
+}
+
+bool Interior::bindBufferObjects()
+{
+   if (mBufferGeneration == smBufferGeneration)
+   {
+      if (mVertexBufferObject == 0)
+         return false;
+
+      glBindBufferARB(GL_ARRAY_BUFFER_ARB, mVertexBufferObject);
+      glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, mIndexBufferObject);
+      return true;
+   }
+
+   PROFILE_START(Interior_createBufferObjects);
+
+   // anything from an older generation went with its context
+   mVertexBufferObject = 0;
+   mIndexBufferObject  = 0;
+   mBufferGeneration   = smBufferGeneration;
+
+   // Every surface gets its own run of verts, the texture coordinates are
+   // per surface.  The lightmap coordinates are moved into the atlas.
+   Vector<U32> surfaceVerts(mSurfaces.size());
+   surfaceVerts.setSize(mSurfaces.size());
+   U32 numVerts = 0;
+   U32 i, j;
+   for (i = 0; i < mSurfaces.size(); i++)
+   {
+      surfaceVerts[i] = numVerts;
+      numVerts += mSurfaces[i].windingCount;
+   }
+
+   if (numVerts == 0)
+   {
+      PROFILE_END();
+      return false;
+   }
+
+   Vector<OutputPoint> verts(numVerts);
+   verts.setSize(numVerts);
+   for (i = 0; i < mSurfaces.size(); i++)
+   {
+      const Surface& rSurface = mSurfaces[i];
+      const TexGenPlanes& rTexGen = mTexGenEQs[rSurface.texGenIndex];
+      const TexGenPlanes& rLMTexGen = mLMTexGenEQs[i];
+      const LightmapAtlasRect& rRect = mLMAtlasRects[mNormalLMapIndices[i]];
+      const Point2I& rAtlasSize = mLMAtlasSizes[rRect.atlas];
+
+      F32 scaleX = F32(rRect.width)  / F32(rAtlasSize.x);
+      F32 scaleY = F32(rRect.height) / F32(rAtlasSize.y);
+      F32 offsetX = F32(rRect.x) / F32(rAtlasSize.x);
+      F32 offsetY = F32(rRect.y) / F32(rAtlasSize.y);
+
+      OutputPoint* pVert = &verts[surfaceVerts[i]];
+      for (j = rSurface.windingStart; j < rSurface.windingStart + rSurface.windingCount; j++, pVert++)
+      {
+         const Point3F& rPoint = mPoints[mWindings[j]].point;
+         pVert->point    = rPoint;
+         pVert->fogCoord = 0.0f;
+         pVert->texCoord.set(rTexGen.planeX.distToPlane(rPoint), rTexGen.planeY.distToPlane(rPoint));
+         pVert->lmCoord.set(offsetX + rLMTexGen.planeX.distToPlane(rPoint) * scaleX,
+                            offsetY + rLMTexGen.planeY.distToPlane(rPoint) * scaleY);
+      }
+   }
+
+   // Each zone's surfaces, sorted so that a base texture and atlas pair is
+   // one draw.  Surfaces in more than one zone are in each of them.
+   Vector<U32> indices;
+   Vector<U32> keys;
+   mBufferBatches.clear();
+   mBufferZones.setSize(mZones.size());
+   for (i = 0; i < mZones.size(); i++)
+   {
+      const Zone& rZone = mZones[i];
+
+      keys.setSize(rZone.surfaceCount);
+      for (j = 0; j < rZone.surfaceCount; j++)
+         keys[j] = mZoneSurfaces[rZone.surfaceStart + j];
+      for (j = 1; j < keys.size(); j++)
+      {
+         U32 surface = keys[j];
+         U32 key = (U32(mSurfaces[surface].textureIndex) << 16) | mLMAtlasRects[mNormalLMapIndices[surface]].atlas;
+
+         S32 k = j;
+         while (k > 0)
+         {
+            U32 other = keys[k - 1];
+            U32 otherKey = (U32(mSurfaces[other].textureIndex) << 16) | mLMAtlasRects[mNormalLMapIndices[other]].atlas;
+            if (otherKey <= key)
+               break;
+            keys[k] = other;
+            k--;
+         }
+         keys[k] = surface;
+      }
+
+      mBufferZones[i].batchStart = mBufferBatches.size();
+      for (j = 0; j < keys.size(); j++)
+      {
+         const Surface& rSurface = mSurfaces[keys[j]];
+         U16 atlas = mLMAtlasRects[mNormalLMapIndices[keys[j]]].atlas;
+
+         if (mBufferBatches.size() == mBufferZones[i].batchStart ||
+             mBufferBatches.last().textureIndex != rSurface.textureIndex ||
+             mBufferBatches.last().atlas != atlas)
+         {
+            mBufferBatches.increment();
+            mBufferBatches.last().indexStart   = indices.size();
+            mBufferBatches.last().indexCount   = 0;
+            mBufferBatches.last().textureIndex = rSurface.textureIndex;
+            mBufferBatches.last().atlas        = atlas;
+         }
+
+         // same triangles as emitPrimitive()
+         U32 offset = surfaceVerts[keys[j]];
+         U32 last = 2;
+         while (last < rSurface.windingCount)
+         {
+            indices.push_back(offset + last - 2);
+            indices.push_back(offset + last - 1);
+            indices.push_back(offset + last - 0);
+            last++;
+
+            if (last == rSurface.windingCount)
+               break;
+
+            indices.push_back(offset + last - 1);
+            indices.push_back(offset + last - 2);
+            indices.push_back(offset + last - 0);
+            last++;
+         }
+         mBufferBatches.last().indexCount = indices.size() - mBufferBatches.last().indexStart;
+      }
+      mBufferZones[i].batchCount = mBufferBatches.size() - mBufferZones[i].batchStart;
+   }
+
+   if (indices.size() == 0)
+   {
+      PROFILE_END();
+      return false;
+   }
+
+   GLuint buffers[2];
+   glGenBuffersARB(2, buffers);
+
+   glBindBufferARB(GL_ARRAY_BUFFER_ARB, buffers[0]);
+   glBufferDataARB(GL_ARRAY_BUFFER_ARB, verts.size() * sizeof(OutputPoint), verts.address(), GL_STATIC_DRAW_ARB);
+
+   glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, buffers[1]);
+   glBufferDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB, indices.size() * sizeof(U32), indices.address(), GL_STATIC_DRAW_ARB);
+
+   mVertexBufferObject = buffers[0];
+   mIndexBufferObject  = buffers[1];
+
+   PROFILE_END();
+   return true;
+}
+
+void Interior::unbindBufferObjects()
+{
+   // the rest of the interior render draws from system memory
+   glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+   glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+}
+
+void Interior::deleteBufferObjects()
+{
+   if (mBufferGeneration == smBufferGeneration && mVertexBufferObject)
+   {
+      GLuint buffers[2] = { mVertexBufferObject, mIndexBufferObject };
+      glDeleteBuffersARB(2, buffers);
+   }
+   mVertexBufferObject = 0;
+   mIndexBufferObject  = 0;
+   mBufferGeneration   = 0;
+}
+
+void Interior::renderBufferZones(MaterialList* pMaterials, const Vector<TextureHandle*>& atlases)
+{
+   U32 currentlyBound0 = U32(-1);
+   U32 currentlyBound1 = U32(-1);
+
+   for (U32 i = 0; i < sgActiveZoneListSize; i++)
+   {
+      const BufferZone& rZone = mBufferZones[sgActiveZoneList[i]];
+      for (U32 j = rZone.batchStart; j < rZone.batchStart + rZone.batchCount; j++)
+      {
+         const BufferBatch& rBatch = mBufferBatches[j];
+
+         // Setup the base texture...
+         U32 baseName = pMaterials->getMaterial(rBatch.textureIndex).getGLName();
+         if (baseName != currentlyBound1)
+         {
+            glActiveTextureARB(GL_TEXTURE1_ARB);
+            glBindTexture(GL_TEXTURE_2D, baseName);
+            currentlyBound1 = baseName;
+
+            detailMapping.sgBindDetailMap(rBatch.textureIndex);
+
+            glActiveTextureARB(GL_TEXTURE0_ARB);
+         }
+
+         // ...and the atlas
+         if (rBatch.atlas != currentlyBound0)
+         {
+            U32 glName = atlases[rBatch.atlas]->getGLName();
+            AssertFatal(glName, "Interior::renderBufferZones: invalid glName for atlas");
+
+            glBindTexture(GL_TEXTURE_2D, glName);
+            currentlyBound0 = rBatch.atlas;
+         }
+
+         STAT_INC(DrawCalls);
+         glDrawElements(GL_TRIANGLES, rBatch.indexCount, GL_UNSIGNED_INT,
+                        (const GLvoid*)(rBatch.indexStart * sizeof(U32)));
+      }
+   }
+}
+
 void Interior::renderARB_FC(const bool useAlarmLighting, MaterialList* pMaterials, const LM_HANDLE instanceHandle)
 {
    U32 i;
@@ -1696,6 +1960,7 @@ void Interior::renderAsShape()
       for (U32 i = 0; i < sgActivePolyListSize; i++)
       {
          const Surface& rSurface = mSurfaces[sgActivePolyList[i]];
+         STAT_INC(DrawCalls);
          glDrawElements(GL_TRIANGLE_STRIP, rSurface.windingCount, GL_UNSIGNED_INT, &mWindings[rSurface.windingStart]);
       }
       if (dglDoesSupportCompiledVertexArray())
@@ -9,6 +9,8 @@
 #include "interior/interiorResObjects.h"
 #include "dgl/gBitmap.h"
 #include "interior/forceField.h"
+#include "core/fileStream.h"
+#include "platform/platformThread.h"
 
 #include "interior/interiorRes.h"
 
@@ -48,7 +50,7 @@ InteriorResource::~InteriorResource()
    mPreviewBitmap = NULL;
 }
 
-bool InteriorResource::read(Stream& stream)
+bool InteriorResource::read(Stream& stream, InteriorLoadCache* cache)
 {
    AssertFatal(stream.hasCapability(Stream::StreamRead), "Interior::read: non-read capable stream passed");
    AssertFatal(stream.getStatus() == Stream::Ok, "Interior::read: Error, stream in inconsistent state");
@@ -63,12 +65,16 @@ bool InteriorResource::read(Stream& stream)
       return false;
    }
 
-   // Handle preview
+   // Handle preview...nothing keeps it, so don't bother decoding it
    bool previewIncluded;
    stream.read(&previewIncluded);
    if (previewIncluded) {
-      GBitmap bmp;
-      bmp.readPNG(stream);
+      if (stream.hasCapability(Stream::StreamPosition))
+         GBitmap::skipPNG(stream);
+      else {
+         GBitmap bmp;
+         bmp.readPNG(stream);
+      }
    }
 
    // Details
@@ -80,7 +86,7 @@ bool InteriorResource::read(Stream& stream)
 
    for (i = 0; i < mDetailLevels.size(); i++) {
       mDetailLevels[i] = new Interior;
-      if (mDetailLevels[i]->read(stream) == false) {
+      if (mDetailLevels[i]->read(stream, cache) == false) {
          Con::errorf(ConsoleLogEntry::General, "Unable to read detail level %d in interior resource", i);
          return false;
       }
@@ -95,8 +101,9 @@ bool InteriorResource::read(Stream& stream)
 
    for (i = 0; i < mSubObjects.size(); i++) {
       mSubObjects[i] = new Interior;
-      if (mSubObjects[i]->read(stream) == false) {
-         AssertISV(false, avar("Unable to read subobject %d in interior resource", i));
+      if (mSubObjects[i]->read(stream, cache) == false) {
+         // a stale cache is no reason to die...the caller starts over without it
+         AssertISV(cache && cache->in, avar("Unable to read subobject %d in interior resource", i));
          return false;
       }
    }
@@ -306,12 +313,77 @@ GBitmap* InteriorResource::extractPreview(Stream& stream)
 
 //------------------------------------------------------------------------------
 //-------------------------------------- Interior Resource constructor
-ResourceInstance* constructInteriorDIF(Stream& stream)
+ResourceInstance* constructInteriorDIF(Stream& stream, ResourceObject* obj)
 {
-   InteriorResource* pResource = new InteriorResource;
+   MemoryTagScope tagScope(Memory::TagInterior);
+
+   // The load cache is looked up and written through the resource
+   // manager, so only on the main thread.
+   char cacheName[1024];
+   bool useCache = Interior::smUseLoadCache && obj && obj->crc != InvalidCRC &&
+                   stream.hasCapability(Stream::StreamPosition) && Thread::isMainThread();
+   if (useCache)
+   {
+      if (obj->path && obj->path[0])
+         dStrcpyl(cacheName, sizeof(cacheName), obj->path, "/", obj->name, ".cache", NULL);
+      else
+         dStrcpyl(cacheName, sizeof(cacheName), obj->name, ".cache", NULL);
+
+      ResourceObject* rCache = ResourceManager->find(cacheName);
+      Stream* cs = rCache ? ResourceManager->openStream(rCache) : NULL;
+      if (cs)
+      {
+         U32 magic, version, crc;
+         cs->read(&magic);
+         cs->read(&version);
+         bool valid = cs->read(&crc) && magic == InteriorLoadCache::Magic &&
+                      version == InteriorLoadCache::Version && crc == obj->crc;
+
+         InteriorResource* pResource = NULL;
+         if (valid)
+         {
+            InteriorLoadCache cache = { cs, NULL };
+            pResource = new InteriorResource;
+            if (pResource->read(stream, &cache) == false)
+            {
+               // start over from the .dif
+               delete pResource;
+               pResource = NULL;
+               stream.setPosition(0);
+            }
+         }
+         ResourceManager->closeStream(cs);
+         if (pResource)
+            return pResource;
+      }
+   }
 
-   if (pResource->read(stream) == true)
+   // The CRC goes in last, so a cache that was only partly written
+   // never matches.
+   FileStream fs;
+   InteriorLoadCache cache = { NULL, NULL };
+#ifndef TORQUE_HEADLESS
+   // A headless build doesn't decode the lightmaps, so it can only read
+   // a cache, never write one.
+   if (useCache && ResourceManager->openFileForWrite(fs, cacheName))
+   {
+      fs.write(U32(InteriorLoadCache::Magic));
+      fs.write(U32(InteriorLoadCache::Version));
+      fs.write(U32(InvalidCRC));
+      cache.out = &fs;
+   }
+#endif
+
+   InteriorResource* pResource = new InteriorResource;
+   if (pResource->read(stream, cache.out ? &cache : NULL) == true)
+   {
+      if (cache.out && fs.getStatus() == Stream::Ok)
+      {
+         fs.setPosition(2 * sizeof(U32));
+         fs.write(obj->crc);
+      }
       return pResource;
+   }
    else {
       delete pResource;
       return NULL;
@@ -12,6 +12,7 @@
 
 class Stream;
 class Interior;
+struct InteriorLoadCache;
 class GBitmap;
 class InteriorResTrigger;
 class InteriorPath;
@@ -40,7 +41,7 @@ class InteriorResource : public ResourceInstance
    InteriorResource();
    ~InteriorResource();
 
-   bool            read(Stream& stream);
+   bool            read(Stream& stream, InteriorLoadCache* cache = NULL);
    bool            write(Stream& stream) const;
    static GBitmap* extractPreview(Stream&);
 
@@ -60,7 +61,7 @@ class InteriorResource : public ResourceInstance
    AISpecialNode*        getSpecialNode(const U32);
    ItrGameEntity*        getGameEntity(const U32);
 };
-extern ResourceInstance* constructInteriorDIF(Stream& stream);
+extern ResourceInstance* constructInteriorDIF(Stream& stream, ResourceObject* obj);
 
 //--------------------------------------------------------------------------
 inline S32 InteriorResource::getNumDetailLevels() const
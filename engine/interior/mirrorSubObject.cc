@@ -389,7 +389,7 @@ SubObjectRenderImage* MirrorSubObject::getRenderImage(SceneState*    state,
 
    // On the right side, guess we have to return an image and a portal...
    //
-   SubObjectRenderImage* ri = new SubObjectRenderImage;
+   SubObjectRenderImage* ri = SceneState::newRenderImage<SubObjectRenderImage>();
 
    ri->obj           = this;
    ri->isTranslucent = false;
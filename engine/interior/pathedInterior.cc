@@ -84,6 +84,9 @@ PathedInterior::PathedInterior()
    mPathKey = 0xFFFFFFFF;
    mStopped = false;
    mSustainHandle = 0;
+   mInterior = NULL;
+   mPolyCacheValid = false;
+   VECTOR_SET_ASSOCIATION(mPolyCacheBounds);
 }
 
 PathedInterior::~PathedInterior()
@@ -119,6 +122,7 @@ bool PathedInterior::onAdd()
    mInterior = mInteriorRes->getSubObject(mInteriorResIndex);
    if (mInterior == NULL)
       return false;
+   mPolyCacheValid = false;
 
    // Setup bounding information
    mObjBox = mInterior->getBoundingBox();
@@ -209,7 +213,62 @@ bool PathedInterior::buildPolyList(AbstractPolyList* list, const Box3F& wsBox, c
    list->setTransform(&getTransform(), getScale());
    list->setObject(this);
 
-   return mInterior->buildPolyList(list, wsBox, mWorldToObj, getScale());
+   // Lists with their own mapping into the interior get the full query.
+   MatrixF mapping;
+   Box3F mappedBox;
+   if (list->getMapping(&mapping, &mappedBox))
+      return mInterior->buildPolyList(list, wsBox, mWorldToObj, getScale());
+
+   Box3F objBox = wsBox;
+   mWorldToObj.mul(objBox);
+   objBox.min.convolveInverse(getScale());
+   objBox.max.convolveInverse(getScale());
+
+   if (!mPolyCacheValid || !mPolyCacheBox.isContained(objBox))
+      buildPolyCache(objBox);
+
+   for (U32 i = 0; i < mPolyCache.mPolyList.size(); i++)
+   {
+      if (!mPolyCacheBounds[i].isOverlapped(objBox))
+         continue;
+
+      const ConcretePolyList::Poly& poly = mPolyCache.mPolyList[i];
+      list->begin(poly.material, poly.surfaceKey);
+      for (U32 j = 0; j < poly.vertexCount; j++)
+         list->vertex(list->addPoint(mPolyCache.mVertexList[mPolyCache.mIndexList[poly.vertexStart + j]]));
+      list->plane(poly.plane);
+      list->end();
+   }
+
+   return !list->isEmpty();
+}
+
+void PathedInterior::buildPolyCache(const Box3F& objBox)
+{
+   // Cover the query's own size again on every side, so a query that
+   //  moves a little with the interior still lands inside.
+   Point3F pad = objBox.max - objBox.min;
+   mPolyCacheBox.min = objBox.min - pad;
+   mPolyCacheBox.max = objBox.max + pad;
+
+   mPolyCache.clear();
+   mPolyCache.setObject(this);
+   mInterior->buildPolyList(&mPolyCache, mPolyCacheBox, MatrixF(true), Point3F(1, 1, 1));
+
+   mPolyCacheBounds.setSize(mPolyCache.mPolyList.size());
+   for (U32 i = 0; i < mPolyCache.mPolyList.size(); i++)
+   {
+      const ConcretePolyList::Poly& poly = mPolyCache.mPolyList[i];
+      Box3F& bounds = mPolyCacheBounds[i];
+      bounds.min = bounds.max = mPolyCache.mVertexList[mPolyCache.mIndexList[poly.vertexStart]];
+      for (U32 j = 1; j < poly.vertexCount; j++)
+      {
+         const Point3F& v = mPolyCache.mVertexList[mPolyCache.mIndexList[poly.vertexStart + j]];
+         bounds.min.setMin(v);
+         bounds.max.setMax(v);
+      }
+   }
+   mPolyCacheValid = true;
 }
 
 
@@ -232,7 +291,7 @@ bool PathedInterior::prepRenderImage(SceneState* state, const U32 stateKey,
          render = true;
 
    if (render == true) {
-      SceneRenderImage* image = new SceneRenderImage;
+      SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
       image->obj = this;
       state->insertRenderImage(image);
    }
@@ -16,6 +16,9 @@
 #include "interior/interiorLMManager.h"
 #endif
 #include "audio/audioDataBlock.h"
+#ifndef _CONCRETEPOLYLIST_H_
+#include "collision/concretePolyList.h"
+#endif
 
 class InteriorInstance;
 class EditGeometry;
@@ -92,6 +95,21 @@ private:
 
    PathedInterior *mNextClientPI;
 
+   /// @name Collision cache
+   /// The interior's polys around the last query, in object space.  The
+   /// interior only ever moves as a whole, so the polys stay good however
+   /// the transform changes; buildPolyList() replays them into queries
+   /// that fall inside mPolyCacheBox, like something riding the interior
+   /// every tick, without going back through the hulls.
+   /// @{
+   ConcretePolyList           mPolyCache;
+   Vector<Box3F>              mPolyCacheBounds;    ///< Per poly, to skip those outside the query.
+   Box3F                      mPolyCacheBox;
+   bool                       mPolyCacheValid;
+
+   void buildPolyCache(const Box3F &objBox);
+   /// @}
+
    // Rendering
   protected:
    bool prepRenderImage(SceneState *state, const U32 stateKey, const U32 startZone, const bool modifyBaseZoneState);
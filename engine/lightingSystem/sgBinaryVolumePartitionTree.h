@@ -269,6 +269,89 @@ public:
 				negative->collectObjectsUnclipped(split, (*b), objectslist);
 		}
 	}
+	// like collectObjectsClipped, but hands each object to visitor(obj)
+	// as it's found, nearest volume to start first, and stops as soon
+	// as the visitor returns true - for shadow casts that only need one
+	// hit and would otherwise build a list per ray...
+	template<class Tvisitor> bool visitObjectsClipped(Point3F start, Point3F end, Tvisitor &visitor)
+	{
+		F32 t;
+		Point3F vect;
+		if(!volume.isContained(start))
+		{
+			if(!volume.collideLine(start, end, &t, &vect))
+				return false;// we missed the whole volume...
+			if((t < 0.0f) || (t > 1.0f))
+				return false;// we missed the whole volume...
+			vect = end - start;
+			start += (vect * t);
+		}
+		if(!volume.isContained(end))
+		{
+			if(!volume.collideLine(end, start, &t, &vect))
+				return false;// we missed the whole volume...
+			if((t < 0.0f) || (t > 1.0f))
+				return false;// we missed the whole volume...
+			vect = start - end;
+			end += (vect * t);
+		}
+		return visitObjectsUnclipped(start, end, visitor);
+	}
+	// assumes the line has been clipped to the outer volume!!!
+	template<class Tvisitor> bool visitObjectsUnclipped(const Point3F &start, const Point3F &end, Tvisitor &visitor)
+	{
+		for(U32 i=0; i<object.size(); i++)
+		{
+			if(visitor(object[i]))
+				return true;
+		}
+
+		// do we have children?
+		if((!positive) && (!negative))
+			return false;
+
+		// test for sides...
+		F32 diststart = plane.distToPlane(start);
+		bool fronts = diststart > 0.0f;
+		bool fronte = plane.distToPlane(end) > 0.0f;
+
+		if(fronts == fronte)// same side?
+		{
+			if(fronts && positive)// in the front...
+				return positive->visitObjectsUnclipped(start, end, visitor);
+			else if((!fronts) && negative)// might be the back...
+				return negative->visitObjectsUnclipped(start, end, visitor);
+			return false;
+		}
+
+		// find the split...
+		Point3F split = end - start;
+		F32 t = mDot(split, plane);
+		if(t == 0)
+			return false;
+		t = -diststart / t;
+		if(t > 0.0f)
+		{
+			split *= t;
+			split += start;
+		}
+		else
+		{
+			split = start;
+		}
+
+		// start's side first...
+		if(fronts)
+		{
+			if(positive && positive->visitObjectsUnclipped(start, split, visitor))
+				return true;
+			return negative && negative->visitObjectsUnclipped(split, end, visitor);
+		}
+
+		if(negative && negative->visitObjectsUnclipped(start, split, visitor))
+			return true;
+		return positive && positive->visitObjectsUnclipped(split, end, visitor);
+	}
 };
 
 
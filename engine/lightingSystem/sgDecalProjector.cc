@@ -94,7 +94,7 @@ bool sgDecalProjector::prepRenderImage(SceneState* state, const U32 stateKey,
 
 	if(state->isObjectRendered(this))
 	{
-		SceneRenderImage* image = new SceneRenderImage;
+		SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
 		image->obj = this;
 		image->isTranslucent = true;
 		image->sortType = SceneRenderImage::EndSort;
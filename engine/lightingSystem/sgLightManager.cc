@@ -13,7 +13,9 @@
 #include "game/shadow.h"
 #include "lightingSystem/sgLightObject.h"
 #include "sim/netConnection.h"
+#ifndef TORQUE_HEADLESS
 #include "editor/worldEditor.h"
+#endif
 #include "platform/profiler.h"
 
 
@@ -35,6 +37,8 @@ U32 LightManager::sgDynamicLightingOcclusionQuality = dlqtFourSample;
 U32 LightManager::sgDynamicShadowQuality = 0;
 bool LightManager::sgMultipleDynamicShadows = true;
 bool LightManager::sgInGUIEditor = false;
+bool LightManager::sgUseLightBins = true;
+F32 LightManager::sgLightBinSize = 32.0f;
 
 bool sgRelightFilter::sgFilterRelight = false;
 bool sgRelightFilter::sgFilterRelightVisible = true;
@@ -159,6 +163,7 @@ LightInfo *LightManager::sgGetSpecialLight(sgSpecialLightTypesEnum type)
 void LightManager::sgRegisterGlobalLight(LightInfo *light)
 {
 	sgRegisteredGlobalLights.sgRegisterLight(light);
+	sgLightBinsDirty = true;
 }
 
 void LightManager::sgRegisterGlobalLights(bool staticlighting)
@@ -176,6 +181,7 @@ void LightManager::sgUnregisterAllLights()
 {
 	sgRegisteredGlobalLights.clear();
 	sgRegisteredLocalLights.clear();
+	sgLightBinsDirty = true;
 
 	dMemset(&sgSpecialLights, 0, sizeof(sgSpecialLights));
 }
@@ -185,7 +191,11 @@ void LightManager::sgGetAllUnsortedLights(LightInfoList &list)
 	list.clear();
 	list.merge(sgRegisteredGlobalLights);
 	list.merge(sgRegisteredLocalLights);
+	sgRemoveDuplicateLights(list);
+}
 
+void LightManager::sgRemoveDuplicateLights(LightInfoList &list)
+{
 	// find dupes...
 	dQsort(list.address(), list.size(), sizeof(LightInfo*), sgSortLightsByAddress);
 	LightInfo *last = NULL;
@@ -380,16 +390,110 @@ void LightManager::sgFindBestLights(SceneObject *obj, const Box3F &box, S32 maxl
 {
 	sgBestLights.clear();
 
-	// gets them all and removes any dupes...
-	sgGetAllUnsortedLights(sgBestLights);
-
 	SphereF sphere;
 	box.getCenter(&sphere.center);
 	sphere.radius = Point3F(box.max - sphere.center).len();
 
-	for(U32 i=0; i<sgBestLights.size(); i++)
-		sgScoreLight(sgBestLights[i], obj, box, sphere, camerabased);
+	if(!sgUseLightBins)
+	{
+		// gets them all and removes any dupes...
+		sgGetAllUnsortedLights(sgBestLights);
+
+		for(U32 i=0; i<sgBestLights.size(); i++)
+			sgScoreLight(sgBestLights[i], obj, box, sphere, camerabased);
+
+		sgSortBestLights(maxlights);
+		return;
+	}
+
+	PROFILE_START(LightManager_sgFindBinnedLights);
+
+	if(sgLightBinsDirty)
+		sgBinGlobalLights();
+
+	// the lights are scored from the sphere, so anything
+	// that can score reaches into the sphere's bounds...
+	Point3F rad(sphere.radius, sphere.radius, sphere.radius);
+	Box3F reach(sphere.center - rad, sphere.center + rad);
+
+	sgLightAssignmentEntry *entry = NULL;
+	if(obj)
+	{
+		U32 val = U32(obj);
+		entry = sgLightAssignments.find(calculateCRC(&val, sizeof(U32)));
+	}
+
+	sgLightAssignment *assign = entry ? &entry->info : NULL;
+	if(assign && (assign->sgObject == obj) &&
+		(assign->sgGeneration + 1 >= sgLightBinGeneration) &&
+		(assign->sgBox.min == box.min) && (assign->sgBox.max == box.max) &&
+		(assign->sgMaxLights == maxlights) && (assign->sgCameraBased == camerabased) &&
+		(assign->sgFilterZones == sgFilterZones) &&
+		(assign->sgZones[0] == sgZones[0]) && (assign->sgZones[1] == sgZones[1]) &&
+		!sgLightBinsChangedSince(reach, assign->sgGeneration))
+	{
+		// nothing moved, the scores from last time stand...
+		for(U32 i=0; i<entry->object.size(); i++)
+		{
+			sgCachedLight &cached = entry->object[i];
+			cached.sgLight->mScore = cached.sgScore;
+			cached.sgLight->sgDTSLightingOcclusionAdjust = cached.sgOcclusionAdjust;
+			sgBestLights.push_back(cached.sgLight);
+		}
+	}
+	else
+	{
+		sgGetBinnedLights(reach, sgBestLights);
 
+		for(U32 i=0; i<sgBestLights.size(); i++)
+			sgScoreLight(sgBestLights[i], obj, box, sphere, camerabased);
+
+		sgSortBestLights(maxlights);
+
+		if(assign)
+		{
+			assign->sgObject = obj;
+			assign->sgGeneration = sgLightBinGeneration;
+			assign->sgBox = box;
+			assign->sgMaxLights = maxlights;
+			assign->sgCameraBased = camerabased;
+			assign->sgFilterZones = sgFilterZones;
+			assign->sgZones[0] = sgZones[0];
+			assign->sgZones[1] = sgZones[1];
+
+			entry->object.setSize(sgBestLights.size());
+			for(U32 i=0; i<sgBestLights.size(); i++)
+			{
+				sgCachedLight &cached = entry->object[i];
+				cached.sgLight = sgBestLights[i];
+				cached.sgScore = sgBestLights[i]->mScore;
+				cached.sgOcclusionAdjust = sgBestLights[i]->sgDTSLightingOcclusionAdjust;
+			}
+		}
+	}
+
+	// the object's own lights aren't binned, they're scored every time...
+	U32 globalcount = sgBestLights.size();
+	for(U32 i=0; i<sgRegisteredLocalLights.size(); i++)
+	{
+		LightInfo *light = sgRegisteredLocalLights[i];
+		bool dupe = false;
+		for(U32 j=0; j<globalcount && !dupe; j++)
+			dupe = (sgBestLights[j] == light);
+		if(dupe)
+			continue;
+
+		sgScoreLight(light, obj, box, sphere, camerabased);
+		sgBestLights.push_back(light);
+	}
+
+	sgSortBestLights(maxlights);
+
+	PROFILE_END();
+}
+
+void LightManager::sgSortBestLights(S32 maxlights)
+{
 	dQsort(sgBestLights.address(), sgBestLights.size(), sizeof(LightInfo*), sgSortLightsByScore);
 
 	for(U32 i=0; i<sgBestLights.size(); i++)
@@ -402,6 +506,255 @@ void LightManager::sgFindBestLights(SceneObject *obj, const Box3F &box, S32 maxl
 	}
 }
 
+//-----------------------------------------------
+
+F32 LightManager::sgGetLightReach(LightInfo *light)
+{
+	sgLightingModel &model = sgLightingModelManager::sgGetLightingModel(light->sgLightingModelName);
+	model.sgSetState(light);
+	F32 reach = getMax(model.sgGetMaxRadius(false), model.sgGetMaxRadius(true));
+	model.sgResetState();
+
+	// lights brighter than white stay above the cutoff further out...
+	F32 intensity = light->sgAssignedToParticleSystem ? SG_PARTICLESYSTEMLIGHT_FIXED_INTENSITY :
+		(light->mColor.red + light->mColor.green + light->mColor.blue) * 0.3333f;
+	return reach * getMax(intensity, 1.0f);
+}
+
+U32 LightManager::sgGetLightSignature(LightInfo *light, U32 crc)
+{
+	crc = calculateCRC(&light, sizeof(LightInfo*), crc);
+	crc = calculateCRC(&light->mType, sizeof(light->mType), crc);
+	crc = calculateCRC(&light->mPos, sizeof(light->mPos), crc);
+	crc = calculateCRC(&light->mDirection, sizeof(light->mDirection), crc);
+	crc = calculateCRC(&light->mColor, sizeof(light->mColor), crc);
+	crc = calculateCRC(&light->mAmbient, sizeof(light->mAmbient), crc);
+	crc = calculateCRC(&light->mRadius, sizeof(light->mRadius), crc);
+	crc = calculateCRC(&light->sgSpotAngle, sizeof(light->sgSpotAngle), crc);
+	crc = calculateCRC(&light->sgLightingModelName, sizeof(light->sgLightingModelName), crc);
+	return calculateCRC(&light->sgMoveSnapshotId, sizeof(light->sgMoveSnapshotId), crc);
+}
+
+void LightManager::sgGetLightBinRange(const Box3F &box, S32 &minx, S32 &miny, S32 &maxx, S32 &maxy)
+{
+	F32 size = getMax(sgLightBinSize, 1.0f);
+	minx = S32(mFloor(getMax(box.min.x / size, -1.0e6f)));
+	miny = S32(mFloor(getMax(box.min.y / size, -1.0e6f)));
+	maxx = S32(mFloor(getMin(box.max.x / size, 1.0e6f)));
+	maxy = S32(mFloor(getMin(box.max.y / size, 1.0e6f)));
+}
+
+S32 LightManager::sgFindLightBinCell(S32 x, S32 y, bool create)
+{
+	U32 bucket = U32((x * 73856093) ^ (y * 19349663)) & (sgLightBinBucketCount - 1);
+	for(S32 i=sgLightBinBuckets[bucket]; i!=-1; i=sgLightBinCells[i].sgNext)
+	{
+		if((sgLightBinCells[i].sgX == x) && (sgLightBinCells[i].sgY == y))
+			return i;
+	}
+
+	if(!create)
+		return -1;
+
+	sgLightBinCells.increment();
+	sgLightBinCell &cell = sgLightBinCells.last();
+	cell.sgX = x;
+	cell.sgY = y;
+	cell.sgSignature = 0;
+	cell.sgChangedGeneration = sgLightBinGeneration;
+	cell.sgFirst = 0;
+	cell.sgCount = 0;
+	cell.sgNext = sgLightBinBuckets[bucket];
+	sgLightBinBuckets[bucket] = sgLightBinCells.size() - 1;
+	return sgLightBinCells.size() - 1;
+}
+
+void LightManager::sgRebuildLightBinBuckets()
+{
+	for(U32 i=0; i<sgLightBinBucketCount; i++)
+		sgLightBinBuckets[i] = -1;
+	for(U32 i=0; i<sgLightBinCells.size(); i++)
+	{
+		sgLightBinCell &cell = sgLightBinCells[i];
+		U32 bucket = U32((cell.sgX * 73856093) ^ (cell.sgY * 19349663)) & (sgLightBinBucketCount - 1);
+		cell.sgNext = sgLightBinBuckets[bucket];
+		sgLightBinBuckets[bucket] = i;
+	}
+}
+
+S32 QSORT_CALLBACK LightManager::sgSortLightBinPairs(const void *a, const void *b)
+{
+	const sgLightBinPair *pa = (const sgLightBinPair *)a;
+	const sgLightBinPair *pb = (const sgLightBinPair *)b;
+	if(pa->sgCell != pb->sgCell)
+		return pa->sgCell - pb->sgCell;
+	if(pa->sgLight == pb->sgLight)
+		return 0;
+	return (pa->sgLight < pb->sgLight) ? -1 : 1;
+}
+
+void LightManager::sgBinGlobalLights()
+{
+	PROFILE_START(LightManager_sgBinGlobalLights);
+
+	sgLightBinsDirty = false;
+	sgLightBinGeneration++;
+
+	LightInfoList lights;
+	lights.merge(sgRegisteredGlobalLights);
+	sgRemoveDuplicateLights(lights);
+
+	sgUnboundedLights.clear();
+	sgLightBinPairs.clear();
+	for(U32 i=0; i<sgLightBinCells.size(); i++)
+		sgLightBinCells[i].sgCount = 0;
+
+	for(U32 i=0; i<lights.size(); i++)
+	{
+		LightInfo *light = lights[i];
+		if((light->mType == LightInfo::Vector) || (light->mType == LightInfo::Ambient))
+		{
+			sgUnboundedLights.push_back(light);
+			continue;
+		}
+
+		F32 reach = sgGetLightReach(light);
+		Box3F box(light->mPos - Point3F(reach, reach, reach), light->mPos + Point3F(reach, reach, reach));
+		S32 minx, miny, maxx, maxy;
+		sgGetLightBinRange(box, minx, miny, maxx, maxy);
+		if((F32(maxx - minx + 1) * F32(maxy - miny + 1)) > F32(sgMaxLightBinCellsPerLight))
+		{
+			sgUnboundedLights.push_back(light);
+			continue;
+		}
+
+		for(S32 y=miny; y<=maxy; y++)
+		{
+			for(S32 x=minx; x<=maxx; x++)
+			{
+				sgLightBinPairs.increment();
+				sgLightBinPairs.last().sgCell = sgFindLightBinCell(x, y, true);
+				sgLightBinPairs.last().sgLight = light;
+			}
+		}
+	}
+
+	// group the lights by cell...
+	dQsort(sgLightBinPairs.address(), sgLightBinPairs.size(), sizeof(sgLightBinPair), sgSortLightBinPairs);
+	sgLightBinEntries.setSize(sgLightBinPairs.size());
+	for(U32 i=0; i<sgLightBinPairs.size(); i++)
+	{
+		sgLightBinCell &cell = sgLightBinCells[sgLightBinPairs[i].sgCell];
+		if(cell.sgCount == 0)
+			cell.sgFirst = i;
+		cell.sgCount++;
+		sgLightBinEntries[i] = sgLightBinPairs[i].sgLight;
+	}
+
+	// see what changed, and drop the cells that were empty last time as well...
+	U32 kept = 0;
+	for(U32 i=0; i<sgLightBinCells.size(); i++)
+	{
+		sgLightBinCell cell = sgLightBinCells[i];
+		U32 signature = 0;
+		for(U32 j=0; j<cell.sgCount; j++)
+			signature = sgGetLightSignature(sgLightBinEntries[cell.sgFirst + j], signature);
+		if(signature != cell.sgSignature)
+		{
+			cell.sgSignature = signature;
+			cell.sgChangedGeneration = sgLightBinGeneration;
+		}
+
+		if((cell.sgCount == 0) && (cell.sgChangedGeneration != sgLightBinGeneration))
+			continue;
+		sgLightBinCells[kept++] = cell;
+	}
+	sgLightBinCells.setSize(kept);
+	sgRebuildLightBinBuckets();
+
+	U32 signature = 0;
+	for(U32 i=0; i<sgUnboundedLights.size(); i++)
+		signature = sgGetLightSignature(sgUnboundedLights[i], signature);
+	if(signature != sgUnboundedSignature)
+	{
+		sgUnboundedSignature = signature;
+		sgUnboundedChangedGeneration = sgLightBinGeneration;
+	}
+
+	PROFILE_END();
+}
+
+void LightManager::sgGetBinnedLights(const Box3F &box, LightInfoList &list)
+{
+	list.clear();
+	list.merge(sgUnboundedLights);
+
+	S32 minx, miny, maxx, maxy;
+	sgGetLightBinRange(box, minx, miny, maxx, maxy);
+	if((F32(maxx - minx + 1) * F32(maxy - miny + 1)) > F32(sgLightBinCells.size()))
+	{
+		// bigger than the binned area, cheaper to walk the cells...
+		for(U32 i=0; i<sgLightBinCells.size(); i++)
+		{
+			const sgLightBinCell &cell = sgLightBinCells[i];
+			if((cell.sgX < minx) || (cell.sgX > maxx) || (cell.sgY < miny) || (cell.sgY > maxy))
+				continue;
+			for(U32 j=0; j<cell.sgCount; j++)
+				list.push_back(sgLightBinEntries[cell.sgFirst + j]);
+		}
+	}
+	else
+	{
+		for(S32 y=miny; y<=maxy; y++)
+		{
+			for(S32 x=minx; x<=maxx; x++)
+			{
+				S32 c = sgFindLightBinCell(x, y, false);
+				if(c == -1)
+					continue;
+				const sgLightBinCell &cell = sgLightBinCells[c];
+				for(U32 j=0; j<cell.sgCount; j++)
+					list.push_back(sgLightBinEntries[cell.sgFirst + j]);
+			}
+		}
+	}
+
+	sgRemoveDuplicateLights(list);
+}
+
+bool LightManager::sgLightBinsChangedSince(const Box3F &box, U32 generation)
+{
+	if(sgUnboundedChangedGeneration > generation)
+		return true;
+
+	// a cell that's gone was empty at the last two binnings, so it didn't change...
+	S32 minx, miny, maxx, maxy;
+	sgGetLightBinRange(box, minx, miny, maxx, maxy);
+	if((F32(maxx - minx + 1) * F32(maxy - miny + 1)) > F32(sgLightBinCells.size()))
+	{
+		for(U32 i=0; i<sgLightBinCells.size(); i++)
+		{
+			const sgLightBinCell &cell = sgLightBinCells[i];
+			if((cell.sgX < minx) || (cell.sgX > maxx) || (cell.sgY < miny) || (cell.sgY > maxy))
+				continue;
+			if(cell.sgChangedGeneration > generation)
+				return true;
+		}
+		return false;
+	}
+
+	for(S32 y=miny; y<=maxy; y++)
+	{
+		for(S32 x=minx; x<=maxx; x++)
+		{
+			S32 c = sgFindLightBinCell(x, y, false);
+			if((c != -1) && (sgLightBinCells[c].sgChangedGeneration > generation))
+				return true;
+		}
+	}
+	return false;
+}
+
 void LightManager::sgScoreLight(LightInfo *light, SceneObject *obj, const Box3F &box, const SphereF &sphere, bool camerabased)
 {
 	if(sgFilterZones && light->sgDiffuseRestrictZone)
@@ -609,6 +962,8 @@ void LightManager::sgInit()
 	Con::addVariable("$pref::LightManager::sgDynamicParticleSystemLighting", TypeBool, &sgDynamicParticleSystemLighting);
 	Con::addVariable("$pref::LightManager::sgBlendedTerrainDynamicLighting", TypeBool, &sgBlendedTerrainDynamicLighting);
 	Con::addVariable("$pref::LightManager::sgMaxBestLights", TypeS32, &sgMaxBestLights);
+	Con::addVariable("$pref::LightManager::sgUseLightBins", TypeBool, &sgUseLightBins);
+	Con::addVariable("$pref::LightManager::sgLightBinSize", TypeF32, &sgLightBinSize);
 	Con::addVariable("$pref::LightManager::sgLightingProfileQuality", TypeS32, &sgLightingProfileQuality);
 	Con::addVariable("$pref::LightManager::sgLightingProfileAllowShadows", TypeBool, &sgLightingProfileAllowShadows);
 
@@ -834,6 +1189,8 @@ void sgRelightFilter::sgInit()
 
 bool sgRelightFilter::sgAllowLighting(const Box3F &box, bool forcefilter)
 {
+#ifndef TORQUE_HEADLESS
+	// the distance is from the editor's camera
 	if((sgRelightFilter::sgFilterRelight && sgRelightFilter::sgFilterRelightByDistance) || forcefilter)
 	{
 		if(!sgRelightFilter::sgFilterRelightVisible)
@@ -854,12 +1211,14 @@ bool sgRelightFilter::sgAllowLighting(const Box3F &box, bool forcefilter)
 		if(!box.isOverlapped(lightbox))
 			return false;
 	}
+#endif
 
 	return true;
 }
 
 void sgRelightFilter::sgRenderAllowedObjects(void *editor)
 {
+#ifndef TORQUE_HEADLESS
 	U32 i;
 	WorldEditor *worldeditor = (WorldEditor *)editor;
 	Vector<SceneObject *> objects;
@@ -878,5 +1237,6 @@ void sgRelightFilter::sgRenderAllowedObjects(void *editor)
 
 		worldeditor->renderObjectBox(obj, color);
 	}
+#endif
 }
 
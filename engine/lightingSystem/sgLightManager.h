@@ -18,6 +18,9 @@
 #ifndef _DATACHUNKER_H_
 #include "core/dataChunker.h"
 #endif
+#ifndef _PLATFORMATOMIC_H_
+#include "platform/platformAtomic.h"
+#endif
 #include "console/console.h"
 #include "console/consoleTypes.h"
 #include "core/stringTable.h"
@@ -112,12 +115,23 @@ public:
 	LightManager()
    {
       dMemset(&sgSpecialLights, 0, sizeof(sgSpecialLights));
+      sgLightBinBuckets.setSize(sgLightBinBucketCount);
+      for(U32 i=0; i<sgLightBinBucketCount; i++)
+         sgLightBinBuckets[i] = -1;
+      sgUnboundedSignature = 0;
+      sgUnboundedChangedGeneration = 0;
+      sgLightBinGeneration = 0;
+      sgLightBinsDirty = true;
       sgInit();
    }
 
 	// registered before scene traversal...
 	void sgRegisterGlobalLight(LightInfo *light);
-	void sgUnregisterGlobalLight(LightInfo *light) {sgRegisteredGlobalLights.sgUnregisterLight(light);}
+	void sgUnregisterGlobalLight(LightInfo *light)
+	{
+		sgRegisteredGlobalLights.sgUnregisterLight(light);
+		sgLightBinsDirty = true;
+	}
 	// registered per object...
 	void sgRegisterLocalLight(LightInfo *light) {sgRegisteredLocalLights.sgRegisterLight(light);}
 	void sgUnregisterLocalLight(LightInfo *light) {sgRegisteredLocalLights.sgUnregisterLight(light);}
@@ -170,6 +184,82 @@ private:
 
 	// used in DTS lighting...
 	void sgScoreLight(LightInfo *light, SceneObject *obj, const Box3F &box, const SphereF &sphere, bool camerabased);
+	// sorts the best lights by score and keeps the top maxlights that score...
+	void sgSortBestLights(S32 maxlights);
+	static void sgRemoveDuplicateLights(LightInfoList &list);
+
+	/// @name Light binning
+	/// The global point and spot lights are binned over x and y by how far
+	/// they can reach, once each time the global lights change, so an object
+	/// only scores the lights in the cells around it.  Lights that reach
+	/// everywhere, or over too many cells, are kept aside and always scored.
+	///
+	/// Each cell keeps a signature of the lights in it and the generation of
+	/// the binning that last changed it.  An object's scored lights are kept
+	/// and used again on the next binning when its box is the same and none
+	/// of the cells it sees changed.
+	/// @{
+	enum
+	{
+		sgLightBinBucketCount = 512,
+		sgMaxLightBinCellsPerLight = 64
+	};
+	struct sgLightBinCell
+	{
+		S32 sgX;
+		S32 sgY;
+		U32 sgSignature;
+		U32 sgChangedGeneration;
+		U32 sgFirst;            ///< Into sgLightBinEntries.
+		U32 sgCount;
+		S32 sgNext;             ///< Next cell in the bucket.
+	};
+	struct sgLightBinPair
+	{
+		S32 sgCell;
+		LightInfo *sgLight;
+	};
+	Vector<sgLightBinCell> sgLightBinCells;
+	Vector<S32> sgLightBinBuckets;
+	Vector<sgLightBinPair> sgLightBinPairs;
+	LightInfoList sgLightBinEntries;
+	LightInfoList sgUnboundedLights;
+	U32 sgUnboundedSignature;
+	U32 sgUnboundedChangedGeneration;
+	U32 sgLightBinGeneration;
+	bool sgLightBinsDirty;
+
+	void sgBinGlobalLights();
+	S32 sgFindLightBinCell(S32 x, S32 y, bool create);
+	void sgRebuildLightBinBuckets();
+	static void sgGetLightBinRange(const Box3F &box, S32 &minx, S32 &miny, S32 &maxx, S32 &maxy);
+	static F32 sgGetLightReach(LightInfo *light);
+	static U32 sgGetLightSignature(LightInfo *light, U32 crc);
+	static S32 QSORT_CALLBACK sgSortLightBinPairs(const void *, const void *);
+	/// Lights that may reach into box, without dupes.
+	void sgGetBinnedLights(const Box3F &box, LightInfoList &list);
+	/// True if any cell in box changed after generation.
+	bool sgLightBinsChangedSince(const Box3F &box, U32 generation);
+
+	struct sgCachedLight
+	{
+		LightInfo *sgLight;
+		S32 sgScore;
+		F32 sgOcclusionAdjust;
+	};
+	struct sgLightAssignment
+	{
+		SceneObject *sgObject;
+		U32 sgGeneration;
+		Box3F sgBox;
+		S32 sgMaxLights;
+		bool sgCameraBased;
+		bool sgFilterZones;
+		S32 sgZones[2];
+	};
+	typedef hash_multimap<sgCachedLight, sgLightAssignment> sgLightAssignmentEntry;
+	sgLightAssignmentEntry sgLightAssignments;
+	/// @}
 
 public:
 	enum lightingProfileQualityType
@@ -229,6 +319,8 @@ private:
 	static S32 sgZones[2];
 	static S32 sgMaxBestLights;
 	static bool sgInGUIEditor;
+	static bool sgUseLightBins;
+	static F32 sgLightBinSize;
 
 public:
 	static bool sgMultipleDynamicShadows;
@@ -392,7 +484,7 @@ public:
 	}
 	~elapsedTimeAggregate()
 	{
-		*resultVar += (Platform::getRealMilliseconds() - time);
+		dFetchAndAdd(*resultVar, Platform::getRealMilliseconds() - time);
 	}
 };
 
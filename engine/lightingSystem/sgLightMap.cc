@@ -13,10 +13,13 @@
 #include "sceneGraph/sceneGraph.h"
 #include "terrain/terrData.h"
 #include "platform/profiler.h"
+#include "platform/platformAtomic.h"
+#include "platform/platformMutex.h"
 #include "interior/interior.h"
 #include "interior/interiorInstance.h"
 #include "lightingSystem/sgLightMap.h"
 #include "lightingSystem/sgLightingModel.h"
+#include "lightingSystem/sgShadowBVH.h"
 
 #include "math/mRandom.h"
 #include "math/mathUtils.h"
@@ -29,14 +32,11 @@
 
 #define SG_STATICMESH_BVPT_SHADOWS
 
-bool badtexgen = false;
-
-
 Vector<sgShadowObjects::sgObjectInfo *> sgShadowObjects::sgObjectInfoStorage;
 sgShadowObjects::sgStaticMeshBVPTEntry sgShadowObjects::sgStaticMeshBVPTMap;
 VectorPtr<SceneObject *> sgShadowObjects::sgObjects;
-
-U32 sgPlanarLightMap::sgCurrentOccluderMaskId = 0;
+bool sgShadowObjects::sgThreadedLighting = false;
+void *sgShadowObjects::sgCastMutex = NULL;
 
 
 /// used to generate light map indexes that wrap around
@@ -98,7 +98,7 @@ void sgShadowObjects::sgGetObjects(SceneObject *obj)
 	obj->getContainer()->findObjects(ShadowCasterObjectType, &sgObjectCallback, &sgObjects);
 }
 
-bool sgShadowObjects::sgCastRayStaticMesh(Point3F s, Point3F e, ConstructorSimpleMesh *staticmesh)
+sgShadowObjects::sgObjectInfo *sgShadowObjects::sgGetStaticMeshInfo(ConstructorSimpleMesh *staticmesh)
 {
    sgStaticMeshBVPTEntry *entry = sgStaticMeshBVPTMap.find(U32(staticmesh));
    AssertFatal((entry), "hash_map should always return an entry!");
@@ -106,6 +106,8 @@ bool sgShadowObjects::sgCastRayStaticMesh(Point3F s, Point3F e, ConstructorSimpl
    // is the BVPT there?
    if(!entry->info)
    {
+      AssertFatal((!sgThreadedLighting), "sgShadowObjects: static mesh BVPT missed by sgBeginThreadedLighting.");
+
       sgObjectInfo *objinfo = new sgObjectInfo();
       entry->info = objinfo;
       sgObjectInfoStorage.push_back(objinfo);
@@ -182,8 +184,35 @@ bool sgShadowObjects::sgCastRayStaticMesh(Point3F s, Point3F e, ConstructorSimpl
       }
    }
 
+   return entry->info;
+}
+
+/// Tests the static mesh triangles the BVPT walk finds against one ray,
+/// stopping the walk at the first hit.
+struct sgStaticMeshRayVisitor
+{
+   Point3F sgStart;
+   Point3F sgVect;
+   U32 sgOccluderCount;
+
+   bool operator()(sgShadowObjects::sgStaticMeshTri *tri)
+   {
+      if(mDot(tri->sgPlane, sgVect) >= 0.0f)
+         return false;
+
+      //stats
+      sgOccluderCount++;
+
+      F32 raycastdist;
+      Point2F temp2;
+      return castRayTriangle(sgStart, sgVect, tri->sgVert[0], tri->sgVert[1], tri->sgVert[2], raycastdist, temp2);
+   }
+};
+
+bool sgShadowObjects::sgCastRayStaticMesh(Point3F s, Point3F e, ConstructorSimpleMesh *staticmesh)
+{
    // convert to static mesh space...
-   sgObjectInfo *objinfo = entry->info;
+   sgObjectInfo *objinfo = sgGetStaticMeshInfo(staticmesh);
    objinfo->sgInverseTransform.mulP(s);
    objinfo->sgInverseTransform.mulP(e);
    s.convolveInverse(staticmesh->scale);
@@ -195,34 +224,50 @@ bool sgShadowObjects::sgCastRayStaticMesh(Point3F s, Point3F e, ConstructorSimpl
    if(!staticmesh->bounds.collideLine(s, e, &t, &n))
       return false;
 
-   // get the likely occluders...
-   sgStaticMeshBVPT::objectList list;
-   objinfo->sgBVPT.collectObjectsClipped(s, e, list);
-   //objinfo->sgBVPT.collectObjects(staticmesh->bounds, list);
-
-   Point3F vect = e - s;
-	F32 raycastdist;
-	Point2F temp2;
+   // cast against the likely occluders as the walk finds them...
+   sgStaticMeshRayVisitor visitor;
+   visitor.sgStart = s;
+   visitor.sgVect = e - s;
+   visitor.sgOccluderCount = 0;
+   bool hit = objinfo->sgBVPT.visitObjectsClipped(s, e, visitor);
 
-   // now cast against them...
-   U32 tc = list.size();
-   sgStaticMeshTri **tris = list.address();
+   if(visitor.sgOccluderCount)
+      dFetchAndAdd(sgStatistics::sgStaticMeshSurfaceOccluderCount, visitor.sgOccluderCount);
+   return hit;
+}
 
-   for(U32 i=0; i<tc; i++)
+void sgShadowObjects::sgBuildStaticMeshInfo(InteriorInstance *interior)
+{
+   InteriorResource *res = interior->getResource();
+   for(U32 d=0; d<res->getNumDetailLevels(); d++)
    {
-      sgStaticMeshTri *tri = tris[i];
+      Interior *detail = res->getDetailLevel(d);
+      for(U32 sm=0; sm<detail->getStaticMeshCount(); sm++)
+         sgGetStaticMeshInfo((ConstructorSimpleMesh *)detail->getStaticMesh(sm));
+   }
+}
 
-      if(mDot(tri->sgPlane, vect) >= 0.0f)
-         continue;
+void sgShadowObjects::sgBeginThreadedLighting(InteriorInstance *interior)
+{
+   AssertFatal((!sgThreadedLighting), "sgShadowObjects: threaded lighting already started.");
 
-      //stats
-      sgStatistics::sgStaticMeshSurfaceOccluderCount++;
-      
-      if(castRayTriangle(s, vect, tri->sgVert[0], tri->sgVert[1], tri->sgVert[2], raycastdist, temp2))
-         return true;
+   // the casts find these, building them here keeps the map read only...
+   sgBuildStaticMeshInfo(interior);
+   for(U32 i=0; i<sgObjects.size(); i++)
+   {
+      InteriorInstance *inst = dynamic_cast<InteriorInstance *>(sgObjects[i]);
+      if(inst)
+         sgBuildStaticMeshInfo(inst);
    }
 
-   return false;
+   if(!sgCastMutex)
+      sgCastMutex = Mutex::createMutex();
+   sgThreadedLighting = true;
+}
+
+void sgShadowObjects::sgEndThreadedLighting()
+{
+   sgThreadedLighting = false;
 }
 
 void sgShadowObjects::sgClearStaticMeshBVPTData()
@@ -354,6 +399,19 @@ void sgLightMap::sgGetIntersectingObjects(const Box3F &surfacebox, const SceneOb
 
 bool sgPlanarLightMap::sgCastRay(Point3F s, Point3F e, SceneObject *obj, Interior *detail, ConstructorSimpleMesh *sm, sgOccluder &occluderinfo)
 {
+   // shapes and terrain are in the shadow BVH, which takes world space
+   // casts from any thread...
+   if(!sm && !detail && !(obj->getTypeMask() & InteriorObjectType) && sgShadowBVH::sgContains(obj))
+   {
+      sgShadowBVH::sgHit hit;
+      if(!sgShadowBVH::sgCastRay(s, e, obj, &hit))
+         return false;
+
+      occluderinfo.sgObject = obj;
+      occluderinfo.sgSurface = hit.sgSurface;
+      return true;
+   }
+
    obj->getWorldTransform().mulP(s);
    obj->getWorldTransform().mulP(e);
    s.convolveInverse(obj->getScale());
@@ -397,6 +455,11 @@ bool sgPlanarLightMap::sgCastRay(Point3F s, Point3F e, SceneObject *obj, Interio
    }
    else
    {
+      // shape and terrain casts keep their state in statics...
+      MutexHandle handle;
+      if(sgShadowObjects::sgIsThreadedLighting() && !(obj->getTypeMask() & InteriorObjectType))
+         handle.lock(sgShadowObjects::sgGetCastMutex());
+
       RayInfo ri;
       if(!obj->castRay(s, e, &ri))
          return false;
@@ -431,7 +494,7 @@ void sgPlanarLightMap::sgSetupLighting()
 {
    // stats
    elapsedTimeAggregate time = elapsedTimeAggregate(sgStatistics::sgInteriorSurfaceSetupTime);
-   sgStatistics::sgInteriorSurfaceSetupCount++;
+   dFetchAndAdd(sgStatistics::sgInteriorSurfaceSetupCount, 1);
 
 	// get tranformed points...
 	U32 windingcount = triStrip.size();
@@ -473,7 +536,7 @@ void sgPlanarLightMap::sgSetupLighting()
 	}
 
    // try again...
-   badtexgen = false;
+   bool badtexgen = false;
    if(sgSAxis == sgTAxis)
    {
       // find the axis with the minimal diff (the bad axis)...
@@ -571,12 +634,12 @@ void sgPlanarLightMap::sgSetupLighting()
 
 
 	// stats...
-	sgStatistics::sgInteriorSurfaceIncludedCount++;
+	dFetchAndAdd(sgStatistics::sgInteriorSurfaceIncludedCount, 1);
 	if(sgUseSmoothing)
 	{
-		sgStatistics::sgInteriorSurfaceSmoothedCount++;
-		sgStatistics::sgInteriorSurfaceSmoothedLexelCount +=
-			sgInnerLexels.size() + sgOuterLexels.size();
+		dFetchAndAdd(sgStatistics::sgInteriorSurfaceSmoothedCount, 1);
+		dFetchAndAdd(sgStatistics::sgInteriorSurfaceSmoothedLexelCount,
+			sgInnerLexels.size() + sgOuterLexels.size());
 	}
 }
 
@@ -778,17 +841,8 @@ void sgPlanarLightMap::sgBuildLexels(const Vector<sgSmoothingTri> &tris)
    }
 }
 
-void sgPlanarLightMap::sgCalculateLighting(LightInfo *light)
+bool sgPlanarLightMap::sgGetZoneLighting(LightInfo *light, bool &allowdiffuse, bool &allowambient)
 {
-	U32 o;
-	U32 i, ii;
-
-
-	// stats...
-	sgStatistics::sgInteriorSurfaceIlluminationCount++;
-   elapsedTimeAggregate time = elapsedTimeAggregate(sgStatistics::sgInteriorLexelTime);
-   
-   
    // setup zone info...
 	bool isinzone = false;
 	if(light->sgDiffuseRestrictZone || light->sgAmbientRestrictZone)
@@ -820,11 +874,21 @@ void sgPlanarLightMap::sgCalculateLighting(LightInfo *light)
 	}
 
 	// allow what?
-	bool allowdiffuse = (!light->sgDiffuseRestrictZone) || isinzone;
-	bool allowambient = (!light->sgAmbientRestrictZone) || isinzone;
+	allowdiffuse = (!light->sgDiffuseRestrictZone) || isinzone;
+	allowambient = (!light->sgAmbientRestrictZone) || isinzone;
 
 	// should I bother?
-	if((!allowdiffuse) && (!allowambient))
+	return allowdiffuse || allowambient;
+}
+
+void sgPlanarLightMap::sgCalculateLighting(LightInfo *light)
+{
+	// stats...
+	dFetchAndAdd(sgStatistics::sgInteriorSurfaceIlluminationCount, 1);
+   elapsedTimeAggregate time = elapsedTimeAggregate(sgStatistics::sgInteriorLexelTime);
+
+	bool allowdiffuse, allowambient;
+	if(!sgGetZoneLighting(light, allowdiffuse, allowambient))
 		return;
 
 	// first get lighting model...
@@ -841,6 +905,38 @@ void sgPlanarLightMap::sgCalculateLighting(LightInfo *light)
 	// this is slow, so do it after the early out...
 	model.sgInitStateLM();
 
+   // put rayCast into lighting mode...
+   Interior::smLightingCastRays = true;
+
+	sgLightLexels(light, model, allowdiffuse, allowambient);
+
+   // put rayCast back to normal mode...
+   Interior::smLightingCastRays = false;
+
+	model.sgResetState();
+}
+
+void sgPlanarLightMap::sgCalculateLighting(LightInfo *light, sgLightingModel &model)
+{
+	// stats...
+	dFetchAndAdd(sgStatistics::sgInteriorSurfaceIlluminationCount, 1);
+   elapsedTimeAggregate time = elapsedTimeAggregate(sgStatistics::sgInteriorLexelTime);
+
+	bool allowdiffuse, allowambient;
+	if(!sgGetZoneLighting(light, allowdiffuse, allowambient))
+		return;
+
+	// the model is shared, only read from it...
+	if(!model.sgCanIlluminate(sgSurfaceBox))
+		return;
+
+	sgLightLexels(light, model, allowdiffuse, allowambient);
+}
+
+void sgPlanarLightMap::sgLightLexels(LightInfo *light, sgLightingModel &model, bool allowdiffuse, bool allowambient)
+{
+	U32 i, ii;
+
 	// setup shadow objects...
 	Box3F lightvolume = sgSurfaceBox;
    if(light->mType == LightInfo::Vector)
@@ -865,15 +961,12 @@ void sgPlanarLightMap::sgCalculateLighting(LightInfo *light)
 
 
 	// stats...
-	sgStatistics::sgInteriorSurfaceIlluminatedCount++;
-	sgStatistics::sgInteriorLexelCount += sgInnerLexels.size() + sgOuterLexels.size();
-
-
-   // put rayCast into lighting mode...
-   Interior::smLightingCastRays = true;
+	dFetchAndAdd(sgStatistics::sgInteriorSurfaceIlluminatedCount, 1);
+	dFetchAndAdd(sgStatistics::sgInteriorLexelCount, sgInnerLexels.size() + sgOuterLexels.size());
 
 
 	Vector<sgOccluder> shadowingsurfaces;
+	U32 diffusecount = 0;
 	ColorF diffuse;
    ColorF ambient;
 	Point3F lightingnormal;
@@ -937,7 +1030,7 @@ void sgPlanarLightMap::sgCalculateLighting(LightInfo *light)
 			if(allowdiffuse && ((diffuse.red > SG_MIN_LEXEL_INTENSITY) || (diffuse.green > SG_MIN_LEXEL_INTENSITY) || (diffuse.blue > SG_MIN_LEXEL_INTENSITY)))
 			{
             // stats
-            sgStatistics::sgInteriorLexelDiffuseCount++;
+            diffusecount++;
 
 				// step four: check for shadows...
 				bool shadowed = false;
@@ -1067,10 +1160,7 @@ void sgPlanarLightMap::sgCalculateLighting(LightInfo *light)
 		}
 	}
 
-   // put rayCast back to normal mode...
-   Interior::smLightingCastRays = false;
-
-	model.sgResetState();
+	dFetchAndAdd(sgStatistics::sgInteriorLexelDiffuseCount, diffusecount);
 }
 
 void sgPlanarLightMap::sgMergeLighting(GBitmap *lightmap, U32 xoffset, U32 yoffset)
@@ -1114,6 +1204,33 @@ void sgPlanarLightMap::sgMergeLighting(GBitmap *lightmap, U32 xoffset, U32 yoffs
 
 //----------------------------------------------
 
+/// Lit terrain lexels waiting on their shadow test, which the shadow BVH
+/// runs four at a time.
+struct sgTerrainShadowPacket
+{
+	Point3F sgStart[4];
+	Point3F sgEnd[4];
+	S32 sgLexel[4];
+	ColorF sgDiffuse[4];
+	U32 sgCount;
+
+	sgTerrainShadowPacket() {sgCount = 0;}
+	/// Adds the diffuse of the unshadowed lexels to texels and empties the packet.
+	void sgFlush(ColorF *texels)
+	{
+		if(!sgCount)
+			return;
+
+		U32 blocked = sgShadowBVH::sgCastRay4(sgStart, sgEnd, ((1 << sgCount) - 1));
+		for(U32 i=0; i<sgCount; i++)
+		{
+			if(!(blocked & (1 << i)))
+				texels[sgLexel[i]] += sgDiffuse[i];
+		}
+		sgCount = 0;
+	}
+};
+
 void sgTerrainLightMap::sgCalculateLighting(LightInfo *light)
 {
 	// setup zone info...
@@ -1187,6 +1304,10 @@ void sgTerrainLightMap::sgCalculateLighting(LightInfo *light)
 	Point3F lightingnormal(0.0f, 0.0f, 0.0f);
 	
 	Point2F point = ((t * lmindexmin.y) + start + (s * lmindexmin.x));
+
+	bool castshadows = light->sgCastsShadows && LightManager::sgAllowShadows();
+	bool usepackets = castshadows && sgShadowBVH::sgContains(sgTerrain);
+	sgTerrainShadowPacket packet;
 	
 	for(lmy=lmindexmin.y; lmy<lmindexmax.y; lmy++)
 	{
@@ -1213,8 +1334,7 @@ void sgTerrainLightMap::sgCalculateLighting(LightInfo *light)
 				// step four: check for shadows...
 
 				bool shadowed = false;
-				RayInfo info;
-				if(light->sgCastsShadows && LightManager::sgAllowShadows())
+				if(castshadows)
 				{
 					// set light pos for shadows...
 					Point3F lightpos = light->mPos;
@@ -1225,12 +1345,28 @@ void sgTerrainLightMap::sgCalculateLighting(LightInfo *light)
 					}
 
 					// make texels terrain space coord into a world space coord...
-					RayInfo info;
-					if(sgTerrain->getContainer()->castRay(lightpos, (lexelworldpos + (lightingnormal * 0.5f)),
-						ShadowCasterObjectType, &info))
+					Point3F lexelpos = lexelworldpos + (lightingnormal * 0.5f);
+					if(usepackets)
 					{
+						// the packet applies the lighting when it's tested...
+						U32 i = packet.sgCount++;
+						packet.sgStart[i] = lightpos;
+						packet.sgEnd[i] = lexelpos;
+						packet.sgLexel[i] = lmindex;
+						packet.sgDiffuse[i] = diffuse;
+						if(packet.sgCount == 4)
+							packet.sgFlush(sgTexels->sgData);
 						shadowed = true;
 					}
+					else
+					{
+						RayInfo info;
+						if(sgTerrain->getContainer()->castRay(lightpos, lexelpos,
+							ShadowCasterObjectType, &info))
+						{
+							shadowed = true;
+						}
+					}
 				}
 
 				if(!shadowed)
@@ -1260,6 +1396,8 @@ void sgTerrainLightMap::sgCalculateLighting(LightInfo *light)
 
 		point = ((t * lmy) + start + (s * lmindexmin.x));
 	}
+
+	packet.sgFlush(sgTexels->sgData);
 	
 	model.sgResetState();
 
@@ -17,6 +17,7 @@
 #include "lightingSystem/sgBinaryVolumePartitionTree.h"
 #include "math/mBox.h"
 
+class sgLightingModel;
 
 class sgShadowObjects
 {
@@ -43,11 +44,26 @@ public:
    static bool sgCastRayStaticMesh(Point3F s, Point3F e, ConstructorSimpleMesh *staticmesh);
    static void sgClearStaticMeshBVPTData();
 
+   /// Prepares for lighting interior's light maps from several threads:
+   /// builds the BVPT of every static mesh in interior and sgObjects up
+   /// front, so the casts only read the map, and has casts against objects
+   /// that aren't reentrant (shapes and terrain) take sgCastMutex.
+   static void sgBeginThreadedLighting(InteriorInstance *interior);
+   static void sgEndThreadedLighting();
+   static bool sgIsThreadedLighting() {return sgThreadedLighting;}
+   static void *sgGetCastMutex() {return sgCastMutex;}
+
 private:
    /// master object info storage...
    static Vector<sgObjectInfo *> sgObjectInfoStorage;
    /// static mesh to BVPT mapping...
    static sgStaticMeshBVPTEntry sgStaticMeshBVPTMap;
+   static bool sgThreadedLighting;
+   static void *sgCastMutex;
+
+   /// returns the static mesh's BVPT, building it on first use...
+   static sgObjectInfo *sgGetStaticMeshInfo(ConstructorSimpleMesh *staticmesh);
+   static void sgBuildStaticMeshInfo(InteriorInstance *interior);
 
 public:
 	static VectorPtr<SceneObject *> sgObjects;
@@ -176,6 +192,7 @@ public:
 		: sgLightMap(width, height)
 	{
 		sgDirty = false;
+		sgCurrentOccluderMaskId = 0;
 		sgUseSmoothing = false;
       surfacePlane = surfaceplane;
       triStrip.clear();
@@ -192,10 +209,17 @@ public:
 	/// See: sgLightMap::sgCalculateLighting.
 	void sgSetupLighting();
 	virtual void sgCalculateLighting(LightInfo *light);
+	/// Same as sgCalculateLighting, but with the model's state (including
+	/// sgInitStateLM) and Interior::smLightingCastRays already set by the
+	/// caller, so light maps sharing the light can be lit concurrently.
+	void sgCalculateLighting(LightInfo *light, sgLightingModel &model);
 	bool sgIsDirty() {return sgDirty;}
 protected:
 	bool sgDirty;
-	static U32 sgCurrentOccluderMaskId;
+	U32 sgCurrentOccluderMaskId;
+	/// Checks the light's zone restrictions against the surface...
+	bool sgGetZoneLighting(LightInfo *light, bool &allowdiffuse, bool &allowambient);
+	void sgLightLexels(LightInfo *light, sgLightingModel &model, bool allowdiffuse, bool allowambient);
 	void sgBuildDerivatives(sgSmoothingTri &tri);
 	void sgBuildLexels(const Vector<sgSmoothingTri> &tris);
    bool sgCastRay(Point3F s, Point3F e, SceneObject *obj, Interior *detail, ConstructorSimpleMesh *sm, sgOccluder &occluderinfo);
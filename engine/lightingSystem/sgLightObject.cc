@@ -281,7 +281,7 @@ U32 sgLightObject::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
 			{
 				// transmit the id...
 				stream->writeFlag(true);
-				stream->writeInt(sgParticleEmitterGhostIndex, NetConnection::GhostIdBitSize);
+				con->packGhostIndex(stream, sgParticleEmitterGhostIndex);
 			}
 			else
 			{
@@ -294,7 +294,7 @@ U32 sgLightObject::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
 			//this is called on the client during recording
 			//and the server should've already provided the ghostid...
 			stream->writeFlag(true);
-			stream->writeInt(sgParticleEmitterGhostIndex, NetConnection::GhostIdBitSize);
+			con->packGhostIndex(stream, sgParticleEmitterGhostIndex);
 		}
 	}
 
@@ -307,7 +307,7 @@ U32 sgLightObject::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
 			{
 				// transmit the id...
 				stream->writeFlag(true);
-				stream->writeInt(sgAttachedObjectGhostIndex, NetConnection::GhostIdBitSize);
+				con->packGhostIndex(stream, sgAttachedObjectGhostIndex);
 			}
 			else
 			{
@@ -320,7 +320,7 @@ U32 sgLightObject::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
 			//this is called on the client during recording
 			//and the server should've already provided the ghostid...
 			stream->writeFlag(true);
-			stream->writeInt(sgAttachedObjectGhostIndex, NetConnection::GhostIdBitSize);
+			con->packGhostIndex(stream, sgAttachedObjectGhostIndex);
 		}
 	}
 
@@ -337,7 +337,7 @@ void sgLightObject::unpackUpdate(NetConnection *con, BitStream *stream)
 	if(stream->readFlag())
 	{
 		if(stream->readFlag())
-			sgParticleEmitterGhostIndex = stream->readInt(NetConnection::GhostIdBitSize);
+			sgParticleEmitterGhostIndex = con->unpackGhostIndex(stream);
 		else
 			sgParticleEmitterGhostIndex = -1;
 	}
@@ -346,7 +346,7 @@ void sgLightObject::unpackUpdate(NetConnection *con, BitStream *stream)
 	{
 		if(stream->readFlag())
 		{
-			sgAttachedObjectGhostIndex = stream->readInt(NetConnection::GhostIdBitSize);
+			sgAttachedObjectGhostIndex = con->unpackGhostIndex(stream);
 			mAttached = true;
 		}
 		else
@@ -18,6 +18,8 @@
 #include "game/tsStatic.h"
 #include "collision/concretePolyList.h"
 #include "lightingSystem/sgSceneLighting.h"
+#include "lightingSystem/sgLightingModel.h"
+#include "lightingSystem/sgShadowBVH.h"
 
 
 namespace
@@ -66,6 +68,9 @@ void SceneLighting::sgLightingStartEvent()
    // clear static mesh shadow data...
    sgShadowObjects::sgClearStaticMeshBVPTData();
 
+   // the static casters don't move while lighting...
+   sgShadowBVH::sgBuild(&gClientContainer);
+
 	// clear interior light maps
 	for(ObjectProxy **proxyItr = mSceneObjects.begin(); proxyItr != mSceneObjects.end(); proxyItr++)
 	{
@@ -78,7 +83,7 @@ void SceneLighting::sgLightingStartEvent()
 		}
 
 		InteriorInstance *interior = dynamic_cast<InteriorInstance *>((*proxyItr)->getObject());
-		if(!interior)
+		if(!interior || (*proxyItr)->mCached)
 			continue;
 
 		for(U32 d=0; d<interior->getResource()->getNumDetailLevels(); d++)
@@ -109,6 +114,7 @@ void SceneLighting::sgLightingCompleteEvent()
 
    // clear static mesh shadow data...
    sgShadowObjects::sgClearStaticMeshBVPTData();
+   sgShadowBVH::sgClear();
 
 	Con::printf("Scene lighting complete (%3.3f seconds)", (Platform::getRealMilliseconds()-sgTimeTemp2)/1000.f);
 	Con::printf("//-----------------------------------------------");
@@ -170,7 +176,7 @@ void SceneLighting::sgTGELightStartEvent(U32 light)
 		// if prelight works add to the list
 		if(dynamic_cast<TerrainProxy *>(*proxyItr))
 		{
-			if((*proxyItr)->preLight(lightobj))
+			if(!(*proxyItr)->mCached && (*proxyItr)->preLight(lightobj))
 				mLitObjects.push_back(*proxyItr);
 		}
 		else if(dynamic_cast<InteriorProxy *>(*proxyItr))
@@ -286,6 +292,10 @@ void SceneLighting::sgSGPassSetupEvent()
 			continue;
 		}
 
+		// already lit from the cache?
+		if((*proxyItr)->mCached)
+			continue;
+
 		// add all lights
 		mLitObjects.push_back(*proxyItr);
 	}
@@ -556,6 +566,9 @@ bool SceneLighting::light(BitSet32 flags)
 	// grab the missions crc
 	U32 missionCRC = calcMissionCRC();
 
+	for(ObjectProxy ** proxyItr = mSceneObjects.begin(); proxyItr != mSceneObjects.end(); proxyItr++)
+		(*proxyItr)->calcLightingKey(mLights);
+
 	// remove the '.mis' extension from the mission name
 	char misName[256];
 	dSprintf(misName, sizeof(misName), "%s", Con::getVariable("$Client::MissionFile"));
@@ -607,9 +620,20 @@ bool SceneLighting::light(BitSet32 flags)
 		}
 	}
 
+	// reuse the lighting of anything the edits didn't touch
+	if(!flags.test(ForceAlways|ForceWritable))
+	{
+		U32 count = loadCachedLighting(misName);
+		if(count)
+			Con::printf(" Reused the cached lighting of %d of %d objects.", count, mSceneObjects.size());
+	}
+
 	// initialize the objects for lighting
 	for(ObjectProxy ** proxyItr = mSceneObjects.begin(); proxyItr != mSceneObjects.end(); proxyItr++)
-		(*proxyItr)->init();
+	{
+		if(!(*proxyItr)->mCached)
+			(*proxyItr)->init();
+	}
 
 	// get things started
 	Sim::postEvent(this, new sgSceneLightingProcessEvent(0, -1,
@@ -830,6 +854,104 @@ bool SceneLighting::loadPersistInfo(const char * fileName)
 	return(true);
 }
 
+bool SceneLighting::isCachedLightingFile(const char *misName, const char *fileName)
+{
+	// <misName>_<crc>.ml, or <misName>_<crc>-raw.ml without full light maps
+	U32 len = dStrlen(misName);
+	if(dStrnicmp(fileName, misName, len) || (fileName[len] != '_'))
+		return(false);
+
+	const char *crc = fileName + len + 1;
+	const char *end = crc;
+	while(dIsdigit(*end) || ((*end >= 'a') && (*end <= 'f')) || ((*end >= 'A') && (*end <= 'F')))
+		end++;
+	if(end == crc)
+		return(false);
+
+	if(LightManager::sgAllowFullLightMaps())
+		return(!dStricmp(end, ".ml"));
+	return(!dStricmp(end, "-raw.ml"));
+}
+
+U32 SceneLighting::loadCachedLighting(const char *misName)
+{
+	// find the latest lighting file of this mission...
+	char pattern[1024];
+	dSprintf(pattern, sizeof(pattern), "%s_*.ml", misName);
+
+	const char *name;
+	const char *bestName = NULL;
+	FileTime bestTime;
+	ResourceObject *match = ResourceManager->findMatch(pattern, &name, 0);
+	while(match)
+	{
+		FileTime create, modify;
+		if((match->flags & ResourceObject::File) && dStricmp(name, mFileName) &&
+			isCachedLightingFile(misName, name) && Platform::getFileTimes(name, &create, &modify))
+		{
+			if(!bestName || (Platform::compareFileTimes(modify, bestTime) > 0))
+			{
+				bestName = StringTable->insert(name);
+				bestTime = modify;
+			}
+		}
+
+		match = ResourceManager->findMatch(pattern, &name, match);
+	}
+
+	if(!bestName)
+		return(0);
+
+	Stream *stream = ResourceManager->openStream(bestName);
+	if(!stream)
+		return(0);
+
+	PersistInfo persistInfo;
+	bool success = persistInfo.read(*stream);
+	ResourceManager->closeStream(stream);
+	if(!success)
+		return(0);
+
+	// match the chunks up by key, the object order may have changed
+	Vector<bool> used;
+	used.setSize(persistInfo.mChunks.size());
+	for(U32 c = 0; c < used.size(); c++)
+		used[c] = false;
+
+	U32 count = 0;
+	for(U32 i = 0; i < mSceneObjects.size(); i++)
+	{
+		ObjectProxy *proxy = mSceneObjects[i];
+
+		U32 chunkType;
+		if(isInterior(proxy->mObj))
+			chunkType = PersistInfo::PersistChunk::InteriorChunkType;
+		else if(isTerrain(proxy->mObj))
+			chunkType = PersistInfo::PersistChunk::TerrainChunkType;
+		else
+			continue;
+
+		// 0th chunk is the mission chunk
+		for(U32 c = 1; c < persistInfo.mChunks.size(); c++)
+		{
+			PersistInfo::PersistChunk *chunk = persistInfo.mChunks[c];
+			if(used[c] || (chunk->mChunkType != chunkType) ||
+				!proxy->isValidChunk(chunk) || (chunk->mLightingKey != proxy->mLightingKey))
+				continue;
+
+			used[c] = true;
+			if(proxy->setPersistInfo(chunk))
+			{
+				proxy->mCached = true;
+				count++;
+			}
+			break;
+		}
+	}
+
+	return(count);
+}
+
 bool SceneLighting::savePersistInfo(const char * fileName)
 {
 	// open the file
@@ -1100,12 +1222,94 @@ bool SceneLighting::ObjectProxy::isValidChunk(PersistInfo::PersistChunk * chunk)
 bool SceneLighting::ObjectProxy::getPersistInfo(PersistInfo::PersistChunk * chunk)
 {
 	chunk->mChunkCRC = mChunkCRC;
+	chunk->mLightingKey = mLightingKey;
 	return(true);
 }
 
 bool SceneLighting::ObjectProxy::setPersistInfo(PersistInfo::PersistChunk * chunk)
 {
 	mChunkCRC = chunk->mChunkCRC;
+	mLightingKey = chunk->mLightingKey;
 	return(true);
 }
 
+static U32 sgGetLightCRC(LightInfo *light)
+{
+	U32 crc = calculateCRC(&light->mType, sizeof(light->mType));
+	crc = calculateCRC(&light->mPos, sizeof(light->mPos), crc);
+	crc = calculateCRC(&light->mDirection, sizeof(light->mDirection), crc);
+	crc = calculateCRC(&light->mColor, sizeof(light->mColor), crc);
+	crc = calculateCRC(&light->mAmbient, sizeof(light->mAmbient), crc);
+	crc = calculateCRC(&light->mRadius, sizeof(light->mRadius), crc);
+	crc = calculateCRC(&light->sgSpotAngle, sizeof(light->sgSpotAngle), crc);
+	crc = calculateCRC(&light->sgCastsShadows, sizeof(light->sgCastsShadows), crc);
+	crc = calculateCRC(&light->sgDiffuseRestrictZone, sizeof(light->sgDiffuseRestrictZone), crc);
+	crc = calculateCRC(&light->sgAmbientRestrictZone, sizeof(light->sgAmbientRestrictZone), crc);
+	crc = calculateCRC(light->sgZone, sizeof(light->sgZone), crc);
+	crc = calculateCRC(&light->sgLocalAmbientAmount, sizeof(light->sgLocalAmbientAmount), crc);
+	crc = calculateCRC(&light->sgSmoothSpotLight, sizeof(light->sgSmoothSpotLight), crc);
+	crc = calculateCRC(&light->sgDoubleSidedAmbient, sizeof(light->sgDoubleSidedAmbient), crc);
+	if(light->sgLightingModelName)
+		crc = calculateCRC(light->sgLightingModelName, dStrlen(light->sgLightingModelName), crc);
+	return(crc);
+}
+
+static U32 sgGetPlacementCRC(SceneObject *obj, U32 crc)
+{
+	const MatrixF &transform = obj->getTransform();
+	crc = calculateCRC((const F32 *)transform, sizeof(F32) * 16, crc);
+	crc = calculateCRC(&obj->getScale(), sizeof(Point3F), crc);
+	return(calculateCRC(&obj->getObjBox(), sizeof(Box3F), crc));
+}
+
+void SceneLighting::ObjectProxy::calcLightingKey(const LightInfoList &lights)
+{
+	SceneObject *obj = getObject();
+	if(!obj)
+		return;
+
+	Vector<U32> crc;
+	crc.push_back(sgGetPlacementCRC(obj, mChunkCRC));
+
+	// the lights that reach the object...
+	const Box3F &box = obj->getWorldBox();
+	for(U32 i = 0; i < lights.size(); i++)
+	{
+		LightInfo *light = lights[i];
+		sgLightingModel &model = sgLightingModelManager::sgGetLightingModel(light->sgLightingModelName);
+		model.sgSetState(light);
+		bool reaches = model.sgCanIlluminate(box);
+		model.sgResetState();
+
+		if(reaches)
+			crc.push_back(sgGetLightCRC(light));
+	}
+
+	// and whatever could shadow it, out to the distance directional light
+	// shadows are cast from...
+	Box3F castbox = box;
+	castbox.min -= Point3F(100.0f, 100.0f, 100.0f);
+	castbox.max += Point3F(100.0f, 100.0f, 100.0f);
+
+	Vector<SceneObject *> casters;
+	gClientContainer.findObjects(castbox, ShadowCasterObjectType, sgFindObjectsCallback, &casters);
+	for(U32 i = 0; i < casters.size(); i++)
+	{
+		SceneObject *caster = casters[i];
+		if(caster == obj)
+			continue;
+
+		U32 castercrc = caster->getTypeMask() & ShadowCasterObjectType;
+		if(InteriorInstance *interior = dynamic_cast<InteriorInstance *>(caster))
+			castercrc = interior->getCRC();
+		else if(TerrainBlock *terrain = dynamic_cast<TerrainBlock *>(caster))
+			castercrc = terrain->getCRC();
+		crc.push_back(sgGetPlacementCRC(caster, castercrc));
+	}
+
+	// sort them, neither list has a stable order
+	dQsort(crc.address() + 1, crc.size() - 1, sizeof(U32), compareS32);
+
+	mLightingKey = calculateCRC(crc.address(), sizeof(U32) * crc.size(), 0xffffffff);
+}
+
@@ -66,6 +66,12 @@ public:
 	bool loadPersistInfo(const char *);
 	bool savePersistInfo(const char *);
 
+	/// Takes the lighting of every object whose lighting key is unchanged
+	/// from the last lighting file saved for the mission, so only objects
+	/// touched by an edit are relit.  Returns the number of objects reused.
+	U32 loadCachedLighting(const char *misName);
+	bool isCachedLightingFile(const char *misName, const char *fileName);
+
 	class ObjectProxy;
 	class TerrainProxy;
 	class InteriorProxy;
@@ -84,8 +90,11 @@ public:
 	public:
 		SimObjectPtr<SceneObject>     mObj;
 		U32                           mChunkCRC;
+		U32                           mLightingKey;
+		/// Lighting was taken from an older lighting file, don't relight.
+		bool                          mCached;
 
-		ObjectProxy(SceneObject * obj) : mObj(obj){mChunkCRC = 0;}
+		ObjectProxy(SceneObject * obj) : mObj(obj){mChunkCRC = 0; mLightingKey = 0; mCached = false;}
 		virtual ~ObjectProxy(){}
 		SceneObject * operator->() {return(mObj);}
 		SceneObject * getObject() {return(mObj);}
@@ -109,6 +118,11 @@ public:
 		bool calcValidation();
 		bool isValidChunk(PersistInfo::PersistChunk *);
 
+		/// Builds mLightingKey from everything the object's lighting
+		/// depends on: its resource CRC, transform and scale, the static
+		/// lights that can reach it and the shadow casters near it.
+		void calcLightingKey(const LightInfoList &lights);
+
 		virtual U32 getResourceCRC() = 0;
 		virtual bool setPersistInfo(PersistInfo::PersistChunk *);
 		virtual bool getPersistInfo(PersistInfo::PersistChunk *);
@@ -169,6 +183,11 @@ public:
 		void sgAddLight(LightInfo *light, InteriorInstance *interior);
 		//void sgLightUniversalPoint(LightInfo *light);
 		void sgProcessSurface(sgSurfaceInfo &surfaceinfo);
+		/// Lights surfaces [start, end) on the thread pool, see light().
+		void sgProcessSurfacesThreaded(U32 start, U32 end);
+		sgPlanarLightMap *sgCreateLightMap(sgSurfaceInfo &surfaceinfo);
+		bool sgCanLightSurface(LightInfo *light, sgSurfaceInfo &surfaceinfo);
+		void sgMergeLightMap(sgPlanarLightMap *lightmap, sgSurfaceInfo &surfaceinfo);
       void sgConvertStaticMeshPrimitiveToSurfaceInfo(const ConstructorSimpleMesh *staticmesh, U32 primitiveindex, Interior *detail, sgSurfaceInfo &surfaceinfo);
       void sgConvertInteriorSurfaceToSurfaceInfo(const Interior::Surface &surface, U32 i, Interior *detail, sgSurfaceInfo &surfaceinfo);
       void sgReorganizeSurface(sgSurfaceInfo &surfaceinfo);
@@ -21,6 +21,10 @@
 #include "lightingSystem/sgLightMap.h"
 #include "lightingSystem/sgSceneLightingGlobals.h"
 #include "lightingSystem/sgLightingModel.h"
+#include "core/threadPool.h"
+
+/// Surfaces lit per batch on the thread pool.
+static const U32 csSurfacesPerBatch = 4;
 
 
 /// adds the ability to bake point lights into interior light maps.
@@ -109,6 +113,20 @@ void SceneLighting::InteriorProxy::light(LightInfo *light)
 	sgStatistics::sgInteriorObjectIlluminationCount++;
 
 
+	// the pass is split into batches of surfaces spread over the pool; the
+	// progress reporting still sees the same passes...
+	if(gThreadPool && gThreadPool->isThreaded())
+	{
+		U32 end = sgSurfaces.size();
+		if(sgLights.last() != light)
+			end = getMin(end, sgCurrentSurfaceIndex + getMax(sgSurfacesPerPass, U32(1)));
+
+		if(sgCurrentSurfaceIndex < end)
+			sgProcessSurfacesThreaded(sgCurrentSurfaceIndex, end);
+		sgCurrentSurfaceIndex = end;
+		return;
+	}
+
 	for(i=sgCurrentSurfaceIndex; i<sgSurfaces.size(); i++)
 	{
 		sgProcessSurface(*sgSurfaces[i]);
@@ -429,7 +447,7 @@ void SceneLighting::InteriorProxy::sgExtractLightingInformation(const Interior *
 	//vectT.convolve(scale);
 }
 
-void SceneLighting::InteriorProxy::sgProcessSurface(sgSurfaceInfo &surfaceinfo)
+sgPlanarLightMap *SceneLighting::InteriorProxy::sgCreateLightMap(sgSurfaceInfo &surfaceinfo)
 {
    sgPlanarLightMap *lightmap = new sgPlanarLightMap(surfaceinfo.sgLightMapExtent.x, surfaceinfo.sgLightMapExtent.y,
       sgInterior, surfaceinfo.sgDetail, surfaceinfo.sgSurfaceIndex, surfaceinfo.sgStaticMesh, surfaceinfo.sgSurfacePlane, surfaceinfo.sgTriStrip);
@@ -438,38 +456,30 @@ void SceneLighting::InteriorProxy::sgProcessSurface(sgSurfaceInfo &surfaceinfo)
 	lightmap->sgLightMapSVector = surfaceinfo.sgSVector;
 	lightmap->sgLightMapTVector = surfaceinfo.sgTVector;
 	lightmap->sgSetupLighting();
+	return lightmap;
+}
 
-	for(U32 ii=0; ii<sgLights.size(); ii++)
-	{
-		// should we even bother?
-		LightInfo *light = sgLights[ii];
-
-      if(light->mType != LightInfo::Vector)
-      {
-         bool valid = false;
-         if(light->sgLocalAmbientAmount > SG_MIN_LEXEL_INTENSITY)
-            valid = true;
-         if(surfaceinfo.sgSurfacePlane.distToPlane(light->mPos) > 0)
-            valid = true;
-         for(U32 v=0; v<surfaceinfo.sgTriStrip.size(); v++)
-         {
-            sgPlanarLightMap::sgSmoothingVert &vert = surfaceinfo.sgTriStrip[v];
-            if(mDot(vert.sgNorm, (light->mPos - vert.sgVect)) > 0)
-               valid = true;
-         }
-
-         if(!valid)
-            continue;
-      }
-      else
-      {
-         if(!surfaceinfo.sgSurfaceOutsideVisible)
-            continue;
-      }
-
-      lightmap->sgCalculateLighting(light);
-	}
+bool SceneLighting::InteriorProxy::sgCanLightSurface(LightInfo *light, sgSurfaceInfo &surfaceinfo)
+{
+	// should we even bother?
+   if(light->mType == LightInfo::Vector)
+      return surfaceinfo.sgSurfaceOutsideVisible;
+
+   if(light->sgLocalAmbientAmount > SG_MIN_LEXEL_INTENSITY)
+      return true;
+   if(surfaceinfo.sgSurfacePlane.distToPlane(light->mPos) > 0)
+      return true;
+   for(U32 v=0; v<surfaceinfo.sgTriStrip.size(); v++)
+   {
+      sgPlanarLightMap::sgSmoothingVert &vert = surfaceinfo.sgTriStrip[v];
+      if(mDot(vert.sgNorm, (light->mPos - vert.sgVect)) > 0)
+         return true;
+   }
+   return false;
+}
 
+void SceneLighting::InteriorProxy::sgMergeLightMap(sgPlanarLightMap *lightmap, sgSurfaceInfo &surfaceinfo)
+{
 	if(lightmap->sgIsDirty())
 	{
       TextureHandle *normHandle = gInteriorLMManager.duplicateBaseLightmap(
@@ -477,10 +487,101 @@ void SceneLighting::InteriorProxy::sgProcessSurface(sgSurfaceInfo &surfaceinfo)
 		GBitmap *normLightmap = normHandle->getBitmap();
       lightmap->sgMergeLighting(normLightmap, surfaceinfo.sgLightMapOffset.x, surfaceinfo.sgLightMapOffset.y);
 	}
+}
 
+void SceneLighting::InteriorProxy::sgProcessSurface(sgSurfaceInfo &surfaceinfo)
+{
+   sgPlanarLightMap *lightmap = sgCreateLightMap(surfaceinfo);
+
+	for(U32 ii=0; ii<sgLights.size(); ii++)
+	{
+		LightInfo *light = sgLights[ii];
+      if(sgCanLightSurface(light, surfaceinfo))
+         lightmap->sgCalculateLighting(light);
+	}
+
+	sgMergeLightMap(lightmap, surfaceinfo);
 	delete lightmap;
 }
 
+namespace {
+
+struct sgSurfaceLightingJob
+{
+   SceneLighting::InteriorProxy *proxy;
+   SceneLighting::InteriorProxy::sgSurfaceInfo **surfaces;
+   sgPlanarLightMap **lightmaps;
+   LightInfo *light;
+   sgLightingModel *model;
+};
+
+void sgSetupSurfaces(U32 start, U32 end, void *userData)
+{
+   sgSurfaceLightingJob *job = (sgSurfaceLightingJob *)userData;
+   for(U32 i=start; i<end; i++)
+      job->lightmaps[i] = job->proxy->sgCreateLightMap(*job->surfaces[i]);
+}
+
+void sgLightSurfaces(U32 start, U32 end, void *userData)
+{
+   sgSurfaceLightingJob *job = (sgSurfaceLightingJob *)userData;
+   for(U32 i=start; i<end; i++)
+   {
+      if(job->proxy->sgCanLightSurface(job->light, *job->surfaces[i]))
+         job->lightmaps[i]->sgCalculateLighting(job->light, *job->model);
+   }
+}
+
+} // namespace {}
+
+/// Lights the surfaces one light at a time, with each light's surfaces
+/// spread over the pool.  Each light map still gets its lights added in
+/// the same order and the merges are done in surface order on this thread,
+/// so the result is the same as sgProcessSurface().
+void SceneLighting::InteriorProxy::sgProcessSurfacesThreaded(U32 start, U32 end)
+{
+   U32 count = end - start;
+   Vector<sgPlanarLightMap *> lightmaps;
+   lightmaps.setSize(count);
+
+   sgSurfaceLightingJob job;
+   job.proxy = this;
+   job.surfaces = sgSurfaces.address() + start;
+   job.lightmaps = lightmaps.address();
+   job.light = NULL;
+   job.model = NULL;
+
+   sgShadowObjects::sgBeginThreadedLighting(sgInterior);
+
+   gThreadPool->parallelFor(count, sgSetupSurfaces, &job, csSurfacesPerBatch);
+
+   // the lighting models are shared, so their state is set up out here
+   // and only read by the batches...
+   Interior::smLightingCastRays = true;
+	for(U32 ii=0; ii<sgLights.size(); ii++)
+	{
+      LightInfo *light = sgLights[ii];
+      sgLightingModel &model = sgLightingModelManager::sgGetLightingModel(light->sgLightingModelName);
+      model.sgSetState(light);
+      model.sgInitStateLM();
+
+      job.light = light;
+      job.model = &model;
+      gThreadPool->parallelFor(count, sgLightSurfaces, &job, csSurfacesPerBatch);
+
+      model.sgResetState();
+	}
+   Interior::smLightingCastRays = false;
+
+   sgShadowObjects::sgEndThreadedLighting();
+
+   for(U32 i=0; i<count; i++)
+   {
+      sgMergeLightMap(lightmaps[i], *sgSurfaces[start + i]);
+      delete lightmaps[i];
+   }
+}
+
 void SceneLighting::addInterior(ShadowVolumeBSP * shadowVolume, InteriorProxy & interior, LightInfo * light, S32 level)
 {
 	if(light->mType != LightInfo::Vector)
@@ -20,6 +20,7 @@
 #include "lightingSystem/sgSceneLighting.h"
 #include "lightingSystem/sgLightMap.h"
 #include "lightingSystem/sgSceneLightingGlobals.h"
+#include "core/threadPool.h"
 
 #define TERRAIN_OVERRANGE 2.0f
 
@@ -63,6 +64,7 @@ SceneLighting::TerrainProxy::TerrainProxy(SceneObject * obj) :
 Parent(obj)
 {
 	mLightmap = 0;
+	mShadowVolume = 0;
 
 	sgBakedLightmap = 0;
 }
@@ -70,6 +72,7 @@ Parent(obj)
 SceneLighting::TerrainProxy::~TerrainProxy()
 {
 	delete [] mLightmap;
+	delete mShadowVolume;
 
 	if(sgBakedLightmap)
 		delete[] sgBakedLightmap;
@@ -165,8 +168,11 @@ void SceneLighting::TerrainProxy::light(LightInfo * light)
 		return;
 	}
 
-	// reset
-	mShadowVolume = new ShadowVolumeBSP;
+	// reset, keeping the memory from the last light
+	if(mShadowVolume)
+		mShadowVolume->reset();
+	else
+		mShadowVolume = new ShadowVolumeBSP;
 
 	if((light->mType == LightInfo::Vector) && LightManager::sgAllowShadows())
 	{
@@ -200,8 +206,6 @@ void SceneLighting::TerrainProxy::light(LightInfo * light)
 
 	lightVector(light);
 
-	delete mShadowVolume;
-
 	//Con::printf("    = terrain lit in %3.3f seconds", (Platform::getRealMilliseconds()-time)/1000.f);
 }
 
@@ -355,6 +359,58 @@ bool SceneLighting::TerrainProxy::markInteriorShadow(InteriorProxy * proxy)
 	return(true);
 }
 
+//-------------------------------------------------------------------------------
+static const U32 csTerrainShadowTestsPerBatch = 64;
+
+/// a lexel that needs to be clipped against the interior shadows...
+struct sgTerrainShadowTest
+{
+	Point2F pos;
+	F32 height;
+	F32 xh;
+	F32 yh;
+};
+
+struct sgTerrainShadowJob
+{
+	ShadowVolumeBSP *bsp;
+	F32 lexelDim;
+	sgTerrainShadowTest *tests;
+	F32 *results;
+};
+
+/// returns the lit fraction of the lexel...
+static F32 sgTestLexelShadow(ShadowVolumeBSP *bsp, const Point2F &wPos, F32 lexelDim,
+	F32 height, F32 xh, F32 yh)
+{
+	ShadowVolumeBSP::SVPoly * poly = bsp->createPoly();
+	poly->mWindingCount = 4;
+	poly->mWinding[0].set(wPos.x, wPos.y, height);
+	poly->mWinding[1].set(wPos.x + lexelDim, wPos.y, height + xh);
+	poly->mWinding[2].set(wPos.x + lexelDim, wPos.y + lexelDim, height + xh + yh);
+	poly->mWinding[3].set(wPos.x, wPos.y + lexelDim, height + yh);
+	poly->mPlane.set(poly->mWinding[0], poly->mWinding[1], poly->mWinding[2]);
+
+	F32 lexelSize = bsp->getPolySurfaceArea(poly);
+	return bsp->getClippedSurfaceArea(poly) / lexelSize;
+}
+
+/// each batch clips with its own copy, the polys aren't thread safe...
+static void sgTestLexelShadows(U32 start, U32 end, void *userData)
+{
+	sgTerrainShadowJob *job = (sgTerrainShadowJob *)userData;
+
+	ShadowVolumeBSP bsp;
+	bsp.initQueryCopy(*job->bsp);
+
+	for(U32 i=start; i<end; i++)
+	{
+		const sgTerrainShadowTest &test = job->tests[i];
+		job->results[i] = sgTestLexelShadow(&bsp, test.pos, job->lexelDim,
+			test.height, test.xh, test.yh);
+	}
+}
+
 //-------------------------------------------------------------------------------
 // BUGS: does not work with x or y directions of 0
 //    : light dir of 0.1, 0.3, -0.8 causes strange behavior
@@ -462,372 +518,408 @@ void SceneLighting::TerrainProxy::lightVector(LightInfo * light)
 	U32 lightmapNormalOffset = lightmapStep >> 1;
 	U32 lightmapMask = lightmapStep - 1;
 
-	Point2I bp = blockFirstPos;
-	F32 terrainHeights[2][TerrainBlock::BlockSize];
-	U32 i;
-
-	F32 * pTerrainHeights = static_cast<F32*>(terrainHeights[0]);
-	F32 * pNextTerrainHeights = static_cast<F32*>(terrainHeights[1]);
-
-	// get first set of heights
-	for(i = 0; i < TerrainBlock::BlockSize; i++) {
-		pTerrainHeights[i] = fixedToFloat(terrain->getHeight(bp.x, bp.y));
-		bp += blockRowStep;
-	}
-
-	// get second set of heights
-	bp = blockFirstPos + blockColStep;
-	for(i = 0; i < TerrainBlock::BlockSize; i++) {
-		pNextTerrainHeights[i] = fixedToFloat(terrain->getHeight(bp.x, bp.y));
-		bp += blockRowStep;
-	}
-
-	F32 heightStep = 1.f / blockStep;
-
-	F32 terrainZRowStep[TerrainBlock::BlockSize];
-	F32 nextTerrainZRowStep[TerrainBlock::BlockSize];
-	F32 terrainZColStep[TerrainBlock::BlockSize];
-
-	// fill in the row steps
-	for(i = 0; i < TerrainBlock::BlockSize; i++)
+	// The interior shadow tests are most of the work, and don't depend on
+	// the sweep, so with a thread pool the sweep is run twice: once to
+	// find the lexels to test, which are then tested in parallel, and
+	// again to light the lexels with the results.  Same numbers either way.
+	bool deferTests = gThreadPool && gThreadPool->isThreaded() && mShadowVolume && mShadowVolume->mSVRoot;
+	Vector<sgTerrainShadowTest> tests;
+	Vector<F32> testResults;
+	U32 nextTest = 0;
+	F32 * normTable = NULL;
+
+	for(U32 pass = deferTests ? 0 : 1; pass < 2; pass++)
 	{
-		terrainZRowStep[i] = (pTerrainHeights[(i+1) & TerrainBlock::BlockMask] - pTerrainHeights[i]) * heightStep;
-		nextTerrainZRowStep[i] = (pNextTerrainHeights[(i+1) & TerrainBlock::BlockMask] - pNextTerrainHeights[i]) * heightStep;
-		terrainZColStep[i] = (pNextTerrainHeights[i] - pTerrainHeights[i]) * heightStep;
-	}
+		bool collect = (pass == 0);
 
-	// get first row of process heights
-	for(i = 0; i < generateDim; i++)
-	{
-		U32 bi = i >> blockShift;
-		heightArray[i] = pTerrainHeights[bi] + (i & blockMask) * terrainZRowStep[bi];
-	}
+		Point2I bp = blockFirstPos;
+		F32 terrainHeights[2][TerrainBlock::BlockSize];
+		U32 i;
 
-	bp = blockFirstPos;
-	if(generateDim == TerrainBlock::BlockSize)
-		bp += blockColStep;
+		F32 * pTerrainHeights = static_cast<F32*>(terrainHeights[0]);
+		F32 * pNextTerrainHeights = static_cast<F32*>(terrainHeights[1]);
 
-	// generate the initial run
-	U32 x, y;
-	for(x = 1; x < generateDim; x++)
-	{
-		U32 xmask = x & blockMask;
+		// get first set of heights
+		for(i = 0; i < TerrainBlock::BlockSize; i++) {
+			pTerrainHeights[i] = fixedToFloat(terrain->getHeight(bp.x, bp.y));
+			bp += blockRowStep;
+		}
 
-		// generate new height step rows?
-		if(!xmask)
-		{
-			F32 * tmp = pTerrainHeights;
-			pTerrainHeights = pNextTerrainHeights;
-			pNextTerrainHeights = tmp;
+		// get second set of heights
+		bp = blockFirstPos + blockColStep;
+		for(i = 0; i < TerrainBlock::BlockSize; i++) {
+			pNextTerrainHeights[i] = fixedToFloat(terrain->getHeight(bp.x, bp.y));
+			bp += blockRowStep;
+		}
 
-			bp += blockColStep;
+		F32 heightStep = 1.f / blockStep;
 
-			Point2I bwalk = bp;
-			for(i = 0; i < TerrainBlock::BlockSize; i++, bwalk += blockRowStep)
-				pNextTerrainHeights[i] = fixedToFloat(terrain->getHeight(bwalk.x, bwalk.y));
+		F32 terrainZRowStep[TerrainBlock::BlockSize];
+		F32 nextTerrainZRowStep[TerrainBlock::BlockSize];
+		F32 terrainZColStep[TerrainBlock::BlockSize];
 
-			// fill in the row steps
-			for(i = 0; i < TerrainBlock::BlockSize; i++)
-			{
-				terrainZRowStep[i] = (pTerrainHeights[(i+1) & TerrainBlock::BlockMask] - pTerrainHeights[i]) * heightStep;
-				nextTerrainZRowStep[i] = (pNextTerrainHeights[(i+1) & TerrainBlock::BlockMask] - pNextTerrainHeights[i]) * heightStep;
-				terrainZColStep[i] = (pNextTerrainHeights[i] - pTerrainHeights[i]) * heightStep;
-			}
+		// fill in the row steps
+		for(i = 0; i < TerrainBlock::BlockSize; i++)
+		{
+			terrainZRowStep[i] = (pTerrainHeights[(i+1) & TerrainBlock::BlockMask] - pTerrainHeights[i]) * heightStep;
+			nextTerrainZRowStep[i] = (pNextTerrainHeights[(i+1) & TerrainBlock::BlockMask] - pNextTerrainHeights[i]) * heightStep;
+			terrainZColStep[i] = (pNextTerrainHeights[i] - pTerrainHeights[i]) * heightStep;
 		}
 
-		Point2I bwalk = bp - blockRowStep;
-		for(y = 0; y < generateDim; y++)
+		// get first row of process heights
+		for(i = 0; i < generateDim; i++)
 		{
-			U32 ymask = y & blockMask;
-			if(!ymask)
-				bwalk += blockRowStep;
+			U32 bi = i >> blockShift;
+			heightArray[i] = pTerrainHeights[bi] + (i & blockMask) * terrainZRowStep[bi];
+		}
 
-			U32 bi = y >> blockShift;
-			U32 binext = (bi + 1) & TerrainBlock::BlockMask;
+		bp = blockFirstPos;
+		if(generateDim == TerrainBlock::BlockSize)
+			bp += blockColStep;
 
-			F32 height;
+		// generate the initial run
+		U32 x, y;
+		for(x = 1; x < generateDim; x++)
+		{
+			U32 xmask = x & blockMask;
 
-			// 135?
-			if((bwalk.x ^ bwalk.y) & 1)
-			{
-				U32 xsub = blockStep - xmask;
-				if(xsub > ymask) // bottom
-					height = pTerrainHeights[bi] + xmask * terrainZColStep[bi] +
-					ymask * terrainZRowStep[bi];
-				else // top
-					height = pNextTerrainHeights[bi] - xmask * terrainZColStep[binext] +
-					ymask * nextTerrainZRowStep[bi];
-			}
-			else
+			// generate new height step rows?
+			if(!xmask)
 			{
-				if(xmask > ymask) // bottom
-					height = pTerrainHeights[bi] + xmask * terrainZColStep[bi] +
-					ymask * nextTerrainZRowStep[bi];
-				else // top
-					height = pTerrainHeights[bi] + xmask * terrainZColStep[binext] +
-					ymask * terrainZRowStep[bi];
-			}
+				F32 * tmp = pTerrainHeights;
+				pTerrainHeights = pNextTerrainHeights;
+				pNextTerrainHeights = tmp;
 
-			F32 intHeight = heightArray[y] * oneMinusFrac + heightArray[(y + fracStep) & generateMask] * frac + zStep;
-			nextHeightArray[y] = getMax(height, intHeight);
-		}
+				bp += blockColStep;
 
-		// swap the height rows
-		F32 * tmp = heightArray;
-		heightArray = nextHeightArray;
-		nextHeightArray = tmp;
-	}
+				Point2I bwalk = bp;
+				for(i = 0; i < TerrainBlock::BlockSize; i++, bwalk += blockRowStep)
+					pNextTerrainHeights[i] = fixedToFloat(terrain->getHeight(bwalk.x, bwalk.y));
 
-	F32 squareSize = terrain->getSquareSize();
-	F32 lexelDim = squareSize * F32(TerrainBlock::BlockSize) / F32(TerrainBlock::LightmapSize);
+				// fill in the row steps
+				for(i = 0; i < TerrainBlock::BlockSize; i++)
+				{
+					terrainZRowStep[i] = (pTerrainHeights[(i+1) & TerrainBlock::BlockMask] - pTerrainHeights[i]) * heightStep;
+					nextTerrainZRowStep[i] = (pNextTerrainHeights[(i+1) & TerrainBlock::BlockMask] - pNextTerrainHeights[i]) * heightStep;
+					terrainZColStep[i] = (pNextTerrainHeights[i] - pTerrainHeights[i]) * heightStep;
+				}
+			}
 
-	// calculate normal runs
-	Point3F normals[2][TerrainBlock::BlockSize];
+			Point2I bwalk = bp - blockRowStep;
+			for(y = 0; y < generateDim; y++)
+			{
+				U32 ymask = y & blockMask;
+				if(!ymask)
+					bwalk += blockRowStep;
 
-	Point3F * pNormals = static_cast<Point3F*>(normals[0]);
-	Point3F * pNextNormals = static_cast<Point3F*>(normals[1]);
+				U32 bi = y >> blockShift;
+				U32 binext = (bi + 1) & TerrainBlock::BlockMask;
 
-	// calculate the normal lookup table
-	F32 * normTable = new F32 [blockStep * blockStep * 4];
+				F32 height;
 
-	Point2F corners[4] = {
-		Point2F(0.f, 0.f),
-			Point2F(1.f, 0.f),
-			Point2F(1.f, 1.f),
-			Point2F(0.f, 1.f)
-	};
+				// 135?
+				if((bwalk.x ^ bwalk.y) & 1)
+				{
+					U32 xsub = blockStep - xmask;
+					if(xsub > ymask) // bottom
+						height = pTerrainHeights[bi] + xmask * terrainZColStep[bi] +
+						ymask * terrainZRowStep[bi];
+					else // top
+						height = pNextTerrainHeights[bi] - xmask * terrainZColStep[binext] +
+						ymask * nextTerrainZRowStep[bi];
+				}
+				else
+				{
+					if(xmask > ymask) // bottom
+						height = pTerrainHeights[bi] + xmask * terrainZColStep[bi] +
+						ymask * nextTerrainZRowStep[bi];
+					else // top
+						height = pTerrainHeights[bi] + xmask * terrainZColStep[binext] +
+						ymask * terrainZRowStep[bi];
+				}
 
-	U32 idx = 0;
-	F32 step = 1.f / blockStep;
-	Point2F pos(0.f, 0.f);
+				F32 intHeight = heightArray[y] * oneMinusFrac + heightArray[(y + fracStep) & generateMask] * frac + zStep;
+				nextHeightArray[y] = getMax(height, intHeight);
+			}
 
-	// fill it
-	for(x = 0; x < blockStep; x++, pos.x += step, pos.y = 0.f) {
-		for(y = 0; y < blockStep; y++, pos.y += step) {
-			for(i = 0; i < 4; i++, idx++)
-				normTable[idx] = 1.f - getMin(Point2F(pos - corners[i]).len(), 1.f);
+			// swap the height rows
+			F32 * tmp = heightArray;
+			heightArray = nextHeightArray;
+			nextHeightArray = tmp;
 		}
-	}
-
-	// fill first column
-	bp = blockFirstPos;
-	for(x = 0; x < TerrainBlock::BlockSize; x++)
-	{
-		pNextTerrainHeights[x] = fixedToFloat(terrain->getHeight(bp.x, bp.y));
-		Point2F pos(bp.x * squareSize, bp.y * squareSize);
-		terrain->getNormal(pos, &pNextNormals[x]);
-		bp += blockRowStep;
-	}
 
-	// get swapped on first pass
-	pTerrainHeights = static_cast<F32*>(terrainHeights[1]);
-	pNextTerrainHeights = static_cast<F32*>(terrainHeights[0]);
+		F32 squareSize = terrain->getSquareSize();
+		F32 lexelDim = squareSize * F32(TerrainBlock::BlockSize) / F32(TerrainBlock::LightmapSize);
 
-	// get the world offset of the terrain
-	const MatrixF & transform = terrain->getTransform();
-	Point3F worldOffset;
-	transform.getColumn(3, &worldOffset);
+		// calculate normal runs
+		Point3F normals[2][TerrainBlock::BlockSize];
 
-	F32 ratio = F32(1 << lightmapShift);
-	F32 ratioSquared = ratio * ratio;
-	F32 inverseRatioSquared = 1.f / ratioSquared;
+		Point3F * pNormals = static_cast<Point3F*>(normals[0]);
+		Point3F * pNextNormals = static_cast<Point3F*>(normals[1]);
 
-	F32 lightScale[TerrainBlock::LightmapSize];
-
-	// walk it...
-	bp = blockFirstPos - blockColStep;
-	for(x = 0; x < generateDim; x++)
-	{
-		U32 xmask = x & blockMask;
-		U32 lxmask = x & lightmapMask;
+		// calculate the normal lookup table
+		normTable = new F32 [blockStep * blockStep * 4];
 
-		// generate new runs?
-		if(!xmask)
-		{
-			bp += blockColStep;
+		Point2F corners[4] = {
+			Point2F(0.f, 0.f),
+				Point2F(1.f, 0.f),
+				Point2F(1.f, 1.f),
+				Point2F(0.f, 1.f)
+		};
 
-			// do the normals
-			Point3F * temp = pNormals;
-			pNormals = pNextNormals;
-			pNextNormals = temp;
+		U32 idx = 0;
+		F32 step = 1.f / blockStep;
+		Point2F pos(0.f, 0.f);
 
-			// fill the row
-			Point2I bwalk = bp + blockColStep;
-			for(i = 0; i < TerrainBlock::BlockSize; i++)
-			{
-				Point2F pos(bwalk.x * squareSize, bwalk.y * squareSize);
-				terrain->getNormal(pos, &pNextNormals[i]);
-				bwalk += blockRowStep;
+		// fill it
+		for(x = 0; x < blockStep; x++, pos.x += step, pos.y = 0.f) {
+			for(y = 0; y < blockStep; y++, pos.y += step) {
+				for(i = 0; i < 4; i++, idx++)
+					normTable[idx] = 1.f - getMin(Point2F(pos - corners[i]).len(), 1.f);
 			}
+		}
 
-			// do the heights
-			F32 * tmp = pTerrainHeights;
-			pTerrainHeights = pNextTerrainHeights;
-			pNextTerrainHeights = tmp;
+		// fill first column
+		bp = blockFirstPos;
+		for(x = 0; x < TerrainBlock::BlockSize; x++)
+		{
+			pNextTerrainHeights[x] = fixedToFloat(terrain->getHeight(bp.x, bp.y));
+			Point2F pos(bp.x * squareSize, bp.y * squareSize);
+			terrain->getNormal(pos, &pNextNormals[x]);
+			bp += blockRowStep;
+		}
 
-			bwalk = bp + blockColStep;
-			for(i = 0; i < TerrainBlock::BlockSize; i++, bwalk += blockRowStep)
-				pNextTerrainHeights[i] = fixedToFloat(terrain->getHeight(bwalk.x, bwalk.y));
+		// get swapped on first pass
+		pTerrainHeights = static_cast<F32*>(terrainHeights[1]);
+		pNextTerrainHeights = static_cast<F32*>(terrainHeights[0]);
 
-			// fill in the row steps
-			for(i = 0; i < TerrainBlock::BlockSize; i++)
-			{
-				terrainZRowStep[i] = (pTerrainHeights[(i+1) & TerrainBlock::BlockMask] - pTerrainHeights[i]) * heightStep;
-				nextTerrainZRowStep[i] = (pNextTerrainHeights[(i+1) & TerrainBlock::BlockMask] - pNextTerrainHeights[i]) * heightStep;
-				terrainZColStep[i] = (pNextTerrainHeights[i] - pTerrainHeights[i]) * heightStep;
-			}
-		}
+		// get the world offset of the terrain
+		const MatrixF & transform = terrain->getTransform();
+		Point3F worldOffset;
+		transform.getColumn(3, &worldOffset);
+
+		F32 ratio = F32(1 << lightmapShift);
+		F32 ratioSquared = ratio * ratio;
+		F32 inverseRatioSquared = 1.f / ratioSquared;
 
-		// reset the light scale table
-		if(!lxmask)
-			for(i = 0; i < TerrainBlock::LightmapSize; i++)
-				lightScale[i] = 1.f;
+		F32 lightScale[TerrainBlock::LightmapSize];
 
-		Point2I bwalk = bp - blockRowStep;
-		for(y = 0; y < generateDim; y++)
+		// walk it...
+		bp = blockFirstPos - blockColStep;
+		for(x = 0; x < generateDim; x++)
 		{
-			U32 lymask = y & lightmapMask;
-			U32 ymask = y & blockMask;
-			if(!ymask)
-				bwalk += blockRowStep;
+			U32 xmask = x & blockMask;
+			U32 lxmask = x & lightmapMask;
 
-			U32 bi = y >> blockShift;
-			U32 binext = (bi + 1) & TerrainBlock::BlockMask;
+			// generate new runs?
+			if(!xmask)
+			{
+				bp += blockColStep;
 
-			F32 height;
-			F32 xstep, ystep;
+				// do the normals
+				Point3F * temp = pNormals;
+				pNormals = pNextNormals;
+				pNextNormals = temp;
 
-			// 135?
-			if((bwalk.x ^ bwalk.y) & 1)
-			{
-				U32 xsub = blockStep - xmask;
-				if(xsub > ymask) // bottom
+				// fill the row
+				Point2I bwalk = bp + blockColStep;
+				for(i = 0; i < TerrainBlock::BlockSize; i++)
 				{
-					xstep = terrainZColStep[bi];
-					ystep = terrainZRowStep[bi];
-					height = pTerrainHeights[bi] + xmask * xstep + ymask * ystep;
+					Point2F pos(bwalk.x * squareSize, bwalk.y * squareSize);
+					terrain->getNormal(pos, &pNextNormals[i]);
+					bwalk += blockRowStep;
 				}
-				else // top
+
+				// do the heights
+				F32 * tmp = pTerrainHeights;
+				pTerrainHeights = pNextTerrainHeights;
+				pNextTerrainHeights = tmp;
+
+				bwalk = bp + blockColStep;
+				for(i = 0; i < TerrainBlock::BlockSize; i++, bwalk += blockRowStep)
+					pNextTerrainHeights[i] = fixedToFloat(terrain->getHeight(bwalk.x, bwalk.y));
+
+				// fill in the row steps
+				for(i = 0; i < TerrainBlock::BlockSize; i++)
 				{
-					xstep = -terrainZColStep[binext];
-					ystep = nextTerrainZRowStep[bi];
-					height = pNextTerrainHeights[bi] + xsub * xstep + ymask * ystep;
+					terrainZRowStep[i] = (pTerrainHeights[(i+1) & TerrainBlock::BlockMask] - pTerrainHeights[i]) * heightStep;
+					nextTerrainZRowStep[i] = (pNextTerrainHeights[(i+1) & TerrainBlock::BlockMask] - pNextTerrainHeights[i]) * heightStep;
+					terrainZColStep[i] = (pNextTerrainHeights[i] - pTerrainHeights[i]) * heightStep;
 				}
 			}
-			else
+
+			// reset the light scale table
+			if(!lxmask)
+				for(i = 0; i < TerrainBlock::LightmapSize; i++)
+					lightScale[i] = 1.f;
+
+			Point2I bwalk = bp - blockRowStep;
+			for(y = 0; y < generateDim; y++)
 			{
-				if(xmask > ymask) // bottom
+				U32 lymask = y & lightmapMask;
+				U32 ymask = y & blockMask;
+				if(!ymask)
+					bwalk += blockRowStep;
+
+				U32 bi = y >> blockShift;
+				U32 binext = (bi + 1) & TerrainBlock::BlockMask;
+
+				F32 height;
+				F32 xstep, ystep;
+
+				// 135?
+				if((bwalk.x ^ bwalk.y) & 1)
 				{
-					xstep = terrainZColStep[bi];
-					ystep = nextTerrainZRowStep[bi];
-					height = pTerrainHeights[bi] + xmask * xstep + ymask * ystep;
+					U32 xsub = blockStep - xmask;
+					if(xsub > ymask) // bottom
+					{
+						xstep = terrainZColStep[bi];
+						ystep = terrainZRowStep[bi];
+						height = pTerrainHeights[bi] + xmask * xstep + ymask * ystep;
+					}
+					else // top
+					{
+						xstep = -terrainZColStep[binext];
+						ystep = nextTerrainZRowStep[bi];
+						height = pNextTerrainHeights[bi] + xsub * xstep + ymask * ystep;
+					}
 				}
-				else // top
+				else
 				{
-					xstep = terrainZColStep[binext];
-					ystep = terrainZRowStep[bi];
-					height = pTerrainHeights[bi] + xmask * xstep + ymask * ystep;
+					if(xmask > ymask) // bottom
+					{
+						xstep = terrainZColStep[bi];
+						ystep = nextTerrainZRowStep[bi];
+						height = pTerrainHeights[bi] + xmask * xstep + ymask * ystep;
+					}
+					else // top
+					{
+						xstep = terrainZColStep[binext];
+						ystep = terrainZRowStep[bi];
+						height = pTerrainHeights[bi] + xmask * xstep + ymask * ystep;
+					}
 				}
-			}
 
-			F32 intHeight = heightArray[y] * oneMinusFrac + heightArray[(y + fracStep) & generateMask] * frac + zStep;
+				F32 intHeight = heightArray[y] * oneMinusFrac + heightArray[(y + fracStep) & generateMask] * frac + zStep;
 
-			U32 lsi = y >> lightmapShift;
+				U32 lsi = y >> lightmapShift;
 
-			Point2I lmPos = lmFirstPos + blockColStep * (x >> lightmapShift) + blockRowStep * lsi;
+				Point2I lmPos = lmFirstPos + blockColStep * (x >> lightmapShift) + blockRowStep * lsi;
 
-			ColorF & col = mLightmap[lmPos.x + (lmPos.y << TerrainBlock::LightmapShift)];
+				ColorF & col = mLightmap[lmPos.x + (lmPos.y << TerrainBlock::LightmapShift)];
 
-			// lexel shaded by an interior?
-			Point2I terrPos = lmPos;
-			terrPos.x >>= TerrainBlock::LightmapShift - TerrainBlock::BlockShift;
-			terrPos.y >>= TerrainBlock::LightmapShift - TerrainBlock::BlockShift;
+				// lexel shaded by an interior?
+				Point2I terrPos = lmPos;
+				terrPos.x >>= TerrainBlock::LightmapShift - TerrainBlock::BlockShift;
+				terrPos.y >>= TerrainBlock::LightmapShift - TerrainBlock::BlockShift;
 
-			if(!lxmask && !lymask && mShadowMask.test(terrPos.x + (terrPos.y << TerrainBlock::BlockShift)))
-			{
-				U32 idx = (xmask + lightmapNormalOffset + ((ymask + lightmapNormalOffset) << blockShift)) << 2;
+				if(!lxmask && !lymask && mShadowMask.test(terrPos.x + (terrPos.y << TerrainBlock::BlockShift)))
+				{
+					U32 idx = (xmask + lightmapNormalOffset + ((ymask + lightmapNormalOffset) << blockShift)) << 2;
 
-				// get the normal for this lexel
-				Point3F normal = pNormals[bi] * normTable[idx++];
-				normal += pNormals[binext] * normTable[idx++];
-				normal += pNextNormals[binext] * normTable[idx++];
-				normal += pNextNormals[bi] * normTable[idx];
-				normal.normalize();
+					// get the normal for this lexel
+					Point3F normal = pNormals[bi] * normTable[idx++];
+					normal += pNormals[binext] * normTable[idx++];
+					normal += pNextNormals[binext] * normTable[idx++];
+					normal += pNextNormals[bi] * normTable[idx];
+					normal.normalize();
 
-				nextHeightArray[y] = height;
-				F32 colorScale = -mDot(normal, lightDir);
+					nextHeightArray[y] = height;
+					F32 colorScale = -mDot(normal, lightDir);
 
-				if(colorScale > 0.f)
-				{
-					// split lexels which cross the square split?
-					if(allowLexelSplits)
+					if(colorScale > 0.f)
 					{
-						// jff:todo
+						// split lexels which cross the square split?
+						if(allowLexelSplits)
+						{
+							// jff:todo
+						}
+						else
+						{
+							Point2F wPos((lmPos.x) * lexelDim + worldOffset.x,
+								(lmPos.y) * lexelDim + worldOffset.y);
+
+							F32 xh = xstep * ratio;
+							F32 yh = ystep * ratio;
+
+							F32 intensity = 1.f;
+							if(collect)
+							{
+								tests.increment();
+								sgTerrainShadowTest & test = tests.last();
+								test.pos = wPos;
+								test.height = height;
+								test.xh = xh;
+								test.yh = yh;
+							}
+							else if(deferTests)
+								intensity = testResults[nextTest++];
+							else
+								intensity = sgTestLexelShadow(mShadowVolume, wPos, lexelDim, height, xh, yh);
+							lightScale[lsi] = mClampF(intensity, 0.f, 1.f);
+						}
 					}
 					else
-					{
-						Point2F wPos((lmPos.x) * lexelDim + worldOffset.x,
-							(lmPos.y) * lexelDim + worldOffset.y);
-
-						F32 xh = xstep * ratio;
-						F32 yh = ystep * ratio;
-
-						ShadowVolumeBSP::SVPoly * poly = mShadowVolume->createPoly();
-						poly->mWindingCount = 4;
-						poly->mWinding[0].set(wPos.x, wPos.y, height);
-						poly->mWinding[1].set(wPos.x + lexelDim, wPos.y, height + xh);
-						poly->mWinding[2].set(wPos.x + lexelDim, wPos.y + lexelDim, height + xh + yh);
-						poly->mWinding[3].set(wPos.x, wPos.y + lexelDim, height + yh);
-						poly->mPlane.set(poly->mWinding[0], poly->mWinding[1], poly->mWinding[2]);
-
-						F32 lexelSize = mShadowVolume->getPolySurfaceArea(poly);
-						F32 intensity = mShadowVolume->getClippedSurfaceArea(poly) / lexelSize;
-						lightScale[lsi] = mClampF(intensity, 0.f, 1.f);
-					}
+						lightScale[lsi] = 0.f;
 				}
-				else
-					lightScale[lsi] = 0.f;
-			}
 
-			// non shadowed?
-			if(height >= intHeight)
-			{
-				U32 idx = (xmask + (ymask << blockShift)) << 2;
+				// non shadowed?
+				if(height >= intHeight)
+				{
+					U32 idx = (xmask + (ymask << blockShift)) << 2;
 
-				Point3F normal = pNormals[bi] * normTable[idx++];
-				normal += pNormals[binext] * normTable[idx++];
-				normal += pNextNormals[binext] * normTable[idx++];
-				normal += pNextNormals[bi] * normTable[idx];
-				normal.normalize();
+					Point3F normal = pNormals[bi] * normTable[idx++];
+					normal += pNormals[binext] * normTable[idx++];
+					normal += pNextNormals[binext] * normTable[idx++];
+					normal += pNextNormals[bi] * normTable[idx];
+					normal.normalize();
 
-				nextHeightArray[y] = height;
-				F32 colorScale = -mDot(normal, lightDir);
+					nextHeightArray[y] = height;
+					F32 colorScale = -mDot(normal, lightDir);
 
-				if(colorScale > 0.f)
-					col += ambient + lightColor * colorScale * lightScale[lsi];
+					if(collect)
+						;
+					else if(colorScale > 0.f)
+						col += ambient + lightColor * colorScale * lightScale[lsi];
+					else
+						col += ambient;
+				}
 				else
-					col += ambient;
-			}
-			else
-			{
-				nextHeightArray[y] = intHeight;
-				col += ambient;
+				{
+					nextHeightArray[y] = intHeight;
+					if(!collect)
+						col += ambient;
+				}
 			}
+
+			F32 * tmp = heightArray;
+			heightArray = nextHeightArray;
+			nextHeightArray = tmp;
 		}
 
-		F32 * tmp = heightArray;
-		heightArray = nextHeightArray;
-		nextHeightArray = tmp;
-	}
+		delete [] normTable;
+		normTable = NULL;
 
-	// set the proper color
-	for(i = 0; i < TerrainBlock::LightmapSize * TerrainBlock::LightmapSize; i++)
-	{
-		mLightmap[i] *= inverseRatioSquared;
-		mLightmap[i].clamp();
+		if(collect)
+		{
+			testResults.setSize(tests.size());
+			sgTerrainShadowJob job;
+			job.bsp = mShadowVolume;
+			job.lexelDim = lexelDim;
+			job.tests = tests.address();
+			job.results = testResults.address();
+			gThreadPool->parallelFor(tests.size(), sgTestLexelShadows, &job, csTerrainShadowTestsPerBatch);
+			continue;
+		}
+
+		// set the proper color
+		for(i = 0; i < TerrainBlock::LightmapSize * TerrainBlock::LightmapSize; i++)
+		{
+			mLightmap[i] *= inverseRatioSquared;
+			mLightmap[i].clamp();
+		}
 	}
 
-	delete [] normTable;
 	delete [] heightArray;
 	delete [] nextHeightArray;
 }
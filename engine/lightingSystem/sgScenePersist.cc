@@ -3,7 +3,10 @@
 // Copyright  Synapse Gaming 2003
 // Written by John Kabus
 //-----------------------------------------------
+#include "zlib.h"
 #include "dgl/gBitmap.h"
+#include "core/memstream.h"
+#include "core/threadPool.h"
 #include "terrain/terrData.h"
 #include "lightingSystem/sgScenePersist.h"
 #include "lightingSystem/sgSceneLighting.h"
@@ -12,7 +15,7 @@
 //------------------------------------------------------------------------------
 // Class SceneLighting::PersistInfo
 //------------------------------------------------------------------------------
-U32 PersistInfo::smFileVersion   = 0x11;
+U32 PersistInfo::smFileVersion   = 0x13;
 
 PersistInfo::~PersistInfo()
 {
@@ -20,6 +23,116 @@ PersistInfo::~PersistInfo()
 		delete mChunks[i];
 }
 
+//------------------------------------------------------------------------------
+// Chunks are written to memory first so they can be deflated and the index
+// filled in.  Seeks back are needed: the interior chunk patches its sizes.
+class PersistBufferStream : public Stream
+{
+	Vector<U8>  mBuffer;
+	U32         mPosition;
+
+  protected:
+	bool _read(const U32, void *)
+	{
+		setStatus(IllegalCall);
+		return(false);
+	}
+	bool _write(const U32 numBytes, const void *buffer)
+	{
+		if(mPosition + numBytes > mBuffer.size())
+			mBuffer.setSize(mPosition + numBytes);
+		dMemcpy(mBuffer.address() + mPosition, buffer, numBytes);
+		mPosition += numBytes;
+		return(true);
+	}
+
+  public:
+	PersistBufferStream()
+	{
+		mPosition = 0;
+		setStatus(Ok);
+		VECTOR_SET_ASSOCIATION(mBuffer);
+	}
+
+	bool hasCapability(const Capability cap) const      { return(cap != StreamRead); }
+	U32  getPosition() const                            { return(mPosition); }
+	U32  getStreamSize()                                { return(mBuffer.size()); }
+	bool setPosition(const U32 pos)
+	{
+		if(pos > mBuffer.size())
+			return(false);
+		mPosition = pos;
+		return(true);
+	}
+
+	void clear()         { mBuffer.clear(); mPosition = 0; setStatus(Ok); }
+	const U8 *address()  { return(mBuffer.address()); }
+};
+
+static PersistInfo::PersistChunk *createChunk(U32 chunkType)
+{
+	switch(chunkType)
+	{
+	case PersistInfo::PersistChunk::MissionChunkType:
+		return(new PersistInfo::MissionChunk);
+	case PersistInfo::PersistChunk::InteriorChunkType:
+		return(new PersistInfo::InteriorChunk);
+	case PersistInfo::PersistChunk::TerrainChunkType:
+		return(new PersistInfo::TerrainChunk);
+	}
+	return(NULL);
+}
+
+struct PersistDecodeJob
+{
+	PersistInfo                       *mInfo;
+	const PersistInfo::IndexEntry     *mIndex;
+	const U8                          *mData;
+	bool                              *mResults;
+};
+
+static bool decodeChunk(PersistInfo::PersistChunk *chunk, const PersistInfo::IndexEntry &entry, const U8 *data)
+{
+	U8 *raw = NULL;
+	if(entry.mStoredSize != entry.mRawSize)
+	{
+		raw = new U8[entry.mRawSize];
+
+		z_stream zs;
+		dMemset(&zs, 0, sizeof(zs));
+		inflateInit2(&zs, -MAX_WBITS);
+		zs.next_in   = (Bytef *) data;
+		zs.avail_in  = entry.mStoredSize;
+		zs.next_out  = raw;
+		zs.avail_out = entry.mRawSize;
+		S32 ret = inflate(&zs, Z_FINISH);
+		U32 size = zs.total_out;
+		inflateEnd(&zs);
+
+		if(ret != Z_STREAM_END || size != entry.mRawSize)
+		{
+			delete [] raw;
+			return(false);
+		}
+		data = raw;
+	}
+
+	MemStream stream(entry.mRawSize, (void *) data, true, false);
+	bool ok = chunk->read(stream);
+	delete [] raw;
+	return(ok);
+}
+
+static void decodeChunks(U32 start, U32 end, void *userData)
+{
+	PersistDecodeJob *job = (PersistDecodeJob *) userData;
+	for(U32 i = start; i < end; i++)
+	{
+		const PersistInfo::IndexEntry &entry = job->mIndex[i];
+		job->mResults[i] = decodeChunk(job->mInfo->mChunks[i], entry, job->mData + entry.mOffset);
+	}
+}
+
 //------------------------------------------------------------------------------
 bool PersistInfo::read(Stream & stream)
 {
@@ -34,43 +147,59 @@ bool PersistInfo::read(Stream & stream)
 	if(numChunks == 0)
 		return(false);
 
-	// read in all the chunks
+	// the index, and the size of the data that follows it
+	Vector<IndexEntry> index;
+	index.setSize(numChunks);
+	U32 dataSize = 0;
 	for(U32 i = 0; i < numChunks; i++)
 	{
-		U32 chunkType;
-		if(!stream.read(&chunkType))
+		IndexEntry &entry = index[i];
+		if(!stream.read(&entry.mChunkType) || !stream.read(&entry.mOffset) ||
+			!stream.read(&entry.mStoredSize) || !stream.read(&entry.mRawSize))
 			return(false);
 
 		// MissionChunk must be first chunk
-		if(i == 0 && chunkType != PersistChunk::MissionChunkType)
+		if((i == 0) != (entry.mChunkType == PersistChunk::MissionChunkType))
 			return(false);
-		if(i != 0 && chunkType == PersistChunk::MissionChunkType)
+		if(entry.mOffset != dataSize || entry.mStoredSize > entry.mRawSize)
 			return(false);
+		dataSize += entry.mStoredSize;
+	}
 
-		// create the chunk
-		switch(chunkType)
-		{
-		case PersistChunk::MissionChunkType:
-			mChunks.push_back(new PersistInfo::MissionChunk);
-			break;
-
-		case PersistChunk::InteriorChunkType:
-			mChunks.push_back(new PersistInfo::InteriorChunk);
-			break;
+	// create the chunks
+	for(U32 i = 0; i < numChunks; i++)
+	{
+		PersistChunk *chunk = createChunk(index[i].mChunkType);
+		if(!chunk)
+			return(false);
+		mChunks.push_back(chunk);
+	}
 
-		case PersistChunk::TerrainChunkType:
-			mChunks.push_back(new PersistInfo::TerrainChunk);
-			break;
+	// one read for all of it, unpacking the lightmaps is what takes the time
+	U8 *data = new U8[dataSize ? dataSize : 1];
+	if(!stream.read(dataSize, data))
+	{
+		delete [] data;
+		return(false);
+	}
 
-		default:
-			return(false);
-			break;
-		}
+	// the chunks are independent, decode them across the pool
+	Vector<bool> results;
+	results.setSize(numChunks);
+	PersistDecodeJob job;
+	job.mInfo    = this;
+	job.mIndex   = index.address();
+	job.mData    = data;
+	job.mResults = results.address();
+	if(gThreadPool && gThreadPool->isThreaded())
+		gThreadPool->parallelFor(numChunks, decodeChunks, &job);
+	else
+		decodeChunks(0, numChunks, &job);
+	delete [] data;
 
-		// load the chunk info
-		if(!mChunks[i]->read(stream))
+	for(U32 i = 0; i < numChunks; i++)
+		if(!results[i])
 			return(false);
-	}
 
 	return(true);
 }
@@ -83,15 +212,70 @@ bool PersistInfo::write(Stream & stream)
 	if(!stream.write((U32)mChunks.size()))
 		return(false);
 
+	// space for the index, it's filled in once the chunks are packed
+	U32 indexPos = stream.getPosition();
+	for(U32 i = 0; i < mChunks.size() * 4; i++)
+		if(!stream.write(U32(0)))
+			return(false);
+	U32 dataStart = stream.getPosition();
+
+	Vector<IndexEntry> index;
+	index.setSize(mChunks.size());
+
+	PersistBufferStream chunkStream;
 	for(U32 i = 0; i < mChunks.size(); i++)
 	{
-		if(!stream.write(mChunks[i]->mChunkType))
+		chunkStream.clear();
+		if(!mChunks[i]->write(chunkStream))
 			return(false);
-		if(!mChunks[i]->write(stream))
+
+		IndexEntry &entry = index[i];
+		entry.mChunkType = mChunks[i]->mChunkType;
+		entry.mOffset    = stream.getPosition() - dataStart;
+		entry.mRawSize   = chunkStream.getStreamSize();
+
+		// the -raw.ml lightmaps shrink a lot, PNGs hardly at all; keep them
+		// stored when it doesn't pay
+		uLong bound = compressBound(entry.mRawSize);
+		U8 *packed = new U8[bound];
+
+		z_stream zs;
+		dMemset(&zs, 0, sizeof(zs));
+		deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+		zs.next_in   = (Bytef *) chunkStream.address();
+		zs.avail_in  = entry.mRawSize;
+		zs.next_out  = packed;
+		zs.avail_out = bound;
+		S32 ret = deflate(&zs, Z_FINISH);
+		U32 packedSize = zs.total_out;
+		deflateEnd(&zs);
+
+		bool ok;
+		if(ret == Z_STREAM_END && packedSize < entry.mRawSize)
+		{
+			entry.mStoredSize = packedSize;
+			ok = stream.write(packedSize, packed);
+		}
+		else
+		{
+			entry.mStoredSize = entry.mRawSize;
+			ok = stream.write(entry.mRawSize, chunkStream.address());
+		}
+		delete [] packed;
+		if(!ok)
 			return(false);
 	}
 
-	return(true);
+	U32 endPos = stream.getPosition();
+	if(!stream.setPosition(indexPos))
+		return(false);
+	for(U32 i = 0; i < index.size(); i++)
+	{
+		if(!stream.write(index[i].mChunkType) || !stream.write(index[i].mOffset) ||
+			!stream.write(index[i].mStoredSize) || !stream.write(index[i].mRawSize))
+			return(false);
+	}
+	return(stream.setPosition(endPos));
 }
 
 //------------------------------------------------------------------------------
@@ -101,6 +285,8 @@ bool PersistInfo::PersistChunk::read(Stream & stream)
 {
 	if(!stream.read(&mChunkCRC))
 		return(false);
+	if(!stream.read(&mLightingKey))
+		return(false);
 	return(true);
 }
 
@@ -108,6 +294,8 @@ bool PersistInfo::PersistChunk::write(Stream & stream)
 {
 	if(!stream.write(mChunkCRC))
 		return(false);
+	if(!stream.write(mLightingKey))
+		return(false);
 	return(true);
 }
 
@@ -24,7 +24,10 @@ struct PersistInfo
 
 		U32            mChunkType;
 		U32            mChunkCRC;
+		/// See SceneLighting::ObjectProxy::calcLightingKey.
+		U32            mLightingKey;
 
+		PersistChunk() {mChunkCRC = 0; mLightingKey = 0;}
 		virtual ~PersistChunk() {}
 
 		virtual bool read(Stream &);
@@ -70,6 +73,17 @@ struct PersistInfo
 		bool write(Stream &);
 	};
 
+	/// The file is the version, the chunk count, this for each chunk, then
+	/// the chunk data in order.  Each chunk is deflated on its own (stored
+	/// if that doesn't shrink it), so read() can unpack them in parallel.
+	struct IndexEntry
+	{
+		U32            mChunkType;
+		U32            mOffset;       ///< From the end of the index.
+		U32            mStoredSize;   ///< mRawSize when not deflated.
+		U32            mRawSize;
+	};
+
 	~PersistInfo();
 
 	Vector<PersistChunk*>      mChunks;
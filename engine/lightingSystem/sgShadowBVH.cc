@@ -0,0 +1,516 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "lightingSystem/sgShadowBVH.h"
+#include "lightingSystem/sgLightManager.h"
+#include "sim/sceneObject.h"
+#include "game/objectTypes.h"
+#include "terrain/terrData.h"
+#include "collision/concretePolyList.h"
+#include "console/console.h"
+#include "platform/profiler.h"
+
+// The packet traversal only needs SSE1 float ops, so it's built wherever
+// the compiler knows about SSE and used when the CPU reports it.
+#if defined(TORQUE_CPU_X86) && (defined(TORQUE_COMPILER_VISUALC) || defined(__SSE__))
+#  define SG_SHADOWBVH_USE_SSE
+#  include <xmmintrin.h>
+#endif
+
+Vector<sgShadowBVH::sgTriangle> sgShadowBVH::sgTriangles;
+Vector<sgShadowBVH::sgNode> sgShadowBVH::sgNodes;
+Container *sgShadowBVH::sgContainer = NULL;
+bool sgShadowBVH::sgUseSSE = false;
+
+
+//-----------------------------------------------------------------------------
+
+void sgShadowBVH::sgBuild(Container *container)
+{
+   PROFILE_START(sgShadowBVH_sgBuild);
+
+   sgClear();
+   sgContainer = container;
+
+#if defined(SG_SHADOWBVH_USE_SSE)
+   sgUseSSE = (Platform::SystemInfo.processor.properties & CPU_PROP_SSE) != 0;
+#endif
+
+   Vector<SceneObject *> objects;
+   container->findObjects(ShadowCasterObjectType, sgFindObjectsCallback, &objects);
+
+   for(U32 i=0; i<objects.size(); i++)
+   {
+      SceneObject *obj = objects[i];
+      if(obj->getTypeMask() & TerrainObjectType)
+      {
+         sgAddTerrain(static_cast<TerrainBlock *>(obj));
+         continue;
+      }
+
+      // the objects put their polys in world space...
+      ConcretePolyList polylist;
+      if(obj->buildPolyList(&polylist, obj->getWorldBox(), obj->getWorldSphere()))
+         sgAddPolyList(polylist, obj);
+   }
+
+   U32 count = sgTriangles.size();
+   if(count == 0)
+   {
+      PROFILE_END();
+      return;
+   }
+
+   Vector<Point3F> centroids;
+   centroids.setSize(count);
+   for(U32 i=0; i<count; i++)
+   {
+      const sgTriangle &tri = sgTriangles[i];
+      centroids[i] = tri.sgVert + ((tri.sgEdge1 + tri.sgEdge2) / 3.0f);
+   }
+
+   sgNodes.reserve(count * 2);
+   sgNodes.increment();
+   sgBuildNode(0, 0, count, centroids, 0);
+
+   Con::printf("    Shadow BVH: %d triangles, %d nodes", count, sgNodes.size());
+
+   PROFILE_END();
+}
+
+void sgShadowBVH::sgClear()
+{
+   sgContainer = NULL;
+   sgTriangles.clear();
+   sgNodes.clear();
+   sgTriangles.compact();
+   sgNodes.compact();
+}
+
+bool sgShadowBVH::sgContains(SceneObject *obj)
+{
+   return sgIsBuilt() && (obj->getContainer() == sgContainer) &&
+      (obj->getTypeMask() & ShadowCasterObjectType);
+}
+
+void sgShadowBVH::sgAddTriangle(const Point3F &a, const Point3F &b, const Point3F &c, SceneObject *obj, U32 surface)
+{
+   Point3F edge1 = b - a;
+   Point3F edge2 = c - a;
+
+   // slivers can't block anything...
+   Point3F normal;
+   mCross(edge1, edge2, &normal);
+   if(normal.isZero())
+      return;
+
+   sgTriangles.increment();
+   sgTriangle &tri = sgTriangles.last();
+   tri.sgVert = a;
+   tri.sgEdge1 = edge1;
+   tri.sgEdge2 = edge2;
+   tri.sgObject = obj;
+   tri.sgSurface = surface;
+}
+
+void sgShadowBVH::sgAddTerrain(TerrainBlock *terrain)
+{
+   // the main block only, split the way TerrainBlock::buildPolyList()
+   // splits it, with the same surface keys...
+   const MatrixF &mat = terrain->getTransform();
+   F32 squaresize = terrain->getSquareSize();
+
+   for(U32 y=0; y<TerrainBlock::BlockSize; y++)
+   {
+      for(U32 x=0; x<TerrainBlock::BlockSize; x++)
+      {
+         const GridSquare *gs = terrain->findSquare(0, x, y);
+         if(gs->flags & GridSquare::Empty)
+            continue;
+
+         Point3F corner[4];
+         for(U32 i=0; i<4; i++)
+         {
+            U32 dx = i >> 1;
+            U32 dy = dx ^ (i & 1);
+            corner[i].set((x + dx) * squaresize, (y + dy) * squaresize,
+               fixedToFloat(terrain->getHeight(x + dx, y + dy)));
+            mat.mulP(corner[i]);
+         }
+
+         U32 surface = ((x << 16) | y) << 1;
+         if(gs->flags & GridSquare::Split45)
+         {
+            sgAddTriangle(corner[0], corner[1], corner[2], terrain, surface);
+            sgAddTriangle(corner[0], corner[2], corner[3], terrain, surface + 1);
+         }
+         else
+         {
+            sgAddTriangle(corner[1], corner[2], corner[3], terrain, surface);
+            sgAddTriangle(corner[1], corner[3], corner[0], terrain, surface + 1);
+         }
+      }
+   }
+}
+
+void sgShadowBVH::sgAddPolyList(const ConcretePolyList &polylist, SceneObject *obj)
+{
+   const ConcretePolyList::Poly *poly = polylist.mPolyList.address();
+   const ConcretePolyList::Poly *end = poly + polylist.mPolyList.size();
+   for(; poly<end; poly++)
+   {
+      const U32 *index = &polylist.mIndexList[poly->vertexStart];
+      const Point3F &first = polylist.mVertexList[index[0]];
+      for(U32 i=2; i<poly->vertexCount; i++)
+      {
+         sgAddTriangle(first, polylist.mVertexList[index[i - 1]],
+            polylist.mVertexList[index[i]], obj, poly->surfaceKey);
+      }
+   }
+}
+
+void sgShadowBVH::sgBuildNode(U32 node, U32 first, U32 count, Vector<Point3F> &centroids, U32 depth)
+{
+   // sgNodes grows under the recursion, so only hold on to indexes...
+   Point3F boundsmin(F32_MAX, F32_MAX, F32_MAX);
+   Point3F boundsmax(-F32_MAX, -F32_MAX, -F32_MAX);
+   Point3F centermin = boundsmin;
+   Point3F centermax = boundsmax;
+   for(U32 i=first; i<(first + count); i++)
+   {
+      const sgTriangle &tri = sgTriangles[i];
+      Point3F b = tri.sgVert + tri.sgEdge1;
+      Point3F c = tri.sgVert + tri.sgEdge2;
+      boundsmin.setMin(tri.sgVert);
+      boundsmin.setMin(b);
+      boundsmin.setMin(c);
+      boundsmax.setMax(tri.sgVert);
+      boundsmax.setMax(b);
+      boundsmax.setMax(c);
+      centermin.setMin(centroids[i]);
+      centermax.setMax(centroids[i]);
+   }
+
+   sgNodes[node].sgMin = boundsmin;
+   sgNodes[node].sgMax = boundsmax;
+
+   // split the longest axis of the centroids' bounds...
+   Point3F extent = centermax - centermin;
+   U32 axis = 0;
+   if(extent.y > extent[axis])
+      axis = 1;
+   if(extent.z > extent[axis])
+      axis = 2;
+
+   if((count <= sgMaxLeafTriangles) || (depth >= (sgMaxDepth - 2)) || (extent[axis] <= 0.0f))
+   {
+      sgNodes[node].sgFirst = first;
+      sgNodes[node].sgCount = count;
+      return;
+   }
+
+   F32 split = (centermin[axis] + centermax[axis]) * 0.5f;
+   U32 mid = first;
+   for(U32 i=first; i<(first + count); i++)
+   {
+      if(centroids[i][axis] >= split)
+         continue;
+
+      sgTriangle tri = sgTriangles[i];
+      sgTriangles[i] = sgTriangles[mid];
+      sgTriangles[mid] = tri;
+
+      Point3F centroid = centroids[i];
+      centroids[i] = centroids[mid];
+      centroids[mid] = centroid;
+
+      mid++;
+   }
+
+   if((mid == first) || (mid == (first + count)))
+      mid = first + (count / 2);
+
+   // first child right after us...
+   sgNodes[node].sgCount = 0;
+   U32 left = sgNodes.size();
+   sgNodes.increment();
+   sgBuildNode(left, first, (mid - first), centroids, depth + 1);
+
+   U32 right = sgNodes.size();
+   sgNodes.increment();
+   sgNodes[node].sgFirst = right;
+   sgBuildNode(right, mid, (first + count - mid), centroids, depth + 1);
+}
+
+
+//-----------------------------------------------------------------------------
+
+/// Segment start to start + dir, with invdir its reciprocal, against the
+/// box, for t in [0, 1].
+static inline bool sgSegmentHitsBox(const Point3F &boxmin, const Point3F &boxmax,
+   const Point3F &start, const Point3F &invdir)
+{
+   F32 tmin = 0.0f;
+   F32 tmax = 1.0f;
+   for(U32 i=0; i<3; i++)
+   {
+      F32 t0 = (boxmin[i] - start[i]) * invdir[i];
+      F32 t1 = (boxmax[i] - start[i]) * invdir[i];
+      if(t0 > t1)
+      {
+         F32 temp = t0;
+         t0 = t1;
+         t1 = temp;
+      }
+      tmin = getMax(tmin, t0);
+      tmax = getMin(tmax, t1);
+      if(tmin > tmax)
+         return false;
+   }
+   return true;
+}
+
+/// Two sided, so back faces shadow like the container casts do.
+static inline bool sgSegmentHitsTriangle(const Point3F &vert, const Point3F &edge1, const Point3F &edge2,
+   const Point3F &start, const Point3F &dir)
+{
+   Point3F p;
+   mCross(dir, edge2, &p);
+   F32 det = mDot(edge1, p);
+   if(det == 0.0f)
+      return false;
+   F32 invdet = 1.0f / det;
+
+   Point3F tvec = start - vert;
+   F32 u = mDot(tvec, p) * invdet;
+   if((u < 0.0f) || (u > 1.0f))
+      return false;
+
+   Point3F q;
+   mCross(tvec, edge1, &q);
+   F32 v = mDot(dir, q) * invdet;
+   if((v < 0.0f) || ((u + v) > 1.0f))
+      return false;
+
+   F32 t = mDot(edge2, q) * invdet;
+   return (t >= 0.0f) && (t <= 1.0f);
+}
+
+/// Axis aligned dir components would give infinities, and infinity times
+/// zero when the start is on a slab plane; F32_MAX keeps the slabs finite.
+static inline F32 sgSafeReciprocal(F32 value)
+{
+   return (value != 0.0f) ? (1.0f / value) : F32_MAX;
+}
+
+bool sgShadowBVH::sgCastRay(const Point3F &s, const Point3F &e, const SceneObject *owner, sgHit *hit)
+{
+   if(!sgIsBuilt())
+      return false;
+
+   Point3F dir = e - s;
+   Point3F invdir(sgSafeReciprocal(dir.x), sgSafeReciprocal(dir.y), sgSafeReciprocal(dir.z));
+
+   // the first child is pushed last, so the stack never gets deeper than the tree...
+   U32 stack[sgMaxDepth];
+   U32 stacksize = 0;
+   stack[stacksize++] = 0;
+
+   while(stacksize)
+   {
+      U32 index = stack[--stacksize];
+      const sgNode &node = sgNodes[index];
+      if(!sgSegmentHitsBox(node.sgMin, node.sgMax, s, invdir))
+         continue;
+
+      if(node.sgCount == 0)
+      {
+         stack[stacksize++] = node.sgFirst;
+         stack[stacksize++] = index + 1;
+         continue;
+      }
+
+      const sgTriangle *tri = &sgTriangles[node.sgFirst];
+      for(U32 i=0; i<node.sgCount; i++, tri++)
+      {
+         if(owner && (tri->sgObject != owner))
+            continue;
+         if(!sgSegmentHitsTriangle(tri->sgVert, tri->sgEdge1, tri->sgEdge2, s, dir))
+            continue;
+
+         if(hit)
+         {
+            hit->sgObject = tri->sgObject;
+            hit->sgSurface = tri->sgSurface;
+         }
+         return true;
+      }
+   }
+
+   return false;
+}
+
+U32 sgShadowBVH::sgCastRay4(const Point3F *s, const Point3F *e, U32 mask)
+{
+   mask &= 0xf;
+   if(!sgIsBuilt() || !mask)
+      return 0;
+
+   if(sgUseSSE)
+      return sgCastRay4SSE(s, e, mask);
+   return sgCastRay4C(s, e, mask);
+}
+
+U32 sgShadowBVH::sgCastRay4C(const Point3F *s, const Point3F *e, U32 mask)
+{
+   U32 blocked = 0;
+   for(U32 i=0; i<4; i++)
+   {
+      if((mask & (1 << i)) && sgCastRay(s[i], e[i]))
+         blocked |= (1 << i);
+   }
+   return blocked;
+}
+
+#if defined(SG_SHADOWBVH_USE_SSE)
+
+/// The four segments' starts, directions and reciprocals, one lane per
+/// segment.
+struct sgRayPacket
+{
+   __m128 sgStart[3];
+   __m128 sgDir[3];
+   __m128 sgInvDir[3];
+};
+
+/// Mask of the packet lanes whose segment hits the box.
+static inline U32 sgPacketHitsBox(const sgRayPacket &packet, const Point3F &boxmin, const Point3F &boxmax)
+{
+   __m128 tmin = _mm_setzero_ps();
+   __m128 tmax = _mm_set1_ps(1.0f);
+   for(U32 i=0; i<3; i++)
+   {
+      __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(boxmin[i]), packet.sgStart[i]), packet.sgInvDir[i]);
+      __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(boxmax[i]), packet.sgStart[i]), packet.sgInvDir[i]);
+      tmin = _mm_max_ps(tmin, _mm_min_ps(t0, t1));
+      tmax = _mm_min_ps(tmax, _mm_max_ps(t0, t1));
+   }
+   return _mm_movemask_ps(_mm_cmple_ps(tmin, tmax));
+}
+
+/// Mask of the packet lanes whose segment hits the triangle, the same
+/// test as sgSegmentHitsTriangle() four wide.
+static inline U32 sgPacketHitsTriangle(const sgRayPacket &packet, const Point3F &vert,
+   const Point3F &edge1, const Point3F &edge2)
+{
+   const __m128 zero = _mm_setzero_ps();
+   const __m128 one = _mm_set1_ps(1.0f);
+
+   __m128 e1x = _mm_set1_ps(edge1.x);
+   __m128 e1y = _mm_set1_ps(edge1.y);
+   __m128 e1z = _mm_set1_ps(edge1.z);
+   __m128 e2x = _mm_set1_ps(edge2.x);
+   __m128 e2y = _mm_set1_ps(edge2.y);
+   __m128 e2z = _mm_set1_ps(edge2.z);
+   const __m128 *dir = packet.sgDir;
+
+   // p = dir x edge2...
+   __m128 px = _mm_sub_ps(_mm_mul_ps(dir[1], e2z), _mm_mul_ps(dir[2], e2y));
+   __m128 py = _mm_sub_ps(_mm_mul_ps(dir[2], e2x), _mm_mul_ps(dir[0], e2z));
+   __m128 pz = _mm_sub_ps(_mm_mul_ps(dir[0], e2y), _mm_mul_ps(dir[1], e2x));
+   __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+   __m128 valid = _mm_cmpneq_ps(det, zero);
+   __m128 invdet = _mm_div_ps(one, det);
+
+   // tvec = start - vert...
+   __m128 tx = _mm_sub_ps(packet.sgStart[0], _mm_set1_ps(vert.x));
+   __m128 ty = _mm_sub_ps(packet.sgStart[1], _mm_set1_ps(vert.y));
+   __m128 tz = _mm_sub_ps(packet.sgStart[2], _mm_set1_ps(vert.z));
+   __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz)), invdet);
+   valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+
+   // q = tvec x edge1...
+   __m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+   __m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+   __m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+   __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dir[0], qx), _mm_mul_ps(dir[1], qy)), _mm_mul_ps(dir[2], qz)), invdet);
+   valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+
+   __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invdet);
+   valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(t, zero), _mm_cmple_ps(t, one)));
+
+   return _mm_movemask_ps(valid);
+}
+
+U32 sgShadowBVH::sgCastRay4SSE(const Point3F *s, const Point3F *e, U32 mask)
+{
+   // lanes not asked for trace a copy of one that was...
+   U32 fill = 0;
+   while(!(mask & (1 << fill)))
+      fill++;
+
+   F32 start[3][4];
+   F32 dir[3][4];
+   F32 invdir[3][4];
+   for(U32 lane=0; lane<4; lane++)
+   {
+      U32 ray = (mask & (1 << lane)) ? lane : fill;
+      for(U32 i=0; i<3; i++)
+      {
+         start[i][lane] = s[ray][i];
+         dir[i][lane] = e[ray][i] - s[ray][i];
+         invdir[i][lane] = sgSafeReciprocal(dir[i][lane]);
+      }
+   }
+
+   sgRayPacket packet;
+   for(U32 i=0; i<3; i++)
+   {
+      packet.sgStart[i] = _mm_loadu_ps(start[i]);
+      packet.sgDir[i] = _mm_loadu_ps(dir[i]);
+      packet.sgInvDir[i] = _mm_loadu_ps(invdir[i]);
+   }
+
+   U32 active = mask;
+   U32 stack[sgMaxDepth];
+   U32 stacksize = 0;
+   stack[stacksize++] = 0;
+
+   while(stacksize && active)
+   {
+      U32 index = stack[--stacksize];
+      const sgNode &node = sgNodes[index];
+      U32 lanes = sgPacketHitsBox(packet, node.sgMin, node.sgMax) & active;
+      if(!lanes)
+         continue;
+
+      if(node.sgCount == 0)
+      {
+         stack[stacksize++] = node.sgFirst;
+         stack[stacksize++] = index + 1;
+         continue;
+      }
+
+      // segments stop being tested once something blocks them...
+      const sgTriangle *tri = &sgTriangles[node.sgFirst];
+      for(U32 i=0; (i<node.sgCount) && lanes; i++, tri++)
+      {
+         U32 hits = sgPacketHitsTriangle(packet, tri->sgVert, tri->sgEdge1, tri->sgEdge2) & lanes;
+         lanes &= ~hits;
+         active &= ~hits;
+      }
+   }
+
+   return mask & ~active;
+}
+
+#else
+
+U32 sgShadowBVH::sgCastRay4SSE(const Point3F *s, const Point3F *e, U32 mask)
+{
+   return sgCastRay4C(s, e, mask);
+}
+
+#endif
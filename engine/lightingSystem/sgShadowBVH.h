@@ -0,0 +1,95 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _SGSHADOWBVH_H_
+#define _SGSHADOWBVH_H_
+
+#ifndef _MPOINT_H_
+#include "math/mPoint.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+
+class SceneObject;
+class Container;
+class TerrainBlock;
+class ConcretePolyList;
+
+/// Bounding volume hierarchy over the triangles of every static shadow
+/// caster, for the shadow tests of scene lighting.
+///
+/// Built once at the start of a lighting run from the terrain's height
+/// field and the collision polys of the interiors and static shapes, all
+/// in world space.  The casts only answer whether anything blocks the
+/// segment, which is all a shadow test needs, and skip the container's
+/// bins and the objects' own castRay()s.  The tree is read only once
+/// built, so any number of threads can cast against it.
+///
+/// sgCastRay4() traces four segments at once, with SSE where the CPU has
+/// it; the terrain light maps use it for runs of lexels.
+class sgShadowBVH
+{
+public:
+   struct sgHit
+   {
+      SceneObject *sgObject;
+      U32 sgSurface;
+   };
+
+   static void sgBuild(Container *container);
+   static void sgClear();
+   static bool sgIsBuilt() {return sgNodes.size() != 0;}
+   /// Is obj one of the casters the tree was built from?
+   static bool sgContains(SceneObject *obj);
+
+   /// Tests the segment s to e, against only owner's triangles if owner
+   /// isn't NULL.  Fills in hit, if given, with the first blocker found.
+   static bool sgCastRay(const Point3F &s, const Point3F &e, const SceneObject *owner = NULL, sgHit *hit = NULL);
+   /// Tests the segments s[i] to e[i] for each bit i set in mask, and
+   /// returns the mask of the ones that are blocked.
+   static U32 sgCastRay4(const Point3F *s, const Point3F *e, U32 mask = 0xf);
+
+private:
+   enum
+   {
+      sgMaxLeafTriangles = 4,
+      sgMaxDepth = 64
+   };
+
+   /// Stored as a vertex and two edges for the intersection test...
+   struct sgTriangle
+   {
+      Point3F sgVert;
+      Point3F sgEdge1;
+      Point3F sgEdge2;
+      SceneObject *sgObject;
+      U32 sgSurface;
+   };
+   /// Leaves have a triangle count, interior nodes have their first
+   /// child right after them and the second at sgFirst.
+   struct sgNode
+   {
+      Point3F sgMin;
+      U32 sgFirst;
+      Point3F sgMax;
+      U32 sgCount;
+   };
+
+   static Vector<sgTriangle> sgTriangles;
+   static Vector<sgNode> sgNodes;
+   static Container *sgContainer;
+   static bool sgUseSSE;
+
+   static void sgAddTriangle(const Point3F &a, const Point3F &b, const Point3F &c, SceneObject *obj, U32 surface);
+   static void sgAddTerrain(TerrainBlock *terrain);
+   static void sgAddPolyList(const ConcretePolyList &polylist, SceneObject *obj);
+   static void sgBuildNode(U32 node, U32 first, U32 count, Vector<Point3F> &centroids, U32 depth);
+
+   static U32 sgCastRay4C(const Point3F *s, const Point3F *e, U32 mask);
+   static U32 sgCastRay4SSE(const Point3F *s, const Point3F *e, U32 mask);
+};
+
+#endif
@@ -16,6 +16,10 @@
 
 IMPLEMENT_CO_NETOBJECT_V1(volumeLight);
 
+F32 volumeLight::smMinPixelSize = 4.0f;
+Vector<volumeLight *> volumeLight::smBatch(__FILE__, __LINE__);
+U32 volumeLight::smBatchKey = 0;
+
 volumeLight::volumeLight()
 {
 	// Setup NetObject.
@@ -24,6 +28,7 @@ volumeLight::volumeLight()
 	mAddedToScene = false;
 
 	mLastRenderTime = 0;
+	mGeometryDirty = true;
 	mLightHandle = NULL;
 	mLTextureName = StringTable->insert("");
 
@@ -106,6 +111,7 @@ void volumeLight::unpackUpdate(NetConnection * con, BitStream * stream)
 
 	// Set Transform.
 	setTransform(ObjectMatrix);
+	mGeometryDirty = true;
 
 	// Very rough, and not complete estimate of the bounding box.
 	// A complete one would actually shoot out rays from the hypothetical lightpoint
@@ -142,6 +148,8 @@ void volumeLight::setLtexture(const char *name)
 void volumeLight::setlpDistance(F32 Dist)
 {
 	mlpDistance = Dist;
+	mGeometryDirty = true;
+
 	// Set Config Change Mask.
 	if (isServerObject()) setMaskBits(volLightMask);
 }
@@ -155,6 +163,8 @@ void volumeLight::setShootDistance(F32 Dist)
 	// Set the Render Transform.
 	setRenderTransform(mObjToWorld);
 
+	mGeometryDirty = true;
+
 	// Set Config Change Mask.
 	if (isServerObject()) setMaskBits(volLightMask);
 }
@@ -168,6 +178,8 @@ void volumeLight::setXextent(F32 extent)
 	// Set the Render Transform.
 	setRenderTransform(mObjToWorld);
 
+	mGeometryDirty = true;
+
 	// Set Config Change Mask.
 	if (isServerObject()) setMaskBits(volLightMask);
 }
@@ -181,6 +193,8 @@ void volumeLight::setYextent(F32 extent)
 	// Set the Render Transform.
 	setRenderTransform(mObjToWorld);
 
+	mGeometryDirty = true;
+
 	// Set Config Change Mask.
 	if (isServerObject()) setMaskBits(volLightMask);
 }
@@ -188,6 +202,8 @@ void volumeLight::setYextent(F32 extent)
 void volumeLight::setSubdivideU(U32 val)
 {
 	mSubdivideU = val;
+	mGeometryDirty = true;
+
 	// Set Config Change Mask.
 	if (isServerObject()) setMaskBits(volLightMask);
 }
@@ -195,6 +211,8 @@ void volumeLight::setSubdivideU(U32 val)
 void volumeLight::setSubdivideV(U32 val)
 {
 	mSubdivideV = val;
+	mGeometryDirty = true;
+
 	// Set Config Change Mask.
 	if (isServerObject()) setMaskBits(volLightMask);
 }
@@ -202,6 +220,8 @@ void volumeLight::setSubdivideV(U32 val)
 void volumeLight::setfootColour(ColorF col)
 {
 	mfootColour = col;
+	mGeometryDirty = true;
+
 	// Set Config Change Mask.
 	if (isServerObject()) setMaskBits(volLightMask);
 }
@@ -209,6 +229,8 @@ void volumeLight::setfootColour(ColorF col)
 void volumeLight::settailColour(ColorF col)
 {
 	mtailColour = col;
+	mGeometryDirty = true;
+
 	// Set Config Change Mask.
 	if (isServerObject()) setMaskBits(volLightMask);
 }
@@ -316,6 +338,15 @@ void volumeLight::onRemove()
 {
 	mAddedToScene = false;
 
+	for(U32 i = 0; i < smBatch.size(); i++)
+	{
+		if(smBatch[i] == this)
+		{
+			smBatch.erase(i);
+			break;
+		}
+	}
+
 	// remove the texture handle
 	mLightHandle = NULL;
 
@@ -325,6 +356,8 @@ void volumeLight::onRemove()
 
 void volumeLight::inspectPostApply()
 {
+	mGeometryDirty = true;
+
 	// Reset the World Box.
 	resetWorldBox();
 	// Set the Render Transform.
@@ -356,8 +389,25 @@ bool volumeLight::prepRenderImage(SceneState *state, const U32 stateKey, const U
 	// Is Object Rendered?
 	if (state->isObjectRendered(this))
 	{
+		// too small to see?
+		const SphereF &sphere = getWorldSphere();
+		F32 dist = (sphere.center - state->getCameraPosition()).len();
+		if((dist > sphere.radius) &&
+			(dglProjectRadius(dist, sphere.radius) * dglGetPixelScale() < smMinPixelSize))
+			return false;
+
+		// the first light of the traversal draws everyone's...
+		if(stateKey != smBatchKey)
+		{
+			smBatch.clear();
+			smBatchKey = stateKey;
+		}
+		smBatch.push_back(this);
+		if(smBatch.size() > 1)
+			return false;
+
 		// Yes, so get a SceneRenderImage.
-		SceneRenderImage* image = new SceneRenderImage;
+		SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
 
 		// Populate it.
 		image->obj = this;
@@ -379,9 +429,6 @@ void volumeLight::renderObject(SceneState *state, SceneRenderImage *image)
 	// Check we are in Canonical State.
 	AssertFatal(dglIsInCanonicalState(), "Error, GL not in canonical state on entry");
 
-	// Check that we have a texture
-	AssertFatal(mLightHandle, "Error : No texture loaded or file failed to open");
-
 	//////////////////////////// -- Entry assertions
 
 	// Calculate Elapsed Time and take new Timestamp.
@@ -390,8 +437,6 @@ void volumeLight::renderObject(SceneState *state, SceneRenderImage *image)
 	mLastRenderTime = Time;
 
 	RectI viewport;
-	MatrixF RXF;
-	Point3F position;
 
 	// Setup out the Projection Matrix/Viewport.
 	glMatrixMode(GL_PROJECTION);
@@ -403,22 +448,11 @@ void volumeLight::renderObject(SceneState *state, SceneRenderImage *image)
 	// Save ModelView Matrix so we can restore Canonical state at exit.
 	glPushMatrix();
 
-	// Transform by the objects' transform e.g move it.
-	RXF = getTransform();
-	RXF.getColumn(3, &position);
-	dglMultMatrix(&RXF);
-
-	// Draw the damn thing
-	renderGL(state, image);
+	// Draw the damn things
+	renderBatch(state);
 
 	//////////////////////////// -- Exit assertions
 
-	// Restore rendering state.
-	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
-	glEnable(GL_DEPTH_TEST);
-	glDisable(GL_TEXTURE_2D);
-	glDisable(GL_BLEND);
-
 	// Restore our nice, friendly and dull canonical state.
 	glPopMatrix();
 	glMatrixMode(GL_PROJECTION);
@@ -431,101 +465,51 @@ void volumeLight::renderObject(SceneState *state, SceneRenderImage *image)
 }
 
 
+void volumeLight::addVertex(const Point3F &pos, F32 s, F32 t, const ColorF &col)
+{
+	mVerts.push_back(pos);
+	mTVerts.push_back(Point2F(s, t));
+	mColors.push_back(col);
+}
+
 void volumeLight::sgRenderY(const Point3F &near1, const Point3F &far1, const Point3F &far2,
 						   const ColorF &nearcol, const ColorF &farcol, F32 offset)
 {
-	glBegin(GL_QUADS);
-	glColor4f(nearcol.red, nearcol.green, nearcol.blue, nearcol.alpha);
-	glTexCoord2f(offset, 0.0);
-	glVertex3f(near1.x, -near1.y, 0.0f);
-
-	glColor4f(nearcol.red, nearcol.green, nearcol.blue, nearcol.alpha);
-	glTexCoord2f(offset, 0.5);
-	glVertex3f(near1.x, 0.0f, 0.0f);
-
-	glColor4f(farcol.red, farcol.green, farcol.blue, farcol.alpha);
-	glTexCoord2f(offset, 0.5);
-	glVertex3f(far1.x, 0.0, far1.z);
-
-	glColor4f(farcol.red, farcol.green, farcol.blue, farcol.alpha);
-	glTexCoord2f(offset, 0.0);
-	glVertex3f(far1.x, far1.y, far1.z);
-	glEnd();
+	addVertex(Point3F(near1.x, -near1.y, 0.0f), offset, 0.0f, nearcol);
+	addVertex(Point3F(near1.x, 0.0f, 0.0f), offset, 0.5f, nearcol);
+	addVertex(Point3F(far1.x, 0.0f, far1.z), offset, 0.5f, farcol);
+	addVertex(Point3F(far1.x, far1.y, far1.z), offset, 0.0f, farcol);
 
-	glBegin(GL_QUADS);
-	glColor4f(farcol.red, farcol.green, farcol.blue, farcol.alpha);
-	glTexCoord2f(offset, 0.5);
-	glVertex3f(far1.x, 0.0, far1.z);
-
-	glColor4f(nearcol.red, nearcol.green, nearcol.blue, nearcol.alpha);
-	glTexCoord2f(offset, 0.5);
-	glVertex3f(near1.x, 0.0f, 0.0f);
-
-	glColor4f(nearcol.red, nearcol.green, nearcol.blue, nearcol.alpha);
-	glTexCoord2f(offset, 1.0);
-	glVertex3f(near1.x, near1.y, 0.0f);
-
-	glColor4f(farcol.red, farcol.green, farcol.blue, farcol.alpha);
-	glTexCoord2f(offset, 1.0);
-	glVertex3f(far2.x, far2.y, far2.z);
-	glEnd();
+	addVertex(Point3F(far1.x, 0.0f, far1.z), offset, 0.5f, farcol);
+	addVertex(Point3F(near1.x, 0.0f, 0.0f), offset, 0.5f, nearcol);
+	addVertex(Point3F(near1.x, near1.y, 0.0f), offset, 1.0f, nearcol);
+	addVertex(Point3F(far2.x, far2.y, far2.z), offset, 1.0f, farcol);
 }
 
 void volumeLight::sgRenderX(const Point3F &near1, const Point3F &far1, const Point3F &far2,
 						   const ColorF &nearcol, const ColorF &farcol, F32 offset)
 {
-	glBegin(GL_QUADS);
-	glColor4f(nearcol.red, nearcol.green, nearcol.blue, nearcol.alpha);
-	glTexCoord2f(0.0, offset);
-	glVertex3f(-near1.x, near1.y, 0.0f);
-
-	glColor4f(nearcol.red, nearcol.green, nearcol.blue, nearcol.alpha);
-	glTexCoord2f(0.5, offset);
-	glVertex3f(0.0f, near1.y, 0.0f);
-
-	glColor4f(farcol.red, farcol.green, farcol.blue, farcol.alpha);
-	glTexCoord2f(0.5, offset);
-	glVertex3f(0.0, far1.y, far1.z);
+	addVertex(Point3F(-near1.x, near1.y, 0.0f), 0.0f, offset, nearcol);
+	addVertex(Point3F(0.0f, near1.y, 0.0f), 0.5f, offset, nearcol);
+	addVertex(Point3F(0.0f, far1.y, far1.z), 0.5f, offset, farcol);
+	addVertex(Point3F(far1.x, far1.y, far1.z), 0.0f, offset, farcol);
 
-	glColor4f(farcol.red, farcol.green, farcol.blue, farcol.alpha);
-	glTexCoord2f(0.0, offset);
-	glVertex3f(far1.x, far1.y, far1.z);
-	glEnd();
-
-	glBegin(GL_QUADS);
-	glColor4f(farcol.red, farcol.green, farcol.blue, farcol.alpha);
-	glTexCoord2f(0.5, offset);
-	glVertex3f(0.0, far1.y, far1.z);
-
-	glColor4f(nearcol.red, nearcol.green, nearcol.blue, nearcol.alpha);
-	glTexCoord2f(0.5, offset);
-	glVertex3f(0.0f, near1.y, 0.0f);
-
-	glColor4f(nearcol.red, nearcol.green, nearcol.blue, nearcol.alpha);
-	glTexCoord2f(1.0, offset);
-	glVertex3f(near1.x, near1.y, 0.0f);
-
-	glColor4f(farcol.red, farcol.green, farcol.blue, farcol.alpha);
-	glTexCoord2f(1.0, offset);
-	glVertex3f(far2.x, far2.y, far2.z);
-	glEnd();
+	addVertex(Point3F(0.0f, far1.y, far1.z), 0.5f, offset, farcol);
+	addVertex(Point3F(0.0f, near1.y, 0.0f), 0.5f, offset, nearcol);
+	addVertex(Point3F(near1.x, near1.y, 0.0f), 1.0f, offset, nearcol);
+	addVertex(Point3F(far2.x, far2.y, far2.z), 1.0f, offset, farcol);
 }
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// GL Render function...
+// Geometry and batched rendering...
 ///////////////////////////////////////////////////////////////////////////////
 
-void volumeLight::renderGL(SceneState *state, SceneRenderImage *image)
+void volumeLight::buildGeometry()
 {
-	glEnable(GL_TEXTURE_2D);
-	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-	glEnable(GL_BLEND);
-	glDepthMask(GL_FALSE);
-
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-
-	glBindTexture(GL_TEXTURE_2D, mLightHandle.getGLName());
+	mVerts.clear();
+	mTVerts.clear();
+	mColors.clear();
 
 	Point3F lightpoint;
 
@@ -537,32 +521,15 @@ void volumeLight::renderGL(SceneState *state, SceneRenderImage *image)
 	F32 ax = mXextent / 2;
 	F32 ay = mYextent / 2;
 
-	glEnable(GL_DEPTH_TEST);
-	glDepthMask(GL_TRUE);
-
-	// Draw the bottom foot...  this is basically the glowing region.
-	glBegin(GL_QUADS);
-		glColor4f(mfootColour.red, mfootColour.green, mfootColour.blue, 1.0f);
-		glTexCoord2f(0.0f, 0.0f);
-		glVertex3f(-ax, -ay, 0.0f);
-
-		glColor4f(mfootColour.red, mfootColour.green, mfootColour.blue, 1.0f);
-		glTexCoord2f(1.0f, 0.0f);
-		glVertex3f(ax, -ay, 0.0f);
-
-		glColor4f(mfootColour.red, mfootColour.green, mfootColour.blue, 1.0f);
-		glTexCoord2f(1.0f, 1.0f);
-		glVertex3f(ax, ay, 0.0f);
-
-		glColor4f(mfootColour.red, mfootColour.green, mfootColour.blue, 1.0f);
-		glTexCoord2f(0.0f, 1.0f);
-		glVertex3f(-ax, ay, 0.0f);
-	glEnd();
+	// The bottom foot...  this is basically the glowing region.
+	ColorF footcol(mfootColour.red, mfootColour.green, mfootColour.blue, 1.0f);
+	addVertex(Point3F(-ax, -ay, 0.0f), 0.0f, 0.0f, footcol);
+	addVertex(Point3F(ax, -ay, 0.0f), 1.0f, 0.0f, footcol);
+	addVertex(Point3F(ax, ay, 0.0f), 1.0f, 1.0f, footcol);
+	addVertex(Point3F(-ax, ay, 0.0f), 0.0f, 1.0f, footcol);
 
 	S32 i;
 
-	glDepthMask(GL_FALSE);
-
 	// Slices in X/U space
 	for(i = mSubdivideU; i >= 0; i--)
 	{
@@ -620,7 +587,107 @@ void volumeLight::renderGL(SceneState *state, SceneRenderImage *image)
 		sgRenderX(Point3F(ax, by, 0.0f), end1, end2, mfootColour, mtailColour, k);
 	}
 
+	mGeometryDirty = false;
+}
+
+static S32 QSORT_CALLBACK cmpVolumeLightTexture(const void *a, const void *b)
+{
+	U32 ta = (*(volumeLight **)a)->getLightTexture();
+	U32 tb = (*(volumeLight **)b)->getLightTexture();
+	return (ta < tb) ? -1 : ((ta > tb) ? 1 : 0);
+}
+
+void volumeLight::renderBatch(SceneState *state)
+{
+	static Vector<Point3F> verts(__FILE__, __LINE__);
+	static Vector<Point2F> tverts(__FILE__, __LINE__);
+	static Vector<ColorF> colors(__FILE__, __LINE__);
+
+	if(smBatch.empty())
+		return;
+
+	// the beams add up, so the order they're drawn in doesn't matter...
+	dQsort(smBatch.address(), smBatch.size(), sizeof(volumeLight *), cmpVolumeLightTexture);
+
+	// world space, the feet first and then the beams
+	U32 i, footCount = 0, beamCount = 0;
+	for(i = 0; i < smBatch.size(); i++)
+	{
+		volumeLight *light = smBatch[i];
+		if(light->mGeometryDirty)
+			light->buildGeometry();
+		footCount += 4;
+		beamCount += light->mVerts.size() - 4;
+	}
+
+	verts.setSize(footCount + beamCount);
+	tverts.setSize(footCount + beamCount);
+	colors.setSize(footCount + beamCount);
+
+	U32 foot = 0, beam = footCount;
+	for(i = 0; i < smBatch.size(); i++)
+	{
+		volumeLight *light = smBatch[i];
+		const MatrixF &mat = light->getTransform();
+		U32 count = light->mVerts.size();
+		for(U32 v = 0; v < count; v++)
+		{
+			U32 dst = (v < 4) ? foot++ : beam++;
+			mat.mulP(light->mVerts[v], &verts[dst]);
+			tverts[dst] = light->mTVerts[v];
+			colors[dst] = light->mColors[v];
+		}
+	}
+
+	glEnable(GL_TEXTURE_2D);
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+	glEnable(GL_DEPTH_TEST);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, verts.address());
+	glColorPointer(4, GL_FLOAT, 0, colors.address());
+	glTexCoordPointer(2, GL_FLOAT, 0, tverts.address());
+
+	// one draw per texture for the feet, which write depth, then the same
+	// for the beams, which don't
+	for(U32 pass = 0; pass < 2; pass++)
+	{
+		glDepthMask(pass == 0 ? GL_TRUE : GL_FALSE);
+
+		U32 start = (pass == 0) ? 0 : footCount;
+		U32 first = 0;
+		while(first < smBatch.size())
+		{
+			U32 texture = smBatch[first]->getLightTexture();
+			U32 count = 0;
+			U32 last = first;
+			for(; last < smBatch.size() && smBatch[last]->getLightTexture() == texture; last++)
+				count += (pass == 0) ? 4 : smBatch[last]->mVerts.size() - 4;
+
+			glBindTexture(GL_TEXTURE_2D, texture);
+			glDrawArrays(GL_QUADS, start, count);
+
+			start += count;
+			first = last;
+		}
+	}
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+	// Restore rendering state.
 	glDepthMask(GL_TRUE);
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+	glEnable(GL_DEPTH_TEST);
+	glDisable(GL_TEXTURE_2D);
+	glDisable(GL_BLEND);
+
+	smBatch.clear();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -654,6 +721,8 @@ void volumeLight::initPersistFields()
 
 void volumeLight::consoleInit()
 {
+	Con::addVariable("$pref::volumeLight::minPixelSize", TypeF32, &smMinPixelSize);
+
 	// Light Field Image
 	Con::addCommand("volumeLight", "setLTexture", csetLTexture, "vlight.setTexture(bitmap)", 3, 3);
 
@@ -30,6 +30,10 @@ public:
 	void sgRenderY(const Point3F &near1, const Point3F &far1, const Point3F &far2,
 						   const ColorF &nearcol, const ColorF &farcol, F32 offset);
 
+	/// Lights smaller than this on screen aren't drawn
+	/// ($pref::volumeLight::minPixelSize).
+	static F32 smMinPixelSize;
+
 
 protected :
 	enum {	volLightMask		= (1 << 0),
@@ -41,13 +45,28 @@ protected :
 
 	TextureHandle	mLightHandle;		// Light beam texture used.
 
+	// The quads in object space, the foot first, rebuilt when the
+	// light's settings change.
+	bool mGeometryDirty;
+	Vector<Point3F> mVerts;
+	Vector<Point2F> mTVerts;
+	Vector<ColorF> mColors;
+
+	void addVertex(const Point3F &pos, F32 s, F32 t, const ColorF &col);
+	void buildGeometry();
+
+	// All of the lights visible in a scene traversal are drawn together
+	// by the render image of the first one, sorted by texture.
+	static Vector<volumeLight *> smBatch;
+	static U32 smBatchKey;
+	static void renderBatch(SceneState *state);
+
 public :
 	volumeLight();
 	~volumeLight();
 
 	// SceneObject functions
 	void renderObject(SceneState*, SceneRenderImage*);
-	void renderGL(SceneState*, SceneRenderImage*);
 	virtual bool prepRenderImage(SceneState*, const U32 stateKey, const U32 startZone, const bool modifyBaseZoneState = false);
 
 	// SimObject functions
@@ -64,6 +83,7 @@ public :
 	static void initPersistFields();
 
 	void setLtexture(const char *name);
+	U32 getLightTexture() const { return mLightHandle.getGLName(); }
 
 	void setlpDistance(F32 Dist);
 	void setShootDistance(F32 Dist);
@@ -101,9 +101,191 @@ void vec_MatrixF_x_MatrixF(const F32 *matA, const F32 *matB, F32 *result)
    }
 }
 
+/// Bones are transposed into a palette of columns on the stack, which
+/// holds up to this many; bigger skeletons use the C version.
+static const U32 MaxVecSkinBones = 128;
+
+static void (*sgSkinVertsC)(const F32 *bones, const U32 numBones,
+                            const S32 *vertexIndex, const S32 *boneIndex, const F32 *weights,
+                            const U32 numInfluences,
+                            const F32 *initVerts, const F32 *initNorms,
+                            F32 *outVerts, F32 *outNorms) = NULL;
+
+/// Loads three floats from anywhere, w is zero.
+static inline vector float vec_load3(const F32 *p)
+{
+   union { vector float v; F32 f[4]; } u;
+   u.f[0] = p[0];
+   u.f[1] = p[1];
+   u.f[2] = p[2];
+   u.f[3] = 0.0f;
+   return u.v;
+}
+
+static inline void vec_store3(F32 *p, vector float v)
+{
+   union { vector float v; F32 f[4]; } u;
+   u.v = v;
+   p[0] = u.f[0];
+   p[1] = u.f[1];
+   p[2] = u.f[2];
+}
+
+/// Altivec skinning, see m_skin_verts.
+void vec_skin_verts(const F32 *bones, const U32 numBones,
+                    const S32 *vertexIndex, const S32 *boneIndex, const F32 *weights,
+                    const U32 numInfluences,
+                    const F32 *initVerts, const F32 *initNorms,
+                    F32 *outVerts, F32 *outNorms)
+{
+   if (numBones > MaxVecSkinBones)
+   {
+      sgSkinVertsC(bones, numBones, vertexIndex, boneIndex, weights, numInfluences,
+                   initVerts, initNorms, outVerts, outNorms);
+      return;
+   }
+
+   // Each bone becomes its four columns, so transforming a point is three
+   // multiply-adds of the columns by the splatted coordinates.
+   vector float palette[MaxVecSkinBones * 4];
+   U32 i;
+   for (i = 0; i < numBones; i++)
+   {
+      union { vector float v[4]; F32 f[16]; } cols;
+      const F32 *m = bones + i * 16;
+      for (U32 c = 0; c < 4; c++)
+      {
+         cols.f[c * 4 + 0] = m[c];
+         cols.f[c * 4 + 1] = m[4 + c];
+         cols.f[c * 4 + 2] = m[8 + c];
+         cols.f[c * 4 + 3] = 0.0f;
+      }
+      palette[i * 4 + 0] = cols.v[0];
+      palette[i * 4 + 1] = cols.v[1];
+      palette[i * 4 + 2] = cols.v[2];
+      palette[i * 4 + 3] = cols.v[3];
+   }
+
+   const vector float zero = (vector float) vec_splat_u32(0);
+   vector float accV = zero;
+   vector float accN = zero;
+   S32 prevIndex = -1;
+   for (i = 0; i < numInfluences; i++)
+   {
+      const S32 vIndex = vertexIndex[i];
+      if (vIndex != prevIndex)
+      {
+         if (prevIndex >= 0)
+         {
+            vec_store3(outVerts + prevIndex * 3, accV);
+            vec_store3(outNorms + prevIndex * 3, accN);
+         }
+         accV = zero;
+         accN = zero;
+         prevIndex = vIndex;
+      }
+
+      const vector float *b = palette + boneIndex[i] * 4;
+      vector float p = vec_load3(initVerts + vIndex * 3);
+      vector float n = vec_load3(initNorms + vIndex * 3);
+      union { vector float v; F32 f[4]; } w;
+      w.f[0] = weights[i];
+      vector float wv = vec_splat(w.v, 0);
+
+      vector float tv = vec_madd(b[0], vec_splat(p, 0), b[3]);
+      tv = vec_madd(b[1], vec_splat(p, 1), tv);
+      tv = vec_madd(b[2], vec_splat(p, 2), tv);
+      vector float tn = vec_madd(b[0], vec_splat(n, 0), zero);
+      tn = vec_madd(b[1], vec_splat(n, 1), tn);
+      tn = vec_madd(b[2], vec_splat(n, 2), tn);
+
+      accV = vec_madd(tv, wv, accV);
+      accN = vec_madd(tn, wv, accN);
+   }
+
+   if (prevIndex >= 0)
+   {
+      vec_store3(outVerts + prevIndex * 3, accV);
+      vec_store3(outNorms + prevIndex * 3, accN);
+   }
+}
+
+static inline void vec_load_columns(const F32 *m, vector float *cols)
+{
+   union { vector float v[4]; F32 f[16]; } u;
+   for (U32 c = 0; c < 4; c++)
+   {
+      u.f[c * 4 + 0] = m[c];
+      u.f[c * 4 + 1] = m[4 + c];
+      u.f[c * 4 + 2] = m[8 + c];
+      u.f[c * 4 + 3] = 0.0f;
+   }
+   cols[0] = u.v[0];
+   cols[1] = u.v[1];
+   cols[2] = u.v[2];
+   cols[3] = u.v[3];
+}
+
+/// Altivec point transforms, see m_matF_x_point3F_array.
+void vec_matF_x_point3F_array(const F32 *m, const F32 *p, F32 *presult, U32 count, U32 stride)
+{
+   vector float cols[4];
+   vec_load_columns(m, cols);
+
+   const U8 *src = (const U8 *) p;
+   U8 *dst = (U8 *) presult;
+   for (U32 i = 0; i < count; i++, src += stride, dst += stride)
+   {
+      vector float v = vec_load3((const F32 *) src);
+      vector float r = vec_madd(cols[0], vec_splat(v, 0), cols[3]);
+      r = vec_madd(cols[1], vec_splat(v, 1), r);
+      r = vec_madd(cols[2], vec_splat(v, 2), r);
+      vec_store3((F32 *) dst, r);
+   }
+}
+
+/// Altivec box transforms, as center and half extents, see
+/// m_matF_x_box_array.
+void vec_matF_x_box_array(const F32 *m, F32 *boxes, U32 count)
+{
+   vector float cols[4];
+   vec_load_columns(m, cols);
+   const vector float abs0 = vec_abs(cols[0]);
+   const vector float abs1 = vec_abs(cols[1]);
+   const vector float abs2 = vec_abs(cols[2]);
+   const vector float zero = (vector float) vec_splat_u32(0);
+   union { vector float v; F32 f[4]; } h;
+   h.f[0] = 0.5f;
+   const vector float half = vec_splat(h.v, 0);
+
+   for (U32 i = 0; i < count; i++, boxes += 6)
+   {
+      vector float bmin = vec_load3(boxes);
+      vector float bmax = vec_load3(boxes + 3);
+      vector float c = vec_madd(vec_add(bmin, bmax), half, zero);
+      vector float e = vec_madd(vec_sub(bmax, bmin), half, zero);
+
+      vector float center = vec_madd(cols[0], vec_splat(c, 0), cols[3]);
+      center = vec_madd(cols[1], vec_splat(c, 1), center);
+      center = vec_madd(cols[2], vec_splat(c, 2), center);
+      vector float extent = vec_madd(abs0, vec_splat(e, 0), zero);
+      extent = vec_madd(abs1, vec_splat(e, 1), extent);
+      extent = vec_madd(abs2, vec_splat(e, 2), extent);
+
+      vec_store3(boxes,     vec_sub(center, extent));
+      vec_store3(boxes + 3, vec_add(center, extent));
+   }
+}
+
 void mInstallLibrary_Vec()
 {
    m_matF_x_matF           = vec_MatrixF_x_MatrixF;
+
+   if (m_skin_verts != vec_skin_verts)
+      sgSkinVertsC         = m_skin_verts;
+   m_skin_verts            = vec_skin_verts;
+   m_matF_x_point3F_array  = vec_matF_x_point3F_array;
+   m_matF_x_box_array      = vec_matF_x_box_array;
 }
 #else // defined(__VEC__)
 void mInstallLibrary_Vec()
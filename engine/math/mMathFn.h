@@ -57,6 +57,15 @@ extern void (*m_point3F_bulk_dot_indexed)(const F32* refVector,
                                           const U32  pointStride,
                                           const U32* pointIndices,
                                           F32*       output);
+/// Returns i for the point farthest along refVector, the first one if
+/// several tie.  Point i is at dotPoints + pointStride * pointIndices[i],
+/// or pointStride * i if pointIndices is NULL.  numPoints must not be 0.
+/// This is the support function of the collision convexes.
+extern U32  (*m_point3F_bulk_max_dot)(const F32* refVector,
+                                      const F32* dotPoints,
+                                      const U32  numPoints,
+                                      const U32  pointStride,
+                                      const U32* pointIndices);
 
 extern void (*m_quatF_set_matF)( F32 x, F32 y, F32 z, F32 w, F32* m );
 
@@ -76,6 +85,35 @@ extern void (*m_matF_x_point4F)(const F32 *m, const F32 *p, F32 *presult);
 extern void (*m_matF_x_scale_x_planeF)(const F32 *m, const F32* s, const F32 *p, F32 *presult);
 extern void (*m_matF_x_box3F)(const F32 *m, F32 *min, F32 *max);
 
+/// Transforms count points by the matrix, like MatrixF::mulP().  The points
+/// are stride bytes apart in both p and presult, which may be the same
+/// array; only the first three floats of each are touched.
+extern void (*m_matF_x_point3F_array)(const F32 *m, const F32 *p, F32 *presult, U32 count, U32 stride);
+/// Transforms count Box3F's in place, like MatrixF::mul(Box3F&).  Each box
+/// is six floats, min then max.
+extern void (*m_matF_x_box_array)(const F32 *m, F32 *boxes, U32 count);
+
+/// Culls count boxes against the planes in planeMask, out of numPlanes
+/// PlaneF's (x, y, z, d), the visible side being in front.  The boxes come
+/// in structure of arrays form: six rows of stride floats, min x, y and z
+/// then max x, y and z.  results[i] is -1 if box i is behind a plane by
+/// more than expand, otherwise the mask of the planes it crosses.
+extern void (*m_box_array_x_planes)(const F32 *planes, U32 numPlanes, U32 planeMask, F32 expand,
+                                    const F32 *boxes, U32 stride, U32 count, S32 *results);
+
+/// Skinning kernel for TSSkinMesh.
+///
+/// Bone influences come in structure of arrays form, sorted by vertex:
+/// influence i adds weights[i] times bone boneIndex[i] applied to vertex
+/// vertexIndex[i].  bones holds numBones MatrixF's.  Every vertex that has
+/// influences is overwritten in outVerts and outNorms (3 floats each); the
+/// others are left alone.  The normals are not renormalized.
+extern void (*m_skin_verts)(const F32 *bones, const U32 numBones,
+                            const S32 *vertexIndex, const S32 *boneIndex, const F32 *weights,
+                            const U32 numInfluences,
+                            const F32 *initVerts, const F32 *initNorms,
+                            F32 *outVerts, F32 *outNorms);
+
 // Note that x must point to at least 4 values for quartics, and 3 for cubics
 extern U32 (*mSolveQuadratic)(F32 a, F32 b, F32 c, F32* x);
 extern U32 (*mSolveCubic)(F32 a, F32 b, F32 c, F32 d, F32* x);
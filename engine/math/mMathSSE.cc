@@ -104,8 +104,335 @@ void SSE_MatrixF_x_MatrixF(const F32 *matA, const F32 *matB, F32 *result)
 #endif
 
 
+// The skinning and support kernels use intrinsics rather than asm, so
+// they're available wherever the compiler knows about SSE.
+#if defined(TORQUE_CPU_X86) && (defined(TORQUE_COMPILER_VISUALC) || defined(__SSE__))
+#define ADD_SSE_SKIN
+#include <xmmintrin.h>
+
+/// Bones are transposed into a palette of columns on the stack, which
+/// holds up to this many; bigger skeletons use the C version.
+static const U32 MaxSSESkinBones = 128;
+
+static void (*sgSkinVertsC)(const F32 *bones, const U32 numBones,
+                            const S32 *vertexIndex, const S32 *boneIndex, const F32 *weights,
+                            const U32 numInfluences,
+                            const F32 *initVerts, const F32 *initNorms,
+                            F32 *outVerts, F32 *outNorms) = NULL;
+
+static inline void SSE_store3(F32 *dst, __m128 v)
+{
+   // low two floats, then the third on its own
+   _mm_storel_pi((__m64*)dst, v);
+   _mm_store_ss(dst + 2, _mm_movehl_ps(v, v));
+}
+
+void SSE_skin_verts(const F32 *bones, const U32 numBones,
+                    const S32 *vertexIndex, const S32 *boneIndex, const F32 *weights,
+                    const U32 numInfluences,
+                    const F32 *initVerts, const F32 *initNorms,
+                    F32 *outVerts, F32 *outNorms)
+{
+   if (numBones > MaxSSESkinBones)
+   {
+      sgSkinVertsC(bones, numBones, vertexIndex, boneIndex, weights, numInfluences,
+                   initVerts, initNorms, outVerts, outNorms);
+      return;
+   }
+
+   // Each bone becomes its four columns, so transforming a point is three
+   // multiply-adds of the columns by the splatted coordinates.
+   __m128 palette[MaxSSESkinBones * 4];
+   U32 i;
+   for (i = 0; i < numBones; i++)
+   {
+      const F32 *m = bones + i * 16;
+      __m128 r0 = _mm_loadu_ps(m);
+      __m128 r1 = _mm_loadu_ps(m + 4);
+      __m128 r2 = _mm_loadu_ps(m + 8);
+      __m128 r3 = _mm_setzero_ps();
+      _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+      palette[i * 4 + 0] = r0;
+      palette[i * 4 + 1] = r1;
+      palette[i * 4 + 2] = r2;
+      palette[i * 4 + 3] = r3;
+   }
+
+   __m128 accV = _mm_setzero_ps();
+   __m128 accN = _mm_setzero_ps();
+   S32 prevIndex = -1;
+   for (i = 0; i < numInfluences; i++)
+   {
+      const S32 vIndex = vertexIndex[i];
+      if (vIndex != prevIndex)
+      {
+         if (prevIndex >= 0)
+         {
+            SSE_store3(outVerts + prevIndex * 3, accV);
+            SSE_store3(outNorms + prevIndex * 3, accN);
+         }
+         accV = _mm_setzero_ps();
+         accN = _mm_setzero_ps();
+         prevIndex = vIndex;
+      }
+
+      const __m128 *b = palette + boneIndex[i] * 4;
+      const F32 *p = initVerts + vIndex * 3;
+      const F32 *n = initNorms + vIndex * 3;
+      __m128 w = _mm_set1_ps(weights[i]);
+
+      __m128 tv = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b[0], _mm_set1_ps(p[0])),
+                                        _mm_mul_ps(b[1], _mm_set1_ps(p[1]))),
+                             _mm_add_ps(_mm_mul_ps(b[2], _mm_set1_ps(p[2])), b[3]));
+      __m128 tn = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b[0], _mm_set1_ps(n[0])),
+                                        _mm_mul_ps(b[1], _mm_set1_ps(n[1]))),
+                             _mm_mul_ps(b[2], _mm_set1_ps(n[2])));
+
+      accV = _mm_add_ps(accV, _mm_mul_ps(tv, w));
+      accN = _mm_add_ps(accN, _mm_mul_ps(tn, w));
+   }
+
+   if (prevIndex >= 0)
+   {
+      SSE_store3(outVerts + prevIndex * 3, accV);
+      SSE_store3(outNorms + prevIndex * 3, accN);
+   }
+}
+
+
+/// Four points at a time: each one is loaded as a whole 16 bytes and the
+/// four transposed into x, y and z columns, so the dots are three
+/// multiply-adds.  The running best keeps its index as a float, SSE1
+/// having no integer ops; point counts are far below 2^24.
+U32 SSE_point3F_bulk_max_dot(const F32* refVector,
+                             const F32* dotPoints,
+                             const U32  numPoints,
+                             const U32  pointStride,
+                             const U32* pointIndices)
+{
+   // a 16 byte load runs 4 bytes past a packed Point3F, so with packed
+   // points the last one is always left to the scalar loop, and indexed
+   // packed points, which could be last anywhere, don't use the loads
+   const U32 overrun = (pointStride < 16) ? 1 : 0;
+   const bool vectorize = !(overrun && pointIndices);
+   const U8* base = (const U8*)dotPoints;
+
+   U32 i = 0;
+   U32 best = 0;
+   F32 bestDot = 0.0f;
+   if (vectorize && numPoints >= 4 + overrun)
+   {
+      const __m128 rx = _mm_set1_ps(refVector[0]);
+      const __m128 ry = _mm_set1_ps(refVector[1]);
+      const __m128 rz = _mm_set1_ps(refVector[2]);
+      const __m128 four = _mm_set1_ps(4.0f);
+      __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+      __m128 laneBest = lane;
+      __m128 laneDot = _mm_set1_ps(-F32_MAX);
+
+      for (; i + 4 + overrun <= numPoints; i += 4)
+      {
+         __m128 p0, p1, p2, p3;
+         if (pointIndices)
+         {
+            p0 = _mm_loadu_ps((const F32*)(base + pointStride * pointIndices[i + 0]));
+            p1 = _mm_loadu_ps((const F32*)(base + pointStride * pointIndices[i + 1]));
+            p2 = _mm_loadu_ps((const F32*)(base + pointStride * pointIndices[i + 2]));
+            p3 = _mm_loadu_ps((const F32*)(base + pointStride * pointIndices[i + 3]));
+         }
+         else
+         {
+            p0 = _mm_loadu_ps((const F32*)(base + pointStride * (i + 0)));
+            p1 = _mm_loadu_ps((const F32*)(base + pointStride * (i + 1)));
+            p2 = _mm_loadu_ps((const F32*)(base + pointStride * (i + 2)));
+            p3 = _mm_loadu_ps((const F32*)(base + pointStride * (i + 3)));
+         }
+         _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+
+         __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, p0), _mm_mul_ps(ry, p1)),
+                                 _mm_mul_ps(rz, p2));
+
+         // strictly greater, so each lane keeps its first best
+         __m128 better = _mm_cmpgt_ps(dot, laneDot);
+         laneDot  = _mm_or_ps(_mm_and_ps(better, dot), _mm_andnot_ps(better, laneDot));
+         laneBest = _mm_or_ps(_mm_and_ps(better, lane), _mm_andnot_ps(better, laneBest));
+         lane = _mm_add_ps(lane, four);
+      }
+
+      F32 dots[4], indices[4];
+      _mm_storeu_ps(dots, laneDot);
+      _mm_storeu_ps(indices, laneBest);
+      best = U32(indices[0]);
+      bestDot = dots[0];
+      for (U32 j = 1; j < 4; j++)
+      {
+         U32 index = U32(indices[j]);
+         if (dots[j] > bestDot || (dots[j] == bestDot && index < best))
+         {
+            best = index;
+            bestDot = dots[j];
+         }
+      }
+   }
+
+   for (; i < numPoints; i++)
+   {
+      U32 index = pointIndices ? pointIndices[i] : i;
+      const F32* pPoint = (const F32*)(base + pointStride * index);
+      F32 dot = ((refVector[0] * pPoint[0]) +
+                 (refVector[1] * pPoint[1]) +
+                 (refVector[2] * pPoint[2]));
+      if (i == 0 || dot > bestDot)
+      {
+         best = i;
+         bestDot = dot;
+      }
+   }
+   return best;
+}
+
+
+/// The matrix as its four columns, w zero, so transforming a point is
+/// three multiply-adds of the columns by the splatted coordinates.
+static inline void SSE_load_columns(const F32 *m, __m128 *cols)
+{
+   cols[0] = _mm_set_ps(0.0f, m[8],  m[4], m[0]);
+   cols[1] = _mm_set_ps(0.0f, m[9],  m[5], m[1]);
+   cols[2] = _mm_set_ps(0.0f, m[10], m[6], m[2]);
+   cols[3] = _mm_set_ps(0.0f, m[11], m[7], m[3]);
+}
+
+void SSE_matF_x_point3F_array(const F32 *m, const F32 *p, F32 *presult, U32 count, U32 stride)
+{
+   __m128 cols[4];
+   SSE_load_columns(m, cols);
+
+   const U8 *src = (const U8 *) p;
+   U8 *dst = (U8 *) presult;
+   for (U32 i = 0; i < count; i++, src += stride, dst += stride)
+   {
+      const F32 *s = (const F32 *) src;
+      __m128 r = _mm_add_ps(_mm_mul_ps(cols[0], _mm_set1_ps(s[0])), cols[3]);
+      r = _mm_add_ps(r, _mm_mul_ps(cols[1], _mm_set1_ps(s[1])));
+      r = _mm_add_ps(r, _mm_mul_ps(cols[2], _mm_set1_ps(s[2])));
+      SSE_store3((F32 *) dst, r);
+   }
+}
+
+/// Boxes go through as center and half extents: the center is
+/// transformed, the extents by the absolute rotation, which is the
+/// same box the Graphics Gems version finds.
+void SSE_matF_x_box_array(const F32 *m, F32 *boxes, U32 count)
+{
+   __m128 cols[4];
+   SSE_load_columns(m, cols);
+   const __m128 sign = _mm_set1_ps(-0.0f);
+   const __m128 abs0 = _mm_andnot_ps(sign, cols[0]);
+   const __m128 abs1 = _mm_andnot_ps(sign, cols[1]);
+   const __m128 abs2 = _mm_andnot_ps(sign, cols[2]);
+   const __m128 half = _mm_set1_ps(0.5f);
+
+   for (U32 i = 0; i < count; i++, boxes += 6)
+   {
+      F32 c[3], e[3];
+      c[0] = boxes[0] + boxes[3];
+      c[1] = boxes[1] + boxes[4];
+      c[2] = boxes[2] + boxes[5];
+      e[0] = boxes[3] - boxes[0];
+      e[1] = boxes[4] - boxes[1];
+      e[2] = boxes[5] - boxes[2];
+
+      __m128 center = _mm_add_ps(_mm_mul_ps(cols[0], _mm_set1_ps(c[0])),
+                                 _mm_mul_ps(cols[1], _mm_set1_ps(c[1])));
+      center = _mm_add_ps(center, _mm_mul_ps(cols[2], _mm_set1_ps(c[2])));
+      center = _mm_add_ps(_mm_mul_ps(center, half), cols[3]);
+
+      __m128 extent = _mm_add_ps(_mm_mul_ps(abs0, _mm_set1_ps(e[0])),
+                                 _mm_mul_ps(abs1, _mm_set1_ps(e[1])));
+      extent = _mm_mul_ps(_mm_add_ps(extent, _mm_mul_ps(abs2, _mm_set1_ps(e[2]))), half);
+
+      SSE_store3(boxes,     _mm_sub_ps(center, extent));
+      SSE_store3(boxes + 3, _mm_add_ps(center, extent));
+   }
+}
+
+/// Culls the four boxes starting at boxes, see m_box_array_x_planes.  The
+/// corners to test are picked per plane, so each plane is six
+/// multiply-adds for all four boxes.
+static inline void SSE_cull_four(const F32 *planes, U32 numPlanes, U32 planeMask, __m128 expand,
+                                 const F32 *boxes, U32 stride, S32 *results)
+{
+   const __m128 zero = _mm_setzero_ps();
+   __m128 rejected = zero;
+   S32 masks[4] = { 0, 0, 0, 0 };
+   for (U32 j = 0; j < numPlanes; j++)
+   {
+      if (!(planeMask & (1 << j)))
+         continue;
+
+      const F32 *p = planes + j * 4;
+      U32 fx = (p[0] > 0.0f) ? 3 : 0;
+      U32 fy = (p[1] > 0.0f) ? 4 : 1;
+      U32 fz = (p[2] > 0.0f) ? 5 : 2;
+      const __m128 px = _mm_set1_ps(p[0]);
+      const __m128 py = _mm_set1_ps(p[1]);
+      const __m128 pz = _mm_set1_ps(p[2]);
+      const __m128 pd = _mm_set1_ps(p[3]);
+
+      __m128 front = _mm_add_ps(_mm_mul_ps(px, _mm_loadu_ps(boxes + fx * stride)),
+                                _mm_mul_ps(py, _mm_loadu_ps(boxes + fy * stride)));
+      front = _mm_add_ps(_mm_add_ps(front, _mm_mul_ps(pz, _mm_loadu_ps(boxes + fz * stride))), pd);
+      __m128 back = _mm_add_ps(_mm_mul_ps(px, _mm_loadu_ps(boxes + (3 - fx) * stride)),
+                               _mm_mul_ps(py, _mm_loadu_ps(boxes + (5 - fy) * stride)));
+      back = _mm_add_ps(_mm_add_ps(back, _mm_mul_ps(pz, _mm_loadu_ps(boxes + (7 - fz) * stride))), pd);
+
+      rejected = _mm_or_ps(rejected, _mm_cmple_ps(front, expand));
+      S32 crossing = _mm_movemask_ps(_mm_cmple_ps(back, zero));
+      for (U32 k = 0; k < 4; k++)
+         if (crossing & (1 << k))
+            masks[k] |= 1 << j;
+   }
+
+   S32 out = _mm_movemask_ps(rejected);
+   for (U32 k = 0; k < 4; k++)
+      results[k] = (out & (1 << k)) ? -1 : masks[k];
+}
+
+void SSE_box_array_x_planes(const F32 *planes, U32 numPlanes, U32 planeMask, F32 expand,
+                            const F32 *boxes, U32 stride, U32 count, S32 *results)
+{
+   const __m128 negExpand = _mm_set1_ps(-expand);
+   U32 i = 0;
+   for (; i + 4 <= count; i += 4)
+      SSE_cull_four(planes, numPlanes, planeMask, negExpand, boxes + i, stride, results + i);
+
+   if (i < count)
+   {
+      // the last few are copied out and padded with the last box
+      F32 tail[6 * 4];
+      S32 tailResults[4];
+      for (U32 row = 0; row < 6; row++)
+         for (U32 k = 0; k < 4; k++)
+            tail[row * 4 + k] = boxes[row * stride + getMin(i + k, count - 1)];
+      SSE_cull_four(planes, numPlanes, planeMask, negExpand, tail, 4, tailResults);
+      for (U32 k = 0; i + k < count; k++)
+         results[i + k] = tailResults[k];
+   }
+}
+#endif
+
+
 void mInstall_Library_SSE()
 {
+#if defined(ADD_SSE_SKIN)
+   if (m_skin_verts != SSE_skin_verts)
+      sgSkinVertsC         = m_skin_verts;
+   m_skin_verts            = SSE_skin_verts;
+   m_point3F_bulk_max_dot  = SSE_point3F_bulk_max_dot;
+   m_matF_x_point3F_array  = SSE_matF_x_point3F_array;
+   m_matF_x_box_array      = SSE_matF_x_box_array;
+   m_box_array_x_planes    = SSE_box_array_x_planes;
+#endif
 #if defined(ADD_SSE_FN)
    m_matF_x_matF           = SSE_MatrixF_x_MatrixF;
    // m_matF_x_point3F = Athlon_MatrixF_x_Point3F;
@@ -713,6 +713,62 @@ static void m_matF_x_box3F_C(const F32 *m, F32* min, F32* max)
    }
 }
 
+static void m_matF_x_point3F_array_C(const F32 *m, const F32 *p, F32 *presult, U32 count, U32 stride)
+{
+   const U8 *src = (const U8 *) p;
+   U8 *dst = (U8 *) presult;
+   for (U32 i = 0; i < count; i++, src += stride, dst += stride)
+   {
+      // read it all before writing, the arrays can be the same
+      const F32 *s = (const F32 *) src;
+      F32 x = s[0];
+      F32 y = s[1];
+      F32 z = s[2];
+      F32 *d = (F32 *) dst;
+      d[0] = m[0]*x + m[1]*y + m[2]*z  + m[3];
+      d[1] = m[4]*x + m[5]*y + m[6]*z  + m[7];
+      d[2] = m[8]*x + m[9]*y + m[10]*z + m[11];
+   }
+}
+
+static void m_matF_x_box_array_C(const F32 *m, F32 *boxes, U32 count)
+{
+   for (U32 i = 0; i < count; i++, boxes += 6)
+      m_matF_x_box3F_C(m, boxes, boxes + 3);
+}
+
+static void m_box_array_x_planes_C(const F32 *planes, U32 numPlanes, U32 planeMask, F32 expand,
+                                   const F32 *boxes, U32 stride, U32 count, S32 *results)
+{
+   for (U32 i = 0; i < count; i++)
+   {
+      S32 mask = 0;
+      for (U32 j = 0; j < numPlanes; j++)
+      {
+         if (!(planeMask & (1 << j)))
+            continue;
+
+         // the corner furthest in front of the plane, and the one behind
+         const F32 *p = planes + j * 4;
+         U32 fx = (p[0] > 0.0f) ? 3 : 0;
+         U32 fy = (p[1] > 0.0f) ? 4 : 1;
+         U32 fz = (p[2] > 0.0f) ? 5 : 2;
+         F32 front = p[0] * boxes[fx * stride + i] + p[1] * boxes[fy * stride + i] +
+                     p[2] * boxes[fz * stride + i] + p[3];
+         F32 back  = p[0] * boxes[(3 - fx) * stride + i] + p[1] * boxes[(5 - fy) * stride + i] +
+                     p[2] * boxes[(7 - fz) * stride + i] + p[3];
+         if (front <= -expand)
+         {
+            mask = -1;
+            break;
+         }
+         if (back <= 0.0f)
+            mask |= 1 << j;
+      }
+      results[i] = mask;
+   }
+}
+
 
 void m_point3F_bulk_dot_C(const F32* refVector,
                           const F32* dotPoints,
@@ -746,6 +802,67 @@ void m_point3F_bulk_dot_indexed_C(const F32* refVector,
 }
 
 
+U32 m_point3F_bulk_max_dot_C(const F32* refVector,
+                              const F32* dotPoints,
+                              const U32  numPoints,
+                              const U32  pointStride,
+                              const U32* pointIndices)
+{
+   U32 best = 0;
+   F32 bestDot = 0.0f;
+   for (U32 i = 0; i < numPoints; i++)
+   {
+      U32 index = pointIndices ? pointIndices[i] : i;
+      const F32* pPoint = (const F32*)(((const U8*)dotPoints) + (pointStride * index));
+      F32 dot = ((refVector[0] * pPoint[0]) +
+                 (refVector[1] * pPoint[1]) +
+                 (refVector[2] * pPoint[2]));
+      if (i == 0 || dot > bestDot)
+      {
+         best = i;
+         bestDot = dot;
+      }
+   }
+   return best;
+}
+
+
+//------------------------------------------------------------------------------
+static void m_skin_verts_C(const F32 *bones, const U32 /*numBones*/,
+                           const S32 *vertexIndex, const S32 *boneIndex, const F32 *weights,
+                           const U32 numInfluences,
+                           const F32 *initVerts, const F32 *initNorms,
+                           F32 *outVerts, F32 *outNorms)
+{
+   S32 prevIndex = -1;
+   F32 *v = NULL, *n = NULL;
+   for (U32 i = 0; i < numInfluences; i++)
+   {
+      const S32 vIndex = vertexIndex[i];
+      if (vIndex != prevIndex)
+      {
+         v = outVerts + vIndex * 3;
+         n = outNorms + vIndex * 3;
+         v[0] = v[1] = v[2] = 0.0f;
+         n[0] = n[1] = n[2] = 0.0f;
+         prevIndex = vIndex;
+      }
+
+      const F32 *m = bones + boneIndex[i] * 16;
+      const F32 *p = initVerts + vIndex * 3;
+      const F32 *d = initNorms + vIndex * 3;
+      const F32  w = weights[i];
+
+      v[0] += (m[0]*p[0] + m[1]*p[1] + m[2]*p[2]  + m[3])  * w;
+      v[1] += (m[4]*p[0] + m[5]*p[1] + m[6]*p[2]  + m[7])  * w;
+      v[2] += (m[8]*p[0] + m[9]*p[1] + m[10]*p[2] + m[11]) * w;
+      n[0] += (m[0]*d[0] + m[1]*d[1] + m[2]*d[2])  * w;
+      n[1] += (m[4]*d[0] + m[5]*d[1] + m[6]*d[2])  * w;
+      n[2] += (m[8]*d[0] + m[9]*d[1] + m[10]*d[2]) * w;
+   }
+}
+
+
 //------------------------------------------------------------------------------
 // Math function pointer declarations
 
@@ -777,6 +894,11 @@ void (*m_point3F_bulk_dot_indexed)(const F32* refVector,
                                    const U32  pointStride,
                                    const U32* pointIndices,
                                    F32*       output) = m_point3F_bulk_dot_indexed_C;
+U32  (*m_point3F_bulk_max_dot)(const F32* refVector,
+                               const F32* dotPoints,
+                               const U32  numPoints,
+                               const U32  pointStride,
+                               const U32* pointIndices) = m_point3F_bulk_max_dot_C;
 
 void (*m_quatF_set_matF)( F32 x, F32 y, F32 z, F32 w, F32* m ) = m_quatF_set_matF_C;
 
@@ -795,6 +917,16 @@ void (*m_matF_x_matF)(const F32 *a, const F32 *b, F32 *mresult)    = default_mat
 void (*m_matF_x_point4F)(const F32 *m, const F32 *p, F32 *presult) = m_matF_x_point4F_C;
 void (*m_matF_x_scale_x_planeF)(const F32 *m, const F32* s, const F32 *p, F32 *presult) = m_matF_x_scale_x_planeF_C;
 void (*m_matF_x_box3F)(const F32 *m, F32 *min, F32 *max)    = m_matF_x_box3F_C;
+void (*m_matF_x_point3F_array)(const F32 *m, const F32 *p, F32 *presult, U32 count, U32 stride) = m_matF_x_point3F_array_C;
+void (*m_matF_x_box_array)(const F32 *m, F32 *boxes, U32 count) = m_matF_x_box_array_C;
+void (*m_box_array_x_planes)(const F32 *planes, U32 numPlanes, U32 planeMask, F32 expand,
+                             const F32 *boxes, U32 stride, U32 count, S32 *results) = m_box_array_x_planes_C;
+
+void (*m_skin_verts)(const F32 *bones, const U32 numBones,
+                     const S32 *vertexIndex, const S32 *boneIndex, const F32 *weights,
+                     const U32 numInfluences,
+                     const F32 *initVerts, const F32 *initNorms,
+                     F32 *outVerts, F32 *outNorms) = m_skin_verts_C;
 
 
 //------------------------------------------------------------------------------
@@ -818,6 +950,7 @@ void mInstallLibrary_C()
 
    m_point3F_bulk_dot      = m_point3F_bulk_dot_C;
    m_point3F_bulk_dot_indexed = m_point3F_bulk_dot_indexed_C;
+   m_point3F_bulk_max_dot  = m_point3F_bulk_max_dot_C;
 
    m_quatF_set_matF        = m_quatF_set_matF_C;
 
@@ -836,5 +969,10 @@ void mInstallLibrary_C()
    m_matF_x_point4F        = m_matF_x_point4F_C;
    m_matF_x_scale_x_planeF = m_matF_x_scale_x_planeF_C;
    m_matF_x_box3F          = m_matF_x_box3F_C;
+   m_matF_x_point3F_array  = m_matF_x_point3F_array_C;
+   m_matF_x_box_array      = m_matF_x_box_array_C;
+   m_box_array_x_planes    = m_box_array_x_planes_C;
+
+   m_skin_verts            = m_skin_verts_C;
 }
 
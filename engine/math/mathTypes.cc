@@ -532,13 +532,13 @@ ConsoleFunction(getRandom, F32, 1, 3, "(int a=1, int b=0)"
                 "Get a random number between a and b.")
 {
    if (argc == 2)
-      return F32(gRandGen.randI(0,dAtoi(argv[1])));
+      return F32(gRandGen.randI(0,Con::readIntArg(argv, 1)));
    else
    {
       if (argc == 3) 
       {
-         S32 min = dAtoi(argv[1]);
-         S32 max = dAtoi(argv[2]);
+         S32 min = Con::readIntArg(argv, 1);
+         S32 max = Con::readIntArg(argv, 2);
          if (min > max) 
          {
             S32 t = min;
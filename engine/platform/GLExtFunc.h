@@ -104,6 +104,62 @@ GL_GROUP_BEGIN(EXT_blend_minmax)
 GL_FUNCTION(void,       glBlendEquationEXT, (GLenum mode), return; )
 GL_GROUP_END()
 
+// ARB_occlusion_query
+#ifndef GL_SAMPLES_PASSED_ARB
+#define GL_QUERY_COUNTER_BITS_ARB            0x8864
+#define GL_CURRENT_QUERY_ARB                 0x8865
+#define GL_QUERY_RESULT_ARB                  0x8866
+#define GL_QUERY_RESULT_AVAILABLE_ARB        0x8867
+#define GL_SAMPLES_PASSED_ARB                0x8914
+#endif
+
+GL_GROUP_BEGIN(ARB_occlusion_query)
+GL_FUNCTION(void,       glGenQueriesARB, (GLsizei n, GLuint *ids), return; )
+GL_FUNCTION(void,       glDeleteQueriesARB, (GLsizei n, const GLuint *ids), return; )
+GL_FUNCTION(void,       glBeginQueryARB, (GLenum target, GLuint id), return; )
+GL_FUNCTION(void,       glEndQueryARB, (GLenum target), return; )
+GL_FUNCTION(void,       glGetQueryObjectivARB, (GLuint id, GLenum pname, GLint *params), return; )
+GL_FUNCTION(void,       glGetQueryObjectuivARB, (GLuint id, GLenum pname, GLuint *params), return; )
+GL_GROUP_END()
+
+// ARB_vertex_buffer_object
+#ifndef GL_ARRAY_BUFFER_ARB
+#include <stddef.h>
+typedef ptrdiff_t GLintptrARB;
+typedef ptrdiff_t GLsizeiptrARB;
+#define GL_ARRAY_BUFFER_ARB                  0x8892
+#define GL_ELEMENT_ARRAY_BUFFER_ARB          0x8893
+#define GL_ARRAY_BUFFER_BINDING_ARB          0x8894
+#define GL_ELEMENT_ARRAY_BUFFER_BINDING_ARB  0x8895
+#define GL_STREAM_DRAW_ARB                   0x88E0
+#define GL_STATIC_DRAW_ARB                   0x88E4
+#define GL_DYNAMIC_DRAW_ARB                  0x88E8
+#endif
+
+GL_GROUP_BEGIN(ARB_vertex_buffer_object)
+GL_FUNCTION(void,       glBindBufferARB, (GLenum target, GLuint buffer), return; )
+GL_FUNCTION(void,       glDeleteBuffersARB, (GLsizei n, const GLuint *buffers), return; )
+GL_FUNCTION(void,       glGenBuffersARB, (GLsizei n, GLuint *buffers), return; )
+GL_FUNCTION(void,       glBufferDataARB, (GLenum target, GLsizeiptrARB size, const GLvoid *data, GLenum usage), return; )
+GL_FUNCTION(void,       glBufferSubDataARB, (GLenum target, GLintptrARB offset, GLsizeiptrARB size, const GLvoid *data), return; )
+GL_GROUP_END()
+
+// ARB_vertex_program
+#ifndef GL_VERTEX_PROGRAM_ARB
+#define GL_VERTEX_PROGRAM_ARB                0x8620
+#define GL_PROGRAM_ERROR_POSITION_ARB        0x864B
+#define GL_PROGRAM_ERROR_STRING_ARB          0x8874
+#define GL_PROGRAM_FORMAT_ASCII_ARB          0x8875
+#endif
+
+GL_GROUP_BEGIN(ARB_vertex_program)
+GL_FUNCTION(void,       glGenProgramsARB, (GLsizei n, GLuint *programs), return; )
+GL_FUNCTION(void,       glDeleteProgramsARB, (GLsizei n, const GLuint *programs), return; )
+GL_FUNCTION(void,       glBindProgramARB, (GLenum target, GLuint program), return; )
+GL_FUNCTION(void,       glProgramStringARB, (GLenum target, GLenum format, GLsizei len, const GLvoid *string), return; )
+GL_FUNCTION(void,       glProgramLocalParameter4fARB, (GLenum target, GLuint index, GLfloat x, GLfloat y, GLfloat z, GLfloat w), return; )
+GL_GROUP_END()
+
 //NV_vertex_array_range
 #ifdef TORQUE_OS_WIN32
 GL_GROUP_BEGIN(NV_vertex_array_range)
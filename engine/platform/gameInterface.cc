@@ -20,6 +20,8 @@ GameInterface::GameInterface()
    mJournalMode = JournalOff;
    mRunning = true;
    mRequiresRestart = false;
+   mNetReplay = false;
+   mWaitingForTraffic = false;
    if(!gGameEventQueueMutex)
       gGameEventQueueMutex = Mutex::createMutex();
    eventQueue = &eventQueue1;
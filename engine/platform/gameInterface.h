@@ -22,6 +22,8 @@ class GameInterface
    bool mRunning;
    bool mJournalBreak;
    bool mRequiresRestart;
+   bool mNetReplay;
+   bool mWaitingForTraffic;
 
    /// Events are stored here by any thread, for processing by the main thread.
    Vector<Event*> eventQueue1, eventQueue2, *eventQueue;
@@ -124,6 +126,24 @@ public:
 
    FileStream *getJournalStream();
    /// @}
+
+   /// @name Server Replay
+   ///
+   /// While recorded packets are being fed to the server (see ServerReplay),
+   /// nothing is sent to the network.
+   /// @{
+   void setNetReplay(bool replay) { mNetReplay = replay; }
+   bool isNetReplaying() { return mNetReplay; }
+   /// @}
+
+   /// @name Dedicated Wait
+   ///
+   /// Set while the main loop blocks in Net::waitForTraffic() between
+   /// ticks, so the platform doesn't sleep on top of it.
+   /// @{
+   void setWaitingForTraffic(bool waiting) { mWaitingForTraffic = waiting; }
+   bool isWaitingForTraffic() { return mWaitingForTraffic; }
+   /// @}
 };
 
 /// Global game instance.
@@ -32,6 +32,8 @@ inline S16 convertHostToLEndian(S16 i) { return i; }
 inline S16 convertLEndianToHost(S16 i) { return i; }
 inline S32 convertHostToLEndian(S32 i) { return i; }
 inline S32 convertLEndianToHost(S32 i) { return i; }
+inline U64 convertHostToLEndian(U64 i) { return i; }
+inline U64 convertLEndianToHost(U64 i) { return i; }
 
 inline F32 convertHostToLEndian(F32 i) { return i; }
 inline F32 convertLEndianToHost(F32 i) { return i; }
@@ -260,8 +262,8 @@ enum x86Properties
    CPU_PROP_MMX       = (1<<2),     // Integer-SIMD
    CPU_PROP_3DNOW     = (1<<3),     // AMD Float-SIMD
    CPU_PROP_SSE       = (1<<4),     // PentiumIII SIMD
-   CPU_PROP_RDTSC     = (1<<5)     // Read Time Stamp Counter
-//   CPU_PROP_SSE2      = (1<<6),   // Pentium4 SIMD
+   CPU_PROP_RDTSC     = (1<<5),     // Read Time Stamp Counter
+   CPU_PROP_SSE2      = (1<<6)      // Pentium4 SIMD
 //   CPU_PROP_MP        = (1<<7)      // Multi-processor system
 };
 
@@ -341,8 +343,15 @@ public:
    static U32  getTime();
    static U32  getVirtualMilliseconds();
    static U32  getRealMilliseconds();
+   /// Wall clock time in microseconds, for measuring short intervals.
+   static U64  getRealMicroseconds();
    static void advanceTime(U32 delta);
 
+   /// Sleeps for about us microseconds.  How close it gets depends on the
+   /// OS scheduler, so code that needs a deadline sleeps short and spins
+   /// the rest; see the frame limiter in game/main.cc.
+   static void sleepMicroseconds(U32 us);
+
    static S32 getBackgroundSleepTime();
 
    // Directory functions.  Dump path returns false iff the directory cannot be
@@ -356,6 +365,15 @@ public:
    static bool getFileTimes(const char *filePath, FileTime *createTime, FileTime *modifyTime);
    static bool isFile(const char *pFilePath);
    static S32  getFileSize(const char *pFilePath);
+
+   /// Map a read only view of a file into memory.
+   ///
+   /// Maps size bytes starting at offset, or everything from offset to the end
+   /// of the file if size is 0, in which case size is set to the mapped length.
+   /// Returns an opaque handle for unmapFile(), with data pointing at offset,
+   /// or NULL if the file can't be mapped (or the view would be empty).
+   static void* mapFile(const char *pFilePath, U32 offset, U32 &size, const void *&data);
+   static void  unmapFile(void *mapping);
    static bool isDirectory(const char *pDirPath);
    static bool isSubDirectory(const char *pParent, const char *pDir);
 
@@ -386,6 +404,7 @@ public:
          const char *name;
          U32         mhz;
          U32         properties;      // CPU type specific enum
+         U32         numCores;        ///< Logical processors the OS reports.
       } processor;
    } SystemInfo;
 
@@ -548,11 +567,49 @@ void dQsort(void *base, U32 nelem, U32 width, int (QSORT_CALLBACK *fcmp)(const v
 /// Memory functions
 namespace Memory
 {
+   /// Subsystems the memory manager charges allocations to, see
+   /// MemoryTagScope.
+   enum Tag
+   {
+      TagGeneral = 0,
+      TagTerrain,
+      TagInterior,
+      TagShape,
+      TagTexture,
+      TagAudio,
+      TagScript,
+      TagGhost,
+      NumTags
+   };
+
    dsize_t getMemoryUsed();
    dsize_t getMemoryAllocated();
    void validate();
+
+   /// Sets the tag the calling thread's allocations are charged to,
+   /// returns the previous one.
+   U32  setCurrentTag(U32 tag);
+   U32  getCurrentTag();
+   const char* getTagName(U32 tag);
+   /// Live bytes and blocks charged to tag, over all threads.
+   void getTagUsage(U32 tag, dsize_t* bytes, U32* count);
+
+   /// Appends the tag usage to $Memory::metricsFile every
+   /// $Memory::metricsInterval seconds; called once a frame.
+   void processMetrics();
+   void consoleInit();
 } // namespace Memory
 
+/// Charges the allocations of the enclosing scope, on this thread, to a
+/// Memory::Tag.  Blocks stay charged to the tag they were allocated under.
+class MemoryTagScope
+{
+   U32 mPrevTag;
+public:
+   MemoryTagScope(U32 tag)  { mPrevTag = Memory::setCurrentTag(tag); }
+   ~MemoryTagScope()        { Memory::setCurrentTag(mPrevTag); }
+};
+
 extern void* FN_CDECL operator new(dsize_t size, void* ptr);
 
 template <class T>
@@ -697,6 +754,11 @@ struct Net
    static bool openPort(S32 connectPort);
    static void closePort();
    static Error sendto(const NetAddress *address, const U8 *buffer, S32 bufferSize);
+   /// Between these sendto() may queue the UDP packets and hand them to the
+   /// kernel together (sendmmsg() on Linux); elsewhere they go out as they
+   /// come.  Errors on queued packets aren't reported.
+   static void beginSendBatch();
+   static void endSendBatch();
 
    // Reliable net functions (TCP)
    // all incoming messages come in on the Connected* events
@@ -707,6 +769,11 @@ struct Net
 
    static void process();
 
+   /// Block until there's something for process() to read, or timeoutMs
+   /// pass.  Returns right away while a connect or name lookup is in
+   /// flight, since those are finished off by polling.
+   static void waitForTraffic(U32 timeoutMs);
+
    static bool compareAddresses(const NetAddress *a1, const NetAddress *a2);
    static bool stringToAddress(const char *addressString, NetAddress *address);
    static void addressToString(const NetAddress *address, char addressString[256]);
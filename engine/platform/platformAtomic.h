@@ -0,0 +1,105 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _PLATFORMATOMIC_H_
+#define _PLATFORMATOMIC_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+/// @defgroup platform_atomic Atomic Operations
+///
+/// Minimal set of atomic primitives on 32 bit values for lock-free code
+/// such as the queues in core/tRingBuffer.h.
+///
+/// dAtomicRead() has acquire semantics and dAtomicWrite() has release
+/// semantics: everything written before a dAtomicWrite() is visible to a
+/// thread that reads the new value with dAtomicRead().  The read-modify-write
+/// operations and dMemoryBarrier() are full barriers.
+///
+/// @{
+
+#if defined(TORQUE_COMPILER_VISUALC)
+
+extern "C" long __cdecl _InterlockedCompareExchange(long volatile *dest, long exchange, long comparand);
+extern "C" long __cdecl _InterlockedExchangeAdd(long volatile *dest, long value);
+extern "C" long __cdecl _InterlockedExchange(long volatile *dest, long value);
+extern "C" void __cdecl _ReadWriteBarrier();
+#pragma intrinsic(_InterlockedCompareExchange)
+#pragma intrinsic(_InterlockedExchangeAdd)
+#pragma intrinsic(_InterlockedExchange)
+#pragma intrinsic(_ReadWriteBarrier)
+
+// x86 doesn't reorder loads with loads or stores with stores, so keeping
+// the compiler from moving things across the access is all that's needed.
+inline U32 dAtomicRead(const volatile U32 &ref)
+{
+   U32 val = ref;
+   _ReadWriteBarrier();
+   return val;
+}
+
+inline void dAtomicWrite(volatile U32 &ref, U32 val)
+{
+   _ReadWriteBarrier();
+   ref = val;
+}
+
+inline bool dCompareAndSwap(volatile U32 &ref, U32 oldVal, U32 newVal)
+{
+   return U32(_InterlockedCompareExchange((long volatile *)&ref, long(newVal), long(oldVal))) == oldVal;
+}
+
+inline U32 dFetchAndAdd(volatile U32 &ref, U32 val)
+{
+   return U32(_InterlockedExchangeAdd((long volatile *)&ref, long(val)));
+}
+
+/// Full fence, for the rare store-then-load orderings x86 doesn't keep.
+inline void dMemoryBarrier()
+{
+   long volatile barrier;
+   _InterlockedExchange(&barrier, 0);
+}
+
+#elif defined(TORQUE_COMPILER_GCC)
+
+// The __sync builtins are full barriers, which also covers PPC.
+inline U32 dAtomicRead(const volatile U32 &ref)
+{
+   U32 val = ref;
+   __sync_synchronize();
+   return val;
+}
+
+inline void dAtomicWrite(volatile U32 &ref, U32 val)
+{
+   __sync_synchronize();
+   ref = val;
+}
+
+inline bool dCompareAndSwap(volatile U32 &ref, U32 oldVal, U32 newVal)
+{
+   return __sync_bool_compare_and_swap(&ref, oldVal, newVal);
+}
+
+inline U32 dFetchAndAdd(volatile U32 &ref, U32 val)
+{
+   return __sync_fetch_and_add(&ref, val);
+}
+
+inline void dMemoryBarrier()
+{
+   __sync_synchronize();
+}
+
+#else
+#  error "platformAtomic.h: no atomic operations for this compiler."
+#endif
+
+/// @}
+
+#endif
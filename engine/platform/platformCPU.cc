@@ -13,6 +13,7 @@ enum CPUFlags
    BIT_RDTSC   = BIT(4),
    BIT_MMX     = BIT(23),
    BIT_SSE     = BIT(25),
+   BIT_SSE2    = BIT(26),
    BIT_3DNOW   = BIT(31),
 };
 
@@ -27,6 +28,7 @@ void SetProcessorInfo(Platform::SystemInfo_struct::Processor& pInfo,
    if (dStricmp(vendor, "GenuineIntel") == 0)
    {
       pInfo.properties |= (properties & BIT_SSE) ? CPU_PROP_SSE : 0;
+      pInfo.properties |= (properties & BIT_SSE2) ? CPU_PROP_SSE2 : 0;
       pInfo.type = CPU_Intel_Unknown;
       // switch on processor family code
       switch ((processor >> 8) & 0x0f)
@@ -106,8 +108,9 @@ void SetProcessorInfo(Platform::SystemInfo_struct::Processor& pInfo,
    else
       if (dStricmp(vendor, "AuthenticAMD") == 0)
       {
-         // AthlonXP processors support SSE
+         // AthlonXP processors support SSE, Athlon 64 SSE2
          pInfo.properties |= (properties & BIT_SSE) ? CPU_PROP_SSE : 0;
+         pInfo.properties |= (properties & BIT_SSE2) ? CPU_PROP_SSE2 : 0;
          pInfo.properties |= (properties & BIT_3DNOW) ? CPU_PROP_3DNOW : 0;
          // switch on processor family code
          switch ((processor >> 8) & 0xf)
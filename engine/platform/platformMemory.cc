@@ -6,8 +6,10 @@
 #include "platform/platform.h"
 #include "core/fileStream.h"
 #include "console/console.h"
+#include "console/consoleTypes.h"
 #include "platform/profiler.h"
 #include "platform/platformMutex.h"
+#include "platform/platformThread.h"
 
 
 #ifdef TORQUE_MULTITHREAD
@@ -23,12 +25,26 @@ enum MemConstants {
    Allocated            = BIT(0),
    Array                = BIT(1),
    FlaggityFlag         = BIT(2),
+   SmallBlock           = BIT(3),
+   TagShift             = 16,         ///< The Memory::Tag of an allocated block is kept in its flags.
+   TagMask              = 0xFF << TagShift,
    AllocatedGuard       = 0xCEDEFEDE,
    FreeGuard            = 0x5555FFFF,
    MaxAllocationAmount  = 0xFFFFFFFF,
    TreeNodeAllocCount   = 2048,
 };
 
+/// Allocations up to SmallBlockMax bytes come from slabs of fixed size
+/// chunks, one free list per 16 byte size class, instead of the tree.
+enum SmallBlockConstants {
+   SmallClassShift      = 4,
+   SmallBlockMax        = 256,
+   NumSmallClasses      = SmallBlockMax >> SmallClassShift,
+   SlabSize             = 64 * 1024,
+   ThreadCacheRefill    = 32,    ///< Chunks a thread takes from the shared list at a time.
+   ThreadCacheMax       = 64,    ///< Past this a thread gives ThreadCacheRefill back.
+};
+
 enum RedBlackTokens {
    Red = 0,
    Black = 1
@@ -130,7 +146,41 @@ struct PageRecord
                    // will cache better
 };
 
+/// A page of small blocks, each an AllocatedHeader followed by
+/// chunkSize bytes.  The page itself comes from allocPage(), with no
+/// header list.
+struct SlabRecord
+{
+   SlabRecord *nextSlab;
+   U32 sizeClass;
+   U32 chunkSize;
+   U32 chunkCount;
+};
+
+/// Free small blocks, linked through their headers' next.
+struct SmallFreeList
+{
+   AllocatedHeader *head[NumSmallClasses];
+   U32 count[NumSmallClasses];
+};
+
+/// A thread's small block cache, the tag its allocations are charged
+/// to, and what it has charged and freed per tag.  Blocks are often
+/// freed by another thread than the one that made them, so only the sum
+/// over all the threads means anything.
+struct ThreadMemory
+{
+   SmallFreeList smallFree;
+   U32 tag;
+   dsize_t tagBytes[NumTags];
+   U32 tagCount[NumTags];
+   ThreadMemory *nextThread;
+};
+
 PageRecord *gPageList = NULL;
+SlabRecord *gSlabList = NULL;
+SmallFreeList gSmallFree;
+ThreadMemory *gThreadMemoryList = NULL;
 TreeNode nil;
 TreeNode *NIL = &nil;
 TreeNode *gFreeTreeRoot = &nil;
@@ -162,6 +212,12 @@ static void setGuard(Header *header, bool alloc)
 }
 #endif
 
+static inline AllocatedHeader *getSlabChunk(SlabRecord *slab, U32 index)
+{
+   U8 *base = (U8 *) (slab + 1);
+   return (AllocatedHeader *) (base + index * (sizeof(AllocatedHeader) + slab->chunkSize));
+}
+
 static void memoryError()
 {
    // free all the pages
@@ -721,6 +777,32 @@ ConsoleFunction(FreeMemoryDump, void, 1, 1, "FreeMemoryDump();")
          fullMem.count, fullMem.maxDepth, fullMem.minDepth, F32(fullMem.depthTotal) / F32(fullMem.count));
 }
 
+ConsoleFunction(SmallMemoryDump, void, 1, 1, "SmallMemoryDump();")
+{
+   argc; argv;
+   U32 slabs[NumSmallClasses];
+   U32 chunks[NumSmallClasses];
+   U32 used[NumSmallClasses];
+   dMemset(slabs, 0, sizeof(slabs));
+   dMemset(chunks, 0, sizeof(chunks));
+   dMemset(used, 0, sizeof(used));
+
+   for (SlabRecord *slab = gSlabList; slab; slab = slab->nextSlab)
+   {
+      slabs[slab->sizeClass]++;
+      chunks[slab->sizeClass] += slab->chunkCount;
+      for (U32 i = 0; i < slab->chunkCount; i++)
+         if (getSlabChunk(slab, i)->flags & Allocated)
+            used[slab->sizeClass]++;
+   }
+
+   // the rest of the free chunks are in the threads' caches
+   for (U32 i = 0; i < NumSmallClasses; i++)
+      if (slabs[i])
+         Con::printf("Size: %d - Slabs: %d  Used: %d  Free: %d  Shared free: %d",
+               (i + 1) << SmallClassShift, slabs[i], used[i], chunks[i] - used[i], gSmallFree.count[i]);
+}
+
 #ifdef TORQUE_DEBUG_GUARD
 
 void flagCurrentAllocs()
@@ -733,6 +815,12 @@ void flagCurrentAllocs()
             pah->flags |= FlaggityFlag;
          }
    }
+   for (SlabRecord *slab = gSlabList; slab; slab = slab->nextSlab)
+      for (U32 i = 0; i < slab->chunkCount; i++) {
+         AllocatedHeader* pah = getSlabChunk(slab, i);
+         if (pah->flags & Allocated)
+            pah->flags |= FlaggityFlag;
+      }
 }
 
 ConsoleFunction(FlagCurrentAllocs, void, 1, 1, "FlagCurrentAllocs();")
@@ -771,6 +859,20 @@ ConsoleFunction(DumpUnflaggedAllocs, void, 2, 2, "DumpUnflaggedAllocs(filename);
          }
       }
    }
+   for (SlabRecord *slab = gSlabList; slab; slab = slab->nextSlab)
+   {
+      for (U32 i = 0; i < slab->chunkCount; i++)
+      {
+         AllocatedHeader* pah = getSlabChunk(slab, i);
+         if ((pah->flags & Allocated) && !(pah->flags & FlaggityFlag))
+         {
+            dSprintf(buffer, 1023, "%s\t%d\t%d\t%d\r\n",
+               pah->fileName != NULL ? pah->fileName : "Undetermined",
+               pah->line, pah->realSize, pah->allocNum);
+            fws.write(dStrlen(buffer), buffer);
+         }
+      }
+   }
 
    fws.close();
 }
@@ -855,10 +957,16 @@ static void shutdown()
    PageRecord * walk;
 #ifdef TORQUE_DEBUG_GUARD
    AllocatedHeader* pLeaks[maxNumLeaks];
-   for (walk = gPageList; walk; walk = walk->prevPage)
-      for(Header *probe = walk->headerList; probe; probe = probe->next)
+   for (walk = gPageList; walk && numLeaks < maxNumLeaks; walk = walk->prevPage)
+      for(Header *probe = walk->headerList; probe && numLeaks < maxNumLeaks; probe = probe->next)
          if ((probe->flags & Allocated) && ((AllocatedHeader *)probe)->fileName != NULL)
             pLeaks[numLeaks++] = (AllocatedHeader *) probe;
+   for (SlabRecord *slab = gSlabList; slab && numLeaks < maxNumLeaks; slab = slab->nextSlab)
+      for (U32 i = 0; i < slab->chunkCount && numLeaks < maxNumLeaks; i++) {
+         AllocatedHeader* pah = getSlabChunk(slab, i);
+         if ((pah->flags & Allocated) && pah->fileName != NULL)
+            pLeaks[numLeaks++] = pah;
+      }
 
    if (numLeaks && !gNeverLogLeaks) {
       if (gAlwaysLogLeaks || Platform::AlertOKCancel("Memory Status", "Memory leaks detected.  Write to memoryLeaks.log?") == true) {
@@ -875,8 +983,9 @@ static void shutdown()
    }
 #endif
 
-   // then free all the memory pages
+   // then free all the memory pages, slabs included
 
+   gSlabList = NULL;
    walk = gPageList;
    while(walk) {
       PageRecord *prev = walk->prevPage;
@@ -932,11 +1041,251 @@ static void checkUnusedAlloc(FreeHeader *header, U32 size)
 static bool gReentrantGuard = false;
 #endif
 
+//---------------------------------------------------------------------------
+// Small blocks
+//
+// Each thread keeps its own free lists of small blocks, so most small
+// allocations and frees take no lock at all.  A thread refills a size
+// class from the shared lists, ThreadCacheRefill chunks at a time, and
+// hands chunks back once it holds more than ThreadCacheMax.  Chunks left
+// in the cache of a thread that exits stay unused.
+
+static bool lockMemory()
+{
+#ifdef TORQUE_MULTITHREAD
+   if(!gMemMutex && !gReentrantGuard)
+   {
+      gReentrantGuard = true;
+      gMemMutex = Mutex::createMutex();
+      gReentrantGuard = false;
+   }
+   if(gReentrantGuard)
+      return false;
+   Mutex::lockMutex(gMemMutex);
+   return true;
+#else
+   return false;
+#endif
+}
+
+static void unlockMemory(bool locked)
+{
+#ifdef TORQUE_MULTITHREAD
+   if(locked)
+      Mutex::unlockMutex(gMemMutex);
+#endif
+}
+
+static ThreadMemory *getThreadMemory()
+{
+#ifdef TORQUE_MULTITHREAD
+   // Constructed by the first allocation, which comes before there are
+   // any other threads, and never destroyed, since static destructors
+   // still free memory.
+   static ThreadStorage *sThreadStorage = NULL;
+   static U64 sThreadStorageSpace[(sizeof(ThreadStorage) + 7) / 8];
+   if(!sThreadStorage)
+      sThreadStorage = new(sThreadStorageSpace) ThreadStorage;
+
+   ThreadMemory *tm = (ThreadMemory *) sThreadStorage->get();
+   if(!tm)
+   {
+      tm = (ThreadMemory *) dRealMalloc(sizeof(ThreadMemory));
+      if(!tm)
+         memoryError();
+      dMemset(tm, 0, sizeof(ThreadMemory));
+      sThreadStorage->set(tm);
+
+      bool locked = lockMemory();
+      tm->nextThread = gThreadMemoryList;
+      gThreadMemoryList = tm;
+      unlockMemory(locked);
+   }
+   return tm;
+#else
+   static ThreadMemory sThreadMemory;
+   gThreadMemoryList = &sThreadMemory;
+   return &sThreadMemory;
+#endif
+}
+
+static inline SmallFreeList *getThreadCache(ThreadMemory *tm)
+{
+#ifdef TORQUE_MULTITHREAD
+   return &tm->smallFree;
+#else
+   // no other threads, the shared lists will do
+   return &gSmallFree;
+#endif
+}
+
+static inline void chargeTag(ThreadMemory *tm, AllocatedHeader *hdr)
+{
+   U32 tag = tm->tag;
+   hdr->flags |= tag << TagShift;
+   tm->tagBytes[tag] += hdr->size;
+   tm->tagCount[tag]++;
+}
+
+static inline void releaseTag(ThreadMemory *tm, AllocatedHeader *hdr)
+{
+   U32 tag = (hdr->flags & TagMask) >> TagShift;
+   tm->tagBytes[tag] -= hdr->size;
+   tm->tagCount[tag]--;
+}
+
+/// For a block resized in place, from oldSize.
+static inline void rechargeTag(AllocatedHeader *hdr, dsize_t oldSize)
+{
+   U32 tag = (hdr->flags & TagMask) >> TagShift;
+   getThreadMemory()->tagBytes[tag] += hdr->size - oldSize;
+}
+
+/// Adds a slab for sizeClass to the shared free list, lock held.
+static void allocSlab(U32 sizeClass)
+{
+   PageRecord *page = allocPage(SlabSize);
+   SlabRecord *slab = (SlabRecord *) page->basePtr;
+   slab->sizeClass = sizeClass;
+   slab->chunkSize = (sizeClass + 1) << SmallClassShift;
+   slab->chunkCount = (SlabSize - sizeof(SlabRecord)) / (sizeof(AllocatedHeader) + slab->chunkSize);
+   slab->nextSlab = gSlabList;
+   gSlabList = slab;
+
+   for(S32 i = slab->chunkCount - 1; i >= 0; i--)
+   {
+      AllocatedHeader *hdr = getSlabChunk(slab, i);
+      hdr->size = slab->chunkSize;
+      hdr->flags = SmallBlock;
+      hdr->prev = NULL;
+      hdr->next = (Header *) gSmallFree.head[sizeClass];
+#ifdef TORQUE_DEBUG_GUARD
+      setGuard((Header *) hdr, false);
+#endif
+      gSmallFree.head[sizeClass] = hdr;
+   }
+   gSmallFree.count[sizeClass] += slab->chunkCount;
+}
+
+/// Moves up to count chunks of sizeClass from one free list to another.
+static void moveSmallBlocks(SmallFreeList *from, SmallFreeList *to, U32 sizeClass, U32 count)
+{
+   while(count-- && from->head[sizeClass])
+   {
+      AllocatedHeader *hdr = from->head[sizeClass];
+      from->head[sizeClass] = (AllocatedHeader *) hdr->next;
+      from->count[sizeClass]--;
+      hdr->next = (Header *) to->head[sizeClass];
+      to->head[sizeClass] = hdr;
+      to->count[sizeClass]++;
+   }
+}
+
+static void* allocSmall(dsize_t size, bool array, const char* fileName, const U32 line)
+{
+   fileName, line;
+   U32 sizeClass = (size - 1) >> SmallClassShift;
+
+   ThreadMemory *tm = getThreadMemory();
+   SmallFreeList *cache = getThreadCache(tm);
+   if(!cache->head[sizeClass])
+   {
+      bool locked = lockMemory();
+      if(!gSmallFree.head[sizeClass])
+         allocSlab(sizeClass);
+      if(cache != &gSmallFree)
+         moveSmallBlocks(&gSmallFree, cache, sizeClass, ThreadCacheRefill);
+      unlockMemory(locked);
+   }
+
+   AllocatedHeader *hdr = cache->head[sizeClass];
+   cache->head[sizeClass] = (AllocatedHeader *) hdr->next;
+   cache->count[sizeClass]--;
+
+   hdr->next = NULL;
+   hdr->flags = array ? (SmallBlock | Allocated | Array) : (SmallBlock | Allocated);
+   chargeTag(tm, hdr);
+
+#ifdef TORQUE_DEBUG_GUARD
+   // the bookkeeping is shared, so guarded builds take the lock for it
+   bool locked = lockMemory();
+   setGuard((Header *) hdr, true);
+   hdr->line = line;
+   hdr->fileName = fileName;
+   hdr->allocNum = gCurrAlloc;
+   hdr->realSize = size;
+   if (gEnableLogging)
+      logAlloc(hdr, size);
+   if(gCurrAlloc == gBreakAlloc && gBreakAlloc != 0xFFFFFFFF)
+      Platform::debugBreak();
+   gCurrAlloc++;
+   unlockMemory(locked);
+#else
+   if(gCurrAlloc == gBreakAlloc && gBreakAlloc != 0xFFFFFFFF)
+      Platform::debugBreak();
+   gCurrAlloc++;
+#endif
+
+#ifdef TORQUE_DEBUG
+   dMemset(hdr + 1, 0xCF, hdr->size);
+#endif
+
+   return hdr + 1;
+}
+
+static void freeSmall(AllocatedHeader *hdr, bool array)
+{
+   AssertFatal(((bool)((hdr->flags & Array)==Array))==array, avar("Array alloc mismatch. "));
+
+#ifdef TORQUE_DEBUG_GUARD
+   if (gEnableLogging)
+   {
+      bool locked = lockMemory();
+      logFree(hdr);
+      unlockMemory(locked);
+   }
+   setGuard((Header *) hdr, false);
+#endif
+
+#ifdef TORQUE_DEBUG
+   dMemset(hdr + 1, 0xCE, hdr->size);
+#endif
+
+   U32 sizeClass = (hdr->size >> SmallClassShift) - 1;
+   ThreadMemory *tm = getThreadMemory();
+   releaseTag(tm, hdr);
+   hdr->flags = SmallBlock;
+
+   SmallFreeList *cache = getThreadCache(tm);
+   hdr->next = (Header *) cache->head[sizeClass];
+   cache->head[sizeClass] = hdr;
+   cache->count[sizeClass]++;
+
+   // The memory mutex is a small block too; the one freeing it
+   // mustn't take it.
+   if(cache != &gSmallFree && cache->count[sizeClass] > ThreadCacheMax && gMemMutex != (void *) (hdr + 1))
+   {
+      bool locked = lockMemory();
+      moveSmallBlocks(cache, &gSmallFree, sizeClass, ThreadCacheRefill);
+      unlockMemory(locked);
+   }
+}
+
+//---------------------------------------------------------------------------
+
 static void* alloc(dsize_t size, bool array, const char* fileName, const U32 line)
 {
    fileName, line;
    AssertFatal(size < MaxAllocationAmount, "Memory::alloc - tried to allocate > MaxAllocationAmount!");
 
+   if (size != 0 && size <= SmallBlockMax)
+   {
+      PROFILE_START(MemoryAllocSmall);
+      void* ret = allocSmall(size, array, fileName, line);
+      PROFILE_END();
+      return ret;
+   }
+
 #ifdef TORQUE_MULTITHREAD
    if(!gMemMutex && !gReentrantGuard)
    {
@@ -986,6 +1335,7 @@ static void* alloc(dsize_t size, bool array, const char* fileName, const U32 lin
 
    AllocatedHeader *retHeader = (AllocatedHeader *) header;
    retHeader->flags = array ? (Allocated | Array) : Allocated;
+   chargeTag(getThreadMemory(), retHeader);
 
 #ifdef TORQUE_DEBUG_GUARD
    retHeader->line = line;
@@ -1026,15 +1376,21 @@ static void free(void* mem, bool array)
    if (!mem)
       return;
 
+   AllocatedHeader *hdr = ((AllocatedHeader *)mem) - 1;
+   AssertFatal(hdr->flags & Allocated, avar("Not an allocated block!"));
+   if (hdr->flags & SmallBlock)
+   {
+      freeSmall(hdr, array);
+      return;
+   }
+
 #ifdef TORQUE_MULTITHREAD
    if(gMemMutex && gMemMutex != mem)
       Mutex::lockMutex(gMemMutex);
 #endif
 
    PROFILE_START(MemoryFree);
-   AllocatedHeader *hdr = ((AllocatedHeader *)mem) - 1;
 
-   AssertFatal(hdr->flags & Allocated, avar("Not an allocated block!"));
    AssertFatal(((bool)((hdr->flags & Array)==Array))==array, avar("Array alloc mismatch. "));
 
 #ifdef TORQUE_DEBUG_GUARD
@@ -1042,6 +1398,7 @@ static void free(void* mem, bool array)
       logFree(hdr);
 #endif
 
+   releaseTag(getThreadMemory(), hdr);
    hdr->flags = 0;
 
    // fill the block with the fill value
@@ -1098,6 +1455,24 @@ static void* realloc(void* mem, dsize_t size)
    if(!mem)
       return alloc(size, false, NULL, 0);
 
+   // Small blocks stay put while the new size fits the chunk, and
+   // otherwise move to a block of the right kind.
+   AllocatedHeader* smallHdr = ((AllocatedHeader *)mem) - 1;
+   if (smallHdr->flags & SmallBlock)
+   {
+      if (size <= smallHdr->size && size > smallHdr->size - (1 << SmallClassShift))
+      {
+#ifdef TORQUE_DEBUG_GUARD
+         smallHdr->realSize = size;
+#endif
+         return mem;
+      }
+      void* ret = alloc(size, false, NULL, 0);
+      dMemcpy(ret, mem, getMin(size, smallHdr->size));
+      free(mem, false);
+      return ret;
+   }
+
 #ifdef TORQUE_MULTITHREAD
    if(!gMemMutex)
       gMemMutex = Mutex::createMutex();
@@ -1122,6 +1497,7 @@ static void* realloc(void* mem, dsize_t size)
    PROFILE_START(MemoryRealloc);
 
    FreeHeader *next = (FreeHeader *) hdr->next;
+   dsize_t chargedSize = hdr->size;
 
 #ifdef TORQUE_DEBUG_GUARD
    hdr->realSize = size;
@@ -1138,6 +1514,7 @@ static void* realloc(void* mem, dsize_t size)
          next->next->prev = (Header *) hdr;
 
       checkUnusedAlloc((FreeHeader *) hdr, size);
+      rechargeTag(hdr, chargedSize);
       //validate();
       PROFILE_END();
 #ifdef TORQUE_MULTITHREAD
@@ -1148,6 +1525,7 @@ static void* realloc(void* mem, dsize_t size)
    else if(size < oldSize)
    {
       checkUnusedAlloc((FreeHeader *) hdr, size);
+      rechargeTag(hdr, chargedSize);
       PROFILE_END();
 #ifdef TORQUE_MULTITHREAD
       Mutex::unlockMutex(gMemMutex);
@@ -1177,6 +1555,10 @@ dsize_t getMemoryUsed()
             size += probe->size;
          }
    }
+   for (SlabRecord *slab = gSlabList; slab; slab = slab->nextSlab)
+      for (U32 i = 0; i < slab->chunkCount; i++)
+         if (getSlabChunk(slab, i)->flags & Allocated)
+            size += slab->chunkSize;
 
    return size;
 }
@@ -1200,6 +1582,16 @@ ConsoleFunction(dumpMemSnapshot,void,2,2,"(string fileName) Dump a snapshot of c
             fws.write(dStrlen(buffer), buffer);
          }
    }
+   for (SlabRecord *slab = gSlabList; slab; slab = slab->nextSlab)
+      for (U32 i = 0; i < slab->chunkCount; i++) {
+         AllocatedHeader* pah = getSlabChunk(slab, i);
+         if (pah->flags & Allocated) {
+            dSprintf(buffer, 1023, "%s\t%d\t%d\t%d\r\n",
+                     pah->fileName != NULL ? pah->fileName : "Undetermined",
+                     pah->line, pah->realSize, pah->allocNum);
+            fws.write(dStrlen(buffer), buffer);
+         }
+      }
 
    Con::errorf("total memory used: %d",getMemoryUsed());
    fws.close();
@@ -1211,6 +1603,144 @@ dsize_t getMemoryAllocated()
    return 0;
 }
 
+//---------------------------------------------------------------------------
+
+static const char* sTagNames[NumTags] =
+{
+   "General",
+   "Terrain",
+   "Interior",
+   "Shape",
+   "Texture",
+   "Audio",
+   "Script",
+   "Ghost",
+};
+
+U32 setCurrentTag(U32 tag)
+{
+   AssertFatal(tag < NumTags, "Memory::setCurrentTag - bad tag");
+   ThreadMemory *tm = getThreadMemory();
+   U32 prevTag = tm->tag;
+   tm->tag = tag;
+   return prevTag;
+}
+
+U32 getCurrentTag()
+{
+   return getThreadMemory()->tag;
+}
+
+const char* getTagName(U32 tag)
+{
+   return tag < NumTags ? sTagNames[tag] : "";
+}
+
+void getTagUsage(U32 tag, dsize_t* bytes, U32* count)
+{
+   *bytes = 0;
+   *count = 0;
+
+   // each thread counts what it allocated and freed, the sums are
+   // right even though the parts wrap
+   bool locked = lockMemory();
+   for(ThreadMemory *tm = gThreadMemoryList; tm; tm = tm->nextThread)
+   {
+      *bytes += tm->tagBytes[tag];
+      *count += tm->tagCount[tag];
+   }
+   unlockMemory(locked);
+}
+
+static const char* gMetricsFile = "";
+static F32 gMetricsInterval = 0;
+
+void consoleInit()
+{
+   Con::addVariable("Memory::metricsFile", TypeString, &gMetricsFile);
+   Con::addVariable("Memory::metricsInterval", TypeF32, &gMetricsInterval);
+}
+
+void processMetrics()
+{
+   static U32 sLastWrite = 0;
+   static char sOpenFile[256] = "";
+
+   if(gMetricsInterval <= 0 || !gMetricsFile || !gMetricsFile[0])
+      return;
+
+   U32 time = Platform::getRealMilliseconds();
+   if(sOpenFile[0] && time - sLastWrite < U32(gMetricsInterval * 1000))
+      return;
+   sLastWrite = time;
+
+   // a new file gets a header line, an old one is appended to
+   FileStream fws;
+   char buffer[1024];
+   if(dStrcmp(sOpenFile, gMetricsFile))
+   {
+      dStrncpy(sOpenFile, gMetricsFile, sizeof(sOpenFile) - 1);
+      sOpenFile[sizeof(sOpenFile) - 1] = 0;
+      if(!fws.open(sOpenFile, FileStream::Write))
+         return;
+
+      U32 len = dSprintf(buffer, sizeof(buffer), "time");
+      for(U32 i = 0; i < NumTags; i++)
+         len += dSprintf(buffer + len, sizeof(buffer) - len, "\t%sBytes\t%sCount", sTagNames[i], sTagNames[i]);
+      dStrcat(buffer, "\r\n");
+      fws.write(dStrlen(buffer), buffer);
+   }
+   else
+   {
+      if(!fws.open(sOpenFile, FileStream::ReadWrite))
+         return;
+      fws.setPosition(fws.getStreamSize());
+   }
+
+   U32 len = dSprintf(buffer, sizeof(buffer), "%d", time / 1000);
+   for(U32 i = 0; i < NumTags; i++)
+   {
+      dsize_t bytes;
+      U32 count;
+      getTagUsage(i, &bytes, &count);
+      len += dSprintf(buffer + len, sizeof(buffer) - len, "\t%d\t%d", bytes, count);
+   }
+   dStrcat(buffer, "\r\n");
+   fws.write(dStrlen(buffer), buffer);
+   fws.close();
+}
+
+ConsoleFunction(dumpMemoryTags, void, 1, 1, "Print the live bytes and blocks charged to each memory tag.")
+{
+   argc; argv;
+   for(U32 i = 0; i < NumTags; i++)
+   {
+      dsize_t bytes;
+      U32 count;
+      getTagUsage(i, &bytes, &count);
+      Con::printf("%-10s %10d bytes  %8d blocks", sTagNames[i], bytes, count);
+   }
+}
+
+ConsoleFunction(getMemoryTagUsage, const char*, 2, 2, "(string tag) Returns \"bytes blocks\" live under the tag.")
+{
+   argc;
+   for(U32 i = 0; i < NumTags; i++)
+   {
+      if(dStricmp(argv[1], sTagNames[i]))
+         continue;
+
+      dsize_t bytes;
+      U32 count;
+      getTagUsage(i, &bytes, &count);
+      char* ret = Con::getReturnBuffer(32);
+      dSprintf(ret, 32, "%d %d", bytes, count);
+      return ret;
+   }
+   Con::errorf("getMemoryTagUsage: unknown tag %s", argv[1]);
+   return "";
+}
+
 void setBreakAlloc(U32 breakAlloc)
 {
    gBreakAlloc = breakAlloc;
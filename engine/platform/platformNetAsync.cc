@@ -10,7 +10,7 @@
 // gets included by automated build stuff, we're manually snipping it out here.
 #if !defined(TORQUE_OS_WIN32)
 
-#include "platform/platformMutex.h"
+#include "platform/platformSemaphore.h"
 #include "platform/platformThread.h"
 #include "platform/platformNetAsync.h"
 #include "console/console.h"
@@ -22,28 +22,6 @@
 
 NetAsync gNetAsync;
 
-void* gNetAsyncMutex = NULL;
-
-static void lockNetAsyncMutex()
-{
-   if(!gNetAsyncMutex)
-      gNetAsyncMutex = Mutex::createMutex();
-
-   AssertFatal(gNetAsyncMutex, "Could not create gNetAsyncMutex!");
-   
-   Mutex::lockMutex(gNetAsyncMutex);
-}
-
-static void unlockNetAsyncMutex()
-{
-   if(!gNetAsyncMutex)
-      gNetAsyncMutex = Mutex::createMutex();
-
-   AssertFatal(gNetAsyncMutex, "Could not create gNetAsyncMutex!");
-   
-   Mutex::unlockMutex(gNetAsyncMutex);
-}
-
 // internal structure for storing information about a name lookup request
 struct NameLookupRequest
 {
@@ -51,7 +29,6 @@ struct NameLookupRequest
       char remoteAddr[4096];
       char out_h_addr[4096];
       int out_h_length;
-      bool complete;
 
       NameLookupRequest()
       {
@@ -59,32 +36,43 @@ struct NameLookupRequest
          remoteAddr[0] = 0;
          out_h_addr[0] = 0;
          out_h_length = -1;
-         complete = false;
       }
 };
 
+void NetAsync::flushBacklog()
+{
+   // Never have more out than mResultQueue can take back, so the lookup
+   // thread can always hand its answer over without waiting.
+   if (!mWakeSemaphore)
+      return;
+
+   while (mBacklog.size() && mInFlight < QueueSize && mRequestQueue.push(mBacklog[0]))
+   {
+      ++mInFlight;
+      mBacklog.erase(U32(0));
+      Semaphore::releaseSemaphore(mWakeSemaphore);
+   }
+}
+
 void NetAsync::queueLookup(const char* remoteAddr, NetSocket socket)
 {
-   lockNetAsyncMutex();
    // do we have it already?
    unsigned int i = 0;
-   for (i = 0; i < mLookupRequests.size(); ++i)
+   for (i = 0; i < mPending.size(); ++i)
    {
-      if (mLookupRequests[i]->sock == socket)
+      if (mPending[i]->sock == socket)
          // found it.  ignore more than one lookup at a time for a socket.
-         break;
+         return;
    }
 
-   if (i == mLookupRequests.size())
-   {
-      // not found, so add it
-      NameLookupRequest* lookupRequest = new NameLookupRequest();
-      lookupRequest->sock = socket;
-      dStrncpy(lookupRequest->remoteAddr, remoteAddr, 
-               sizeof(lookupRequest->remoteAddr));
-      mLookupRequests.push_back(lookupRequest);
-   }
-   unlockNetAsyncMutex();
+   // not found, so add it
+   NameLookupRequest* lookupRequest = new NameLookupRequest();
+   lookupRequest->sock = socket;
+   dStrncpy(lookupRequest->remoteAddr, remoteAddr, 
+            sizeof(lookupRequest->remoteAddr));
+   mPending.push_back(lookupRequest);
+   mBacklog.push_back(lookupRequest);
+   flushBacklog();
 }
 
 void NetAsync::run()
@@ -93,38 +81,18 @@ void NetAsync::run()
       return;
 
    mRunning = true;
-   NameLookupRequest* lookupRequest = NULL;
 
    while (isRunning())
    {
-      lookupRequest = NULL;
+      // one token per queued request, plus one from stop()
+      Semaphore::acquireSemaphore(mWakeSemaphore);
 
-      // lock 
-      lockNetAsyncMutex();
-      // if there is a request...
-      if (mLookupRequests.size() > 0)
-      {
-         // assign the first incomplete request
-         for (unsigned int i = 0; i < mLookupRequests.size(); ++i)
-            if (!mLookupRequests[i]->complete)
-               lookupRequest = mLookupRequests[i];
-      }
-
-      // unlock so that more requests can be added
-      unlockNetAsyncMutex();
-
-      // if we have a lookup request
-      if (lookupRequest != NULL)
+      NameLookupRequest* lookupRequest;
+      while (mRequestQueue.pop(lookupRequest))
       {
          // do it
          struct hostent* hostent = gethostbyname(lookupRequest->remoteAddr);
-         if (hostent == NULL)
-         {
-            // oh well!  leave the lookup data unmodified (h_length) should
-            // still be -1 from initialization
-            lookupRequest->complete = true;
-         }
-         else
+         if (hostent != NULL)
          {
             // copy the stuff we need from the hostent 
             dMemset(lookupRequest->out_h_addr, 0, 
@@ -132,47 +100,57 @@ void NetAsync::run()
             dMemcpy(lookupRequest->out_h_addr, hostent->h_addr, hostent->h_length);
 
             lookupRequest->out_h_length = hostent->h_length;
-            lookupRequest->complete = true;
          }
+         // otherwise oh well!  leave the lookup data unmodified (h_length)
+         // should still be -1 from initialization
+
+         // can't fail, the main thread never has more than QueueSize out.
+         mResultQueue.push(lookupRequest);
       }
-      else
-      {
-         // no lookup request.  sleep for a bit
-         Platform::sleep(500);
-      }
-   };
+   }
+}
+
+void NetAsync::stop()
+{
+   mRunning = false;
+   Semaphore::releaseSemaphore(mWakeSemaphore);
 }
 
 bool NetAsync::checkLookup(NetSocket socket, char* out_h_addr, 
                            int* out_h_length, int out_h_addr_size)
 {
-   lockNetAsyncMutex();
-   unsigned int i = 0;
-   bool found = false;
-   // search for the socket
-   Vector<NameLookupRequest*>::iterator iter;
-   for (iter = mLookupRequests.begin(); 
-        iter != mLookupRequests.end(); 
-        ++iter)
-      // if we found it and it is complete...
-      if (socket == (*iter)->sock && (*iter)->complete)
-      {
-         // copy the lookup data to the callers parameters
-         dMemcpy(out_h_addr, (*iter)->out_h_addr, out_h_addr_size);
-         *out_h_length = (*iter)->out_h_length;
-         found = true;
-         break;
-      }
+   NameLookupRequest* lookupRequest;
+   while (mResultQueue.pop(lookupRequest))
+   {
+      --mInFlight;
+      mComplete.push_back(lookupRequest);
+   }
+   flushBacklog();
 
-   // we found the socket, so we are done with it.  erase.
-   if (found)
+   // search for the socket
+   for (unsigned int i = 0; i < mComplete.size(); ++i)
    {
-      delete *iter;
-      mLookupRequests.erase(iter);
+      lookupRequest = mComplete[i];
+      if (lookupRequest->sock != socket)
+         continue;
+
+      // copy the lookup data to the callers parameters
+      dMemcpy(out_h_addr, lookupRequest->out_h_addr, out_h_addr_size);
+      *out_h_length = lookupRequest->out_h_length;
+
+      // we found the socket, so we are done with it.  erase.
+      mComplete.erase_fast(i);
+      for (unsigned int j = 0; j < mPending.size(); ++j)
+         if (mPending[j] == lookupRequest)
+         {
+            mPending.erase_fast(j);
+            break;
+         }
+      delete lookupRequest;
+      return true;
    }
-   unlockNetAsyncMutex();
 
-   return found;
+   return false;
 }
 
 // this is called by the pthread module to start the thread
@@ -193,6 +171,11 @@ void NetAsync::startAsync()
   if (gNetAsync.isRunning())
      return;
 
+  // the thread deletes itself and may still be finishing a lookup after
+  // stopAsync(), so the semaphore is created once and kept for good.
+  if (!gNetAsync.mWakeSemaphore)
+     gNetAsync.mWakeSemaphore = Semaphore::createSemaphore(0);
+
   // create the thread...
    Thread *zThread = new Thread((ThreadRunFunction)StartThreadFunc, 0, true);
 
@@ -8,21 +8,38 @@
 
 #include "platform/platform.h"
 #include "core/tVector.h"
+#include "core/tRingBuffer.h"
 
 struct NameLookupRequest;
 
 // class for doing asynchronous network operations on unix (linux and 
 // hopefully osx) platforms.  right now it only implements dns lookups
+//
+// requests go to the lookup thread and come back through a pair of
+// lock-free queues, so the main thread never waits on the resolver.
+// mPending, mBacklog and mComplete are only touched by the main thread.
 class NetAsync
 {
    private:
-      Vector<NameLookupRequest*> mLookupRequests;
-      bool mRunning;
+      enum { QueueSize = 64 };
+
+      SPSCQueue<NameLookupRequest*, QueueSize> mRequestQueue;   ///< main -> lookup thread
+      SPSCQueue<NameLookupRequest*, QueueSize> mResultQueue;    ///< lookup thread -> main
+      Vector<NameLookupRequest*> mPending;   ///< handed to the lookup thread or in mBacklog
+      Vector<NameLookupRequest*> mBacklog;   ///< didn't fit in mRequestQueue yet
+      Vector<NameLookupRequest*> mComplete;  ///< resolved, waiting for checkLookup()
+      U32 mInFlight;                         ///< pushed to mRequestQueue, not yet popped from mResultQueue
+      void* mWakeSemaphore;
+      volatile bool mRunning;
+
+      void flushBacklog();
 
    public:
       NetAsync()
       {
          mRunning = false;
+         mWakeSemaphore = NULL;
+         mInFlight = 0;
       }
 
       // queue a DNS lookup.  only one dns lookup can be queued per socket at
@@ -43,7 +60,7 @@ class NetAsync
 
       // these functions are used by the static start/stop functions
       void run();
-      void stop() { mRunning = false; };
+      void stop();
 
       // used to start and stop the thread
       static void startAsync();
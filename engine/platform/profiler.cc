@@ -16,6 +16,7 @@
 #include "platform/profiler.h"
 #include "platform/platformMutex.h"
 #include "util/safeDelete.h"
+#include "console/consoleTypes.h"
 #include <stdlib.h> // gotta use malloc and free directly
 
 #ifdef TORQUE_ENABLE_PROFILER
@@ -127,6 +128,22 @@ U32 endHighResolutionTimer(U32 time[2])
 
 #endif
 
+/// Absolute time for the trace events, in whatever units the high
+/// resolution timer counts.
+static U64 readTraceClock()
+{
+   U32 time[2] = { 0, 0 };
+   startHighResolutionTimer(time);
+
+   U64 ticks = (U64(time[1]) << 32) | time[0];
+
+   // No timer on this platform, so make do with milliseconds.
+   if(!ticks)
+      ticks = U64(Platform::getRealMilliseconds()) * 1000;
+
+   return ticks;
+}
+
 //-----------------------------------------------------------------------------
 
 ProfilerRoot *ProfilerRoot::smRootList = NULL;
@@ -172,6 +189,8 @@ void ProfilerRootData::reset()
    mTotalTime = 0;
    mSubTime   = 0;
    mTotalInvokeCount = 0;
+   mGpuTime   = 0;
+   mGpuInvokeCount = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -215,6 +234,13 @@ ProfilerInstance::ProfilerInstance()
    mDumpToFile       = false;
    dMemset(mDumpFileName, 0, sizeof(mDumpFileName));
 
+   // No trace buffer until we record.
+   mTraceEvents      = NULL;
+   mTraceSize        = 0;
+   mTraceHead        = 0;
+   mTracing          = false;
+   mTraceFrameStart  = 0;
+
    mRootCount = ProfilerRoot::smRootCount;
 }
 
@@ -224,6 +250,7 @@ ProfilerInstance::~ProfilerInstance()
    m.lock(mMutex);
 
    free(mRootTable);
+   free(mTraceEvents);
 
    // Walk the profilelist and free things on it.
    ProfilerData *walk = mProfileList, *tmp;
@@ -251,6 +278,12 @@ void ProfilerInstance::hashPush(ProfilerRoot *pr)
    AssertFatal(mStackDepth <= mMaxStackDepth,
       "Stack overflow in profiler.  You may have mismatched PROFILE_START and PROFILE_ENDs");
 
+   // Timeline capture doesn't care if we're enabled.
+   if(mStackDepth == 1)
+      beginTraceFrame();
+   if(mTracing)
+      recordTrace(pr);
+
    if(!mEnabled)
       return;
 
@@ -341,6 +374,9 @@ void ProfilerInstance::hashPop()
    mStackDepth--;
    AssertFatal(mStackDepth >= 0, "Stack underflow in profiler.  You may have mismatched PROFILE_START and PROFILE_ENDs");
 
+   if(mTracing)
+      recordTrace(NULL);
+
    if(mEnabled)
    {
       // If we're in a subdepth situation, then just dec it.
@@ -401,9 +437,126 @@ void ProfilerInstance::hashPop()
       // Finally, kick off the timer if appropriate.
       if(doStart)
          startHighResolutionTimer(mCurrentProfilerData->mStartTime);
+
+      // Trace dumps lock the other instances, so do them without ours.
+      m.unlock();
+      gProfiler->gpuCollect(this);
+      endTraceFrame();
    }
 }
 
+inline void ProfilerInstance::recordTrace(ProfilerRoot *pr)
+{
+   TraceEvent &ev = mTraceEvents[mTraceHead & (mTraceSize - 1)];
+   ev.mRoot  = pr;
+   ev.mTicks = readTraceClock();
+   mTraceHead++;
+}
+
+void ProfilerInstance::beginTraceFrame()
+{
+   if(!gProfiler->mTraceCapture)
+   {
+      mTracing = false;
+      return;
+   }
+
+   if(!mTracing)
+   {
+      // Starting a new recording, so start with an empty buffer. Keep it
+      // a power of two so the ring index is a mask.
+      U32 size = 1024;
+      while(size < Profiler::smTraceEvents && size < (1 << 24))
+         size <<= 1;
+
+      MutexHandle m;
+      m.lock(mMutex);
+
+      if(size != mTraceSize)
+      {
+         free(mTraceEvents);
+         mTraceEvents = (TraceEvent*)malloc(sizeof(TraceEvent) * size);
+         mTraceSize   = size;
+      }
+      mTraceHead = 0;
+      mTracing   = true;
+   }
+
+   mTraceFrameStart = readTraceClock();
+}
+
+void ProfilerInstance::endTraceFrame()
+{
+   if(mTracing && Profiler::smTraceHitchMs > 0)
+   {
+      F64 ms = F64(readTraceClock() - mTraceFrameStart) / (gProfiler->getTraceTicksPerUs() * 1000);
+      if(ms > Profiler::smTraceHitchMs)
+         gProfiler->traceHitch(ms);
+   }
+
+   if(gProfiler->mTraceDumpPending)
+      gProfiler->traceDumpPending();
+}
+
+void ProfilerInstance::writeTrace(Stream &stream, U64 startTicks, F64 ticksPerUs, bool &first)
+{
+   TraceEvent *events = NULL;
+   U32 count = 0;
+   U32 skip  = 0;
+
+   {
+      MutexHandle m;
+      m.lock(mMutex);
+
+      if(!mTraceEvents || !mTraceHead)
+         return;
+
+      U32 head  = mTraceHead;
+      count     = head < mTraceSize ? head : mTraceSize;
+      events    = (TraceEvent*)malloc(sizeof(TraceEvent) * count);
+
+      U32 start = head - count;
+      for(U32 i = 0; i < count; i++)
+         events[i] = mTraceEvents[(start + i) & (mTraceSize - 1)];
+
+      // The thread doesn't lock to record, so it may have gone on over
+      // our oldest events while we copied them.
+      skip = mTraceHead - head;
+      if(skip > count)
+         skip = count;
+   }
+
+   // The ring will usually have lost the starts of the oldest blocks, so
+   // drop ends that have nothing to close.
+   U32 depth = 0;
+   char buffer[512];
+   for(U32 i = skip; i < count; i++)
+   {
+      const TraceEvent &ev = events[i];
+      F64 ts = ev.mTicks > startTicks ? F64(ev.mTicks - startTicks) / ticksPerUs : 0;
+
+      if(ev.mRoot)
+      {
+         depth++;
+         dSprintf(buffer, sizeof(buffer), "%s\n{\"name\":\"%s\",\"ph\":\"B\",\"pid\":0,\"tid\":%u,\"ts\":%.3f}",
+            first ? "" : ",", ev.mRoot->mName, mThreadID, ts);
+      }
+      else
+      {
+         if(!depth)
+            continue;
+         depth--;
+         dSprintf(buffer, sizeof(buffer), "%s\n{\"ph\":\"E\",\"pid\":0,\"tid\":%u,\"ts\":%.3f}",
+            first ? "" : ",", mThreadID, ts);
+      }
+
+      stream.write(dStrlen(buffer), buffer);
+      first = false;
+   }
+
+   free(events);
+}
+
 void ProfilerInstance::validate()
 {
    mEnabled = false;
@@ -494,9 +647,44 @@ void ProfilerInstance::printSortedRootData(Vector<ProfilerRootData*> &rootVector
          F32(100 * rootVector[i]->mTotalTime / totalTime),
          rootVector[i]->mTotalInvokeCount,
          rootVector[i]->mRoot->mName);
+   }
+
+   printGpuRootData(rootVector, totalTime);
+
+   for(U32 i = 0; i < rootVector.size(); i++)
+   {
       rootVector[i]->mTotalInvokeCount = 0;
       rootVector[i]->mTotalTime = 0;
       rootVector[i]->mSubTime = 0;
+      rootVector[i]->mGpuTime = 0;
+      rootVector[i]->mGpuInvokeCount = 0;
+   }
+}
+
+void ProfilerInstance::printGpuRootData(Vector<ProfilerRootData*> &rootVector, F64 totalTime)
+{
+   bool header = false;
+   for(U32 i = 0; i < rootVector.size(); i++)
+   {
+      ProfilerRootData *prd = rootVector[i];
+      if(!prd->mGpuInvokeCount)
+         continue;
+
+      if(!header)
+      {
+         printFunc("");
+         printFunc("GPU timed blocks, in the same order:");
+         printFunc("");
+         printFunc("  GPU ms  Avg ms  Timed #  %% Time  Name");
+         header = true;
+      }
+
+      printFunc("%8.2f %7.3f %8d %7.3f  %s",
+         F32(prd->mGpuTime),
+         F32(prd->mGpuTime / prd->mGpuInvokeCount),
+         prd->mGpuInvokeCount,
+         F32(100 * prd->mTotalTime / totalTime),
+         prd->mRoot->mName);
    }
 }
 
@@ -665,6 +853,26 @@ void ProfilerInstance::dumpToConsole()
    // Implicit unlock.
 }
 
+void ProfilerInstance::dumpToFile(const char *fileName)
+{
+   MutexHandle m;
+   m.lock(mMutex);
+
+   mDumpToFile = true;
+   dStrncpy(mDumpFileName, fileName, DumpFileNameLength - 1);
+   mDumpFileName[DumpFileNameLength - 1] = '\0';
+
+   // Same as dumpToConsole(), in case this thread is gone.
+   if(mStackDepth == 0)
+   {
+      mEnabled = false;
+      mNextEnable = true;
+      dump();
+   }
+
+   // Implicit unlock.
+}
+
 void ProfilerInstance::growRoots(U32 newCount)
 {
    // If it's the same size or smaller as we've got now, early out.
@@ -709,6 +917,11 @@ void ProfilerInstance::growRoots(U32 newCount)
 /// Pointer to the global profiler.
 Profiler *gProfiler = NULL;
 
+S32         Profiler::smTraceEvents    = 65536;
+S32         Profiler::smTraceHitchMs   = 0;
+const char *Profiler::smTraceHitchFile = "profilerHitch";
+bool        Profiler::smGpuTiming      = true;
+
 static Profiler aProfiler;
 
 Profiler::Profiler()
@@ -716,6 +929,22 @@ Profiler::Profiler()
    mInstanceListHead = NULL;
    mDumpMutex = Mutex::createMutex();
 
+   mTraceCapture       = false;
+   mTraceStartTicks    = 0;
+   mTraceStartMs       = 0;
+   mTraceHitchDumpMs   = 0;
+   mTraceHitchCount    = 0;
+   mTraceDumpPending   = false;
+   mTraceDumpFileName[0] = 0;
+   mTraceMutex         = Mutex::createMutex();
+
+   mGpuTimer           = NULL;
+   mGpuHead            = 0;
+   mGpuTail            = 0;
+   mGpuDepth           = 0;
+   mGpuTiming          = false;
+   mGpuTraceHead       = 0;
+
    // Singleton magic:
    AssertISV(gProfiler==NULL, "Profiler - a Profiler is already present!");
    gProfiler = this;
@@ -727,6 +956,7 @@ Profiler::~Profiler()
    // Make it so we don't do anything while we're in the destructor.
    gGlobalProfilerReentrancyGuard = true;
    Mutex::destroyMutex(mDumpMutex);
+   Mutex::destroyMutex(mTraceMutex);
 
    // Clean up the instance list.
    ProfilerInstance *walk = mInstanceListHead, *tmp;
@@ -818,6 +1048,231 @@ void Profiler::dumpToConsole()
       walk->dumpToConsole();
 }
 
+void Profiler::dumpToFile(const char *fileName)
+{
+   // The threads would all write the same file, so only the caller's goes.
+   ProfilerInstance *pi = getCurrentInstance();
+   if(pi)
+      pi->dumpToFile(fileName);
+}
+
+//-----------------------------------------------------------------------------
+
+void Profiler::enableTrace(bool enable)
+{
+   MutexHandle m;
+   m.lock(mTraceMutex);
+
+   if(enable && !mTraceCapture)
+   {
+      mTraceStartTicks = readTraceClock();
+      mTraceStartMs    = Platform::getRealMilliseconds();
+      mGpuTraceHead    = 0;
+   }
+
+   // The threads pick this up at their next frame.
+   mTraceCapture = enable;
+}
+
+void Profiler::traceToFile(const char *fileName)
+{
+   MutexHandle m;
+   m.lock(mTraceMutex);
+
+   dStrncpy(mTraceDumpFileName, fileName, sizeof(mTraceDumpFileName) - 1);
+   mTraceDumpFileName[sizeof(mTraceDumpFileName) - 1] = 0;
+   mTraceDumpPending = true;
+}
+
+F64 Profiler::getTraceTicksPerUs()
+{
+   U32 ms = Platform::getRealMilliseconds() - mTraceStartMs;
+   if(!ms)
+      return 1;
+
+   return F64(readTraceClock() - mTraceStartTicks) / (F64(ms) * 1000);
+}
+
+void Profiler::traceHitch(F64 ms)
+{
+   MutexHandle m;
+   m.lock(mTraceMutex);
+
+   // Writing the trace makes for another long frame; don't dump that too.
+   enum { HitchDumpInterval = 5000 };
+   U32 now = Platform::getRealMilliseconds();
+   if(mTraceHitchCount && now - mTraceHitchDumpMs < HitchDumpInterval)
+      return;
+
+   char fileName[256];
+   dSprintf(fileName, sizeof(fileName), "%s%d.json", smTraceHitchFile, mTraceHitchCount++);
+   Con::warnf("Profiler: %.1f ms frame, writing timeline to %s.", F32(ms), fileName);
+   writeTrace(fileName);
+
+   mTraceHitchDumpMs = Platform::getRealMilliseconds();
+}
+
+void Profiler::traceDumpPending()
+{
+   MutexHandle m;
+   m.lock(mTraceMutex);
+
+   // Someone else might've got here first.
+   if(!mTraceDumpPending)
+      return;
+
+   writeTrace(mTraceDumpFileName);
+   mTraceDumpPending = false;
+}
+
+void Profiler::writeTrace(const char *fileName)
+{
+   // Writing the file allocates, which we don't want to profile.
+   gProfilerReentrancyGuard.set((void*)1);
+
+   FileStream fws;
+   if(fws.open(fileName, FileStream::Write))
+   {
+      const char *header = "{\"traceEvents\":[";
+      fws.write(dStrlen(header), header);
+
+      F64 ticksPerUs = getTraceTicksPerUs();
+      bool first = true;
+      for(ProfilerInstance *walk = mInstanceListHead; walk; walk = walk->mNextInstance)
+         walk->writeTrace(fws, mTraceStartTicks, ticksPerUs, first);
+      writeGpuTrace(fws, ticksPerUs, first);
+
+      const char *footer = "\n],\"displayTimeUnit\":\"ms\"}\n";
+      fws.write(dStrlen(footer), footer);
+      fws.close();
+   }
+   else
+      Con::errorf("Profiler: unable to write timeline to %s.", fileName);
+
+   gProfilerReentrancyGuard.set(0);
+}
+
+//-----------------------------------------------------------------------------
+
+void Profiler::setGpuTimer(ProfilerGpuTimer *timer)
+{
+   AssertFatal(!mGpuDepth, "Profiler::setGpuTimer - changing timers inside a GPU block!");
+
+   // Whatever the old timer had out is gone.
+   mGpuTimer = timer;
+   mGpuTail  = mGpuHead;
+}
+
+void Profiler::gpuPush(ProfilerRoot *pr)
+{
+   // Only the outermost block is timed; the queries don't nest.
+   if(mGpuDepth++ || !mGpuTimer || !smGpuTiming)
+      return;
+
+   // Falling behind on the results; skip this one.
+   if(mGpuHead - mGpuTail >= MaxGpuBlocks)
+      return;
+
+   ProfilerInstance *pi = getCurrentInstance();
+   if(!pi || (!pi->mEnabled && !pi->mTracing))
+      return;
+
+   S32 query = mGpuTimer->begin();
+   if(query < 0)
+      return;
+
+   GpuBlock &block = mGpuBlocks[mGpuHead % MaxGpuBlocks];
+   block.mRoot     = pr;
+   block.mInstance = pi;
+   block.mQuery    = query;
+   block.mTicks    = readTraceClock();
+   mGpuHead++;
+   mGpuTiming = true;
+}
+
+void Profiler::gpuPop()
+{
+   AssertFatal(mGpuDepth, "Profiler::gpuPop - mismatched PROFILE_GPU_START and PROFILE_GPU_END!");
+   if(--mGpuDepth || !mGpuTiming)
+      return;
+
+   mGpuTimer->end(mGpuBlocks[(mGpuHead - 1) % MaxGpuBlocks].mQuery);
+   mGpuTiming = false;
+}
+
+void Profiler::gpuCollect(ProfilerInstance *pi)
+{
+   // The GPU finishes queries in order, so stop at the first that isn't.
+   while(mGpuTail != mGpuHead)
+   {
+      GpuBlock &block = mGpuBlocks[mGpuTail % MaxGpuBlocks];
+      if(block.mInstance != pi)
+         return;
+
+      F64 ms;
+      if(!mGpuTimer->collect(block.mQuery, ms))
+         return;
+      mGpuTail++;
+
+      if(ms < 0)
+         continue;
+
+      if(pi->mEnabled)
+      {
+         pi->growRoots(ProfilerRoot::smRootCount);
+         ProfilerRootData *prd = pi->lookup(block.mRoot);
+         prd->mGpuTime += ms;
+         prd->mGpuInvokeCount++;
+      }
+
+      if(pi->mTracing)
+      {
+         MutexHandle m;
+         m.lock(mTraceMutex);
+
+         GpuTraceEvent &ev = mGpuTrace[mGpuTraceHead % GpuTraceSize];
+         ev.mRoot  = block.mRoot;
+         ev.mTicks = block.mTicks;
+         ev.mMs    = ms;
+         mGpuTraceHead++;
+      }
+   }
+}
+
+void Profiler::writeGpuTrace(Stream &stream, F64 ticksPerUs, bool &first)
+{
+   if(!mGpuTraceHead)
+      return;
+
+   // Only how long the GPU took is known, not when it started, so the
+   // blocks go on their own track at the time they were issued.
+   char buffer[512];
+   dSprintf(buffer, sizeof(buffer), "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"GPU\"}}",
+      first ? "" : ",");
+   stream.write(dStrlen(buffer), buffer);
+   first = false;
+
+   U32 count = mGpuTraceHead < GpuTraceSize ? mGpuTraceHead : GpuTraceSize;
+   for(U32 i = mGpuTraceHead - count; i < mGpuTraceHead; i++)
+   {
+      const GpuTraceEvent &ev = mGpuTrace[i % GpuTraceSize];
+      if(ev.mTicks < mTraceStartTicks)
+         continue;
+
+      dSprintf(buffer, sizeof(buffer), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}",
+         ev.mRoot->mName, F64(ev.mTicks - mTraceStartTicks) / ticksPerUs, ev.mMs * 1000);
+      stream.write(dStrlen(buffer), buffer);
+   }
+}
+
+void Profiler::consoleInit()
+{
+   Con::addVariable("$Profiler::traceEvents",    TypeS32,    &smTraceEvents);
+   Con::addVariable("$Profiler::traceHitchMs",   TypeS32,    &smTraceHitchMs);
+   Con::addVariable("$Profiler::traceHitchFile", TypeString, &smTraceHitchFile);
+   Con::addVariable("$Profiler::gpuTiming",      TypeBool,   &smGpuTiming);
+}
+
 //-----------------------------------------------------------------------------
 
 ConsoleFunction(profilerEnable, void, 2, 2, "(bool enable) - Turn the profiler on and off.")
@@ -830,4 +1285,16 @@ ConsoleFunction(profilerDump, void, 1, 1, "() - Dump all profiled threads' infor
    if(gProfiler) gProfiler->dumpToConsole();
 }
 
+ConsoleFunction(profilerTraceEnable, void, 2, 2, "(bool enable) - Start or stop recording the profiler timeline.")
+{
+   if(gProfiler) gProfiler->enableTrace(dAtob(argv[1]));
+}
+
+ConsoleFunction(profilerTraceDump, void, 2, 2, "(string filename) - Write the recorded timeline as Chrome trace events.")
+{
+   char fileName[1024];
+   Con::expandScriptFilename(fileName, sizeof(fileName), argv[1]);
+   if(gProfiler) gProfiler->traceToFile(fileName);
+}
+
 #endif
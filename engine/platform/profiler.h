@@ -18,11 +18,22 @@
 
    #define PROFILE_END() if(gProfiler) gProfiler->hashPop()
 
+   // A block whose GPU time is measured as well.
+   #define PROFILE_GPU_START(name) \
+      PROFILE_START(name); \
+      if(gProfiler) gProfiler->gpuPush(& pdata##name##obj )
+
+   #define PROFILE_GPU_END() \
+      if(gProfiler) gProfiler->gpuPop(); \
+      PROFILE_END()
+
 #else
 
    // If profiler is disabled then just stub the blocks out.
    #define PROFILE_START(x)
    #define PROFILE_END()
+   #define PROFILE_GPU_START(x)
+   #define PROFILE_GPU_END()
 
 #endif
 
@@ -89,6 +100,42 @@ struct ProfilerInstance;
 /// profilerDumpToFile(string filename);                    //dumps all profiler data to a given file
 /// @endcode
 ///
+/// <b>Timeline Capture</b>
+///
+/// The dumps above only give totals, which can't show what happened in
+/// one slow frame, or how the threads lined up in it. For that the
+/// profiler can also record every PROFILE_START() and PROFILE_END() as a
+/// timestamped event in a ring buffer per thread, and write the last
+/// events of all the threads to a file in the Chrome trace event format,
+/// for chrome://tracing or any other viewer that reads it.
+///
+/// @code
+/// // Starts or stops recording. Each thread keeps its last
+/// // $Profiler::traceEvents events, 65536 by default.
+/// profilerTraceEnable(bool enable);
+/// profilerTraceDump(string filename);                     //writes the recorded events
+///
+/// // While recording, a frame (ie, a thread's outermost block) taking
+/// // longer than this many ms writes the events by itself, to
+/// // $Profiler::traceHitchFile with a number and ".json" appended.
+/// // 0 turns it off.
+/// $Profiler::traceHitchMs = 50;
+/// @endcode
+///
+/// Recording is independent from profilerEnable(), and is picked up by
+/// each thread at the start of its next frame, so every frame it has is
+/// complete.
+///
+/// <b>GPU Timing</b>
+///
+/// Blocks opened with PROFILE_GPU_START() and closed with PROFILE_GPU_END()
+/// also measure how long the GPU took over the commands issued inside
+/// them, when the renderer has set up a ProfilerGpuTimer (GL_EXT_timer_query).
+/// The results come back a few frames later without stalling, and show
+/// up in a section of their own in the dumps, and on a "GPU" thread in the
+/// timeline. Only the outermost of nested GPU blocks is timed. Set
+/// $Profiler::gpuTiming to false to turn this off.
+///
 /// The C++ code side of the profiler uses pairs of PROFILE_START() and
 /// PROFILE_END().
 ///
@@ -202,6 +249,26 @@ struct ProfilerInstance;
 /// in the tree, we can easily build up a consistent view of how our code
 /// blocks are called, and how we spend our time in different calling
 /// hierarchies.
+/// Times GPU work for PROFILE_GPU_START() blocks, for whatever renderer
+/// the platform has.
+///
+/// @see dglGpuTimerInit
+class ProfilerGpuTimer
+{
+public:
+   virtual ~ProfilerGpuTimer() {}
+
+   /// Start timing what gets issued from now on. Returns a query for the
+   /// calls below, or -1 if it can't time anything right now.
+   virtual S32 begin() = 0;
+   virtual void end(S32 query) = 0;
+
+   /// Returns false if the GPU hasn't got through the query yet. Otherwise
+   /// the query is freed, and ms is how long it took, or negative if the
+   /// result was lost.
+   virtual bool collect(S32 query, F64 &ms) = 0;
+};
+
 class Profiler
 {
    friend class ProfilerInstance;
@@ -223,6 +290,90 @@ class Profiler
    bool mCurrentDumpIsFile;
    Stream *mCurrentDumpStream;
 
+   /// @name Timeline Capture
+   /// @{
+
+   /// Should threads record at their next frame?
+   volatile bool mTraceCapture;
+
+   /// Clock and real time when recording started, for converting the
+   /// event times to microseconds.
+   U64 mTraceStartTicks;
+   U32 mTraceStartMs;
+
+   /// Real time of the last hitch dump, so one long hitch doesn't write a
+   /// file a frame.
+   U32 mTraceHitchDumpMs;
+   U32 mTraceHitchCount;
+
+   /// Dump requested by profilerTraceDump(), done by the next thread to
+   /// finish a frame.
+   volatile bool mTraceDumpPending;
+   char mTraceDumpFileName[256];
+
+   /// Guards the above, and keeps to one trace dump at a time. Taken
+   /// before any instance's mutex, never after.
+   void *mTraceMutex;
+
+   /// Clock ticks per microsecond, measured since recording started.
+   F64 getTraceTicksPerUs();
+
+   /// Called by the instances at the end of a frame, with no locks held.
+   void traceHitch(F64 ms);
+   void traceDumpPending();
+
+   /// Write the events of all the threads. You should have mTraceMutex.
+   void writeTrace(const char *fileName);
+
+   /// @}
+
+   /// @name GPU Timing
+   /// @{
+
+   enum
+   {
+      MaxGpuBlocks = 256,
+      GpuTraceSize = 4096
+   };
+
+   /// A timed block, waiting on its query.
+   struct GpuBlock
+   {
+      ProfilerRoot *mRoot;
+      ProfilerInstance *mInstance;
+      S32 mQuery;
+      U64 mTicks;
+   };
+
+   ProfilerGpuTimer *mGpuTimer;
+
+   /// Blocks waiting on their results, oldest at mGpuTail % MaxGpuBlocks.
+   GpuBlock mGpuBlocks[MaxGpuBlocks];
+   U32 mGpuHead;
+   U32 mGpuTail;
+
+   /// Depth of GPU blocks, and whether the outermost one is being timed.
+   U32  mGpuDepth;
+   bool mGpuTiming;
+
+   /// Results for the timeline, a ring like ProfilerInstance's.
+   struct GpuTraceEvent
+   {
+      ProfilerRoot *mRoot;
+      U64 mTicks;
+      F64 mMs;
+   };
+   GpuTraceEvent mGpuTrace[GpuTraceSize];
+   U32 mGpuTraceHead;
+
+   /// Read back what's finished, at the end of a frame of the thread that
+   /// issued it.
+   void gpuCollect(ProfilerInstance *pi);
+
+   void writeGpuTrace(Stream &stream, F64 ticksPerUs, bool &first);
+
+   /// @}
+
 public:
    Profiler();
    ~Profiler();
@@ -236,12 +387,38 @@ public:
 
    void enable(bool enable);
    void dumpToConsole();
+   /// Dumps the calling thread's blocks to a file, at the end of its frame.
    void dumpToFile(const char *fileName);
    void enableMarker(const char *marker, bool enable);
    void reset();
 
    void hashPush(ProfilerRoot *pr);
    void hashPop();
+
+   /// @name Timeline Capture
+   /// @{
+   void enableTrace(bool enable);
+   void traceToFile(const char *fileName);
+
+   /// Ring buffer size, in events per thread.
+   static S32 smTraceEvents;
+   /// Dump when a frame takes longer than this, in ms.
+   static S32 smTraceHitchMs;
+   static const char *smTraceHitchFile;
+
+   static void consoleInit();
+   /// @}
+
+   /// @name GPU Timing
+   /// @{
+   void gpuPush(ProfilerRoot *pr);
+   void gpuPop();
+
+   /// Set by the renderer, or NULL.
+   void setGpuTimer(ProfilerGpuTimer *timer);
+
+   static bool smGpuTiming;
+   /// @}
 };
 
 extern Profiler *gProfiler;
@@ -330,6 +507,10 @@ struct ProfilerRootData
    /// Total number of times all instances of this block have been invoked.
    U32 mTotalInvokeCount;
 
+   /// GPU time of the timed invocations, in ms, and how many there were.
+   F64 mGpuTime;
+   U32 mGpuInvokeCount;
+
    /// @}
 
    /// Reset all the data accumulators.
@@ -438,6 +619,9 @@ class ProfilerInstance
    /// Print a sorted vector of profiler block data in a nice way.
    static void printSortedRootData(Vector<ProfilerRootData*> &rootVector, F64 totalTime);
 
+   /// Print the blocks with GPU times.
+   static void printGpuRootData(Vector<ProfilerRootData*> &rootVector, F64 totalTime);
+
    /// Recursively dump part of the profiler data tree.
    static void profilerDataDumpRecurse(ProfilerData *data, char *buffer, U32 bufferLen, F64 totalTime);
 
@@ -496,6 +680,45 @@ class ProfilerInstance
    /// This is the root ProfilerData in our local tree of profiler data.
    ProfilerData *mRootProfilerData;
 
+   /// @name Timeline Capture
+   /// @{
+
+   /// A PROFILE_START(), or a PROFILE_END() if mRoot is NULL.
+   struct TraceEvent
+   {
+      ProfilerRoot *mRoot;
+      U64 mTicks;
+   };
+
+   /// Ring buffer of events, allocated the first time we record.
+   TraceEvent *mTraceEvents;
+   U32 mTraceSize;
+
+   /// Total events recorded so far; the next one goes at
+   /// mTraceHead % mTraceSize.
+   U32 mTraceHead;
+
+   /// Recording this frame? Only changes between frames, so ends always
+   /// follow their starts.
+   bool mTracing;
+
+   /// When the current frame started.
+   U64 mTraceFrameStart;
+
+   inline void recordTrace(ProfilerRoot *pr);
+
+   /// Pick up the recording state at the start of a frame.
+   void beginTraceFrame();
+
+   /// Check for hitches and trace dumps at the end of a frame.
+   void endTraceFrame();
+
+   /// Write our events, as part of Profiler::writeTrace(). They are
+   /// copied out under our mutex first, so the thread can keep going.
+   void writeTrace(Stream &stream, U64 startTicks, F64 ticksPerUs, bool &first);
+
+   /// @}
+
    /// Currently enabled?
    bool mEnabled;
 
@@ -93,5 +93,13 @@ typedef unsigned long long  U64;
 #endif
 
 
+//--------------------------------------
+// Thread local storage for plain data; Apple's GCC doesn't have it.
+#if !defined(__APPLE__)
+#  define TORQUE_THREAD_LOCAL __thread
+#  define TORQUE_SUPPORTS_THREAD_LOCAL
+#endif
+
+
 #endif // INCLUDED_TYPES_GCC_H
 
@@ -72,6 +72,12 @@ static const F32 F32_MAX = F32(3.402823466e+38F);                 ///< Constant
 #  error "Unknown Compiler"
 #endif
 
+// Without thread local storage the data is simply shared, and code that
+// needs it must check TORQUE_SUPPORTS_THREAD_LOCAL to run on one thread.
+#ifndef TORQUE_THREAD_LOCAL
+#  define TORQUE_THREAD_LOCAL
+#endif
+
 //--------------------------------------
 // Enable Asserts in all debug builds -- AFTER compiler types include.
 #if defined(TORQUE_DEBUG)
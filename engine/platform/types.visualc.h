@@ -52,6 +52,9 @@ typedef unsigned _int64 U64;
 
 #define FN_CDECL __cdecl            ///< Calling convention
 
+#define TORQUE_THREAD_LOCAL __declspec(thread)   ///< Thread local storage for plain data
+#define TORQUE_SUPPORTS_THREAD_LOCAL
+
 #define for if(false) {} else for   ///< Hack to work around Microsoft VC's non-C++ compliance on variable scoping
 
 // disable warning caused by memory layer
@@ -55,6 +55,8 @@ void Processor::init()
    // These should determine what special code paths we use.
    Platform::SystemInfo.processor.properties = cpuFeatures;
 
+   Platform::SystemInfo.processor.numCores = numCpus > 0 ? numCpus : 1;
+
    // Make pretty strings...
    char freqString[32];
    if(cpuMhz >= 1000)
@@ -81,6 +83,8 @@ void Processor::init()
       Con::printf("    MMX detected");
    if(Platform::SystemInfo.processor.properties & CPU_PROP_SSE)
       Con::printf("    SSE detected");
+   if(Platform::SystemInfo.processor.properties & CPU_PROP_SSE2)
+      Con::printf("    SSE2 detected");
    if(Platform::SystemInfo.processor.properties & CPU_PROP_ALTIVEC)
       Con::printf("    Altivec detected");
 
@@ -279,6 +283,10 @@ void  _MacCarbGetCpuTypeAndFeatures(U32 *type, char **typeString, U32 *features)
          err = sysctlbyname("hw.optional.sse", &cpufeature, &u32size, NULL, 0);
          if(!err && cpufeature)
             torqueCpuFeatures |= CPU_PROP_SSE;
+
+         err = sysctlbyname("hw.optional.sse2", &cpufeature, &u32size, NULL, 0);
+         if(!err && cpufeature)
+            torqueCpuFeatures |= CPU_PROP_SSE2;
             
          break;
 	   case CPU_PowerPC_G5:
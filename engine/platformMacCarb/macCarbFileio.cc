@@ -641,6 +641,17 @@ S32 Platform::getFileSize(const char* pFilePath)
    return (S32)statData.st_size;
 }
 
+//-----------------------------------------------------------------------------
+// Not supported here yet, the resource manager falls back to a FileStream.
+void* Platform::mapFile(const char *pFilePath, U32 offset, U32 &size, const void *&data)
+{
+   return NULL;
+}
+
+void Platform::unmapFile(void *mapping)
+{
+}
+
 
 //-----------------------------------------------------------------------------
 bool Platform::isSubDirectory(const char *pathParent, const char *pathSub)
@@ -139,6 +139,22 @@ void getGLCapabilities( )
       if(dStrstr(pExtString, (const char*)"GL_EXT_blend_minmax") != NULL)
          gGLState.suppEXTblendminmax = true;
 
+      // ARB_occlusion_query
+      if(dStrstr(pExtString, (const char*)"GL_ARB_occlusion_query") != NULL)
+         gGLState.suppOcclusionQuery = true;
+
+      // EXT_timer_query
+      if(gGLState.suppOcclusionQuery && dStrstr(pExtString, (const char*)"GL_EXT_timer_query") != NULL)
+         gGLState.suppTimerQuery = true;
+
+      // ARB_vertex_buffer_object
+      if(dStrstr(pExtString, (const char*)"GL_ARB_vertex_buffer_object") != NULL)
+         gGLState.suppVertexBufferObject = true;
+
+      // ARB_vertex_program
+      if(dStrstr(pExtString, (const char*)"GL_ARB_vertex_program") != NULL)
+         gGLState.suppVertexProgram = true;
+
       // NV_vertex_array_range ========================================
       // does not appear to be supported by apple, at all. ( as of 10.4.3 )
       // GL_APPLE_vertex_array_range is similar, and may be nearly identical.
@@ -213,6 +229,10 @@ void getGLCapabilities( )
    if (gGLState.suppARBMultitexture)    Con::printf("  ARB_multitexture (Max Texture Units: %d)", gGLState.maxTextureUnits);
    if (gGLState.suppEXTblendcolor)      Con::printf("  EXT_blend_color");
    if (gGLState.suppEXTblendminmax)     Con::printf("  EXT_blend_minmax");
+   if (gGLState.suppOcclusionQuery)     Con::printf("  ARB_occlusion_query");
+   if (gGLState.suppTimerQuery)         Con::printf("  EXT_timer_query");
+   if (gGLState.suppVertexBufferObject) Con::printf("  ARB_vertex_buffer_object");
+   if (gGLState.suppVertexProgram)      Con::printf("  ARB_vertex_program");
    if (gGLState.suppPalettedTexture)    Con::printf("  EXT_paletted_texture");
    if (gGLState.suppLockedArrays)       Con::printf("  EXT_compiled_vertex_array");
    if (gGLState.suppVertexArrayRange)   Con::printf("  NV_vertex_array_range");
@@ -231,6 +251,10 @@ void getGLCapabilities( )
    if (!gGLState.suppARBMultitexture)    Con::warnf("  ARB_multitexture");
    if (!gGLState.suppEXTblendcolor)      Con::warnf("  EXT_blend_color");
    if (!gGLState.suppEXTblendminmax)     Con::warnf("  EXT_blend_minmax");
+   if (!gGLState.suppOcclusionQuery)     Con::warnf("  ARB_occlusion_query");
+   if (!gGLState.suppTimerQuery)         Con::warnf("  EXT_timer_query");
+   if (!gGLState.suppVertexBufferObject) Con::warnf("  ARB_vertex_buffer_object");
+   if (!gGLState.suppVertexProgram)      Con::warnf("  ARB_vertex_program");
    if (!gGLState.suppPalettedTexture)    Con::warnf("  EXT_paletted_texture");
    if (!gGLState.suppLockedArrays)       Con::warnf("  EXT_compiled_vertex_array");
    if (!gGLState.suppVertexArrayRange)   Con::warnf("  NV_vertex_array_range");
@@ -8,6 +8,7 @@
 #include "console/console.h"
 #include "math/mMath.h"
 #include "terrain/blender.h"
+#include "dgl/gBitmap.h"
 
 extern void mInstallLibrary_C();
 extern void mInstallLibrary_Vec();
@@ -84,6 +85,16 @@ void Math::init(U32 properties)
 	   Con::printf("   Installing SSE extensions");
 	   mInstall_Library_SSE();
    }
+
+   #if defined(TORQUE_CPU_X86)
+   Blender::smUseSSE2Blender = false;
+   if (properties & CPU_PROP_SSE2)
+   {
+      Con::printf("   Installing SSE2 extensions");
+      Blender::smUseSSE2Blender = true;
+      bitmapInstallSSE2();
+   }
+   #endif
       
    Con::printf(" ");
 } 
@@ -103,6 +103,7 @@ static Socket* addPolledSocket(NetSocket& fd, S32 state,
 
 enum {
    MaxConnections = 1024,
+   UDPBufferSize = 262144,    ///< A full server's worth of client packets can queue up between ticks.
 };
    
    
@@ -329,7 +330,7 @@ bool Net::openPort(S32 port)
       Net::Error error;
       error = bind(udpSocket, port);
       if(error == NoError)
-         error = setBufferSize(udpSocket, 32768);
+         error = setBufferSize(udpSocket, UDPBufferSize);
       if(error == NoError)
          error = setBroadcast(udpSocket, true);
       if(error == NoError)
@@ -354,7 +355,7 @@ bool Net::openPort(S32 port)
       if(err)
          error = getLastError();
       if(error == NoError)
-         error = setBufferSize(ipxSocket, 32768);
+         error = setBufferSize(ipxSocket, UDPBufferSize);
       if(error == NoError)
          error = setBroadcast(ipxSocket, true);
       if(error == NoError)
@@ -380,9 +381,18 @@ void Net::closePort()
       close(udpSocket);
 }
 
+// No sendmmsg() here, the packets go out as they're sent.
+void Net::beginSendBatch()
+{
+}
+
+void Net::endSendBatch()
+{
+}
+
 Net::Error Net::sendto(const NetAddress *address, const U8 *buffer, S32  bufferSize)
 {
-   if(Game->isJournalReading())
+   if(Game->isJournalReading() || Game->isNetReplaying())
       return NoError;
 
    if(address->type == NetAddress::IPAddress)
@@ -610,6 +620,48 @@ void Net::process()
    }
 }
 
+void Net::waitForTraffic(U32 timeoutMs)
+{
+   fd_set readfds, writefds;
+   FD_ZERO(&readfds);
+   FD_ZERO(&writefds);
+   S32 maxfd = -1;
+
+   if(udpSocket != InvalidSocket)
+   {
+      FD_SET(udpSocket, &readfds);
+      maxfd = getMax(maxfd, udpSocket);
+   }
+   if(ipxSocket != InvalidSocket)
+   {
+      FD_SET(ipxSocket, &readfds);
+      maxfd = getMax(maxfd, ipxSocket);
+   }
+
+   for(S32 i = 0; i < gPolledSockets.size(); i++)
+   {
+      Socket *sock = gPolledSockets[i];
+      if(sock->state == Connected || sock->state == Listening)
+         FD_SET(sock->fd, &readfds);
+      else if(sock->state == ConnectionPending)
+         FD_SET(sock->fd, &writefds);
+      else
+         return;  // the name lookup finishes on another thread
+      maxfd = getMax(maxfd, S32(sock->fd));
+   }
+
+   if(maxfd == -1)
+   {
+      Platform::sleep(timeoutMs);
+      return;
+   }
+
+   timeval timeout;
+   timeout.tv_sec = timeoutMs / 1000;
+   timeout.tv_usec = (timeoutMs % 1000) * 1000;
+   select(maxfd + 1, &readfds, &writefds, NULL, &timeout);
+}
+
 NetSocket Net::openSocket()
 {
    int retSocket;
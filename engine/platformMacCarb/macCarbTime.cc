@@ -58,6 +58,14 @@ U32 Platform::getRealMilliseconds()
    return ret;
 }   
 
+/// Gets the time in microseconds since system start.
+U64 Platform::getRealMicroseconds()
+{
+   UnsignedWide t;
+   Microseconds(&t);
+   return (U64(t.hi) << 32) | t.lo;
+}
+
 U32 Platform::getVirtualMilliseconds()
 {
    return platState.currentTime;   
@@ -75,6 +83,11 @@ void Platform::sleep(U32 ms)
     usleep( ms * 1000 );
 }
 
+void Platform::sleepMicroseconds(U32 us)
+{
+    usleep( us );
+}
+
 #pragma mark ---- TimeManager ----
 //--------------------------------------
 static void _MacCarbUpdateSleepTicks()
@@ -60,6 +60,10 @@ struct GLState
    bool suppARBMultitexture;
    bool suppEXTblendcolor;
    bool suppEXTblendminmax;
+   bool suppOcclusionQuery;
+   bool suppTimerQuery;
+   bool suppVertexBufferObject;
+   bool suppVertexProgram;
    bool suppPackedPixels;
    bool suppTexEnvAdd;
    bool suppLockedArrays;
@@ -146,6 +150,26 @@ inline bool dglDoesSupportEXTBlendMinMax()
    return gGLState.suppEXTblendminmax;
 }
 
+inline bool dglDoesSupportOcclusionQuery()
+{
+   return gGLState.suppOcclusionQuery;
+}
+
+inline bool dglDoesSupportTimerQuery()
+{
+   return gGLState.suppTimerQuery;
+}
+
+inline bool dglDoesSupportVertexBufferObject()
+{
+   return gGLState.suppVertexBufferObject;
+}
+
+inline bool dglDoesSupportVertexProgram()
+{
+   return gGLState.suppVertexProgram;
+}
+
 inline bool dglDoesSupportVertexArrayRange()
 {
    return gGLState.suppVertexArrayRange;
@@ -12,6 +12,37 @@ static void APIENTRY d3dVertex3fv (const GLfloat *v);
 
 static Globals g;
 
+// Render states are never recorded in state blocks, so the last value set
+// is what the device has and setting it again can be skipped.
+static void QuakeSetRenderState(D3DRENDERSTATETYPE state, DWORD value)
+{
+	if ((DWORD) state < D3DRSCACHESIZE)
+	{
+		if (g.m_renderstatevalid[state] && g.m_renderstate[state] == value)
+			return;
+		g.m_renderstate[state] = value;
+		g.m_renderstatevalid[state] = TRUE;
+	}
+	g.m_d3ddev->SetRenderState(state, value);
+}
+
+// Rewrites the count quad indices in g.m_wIndices, in place, as a triangle
+// list, so a run of quads goes to D3D as one list instead of a fan each.
+// Returns the number of indices in the list.
+static DWORD QuakeQuadsToTriangles(GLsizei count)
+{
+	GLsizei quads = count / 4;
+	for (GLsizei q = quads - 1; q >= 0; --q)
+	{
+		WORD *src = &g.m_wIndices[q * 4];
+		WORD a = src[0], b = src[1], c = src[2], d = src[3];
+		WORD *dst = &g.m_wIndices[q * 6];
+		dst[0] = a; dst[1] = b; dst[2] = c;
+		dst[3] = a; dst[4] = c; dst[5] = d;
+	}
+	return quads * 6;
+}
+
 static void QuakeUpdateViewport()
 {
     D3DVIEWPORT7 vport;
@@ -665,8 +696,8 @@ static void APIENTRY d3dAlphaFunc (GLenum func, GLclampf ref)
         break;
     }
     if (funcvalue >= 0) {
-        g.m_d3ddev->SetRenderState(D3DRENDERSTATE_ALPHAFUNC, funcvalue);
-        g.m_d3ddev->SetRenderState(D3DRENDERSTATE_ALPHAREF, (D3DFIXED)(ref * 255.f));
+        QuakeSetRenderState(D3DRENDERSTATE_ALPHAFUNC, funcvalue);
+        QuakeSetRenderState(D3DRENDERSTATE_ALPHAREF, (D3DFIXED)(ref * 255.f));
     }
 }
 
@@ -968,8 +999,8 @@ static void APIENTRY d3dBlendFunc (GLenum sfactor, GLenum dfactor)
         break;
     }
     
-    if (svalue >= 0) g.m_d3ddev->SetRenderState(D3DRENDERSTATE_SRCBLEND, (DWORD)svalue);
-    if (dvalue >= 0) g.m_d3ddev->SetRenderState(D3DRENDERSTATE_DESTBLEND, (DWORD)dvalue);
+    if (svalue >= 0) QuakeSetRenderState(D3DRENDERSTATE_SRCBLEND, (DWORD)svalue);
+    if (dvalue >= 0) QuakeSetRenderState(D3DRENDERSTATE_DESTBLEND, (DWORD)dvalue);
     
 }
 
@@ -1298,7 +1329,7 @@ static void APIENTRY d3dCullFace (GLenum mode)
             statevalue=D3DCULL_CW;
         else
             statevalue=D3DCULL_CCW;
-        g.m_d3ddev->SetRenderState(D3DRENDERSTATE_CULLMODE, statevalue);
+        QuakeSetRenderState(D3DRENDERSTATE_CULLMODE, statevalue);
     }
 }
 
@@ -1371,15 +1402,15 @@ static void APIENTRY d3dDepthFunc (GLenum func)
         break;
     }
     if(state >= 0)
-        g.m_d3ddev->SetRenderState(D3DRENDERSTATE_ZFUNC, state);
+        QuakeSetRenderState(D3DRENDERSTATE_ZFUNC, state);
 }
 
 static void APIENTRY d3dDepthMask (GLboolean flag)
 {
     if(flag == 0)
-        g.m_d3ddev->SetRenderState(D3DRENDERSTATE_ZWRITEENABLE, FALSE);
+        QuakeSetRenderState(D3DRENDERSTATE_ZWRITEENABLE, FALSE);
     else
-        g.m_d3ddev->SetRenderState(D3DRENDERSTATE_ZWRITEENABLE, TRUE);
+        QuakeSetRenderState(D3DRENDERSTATE_ZWRITEENABLE, TRUE);
 }
 
 static void APIENTRY d3dDepthRange (GLclampd zNear, GLclampd zFar)
@@ -1446,11 +1477,8 @@ static void APIENTRY d3dEnd (void)
                 g.m_nfv[2] += g.m_vcnt[2];
                 break;
             case GL_QUADS:
-                for(i = 0; i < g.m_vcnt[2]; i += 4) 
-                {
-                    g.m_d3ddev->DrawPrimitiveVB(D3DPT_TRIANGLEFAN, g.m_mtvbuf, g.m_nfv[2], 4, 0);
-                    g.m_nfv[2] += 4;
-                }
+                g.m_d3ddev->DrawIndexedPrimitiveVB(D3DPT_TRIANGLELIST, g.m_mtvbuf, g.m_nfv[2], g.m_vcnt[2], g.m_quadIndices, g.m_vcnt[2] / 4 * 6, 0);
+                g.m_nfv[2] += g.m_vcnt[2];
                 break;
             default:
 					{
@@ -1499,11 +1527,8 @@ static void APIENTRY d3dEnd (void)
                 g.m_nfv[1] += g.m_vcnt[1];
                 break;
             case GL_QUADS:
-                for(i = 0; i < g.m_vcnt[1]; i += 4) 
-                {
-                    g.m_d3ddev->DrawPrimitiveVB(D3DPT_TRIANGLEFAN, g.m_tvbuf, g.m_nfv[1], 4, 0);
-                    g.m_nfv[1] += 4;
-                }
+                g.m_d3ddev->DrawIndexedPrimitiveVB(D3DPT_TRIANGLELIST, g.m_tvbuf, g.m_nfv[1], g.m_vcnt[1], g.m_quadIndices, g.m_vcnt[1] / 4 * 6, 0);
+                g.m_nfv[1] += g.m_vcnt[1];
                 break;
 				default:
                 {
@@ -1553,11 +1578,8 @@ static void APIENTRY d3dEnd (void)
             g.m_nfv[0] += g.m_vcnt[0];
             break;
         case GL_QUADS:
-            for(i = 0; i < g.m_vcnt[0]; i += 4) 
-            {
-                g.m_d3ddev->DrawPrimitiveVB(D3DPT_TRIANGLEFAN, g.m_vbuf, g.m_nfv[0], 4, 0);
-                g.m_nfv[0] += 4;
-            }
+            g.m_d3ddev->DrawIndexedPrimitiveVB(D3DPT_TRIANGLELIST, g.m_vbuf, g.m_nfv[0], g.m_vcnt[0], g.m_quadIndices, g.m_vcnt[0] / 4 * 6, 0);
+            g.m_nfv[0] += g.m_vcnt[0];
             break;
         default:
             {
@@ -1575,9 +1597,13 @@ static void APIENTRY d3dDrawElements(GLenum mode, GLsizei count, GLenum type, co
 	if (count == 0)
 		return;
 
-	if (count > g.m_numIndices)
+	// Quads get turned into a triangle list in place.
+	GLsizei numIndices = mode == GL_QUADS ? count / 4 * 6 : count;
+	if (numIndices < count)
+		numIndices = count;
+	if (numIndices > g.m_numIndices)
 	{
-		g.m_numIndices = count;
+		g.m_numIndices = numIndices;
 		delete [] g.m_wIndices;
 		g.m_wIndices = new WORD[g.m_numIndices];
 	}
@@ -2003,8 +2029,7 @@ lp1:			lodsd;
 					g.m_nfv[2] += vcount;
 					break;
 				case GL_QUADS:
-					for (i = 0; i < count; i += 4) 
-						g.m_d3ddev->DrawIndexedPrimitiveVB(D3DPT_TRIANGLEFAN, g.m_mtvbuf, g.m_nfv[2], vcount, &g.m_wIndices[i], 4, 0);
+					g.m_d3ddev->DrawIndexedPrimitiveVB(D3DPT_TRIANGLELIST, g.m_mtvbuf, g.m_nfv[2], vcount, g.m_wIndices, QuakeQuadsToTriangles(count), 0);
 					g.m_nfv[2] += vcount;
         			break;
 				default:
@@ -2039,8 +2064,7 @@ lp1:			lodsd;
 					g.m_nfv[1] += vcount;
 					break;
 				case GL_QUADS:
-					for (i = 0; i < count; i += 4) 
-						g.m_d3ddev->DrawIndexedPrimitiveVB(D3DPT_TRIANGLEFAN, g.m_tvbuf, g.m_nfv[1], vcount, &g.m_wIndices[i], 4, 0);
+					g.m_d3ddev->DrawIndexedPrimitiveVB(D3DPT_TRIANGLELIST, g.m_tvbuf, g.m_nfv[1], vcount, g.m_wIndices, QuakeQuadsToTriangles(count), 0);
 					g.m_nfv[1] += vcount;
         			break;
 				default:
@@ -2075,8 +2099,7 @@ lp1:			lodsd;
 					g.m_nfv[0] += vcount;
 					break;
 				case GL_QUADS:
-					for (i = 0; i < count; i += 4) 
-						g.m_d3ddev->DrawIndexedPrimitiveVB(D3DPT_TRIANGLEFAN, g.m_vbuf, g.m_nfv[0], vcount, &g.m_wIndices[i], 4, 0);
+					g.m_d3ddev->DrawIndexedPrimitiveVB(D3DPT_TRIANGLELIST, g.m_vbuf, g.m_nfv[0], vcount, g.m_wIndices, QuakeQuadsToTriangles(count), 0);
 					g.m_nfv[0] += vcount;
         			break;
 				default:
@@ -2135,17 +2158,17 @@ static void APIENTRY d3dDisable (GLenum cap)
 	switch(cap)
 	{
 		case GL_DEPTH_TEST:
-			g.m_d3ddev->SetRenderState(D3DRENDERSTATE_ZENABLE, FALSE);
+			QuakeSetRenderState(D3DRENDERSTATE_ZENABLE, FALSE);
 			break;
 		case GL_CULL_FACE:
 			g.m_cullEnabled = FALSE;
-			g.m_d3ddev->SetRenderState(D3DRENDERSTATE_CULLMODE, D3DCULL_NONE);
+			QuakeSetRenderState(D3DRENDERSTATE_CULLMODE, D3DCULL_NONE);
 			break;
 		case GL_FOG:
-			g.m_d3ddev->SetRenderState(D3DRENDERSTATE_FOGENABLE, FALSE);
+			QuakeSetRenderState(D3DRENDERSTATE_FOGENABLE, FALSE);
 			break;
 		case GL_BLEND:
-			g.m_d3ddev->SetRenderState(D3DRENDERSTATE_ALPHABLENDENABLE, FALSE);
+			QuakeSetRenderState(D3DRENDERSTATE_ALPHABLENDENABLE, FALSE);
 			break;
 		case GL_CLIP_PLANE0:
 		case GL_CLIP_PLANE1:
@@ -2155,7 +2178,7 @@ static void APIENTRY d3dDisable (GLenum cap)
 		case GL_CLIP_PLANE5:
 			break;
 		case GL_POLYGON_OFFSET_FILL:
-			g.m_d3ddev->SetRenderState(D3DRENDERSTATE_ZBIAS, 0);
+			QuakeSetRenderState(D3DRENDERSTATE_ZBIAS, 0);
 			break;
 		case GL_STENCIL_TEST:
 			break;
@@ -2179,10 +2202,10 @@ static void APIENTRY d3dDisable (GLenum cap)
         	g.m_texHandleValid = FALSE;
         	break;
 		case GL_ALPHA_TEST:
-      	g.m_d3ddev->SetRenderState(D3DRENDERSTATE_ALPHATESTENABLE, FALSE);
+      	QuakeSetRenderState(D3DRENDERSTATE_ALPHATESTENABLE, FALSE);
         	break;
 		case GL_LIGHTING:
-			g.m_d3ddev->SetRenderState(D3DRENDERSTATE_LIGHTING, FALSE);
+			QuakeSetRenderState(D3DRENDERSTATE_LIGHTING, FALSE);
 			break;
 		case GL_TEXTURE_GEN_S:
 		case GL_TEXTURE_GEN_T:
@@ -2245,21 +2268,21 @@ static void APIENTRY d3dEnable (GLenum cap)
 {
 	switch (cap) {
 		case GL_DEPTH_TEST:
-			g.m_d3ddev->SetRenderState(D3DRENDERSTATE_ZENABLE, TRUE);
+			QuakeSetRenderState(D3DRENDERSTATE_ZENABLE, TRUE);
 			break;
 		case GL_CULL_FACE:
 			g.m_cullEnabled = TRUE;
 			if ((g.m_cullMode == GL_BACK && g.m_frontFace == GL_CCW) ||
 			 	 (g.m_cullMode == GL_FRONT && g.m_frontFace == GL_CW))
-				g.m_d3ddev->SetRenderState(D3DRENDERSTATE_CULLMODE, D3DCULL_CW);
+				QuakeSetRenderState(D3DRENDERSTATE_CULLMODE, D3DCULL_CW);
 			else
-				g.m_d3ddev->SetRenderState(D3DRENDERSTATE_CULLMODE, D3DCULL_CCW);
+				QuakeSetRenderState(D3DRENDERSTATE_CULLMODE, D3DCULL_CCW);
 			break;
 		case GL_FOG:
-			g.m_d3ddev->SetRenderState(D3DRENDERSTATE_FOGENABLE, TRUE);
+			QuakeSetRenderState(D3DRENDERSTATE_FOGENABLE, TRUE);
 			break;
 		case GL_BLEND:
-			g.m_d3ddev->SetRenderState(D3DRENDERSTATE_ALPHABLENDENABLE, TRUE);
+			QuakeSetRenderState(D3DRENDERSTATE_ALPHABLENDENABLE, TRUE);
 			break;
 		case GL_CLIP_PLANE0:
 		case GL_CLIP_PLANE1:
@@ -2269,7 +2292,7 @@ static void APIENTRY d3dEnable (GLenum cap)
 		case GL_CLIP_PLANE5:
 			break;
 		case GL_POLYGON_OFFSET_FILL:
-			g.m_d3ddev->SetRenderState(D3DRENDERSTATE_ZBIAS, g.m_zbias);
+			QuakeSetRenderState(D3DRENDERSTATE_ZBIAS, g.m_zbias);
 			break;
 		case GL_SCISSOR_TEST:
 			g.m_scissoring = TRUE;
@@ -2283,10 +2306,10 @@ static void APIENTRY d3dEnable (GLenum cap)
 			g.m_texHandleValid = FALSE;
 			break;
 		case GL_ALPHA_TEST:
-			g.m_d3ddev->SetRenderState(D3DRENDERSTATE_ALPHATESTENABLE, TRUE);
+			QuakeSetRenderState(D3DRENDERSTATE_ALPHATESTENABLE, TRUE);
 			break;
 		case GL_LIGHTING:
-			g.m_d3ddev->SetRenderState(D3DRENDERSTATE_LIGHTING, TRUE);
+			QuakeSetRenderState(D3DRENDERSTATE_LIGHTING, TRUE);
 			break;
 		case GL_TEXTURE_GEN_S:
 		case GL_TEXTURE_GEN_T:
@@ -2356,11 +2379,11 @@ static void APIENTRY d3dFogf (GLenum pname, GLfloat param)
 	{
 		case GL_FOG_START:
 			start = param;
-			//g.m_d3ddev->SetRenderState(D3DRENDERSTATE_FOGTABLESTART, *(DWORD*)(&start));
+			//QuakeSetRenderState(D3DRENDERSTATE_FOGTABLESTART, *(DWORD*)(&start));
 			break;
 		case GL_FOG_END:
 			end = param;
-			//g.m_d3ddev->SetRenderState(D3DRENDERSTATE_FOGTABLEEND, *(DWORD*)(&end));
+			//QuakeSetRenderState(D3DRENDERSTATE_FOGTABLEEND, *(DWORD*)(&end));
 			break;
 		default:
 			OutputDebugString("Wrapper: Fog pname not supported\n");
@@ -2429,7 +2452,7 @@ static void APIENTRY d3dFogfv (GLenum pname, const GLfloat *params)
 			A = 255;
 		g.m_fogcolor = RGBA_MAKE(R, G, B, A);
 #endif
-		g.m_d3ddev->SetRenderState(D3DRENDERSTATE_FOGCOLOR, g.m_fogcolor);
+		QuakeSetRenderState(D3DRENDERSTATE_FOGCOLOR, g.m_fogcolor);
 	}
 	else
 		OutputDebugString("Wrapper: Fog pname not supported\n");
@@ -2445,13 +2468,13 @@ static void APIENTRY d3dFogi (GLenum pname, GLint param)
 			switch (param)
 			{
 				case GL_LINEAR:
-					//g.m_d3ddev->SetRenderState(D3DRENDERSTATE_FOGTABLEMODE, D3DFOG_LINEAR);
+					//QuakeSetRenderState(D3DRENDERSTATE_FOGTABLEMODE, D3DFOG_LINEAR);
 					break;
 				case GL_EXP:
-					//g.m_d3ddev->SetRenderState(D3DRENDERSTATE_FOGTABLEMODE, D3DFOG_EXP);
+					//QuakeSetRenderState(D3DRENDERSTATE_FOGTABLEMODE, D3DFOG_EXP);
 					break;
 				case GL_EXP2:
-					//g.m_d3ddev->SetRenderState(D3DRENDERSTATE_FOGTABLEMODE, D3DFOG_EXP2);
+					//QuakeSetRenderState(D3DRENDERSTATE_FOGTABLEMODE, D3DFOG_EXP2);
 					break;
 			}
 			break;
@@ -2689,7 +2712,7 @@ static void APIENTRY d3dPolygonMode (GLenum face, GLenum mode)
 			break;
 	}
 	if(statevalue >= 0) {
-		g.m_d3ddev->SetRenderState(D3DRENDERSTATE_FILLMODE, (DWORD)statevalue);
+		QuakeSetRenderState(D3DRENDERSTATE_FILLMODE, (DWORD)statevalue);
 	}
 }
 
@@ -2830,9 +2853,9 @@ static void APIENTRY d3dSelectTextureSGIS(GLenum target)
 static void APIENTRY d3dShadeModel (GLenum mode)
 {
     if(mode == GL_SMOOTH)
-        g.m_d3ddev->SetRenderState(D3DRENDERSTATE_SHADEMODE, D3DSHADE_GOURAUD);
+        QuakeSetRenderState(D3DRENDERSTATE_SHADEMODE, D3DSHADE_GOURAUD);
     else
-        g.m_d3ddev->SetRenderState(D3DRENDERSTATE_SHADEMODE, D3DSHADE_FLAT);
+        QuakeSetRenderState(D3DRENDERSTATE_SHADEMODE, D3DSHADE_FLAT);
 }
 
 static void APIENTRY d3dTexCoord2f (GLfloat s, GLfloat t)
@@ -3475,7 +3498,7 @@ static void APIENTRY d3dFrontFace (GLenum mode)
 			statevalue=D3DCULL_CW;
 		else
 			statevalue=D3DCULL_CCW;
-		g.m_d3ddev->SetRenderState(D3DRENDERSTATE_CULLMODE, statevalue);
+		QuakeSetRenderState(D3DRENDERSTATE_CULLMODE, statevalue);
 	}
 }
 
@@ -3856,11 +3879,8 @@ lp1:			lodsd;
 					g.m_nfv[2] += count;
 					break;
 				case GL_QUADS:
-					for (i = 0; i < count; i += 4) 
-					{
-						g.m_d3ddev->DrawPrimitiveVB(D3DPT_TRIANGLEFAN, g.m_mtvbuf, g.m_nfv[2], 4, 0);
-						g.m_nfv[2] += 4;
-					}
+					g.m_d3ddev->DrawIndexedPrimitiveVB(D3DPT_TRIANGLELIST, g.m_mtvbuf, g.m_nfv[2], count, g.m_quadIndices, count / 4 * 6, 0);
+					g.m_nfv[2] += count;
         			break;
 				default:
 				{
@@ -3894,11 +3914,8 @@ lp1:			lodsd;
 					g.m_nfv[1] += count;
 					break;
 				case GL_QUADS:
-					for (i = 0; i < count; i += 4) 
-					{
-						g.m_d3ddev->DrawPrimitiveVB(D3DPT_TRIANGLEFAN, g.m_tvbuf, g.m_nfv[1], 4, 0);
-						g.m_nfv[1] += 4;
-					}
+					g.m_d3ddev->DrawIndexedPrimitiveVB(D3DPT_TRIANGLELIST, g.m_tvbuf, g.m_nfv[1], count, g.m_quadIndices, count / 4 * 6, 0);
+					g.m_nfv[1] += count;
         			break;
 				default:
 				{
@@ -3932,11 +3949,8 @@ lp1:			lodsd;
 					g.m_nfv[0] += count;
 					break;
 				case GL_QUADS:
-					for (i = 0; i < count; i += 4) 
-					{
-						g.m_d3ddev->DrawPrimitiveVB(D3DPT_TRIANGLEFAN, g.m_vbuf, g.m_nfv[0], 4, 0);
-						g.m_nfv[0] += 4;
-					}
+					g.m_d3ddev->DrawIndexedPrimitiveVB(D3DPT_TRIANGLELIST, g.m_vbuf, g.m_nfv[0], count, g.m_quadIndices, count / 4 * 6, 0);
+					g.m_nfv[0] += count;
         			break;
 				default:
 				{
@@ -4023,11 +4037,11 @@ lp1:			lodsd;
 		g.m_d3ddev->GetRenderState(D3DRENDERSTATE_DESTBLEND, &dst);
 
 		if (!blend)
-			g.m_d3ddev->SetRenderState(D3DRENDERSTATE_ALPHABLENDENABLE, TRUE);
+			QuakeSetRenderState(D3DRENDERSTATE_ALPHABLENDENABLE, TRUE);
 		if (src != D3DBLEND_SRCALPHA)
-			g.m_d3ddev->SetRenderState(D3DRENDERSTATE_SRCBLEND, D3DBLEND_SRCALPHA);
+			QuakeSetRenderState(D3DRENDERSTATE_SRCBLEND, D3DBLEND_SRCALPHA);
 		if (dst != D3DBLEND_INVSRCALPHA)
-			g.m_d3ddev->SetRenderState(D3DRENDERSTATE_DESTBLEND, D3DBLEND_INVSRCALPHA); 
+			QuakeSetRenderState(D3DRENDERSTATE_DESTBLEND, D3DBLEND_INVSRCALPHA); 
    
 		g.m_d3ddev->SetTextureStageState (0, D3DTSS_COLOROP, D3DTOP_DISABLE);
 		g.m_d3ddev->SetTextureStageState (0, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
@@ -4049,11 +4063,11 @@ lp1:			lodsd;
 		}
 
 		if (!blend)
-			g.m_d3ddev->SetRenderState(D3DRENDERSTATE_ALPHABLENDENABLE, FALSE);
+			QuakeSetRenderState(D3DRENDERSTATE_ALPHABLENDENABLE, FALSE);
 		if (src != D3DBLEND_SRCALPHA)
-			g.m_d3ddev->SetRenderState(D3DRENDERSTATE_SRCBLEND, src);
+			QuakeSetRenderState(D3DRENDERSTATE_SRCBLEND, src);
 		if (dst != D3DBLEND_INVSRCALPHA)
-			g.m_d3ddev->SetRenderState(D3DRENDERSTATE_DESTBLEND, dst);
+			QuakeSetRenderState(D3DRENDERSTATE_DESTBLEND, dst);
 	}
 #endif
 }
@@ -4377,7 +4391,7 @@ static void APIENTRY d3dLightModelfv (GLenum pname, const GLfloat *params)
 			A = 255;
 		ambient = RGBA_MAKE(R, G, B, A);
 #endif
-		g.m_d3ddev->SetRenderState(D3DRENDERSTATE_AMBIENT, ambient);
+		QuakeSetRenderState(D3DRENDERSTATE_AMBIENT, ambient);
 	}
 	else
 	{
@@ -4849,6 +4863,20 @@ static HGLRC WINAPI wd3dCreateContext(HDC hdc)
 	g.m_lckcount = 0;
 	g.m_numIndices = 1024;
 	g.m_wIndices = new WORD[g.m_numIndices];
+	memset(g.m_renderstatevalid, 0, sizeof(g.m_renderstatevalid));
+
+	// Two triangles for each quad that fits in a vertex buffer
+	g.m_quadIndices = new WORD[VBUFSIZE / 4 * 6];
+	for (i = 0; i < VBUFSIZE / 4; ++i)
+	{
+		WORD *quad = &g.m_quadIndices[i * 6];
+		quad[0] = (WORD) (i * 4);
+		quad[1] = (WORD) (i * 4 + 1);
+		quad[2] = (WORD) (i * 4 + 2);
+		quad[3] = (WORD) (i * 4);
+		quad[4] = (WORD) (i * 4 + 2);
+		quad[5] = (WORD) (i * 4 + 3);
+	}
 	g.m_frontFace = GL_CCW;
 	g.m_usenormalary = FALSE;
 	g.m_normalstride = 0;
@@ -4991,14 +5019,14 @@ static HGLRC WINAPI wd3dCreateContext(HDC hdc)
     g.m_d3ddev->SetTransform(D3DTRANSFORMSTATE_PROJECTION, &unity); 
     g.m_curtex[0] = NULL;
     g.m_curtex[1] = NULL;
-    g.m_d3ddev->SetRenderState(D3DRENDERSTATE_TEXTUREPERSPECTIVE, TRUE);
-    g.m_d3ddev->SetRenderState(D3DRENDERSTATE_SPECULARENABLE, FALSE);
-    g.m_d3ddev->SetRenderState(D3DRENDERSTATE_DITHERENABLE, TRUE);
-    g.m_d3ddev->SetRenderState(D3DRENDERSTATE_CLIPPING, TRUE);
-    g.m_d3ddev->SetRenderState(D3DRENDERSTATE_LIGHTING, FALSE);
-	 g.m_d3ddev->SetRenderState(D3DRENDERSTATE_AMBIENT, 0x32323219);
-	 g.m_d3ddev->SetRenderState(D3DRENDERSTATE_AMBIENTMATERIALSOURCE, D3DMCS_COLOR1);
-    g.m_d3ddev->SetRenderState(D3DRENDERSTATE_EXTENTS, FALSE);
+    QuakeSetRenderState(D3DRENDERSTATE_TEXTUREPERSPECTIVE, TRUE);
+    QuakeSetRenderState(D3DRENDERSTATE_SPECULARENABLE, FALSE);
+    QuakeSetRenderState(D3DRENDERSTATE_DITHERENABLE, TRUE);
+    QuakeSetRenderState(D3DRENDERSTATE_CLIPPING, TRUE);
+    QuakeSetRenderState(D3DRENDERSTATE_LIGHTING, FALSE);
+	 QuakeSetRenderState(D3DRENDERSTATE_AMBIENT, 0x32323219);
+	 QuakeSetRenderState(D3DRENDERSTATE_AMBIENTMATERIALSOURCE, D3DMCS_COLOR1);
+    QuakeSetRenderState(D3DRENDERSTATE_EXTENTS, FALSE);
     g.m_d3ddev->SetTextureStageState (0, D3DTSS_TEXCOORDINDEX,0);
     if(g.m_usemtex == TRUE)
         g.m_d3ddev->SetTextureStageState (1, D3DTSS_TEXCOORDINDEX,1);
@@ -5235,6 +5263,8 @@ static BOOL WINAPI wd3dDeleteContext(HGLRC hglrc)
     D3DXUninitialize();
     delete[] g.m_wIndices;
     g.m_wIndices = 0;
+    delete[] g.m_quadIndices;
+    g.m_quadIndices = 0;
 
     return TRUE;
 }
@@ -9911,6 +9941,18 @@ bool D3DGL_EXT_Init()
    // EXT_texture_compression_S3TC
    gGLState.suppS3TC = false;
 
+   // ARB_occlusion_query
+   gGLState.suppOcclusionQuery = false;
+
+   // EXT_timer_query
+   gGLState.suppTimerQuery = false;
+
+   // ARB_vertex_buffer_object
+   gGLState.suppVertexBufferObject = false;
+
+   // ARB_vertex_program
+   gGLState.suppVertexProgram = false;
+
    // WGL_3DFS_gamma_control
    qwglGetDeviceGammaRamp3DFX = NULL;
    qwglSetDeviceGammaRamp3DFX = NULL;
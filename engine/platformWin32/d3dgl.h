@@ -64,8 +64,9 @@ struct TransformedQuakeVertex {
 #define QUAKEFMTVFMT (D3DFVF_XYZ | D3DFVF_NORMAL | D3DFVF_DIFFUSE | D3DFVF_TEX2 | D3DFVF_SPECULAR)
 #define QUAKETRVFMT (D3DFVF_XYZRHW | D3DFVF_DIFFUSE | D3DFVF_TEX2)
 
-#define VBUFSIZE 2048
+#define VBUFSIZE 8192
 #define MAXVERTSPERPRIM 128
+#define D3DRSCACHESIZE 256
 
 #define RESPATH_QUAKE "Software\\Microsoft\\Quake"
 
@@ -148,6 +149,9 @@ struct Globals {
 	const void *m_colorary;
 	GLsizei m_numIndices;
 	WORD *m_wIndices;
+	WORD *m_quadIndices;
+	DWORD m_renderstate[D3DRSCACHESIZE];
+	BOOL m_renderstatevalid[D3DRSCACHESIZE];
 	const GLfloat *m_texcoordary[2];
 	LPDIRECTDRAWSURFACE7 m_curtex[2];
 	GLList<D3DMATRIX> m_matrixStack[3];
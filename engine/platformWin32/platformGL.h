@@ -23,6 +23,9 @@ extern "C" {
 #include "platform/GLUFunc.h"
 #undef GL_FUNCTION
 
+/// The GL entry points are pointers that can be hooked.
+#define TORQUE_GL_FUNCTION_POINTERS
+
 /* EXT_vertex_buffer */
 #define GL_V12MTVFMT_EXT                     0x8702
 #define GL_V12MTNVFMT_EXT                    0x8703
@@ -34,6 +37,10 @@ struct GLState
    bool suppARBMultitexture;
    bool suppEXTblendcolor;
    bool suppEXTblendminmax;
+   bool suppOcclusionQuery;
+   bool suppTimerQuery;
+   bool suppVertexBufferObject;
+   bool suppVertexProgram;
    bool suppPackedPixels;
    bool suppTexEnvAdd;
    bool suppLockedArrays;
@@ -114,6 +121,26 @@ inline bool dglDoesSupportEXTBlendMinMax()
    return gGLState.suppEXTblendminmax;
 }
 
+inline bool dglDoesSupportOcclusionQuery()
+{
+   return gGLState.suppOcclusionQuery;
+}
+
+inline bool dglDoesSupportTimerQuery()
+{
+   return gGLState.suppTimerQuery;
+}
+
+inline bool dglDoesSupportVertexBufferObject()
+{
+   return gGLState.suppVertexBufferObject;
+}
+
+inline bool dglDoesSupportVertexProgram()
+{
+   return gGLState.suppVertexProgram;
+}
+
 inline bool dglDoesSupportVertexArrayRange()
 {
    return gGLState.suppVertexArrayRange;
@@ -332,5 +332,8 @@ void PlatformBlitInit()
       bitmapConvertRGB_to_5551 = bitmapConvertRGB_to_5551_mmx;
 #endif
    }
+
+   if (Platform::SystemInfo.processor.properties & CPU_PROP_SSE2)
+      bitmapInstallSSE2();
 //   terrMipBlit = terrMipBlit_asm;
 }
@@ -39,6 +39,10 @@ void Processor::init()
    Platform::SystemInfo.processor.mhz  = 0;
    Platform::SystemInfo.processor.properties = CPU_PROP_C;
 
+   SYSTEM_INFO sysInfo;
+   GetSystemInfo(&sysInfo);
+   Platform::SystemInfo.processor.numCores = sysInfo.dwNumberOfProcessors ? U32(sysInfo.dwNumberOfProcessors) : 1;
+
    char     vendor[13] = {0,};
    U32   properties = 0;
    U32   processor  = 0;
@@ -235,6 +239,8 @@ void Processor::init()
       Con::printf("   3DNow detected");
    if (Platform::SystemInfo.processor.properties & CPU_PROP_SSE)
       Con::printf("   SSE detected");
+   if (Platform::SystemInfo.processor.properties & CPU_PROP_SSE2)
+      Con::printf("   SSE2 detected");
    Con::printf(" ");
 
    PlatformBlitInit();
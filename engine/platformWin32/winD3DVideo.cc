@@ -7,6 +7,7 @@
 #include "platformWin32/platformWin32.h"
 #include "platform/platformAudio.h"
 #include "platformWin32/winD3DVideo.h"
+#include "dgl/dgl.h"
 #include "console/console.h"
 #include "math/mPoint.h"
 #include "platform/event.h"
@@ -170,6 +171,7 @@ bool D3DDevice::activate( U32 width, U32 height, U32 bpp, bool fullScreen )
    }
 
    GL_EXT_Init();
+   dglInstallStateCache();
 
    Con::setVariable( "$pref::Video::displayDevice", mDeviceName );
    Con::setBoolVariable( "$SwapIntervalSupported", false );
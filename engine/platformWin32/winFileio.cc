@@ -802,6 +802,77 @@ S32 Platform::getFileSize(const char *pFilePath)
    return findData.nFileSizeLow;;
 }
 
+//--------------------------------------
+struct Win32FileMapping
+{
+   HANDLE mMapping;
+   void*  mView;
+};
+
+void* Platform::mapFile(const char *pFilePath, U32 offset, U32 &size, const void *&data)
+{
+   if (!pFilePath || !*pFilePath)
+      return NULL;
+
+   char filebuf[2048];
+   dStrcpy(filebuf, pFilePath);
+   backslash(filebuf);
+#ifdef UNICODE
+   UTF16 fname[2048];
+   convertUTF8toUTF16((UTF8 *)filebuf, fname, sizeof(fname));
+#else
+   char *fname = filebuf;
+#endif
+
+   HANDLE file = CreateFile(fname, GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+   if (file == INVALID_HANDLE_VALUE)
+      return NULL;
+
+   DWORD fileSize = GetFileSize(file, NULL);
+   if (size == 0 && offset < fileSize)
+      size = fileSize - offset;
+   if (size == 0 || fileSize == INVALID_FILE_SIZE || offset + size > fileSize)
+   {
+      CloseHandle(file);
+      return NULL;
+   }
+
+   // The mapping object keeps the file open, so the handle can go now.
+   HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+   CloseHandle(file);
+   if (!mapping)
+      return NULL;
+
+   // Views have to start on an allocation granularity boundary.
+   SYSTEM_INFO info;
+   GetSystemInfo(&info);
+   U32 viewOffset = offset - (offset % info.dwAllocationGranularity);
+   void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, viewOffset, size + (offset - viewOffset));
+   if (!view)
+   {
+      CloseHandle(mapping);
+      return NULL;
+   }
+
+   Win32FileMapping *ret = new Win32FileMapping;
+   ret->mMapping = mapping;
+   ret->mView = view;
+   data = (const U8 *)view + (offset - viewOffset);
+   return ret;
+}
+
+void Platform::unmapFile(void *mapping)
+{
+   if (!mapping)
+      return;
+
+   Win32FileMapping *map = (Win32FileMapping *)mapping;
+   UnmapViewOfFile(map->mView);
+   CloseHandle(map->mMapping);
+   delete map;
+}
+
 
 //--------------------------------------
 bool Platform::isDirectory(const char *pDirPath)
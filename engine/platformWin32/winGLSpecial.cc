@@ -10,6 +10,7 @@
 
 #include "platformWin32/platformWin32.h"
 #include "platform/platformGL.h"
+#include "dgl/dgl.h"
 #include "console/consoleTypes.h"
 #include "console/console.h"
 #include <time.h>
@@ -2480,6 +2481,118 @@ static void APIENTRY logglBlendEquationEXT(GLenum mode)
    dllglBlendEquationEXT(mode);
 }
 
+static void APIENTRY logglGenQueriesARB(GLsizei n, GLuint *ids)
+{
+   fprintf( winState.log_fp, "glGenQueriesARB( %d, ... )\n", n );
+   fflush(winState.log_fp);
+   dllglGenQueriesARB(n, ids);
+}
+
+static void APIENTRY logglDeleteQueriesARB(GLsizei n, const GLuint *ids)
+{
+   fprintf( winState.log_fp, "glDeleteQueriesARB( %d, ... )\n", n );
+   fflush(winState.log_fp);
+   dllglDeleteQueriesARB(n, ids);
+}
+
+static void APIENTRY logglBeginQueryARB(GLenum target, GLuint id)
+{
+   fprintf( winState.log_fp, "glBeginQueryARB( 0x%x, %d )\n", target, id );
+   fflush(winState.log_fp);
+   dllglBeginQueryARB(target, id);
+}
+
+static void APIENTRY logglEndQueryARB(GLenum target)
+{
+   fprintf( winState.log_fp, "glEndQueryARB( 0x%x )\n", target );
+   fflush(winState.log_fp);
+   dllglEndQueryARB(target);
+}
+
+static void APIENTRY logglGetQueryObjectivARB(GLuint id, GLenum pname, GLint *params)
+{
+   fprintf( winState.log_fp, "glGetQueryObjectivARB( %d, 0x%x, ... )\n", id, pname );
+   fflush(winState.log_fp);
+   dllglGetQueryObjectivARB(id, pname, params);
+}
+
+static void APIENTRY logglGetQueryObjectuivARB(GLuint id, GLenum pname, GLuint *params)
+{
+   fprintf( winState.log_fp, "glGetQueryObjectuivARB( %d, 0x%x, ... )\n", id, pname );
+   fflush(winState.log_fp);
+   dllglGetQueryObjectuivARB(id, pname, params);
+}
+
+static void APIENTRY logglBindBufferARB(GLenum target, GLuint buffer)
+{
+   fprintf( winState.log_fp, "glBindBufferARB( 0x%x, %d )\n", target, buffer );
+   fflush(winState.log_fp);
+   dllglBindBufferARB(target, buffer);
+}
+
+static void APIENTRY logglDeleteBuffersARB(GLsizei n, const GLuint *buffers)
+{
+   fprintf( winState.log_fp, "glDeleteBuffersARB( %d, ... )\n", n );
+   fflush(winState.log_fp);
+   dllglDeleteBuffersARB(n, buffers);
+}
+
+static void APIENTRY logglGenBuffersARB(GLsizei n, GLuint *buffers)
+{
+   fprintf( winState.log_fp, "glGenBuffersARB( %d, ... )\n", n );
+   fflush(winState.log_fp);
+   dllglGenBuffersARB(n, buffers);
+}
+
+static void APIENTRY logglBufferDataARB(GLenum target, GLsizeiptrARB size, const GLvoid *data, GLenum usage)
+{
+   fprintf( winState.log_fp, "glBufferDataARB( 0x%x, %d, ..., 0x%x )\n", target, S32(size), usage );
+   fflush(winState.log_fp);
+   dllglBufferDataARB(target, size, data, usage);
+}
+
+static void APIENTRY logglBufferSubDataARB(GLenum target, GLintptrARB offset, GLsizeiptrARB size, const GLvoid *data)
+{
+   fprintf( winState.log_fp, "glBufferSubDataARB( 0x%x, %d, %d, ... )\n", target, S32(offset), S32(size) );
+   fflush(winState.log_fp);
+   dllglBufferSubDataARB(target, offset, size, data);
+}
+
+static void APIENTRY logglGenProgramsARB(GLsizei n, GLuint *programs)
+{
+   fprintf( winState.log_fp, "glGenProgramsARB( %d, ... )\n", n );
+   fflush(winState.log_fp);
+   dllglGenProgramsARB(n, programs);
+}
+
+static void APIENTRY logglDeleteProgramsARB(GLsizei n, const GLuint *programs)
+{
+   fprintf( winState.log_fp, "glDeleteProgramsARB( %d, ... )\n", n );
+   fflush(winState.log_fp);
+   dllglDeleteProgramsARB(n, programs);
+}
+
+static void APIENTRY logglBindProgramARB(GLenum target, GLuint program)
+{
+   fprintf( winState.log_fp, "glBindProgramARB( 0x%x, %d )\n", target, program );
+   fflush(winState.log_fp);
+   dllglBindProgramARB(target, program);
+}
+
+static void APIENTRY logglProgramStringARB(GLenum target, GLenum format, GLsizei len, const GLvoid *string)
+{
+   fprintf( winState.log_fp, "glProgramStringARB( 0x%x, 0x%x, %d, ... )\n", target, format, len );
+   fflush(winState.log_fp);
+   dllglProgramStringARB(target, format, len, string);
+}
+
+static void APIENTRY logglProgramLocalParameter4fARB(GLenum target, GLuint index, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+{
+   fprintf( winState.log_fp, "glProgramLocalParameter4fARB( 0x%x, %d, %g, %g, %g, %g )\n", target, index, x, y, z, w );
+   fflush(winState.log_fp);
+   dllglProgramLocalParameter4fARB(target, index, x, y, z, w);
+}
+
 //-------------------------------------------------------
 static U32 getIndex(GLenum type, const void *indices, U32 i)
 {
@@ -2751,6 +2864,9 @@ ConsoleFunction(GLEnableLogging, void, 2, 2, "GLEnableLogging(bool);")
 #include "platform/GLExtFunc.h"
 #include "platform/GLUFunc.h"
 #undef GL_FUNCTION
+
+      // Logging went straight to GL, so the state cache has to start over.
+      dglInstallStateCache();
    }
 }
 
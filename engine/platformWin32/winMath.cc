@@ -6,6 +6,7 @@
 #include "platform/platform.h"
 #include "console/console.h"
 #include "math/mMath.h"
+#include "terrain/blender.h"
 
 
 extern void mInstallLibrary_C();
@@ -25,7 +26,8 @@ ConsoleFunction( mathInit, void, 1, 10, "( ... )"
                 "    - 'FPU' Enable floating point unit routines.\n"
                 "    - 'MMX' Enable MMX math routines.\n"
                 "    - '3DNOW' Enable 3dNow! math routines.\n"
-                "    - 'SSE' Enable SSE math routines.\n")
+                "    - 'SSE' Enable SSE math routines.\n"
+                "    - 'SSE2' Enable SSE2 routines.\n")
 
 
 {
@@ -62,6 +64,10 @@ ConsoleFunction( mathInit, void, 1, 10, "( ... )"
          properties |= CPU_PROP_SSE;
          continue;
       }
+      if (dStricmp(*argv, "SSE2") == 0) {
+         properties |= CPU_PROP_SSE2;
+         continue;
+      }
       Con::printf("Error: MathInit(): ignoring unknown math extension '%s'", *argv);
    }
    Math::init(properties);
@@ -107,6 +113,13 @@ void Math::init(U32 properties)
       mInstall_Library_SSE();
    }
 
+   Blender::smUseSSE2Blender = false;
+   if (properties & CPU_PROP_SSE2)
+   {
+      Con::printf("   Installing SSE2 extensions");
+      Blender::smUseSSE2Blender = true;
+   }
+
    Con::printf(" ");
 }
 
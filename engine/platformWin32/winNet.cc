@@ -42,6 +42,7 @@ static SOCKET udpSocket = INVALID_SOCKET;
 
 enum WinNetConstants {
    MaxConnections = 1024,  ///< Maximum allowed number of connections.
+   UDPBufferSize = 262144, ///< A full server's worth of client packets can queue up between ticks.
 };
 
 HWND winsockWindow = NULL;
@@ -419,7 +420,7 @@ bool Net::openPort(S32 port)
       Net::Error error;
       error = bind(udpSocket, port);
       if(error == NoError)
-         error = setBufferSize(udpSocket, 32768);
+         error = setBufferSize(udpSocket, UDPBufferSize);
       if(error == NoError)
          error = setBroadcast(udpSocket, true);
       if(error == NoError)
@@ -446,7 +447,7 @@ bool Net::openPort(S32 port)
       if(err)
          error = getLastError();
       if(error == NoError)
-         error = setBufferSize(ipxSocket, 32768);
+         error = setBufferSize(ipxSocket, UDPBufferSize);
       if(error == NoError)
          error = setBroadcast(ipxSocket, true);
       if(error == NoError)
@@ -473,9 +474,19 @@ void Net::closePort()
       closesocket(udpSocket);
 }
 
+// No batched datagram calls in winsock; process() already reads until the
+// socket is empty.
+void Net::beginSendBatch()
+{
+}
+
+void Net::endSendBatch()
+{
+}
+
 Net::Error Net::sendto(const NetAddress *address, const U8 *buffer, S32 bufferSize)
 {
-   if(Game->isJournalReading())
+   if(Game->isJournalReading() || Game->isNetReplaying())
       return NoError;
 
    if(address->type == NetAddress::IPXAddress)
@@ -542,6 +553,33 @@ void Net::process()
    }
 }
 
+void Net::waitForTraffic(U32 timeoutMs)
+{
+   // The TCP sockets and name lookups report through WinsockProc, so
+   // anything in the message queue means there's work already.
+   if(lookupList || HIWORD(GetQueueStatus(QS_ALLINPUT)))
+      return;
+
+   fd_set readfds;
+   FD_ZERO(&readfds);
+   if(udpSocket != INVALID_SOCKET)
+      FD_SET(udpSocket, &readfds);
+   if(ipxSocket != INVALID_SOCKET)
+      FD_SET(ipxSocket, &readfds);
+
+   // select() with nothing to wait on is an error under winsock.
+   if(!readfds.fd_count)
+   {
+      Sleep(timeoutMs);
+      return;
+   }
+
+   timeval timeout;
+   timeout.tv_sec = timeoutMs / 1000;
+   timeout.tv_usec = (timeoutMs % 1000) * 1000;
+   select(0, &readfds, NULL, NULL, &timeout);
+}
+
 NetSocket Net::openSocket()
 {
    SOCKET retSocket;
@@ -8,6 +8,7 @@
 #include "platform/platformAudio.h"
 #include "platformWin32/winOGLVideo.h"
 #include "platformWin32/winD3DVideo.h"
+#include "dgl/dgl.h"
 #include "console/console.h"
 #include "math/mPoint.h"
 #include "platform/event.h"
@@ -542,6 +543,7 @@ bool OpenGLDevice::activate( U32 width, U32 height, U32 bpp, bool fullScreen )
    }
 
    GL_EXT_Init();
+   dglInstallStateCache();
 
    Con::setVariable( "$pref::Video::displayDevice", mDeviceName );
 
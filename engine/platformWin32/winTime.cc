@@ -11,6 +11,19 @@ void Platform::sleep(U32 ms)
    Sleep(ms);
 }
 
+void Platform::sleepMicroseconds(U32 us)
+{
+   // Sleep() rounds up to the scheduler tick, 10-15ms by default; ask for
+   // 1ms the first time anyone needs to sleep this precisely
+   static bool periodSet = false;
+   if(!periodSet)
+   {
+      timeBeginPeriod(1);
+      periodSet = true;
+   }
+   Sleep(us / 1000);
+}
+
 //--------------------------------------
 void Platform::getLocalTime(LocalTime &lt)
 {
@@ -81,6 +94,21 @@ U32 Platform::getRealMilliseconds()
    return GetTickCount();
 }
 
+U64 Platform::getRealMicroseconds()
+{
+   static LARGE_INTEGER frequency = { 0 };
+   if(!frequency.QuadPart && !QueryPerformanceFrequency(&frequency))
+      frequency.QuadPart = -1;
+
+   // no performance counter, make do with the tick count
+   LARGE_INTEGER count;
+   if(frequency.QuadPart < 0 || !QueryPerformanceCounter(&count))
+      return U64(GetTickCount()) * 1000;
+
+   return U64(count.QuadPart / frequency.QuadPart) * 1000000 +
+          U64(count.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart;
+}
+
 U32 Platform::getVirtualMilliseconds()
 {
    return winState.currentTime;
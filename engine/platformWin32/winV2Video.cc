@@ -8,6 +8,7 @@
 #include "platform/platformAudio.h"
 #include "platformWin32/winV2Video.h"
 #include "platform/3Dfx.h"
+#include "dgl/dgl.h"
 #include "console/console.h"
 #include "math/mPoint.h"
 #include "platform/event.h"
@@ -212,6 +213,7 @@ bool Voodoo2Device::activate( U32 width, U32 height, U32 /*bpp*/, bool /*fullScr
    SetFocus( winState.appWindow );
 
    GL_EXT_Init();
+   dglInstallStateCache();
 
    Con::setBoolVariable( "$SwapIntervalSupported", false );
    Con::setVariable( "$pref::Video::displayDevice", mDeviceName );
@@ -1347,7 +1347,10 @@ class WinTimer
    public:
       WinTimer()
       {
-         SetProcessAffinityMask( GetCurrentProcess(), 1 );
+         // Keep the thread that reads the counter on one core, where
+         // QPC is always consistent.  Only this thread: pinning the whole
+         // process would put the worker threads on that core too.
+         SetThreadAffinityMask( GetCurrentThread(), 1 );
          
          mPerfCountRemainderCurrent = 0.0f;
          mUsingPerfCounter = QueryPerformanceFrequency((LARGE_INTEGER *) &mFrequency);
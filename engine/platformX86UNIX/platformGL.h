@@ -22,6 +22,9 @@ extern "C" {
 #include "platform/GLExtFunc.h"
 #undef GL_FUNCTION
 
+/// The GL entry points are pointers that can be hooked.
+#define TORQUE_GL_FUNCTION_POINTERS
+
 // GLU functions are linked at compile time, except in the dedicated server build
 #ifndef DEDICATED
 #define GL_FUNCTION(fn_return,fn_name,fn_args,fn_value) fn_return fn_name fn_args; 
@@ -48,6 +51,10 @@ struct GLState
    bool suppARBMultitexture;
    bool suppEXTblendcolor;
    bool suppEXTblendminmax;
+   bool suppOcclusionQuery;
+   bool suppTimerQuery;
+   bool suppVertexBufferObject;
+   bool suppVertexProgram;
    bool suppPackedPixels;
    bool suppTexEnvAdd;
    bool suppLockedArrays;
@@ -125,6 +132,26 @@ inline bool dglDoesSupportEXTBlendMinMax()
    return gGLState.suppEXTblendminmax;
 }
 
+inline bool dglDoesSupportOcclusionQuery()
+{
+   return gGLState.suppOcclusionQuery;
+}
+
+inline bool dglDoesSupportTimerQuery()
+{
+   return gGLState.suppTimerQuery;
+}
+
+inline bool dglDoesSupportVertexBufferObject()
+{
+   return gGLState.suppVertexBufferObject;
+}
+
+inline bool dglDoesSupportVertexProgram()
+{
+   return gGLState.suppVertexProgram;
+}
+
 inline bool dglDoesSupportVertexArrayRange()
 {
    return gGLState.suppVertexArrayRange;
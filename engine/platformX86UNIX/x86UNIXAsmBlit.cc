@@ -47,4 +47,7 @@ void PlatformBlitInit()
       // JMQ: haven't bothered porting mmx bitmap funcs because they don't
       // seem to offer a big performance boost right now.
    }
+
+   if (Platform::SystemInfo.processor.properties & CPU_PROP_SSE2)
+      bitmapInstallSSE2();
 }
@@ -10,6 +10,7 @@
 #include "console/console.h"
 #include "core/stringTable.h"
 #include <math.h>
+#include <unistd.h>
 
 Platform::SystemInfo_struct Platform::SystemInfo;
 
@@ -44,6 +45,9 @@ void Processor::init()
    Platform::SystemInfo.processor.mhz  = 0;
    Platform::SystemInfo.processor.properties = CPU_PROP_C;
 
+   long numCores = sysconf(_SC_NPROCESSORS_ONLN);
+   Platform::SystemInfo.processor.numCores = numCores > 0 ? U32(numCores) : 1;
+
    clockticks = properties = processor = time[0] = 0;
    dStrcpy(vendor, "");
 
@@ -134,6 +138,8 @@ void Processor::init()
       Con::printf("   3DNow detected");
    if (Platform::SystemInfo.processor.properties & CPU_PROP_SSE)
       Con::printf("   SSE detected");
+   if (Platform::SystemInfo.processor.properties & CPU_PROP_SSE2)
+      Con::printf("   SSE2 detected");
    Con::printf(" ");
 
    PlatformBlitInit();
@@ -58,6 +58,7 @@
  #include <sys/types.h>
  #include <sys/stat.h>
  #include <unistd.h>
+ #include <sys/mman.h>
  #include <fcntl.h>
  #include <errno.h>
  #include <stdlib.h>
@@ -929,6 +930,75 @@ bool dPathCopy(const char *fromName, const char *toName, bool nooverwrite)
    // Must be something else or we can't read the file.
    return -1;
  }
+
+ //-----------------------------------------------------------------------------
+ struct x86UNIXFileMapping
+ {
+    void*  base;
+    size_t length;
+ };
+
+ void* Platform::mapFile(const char *pFilePath, U32 offset, U32 &size, const void *&data)
+ {
+    if (!pFilePath || !*pFilePath)
+       return NULL;
+
+    // same lookup order as File::open for reading: pref dir, then game dir
+    char prefPathName[MaxPath];
+    char gamePathName[MaxPath];
+    char cwd[MaxPath];
+    getcwd(cwd, MaxPath);
+    MungePath(prefPathName, MaxPath, pFilePath, GetPrefDir());
+    MungePath(gamePathName, MaxPath, pFilePath, cwd);
+
+    int fd = x86UNIXOpen(prefPathName, O_RDONLY);
+    if (fd == -1)
+       fd = x86UNIXOpen(gamePathName, O_RDONLY);
+    if (fd == -1)
+       return NULL;
+
+    struct stat fStat;
+    if (fstat(fd, &fStat) < 0 || (fStat.st_mode & S_IFMT) != S_IFREG)
+    {
+       x86UNIXClose(fd);
+       return NULL;
+    }
+
+    U32 fileSize = fStat.st_size;
+    if (size == 0 && offset < fileSize)
+       size = fileSize - offset;
+    if (size == 0 || offset + size > fileSize)
+    {
+       x86UNIXClose(fd);
+       return NULL;
+    }
+
+    // mmap offsets have to be page aligned
+    U32 pageSize = sysconf(_SC_PAGESIZE);
+    U32 mapOffset = offset - (offset % pageSize);
+    size_t length = size + (offset - mapOffset);
+    void *base = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, mapOffset);
+    x86UNIXClose(fd);
+    if (base == MAP_FAILED)
+       return NULL;
+
+    x86UNIXFileMapping *ret = new x86UNIXFileMapping;
+    ret->base = base;
+    ret->length = length;
+    data = (const U8 *)base + (offset - mapOffset);
+    return ret;
+ }
+
+ //-----------------------------------------------------------------------------
+ void Platform::unmapFile(void *mapping)
+ {
+    if (!mapping)
+       return;
+
+    x86UNIXFileMapping *map = (x86UNIXFileMapping *)mapping;
+    munmap(map->base, map->length);
+    delete map;
+ }
  
  //-----------------------------------------------------------------------------
  bool Platform::isDirectory(const char *pDirPath)
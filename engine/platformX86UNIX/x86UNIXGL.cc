@@ -39,7 +39,11 @@ enum {
    EXT_paletted_texture          = BIT(4),
    NV_vertex_array_range         = BIT(5),
    EXT_blend_color               = BIT(6),
-   EXT_blend_minmax              = BIT(7)
+   EXT_blend_minmax              = BIT(7),
+   ARB_occlusion_query           = BIT(8),
+   ARB_vertex_buffer_object      = BIT(9),
+   ARB_vertex_program            = BIT(10),
+   EXT_timer_query               = BIT(11)
 };
 
 //WGL_ARB
@@ -265,6 +269,42 @@ bool GL_EXT_Init( )
       gGLState.suppEXTblendminmax = false;
    }
 
+   // ARB_occlusion_query
+   if(pExtString && dStrstr(pExtString, (const char*)"GL_ARB_occlusion_query") != NULL)
+   {
+      extBitMask |= ARB_occlusion_query;
+      gGLState.suppOcclusionQuery = true;
+   } else {
+      gGLState.suppOcclusionQuery = false;
+   }
+
+   // EXT_timer_query, which times with the ARB_occlusion_query functions
+   if(gGLState.suppOcclusionQuery && dStrstr(pExtString, (const char*)"GL_EXT_timer_query") != NULL)
+   {
+      extBitMask |= EXT_timer_query;
+      gGLState.suppTimerQuery = true;
+   } else {
+      gGLState.suppTimerQuery = false;
+   }
+
+   // ARB_vertex_buffer_object
+   if(pExtString && dStrstr(pExtString, (const char*)"GL_ARB_vertex_buffer_object") != NULL)
+   {
+      extBitMask |= ARB_vertex_buffer_object;
+      gGLState.suppVertexBufferObject = true;
+   } else {
+      gGLState.suppVertexBufferObject = false;
+   }
+
+   // ARB_vertex_program
+   if(pExtString && dStrstr(pExtString, (const char*)"GL_ARB_vertex_program") != NULL)
+   {
+      extBitMask |= ARB_vertex_program;
+      gGLState.suppVertexProgram = true;
+   } else {
+      gGLState.suppVertexProgram = false;
+   }
+
    // EXT_fog_coord
    if (pExtString && dStrstr(pExtString, (const char*)"GL_EXT_fog_coord") != NULL)
    {
@@ -329,6 +369,10 @@ bool GL_EXT_Init( )
    if (gGLState.suppARBMultitexture)    Con::printf("  ARB_multitexture (Max Texture Units: %d)", gGLState.maxTextureUnits);
    if (gGLState.suppEXTblendcolor)        Con::printf("  EXT_blend_color");
    if (gGLState.suppEXTblendminmax)       Con::printf("  EXT_blend_minmax");
+   if (gGLState.suppOcclusionQuery)       Con::printf("  ARB_occlusion_query");
+   if (gGLState.suppTimerQuery)           Con::printf("  EXT_timer_query");
+   if (gGLState.suppVertexBufferObject)   Con::printf("  ARB_vertex_buffer_object");
+   if (gGLState.suppVertexProgram)        Con::printf("  ARB_vertex_program");
    if (gGLState.suppPalettedTexture)    Con::printf("  EXT_paletted_texture");
    if (gGLState.suppLockedArrays)       Con::printf("  EXT_compiled_vertex_array");
    if (gGLState.suppVertexArrayRange)   Con::printf("  NV_vertex_array_range");
@@ -346,6 +390,10 @@ bool GL_EXT_Init( )
    if (!gGLState.suppARBMultitexture)    Con::warnf("  ARB_multitexture");
    if (!gGLState.suppEXTblendcolor)      Con::warnf("  EXT_blend_color");
    if (!gGLState.suppEXTblendminmax)     Con::warnf("  EXT_blend_minmax");
+   if (!gGLState.suppOcclusionQuery)      Con::warnf("  ARB_occlusion_query");
+   if (!gGLState.suppTimerQuery)          Con::warnf("  EXT_timer_query");
+   if (!gGLState.suppVertexBufferObject)  Con::warnf("  ARB_vertex_buffer_object");
+   if (!gGLState.suppVertexProgram)       Con::warnf("  ARB_vertex_program");
    if (!gGLState.suppPalettedTexture)    Con::warnf("  EXT_paletted_texture");
    if (!gGLState.suppLockedArrays)       Con::warnf("  EXT_compiled_vertex_array");
    if (!gGLState.suppVertexArrayRange)   Con::warnf("  NV_vertex_array_range");
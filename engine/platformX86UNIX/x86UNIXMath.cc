@@ -8,6 +8,7 @@
 #include "platform/platform.h"
 #include "console/console.h"
 #include "math/mMath.h"
+#include "terrain/blender.h"
 
 
 extern void mInstallLibrary_C();
@@ -54,6 +55,10 @@ ConsoleFunction( MathInit, void, 1, 10, "(detect|C|FPU|MMX|3DNOW|SSE|...)")
          properties |= CPU_PROP_SSE; 
          continue; 
       }
+      if (dStricmp(*argv, "SSE2") == 0) { 
+         properties |= CPU_PROP_SSE2; 
+         continue; 
+      }
       Con::printf("Error: MathInit(): ignoring unknown math extension '%s'", *argv);
    }
    Math::init(properties);
@@ -101,6 +106,13 @@ void Math::init(U32 properties)
    }
 #endif //mwerks>2.4
 
+   Blender::smUseSSE2Blender = false;
+   if (properties & CPU_PROP_SSE2)
+   {
+      Con::printf("   Installing SSE2 extensions");
+      Blender::smUseSSE2Blender = true;
+   }
+
    Con::printf(" ");
 }   
 
@@ -91,8 +91,75 @@ static Socket* addPolledSocket(NetSocket& fd, S32 state,
 
 enum {
    MaxConnections = 1024,
+   UDPBufferSize = 262144,    ///< A full server's worth of client packets can queue up between ticks.
+   PacketBatchSize = 32,
 };
 
+// recvmmsg() and sendmmsg() move a batch of datagrams per syscall.
+#if defined(__linux__) && defined(MSG_WAITFORONE)
+#define TORQUE_NET_MMSG
+#endif
+
+#ifdef TORQUE_NET_MMSG
+static mmsghdr sgRecvMsgs[PacketBatchSize];
+static iovec sgRecvIov[PacketBatchSize];
+static sockaddr sgRecvAddrs[PacketBatchSize];
+static U8 sgRecvData[PacketBatchSize][MaxPacketDataSize];
+static S32 sgRecvCount = 0;
+static S32 sgRecvNext = 0;
+
+static bool sgSendBatching = false;
+static mmsghdr sgSendMsgs[PacketBatchSize];
+static iovec sgSendIov[PacketBatchSize];
+static sockaddr_in sgSendAddrs[PacketBatchSize];
+static U8 sgSendData[PacketBatchSize][MaxPacketDataSize];
+static S32 sgSendCount = 0;
+
+/// Next UDP packet, from the batch that the last recvmmsg() read.
+static S32 recvUDP(U8 *buffer, sockaddr *sa, U32 *addrLen)
+{
+   if(sgRecvNext == sgRecvCount)
+   {
+      for(S32 i = 0; i < PacketBatchSize; i++)
+      {
+         sgRecvIov[i].iov_base = sgRecvData[i];
+         sgRecvIov[i].iov_len = MaxPacketDataSize;
+         dMemset(&sgRecvMsgs[i], 0, sizeof(mmsghdr));
+         sgRecvMsgs[i].msg_hdr.msg_name = &sgRecvAddrs[i];
+         sgRecvMsgs[i].msg_hdr.msg_namelen = sizeof(sockaddr);
+         sgRecvMsgs[i].msg_hdr.msg_iov = &sgRecvIov[i];
+         sgRecvMsgs[i].msg_hdr.msg_iovlen = 1;
+      }
+      sgRecvNext = sgRecvCount = 0;
+      S32 count = recvmmsg(udpSocket, sgRecvMsgs, PacketBatchSize, MSG_DONTWAIT, NULL);
+      if(count <= 0)
+         return -1;
+      sgRecvCount = count;
+   }
+
+   S32 i = sgRecvNext++;
+   S32 bytesRead = sgRecvMsgs[i].msg_len;
+   dMemcpy(buffer, sgRecvData[i], bytesRead);
+   *addrLen = getMin(*addrLen, U32(sgRecvMsgs[i].msg_hdr.msg_namelen));
+   dMemcpy(sa, &sgRecvAddrs[i], *addrLen);
+   return bytesRead;
+}
+
+static void flushSendBatch()
+{
+   // UDP makes no promises, so what the kernel won't take is dropped.
+   S32 sent = 0;
+   while(sent < sgSendCount)
+   {
+      S32 count = sendmmsg(udpSocket, sgSendMsgs + sent, sgSendCount - sent, 0);
+      if(count <= 0)
+         break;
+      sent += count;
+   }
+   sgSendCount = 0;
+}
+#endif
+
 S32 Poll(NetSocket fd, S32 eventMask, S32 timeoutMs)
 {
    pollfd pfd;
@@ -332,7 +399,7 @@ bool Net::openPort(S32 port)
       Net::Error error;
       error = bind(udpSocket, port);
       if(error == NoError)
-         error = setBufferSize(udpSocket, 32768);
+         error = setBufferSize(udpSocket, UDPBufferSize);
       if(error == NoError)
          error = setBroadcast(udpSocket, true);
       if(error == NoError)
@@ -357,7 +424,7 @@ bool Net::openPort(S32 port)
       if(err)
          error = getLastError();
       if(error == NoError)
-         error = setBufferSize(ipxSocket, 32768);
+         error = setBufferSize(ipxSocket, UDPBufferSize);
       if(error == NoError)
          error = setBroadcast(ipxSocket, true);
       if(error == NoError)
@@ -377,15 +444,34 @@ bool Net::openPort(S32 port)
 
 void Net::closePort()
 {
+#ifdef TORQUE_NET_MMSG
+   sgRecvNext = sgRecvCount = 0;
+   sgSendCount = 0;
+#endif
    if(ipxSocket != InvalidSocket)
       close(ipxSocket);
    if(udpSocket != InvalidSocket)
       close(udpSocket);
 }
 
+void Net::beginSendBatch()
+{
+#ifdef TORQUE_NET_MMSG
+   sgSendBatching = true;
+#endif
+}
+
+void Net::endSendBatch()
+{
+#ifdef TORQUE_NET_MMSG
+   sgSendBatching = false;
+   flushSendBatch();
+#endif
+}
+
 Net::Error Net::sendto(const NetAddress *address, const U8 *buffer, S32 bufferSize)
 {
-   if(Game->isJournalReading())
+   if(Game->isJournalReading() || Game->isNetReplaying())
       return NoError;
 
    if(address->type == NetAddress::IPXAddress)
@@ -400,6 +486,24 @@ Net::Error Net::sendto(const NetAddress *address, const U8 *buffer, S32 bufferSi
    }
    else
    {
+#ifdef TORQUE_NET_MMSG
+      if(sgSendBatching && bufferSize <= MaxPacketDataSize)
+      {
+         S32 i = sgSendCount++;
+         netToIPSocketAddress(address, &sgSendAddrs[i]);
+         dMemcpy(sgSendData[i], buffer, bufferSize);
+         sgSendIov[i].iov_base = sgSendData[i];
+         sgSendIov[i].iov_len = bufferSize;
+         dMemset(&sgSendMsgs[i], 0, sizeof(mmsghdr));
+         sgSendMsgs[i].msg_hdr.msg_name = &sgSendAddrs[i];
+         sgSendMsgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+         sgSendMsgs[i].msg_hdr.msg_iov = &sgSendIov[i];
+         sgSendMsgs[i].msg_hdr.msg_iovlen = 1;
+         if(sgSendCount == PacketBatchSize)
+            flushSendBatch();
+         return NoError;
+      }
+#endif
       sockaddr_in ipAddr;
       netToIPSocketAddress(address, &ipAddr);
       if(::sendto(udpSocket, (const char*)buffer, bufferSize, 0,
@@ -420,7 +524,11 @@ void Net::process()
       U32 addrLen = sizeof(sa);
       S32 bytesRead = -1;
       if(udpSocket != InvalidSocket)
+#ifdef TORQUE_NET_MMSG
+         bytesRead = recvUDP(receiveEvent.data, &sa, &addrLen);
+#else
          bytesRead = recvfrom(udpSocket, (char *) receiveEvent.data, MaxPacketDataSize, 0, &sa, &addrLen);
+#endif
       if(bytesRead == -1 && ipxSocket != InvalidSocket)
       {
          addrLen = sizeof(sa);
@@ -620,6 +728,44 @@ void Net::process()
          i++;
    }
 }
+
+void Net::waitForTraffic(U32 timeoutMs)
+{
+   static Vector<pollfd> fds;
+   fds.clear();
+
+   pollfd pfd;
+   pfd.events = POLLIN;
+   pfd.revents = 0;
+   if(udpSocket != InvalidSocket)
+   {
+      pfd.fd = udpSocket;
+      fds.push_back(pfd);
+   }
+   if(ipxSocket != InvalidSocket)
+   {
+      pfd.fd = ipxSocket;
+      fds.push_back(pfd);
+   }
+
+   for(S32 i = 0; i < gPolledSockets.size(); i++)
+   {
+      Socket *sock = gPolledSockets[i];
+      if(sock->state == Connected || sock->state == Listening)
+         pfd.events = POLLIN;
+      else if(sock->state == ConnectionPending)
+         pfd.events = POLLOUT;
+      else
+         return;  // the name lookup finishes on another thread
+      pfd.fd = sock->fd;
+      fds.push_back(pfd);
+   }
+
+   if(fds.size())
+      poll(fds.address(), fds.size(), timeoutMs);
+   else
+      Platform::sleep(timeoutMs);
+}
                  
 NetSocket Net::openSocket()
 {
@@ -13,6 +13,7 @@
 #include "platformX86UNIX/platformGL.h"
 #include "platformX86UNIX/x86UNIXOGLVideo.h"
 #include "platformX86UNIX/x86UNIXState.h"
+#include "dgl/dgl.h"
 
 #include <SDL/SDL.h>
 #include <SDL/SDL_syswm.h>
@@ -176,6 +177,7 @@ bool OpenGLDevice::activate( U32 width, U32 height, U32 bpp, bool fullScreen )
       Con::printf( "  Version: %s", versionString );
 
    GL_EXT_Init();
+   dglInstallStateCache();
 
    Con::setVariable( "$pref::Video::displayDevice", mDeviceName );
 
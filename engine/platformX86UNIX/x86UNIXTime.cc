@@ -50,6 +50,18 @@ U32 Platform::getRealMilliseconds()
    return x86UNIXGetTickCount();
 }
 
+U64 Platform::getRealMicroseconds()
+{
+   // monotonic, so frame timing doesn't jump when the clock is set
+   struct timespec ts;
+   if(clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+      return U64(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return U64(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
 U32 Platform::getVirtualMilliseconds()
 {
    return x86UNIXState->currentTime;
@@ -97,4 +109,13 @@ void Platform::sleep(U32 ms)
 	// note: this will overflow if you want to sleep for more than 49 days. just so ye know.
 	usleep( ms * 1000 );
 }
+
+void Platform::sleepMicroseconds(U32 us)
+{
+   struct timespec ts;
+   ts.tv_sec = us / 1000000;
+   ts.tv_nsec = (us % 1000000) * 1000;
+   while(nanosleep(&ts, &ts) == -1 && errno == EINTR)
+      ;
+}
 	    
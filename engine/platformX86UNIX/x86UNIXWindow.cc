@@ -49,7 +49,7 @@ bool DisplayPtrManager::sgDisplayLocked = false;
 LockFunc_t DisplayPtrManager::sgLockFunc = NULL;
 LockFunc_t DisplayPtrManager::sgUnlockFunc = NULL;
 
-static U32 lastTimeTick;
+static U64 lastTimeTick;   ///< Microseconds, so frames don't lose the sub-ms part.
 static MRandomLCG sgPlatRandom;
 
 #ifndef DEDICATED
@@ -595,7 +595,9 @@ void Platform::process()
       // there are no players connected.
       // JMQ: recent kernels (such as RH 8.0 2.4.18) reduce the latency
       // to 2-4 ms on average.
-      if (!Game->isJournalReading() && (x86UNIXState->getDSleep() || 
+      // The main loop's wait for traffic does the sleeping when it's on.
+      if (!Game->isJournalReading() && !Game->isWaitingForTraffic() &&
+          (x86UNIXState->getDSleep() || 
              Con::getIntVariable("Server::PlayerCount") - 
              Con::getIntVariable("Server::BotCount") <= 0))
       {
@@ -824,12 +826,13 @@ bool Platform::setLoginPassword( const char* password )
 //-------------------------------------------------------------------------------
 void TimeManager::process()
 {
-   U32 curTime = Platform::getRealMilliseconds();
+   U64 curTime = Platform::getRealMicroseconds();
    TimeEvent event;
-   event.elapsedTime = curTime - lastTimeTick;
+   event.elapsedTime = U32((curTime - lastTimeTick) / 1000);
    if(event.elapsedTime > sgTimeManagerProcessInterval)
    {
-      lastTimeTick = curTime;
+      // carry the remainder into the next frame
+      lastTimeTick += U64(event.elapsedTime) * 1000;
       Game->postEvent(event);
    }
 }
@@ -874,7 +877,7 @@ int main(S32 argc, const char **argv)
       return returnVal;
 
    // init lastTimeTick for TimeManager::process()
-   lastTimeTick = Platform::getRealMilliseconds();
+   lastTimeTick = Platform::getRealMicroseconds();
 
    // init process control stuff 
    ProcessControlInit();
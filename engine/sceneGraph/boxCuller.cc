@@ -0,0 +1,102 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "sceneGraph/boxCuller.h"
+#include "math/mMathFn.h"
+#include "platform/profiler.h"
+
+Vector<F32>       BoxCuller::smBoxes;
+U32               BoxCuller::smCapacity = 0;
+U32               BoxCuller::smNumSlots = 0;
+Vector<S32>       BoxCuller::smFreeSlots;
+Vector<S32>       BoxCuller::smResults;
+const SceneState* BoxCuller::smResultState = NULL;
+bool              BoxCuller::smEnabled = true;
+
+//-----------------------------------------------------------------------------
+
+void BoxCuller::grow()
+{
+   U32 capacity = smCapacity ? smCapacity * 2 : U32(MinCapacity);
+
+   // Each row moves to its new place, last first so none is overwritten.
+   smBoxes.setSize(capacity * 6);
+   for (S32 row = 5; row >= 0; row--)
+      dMemmove(&smBoxes[row * capacity], &smBoxes[row * smCapacity], smNumSlots * sizeof(F32));
+   smCapacity = capacity;
+}
+
+S32 BoxCuller::allocSlot()
+{
+   if (smFreeSlots.size())
+   {
+      S32 slot = smFreeSlots.last();
+      smFreeSlots.decrement();
+      return slot;
+   }
+
+   if (smNumSlots == smCapacity)
+      grow();
+   return smNumSlots++;
+}
+
+void BoxCuller::freeSlot(S32 slot)
+{
+   AssertFatal(slot >= 0 && U32(slot) < smNumSlots, "BoxCuller::freeSlot: bad slot");
+
+   // The box stays in the batch until the slot is reused, but nobody asks
+   // for its result.
+   smFreeSlots.push_back(slot);
+}
+
+void BoxCuller::setBox(S32 slot, const Box3F &box)
+{
+   F32 *boxes = smBoxes.address() + slot;
+   boxes[0 * smCapacity] = box.min.x;
+   boxes[1 * smCapacity] = box.min.y;
+   boxes[2 * smCapacity] = box.min.z;
+   boxes[3 * smCapacity] = box.max.x;
+   boxes[4 * smCapacity] = box.max.y;
+   boxes[5 * smCapacity] = box.max.z;
+}
+
+//-----------------------------------------------------------------------------
+
+void BoxCuller::cullObjects(const SceneState *state, const PlaneF *planes, U32 numPlanes)
+{
+   clearResults();
+   if (!smEnabled || !smNumSlots)
+      return;
+
+   PROFILE_START(BoxCullerCullObjects);
+   smResults.setSize(smNumSlots);
+   m_box_array_x_planes((const F32 *) planes, numPlanes, BIT(numPlanes) - 1, 0.0f,
+                        smBoxes.address(), smCapacity, smNumSlots, smResults.address());
+   smResultState = state;
+   PROFILE_END();
+}
+
+void BoxCuller::clearResults()
+{
+   smResultState = NULL;
+   smResults.clear();
+}
+
+bool BoxCuller::getResult(const SceneState *state, S32 slot, S32 &result)
+{
+   if (state != smResultState || slot < 0 || U32(slot) >= smResults.size())
+      return false;
+   result = smResults[slot];
+   return true;
+}
+
+S32 BoxCuller::cullBox(const PlaneF *planes, U32 numPlanes, U32 planeMask, F32 expand,
+                       const Point3F &min, const Point3F &max)
+{
+   F32 box[6] = { min.x, min.y, min.z, max.x, max.y, max.z };
+   S32 result;
+   m_box_array_x_planes((const F32 *) planes, numPlanes, planeMask, expand, box, 1, 1, &result);
+   return result;
+}
@@ -0,0 +1,75 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _BOXCULLER_H_
+#define _BOXCULLER_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+#ifndef _MBOX_H_
+#include "math/mBox.h"
+#endif
+#ifndef _MPLANE_H_
+#include "math/mPlane.h"
+#endif
+
+class SceneState;
+
+/// Frustum culling of boxes in batches, with m_box_array_x_planes().
+///
+/// The render world boxes of the client's scene objects are kept here in
+/// structure of arrays form, one slot per object, updated by
+/// SceneObject::resetRenderWorldBox().  Once the zone managers of a
+/// traversal have set up the zone states, cullObjects() tests every box
+/// against the outside zone's clip planes in one go, and
+/// SceneState::isObjectRendered() only does its exact test on the objects
+/// whose boxes cross a plane.
+///
+/// cullBox() runs a single box through the same kernel, for the terrain
+/// and FrustrumCuller, whose quadtree walks need the answer for one square
+/// before they know the next.
+class BoxCuller
+{
+   enum {
+      MinCapacity = 256          ///< Slots; capacities stay a multiple of 4.
+   };
+
+   static Vector<F32> smBoxes;   ///< Six rows of smCapacity floats, min x, y, z then max x, y, z.
+   static U32         smCapacity;
+   static U32         smNumSlots;     ///< High water mark of the slots in use.
+   static Vector<S32> smFreeSlots;
+
+   static Vector<S32> smResults;      ///< Per slot, from the last cullObjects().
+   static const SceneState* smResultState;
+
+   static void grow();
+
+  public:
+   /// $pref::SceneGraph::batchCulling, to compare against the one at a
+   /// time tests.
+   static bool smEnabled;
+
+   static S32  allocSlot();
+   static void freeSlot(S32 slot);
+   static void setBox(S32 slot, const Box3F &box);
+
+   /// Culls every box against planes, for state, see m_box_array_x_planes().
+   static void cullObjects(const SceneState *state, const PlaneF *planes, U32 numPlanes);
+   /// Forgets the results of cullObjects().
+   static void clearResults();
+   /// The result for slot from cullObjects() for state, false if there is none.
+   static bool getResult(const SceneState *state, S32 slot, S32 &result);
+
+   /// Culls a single box, returning -1 or the crossed planes like
+   /// m_box_array_x_planes().
+   static S32 cullBox(const PlaneF *planes, U32 numPlanes, U32 planeMask, F32 expand,
+                      const Point3F &min, const Point3F &max);
+};
+
+#endif
@@ -4,13 +4,11 @@
 //-----------------------------------------------------------------------------
 
 #include "sceneGraph/detailManager.h"
+#include "sceneGraph/sceneState.h"
 #include "ts/tsShapeInstance.h"
 #include "ts/tsPartInstance.h"
 #include "dgl/dgl.h"
-
-// bias towards using same detail level as previous frame
-#define MatchPreviousReward 0.99f
-#define NotMatchPreviousPenalty 1.01f
+#include "platform/platform.h"
 
 // this is the pref value that the user should be able to set
 F32 DetailManager::smDetailScale = 1.0f;
@@ -29,6 +27,10 @@ DetailManager * DetailManager::smDetailManager = NULL;
 S32 DetailManager::smPolysDidRender = 0;
 S32 DetailManager::smPolysTriedToRender = 0;
 
+S32 DetailManager::smPolyBudget = 0;
+F32 DetailManager::smTargetFrameMs = 0.0f;
+F32 DetailManager::smHysteresis = 0.1f;
+
 S32 QSORT_CALLBACK FN_CDECL compareDetailData( const void * e1, const void * e2 )
 {
    const DetailManager::DetailData * dd1 = *(const DetailManager::DetailData**)e1;
@@ -46,6 +48,9 @@ S32 QSORT_CALLBACK FN_CDECL compareDetailData( const void * e1, const void * e2
 DetailManager::DetailManager()
 {
    mInPrepRender = false;
+   mBudget = 0.0f;
+   mLastBeginTime = 0;
+   mReducing = false;
 }
 
 DetailManager::~DetailManager()
@@ -94,6 +99,36 @@ void DetailManager::begin()
    // clear bump count
    for (U32 i=0; i<MAX_BUMP; i++)
       mBumpPolyCount[i] = 0;
+
+   updateBudget();
+}
+
+void DetailManager::updateBudget()
+{
+   U32 now = Platform::getRealMilliseconds();
+   U32 frameMs = now - mLastBeginTime;
+   bool firstFrame = mLastBeginTime == 0;
+   mLastBeginTime = now;
+
+   if (smTargetFrameMs <= 0.0f)
+   {
+      mBudget = (F32)getMax(smPolyBudget,0);
+      return;
+   }
+
+   // feel for the budget from the frame time, a little at a time so one
+   // slow frame doesn't drop everything a detail
+   F32 cap = (F32)(smPolyBudget>0 ? smPolyBudget : smMaxPolyLimit);
+   if (mBudget <= 0.0f)
+      mBudget = cap;
+   if (!firstFrame)
+   {
+      if (frameMs > smTargetFrameMs * (1.0f + smHysteresis))
+         mBudget *= 0.95f;
+      else if (frameMs < smTargetFrameMs * (1.0f - smHysteresis))
+         mBudget *= 1.02f;
+   }
+   mBudget = mClampF(mBudget,(F32)smMinPolyLimit,cap);
 }
 
 void DetailManager::end()
@@ -103,6 +138,13 @@ void DetailManager::end()
    // leave prepRender stage
    mInPrepRender = false;
 
+   // remember how far the budget took everyone last time
+   for (i=0; i<mDetailData.size(); i++)
+   {
+      mDetailData[i]->prevNumBumps = mDetailData[i]->prevDL==-2 ? 0 : mDetailData[i]->numBumps;
+      mDetailData[i]->numBumps = 0;
+   }
+
    // update poly count for new frame
    smPolysDidRender = mPolyCount;
    smPolysTriedToRender = mPolyCount;
@@ -118,44 +160,18 @@ void DetailManager::end()
          mDetailData.erase(i);
       }
 
-   // we may already be below the poly limit
-   if (mPolyCount<getMax(1,mPolyLimit))
-      // we accept the preferred details
-      return;
-/*
-   // do as many full bumps as we can
-   S32 bump;
-   for (bump=0; bump<MAX_BUMP; bump++)
-      if (mPolyCount-mBumpPolyCount[bump]<mPolyLimit)
-         break;
-   if (bump)
-      // bump everyone this many times...
-      bumpAll(bump-1);
-
-   // update poly count for new frame
-   smPolysDidRender = mPolyCount;
-
-   if (bump==MAX_BUMP)
-      // can do no more...
+   if (mBudget <= 0.0f)
+   {
+      mReducing = false;
       return;
+   }
 
-   // compute priority function...sort
-   for (i=0; i<mDetailData.size(); i++)
-      computePriority(mDetailData[i],bump);
-   dQsort(mDetailData.address(),mDetailData.size(),sizeof(DetailData*),compareDetailData);
+   // aim lower once we've had to reduce, until the preferred details fit that too
+   S32 target = (S32)(mReducing ? mBudget * (1.0f - smHysteresis) : mBudget);
+   mReducing = mPolyCount > target;
+   if (mReducing)
+      reduceToBudget(target);
 
-   // keep reducing until done...
-   for (i=0; i<mDetailData.size(); i++)
-   {
-      if (mPolyCount-mDetailData[i]->bump[bump] > mPolyLimit-smLimitRange)
-      {
-         bumpOne(mDetailData[i],bump);
-         if (mPolyCount<mPolyLimit)
-            // we're done...
-            break;
-      }
-   }
-*/
    // update poly count for new frame
    smPolysDidRender = mPolyCount;
 }
@@ -165,6 +181,19 @@ void DetailManager::selectPotential(TSShapeInstance * si, F32 dist, F32 invScale
 {
    AssertFatal(mInPrepRender,"DetailManager::selectPotentialDetails");
 
+   if (ScenePrepCollector * collector = SceneState::getPrepCollector())
+   {
+      // Parallel prep: pick the detail now so the caller can test it, and
+      // leave the shared bookkeeping for when the collector is merged.
+      AssertFatal(dp == &smDefaultProfile, "DetailManager::selectPotentialDetails: can't defer custom profiles");
+      collector->details.increment();
+      collector->details.last().shape = si;
+      collector->details.last().dist = dist;
+      collector->details.last().invScale = invScale;
+      si->selectCurrentDetail2(dist * invScale);
+      return;
+   }
+
    dist *= invScale;
    S32 dl = si->selectCurrentDetail2(dist);
    if (dl<0)
@@ -191,7 +220,8 @@ void DetailManager::selectPotential(TSShapeInstance * si, F32 dist, F32 invScale
    dd->partInstance = NULL;
    dd->tag = mTag;
    dd->dl = dl;
-   dd->pixelSize = -dist; //pixelRadius; BROKEN, but this'll be fine for now
+   dd->pixelsPerMeter = dglProjectRadius(dist,1.0f) * dglGetPixelScale();
+   dd->pixelSize = dd->pixelsPerMeter * si->getShape()->radius;
    dd->intraDL = si->getCurrentIntraDetail();
 
    // add in poly count for preferred detail level
@@ -286,7 +316,8 @@ void DetailManager::selectPotential(TSPartInstance * pi, F32 dist, F32 invScale,
    dd->partInstance = pi;
    dd->tag = mTag;
    dd->dl = dl;
-   dd->pixelSize = -dist;
+   dd->pixelsPerMeter = dglProjectRadius(dist,1.0f) * dglGetPixelScale();
+   dd->pixelSize = dd->pixelsPerMeter * pi->getRadius();
    dd->intraDL = pi->getCurrentIntraDetail();
 
    // add in poly count for preferred detail level
@@ -377,54 +408,77 @@ bool DetailManager::selectCurrent(TSPartInstance * pi)
 }
 
 //---------------------------------------------------------
-void DetailManager::computePriority(DetailData * detailData, S32 bump)
+void DetailManager::reduceToBudget(S32 target)
 {
-   S32 oldSize, newSize;
+   // Everyone's next detail down, a round at a time, cheapest first.  The
+   // bump counts are relative to the current detail after bumpOne(), so
+   // a shape's next step saves bump[numBumps].
+   for (S32 round=0; round<MAX_BUMP && mPolyCount>target; round++)
+   {
+      S32 i;
+      for (i=0; i<mDetailData.size(); i++)
+         computePriority(mDetailData[i],mDetailData[i]->numBumps);
+      dQsort(mDetailData.address(),mDetailData.size(),sizeof(DetailData*),compareDetailData);
+
+      for (i=0; i<mDetailData.size() && mPolyCount>target; i++)
+      {
+         DetailData * dd = mDetailData[i];
+         if (dd->priority >= F32_MAX)
+            break;
+         bumpOne(dd,dd->numBumps);
+         dd->numBumps++;
+      }
+   }
+
+   // update poly count for new frame
+   smPolysDidRender = mPolyCount;
+}
+
+F32 DetailManager::getError(DetailData * detailData, S32 dl)
+{
+   // not drawing it at all is off by the whole shape
+   if (dl<0)
+      return detailData->pixelSize;
+
+   F32 size;
    if (detailData->shapeInstance)
    {
-      // shape instance...
-      if (bump>0)
-         oldSize = (S32)(detailData->dl>=0 ? detailData->shapeInstance->getShape()->details[detailData->dl].size : 0);
-      else
-         oldSize = (S32)detailData->pixelSize;
-      newSize = (S32)(detailData->dls[bump]>=0 ? detailData->shapeInstance->getShape()->details[detailData->dls[bump]].size : 0);
+      const TSShape::Detail & detail = detailData->shapeInstance->getShape()->details[dl];
+      if (detail.maxError>=0)
+         return detail.maxError * detailData->pixelsPerMeter;
+      size = detail.size;
    }
    else
    {
-      // part instance...
-      AssertFatal(detailData->partInstance,"DetailManager::computePriority");
-      if (bump>0)
-         oldSize = (S32)detailData->partInstance->getDetailSize(detailData->dl);
-      else
-         oldSize = (S32)detailData->pixelSize;
-      newSize = (S32)detailData->partInstance->getDetailSize(detailData->dls[bump]);
+      AssertFatal(detailData->partInstance,"DetailManager::getError");
+      size = detailData->partInstance->getDetailSize(dl);
    }
 
-   // priority weighted by both total bump and recent bump (total bump component helps break ties
-   // when recent bump has the same effect).
-   detailData->priority = 0.5f * (detailData->pixelSize - oldSize) + (oldSize - newSize);
+   // otherwise, how far short of our size the detail was made for
+   return getMax(detailData->pixelSize - size,0.0f);
+}
 
-   // try to be consistent between frames...as much as possible
-   if (detailData->prevDL<0)
+//---------------------------------------------------------
+void DetailManager::computePriority(DetailData * detailData, S32 bump)
+{
+   // screen space error we add per poly we save
+   S32 saved = bump<MAX_BUMP ? detailData->bump[bump] : 0;
+   if (saved<=0 || detailData->dl<0)
    {
-      if (detailData->prevDL==-1)
-      {
-         // weren't visible last time...penalize for being visible this time, reward for being invisible
-         if (detailData->dls[bump]==-1)
-            detailData->priority *= MatchPreviousReward;
-         else if (detailData->dl!=-1)
-            detailData->priority *= NotMatchPreviousPenalty;
-      }
+      detailData->priority = F32_MAX;
+      return;
    }
-   else
+   F32 error = getError(detailData,detailData->dls[bump]) - getError(detailData,detailData->dl);
+   detailData->priority = getMax(error,0.0f) / (F32)saved;
+
+   // try to be consistent between frames...steps we took last time come cheaper,
+   // steps further than that cost more
+   if (detailData->prevDL!=-2)
    {
-      // reward for bumping us down if we are at a higher detail than last time,
-      // penalize for bumping us down if our detail is at or lower than last time
-      // Note: higher detail --> smaller dl number
-      if (detailData->dl > detailData->prevDL)
-         detailData->priority *= MatchPreviousReward;
+      if (bump<detailData->prevNumBumps)
+         detailData->priority *= 1.0f - smHysteresis;
       else
-         detailData->priority *= NotMatchPreviousPenalty;
+         detailData->priority *= 1.0f + smHysteresis;
    }
 }
 
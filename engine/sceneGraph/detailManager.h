@@ -35,7 +35,10 @@ public:
       S32 dl;
       F32 intraDL;
       S32 prevDL;
-      F32 pixelSize;
+      F32 pixelSize;       ///< Radius in pixels.
+      F32 pixelsPerMeter;  ///< At the shape's distance, for TSShape::Detail::maxError.
+      S32 numBumps;        ///< How far the budget took us below dl.
+      S32 prevNumBumps;
       F32 priority;
    };
 
@@ -60,6 +63,10 @@ private:
    S32 mPolyCount; // current poly count
    S32 mBumpPolyCount[MAX_BUMP]; // number of polys we save at each "bump" level
 
+   F32 mBudget;       ///< Poly budget this frame, 0 for none.
+   U32 mLastBeginTime;
+   bool mReducing;    ///< Over budget last frame.
+
    Vector<DetailData*> mDetailData;
    Vector<DetailData*> mFreeDetailData;
 
@@ -75,6 +82,9 @@ private:
    void bumpOne(DetailData*, S32 bump);
    void bumpAll(S32 bump);
 
+   void updateBudget();
+   void reduceToBudget(S32 target);
+   F32  getError(DetailData *, S32 dl);
    void computePriority(DetailData *, S32 bump);
    DetailData * getNewDetailData();
 
@@ -92,6 +102,19 @@ public:
    static S32 smPolysTriedToRender;  // not used here, but can be read for misc. uses
    static S32 smPolysDidRender;      // not used here, but can be read for misc. uses
 
+   /// @name Budget
+   /// With a budget, the details the shapes would pick on their own are
+   /// taken down until the frame's polys fit, the shapes whose next detail
+   /// adds the least screen space error per poly saved going first.
+   /// Shapes keep last frame's reductions ahead of new ones, and once over
+   /// budget it aims for budget * (1 - hysteresis) until the preferred
+   /// details fit under that again, so a scene on the edge doesn't pop.
+   /// @{
+   static S32 smPolyBudget;     ///< $pref::TS::detailBudget, polys per frame, 0 for none.
+   static F32 smTargetFrameMs;  ///< $pref::TS::detailTargetMs, adapts the budget to the frame time, 0 for off.
+   static F32 smHysteresis;     ///< $pref::TS::detailBudgetHysteresis
+   /// @}
+
    static void init() { AssertFatal(!smDetailManager,"DetailManger::init"); smDetailManager = new DetailManager; }
    static void shutdown() { delete smDetailManager; smDetailManager = NULL; }
 
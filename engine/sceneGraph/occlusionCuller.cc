@@ -0,0 +1,241 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "sceneGraph/occlusionCuller.h"
+#include "sim/sceneObject.h"
+#include "dgl/dgl.h"
+#include "dgl/gTexManager.h"
+#include "platform/profiler.h"
+
+U32 OcclusionCuller::smGeneration = 1;
+U32 OcclusionCuller::smFrame = 0;
+U32 OcclusionCuller::smEpoch = 0;
+bool OcclusionCuller::smActive = false;
+Point3F OcclusionCuller::smLastCamPos(0, 0, 0);
+U32 OcclusionCuller::smTextureCallbackKey = U32(-1);
+
+Vector<U32>          OcclusionCuller::smFreeQueries;
+Vector<U32>          OcclusionCuller::smAllQueries;
+Vector<SceneObject*> OcclusionCuller::smToQuery;
+
+bool OcclusionCuller::smEnabled = true;
+S32  OcclusionCuller::smVisibleRequeryFrames = 4;
+F32  OcclusionCuller::smCameraCutDistance = 20.0f;
+S32  OcclusionCuller::smNumCulled = 0;
+S32  OcclusionCuller::smNumQueries = 0;
+
+namespace {
+
+/// Boxes closer than this to the camera would be cut by the near plane, so
+/// they're never culled.
+const F32 csgNearMargin = 0.5f;
+
+void drawBox(const Box3F& box)
+{
+   const Point3F& a = box.min;
+   const Point3F& b = box.max;
+
+   glBegin(GL_QUADS);
+   glVertex3f(a.x, a.y, a.z); glVertex3f(b.x, a.y, a.z); glVertex3f(b.x, b.y, a.z); glVertex3f(a.x, b.y, a.z);
+   glVertex3f(a.x, a.y, b.z); glVertex3f(a.x, b.y, b.z); glVertex3f(b.x, b.y, b.z); glVertex3f(b.x, a.y, b.z);
+   glVertex3f(a.x, a.y, a.z); glVertex3f(a.x, a.y, b.z); glVertex3f(b.x, a.y, b.z); glVertex3f(b.x, a.y, a.z);
+   glVertex3f(a.x, b.y, a.z); glVertex3f(b.x, b.y, a.z); glVertex3f(b.x, b.y, b.z); glVertex3f(a.x, b.y, b.z);
+   glVertex3f(a.x, a.y, a.z); glVertex3f(a.x, b.y, a.z); glVertex3f(a.x, b.y, b.z); glVertex3f(a.x, a.y, b.z);
+   glVertex3f(b.x, a.y, a.z); glVertex3f(b.x, a.y, b.z); glVertex3f(b.x, b.y, b.z); glVertex3f(b.x, b.y, a.z);
+   glEnd();
+}
+
+} // namespace {}
+
+//--------------------------------------------------------------------------
+void OcclusionCuller::init()
+{
+   smTextureCallbackKey = TextureManager::registerEventCallback(textureEvent, NULL);
+}
+
+void OcclusionCuller::destroy()
+{
+   if (smTextureCallbackKey != U32(-1))
+   {
+      TextureManager::unregisterEventCallback(smTextureCallbackKey);
+      smTextureCallbackKey = U32(-1);
+   }
+   deleteQueries();
+   smToQuery.clear();
+}
+
+void OcclusionCuller::textureEvent(const U32 eventCode, void*)
+{
+   // The GL context goes away with the textures.
+   if (eventCode == TextureManager::BeginZombification)
+      deleteQueries();
+}
+
+void OcclusionCuller::deleteQueries()
+{
+   if (smAllQueries.size() != 0)
+      glDeleteQueriesARB(smAllQueries.size(), smAllQueries.address());
+   smAllQueries.clear();
+   smFreeQueries.clear();
+   smGeneration++;
+}
+
+U32 OcclusionCuller::allocQuery()
+{
+   if (smFreeQueries.size() == 0)
+   {
+      const U32 batch = 32;
+      U32 start = smAllQueries.size();
+      smAllQueries.setSize(start + batch);
+      glGenQueriesARB(batch, smAllQueries.address() + start);
+      for (U32 i = 0; i < batch; i++)
+         smFreeQueries.push_back(smAllQueries[start + i]);
+   }
+
+   U32 query = smFreeQueries.last();
+   smFreeQueries.pop_back();
+   return query;
+}
+
+void OcclusionCuller::releaseObject(SceneObject* obj)
+{
+   OcclusionInfo& info = obj->mOcclusion;
+   if (info.query != 0 && info.generation == smGeneration)
+      smFreeQueries.push_back(info.query);
+   info.query = 0;
+   info.pending = false;
+}
+
+//--------------------------------------------------------------------------
+bool OcclusionCuller::beginFrame(const Point3F& camPos)
+{
+   smNumCulled  = 0;
+   smNumQueries = 0;
+
+   // Anything left from a frame that didn't get to issueQueries().
+   smToQuery.clear();
+
+   if (!smEnabled || !dglDoesSupportOcclusionQuery())
+   {
+      smActive = false;
+      return false;
+   }
+
+   smFrame++;
+   if (!smActive || (camPos - smLastCamPos).lenSquared() > smCameraCutDistance * smCameraCutDistance)
+      smEpoch++;
+   smLastCamPos = camPos;
+   smActive = true;
+   return true;
+}
+
+bool OcclusionCuller::isCandidate(const SceneObject* obj)
+{
+   return (obj->getTypeMask() & (ShapeBaseObjectType | StaticTSObjectType)) != 0;
+}
+
+bool OcclusionCuller::wasCulled(const SceneObject* obj)
+{
+   const OcclusionInfo& info = obj->mOcclusion;
+   return info.frame == smFrame && info.culled;
+}
+
+bool OcclusionCuller::testObject(SceneObject* obj, const Point3F& camPos)
+{
+   OcclusionInfo& info = obj->mOcclusion;
+   if (info.frame == smFrame)
+      return info.culled;
+
+   info.frame  = smFrame;
+   info.culled = false;
+
+   if (info.generation != smGeneration)
+   {
+      info.query      = 0;
+      info.pending    = false;
+      info.occluded   = false;
+      info.generation = smGeneration;
+   }
+
+   Box3F box = obj->getRenderWorldBox();
+   box.min -= Point3F(csgNearMargin, csgNearMargin, csgNearMargin);
+   box.max += Point3F(csgNearMargin, csgNearMargin, csgNearMargin);
+   if (box.isContained(camPos))
+      return false;
+
+   // Pick up the last result if it's there, never wait for it.
+   if (info.pending)
+   {
+      GLint available = 0;
+      glGetQueryObjectivARB(info.query, GL_QUERY_RESULT_AVAILABLE_ARB, &available);
+      if (available)
+      {
+         GLuint samples = 0;
+         glGetQueryObjectuivARB(info.query, GL_QUERY_RESULT_ARB, &samples);
+         info.occluded = (samples == 0);
+         info.pending  = false;
+      }
+   }
+
+   bool occluded = info.occluded && info.queryEpoch == smEpoch;
+
+   // Hidden objects are queried every frame so they reappear quickly,
+   //  visible ones now and then, spread out over the frames.
+   if (!info.pending)
+   {
+      U32 interval = getMax(smVisibleRequeryFrames, 1);
+      if (occluded || info.queryEpoch != smEpoch || (smFrame + obj->getId()) % interval == 0)
+         smToQuery.push_back(obj);
+   }
+
+   if (occluded)
+   {
+      info.culled = true;
+      smNumCulled++;
+   }
+   return occluded;
+}
+
+void OcclusionCuller::issueQueries()
+{
+   if (smToQuery.size() == 0)
+      return;
+
+   PROFILE_START(OcclusionCuller_IssueQueries);
+
+   glPushAttrib(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_ENABLE_BIT | GL_POLYGON_BIT);
+   glDisable(GL_TEXTURE_2D);
+   glDisable(GL_BLEND);
+   glDisable(GL_ALPHA_TEST);
+   glDisable(GL_LIGHTING);
+   glDisable(GL_FOG);
+   glDisable(GL_CULL_FACE);
+   glEnable(GL_DEPTH_TEST);
+   glDepthFunc(GL_LEQUAL);
+   glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+   glDepthMask(GL_FALSE);
+
+   for (U32 i = 0; i < smToQuery.size(); i++)
+   {
+      SceneObject* obj = smToQuery[i];
+      OcclusionInfo& info = obj->mOcclusion;
+      if (info.query == 0)
+         info.query = allocQuery();
+
+      glBeginQueryARB(GL_SAMPLES_PASSED_ARB, info.query);
+      drawBox(obj->getRenderWorldBox());
+      glEndQueryARB(GL_SAMPLES_PASSED_ARB);
+
+      info.pending    = true;
+      info.queryEpoch = smEpoch;
+   }
+
+   glPopAttrib();
+
+   smNumQueries += smToQuery.size();
+   smToQuery.clear();
+
+   PROFILE_END();
+}
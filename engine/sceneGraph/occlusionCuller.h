@@ -0,0 +1,116 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _OCCLUSIONCULLER_H_
+#define _OCCLUSIONCULLER_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _MPOINT_H_
+#include "math/mPoint.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+
+class SceneObject;
+
+/// Per object state for OcclusionCuller, kept in the SceneObject.
+struct OcclusionInfo
+{
+   U32  query;          ///< GL query object, 0 if none yet.
+   U32  generation;     ///< OcclusionCuller generation the query belongs to.
+   U32  frame;          ///< Frame the object was last tested in.
+   U32  queryEpoch;     ///< Camera epoch the last query was issued in.
+   bool pending;        ///< Query issued and its result not read yet.
+   bool occluded;       ///< Result of the last query that came back.
+   bool culled;         ///< Whether the object is skipped in frame.
+
+   OcclusionInfo()
+      : query(0), generation(0), frame(0), queryEpoch(0),
+        pending(false), occluded(false), culled(false)
+   {
+   }
+};
+
+/// Hardware occlusion culling for the main scene render.
+///
+/// Outdoors portals don't help, so dense towns on terrain end up drawing
+/// many shapes that sit behind interiors or hills.  After the opaque images
+/// of the base SceneState are rendered, the bounding boxes of the shapes are
+/// drawn with color and depth writes off inside ARB_occlusion_query queries.
+/// The result is picked up the next frame, or later when the GPU is behind,
+/// and a shape whose box had no visible samples is skipped, along with its
+/// translucent images and shadow, until a query says it is visible again.
+///
+/// Hidden shapes are queried every frame so they come back after one frame.
+/// Visible shapes are only queried every smVisibleRequeryFrames frames.
+/// Results are never waited on.
+///
+/// Only ShapeBase and TSStatic objects are culled (they're the usual
+/// occludees), and only in the base state of a SceneGraph::renderScene().
+/// Interiors and terrain are drawn first and act as the occluders.  A camera
+/// cut, or several views sharing the scene, starts a new epoch, so results
+/// from the old viewpoint are thrown away.
+class OcclusionCuller
+{
+   /// Bumped when the GL queries are lost; every OcclusionInfo from an older
+   /// generation is treated as having no query.
+   static U32 smGeneration;
+   static U32 smFrame;
+   static U32 smEpoch;
+   static bool smActive;
+   static Point3F smLastCamPos;
+   static U32 smTextureCallbackKey;
+
+   static Vector<U32>          smFreeQueries;
+   static Vector<U32>          smAllQueries;
+   static Vector<SceneObject*> smToQuery;
+
+   static U32  allocQuery();
+   static void deleteQueries();
+   static void textureEvent(const U32 eventCode, void* userData);
+
+  public:
+   /// $pref::SceneGraph::occlusionCulling
+   static bool smEnabled;
+   /// $pref::SceneGraph::occlusionRequeryFrames
+   static S32  smVisibleRequeryFrames;
+   /// $pref::SceneGraph::occlusionCameraCut, camera movement in one frame
+   /// that throws away the previous results.
+   static F32  smCameraCutDistance;
+
+   /// $OcclusionCuller::numCulled and numQueries, for the last frame.
+   static S32  smNumCulled;
+   static S32  smNumQueries;
+
+   static void init();
+   static void destroy();
+
+   /// Starts a frame from the given camera; returns false if occlusion
+   /// culling is off or not supported, in which case nothing else should be
+   /// called this frame.
+   static bool beginFrame(const Point3F& camPos);
+
+   /// Returns true if obj can be culled at all.
+   static bool isCandidate(const SceneObject* obj);
+
+   /// Returns true if obj should be skipped this frame, and schedules a new
+   /// query for it if one is due.  Cheap to call more than once per frame.
+   static bool testObject(SceneObject* obj, const Point3F& camPos);
+
+   /// True if testObject() culled obj this frame.
+   static bool wasCulled(const SceneObject* obj);
+
+   /// Draws the queries scheduled by testObject().  Must be called with the
+   /// scene's modelview loaded, once the occluders are in the depth buffer.
+   static void issueQueries();
+
+   /// Gives the object's query back to the pool when it is deleted.
+   static void releaseObject(SceneObject* obj);
+};
+
+#endif
@@ -16,6 +16,8 @@
 #include "terrain/waterBlock.h"
 #include "sim/decalManager.h"
 #include "sceneGraph/detailManager.h"
+#include "sceneGraph/occlusionCuller.h"
+#include "sceneGraph/visibilityQuery.h"
 #include "ts/tsShapeInstance.h"
 #include "core/fileStream.h"
 #include "platform/profiler.h"
@@ -28,6 +30,9 @@ SceneGraph* gClientSceneGraph = NULL;
 SceneGraph* gServerSceneGraph = NULL;
 const U32 SceneGraph::csmRefPoolBlockSize = 4096;
 F32 SceneGraph::smVisibleDistanceMod = 1.0;
+bool SceneGraph::smParallelPrep = true;
+S32 SceneGraph::smParallelPrepMinObjects = 64;
+bool SceneGraph::smScopeWithBins = true;
 
 F32 SceneGraph::mHazeArray[FogTextureDistSize];
 U32 SceneGraph::mHazeArrayi[FogTextureDistSize];
@@ -124,6 +129,7 @@ void SceneGraph::renderScene(const U32 objectMask)
    Point3F cp;
 
    dglClearPrimMetrics();
+   dglClearStateMetrics();
    dglSetRenderPrimType(0);
 
    bool multitex = dglDoesSupportARBMultitexture();
@@ -163,6 +169,8 @@ void SceneGraph::renderScene(const U32 objectMask)
                                            mFogVolumes,
                                            envMap,
                                            smVisibleDistanceMod);
+   pBaseState->mOcclusionCull = OcclusionCuller::beginFrame(cp);
+
    // build the fog texture
    PROFILE_START(BuildFogTexture);
    if(!useSpecial)
@@ -193,6 +201,9 @@ void SceneGraph::renderScene(const U32 objectMask)
    traverseSceneTree(pBaseState);
    PROFILE_END();
 
+   // Line of sight tests the flares asked for while rendering.
+   VisibilityQuery::resolveAll(pBaseState);
+
    delete pBaseState;
    PROFILE_END();
 }
@@ -490,6 +501,7 @@ struct ScopingInfo {
    F32            scopeDistSquared;
    const bool*    zoneScopeStates;
    NetConnection* connection;
+   U32            stateKey;
 };
 
 
@@ -512,6 +524,22 @@ inline void scopeCallback(SceneObject* obj, ScopingInfo* pInfo)
    }
 }
 
+void SceneGraph::scopeBinCallback(SceneObject* obj, void* key)
+{
+   ScopingInfo* pInfo = static_cast<ScopingInfo*>(key);
+   if (obj->mLastStateKey == pInfo->stateKey)
+      return;
+
+   // Only what's in the outdoor zone; the other zones come from their lists.
+   for (U32 i = 0; i < obj->getNumCurrZones(); i++) {
+      if (obj->getCurrZone(i) == 0) {
+         obj->mLastStateKey = pInfo->stateKey;
+         scopeCallback(obj, pInfo);
+         return;
+      }
+   }
+}
+
 void SceneGraph::scopeScene(const Point3F& scopePosition,
                             const F32      scopeDistance,
                             NetConnection* netConnection)
@@ -584,8 +612,17 @@ void SceneGraph::scopeScene(const Point3F& scopePosition,
    info.scopeDistSquared = scopeDistance * scopeDistance;
    info.zoneScopeStates  = zoneScopeState;
    info.connection       = netConnection;
+   info.stateKey         = smStateKey;
+
+   // The outdoor zone holds nearly everything in a mission.  Its objects are
+   //  already binned by position in the container, so only the bins around
+   //  the scope point need looking at rather than the whole zone list.
+   bool scopeWithBins = smScopeWithBins && zoneScopeState[0] == true;
 
    for (i = 0; i < mCurrZoneEnd; i++) {
+      if (i == 0 && scopeWithBins)
+         continue;
+
       // Zip through the zone lists...
       if (zoneScopeState[i] == true) {
          // Scope zone i...
@@ -603,6 +640,13 @@ void SceneGraph::scopeScene(const Point3F& scopePosition,
       }
    }
 
+   if (scopeWithBins) {
+      Container* pQueryContainer = mIsClient ? &gClientContainer : &gServerContainer;
+      Point3F extent(scopeDistance, scopeDistance, scopeDistance);
+      Box3F scopeBox(scopePosition - extent, scopePosition + extent);
+      pQueryContainer->findObjects(scopeBox, 0xFFFFFFFF, scopeBinCallback, &info, false);
+   }
+
    delete [] zoneScopeState;
    zoneScopeState = NULL;
 }
@@ -140,6 +140,16 @@ class SceneGraph
   public:
    static F32 smVisibleDistanceMod;
 
+   /// Run prepRenderImage() for objects that allow it on the thread pool.
+   /// @see SceneObject::isParallelPrepSafe
+   static bool smParallelPrep;
+   /// Fewer deferred objects than this are prepped serially.
+   static S32  smParallelPrepMinObjects;
+
+   /// Scope the outdoor zone from the container bins around the camera
+   /// instead of walking all of its objects.
+   static bool smScopeWithBins;
+
 
   public:
    static bool useSpecial;
@@ -189,6 +199,8 @@ class SceneGraph
 
    Sky*          getCurrentSky()          { return mCurrSky; }
    TerrainBlock* getCurrentTerrain()      { return mCurrTerrain; }
+   /// Used by TerrainPager to follow the page under the camera.
+   void          setCurrentTerrain(TerrainBlock *block) { mCurrTerrain = block; }
    DecalManager* getCurrentDecalManager() { return mCurrDecalManager; }
    void getWaterObjectList(SimpleQueryList&);
 
@@ -212,7 +224,25 @@ class SceneGraph
   protected:
    void buildSceneTree(SceneState*, SceneObject*, const U32, const U32, const U32);
    void traverseSceneTree(SceneState* pState);
-   void treeTraverseVisit(SceneObject*, SceneState*, const U32);
+   /// Visits obj and the zone owners it depends on.  Objects that can
+   /// be prepped on another thread are appended to deferred instead, when
+   /// it's given.
+   void treeTraverseVisit(SceneObject*, SceneState*, const U32, Vector<SceneObject*>* deferred = NULL);
+
+   /// Terrain occlusion test then prepRenderImage() for a visited object.
+   void prepVisibleObject(SceneObject*, SceneState*, const U32);
+
+   /// Second phase of the traversal, once the zone states are final: culls
+   /// the object boxes in one batch, then preps the deferred objects, on
+   /// the thread pool when parallel is set.
+   void prepDeferredObjects(Vector<SceneObject*>& objects, SceneState*, const U32, bool parallel);
+
+   /// Preps the deferred objects on the thread pool into per batch
+   /// collectors and merges them into state.
+   void prepObjectsParallel(Vector<SceneObject*>& objects, SceneState*, const U32);
+   static void prepObjectBatches(U32 start, U32 end, void* userData);
+
+   static void scopeBinCallback(SceneObject*, void* key);
 
    void compactZonesCheck();
    bool alreadyManagingZones(SceneObject*) const;
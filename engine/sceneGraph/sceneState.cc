@@ -10,57 +10,170 @@
 #include "sceneGraph/sceneGraph.h"
 #include "terrain/sky.h"
 #include "platform/profiler.h"
+#include "platform/platformMutex.h"
+#include "sceneGraph/occlusionCuller.h"
+#include "sceneGraph/boxCuller.h"
+#include "sceneGraph/detailManager.h"
+#include "ts/tsShapeInstance.h"
+#include "ts/tsImpostorAtlas.h"
+#include "core/dataChunker.h"
+#include "core/tVectorPool.h"
 
 namespace {
 
-S32 FN_CDECL
-cmpImageFunc(const void* p1, const void* p2)
+/// One thread's bump allocator for render images.  Blocks are kept from
+/// frame to frame, so after the first few frames nothing is allocated.
+class RenderImagePool : public DataChunker
 {
-   const SceneRenderImage* psri1 = *((const SceneRenderImage**)p1);
-   const SceneRenderImage* psri2 = *((const SceneRenderImage**)p2);
-   // Compares only non-transcluent images
-   AssertFatal(psri1->isTranslucent == false && psri2->isTranslucent == false,
-               "Error, only non-translucent images allowed here.");
+  public:
+   enum { BlockSize = 64 * 1024 };
 
-   if (psri1->sortType != psri2->sortType)
-   {
-      // Normal render images are setup in such a way that increasing order
-      //  renders
-      return S32(psri1->sortType) - S32(psri2->sortType);
-   }
-   else
+   RenderImagePool() : DataChunker(BlockSize) {}
+
+   void* alloc(U32 size) { return DataChunker::alloc(S32(size), 16); }
+};
+
+Vector<RenderImagePool*> sgRenderImagePools;
+ThreadStorage            sgThreadRenderImagePool;
+void*                    sgRenderImagePoolMutex = NULL;
+U32                      sgNumRootStates = 0;
+
+/// A render image with its 64 bit sort key.
+struct SortEntry
+{
+   U64               key;
+   SceneRenderImage* image;
+};
+
+Vector<SortEntry> sgSortEntries;
+Vector<SortEntry> sgSortScratch;
+
+inline U32 floatSortBits(F32 f)
+{
+   // Non-negative floats order the same as their bit patterns.
+   AssertFatal(f >= 0.0f, "floatSortBits: negative values don't sort");
+   return *((U32*)&f);
+}
+
+/// Rough grouping by render path, so that interiors and shapes, which set
+/// up very different GL state, are drawn together.
+inline U32 objectSortClass(const SceneObject* obj)
+{
+   if (obj == NULL)
+      return 3;
+   U32 mask = obj->getTypeMask();
+   if (mask & InteriorObjectType)
+      return 0;
+   if (mask & (ShapeBaseObjectType | StaticTSObjectType))
+      return 1;
+   return 2;
+}
+
+/// Key for the opaque list.  From the top down:
+///   - 4 bits of SortType, which has to come first to keep the render order
+///   - 4 bits of object class
+///   - 32 bits of textureSortKey, the material/texture handle set by the object
+///   - 24 bits of depth, front to back so later pixels fail the z test
+inline U64 opaqueSortKey(const SceneRenderImage* image, const Point3F& camPos)
+{
+   AssertFatal(image->isTranslucent == false, "Error, only non-translucent images allowed here.");
+
+   U32 depth = 0;
+   if (image->obj != NULL)
    {
-      // Otherwise, sort on primary texture, as set by the sort key
-      return S32(psri1->textureSortKey) - S32(psri2->textureSortKey);
+      Point3F center;
+      image->obj->getRenderWorldBox().getCenter(&center);
+      depth = floatSortBits((center - camPos).lenSquared()) >> 8;
    }
+
+   return (U64(image->sortType & 0xF)            << 60) |
+          (U64(objectSortClass(image->obj))      << 56) |
+          (U64(image->textureSortKey)            << 24) |
+          U64(depth);
 }
 
-S32 FN_CDECL
-cmpTPImageFunc(const void* p1, const void* p2)
+/// Stable LSD radix sort of sgSortEntries, one byte per pass.  Passes where
+/// every key has the same byte are skipped, which with these keys is most
+/// of the top ones.
+void radixSortEntries()
 {
-   const SceneRenderImage* psri1 = *((const SceneRenderImage**)p1);
-   const SceneRenderImage* psri2 = *((const SceneRenderImage**)p2);
-   // Compares only non-transcluent images
-   AssertFatal(psri1->isTranslucent == true && psri2->isTranslucent == true,
-               "Error, only non-translucent images allowed here.");
+   U32 count = sgSortEntries.size();
+   if (count < 2)
+      return;
 
-   return S32(psri1->textureSortKey) - S32(psri2->textureSortKey);
+   sgSortScratch.setSize(count);
+   SortEntry* src = sgSortEntries.address();
+   SortEntry* dst = sgSortScratch.address();
+
+   for (U32 shift = 0; shift < 64; shift += 8)
+   {
+      U32 histogram[256];
+      dMemset(histogram, 0, sizeof(histogram));
+      for (U32 i = 0; i < count; i++)
+         histogram[U32(src[i].key >> shift) & 0xFF]++;
+
+      if (histogram[U32(src[0].key >> shift) & 0xFF] == count)
+         continue;
+
+      U32 offset = 0;
+      for (U32 i = 0; i < 256; i++)
+      {
+         U32 n = histogram[i];
+         histogram[i] = offset;
+         offset += n;
+      }
+      for (U32 i = 0; i < count; i++)
+         dst[histogram[U32(src[i].key >> shift) & 0xFF]++] = src[i];
+
+      SortEntry* swap = src;
+      src = dst;
+      dst = swap;
+   }
+
+   if (src != sgSortEntries.address())
+      dMemcpy(sgSortEntries.address(), src, count * sizeof(SortEntry));
 }
 
-S32 FN_CDECL
-cmpPlaneImageFunc(const void* p1, const void* p2)
+enum SortListType
 {
-   const SceneRenderImage** psri1 = (const SceneRenderImage**)p1;
-   const SceneRenderImage** psri2 = (const SceneRenderImage**)p2;
+   SortOpaque,
+   SortTranslucentPoint,
+   SortTranslucentPlane
+};
 
-   // Normal render images are setup in such a way that increasing order
-   //  renders
-   if (((*psri2)->polyArea - (*psri1)->polyArea) < 0.0)
-      return -1;
-   else if (((*psri2)->polyArea - (*psri1)->polyArea) == 0.0)
-      return 0;
-   else
-      return 1;
+void sortImageList(Vector<SceneRenderImage*>& list, SortListType type, const Point3F& camPos)
+{
+   U32 count = list.size();
+   if (count < 2)
+      return;
+
+   sgSortEntries.setSize(count);
+   for (U32 i = 0; i < count; i++)
+   {
+      SceneRenderImage* image = list[i];
+      SortEntry& entry = sgSortEntries[i];
+      entry.image = image;
+
+      switch (type)
+      {
+        case SortOpaque:
+         entry.key = opaqueSortKey(image, camPos);
+         break;
+        case SortTranslucentPoint:
+         // Only groups them, the BSP leaves sort them on distance.
+         entry.key = image->textureSortKey;
+         break;
+        case SortTranslucentPlane:
+         // Largest first, so the big planes split the BSP.
+         entry.key = ~floatSortBits(image->polyArea);
+         break;
+      }
+   }
+
+   radixSortEntries();
+
+   for (U32 i = 0; i < count; i++)
+      list[i] = sgSortEntries[i].image;
 }
 
 
@@ -96,6 +209,10 @@ cmpPointImageFunc(const void* p1, const void* p2)
 
 inline void renderImage(SceneState* state, SceneRenderImage* image)
 {
+   // Hidden shapes lose all their images, translucent ones and shadows too.
+   if (state->isOcclusionCulling() && OcclusionCuller::wasCulled(image->obj))
+      return;
+
    PROFILE_START(SceneStateRenderImage);
 #if defined(TORQUE_DEBUG)
    S32 m, p, t0, t1, v[4];
@@ -119,7 +236,59 @@ inline void renderImage(SceneState* state, SceneRenderImage* image)
    PROFILE_END();
 }
 
+/// Renders a run of images that share a batch key.  Culled ones are moved to
+/// the back of the run so the rest can be passed on in one piece.  Opaque
+/// images are tested as they're drawn, translucent ones go by the opaque
+/// pass's results, like renderImage().
+void renderImageBatch(SceneState* state, SceneRenderImage** images, U32 count, bool opaque = true)
+{
+   U32 numVisible = count;
+   if (state->isOcclusionCulling())
+   {
+      numVisible = 0;
+      for (U32 i = 0; i < count; i++)
+      {
+         SceneRenderImage* image = images[i];
+         if (opaque ? OcclusionCuller::isCandidate(image->obj) &&
+                      OcclusionCuller::testObject(image->obj, state->getCameraPosition())
+                    : OcclusionCuller::wasCulled(image->obj))
+            continue;
+
+         images[i] = images[numVisible];
+         images[numVisible++] = image;
+      }
+   }
+
+   if (numVisible == 0)
+      return;
+   if (numVisible == 1)
+   {
+      renderImage(state, images[0]);
+      return;
+   }
 
+   PROFILE_START(SceneStateRenderImageBatch);
+#if defined(TORQUE_DEBUG)
+   S32 m, p, t0, t1, v[4];
+   F32 t0m[16], t1m[16];
+   dglGetTransformState(&m, &p, &t0, t0m, &t1, t1m, v);
+#endif
+   images[0]->obj->renderObjectBatch(state, images, numVisible);
+
+#if defined(TORQUE_DEBUG)
+   if (dglCheckState(m, p, t0, t0m, t1, t1m, v) == false) {
+      S32 bm, bp, bt0, bt1, bv[4];
+      F32 bt0m[16], bt1m[16];
+      dglGetTransformState(&bm, &bp, &bt0, bt0m, &bt1, bt1m, bv);
+      AssertFatal(false,
+                  avar("Error, objects of class %s either unbalanced the xform stacks, or didn't reset the viewport!"
+                       " mv(%d %d) proj(%d %d) t0(%d %d), t1(%d %d) (%d %d %d %d: %d %d %d %d)",
+                       images[0]->obj->getClassName(),
+                       m, bm, p, bp, t0, bt0, t1, bt1, v[0], v[1], v[2], v[3], bv[0], bv[1], bv[2], bv[3]));
+   }
+#endif
+   PROFILE_END();
+}
 
 } // namespace {}
 
@@ -172,6 +341,15 @@ SceneState::SceneState(SceneState*    parent,
 
    mParent   = parent;
    mFlipCull = false;
+   mOcclusionCull = false;
+
+   if (parent == NULL)
+   {
+      // Created here on the main thread, before any worker allocates.
+      if (sgRenderImagePoolMutex == NULL)
+         sgRenderImagePoolMutex = Mutex::createMutex();
+      sgNumRootStates++;
+   }
 
    mBaseZoneState.render          = false;
    mBaseZoneState.clipPlanesValid = false;
@@ -212,6 +390,15 @@ SceneState::SceneState(SceneState*    parent,
 
    mEnvironmentMap  = envMap;
 
+   // A frame makes a fair number of states, so their lists take the
+   //  storage the last ones gave back.
+   VectorPool<SceneRenderImage*>::acquire(mRenderImages);
+   VectorPool<SceneRenderImage*>::acquire(mTranslucentPlaneImages);
+   VectorPool<SceneRenderImage*>::acquire(mTranslucentPointImages);
+   VectorPool<SceneRenderImage*>::acquire(mTranslucentBeginImages);
+   VectorPool<SceneRenderImage*>::acquire(mTranslucentEndImages);
+   VectorPool<RenderBSPNode>::acquire(mTranslucentBSP);
+
    mRenderImages.reserve(128);
    mTranslucentPlaneImages.reserve(128);
    mTranslucentPointImages.reserve(128);
@@ -231,16 +418,51 @@ SceneState::~SceneState()
    for (i = 0; i < mSubsidiaries.size(); i++)
       delete mSubsidiaries[i];
 
-   for (i = 0; i < mRenderImages.size(); i++)
-      delete mRenderImages[i];
-   for (i = 0; i < mTranslucentPlaneImages.size(); i++)
-      delete mTranslucentPlaneImages[i];
-   for (i = 0; i < mTranslucentPointImages.size(); i++)
-      delete mTranslucentPointImages[i];
-   for (i = 0; i < mTranslucentEndImages.size(); i++)
-      delete mTranslucentEndImages[i];
-   for (i = 0; i < mTranslucentBeginImages.size(); i++)
-      delete mTranslucentBeginImages[i];
+   VectorPool<SceneRenderImage*>::release(mRenderImages);
+   VectorPool<SceneRenderImage*>::release(mTranslucentPlaneImages);
+   VectorPool<SceneRenderImage*>::release(mTranslucentPointImages);
+   VectorPool<SceneRenderImage*>::release(mTranslucentBeginImages);
+   VectorPool<SceneRenderImage*>::release(mTranslucentEndImages);
+   VectorPool<RenderBSPNode>::release(mTranslucentBSP);
+
+   // The images themselves go back to the pools in one go once the last
+   //  root state is done with them.
+   if (mParent == NULL && --sgNumRootStates == 0)
+   {
+      Mutex::lockMutex(sgRenderImagePoolMutex);
+      for (i = 0; i < sgRenderImagePools.size(); i++)
+         sgRenderImagePools[i]->reset();
+      Mutex::unlockMutex(sgRenderImagePoolMutex);
+   }
+}
+
+void* SceneState::allocRenderImage(U32 size)
+{
+   RenderImagePool* pool = (RenderImagePool*)sgThreadRenderImagePool.get();
+   if (pool == NULL)
+   {
+      AssertFatal(sgRenderImagePoolMutex != NULL, "SceneState::allocRenderImage: no scene is being rendered");
+      pool = new RenderImagePool;
+      sgThreadRenderImagePool.set(pool);
+
+      Mutex::lockMutex(sgRenderImagePoolMutex);
+      sgRenderImagePools.push_back(pool);
+      Mutex::unlockMutex(sgRenderImagePoolMutex);
+   }
+   return pool->alloc(size);
+}
+
+void SceneState::destroyRenderImagePools()
+{
+   AssertFatal(sgNumRootStates == 0, "SceneState::destroyRenderImagePools: scene still being rendered");
+   for (U32 i = 0; i < sgRenderImagePools.size(); i++)
+      delete sgRenderImagePools[i];
+   sgRenderImagePools.clear();
+   if (sgRenderImagePoolMutex != NULL)
+   {
+      Mutex::destroyMutex(sgRenderImagePoolMutex);
+      sgRenderImagePoolMutex = NULL;
+   }
 }
 
 void SceneState::setPortal(SceneObject* owner, const U32 index)
@@ -249,8 +471,27 @@ void SceneState::setPortal(SceneObject* owner, const U32 index)
    mPortalIndex = index;
 }
 
+bool          SceneState::smCollecting = false;
+ThreadStorage SceneState::smCollector;
+
+void SceneState::prepareParallelQueries()
+{
+   for (U32 i = 0; i < mZoneStates.size(); i++)
+   {
+      ZoneState& rState = mZoneStates[i];
+      if (rState.render == true && rState.clipPlanesValid == false)
+         setupClipPlanes(rState);
+   }
+}
+
 void SceneState::insertRenderImage(SceneRenderImage* ri)
 {
+   if (ScenePrepCollector* collector = getPrepCollector())
+   {
+      collector->images.push_back(ri);
+      return;
+   }
+
    if (ri->isTranslucent == false)
       mRenderImages.push_back(ri);
    else
@@ -289,9 +530,11 @@ void SceneState::insertTransformPortal(SceneObject* owner, U32 portalIndex,
 
 void SceneState::sortRenderImages()
 {
-   dQsort(mRenderImages.address(), mRenderImages.size(), sizeof(SceneRenderImage*), cmpImageFunc);
-   dQsort(mTranslucentPointImages.address(), mTranslucentPointImages.size(), sizeof(SceneRenderImage*), cmpTPImageFunc);
-   dQsort(mTranslucentPlaneImages.address(), mTranslucentPlaneImages.size(), sizeof(SceneRenderImage*), cmpPlaneImageFunc);
+   PROFILE_START(SceneState_SortRenderImages);
+   sortImageList(mRenderImages, SortOpaque, mCamPosition);
+   sortImageList(mTranslucentPointImages, SortTranslucentPoint, mCamPosition);
+   sortImageList(mTranslucentPlaneImages, SortTranslucentPlane, mCamPosition);
+   PROFILE_END();
 }
 
 void SceneState::insertIntoNode(RenderBSPNode& rNode, SceneRenderImage* pImage, bool rendered)
@@ -419,7 +662,7 @@ void SceneState::renderNode(RenderBSPNode& rNode)
    }
    else
    {
-      Vector<SceneRenderImage*> imageList(128);
+      SmallVector<SceneRenderImage*, 128> imageList;
       SceneRenderImage* pImage = rNode.riList;
       while (pImage != NULL)
       {
@@ -430,19 +673,66 @@ void SceneState::renderNode(RenderBSPNode& rNode)
 
       dQsort(imageList.address(), imageList.size(), sizeof(SceneRenderImage*), cmpPointImageFunc);
 
-      for (U32 i = 0; i < imageList.size(); i++)
+      // Neighbours in the sort that batch together are drawn together,
+      //  which keeps them in order.
+      for (U32 i = 0; i < imageList.size(); )
       {
-         renderImage(this, imageList[i]);
+         SceneRenderImage* image = imageList[i];
+         U32 end = i + 1;
+         if (image->batchKey != 0)
+         {
+            AbstractClassRep* rep = image->obj->getClassRep();
+            while (end < imageList.size() &&
+                   imageList[end]->batchKey == image->batchKey &&
+                   imageList[end]->obj->getClassRep() == rep)
+               end++;
+         }
+
+         if (end - i > 1)
+            renderImageBatch(this, &imageList[i], end - i, false);
+         else
+            renderImage(this, image);
+         i = end;
       }
    }
 }
 
 
+void SceneState::skinRenderImages()
+{
+   PROFILE_START(SceneStateSkinRenderImages);
+
+   static Vector<TSShapeInstance*> instances(__FILE__, __LINE__);
+   instances.clear();
+
+   for (U32 i = 0; i < mRenderImages.size(); i++)
+   {
+      SceneObject* obj = mRenderImages[i]->obj;
+      TSShapeInstance* si = obj->getRenderShapeInstance();
+      if (si == NULL || !si->hasSkinMeshes())
+         continue;
+      if (mOcclusionCull && OcclusionCuller::isCandidate(obj) &&
+          OcclusionCuller::testObject(obj, mCamPosition))
+         continue;
+      if (DetailManager::selectCurrentDetail(si))
+         instances.push_back(si);
+   }
+
+   TSShapeInstance::skinInstances(instances.address(), instances.size());
+
+   PROFILE_END();
+}
+
 void SceneState::renderCurrentImages()
 {
    sortRenderImages();
    buildTranslucentBSP();
 
+   // Skin the characters on the thread pool up front, so drawing them
+   //  below only has to pick up the results.
+   if (TSShapeInstance::isParallelSkinning())
+      skinRenderImages();
+
    if (mPortalOwner != NULL) 
    {
       // If we're a portalized object, we need to setup a user clip plane...
@@ -465,9 +755,44 @@ void SceneState::renderCurrentImages()
    glPushMatrix();
    dglLoadMatrix(&mModelview);
 
+   // The billboards of the opaque images go in the atlas batches,
+   //  drawn a page at a time once the images are done.
+   TSImpostorAtlas::beginBatch();
+
    U32 i;
-   for (i = 0; i < mRenderImages.size(); i++)
-      renderImage(this, mRenderImages[i]);
+   for (i = 0; i < mRenderImages.size(); )
+   {
+      SceneRenderImage* image = mRenderImages[i];
+
+      // The sort has already brought images with the same batch key together.
+      U32 end = i + 1;
+      if (image->batchKey != 0)
+      {
+         AbstractClassRep* rep = image->obj->getClassRep();
+         while (end < mRenderImages.size() &&
+                mRenderImages[end]->batchKey == image->batchKey &&
+                mRenderImages[end]->sortType == image->sortType &&
+                mRenderImages[end]->obj->getClassRep() == rep)
+            end++;
+      }
+
+      if (end - i > 1)
+         renderImageBatch(this, &mRenderImages[i], end - i);
+      else
+      {
+         if (mOcclusionCull && OcclusionCuller::isCandidate(image->obj))
+            OcclusionCuller::testObject(image->obj, mCamPosition);
+         renderImage(this, image);
+      }
+      i = end;
+   }
+
+   TSImpostorAtlas::endBatch();
+
+   // Everything opaque is in the depth buffer now, so test the boxes
+   //  against it for next frame.
+   if (mOcclusionCull)
+      OcclusionCuller::issueQueries();
 
    for (i = 0; i < mTranslucentBeginImages.size(); i++)
       renderImage(this, mTranslucentBeginImages[i]);
@@ -557,21 +882,6 @@ bool SceneState::isObjectRendered(const SceneObject* obj)
    // Don't bother if it's globally bounded.
    const SceneObjectRef* pWalk = obj->mZoneRefHead;
 
-   static F32 darkToOGLCoord[16] = { 1, 0,  0, 0,
-                                     0, 0, -1, 0,
-                                     0, 1,  0, 0,
-                                     0, 0,  0, 1 };
-   static MatrixF darkToOGLMatrix;
-   static bool matrixInitialized = false;
-   if (matrixInitialized == false)
-   {
-      F32* m = darkToOGLMatrix;
-      for (U32 i = 0; i < 16; i++)
-         m[i] = darkToOGLCoord[i];
-      darkToOGLMatrix.transpose();
-      matrixInitialized = true;
-   }
-
    while (pWalk != NULL) 
    {
       if (getZoneState(pWalk->zone).render == true)
@@ -585,6 +895,21 @@ bool SceneState::isObjectRendered(const SceneObject* obj)
          if(obj->isGlobalBounds())
             return true;
 
+         // The batch result for the outside zone settles the boxes that
+         //  are clear of every plane; only those that cross one need the
+         //  exact test.
+         S32 batch;
+         if (pWalk->zone == 0 && BoxCuller::getResult(this, obj->mCullSlot, batch))
+         {
+            if (batch == 0)
+               return true;
+            if (batch == -1)
+            {
+               pWalk = pWalk->nextInObj;
+               continue;
+            }
+         }
+
          const Box3F& rObjBox = obj->getObjBox();
          const Point3F& rScale = obj->getScale();
 
@@ -27,6 +27,9 @@
 #ifndef _GTEXMANAGER_H_
 #include "dgl/gTexManager.h"
 #endif
+#ifndef _PLATFORMTHREAD_H_
+#include "platform/platformThread.h"
+#endif
 
 class SceneObject;
 
@@ -74,13 +77,32 @@ class SceneRenderImage
         isTranslucent(false),
         tieBreaker(false),
         useSmallTextures(false),
-        textureSortKey(0)
+        textureSortKey(0),
+        batchKey(0)
    {
       //
    }
 
    virtual ~SceneRenderImage();
 
+   /// Images come from SceneState::newRenderImage() and are released with
+   /// the frame, never one at a time.
+   static void operator delete(void*) {}
+
+   /// Only placement, so a plain new of an image, which nothing would ever
+   /// free, doesn't build.
+#if !defined(TORQUE_DISABLE_MEMORY_MANAGER)
+#  undef new
+#endif
+   static void* operator new(dsize_t, void* ptr) { return ptr; }
+  private:
+   static void* operator new(dsize_t size);
+   static void* operator new(dsize_t size, const char*, const U32);
+  public:
+#if !defined(TORQUE_DISABLE_MEMORY_MANAGER)
+#  define new new(__FILE__, __LINE__)
+#endif
+
    SceneObject* obj;             ///< The SceneObject this image represents.
 
    bool     isTranslucent;       ///< Is this image translucent?
@@ -97,7 +119,14 @@ class SceneRenderImage
                                  /// @note This is set inside SceneState.
 
    U32 textureSortKey;           ///< This is used to sort objects of the same SortType into order if the objects have
-                                 ///  no translucency.
+                                 ///  no translucency.  Images with the same key are drawn together, so it should
+                                 ///  identify the material or texture set, e.g. a shape or skin hash.
+
+   U32 batchKey;                 ///< If non-zero, adjacent opaque images with the same key and object class are
+                                 ///  handed to SceneObject::renderObjectBatch() together.  It should only be set
+                                 ///  along with an equal textureSortKey, so the sort brings the images together.
+                                 ///  Translucent SortType::Point images that end up next to each other in the
+                                 ///  depth sort are batched the same way.
 
    /// Linked list implementation.
    ///
@@ -110,6 +139,25 @@ class SceneRenderImage
 //
 
 struct FogVolume;
+class TSShapeInstance;
+
+/// What one worker gathers during a parallel prepRenderImage pass.
+///
+/// Render images and DetailManager selections made off the main thread
+/// land here instead of in the SceneState, and are merged back in order
+/// before the images are sorted.  @see SceneGraph::prepObjectsParallel
+struct ScenePrepCollector
+{
+   struct DetailSelection
+   {
+      TSShapeInstance* shape;
+      F32              dist;
+      F32              invScale;
+   };
+
+   Vector<SceneRenderImage*> images;
+   Vector<DetailSelection>   details;
+};
 
 /// The SceneState describes the state of the scene being rendered. It keeps track
 /// of the information that objects need to render properly with regard to the
@@ -245,6 +293,10 @@ class SceneState
    /// Returns true if terrain is allowed to be drawn inside interiors.
    bool isTerrainOverridden() const;
 
+   /// Returns true if shapes in this state are skipped when OcclusionCuller
+   /// finds them hidden.
+   bool isOcclusionCulling() const { return mOcclusionCull; }
+
    /// Sorts the list of images, builds the translucency BSP tree,
    /// sets up the portal, then renders all images in the state.
    void renderCurrentImages();
@@ -255,6 +307,45 @@ class SceneState
    /// @param   obj   Object in question.
    bool isObjectRendered(const SceneObject *obj);
 
+   /// @name Parallel Prep
+   ///
+   /// While smCollecting is set, insertRenderImage() and
+   /// DetailManager::selectPotentialDetails() called from a thread with a
+   /// collector go to that collector.
+   /// @{
+
+   static bool          smCollecting;
+   static ThreadStorage smCollector;
+
+   static ScenePrepCollector* getPrepCollector()
+   {
+      return smCollecting ? (ScenePrepCollector*)smCollector.get() : NULL;
+   }
+   /// @}
+
+   /// @name Render Image Pool
+   ///
+   /// Render images only live until the root SceneState goes away, so they
+   /// come from per thread bump allocators that are all rewound then rather
+   /// than from the heap.  Images are never destructed, so subclasses must
+   /// not own anything.
+   /// @{
+
+   /// Use this instead of new for SceneRenderImage and its subclasses.
+   template<class T> static T* newRenderImage()
+   {
+      return constructInPlace((T*)allocRenderImage(sizeof(T)));
+   }
+   static void* allocRenderImage(U32 size);
+
+   /// Frees the pools' memory at shutdown.
+   static void destroyRenderImagePools();
+
+   /// Builds the per zone data isObjectRendered() otherwise fills in
+   /// lazily, so that it can be called from several threads at once.
+   void prepareParallelQueries();
+   /// @}
+
    /// Sets the viewport and projection up for the given zone.
    ///
    /// @param   zone   Zone for which we want to set up a viewport/projection.
@@ -351,6 +442,10 @@ class SceneState
    /// Builds the BSP tree of translucent images.
    void buildTranslucentBSP();
 
+   /// Skins the shape instances of the opaque images on the thread pool.
+   /// @see TSShapeInstance::skinInstances
+   void skinRenderImages();
+
    /// Inserts a translucent image into the translucent BSP tree.
    ///
    /// @param   rNode    Root node.
@@ -398,6 +493,8 @@ class SceneState
 
    TextureHandle mEnvironmentMap;                     ///< Current environment map
 
+   bool mOcclusionCull;                               ///< Set by SceneGraph on the base state when OcclusionCuller is active
+
   public:
    bool    mFlipCull;                                 ///< If true the portal clipping plane will be reversed
    MatrixF mModelview;                                ///< Modelview matrix this scene is based off of
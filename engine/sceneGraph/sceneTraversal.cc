@@ -11,6 +11,10 @@
 #include "dgl/dgl.h"
 #include "core/polyList.h"
 #include "terrain/terrData.h"
+#include "sceneGraph/detailManager.h"
+#include "core/threadPool.h"
+#include "sceneGraph/boxCuller.h"
+#include "platform/profiler.h"
 
 namespace {
 
@@ -211,9 +215,19 @@ void SceneGraph::buildSceneTree(SceneState*  state,
    for (i = 0; i < prl.mList.size(); i++)
       prl.mList[i]->setTraversalState( SceneObject::Pending );
 
+   // Zone managers are visited in order here since they decide what the
+   //  rest can see.  Plain objects may be put aside and prepped afterwards,
+   //  batch culled and on the thread pool, once the zone states are final.
+   bool parallel = smParallelPrep && gThreadPool && gThreadPool->isThreaded();
+   bool defer = parallel || BoxCuller::smEnabled;
+   Vector<SceneObject*> deferred;
+
    for (i = 0; i < prl.mList.size(); i++)
       if( prl.mList[i]->getTraversalState() == SceneObject::Pending )
-         treeTraverseVisit(prl.mList[i], state, smStateKey);
+         treeTraverseVisit(prl.mList[i], state, smStateKey, defer ? &deferred : NULL);
+
+   if (deferred.size() != 0)
+      prepDeferredObjects(deferred, state, smStateKey, parallel);
 
    if (currDepth < csmMaxTraversalDepth && state->mTransformPortals.size() != 0) 
    {
@@ -307,9 +321,10 @@ bool terrCheck(TerrainBlock* pBlock,
                SceneObject*  pObj,
                const Point3F camPos);
 
-void SceneGraph::treeTraverseVisit(SceneObject* obj,
-                                   SceneState*  state,
-                                   const U32    stateKey)
+void SceneGraph::treeTraverseVisit(SceneObject*          obj,
+                                   SceneState*           state,
+                                   const U32             stateKey,
+                                   Vector<SceneObject*>* deferred)
 {
    if (obj->getNumCurrZones() == 0) 
    {
@@ -328,13 +343,26 @@ void SceneGraph::treeTraverseVisit(SceneObject* obj,
       // Determine who owns this zone...
       SceneObject* pOwner = getZoneOwner(pWalk->zone);
       if( pOwner->getTraversalState() == SceneObject::Pending )
-         treeTraverseVisit(pOwner, state, stateKey);
+         treeTraverseVisit(pOwner, state, stateKey, deferred);
 
       pWalk = pWalk->nextInObj;
    }
 
    obj->setTraversalState( SceneObject::Done );//obj->setTraverseColor(SceneObject::Black);
 
+   if (deferred != NULL && obj->isParallelPrepSafe())
+   {
+      deferred->push_back(obj);
+      return;
+   }
+
+   prepVisibleObject(obj, state, stateKey);
+}
+
+void SceneGraph::prepVisibleObject(SceneObject* obj,
+                                   SceneState*  state,
+                                   const U32    stateKey)
+{
    // Cull it, but not if it's too low or there's no terrain to occlude against, or if it's global...
    if (getCurrentTerrain() != NULL && obj->getWorldBox().min.x > -1e5 && !obj->isGlobalBounds())
    {
@@ -357,6 +385,108 @@ void SceneGraph::treeTraverseVisit(SceneObject* obj,
    obj->prepRenderImage(state, stateKey, 0xFFFFFFFF);
 }
 
+namespace {
+
+struct PrepBatchInfo
+{
+   SceneGraph*         graph;
+   SceneState*         state;
+   U32                 stateKey;
+   SceneObject**       objects;
+   U32                 numObjects;
+   U32                 batchSize;
+   ScenePrepCollector* collectors;   ///< One per batch.
+};
+
+} // namespace {}
+
+void SceneGraph::prepObjectBatches(U32 start, U32 end, void* userData)
+{
+   PrepBatchInfo* info = (PrepBatchInfo*)userData;
+
+   for (U32 b = start; b < end; b++)
+   {
+      SceneState::smCollector.set(&info->collectors[b]);
+
+      U32 first = b * info->batchSize;
+      U32 last  = getMin(first + info->batchSize, info->numObjects);
+      for (U32 i = first; i < last; i++)
+         info->graph->prepVisibleObject(info->objects[i], info->state, info->stateKey);
+
+      SceneState::smCollector.set(NULL);
+   }
+}
+
+void SceneGraph::prepDeferredObjects(Vector<SceneObject*>& objects,
+                                     SceneState*           state,
+                                     const U32             stateKey,
+                                     bool                  parallel)
+{
+   // From here on isObjectRendered() only reads the zone states.
+   state->prepareParallelQueries();
+
+   // Most objects are outside, so one pass over all the boxes against the
+   //  outside zone answers isObjectRendered() for the bulk of them.
+   const SceneState::ZoneState& outside = state->getZoneState(0);
+   if (outside.render)
+      BoxCuller::cullObjects(state, outside.clipPlanes, 5);
+
+   if (parallel && objects.size() >= U32(getMax(smParallelPrepMinObjects, 1)))
+      prepObjectsParallel(objects, state, stateKey);
+   else
+   {
+      for (U32 i = 0; i < objects.size(); i++)
+         prepVisibleObject(objects[i], state, stateKey);
+   }
+
+   BoxCuller::clearResults();
+}
+
+void SceneGraph::prepObjectsParallel(Vector<SceneObject*>& objects,
+                                     SceneState*           state,
+                                     const U32             stateKey)
+{
+   PROFILE_START(PrepObjectsParallel);
+
+   // A few batches per thread, each with its own collector so the merge
+   //  keeps the serial insertion order.
+   U32 numBatches = getMin((gThreadPool->getNumThreads() + 1) * 4, U32(objects.size()));
+   Vector<ScenePrepCollector> collectors;
+   collectors.setSize(numBatches);
+   for (U32 i = 0; i < numBatches; i++)
+      constructInPlace(&collectors[i]);
+
+   PrepBatchInfo info;
+   info.graph      = this;
+   info.state      = state;
+   info.stateKey   = stateKey;
+   info.objects    = objects.address();
+   info.numObjects = objects.size();
+   info.batchSize  = (objects.size() + numBatches - 1) / numBatches;
+   info.collectors = collectors.address();
+
+   SceneState::smCollecting = true;
+   gThreadPool->parallelFor(numBatches, prepObjectBatches, &info);
+   SceneState::smCollecting = false;
+
+   PROFILE_START(PrepObjectsMerge);
+   for (U32 i = 0; i < numBatches; i++)
+   {
+      ScenePrepCollector& collector = collectors[i];
+      for (U32 j = 0; j < collector.details.size(); j++)
+      {
+         const ScenePrepCollector::DetailSelection& sel = collector.details[j];
+         DetailManager::selectPotentialDetails(sel.shape, sel.dist, sel.invScale);
+      }
+      for (U32 j = 0; j < collector.images.size(); j++)
+         state->insertRenderImage(collector.images[j]);
+      destructInPlace(&collector);
+   }
+   PROFILE_END();
+
+   PROFILE_END();
+}
+
 bool terrCheck(TerrainBlock* pBlock,
                SceneObject*  pObj,
                const Point3F camPos)
@@ -6,12 +6,23 @@
 #include "sceneGraph/shadowVolumeBSP.h"
 #include "math/mPlane.h"
 
+// Same test as in the extruded poly list: SSE1 only, built wherever the
+// compiler knows it and used when the CPU has it.
+#if defined(TORQUE_CPU_X86) && (defined(TORQUE_COMPILER_VISUALC) || defined(__SSE__))
+#  define SHADOW_VOLUME_BSP_USE_SSE
+#  include <xmmintrin.h>
+#endif
+
 ShadowVolumeBSP::ShadowVolumeBSP() :
    mSVRoot(0),
    mNodeStore(0),
    mPolyStore(0),
    mFirstInteriorNode(0)
 {
+   mUseSSE = false;
+#if defined(SHADOW_VOLUME_BSP_USE_SSE)
+   mUseSSE = (Platform::SystemInfo.processor.properties & CPU_PROP_SSE) != 0;
+#endif
 }
 
 ShadowVolumeBSP::~ShadowVolumeBSP()
@@ -20,6 +31,33 @@ ShadowVolumeBSP::~ShadowVolumeBSP()
       delete mSurfaces[i];
 }
 
+void ShadowVolumeBSP::reset()
+{
+   for(U32 i = 0; i < mSurfaces.size(); i++)
+      delete mSurfaces[i];
+   mSurfaces.clear();
+
+   mPlanes.clear();
+   mShadowVolumes.clear();
+   mParentNodes.clear();
+
+   // every node and poly goes at once, the chunkers keep their blocks
+   mNodeChunker.reset();
+   mPolyChunker.reset();
+   mNodeStore = 0;
+   mPolyStore = 0;
+
+   mSVRoot = 0;
+   mFirstInteriorNode = 0;
+}
+
+void ShadowVolumeBSP::initQueryCopy(const ShadowVolumeBSP & src)
+{
+   AssertFatal(!mSVRoot && !mSurfaces.size(), "ShadowVolumeBSP::initQueryCopy - not empty");
+   mPlanes = src.mPlanes;
+   mSVRoot = src.mSVRoot;
+}
+
 void ShadowVolumeBSP::insertShadowVolume(SVNode ** root, U32 volume)
 {
    SVNode * traverse = mShadowVolumes[volume];
@@ -39,25 +77,55 @@ void ShadowVolumeBSP::insertShadowVolume(SVNode ** root, U32 volume)
    }
 }
 
-ShadowVolumeBSP::SVNode::Side ShadowVolumeBSP::whichSide(SVPoly * poly, const PlaneF & plane) const
+U32 ShadowVolumeBSP::classifyWinding(const SVPoly * poly, const PlaneF & plane, U32 * backMask) const
 {
-   bool front = false;
-   bool back = false;
+   U32 count = poly->mWindingCount;
+   U32 front = 0;
+   U32 back = 0;
 
-   for(U32 i = 0; i < poly->mWindingCount; i++)
+#if defined(SHADOW_VOLUME_BSP_USE_SSE)
+   if(mUseSSE)
+   {
+      // Four points per compare, with the same sums in the same order
+      // as PlaneF::distToPlane().  The winding is always MaxWinding long,
+      // so the points past the count are read and masked off.
+      const __m128 px = _mm_set1_ps(plane.x);
+      const __m128 py = _mm_set1_ps(plane.y);
+      const __m128 pz = _mm_set1_ps(plane.z);
+      const __m128 pd = _mm_set1_ps(plane.d);
+      const __m128 onFront = _mm_set1_ps(0.005f);
+      const __m128 onBack = _mm_set1_ps(-0.005f);
+      for(U32 i = 0; i < count; i += 4)
+      {
+         const Point3F * w = &poly->mWinding[i];
+         __m128 wx = _mm_set_ps(w[3].x, w[2].x, w[1].x, w[0].x);
+         __m128 wy = _mm_set_ps(w[3].y, w[2].y, w[1].y, w[0].y);
+         __m128 wz = _mm_set_ps(w[3].z, w[2].z, w[1].z, w[0].z);
+         __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+                          _mm_mul_ps(px, wx),
+                          _mm_mul_ps(py, wy)),
+                          _mm_mul_ps(pz, wz)),
+                          pd);
+         front |= U32(_mm_movemask_ps(_mm_cmpge_ps(dist, onFront))) << i;
+         back |= U32(_mm_movemask_ps(_mm_cmple_ps(dist, onBack))) << i;
+      }
+
+      U32 mask = (count < 32) ? (U32(1) << count) - 1 : U32(-1);
+      *backMask = back & mask;
+      return(front & mask);
+   }
+#endif
+
+   for(U32 i = 0; i < count; i++)
    {
       switch(plane.whichSide(poly->mWinding[i]))
       {
          case PlaneF::Front:
-            if(back)
-               return(SVNode::Split);
-            front = true;
+            front |= U32(1) << i;
             break;
 
          case PlaneF::Back:
-            if(front)
-               return(SVNode::Split);
-            back = true;
+            back |= U32(1) << i;
             break;
 
          default:
@@ -65,7 +133,17 @@ ShadowVolumeBSP::SVNode::Side ShadowVolumeBSP::whichSide(SVPoly * poly, const Pl
       }
    }
 
-   AssertFatal(!(front && back), "ShadowVolumeBSP::whichSide - failed to classify poly");
+   *backMask = back;
+   return(front);
+}
+
+ShadowVolumeBSP::SVNode::Side ShadowVolumeBSP::whichSide(SVPoly * poly, const PlaneF & plane) const
+{
+   U32 back;
+   U32 front = classifyWinding(poly, plane, &back);
+
+   if(front && back)
+      return(SVNode::Split);
 
    if(!front && !back)
       return(SVNode::On);
@@ -77,9 +155,19 @@ void ShadowVolumeBSP::splitPoly(SVPoly * poly, const PlaneF & plane, SVPoly ** f
 {
    PlaneF::Side sides[SVPoly::MaxWinding];
 
+   U32 backMask;
+   U32 frontMask = classifyWinding(poly, plane, &backMask);
+
    U32 i;
    for(i = 0; i < poly->mWindingCount; i++)
-      sides[i] = plane.whichSide(poly->mWinding[i]);
+   {
+      if(frontMask & (U32(1) << i))
+         sides[i] = PlaneF::Front;
+      else if(backMask & (U32(1) << i))
+         sides[i] = PlaneF::Back;
+      else
+         sides[i] = PlaneF::On;
+   }
 
    // create the polys
    (*front) = createPoly();
@@ -297,14 +385,14 @@ ShadowVolumeBSP::SVPoly * ShadowVolumeBSP::createPoly()
 
 void ShadowVolumeBSP::recyclePoly(SVPoly * poly)
 {
-   if(!poly)
-      return;
-
-   recyclePoly(poly->mNext);
-
-   //
-   poly->mNext = mPolyStore;
-   mPolyStore = poly;
+   // walk the list rather than recursing, clipped lists get long
+   while(poly)
+   {
+      SVPoly * next = poly->mNext;
+      poly->mNext = mPolyStore;
+      mPolyStore = poly;
+      poly = next;
+   }
 }
 
 U32 ShadowVolumeBSP::insertPlane(const PlaneF & plane)
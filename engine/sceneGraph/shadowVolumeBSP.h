@@ -85,6 +85,12 @@ class ShadowVolumeBSP
 
       SVNode::Side whichSide(SVPoly *, const PlaneF &) const;
 
+      /// Classify every point of the winding against the plane, as
+      /// PlaneF::whichSide() does.  Returns a bit per point in front,
+      /// and those behind in backMask; points on the plane are in neither.
+      U32 classifyWinding(const SVPoly *, const PlaneF &, U32 * backMask) const;
+      bool  mUseSSE;
+
       //
       bool testPoint(SVNode *, const Point3F &);
       bool testPoly(SVNode *, SVPoly *);
@@ -137,6 +143,16 @@ class ShadowVolumeBSP
       void buildPolyVolume(SVPoly *, LightInfo *);
       SVPoly * copyPoly(SVPoly *);
       /// @}
+
+      /// Empty the tree for the next light.  The node and poly memory is
+      /// kept, so building again doesn't allocate.
+      void reset();
+
+      /// Set this one up to clip polys against src's tree from another
+      /// thread.  It gets its own planes and poly store and shares src's
+      /// nodes, which must not change while it's in use; the polys it clips
+      /// have to come from its own createPoly().
+      void initQueryCopy(const ShadowVolumeBSP & src);
 };
 
 #endif
@@ -0,0 +1,302 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "sceneGraph/visibilityQuery.h"
+#include "sceneGraph/sceneState.h"
+#include "sim/sceneObject.h"
+#include "dgl/dgl.h"
+#include "dgl/gTexManager.h"
+#include "platform/profiler.h"
+
+Vector<VisibilityQuery*> VisibilityQuery::smAll;
+Vector<VisibilityQuery*> VisibilityQuery::smQueue;
+U32 VisibilityQuery::smTextureCallbackKey = U32(-1);
+
+bool VisibilityQuery::smUseOcclusionQueries = false;
+S32  VisibilityQuery::smNumRays = 0;
+S32  VisibilityQuery::smNumQueries = 0;
+
+//--------------------------------------------------------------------------
+VisibilityQuery::VisibilityQuery()
+{
+   mStart.set(0, 0, 0);
+   mEnd.set(0, 0, 0);
+   mMask = 0;
+   mRadius = 0.0f;
+   mQueued = false;
+   mVisible = true;
+   mQuery = 0;
+   mQueryPending = false;
+   mQueryResult = false;
+
+   smAll.push_back(this);
+}
+
+VisibilityQuery::~VisibilityQuery()
+{
+   if (mQueued)
+   {
+      for (U32 i = 0; i < smQueue.size(); i++)
+         if (smQueue[i] == this)
+         {
+            smQueue.erase(i);
+            break;
+         }
+   }
+   if (mQuery != 0)
+      glDeleteQueriesARB(1, &mQuery);
+
+   for (U32 i = 0; i < smAll.size(); i++)
+      if (smAll[i] == this)
+      {
+         smAll.erase_fast(i);
+         break;
+      }
+}
+
+void VisibilityQuery::request(const Point3F& start, const Point3F& end, U32 mask,
+                              SceneObject* ignore, F32 radius)
+{
+   mStart  = start;
+   mEnd    = end;
+   mMask   = mask;
+   mIgnore = ignore;
+   mRadius = radius;
+
+   if (!mQueued)
+   {
+      mQueued = true;
+      smQueue.push_back(this);
+   }
+}
+
+//--------------------------------------------------------------------------
+void VisibilityQuery::init()
+{
+   smTextureCallbackKey = TextureManager::registerEventCallback(textureEvent, NULL);
+}
+
+void VisibilityQuery::destroy()
+{
+   if (smTextureCallbackKey != U32(-1))
+   {
+      TextureManager::unregisterEventCallback(smTextureCallbackKey);
+      smTextureCallbackKey = U32(-1);
+   }
+   deleteQueries();
+   for (U32 i = 0; i < smQueue.size(); i++)
+      smQueue[i]->mQueued = false;
+   smQueue.clear();
+}
+
+void VisibilityQuery::textureEvent(const U32 eventCode, void*)
+{
+   // The GL context goes away with the textures.
+   if (eventCode == TextureManager::BeginZombification)
+      deleteQueries();
+}
+
+void VisibilityQuery::deleteQueries()
+{
+   for (U32 i = 0; i < smAll.size(); i++)
+   {
+      VisibilityQuery* q = smAll[i];
+      if (q->mQuery != 0)
+         glDeleteQueriesARB(1, &q->mQuery);
+      q->mQuery = 0;
+      q->mQueryPending = false;
+      q->mQueryResult = false;
+   }
+}
+
+//--------------------------------------------------------------------------
+S32 VisibilityQuery::compareRequests(const void* a, const void* b)
+{
+   const VisibilityQuery* qa = *(const VisibilityQuery**) a;
+   const VisibilityQuery* qb = *(const VisibilityQuery**) b;
+
+   // Grouped by what they ignore and their mask, so each group is one
+   //  batch, then by the ray so duplicates end up together.
+   const SceneObject* ia = qa->mIgnore;
+   const SceneObject* ib = qb->mIgnore;
+   if (ia != ib)
+      return ia < ib ? -1 : 1;
+   if (qa->mMask != qb->mMask)
+      return qa->mMask < qb->mMask ? -1 : 1;
+   S32 cmp = dMemcmp(&qa->mStart, &qb->mStart, sizeof(Point3F));
+   if (cmp == 0)
+      cmp = dMemcmp(&qa->mEnd, &qb->mEnd, sizeof(Point3F));
+   return cmp;
+}
+
+void VisibilityQuery::castRays(U32 first, U32 end)
+{
+   static Vector<RayQuery> rays;
+   static Vector<RayInfo>  hits;
+
+   rays.clear();
+   for (U32 i = first; i < end; i++)
+      if (i == first || compareRequests(&smQueue[i - 1], &smQueue[i]) != 0)
+      {
+         rays.increment();
+         rays.last().start = smQueue[i]->mStart;
+         rays.last().end   = smQueue[i]->mEnd;
+      }
+
+   hits.setSize(rays.size());
+   for (U32 i = 0; i < hits.size(); i++)
+      constructInPlace(&hits[i]);
+
+   SceneObject* ignore = smQueue[first]->mIgnore;
+   if (ignore)
+      ignore->disableCollision();
+   gClientContainer.castRays(rays.address(), rays.size(), smQueue[first]->mMask, hits.address());
+   if (ignore)
+      ignore->enableCollision();
+
+   S32 ray = -1;
+   for (U32 i = first; i < end; i++)
+   {
+      if (i == first || compareRequests(&smQueue[i - 1], &smQueue[i]) != 0)
+         ray++;
+      smQueue[i]->mVisible = (hits[ray].object == NULL);
+   }
+   smNumRays += rays.size();
+}
+
+void VisibilityQuery::issueQueries(SceneState* state)
+{
+   bool any = false;
+   for (U32 i = 0; i < smQueue.size() && !any; i++)
+      any = smQueue[i]->mRadius > 0.0f;
+   if (!any)
+      return;
+
+   PROFILE_START(VisibilityQuery_IssueQueries);
+
+   // Squares facing the camera.
+   MatrixF modelview;
+   dglGetModelview(&modelview);
+   Point3F right, up;
+   modelview.getRow(0, &right);
+   modelview.getRow(1, &up);
+
+   RectI viewport;
+   dglGetViewport(&viewport);
+   glMatrixMode(GL_PROJECTION);
+   glPushMatrix();
+   state->setupBaseProjection();
+   glMatrixMode(GL_MODELVIEW);
+
+   glPushAttrib(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_ENABLE_BIT | GL_POLYGON_BIT);
+   glDisable(GL_TEXTURE_2D);
+   glDisable(GL_BLEND);
+   glDisable(GL_ALPHA_TEST);
+   glDisable(GL_LIGHTING);
+   glDisable(GL_FOG);
+   glDisable(GL_CULL_FACE);
+   glEnable(GL_DEPTH_TEST);
+   glDepthFunc(GL_LEQUAL);
+   glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+   glDepthMask(GL_FALSE);
+
+   U32 keep = 0;
+   for (U32 i = 0; i < smQueue.size(); i++)
+   {
+      VisibilityQuery* q = smQueue[i];
+      if (q->mRadius <= 0.0f)
+      {
+         smQueue[keep++] = q;
+         continue;
+      }
+
+      // Pick up the last result if it's there, never wait for it.
+      if (q->mQueryPending)
+      {
+         GLint available = 0;
+         glGetQueryObjectivARB(q->mQuery, GL_QUERY_RESULT_AVAILABLE_ARB, &available);
+         if (available)
+         {
+            GLuint samples = 0;
+            glGetQueryObjectuivARB(q->mQuery, GL_QUERY_RESULT_ARB, &samples);
+            q->mVisible = (samples != 0);
+            q->mQueryPending = false;
+            q->mQueryResult = true;
+         }
+      }
+
+      if (!q->mQueryPending)
+      {
+         if (q->mQuery == 0)
+            glGenQueriesARB(1, &q->mQuery);
+
+         Point3F r = right * q->mRadius;
+         Point3F u = up * q->mRadius;
+         glBeginQueryARB(GL_SAMPLES_PASSED_ARB, q->mQuery);
+         glBegin(GL_QUADS);
+            glVertex3fv(q->mEnd - r - u);
+            glVertex3fv(q->mEnd + r - u);
+            glVertex3fv(q->mEnd + r + u);
+            glVertex3fv(q->mEnd - r + u);
+         glEnd();
+         glEndQueryARB(GL_SAMPLES_PASSED_ARB);
+         q->mQueryPending = true;
+         smNumQueries++;
+      }
+
+      // Until the first result is in the ray answers.
+      if (q->mQueryResult)
+         q->mQueued = false;
+      else
+         smQueue[keep++] = q;
+   }
+   smQueue.setSize(keep);
+
+   glPopAttrib();
+
+   glMatrixMode(GL_PROJECTION);
+   glPopMatrix();
+   glMatrixMode(GL_MODELVIEW);
+   dglSetViewport(viewport);
+
+   PROFILE_END();
+}
+
+//--------------------------------------------------------------------------
+void VisibilityQuery::resolveAll(SceneState* state)
+{
+   smNumRays = 0;
+   smNumQueries = 0;
+   if (smQueue.size() == 0)
+      return;
+
+   PROFILE_START(VisibilityQuery_Resolve);
+
+   if (smUseOcclusionQueries && dglDoesSupportOcclusionQuery())
+      issueQueries(state);
+
+   if (smQueue.size() != 0)
+   {
+      dQsort(smQueue.address(), smQueue.size(), sizeof(VisibilityQuery*), compareRequests);
+
+      U32 first = 0;
+      for (U32 i = 1; i <= smQueue.size(); i++)
+      {
+         if (i < smQueue.size() &&
+             (SceneObject*) smQueue[i]->mIgnore == (SceneObject*) smQueue[first]->mIgnore &&
+             smQueue[i]->mMask == smQueue[first]->mMask)
+            continue;
+
+         castRays(first, i);
+         first = i;
+      }
+
+      for (U32 i = 0; i < smQueue.size(); i++)
+         smQueue[i]->mQueued = false;
+      smQueue.clear();
+   }
+
+   PROFILE_END();
+}
@@ -0,0 +1,101 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _VISIBILITYQUERY_H_
+#define _VISIBILITYQUERY_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _MPOINT_H_
+#include "math/mPoint.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+#ifndef _SIMBASE_H_
+#include "console/simBase.h"
+#endif
+
+class SceneObject;
+class SceneState;
+
+/// A line of sight test for render side effects, like flares, resolved
+/// along with everyone else's once the frame is drawn.
+///
+/// The owner keeps one of these and calls request() while rendering, and
+/// reads isVisible(), which is the answer to the request of the previous
+/// frame.  Once the scene is drawn SceneGraph::renderScene() calls
+/// resolveAll(), which casts the rays of the frame through
+/// Container::castRays(), one batch per mask and ignored object.  Identical
+/// requests share a ray.
+///
+/// With $pref::VisibilityQuery::occlusionQueries on, and ARB_occlusion_query
+/// supported, requests that give a radius are instead tested by drawing a
+/// square of that radius at the end point against the depth buffer.  Those
+/// results are picked up when the GPU has them, never waited on, and the
+/// ray is only used until the first one comes in.
+class VisibilityQuery
+{
+   Point3F mStart;
+   Point3F mEnd;
+   U32     mMask;
+   F32     mRadius;
+   SimObjectPtr<SceneObject> mIgnore;
+
+   bool mQueued;        ///< Requested this frame.
+   bool mVisible;
+
+   /// @name Occlusion query
+   /// @{
+   U32  mQuery;         ///< GL query object, 0 if none yet.
+   bool mQueryPending;  ///< Issued and its result not read yet.
+   bool mQueryResult;   ///< A query result has come back.
+   /// @}
+
+   static Vector<VisibilityQuery*> smAll;
+   static Vector<VisibilityQuery*> smQueue;
+   static U32 smTextureCallbackKey;
+
+   static S32  compareRequests(const void* a, const void* b);
+   static void castRays(U32 first, U32 end);
+   static void issueQueries(SceneState* state);
+   static void deleteQueries();
+   static void textureEvent(const U32 eventCode, void* userData);
+
+  public:
+   /// $pref::VisibilityQuery::occlusionQueries
+   static bool smUseOcclusionQueries;
+   /// $VisibilityQuery::numRays and numQueries, for the last frame.
+   static S32  smNumRays;
+   static S32  smNumQueries;
+
+   VisibilityQuery();
+   ~VisibilityQuery();
+
+   /// Asks whether end can be seen from start for this frame.
+   ///
+   /// @param   start    Usually the eye.
+   /// @param   end      What's looked at.
+   /// @param   mask     Object types that block the view.
+   /// @param   ignore   Object that doesn't block the view, like the
+   ///                  control object in first person.
+   /// @param   radius   World size of what's looked at, for an occlusion
+   ///                  query; 0 always uses a ray.
+   void request(const Point3F& start, const Point3F& end, U32 mask,
+                SceneObject* ignore = NULL, F32 radius = 0.0f);
+
+   /// The last answer in; true until there is one.
+   bool isVisible() const { return mVisible; }
+
+   static void init();
+   static void destroy();
+
+   /// Answers the requests of this frame.  Called once the scene of state
+   /// is drawn, with its modelview loaded.
+   static void resolveAll(SceneState* state);
+};
+
+#endif
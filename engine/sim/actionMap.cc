@@ -43,6 +43,9 @@ Vector<ActionMap::BreakEntry> ActionMap::smBreakTable(__FILE__, __LINE__);
 ActionMap::ActionMap()
 {
    VECTOR_SET_ASSOCIATION(mDeviceMaps);
+   VECTOR_SET_ASSOCIATION(mNodeRefs);
+   VECTOR_SET_ASSOCIATION(mNodeBuckets);
+   mNodeHashDirty = true;
 }
 
 //------------------------------------------------------------------------------
@@ -409,6 +412,7 @@ ActionMap::Node* ActionMap::getNode(const U32 inDeviceType, const U32 inDeviceIn
 
    // If we're here, the node doesn't exist.  create it.
    pDeviceMap->nodeMap.increment();
+   mNodeHashDirty = true;
 
    Node* pRetNode = &pDeviceMap->nodeMap.last();
    pRetNode->modifiers = inModifiers;
@@ -420,6 +424,7 @@ ActionMap::Node* ActionMap::getNode(const U32 inDeviceType, const U32 inDeviceIn
    pRetNode->scaleFactor   = 1.0;
 
    pRetNode->consoleFunction = NULL;
+   pRetNode->functionCache = Con::FunctionCache();
    pRetNode->makeConsoleCommand = NULL;
    pRetNode->breakConsoleCommand = NULL;
 
@@ -460,30 +465,83 @@ void ActionMap::removeNode(const U32 inDeviceType, const U32 inDeviceInst, const
           dFree(pDeviceMap->nodeMap[i].makeConsoleCommand);
           dFree(pDeviceMap->nodeMap[i].breakConsoleCommand);
           pDeviceMap->nodeMap.erase(i);
+          mNodeHashDirty = true;
       }
    }
 }
 
 //------------------------------------------------------------------------------
-const ActionMap::Node* ActionMap::findNode(const U32 inDeviceType, const U32 inDeviceInst,
-                    const U32 inModifiers,  const U32 inAction)
+U32 ActionMap::hashNode(const U32 inDeviceType, const U32 inDeviceInst,
+                        const U32 inModifiers,  const U32 inAction)
 {
-   // DMMTODO - Slow INITIAL implementation.  Replace with a faster version...
-   //
-   DeviceMap* pDeviceMap = NULL;
-   U32 i;
-   for (i = 0; i < mDeviceMaps.size(); i++)
+   U32 hash = 2166136261;
+   hash = (hash ^ inDeviceType) * 16777619;
+   hash = (hash ^ inDeviceInst) * 16777619;
+   hash = (hash ^ inModifiers)  * 16777619;
+   hash = (hash ^ inAction)     * 16777619;
+   return hash ^ (hash >> 16);
+}
+
+void ActionMap::buildNodeHash()
+{
+   mNodeRefs.clear();
+   for (U32 i = 0; i < mDeviceMaps.size(); i++)
    {
-      if (mDeviceMaps[i]->deviceType == inDeviceType && mDeviceMaps[i]->deviceInst == inDeviceInst)
+      DeviceMap* pDeviceMap = mDeviceMaps[i];
+      for (U32 j = 0; j < pDeviceMap->nodeMap.size(); j++)
       {
-         pDeviceMap = mDeviceMaps[i];
-         break;
+         mNodeRefs.increment();
+         NodeRef& ref  = mNodeRefs.last();
+         ref.deviceType = pDeviceMap->deviceType;
+         ref.deviceInst = pDeviceMap->deviceInst;
+         ref.modifiers  = pDeviceMap->nodeMap[j].modifiers;
+         ref.action     = pDeviceMap->nodeMap[j].action;
+         ref.deviceMap  = pDeviceMap;
+         ref.node       = j;
       }
    }
 
-   if (pDeviceMap == NULL)
-      return NULL;
+   U32 size = 16;
+   while (size < mNodeRefs.size() * 2)
+      size <<= 1;
+   mNodeBuckets.setSize(size);
+   for (U32 i = 0; i < size; i++)
+      mNodeBuckets[i] = -1;
 
+   // Backwards, so each bucket lists its nodes in map order and the first
+   //  of any duplicates is found, as with the old search.
+   for (S32 i = mNodeRefs.size() - 1; i >= 0; i--)
+   {
+      NodeRef& ref = mNodeRefs[i];
+      U32 bucket = hashNode(ref.deviceType, ref.deviceInst, ref.modifiers, ref.action) & (size - 1);
+      ref.next = mNodeBuckets[bucket];
+      mNodeBuckets[bucket] = i;
+   }
+
+   mNodeHashDirty = false;
+}
+
+const ActionMap::NodeRef* ActionMap::findNodeRef(const U32 inDeviceType, const U32 inDeviceInst,
+                                                 const U32 inModifiers,  const U32 inAction)
+{
+   if (mNodeHashDirty)
+      buildNodeHash();
+
+   U32 bucket = hashNode(inDeviceType, inDeviceInst, inModifiers, inAction) & (mNodeBuckets.size() - 1);
+   for (S32 i = mNodeBuckets[bucket]; i != -1; i = mNodeRefs[i].next)
+   {
+      const NodeRef& ref = mNodeRefs[i];
+      if (ref.action     == inAction    && ref.modifiers  == inModifiers &&
+          ref.deviceType == inDeviceType && ref.deviceInst == inDeviceInst)
+         return &ref;
+   }
+   return NULL;
+}
+
+//------------------------------------------------------------------------------
+const ActionMap::Node* ActionMap::findNode(const U32 inDeviceType, const U32 inDeviceInst,
+                    const U32 inModifiers,  const U32 inAction)
+{
    U32 realMods = inModifiers;
    if (realMods & SI_SHIFT)
       realMods |= SI_SHIFT;
@@ -494,15 +552,20 @@ const ActionMap::Node* ActionMap::findNode(const U32 inDeviceType, const U32 inD
    if (realMods & SI_MAC_OPT)
       realMods |= SI_MAC_OPT;
 
-   for (i = 0; i < pDeviceMap->nodeMap.size(); i++)
+   const NodeRef* pRef = findNodeRef(inDeviceType, inDeviceInst, realMods, inAction);
+
+   // An "anykey" bind takes any decent char, if it's ahead of the char's own
+   //  bind in the map.
+   if (dIsDecentChar(inAction))
    {
-      if (pDeviceMap->nodeMap[i].action == KEY_ANYKEY && pDeviceMap->nodeMap[i].modifiers == realMods && dIsDecentChar(inAction))
-         return &pDeviceMap->nodeMap[i];
-      else if (pDeviceMap->nodeMap[i].modifiers == realMods && pDeviceMap->nodeMap[i].action    == inAction)
-         return &pDeviceMap->nodeMap[i];
+      const NodeRef* pAny = findNodeRef(inDeviceType, inDeviceInst, realMods, KEY_ANYKEY);
+      if (pAny && (pRef == NULL || pAny->node < pRef->node))
+         pRef = pAny;
    }
 
-   return NULL;
+   if (pRef == NULL)
+      return NULL;
+   return &pRef->deviceMap->nodeMap[pRef->node];
 }
 
 //------------------------------------------------------------------------------
@@ -1096,7 +1159,7 @@ bool ActionMap::processAction(const InputEvent* pEvent)
       {
          argv[0] = pNode->consoleFunction;
          argv[1] = Con::getFloatArg(value);
-         Con::execute(2, argv);
+         Con::execute(pNode->functionCache, 2, argv);
       }
       //
       // And enter the break into the table if this is a make event...
@@ -1135,7 +1198,7 @@ bool ActionMap::processAction(const InputEvent* pEvent)
          // Ok, we're all set up, call the function.
          argv[0] = pNode->consoleFunction;
          argv[1] = Con::getFloatArg(value);
-         Con::execute(2, argv);
+         Con::execute(pNode->functionCache, 2, argv);
 
          return true;
       } else
@@ -1178,7 +1241,7 @@ bool ActionMap::processAction(const InputEvent* pEvent)
          // Ok, we're all set up, call the function.
          argv[0] = pNode->consoleFunction;
          argv[1] = Con::getFloatArg( value );
-         Con::execute( 2, argv );
+         Con::execute( pNode->functionCache, 2, argv );
 
          return true;
       }
@@ -1220,6 +1283,7 @@ void ActionMap::enterBreakEvent(const InputEvent* pEvent, const Node* pNode)
    //  Copy out the node information...
    //
    smBreakTable[entry].consoleFunction = pNode->consoleFunction;
+   smBreakTable[entry].functionCache = pNode->functionCache;
    if(pNode->breakConsoleCommand)
       smBreakTable[entry].breakConsoleCommand = dStrdup(pNode->breakConsoleCommand);
    else
@@ -1266,7 +1330,7 @@ bool ActionMap::checkBreakTable(const InputEvent* pEvent)
                static const char *argv[2];
                argv[0] = smBreakTable[i].consoleFunction;
                argv[1] = Con::getFloatArg(value);
-               Con::execute(2,argv);
+               Con::execute(smBreakTable[i].functionCache, 2, argv);
             }
          }
          else if(smBreakTable[i].breakConsoleCommand)
@@ -15,6 +15,9 @@
 #ifndef _SIMBASE_H_
 #include "console/simBase.h"
 #endif
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
 
 struct InputEvent;
 
@@ -53,6 +56,7 @@ class ActionMap : public SimObject
       F32 scaleFactor;
 
       StringTableEntry consoleFunction; ///< Console function to call with new values.
+      mutable Con::FunctionCache functionCache;
 
       char *makeConsoleCommand;         ///< Console command to execute when we make this command.
       char *breakConsoleCommand;        ///< Console command to execute when we break this command.
@@ -76,6 +80,7 @@ class ActionMap : public SimObject
       U32 deviceInst;
       U32 objInst;
       StringTableEntry consoleFunction;
+      Con::FunctionCache functionCache;
       char *breakConsoleCommand;
 
       // It's possible that the node could be deleted (unlikely, but possible,
@@ -91,6 +96,32 @@ class ActionMap : public SimObject
    Vector<DeviceMap*>        mDeviceMaps;
    static Vector<BreakEntry> smBreakTable;
 
+   /// @name Node lookup
+   /// Every node by device, modifiers and action, so an event doesn't
+   /// search the maps.  Rebuilt on the first lookup after a node is added
+   /// or removed.
+   /// @{
+   struct NodeRef
+   {
+      U32 deviceType;
+      U32 deviceInst;
+      U32 modifiers;
+      U32 action;
+      DeviceMap *deviceMap;
+      U32 node;            ///< Into deviceMap->nodeMap.
+      S32 next;            ///< In the bucket, -1 at the end.
+   };
+   Vector<NodeRef> mNodeRefs;
+   Vector<S32>     mNodeBuckets;
+   bool            mNodeHashDirty;
+
+   static U32 hashNode(const U32 inDeviceType, const U32 inDeviceInst,
+                       const U32 inModifiers,  const U32 inAction);
+   void buildNodeHash();
+   const NodeRef* findNodeRef(const U32 inDeviceType, const U32 inDeviceInst,
+                              const U32 inModifiers,  const U32 inAction);
+   /// @}
+
    // Find: return NULL if not found in current map, Get: create if not
    //  found.
    const Node* findNode(const U32 inDeviceType, const U32 inDeviceInst,
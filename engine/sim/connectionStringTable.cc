@@ -10,49 +10,72 @@
 #include "core/bitStream.h"
 #include "console/consoleTypes.h"
 
+/// Maps one or more strings to entries of the other side's table.
 class NetStringEvent : public NetEvent
 {
-   StringHandle mString;
-   U32 mIndex;
+   StringHandle mString[ConnectionStringTable::EntryCount];
+   U32 mIndex[ConnectionStringTable::EntryCount];
+   U32 mCount;
 public:
-   NetStringEvent(U32 index = 0, StringHandle string = StringHandle())
+   NetStringEvent()
    {
-      mIndex = index;
-      mString = string;
+      mCount = 0;
    }
-   virtual void pack(NetConnection* /*ps*/, BitStream *bstream)
+   /// False if it's full.
+   bool addString(U32 index, StringHandle &string)
    {
-      bstream->writeInt(mIndex, ConnectionStringTable::EntryBitSize);
-      bstream->writeString(mString.getString());
+      if(mCount == ConnectionStringTable::EntryCount)
+         return false;
+      mIndex[mCount] = index;
+      mString[mCount] = string;
+      mCount++;
+      return true;
+   }
+   virtual void pack(NetConnection *ps, BitStream *bstream)
+   {
+      ps->closeStringBatch(this);
+      write(ps, bstream);
    }
    virtual void write(NetConnection* /*ps*/, BitStream *bstream)
    {
-      bstream->writeInt(mIndex, ConnectionStringTable::EntryBitSize);
-      bstream->writeString(mString.getString());
+      bstream->writeInt(mCount - 1, ConnectionStringTable::EntryBitSize);
+      for(U32 i = 0; i < mCount; i++)
+      {
+         bstream->writeInt(mIndex[i], ConnectionStringTable::EntryBitSize);
+         bstream->writeString(mString[i].getString());
+      }
    }
    virtual void unpack(NetConnection* /*con*/, BitStream *bstream)
    {
       char buf[256];
-      mIndex = bstream->readInt(ConnectionStringTable::EntryBitSize);
-      bstream->readString(buf);
-      mString = StringHandle(buf);
+      mCount = bstream->readInt(ConnectionStringTable::EntryBitSize) + 1;
+      for(U32 i = 0; i < mCount; i++)
+      {
+         mIndex[i] = bstream->readInt(ConnectionStringTable::EntryBitSize);
+         bstream->readString(buf);
+         mString[i] = StringHandle(buf);
+      }
    }
    virtual void notifyDelivered(NetConnection *ps, bool madeit)
    {
       if(madeit)
-         ps->confirmStringReceived(mString, mIndex);
+         for(U32 i = 0; i < mCount; i++)
+            ps->confirmStringReceived(mString[i], mIndex[i]);
    }
    virtual void process(NetConnection *connection)
    {
-      Con::printf("Mapping string: %s to index: %d", mString.getString(), mIndex);
-      connection->mapString(mIndex, mString);
+      for(U32 i = 0; i < mCount; i++)
+      {
+         Con::printf("Mapping string: %s to index: %d", mString[i].getString(), mIndex[i]);
+         connection->mapString(mIndex[i], mString[i]);
+      }
    }
 #ifdef TORQUE_DEBUG_NET
    const char *getDebugName()
    {
       static char buffer[512];
-      dSprintf(buffer, sizeof(buffer), "%s - \"", getClassName());
-      expandEscape(buffer + dStrlen(buffer), mString.getString());
+      dSprintf(buffer, sizeof(buffer), "%s - %d strings, \"", getClassName(), mCount);
+      expandEscape(buffer + dStrlen(buffer), mString[0].getString());
       dStrcat(buffer, "\"");
       return buffer;
    }
@@ -81,6 +104,25 @@ ConnectionStringTable::ConnectionStringTable(NetConnection *parent)
    mEntryTable[0].prevLink = &mLRUHead;
    mLRUTail.prevLink = &mEntryTable[EntryCount-1];
    mEntryTable[EntryCount-1].nextLink = &mLRUTail;
+
+   for(U32 i = 0; i < EntryCount; i++)
+      mEntryTable[i].useStamp = 0;
+   mUseStamp = 0;
+   mBatchStamp = 0;
+   mOpenBatch = NULL;
+}
+
+ConnectionStringTable::~ConnectionStringTable()
+{
+   closeBatch(mOpenBatch);
+}
+
+void ConnectionStringTable::closeBatch(NetStringEvent *batch)
+{
+   if(!batch || batch != mOpenBatch)
+      return;
+   mOpenBatch = NULL;
+   batch->decRef();
 }
 
 U32 ConnectionStringTable::getNetSendId(StringHandle &string)
@@ -103,6 +145,7 @@ U32 ConnectionStringTable::checkString(StringHandle &string, bool *isOnOtherSide
       if(walk->string == string)
       {
          pushBack(walk);
+         walk->useStamp = ++mUseStamp;
 		 if(isOnOtherSide)
 			 *isOnOtherSide = walk->receiveConfirmed;
          return walk->index;
@@ -132,7 +175,22 @@ U32 ConnectionStringTable::checkString(StringHandle &string, bool *isOnOtherSide
    newEntry->nextHash = mHashTable[hashIndex];
    mHashTable[hashIndex] = newEntry;
 
-   mParent->postNetEvent(new NetStringEvent(newEntry->index, string));
+   // into the open batch if it can go, else a new one
+   if(!mOpenBatch || newEntry->useStamp > mBatchStamp || !mOpenBatch->addString(newEntry->index, string))
+   {
+      closeBatch(mOpenBatch);
+
+      NetStringEvent *batch = new NetStringEvent;
+      batch->addString(newEntry->index, string);
+      batch->incRef();
+      // a refused event is released by postNetEvent
+      if(mParent->postNetEvent(batch))
+      {
+         mOpenBatch = batch;
+         mBatchStamp = mUseStamp;
+      }
+   }
+   newEntry->useStamp = ++mUseStamp;
    if(isOnOtherSide)
       *isOnOtherSide = false;
    return newEntry->index;
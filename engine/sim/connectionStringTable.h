@@ -6,6 +6,8 @@
 #ifndef _H_CONNECTIONSTRINGTABLE
 #define _H_CONNECTIONSTRINGTABLE
 
+class NetStringEvent;
+
 /// Maintain a table of strings which are shared across the network.
 ///
 /// This allows us to reference strings in our network streams more efficiently.
@@ -27,6 +29,7 @@ private:
       Entry *nextLink;       ///< the next in the LRU list
       Entry *prevLink;       ///< the prev entry in the LRU list
       bool receiveConfirmed; ///< The other side now has this string.
+      U32 useStamp;          ///< mUseStamp when last checked.
    };
 
    Entry mEntryTable[EntryCount];
@@ -34,6 +37,23 @@ private:
    StringHandle mRemoteStringTable[EntryCount];
    Entry mLRUHead, mLRUTail;
 
+   /// @name Batching
+   ///
+   /// New strings go out in a NetStringEvent that can carry many.  Until
+   /// it's packed, strings checked after it was posted are added to it
+   /// instead of getting an event each, which at join time, when every
+   /// command and message brings a new string, saves most of them.
+   ///
+   /// A string can only join if the entry it replaces hasn't been checked
+   /// since the batch was posted; an event posted after the batch could
+   /// be naming the old string by that entry, and the batch is processed
+   /// first.
+   /// @{
+   NetStringEvent *mOpenBatch;
+   U32 mBatchStamp;          ///< mUseStamp when mOpenBatch was posted.
+   U32 mUseStamp;
+   /// @}
+
    /// Connection over which we are maintaining this string table.
    NetConnection *mParent;
 
@@ -52,6 +72,10 @@ public:
    ///
    /// @param  parent   Connection over which we are maintaining this string table.
    ConnectionStringTable(NetConnection *parent);
+   ~ConnectionStringTable();
+
+   /// The batch has gone out, or is going; nothing more can be added.
+   void closeBatch(NetStringEvent *batch);
 
    /// Has the specified string been received on the other side?
    inline void confirmStringReceived(StringHandle &string, U32 index)
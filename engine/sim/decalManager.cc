@@ -10,6 +10,7 @@
 #include "ts/tsShapeInstance.h"
 #include "core/bitStream.h"
 #include "console/consoleTypes.h"
+#include "collision/clippedPolyList.h"
 
 bool DecalManager::smDecalsOn = true;
 bool DecalManager::sgThisIsSelfIlluminated = false;
@@ -17,24 +18,12 @@ bool DecalManager::sgLastWasSelfIlluminated = false;
 const U32 DecalManager::csmFreePoolBlockSize = 256;
 U32       DecalManager::smMaxNumDecals = 256;
 U32       DecalManager::smDecalTimeout = 5000;
+const U32 DecalManager::csmClipMask = STATIC_COLLISION_MASK;
 
 DecalManager* gDecalManager = NULL;
 IMPLEMENT_CONOBJECT(DecalManager);
 IMPLEMENT_CO_DATABLOCK_V1(DecalData);
 
-namespace {
-
-int QSORT_CALLBACK cmpDecalInstance(const void* p1, const void* p2)
-{
-   const DecalInstance** pd1 = (const DecalInstance**)p1;
-   const DecalInstance** pd2 = (const DecalInstance**)p2;
-
-   return int(((char *)(*pd1)->decalData) - ((char *)(*pd2)->decalData));
-}
-
-} // namespace {}
-
-
 //--------------------------------------------------------------------------
 DecalData::DecalData()
 {
@@ -130,19 +119,24 @@ DecalManager::DecalManager()
    mWorldBox.max.set( 1e7,  1e7,  1e7);
 
    mFreePool = NULL;
-   VECTOR_SET_ASSOCIATION(mDecalQueue);
+   mNumDecals = 0;
+   VECTOR_SET_ASSOCIATION(mBatches);
    VECTOR_SET_ASSOCIATION(mFreePoolBlocks);
 }
 
 
 DecalManager::~DecalManager()
 {
+   // The instances go with their blocks.
+   for (S32 i = 0; i < mBatches.size(); i++)
+      delete mBatches[i];
+   mBatches.clear();
+
    mFreePool = NULL;
    for (S32 i = 0; i < mFreePoolBlocks.size(); i++)
    {
       delete [] mFreePoolBlocks[i];
    }
-   mDecalQueue.clear();
 }
 
 
@@ -173,20 +167,94 @@ void DecalManager::freeDecalInstance(DecalInstance* trash)
 {
    AssertFatal(trash != NULL, "Error, no trash pointer to free!");
 
+   // The mesh vectors keep their memory for the next decal.
    trash->next = mFreePool;
    mFreePool = trash;
 }
 
 
+DecalManager::DecalBatch* DecalManager::findBatch(DecalData* data, bool create)
+{
+   for (S32 i = 0; i < mBatches.size(); i++)
+      if (mBatches[i]->decalData == data)
+         return mBatches[i];
+
+   if (!create)
+      return NULL;
+
+   DecalBatch* batch = new DecalBatch;
+   batch->decalData = data;
+   batch->ring.setSize(16);
+   batch->head  = 0;
+   batch->count = 0;
+   batch->dirty = false;
+   mBatches.push_back(batch);
+   return batch;
+}
+
+void DecalManager::pushDecal(DecalBatch* batch, DecalInstance* decal)
+{
+   if (batch->count == batch->ring.size())
+   {
+      Vector<DecalInstance*> grown;
+      grown.setSize(batch->ring.size() * 2);
+      for (U32 i = 0; i < batch->count; i++)
+         grown[i] = batch->at(i);
+      batch->ring = grown;
+      batch->head = 0;
+   }
+
+   batch->ring[(batch->head + batch->count) & (batch->ring.size() - 1)] = decal;
+   batch->count++;
+   batch->dirty = true;
+   mNumDecals++;
+}
+
+void DecalManager::popDecal(DecalBatch* batch)
+{
+   AssertFatal(batch->count, "DecalManager::popDecal: empty batch");
+
+   freeDecalInstance(batch->at(0));
+   batch->head = (batch->head + 1) & (batch->ring.size() - 1);
+   batch->count--;
+   batch->dirty = true;
+   mNumDecals--;
+}
+
+void DecalManager::rebuildBatch(DecalBatch* batch)
+{
+   batch->verts.clear();
+   for (U32 i = 0; i < batch->count; i++)
+   {
+      DecalInstance* decal = batch->at(i);
+      decal->firstVert = batch->verts.size();
+
+      const U8 fade = U8(decal->fade * 255);
+      batch->verts.increment(decal->verts.size());
+      DecalVert* verts = &batch->verts[decal->firstVert];
+      for (U32 j = 0; j < decal->verts.size(); j++)
+      {
+         verts[j].vert     = decal->verts[j];
+         verts[j].texCoord = decal->texCoords[j];
+         verts[j].color.set(255, 255, 255, fade);
+      }
+   }
+   batch->dirty = false;
+}
+
+
 void DecalManager::dataDeleted(DecalData *data)
 {
-   for(S32 i = mDecalQueue.size() - 1; i >= 0; i--)
+   for(S32 i = 0; i < mBatches.size(); i++)
    {
-      DecalInstance *inst = mDecalQueue[i];
-      if(inst->decalData == data)
+      DecalBatch *batch = mBatches[i];
+      if(batch->decalData == data)
       {
-         freeDecalInstance(inst);
-         mDecalQueue.erase(U32(i));
+         while(batch->count)
+            popDecal(batch);
+         delete batch;
+         mBatches.erase(U32(i));
+         return;
       }
    }
 }
@@ -198,24 +266,99 @@ void DecalManager::consoleInit()
    Con::addVariable("$pref::Decal::decalTimeout", TypeS32, &smDecalTimeout);
 }
 
-void DecalManager::addDecal(const Point3F& pos,
-                            Point3F normal,
-                            DecalData* decalData)
+//--------------------------------------------------------------------------
+
+static void addDecalVert(DecalInstance* decal, const Point3F& point, const Point3F& pos,
+                         const Point3F& vecX, const Point3F& vecY, const Point3F& offset)
 {
-   if (smMaxNumDecals == 0)
+   Point3F d = point - pos;
+   decal->verts.push_back(point + offset);
+   decal->texCoords.push_back(Point2F(0.5f + 0.5f * mDot(d, vecX) / vecX.lenSquared(),
+                                      0.5f - 0.5f * mDot(d, vecY) / vecY.lenSquared()));
+}
+
+void DecalManager::insertDecal(const Point3F& pos, const Point3F& normal,
+                               const Point3F& vecX, const Point3F& vecY,
+                               DecalData* decalData, U32 ownerId)
+{
+   if (vecX.lenSquared() == 0.0f || vecY.lenSquared() == 0.0f)
       return;
 
-   // DMM: Rework this, should be based on time
-   if(mDecalQueue.size() >= smMaxNumDecals)
-   {
+   if (mNumDecals >= smMaxNumDecals)
       findSpace();
-   }
 
-   Point3F vecX, vecY;
    DecalInstance* newDecal = allocateDecalInstance();
    newDecal->decalData = decalData;
    newDecal->allocTime = Platform::getVirtualMilliseconds();
+   newDecal->ownerId = ownerId;
+   newDecal->fade = 1.0f;
+   newDecal->verts.clear();
+   newDecal->texCoords.clear();
+
+   // The decal's box, as deep as it's wide either side of the surface.
+   Point3F dirX = vecX, dirY = vecY;
+   dirX.normalize();
+   dirY.normalize();
+   F32 depth = getMax(vecX.len(), vecY.len());
+   Point3F vecZ = normal * depth;
+
+   static ClippedPolyList polyList;
+   polyList.clear();
+   polyList.doConstruct();
+   polyList.mNormal = -normal;
+   polyList.setInterestNormal(-normal);
+
+   polyList.mPlaneList.setSize(6);
+   polyList.mPlaneList[0].set(pos + vecX,  dirX);
+   polyList.mPlaneList[1].set(pos - vecX, -dirX);
+   polyList.mPlaneList[2].set(pos + vecY,  dirY);
+   polyList.mPlaneList[3].set(pos - vecY, -dirY);
+   polyList.mPlaneList[4].set(pos + vecZ,  normal);
+   polyList.mPlaneList[5].set(pos - vecZ, -normal);
+
+   Point3F extent(mFabs(vecX.x) + mFabs(vecY.x) + mFabs(vecZ.x),
+                  mFabs(vecX.y) + mFabs(vecY.y) + mFabs(vecZ.y),
+                  mFabs(vecX.z) + mFabs(vecY.z) + mFabs(vecZ.z));
+   Box3F box(pos - extent, pos + extent);
+   gClientContainer.buildPolyList(box, csmClipMask, &polyList);
+
+   Point3F offset = normal * 0.008f;
+   for (U32 i = 0; i < polyList.mPolyList.size(); i++)
+   {
+      const ClippedPolyList::Poly& poly = polyList.mPolyList[i];
+      const U32* index = &polyList.mIndexList[poly.vertexStart];
+      for (U32 j = 2; j < poly.vertexCount; j++)
+      {
+         addDecalVert(newDecal, polyList.mVertexList[index[0]].point,     pos, vecX, vecY, offset);
+         addDecalVert(newDecal, polyList.mVertexList[index[j - 1]].point, pos, vecX, vecY, offset);
+         addDecalVert(newDecal, polyList.mVertexList[index[j]].point,     pos, vecX, vecY, offset);
+      }
+   }
+
+   // Nothing static under it, so just the rectangle.
+   if (newDecal->verts.empty())
+   {
+      Point3F corner[4];
+      corner[0] = pos - vecX + vecY;
+      corner[1] = pos - vecX - vecY;
+      corner[2] = pos + vecX - vecY;
+      corner[3] = pos + vecX + vecY;
+      static const U32 sQuad[6] = { 0, 1, 2, 2, 3, 0 };
+      for (U32 i = 0; i < 6; i++)
+         addDecalVert(newDecal, corner[sQuad[i]], pos, vecX, vecY, offset);
+   }
+
+   pushDecal(findBatch(decalData, true), newDecal);
+}
+
+void DecalManager::addDecal(const Point3F& pos,
+                            Point3F normal,
+                            DecalData* decalData)
+{
+   if (smMaxNumDecals == 0)
+      return;
 
+   Point3F vecX, vecY;
    if(mFabs(normal.z) > 0.9f)
       mCross(normal, Point3F(0.0f, 1.0f, 0.0f), &vecX);
    else
@@ -224,21 +367,13 @@ void DecalManager::addDecal(const Point3F& pos,
    mCross(vecX, normal, &vecY);
 
    normal.normalizeSafe();
-   Point3F position = Point3F(pos.x + (normal.x * 0.008), pos.y + (normal.y * 0.008), pos.z + (normal.z * 0.008));
-
    vecX.normalizeSafe();
    vecY.normalizeSafe();
 
    vecX *= decalData->sizeX;
    vecY *= decalData->sizeY;
 
-   newDecal->point[0] = position + vecX + vecY;
-   newDecal->point[1] = position + vecX - vecY;
-   newDecal->point[2] = position - vecX - vecY;
-   newDecal->point[3] = position - vecX + vecY;
-
-   mDecalQueue.push_back(newDecal);
-   mQueueDirty = true;
+   insertDecal(pos, normal, vecX, vecY, decalData, 0);
 }
 
 void DecalManager::addDecal(const Point3F& pos,
@@ -258,46 +393,37 @@ void DecalManager::addDecal(const Point3F& pos,
                             const Point3F& scale,
                             DecalData* decalData)
 {
-   if (smMaxNumDecals == 0)
+   addDecal(pos, rot, normal, scale, decalData, 0);
+}
+
+void DecalManager::addDecal(const Point3F& pos, const Point3F& rot, Point3F normal,
+                            const Point3F& scale, DecalData *decaldata, U32 ownerid)
+{
+   if(smMaxNumDecals == 0)
       return;
 
    if(mDot(rot, normal) < 0.98)
    {
-      // DMM: Rework this, should be based on time
-      if(mDecalQueue.size() >= smMaxNumDecals)
-      {
-         findSpace();
-      }
-
       Point3F vecX, vecY;
-      DecalInstance* newDecal = allocateDecalInstance();
-      newDecal->decalData = decalData;
-      newDecal->allocTime = Platform::getVirtualMilliseconds();
-
       mCross(rot, normal, &vecX);
       mCross(normal, vecX, &vecY);
 
       normal.normalize();
-      Point3F position = Point3F(pos.x + (normal.x * 0.008), pos.y + (normal.y * 0.008), pos.z + (normal.z * 0.008));
 
       vecX.normalize();
       vecX.convolve( scale );
       vecY.normalize();
       vecY.convolve( scale );
 
-      vecX *= decalData->sizeX;
-      vecY *= decalData->sizeY;
+      vecX *= decaldata->sizeX;
+      vecY *= decaldata->sizeY;
 
-      newDecal->point[0] = position + vecX + vecY;
-      newDecal->point[1] = position + vecX - vecY;
-      newDecal->point[2] = position - vecX - vecY;
-      newDecal->point[3] = position - vecX + vecY;
-
-      mDecalQueue.push_back(newDecal);
-      mQueueDirty = true;
+      insertDecal(pos, normal, vecX, vecY, decaldata, ownerid);
    }
 }
 
+//--------------------------------------------------------------------------
+
 bool DecalManager::prepRenderImage(SceneState* state, const U32 stateKey,
                                    const U32 /*startZone*/, const bool /*modifyBaseState*/)
 {
@@ -307,45 +433,49 @@ bool DecalManager::prepRenderImage(SceneState* state, const U32 stateKey,
       return false;
    setLastState(state, stateKey);
 
-   if (mDecalQueue.size() == 0)
+   if (mNumDecals == 0)
       return false;
 
    // This should be sufficient for most objects that don't manage zones, and
    //  don't need to return a specialized RenderImage...
-   SceneRenderImage* image = new SceneRenderImage;
+   SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
    image->obj = this;
    image->isTranslucent = true;
    image->sortType      = SceneRenderImage::BeginSort;
    state->insertRenderImage(image);
 
    U32 currMs = Platform::getVirtualMilliseconds();
-   for (S32 i = mDecalQueue.size() - 1; i >= 0; i--)
+   for (S32 i = 0; i < mBatches.size(); i++)
    {
-      U32 age = currMs - mDecalQueue[i]->allocTime;
-	  U32 timeout = mDecalQueue[i]->decalData->lifeSpan;
-      if (age > timeout)
-      {
-         freeDecalInstance(mDecalQueue[i]);
-         mDecalQueue.erase(i);
-      }
-      else if (age > ((3 * timeout) / 4))
-      {
-         mDecalQueue[i]->fade = 1.0f - (F32(age - ((3 * timeout) / 4)) / F32(timeout / 4));
-      }
-      else
+      DecalBatch* batch = mBatches[i];
+      U32 timeout   = batch->decalData->lifeSpan;
+      U32 fadeStart = (3 * timeout) / 4;
+      U32 fadeTime  = getMax(timeout / 4, U32(1));
+
+      // The expired decals are at the front of the ring...
+      while (batch->count && currMs - batch->at(0)->allocTime > timeout)
+         popDecal(batch);
+
+      // ...then the ones fading out.
+      for (U32 j = 0; j < batch->count; j++)
       {
-         mDecalQueue[i]->fade = 1.0f;
+         DecalInstance* decal = batch->at(j);
+         U32 age = currMs - decal->allocTime;
+         if (age <= fadeStart)
+            break;
+
+         decal->fade = 1.0f - (F32(age - fadeStart) / F32(fadeTime));
+         if (!batch->dirty)
+         {
+            const U8 fade = U8(decal->fade * 255);
+            DecalVert* verts = &batch->verts[decal->firstVert];
+            for (U32 k = 0; k < decal->verts.size(); k++)
+               verts[k].color.alpha = fade;
+         }
       }
-   }
 
-   if (mQueueDirty == true)
-   {
-      // Sort the decals based on the data pointers...
-      dQsort(mDecalQueue.address(),
-             mDecalQueue.size(),
-             sizeof(DecalInstance*),
-             cmpDecalInstance);
-      mQueueDirty = false;
+      if (batch->dirty)
+         rebuildBatch(batch);
    }
 
    return false;
@@ -382,25 +512,12 @@ void DecalManager::renderObject(SceneState* state, SceneRenderImage*)
    AssertFatal(dglIsInCanonicalState(), "Error, GL not in canonical state on exit");
 }
 
-struct DecalVert
-{
-   Point3F vert;
-   Point2F texCoord;
-   ColorI color;
-};
-
 void DecalManager::renderDecal()
 {
-   static Vector<DecalVert> renderVerts(__FILE__, __LINE__);
-   static Vector<U16> indices(__FILE__, __LINE__);
-   renderVerts.clear();
-   indices.clear();
-   U32 decalCount = 0;
-   
    glEnableClientState(GL_VERTEX_ARRAY);
    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
    glEnableClientState(GL_COLOR_ARRAY);
-    
+
    glEnable(GL_TEXTURE_2D);
    glEnable(GL_BLEND);
    glEnable(GL_ALPHA_TEST);
@@ -413,179 +530,94 @@ void DecalManager::renderDecal()
    sgLastWasSelfIlluminated = false;
    glEnable(GL_POLYGON_OFFSET_FILL);
    glPolygonOffset(-1,-1);
-   glDepthMask(GL_FALSE);
-	
-   DecalData* pLastData = NULL;
-   for (S32 x = 0; x < mDecalQueue.size(); x++)
+
+   // One draw per batch.
+   for (S32 i = 0; i < mBatches.size(); i++)
    {
-      if (mDecalQueue[x]->decalData != pLastData)
-      {         
-         glVertexPointer(3, GL_FLOAT, sizeof(DecalVert), &(renderVerts[0].vert));
-         glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(DecalVert), &(renderVerts[0].color));
-         glTexCoordPointer(2, GL_FLOAT, sizeof(DecalVert), &(renderVerts[0].texCoord));
-      
-		 glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_SHORT, indices.address());
-
-		 renderVerts.clear();
-		 indices.clear();
-		 decalCount = 0;
-
-		 glBindTexture(GL_TEXTURE_2D, mDecalQueue[x]->decalData->textureHandle.getGLName());
-		 pLastData = mDecalQueue[x]->decalData;
+      DecalBatch* batch = mBatches[i];
+      if (batch->verts.empty())
+         continue;
+
+      sgThisIsSelfIlluminated = batch->decalData->selfIlluminated;
+      if(sgThisIsSelfIlluminated != sgLastWasSelfIlluminated)
+      {
+         if(sgThisIsSelfIlluminated)
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+         else
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+         sgLastWasSelfIlluminated = sgThisIsSelfIlluminated;
       }
 
-	  sgThisIsSelfIlluminated = mDecalQueue[x]->decalData->selfIlluminated;
-	  if(sgThisIsSelfIlluminated != sgLastWasSelfIlluminated)
-	  {     
-         glVertexPointer(3, GL_FLOAT, sizeof(DecalVert), &(renderVerts[0].vert));
-         glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(DecalVert), &(renderVerts[0].color));
-         glTexCoordPointer(2, GL_FLOAT, sizeof(DecalVert), &(renderVerts[0].texCoord));
-      
-         glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_SHORT, indices.address());
-         
-         renderVerts.clear();
-         indices.clear();
-         decalCount = 0;
-        
-		 if(sgThisIsSelfIlluminated)
-		    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-		 else
-		    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		 sgLastWasSelfIlluminated = sgThisIsSelfIlluminated;
-	  }
-     
-     renderVerts.increment(4);
-     indices.increment(6);
-     DecalVert *verts = &(renderVerts[decalCount * 4]);
-     U16 *ind = &(indices[decalCount * 6]);
-     
-     const U8	fade = mDecalQueue[x]->fade * 255;
-     
-     verts[0].vert = mDecalQueue[x]->point[3];
-     verts[0].texCoord.set(0, 0);
-     verts[0].color.set(255, 255, 255, fade);
-     ind[0] = decalCount * 4;
-     ind[5] = decalCount * 4;
-      
-     verts[1].vert = mDecalQueue[x]->point[2];
-     verts[1].texCoord.set(0, 1);
-     verts[1].color.set(255, 255, 255, fade);
-     ind[1] = decalCount * 4 + 1;
-      
-     verts[2].vert = mDecalQueue[x]->point[1];
-     verts[2].texCoord.set(1, 1);
-     verts[2].color.set(255, 255, 255, fade);
-     ind[2] = decalCount * 4 + 2;
-     ind[3] = decalCount * 4 + 2;
-      
-     verts[3].vert = mDecalQueue[x]->point[0];
-     verts[3].texCoord.set(1, 0);
-     verts[3].color.set(255, 255, 255, fade);
-     ind[4] = decalCount * 4 + 3;
-      
-     decalCount++;   
-   }
-   
-   if(decalCount)
-   {
-      glVertexPointer(3, GL_FLOAT, sizeof(DecalVert), &(renderVerts[0].vert));
-      glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(DecalVert), &(renderVerts[0].color));
-	  glTexCoordPointer(2, GL_FLOAT, sizeof(DecalVert), &(renderVerts[0].texCoord));
-      
-      glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_SHORT, indices.address());
+      glBindTexture(GL_TEXTURE_2D, batch->decalData->textureHandle.getGLName());
+
+      const DecalVert* verts = batch->verts.address();
+      glVertexPointer(3, GL_FLOAT, sizeof(DecalVert), &verts->vert);
+      glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(DecalVert), &verts->color);
+      glTexCoordPointer(2, GL_FLOAT, sizeof(DecalVert), &verts->texCoord);
+
+      glDrawArrays(GL_TRIANGLES, 0, batch->verts.size());
    }
-   
+
    glDisableClientState(GL_VERTEX_ARRAY);
    glDisableClientState(GL_COLOR_ARRAY);
    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 
    glDisable(GL_POLYGON_OFFSET_FILL);
-   glDepthMask(GL_TRUE);
-
    glDepthMask(GL_TRUE);
    glDisable(GL_BLEND);
    glDisable(GL_TEXTURE_2D);
    glDisable(GL_ALPHA_TEST);
 }
 
+//--------------------------------------------------------------------------
+
 void DecalManager::findSpace()
 {
-	S32 besttime = S32_MAX;
-	U32 bestindex = 0;
-	DecalInstance *bestdecal = NULL;
-
-	U32 time = Platform::getVirtualMilliseconds();
-
-	for(U32 i=0; i<mDecalQueue.size(); i++)
-	{
-		DecalInstance *inst = mDecalQueue[i];
-		U32 age = time - inst->allocTime;
-		U32 timeleft = inst->decalData->lifeSpan - age;
-		if(besttime > timeleft)
-		{
-			besttime = timeleft;
-			bestindex = i;
-			bestdecal = inst;
-		}
-	}
-
-	AssertFatal((bestdecal), "No good decals?");
-
-	mDecalQueue.erase_fast(bestindex);
-	freeDecalInstance(bestdecal);
-}
+   // Each batch's oldest decal is the next of it to go, so it's one of those.
+   S32 besttime = S32_MAX;
+   DecalBatch *bestbatch = NULL;
 
-void DecalManager::addDecal(const Point3F& pos, const Point3F& rot, Point3F normal,
-							  const Point3F& scale, DecalData *decaldata, U32 ownerid)
-{
-	if(smMaxNumDecals == 0)
-		return;
-
-	if(mDot(rot, normal) < 0.98)
-	{
-		if(mDecalQueue.size() >= smMaxNumDecals)
-			findSpace();
-
-		Point3F vecX, vecY;
-		DecalInstance* newDecal = allocateDecalInstance();
-		newDecal->decalData = decaldata;
-		newDecal->allocTime = Platform::getVirtualMilliseconds();
-		newDecal->ownerId = ownerid;
-
-		mCross(rot, normal, &vecX);
-		mCross(normal, vecX, &vecY);
-
-		normal.normalize();
-		Point3F position = Point3F(pos.x + (normal.x * 0.008), pos.y + (normal.y * 0.008), pos.z + (normal.z * 0.008));
-
-		vecX.normalize();
-		vecX.convolve( scale );
-		vecY.normalize();
-		vecY.convolve( scale );
-
-		vecX *= decaldata->sizeX;
-		vecY *= decaldata->sizeY;
-
-		newDecal->point[0] = position + vecX + vecY;
-		newDecal->point[1] = position + vecX - vecY;
-		newDecal->point[2] = position - vecX - vecY;
-		newDecal->point[3] = position - vecX + vecY;
-
-		mDecalQueue.push_back(newDecal);
-		mQueueDirty = true;
-	}
+   U32 time = Platform::getVirtualMilliseconds();
+
+   for(S32 i = 0; i < mBatches.size(); i++)
+   {
+      DecalBatch *batch = mBatches[i];
+      if(!batch->count)
+         continue;
+
+      U32 age = time - batch->at(0)->allocTime;
+      S32 timeleft = S32(batch->decalData->lifeSpan) - S32(age);
+      if(besttime > timeleft)
+      {
+         besttime = timeleft;
+         bestbatch = batch;
+      }
+   }
+
+   AssertFatal((bestbatch), "No good decals?");
+
+   popDecal(bestbatch);
 }
 
 void DecalManager::ageDecal(U32 ownerid)
 {
-	for(U32 i=0; i<mDecalQueue.size(); i++)
-	{
-		DecalInstance *inst = mDecalQueue[i];
-		if(inst->ownerId == ownerid)
-		{
-			freeDecalInstance(inst);
-			mDecalQueue.erase(U32(i));
-		}
-	}
+   for(S32 i = 0; i < mBatches.size(); i++)
+   {
+      DecalBatch *batch = mBatches[i];
+      U32 mask = batch->ring.size() - 1;
+      U32 kept = 0;
+      for(U32 j = 0; j < batch->count; j++)
+      {
+         DecalInstance *inst = batch->at(j);
+         if(inst->ownerId == ownerid)
+         {
+            freeDecalInstance(inst);
+            mNumDecals--;
+            batch->dirty = true;
+         }
+         else
+            batch->ring[(batch->head + kept++) & mask] = inst;
+      }
+      batch->count = kept;
+   }
 }
-
@@ -47,25 +47,68 @@ class DecalData : public GameBaseData
 DECLARE_CONSOLETYPE(DecalData)
 
 /// Store an instance of a decal.
+///
+/// The mesh is the decal's rectangle clipped to the static geometry under
+/// it, worked out once when the decal is added.
 struct DecalInstance
 {
    DecalData* decalData;
-   Point3F    point[4];
 
    U32 ownerId;
 
    U32            allocTime;
    F32            fade;
    DecalInstance* next;
+
+   Vector<Point3F> verts;     ///< A triangle list, already pushed off the surface.
+   Vector<Point2F> texCoords;
+   U32             firstVert; ///< Where it is in its batch's vertices.
 };
 
 /// Manage decals in the world.
+///
+/// The decals of each DecalData are kept together in a batch, with all of
+/// their meshes in one vertex array drawn with a single call.  The decals
+/// of a batch share a life span, so a ring of them in the order they were
+/// added is also the order they fade and expire in: aging a batch only
+/// looks at the decals at the front of its ring, and making room means
+/// comparing the oldest decal of each batch.
 class DecalManager : public SceneObject
 {
    typedef SceneObject Parent;
 
-   Vector<DecalInstance*> mDecalQueue;
-   bool                   mQueueDirty;
+   struct DecalVert
+   {
+      Point3F vert;
+      Point2F texCoord;
+      ColorI  color;
+   };
+
+   struct DecalBatch
+   {
+      DecalData*             decalData;
+      Vector<DecalInstance*> ring;     ///< Power of two long.
+      U32                    head;     ///< The oldest.
+      U32                    count;
+      Vector<DecalVert>      verts;
+      bool                   dirty;    ///< verts needs rebuilding.
+
+      DecalInstance* at(U32 i) const { return ring[(head + i) & (ring.size() - 1)]; }
+   };
+
+   Vector<DecalBatch*> mBatches;
+   U32                 mNumDecals;
+
+   DecalBatch* findBatch(DecalData*, bool create);
+   void pushDecal(DecalBatch*, DecalInstance*);
+   void popDecal(DecalBatch*);
+   void rebuildBatch(DecalBatch*);
+
+   /// Projects a rectangle onto whatever static geometry it's over, and
+   /// adds it; vecX and vecY reach from its center to its edges.
+   void insertDecal(const Point3F& pos, const Point3F& normal,
+                    const Point3F& vecX, const Point3F& vecY,
+                    DecalData*, U32 ownerId);
 
 public:
    void addDecal(const Point3F& pos,
@@ -86,6 +129,9 @@ public:
    Vector<DecalInstance*>    mFreePoolBlocks;
    DecalInstance*            mFreePool;
 
+   /// What decals are clipped to.
+   static const U32          csmClipMask;
+
   protected:
    bool prepRenderImage(SceneState *state, const U32 stateKey, const U32 startZone, const bool modifyBaseZoneState);
    void renderObject(SceneState *state, SceneRenderImage *image);
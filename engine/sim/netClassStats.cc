@@ -0,0 +1,313 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "sim/netClassStats.h"
+#include "sim/netConnection.h"
+#include "console/console.h"
+#include "console/consoleTypes.h"
+#include "console/consoleObject.h"
+#include "core/fileStream.h"
+#include "core/resManager.h"
+
+bool        NetClassStats::smEnabled = false;
+S32         NetClassStats::smDumpInterval = 0;
+const char *NetClassStats::smDumpFile = NULL;
+
+U32 NetClassStats::smLastDump = 0;
+
+/// Left behind by closed connections, per group.
+static NetClassStats *sClosed[NetClassGroupsCount];
+
+//-----------------------------------------------------------------------------
+
+NetClassStats::NetClassStats(U32 group)
+{
+   AssertFatal(group < NetClassGroupsCount, "NetClassStats: bad class group.");
+   mGroup = group;
+   VECTOR_SET_ASSOCIATION(mGhosts);
+   VECTOR_SET_ASSOCIATION(mEvents);
+   mGhosts.setSize(AbstractClassRep::NetClassCount[group][NetClassTypeObject]);
+   mEvents.setSize(AbstractClassRep::NetClassCount[group][NetClassTypeEvent]);
+   reset();
+}
+
+void NetClassStats::reset()
+{
+   if(mGhosts.size())
+      dMemset(mGhosts.address(), 0, mGhosts.size() * sizeof(GhostClass));
+   if(mEvents.size())
+      dMemset(mEvents.address(), 0, mEvents.size() * sizeof(EventClass));
+}
+
+void NetClassStats::add(Counter &counter, U32 bits, U32 micros)
+{
+   counter.count++;
+   counter.bits += bits;
+   counter.micros += micros;
+}
+
+void NetClassStats::add(Counter &to, const Counter &from)
+{
+   to.count += from.count;
+   to.bits += from.bits;
+   to.micros += from.micros;
+}
+
+void NetClassStats::addGhost(S32 classId, const char *name, U32 mask, U32 bits, U32 micros)
+{
+   if(classId < 0 || classId >= mGhosts.size())
+      return;
+
+   GhostClass &ghost = mGhosts[classId];
+   ghost.name = name;
+   add(ghost.total, bits, micros);
+   for(U32 i = 0; mask; i++, mask >>= 1)
+      if(mask & 1)
+         add(ghost.mask[i], bits, micros);
+}
+
+void NetClassStats::addEvent(S32 classId, const char *name, U32 bits)
+{
+   if(classId < 0 || classId >= mEvents.size())
+      return;
+
+   EventClass &event = mEvents[classId];
+   event.name = name;
+   add(event.total, bits, 0);
+}
+
+void NetClassStats::merge(const NetClassStats &other)
+{
+   AssertFatal(other.mGroup == mGroup, "NetClassStats::merge: different class groups.");
+   for(U32 i = 0; i < mGhosts.size() && i < other.mGhosts.size(); i++)
+   {
+      const GhostClass &from = other.mGhosts[i];
+      if(!from.name)
+         continue;
+      GhostClass &to = mGhosts[i];
+      to.name = from.name;
+      add(to.total, from.total);
+      for(U32 j = 0; j < MaskBits; j++)
+         add(to.mask[j], from.mask[j]);
+   }
+   for(U32 i = 0; i < mEvents.size() && i < other.mEvents.size(); i++)
+   {
+      const EventClass &from = other.mEvents[i];
+      if(!from.name)
+         continue;
+      mEvents[i].name = from.name;
+      add(mEvents[i].total, from.total);
+   }
+}
+
+bool NetClassStats::getTotals(const char *name, Counter *ghost, Counter *event) const
+{
+   bool found = false;
+   for(U32 i = 0; i < mGhosts.size(); i++)
+      if(mGhosts[i].name && !dStricmp(mGhosts[i].name, name))
+      {
+         add(*ghost, mGhosts[i].total);
+         found = true;
+      }
+   for(U32 i = 0; i < mEvents.size(); i++)
+      if(mEvents[i].name && !dStricmp(mEvents[i].name, name))
+      {
+         add(*event, mEvents[i].total);
+         found = true;
+      }
+   return found;
+}
+
+//-----------------------------------------------------------------------------
+
+void NetClassStats::writeLine(FileStream *file, const char *line)
+{
+   if(file)
+      file->writeLine((U8 *) line);
+   else
+      Con::printf("%s", line);
+}
+
+void NetClassStats::dumpHeader(FileStream *file)
+{
+   writeLine(file, "time,kind,class,mask,count,bits,micros");
+}
+
+void NetClassStats::dumpCounter(FileStream *file, U32 time, const char *kind, const char *name,
+                                S32 bit, const Counter &counter)
+{
+   char line[256];
+   char mask[16];
+   if(bit < 0)
+      dStrcpy(mask, "all");
+   else
+      dSprintf(mask, sizeof(mask), "%d", bit);
+
+   dSprintf(line, sizeof(line), "%d,%s,%s,%s,%d,%.0f,%.0f", time, kind, name, mask, counter.count,
+            F64(counter.bits), F64(counter.micros));
+   writeLine(file, line);
+}
+
+void NetClassStats::dump(FileStream *file, U32 time) const
+{
+   for(U32 i = 0; i < mGhosts.size(); i++)
+   {
+      const GhostClass &ghost = mGhosts[i];
+      if(!ghost.name)
+         continue;
+      dumpCounter(file, time, "ghost", ghost.name, -1, ghost.total);
+      for(U32 j = 0; j < MaskBits; j++)
+         if(ghost.mask[j].count)
+            dumpCounter(file, time, "ghost", ghost.name, j, ghost.mask[j]);
+   }
+   for(U32 i = 0; i < mEvents.size(); i++)
+      if(mEvents[i].name)
+         dumpCounter(file, time, "event", mEvents[i].name, -1, mEvents[i].total);
+}
+
+//-----------------------------------------------------------------------------
+
+void NetClassStats::consoleInit()
+{
+   smDumpFile = StringTable->insert("netClassStats.csv");
+   Con::addVariable("pref::Net::ClassStats",             TypeBool,   &smEnabled);
+   Con::addVariable("pref::Net::ClassStatsDumpInterval", TypeS32,    &smDumpInterval);
+   Con::addVariable("pref::Net::ClassStatsDumpFile",     TypeString, &smDumpFile);
+}
+
+void NetClassStats::retire(const NetClassStats &stats)
+{
+   if(!sClosed[stats.mGroup])
+      sClosed[stats.mGroup] = new NetClassStats(stats.mGroup);
+   sClosed[stats.mGroup]->merge(stats);
+}
+
+void NetClassStats::gather(Vector<NetClassStats *> &stats)
+{
+   stats.setSize(NetClassGroupsCount);
+   for(U32 i = 0; i < NetClassGroupsCount; i++)
+   {
+      stats[i] = new NetClassStats(i);
+      if(sClosed[i])
+         stats[i]->merge(*sClosed[i]);
+   }
+   for(NetConnection *conn = NetConnection::getConnectionList(); conn; conn = conn->getNext())
+      if(const NetClassStats *connStats = conn->getClassStats())
+         stats[connStats->mGroup]->merge(*connStats);
+}
+
+void NetClassStats::resetAll()
+{
+   for(U32 i = 0; i < NetClassGroupsCount; i++)
+      if(sClosed[i])
+         sClosed[i]->reset();
+   for(NetConnection *conn = NetConnection::getConnectionList(); conn; conn = conn->getNext())
+      if(NetClassStats *connStats = conn->getClassStats())
+         connStats->reset();
+}
+
+bool NetClassStats::dumpAll(const char *fileName, bool append)
+{
+   FileStream file;
+   FileStream *out = NULL;
+   if(fileName && *fileName)
+   {
+      if(!ResourceManager->openFileForWrite(file, fileName, append ? FileStream::WriteAppend : FileStream::Write))
+      {
+         Con::errorf("NetClassStats: unable to write %s.", fileName);
+         return false;
+      }
+      out = &file;
+   }
+   if(!out || !append || file.getStreamSize() == 0)
+      dumpHeader(out);
+
+   Vector<NetClassStats *> stats;
+   gather(stats);
+   U32 time = Platform::getRealMilliseconds();
+   for(U32 i = 0; i < stats.size(); i++)
+   {
+      stats[i]->dump(out, time);
+      delete stats[i];
+   }
+   return true;
+}
+
+void NetClassStats::checkDump()
+{
+   if(!smEnabled || smDumpInterval <= 0)
+      return;
+
+   U32 time = Platform::getRealMilliseconds();
+   if(!smLastDump)
+      smLastDump = time;
+   if(time - smLastDump < U32(smDumpInterval))
+      return;
+   smLastDump = time;
+   dumpAll(smDumpFile, true);
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction(dumpNetClassStats, bool, 1, 2, "([string file]) - "
+                "Write the bits, counts and pack time of every network class, summed "
+                "over all connections, as CSV to file or the console.")
+{
+   return NetClassStats::dumpAll(argc > 1 ? argv[1] : NULL, false);
+}
+
+ConsoleFunction(resetNetClassStats, void, 1, 1, "() - "
+                "Zero the network class stats of every connection.")
+{
+   NetClassStats::resetAll();
+}
+
+ConsoleFunction(getNetClassStats, const char *, 2, 2, "(string className) - "
+                "Returns \"updates bits micros events eventBits\" for the class, "
+                "summed over all connections.")
+{
+   NetClassStats::Counter ghost, event;
+   dMemset(&ghost, 0, sizeof(ghost));
+   dMemset(&event, 0, sizeof(event));
+
+   Vector<NetClassStats *> stats;
+   NetClassStats::gather(stats);
+   for(U32 i = 0; i < stats.size(); i++)
+   {
+      stats[i]->getTotals(argv[1], &ghost, &event);
+      delete stats[i];
+   }
+
+   char *ret = Con::getReturnBuffer(128);
+   dSprintf(ret, 128, "%d %.0f %.0f %d %.0f", ghost.count, F64(ghost.bits), F64(ghost.micros),
+            event.count, F64(event.bits));
+   return ret;
+}
+
+ConsoleMethod(NetConnection, dumpClassStats, bool, 2, 3, "([string file]) - "
+              "Write this connection's network class stats as CSV to file or the console.")
+{
+   const NetClassStats *stats = object->getClassStats();
+   if(!stats)
+      return false;
+
+   FileStream file;
+   bool toFile = argc > 2 && *argv[2];
+   if(toFile && !ResourceManager->openFileForWrite(file, argv[2]))
+   {
+      Con::errorf("dumpClassStats: unable to write %s.", argv[2]);
+      return false;
+   }
+   NetClassStats::dumpHeader(toFile ? &file : NULL);
+   stats->dump(toFile ? &file : NULL, Platform::getRealMilliseconds());
+   return true;
+}
+
+ConsoleMethod(NetConnection, resetClassStats, void, 2, 2, "() - "
+              "Zero this connection's network class stats.")
+{
+   if(NetClassStats *stats = object->getClassStats())
+      stats->reset();
+}
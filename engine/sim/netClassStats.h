@@ -0,0 +1,115 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _NETCLASSSTATS_H_
+#define _NETCLASSSTATS_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+
+class FileStream;
+
+/// Where a connection's bandwidth and pack time go, by network class.
+///
+/// With $pref::Net::ClassStats on, each NetConnection counts, for every
+/// NetObject class it ghosts, the updates written, their bits and the
+/// microseconds spent in packUpdate(), and for every NetEvent class the
+/// events written and their bits.  The same is kept for each bit of the
+/// update masks: an update is counted, with all its bits and time, under
+/// every mask bit it had set, since packUpdate() doesn't say which bits
+/// wrote what.  Summing the mask rows won't give the class total.
+///
+/// Only the owning connection writes its stats, so the parallel packet
+/// build can count without locks; the aggregate is summed up when asked
+/// for, from the live connections and what the closed ones left behind.
+///
+/// Scripts use NetConnection::dumpClassStats(), dumpNetClassStats(),
+/// getNetClassStats() and resetNetClassStats().  With
+/// $pref::Net::ClassStatsDumpInterval set the aggregate is also appended to
+/// $pref::Net::ClassStatsDumpFile that often, as CSV.
+class NetClassStats
+{
+  public:
+   enum Constants
+   {
+      MaskBits = 32
+   };
+
+   struct Counter
+   {
+      U32 count;
+      U64 bits;
+      U64 micros;
+   };
+
+   struct GhostClass
+   {
+      const char *name;    ///< NULL until something of the class is written.
+      Counter     total;
+      Counter     mask[MaskBits];
+   };
+
+   struct EventClass
+   {
+      const char *name;
+      Counter     total;
+   };
+
+  private:
+   U32 mGroup;
+   Vector<GhostClass> mGhosts;     ///< By class id in mGroup.
+   Vector<EventClass> mEvents;
+
+   static U32 smLastDump;
+
+   static void add(Counter &counter, U32 bits, U32 micros);
+   static void add(Counter &to, const Counter &from);
+   static void writeLine(FileStream *file, const char *line);
+   static void dumpCounter(FileStream *file, U32 time, const char *kind, const char *name,
+                           S32 bit, const Counter &counter);
+
+  public:
+   /// $pref::Net::ClassStats
+   static bool smEnabled;
+   /// $pref::Net::ClassStatsDumpInterval, real ms, 0 doesn't dump.
+   static S32  smDumpInterval;
+   /// $pref::Net::ClassStatsDumpFile
+   static const char *smDumpFile;
+
+   NetClassStats(U32 group);
+
+   void reset();
+   void merge(const NetClassStats &other);
+
+   void addGhost(S32 classId, const char *name, U32 mask, U32 bits, U32 micros);
+   void addEvent(S32 classId, const char *name, U32 bits);
+
+   /// The totals of the named class, false if it hasn't been written.
+   bool getTotals(const char *name, Counter *ghost, Counter *event) const;
+
+   /// One CSV line per class and set mask bit, to file or the console.
+   void dump(FileStream *file, U32 time) const;
+   static void dumpHeader(FileStream *file);
+
+   static void consoleInit();
+
+   /// Called as a connection closes, so its stats stay in the aggregate.
+   static void retire(const NetClassStats &stats);
+
+   /// All connections' stats, summed per group into stats, which has one
+   /// entry per NetClassGroup.
+   static void gather(Vector<NetClassStats *> &stats);
+   static void resetAll();
+   static bool dumpAll(const char *fileName, bool append);
+
+   /// Appends to smDumpFile every smDumpInterval.
+   static void checkDump();
+};
+
+#endif
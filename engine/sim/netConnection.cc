@@ -14,6 +14,10 @@
 #include "sim/pathManager.h"
 #include "console/consoleTypes.h"
 #include "sim/netInterface.h"
+#include "core/threadPool.h"
+#include "platform/profiler.h"
+#include "core/frameStats.h"
+#include "sim/netClassStats.h"
 #include <stdarg.h>
 
 S32 gNetBitsSent = 0;
@@ -25,6 +29,9 @@ enum NetConnectionConstants {
    DefaultPingRetryCount = 15,
 };
 
+bool NetConnection::smParallelPacketBuild = false;
+S32  NetConnection::smParallelMinConnections = 4;
+
 SimObjectPtr<NetConnection> NetConnection::mServerConnection;
 SimObjectPtr<NetConnection> NetConnection::mLocalClientConnection;
 
@@ -46,19 +53,19 @@ public:
    {
       bstream->write(sequence);
       bstream->writeInt(message, 3);
-      bstream->writeInt(ghostCount, NetConnection::GhostIdBitSize + 1);
+      bstream->writeInt(ghostCount, NetConnection::MaxGhostIdBitSize + 1);
    }
    void write(NetConnection *, BitStream *bstream)
    {
       bstream->write(sequence);
       bstream->writeInt(message, 3);
-      bstream->writeInt(ghostCount, NetConnection::GhostIdBitSize + 1);
+      bstream->writeInt(ghostCount, NetConnection::MaxGhostIdBitSize + 1);
    }
    void unpack(NetConnection *, BitStream *bstream)
    {
       bstream->read(&sequence);
       message = bstream->readInt(3);
-      ghostCount = bstream->readInt(NetConnection::GhostIdBitSize + 1);
+      ghostCount = bstream->readInt(NetConnection::MaxGhostIdBitSize + 1);
    }
    void process(NetConnection *ps)
    {
@@ -149,9 +156,27 @@ void NetConnection::consoleInit()
    Con::addVariable("pref::Net::PacketRateToServer",  TypeS32, &gPacketRateToServer);
    Con::addVariable("pref::Net::PacketRateToClient",  TypeS32, &gPacketRateToClient);
    Con::addVariable("pref::Net::PacketSize",          TypeS32, &gPacketSize);
+   Con::addVariable("pref::Net::ConnectRequestRate",  TypeS32, &NetInterface::smConnectRequestRate);
+   Con::addVariable("pref::Net::ConnectRequestBurst", TypeS32, &NetInterface::smConnectRequestBurst);
+   Con::addVariable("pref::Net::GhostUpdateBudget",   TypeS32, &smGhostUpdateBudget);
+   Con::addVariable("pref::Net::GhostPriorityRefresh", TypeS32, &smGhostPriorityRefresh);
+   Con::addVariable("pref::Net::ParallelPacketBuild", TypeBool, &smParallelPacketBuild);
+   Con::addVariable("pref::Net::ParallelMinConnections", TypeS32, &smParallelMinConnections);
+   Con::addVariable("pref::Net::DeltaBaselines",      TypeBool, &smDeltaBaselines);
+   Con::addVariable("pref::Net::BatchGhostAlways",    TypeBool, &smBatchGhostAlways);
    Con::addVariable("Stats::netBitsSent",       TypeS32, &gNetBitsSent);
    Con::addVariable("Stats::netBitsReceived",   TypeS32, &gNetBitsReceived);
    Con::addVariable("Stats::netGhostUpdates",   TypeS32, &gGhostUpdates);
+   NetClassStats::consoleInit();
+}
+
+NetClassStats *NetConnection::getWriteClassStats()
+{
+   if(!NetClassStats::smEnabled)
+      return NULL;
+   if(!mClassStats)
+      mClassStats = new NetClassStats(getNetClassGroup());
+   return mClassStats;
 }
 
 void NetConnection::checkMaxRate()
@@ -225,11 +250,12 @@ NetConnection::NetConnection()
    mLastUpdateTime = 0;
    mRoundTripTime = 0;
    mPacketLoss = 0;
+   mHuffmanTable = 0;
    mNextTableHash = NULL;
    mSendDelayCredit = 0;
    mConnectionState = NotConnected;
 
-   mCurrentDownloadingFile = NULL;
+   mCurrentUploadBuffer = NULL;
    mCurrentFileBuffer = NULL;
 
    mNextConnection = NULL;
@@ -266,11 +292,34 @@ NetConnection::NetConnection()
    mGhosting = false;
    mScoping = false;
    mGhostArray = NULL;
-   mGhostRefs = NULL;
+   mGhostCapacity = 0;
+   mLocalGhostCapacity = 0;
+   mGhostIdBitSize = MaxGhostIdBitSize;
+   mRemoteGhostIdBitSize = MaxGhostIdBitSize;
    mGhostLookupTable = NULL;
    mLocalGhosts = NULL;
+   mLocalSnapshots = NULL;
+   mDeltaGhost = NULL;
+   mDeltaRef = NULL;
+   mDeltaLocalIndex = -1;
+   mDeltaStarted = false;
+   mDeltaSnapshot = NULL;
 
    mGhostsActive = 0;
+   mGhostPacketCount = 0;
+   mGhostUpdateBudget = 0;
+   mDeferGhostUpdates = false;
+   mGhostUpdatesPending = false;
+   mGhostHeapCount = 0;
+   mGhostPacketTime = 0;
+   mGhostLatencyCount = 0;
+   mGhostLatencyTotal = 0;
+   mGhostLatencyMax = 0;
+   mPacketBuildStream = NULL;
+   mPacketBuildBuffer = NULL;
+   mClassStats = NULL;
+   mLastPacketSize = 0;
+   mGhostUpdatesRead = 0;
 
    mMissionPathsSent = false;
    mDemoWriteStream = NULL;
@@ -280,10 +329,15 @@ NetConnection::NetConnection()
    mPingRetryCount = DefaultPingRetryCount;
    mLastPingSendTime = Platform::getVirtualMilliseconds();
 
-   mCurrentDownloadingFile = NULL;
+   mCurrentUploadBuffer = NULL;
+   mCurrentUploadSize = 0;
+   mCurrentUploadOffset = 0;
+   mFileChunksInFlight = 0;
    mCurrentFileBuffer = NULL;
    mCurrentFileBufferSize = 0;
    mCurrentFileBufferOffset = 0;
+   mCurrentFileSize = 0;
+   mCurrentFileCompressed = false;
    mNumDownloadedFiles = 0;
 }
 
@@ -293,14 +347,20 @@ NetConnection::~NetConnection()
    netAddressTableRemove();
 
    dFree(mCurrentFileBuffer);
-   if(mCurrentDownloadingFile)
-      ResourceManager->closeStream(mCurrentDownloadingFile);
+   delete [] mCurrentUploadBuffer;
 
+   for(U32 i = 0; mLocalSnapshots && i < mLocalGhostCapacity; i++)
+      delete mLocalSnapshots[i];
+   delete[] mLocalSnapshots;
    delete[] mLocalGhosts;
    delete[] mGhostLookupTable;
-   delete[] mGhostRefs;
+   for(S32 i = 0; i < mGhostRefs.size(); i++)
+      delete[] mGhostRefs[i];
    delete[] mGhostArray;
    delete mStringTable;
+   delete mPacketBuildStream;
+   delete[] mPacketBuildBuffer;
+   delete mClassStats;
    if(mDemoWriteStream)
       delete mDemoWriteStream;
    if(mDemoReadStream)
@@ -436,6 +496,11 @@ void NetConnection::onRemove()
    while(mNotifyQueueHead)
       handleNotify(false);
 
+   if(mClassStats)
+      NetClassStats::retire(*mClassStats);
+   gGhostUpdates += mGhostUpdatesRead;
+   mGhostUpdatesRead = 0;
+
    ghostOnRemove();
    eventOnRemove();
 
@@ -483,6 +548,9 @@ void NetConnection::handleNotify(bool recvd)
    else
       packetDropped(note);
 
+   // Running average of the notifies that came back dropped.
+   mPacketLoss += ((recvd ? 0.0f : 1.0f) - mPacketLoss) * 0.05f;
+
    delete note;
 }
 
@@ -491,6 +559,7 @@ void NetConnection::processRawPacket(BitStream *bstream)
    if(mDemoWriteStream)
       recordBlock(BlockTypePacket, bstream->getReadByteSize(), bstream->getBuffer());
 
+   STAT_INC(PacketsReceived);
    ConnectionProtocol::processRawPacket(bstream);
 }
 
@@ -500,6 +569,7 @@ void NetConnection::handlePacket(BitStream *bstream)
    // clear out any errors
 
    mErrorBuffer[0] = 0;
+   bstream->setHuffmanTable(mHuffmanTable);
 
    if(bstream->readFlag())
    {
@@ -522,7 +592,11 @@ void NetConnection::handlePacket(BitStream *bstream)
          mCurRate.changed = true;
       }
    }
-   readPacket(bstream);
+   mRemoteGhostIdBitSize = bstream->readInt(GhostIndexBitSize) + MinGhostIdBitSize;
+   if(mRemoteGhostIdBitSize > MaxGhostIdBitSize)
+      setLastError("Invalid packet.");
+   else
+      readPacket(bstream);
 
    if(mErrorBuffer[0])
       connectionError(mErrorBuffer);
@@ -562,14 +636,27 @@ public:
 };
 
 void NetConnection::checkPacketSend(bool force)
+{
+   BitStream *stream = BitStream::getPacketStream(mCurRate.packetSize);
+   stream->setHuffmanTable(mHuffmanTable);
+   if(buildPacket(force, stream))
+      finishPacket(stream);
+}
+
+U32 NetConnection::getPacketUpdateDelay()
+{
+   return isConnectionToServer() ? gPacketUpdateDelayToServer : mCurRate.updateDelay;
+}
+
+bool NetConnection::buildPacket(bool force, BitStream *stream)
 {
    U32 curTime = Platform::getVirtualMilliseconds();
-   U32 delay = isConnectionToServer() ? gPacketUpdateDelayToServer : mCurRate.updateDelay;
+   U32 delay = getPacketUpdateDelay();
 
    if(!force)
    {
       if(curTime < mLastUpdateTime + delay - mSendDelayCredit)
-         return;
+         return false;
 
       mSendDelayCredit = curTime - (mLastUpdateTime + delay - mSendDelayCredit);
       if(mSendDelayCredit > 1000)
@@ -579,9 +666,8 @@ void NetConnection::checkPacketSend(bool force)
          recordBlock(BlockTypeSendPacket, 0, 0);
    }
    if(windowFull())
-      return;
+      return false;
 
-   BitStream *stream = BitStream::getPacketStream(mCurRate.packetSize);
    buildSendPacketHeader(stream);
 
    mLastUpdateTime = curTime;
@@ -610,10 +696,28 @@ void NetConnection::checkPacketSend(bool force)
       stream->writeInt(mMaxRate.packetSize, 10);
       mMaxRate.changed = false;
    }
+
+   // every ghost id written from here on uses this width
+   updateGhostIdBitSize();
+   stream->writeInt(mGhostIdBitSize - MinGhostIdBitSize, GhostIndexBitSize);
+
    U32 start = stream->getCurPos();
    DEBUG_LOG(("PKLOG %d START", getId()) );
    writePacket(stream, note);
    DEBUG_LOG(("PKLOG %d END - %d", getId(), stream->getCurPos() - start) );
+   return true;
+}
+
+void NetConnection::finishPacket(BitStream *stream)
+{
+   // Only does anything if the ghost updates were deferred by checkPacketSends().
+   ghostWriteUpdates(stream, mNotifyQueueTail, false);
+   ghostEndPacket(stream, mNotifyQueueTail);
+
+   // writePacket() leaves these set for the ghost updates written after it
+   stream->clearCompressionPoint();
+   stream->setStringBuffer(NULL);
+
    if(mSimulatedPacketLoss && Platform::getRandom() < mSimulatedPacketLoss)
    {
       //Con::printf("NET  %d: SENDDROP - %d", getId(), mLastSendSeq);
@@ -627,6 +731,104 @@ void NetConnection::checkPacketSend(bool force)
    sendPacket(stream);
 }
 
+//--------------------------------------------------------------------
+
+/// Writes the parallel safe part of one connection's ghost updates.
+class PacketBuildWorkItem : public ThreadPool::WorkItem
+{
+  public:
+   NetConnection *mConnection;
+
+   void process()
+   {
+      PROFILE_START(PacketBuildWorkItem);
+      NetConnection *conn = mConnection;
+      conn->ghostWriteUpdates(conn->mPacketBuildStream, conn->mNotifyQueueTail, true);
+      PROFILE_END();
+   }
+};
+
+void NetConnection::checkPacketSends(NetConnection **conns, U32 count)
+{
+   NetClassStats::checkDump();
+
+   if(!smParallelPacketBuild || count < smParallelMinConnections ||
+         !gThreadPool || !gThreadPool->isThreaded())
+   {
+      for(U32 i = 0; i < count; i++)
+         conns[i]->checkPacketSend(false);
+      updateSendStats(conns, count);
+      return;
+   }
+
+   PROFILE_START(NetConnection_checkPacketSends);
+
+   // Scoping, events and anything else that touches shared state is done
+   // here on the main thread.  Each connection gets its own stream since
+   // the packets are all in flight at once.
+   Vector<NetConnection *> building;
+   for(U32 i = 0; i < count; i++)
+   {
+      NetConnection *conn = conns[i];
+      if(!conn->mPacketBuildStream)
+      {
+         conn->mPacketBuildBuffer = new U8[MaxPacketDataSize];
+         conn->mPacketBuildStream = new BitStream(conn->mPacketBuildBuffer, MaxPacketDataSize);
+      }
+      BitStream *stream = conn->mPacketBuildStream;
+      stream->setBuffer(conn->mPacketBuildBuffer, conn->mCurRate.packetSize, MaxPacketDataSize);
+      stream->setPosition(0);
+
+      conn->mDeferGhostUpdates = true;
+      bool built = conn->buildPacket(false, stream);
+      conn->mDeferGhostUpdates = false;
+      if(built)
+         building.push_back(conn);
+   }
+
+   // Nothing advances while the workers run, so object state is effectively
+   // a read-only snapshot and each item only writes its own connection.
+   Vector<PacketBuildWorkItem> items;
+   items.setSize(building.size());
+   ThreadPool::Counter done;
+   for(U32 i = 0; i < building.size(); i++)
+   {
+      constructInPlace(&items[i]);
+      items[i].mConnection = building[i];
+      gThreadPool->queueWorkItem(&items[i], &done);
+   }
+   gThreadPool->waitForCounter(&done);
+
+   // Unsafe leftovers, then the sends, strictly in connection order.
+   for(U32 i = 0; i < building.size(); i++)
+      building[i]->finishPacket(building[i]->mPacketBuildStream);
+   updateSendStats(conns, count);
+
+   PROFILE_END();
+}
+
+void NetConnection::updateSendStats(NetConnection **conns, U32 count)
+{
+   // The connections count their own, the globals are only written here
+   // on the main thread.
+   U32 size = 0;
+   for(U32 i = 0; i < count; i++)
+   {
+      size += conns[i]->mLastPacketSize;
+      conns[i]->mLastPacketSize = 0;
+   }
+   gNetBitsSent = size;
+}
+
+void NetConnection::collectReadStats()
+{
+   for(NetConnection *walk = mConnectionList; walk; walk = walk->mNextConnection)
+   {
+      gGhostUpdates += walk->mGhostUpdatesRead;
+      walk->mGhostUpdatesRead = 0;
+   }
+}
+
 Net::Error NetConnection::sendPacket(BitStream *stream)
 {
    //Con::printf("NET  %d: SEND - %d", getId(), mLastSendSeq);
@@ -634,7 +836,8 @@ Net::Error NetConnection::sendPacket(BitStream *stream)
    if(mDemoReadStream)
       return Net::NoError;
 
-   gNetBitsSent = stream->getStreamSize();
+   mLastPacketSize = stream->getStreamSize();
+   STAT_INC(PacketsSent);
 
    if(isLocalConnection())
    {
@@ -690,6 +893,8 @@ void NetConnection::writeDemoStartBlock(ResizeBitStream* stream)
 
    stream->write(mRoundTripTime);
    stream->write(mPacketLoss);
+   stream->writeInt(mHuffmanTable, BitStream::HuffmanTableBits);
+   stream->write(BitStream::getHuffmanTableCRC(mHuffmanTable));
 
    // Write all the current paths to the stream...
    gClientPathManager->dumpState(stream);
@@ -705,6 +910,8 @@ void NetConnection::writeDemoStartBlock(ResizeBitStream* stream)
    }
    stream->write(start);
 
+   // ghost ids in the start block are always full width
+   mGhostIdBitSize = MaxGhostIdBitSize;
    eventWriteStartBlock(stream);
    ghostWriteStartBlock(stream);
 }
@@ -716,6 +923,17 @@ bool NetConnection::readDemoStartBlock(BitStream* stream)
    stream->read(&mRoundTripTime);
    stream->read(&mPacketLoss);
 
+   // The recording's strings are only readable with the table it was made with.
+   U32 huffCRC;
+   mHuffmanTable = stream->readInt(BitStream::HuffmanTableBits);
+   stream->read(&huffCRC);
+   if(!BitStream::isHuffmanTableValid(mHuffmanTable) || BitStream::getHuffmanTableCRC(mHuffmanTable) != huffCRC)
+   {
+      Con::errorf("Demo was recorded with string table %d, which is not loaded.", mHuffmanTable);
+      mHuffmanTable = 0;
+      return false;
+   }
+
    // Read
    gClientPathManager->readState(stream);
    mStringTable->readDemoStartBlock(stream);
@@ -731,6 +949,7 @@ bool NetConnection::readDemoStartBlock(BitStream* stream)
          mNotifyQueueTail->nextPacket = note;
       mNotifyQueueTail = note;
    }
+   mRemoteGhostIdBitSize = MaxGhostIdBitSize;
    eventReadStartBlock(stream);
    ghostReadStartBlock(stream);
    return true;
@@ -1060,6 +1279,21 @@ void NetConnection::writeConnectRequest(BitStream *stream)
 {
    stream->write(mNetClassGroup);
    stream->write(U32(AbstractClassRep::getClassCRC(mNetClassGroup)));
+
+   // Offer every string table we have; the server picks one in readConnectRequest().
+   U32 count = 0;
+   for(U32 i = 1; i < BitStream::MaxHuffmanTables; i++)
+      if(BitStream::isHuffmanTableValid(i))
+         count++;
+   stream->writeInt(count, BitStream::HuffmanTableBits);
+   for(U32 i = 1; i < BitStream::MaxHuffmanTables; i++)
+   {
+      if(BitStream::isHuffmanTableValid(i))
+      {
+         stream->writeInt(i, BitStream::HuffmanTableBits);
+         stream->write(BitStream::getHuffmanTableCRC(i));
+      }
+   }
 }
 
 bool NetConnection::readConnectRequest(BitStream *stream, const char **errorString)
@@ -1068,22 +1302,40 @@ bool NetConnection::readConnectRequest(BitStream *stream, const char **errorStri
    stream->read(&classGroup);
    stream->read(&classCRC);
 
-   if(classGroup == mNetClassGroup && classCRC == AbstractClassRep::getClassCRC(mNetClassGroup))
-      return true;
+   if(classGroup != mNetClassGroup || classCRC != AbstractClassRep::getClassCRC(mNetClassGroup))
+   {
+      *errorString = "CHR_INVALID";
+      return false;
+   }
 
-   *errorString = "CHR_INVALID";
-   return false;
+   // Use the highest numbered table both sides have identical copies of.
+   mHuffmanTable = 0;
+   U32 count = stream->readInt(BitStream::HuffmanTableBits);
+   for(U32 i = 0; i < count; i++)
+   {
+      U32 id = stream->readInt(BitStream::HuffmanTableBits);
+      U32 crc;
+      stream->read(&crc);
+      if(id > mHuffmanTable && BitStream::isHuffmanTableValid(id) && BitStream::getHuffmanTableCRC(id) == crc)
+         mHuffmanTable = id;
+   }
+   return true;
 }
 
 void NetConnection::writeConnectAccept(BitStream *stream)
 {
-   stream;
+   stream->writeInt(mHuffmanTable, BitStream::HuffmanTableBits);
 }
 
 bool NetConnection::readConnectAccept(BitStream *stream, const char **errorString)
 {
-   stream;
-   errorString;
+   mHuffmanTable = stream->readInt(BitStream::HuffmanTableBits);
+   if(!BitStream::isHuffmanTableValid(mHuffmanTable))
+   {
+      mHuffmanTable = 0;
+      *errorString = "CHR_INVALID";
+      return false;
+   }
    return true;
 }
 
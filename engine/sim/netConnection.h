@@ -34,6 +34,7 @@ class Stream;
 class Point3F;
 
 struct GhostInfo;
+struct CameraScopeQuery;
 struct SubPacketRef; // defined in NetConnection subclass
 
 //#define TORQUE_DEBUG_NET
@@ -47,6 +48,7 @@ struct SubPacketRef; // defined in NetConnection subclass
 //----------------------------------------------------------------------------
 
 class NetEvent;
+class NetClassStats;
 
 struct NetEventNote
 {
@@ -260,6 +262,11 @@ public:
    virtual void process(NetConnection *ps) = 0;
    virtual void notifySent(NetConnection *ps);
    virtual void notifyDelivered(NetConnection *ps, bool madeit);
+
+   /// Latest value events: an Unguaranteed event with a channel other than
+   /// 0 takes the place of an unsent one of the same class and channel
+   /// that's still queued, so only the newest value goes out.
+   virtual U32 getChannel() const { return 0; }
    /// @}
 };
 
@@ -375,6 +382,32 @@ class NetConnection : public ConnectionProtocol, public SimGroup
    typedef SimGroup Parent;
 
 public:
+   enum GhostSnapshotConstants
+   {
+      MaxSnapshotFields = 12,
+      SnapshotHistorySize = 32,  ///< Covers the whole 30 packet send window.
+      SnapshotSeqBits = 9,       ///< Sequence bits used to name a baseline on the wire.
+   };
+
+   /// Quantized values of a ghost's delta compressed fields, as decoded by
+   /// the client from one update.
+   ///
+   /// @see packDeltaInt
+   struct GhostSnapshot
+   {
+      U32 seq;                         ///< Packet sequence this state was sent in.
+      U32 validMask;                   ///< Fields that have a value.
+      U32 values[MaxSnapshotFields];
+   };
+
+   /// Client side ring of the most recently received snapshots for a ghost.
+   struct GhostSnapshotHistory
+   {
+      U32 count;
+      U32 head;                        ///< Slot the next snapshot is written to.
+      GhostSnapshot entries[SnapshotHistorySize];
+   };
+
    /// Structure to track ghost references in packets.
    ///
    /// Every packet we send out with an update from a ghost causes one of these to be
@@ -389,6 +422,7 @@ public:
       GhostInfo *ghost;          ///< Reference to the GhostInfo we're from.
       GhostRef *nextRef;         ///< Next GhostRef in this packet.
       GhostRef *nextUpdateChain; ///< Next update we sent for this ghost.
+      GhostSnapshot *snapshot;   ///< Delta compressed state sent in this update, if any.
    };
 
    enum Constants
@@ -442,6 +476,7 @@ private:
    BitSet32 mTypeFlags;
 
    U32 mNetClassGroup;  ///< The NetClassGroup of this connection.
+   U32 mHuffmanTable;   ///< String compression table negotiated at connect, see BitStream::setHuffmanTable().
 
    /// @name Statistics
    /// @{
@@ -542,6 +577,7 @@ public:
 
    /// Call this if the "connection" is local to this app. This short-circuits the protocol layer.
    void setRemoteConnectionObject(NetConnection *connection) { mRemoteConnection = connection; };
+   NetConnection *getRemoteConnectionObject() { return mRemoteConnection; }
 
    void setSequence(U32 connectSequence);
 
@@ -553,6 +589,9 @@ public:
    void setProtocolVersion(U32 protocolVersion) { mProtocolVersion = protocolVersion; }
    U32 getProtocolVersion()                     { return mProtocolVersion; }
    F32 getRoundTripTime()                       { return mRoundTripTime; }
+   /// Milliseconds between the packets we send, see checkMaxRate().
+   U32 getPacketUpdateDelay();
+   S32 getPacketSize()                          { return mCurRate.packetSize; }
    F32 getPacketLoss()                          { return( mPacketLoss ); }
 
    static char mErrorBuffer[256];
@@ -573,6 +612,27 @@ private:
    void netAddressTableInsert();
    void netAddressTableRemove();
 
+   friend class PacketBuildWorkItem;
+   friend class GhostAlwaysBatchEvent;
+
+   BitStream *mPacketBuildStream;   ///< Per connection packet stream used by checkPacketSends().
+   U8        *mPacketBuildBuffer;
+
+   /// Bits and pack time by class, made on the first write with
+   /// $pref::Net::ClassStats on.
+   NetClassStats *mClassStats;
+   NetClassStats *getWriteClassStats();
+
+   /// Bytes of the last packet sent, for $Stats::netBitsSent.
+   U32 mLastPacketSize;
+   /// Ghost updates read since the last collectReadStats().
+   U32 mGhostUpdatesRead;
+
+   /// Writes everything up to the ghost updates; returns false if no packet is due.
+   bool buildPacket(bool force, BitStream *stream);
+   /// Writes any remaining ghost updates and sends the packet.
+   void finishPacket(BitStream *stream);
+
 public:
    /// Find a NetConnection, if any, with the specified address.
    static NetConnection *lookup(const NetAddress *remoteAddress);
@@ -581,6 +641,16 @@ public:
 
    void checkPacketSend(bool force);
 
+   /// Like calling checkPacketSend(false) on each connection, but ghost updates
+   /// for objects that are safe to pack concurrently are written on the thread
+   /// pool.  Scoping, events and the final sendPacket() run on the main thread.
+   ///
+   /// @see NetObject::isParallelPackSafe
+   static void checkPacketSends(NetConnection **conns, U32 count);
+
+   static bool smParallelPacketBuild;     ///< Use checkPacketSends() for server packets.
+   static S32  smParallelMinConnections;  ///< Fewer connections than this are sent serially.
+
    bool missionPathsSent() const          { return mMissionPathsSent; }
    void setMissionPathsSent(const bool s) { mMissionPathsSent = s; }
 
@@ -703,6 +773,8 @@ public:
       { if(mStringTable) return mStringTable->getNetSendId(string); else return 0;}
    void confirmStringReceived(StringHandle &string, U32 index)
       { if(!isRemoved()) mStringTable->confirmStringReceived(string, index); }
+   void closeStringBatch(NetStringEvent *batch)
+      { if(mStringTable) mStringTable->closeBatch(batch); }
 
    StringHandle translateRemoteStringId(U32 id) { return mStringTable->lookupString(id); }
    void         validateSendString(const char *str);
@@ -726,7 +798,7 @@ protected:
       EndGhosting,
       GhostAlwaysStarting,
       SendNextDownloadRequest,
-      FileDownloadSizeMessage,
+      FileDownloadSizeMessage,   ///< No longer sent, see FileDownloadStartEvent.
       NumConnectionMessages,
    };
    GhostInfo **mGhostArray;    ///< Linked list of ghostInfos ghosted by this side of the connection
@@ -736,15 +808,59 @@ protected:
 
    U32 mGhostsActive;			///- Track actve ghosts on client side
 
+   U32 mGhostPacketCount;      ///< Number of ghost packets written, used to age cached priorities.
+   U32 mGhostUpdateBudget;     ///< Max bytes of ghost updates per packet, 0 to use smGhostUpdateBudget.
+   Vector<GhostInfo *> mGhostUpdateHeap; ///< Scratch max-heap of ghosts waiting for an update.
+
+   /// @name Delta compression state
+   /// Set while a ghost's packUpdate()/unpackUpdate() is running.
+   /// @{
+   GhostInfo     *mDeltaGhost;       ///< Ghost being packed.
+   GhostRef      *mDeltaRef;         ///< Update the snapshot belongs to.
+   S32            mDeltaLocalIndex;  ///< Local ghost being unpacked, or -1.
+   bool           mDeltaStarted;     ///< Baseline header has been written/read for this update.
+   GhostSnapshot *mDeltaSnapshot;    ///< Snapshot being filled in, NULL if not tracked.
+   GhostSnapshotHistory **mLocalSnapshots; ///< Parallel to mLocalGhosts, allocated as needed.
+
+   void packDeltaHeader(BitStream *stream);
+   void unpackDeltaHeader(BitStream *stream);
+   void clearLocalSnapshots(U32 index);
+   /// @}
+
+   /// @name Ghost update writing state
+   ///
+   /// ghostWritePacket() only scopes and prioritizes while mDeferGhostUpdates is
+   /// set, leaving the update list open for ghostWriteUpdates().
+   /// @{
+   bool mDeferGhostUpdates;
+   bool mGhostUpdatesPending;  ///< Update list started but not yet terminated.
+   U32  mGhostSendSize;        ///< Bits per ghost index in the current packet.
+   U32  mGhostPacketTime;      ///< Virtual time the current packet was started.
+   S32  mGhostHeapCount;       ///< Entries left in mGhostUpdateHeap.
+   U32  mGhostBudgetBits;
+   U32  mGhostBudgetStart;
+   /// @}
+
    bool mGhosting;             ///< Am I currently ghosting objects?
    bool mScoping;              ///< am I currently scoping objects?
    U32  mGhostingSequence;     ///< Sequence number describing this ghosting session.
 
+   /// @name Ghost update latency
+   /// Time from an object's state going dirty to the update being written,
+   /// in virtual ms, over the ghost updates written since the last reset.
+   /// @{
+   U32 mGhostLatencyCount;
+   U32 mGhostLatencyTotal;
+   U32 mGhostLatencyMax;
+   /// @}
+
    NetObject **mLocalGhosts;  ///< Local ghost for remote object.
                               ///
                               /// mLocalGhosts pointer is NULL if mGhostTo is false
+   U32 mLocalGhostCapacity;   ///< Allocated size of mLocalGhosts, grown as higher ghost ids arrive.
 
-   GhostInfo *mGhostRefs;           ///< Allocated array of ghostInfos. Null if ghostFrom is false.
+   Vector<GhostInfo *> mGhostRefs;  ///< Blocks of GhostBlockSize ghostInfos. Empty if ghostFrom is false.
+   U32 mGhostCapacity;              ///< Number of ghostInfos allocated, and the size of mGhostArray.
    GhostInfo **mGhostLookupTable;   ///< Table indexed by object id to GhostInfo. Null if ghostFrom is false.
 
    /// The object around which we are scoping this connection.
@@ -760,24 +876,105 @@ protected:
    void ghostPacketReceived(PacketNotify *notify);
 
    void ghostWritePacket(BitStream *bstream, PacketNotify *notify);
+   void ghostUpdatePriorities(CameraScopeQuery *camInfo);
+   void ghostWriteUpdates(BitStream *bstream, PacketNotify *notify, bool parallelOnly);
+   void ghostEndPacket(BitStream *bstream, PacketNotify *notify);
    void ghostReadPacket(BitStream *bstream);
    void freeGhostInfo(GhostInfo *);
 
    void ghostWriteStartBlock(ResizeBitStream *stream);
    void ghostReadStartBlock(BitStream *stream);
 
+   /// Add another GhostBlockSize ghostInfos to the ghosting side.
+   void growGhostArray();
+   /// Make sure mLocalGhosts can hold the given ghost index.
+   void growLocalGhosts(U32 index);
+
+   /// Get the ghostInfo for a ghost index on the ghosting side.
+   inline GhostInfo *getGhostRef(U32 index);
+
+   /// @name Ghost id width
+   ///
+   /// Ghost ids written into a packet (in packUpdates, events, control object
+   /// updates and the like) use as few bits as the highest active ghost index
+   /// on the ghosting side needs.  The width is written at the start of every
+   /// packet, so it can grow and shrink freely from one packet to the next.
+   /// @{
+   U32 mGhostIdBitSize;        ///< Width of ghost ids in packets we write.
+   U32 mRemoteGhostIdBitSize;  ///< Width of ghost ids in the packet being read.
+
+   void updateGhostIdBitSize();
+   /// @}
+
 public:
    /// Some configuration values.
    enum GhostConstants
    {
-      GhostIdBitSize = 12,
-      MaxGhostCount = 1 << GhostIdBitSize, //4096,
-      GhostLookupTableSize = 1 << GhostIdBitSize, //4096
-      GhostIndexBitSize = 4 // number of bits GhostIdBitSize-3 fits into
+      MinGhostIdBitSize = 3,
+      MaxGhostIdBitSize = 16,
+      MaxGhostCount = 1 << MaxGhostIdBitSize, //65536
+      GhostBlockSize = 1024, ///< ghostInfos and local ghost slots are allocated this many at a time.
+      GhostLookupTableSize = 1 << 12, //4096
+      GhostIndexBitSize = 4 // number of bits MaxGhostIdBitSize-3 fits into
    };
 
+   /// Write a ghost index using this packet's ghost id width.
+   void packGhostIndex(BitStream *stream, S32 index);
+   /// Read a ghost index written by packGhostIndex().
+   S32 unpackGhostIndex(BitStream *stream);
+   U32 getGhostIdBitSize() { return mGhostIdBitSize; }
+
+   /// @name Delta compressed ghost state
+   ///
+   /// packUpdate() can send ghost state relative to the last state the client
+   /// acknowledged, instead of in full.  Each field is a quantized integer of
+   /// bitCount bits, identified by a per-class field number below
+   /// MaxSnapshotFields.  If the field has an acknowledged baseline and the
+   /// difference (modulo 2^bitCount, so angles wrap) fits in deltaBits, only
+   /// the signed difference is written.  Otherwise the full value is written.
+   ///
+   /// The first delta field in an update names the baseline snapshot. The
+   /// server keeps the newest acknowledged snapshot on the GhostInfo, and the
+   /// client keeps a ring of the snapshots it has received.  Fields that aren't
+   /// written in an update carry over from the baseline on both sides.
+   ///
+   /// Outside of a ghost update (ghost always events, demo start blocks) the
+   /// fields are always written in full, so packUpdate doesn't need to care.
+   /// @{
+
+   static bool smDeltaBaselines;   ///< $pref::Net::DeltaBaselines; false sends every field in full.
+
+   void packDeltaInt(BitStream *stream, U32 field, U32 value, U32 bitCount, U32 deltaBits);
+   U32  unpackDeltaInt(BitStream *stream, U32 field, U32 bitCount, U32 deltaBits);
+
+   /// Same as BitStream::writeFloat(), for values in [0,1].
+   void packDeltaFloat(BitStream *stream, U32 field, F32 value, U32 bitCount, U32 deltaBits)
+      { packDeltaInt(stream, field, U32(S32(value * ((1 << bitCount) - 1))), bitCount, deltaBits); }
+   F32  unpackDeltaFloat(BitStream *stream, U32 field, U32 bitCount, U32 deltaBits)
+      { return unpackDeltaInt(stream, field, bitCount, deltaBits) / F32((1 << bitCount) - 1); }
+   /// @}
+
    U32 getGhostsActive() { return mGhostsActive;};
 
+   /// @name Ghost update scheduling
+   ///
+   /// Ghost priorities are cached in the GhostInfo and only recomputed when the
+   /// object's update mask changes, or when the cached value is older than
+   /// smGhostPriorityRefresh packets (the camera moves even if the object doesn't).
+   /// Between refreshes a ghost's priority grows with the number of packets it
+   /// has been waiting, so nothing starves.
+   /// @{
+
+   static U32 smGhostUpdateBudget;     ///< Default max bytes of ghost updates per packet, 0 for no limit.
+   static U32 smGhostPriorityRefresh;  ///< Packets before a cached ghost priority is recomputed.
+   static bool smBatchGhostAlways;     ///< $pref::Net::BatchGhostAlways, see GhostAlwaysBatchEvent.
+
+   /// Limit the amount of ghost data written per packet on this connection.
+   /// A budget of 0 uses the $pref::Net::GhostUpdateBudget default.
+   void setGhostUpdateBudget(U32 bytes) { mGhostUpdateBudget = bytes; }
+   U32  getGhostUpdateBudget() { return mGhostUpdateBudget ? mGhostUpdateBudget : smGhostUpdateBudget; }
+   /// @}
+
    /// Are we ghosting to someone?
    bool isGhostingTo() { return mLocalGhosts != NULL; };
 
@@ -847,6 +1044,25 @@ public:
    /// Are we ghosting?
    bool isGhosting() { return mGhosting; }
 
+   /// Sequence number of the current ghosting session.
+   U32 getGhostingSequence() { return mGhostingSequence; }
+
+   /// Get the ghost update latency stats, see mGhostLatencyCount.
+   void getGhostLatency(U32 *count, U32 *totalMs, U32 *maxMs)
+      { *count = mGhostLatencyCount; *totalMs = mGhostLatencyTotal; *maxMs = mGhostLatencyMax; }
+   void resetGhostLatency() { mGhostLatencyCount = mGhostLatencyTotal = mGhostLatencyMax = 0; }
+
+   /// What this connection has written by class, NULL if nothing has been
+   /// counted yet.  See NetClassStats.
+   NetClassStats *getClassStats() { return mClassStats; }
+
+   /// Adds what each connection has read to $Stats::netGhostUpdates.  Main
+   /// thread only.
+   static void collectReadStats();
+   /// Sets $Stats::netBitsSent to what conns have sent since the last call.
+   /// Main thread only.
+   static void updateSendStats(NetConnection **conns, U32 count);
+
    /// Begin to stop ghosting an object.
    void detachObject(GhostInfo *info);
 
@@ -888,18 +1104,34 @@ protected:
    /// The currently downloading file is always first in the list (ie, [0]).
    Vector<char *> mMissingFileList;
 
-   /// Stream for currently uploading file (if any).
-   Stream *mCurrentDownloadingFile;
+   /// The currently uploading file (if any), compressed if that made it
+   /// smaller.
+   U8 *mCurrentUploadBuffer;
 
-   /// Storage for currently downloading file.
+   /// Size of the currently uploading data in bytes.
+   U32 mCurrentUploadSize;
+
+   /// Our position in the currently uploading data in bytes.
+   U32 mCurrentUploadOffset;
+
+   /// Number of FileChunkEvents in flight.
+   U32 mFileChunksInFlight;
+
+   /// Storage for currently downloading file, as it's sent.
    void *mCurrentFileBuffer;
 
-   /// Size of currently downloading file in bytes.
+   /// Size of the currently downloading data in bytes.
    U32 mCurrentFileBufferSize;
 
-   /// Our position in the currently downloading file in bytes.
+   /// Our position in the currently downloading data in bytes.
    U32 mCurrentFileBufferOffset;
 
+   /// Size of the currently downloading file once it's uncompressed.
+   U32 mCurrentFileSize;
+
+   /// Is the currently downloading file compressed?
+   bool mCurrentFileCompressed;
+
    /// Number of files we have downloaded.
    U32 mNumDownloadedFiles;
 
@@ -919,15 +1151,29 @@ public:
    /// Start sending the specified file over the link.
    bool startSendingFile(const char *fileName);
 
+   /// Called when we receive a FileDownloadStartEvent.
+   void fileDownloadStarted(U32 fileSize, U32 transferSize, bool compressed);
+
    /// Called when we receive a FileChunkEvent.
    void chunkReceived(U8 *chunkData, U32 chunkLen);
 
    /// Get the next file...
    void sendNextFileDownloadRequest();
 
-   /// Post the next FileChunkEvent.
+   /// Post FileChunkEvents until the window is full.
    void sendFileChunk();
 
+   /// Called when a FileChunkEvent we sent has arrived.
+   void fileChunkDelivered();
+
+   /// Bytes of file data to send in each FileChunkEvent; a chunk takes up
+   /// most of a packet.
+   U32 getFileChunkSize();
+
+   /// Number of FileChunkEvents to keep in flight, enough to cover the
+   /// round trip at the packet rate.
+   U32 getFileChunkWindow();
+
    /// Called when we finish downloading file data.
    virtual void fileDownloadSegmentComplete();
 
@@ -1005,6 +1251,10 @@ public:  // required for MSVC
    U32 flags;                             ///< Flags from GhostInfo::Flags
    F32 priority;                          ///< A float value indicating the priority of this object for
                                           ///  updates.
+   F32 basePriority;                      ///< Cached result of NetObject::getUpdatePriority().
+   NetConnection::GhostSnapshot *baseline;///< Newest acknowledged delta snapshot, if any.
+   U32 priorityStamp;                     ///< Connection packet count when basePriority was computed.
+   U32 dirtyTime;                         ///< Virtual time the update mask last went nonzero.
 
    /// @name References
    ///
@@ -1037,9 +1287,16 @@ public:  // required for MSVC
       KillingGhost      = BIT(6),
       ScopedEvent       = BIT(7),
       ScopeLocalAlways  = BIT(8),
+      PriorityDirty     = BIT(9),      ///< Update mask changed, basePriority must be recomputed.
    };
 };
 
+inline GhostInfo *NetConnection::getGhostRef(U32 index)
+{
+   AssertFatal(index < mGhostCapacity, "NetConnection::getGhostRef: index out of range.");
+   return mGhostRefs[index / GhostBlockSize] + (index % GhostBlockSize);
+}
+
 inline void NetConnection::ghostPushNonZero(GhostInfo *info)
 {
    AssertFatal(info->arrayIndex >= mGhostZeroUpdateIndex && info->arrayIndex < mGhostFreeIndex, "Out of range arrayIndex.");
@@ -1052,6 +1309,8 @@ inline void NetConnection::ghostPushNonZero(GhostInfo *info)
       info->arrayIndex = mGhostZeroUpdateIndex;
    }
    mGhostZeroUpdateIndex++;
+   info->flags |= GhostInfo::PriorityDirty;
+   info->dirtyTime = Platform::getVirtualMilliseconds();
    //AssertFatal(validateGhostArray(), "Invalid ghost array!");
 }
 
@@ -10,6 +10,7 @@
 #include "core/bitStream.h"
 #include "sim/netObject.h"
 #include "core/resManager.h"
+#include "zlib.h"
 
 class FileDownloadRequestEvent : public NetEvent
 {
@@ -77,19 +78,66 @@ public:
 
 IMPLEMENT_CO_NETEVENT_V1(FileDownloadRequestEvent);
 
+class FileDownloadStartEvent : public NetEvent
+{
+public:
+   U32 fileSize;
+   U32 transferSize;
+   bool compressed;
+
+   FileDownloadStartEvent(U32 size = 0, U32 xferSize = 0, bool isCompressed = false)
+   {
+      fileSize = size;
+      transferSize = xferSize;
+      compressed = isCompressed;
+   }
+
+   virtual void pack(NetConnection *, BitStream *bstream)
+   {
+      bstream->write(fileSize);
+      if(bstream->writeFlag(compressed))
+         bstream->write(transferSize);
+   }
+
+   virtual void write(NetConnection *con, BitStream *bstream)
+   {
+      pack(con, bstream);
+   }
+
+   virtual void unpack(NetConnection *, BitStream *bstream)
+   {
+      bstream->read(&fileSize);
+      transferSize = fileSize;
+      compressed = bstream->readFlag();
+      if(compressed)
+         bstream->read(&transferSize);
+   }
+
+   virtual void process(NetConnection *connection)
+   {
+      connection->fileDownloadStarted(fileSize, transferSize, compressed);
+   }
+
+   DECLARE_CONOBJECT(FileDownloadStartEvent);
+};
+
+IMPLEMENT_CO_NETEVENT_V1(FileDownloadStartEvent);
+
 class FileChunkEvent : public NetEvent
 {
 public:
    enum
    {
-      ChunkSize = 63,
+      MinChunkSize = 63,
+      MaxChunkSize = 1024,
    };
 
-   U8 chunkData[ChunkSize];
+   U8 chunkData[MaxChunkSize];
    U32 chunkLen;
    
    FileChunkEvent(U8 *data = NULL, U32 len = 0)
    {
+      AssertFatal(len <= MaxChunkSize, "FileChunkEvent: chunk too large.");
       if(data)
          dMemcpy(chunkData, data, len);
       chunkLen = len;
@@ -97,19 +145,19 @@ public:
    
    virtual void pack(NetConnection *, BitStream *bstream)
    {
-      bstream->writeRangedU32(chunkLen, 0, ChunkSize);
+      bstream->writeRangedU32(chunkLen, 0, MaxChunkSize);
       bstream->write(chunkLen, chunkData);
    }
    
    virtual void write(NetConnection *, BitStream *bstream)
    {
-      bstream->writeRangedU32(chunkLen, 0, ChunkSize);
+      bstream->writeRangedU32(chunkLen, 0, MaxChunkSize);
       bstream->write(chunkLen, chunkData);
    }
    
    virtual void unpack(NetConnection *, BitStream *bstream)
    {
-      chunkLen = bstream->readRangedU32(0, ChunkSize);
+      chunkLen = bstream->readRangedU32(0, MaxChunkSize);
       bstream->read(chunkLen, chunkData);
    }
    
@@ -121,7 +169,9 @@ public:
    virtual void notifyDelivered(NetConnection *nc, bool madeIt)
    {
       if(!nc->isRemoved())
-        nc->sendFileChunk();
+      {
+         nc->fileChunkDelivered();
+      }
    }
    
    DECLARE_CONOBJECT(FileChunkEvent);
@@ -129,23 +179,50 @@ public:
 
 IMPLEMENT_CO_NETEVENT_V1(FileChunkEvent);
 
+U32 NetConnection::getFileChunkSize()
+{
+   // Leave room for the packet header, moves and whatever else is going out.
+   S32 size = getPacketSize() - 128;
+   return mClamp(size, S32(FileChunkEvent::MinChunkSize), S32(FileChunkEvent::MaxChunkSize));
+}
+
+U32 NetConnection::getFileChunkWindow()
+{
+   // A packet carries about one chunk, so this keeps every packet sent
+   // until the first ack comes back full, with some slack for drops.
+   U32 delay = getMax(getPacketUpdateDelay(), U32(1));
+   U32 window = (U32(mRoundTripTime) + delay - 1) / delay * 2;
+   return mClamp(window, U32(4), U32(64));
+}
+
 void NetConnection::sendFileChunk()
 {
-   U8 buffer[FileChunkEvent::ChunkSize];
-   U32 len = FileChunkEvent::ChunkSize;
-   if(len + mCurrentFileBufferOffset > mCurrentFileBufferSize)
-      len = mCurrentFileBufferSize - mCurrentFileBufferOffset;
+   if(!mCurrentUploadBuffer)
+      return;
 
-   if(!len)
+   U32 chunkSize = getFileChunkSize();
+   U32 window = getFileChunkWindow();
+   while(mFileChunksInFlight < window && mCurrentUploadOffset < mCurrentUploadSize)
    {
-      ResourceManager->closeStream(mCurrentDownloadingFile);
-      mCurrentDownloadingFile = NULL;
-      return;
+      U32 len = getMin(chunkSize, mCurrentUploadSize - mCurrentUploadOffset);
+      postNetEvent(new FileChunkEvent(mCurrentUploadBuffer + mCurrentUploadOffset, len));
+      mCurrentUploadOffset += len;
+      mFileChunksInFlight++;
    }
 
-   mCurrentFileBufferOffset += len;
-   mCurrentDownloadingFile->read(len, buffer);
-   postNetEvent(new FileChunkEvent(buffer, len));
+   if(mCurrentUploadOffset == mCurrentUploadSize)
+   {
+      delete [] mCurrentUploadBuffer;
+      mCurrentUploadBuffer = NULL;
+   }
+}
+
+void NetConnection::fileChunkDelivered()
+{
+   // The empty chunk for a missing file isn't counted.
+   if(mFileChunksInFlight)
+      mFileChunksInFlight--;
+   sendFileChunk();
 }
 
 bool NetConnection::startSendingFile(const char *fileName)
@@ -156,9 +233,9 @@ bool NetConnection::startSendingFile(const char *fileName)
       return false;
    }
 
-   mCurrentDownloadingFile = ResourceManager->openStream(fileName);
+   Stream *stream = ResourceManager->openStream(fileName);
 
-   if(!mCurrentDownloadingFile)
+   if(!stream)
    {
       // the server didn't have the file, so send a 0 byte chunk:
       Con::printf("No such file '%s'.", fileName);
@@ -166,14 +243,39 @@ bool NetConnection::startSendingFile(const char *fileName)
       return false;
    }
 
-   Con::printf("Sending file '%s'.", fileName);
-   mCurrentFileBufferSize = mCurrentDownloadingFile->getStreamSize();
-   mCurrentFileBufferOffset = 0;
+   U32 fileSize = stream->getStreamSize();
+   U8 *fileData = new U8[getMax(fileSize, U32(1))];
+   stream->read(fileSize, fileData);
+   ResourceManager->closeStream(stream);
 
-   // always have 32 file chunks (64 bytes each) in transit
-   sendConnectionMessage(FileDownloadSizeMessage, mCurrentFileBufferSize);
-   for(U32 i = 0; i < 32; i++)
-      sendFileChunk();
+   // Most game content packs down well, send it compressed when it does;
+   // compress2() fails if the result wouldn't be any smaller.
+   uLongf compressedSize = fileSize;
+   U8 *compressedData = new U8[getMax(fileSize, U32(1))];
+   S32 level = mClamp(Con::getIntVariable("$NetConnection::fileCompressionLevel", Z_DEFAULT_COMPRESSION), -1, 9);
+   bool compressed = level != 0 &&
+                     compress2(compressedData, &compressedSize, fileData, fileSize, level) == Z_OK &&
+                     compressedSize < fileSize;
+
+   delete [] mCurrentUploadBuffer;
+   if(compressed)
+   {
+      delete [] fileData;
+      mCurrentUploadBuffer = compressedData;
+      mCurrentUploadSize = compressedSize;
+      Con::printf("Sending file '%s' (%d bytes, %d compressed).", fileName, fileSize, mCurrentUploadSize);
+   }
+   else
+   {
+      delete [] compressedData;
+      mCurrentUploadBuffer = fileData;
+      mCurrentUploadSize = fileSize;
+      Con::printf("Sending file '%s' (%d bytes).", fileName, fileSize);
+   }
+   mCurrentUploadOffset = 0;
+
+   postNetEvent(new FileDownloadStartEvent(fileSize, mCurrentUploadSize, compressed));
+   sendFileChunk();
    return true;
 }
 
@@ -197,6 +299,20 @@ void NetConnection::sendNextFileDownloadRequest()
 }
 
 
+void NetConnection::fileDownloadStarted(U32 fileSize, U32 transferSize, bool compressed)
+{
+   if(!isGhostingTo() || (compressed && transferSize > fileSize) || (!compressed && transferSize != fileSize))
+   {
+      setLastError("Invalid packet.");
+      return;
+   }
+   mCurrentFileSize = fileSize;
+   mCurrentFileCompressed = compressed;
+   mCurrentFileBufferSize = transferSize;
+   mCurrentFileBuffer = dRealloc(mCurrentFileBuffer, mCurrentFileBufferSize);
+   mCurrentFileBufferOffset = 0;
+}
+
 void NetConnection::chunkReceived(U8 *chunkData, U32 chunkLen)
 {
    if(chunkLen == 0)
@@ -218,6 +334,22 @@ void NetConnection::chunkReceived(U8 *chunkData, U32 chunkLen)
    if(mCurrentFileBufferOffset == mCurrentFileBufferSize)
    {
       // this file's done...
+      if(mCurrentFileCompressed)
+      {
+         void *fileData = dMalloc(getMax(mCurrentFileSize, U32(1)));
+         uLongf fileSize = mCurrentFileSize;
+         if(uncompress((Bytef *) fileData, &fileSize, (Bytef *) mCurrentFileBuffer, mCurrentFileBufferSize) != Z_OK ||
+            fileSize != mCurrentFileSize)
+         {
+            dFree(fileData);
+            setLastError("Invalid file from server.");
+            return;
+         }
+         dFree(mCurrentFileBuffer);
+         mCurrentFileBuffer = fileData;
+         mCurrentFileBufferSize = mCurrentFileSize;
+      }
+
       // save it to disk:
       FileStream stream;
 
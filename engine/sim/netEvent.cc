@@ -8,6 +8,7 @@
 #include "console/simBase.h"
 #include "sim/netConnection.h"
 #include "core/bitStream.h"
+#include "sim/netClassStats.h"
 
 #define DebugChecksum 0xF00DBAAD
 
@@ -163,6 +164,9 @@ void NetConnection::eventWritePacket(BitStream *bstream, PacketNotify *notify)
 
    NetEventNote *packQueueHead = NULL, *packQueueTail = NULL;
 
+   // A run of events of one class only writes the class once.
+   S32 prevClassId = -1;
+
    while(mUnorderedSendEventQueueHead)
    {
       if(bstream->isFull())
@@ -174,10 +178,14 @@ void NetConnection::eventWritePacket(BitStream *bstream, PacketNotify *notify)
 
       bstream->writeFlag(true);
       S32 classId = ev->mEvent->getClassId(getNetClassGroup());
-      bstream->writeClassId(classId, NetClassTypeEvent, getNetClassGroup());
+      if(!bstream->writeFlag(classId == prevClassId))
+         bstream->writeClassId(classId, NetClassTypeEvent, getNetClassGroup());
+      prevClassId = classId;
 
       ev->mEvent->pack(this, bstream);
       DEBUG_LOG(("PKLOG %d EVENT %d: %s", getId(), bstream->getCurPos() - start, ev->mEvent->getDebugName()) );
+      if(NetClassStats *classStats = getWriteClassStats())
+         classStats->addEvent(classId, ev->mEvent->getClassName(), bstream->getCurPos() - start);
 
 #ifdef TORQUE_DEBUG_NET
       bstream->writeInt(classId ^ DebugChecksum, 32);
@@ -224,9 +232,13 @@ void NetConnection::eventWritePacket(BitStream *bstream, PacketNotify *notify)
 
       U32 start = bstream->getCurPos();
       S32 classId = ev->mEvent->getClassId(getNetClassGroup());
-      bstream->writeClassId(classId, NetClassTypeEvent, getNetClassGroup());
+      if(!bstream->writeFlag(classId == prevClassId))
+         bstream->writeClassId(classId, NetClassTypeEvent, getNetClassGroup());
+      prevClassId = classId;
       ev->mEvent->pack(this, bstream);
       DEBUG_LOG(("PKLOG %d EVENT %d: %s", getId(), bstream->getCurPos() - start, ev->mEvent->getDebugName()) );
+      if(NetClassStats *classStats = getWriteClassStats())
+         classStats->addEvent(classId, ev->mEvent->getClassName(), bstream->getCurPos() - start);
 #ifdef TORQUE_DEBUG_NET
       bstream->writeInt(classId ^ DebugChecksum, 32);
 #endif
@@ -246,6 +258,7 @@ void NetConnection::eventReadPacket(BitStream *bstream)
 #endif
 
    S32 prevSeq = -2;
+   S32 prevClassId = -1;
    NetEventNote **waitInsert = &mWaitSeqEvents;
    bool unguaranteedPhase = true;
 
@@ -270,7 +283,10 @@ void NetConnection::eventReadPacket(BitStream *bstream)
             seq = bstream->readInt(7);
          prevSeq = seq;
       }
-      S32 classId = bstream->readClassId(NetClassTypeEvent, getNetClassGroup());
+      S32 classId = prevClassId;
+      if(!bstream->readFlag())
+         classId = bstream->readClassId(NetClassTypeEvent, getNetClassGroup());
+      prevClassId = classId;
       if(classId == -1)
       {
          setLastError("Invalid packet.");
@@ -356,6 +372,24 @@ bool NetConnection::postNetEvent(NetEvent *theEvent)
       theEvent->decRef();
       return false;
    }
+   // Replace an older value on the same channel if it hasn't gone out yet.
+   U32 channel = theEvent->getChannel();
+   if(channel && theEvent->mGuaranteeType == NetEvent::Unguaranteed)
+   {
+      for(NetEventNote *walk = mUnorderedSendEventQueueHead; walk; walk = walk->mNextEvent)
+      {
+         NetEvent *older = walk->mEvent;
+         if(older->mGuaranteeType == NetEvent::Unguaranteed && older->getChannel() == channel &&
+            older->getClassRep() == theEvent->getClassRep())
+         {
+            theEvent->incRef();
+            walk->mEvent = theEvent;
+            older->decRef();
+            return true;
+         }
+      }
+   }
+
    NetEventNote *event = mEventNoteChunker.alloc();
    event->mEvent = theEvent;
    theEvent->incRef();
@@ -12,10 +12,12 @@
 #include "core/resManager.h"
 #include "console/console.h"
 #include "console/consoleTypes.h"
+#include "core/frameStats.h"
+#include "sim/netClassStats.h"
+#include "zlib.h"
 
 #define DebugChecksum 0xF00DBAAD
 
-extern U32 gGhostUpdates;
 
 class GhostAlwaysObjectEvent : public NetEvent
 {
@@ -38,7 +40,7 @@ public:
 
    void pack(NetConnection *ps, BitStream *bstream)
    {
-      bstream->writeInt(ghostIndex, NetConnection::GhostIdBitSize);
+      ps->packGhostIndex(bstream, ghostIndex);
 
       NetObject *obj = (NetObject *) Sim::findObject(objectId);
       if(bstream->writeFlag(obj != NULL))
@@ -50,7 +52,7 @@ public:
    }
    void write(NetConnection *ps, BitStream *bstream)
    {
-      bstream->writeInt(ghostIndex, NetConnection::GhostIdBitSize);
+      ps->packGhostIndex(bstream, ghostIndex);
       if(bstream->writeFlag(validObject))
       {
          S32 classId = object->getClassId(ps->getNetClassGroup());
@@ -60,7 +62,7 @@ public:
    }
    void unpack(NetConnection *ps, BitStream *bstream)
    {
-      ghostIndex = bstream->readInt(NetConnection::GhostIdBitSize);
+      ghostIndex = ps->unpackGhostIndex(bstream);
 
       if(bstream->readFlag())
       {
@@ -99,23 +101,252 @@ public:
 
 IMPLEMENT_CO_NETEVENT_V1(GhostAlwaysObjectEvent);
 
+//----------------------------------------------------------------------------
+
+/// A run of ghost always objects, sent in one event at connect.
+///
+/// The server packs the objects when ghosting starts, each as a
+/// GhostAlwaysObjectEvent would, byte aligned one after another, and
+/// deflates the lot.  Static objects of one kind that share a datablock
+/// pack to nearly the same bytes, so the repeats mostly compress away, and
+/// a batch fills a packet where one object each would mostly be headers.
+/// Batches are sized to stay under MaxBatchBytes deflated; that can be more
+/// than $pref::Net::PacketSize, so the packets during the ghost always
+/// phase run bigger than the connection's usual.
+///
+/// Ghost ids inside the objects are written at the width of the ghost
+/// table when they were packed, which is sent along, since the packet
+/// width may have changed by the time the event goes out.
+class GhostAlwaysBatchEvent : public NetEvent
+{
+   U32 mCount;
+   U32 mIdBitSize;
+   U32 mRawSize;
+   bool mDeflated;
+   Vector<U8> mData;
+
+   Vector<NetObject *> mObjects;
+   Vector<S32> mIndices;
+
+public:
+   enum
+   {
+      MaxBatchBytes   = 1024,     ///< Deflated.
+      MaxRawBytes     = 32768,
+      MaxBatchObjects = 1023,
+      CountBits       = 10,
+      SizeBits        = 16,
+   };
+
+   GhostAlwaysBatchEvent(U32 count = 0, U32 idBitSize = 0, const U8 *raw = NULL, U32 rawSize = 0,
+                         const U8 *packed = NULL, U32 packedSize = 0)
+   {
+      mCount = count;
+      mIdBitSize = idBitSize;
+      mRawSize = rawSize;
+      mDeflated = packed != NULL;
+      if(mDeflated)
+      {
+         mData.setSize(packedSize);
+         dMemcpy(mData.address(), packed, packedSize);
+      }
+      else if(raw)
+      {
+         mData.setSize(rawSize);
+         dMemcpy(mData.address(), raw, rawSize);
+      }
+   }
+   ~GhostAlwaysBatchEvent()
+   {
+      for(S32 i = 0; i < mObjects.size(); i++)
+         delete mObjects[i];
+   }
+
+   /// Deflates raw into out; returns the deflated size, 0 if it didn't shrink.
+   static U32 deflateBatch(const U8 *raw, U32 rawSize, Vector<U8> &out)
+   {
+      out.setSize(compressBound(rawSize));
+      uLongf size = out.size();
+      if(compress2(out.address(), &size, raw, rawSize, Z_BEST_COMPRESSION) != Z_OK || size >= rawSize)
+         return 0;
+      return U32(size);
+   }
+
+   void pack(NetConnection *, BitStream *bstream)
+   {
+      bstream->writeInt(mCount, CountBits);
+      bstream->writeInt(mIdBitSize - NetConnection::MinGhostIdBitSize, NetConnection::GhostIndexBitSize);
+      bstream->writeInt(mRawSize, SizeBits);
+      if(bstream->writeFlag(mDeflated))
+         bstream->writeInt(mData.size(), SizeBits);
+      bstream->write(mData.size(), mData.address());
+   }
+   void write(NetConnection *ps, BitStream *bstream)
+   {
+      pack(ps, bstream);
+   }
+   void unpack(NetConnection *ps, BitStream *bstream)
+   {
+      mCount = bstream->readInt(CountBits);
+      mIdBitSize = bstream->readInt(NetConnection::GhostIndexBitSize) + NetConnection::MinGhostIdBitSize;
+      mRawSize = bstream->readInt(SizeBits);
+      mDeflated = bstream->readFlag();
+      U32 dataSize = mDeflated ? bstream->readInt(SizeBits) : mRawSize;
+      if(mRawSize > MaxRawBytes || dataSize > MaxPacketDataSize ||
+         mIdBitSize > NetConnection::MaxGhostIdBitSize)
+      {
+         ps->setLastError("Invalid packet.");
+         return;
+      }
+      mData.setSize(dataSize);
+      bstream->read(dataSize, mData.address());
+
+      U8 *raw = mData.address();
+      Vector<U8> inflated;
+      if(mDeflated)
+      {
+         inflated.setSize(mRawSize);
+         uLongf size = mRawSize;
+         if(uncompress(inflated.address(), &size, mData.address(), dataSize) != Z_OK || size != mRawSize)
+         {
+            ps->setLastError("Invalid packet.");
+            return;
+         }
+         raw = inflated.address();
+      }
+
+      // The ids in here are at the width they were packed with.
+      U32 packetIdBitSize = ps->mRemoteGhostIdBitSize;
+      ps->mRemoteGhostIdBitSize = mIdBitSize;
+
+      BitStream stream(raw, mRawSize);
+      stream.setHuffmanTable(ps->mHuffmanTable);
+      for(U32 i = 0; i < mCount; i++)
+      {
+         S32 ghostIndex = ps->unpackGhostIndex(&stream);
+         NetObject *object;
+         if(stream.readFlag())
+         {
+            S32 classId = stream.readClassId(NetClassTypeObject, ps->getNetClassGroup());
+            object = classId == -1 ? NULL :
+               (NetObject *) ConsoleObject::create(ps->getNetClassGroup(), NetClassTypeObject, classId);
+            if(!object)
+            {
+               ps->setLastError("Invalid packet.");
+               break;
+            }
+            object->mNetFlags = NetObject::IsGhost;
+            object->mNetIndex = ghostIndex;
+            object->unpackUpdate(ps, &stream);
+         }
+         else
+            object = new NetObject;
+
+         mObjects.push_back(object);
+         mIndices.push_back(ghostIndex);
+
+         U32 pad = (8 - (stream.getCurPos() & 7)) & 7;
+         if(pad)
+            stream.readInt(pad);
+         if(!stream.isValid())
+         {
+            ps->setLastError("Invalid packet.");
+            break;
+         }
+      }
+      ps->mRemoteGhostIdBitSize = packetIdBitSize;
+   }
+   void process(NetConnection *ps)
+   {
+      for(S32 i = 0; i < mObjects.size(); i++)
+      {
+         Con::executef(1, "onGhostAlwaysObjectReceived");
+         ps->setGhostAlwaysObject(mObjects[i], mIndices[i]);
+      }
+      mObjects.clear();
+   }
+   DECLARE_CONOBJECT(GhostAlwaysBatchEvent);
+};
+
+IMPLEMENT_CO_NETEVENT_V1(GhostAlwaysBatchEvent);
+
+/// Posts the packed objects, ends[i] being where object i ends, as one
+/// GhostAlwaysBatchEvent, or as two halves if that doesn't deflate small
+/// enough.  target is the raw size to aim the next batch at.
+static void postGhostAlwaysBatch(NetConnection *conn, U32 idBitSize, const U8 *raw,
+                                 const U32 *ends, U32 count, U32 &target)
+{
+   static Vector<U8> packed;
+   U32 rawSize = ends[count - 1];
+   U32 packedSize = GhostAlwaysBatchEvent::deflateBatch(raw, rawSize, packed);
+   U32 size = packedSize ? packedSize : rawSize;
+
+   if(size > GhostAlwaysBatchEvent::MaxBatchBytes && count > 1)
+   {
+      U32 half = count / 2;
+      U32 offset = ends[half - 1];
+      Vector<U32> rest;
+      rest.setSize(count - half);
+      for(U32 i = half; i < count; i++)
+         rest[i - half] = ends[i] - offset;
+
+      postGhostAlwaysBatch(conn, idBitSize, raw, ends, half, target);
+      postGhostAlwaysBatch(conn, idBitSize, raw + offset, rest.address(), count - half, target);
+      return;
+   }
+
+   // Aim the next one at what would have just fit.
+   target = mClamp(rawSize * (GhostAlwaysBatchEvent::MaxBatchBytes * 7 / 8) / getMax(size, U32(1)),
+                   U32(256), U32(GhostAlwaysBatchEvent::MaxRawBytes));
+
+   conn->postNetEvent(new GhostAlwaysBatchEvent(count, idBitSize, raw, rawSize,
+                                                packedSize ? packed.address() : NULL, packedSize));
+}
+
 ConsoleMethod( NetConnection, getGhostsActive, S32, 2, 2, "()"
 			  "Returns number of ghosts active.")
 {
 	return object->getGhostsActive();
 }
 
+ConsoleMethod( NetConnection, setGhostUpdateBudget, void, 3, 3, "(int bytes)"
+              "Limit ghost updates to this many bytes per packet, 0 to use $pref::Net::GhostUpdateBudget.")
+{
+   object->setGhostUpdateBudget(dAtoi(argv[2]));
+}
+
 void NetConnection::setGhostTo(bool ghostTo)
 {
    if(mLocalGhosts) // if ghosting to this is already enabled, silently return
       return;
 
    if(ghostTo)
+      growLocalGhosts(0);
+}
+
+void NetConnection::growLocalGhosts(U32 index)
+{
+   AssertFatal(index < MaxGhostCount, "NetConnection::growLocalGhosts: ghost index out of range.");
+   if(mLocalGhosts && index < mLocalGhostCapacity)
+      return;
+
+   U32 capacity = getMax(mLocalGhostCapacity, U32(GhostBlockSize));
+   while(capacity <= index)
+      capacity <<= 1;
+
+   NetObject **localGhosts = new NetObject *[capacity];
+   GhostSnapshotHistory **localSnapshots = new GhostSnapshotHistory *[capacity];
+   for(U32 i = 0; i < capacity; i++)
    {
-      mLocalGhosts = new NetObject *[MaxGhostCount];
-      for(S32 i = 0; i < MaxGhostCount; i++)
-         mLocalGhosts[i] = NULL;
+      localGhosts[i] = i < mLocalGhostCapacity ? mLocalGhosts[i] : NULL;
+      localSnapshots[i] = i < mLocalGhostCapacity ? mLocalSnapshots[i] : NULL;
    }
+
+   delete[] mLocalGhosts;
+   delete[] mLocalSnapshots;
+   mLocalGhosts = localGhosts;
+   mLocalSnapshots = localSnapshots;
+   mLocalGhostCapacity = capacity;
 }
 
 void NetConnection::setGhostFrom(bool ghostFrom)
@@ -126,21 +357,244 @@ void NetConnection::setGhostFrom(bool ghostFrom)
    if(ghostFrom)
    {
       mGhostFreeIndex = mGhostZeroUpdateIndex = 0;
-      mGhostArray = new GhostInfo *[MaxGhostCount];
-      mGhostRefs = new GhostInfo[MaxGhostCount];
-      S32 i;
-      for(i = 0; i < MaxGhostCount; i++)
-      {
-         mGhostRefs[i].obj = NULL;
-         mGhostRefs[i].index = i;
-         mGhostRefs[i].updateMask = 0;
-      }
+      growGhostArray();
       mGhostLookupTable = new GhostInfo *[GhostLookupTableSize];
-      for(i = 0; i < GhostLookupTableSize; i++)
+      for(S32 i = 0; i < GhostLookupTableSize; i++)
          mGhostLookupTable[i] = 0;
    }
 }
 
+void NetConnection::growGhostArray()
+{
+   AssertFatal(mGhostCapacity < MaxGhostCount, "NetConnection::growGhostArray: already at MaxGhostCount.");
+
+   // The ghostInfos themselves never move, since they're referenced from
+   // the lookup table, the objects and the packet notifies. Only the array
+   // of pointers is reallocated.
+   GhostInfo *block = new GhostInfo[GhostBlockSize];
+   mGhostRefs.push_back(block);
+
+   U32 capacity = mGhostCapacity + GhostBlockSize;
+   GhostInfo **ghostArray = new GhostInfo *[capacity];
+   if(mGhostArray)
+      dMemcpy(ghostArray, mGhostArray, mGhostCapacity * sizeof(GhostInfo *));
+   delete[] mGhostArray;
+   mGhostArray = ghostArray;
+
+   // new entries go on the end of the free list
+   for(U32 i = 0; i < GhostBlockSize; i++)
+   {
+      GhostInfo *info = block + i;
+      info->obj = NULL;
+      info->index = mGhostCapacity + i;
+      info->updateMask = 0;
+      info->basePriority = 0;
+      info->priorityStamp = 0;
+      info->baseline = NULL;
+      info->arrayIndex = mGhostCapacity + i;
+      mGhostArray[info->arrayIndex] = info;
+   }
+   mGhostCapacity = capacity;
+}
+
+void NetConnection::updateGhostIdBitSize()
+{
+   if(!isGhostingFrom())
+   {
+      // Any ids we write refer to the other side's ghosts.
+      mGhostIdBitSize = mRemoteGhostIdBitSize;
+      return;
+   }
+
+   U32 maxIndex = 0;
+   for(U32 i = 0; i < mGhostFreeIndex; i++)
+      if(mGhostArray[i]->index > maxIndex)
+         maxIndex = mGhostArray[i]->index;
+
+   mGhostIdBitSize = MinGhostIdBitSize;
+   while(maxIndex >> mGhostIdBitSize)
+      mGhostIdBitSize++;
+}
+
+void NetConnection::packGhostIndex(BitStream *stream, S32 index)
+{
+   AssertFatal(index < (1 << mGhostIdBitSize), "NetConnection::packGhostIndex: index doesn't fit this packet's ghost id width.");
+   stream->writeInt(index, mGhostIdBitSize);
+}
+
+S32 NetConnection::unpackGhostIndex(BitStream *stream)
+{
+   return stream->readInt(mRemoteGhostIdBitSize);
+}
+
+//-----------------------------------------------------------------------------
+
+bool NetConnection::smDeltaBaselines = true;
+
+static inline U32 deltaFieldMask(U32 bitCount)
+{
+   return bitCount >= 32 ? 0xFFFFFFFF : (1 << bitCount) - 1;
+}
+
+void NetConnection::packDeltaHeader(BitStream *stream)
+{
+   mDeltaStarted = true;
+   mDeltaSnapshot = NULL;
+
+   // The client keeps a snapshot for every update it gets inside a ghost
+   // packet, so we have to as well, even when there's no baseline to use.
+   if(!mDeltaGhost)
+   {
+      stream->writeFlag(false);
+      return;
+   }
+
+   GhostSnapshot *base = mDeltaGhost->baseline;
+   if(!smDeltaBaselines || (base && mLastSendSeq - base->seq >= (1 << SnapshotSeqBits)))
+      base = NULL;
+
+   GhostSnapshot *snap = new GhostSnapshot;
+   if(base)
+      *snap = *base;
+   else
+      snap->validMask = 0;
+   snap->seq = mLastSendSeq;
+
+   AssertFatal(mDeltaRef->snapshot == NULL, "NetConnection::packDeltaHeader: update already has a snapshot.");
+   mDeltaRef->snapshot = snap;
+   mDeltaSnapshot = snap;
+
+   if(stream->writeFlag(base != NULL))
+      stream->writeInt(base->seq, SnapshotSeqBits);
+}
+
+void NetConnection::unpackDeltaHeader(BitStream *stream)
+{
+   mDeltaStarted = true;
+   mDeltaSnapshot = NULL;
+
+   bool hasBase = stream->readFlag();
+   U32 baseSeq = hasBase ? stream->readInt(SnapshotSeqBits) : 0;
+
+   if(mDeltaLocalIndex < 0)
+   {
+      if(hasBase)
+         setLastError("Invalid packet.");
+      return;
+   }
+
+   GhostSnapshotHistory *history = mLocalSnapshots[mDeltaLocalIndex];
+   if(!history)
+   {
+      history = new GhostSnapshotHistory;
+      history->count = history->head = 0;
+      mLocalSnapshots[mDeltaLocalIndex] = history;
+   }
+
+   // newest snapshot first, so a repeated sequence tag finds the right one
+   GhostSnapshot *base = NULL;
+   if(hasBase)
+   {
+      for(U32 i = 1; i <= history->count && !base; i++)
+      {
+         GhostSnapshot *entry = &history->entries[(history->head + SnapshotHistorySize - i) % SnapshotHistorySize];
+         if((entry->seq & ((1 << SnapshotSeqBits) - 1)) == baseSeq)
+            base = entry;
+      }
+      if(!base)
+      {
+         setLastError("Invalid packet.");
+         return;
+      }
+   }
+
+   // Copy the baseline before taking its slot, the ring may have wrapped onto it.
+   GhostSnapshot snap;
+   if(base)
+      snap = *base;
+   else
+      snap.validMask = 0;
+   snap.seq = mHandlingSeq;
+
+   mDeltaSnapshot = &history->entries[history->head];
+   *mDeltaSnapshot = snap;
+   history->head = (history->head + 1) % SnapshotHistorySize;
+   if(history->count < SnapshotHistorySize)
+      history->count++;
+}
+
+void NetConnection::clearLocalSnapshots(U32 index)
+{
+   if(mLocalSnapshots && index < mLocalGhostCapacity && mLocalSnapshots[index])
+      mLocalSnapshots[index]->count = mLocalSnapshots[index]->head = 0;
+}
+
+void NetConnection::packDeltaInt(BitStream *stream, U32 field, U32 value, U32 bitCount, U32 deltaBits)
+{
+   AssertFatal(field < MaxSnapshotFields, "NetConnection::packDeltaInt: field out of range.");
+   AssertFatal(deltaBits > 0 && deltaBits < bitCount, "NetConnection::packDeltaInt: bad delta size.");
+
+   if(!mDeltaStarted)
+      packDeltaHeader(stream);
+
+   U32 mask = deltaFieldMask(bitCount);
+   value &= mask;
+
+   GhostSnapshot *snap = mDeltaSnapshot;
+   if(snap && (snap->validMask & BIT(field)))
+   {
+      // signed difference in bitCount wide modular arithmetic
+      S32 diff = S32((value - snap->values[field]) << (32 - bitCount)) >> (32 - bitCount);
+      S32 range = 1 << (deltaBits - 1);
+      if(diff >= -range && diff < range)
+      {
+         stream->writeFlag(true);
+         stream->writeInt(diff & ((1 << deltaBits) - 1), deltaBits);
+         snap->values[field] = value;
+         return;
+      }
+   }
+   stream->writeFlag(false);
+   stream->writeInt(value, bitCount);
+   if(snap)
+   {
+      snap->values[field] = value;
+      snap->validMask |= BIT(field);
+   }
+}
+
+U32 NetConnection::unpackDeltaInt(BitStream *stream, U32 field, U32 bitCount, U32 deltaBits)
+{
+   AssertFatal(field < MaxSnapshotFields, "NetConnection::unpackDeltaInt: field out of range.");
+
+   if(!mDeltaStarted)
+      unpackDeltaHeader(stream);
+
+   U32 mask = deltaFieldMask(bitCount);
+   GhostSnapshot *snap = mDeltaSnapshot;
+   U32 value;
+   if(stream->readFlag())
+   {
+      if(!snap || !(snap->validMask & BIT(field)))
+      {
+         setLastError("Invalid packet.");
+         stream->readInt(deltaBits);
+         return 0;
+      }
+      S32 diff = S32(U32(stream->readInt(deltaBits)) << (32 - deltaBits)) >> (32 - deltaBits);
+      value = (snap->values[field] + diff) & mask;
+   }
+   else
+      value = U32(stream->readInt(bitCount)) & mask;
+
+   if(snap)
+   {
+      snap->values[field] = value;
+      snap->validMask |= BIT(field);
+   }
+   return value;
+}
+
 void NetConnection::ghostOnRemove()
 {
    if(mGhostArray)
@@ -182,8 +636,11 @@ void NetConnection::ghostPacketDropped(PacketNotify *notify)
             packRef->ghost->updateMask = orFlags;
             ghostPushNonZero(packRef->ghost);
          }
-         else
+         else if((packRef->ghost->updateMask | orFlags) != packRef->ghost->updateMask)
+         {
             packRef->ghost->updateMask |= orFlags;
+            packRef->ghost->flags |= GhostInfo::PriorityDirty;
+         }
       }
 
       // if this packet was ghosting an object, set it
@@ -204,6 +661,7 @@ void NetConnection::ghostPacketDropped(PacketNotify *notify)
          packRef->ghost->flags &= ~GhostInfo::KillingGhost;
       }
 
+      delete packRef->snapshot;
       delete packRef;
       packRef = temp;
    }
@@ -230,6 +688,13 @@ void NetConnection::ghostPacketReceived(PacketNotify *notify)
 
       *walk = 0;
 
+      // acked delta state becomes the new baseline
+      if(packRef->snapshot)
+      {
+         delete packRef->ghost->baseline;
+         packRef->ghost->baseline = packRef->snapshot;
+      }
+
       // if this object was ghosting , it is now ghosted
 
       if(packRef->ghostInfoFlags & GhostInfo::Ghosting)
@@ -245,22 +710,78 @@ void NetConnection::ghostPacketReceived(PacketNotify *notify)
    }
 }
 
-struct UpdateQueueEntry
+U32 NetConnection::smGhostUpdateBudget = 0;
+U32 NetConnection::smGhostPriorityRefresh = 4;
+bool NetConnection::smBatchGhostAlways = true;
+
+/// How much a ghost's cached priority grows for each packet it waits.
+static const F32 csmGhostStalenessScale = 0.25f;
+
+// Max-heap helpers for the ghost update queue; the scratch list is
+// heapified in place and popped until the packet or budget is full.
+static void ghostHeapSiftDown(GhostInfo **heap, S32 count, S32 i)
 {
-   F32 priority;
-   GhostInfo *obj;
+   GhostInfo *item = heap[i];
+   for(;;)
+   {
+      S32 child = i * 2 + 1;
+      if(child >= count)
+         break;
+      if(child + 1 < count && heap[child + 1]->priority > heap[child]->priority)
+         child++;
+      if(heap[child]->priority <= item->priority)
+         break;
+      heap[i] = heap[child];
+      i = child;
+   }
+   heap[i] = item;
+}
 
-   UpdateQueueEntry(F32 in_priority, GhostInfo *in_obj)
-      { priority = in_priority; obj = in_obj; }
-};
+static GhostInfo *ghostHeapPop(GhostInfo **heap, S32 &count)
+{
+   GhostInfo *top = heap[0];
+   if(--count > 0)
+   {
+      heap[0] = heap[count];
+      ghostHeapSiftDown(heap, count, 0);
+   }
+   return top;
+}
 
-static S32 QSORT_CALLBACK UQECompare(const void *a,const void *b)
+void NetConnection::ghostUpdatePriorities(CameraScopeQuery *camInfo)
 {
-   GhostInfo *ga = *((GhostInfo **) a);
-   GhostInfo *gb = *((GhostInfo **) b);
+   mGhostUpdateHeap.clear();
+   for(S32 i = mGhostZeroUpdateIndex - 1; i >= 0; i--)
+   {
+      GhostInfo *walk = mGhostArray[i];
 
-   F32 ret = ga->priority - gb->priority;
-   return (ret < 0) ? -1 : ((ret > 0) ? 1 : 0);
+      // objects being killed or in the process of ghosting wait for an ack
+      if(walk->flags & (GhostInfo::KillingGhost | GhostInfo::Ghosting))
+         continue;
+
+      if(walk->flags & GhostInfo::KillGhost)
+         walk->priority = 10000;
+      else
+      {
+         // only ask the object when something changed, or the cached
+         // priority is old enough that the camera has probably moved.
+         U32 age = mGhostPacketCount - walk->priorityStamp;
+         if((walk->flags & (GhostInfo::PriorityDirty | GhostInfo::NotYetGhosted)) ||
+               age >= smGhostPriorityRefresh)
+         {
+            walk->basePriority = walk->obj->getUpdatePriority(camInfo, walk->updateMask, walk->updateSkipCount);
+            walk->priorityStamp = mGhostPacketCount;
+            walk->flags &= ~GhostInfo::PriorityDirty;
+            age = 0;
+         }
+         walk->priority = walk->basePriority * (1.0f + age * csmGhostStalenessScale);
+      }
+      mGhostUpdateHeap.push_back(walk);
+   }
+
+   S32 count = mGhostUpdateHeap.size();
+   for(S32 i = count / 2 - 1; i >= 0; i--)
+      ghostHeapSiftDown(mGhostUpdateHeap.address(), count, i);
 }
 
 void NetConnection::ghostWritePacket(BitStream *bstream, PacketNotify *notify)
@@ -270,6 +791,7 @@ void NetConnection::ghostWritePacket(BitStream *bstream, PacketNotify *notify)
 #endif
 
    notify->ghostList = NULL;
+   mGhostHeapCount = 0;
 
    if(!isGhostingFrom())
       return;
@@ -329,28 +851,10 @@ void NetConnection::ghostWritePacket(BitStream *bstream, PacketNotify *notify)
 
       // clear out any kill objects that haven't been ghosted yet
       if((walk->flags & GhostInfo::KillGhost) && (walk->flags & GhostInfo::NotYetGhosted))
-      {
          freeGhostInfo(walk);
-         continue;
-      }
-      // don't do any ghost processing on objects that are being killed
-      // or in the process of ghosting
-      else if(!(walk->flags & (GhostInfo::KillingGhost | GhostInfo::Ghosting)))
-      {
-         if(walk->flags & GhostInfo::KillGhost)
-            walk->priority = 10000;
-         else
-            walk->priority = walk->obj->getUpdatePriority(&camInfo, walk->updateMask, walk->updateSkipCount);
-      }
-      else
-         walk->priority = 0;
    }
-   GhostRef *updateList = NULL;
-   dQsort(mGhostArray, mGhostZeroUpdateIndex, sizeof(GhostInfo *), UQECompare);
-
-   // reset the array indices...
-   for(i = mGhostZeroUpdateIndex - 1; i >= 0; i--)
-      mGhostArray[i]->arrayIndex = i;
+   ghostUpdatePriorities(&camInfo);
+   mGhostPacketCount++;
 
    S32 sendSize = 1;
    while(maxIndex >>= 1)
@@ -361,28 +865,54 @@ void NetConnection::ghostWritePacket(BitStream *bstream, PacketNotify *notify)
 
    bstream->writeInt(sendSize - 3, GhostIndexBitSize);
 
-   U32 count = 0;
-   //
-   for(i = mGhostZeroUpdateIndex - 1; i >= 0 && !bstream->isFull(); i--)
+   mGhostSendSize = sendSize;
+   mGhostPacketTime = Platform::getVirtualMilliseconds();
+   mGhostHeapCount = mGhostUpdateHeap.size();
+   mGhostBudgetBits = getGhostUpdateBudget() << 3;
+   mGhostBudgetStart = bstream->getCurPos();
+   mGhostUpdatesPending = true;
+
+   // checkPacketSends() writes the updates itself, possibly from another thread.
+   if(mDeferGhostUpdates)
+      return;
+
+   ghostWriteUpdates(bstream, notify, false);
+   ghostEndPacket(bstream, notify);
+}
+
+void NetConnection::ghostWriteUpdates(BitStream *bstream, PacketNotify *notify, bool parallelOnly)
+{
+   if(!mGhostUpdatesPending)
+      return;
+
+   while(mGhostHeapCount && !bstream->isFull())
    {
-      GhostInfo *walk = mGhostArray[i];
-		if(walk->flags & (GhostInfo::KillingGhost | GhostInfo::Ghosting))
-		   continue;
-		
+      if(mGhostBudgetBits && bstream->getCurPos() - mGhostBudgetStart >= mGhostBudgetBits)
+         break;
+
+      // Updates have to go out in priority order, so the parallel pass
+      // stops at the first object that can't be packed off the main thread.
+      GhostInfo *walk = mGhostUpdateHeap[0];
+      if(parallelOnly && !(walk->flags & GhostInfo::KillGhost) &&
+            !walk->obj->isParallelPackSafe(walk->updateMask))
+         break;
+
+      ghostHeapPop(mGhostUpdateHeap.address(), mGhostHeapCount);
       bstream->writeFlag(true);
 
-      bstream->writeInt(walk->index, sendSize);
+      bstream->writeInt(walk->index, mGhostSendSize);
       U32 updateMask = walk->updateMask;
 
       GhostRef *upd = new GhostRef;
 
-      upd->nextRef = updateList;
-      updateList = upd;
+      upd->nextRef = notify->ghostList;
+      notify->ghostList = upd;
       upd->nextUpdateChain = walk->updateChain;
       walk->updateChain = upd;
 
       upd->ghost = walk;
       upd->ghostInfoFlags = 0;
+      upd->snapshot = NULL;
 
       if(walk->flags & GhostInfo::KillGhost)
       {
@@ -418,11 +948,29 @@ void NetConnection::ghostWritePacket(BitStream *bstream, PacketNotify *notify)
          }
 #endif
          // update the object
+         mDeltaGhost = walk;
+         mDeltaRef = upd;
+         mDeltaStarted = false;
+         NetClassStats *classStats = getWriteClassStats();
+         U64 packStart = classStats ? Platform::getRealMicroseconds() : 0;
          U32 retMask = walk->obj->packUpdate(this, updateMask, bstream);
+         STAT_INC(GhostsSent);
+         if(classStats)
+            classStats->addGhost(walk->obj->getClassId(getNetClassGroup()), walk->obj->getClassName(), updateMask,
+                                 bstream->getCurPos() - startPos, U32(Platform::getRealMicroseconds() - packStart));
+         mDeltaGhost = NULL;
+         mDeltaRef = NULL;
+         mDeltaStarted = false;
          DEBUG_LOG(("PKLOG %d GHOST %d: %s", getId(), bstream->getCurPos() - 16 - startPos, walk->obj->getClassName()));
 
          AssertFatal((retMask & (~updateMask)) == 0, "Cannot set new bits in packUpdate return");
 
+         U32 latency = mGhostPacketTime - walk->dirtyTime;
+         mGhostLatencyCount++;
+         mGhostLatencyTotal += latency;
+         if(latency > mGhostLatencyMax)
+            mGhostLatencyMax = latency;
+
          walk->updateMask = retMask;
          if(!retMask)
             ghostPushToZero(walk);
@@ -435,16 +983,22 @@ void NetConnection::ghostWritePacket(BitStream *bstream, PacketNotify *notify)
 #endif
       }
       walk->updateSkipCount = 0;
-      count++;
    }
-   //Con::printf("Ghosts updated: %d (%d remain)", count, mGhostZeroUpdateIndex);
+}
+
+void NetConnection::ghostEndPacket(BitStream *bstream, PacketNotify *)
+{
+   if(!mGhostUpdatesPending)
+      return;
+
    // no more objects...
    bstream->writeFlag(false);
-   notify->ghostList = updateList;
+   mGhostUpdatesPending = false;
 }
 
 void NetConnection::ghostReadPacket(BitStream *bstream)
 {
+   MemoryTagScope tagScope(Memory::TagGhost);
 #ifdef    TORQUE_DEBUG_NET
    U32 sum = bstream->readInt(32);
    AssertISV(sum == DebugChecksum, "Invalid checksum.");
@@ -458,23 +1012,30 @@ void NetConnection::ghostReadPacket(BitStream *bstream)
    S32 idSize;
    idSize = bstream->readInt( GhostIndexBitSize);
    idSize += 3;
+   if(idSize > MaxGhostIdBitSize)
+   {
+      setLastError("Invalid packet.");
+      return;
+   }
 
    // while there's an object waiting...
 
    while(bstream->readFlag())
    {
 
-	  gGhostUpdates++;
+      mGhostUpdatesRead++;
 
       U32 index;
       //S32 startPos = bstream->getCurPos();
       index = (U32) bstream->readInt(idSize);
+      growLocalGhosts(index);
       if(bstream->readFlag()) // is this ghost being deleted?
       {
 		 mGhostsActive--;
          AssertFatal(mLocalGhosts[index] != NULL, "Error, NULL ghost encountered.");
          mLocalGhosts[index]->deleteObject();
          mLocalGhosts[index] = NULL;
+         clearLocalSnapshots(index);
       }
       else
       {
@@ -500,6 +1061,7 @@ void NetConnection::ghostReadPacket(BitStream *bstream)
 
             obj->mNetIndex = index;
             mLocalGhosts[index] = obj;
+            clearLocalSnapshots(index);
 #ifdef TORQUE_DEBUG_NET
             U32 checksum = bstream->readInt(32);
             S32 origId = checksum ^ DebugChecksum;
@@ -508,7 +1070,11 @@ void NetConnection::ghostReadPacket(BitStream *bstream)
                avar("class id mismatch for dest class %s.",
                   mLocalGhosts[index]->getClassName()) );
 #endif
+            mDeltaLocalIndex = index;
+            mDeltaStarted = false;
             mLocalGhosts[index]->unpackUpdate(this, bstream);
+            mDeltaLocalIndex = -1;
+            mDeltaStarted = false;
 
             if(!obj->registerObject())
             {
@@ -532,7 +1098,11 @@ void NetConnection::ghostReadPacket(BitStream *bstream)
                avar("class id mismatch for dest class %s.",
                   mLocalGhosts[index]->getClassName()) );
 #endif
+            mDeltaLocalIndex = index;
+            mDeltaStarted = false;
             mLocalGhosts[index]->unpackUpdate(this, bstream);
+            mDeltaLocalIndex = -1;
+            mDeltaStarted = false;
          }
          //PacketStream::getStats()->addBits(PacketStats::Receive, bstream->getCurPos() - startPos, ghostRefs[index].localGhost->getPersistTag());
 #ifdef TORQUE_DEBUG_NET
@@ -607,6 +1177,9 @@ void NetConnection::freeGhostInfo(GhostInfo *ghost)
    }
    ghostPushZeroToFree(ghost);
    AssertFatal(ghost->updateChain == NULL, "Ack!");
+
+   delete ghost->baseline;
+   ghost->baseline = NULL;
 }
 
 //-----------------------------------------------------------------------------
@@ -641,7 +1214,7 @@ void NetConnection::objectLocalClearAlways(NetObject *obj)
 bool NetConnection::validateGhostArray()
 {
    AssertFatal(mGhostZeroUpdateIndex >= 0 && mGhostZeroUpdateIndex <= mGhostFreeIndex, "Invalid update index range.");
-   AssertFatal(mGhostFreeIndex <= MaxGhostCount, "Invalid free index range.");
+   AssertFatal(mGhostFreeIndex <= mGhostCapacity, "Invalid free index range.");
    U32 i;
    for(i = 0; i < mGhostZeroUpdateIndex; i ++)
    {
@@ -653,7 +1226,7 @@ bool NetConnection::validateGhostArray()
       AssertFatal(mGhostArray[i]->arrayIndex == i, "Invalid array index.");
       AssertFatal(mGhostArray[i]->updateMask == 0, "Invalid ghost mask.");
    }
-   for(; i < MaxGhostCount; i++)
+   for(; i < mGhostCapacity; i++)
    {
       AssertFatal(mGhostArray[i]->arrayIndex == i, "Invalid array index.");
    }
@@ -681,10 +1254,14 @@ void NetConnection::objectInScope(NetObject *obj)
       return;
    }
 
-   if (mGhostFreeIndex == MaxGhostCount)
+   if (mGhostFreeIndex == mGhostCapacity)
    {
-      AssertWarn(0,"NetConnection::objectInScope: too many ghosts");
-      return;
+      if (mGhostCapacity == MaxGhostCount)
+      {
+         AssertWarn(0,"NetConnection::objectInScope: too many ghosts");
+         return;
+      }
+      growGhostArray();
    }
 
    GhostInfo *giptr = mGhostArray[mGhostFreeIndex];
@@ -719,7 +1296,6 @@ void NetConnection::objectInScope(NetObject *obj)
 void NetConnection::handleConnectionMessage(U32 message, U32 sequence, U32 ghostCount)
 {
    if((  message == SendNextDownloadRequest
-      || message == FileDownloadSizeMessage
       || message == GhostAlwaysStarting
       || message == GhostAlwaysDone
       || message == EndGhosting) && !isGhostingTo())
@@ -758,13 +1334,14 @@ void NetConnection::handleConnectionMessage(U32 message, U32 sequence, U32 ghost
       case EndGhosting:
          // just delete all the local ghosts,
          // and delete all the ghosts in the current save list
-         for(i = 0; i < MaxGhostCount; i++)
+         for(i = 0; i < mLocalGhostCapacity; i++)
          {
             if(mLocalGhosts[i])
             {
                mLocalGhosts[i]->deleteObject();
                mLocalGhosts[i] = NULL;
             }
+            clearLocalSnapshots(i);
          }
          while(mGhostAlwaysSaveList.size())
          {
@@ -778,11 +1355,6 @@ void NetConnection::handleConnectionMessage(U32 message, U32 sequence, U32 ghost
       case SendNextDownloadRequest:
          sendNextFileDownloadRequest();
          break;
-      case FileDownloadSizeMessage:
-         mCurrentFileBufferSize = sequence;
-         mCurrentFileBuffer = dRealloc(mCurrentFileBuffer, mCurrentFileBufferSize);
-         mCurrentFileBufferOffset = 0;
-         break;
    }
 }
 
@@ -802,19 +1374,13 @@ void NetConnection::activateGhosting()
 
    AssertFatal((mGhostFreeIndex == 0) && (mGhostZeroUpdateIndex == 0), "Error: ghosts in the ghost list before activate.");
 
-   U32 sz = ghostAlwaysSet->size();
    S32 j;
 
-   for(j = 0; j < sz; j++)
+   // Hand out indices from the bottom up, ghost always objects first, so
+   // the ghost ids stay as narrow as possible.
+   for(j = 0; j < mGhostCapacity; j++)
    {
-      U32 idx = MaxGhostCount - sz + j;
-      mGhostArray[j] = mGhostRefs + idx;
-      mGhostArray[j]->arrayIndex = j;
-   }
-   for(j = sz; j < MaxGhostCount; j++)
-   {
-      U32 idx = j - sz;
-      mGhostArray[j] = mGhostRefs + idx;
+      mGhostArray[j] = getGhostRef(j);
       mGhostArray[j]->arrayIndex = j;
    }
    mScoping = true; // so that objectInScope will work
@@ -826,6 +1392,17 @@ void NetConnection::activateGhosting()
          objectInScope(obj);
    }
    sendConnectionMessage(GhostAlwaysStarting, mGhostingSequence, ghostAlwaysSet->size());
+
+   // Batched objects are packed now, at the width of the whole ghost
+   // always set; the packet width is back to normal after.
+   U32 packetIdBitSize = mGhostIdBitSize;
+   updateGhostIdBitSize();
+   U32 batchIdBitSize = mGhostIdBitSize;
+   U32 batchTarget = 4096;
+   InfiniteBitStream batch;
+   batch.setHuffmanTable(mHuffmanTable);
+   Vector<U32> batchEnds;
+
    for(j = mGhostZeroUpdateIndex - 1; j >= 0; j--)
    {
       AssertFatal((mGhostArray[j]->flags & GhostInfo::ScopeAlways) != 0, "Non-scope always in the scope always list.")
@@ -837,8 +1414,33 @@ void NetConnection::activateGhosting()
       mGhostArray[j]->flags &= ~GhostInfo::NotYetGhosted;
       mGhostArray[j]->flags |= GhostInfo::ScopedEvent;
 
-      postNetEvent(new GhostAlwaysObjectEvent(mGhostArray[j]->obj, mGhostArray[j]->index));
+      if(!smBatchGhostAlways)
+      {
+         postNetEvent(new GhostAlwaysObjectEvent(mGhostArray[j]->obj, mGhostArray[j]->index));
+         continue;
+      }
+
+      NetObject *obj = mGhostArray[j]->obj;
+      packGhostIndex(&batch, mGhostArray[j]->index);
+      batch.writeFlag(true);
+      batch.writeClassId(obj->getClassId(getNetClassGroup()), NetClassTypeObject, getNetClassGroup());
+      obj->packUpdate(this, 0xFFFFFFFF, &batch);
+      U32 pad = (8 - (batch.getCurPos() & 7)) & 7;
+      if(pad)
+         batch.writeInt(0, pad);
+      batchEnds.push_back(batch.getPosition());
+
+      if(batch.getPosition() >= batchTarget || batchEnds.size() == GhostAlwaysBatchEvent::MaxBatchObjects)
+      {
+         postGhostAlwaysBatch(this, batchIdBitSize, batch.getBuffer(), batchEnds.address(), batchEnds.size(), batchTarget);
+         batch.reset();
+         batchEnds.clear();
+      }
    }
+   if(batchEnds.size())
+      postGhostAlwaysBatch(this, batchIdBitSize, batch.getBuffer(), batchEnds.address(), batchEnds.size(), batchTarget);
+   mGhostIdBitSize = packetIdBitSize;
+
    sendConnectionMessage(GhostAlwaysDone, mGhostingSequence);
    //AssertFatal(validateGhostArray(), "Invalid ghost array!");
 }
@@ -851,12 +1453,13 @@ void NetConnection::clearGhostInfo()
       ghostPacketReceived(walk);
       walk->ghostList = NULL;
    }
-   for(S32 i = 0; i < MaxGhostCount; i++)
+   for(U32 i = 0; i < mGhostCapacity; i++)
    {
-      if(mGhostRefs[i].arrayIndex < mGhostFreeIndex)
+      GhostInfo *info = getGhostRef(i);
+      if(info->arrayIndex < mGhostFreeIndex)
       {
-         detachObject(&mGhostRefs[i]);
-         freeGhostInfo(&mGhostRefs[i]);
+         detachObject(info);
+         freeGhostInfo(info);
       }
    }
    AssertFatal((mGhostFreeIndex == 0) && (mGhostZeroUpdateIndex == 0), "Invalid indices.");
@@ -979,6 +1582,7 @@ void NetConnection::loadNextGhostAlwaysObject(bool hadNewFiles)
       addObject(object);
       mGhostAlwaysSaveList.pop_front();
 
+      growLocalGhosts(index);
       AssertFatal(mLocalGhosts[index] == NULL, "Ghost already in table!");
       mLocalGhosts[index] = object;
       hadNewFiles = true;
@@ -989,12 +1593,16 @@ void NetConnection::loadNextGhostAlwaysObject(bool hadNewFiles)
 
 NetObject *NetConnection::resolveGhost(S32 id)
 {
+   if(U32(id) >= mLocalGhostCapacity)
+      return NULL;
    return mLocalGhosts[id];
 }
 
 NetObject *NetConnection::resolveObjectFromGhostIndex(S32 id)
 {
-   return mGhostRefs[id].obj;
+   if(U32(id) >= mGhostCapacity)
+      return NULL;
+   return getGhostRef(id)->obj;
 }
 
 S32 NetConnection::getGhostIndex(NetObject *obj)
@@ -1029,12 +1637,12 @@ void NetConnection::ghostWriteStartBlock(ResizeBitStream *stream)
    stream->write(mGhostingSequence);
 
    // first write out the indices and ids:
-   for(U32 i = 0; i < MaxGhostCount; i++)
+   for(U32 i = 0; i < mLocalGhostCapacity; i++)
    {
       if(mLocalGhosts[i])
       {
          stream->writeFlag(true);
-         stream->writeInt(i, GhostIdBitSize);
+         stream->writeInt(i, MaxGhostIdBitSize);
          stream->writeClassId(mLocalGhosts[i]->getClassId(getNetClassGroup()), NetClassTypeObject, getNetClassGroup());
          stream->validate();
       }
@@ -1048,7 +1656,7 @@ void NetConnection::ghostWriteStartBlock(ResizeBitStream *stream)
    // then, for each ghost written into the start block, write the full pack update
    // into the start block.  For demos to work properly, packUpdate must
    // be callable from client objects.
-   for(U32 i = 0; i < MaxGhostCount; i++)
+   for(U32 i = 0; i < mLocalGhostCapacity; i++)
    {
       if(mLocalGhosts[i])
       {
@@ -1056,6 +1664,29 @@ void NetConnection::ghostWriteStartBlock(ResizeBitStream *stream)
          stream->validate();
       }
    }
+
+   // recorded packets may delta against any snapshot we're holding, so
+   // the histories have to come along too.
+   for(U32 i = 0; i < mLocalGhostCapacity; i++)
+   {
+      if(!mLocalGhosts[i])
+         continue;
+      GhostSnapshotHistory *history = mLocalSnapshots[i];
+      if(!stream->writeFlag(history && history->count))
+         continue;
+      stream->writeInt(history->count, 6);
+      stream->writeInt(history->head, 5);
+      for(U32 j = 0; j < history->count; j++)
+      {
+         GhostSnapshot &snap = history->entries[(history->head + SnapshotHistorySize - 1 - j) % SnapshotHistorySize];
+         stream->write(snap.seq);
+         stream->writeInt(snap.validMask, MaxSnapshotFields);
+         for(U32 k = 0; k < MaxSnapshotFields; k++)
+            if(snap.validMask & BIT(k))
+               stream->write(snap.values[k]);
+      }
+      stream->validate();
+   }
 }
 
 void NetConnection::ghostReadStartBlock(BitStream *stream)
@@ -1067,7 +1698,7 @@ void NetConnection::ghostReadStartBlock(BitStream *stream)
 
    while(stream->readFlag())
    {
-      U32 index = stream->readInt(GhostIdBitSize);
+      U32 index = stream->readInt(MaxGhostIdBitSize);
       S32 tag = stream->readClassId(NetClassTypeObject, getNetClassGroup());
       NetObject *obj = (NetObject *) ConsoleObject::create(getNetClassGroup(), NetClassTypeObject, tag);
       if(!obj)
@@ -1077,6 +1708,7 @@ void NetConnection::ghostReadStartBlock(BitStream *stream)
       }
       obj->mNetFlags = NetObject::IsGhost;
       obj->mNetIndex = index;
+      growLocalGhosts(index);
       mLocalGhosts[index] = obj;
    }
 
@@ -1084,7 +1716,7 @@ void NetConnection::ghostReadStartBlock(BitStream *stream)
    // through all non-null mLocalGhosts, unpacking the objects
    // as we go:
 
-   for(U32 i = 0; i < MaxGhostCount; i++)
+   for(U32 i = 0; i < mLocalGhostCapacity; i++)
    {
       if(mLocalGhosts[i])
       {
@@ -1098,6 +1730,35 @@ void NetConnection::ghostReadStartBlock(BitStream *stream)
          addObject(mLocalGhosts[i]);
       }
    }
+
+   for(U32 i = 0; i < mLocalGhostCapacity; i++)
+   {
+      if(!mLocalGhosts[i] || !stream->readFlag())
+         continue;
+      GhostSnapshotHistory *history = mLocalSnapshots[i];
+      if(!history)
+      {
+         history = new GhostSnapshotHistory;
+         mLocalSnapshots[i] = history;
+      }
+      history->count = stream->readInt(6);
+      history->head = stream->readInt(5);
+      if(history->count > SnapshotHistorySize)
+      {
+         history->count = history->head = 0;
+         setLastError("Invalid packet.");
+         return;
+      }
+      for(U32 j = 0; j < history->count; j++)
+      {
+         GhostSnapshot &snap = history->entries[(history->head + SnapshotHistorySize - 1 - j) % SnapshotHistorySize];
+         stream->read(&snap.seq);
+         snap.validMask = stream->readInt(MaxSnapshotFields);
+         for(U32 k = 0; k < MaxSnapshotFields; k++)
+            if(snap.validMask & BIT(k))
+               stream->read(&snap.values[k]);
+      }
+   }
    // MARKF - TODO - looks like we could have memory leaks here
    // if there are errors.
 }
@@ -13,6 +13,9 @@
 
 NetInterface *GNet = NULL;
 
+S32 NetInterface::smConnectRequestRate = 2;
+S32 NetInterface::smConnectRequestBurst = 8;
+
 NetInterface::NetInterface()
 {
    AssertFatal(GNet == NULL, "ERROR: Multiple net interfaces declared.");
@@ -20,12 +23,12 @@ NetInterface::NetInterface()
 
    mLastTimeoutCheckTime = 0;
    mAllowConnections = true;
-
+   mRandomDataInitialized = false;
+   dMemset(mConnectRate, 0, sizeof(mConnectRate));
 }
 
 void NetInterface::initRandomData()
 {
-   mRandomDataInitialized = true;
    U32 seed = Platform::getRealMilliseconds();
 
    if(Game->isJournalReading())
@@ -33,11 +36,62 @@ void NetInterface::initRandomData()
    else if(Game->isJournalWriting())
       Game->journalWrite(seed);
 
+   seedRandomData(seed);
+}
+
+void NetInterface::seedRandomData(U32 seed)
+{
+   mRandomDataInitialized = true;
    MRandomR250 myRandom(seed);
    for(U32 i = 0; i < 12; i++)
       mRandomHashData[i] = myRandom.randI();
 }
 
+bool NetInterface::checkConnectRate(const NetAddress *addr)
+{
+   if(smConnectRequestRate <= 0)
+      return true;
+
+   U32 key = (U32(addr->netNum[0]) << 24) |
+             (U32(addr->netNum[1]) << 16) |
+             (U32(addr->netNum[2]) << 8)  |
+             (U32(addr->netNum[3]));
+   if(addr->type != NetAddress::IPAddress)
+      key ^= (U32(addr->nodeNum[2]) << 24 | U32(addr->nodeNum[3]) << 16 | U32(addr->nodeNum[4]) << 8 | U32(addr->nodeNum[5])) + addr->type;
+
+   U32 hash = key * 2654435761U;
+   ConnectRateEntry &entry = mConnectRate[(hash ^ (hash >> 16)) & (ConnectRateTableSize - 1)];
+
+   U32 burst = getMax(smConnectRequestBurst, 1) * 1000;
+   U32 time = Platform::getVirtualMilliseconds();
+   if(!entry.used || entry.key != key)
+   {
+      entry.used = true;
+      entry.key = key;
+      entry.tokens = burst;
+   }
+   else
+   {
+      // a request a second is a thousandth of one a millisecond
+      U32 elapsed = time - entry.lastTime;
+      if(elapsed >= burst / smConnectRequestRate)
+         entry.tokens = burst;
+      else
+         entry.tokens = getMin(entry.tokens + elapsed * smConnectRequestRate, burst);
+   }
+   entry.lastTime = time;
+
+   if(entry.tokens < 1000)
+      return false;
+   entry.tokens -= 1000;
+   return true;
+}
+
+U32 NetInterface::getChallengeEpoch()
+{
+   return Platform::getVirtualMilliseconds() / ChallengeEpochTime;
+}
+
 void NetInterface::addPendingConnection(NetConnection *connection)
 {
    Con::printf("Adding a pending connection");
@@ -163,11 +217,12 @@ void NetInterface::sendConnectChallengeRequest(NetConnection *conn)
 
 void NetInterface::handleConnectChallengeRequest(const NetAddress *addr, BitStream *stream)
 {
+   if(!mAllowConnections || !checkConnectRate(addr))
+      return;
+
    char buf[256];
    Net::addressToString(addr, buf);
    Con::printf("Got Connect challenge Request from %s", buf);
-   if(!mAllowConnections)
-      return;
 
    U32 connectSequence;
    stream->read(&connectSequence);
@@ -176,7 +231,7 @@ void NetInterface::handleConnectChallengeRequest(const NetAddress *addr, BitStre
       initRandomData();
 
    U32 addressDigest[4];
-   computeNetMD5(addr, connectSequence, addressDigest);
+   computeNetMD5(addr, connectSequence, getChallengeEpoch(), addressDigest);
 
    BitStream *out = BitStream::getPacketStream();
    out->write(U8(ConnectChallengeResponse));
@@ -241,7 +296,7 @@ void NetInterface::sendConnectRequest(NetConnection *conn)
 
 void NetInterface::handleConnectRequest(const NetAddress *address, BitStream *stream)
 {
-   if(!mAllowConnections)
+   if(!mAllowConnections || !checkConnectRate(address))
       return;
    Con::printf("Got Connect Request");
    U32 connectSequence;
@@ -263,12 +318,19 @@ void NetInterface::handleConnectRequest(const NetAddress *address, BitStream *st
    stream->read(&addressDigest[2]);
    stream->read(&addressDigest[3]);
 
-   computeNetMD5(address, connectSequence, computedAddressDigest);
-   if(addressDigest[0] != computedAddressDigest[0] ||
-      addressDigest[1] != computedAddressDigest[1] ||
-      addressDigest[2] != computedAddressDigest[2] ||
-      addressDigest[3] != computedAddressDigest[3])
-      return; // bogus connection attempt
+   // good for the epoch that handed it out and the one after
+   U32 epoch = getChallengeEpoch();
+   bool valid = false;
+   for(U32 i = 0; i < 2 && !valid; i++)
+   {
+      computeNetMD5(address, connectSequence, epoch - i, computedAddressDigest);
+      valid = addressDigest[0] == computedAddressDigest[0] &&
+              addressDigest[1] == computedAddressDigest[1] &&
+              addressDigest[2] == computedAddressDigest[2] &&
+              addressDigest[3] == computedAddressDigest[3];
+   }
+   if(!valid)
+      return; // bogus or stale connection attempt
 
    if(connect)
    {
@@ -394,23 +456,36 @@ void NetInterface::handleInfoPacket(const NetAddress *address, U8 packetType, Bi
 void NetInterface::processClient()
 {
    NetObject::collapseDirtyList(); // collapse all the mask bits...
+   Vector<NetConnection *> conns;
    for(NetConnection *walk = NetConnection::getConnectionList();
       walk; walk = walk->getNext())
    {
       if(walk->isConnectionToServer() && (walk->isLocalConnection() || walk->isNetworkConnection()))
+      {
          walk->checkPacketSend(false);
+         conns.push_back(walk);
+      }
    }
+   NetConnection::updateSendStats(conns.address(), conns.size());
+   NetConnection::collectReadStats();
 }
 
 void NetInterface::processServer()
 {
    NetObject::collapseDirtyList(); // collapse all the mask bits...
+   Vector<NetConnection *> conns;
    for(NetConnection *walk = NetConnection::getConnectionList();
       walk; walk = walk->getNext())
    {
       if(!walk->isConnectionToServer() && (walk->isLocalConnection() || walk->isNetworkConnection()))
-         walk->checkPacketSend(false);
+         conns.push_back(walk);
    }
+
+   // All the tick's client packets go to the kernel together.
+   Net::beginSendBatch();
+   NetConnection::checkPacketSends(conns.address(), conns.size());
+   Net::endSendBatch();
+   NetConnection::collectReadStats();
 }
 
 void NetInterface::startConnection(NetConnection *conn)
@@ -510,7 +585,7 @@ inline U32 rotlFixed(U32 x, unsigned int y)
 
 #define MD5STEP(f, w, x, y, z, data, s) w = rotlFixed(w + f(x, y, z) + data, s) + x
 
-void NetInterface::computeNetMD5(const NetAddress *address, U32 connectSequence, U32 digest[4])
+void NetInterface::computeNetMD5(const NetAddress *address, U32 connectSequence, U32 epoch, U32 digest[4])
 {
 	digest[0] = 0x67452301L;
 	digest[1] = 0xefcdab89L;
@@ -535,6 +610,7 @@ void NetInterface::computeNetMD5(const NetAddress *address, U32 connectSequence,
    in[3] = connectSequence;
    for(U32 i = 0; i < 12; i++)
       in[i + 4] = mRandomHashData[i];
+   in[4] ^= epoch;
 
    MD5STEP(F1, a, b, c, d, in[0] + 0xd76aa478, 7);
    MD5STEP(F1, d, a, b, c, in[1] + 0xe8c7b756, 12);
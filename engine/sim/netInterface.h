@@ -50,7 +50,32 @@ protected:
       ConnectRetryCount    = 4,     ///< Number of times to send connect requests before giving up.
       ConnectRetryTime     = 2500,  ///< Timeout interval in milliseconds before retrying connect request.
       TimeoutCheckInterval = 1500,  ///< Interval in milliseconds between checking for connection timeouts.
+
+      ChallengeEpochTime   = 30000, ///< Milliseconds; a challenge stays good for one to two of these.
+      ConnectRateTableSize = 256,   ///< Addresses tracked by the rate limiter; a power of two.
+   };
+
+   /// @name Connect rate limiting
+   ///
+   /// A token bucket per source address, checked before a challenge or
+   /// connect request packet gets any other work done on it.  The table is
+   /// direct mapped on the address, so it never allocates; addresses that
+   /// land on the same entry push each other out and start with a full
+   /// bucket.
+   /// @{
+
+   struct ConnectRateEntry
+   {
+      bool used;
+      U32  key;
+      U32  lastTime;
+      U32  tokens;      ///< In thousandths of a request.
    };
+   ConnectRateEntry mConnectRate[ConnectRateTableSize];
+
+   /// Takes a request from addr's bucket, false if it's empty.
+   bool checkConnectRate(const NetAddress *addr);
+   /// @}
 
    /// Initialize random data.
    void initRandomData();
@@ -82,17 +107,31 @@ protected:
    /// @}
 
    /// Calculate an MD5 sum representing a connection, and store it into addressDigest.
-   void computeNetMD5(const NetAddress *address, U32 connectSequence, U32 addressDigest[4]);
+   ///
+   /// The epoch, the time in ChallengeEpochTime units, goes into the hash,
+   /// so a challenge expires instead of being good forever.
+   void computeNetMD5(const NetAddress *address, U32 connectSequence, U32 epoch, U32 addressDigest[4]);
+
+   /// The challenge epoch right now.
+   static U32 getChallengeEpoch();
 
 public:
    NetInterface();
 
+   static S32 smConnectRequestRate;    ///< $pref::Net::ConnectRequestRate, a second per address; 0 for no limit.
+   static S32 smConnectRequestBurst;   ///< $pref::Net::ConnectRequestBurst
+
    /// Returns whether or not this NetInterface allows connections from remote hosts.
    bool doesAllowConnections() { return mAllowConnections; }
 
    /// Sets whether or not this NetInterface allows connections from remote hosts.
    void setAllowsConnections(bool conn) { mAllowConnections = conn; }
 
+   /// Build the connect challenge hash data from a known seed rather than
+   /// the clock, so a recorded session hands out the same challenges when
+   /// it's replayed.
+   void seedRandomData(U32 seed);
+
    /// Dispatch function for processing all network packets through this NetInterface.
    virtual void processPacketReceiveEvent(PacketReceiveEvent *event);
 
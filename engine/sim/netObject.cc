@@ -111,8 +111,11 @@ void NetObject::collapseDirtyList()
                walk->updateMask = orMask;
                walk->connection->ghostPushNonZero(walk);
             }
-            else
+            else if((walk->updateMask | orMask) != walk->updateMask)
+            {
                walk->updateMask |= orMask;
+               walk->flags |= GhostInfo::PriorityDirty;
+            }
          }
       }
       obj = next;
@@ -209,6 +209,7 @@ class NetObject: public SimObject
 
    // Not the best way to do this, but the event needs access to mNetFlags
    friend class GhostAlwaysObjectEvent;
+   friend class GhostAlwaysBatchEvent;
 
 private:
    typedef SimObject Parent;
@@ -328,6 +329,17 @@ public:
    ///          system. Don't set bits you weren't passed.
    virtual U32  packUpdate(NetConnection * conn, U32 mask, BitStream *stream);
 
+   /// Returns true if packUpdate() with this mask may run on a worker thread,
+   /// concurrently with other connections packing this and other objects.
+   ///
+   /// That means packUpdate() must only read the object's state and only touch
+   /// per-connection data; string handles, script and SimObject lookups are not
+   /// safe.  The default is false, so only classes that have been checked are
+   /// packed in parallel.
+   ///
+   /// @see NetConnection::checkPacketSends
+   virtual bool isParallelPackSafe(U32 mask) { return false; }
+
    /// Instructs this object to read state data previously packed with packUpdate.
    ///
    /// @param   conn    Net connection being used
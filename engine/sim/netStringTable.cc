@@ -13,8 +13,9 @@ NetStringTable *gNetStringTable = NULL;
 
 NetStringTable::NetStringTable()
 {
+   // 0 is no string, and ends the valid list
    firstFree = 1;
-   firstValid = 1;
+   firstValid = 0;
 
    table = (Entry *) dMalloc(sizeof(Entry) * InitialSize);
    size = InitialSize;
@@ -25,7 +26,11 @@ NetStringTable::NetStringTable()
       table[i].scriptRefCount = 0;
    }
    table[InitialSize-1].next = InvalidEntry;
-   for(U32 j = 0; j < HashTableSize; j++)
+
+   numStrings = 0;
+   hashTableSize = InitialHashTableSize;
+   hashTable = (U32 *) dMalloc(sizeof(U32) * hashTableSize);
+   for(U32 j = 0; j < hashTableSize; j++)
       hashTable[j] = 0;
    allocator = new DataChunker(DataChunkerSize);
 }
@@ -33,6 +38,23 @@ NetStringTable::NetStringTable()
 NetStringTable::~NetStringTable()
 {
    delete allocator;
+   dFree(hashTable);
+   dFree(table);
+}
+
+void NetStringTable::growHashTable()
+{
+   hashTableSize *= 2;
+   hashTable = (U32 *) dRealloc(hashTable, sizeof(U32) * hashTableSize);
+   for(U32 j = 0; j < hashTableSize; j++)
+      hashTable[j] = 0;
+
+   for(U32 walk = firstValid; walk; walk = table[walk].link)
+   {
+      U32 bucket = table[walk].hash & (hashTableSize - 1);
+      table[walk].next = hashTable[bucket];
+      hashTable[bucket] = walk;
+   }
 }
 
 void NetStringTable::incStringRef(U32 id)
@@ -50,10 +72,10 @@ void NetStringTable::incStringRefScript(U32 id)
 U32 NetStringTable::addString(const char *string)
 {
    U32 hash = _StringTable::hashString(string);
-   U32 bucket = hash % HashTableSize;
+   U32 bucket = hash & (hashTableSize - 1);
    for(U32 walk = hashTable[bucket];walk; walk = table[walk].next)
    {
-      if(!dStrcmp(table[walk].string, string))
+      if(table[walk].hash == hash && !dStrcmp(table[walk].string, string))
       {
          table[walk].refCount++;
          return walk;
@@ -79,12 +101,16 @@ U32 NetStringTable::addString(const char *string)
    table[e].refCount++;
    table[e].string = (char *) allocator->alloc(dStrlen(string) + 1);
    dStrcpy(table[e].string, string);
+   table[e].hash = hash;
    table[e].next = hashTable[bucket];
    hashTable[bucket] = e;
    table[e].link = firstValid;
    table[firstValid].prevLink = e;
    firstValid = e;
    table[e].prevLink = 0;
+
+   if(++numStrings > hashTableSize)
+      growHashTable();
    return e;
 }
 
@@ -137,8 +163,7 @@ void NetStringTable::removeString(U32 id, bool script)
    else
       firstValid = next;
    // remove it from the hash table
-   U32 hash = _StringTable::hashString(table[id].string);
-   U32 bucket = hash % HashTableSize;
+   U32 bucket = table[id].hash & (hashTableSize - 1);
    for(U32 *walk = &hashTable[bucket];*walk; walk = &table[*walk].next)
    {
       if(*walk == id)
@@ -149,6 +174,7 @@ void NetStringTable::removeString(U32 id, bool script)
    }
    table[id].next = firstFree;
    firstFree = id;
+   numStrings--;
 }
 
 void NetStringTable::repack()
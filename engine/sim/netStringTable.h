@@ -30,12 +30,13 @@ class NetStringTable
    enum Constants {
       InitialSize = 16,
       InvalidEntry = 0xFFFFFFFF,
-      HashTableSize = 2128,
+      InitialHashTableSize = 1024,  ///< A power of two; doubles to stay above the string count.
       DataChunkerSize = 65536
    };
    struct Entry
    {
       char *string;
+      U32 hash;            ///< Of string, so lookups only compare strings that match it.
       U32 refCount;
       U32 scriptRefCount;
       U32 next;
@@ -47,11 +48,16 @@ class NetStringTable
    U32 firstFree;
    U32 firstValid;
    U32 sequenceCount;
+   U32 numStrings;
 
    Entry *table;
-   U32 hashTable[HashTableSize];
+   U32 *hashTable;
+   U32 hashTableSize;
    DataChunker *allocator;
 
+   /// Doubles the buckets, rechaining from the stored hashes.
+   void growHashTable();
+
     NetStringTable();
    ~NetStringTable();
 
@@ -104,6 +104,7 @@ void PathManagerEvent::unpack(NetConnection*, BitStream* stream)
       stream->read(&path.msToNext[j]);
       stream->read(&path.smoothingType[j]);
    }
+   path.computeTimes();
 }
 
 void PathManagerEvent::process(NetConnection*)
@@ -132,6 +133,34 @@ IMPLEMENT_CO_NETEVENT_V1(PathManagerEvent);
 PathManager* gClientPathManager = NULL;
 PathManager* gServerPathManager = NULL;
 
+//--------------------------------------------------------------------------
+void PathManager::PathEntry::computeTimes()
+{
+   msStart.setSize(msToNext.size());
+
+   U32 time = 0;
+   for (U32 i = 0; i < msToNext.size(); i++) {
+      msStart[i] = time;
+      time += msToNext[i];
+   }
+}
+
+S32 PathManager::PathEntry::findSegment(const F64 ms) const
+{
+   AssertFatal(msStart.size() == msToNext.size(), "PathManager::PathEntry::findSegment: times not computed");
+
+   S32 lo = 0;
+   S32 hi = S32(msStart.size()) - 1;
+   while (lo < hi) {
+      S32 mid = (lo + hi) >> 1;
+      if (ms > F64(msStart[mid] + msToNext[mid]))
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   return lo;
+}
+
 //--------------------------------------------------------------------------
 PathManager::PathManager(const bool isServer)
 {
@@ -206,6 +235,7 @@ void PathManager::updatePath(const U32              id,
    rEntry.totalTime = 0;
    for (S32 i = 0; i < S32(rEntry.msToNext.size()); i++)
       rEntry.totalTime += rEntry.msToNext[i];
+   rEntry.computeTimes();
 
    transmitPath(id);
 }
@@ -260,11 +290,8 @@ void PathManager::getPathPosition(const U32 id,
    if (ms > mPaths[id]->totalTime)
       ms = mPaths[id]->totalTime;
 
-   S32 startNode = 0;
-   while (ms > mPaths[id]->msToNext[startNode]) {
-      ms -= mPaths[id]->msToNext[startNode];
-      startNode++;
-   }
+   S32 startNode = mPaths[id]->findSegment(ms);
+   ms -= mPaths[id]->msStart[startNode];
    S32 endNode = (startNode + 1) % mPaths[id]->positions.size();
 
    Point3F& rStart = mPaths[id]->positions[startNode];
@@ -318,11 +345,7 @@ U32 PathManager::getWaypointTime(const U32 id, const U32 wayPoint) const
    AssertFatal(isValidPath(id), "Error, this is not a valid path!");
    AssertFatal(wayPoint < getPathNumWaypoints(id), "Invalid waypoint!");
 
-   U32 time = 0;
-   for (U32 i = 0; i < wayPoint; i++)
-      time += mPaths[id]->msToNext[i];
-
-   return time;
+   return mPaths[id]->msStart[wayPoint];
 }
 
 U32 PathManager::getPathTimeBits(const U32 id)
@@ -382,6 +405,7 @@ bool PathManager::readState(BitStream* stream)
          mathRead(*stream, &rEntry.positions[j]);
          stream->read(&rEntry.msToNext[j]);
       }
+      rEntry.computeTimes();
    }
 
    return stream->getStatus() == Stream::Ok;
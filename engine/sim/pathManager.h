@@ -39,12 +39,23 @@ class PathManager
       Vector<U32>     smoothingType;
       Vector<U32>     msToNext;
 
+      /// Time each segment starts at, built by computeTimes() whenever the
+      /// path changes so queries needn't walk msToNext.
+      Vector<U32>     msStart;
+
       PathEntry() {
          VECTOR_SET_ASSOCIATION(positions);
          VECTOR_SET_ASSOCIATION(rotations);
          VECTOR_SET_ASSOCIATION(smoothingType);
          VECTOR_SET_ASSOCIATION(msToNext);
+         VECTOR_SET_ASSOCIATION(msStart);
       }
+
+      void computeTimes();
+
+      /// Index of the segment ms falls in, the first one that ends at or
+      /// after it.
+      S32  findSegment(const F64 ms) const;
    };
 
    Vector<PathEntry*> mPaths;
@@ -5,6 +5,7 @@
 
 #include "sim/sceneObject.h"
 #include "sceneGraph/sceneGraph.h"
+#include "sceneGraph/sceneState.h"
 #include "console/consoleTypes.h"
 #include "collision/extrudedPolyList.h"
 #include "collision/earlyOutPolyList.h"
@@ -18,14 +19,22 @@
 #include "dgl/dgl.h"
 #include "sim/netConnection.h"
 #include "lightingSystem/sgLightObject.h"
+#include "core/frameStats.h"
+#include "sceneGraph/boxCuller.h"
 
 IMPLEMENT_CONOBJECT(SceneObject);
 
 const U32 Container::csmNumBins = 16;
 const F32 Container::csmBinSize = 64;
 const F32 Container::csmTotalBinSize = Container::csmBinSize * Container::csmNumBins;
+const F32 Container::csmLooseMinBinSize = 16;
 U32       Container::smCurrSeqKey = 1;
 const U32 Container::csmRefPoolBlockSize = 4096;
+const U32 Container::csmMaxRaysPerBatch = 32;
+const F32 Container::csmMaxBatchRayLength = Container::csmBinSize * 2;
+const U32 Container::csmStaticCollisionMask = TerrainObjectType | InteriorObjectType |
+                                              InteriorMapObjectType | AtlasObjectType |
+                                              StaticTSObjectType;
 
 // Statics used by buildPolyList methods
 AbstractPolyList* sPolyList;
@@ -172,6 +181,22 @@ ConsoleFunction(containerBoxEmpty, bool, 4, 6, "(bitset mask, Point3F center, fl
    return ! gServerContainer.buildPolyList(B, mask, &polyList);
 }
 
+ConsoleFunction( setContainerBinMode, void, 3, 3, "(bool serverContainer, string mode)"
+                "Select the spatial index used by the server or client container.\n\n"
+                "@param serverContainer True for the server container, false for the client.\n"
+                "@param mode Either \"grid\" for the classic single level bin grid, or \"loose\" "
+                "for the multi-level loose grid, which is better suited to large maps with "
+                "many large objects.")
+{
+   Container& container = dAtob(argv[1]) ? gServerContainer : gClientContainer;
+   if (!dStricmp(argv[2], "loose"))
+      container.setBinMode(Container::LooseGridBins);
+   else if (!dStricmp(argv[2], "grid"))
+      container.setBinMode(Container::GridBins);
+   else
+      Con::errorf("setContainerBinMode: unknown mode '%s', expected grid or loose.", argv[2]);
+}
+
 ConsoleFunction( initContainerRadiusSearch, void, 4, 4, "(Point3F pos, float radius, bitset mask)"
                 "Start a search for items within radius of pos, filtering by bitset mask.")
 {
@@ -360,11 +385,13 @@ SceneObject::SceneObject()
 
    mLastState    = NULL;
    mLastStateKey = 0;
+   mCullSlot     = -1;
 
    mBinMinX = 0xFFFFFFFF;
    mBinMaxX = 0xFFFFFFFF;
    mBinMinY = 0xFFFFFFFF;
    mBinMaxY = 0xFFFFFFFF;
+   mBinLevel = Container::NumLooseLevels;
 }
 
 SceneObject::~SceneObject()
@@ -374,6 +401,9 @@ SceneObject::~SceneObject()
    AssertFatal(mZoneRefHead == NULL && mBinRefHead == NULL,
                "Error, still linked in reference lists!");
 
+   OcclusionCuller::releaseObject(this);
+   if (mCullSlot != -1)
+      BoxCuller::freeSlot(mCullSlot);
    unlink();
 }
 
@@ -579,6 +609,9 @@ void SceneObject::setTransform(const MatrixF& mat)
 
    resetWorldBox();
 
+   if (getContainer())
+      getContainer()->staticObjectChanged(this);
+
    if (mSceneManager != NULL && mNumCurrZones != 0) {
       mSceneManager->zoneRemove(this);
       mSceneManager->zoneInsert(this);
@@ -653,6 +686,14 @@ void SceneObject::resetRenderWorldBox()
    // Create mRenderWorldSphere from mRenderWorldBox
    mRenderWorldBox.getCenter(&mRenderWorldSphere.center);
    mRenderWorldSphere.radius = (mRenderWorldBox.max - mRenderWorldSphere.center).len();
+
+   // Only client objects are rendered, the rest don't need a slot.
+   if (isClientObject())
+   {
+      if (mCullSlot == -1)
+         mCullSlot = BoxCuller::allocSlot();
+      BoxCuller::setBox(mCullSlot, mRenderWorldBox);
+   }
 }
 
 
@@ -695,6 +736,12 @@ void SceneObject::renderObject(SceneState*, SceneRenderImage*)
    //
 }
 
+void SceneObject::renderObjectBatch(SceneState* state, SceneRenderImage** images, U32 count)
+{
+   for (U32 i = 0; i < count; i++)
+      images[i]->obj->renderObject(state, images[i]);
+}
+
 bool SceneObject::scopeObject(const Point3F&        /*rootPosition*/,
                               const F32             /*rootDistance*/,
                               bool*                 /*zoneScopeState*/)
@@ -820,8 +867,16 @@ Container::Container()
    mOverflowBin.prevInBin = NULL;
    mOverflowBin.nextInObj = NULL;
 
+   mBinMode = GridBins;
+   mLooseBinArray = NULL;
+   for (U32 i = 0; i < NumLooseLevels; i++)
+      mLooseLevelCount[i] = 0;
+
+   mStaticChangeKey = 0;
+
    VECTOR_SET_ASSOCIATION(mRefPoolBlocks);
    VECTOR_SET_ASSOCIATION(mSearchList);
+   VECTOR_SET_ASSOCIATION(mRayCandidates);
 
    mFreeRefPool = NULL;
    addRefPoolBlock();
@@ -852,6 +907,9 @@ Container::~Container()
    }
    mFreeRefPool = NULL;
 
+   delete [] mBinArray;
+   delete [] mLooseBinArray;
+
    cleanupSearchVectors();
 }
 
@@ -862,6 +920,7 @@ bool Container::addObject(SceneObject* obj)
    obj->linkAfter(&mStart);
 
    insertIntoBins(obj);
+   staticObjectChanged(obj);
    return true;
 }
 
@@ -869,12 +928,19 @@ bool Container::removeObject(SceneObject* obj)
 {
    AssertFatal(obj->mContainer == this, "Trying to remove from wrong container.");
    removeFromBins(obj);
+   staticObjectChanged(obj);
 
    obj->mContainer = 0;
    obj->unlink();
    return true;
 }
 
+void Container::staticObjectChanged(SceneObject* obj)
+{
+   if (obj->getTypeMask() & csmStaticCollisionMask)
+      mStaticChangeKey++;
+}
+
 void Container::addRefPoolBlock()
 {
    mRefPoolBlocks.push_back(new SceneObjectRef[csmRefPoolBlockSize]);
@@ -902,6 +968,16 @@ void Container::insertIntoBins(SceneObject* obj)
    // The first thing we do is find which bins are covered in x and y...
    const Box3F* pWBox = &obj->getWorldBox();
 
+   if (mBinMode == LooseGridBins)
+   {
+      U32 level, x, y;
+      getLooseBinCoords(*pWBox, level, x, y);
+      if (obj->isGlobalBounds())
+         level = NumLooseLevels;
+      insertIntoLooseBins(obj, level, x, y);
+      return;
+   }
+
    U32 minX, maxX, minY, maxY;
    getBinRange(pWBox->min.x, pWBox->max.x, minX, maxX);
    getBinRange(pWBox->min.y, pWBox->max.y, minY, maxY);
@@ -964,6 +1040,7 @@ void Container::insertIntoBins(SceneObject* obj,
                                U32 minY, U32 maxY)
 {
    AssertFatal(obj != NULL, "No object?");
+   AssertFatal(mBinMode == GridBins, "Container::insertIntoBins: bin ranges only apply to the grid bin mode.");
 
    AssertFatal(obj->mBinRefHead == NULL, "Error, already have a bin chain!");
    // Store the current regions for later queries
@@ -1026,6 +1103,9 @@ void Container::removeFromBins(SceneObject* obj)
    SceneObjectRef* chain = obj->mBinRefHead;
    obj->mBinRefHead = NULL;
 
+   if (chain && mBinMode == LooseGridBins && obj->mBinLevel < NumLooseLevels)
+      mLooseLevelCount[obj->mBinLevel]--;
+
    while (chain)
    {
       SceneObjectRef* trash = chain;
@@ -1055,6 +1135,20 @@ void Container::checkBins(SceneObject* obj)
    //  the bins that it's currently in...
    const Box3F* pWBox = &obj->getWorldBox();
 
+   if (mBinMode == LooseGridBins)
+   {
+      U32 level, x, y;
+      getLooseBinCoords(*pWBox, level, x, y);
+      if (obj->isGlobalBounds())
+         level = NumLooseLevels;
+      if (obj->mBinLevel != level || obj->mBinMinX != x || obj->mBinMinY != y)
+      {
+         removeFromBins(obj);
+         insertIntoLooseBins(obj, level, x, y);
+      }
+      return;
+   }
+
    U32 minX, maxX, minY, maxY;
    getBinRange(pWBox->min.x, pWBox->max.x, minX, maxX);
    getBinRange(pWBox->min.y, pWBox->max.y, minY, maxY);
@@ -1069,8 +1163,16 @@ void Container::checkBins(SceneObject* obj)
 }
 
 
-void Container::findObjects(const Box3F& box, U32 mask, FindCallback callback, void *key)
+void Container::findObjects(const Box3F& box, U32 mask, FindCallback callback, void *key,
+                            bool collidableOnly)
 {
+   STAT_INC(ContainerQueries);
+   if (mBinMode == LooseGridBins)
+   {
+      findLooseObjects(box, mask, callback, key, collidableOnly);
+      return;
+   }
+
    U32 minX, maxX, minY, maxY;
    getBinRange(box.min.x, box.max.x, minX, maxX);
    getBinRange(box.min.y, box.max.y, minY, maxY);
@@ -1091,7 +1193,7 @@ void Container::findObjects(const Box3F& box, U32 mask, FindCallback callback, v
                chain->object->setContainerSeqKey(smCurrSeqKey);
 
                if ((chain->object->getType() & mask) != 0 &&
-                   chain->object->isCollisionEnabled())
+                   (!collidableOnly || chain->object->isCollisionEnabled()))
                {
                   if (chain->object->getWorldBox().isOverlapped(box) || chain->object->isGlobalBounds())
                   {
@@ -1111,7 +1213,7 @@ void Container::findObjects(const Box3F& box, U32 mask, FindCallback callback, v
          chain->object->setContainerSeqKey(smCurrSeqKey);
 
          if ((chain->object->getType() & mask) != 0 &&
-             chain->object->isCollisionEnabled())
+             (!collidableOnly || chain->object->isCollisionEnabled()))
          {
             if (chain->object->getWorldBox().isOverlapped(box) || chain->object->isGlobalBounds())
             {
@@ -1126,6 +1228,7 @@ void Container::findObjects(const Box3F& box, U32 mask, FindCallback callback, v
 
 void Container::polyhedronFindObjects(const Polyhedron& polyhedron, U32 mask, FindCallback callback, void *key)
 {
+   STAT_INC(ContainerQueries);
    U32 i;
    Box3F box;
    box.min.set(1e9, 1e9, 1e9);
@@ -1136,6 +1239,12 @@ void Container::polyhedronFindObjects(const Polyhedron& polyhedron, U32 mask, Fi
       box.max.setMax(polyhedron.pointList[i]);
    }
 
+   if (mBinMode == LooseGridBins)
+   {
+      findLooseObjects(box, mask, callback, key, true);
+      return;
+   }
+
    U32 minX, maxX, minY, maxY;
    getBinRange(box.min.x, box.max.x, minX, maxX);
    getBinRange(box.min.y, box.max.y, minY, maxY);
@@ -1189,6 +1298,282 @@ void Container::polyhedronFindObjects(const Polyhedron& polyhedron, U32 mask, Fi
 }
 
 
+//----------------------------------------------------------------------------
+// Loose grid bins
+//
+void Container::setBinMode(BinMode mode)
+{
+   if (mode == mBinMode)
+      return;
+
+   // Pull everything out under the old scheme before switching.
+   Link* itr;
+   for (itr = mStart.next; itr != &mEnd; itr = itr->next)
+      removeFromBins(static_cast<SceneObject*>(itr));
+
+   mBinMode = mode;
+   if (mBinMode == LooseGridBins && mLooseBinArray == NULL)
+   {
+      U32 numBins = NumLooseLevels * LooseLevelBins * LooseLevelBins;
+      mLooseBinArray = new SceneObjectRef[numBins];
+      for (U32 i = 0; i < numBins; i++)
+      {
+         mLooseBinArray[i].object    = NULL;
+         mLooseBinArray[i].nextInBin = NULL;
+         mLooseBinArray[i].prevInBin = NULL;
+         mLooseBinArray[i].nextInObj = NULL;
+      }
+   }
+
+   for (itr = mStart.next; itr != &mEnd; itr = itr->next)
+      insertIntoBins(static_cast<SceneObject*>(itr));
+}
+
+inline SceneObjectRef* Container::getLooseBin(U32 level, S32 x, S32 y)
+{
+   // Bins wrap, just like the regular grid.  LooseLevelBins is a power
+   //  of two so masking handles negative coordinates as well.
+   U32 wrapX = U32(x) & (LooseLevelBins - 1);
+   U32 wrapY = U32(y) & (LooseLevelBins - 1);
+   return &mLooseBinArray[(level * LooseLevelBins + wrapY) * LooseLevelBins + wrapX];
+}
+
+void Container::getLooseBinCoords(const Box3F& box, U32& level, U32& x, U32& y)
+{
+   // Finest level whose bins are at least as large as the object
+   F32 extent  = getMax(box.len_x(), box.len_y());
+   F32 binSize = csmLooseMinBinSize;
+   for (level = 0; level < NumLooseLevels && extent > binSize; level++)
+      binSize *= 2;
+
+   if (level == NumLooseLevels)
+   {
+      // Too big for any level, overflow bin.
+      x = y = 0;
+      return;
+   }
+
+   Point3F center;
+   box.getCenter(&center);
+   x = U32(S32(mFloor(center.x / binSize))) & (LooseLevelBins - 1);
+   y = U32(S32(mFloor(center.y / binSize))) & (LooseLevelBins - 1);
+}
+
+void Container::insertIntoLooseBins(SceneObject* obj, U32 level, U32 x, U32 y)
+{
+   AssertFatal(obj->mBinRefHead == NULL, "Error, already have a bin chain!");
+
+   SceneObjectRef* bin;
+   if (level < NumLooseLevels)
+   {
+      bin = getLooseBin(level, x, y);
+      mLooseLevelCount[level]++;
+   }
+   else
+      bin = &mOverflowBin;
+
+   SceneObjectRef* ref = allocateObjectRef();
+   ref->object    = obj;
+   ref->nextInBin = bin->nextInBin;
+   ref->prevInBin = bin;
+   ref->nextInObj = NULL;
+
+   if (bin->nextInBin)
+      bin->nextInBin->prevInBin = ref;
+   bin->nextInBin = ref;
+
+   // Keep the grid style ranges meaningful, a single bin.
+   obj->mBinRefHead = ref;
+   obj->mBinMinX  = obj->mBinMaxX = x;
+   obj->mBinMinY  = obj->mBinMaxY = y;
+   obj->mBinLevel = level;
+}
+
+void Container::findLooseObjects(const Box3F& box, U32 mask, FindCallback callback, void *key,
+                                 bool collidableOnly)
+{
+   smCurrSeqKey++;
+
+   F32 binSize = csmLooseMinBinSize;
+   for (U32 level = 0; level < NumLooseLevels; level++, binSize *= 2)
+   {
+      if (mLooseLevelCount[level] == 0)
+         continue;
+
+      // Objects are binned by center and are at most a bin wide, so they
+      //  can stick out half a bin past the bin they're in.
+      F32 slop = binSize * 0.5f;
+      S32 minX = S32(mFloor((box.min.x - slop) / binSize));
+      S32 maxX = S32(mFloor((box.max.x + slop) / binSize));
+      S32 minY = S32(mFloor((box.min.y - slop) / binSize));
+      S32 maxY = S32(mFloor((box.max.y + slop) / binSize));
+      if (maxX - minX >= LooseLevelBins)
+      {
+         minX = 0;
+         maxX = LooseLevelBins - 1;
+      }
+      if (maxY - minY >= LooseLevelBins)
+      {
+         minY = 0;
+         maxY = LooseLevelBins - 1;
+      }
+
+      for (S32 i = minY; i <= maxY; i++)
+      {
+         for (S32 j = minX; j <= maxX; j++)
+         {
+            SceneObjectRef* chain = getLooseBin(level, j, i)->nextInBin;
+            while (chain)
+            {
+               if (chain->object->getContainerSeqKey() != smCurrSeqKey)
+               {
+                  chain->object->setContainerSeqKey(smCurrSeqKey);
+
+                  if ((chain->object->getType() & mask) != 0 &&
+                      (!collidableOnly || chain->object->isCollisionEnabled()))
+                  {
+                     if (chain->object->getWorldBox().isOverlapped(box))
+                        (*callback)(chain->object,key);
+                  }
+               }
+               chain = chain->nextInBin;
+            }
+         }
+      }
+   }
+
+   SceneObjectRef* chain = mOverflowBin.nextInBin;
+   while (chain)
+   {
+      if (chain->object->getContainerSeqKey() != smCurrSeqKey)
+      {
+         chain->object->setContainerSeqKey(smCurrSeqKey);
+
+         if ((chain->object->getType() & mask) != 0 &&
+             (!collidableOnly || chain->object->isCollisionEnabled()))
+         {
+            if (chain->object->getWorldBox().isOverlapped(box) || chain->object->isGlobalBounds())
+               (*callback)(chain->object,key);
+         }
+      }
+      chain = chain->nextInBin;
+   }
+}
+
+void Container::castRayBin(SceneObjectRef* bin, const Point3F &start, const Point3F &end, U32 mask, RayInfo* info, F32& currentT)
+{
+   for (SceneObjectRef* chain = bin->nextInBin; chain; chain = chain->nextInBin)
+   {
+      SceneObject* ptr = chain->object;
+      if (ptr->getContainerSeqKey() == smCurrSeqKey)
+         continue;
+      ptr->setContainerSeqKey(smCurrSeqKey);
+
+      if ((ptr->getType() & mask) != 0 && ptr->isCollisionEnabled() == true &&
+          ptr->getWorldBox().collideLine(start, end))
+      {
+         Point3F xformedStart, xformedEnd;
+         ptr->mWorldToObj.mulP(start, &xformedStart);
+         ptr->mWorldToObj.mulP(end,   &xformedEnd);
+         xformedStart.convolveInverse(ptr->mObjScale);
+         xformedEnd.convolveInverse(ptr->mObjScale);
+
+         RayInfo ri;
+         if (ptr->castRay(xformedStart, xformedEnd, &ri) && ri.t < currentT)
+         {
+            *info = ri;
+            info->point.interpolate(start, end, info->t);
+            currentT = ri.t;
+         }
+      }
+   }
+}
+
+void Container::castRayLoose(const Point3F &start, const Point3F &end, U32 mask, RayInfo* info, F32& currentT)
+{
+   F32 binSize = csmLooseMinBinSize;
+   for (U32 level = 0; level < NumLooseLevels; level++, binSize *= 2)
+   {
+      if (mLooseLevelCount[level] == 0)
+         continue;
+
+      // Work in bin units shifted by half a bin.  An object in bin k covers
+      //  at most [k, k + 2) in these units, so a point u on the line can only
+      //  touch objects in bins floor(u) - 1 and floor(u), on both axes.  We
+      //  walk the cells the line passes through and check those four bins.
+      F32 ux0 = start.x / binSize + 0.5f;
+      F32 uy0 = start.y / binSize + 0.5f;
+      F32 ux1 = end.x   / binSize + 0.5f;
+      F32 uy1 = end.y   / binSize + 0.5f;
+
+      S32 cellX = S32(mFloor(ux0));
+      S32 cellY = S32(mFloor(uy0));
+      S32 endX  = S32(mFloor(ux1));
+      S32 endY  = S32(mFloor(uy1));
+      S32 numSteps = mAbs(endX - cellX) + mAbs(endY - cellY) + 1;
+
+      if (numSteps * 4 >= LooseLevelBins * LooseLevelBins)
+      {
+         // Long enough to wrap the level, cheaper to just look at everything.
+         for (S32 i = 0; i < LooseLevelBins; i++)
+            for (S32 j = 0; j < LooseLevelBins; j++)
+               castRayBin(getLooseBin(level, j, i), start, end, mask, info, currentT);
+         continue;
+      }
+
+      F32 dx = ux1 - ux0;
+      F32 dy = uy1 - uy0;
+      S32 stepX = dx >= 0 ? 1 : -1;
+      S32 stepY = dy >= 0 ? 1 : -1;
+      F32 tDeltaX = dx != 0 ? mFabs(1.0f / dx) : 1e30f;
+      F32 tDeltaY = dy != 0 ? mFabs(1.0f / dy) : 1e30f;
+      F32 tMaxX = dx > 0 ? (cellX + 1 - ux0) / dx : dx < 0 ? (ux0 - cellX) / -dx : 1e30f;
+      F32 tMaxY = dy > 0 ? (cellY + 1 - uy0) / dy : dy < 0 ? (uy0 - cellY) / -dy : 1e30f;
+
+      for (S32 i = 0; i < numSteps; i++)
+      {
+         castRayBin(getLooseBin(level, cellX - 1, cellY - 1), start, end, mask, info, currentT);
+         castRayBin(getLooseBin(level, cellX,     cellY - 1), start, end, mask, info, currentT);
+         castRayBin(getLooseBin(level, cellX - 1, cellY),     start, end, mask, info, currentT);
+         castRayBin(getLooseBin(level, cellX,     cellY),     start, end, mask, info, currentT);
+
+         if (tMaxX < tMaxY)
+         {
+            cellX += stepX;
+            tMaxX += tDeltaX;
+         }
+         else
+         {
+            cellY += stepY;
+            tMaxY += tDeltaY;
+         }
+      }
+
+      // Always finish on the end cell, round off in the walk could have
+      //  dropped it.  Anything already checked is skipped by the seq key.
+      castRayBin(getLooseBin(level, endX - 1, endY - 1), start, end, mask, info, currentT);
+      castRayBin(getLooseBin(level, endX,     endY - 1), start, end, mask, info, currentT);
+      castRayBin(getLooseBin(level, endX - 1, endY),     start, end, mask, info, currentT);
+      castRayBin(getLooseBin(level, endX,     endY),     start, end, mask, info, currentT);
+   }
+}
+
+
+// Ray hits come back with an object space normal, bump it into worldspace.
+static void transformRayNormal(RayInfo* info)
+{
+   PlaneF fakePlane;
+   fakePlane.x = info->normal.x;
+   fakePlane.y = info->normal.y;
+   fakePlane.z = info->normal.z;
+   fakePlane.d = 0;
+
+   PlaneF result;
+   mTransformPlane(info->object->getTransform(), info->object->getScale(), fakePlane, &result);
+   info->normal = result;
+}
+
+
 //----------------------------------------------------------------------------
 // DMMNOTE: There are still some optimizations to be done here.  In particular:
 //           - After checking the overflow bin, we can potentially shorten the line
@@ -1205,6 +1590,7 @@ void Container::polyhedronFindObjects(const Polyhedron& polyhedron, U32 mask, Fi
 bool Container::castRay(const Point3F &start, const Point3F &end, U32 mask, RayInfo* info)
 {
    PROFILE_START(ContainerCastRay);
+   STAT_INC(ContainerQueries);
    F32 currentT = 2.0;
    smCurrSeqKey++;
 
@@ -1274,10 +1660,15 @@ bool Container::castRay(const Point3F &start, const Point3F &end, U32 mask, RayI
 //if (normalStart.y == normalEnd.y && minY != maxY)
 //   Con::printf("Y min = %d, max = %d", minY, maxY);
 
-   // We'll optimize the case that the line is contained in one bin row or column, which
-   //  will be quite a few lines.  No sense doing more work than we have to...
+   // The loose grid does its own traversal.  Otherwise, we'll optimize the case that
+   //  the line is contained in one bin row or column, which will be quite a few lines.
+   //  No sense doing more work than we have to...
    //
-   if ((mFabs(normalStart.x - normalEnd.x) < csmTotalBinSize && minX == maxX) ||
+   if (mBinMode == LooseGridBins)
+   {
+      castRayLoose(start, end, mask, info, currentT);
+   }
+   else if ((mFabs(normalStart.x - normalEnd.x) < csmTotalBinSize && minX == maxX) ||
        (mFabs(normalStart.y - normalEnd.y) < csmTotalBinSize && minY == maxY))
    {
       U32 count;
@@ -1433,15 +1824,7 @@ bool Container::castRay(const Point3F &start, const Point3F &end, U32 mask, RayI
    // Bump the normal into worldspace if appropriate.
    if(currentT != 2)
    {
-      PlaneF fakePlane;
-      fakePlane.x = info->normal.x;
-      fakePlane.y = info->normal.y;
-      fakePlane.z = info->normal.z;
-      fakePlane.d = 0;
-
-      PlaneF result;
-      mTransformPlane(info->object->getTransform(), info->object->getScale(), fakePlane, &result);
-      info->normal = result;
+      transformRayNormal(info);
 
       PROFILE_END();
       return true;
@@ -1455,9 +1838,151 @@ bool Container::castRay(const Point3F &start, const Point3F &end, U32 mask, RayI
 
 }
 
+//----------------------------------------------------------------------------
+
+void Container::rayCandidateCallback(SceneObject* obj, void *key)
+{
+   reinterpret_cast<Container*>(key)->mRayCandidates.push_back(obj);
+}
+
+struct RaySortEntry
+{
+   U32 key;
+   U32 index;
+};
+
+static int QSORT_CALLBACK cmpRaySortEntry(const void* a, const void* b)
+{
+   const RaySortEntry* ea = reinterpret_cast<const RaySortEntry*>(a);
+   const RaySortEntry* eb = reinterpret_cast<const RaySortEntry*>(b);
+   if (ea->key != eb->key)
+      return ea->key < eb->key ? -1 : 1;
+   // Keep the sort stable so results don't depend on qsort
+   return S32(ea->index) - S32(eb->index);
+}
+
+U32 Container::castRays(const RayQuery* rays, U32 count, U32 mask, RayInfo* out)
+{
+   PROFILE_START(ContainerCastRays);
+
+   U32 numHits = 0;
+   U32 i;
+
+   // Short rays are sorted by the bin their start falls in, so that a run
+   //  of sorted rays covers a small area.  Long rays are done one at a time.
+   Vector<RaySortEntry> sorted;
+   sorted.reserve(count);
+   for (i = 0; i < count; i++)
+   {
+      out[i].object = NULL;
+
+      const RayQuery& ray = rays[i];
+      Point2F delta(ray.end.x - ray.start.x, ray.end.y - ray.start.y);
+      if (delta.len() > csmMaxBatchRayLength)
+      {
+         if (castRay(ray.start, ray.end, mask, &out[i]))
+            numHits++;
+         continue;
+      }
+
+      sorted.increment();
+      sorted.last().key   = ((U32(S32(mFloor(ray.start.y / csmBinSize))) & 0xFFFF) << 16) |
+                             (U32(S32(mFloor(ray.start.x / csmBinSize))) & 0xFFFF);
+      sorted.last().index = i;
+   }
+   // The long ones were counted by castRay().
+   STAT_ADD(ContainerQueries, sorted.size());
+   if (sorted.size() > 1)
+      dQsort(sorted.address(), sorted.size(), sizeof(RaySortEntry), cmpRaySortEntry);
+
+   for (U32 batchStart = 0; batchStart < sorted.size(); )
+   {
+      // A batch is a run of rays starting in the same bin.
+      U32 batchEnd = batchStart + 1;
+      while (batchEnd < sorted.size() && batchEnd - batchStart < csmMaxRaysPerBatch &&
+             sorted[batchEnd].key == sorted[batchStart].key)
+         batchEnd++;
+
+      Box3F batchBox(rays[sorted[batchStart].index].start, rays[sorted[batchStart].index].start);
+      for (i = batchStart; i < batchEnd; i++)
+      {
+         batchBox.min.setMin(rays[sorted[i].index].start);
+         batchBox.min.setMin(rays[sorted[i].index].end);
+         batchBox.max.setMax(rays[sorted[i].index].start);
+         batchBox.max.setMax(rays[sorted[i].index].end);
+      }
+
+      // One bin walk for the lot.  findObjects() has already done the
+      //  mask, collision and seq key filtering, and each candidate only
+      //  shows up once.
+      mRayCandidates.clear();
+      findObjects(batchBox, mask, rayCandidateCallback, this);
+
+      for (i = batchStart; i < batchEnd; i++)
+         if (castRayAgainst(mRayCandidates.address(), mRayCandidates.size(),
+                            rays[sorted[i].index], &out[sorted[i].index]))
+            numHits++;
+
+      batchStart = batchEnd;
+   }
+   mRayCandidates.clear();
+
+   PROFILE_END();
+   return numHits;
+}
+
+U32 Container::castRaysAgainst(SceneObject* const* objects, U32 objectCount,
+                               const RayQuery* rays, U32 count, RayInfo* out)
+{
+   PROFILE_START(ContainerCastRaysAgainst);
+
+   U32 numHits = 0;
+   for (U32 i = 0; i < count; i++)
+   {
+      out[i].object = NULL;
+      if (castRayAgainst(objects, objectCount, rays[i], &out[i]))
+         numHits++;
+   }
+
+   PROFILE_END();
+   return numHits;
+}
+
+bool Container::castRayAgainst(SceneObject* const* objects, U32 objectCount,
+                               const RayQuery& ray, RayInfo* info)
+{
+   F32 currentT = 2.0;
+   for (U32 j = 0; j < objectCount; j++)
+   {
+      SceneObject* ptr = objects[j];
+      if (!ptr->getWorldBox().collideLine(ray.start, ray.end) && !ptr->isGlobalBounds())
+         continue;
+
+      Point3F xformedStart, xformedEnd;
+      ptr->mWorldToObj.mulP(ray.start, &xformedStart);
+      ptr->mWorldToObj.mulP(ray.end,   &xformedEnd);
+      xformedStart.convolveInverse(ptr->mObjScale);
+      xformedEnd.convolveInverse(ptr->mObjScale);
+
+      RayInfo ri;
+      if (ptr->castRay(xformedStart, xformedEnd, &ri) && ri.t < currentT)
+      {
+         *info = ri;
+         info->point.interpolate(ray.start, ray.end, info->t);
+         currentT = ri.t;
+      }
+   }
+
+   if (currentT == 2)
+      return false;
+   transformRayNormal(info);
+   return true;
+}
+
 // collide with the objects projected object box
 bool Container::collideBox(const Point3F &start, const Point3F &end, U32 mask, RayInfo * info)
 {
+   STAT_INC(ContainerQueries);
    F32 currentT = 2;
    for (Link* itr = mStart.next; itr != &mEnd; itr = itr->next)
    {
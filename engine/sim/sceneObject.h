@@ -28,6 +28,10 @@
 #include "core/color.h"
 #endif
 
+#ifndef _OCCLUSIONCULLER_H_
+#include "sceneGraph/occlusionCuller.h"
+#endif
+
 #include "lightingSystem/sgLightManager.h"
 
 //-------------------------------------- Forward declarations...
@@ -39,6 +43,7 @@ class Box3F;
 class Point3F;
 class LightManager;
 class Convex;
+class TSShapeInstance;
 
 //----------------------------------------------------------------------------
 /// Extension of the collision structore to allow use with raycasting.
@@ -50,6 +55,13 @@ struct RayInfo: public Collision
    F32 t;
 };
 
+/// A single ray for Container::castRays().
+struct RayQuery
+{
+   Point3F start;
+   Point3F end;
+};
+
 //--------------------------------------------------------------------------
 
 /// Reference to a scene object.
@@ -109,10 +121,43 @@ public:
       void *key;
    };
 
+   /// Spatial index used to bin objects.
+   ///
+   /// GridBins is the classic scheme: a single csmNumBins x csmNumBins grid
+   /// that wraps around every csmTotalBinSize units, with objects covering the
+   /// whole grid going into the overflow bin.  An object is referenced from
+   /// every bin its box touches.
+   ///
+   /// LooseGridBins is a multi-level loose grid.  Each level is a wrapping
+   /// grid of LooseLevelBins bins per side with twice the bin size of the
+   /// level below it.  An object is referenced from exactly one bin: the one
+   /// containing its center, on the finest level whose bin size is at least
+   /// the object's extent.  Since every object is at most one bin wide on its
+   /// level, a query only needs to look at the bins overlapping the query
+   /// expanded by half a bin, so large objects no longer end up in the
+   /// overflow bin and query cost doesn't depend on object size.  Only
+   /// objects larger than the coarsest level, or with global bounds, go to
+   /// the overflow bin.
+   enum BinMode
+   {
+      GridBins = 0,
+      LooseGridBins
+   };
+
+   enum LooseGridConstants
+   {
+      NumLooseLevels = 9,     ///< Bin sizes csmLooseMinBinSize * 2^0 .. 2^8
+      LooseLevelBins = 32     ///< Bins per side, per level. Must be a power of two.
+   };
+
    static const U32 csmNumBins;
    static const F32 csmBinSize;
    static const F32 csmTotalBinSize;
+   static const F32 csmLooseMinBinSize;
    static const U32 csmRefPoolBlockSize;
+   static const U32 csmMaxRaysPerBatch;
+   static const F32 csmMaxBatchRayLength;
+   static const U32 csmStaticCollisionMask;
    static U32    smCurrSeqKey;
 
 private:
@@ -124,17 +169,35 @@ private:
    SceneObjectRef* mBinArray;
    SceneObjectRef  mOverflowBin;
 
+   BinMode         mBinMode;
+   SceneObjectRef* mLooseBinArray;                     ///< NumLooseLevels * LooseLevelBins^2 bin heads
+   U32             mLooseLevelCount[NumLooseLevels];   ///< Objects per level, so empty levels can be skipped
+
+   U32             mStaticChangeKey;
+
 public:
    Container();
    ~Container();
 
+   /// @name Bin mode
+   /// @{
+
+   /// Switch the spatial index used by this container.  Objects already in
+   /// the container are rebinned.
+   void setBinMode(BinMode mode);
+   BinMode getBinMode() const { return mBinMode; }
+   /// @}
+
    /// @name Basic database operations
    /// @{
 
    ///
    typedef void (*FindCallback)(SceneObject*,void *key);
    void findObjects(U32 mask, FindCallback, void *key = NULL);
-   void findObjects(const Box3F& box, U32 mask, FindCallback, void *key = NULL);
+   /// Objects with collision disabled are skipped unless collidableOnly is
+   /// false, for queries that aren't about collision such as ghost scoping.
+   void findObjects(const Box3F& box, U32 mask, FindCallback, void *key = NULL,
+                    bool collidableOnly = true);
    void polyhedronFindObjects(const Polyhedron& polyhedron, U32 mask,
                               FindCallback, void *key = NULL);
    /// @}
@@ -144,6 +207,31 @@ public:
 
    ///
    bool castRay(const Point3F &start, const Point3F &end, U32 mask, RayInfo* info);
+
+   /// Cast a batch of rays against the same mask.
+   ///
+   /// Rays that start near each other are grouped, and each group gathers
+   /// its candidate objects from the bins once, so the bin walk and mask
+   /// filtering are shared instead of repeated per ray.  Very long rays
+   /// gain nothing from grouping and go through castRay() individually.
+   ///
+   /// @param   rays    Array of count rays.
+   /// @param   count   Number of rays.
+   /// @param   mask    Object type mask, as for castRay().
+   /// @param   out     Array of count results.  out[i].object is NULL if
+   ///                  ray i didn't hit anything.
+   /// @returns Number of rays that hit something.
+   U32  castRays(const RayQuery* rays, U32 count, U32 mask, RayInfo* out);
+
+   /// Cast a batch of rays against candidate objects the caller gathered,
+   /// usually with findObjects() over a box it keeps for several casts.
+   /// The candidates aren't filtered by type or collision; the results are
+   /// as for castRays().
+   ///
+   /// @returns Number of rays that hit something.
+   U32  castRaysAgainst(SceneObject* const* objects, U32 objectCount,
+                        const RayQuery* rays, U32 count, RayInfo* out);
+
    bool collideBox(const Point3F &start, const Point3F &end, U32 mask, RayInfo* info);
    /// @}
 
@@ -177,8 +265,33 @@ public:
    void checkBins(SceneObject*);
    void insertIntoBins(SceneObject*, U32, U32, U32, U32);
 
+   /// @name Static object changes
+   /// Objects of the csmStaticCollisionMask types don't move during play, so
+   /// Convex::updateWorkingList() keeps what it found for them across ticks.
+   /// Adding, removing, moving or rescaling one of them changes the key,
+   /// which tells the working lists to look again.
+   /// @{
+   U32  getStaticChangeKey() const { return mStaticChangeKey; }
+   void staticObjectChanged(SceneObject*);
+   /// @}
+
 
 private:
+   /// @name Loose grid helpers
+   /// @{
+   SceneObjectRef* getLooseBin(U32 level, S32 x, S32 y);
+   void getLooseBinCoords(const Box3F& box, U32& level, U32& x, U32& y);
+   void insertIntoLooseBins(SceneObject*, U32 level, U32 x, U32 y);
+   void findLooseObjects(const Box3F& box, U32 mask, FindCallback, void *key, bool collidableOnly);
+   void castRayLoose(const Point3F &start, const Point3F &end, U32 mask, RayInfo* info, F32& currentT);
+   void castRayBin(SceneObjectRef* bin, const Point3F &start, const Point3F &end, U32 mask, RayInfo* info, F32& currentT);
+   /// @}
+
+   Vector<SceneObject*> mRayCandidates;   ///< Scratch list for castRays()
+   static void rayCandidateCallback(SceneObject*, void *key);
+   static bool castRayAgainst(SceneObject* const* objects, U32 objectCount,
+                              const RayQuery& ray, RayInfo* info);
+
    Vector<SimObjectPtr<SceneObject>*>  mSearchList;///< Object searches to support console querying of the database.  ONLY WORKS ON SERVER
    S32                                 mCurrSearchPos;
    Point3F                             mSearchReferencePoint;
@@ -243,6 +356,7 @@ class SceneObject : public NetObject, public Container::Link
    friend class Container;
    friend class SceneGraph;
    friend class SceneState;
+   friend class OcclusionCuller;
 
    //-------------------------------------- Public constants
 public:
@@ -491,6 +605,21 @@ public:
    /// @param   image   Image associated with this object to render.
    ///                  @see SceneRenderImage
    virtual void renderObject(SceneState *state, SceneRenderImage *image);
+
+   /// Renders a run of images that share a SceneRenderImage::batchKey.  For
+   /// translucent images the run is in back to front order.
+   ///
+   /// Every image in the list has the same batch key and belongs to an
+   /// object of this class, but not necessarily to this object.  The default
+   /// just calls renderObject() for each one.
+   ///
+   /// @param   state   Current rendering state.
+   /// @param   images  Images to render, count of them.
+   virtual void renderObjectBatch(SceneState *state, SceneRenderImage **images, U32 count);
+
+   /// Returns the shape instance renderObject() draws, if the object has
+   /// one, so the scene can skin it ahead of time.
+   virtual TSShapeInstance* getRenderShapeInstance() { return NULL; }
    virtual void renderShadow( SceneState *state, SceneRenderImage *image){}
 
    /// Called when the SceneGraph is ready for the registration of RenderImages.
@@ -504,6 +633,15 @@ public:
    virtual bool prepRenderImage(SceneState *state, const U32 stateKey, const U32 startZone,
                                 const bool modifyBaseZoneState = false);
 
+   /// Returns true if prepRenderImage() may run on a worker thread.
+   ///
+   /// Such objects must not manage zones and may only call the read-only
+   /// SceneState queries, insertRenderImage(), setImageRefPoint() and
+   /// DetailManager::selectPotentialDetails() for a TSShapeInstance.
+   ///
+   /// @see SceneGraph::prepObjectsParallel
+   virtual bool isParallelPrepSafe() const { return false; }
+
    /// Adds object to the client or server container depending on the object
    void addToScene();
 
@@ -719,6 +857,7 @@ protected:
    U32 mBinMaxX;
    U32 mBinMinY;
    U32 mBinMaxY;
+   U32 mBinLevel;    ///< Loose grid level, or Container::NumLooseLevels for the overflow bin
 
    /// @}
 
@@ -792,6 +931,8 @@ private:
    TraversalState mTraversalState;  ///< State of this object in the SceneGraph traversal - DON'T MESS WITH THIS
    SceneState*    mLastState;       ///< Last SceneState that was used to render this object.
    U32            mLastStateKey;    ///< Last state key that was used to render this object.
+   OcclusionInfo  mOcclusion;       ///< Occlusion query state - managed by OcclusionCuller.
+   S32            mCullSlot;        ///< Slot of mRenderWorldBox in BoxCuller, -1 if none.
 
    /// @}
 
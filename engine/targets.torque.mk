@@ -1,5 +1,6 @@
 EXE_NAME=torqueDemo
 EXE_DEDICATED_NAME=$(EXE_NAME)d
+EXE_BENCH_NAME=torqueBench
 BIN_DIRECTORY=../example
 CHECK_LINK_FILE=../lib/xiph/linux/checklinks.sh
 
@@ -8,7 +9,9 @@ SOURCE.AUDIO=\
 	audio/audioBuffer.cc \
 	audio/audioDataBlock.cc \
 	audio/audioFunctions.cc \
+	audio/audioStreamSource.cc \
 	audio/audioStreamSourceFactory.cc \
+	audio/audioStreamThread.cc \
 	audio/oggMixedStreamSource.cc \
 	audio/vorbisStream.cc \
 	audio/vorbisStreamSource.cc \
@@ -33,6 +36,7 @@ SOURCE.COLLISION=\
 SOURCE.CONSOLE=\
 	console/astAlloc.cc \
 	console/astNodes.cc \
+	console/asyncLogWriter.cc \
 	console/BASscan.cc \
 	console/BASgram.cc \
 	console/codeBlock.cc \
@@ -71,8 +75,10 @@ SOURCE.CORE=\
 	core/filterStream.cc \
 	core/findMatch.cc \
 	core/frameAllocator.cc \
+	core/frameStats.cc \
 	core/idGenerator.cc \
 	core/iTickable.cc \
+	core/mappedStream.cc \
 	core/memStream.cc \
 	core/nStream.cc \
 	core/nTypes.cc \
@@ -88,16 +94,20 @@ SOURCE.CORE=\
 	core/zipHeaders.cc \
 	core/zipSubStream.cc \
         core/unicode.cc \
-	core/theoraPlayer.cc \
+	core/threadPool.cc \
+	core/zipWriter.cc \
 
 SOURCE.DGL=\
 	dgl/bitmapBm8.cc \
 	dgl/bitmapBmp.cc \
+	dgl/bitmapDds.cc \
 	dgl/bitmapGif.cc \
 	dgl/bitmapJpeg.cc \
 	dgl/bitmapPng.cc \
 	dgl/dgl.cc \
+	dgl/dglGpuTimer.cc \
 	dgl/dglMatrix.cc \
+	dgl/dglState.cc \
 	dgl/gBitmap.cc \
 	dgl/gFont.cc \
 	dgl/gNewFont.cc \
@@ -146,6 +156,7 @@ SOURCE.GUI=\
 	gui/controls/guiConsoleTextCtrl.cc \
 	gui/controls/guiMLTextCtrl.cc \
 	gui/controls/guiMLTextEditCtrl.cc \
+	gui/controls/guiMLTextStrip.cc \
 	gui/controls/guiPopUpCtrl.cc \
 	gui/controls/guiRadioCtrl.cc \
 	gui/controls/guiSliderCtrl.cc \
@@ -175,6 +186,7 @@ SOURCE.GUI=\
 	gui/game/guiAviBitmapCtrl.cc \
 	gui/game/guiChunkedBitmapCtrl.cc \
 	gui/game/guiFadeinBitmapCtrl.cc \
+	gui/game/guiFrameStatsCtrl.cc \
 	gui/game/guiMessageVectorCtrl.cc \
 	gui/game/guiProgressCtrl.cc \
 	gui/utility/guiBubbleTextCtrl.cc \
@@ -275,6 +287,7 @@ SOURCE.SIM=\
 	sim/actionMap.cc \
 	sim/connectionStringTable.cc \
 	sim/decalManager.cc \
+	sim/netClassStats.cc \
 	sim/netConnection.cc \
 	sim/netDownload.cc \
 	sim/netEvent.cc \
@@ -289,6 +302,7 @@ SOURCE.SIM=\
 SOURCE.GAME=\
 	game/aiClient.cc \
 	game/aiConnection.cc \
+	game/aiPerception.cc \
 	game/aiPlayer.cc \
 	game/aiWheeledVehicle.cc \
 	game/ambientAudioManager.cc \
@@ -298,8 +312,8 @@ SOURCE.GAME=\
 	game/camera.cc \
 	game/cameraSpline.cc \
 	game/collisionTest.cc \
+	game/dataBlockCache.cc \
 	game/debris.cc \
-	game/debugView.cc \
 	game/fireballAtmosphere.cc \
 	game/game.cc \
 	game/gameBase.cc \
@@ -308,27 +322,29 @@ SOURCE.GAME=\
 	game/gameConnectionMoves.cc \
 	game/gameFunctions.cc \
 	game/gameProcess.cc \
-	game/gameTSCtrl.cc \
-	game/guiNoMouseCtrl.cc \
-	game/guiPlayerView.cc \
 	game/item.cc \
 	game/main.cc \
 	game/missionArea.cc \
+	game/missionLoadPipeline.cc \
 	game/missionMarker.cc \
+	game/navGraph.cc \
 	game/pathCamera.cc \
 	game/physicalZone.cc \
 	game/player.cc \
 	game/projectile.cc \
+	game/projectileBatch.cc \
 	game/rigid.cc \
 	game/rigidShape.cc \
 	game/scopeAlwaysShape.cc \
+	game/serverReplay.cc \
 	game/shadow.cc \
 	game/shapeBase.cc \
 	game/shapeCollision.cc \
 	game/shapeImage.cc \
-	game/showTSShape.cc \
+	game/soakTest.cc \
 	game/sphere.cc \
 	game/staticShape.cc \
+	game/timeDemo.cc \
 	game/trigger.cc \
 	game/tsStatic.cc \
 	game/version.cc \
@@ -364,13 +380,37 @@ SOURCE.GAME.FX=\
 
 SOURCE.GAME.VEHICLES=\
 	game/vehicles/flyingVehicle.cc \
-	game/vehicles/guiSpeedometer.cc \
 	game/vehicles/hoverVehicle.cc \
 	game/vehicles/vehicle.cc \
 	game/vehicles/vehicleBlocker.cc \
 	game/vehicles/wheeledVehicle.cc \
 
 
+# Client only code from the directories the dedicated build keeps.
+SOURCE.CLIENT=\
+	core/theoraPlayer.cc \
+	game/debugView.cc \
+	game/gameTSCtrl.cc \
+	game/guiNoMouseCtrl.cc \
+	game/guiPlayerView.cc \
+	game/showTSShape.cc \
+	game/vehicles/guiSpeedometer.cc \
+
+# What the dedicated build has in place of dgl/, audio/, gui/ and editor/:
+# the bitmap and material code interiors and shapes load, the audio
+# datablocks, and stand-ins for the drawing, texture and sound calls the
+# simulation makes.
+SOURCE.HEADLESS=\
+	audio/audioDataBlock.cc \
+	audio/audioHeadless.cc \
+	dgl/bitmapPng.cc \
+	dgl/dglHeadless.cc \
+	dgl/gBitmap.cc \
+	dgl/gPalette.cc \
+	dgl/materialList.cc \
+	dgl/materialPropertyMap.cc \
+	gui/controls/guiMLTextStrip.cc \
+
 SOURCE.UTIL=\
    util/frustrumCuller.cpp \
    util/quadTreeTracer.cpp \
@@ -436,8 +476,10 @@ SOURCE.PLATFORMFreeBSD=$(SOURCE.PLATFORMX86UNIX)
 SOURCE.PLATFORMFreeBSDDEDICATED=$(SOURCE.PLATFORMX86UNIXDEDICATED)
 
 SOURCE.SCENEGRAPH=\
+	sceneGraph/boxCuller.cc \
 	sceneGraph/detailManager.cc \
 	sceneGraph/lightManager.cc \
+	sceneGraph/occlusionCuller.cc \
 	sceneGraph/sceneGraph.cc \
 	sceneGraph/sceneLighting.cc \
 	sceneGraph/sceneRoot.cc \
@@ -445,6 +487,7 @@ SOURCE.SCENEGRAPH=\
 	sceneGraph/sceneTraversal.cc \
 	sceneGraph/sgUtil.cc \
 	sceneGraph/shadowVolumeBSP.cc \
+	sceneGraph/visibilityQuery.cc \
 	sceneGraph/windingClipper.cc 
 
 SOURCE.TERRAIN=\
@@ -459,6 +502,7 @@ SOURCE.TERRAIN=\
 	terrain/terrCollision.cc \
 	terrain/terrData.cc \
 	terrain/terrLighting.cc \
+	terrain/terrPager.cc \
 	terrain/terrRender.cc \
 	terrain/waterBlock.cc 
 
@@ -467,6 +511,7 @@ SOURCE.TS=\
 	ts/tsCollision.cc \
 	ts/tsDecal.cc \
 	ts/tsDump.cc \
+	ts/tsImpostorAtlas.cc \
 	ts/tsIntegerSet.cc \
 	ts/tsLastDetail.cc \
 	ts/tsMaterialList.cc \
@@ -474,6 +519,7 @@ SOURCE.TS=\
 	ts/tsPartInstance.cc \
 	ts/tsShape.cc \
 	ts/tsShapeAlloc.cc \
+	ts/tsShapeCompress.cc \
 	ts/tsShapeConstruct.cc \
 	ts/tsShapeInstance.cc \
 	ts/tsShapeOldRead.cc \
@@ -494,6 +540,7 @@ SOURCE.LIGHTINGSYSTEM=\
 	lightingSystem/sgSceneLightingInterior.cc \
 	lightingSystem/sgSceneLightingTerrain.cc \
 	lightingSystem/sgScenePersist.cc \
+	lightingSystem/sgShadowBVH.cc \
 	lightingSystem/volLight.cc
 
 # jmq: added the stuff after SOURCE.TS for tools build hack
@@ -517,6 +564,7 @@ SOURCE.ENGINE =\
 	$(SOURCE.GAME.NET) \
 	$(SOURCE.GAME.FX) \
 	$(SOURCE.GAME.VEHICLES) \
+	$(SOURCE.CLIENT) \
    $(SOURCE.UTIL) \
    $(SOURCE.LIGHTINGSYSTEM)
 
@@ -527,16 +575,12 @@ SOURCE.ENGINE += $(SOURCE.PLATFORM$(OS)DEDICATED)
 endif
 
 
-SOURCE.TESTAPP =\
-	$(SOURCE.AUDIO) \
+# The simulation, which both builds run...
+SOURCE.TESTAPP_SIM =\
 	$(SOURCE.COLLISION) \
 	$(SOURCE.CONSOLE) \
 	$(SOURCE.CORE) \
-	$(SOURCE.DGL) \
-	$(SOURCE.EDITOR) \
-	$(SOURCE.GUI) \
 	$(SOURCE.GAME) \
-	$(SOURCE.GAME.FPS) \
 	$(SOURCE.GAME.NET) \
 	$(SOURCE.GAME.FX) \
 	$(SOURCE.GAME.VEHICLES) \
@@ -551,18 +595,43 @@ SOURCE.TESTAPP =\
 	$(SOURCE.TS) \
 	$(SOURCE.LIGHTINGSYSTEM)
 
+# ...and rendering, sound, gui and the editors, which only the client does.
+SOURCE.TESTAPP_RENDER =\
+	$(SOURCE.AUDIO) \
+	$(SOURCE.DGL) \
+	$(SOURCE.EDITOR) \
+	$(SOURCE.GUI) \
+	$(SOURCE.GAME.FPS) \
+	$(SOURCE.CLIENT)
+
+SOURCE.TESTAPP =\
+	$(SOURCE.TESTAPP_SIM) \
+	$(SOURCE.TESTAPP_RENDER)
+
 SOURCE.TESTAPP_CLIENT =\
 	$(SOURCE.TESTAPP) \
 	$(SOURCE.PLATFORM$(OS)) \
 
 SOURCE.TESTAPP_DEDICATED =\
-	$(SOURCE.TESTAPP) \
+	$(SOURCE.TESTAPP_SIM) \
+	$(SOURCE.HEADLESS) \
 	$(SOURCE.PLATFORM$(OS)DEDICATED) \
 
+SOURCE.BENCH =\
+	bench/benchmark.cc \
+	bench/coreBenchmarks.cc \
+	bench/sceneBenchmarks.cc \
+
+SOURCE.TESTAPP_BENCH =\
+	$(SOURCE.TESTAPP_DEDICATED) \
+	$(SOURCE.BENCH) \
+
 SOURCE.TESTAPP_CLIENT.OBJ:=$(addprefix $(DIR.OBJ)/, $(addsuffix $O, $(basename $(SOURCE.TESTAPP_CLIENT))) )
 SOURCE.TESTAPP_DEDICATED.OBJ:=$(addprefix $(DIR.OBJ)/, $(addsuffix $O, $(basename $(SOURCE.TESTAPP_DEDICATED))) )
+SOURCE.TESTAPP_BENCH.OBJ:=$(addprefix $(DIR.OBJ)/, $(addsuffix $O, $(basename $(SOURCE.TESTAPP_BENCH))) )
 SOURCE.ENGINE.OBJ:=$(addprefix $(DIR.OBJ)/, $(addsuffix $O, $(basename $(SOURCE.ENGINE))) )
 SOURCE.ALL += $(SOURCE.TESTAPP_CLIENT)
+SOURCE.ALL += $(SOURCE.BENCH)
 targetsclean += torqueClean
 
 #---------------------------------------
@@ -619,13 +688,17 @@ $(DIR.OBJ)/engine$(EXT.LIB): $(DIR.OBJ) $(DIR.LIST) $(SOURCE.ENGINE.OBJ)
 
 #----------------------------------------
 # dedicated server build (unix only)
+# Links SOURCE.TESTAPP_SIM with SOURCE.HEADLESS instead of the render, sound
+# and gui code.  TORQUE_HEADLESS also leaves out the data only drawing uses,
+# like interior lightmaps and shape materials.  dumpMemoryTags() and
+# dumpResourceStats() report what's left.
 dedicated: $(DIR.OBJ)/$(EXE_DEDICATED_NAME)$(EXT.EXE)
 
 DIR.LIST = $(addprefix $(DIR.OBJ)/, $(sort $(dir $(SOURCE.TESTAPP_DEDICATED))))
 
 $(DIR.LIST): targets.torque.mk
 
-$(DIR.OBJ)/$(EXE_DEDICATED_NAME)$(EXT.EXE): CFLAGS += -DDEDICATED $(INCLUDES_$(OS))
+$(DIR.OBJ)/$(EXE_DEDICATED_NAME)$(EXT.EXE): CFLAGS += -DDEDICATED -DTORQUE_HEADLESS $(INCLUDES_$(OS))
 
 $(DIR.OBJ)/$(EXE_DEDICATED_NAME)$(EXT.EXE): LIB.PATH +=../lib/$(DIR.OBJ) \
 
@@ -641,6 +714,30 @@ $(DIR.OBJ)/$(EXE_DEDICATED_NAME)$(EXT.EXE): $(DIR.OBJ) $(DIR.LIST) $(SOURCE.TEST
 	$(DO.LINK.CONSOLE.EXE)
 	$(CP) $(DIR.OBJ)/$(EXE_DEDICATED_NAME)$(BUILD_SUFFIX).* $(BIN_DIRECTORY)
 
+#----------------------------------------
+# benchmark harness, the dedicated build plus bench/ (unix only)
+$(EXE_BENCH_NAME): $(DIR.OBJ)/$(EXE_BENCH_NAME)$(EXT.EXE)
+
+DIR.LIST = $(addprefix $(DIR.OBJ)/, $(sort $(dir $(SOURCE.TESTAPP_BENCH))))
+
+$(DIR.LIST): targets.torque.mk
+
+$(DIR.OBJ)/$(EXE_BENCH_NAME)$(EXT.EXE): CFLAGS += -DDEDICATED -DTORQUE_HEADLESS $(INCLUDES_$(OS))
+
+$(DIR.OBJ)/$(EXE_BENCH_NAME)$(EXT.EXE): LIB.PATH +=../lib/$(DIR.OBJ) \
+
+$(DIR.OBJ)/$(EXE_BENCH_NAME)$(EXT.EXE): LINK.LIBS.GENERAL = \
+	$(LINK.LIBS.SERVER) \
+	$(PRE.LIBRARY.LIB)ljpeg$(EXT.LIB) \
+	$(PRE.LIBRARY.LIB)lpng$(EXT.LIB) \
+	$(PRE.LIBRARY.LIB)lungif$(EXT.LIB) \
+	$(PRE.LIBRARY.LIB)zlib$(EXT.LIB)
+
+$(DIR.OBJ)/$(EXE_BENCH_NAME)$(EXT.EXE): $(DIR.OBJ) $(DIR.LIST) $(SOURCE.TESTAPP_BENCH.OBJ)
+	${CHECK_LINK_FILE}
+	$(DO.LINK.CONSOLE.EXE)
+	$(CP) $(DIR.OBJ)/$(EXE_BENCH_NAME)$(BUILD_SUFFIX).* $(BIN_DIRECTORY)
+
 #----------------------------------------
 torqueClean:
 ifneq ($(wildcard $(EXE_NAME)_DEBUG.*),)
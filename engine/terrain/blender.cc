@@ -19,6 +19,13 @@
 #  define BLENDER_USE_ASM
 #endif
 
+// The SSE2 kernels use intrinsics, so they're built wherever the compiler
+// knows about SSE2, and picked at run time through smUseSSE2Blender.
+#if defined(TORQUE_CPU_X86) && (defined(TORQUE_COMPILER_VISUALC) || defined(__SSE2__))
+#  define BLENDER_USE_SSE2
+#  include <emmintrin.h>
+#endif
+
 
 /*************Explanation*******************************/
 // Manifest CONSTANTS mentioned within are defined right below.
@@ -77,6 +84,9 @@
 vector unsigned int vlumels;
 bool Blender::smUseVecBlender = false;
 #endif
+#if defined(TORQUE_CPU_X86)
+bool Blender::smUseSSE2Blender = false;
+#endif
 extern "C"
 {
    U32 lumels[4];
@@ -111,7 +121,10 @@ extern "C"
    extern U32 srcrows_x2_MinusTPL;
 }
 
-#else /* BLENDER_USE_ASM */
+#endif /* BLENDER_USE_ASM */
+
+// The C kernels are always built: blendThreadSafe() uses them even when the
+// assembly versions are available, since those pass parameters in globals.
 
 static U8 alphaTable[64 * 256];
 class InitAlphaTable
@@ -131,8 +144,8 @@ public:
 static InitAlphaTable initAlphaTable; // Okay, cheesy
 
 
-static void doSquare4( U32 *bmp_dest, int sq_shift, const int *alphaOffsets, const U32 *const *bmp_ptrs,
-                      const U8 *const *alpha_ptrs )
+static void doSquare4C( U32 *bmp_dest, int sq_shift, const int *alphaOffsets, const U32 *const *bmp_ptrs,
+                       const U8 *const *alpha_ptrs )
 {
    int squareSize = 1 << sq_shift;
    int squareSizeColors = squareSize;
@@ -278,8 +291,8 @@ static void doSquare4( U32 *bmp_dest, int sq_shift, const int *alphaOffsets, con
    }
 }
 
-static void doSquare3( U32 *bmp_dest, int sq_shift, const int *alphaOffsets, const U32 *const *bmp_ptrs,
-                      const U8 *const *alpha_ptrs )
+static void doSquare3C( U32 *bmp_dest, int sq_shift, const int *alphaOffsets, const U32 *const *bmp_ptrs,
+                       const U8 *const *alpha_ptrs )
 {
    int squareSize = 1 << sq_shift;
    int squareSizeColors = squareSize;
@@ -395,8 +408,8 @@ static void doSquare3( U32 *bmp_dest, int sq_shift, const int *alphaOffsets, con
    }
 }
 
-static void doSquare2( U32 *bmp_dest, int sq_shift, int *alphaOffsets, const U32 *const *bmp_ptrs,
-                      const U8 *const *alpha_ptrs )
+static void doSquare2C( U32 *bmp_dest, int sq_shift, const int *alphaOffsets, const U32 *const *bmp_ptrs,
+                       const U8 *const *alpha_ptrs )
 {
    int squareSize = 1 << sq_shift;
    int squareSizeColors = squareSize;
@@ -485,7 +498,179 @@ static void doSquare2( U32 *bmp_dest, int sq_shift, int *alphaOffsets, const U32
    }
 }
 
-#endif /* BLENDER_USE_ASM */
+#if defined(BLENDER_USE_SSE2)
+
+// The SSE2 versions give the same results as the C code above: the alpha
+// table is replaced by (pix * alpha + 32) / 63, and the divide by 63 by a
+// multiply with 2^21 / 63, which is exact for everything up to 255 * 63 + 32.
+#define SSE2_ROUND_63      32
+#define SSE2_DIV_63_MUL    33289
+#define SSE2_DIV_63_SHIFT  5
+
+/// Blends numTextures source squares, four texels at a time.  The square
+/// must be at least four texels wide.
+static inline void doSquareSSE2( U32 *bmp_dest, int sq_shift, const int *alphaOffsets, const U32 *const *bmp_ptrs,
+                                 const U8 *const *alpha_ptrs, int numTextures )
+{
+   const int squareSize = 1 << sq_shift;
+
+   int left_scan_edge_alpha[MAXIMUM_TEXTURES];
+   int right_scan_edge_alpha[MAXIMUM_TEXTURES];
+   int delta_left_alpha[MAXIMUM_TEXTURES];
+   int delta_right_alpha[MAXIMUM_TEXTURES];
+   const U32 *sourcePtr[MAXIMUM_TEXTURES];
+
+   for ( int i = 0; i < numTextures; i++ )
+   {
+      const int top_left_alpha = alpha_ptrs[i][ alphaOffsets[0] ] << MAX_TEXELS_PER_SQUARE_LOG2;
+      const int top_right_alpha = alpha_ptrs[i][ alphaOffsets[1] ] << MAX_TEXELS_PER_SQUARE_LOG2;
+      const int bot_left_alpha = alpha_ptrs[i][ alphaOffsets[2] ] << MAX_TEXELS_PER_SQUARE_LOG2;
+      const int bot_right_alpha = alpha_ptrs[i][ alphaOffsets[3] ] << MAX_TEXELS_PER_SQUARE_LOG2;
+
+      delta_left_alpha[i] = (bot_left_alpha - top_left_alpha) / squareSize;
+      delta_right_alpha[i] = (bot_right_alpha - top_right_alpha) / squareSize;
+
+      left_scan_edge_alpha[i] = top_left_alpha;
+      right_scan_edge_alpha[i] = top_right_alpha;
+      sourcePtr[i] = bmp_ptrs[i];
+   }
+
+   const __m128i zero = _mm_setzero_si128();
+   const __m128i alphaMask = _mm_set1_epi32(0x3F);
+   const __m128i byteMask = _mm_set1_epi16(0xFF);
+   const __m128i round = _mm_set1_epi16(SSE2_ROUND_63);
+   const __m128i div63 = _mm_set1_epi16(S16(SSE2_DIV_63_MUL));
+   U32 *destPtr = bmp_dest;
+
+   for ( int iy = 0; iy < squareSize; iy++ )
+   {
+      __m128i scan_alpha[MAXIMUM_TEXTURES];
+      __m128i delta_scan_alpha[MAXIMUM_TEXTURES];
+
+      for ( int i = 0; i < numTextures; i++ )
+      {
+         const int scan = left_scan_edge_alpha[i];
+         const int delta = (right_scan_edge_alpha[i] - scan) / squareSize;
+         left_scan_edge_alpha[i] += delta_left_alpha[i];
+         right_scan_edge_alpha[i] += delta_right_alpha[i];
+
+         scan_alpha[i] = _mm_set_epi32(scan + delta * 3, scan + delta * 2, scan + delta, scan);
+         delta_scan_alpha[i] = _mm_set1_epi32(delta * 4);
+      }
+
+      for ( int ix = 0; ix < squareSize; ix += 4 )
+      {
+         __m128i sumLo = zero;
+         __m128i sumHi = zero;
+
+         for ( int i = 0; i < numTextures; i++ )
+         {
+            // six bit alpha of each texel, spread over its four channels
+            __m128i alpha = _mm_and_si128(_mm_srai_epi32(scan_alpha[i], MAX_TEXELS_PER_SQUARE_LOG2 + 2), alphaMask);
+            alpha = _mm_packs_epi32(alpha, alpha);
+            alpha = _mm_unpacklo_epi16(alpha, alpha);
+            const __m128i alphaLo = _mm_unpacklo_epi32(alpha, alpha);
+            const __m128i alphaHi = _mm_unpackhi_epi32(alpha, alpha);
+
+            const __m128i texels = _mm_loadu_si128((const __m128i *) &sourcePtr[i][ix]);
+            __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(texels, zero), alphaLo), round);
+            __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(texels, zero), alphaHi), round);
+            sumLo = _mm_add_epi16(sumLo, _mm_srli_epi16(_mm_mulhi_epu16(lo, div63), SSE2_DIV_63_SHIFT));
+            sumHi = _mm_add_epi16(sumHi, _mm_srli_epi16(_mm_mulhi_epu16(hi, div63), SSE2_DIV_63_SHIFT));
+
+            scan_alpha[i] = _mm_add_epi32(scan_alpha[i], delta_scan_alpha[i]);
+         }
+
+         // the C code adds into bytes, so wrap the same way
+         sumLo = _mm_and_si128(sumLo, byteMask);
+         sumHi = _mm_and_si128(sumHi, byteMask);
+         _mm_storeu_si128((__m128i *) &destPtr[ix], _mm_packus_epi16(sumLo, sumHi));
+      }
+
+      for ( int i = 0; i < numTextures; i++ )
+         sourcePtr[i] += squareSize;
+      destPtr += squareSize;
+   }
+}
+
+static void doSquare4SSE2( U32 *bmp_dest, int sq_shift, const int *alphaOffsets, const U32 *const *bmp_ptrs,
+                           const U8 *const *alpha_ptrs )
+{
+   doSquareSSE2( bmp_dest, sq_shift, alphaOffsets, bmp_ptrs, alpha_ptrs, 4 );
+}
+
+static void doSquare3SSE2( U32 *bmp_dest, int sq_shift, const int *alphaOffsets, const U32 *const *bmp_ptrs,
+                           const U8 *const *alpha_ptrs )
+{
+   doSquareSSE2( bmp_dest, sq_shift, alphaOffsets, bmp_ptrs, alpha_ptrs, 3 );
+}
+
+static void doSquare2SSE2( U32 *bmp_dest, int sq_shift, const int *alphaOffsets, const U32 *const *bmp_ptrs,
+                           const U8 *const *alpha_ptrs )
+{
+   doSquareSSE2( bmp_dest, sq_shift, alphaOffsets, bmp_ptrs, alpha_ptrs, 2 );
+}
+
+/// Lights the texels under one lumel, interpolating the four lumels around
+/// it, and writes them out as 5551.  Works on two texels at a time, so
+/// there must be at least two texels per lumel.
+static void lightLumelSSE2( U16 *dstbits, const U32 *srcbits, const U32 *lumels,
+                            U32 texelsPerLumel, U32 texelsPerLumel_log2, U32 srcStride )
+{
+   // The corner colors, in the same fixed point as the C code, one channel
+   // per lane in the order of the source bytes.
+   __m128i col[4];
+   for ( U32 i = 0; i < 4; i++ )
+      col[i] = _mm_set_epi32( 0, lumels[i] & (0x1f << 11), (lumels[i] << 5) & (0x1f << 11), (lumels[i] << 10) & (0x1f << 11) );
+
+   const __m128i left_component_delta = _mm_srli_epi32(_mm_sub_epi32(col[2], col[0]), texelsPerLumel_log2);
+   const __m128i right_component_delta = _mm_srli_epi32(_mm_sub_epi32(col[3], col[1]), texelsPerLumel_log2);
+   __m128i vscan_left_component = col[0];
+   __m128i vscan_right_component = col[1];
+
+   const __m128i zero = _mm_setzero_si128();
+   const __m128i alphaMask = _mm_set1_epi32(0x3F);
+   const __m128i round = _mm_set1_epi16(SSE2_ROUND_63);
+   const __m128i div63 = _mm_set1_epi16(S16(SSE2_DIV_63_MUL));
+   const __m128i maxColor = _mm_set1_epi16(255);
+   // puts the five bit channels of each texel together with a multiply-add
+   const __m128i packWeights = _mm_set_epi16(0, 1 << 1, 1 << 6, 1 << 11, 0, 1 << 1, 1 << 6, 1 << 11);
+
+   for ( U32 yTexelInLumel = 0; yTexelInLumel < texelsPerLumel; yTexelInLumel++ )
+   {
+      const __m128i across_component_delta = _mm_srli_epi32(_mm_sub_epi32(vscan_right_component, vscan_left_component), texelsPerLumel_log2);
+      __m128i hscan_component = vscan_left_component;
+      vscan_left_component = _mm_add_epi32(vscan_left_component, left_component_delta);
+      vscan_right_component = _mm_add_epi32(vscan_right_component, right_component_delta);
+
+      for ( U32 xTexelInLumel = 0; xTexelInLumel < texelsPerLumel; xTexelInLumel += 2 )
+      {
+         const __m128i hscan0 = hscan_component;
+         const __m128i hscan1 = _mm_add_epi32(hscan0, across_component_delta);
+         hscan_component = _mm_add_epi32(hscan1, across_component_delta);
+
+         const __m128i light = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(hscan0, 10), alphaMask),
+                                               _mm_and_si128(_mm_srli_epi32(hscan1, 10), alphaMask));
+         const __m128i texels = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) &srcbits[xTexelInLumel]), zero);
+
+         __m128i color = _mm_add_epi16(_mm_mullo_epi16(texels, light), round);
+         color = _mm_srli_epi16(_mm_mulhi_epu16(color, div63), SSE2_DIV_63_SHIFT);
+         color = _mm_min_epi16(_mm_add_epi16(color, color), maxColor);
+         color = _mm_srli_epi16(color, 3);
+
+         __m128i packed = _mm_madd_epi16(color, packWeights);
+         packed = _mm_add_epi32(packed, _mm_srli_epi64(packed, 32));
+         packed = _mm_shuffle_epi32(packed, _MM_SHUFFLE(3, 1, 2, 0));
+         packed = _mm_shufflelo_epi16(packed, _MM_SHUFFLE(3, 2, 2, 0));
+         *(U32 *) &dstbits[xTexelInLumel] = U32(_mm_cvtsi128_si32(packed));
+      }
+
+      dstbits += TEXELS_PER_TARGET_EDGE;
+      srcbits += srcStride;
+   }
+}
+
+#endif /* BLENDER_USE_SSE2 */
 
 // old C extruder
 static void extrude5551( const U16 *srcMip, U16 *mip, U32 height, U32 width )
@@ -687,6 +872,7 @@ class AlphaCalc
 inline void Blender::blend_vec( int x, int y, int squaresPerTargetEdge_log2, const U16 *lmap, U16 **destmips )
 {
 	PROFILE_START(ALTIVEC_BLEND);
+	TerrainBlock *block = TerrainRender::mCurrentBlock;
 	const U32 squaresPerTargetEdge(1 << squaresPerTargetEdge_log2); // 32 (low detail) to 4 (high detail).
 	const U32 texelsPerSquareEdge_log2(TEXELS_PER_TARGET_EDGE_LOG2 - squaresPerTargetEdge_log2);  // 5 (high detail) to 2 (low detail)
 	const U32 texelsPerSquareEdge(1 << texelsPerSquareEdge_log2); // == TEXELS_PER_TARGET_EDGE / squaresPerTargetEdge); 4 (low) to 32 (high) detail.
@@ -803,13 +989,13 @@ inline void Blender::blend_vec( int x, int y, int squaresPerTargetEdge_log2, con
 				switch( numTexturesToBlend ) // Blend 1 square of the numTexturesToBlend bit-maps into the blend buffer
 				{
 						case 2:
-							doSquare2( blendbuffer, texelsPerSquareEdge_log2, alphaOffsets, sourceSquareBitMaps, alphaMaps  );
+							doSquare2C( blendbuffer, texelsPerSquareEdge_log2, alphaOffsets, sourceSquareBitMaps, alphaMaps  );
 							break;
 						case 3:
-							doSquare3( blendbuffer, texelsPerSquareEdge_log2, alphaOffsets, sourceSquareBitMaps, alphaMaps  );
+							doSquare3C( blendbuffer, texelsPerSquareEdge_log2, alphaOffsets, sourceSquareBitMaps, alphaMaps  );
 							break;
 						default: // more subtle paranoia
-							doSquare4( blendbuffer, texelsPerSquareEdge_log2, alphaOffsets, sourceSquareBitMaps, alphaMaps  );
+							doSquare4C( blendbuffer, texelsPerSquareEdge_log2, alphaOffsets, sourceSquareBitMaps, alphaMaps  );
 							break;
 				}
 			}
@@ -922,17 +1108,29 @@ void Blender::blend( int x, int y, int squaresPerTargetEdge_log2, const U16 *lma
    if(smUseVecBlender)
      blend_vec(x, y, squaresPerTargetEdge_log2, lmap, destmips);
    else
-      blend_c(x, y, squaresPerTargetEdge_log2, lmap, destmips);
+      blend_c(x, y, squaresPerTargetEdge_log2, lmap, destmips, blendbuffer, TerrainRender::mCurrentBlock, true);
 }
 
 #else
 void Blender::blend( int x, int y, int squaresPerTargetEdge_log2, const U16 *lmap, U16 **destmips )
 {
-   blend_c(x, y, squaresPerTargetEdge_log2, lmap, destmips);
+   blend_c(x, y, squaresPerTargetEdge_log2, lmap, destmips, blendbuffer, TerrainRender::mCurrentBlock, true);
 }
 #endif
 
-inline void Blender::blend_c( int x, int y, int squaresPerTargetEdge_log2, const U16 *lmap, U16 **destmips )
+void Blender::blendThreadSafe( int x, int y, int squaresPerTargetEdge_log2, const U16 *lmap, U16 **destmips,
+                               U32 *buffer, TerrainBlock *block )
+{
+   blend_c(x, y, squaresPerTargetEdge_log2, lmap, destmips, buffer, block, false);
+}
+
+U32 Blender::getBlendBufferSize()
+{
+   return MAX_TEXELS_PER_SQUARE;
+}
+
+inline void Blender::blend_c( int x, int y, int squaresPerTargetEdge_log2, const U16 *lmap, U16 **destmips,
+                              U32 *blendbuffer, TerrainBlock *block, bool useAsm )
 {
    PROFILE_START(Blender);
    const int squaresPerTargetEdge(1 << squaresPerTargetEdge_log2); // 32 (low detail) to 4 (high detail).
@@ -948,19 +1146,51 @@ inline void Blender::blend_c( int x, int y, int squaresPerTargetEdge_log2, const
    const U32 yStrideThroughTargetAcrossLumels(yStrideThroughTarget << targetTexelsPerLumel_log2);
    const U32 yStrideThroughSquareAcrossLumels(yStrideThroughSquare << targetTexelsPerLumel_log2);
 
+   typedef void (*DoSquareFn)( U32 *, int, const int *, const U32 *const *, const U8 *const * );
+   DoSquareFn doSquare2 = doSquare2C;
+   DoSquareFn doSquare3 = doSquare3C;
+   DoSquareFn doSquare4 = doSquare4C;
+
+   // The lumels are passed to the assembly code in a global, the C code
+   // keeps its own so it can run on any thread.
+   U32 localLumels[4];
+   U32 *lumel = localLumels;
+
+#if defined(BLENDER_USE_SSE2)
+   // SSE2 works on at least four texels per square and two per lumel, the
+   // lowest detail level is left to the other code.  It's safe on any
+   // thread, and preferred to the assembly.
+   const bool useSSE2 = smUseSSE2Blender && texelsPerSquareEdge >= 4;
+   if ( useSSE2 )
+   {
+      useAsm = false;
+      doSquare2 = doSquare2SSE2;
+      doSquare3 = doSquare3SSE2;
+      doSquare4 = doSquare4SSE2;
+   }
+#endif
+
 #if defined(BLENDER_USE_ASM)
-   // These are all secret parameters passed to the assembly language code through statics.
-   sTargetTexelsPerLumel_log2 = targetTexelsPerLumel_log2;
-   sTargetTexelsPerLumel = targetTexelsPerLumel;
-
-   sTargetTexelsPerLumelDiv2 = targetTexelsPerLumel >> 1;
-   nextsrcrow = ((yStrideThroughSquare) << 2);
-   nextdstrow = ((yStrideThroughTarget) << 1);
-
-   mip0_dstrowadd = (nextdstrow << 1) - (targetTexelsPerLumel << 1);
-   mip1_dstrowadd = (nextdstrow >> 1) - (targetTexelsPerLumel);
-   minus1srcrowsPlus8 = 8 - nextsrcrow;
-   srcrows_x2_MinusTPL = (nextsrcrow << 1) - (targetTexelsPerLumel << 2);
+   if ( useAsm )
+   {
+      doSquare2 = ::doSquare2;
+      doSquare3 = ::doSquare3;
+      doSquare4 = ::doSquare4;
+      lumel = lumels;
+
+      // These are all secret parameters passed to the assembly language code through statics.
+      sTargetTexelsPerLumel_log2 = targetTexelsPerLumel_log2;
+      sTargetTexelsPerLumel = targetTexelsPerLumel;
+
+      sTargetTexelsPerLumelDiv2 = targetTexelsPerLumel >> 1;
+      nextsrcrow = ((yStrideThroughSquare) << 2);
+      nextdstrow = ((yStrideThroughTarget) << 1);
+
+      mip0_dstrowadd = (nextdstrow << 1) - (targetTexelsPerLumel << 1);
+      mip1_dstrowadd = (nextdstrow >> 1) - (targetTexelsPerLumel);
+      minus1srcrowsPlus8 = 8 - nextsrcrow;
+      srcrows_x2_MinusTPL = (nextsrcrow << 1) - (targetTexelsPerLumel << 2);
+   }
 #endif
 
    const U32 *const*const allSourceBitMaps = &bmpdata[sourceMipMapIndex * num_src_bmps];
@@ -1100,103 +1330,116 @@ inline void Blender::blend_c( int x, int y, int squaresPerTargetEdge_log2, const
                   U32 texelInSquare_offset = yTexelInSquare_offset + xTexelInSquare_offset;
 
                   // lumels are secret parameters to subroutines
-                  lumels[0] = U32(lmap[xInLightmap | yInLightmap_offset]);
-                  lumels[1] = U32(lmap[next_xInLightmap | yInLightmap_offset]);
-                  lumels[2] = U32(lmap[xInLightmap | next_yInLightmap_offset]);
-                  lumels[3] = U32(lmap[next_xInLightmap | next_yInLightmap_offset]);
+                  lumel[0] = U32(lmap[xInLightmap | yInLightmap_offset]);
+                  lumel[1] = U32(lmap[next_xInLightmap | yInLightmap_offset]);
+                  lumel[2] = U32(lmap[xInLightmap | next_yInLightmap_offset]);
+                  lumel[3] = U32(lmap[next_xInLightmap | next_yInLightmap_offset]);
 
 				  PROFILE_START(BlenderInASM);
 #if defined(BLENDER_USE_ASM)
-                  if ( targetTexelsPerLumel > 1 )
+                  if ( useAsm )
                   {
-                     doLumelPlus1Mip( &bits0[ texelInTargetSquare_offset ],
-                        &bits1[ (yTexelInTargetSquare_offset >> 2) + (xTexelInSquare_offset >> 1) ],
-                        &bufferToLightFrom[ texelInSquare_offset ] );
+                     if ( targetTexelsPerLumel > 1 )
+                     {
+                        doLumelPlus1Mip( &bits0[ texelInTargetSquare_offset ],
+                           &bits1[ (yTexelInTargetSquare_offset >> 2) + (xTexelInSquare_offset >> 1) ],
+                           &bufferToLightFrom[ texelInSquare_offset ] );
+                     }
+                     else
+                        do1x1Lumel( &bits0[ texelInTargetSquare_offset ], &bufferToLightFrom[ texelInSquare_offset ] );
                   }
                   else
-                     do1x1Lumel( &bits0[ texelInTargetSquare_offset ], &bufferToLightFrom[ texelInSquare_offset ] );
-#else
-                  // Split the LUMELs into colors
-                  U32 col[3][4];
-
-                  U32 i;
-                  for(i = 0; i < 4; i++)
+#endif
+#if defined(BLENDER_USE_SSE2)
+                  if ( useSSE2 )
                   {
-                     col[2][i] = (lumels[i]) & (0x1f << 11);
-                     col[1][i] = (lumels[i] << 5)   & (0x1f << 11);
-                     col[0][i] = (lumels[i] << 10) & (0x1f << 11);
+                     lightLumelSSE2( &bits0[ texelInTargetSquare_offset ], &bufferToLightFrom[ texelInSquare_offset ], lumel,
+                        targetTexelsPerLumel, targetTexelsPerLumel_log2, yStrideThroughSquare );
                   }
-
-                  // One for each color component
-                  U32 left_component_delta[3];
-                  U32 right_component_delta[3];
-                  U32 vscan_left_component[3];
-                  U32 vscan_right_component[3];
-
-                  for(i = 0; i < 3; i++)
+                  else
+#endif
                   {
-                     left_component_delta[i] = (col[i][2] - col[i][0]) >> targetTexelsPerLumel_log2;
-                     right_component_delta[i] = (col[i][3] - col[i][1]) >> targetTexelsPerLumel_log2;
+                     // Split the LUMELs into colors
+                     U32 col[3][4];
 
-                     vscan_left_component[i] = col[i][0];
-                     vscan_right_component[i] = col[i][1];
-                  }
+                     U32 i;
+                     for(i = 0; i < 4; i++)
+                     {
+                        col[2][i] = (lumel[i]) & (0x1f << 11);
+                        col[1][i] = (lumel[i] << 5)   & (0x1f << 11);
+                        col[0][i] = (lumel[i] << 10) & (0x1f << 11);
+                     }
 
-                  // Now we interpolate the color shifts across the square
-                  for(U32 yTexelInLumel = 0; yTexelInLumel < targetTexelsPerLumel; yTexelInLumel++)
-                  {
-                     U32 across_component_delta[3];
-                     U32 hscan_component[3];
+                     // One for each color component
+                     U32 left_component_delta[3];
+                     U32 right_component_delta[3];
+                     U32 vscan_left_component[3];
+                     U32 vscan_right_component[3];
 
                      for(i = 0; i < 3; i++)
                      {
-                        across_component_delta[i] = (vscan_right_component[i] - vscan_left_component[i]) >> targetTexelsPerLumel_log2;
-                        hscan_component[i] = vscan_left_component[i];
-                        vscan_left_component[i] += left_component_delta[i];
-                        vscan_right_component[i] += right_component_delta[i];
-                     }
+                        left_component_delta[i] = (col[i][2] - col[i][0]) >> targetTexelsPerLumel_log2;
+                        right_component_delta[i] = (col[i][3] - col[i][1]) >> targetTexelsPerLumel_log2;
 
-                     U16 *dstbits = &bits0[ texelInTargetSquare_offset ];
-                     const U8 *srcbits = (U8 *)&bufferToLightFrom[ texelInSquare_offset ];
+                        vscan_left_component[i] = col[i][0];
+                        vscan_right_component[i] = col[i][1];
+                     }
 
-                     for(U32 xTexelInLumel = 0; xTexelInLumel < targetTexelsPerLumel; xTexelInLumel++)
+                     // Now we interpolate the color shifts across the square
+                     for(U32 yTexelInLumel = 0; yTexelInLumel < targetTexelsPerLumel; yTexelInLumel++)
                      {
-						 PROFILE_START(BlendInnermost);
-                        U16 dstcol[3];
+                        U32 across_component_delta[3];
+                        U32 hscan_component[3];
 
-                        for(i = 0; i < 3; i++) // Unroll this dumb loop?
+                        for(i = 0; i < 3; i++)
                         {
-                           U32 index = (hscan_component[i] >> 2) & 0x3F00;
-                           dstcol[i] = alphaTable[index | srcbits[i]];
-                           hscan_component[i] += across_component_delta[i];
+                           across_component_delta[i] = (vscan_right_component[i] - vscan_left_component[i]) >> targetTexelsPerLumel_log2;
+                           hscan_component[i] = vscan_left_component[i];
+                           vscan_left_component[i] += left_component_delta[i];
+                           vscan_right_component[i] += right_component_delta[i];
                         }
+
+                        U16 *dstbits = &bits0[ texelInTargetSquare_offset ];
+                        const U8 *srcbits = (U8 *)&bufferToLightFrom[ texelInSquare_offset ];
+
+                        for(U32 xTexelInLumel = 0; xTexelInLumel < targetTexelsPerLumel; xTexelInLumel++)
+                        {
+   						 PROFILE_START(BlendInnermost);
+                           U16 dstcol[3];
+
+                           for(i = 0; i < 3; i++) // Unroll this dumb loop?
+                           {
+                              U32 index = (hscan_component[i] >> 2) & 0x3F00;
+                              dstcol[i] = alphaTable[index | srcbits[i]];
+                              hscan_component[i] += across_component_delta[i];
+                           }
                         
                         
-                        const U16 max = 255;
-                        dstcol[0] += dstcol[0];
-                        dstcol[1] += dstcol[1];
-                        dstcol[2] += dstcol[2];
-                        dstcol[0] = (dstcol[0] > max) ? max : dstcol[0];
-                        dstcol[1] = (dstcol[1] > max) ? max : dstcol[1];
-                        dstcol[2] = (dstcol[2] > max) ? max : dstcol[2];
+                           const U16 max = 255;
+                           dstcol[0] += dstcol[0];
+                           dstcol[1] += dstcol[1];
+                           dstcol[2] += dstcol[2];
+                           dstcol[0] = (dstcol[0] > max) ? max : dstcol[0];
+                           dstcol[1] = (dstcol[1] > max) ? max : dstcol[1];
+                           dstcol[2] = (dstcol[2] > max) ? max : dstcol[2];
                         
 
-#if SRC_IS_ABGR
-                        // NOTE that on Mac, color order is flipped (ABGR1555 instead of RGBA5551), so:
-                        // 1. we already reversed color order via BIG_ENDIAN indexing above, but
-                        // 2. we need to change the shifts for alpha being the high bit instead of the low.
-                        *dstbits++ = ((dstcol[0] & 0xf8) << 7) | ((dstcol[1] & 0xf8) << 2) | ((dstcol[2] & 0xf8) >> 3);
-#else
-                        *dstbits++ = ((dstcol[0] & 0xf8) << 8) | ((dstcol[1] & 0xf8) << 3) | ((dstcol[2] & 0xf8) >> 2);
-#endif
-                        srcbits += 4;
-						PROFILE_END();
-                     }
+   #if SRC_IS_ABGR
+                           // NOTE that on Mac, color order is flipped (ABGR1555 instead of RGBA5551), so:
+                           // 1. we already reversed color order via BIG_ENDIAN indexing above, but
+                           // 2. we need to change the shifts for alpha being the high bit instead of the low.
+                           *dstbits++ = ((dstcol[0] & 0xf8) << 7) | ((dstcol[1] & 0xf8) << 2) | ((dstcol[2] & 0xf8) >> 3);
+   #else
+                           *dstbits++ = ((dstcol[0] & 0xf8) << 8) | ((dstcol[1] & 0xf8) << 3) | ((dstcol[2] & 0xf8) >> 2);
+   #endif
+                           srcbits += 4;
+   						PROFILE_END();
+                        }
 
-                     texelInTargetSquare_offset += yStrideThroughTarget;
-                     texelInSquare_offset += yStrideThroughSquare;
+                        texelInTargetSquare_offset += yStrideThroughTarget;
+                        texelInSquare_offset += yStrideThroughSquare;
+                     }
                   }
-#endif
 				  PROFILE_END();
                   xTexelInSquare_offset += xStrideAcrossLumels;
                   xInLightmap = next_xInLightmap;
@@ -1210,7 +1453,7 @@ inline void Blender::blend_c( int x, int y, int squaresPerTargetEdge_log2, const
    }
 
 #if defined(BLENDER_USE_ASM)
-   if ( targetTexelsPerLumel > 1)
+   if ( useAsm && targetTexelsPerLumel > 1)
    {
       cheatmips( destmips[1], destmips[2], destmips[3], 64 );
       cheatmips( destmips[3], destmips[4], destmips[5], 16 );
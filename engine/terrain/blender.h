@@ -16,7 +16,7 @@
 #include "terrain/terrRender.h"
 #endif
 
-#define GRIDFLAGS(X,Y)   (TerrainRender::mCurrentBlock->findSquare( 0, Point2I( X, Y ) )->flags)
+#define GRIDFLAGS(X,Y)   (block->findSquare( 0, Point2I( X, Y ) )->flags)
 #define MATERIALSTART       (GridSquare::MaterialStart)
 /**
    This MODULE contains class Blender. Blender has a set of textures and an ALPHA-VALUE MAP, and
@@ -121,8 +121,13 @@ class Blender
     /// Mip levels (including top detail) for each bmp type
     int num_mip_levels;
     
-    /// C version of the blender
-    inline void blend_c( int x, int y, int level, const U16 *lightmap, U16 **destmips );
+    /// C version of the blender.
+    ///
+    /// The blend buffer and the block whose grid flags are used are passed in,
+    /// so it can run on any thread as long as useAsm is false; the assembly
+    /// code passes its parameters in globals and is main thread only.
+    inline void blend_c( int x, int y, int level, const U16 *lightmap, U16 **destmips,
+                         U32 *buffer, TerrainBlock *block, bool useAsm );
     
    #if defined(__VEC__)
    /// Altivec version of the blender
@@ -151,6 +156,20 @@ public:
     ///                     mips to be filled in by this function
     void blend( int x, int y, int level, const U16 *lightmap, U16 **destmips );
 
+    /// Same as blend(), but safe to call from worker threads.
+    ///
+    /// Uses the C or SSE2 code, never the assembly, blending through the
+    /// caller's buffer and the grid of the given block instead of
+    /// TerrainRender::mCurrentBlock.
+    ///
+    /// @param  buffer      Scratch space of getBlendBufferSize() U32s.
+    /// @param  block       Block the alpha maps of this blender belong to.
+    void blendThreadSafe( int x, int y, int level, const U16 *lightmap, U16 **destmips,
+                          U32 *buffer, TerrainBlock *block );
+
+    /// Size in U32s of the buffer blendThreadSafe() needs.
+    static U32 getBlendBufferSize();
+
     /// Add a texture to use in blending.
     ///
     /// Call this once per bmp type.  It copies the bmp into it's own format,
@@ -165,6 +184,13 @@ public:
    /// flag to determine which version of the blender is used.
    static bool smUseVecBlender;
    #endif
+
+   #if defined(TORQUE_CPU_X86)
+   /// Use the SSE2 kernels, where they are compiled in.  Set by Math::init()
+   /// when the CPU has SSE2; they're thread safe, so blendThreadSafe() uses
+   /// them too.
+   static bool smUseSSE2Blender;
+   #endif
 };
 
 #endif
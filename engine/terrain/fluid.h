@@ -217,6 +217,16 @@ private:
         ColorF  SPECULAR;
    };
 
+    // The wave, environment map wobble and depth map distortion are sums of
+    // a term in X and a term in Y.  Every vert sits on the quarter block
+    // grid, so the terms are worked out once a frame for each grid line.
+    struct wave_term
+    {
+        f32     Wave;       // Surface height
+        f32     Env;        // EnvMap UV offset
+        f32     Distort;    // Depth map UV offset
+    };
+
 //------------------------------------------------------------------------------
 //  Private Variables
 //
@@ -299,6 +309,13 @@ private:
     static  s32     m_IAllocated;
     static  s32     m_IUsed;
 
+    static  wave_term*  m_pWaveX;
+    static  wave_term*  m_pWaveY;
+    static  s32         m_WaveAllocated;
+    static  s32         m_WaveCount;        // Grid lines in each table
+    static  f32         m_WaveX0, m_WaveY0;  // World position of line 0
+    static  f32         m_WaveInvStep;
+
     static  s32     m_Instances;
 
     //
@@ -352,6 +369,11 @@ private:
 
     void    SetupVert               ( f32 X, f32 Y, f32 Distance, vertex* pV );
 
+    void    BuildWaveTables         ( f32 X0, f32 Y0, s32 Count );
+    void    ComputeWaveTermX        ( f32 X, wave_term* pT ) const;
+    void    ComputeWaveTermY        ( f32 Y, wave_term* pT ) const;
+    s32     GetWaveIndex            ( f32 P, f32 P0 ) const;
+
     void    InterpolateVerts        ( vertex* pV0,
                                       vertex* pV1,
                                       vertex* pV2,
@@ -367,7 +389,7 @@ private:
 
     void    ReleaseVertexMemory     ( void );
     vertex* AcquireVertices         ( s32 Count );
-    void    AddTriangleIndices      ( s16 I1, s16 I2, s16 I3 );
+    void    AddBlockIndices         ( const s16* pIndices, s32 Count );
 
     void    CalcVertSpecular        ();
 };
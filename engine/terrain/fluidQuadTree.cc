@@ -20,6 +20,14 @@ s16             fluid::m_IOffset    = 0;
 s32             fluid::m_IAllocated = 0;
 s32             fluid::m_IUsed      = 0;
 
+fluid::wave_term* fluid::m_pWaveX        = NULL;
+fluid::wave_term* fluid::m_pWaveY        = NULL;
+s32               fluid::m_WaveAllocated = 0;
+s32               fluid::m_WaveCount     = 0;
+f32               fluid::m_WaveX0        = 0.0f;
+f32               fluid::m_WaveY0        = 0.0f;
+f32               fluid::m_WaveInvStep   = 0.0f;
+
 static  f32     sSurfaceAtEye;
 static  f32     sFogZ;
 //atic  f32     sFogTable[64];
@@ -72,10 +80,13 @@ fluid::vertex* fluid::AcquireVertices( s32 Count )
         ASSERT( m_pVertex );
     }
 
-    while( Count + m_VUsed > m_VAllocated )
+    // Double up, so a big fluid doesn't realloc every few blocks on its
+    // first frame.
+    if( Count + m_VUsed > m_VAllocated )
     {
-        m_VAllocated += 100;
-        m_pVertex     = (vertex*)REALLOC( m_pVertex, m_VAllocated * sizeof(vertex) );
+        while( Count + m_VUsed > m_VAllocated )
+            m_VAllocated *= 2;
+        m_pVertex = (vertex*)REALLOC( m_pVertex, m_VAllocated * sizeof(vertex) );
         ASSERT( m_pVertex );
     }
 
@@ -88,31 +99,36 @@ fluid::vertex* fluid::AcquireVertices( s32 Count )
 
 //==============================================================================
 
-void fluid::AddTriangleIndices( s16 I1, s16 I2, s16 I3 )
+// Appends one of the fixed block meshes, relative to the last verts acquired.
+
+void fluid::AddBlockIndices( const s16* pIndices, s32 Count )
 {
     if( m_IAllocated == 0 )
     {
-        m_IAllocated = 100;
+        m_IAllocated = 384;
         m_IUsed      =   0;
         m_pIndex     = (s16*)MALLOC( m_IAllocated * sizeof(s16) );
         m_pINext     = m_pIndex;
         ASSERT( m_pIndex );
     }
 
-    if( m_IUsed+3 > m_IAllocated )
+    if( m_IUsed+Count > m_IAllocated )
     {
         s32 Next = m_pINext - m_pIndex;
-        m_IAllocated += 100;
+        while( m_IUsed+Count > m_IAllocated )
+            m_IAllocated *= 2;
         m_pIndex      = (s16*)REALLOC( m_pIndex, m_IAllocated * sizeof(s16) );
         m_pINext      = m_pIndex + Next;
         ASSERT( m_pIndex );
     }
 
-    m_IUsed += 3;
+    m_IUsed += Count;
 
-    *m_pINext = m_IOffset + I1;  m_pINext++;
-    *m_pINext = m_IOffset + I2;  m_pINext++;
-    *m_pINext = m_IOffset + I3;  m_pINext++;
+    for( s32 i = 0; i < Count; i++ )
+    {
+        *m_pINext = m_IOffset + pIndices[i];
+        m_pINext++;
+    }
 }
 
 //==============================================================================
@@ -135,6 +151,75 @@ void fluid::ReleaseVertexMemory( void )
         m_IAllocated = 0;
         m_IUsed      = 0;
     }
+
+    if( m_pWaveX )
+    {
+        FREE( m_pWaveX );
+        m_pWaveX        = NULL;
+        m_pWaveY        = NULL;
+        m_WaveAllocated = 0;
+        m_WaveCount     = 0;
+    }
+}
+
+//==============================================================================
+
+// Period (in meters) and size of the wobble on the environment map UVs.
+#define ENV_WOBBLE_PERIOD       150.0f
+#define ENV_WOBBLE_MAGNITUDE      0.01f
+
+void fluid::ComputeWaveTermX( f32 X, wave_term* pT ) const
+{
+    pT->Wave    = SINE  ( (X * 0.05f) + m_Seconds );
+    pT->Env     = COSINE( (X / ENV_WOBBLE_PERIOD) + (m_Seconds / m_DistortTime) );
+    pT->Distort = m_DistortMagnitude * COSINE( (X * m_DistortGridScale) + (m_Seconds / m_DistortTime) );
+}
+
+void fluid::ComputeWaveTermY( f32 Y, wave_term* pT ) const
+{
+    pT->Wave    = SINE( (Y * 0.05f) + m_Seconds );
+    pT->Env     = SINE( (Y / ENV_WOBBLE_PERIOD) + (m_Seconds / m_DistortTime) );
+    pT->Distort = m_DistortMagnitude * SINE( (Y * m_DistortGridScale) + (m_Seconds / m_DistortTime) );
+}
+
+//==============================================================================
+// Fills the tables for Count grid lines a quarter block apart in each
+// direction, starting at (X0,Y0).
+
+void fluid::BuildWaveTables( f32 X0, f32 Y0, s32 Count )
+{
+    s32 i;
+
+    if( Count > m_WaveAllocated )
+    {
+        m_WaveAllocated = Count;
+        m_pWaveX        = (wave_term*)REALLOC( m_pWaveX, 2 * m_WaveAllocated * sizeof(wave_term) );
+        ASSERT( m_pWaveX );
+    }
+    m_pWaveY      = m_pWaveX + m_WaveAllocated;
+    m_WaveCount   = Count;
+    m_WaveX0      = X0;
+    m_WaveY0      = Y0;
+    m_WaveInvStep = 1.0f / m_Step[1];
+
+    for( i = 0; i < Count; i++ )
+    {
+        ComputeWaveTermX( X0 + i * m_Step[1], m_pWaveX + i );
+        ComputeWaveTermY( Y0 + i * m_Step[1], m_pWaveY + i );
+    }
+}
+
+//==============================================================================
+// Grid line P is on, or -1 if it's off the tables.
+
+s32 fluid::GetWaveIndex( f32 P, f32 P0 ) const
+{
+    f32 Line = (P - P0) * m_WaveInvStep + 0.5f;
+    if( Line < 0.0f )
+        return( -1 );
+
+    s32 Index = (s32)Line;
+    return( Index < m_WaveCount ? Index : -1 );
 }
 
 //==============================================================================
@@ -168,6 +253,7 @@ void fluid::RunQuadTree( bool& EyeSubmerged )
     s32     Top = -1;
     s32     i, j;
     s32     I, J;
+    s32     Reps;
     s32     BlocksPerRep  = m_HighResMode ? 64 : 32;
 
     // Build a fog sample table.
@@ -194,9 +280,29 @@ void fluid::RunQuadTree( bool& EyeSubmerged )
     if( m_Eye.x < 0.0f )  I--;
     if( m_Eye.y < 0.0f )  J--;
 
-    // Push 9 reps of the fluid onto the stack.
-    for( j = J-1; j <= J+1; j++ )
-    for( i = I-1; i <= I+1; i++ )
+    // A fluid that doesn't tile is only in its own rep.  Otherwise, the rep
+    // the eye is in and the 8 around it.
+    if( mTile )
+    {
+        I   -= 1;
+        J   -= 1;
+        Reps = 3;
+    }
+    else
+    {
+        I    = 0;
+        J    = 0;
+        Reps = 1;
+    }
+
+    // The wave terms for every grid line those reps can use.
+    BuildWaveTables( (I * BlocksPerRep * m_Step[4]) + (m_SquareX0 * F32(m_TerrainBlockSize)),
+                     (J * BlocksPerRep * m_Step[4]) + (m_SquareY0 * F32(m_TerrainBlockSize)),
+                     (Reps * BlocksPerRep * 4) + 1 );
+
+    // Push the reps of the fluid onto the stack.
+    for( j = J; j < J+Reps; j++ )
+    for( i = I; i < I+Reps; i++ )
     {
         // New stack node.
         Top++;
@@ -509,6 +615,61 @@ static s16 HighLODIndices[96] =
     18, 19, 24,    24, 23, 18,
 };
 
+//==============================================================================
+//
+// The transition block is a fan around the center, [4].  An edge whose ends
+// both have some detail gets its three inner verts, which follow the corners
+// and center in edge order, and four triangles.  The rest get one.  There is
+// a mesh for each combination of split edges, bit N for edge N.
+//
+
+static s16 LowLODIndices[12] =
+{
+    0, 1, 4,    1, 3, 4,    3, 2, 4,    2, 0, 4,
+};
+
+static s16  TransLODIndices[16][48];
+static s32  TransLODCounts [16];
+static s32  TransLODVerts  [16];
+static bool TransLODBuilt = false;
+
+static void BuildTransLODIndices( void )
+{
+    // Edges are walked [0]->[1]->[3]->[2]->[0].
+    static const s16 Ends[4][2] = { { 0, 1 }, { 1, 3 }, { 3, 2 }, { 2, 0 } };
+    s32 Mask, Edge;
+
+    for( Mask = 0; Mask < 16; Mask++ )
+    {
+        s16* pI = TransLODIndices[Mask];
+        s16  I  = 5;
+
+        for( Edge = 0; Edge < 4; Edge++ )
+        {
+            s16 A = Ends[Edge][0];
+            s16 B = Ends[Edge][1];
+
+            if( Mask & (1 << Edge) )
+            {
+                *pI++ = 4; *pI++ = A;   *pI++ = I+0;
+                *pI++ = 4; *pI++ = I+0; *pI++ = I+1;
+                *pI++ = 4; *pI++ = I+1; *pI++ = I+2;
+                *pI++ = 4; *pI++ = I+2; *pI++ = B;
+                I += 3;
+            }
+            else
+            {
+                *pI++ = 4; *pI++ = A;   *pI++ = B;
+            }
+        }
+
+        TransLODCounts[Mask] = pI - TransLODIndices[Mask];
+        TransLODVerts [Mask] = I;
+    }
+
+    TransLODBuilt = true;
+}
+
 //==============================================================================
 
 void fluid::ProcessBlockLODHigh( block& Block )
@@ -516,7 +677,6 @@ void fluid::ProcessBlockLODHigh( block& Block )
     vertex* pV;
     s32     X, Y, i;
     f32     x, y;
-    s16*    pIndex = HighLODIndices;
     f32     Distance;
 
     // Get vetices.
@@ -545,11 +705,7 @@ void fluid::ProcessBlockLODHigh( block& Block )
     }
 
     // Add the triangle indices.
-    for( i = 0; i < 32; i++ )
-    {
-        AddTriangleIndices( *(pIndex+0), *(pIndex+1), *(pIndex+2) );
-        pIndex += 3;
-    }
+    AddBlockIndices( HighLODIndices, 96 );
 }
 
 //==============================================================================
@@ -559,7 +715,6 @@ void fluid::ProcessBlockLODMorph( block& Block )
     vertex* pV;
     s32     X, Y, i;
     f32     x, y;
-    s16*    pIndex = HighLODIndices;
     f32     Distance;
     f32     LOD;
     f32     MiddleX = Block.X0 + m_Step[2];
@@ -613,11 +768,7 @@ void fluid::ProcessBlockLODMorph( block& Block )
     InterpolateVert( pV + 12, pV + 11, pV + 10, LOD );
 
     // Add the triangle indices.
-    for( i = 0; i < 32; i++ )
-    {
-        AddTriangleIndices( *(pIndex+0), *(pIndex+1), *(pIndex+2) );
-        pIndex += 3;
-    }
+    AddBlockIndices( HighLODIndices, 96 );
 }
 
 //==============================================================================
@@ -625,7 +776,7 @@ void fluid::ProcessBlockLODMorph( block& Block )
 void fluid::ProcessBlockLODTrans( block& Block )
 {
     vertex* pV;
-    s32     Verts;
+    s32     Mask;
     s32     I;
     f32     X, Y;
     f32     Distance;
@@ -633,15 +784,18 @@ void fluid::ProcessBlockLODTrans( block& Block )
     f32     MiddleY = Block.Y0 + m_Step[2];
     f32     MiddleD = DISTANCE( MiddleX, MiddleY, m_SurfaceZ );
 
-    // Determine how many verts we need.
-    Verts = 5;
-    if( (Block.LOD[0] > 0.0f) && (Block.LOD[0] > 0.0f) )    Verts += 3;
-    if( (Block.LOD[1] > 0.0f) && (Block.LOD[3] > 0.0f) )    Verts += 3;
-    if( (Block.LOD[3] > 0.0f) && (Block.LOD[2] > 0.0f) )    Verts += 3;
-    if( (Block.LOD[2] > 0.0f) && (Block.LOD[0] > 0.0f) )    Verts += 3;
+    if( !TransLODBuilt )
+        BuildTransLODIndices();
+
+    // Determine which edges are split, and so how many verts we need.
+    Mask = 0;
+    if( (Block.LOD[0] > 0.0f) && (Block.LOD[1] > 0.0f) )    Mask |= 1;
+    if( (Block.LOD[1] > 0.0f) && (Block.LOD[3] > 0.0f) )    Mask |= 2;
+    if( (Block.LOD[3] > 0.0f) && (Block.LOD[2] > 0.0f) )    Mask |= 4;
+    if( (Block.LOD[2] > 0.0f) && (Block.LOD[0] > 0.0f) )    Mask |= 8;
 
     // Get vetices.
-    pV = AcquireVertices( Verts );
+    pV = AcquireVertices( TransLODVerts[Mask] );
 
     // Build the corner and center vertices.
     SetupVert( Block.X0, Block.Y0, Block.Distance[0], pV+0 );
@@ -654,7 +808,7 @@ void fluid::ProcessBlockLODTrans( block& Block )
 
     //------------------------------------------------------
 
-    if( (Block.LOD[0] > 0.0f) && (Block.LOD[1] > 0.0f) )
+    if( Mask & 1 )
     {
         X = Block.X0 + m_Step[1];
         Distance = DISTANCE( X, Block.Y0, m_SurfaceZ );
@@ -669,20 +823,12 @@ void fluid::ProcessBlockLODTrans( block& Block )
         SetupVert( X, Block.Y0, Distance, pV+I+2 );
 
         InterpolateVerts( pV+0, pV+I+0, pV+I+1, pV+I+2, pV+1, Block.LOD[0], Block.LOD[1] );
-        AddTriangleIndices( 4,   0, I+0 );
-        AddTriangleIndices( 4, I+0, I+1 );
-        AddTriangleIndices( 4, I+1, I+2 );
-        AddTriangleIndices( 4, I+2,   1 );
         I += 3;
     }
-    else
-    {
-        AddTriangleIndices( 4, 0, 1 );
-    }
 
     //------------------------------------------------------
 
-    if( (Block.LOD[1] > 0.0f) && (Block.LOD[3] > 0.0f) )
+    if( Mask & 2 )
     {
         Y = Block.Y0 + m_Step[1];
         Distance = DISTANCE( Block.X1, Y, m_SurfaceZ );
@@ -697,20 +843,12 @@ void fluid::ProcessBlockLODTrans( block& Block )
         SetupVert( Block.X1, Y, Distance, pV+I+2 );
 
         InterpolateVerts( pV+1, pV+I+0, pV+I+1, pV+I+2, pV+3, Block.LOD[1], Block.LOD[3] );
-        AddTriangleIndices( 4,   1, I+0 );
-        AddTriangleIndices( 4, I+0, I+1 );
-        AddTriangleIndices( 4, I+1, I+2 );
-        AddTriangleIndices( 4, I+2,   3 );
         I += 3;
     }
-    else
-    {
-        AddTriangleIndices( 4, 1, 3 );
-    }
 
     //------------------------------------------------------
 
-    if( (Block.LOD[3] > 0.0f) && (Block.LOD[2] > 0.0f) )
+    if( Mask & 4 )
     {
         X = Block.X1 - m_Step[1];
         Distance = DISTANCE( X, Block.Y1, m_SurfaceZ );
@@ -725,20 +863,12 @@ void fluid::ProcessBlockLODTrans( block& Block )
         SetupVert( X, Block.Y1, Distance, pV+I+2 );
 
         InterpolateVerts( pV+3, pV+I+0, pV+I+1, pV+I+2, pV+2, Block.LOD[3], Block.LOD[2] );
-        AddTriangleIndices( 4,   3, I+0 );
-        AddTriangleIndices( 4, I+0, I+1 );
-        AddTriangleIndices( 4, I+1, I+2 );
-        AddTriangleIndices( 4, I+2,   2 );
         I += 3;
     }
-    else
-    {
-        AddTriangleIndices( 4, 3, 2 );
-    }
 
     //------------------------------------------------------
 
-    if( (Block.LOD[2] > 0.0f) && (Block.LOD[0] > 0.0f) )
+    if( Mask & 8 )
     {
         Y = Block.Y1 - m_Step[1];
         Distance = DISTANCE( Block.X0, Y, m_SurfaceZ );
@@ -753,18 +883,13 @@ void fluid::ProcessBlockLODTrans( block& Block )
         SetupVert( Block.X0, Y, Distance, pV+I+2 );
 
         InterpolateVerts( pV+2, pV+I+0, pV+I+1, pV+I+2, pV+0, Block.LOD[2], Block.LOD[0] );
-        AddTriangleIndices( 4,   2, I+0 );
-        AddTriangleIndices( 4, I+0, I+1 );
-        AddTriangleIndices( 4, I+1, I+2 );
-        AddTriangleIndices( 4, I+2,   0 );
         I += 3;
     }
-    else
-    {
-        AddTriangleIndices( 4, 2, 0 );
-    }
 
     //------------------------------------------------------
+
+    // Add the triangle indices.
+    AddBlockIndices( TransLODIndices[Mask], TransLODCounts[Mask] );
 }
 
 //==============================================================================
@@ -798,10 +923,7 @@ void fluid::ProcessBlockLODLow( block& Block )
 //--Attempt to reject if all fogged.
 
     // Add the triangle indices.
-    AddTriangleIndices( 0, 1, 4 );
-    AddTriangleIndices( 1, 3, 4 );
-    AddTriangleIndices( 3, 2, 4 );
-    AddTriangleIndices( 2, 0, 4 );
+    AddBlockIndices( LowLODIndices, 12 );
 
     // Quick debug render.
 #if 0
@@ -829,6 +951,20 @@ void fluid::SetupVert( f32 X, f32 Y, f32 Distance, vertex* pV )
 {
     f32 Z;
 
+    // Look up the wave terms for this vert's grid lines.
+    wave_term        TX, TY;
+    const wave_term* pTX;
+    const wave_term* pTY;
+    s32              Index;
+
+    Index = GetWaveIndex( X, m_WaveX0 );
+    if( Index >= 0 )    pTX = m_pWaveX + Index;
+    else                { ComputeWaveTermX( X, &TX );  pTX = &TX; }
+
+    Index = GetWaveIndex( Y, m_WaveY0 );
+    if( Index >= 0 )    pTY = m_pWaveY + Index;
+    else                { ComputeWaveTermY( Y, &TY );  pTY = &TY; }
+
     //
     // Compute a Z value.
     //
@@ -837,8 +973,7 @@ void fluid::SetupVert( f32 X, f32 Y, f32 Distance, vertex* pV )
         f32 WarpFactor;
         f32 Delta;
 
-        Delta = SINE( (X * 0.05f) + m_Seconds ) +
-                SINE( (Y * 0.05f) + m_Seconds );
+        Delta = pTX->Wave + pTY->Wave;
 
         Z = m_SurfaceZ + Delta * m_WaveFactor;
 
@@ -950,16 +1085,12 @@ void fluid::SetupVert( f32 X, f32 Y, f32 Distance, vertex* pV )
 
         // Now, based on the XY, tweak the UV in some liquid manner.
 
-        volatile static f32 Q1 = 150.00f;
-        volatile static f32 Q2 =   2.00f;
-        volatile static f32 Q3 =   0.01f;
-
 		// MM: Modified the environment distortion times to match the surface distortion.
-        f32 A1 = COSINE( ((X / Q1) + (m_Seconds / m_DistortTime)));
-        f32 A2 = SINE  ( ((Y / Q1) + (m_Seconds / m_DistortTime)));
+        f32 A1 = pTX->Env;
+        f32 A2 = pTY->Env;
 
-        pV->UV3.U += A1 * Q3;
-        pV->UV3.V += A2 * Q3;
+        pV->UV3.U += A1 * ENV_WOBBLE_MAGNITUDE;
+        pV->UV3.V += A2 * ENV_WOBBLE_MAGNITUDE;
 
 		// MM:	Removed the fresnel style blending as it makes the depth-map difficult
 		//		to control.
@@ -974,8 +1105,8 @@ void fluid::SetupVert( f32 X, f32 Y, f32 Distance, vertex* pV )
     }
 
 	// MM: Calculate Depth-map Position.
-	f32 S1 = m_DistortMagnitude * COSINE( (X * m_DistortGridScale) + (m_Seconds / m_DistortTime) );
-	f32 T1 = m_DistortMagnitude * SINE  ( (Y * m_DistortGridScale) + (m_Seconds / m_DistortTime) );
+	f32 S1 = pTX->Distort;
+	f32 T1 = pTY->Distort;
 	
 	pV->UV1.U	= ((X-(m_SquareX0*m_TerrainBlockSize)) * m_DepthTexelX) * m_TessellationSurface + S1;
 	pV->UV1.V	= ((Y-(m_SquareY0*m_TerrainBlockSize)) * m_DepthTexelY) * m_TessellationSurface + T1;
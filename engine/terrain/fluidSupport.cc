@@ -298,7 +298,10 @@ void fluid::RebuildMasks( void )
 
     if( m_pTerrain )
     {
-        u16 FluidLevel = (u16)((m_SurfaceZ + (m_WaveAmplitude/2.0f)) * 32.0f);
+        // The tallest wave, in terrain height units.  A fluid under the
+        // terrain's range must not wrap round to the top of it.
+        f32 Level      = (m_SurfaceZ + (m_WaveAmplitude/2.0f)) * 32.0f;
+        u16 FluidLevel = (u16)mClampF( Level, 0.0f, 65535.0f );
 
         pG = pGrid;
         for( Y = 0; Y < m_SquaresInY+1; Y++ )
@@ -110,6 +110,10 @@ Sky::Sky()
 
    mLastForce16Bit = false;
    mLastForcePaletted = false;
+
+   dMemset(&mBanKey, 0, sizeof(mBanKey));
+   mBansDirty = true;
+   mBoxDirty = true;
 }
 
 //------------------------------------------------------------------------------
@@ -694,7 +698,7 @@ bool Sky::prepRenderImage(SceneState* state, const U32 stateKey,
    // This should be sufficient for most objects that don't manage zones, and
    //  don't need to return a specialized RenderImage...
    if (state->isObjectRendered(this)) {
-      SceneRenderImage* image = new SceneRenderImage;
+      SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
       image->obj = this;
       image->sortType = SceneRenderImage::Sky;
       state->insertRenderImage(image);
@@ -707,11 +711,8 @@ bool Sky::prepRenderImage(SceneState* state, const U32 stateKey,
 void Sky::render(SceneState *state)
 {
    PROFILE_START(SkyRender);
-   F32 banHeights[2] = {-(mSpherePt.z-1),-(mSpherePt.z-1)};
-   F32 alphaBan[2] = {0.0f, 0.0f};
    F32 depthInFog = 0.0f;
-   Point3F camPos;
-   S32 index=0;
+   Point3F camPos = state->getCameraPosition();
 
    if(gClientSceneGraph)
    {
@@ -726,35 +727,21 @@ void Sky::render(SceneState *state)
       }
    }
    if(mNumFogVolumes)
-   {
-      camPos = state->getCameraPosition();
       depthInFog = -(camPos.z - mFogLine);
-   }
-   // Calculats alpha values and ban heights
-   if(depthInFog > 0.0f)
-      calcAlphas_Heights(camPos.z, banHeights, alphaBan, depthInFog);
-   else // Not in fog so setup default values
-   {
-      alphaBan[0] = 0.0f;
-      alphaBan[1] = 0.0f;
-      banHeights[0] = HORIZON;
-      banHeights[1] = banHeights[0] + OFFSET_HEIGHT;
-   }
 
-   // if lower ban is at top of box then no cliping plan is needed
-   if(banHeights[0] >= mSpherePt.z)
-      banHeights[0] = banHeights[1] = mSpherePt.z;
+   // Ban heights, alphas and points
+   updateBans(camPos.z);
 
    //Renders the 6 sides of the sky box
-   if(alphaBan[1] < 1.0f || mNumFogVolumes == 0)
-      renderSkyBox(banHeights[0], alphaBan[1]);
+   if(mAlphaBan[1] < 1.0f || mNumFogVolumes == 0)
+      renderSkyBox(mBanHeights[0], mAlphaBan[1]);
 
    // if completly fogged out then no need to render
-   if(alphaBan[1] < 1.0f || depthInFog < 0.0f)
+   if(mAlphaBan[1] < 1.0f || depthInFog < 0.0f)
    {
       if(smCloudsOn && mStormCloudsOn && smSkyOn)
       {
-         F32 ang   = mAtan(banHeights[0],mSkyBoxPt.x);
+         F32 ang   = mAtan(mBanHeights[0],mSkyBoxPt.x);
          F32 xyval = mSin(ang);
          F32 zval  = mCos(ang);
          PlaneF planes[4];
@@ -769,18 +756,12 @@ void Sky::render(SceneState *state)
       }
       if(!mNoRenderBans)
       {
-         Point3F banPoints[2][MAX_BAN_POINTS];
-         Point3F cornerPoints[MAX_BAN_POINTS];
-
-         // Calculate upper, lower, and corner ban points
-         calcBans(banHeights, banPoints, cornerPoints);
-
          glDisable(GL_TEXTURE_2D);
          glEnable(GL_BLEND);
          glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
          // Renders the side, top, and corner bans
-         renderBans(alphaBan, banHeights, banPoints, cornerPoints);
+         renderBans(mAlphaBan, mBanHeights, mBanPoints, mCornerPoints);
       }
       glDisable(GL_BLEND);
       glEnable(GL_TEXTURE_2D);
@@ -798,6 +779,57 @@ void Sky::render(SceneState *state)
    PROFILE_END();
 }
 
+//---------------------------------------------------------------------------
+void Sky::updateBans(F32 camZ)
+{
+   // Everything the bans are worked out from.  The camera height only
+   // matters while it's in the fog.
+   BanKey key;
+   dMemset(&key, 0, sizeof(key));
+   key.visibleDistance = mVisibleDistance;
+   key.numFogVolumes = mNumFogVolumes;
+   F32 depthInFog = 0.0f;
+   if(mNumFogVolumes)
+   {
+      depthInFog = -(camZ - mFogLine);
+      if(depthInFog > 0.0f)
+         key.camZ = camZ;
+   }
+   for(U32 i = 0; i < mNumFogVolumes; ++i)
+   {
+      key.fog[i][0] = mFogVolumes[i].visibleDistance;
+      key.fog[i][1] = mFogVolumes[i].minHeight;
+      key.fog[i][2] = mFogVolumes[i].maxHeight;
+      key.fog[i][3] = mFogVolumes[i].percentage;
+   }
+
+   if(!mBansDirty && !dMemcmp(&key, &mBanKey, sizeof(key)))
+      return;
+   mBanKey = key;
+   mBansDirty = false;
+
+   mBanHeights[0] = mBanHeights[1] = -(mSpherePt.z-1);
+   mAlphaBan[0] = mAlphaBan[1] = 0.0f;
+
+   // Calculats alpha values and ban heights
+   if(depthInFog > 0.0f)
+      calcAlphas_Heights(camZ, mBanHeights, mAlphaBan, depthInFog);
+   else // Not in fog so setup default values
+   {
+      mAlphaBan[0] = 0.0f;
+      mAlphaBan[1] = 0.0f;
+      mBanHeights[0] = HORIZON;
+      mBanHeights[1] = mBanHeights[0] + OFFSET_HEIGHT;
+   }
+
+   // if lower ban is at top of box then no cliping plan is needed
+   if(mBanHeights[0] >= mSpherePt.z)
+      mBanHeights[0] = mBanHeights[1] = mSpherePt.z;
+
+   // Calculate upper, lower, and corner ban points
+   calcBans(mBanHeights, mBanPoints, mCornerPoints);
+}
+
 //---------------------------------------------------------------------------
 void Sky::calcAlphas_Heights(F32 zCamPos, F32 *banHeights,
                              F32 *alphaBan, F32 depthInFog)
@@ -898,67 +930,79 @@ void Sky::calcTexCoords(Point2F* texCoords, Point3F* renderPoints, S32 index)
 }
 
 //---------------------------------------------------------------------------
-void Sky::renderSkyBox(F32 lowerBanHeight, F32 alphaBanUpper)
+void Sky::buildSkyBox(F32 lowerBanHeight)
 {
-   S32 side, index=0, val;
-   U32 numPoints;
    Point3F renderPoints[4];
    Point2F texCoords[4];
+   static const S32 texOrder[4] = {0, 1, 3, 2};
+
+   // The sides, clipped to the lower ban
+   for(S32 side = 0; side < 4; ++side)
+   {
+      U32 numPoints = 4;
+      setRenderPoints(renderPoints, side);
+      if(!mNoRenderBans)
+         sgUtil_clipToPlane(renderPoints, numPoints, PlaneF(0.0f, 0.0f, 1.0f, -lowerBanHeight));
+      mBoxSideVisible[side] = numPoints != 0;
+      if(!numPoints)
+         continue;
+
+      calcTexCoords(texCoords, renderPoints, side);
+      for(S32 x = 0; x < 4; ++x)
+      {
+         mBoxVerts[side][x].point = renderPoints[x];
+         mBoxVerts[side][x].texCoord = texCoords[texOrder[x]];
+      }
+   }
+
+   // Top and bottom
+   for(S32 side = 4; side < 6; ++side)
+   {
+      S32 index = (side == 4) ? 3 : 5;
+      S32 val   = (side == 4) ? -1 : 1;
+      for(S32 x = 0; x < 4; ++x)
+      {
+         mBoxVerts[side][x].point = mPoints[index + x * val];
+         mBoxVerts[side][x].texCoord = mTexCoord[texOrder[x]];
+      }
+      mBoxSideVisible[side] = true;
+   }
+
+   mBoxBanHeight = lowerBanHeight;
+   mBoxNoRenderBans = mNoRenderBans;
+   mBoxDirty = false;
+}
+
+//---------------------------------------------------------------------------
+void Sky::renderSkyBox(F32 lowerBanHeight, F32 alphaBanUpper)
+{
+   if(mBoxDirty || mBoxBanHeight != lowerBanHeight || mBoxNoRenderBans != mNoRenderBans)
+      buildSkyBox(lowerBanHeight);
+
    if(!mSkyTexturesOn || !smSkyOn)
    {
       glDisable(GL_TEXTURE_2D);
       glColor3ub(mRealSkyColor.red, mRealSkyColor.green, mRealSkyColor.blue);
    }
-   for(side = 0; side < ((mRenderBoxBottom) ? 6 : 5); ++side)
+
+   glEnableClientState(GL_VERTEX_ARRAY);
+   glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+   glVertexPointer(3, GL_FLOAT, sizeof(BoxVertex), &mBoxVerts[0][0].point);
+   glTexCoordPointer(2, GL_FLOAT, sizeof(BoxVertex), &mBoxVerts[0][0].texCoord);
+
+   for(S32 side = 0; side < ((mRenderBoxBottom) ? 6 : 5); ++side)
    {
-      if((lowerBanHeight != mSpherePt.z  || (side == 4 && alphaBanUpper < 1.0f)) && mSkyHandle[side])
+      if((lowerBanHeight != mSpherePt.z  || (side == 4 && alphaBanUpper < 1.0f)) &&
+         mSkyHandle[side] && mBoxSideVisible[side])
       {
          glBindTexture(GL_TEXTURE_2D,mSkyHandle[side].getGLName());
-         if(side < 4)
-         {
-            numPoints = 4;
-            setRenderPoints(renderPoints, index);
-            if(!mNoRenderBans)
-               sgUtil_clipToPlane(renderPoints, numPoints, PlaneF(0.0f, 0.0f, 1.0f, -lowerBanHeight));
-            if(numPoints)
-            {
-               calcTexCoords(texCoords, renderPoints, index);
-               glBegin(GL_QUADS);
-                  glTexCoord2f(texCoords[0].x, texCoords[0].y);
-                  glVertex3f(renderPoints[0].x, renderPoints[0].y, renderPoints[0].z);
-                  glTexCoord2f(texCoords[1].x, texCoords[1].y);
-                  glVertex3f(renderPoints[1].x, renderPoints[1].y, renderPoints[1].z);
-                  glTexCoord2f(texCoords[3].x, texCoords[3].y);
-                  glVertex3f(renderPoints[2].x, renderPoints[2].y, renderPoints[2].z);
-                  glTexCoord2f(texCoords[2].x, texCoords[2].y);
-                  glVertex3f(renderPoints[3].x, renderPoints[3].y, renderPoints[3].z);
-               glEnd();
-            }
-            ++index;
-         }
-         else
-         {
-            index = 3;
-            val = -1;
-            if(side == 5)
-            {
-               index = 5;
-               val = 1;
-            }
-            glBegin(GL_QUADS);
-               glTexCoord2f(mTexCoord[0].x, mTexCoord[0].y);
-               glVertex3f(mPoints[index].x, mPoints[index].y, mPoints[index].z);
-               glTexCoord2f(mTexCoord[1].x, mTexCoord[1].y);
-               glVertex3f(mPoints[index+(1*val)].x, mPoints[index+(1*val)].y, mPoints[index+(1*val)].z);
-               glTexCoord2f(mTexCoord[3].x, mTexCoord[3].y);
-               glVertex3f(mPoints[index+(2*val)].x, mPoints[index+(2*val)].y, mPoints[index+(2*val)].z);
-               glTexCoord2f(mTexCoord[2].x, mTexCoord[2].y);
-               glVertex3f(mPoints[index+(3*val)].x, mPoints[index+(3*val)].y, mPoints[index+(3*val)].z);
-            glEnd();
-         }
-
+         glDrawArrays(GL_QUADS, side * 4, 4);
       }
    }
+
+   glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+   glDisableClientState(GL_VERTEX_ARRAY);
+
    if(!mSkyTexturesOn)
       glEnable(GL_TEXTURE_2D);
 }
@@ -1233,6 +1277,9 @@ void Sky::calcPoints()
    mSpherePt.set(mSpherePt.x,0.0f,mSpherePt.z);
    mSpherePt.normalize(mSkyBoxPt.x);
    mTopCenterPt.set(0.0f,0.0f,mSkyBoxPt.z);
+
+   mBansDirty = true;
+   mBoxDirty = true;
 }
 
 //---------------------------------------------------------------------------
@@ -1341,6 +1388,8 @@ Cloud::Cloud()
    for(int i = 0; i < 25; ++i)
       stormAlpha[i] = 1.0f;
    mRadius = 1.0f;
+   mNumVerts = mNumIndices = 0;
+   mGeomDirty = true;
 }
 
 //---------------------------------------------------------------------------
@@ -1415,6 +1464,7 @@ void Cloud::setPoints()
    mPoints[24] =  mPoints[18] + (vec * 2.0f);
 
    calcAlpha();
+   mGeomDirty = true;
 }
 
 //---------------------------------------------------------------------------
@@ -1435,11 +1485,6 @@ void Cloud::render(U32 currentTime, U32 cloudLayer, bool outlineOn, S32 numLayer
 {
    mGStormData.numCloudLayers = numLayers;
    mOffset = 1.0f;
-   U32 numPoints;
-   Point3F renderPoints[128];
-   Point2F renderTexPoints[128];
-   F32 renderAlpha[128];
-   F32 renderSAlpha[128];
    if(mLastTime != 0)
       mOffset = (currentTime - mLastTime)/32.0f;
 
@@ -1448,18 +1493,17 @@ void Cloud::render(U32 currentTime, U32 cloudLayer, bool outlineOn, S32 numLayer
    if(!mCloudHandle || (mGStormData.StormOn && mGStormData.currentCloud < cloudLayer))
       return;
 
-   S32 start=0, i, j, k;
-
    updateCoord();
 
-   for(S32 x = 0; x < 5; x++)
-      for(S32 y = 0; y < 5; y++)
-         mTexCoords[y * 5 + x].set ( x * mTextureScale.x + mBaseOffset.x,
-                                     y * mTextureScale.y - mBaseOffset.y);
-
    if(mGStormData.StormOn && mGStormData.currentCloud == cloudLayer)
       updateStorm();
 
+   // All four planes come from the same angle
+   if(mGeomDirty || planes[0].x != mGeomPlane.x || planes[0].z != mGeomPlane.z)
+      buildGeometry(planes);
+   if(!mNumVerts)
+      return;
+
    if(!outlineOn)
    {
       glBindTexture(GL_TEXTURE_2D, mCloudHandle.getGLName());
@@ -1467,34 +1511,86 @@ void Cloud::render(U32 currentTime, U32 cloudLayer, bool outlineOn, S32 numLayer
       glEnable(GL_BLEND);
       glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
    }
-   for(i = 0; i < 4; ++i)
+
+   // Scroll the layer
+   glMatrixMode(GL_TEXTURE);
+   glPushMatrix();
+   glTranslatef(mBaseOffset.x, -mBaseOffset.y, 0.0f);
+
+   glEnableClientState(GL_VERTEX_ARRAY);
+   glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+   glEnableClientState(GL_COLOR_ARRAY);
+   glVertexPointer(3, GL_FLOAT, sizeof(Vertex), &mVerts[0].point);
+   glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &mVerts[0].texCoord);
+   glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), &mVerts[0].color);
+
+   if(!outlineOn)
+      glDrawElements(GL_TRIANGLES, mNumIndices, GL_UNSIGNED_SHORT, mIndices);
+   else
+      for(S32 i = 0; i < MaxFans; ++i)
+         if(mFanCount[i])
+            glDrawArrays(GL_LINE_LOOP, mFanStart[i], mFanCount[i]);
+
+   glDisableClientState(GL_COLOR_ARRAY);
+   glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+   glDisableClientState(GL_VERTEX_ARRAY);
+
+   glPopMatrix();
+   glMatrixMode(GL_MODELVIEW);
+
+   glDisable(GL_BLEND);
+}
+
+//---------------------------------------------------------------------------
+void Cloud::buildGeometry(PlaneF* planes)
+{
+   U32 numPoints;
+   Point3F renderPoints[128];
+   Point2F renderTexPoints[128];
+   F32 renderAlpha[128];
+   F32 renderSAlpha[128];
+
+   // Without the scroll offset, that goes in the texture matrix
+   for(S32 x = 0; x < 5; x++)
+      for(S32 y = 0; y < 5; y++)
+         mTexCoords[y * 5 + x].set(x * mTextureScale.x, y * mTextureScale.y);
+
+   mNumVerts = mNumIndices = 0;
+   for(S32 i = 0; i < 4; ++i)
    {
-      start = i * 5;
-      for(j = 0; j < 4; ++j )
+      S32 start = i * 5;
+      for(S32 j = 0; j < 4; ++j, ++start)
       {
          numPoints = 4;
          setRenderPoints(renderPoints, renderTexPoints, renderAlpha, renderSAlpha, start);
-         for(S32 i = 0; i < 4; ++i)
+         for(S32 p = 0; p < 4; ++p)
             clipToPlane(renderPoints, renderTexPoints, renderAlpha, renderSAlpha,
-                        numPoints, planes[i]);
+                        numPoints, planes[p]);
+         AssertFatal(numPoints <= MaxFanPoints, "Cloud::buildGeometry: too many clipped points");
 
-         if(!outlineOn)
-            glBegin(GL_TRIANGLE_FAN);
-         else
-            glBegin(GL_LINE_LOOP);
+         U32 fan = i * 4 + j;
+         mFanStart[fan] = mNumVerts;
+         mFanCount[fan] = numPoints;
 
-         for(k = 0; k < numPoints; ++k)
+         for(U32 k = 0; k < numPoints; ++k)
          {
-            glColor4f(1.0,1.0,1.0, renderAlpha[k]*renderSAlpha[k]);
-            glTexCoord2f(renderTexPoints[k].x,renderTexPoints[k].y);
-            glVertex3f(renderPoints[k].x,renderPoints[k].y,renderPoints[k].z);
+            Vertex& vert = mVerts[mNumVerts + k];
+            vert.point = renderPoints[k];
+            vert.texCoord = renderTexPoints[k];
+            vert.color.set(255, 255, 255, U8(mClampF(renderAlpha[k] * renderSAlpha[k], 0.0f, 1.0f) * 255.0f + 0.5f));
          }
-         glEnd();
-
-         ++start;
+         for(U32 k = 2; k < numPoints; ++k)
+         {
+            mIndices[mNumIndices++] = mNumVerts;
+            mIndices[mNumIndices++] = mNumVerts + k - 1;
+            mIndices[mNumIndices++] = mNumVerts + k;
+         }
+         mNumVerts += numPoints;
       }
    }
-   glDisable(GL_BLEND);
+
+   mGeomPlane = planes[0];
+   mGeomDirty = false;
 }
 
 void Cloud::setRenderPoints(Point3F* renderPoints, Point2F* renderTexPoints,
@@ -1515,6 +1611,7 @@ void Cloud::setRenderPoints(Point3F* renderPoints, Point2F* renderTexPoints,
 void Cloud::setTextPer(F32 cloudTextPer)
 {
    mTextureScale.set(cloudTextPer / 4.0, cloudTextPer / 4.0);
+   mGeomDirty = true;
 }
 
 //---------------------------------------------------------------------------
@@ -1556,6 +1653,7 @@ void Cloud::updateStorm()
 //---------------------------------------------------------------------------
 void Cloud::calcStormAlpha()
 {
+   mGeomDirty = true;
    if(mGStormData.FadeIn)
    {
       bool done = true;
@@ -106,6 +106,35 @@ class Cloud
    F32 mAlphaSave[25];
 
    static StormInfo mGStormData;
+
+   /// @name Cached Geometry
+   ///
+   /// The layer clipped to the fog ban planes, as triangles.  It's only
+   /// rebuilt when the points, the storm alpha or the planes change; the
+   /// texture scrolls through the texture matrix.
+   /// @{
+   struct Vertex
+   {
+      Point3F point;
+      Point2F texCoord;
+      ColorI  color;
+   };
+   enum {
+      MaxFans      = 16,
+      MaxFanPoints = 8,    ///< A quad clipped by four planes.
+      MaxVerts     = MaxFans * MaxFanPoints,
+      MaxIndices   = MaxFans * (MaxFanPoints - 2) * 3
+   };
+   Vertex mVerts[MaxVerts];
+   U16 mIndices[MaxIndices];
+   U32 mFanStart[MaxFans];
+   U32 mFanCount[MaxFans];
+   U32 mNumVerts, mNumIndices;
+   bool mGeomDirty;
+   PlaneF mGeomPlane;      ///< planes[0] the geometry was clipped to.
+
+   void buildGeometry(PlaneF* planes);
+   /// @}
   public:
    Cloud();
    ~Cloud();
@@ -188,6 +217,42 @@ class Sky : public SceneObject
     bool mStormFogOn;
     bool mSetFog;
 
+    /// @name Cached Bans and Box
+    ///
+    /// The fog ban heights and points only depend on the camera height
+    /// while it's in fog, and on the fog volumes, so they are kept until
+    /// one of those changes.  Likewise the sky box sides clipped to the
+    /// lower ban.
+    /// @{
+    struct BanKey
+    {
+       F32 camZ;
+       F32 visibleDistance;
+       U32 numFogVolumes;
+       F32 fog[MaxFogVolumes][4];
+    };
+    struct BoxVertex
+    {
+       Point3F point;
+       Point2F texCoord;
+    };
+    BanKey mBanKey;
+    bool mBansDirty;
+    F32 mBanHeights[2];
+    F32 mAlphaBan[2];
+    Point3F mBanPoints[2][MAX_BAN_POINTS];
+    Point3F mCornerPoints[MAX_BAN_POINTS];
+
+    BoxVertex mBoxVerts[6][4];
+    bool mBoxSideVisible[6];
+    bool mBoxDirty;
+    bool mBoxNoRenderBans;
+    F32 mBoxBanHeight;
+
+    void updateBans(F32 camZ);
+    void buildSkyBox(F32 lowerBanHeight);
+    /// @}
+
     void calcPoints();
   protected:
     bool onAdd();
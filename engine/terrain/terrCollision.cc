@@ -345,6 +345,93 @@ void TerrainConvex::getPolyList(AbstractPolyList* list)
 
 //----------------------------------------------------------------------------
 
+void TerrainBlock::flushCollisionCache()
+{
+   for (U32 i = 0; i < CollisionCacheSets * CollisionCacheWays; i++)
+      mCollisionCache[i].key = CollisionCacheEmpty;
+   mCollisionCacheTime = 0;
+}
+
+void TerrainBlock::flushCollisionCache(Point2I min, Point2I max)
+{
+   // Just the squares with a corner in the rect, wrapped like the keys
+   U32 width  = max.x - min.x + 1;
+   U32 height = max.y - min.y + 1;
+   for (U32 i = 0; i < CollisionCacheSets * CollisionCacheWays; i++)
+   {
+      CollisionSquare &cs = mCollisionCache[i];
+      if (cs.key == CollisionCacheEmpty)
+         continue;
+
+      U32 dx = ((cs.key >> 16) - (min.x - 1)) & BlockMask;
+      U32 dy = ((cs.key & 0xFFFF) - (min.y - 1)) & BlockMask;
+      if (dx <= width && dy <= height)
+         cs.key = CollisionCacheEmpty;
+   }
+}
+
+const TerrainBlock::CollisionSquare &TerrainBlock::getCollisionSquare(S32 xi, S32 yi, const GridSquare *gs)
+{
+   const U32 key = (xi << 16) | yi;
+   CollisionSquare *set = &mCollisionCache[((xi * 31 + yi) & (CollisionCacheSets - 1)) * CollisionCacheWays];
+
+   // Wrapping the clock would confuse the ages, start over instead
+   if (++mCollisionCacheTime == 0)
+      flushCollisionCache();
+
+   CollisionSquare *cs = set;
+   for (U32 i = 0; i < CollisionCacheWays; i++)
+   {
+      if (set[i].key == key)
+      {
+         set[i].lastUsed = mCollisionCacheTime;
+         return set[i];
+      }
+      if (set[i].key == CollisionCacheEmpty)
+      {
+         cs = &set[i];
+         break;
+      }
+      if (set[i].lastUsed < cs->lastUsed)
+         cs = &set[i];
+   }
+
+   cs->key = key;
+   cs->lastUsed = mCollisionCacheTime;
+
+   // Normals from the points at the square's own position, the
+   // differences are the same for every tile
+   Point3F vp[4];
+   for (int i = 0; i < 4 ; i++)
+   {
+      S32 dx = i >> 1;
+      S32 dy = dx ^ (i & 1);
+      vp[i].x = (xi + dx) * squareSize;
+      vp[i].y = (yi + dy) * squareSize;
+      vp[i].z = cs->height[i] = fixedToFloat(getHeight(xi + dx, yi + dy));
+   }
+
+   if ((cs->split45 = (gs->flags & GridSquare::Split45) != 0) == true)
+   {
+      mCross(vp[0] - vp[1],vp[2] - vp[1],&cs->normal[0]);
+      cs->normal[0].normalize();
+
+      mCross(vp[2] - vp[3],vp[0] - vp[3],&cs->normal[1]);
+      cs->normal[1].normalize();
+      cs->concave = mDot(vp[3] - vp[1],cs->normal[0]) > 0;
+   }
+   else
+   {
+      mCross(vp[3] - vp[0],vp[1] - vp[0],&cs->normal[0]);
+      cs->normal[0].normalize();
+
+      mCross(vp[1] - vp[2],vp[3] - vp[2],&cs->normal[1]);
+      cs->normal[1].normalize();
+      cs->concave = mDot(vp[2] - vp[0],cs->normal[0]) > 0;
+   }
+   return *cs;
+}
+
 void TerrainBlock::buildConvex(const Box3F& box,Convex* convex)
 {
    sTerrainConvexList.collectGarbage();
@@ -436,7 +523,8 @@ void TerrainBlock::buildConvex(const Box3F& box,Convex* convex)
 
          mObjToWorld.mul(cp->box);
 
-         // Build points
+         // Build points, the heights and normals come from the cache
+         const CollisionSquare &cs = getCollisionSquare(xi, yi, gs);
          Point3F* pos = cp->point;
          for (int i = 0; i < 4 ; i++,pos++)
          {
@@ -444,51 +532,21 @@ void TerrainBlock::buildConvex(const Box3F& box,Convex* convex)
             S32 dy = dx ^ (i & 1);
             pos->x = (x + dx) * squareSize;
             pos->y = (y + dy) * squareSize;
-            pos->z = fixedToFloat(getHeight(xi + dx, yi + dy));
+            pos->z = cs.height[i];
          }
+         cp->normal[0] = cs.normal[0];
+         cp->normal[1] = cs.normal[1];
 
-         // Build normals, then split into two Convex objects if the
-         // square is concave
-         if ((cp->split45 = gs->flags & GridSquare::Split45) == true)
-         {
-            VectorF *vp = cp->point;
-
-            mCross(vp[0] - vp[1],vp[2] - vp[1],&cp->normal[0]);
-            cp->normal[0].normalize();
-
-            mCross(vp[2] - vp[3],vp[0] - vp[3],&cp->normal[1]);
-            cp->normal[1].normalize();
-            if (mDot(vp[3] - vp[1],cp->normal[0]) > 0)
-            {
-               TerrainConvex* nc = new TerrainConvex(*cp);
-               sTerrainConvexList.registerObject(nc);
-               convex->addToWorkingList(nc);
-               nc->halfA = false;
-               nc->square = cp;
-               cp->square = nc;
-            }
-         }
-         else
+         // Split into two Convex objects if the square is concave
+         cp->split45 = cs.split45;
+         if (cs.concave)
          {
-            VectorF *vp = cp->point;
-
-            mCross(vp[3] - vp[0],vp[1] - vp[0],&cp->normal[0]);
-            cp->normal[0].normalize();
-
-            mCross(vp[1] - vp[2],vp[3] - vp[2],&cp->normal[1]);
-            cp->normal[1].normalize();
-
-            if (mDot(vp[2] - vp[0],cp->normal[0]) > 0)
-            {
-               TerrainConvex* nc = new TerrainConvex(*cp);
-
-               sTerrainConvexList.registerObject(nc);
-               convex->addToWorkingList(nc);
-
-               nc->halfA = false;
-               nc->square = cp;
-               cp->square = nc;
-            }
+            TerrainConvex* nc = new TerrainConvex(*cp);
+            sTerrainConvexList.registerObject(nc);
+            convex->addToWorkingList(nc);
+            nc->halfA = false;
+            nc->square = cp;
+            cp->square = nc;
          }
       }
    }
@@ -11,8 +11,10 @@
 #include "dgl/materialPropertyMap.h"
 #include "math/mMath.h"			
 #include "math/mathIO.h"
+#include "math/mathTypes.h"
 #include "core/fileStream.h"
 #include "core/bitStream.h"
+#include "platform/profiler.h"
 #include "console/consoleTypes.h"
 #include "sceneGraph/sceneGraph.h"
 #include "sceneGraph/sceneState.h"
@@ -69,8 +71,13 @@ TerrainBlock::TerrainBlock()
 
    mCRC = 0;
    flagMap = 0;
+   flushCollisionCache();
 	mVertexBuffer = -1;
+   for(U32 i = 0; i < ChunkPageCount; i++)
+      mChunkBuffers[i] = 0;
    mTile = true;
+   mPaged = false;
+   mPagePos.set(0, 0);
    
    mTypeMask |= ShadowCasterObjectType;
 }
@@ -85,6 +92,14 @@ TerrainBlock::~TerrainBlock()
 }
 
 
+//--------------------------------------
+Point3F TerrainBlock::getPageOrigin(S32 squareSize, const Point2I &pagePos)
+{
+   F32 pageSize = F32(squareSize * PageSquares);
+   F32 corner = -F32(squareSize * (BlockSize >> 1));
+   return Point3F(corner + pagePos.x * pageSize, corner + pagePos.y * pageSize, 0);
+}
+
 //--------------------------------------
 void TerrainBlock::setFile(Resource<TerrainFile> terr)
 {
@@ -98,6 +113,11 @@ void TerrainBlock::setFile(Resource<TerrainFile> terr)
    materialMap = mFile->mMaterialMap;
    heightMap   = mFile->mHeightMap;
    flagMap = mFile->mFlagMap;
+   freeChunkBuffers();
+   flushCollisionCache();
+
+   if(!mFile->mNormalCache)
+      mFile->buildNormalCache(squareSize);
 }
 
 
@@ -155,6 +175,16 @@ bool TerrainBlock::unpackEmptySquares()
       }
    }
 
+   // the edge squares of a page are covered by its neighbors
+   if(mPaged)
+   {
+      for(i = 0; i < BlockSquareWidth; i++)
+      {
+         materialMap[BlockMask + (i << BlockShift)].flags |= Material::Empty;
+         materialMap[i + (BlockMask << BlockShift)].flags |= Material::Empty;
+      }
+   }
+
    rebuildEmptyFlags();
    return(true);
 }
@@ -292,38 +322,41 @@ inline void checkSquareMinMax(GridSquare *parent, GridSquare *child)
 void TerrainBlock::updateGridMaterials(Point2I min, Point2I max)
 {
    // ok:
-   // build the chunk materials flags for all the chunks in the bounding rect
-   // ((min - 1) >> ChunkDownShift) up to ((max + ChunkWidth) >> ChunkDownShift)
+   // rebuild the material flags of every square with a corner in the
+   // rect, (min - 1) up to max, then those of their level 1 parents.
+   // nothing else is touched.
 
-   // we have to make sure to cover boundary conditions as as stated above
-   // since, for example, x = 0 affects 2 chunks
+   // we have to make sure to wrap the coordinates, since, for example,
+   // x = 0 is also a corner of the square at x = BlockMask
 
-   for (S32 y = min.y - 1; y < max.y + 1; y++)
+   for (S32 y = min.y - 1; y <= max.y; y++)
    {
-      for (S32 x=min.x - 1; x < max.x + 1; x++)
+      for (S32 x = min.x - 1; x <= max.x; x++)
       {
-         GridSquare *sq = findSquare(0, Point2I(x, y));
+         S32 sx = x & TerrainBlock::BlockMask;
+         S32 sy = y & TerrainBlock::BlockMask;
+         GridSquare *sq = findSquare(0, sx, sy);
          sq->flags &= (GridSquare::MaterialStart -1);
-         S32 xpl = (x + 1) & TerrainBlock::BlockMask;
-         S32 ypl = (y + 1) & TerrainBlock::BlockMask;
+         S32 xpl = (sx + 1) & TerrainBlock::BlockMask;
+         S32 ypl = (sy + 1) & TerrainBlock::BlockMask;
 
          U32 numContribs = 0;
 
          for(U32 i = 0; i < TerrainBlock::MaterialGroups; i++)
          {
-            if (mFile->mMaterialAlphaMap[i] == NULL) 
+            if (mFile->mMaterialAlphaMap[i] == NULL)
                continue;
 
-               U32 mapVal = (mFile->mMaterialAlphaMap[i][(y << TerrainBlock::BlockShift) + x]     |
-                             mFile->mMaterialAlphaMap[i][(ypl << TerrainBlock::BlockShift) + x]   |
-                             mFile->mMaterialAlphaMap[i][(ypl << TerrainBlock::BlockShift) + xpl] |
-                             mFile->mMaterialAlphaMap[i][(y << TerrainBlock::BlockShift) + xpl]);
+            U32 mapVal = (mFile->mMaterialAlphaMap[i][(sy << TerrainBlock::BlockShift) + sx]   |
+                          mFile->mMaterialAlphaMap[i][(ypl << TerrainBlock::BlockShift) + sx]  |
+                          mFile->mMaterialAlphaMap[i][(ypl << TerrainBlock::BlockShift) + xpl] |
+                          mFile->mMaterialAlphaMap[i][(sy << TerrainBlock::BlockShift) + xpl]);
             if(!mapVal)
                continue;
 
-                  sq->flags |= (GridSquare::MaterialStart << i);
+            sq->flags |= (GridSquare::MaterialStart << i);
             numContribs++;
-            }
+         }
 
          // We apply a constraint based on number of set materials, each square
          // should have no more than 4 materials set due to limitations in the
@@ -334,14 +367,14 @@ void TerrainBlock::updateGridMaterials(Point2I min, Point2I max)
             S32 smallestContributor = -1, smallestContribAmt = S32_MAX;
             for(S32 i=0; i < TerrainBlock::MaterialGroups; i++)
             {
-               if (mFile->mMaterialAlphaMap[i] == NULL) 
+               if (mFile->mMaterialAlphaMap[i] == NULL)
                   continue;
 
                // What's the sum of contribution to this square?
-               U32 mapVal = (mFile->mMaterialAlphaMap[i][(y << TerrainBlock::BlockShift) + x] +
-                  mFile->mMaterialAlphaMap[i][(ypl << TerrainBlock::BlockShift) + x]   +
+               U32 mapVal = (mFile->mMaterialAlphaMap[i][(sy << TerrainBlock::BlockShift) + sx] +
+                  mFile->mMaterialAlphaMap[i][(ypl << TerrainBlock::BlockShift) + sx]  +
                   mFile->mMaterialAlphaMap[i][(ypl << TerrainBlock::BlockShift) + xpl] +
-                  mFile->mMaterialAlphaMap[i][(y << TerrainBlock::BlockShift) + xpl]);
+                  mFile->mMaterialAlphaMap[i][(sy << TerrainBlock::BlockShift) + xpl]);
 
                // Zero doesn't count.
                if(mapVal==0)
@@ -351,35 +384,42 @@ void TerrainBlock::updateGridMaterials(Point2I min, Point2I max)
                {
                   smallestContributor = i;
                   smallestContribAmt = mapVal;
+               }
             }
-         }
 
             // Skip out if we have nothing contributing (!?)...
             if(smallestContributor == -1)
                break;
 
             // Nuke it...
-            mFile->mMaterialAlphaMap[smallestContributor][(y << TerrainBlock::BlockShift) + x] = 0;
-            mFile->mMaterialAlphaMap[smallestContributor][(ypl << TerrainBlock::BlockShift) + x] = 0;
+            mFile->mMaterialAlphaMap[smallestContributor][(sy << TerrainBlock::BlockShift) + sx] = 0;
+            mFile->mMaterialAlphaMap[smallestContributor][(ypl << TerrainBlock::BlockShift) + sx] = 0;
             mFile->mMaterialAlphaMap[smallestContributor][(ypl << TerrainBlock::BlockShift) + xpl] = 0;
-            mFile->mMaterialAlphaMap[smallestContributor][(y << TerrainBlock::BlockShift) + xpl] = 0;
+            mFile->mMaterialAlphaMap[smallestContributor][(sy << TerrainBlock::BlockShift) + xpl] = 0;
             sq->flags &= ~(GridSquare::MaterialStart << smallestContributor);
 
             // And try again if necessary...
             numContribs--;
-   }
+         }
       }
    }
-   for (S32 y = min.y - 2; y < max.y + 2; y += 2)
+
+   // the level 1 squares take the materials of their children, replacing
+   // what they had, and are mirrored in the flag map
+   for (S32 y = (min.y - 1) >> 1; y <= max.y >> 1; y++)
    {
-      for (S32 x= min.x - 2; x < max.x + 2; x += 2)
+      for (S32 x = (min.x - 1) >> 1; x <= max.x >> 1; x++)
       {
-         GridSquare *sq = findSquare(1, Point2I(x, y));
-         GridSquare *s1 = findSquare(0, Point2I(x, y));
-         GridSquare *s2 = findSquare(0, Point2I(x+1, y));
-         GridSquare *s3 = findSquare(0, Point2I(x, y+1));
-         GridSquare *s4 = findSquare(0, Point2I(x+1, y+1));
-         sq->flags |= (s1->flags | s2->flags | s3->flags | s4->flags) & ~(GridSquare::MaterialStart -1);
+         S32 px = (x << 1) & TerrainBlock::BlockMask;
+         S32 py = (y << 1) & TerrainBlock::BlockMask;
+         GridSquare *sq = findSquare(1, px, py);
+         GridSquare *s1 = findSquare(0, px, py);
+         GridSquare *s2 = findSquare(0, px+1, py);
+         GridSquare *s3 = findSquare(0, px, py+1);
+         GridSquare *s4 = findSquare(0, px+1, py+1);
+         sq->flags = (sq->flags & (GridSquare::MaterialStart -1)) |
+                     ((s1->flags | s2->flags | s3->flags | s4->flags) & ~(GridSquare::MaterialStart -1));
+         flagMap[(px >> 1) + (py >> 1) * TerrainBlock::FlagMapWidth] = sq->flags;
       }
    }
    TerrainRender::flushCacheRect(RectI(min, max - min));
@@ -395,20 +435,18 @@ void TerrainBlock::updateGrid(Point2I min, Point2I max)
    // we have to make sure to cover boundary conditions as as stated above
    // since, for example, x = 0 affects 2 chunks
 
+   const S32 chunkMask = (BlockSize >> ChunkDownShift) - 1;
    for(S32 x = (min.x - 1) >> ChunkDownShift;x < (max.x + ChunkSize) >> ChunkDownShift; x++)
    {
       for(S32 y = (min.y - 1) >> ChunkDownShift;y < (max.y + ChunkSize) >> ChunkDownShift; y++)
       {
-         S32 px = x;
-         S32 py = y;
-         if(px < 0)
-            px += BlockSize >> ChunkDownShift;
-         if(py < 0)
-            py += BlockSize >> ChunkDownShift;
-
-         buildChunkDeviance(px, py);
+         buildChunkDeviance(x & chunkMask, y & chunkMask);
       }
    }
+   flushGridRect(min, max);
+
+   if(mFile->mNormalCache)
+      mFile->updateNormalCache(min, max);
 
    // ok the chunk deviances are rebuilt... now rebuild the affected area
    // of the grid map:
@@ -426,14 +464,7 @@ void TerrainBlock::updateGrid(Point2I min, Point2I max)
    {
       for(S32 x = min.x - 1; x < max.x + 1; x++)
       {
-         S32 px = x;
-         S32 py = y;
-         if(px < 0)
-            px += BlockSize;
-         if(py < 0)
-            py += BlockSize;
-
-         GridSquare *sq = findSquare(0, px, py);
+         GridSquare *sq = findSquare(0, x, y);
 
          sq->minHeight = 0xFFFF;
          sq->maxHeight = 0;
@@ -472,148 +503,172 @@ void TerrainBlock::updateGrid(Point2I min, Point2I max)
    }
 }
 
-
-//--------------------------------------
-bool TerrainBlock::getHeight(const Point2F &pos, F32 *height)
+void TerrainBlock::flushGridRect(Point2I min, Point2I max)
 {
-   float invSquareSize = 1.0f / (float)squareSize;
-   float xp = pos.x * invSquareSize;
-   float yp = pos.y * invSquareSize;
-   int x = (S32)mFloor(xp);
-   int y = (S32)mFloor(yp);
-   xp -= (float)x;
-   yp -= (float)y;
-   x &= BlockMask;
-   y &= BlockMask;
-   GridSquare * gs = findSquare(0, Point2I(x,y));
-
-   if (gs->flags & GridSquare::Empty)
-      return false;
+   freeChunkBuffers(min, max);
+   flushCollisionCache(min, max);
+}
 
-   float zBottomLeft = fixedToFloat(getHeight(x, y));
-   float zBottomRight = fixedToFloat(getHeight(x + 1, y));
-   float zTopLeft = fixedToFloat(getHeight(x, y + 1));
-   float zTopRight = fixedToFloat(getHeight(x + 1, y + 1));
 
-   if(gs->flags & GridSquare::Split45)
+//--------------------------------------
+struct TerrainBlock::HeightQuery
+{
+   S32  x, y;          ///< Square, wrapped into the block.
+   F32  xp, yp;        ///< Position inside the square, 0 to 1.
+   bool split45;
+   bool top;           ///< Point is in the top triangle rather than the bottom.
+   F32  zBottomLeft, zBottomRight, zTopLeft, zTopRight;
+};
+
+/// Unnormalized normal of one triangle of a square.
+static inline void getTriangleNormal(bool split45, bool top, F32 zBottomLeft, F32 zBottomRight,
+                                     F32 zTopLeft, F32 zTopRight, F32 squareSize, Point3F *normal)
+{
+   if(split45)
    {
-      if (xp>yp)
-         // bottom half
-         *height = zBottomLeft + xp * (zBottomRight-zBottomLeft) + yp * (zTopRight-zBottomRight);
+      if(!top)
+         normal->set(zBottomLeft-zBottomRight,zBottomRight-zTopRight,squareSize);
       else
-         // top half
-         *height = zBottomLeft + xp * (zTopRight-zTopLeft) + yp * (zTopLeft-zBottomLeft);
+         normal->set(zTopLeft-zTopRight,zBottomLeft-zTopLeft,squareSize);
    }
    else
    {
-      if (1.0f-xp>yp)
-         // bottom half
-         *height = zBottomRight + (1.0f-xp) * (zBottomLeft-zBottomRight) + yp * (zTopLeft-zBottomLeft);
+      if(!top)
+         normal->set(zBottomLeft-zBottomRight,zBottomLeft-zTopLeft,squareSize);
       else
-         // top half
-         *height = zBottomRight + (1.0f-xp) * (zTopLeft-zTopRight) + yp * (zTopRight-zBottomRight);
+         normal->set(zTopLeft-zTopRight,zBottomRight-zTopRight,squareSize);
    }
-   return true;
 }
 
-bool TerrainBlock::getNormal(const Point2F & pos, Point3F * normal, bool normalize)
+inline bool TerrainBlock::findQueryTriangle(const Point2F &pos, F32 invSquareSize, HeightQuery &q)
 {
-   float invSquareSize = 1.0f / (float)squareSize;
-   float xp = pos.x * invSquareSize;
-   float yp = pos.y * invSquareSize;
-   int x = (S32)mFloor(xp);
-   int y = (S32)mFloor(yp);
-   xp -= (float)x;
-   yp -= (float)y;
-   x &= BlockMask;
-   y &= BlockMask;
-   GridSquare * gs = findSquare(0, Point2I(x,y));
+   F32 xp = pos.x * invSquareSize;
+   F32 yp = pos.y * invSquareSize;
+   S32 x = (S32)mFloor(xp);
+   S32 y = (S32)mFloor(yp);
+   q.xp = xp - (F32)x;
+   q.yp = yp - (F32)y;
+   q.x = x & BlockMask;
+   q.y = y & BlockMask;
+   GridSquare * gs = findSquare(0, Point2I(q.x,q.y));
 
    if (gs->flags & GridSquare::Empty)
       return false;
 
-   float zBottomLeft = fixedToFloat(getHeight(x, y));
-   float zBottomRight = fixedToFloat(getHeight(x + 1, y));
-   float zTopLeft = fixedToFloat(getHeight(x, y + 1));
-   float zTopRight = fixedToFloat(getHeight(x + 1, y + 1));
+   q.split45 = (gs->flags & GridSquare::Split45) != 0;
+   q.top = q.split45 ? !(q.xp > q.yp) : !(1.0f - q.xp > q.yp);
 
-   if(gs->flags & GridSquare::Split45)
+   q.zBottomLeft = fixedToFloat(getHeight(q.x, q.y));
+   q.zBottomRight = fixedToFloat(getHeight(q.x + 1, q.y));
+   q.zTopLeft = fixedToFloat(getHeight(q.x, q.y + 1));
+   q.zTopRight = fixedToFloat(getHeight(q.x + 1, q.y + 1));
+   return true;
+}
+
+inline F32 TerrainBlock::getQueryHeight(const HeightQuery &q)
+{
+   if(q.split45)
    {
-      if (xp>yp)
-         // bottom half
-         normal->set(zBottomLeft-zBottomRight,zBottomRight-zTopRight,squareSize);
+      if (!q.top)
+         return q.zBottomLeft + q.xp * (q.zBottomRight-q.zBottomLeft) + q.yp * (q.zTopRight-q.zBottomRight);
       else
-         // top half
-         normal->set(zTopLeft-zTopRight,zBottomLeft-zTopLeft,squareSize);
+         return q.zBottomLeft + q.xp * (q.zTopRight-q.zTopLeft) + q.yp * (q.zTopLeft-q.zBottomLeft);
    }
    else
    {
-      if (1.0f-xp>yp)
-         // bottom half
-         normal->set(zBottomLeft-zBottomRight,zBottomLeft-zTopLeft,squareSize);
+      if (!q.top)
+         return q.zBottomRight + (1.0f-q.xp) * (q.zBottomLeft-q.zBottomRight) + q.yp * (q.zTopLeft-q.zBottomLeft);
       else
-         // top half
-         normal->set(zTopLeft-zTopRight,zBottomRight-zTopRight,squareSize);
+         return q.zBottomRight + (1.0f-q.xp) * (q.zTopLeft-q.zTopRight) + q.yp * (q.zTopRight-q.zBottomRight);
+   }
+}
+
+inline void TerrainBlock::getQueryNormal(const HeightQuery &q, Point3F *normal, bool normalize)
+{
+   if(normalize && mFile->mNormalCache && mFile->mNormalCacheSquareSize == squareSize)
+   {
+      const S16 *n = mFile->mNormalCache + ((q.x + (q.y << BlockShift)) * 2 + q.top) * 3;
+      const F32 scale = 1.0f / 32767.0f;
+      normal->set(n[0] * scale, n[1] * scale, n[2] * scale);
+      return;
    }
+
+   getTriangleNormal(q.split45, q.top, q.zBottomLeft, q.zBottomRight, q.zTopLeft, q.zTopRight,
+                     (F32)squareSize, normal);
    if (normalize)
       normal->normalize();
+}
+
+bool TerrainBlock::getHeight(const Point2F &pos, F32 *height)
+{
+   HeightQuery q;
+   if(!findQueryTriangle(pos, 1.0f / (F32)squareSize, q))
+      return false;
+
+   *height = getQueryHeight(q);
    return true;
 }
 
-bool TerrainBlock::getNormalAndHeight(const Point2F & pos, Point3F * normal, F32 * height, bool normalize)
+bool TerrainBlock::getNormal(const Point2F & pos, Point3F * normal, bool normalize)
 {
-   float invSquareSize = 1.0f / (float)squareSize;
-   float xp = pos.x * invSquareSize;
-   float yp = pos.y * invSquareSize;
-   int x = (S32)mFloor(xp);
-   int y = (S32)mFloor(yp);
-   xp -= (float)x;
-   yp -= (float)y;
-   x &= BlockMask;
-   y &= BlockMask;
-   GridSquare * gs = findSquare(0, Point2I(x,y));
+   HeightQuery q;
+   if(!findQueryTriangle(pos, 1.0f / (F32)squareSize, q))
+      return false;
 
-   if (gs->flags & GridSquare::Empty)
+   getQueryNormal(q, normal, normalize);
+   return true;
+}
+
+bool TerrainBlock::getNormalAndHeight(const Point2F & pos, Point3F * normal, F32 * height, bool normalize)
+{
+   HeightQuery q;
+   if(!findQueryTriangle(pos, 1.0f / (F32)squareSize, q))
       return false;
 
-   float zBottomLeft = fixedToFloat(getHeight(x, y));
-   float zBottomRight = fixedToFloat(getHeight(x + 1, y));
-   float zTopLeft = fixedToFloat(getHeight(x, y + 1));
-   float zTopRight = fixedToFloat(getHeight(x + 1, y + 1));
+   getQueryNormal(q, normal, normalize);
+   *height = getQueryHeight(q);
+   return true;
+}
+
+U32 TerrainBlock::getHeights(const Point2F *pos, U32 count, F32 *heights, bool *valid)
+{
+   F32 invSquareSize = 1.0f / (F32)squareSize;
+   U32 found = 0;
+   HeightQuery q;
 
-   if(gs->flags & GridSquare::Split45)
+   for(U32 i = 0; i < count; i++)
    {
-      if (xp>yp)
+      bool hit = findQueryTriangle(pos[i], invSquareSize, q);
+      if(hit)
       {
-         // bottom half
-         normal->set(zBottomLeft-zBottomRight,zBottomRight-zTopRight,squareSize);
-         *height = zBottomLeft + xp * (zBottomRight-zBottomLeft) + yp * (zTopRight-zBottomRight);
-      }
-      else
-      {
-         // top half
-         normal->set(zTopLeft-zTopRight,zBottomLeft-zTopLeft,squareSize);
-         *height = zBottomLeft + xp * (zTopRight-zTopLeft) + yp * (zTopLeft-zBottomLeft);
+         heights[i] = getQueryHeight(q);
+         found++;
       }
+      if(valid)
+         valid[i] = hit;
    }
-   else
+   return found;
+}
+
+U32 TerrainBlock::getNormalsAndHeights(const Point2F *pos, U32 count, Point3F *normals, F32 *heights, bool *valid)
+{
+   F32 invSquareSize = 1.0f / (F32)squareSize;
+   U32 found = 0;
+   HeightQuery q;
+
+   for(U32 i = 0; i < count; i++)
    {
-      if (1.0f-xp>yp)
-      {
-         // bottom half
-         normal->set(zBottomLeft-zBottomRight,zBottomLeft-zTopLeft,squareSize);
-         *height = zBottomRight + (1.0f-xp) * (zBottomLeft-zBottomRight) + yp * (zTopLeft-zBottomLeft);
-      }
-      else
+      bool hit = findQueryTriangle(pos[i], invSquareSize, q);
+      if(hit)
       {
-         // top half
-         normal->set(zTopLeft-zTopRight,zBottomRight-zTopRight,squareSize);
-         *height = zBottomRight + (1.0f-xp) * (zTopLeft-zTopRight) + yp * (zTopRight-zBottomRight);
+         getQueryNormal(q, &normals[i], true);
+         heights[i] = getQueryHeight(q);
+         found++;
       }
+      if(valid)
+         valid[i] = hit;
    }
-   if (normalize)
-      normal->normalize();
-   return true;
+   return found;
 }
 
 //------------------------------------------------------------------------------
@@ -703,6 +758,7 @@ void tweakTerrainBmp(GBitmap * pBitmap)
 bool TerrainBlock::initMMXBlender()
 {
    // DMMNOTE: come back to this
+   TerrainRender::finishBlendJobs();
    delete mBlender;
    mBlender = NULL;
 
@@ -859,7 +915,9 @@ bool TerrainBlock::onAdd()
    if(!Parent::onAdd())
       return false;
 
-   setPosition(Point3F(-squareSize * (BlockSize >> 1), -squareSize * (BlockSize >> 1), 0));
+   if(mPaged)
+      mTile = false;
+   setPosition(getPageOrigin(squareSize, mPaged ? mPagePos : Point2I(0, 0)));
 
    Resource<TerrainFile> terr = ResourceManager->load(mTerrFileName, true);
    if(!bool(terr))
@@ -924,6 +982,16 @@ bool TerrainBlock::onAdd()
       if (!buildMaterialMap())
          return false;
 
+      // pages come and go after the mission is lit, so they light themselves
+      if (mPaged)
+      {
+         LightInfo *sun = gClientSceneGraph->getLightManager()->sgGetSpecialLight(LightManager::sgSunLightType);
+         if (sun)
+            relight(sun->mColor, sun->mAmbient, sun->mDirection);
+         else
+            dMemset(lightMap->getWritableBits(), 0xFF, lightMap->byteSize);
+      }
+
       mTextureCallbackKey = TextureManager::registerEventCallback(terrainTextureEventCB, this);
 
       mDynLightTexture = TextureHandle("common/lighting/lightFalloffMono", BitmapTexture, true);
@@ -949,9 +1017,13 @@ void TerrainBlock::onRemove()
 {
    lightMapTexture = NULL;
 
+   TerrainRender::finishBlendJobs();
    delete mBlender;
    mBlender = NULL;
 
+   if(isClientObject())
+      TerrainRender::flushBlock(this);
+
    removeFromScene();
 
 	if (mVertexBuffer != -1)
@@ -962,6 +1034,7 @@ void TerrainBlock::onRemove()
 			AssertFatal(false,"Vertex buffer should have already been freed!");
 		mVertexBuffer = -1;
 	}
+   freeChunkBuffers();
 
 	TerrainRender::flushCache();
    TextureManager::unregisterEventCallback(mTextureCallbackKey);
@@ -985,12 +1058,45 @@ void TerrainBlock::processTextureEvent(const U32 eventCode)
 				AssertFatal(false,"Vertex buffer should have already been freed!");
 			mVertexBuffer = -1;
 		}
+      freeChunkBuffers();
    } else if (eventCode == TextureManager::CacheResurrected) {
 		if (dglDoesSupportVertexBuffer())
 			mVertexBuffer = glAllocateVertexBufferEXT(VertexBufferSize,GL_V12MTVFMT_EXT,true);
    }
 }
 
+//--------------------------------------
+void TerrainBlock::freeChunkBuffers()
+{
+   for(U32 i = 0; i < ChunkPageCount; i++)
+   {
+      if(mChunkBuffers[i])
+      {
+         GLuint buffer = mChunkBuffers[i];
+         glDeleteBuffersARB(1, &buffer);
+         mChunkBuffers[i] = 0;
+      }
+   }
+}
+
+void TerrainBlock::freeChunkBuffers(Point2I min, Point2I max)
+{
+   // a height change moves the skirts of the neighboring chunks too
+   for(S32 y = (min.y - 1) >> ChunkPageShift; y <= (max.y + 1) >> ChunkPageShift; y++)
+   {
+      for(S32 x = (min.x - 1) >> ChunkPageShift; x <= (max.x + 1) >> ChunkPageShift; x++)
+      {
+         U32 page = (x & (ChunkPageWidth - 1)) + ((y & (ChunkPageWidth - 1)) * ChunkPageWidth);
+         if(mChunkBuffers[page])
+         {
+            GLuint buffer = mChunkBuffers[page];
+            glDeleteBuffersARB(1, &buffer);
+            mChunkBuffers[page] = 0;
+         }
+      }
+   }
+}
+
 //--------------------------------------------------------------------------
 bool TerrainBlock::prepRenderImage(SceneState* state, const U32 stateKey,
                                    const U32 /*startZone*/, const bool /*modifyBaseState*/)
@@ -1008,7 +1114,7 @@ bool TerrainBlock::prepRenderImage(SceneState* state, const U32 stateKey,
       render = true;
 
    if (render == true) {
-      SceneRenderImage* image = new SceneRenderImage;
+      SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
       image->obj = this;
       image->sortType = SceneRenderImage::Terrain;
       state->insertRenderImage(image);
@@ -1025,6 +1131,7 @@ void TerrainBlock::buildChunkDeviance(S32 x, S32 y)
 void TerrainBlock::buildGridMap()
 {
    mFile->buildGridMap();
+   flushCollisionCache();
 }
 
 //------------------------------------------------------------------------------
@@ -1098,6 +1205,8 @@ void TerrainBlock::initPersistFields()
 	addField("bumpOffset",			TypeF32,			Offset(mBumpOffset, TerrainBlock));
 	addField("zeroBumpScale",		TypeS32,			Offset(mZeroBumpScale, TerrainBlock));
    addField("tile",              TypeBool,      Offset(mTile, TerrainBlock));
+   addField("paged",             TypeBool,      Offset(mPaged, TerrainBlock));
+   addField("pagePos",           TypePoint2I,   Offset(mPagePos, TerrainBlock));
    endGroup("Misc");
 
    removeField("position");
@@ -1117,6 +1226,11 @@ U32 TerrainBlock::packUpdate(NetConnection *, U32 mask, BitStream *stream)
    {
       stream->write(mCRC);
       stream->writeFlag(mTile);
+      if(stream->writeFlag(mPaged))
+      {
+         stream->write(mPagePos.x);
+         stream->write(mPagePos.y);
+      }
       stream->writeString(mTerrFileName);
       stream->writeString(mDetailTextureName);
 
@@ -1158,6 +1272,12 @@ void TerrainBlock::unpackUpdate(NetConnection *, BitStream *stream)
    {
       stream->read(&mCRC);
       mTile = stream->readFlag();
+      mPaged = stream->readFlag();
+      if(mPaged)
+      {
+         stream->read(&mPagePos.x);
+         stream->read(&mPagePos.y);
+      }
       mTerrFileName = stream->readSTString();
       mDetailTextureName = stream->readSTString();
 //CW - bump mapping stuff
@@ -1326,6 +1446,17 @@ void TerrainBlock::flushCache()
    TerrainRender::flushCache();
 }
 
+void TerrainBlock::triggerLightmapReload()
+{
+   // blend jobs may be reading the white map
+   TerrainRender::finishBlendJobs();
+
+   if(whiteMap)
+      delete whiteMap;
+   whiteMap = NULL;
+   lightMapTexture = NULL;
+}
+
 //--------------------------------------
 TerrainFile::TerrainFile()
 {
@@ -1336,6 +1467,8 @@ TerrainFile::TerrainFile()
    }
    mTextureScript = 0;
    mHeightfieldScript = 0;
+   mNormalCache = NULL;
+   mNormalCacheSquareSize = 0;
 }
 
 TerrainFile::~TerrainFile()
@@ -1346,6 +1479,7 @@ TerrainFile::~TerrainFile()
    }
    dFree(mTextureScript);
    dFree(mHeightfieldScript);
+   freeNormalCache();
 }
 
 void TerrainFile::setTextureScript(const char *script)
@@ -1507,6 +1641,56 @@ void TerrainFile::buildChunkDeviance(S32 x, S32 y)
    }
 }
 
+//------------------------------------------------------------------------------
+void TerrainFile::buildNormalCache(S32 squareSize)
+{
+   if(!mNormalCache)
+      mNormalCache = new S16[TerrainBlock::BlockSize * TerrainBlock::BlockSize * 6];
+   mNormalCacheSquareSize = squareSize;
+   updateNormalCache(Point2I(1, 1), Point2I(TerrainBlock::BlockSize - 1, TerrainBlock::BlockSize - 1));
+}
+
+void TerrainFile::updateNormalCache(Point2I min, Point2I max)
+{
+   PROFILE_START(TerrainFile_updateNormalCache);
+
+   for(S32 y = min.y - 1; y <= max.y; y++)
+   {
+      for(S32 x = min.x - 1; x <= max.x; x++)
+      {
+         U32 sx = x & TerrainBlock::BlockMask;
+         U32 sy = y & TerrainBlock::BlockMask;
+         bool split45 = (findSquare(0, Point2I(sx, sy))->flags & GridSquare::Split45) != 0;
+
+         F32 zBottomLeft = fixedToFloat(getHeight(sx, sy));
+         F32 zBottomRight = fixedToFloat(getHeight(sx + 1, sy));
+         F32 zTopLeft = fixedToFloat(getHeight(sx, sy + 1));
+         F32 zTopRight = fixedToFloat(getHeight(sx + 1, sy + 1));
+
+         S16 *dst = mNormalCache + (sx + (sy << TerrainBlock::BlockShift)) * 6;
+         for(U32 top = 0; top < 2; top++)
+         {
+            Point3F normal;
+            getTriangleNormal(split45, top != 0, zBottomLeft, zBottomRight,
+                              zTopLeft, zTopRight, (F32)mNormalCacheSquareSize, &normal);
+            normal.normalize();
+            dst[0] = (S16)mFloor(normal.x * 32767.0f + 0.5f);
+            dst[1] = (S16)mFloor(normal.y * 32767.0f + 0.5f);
+            dst[2] = (S16)mFloor(normal.z * 32767.0f + 0.5f);
+            dst += 3;
+         }
+      }
+   }
+
+   PROFILE_END();
+}
+
+void TerrainFile::freeNormalCache()
+{
+   delete [] mNormalCache;
+   mNormalCache = NULL;
+}
+
 void TerrainFile::buildGridMap()
 {
    S32 y;
@@ -1677,11 +1861,15 @@ void TerrainFile::buildGridMap()
    for(;dflags != eflags;s++,dflags++)
       *dflags = s->flags;
 
+   // the heights or splits may have changed
+   if(mNormalCache)
+      buildNormalCache(mNormalCacheSquareSize);
 }
 
 //--------------------------------------
 ResourceInstance *constructTerrainFile(Stream &stream)
 {
+   MemoryTagScope tagScope(Memory::TagTerrain);
    U8 version;
    stream.read(&version);
    if (version > TerrainFile::FILE_VERSION)
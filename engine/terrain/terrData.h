@@ -107,6 +107,7 @@ struct GridChunk
 class TerrainBlock : public SceneObject
 {
    typedef SceneObject Parent;
+   friend class TerrainPager;
 
   public:
    struct Material {
@@ -138,6 +139,10 @@ class TerrainBlock : public SceneObject
       ChunkSize = 4,
       ChunkDownShift = 2,
       ChunkShift = BlockShift - ChunkDownShift,
+      ChunkPageShift = 6,                           ///< Chunked LOD vertex buffers are 64x64 squares.
+      ChunkPageSize = 1 << ChunkPageShift,
+      ChunkPageWidth = BlockSize >> ChunkPageShift,
+      ChunkPageCount = ChunkPageWidth * ChunkPageWidth,
       BlockSquareWidth = 256,
       SquareMaxPoints = 1024,
       BlockMask = 255,
@@ -164,13 +169,7 @@ class TerrainBlock : public SceneObject
    GBitmap *lightMap;
    GBitmap *whiteMap;
    TextureHandle lightMapTexture;
-   void triggerLightmapReload()
-   {
-	   if(whiteMap)
-		   delete whiteMap;
-	   whiteMap = NULL;
-	   lightMapTexture = NULL;
-   }
+   void triggerLightmapReload();
    StringTableEntry *mMaterialFileName; ///< Array from the file.
 
    TextureHandle mDynLightTexture;
@@ -202,9 +201,29 @@ class TerrainBlock : public SceneObject
 
    S32 mVertexBuffer;
 
+   /// Chunked LOD vertex buffers, 0 until a page is first drawn.
+   U32 mChunkBuffers[ChunkPageCount];
+   void freeChunkBuffers();
+   void freeChunkBuffers(Point2I min, Point2I max);
+
    /// If true, we tile infinitely.
    bool mTile;
 
+   /// @name Paging
+   /// A block placed by a TerrainPager holds one page of a larger grid and
+   /// doesn't tile.  Neighboring pages share their edge samples, so pages
+   /// are placed PageSquares apart and the last row and column of squares,
+   /// which would wrap back to the start of the page, are made empty.
+   /// @{
+   enum { PageSquares = BlockSquareWidth - 1 };
+   bool    mPaged;
+   Point2I mPagePos;
+
+   /// World position of the corner of a page; page 0,0 is where a lone
+   /// block would be.
+   static Point3F getPageOrigin(S32 squareSize, const Point2I &pagePos);
+   /// @}
+
   private:
    Resource<TerrainFile> mFile;
    GridSquare *gridMap[BlockShift+1];
@@ -241,8 +260,24 @@ class TerrainBlock : public SceneObject
    GridChunk *findChunk(Point2I pos);
 
    void setHeight(const Point2I & pos, float height);
+
+   /// @name Incremental updates
+   /// For edits to the points from min to max, inclusive.  The rect may run
+   /// past the edge of the block, anything beyond BlockMask wraps, but
+   /// should be no wider than the block.
+   /// @{
+
+   /// Rebuilds the grid map, chunk deviances and normal cache around the
+   /// points after their heights change, then flushGridRect().
    void updateGrid(Point2I min, Point2I max);
+   /// Rebuilds the material flags of the squares around the points after
+   /// their alphas change, and drops the blended textures over them.
    void updateGridMaterials(Point2I min, Point2I max);
+   /// Drops this block's own copies of the squares around the points: its
+   /// chunk buffers and collision cache.  A block sharing the file with
+   /// the one that was updated needs this too.
+   void flushGridRect(Point2I min, Point2I max);
+   /// @}
 
    U16 getHeight(U32 x, U32 y) { return heightMap[(x & BlockMask) + ((y & BlockMask) << BlockShift)]; }
    U16 *getHeightAddress(U32 x, U32 y) { return &heightMap[(x & BlockMask) + ((y & BlockMask) << BlockShift)]; }
@@ -262,6 +297,15 @@ class TerrainBlock : public SceneObject
    bool getNormal(const Point2F & pos, Point3F * normal, bool normalize = true);
    bool getNormalAndHeight(const Point2F & pos, Point3F * normal, F32 * height, bool normalize = true);
 
+   /// Batched getHeight(), for callers with several points to resolve at
+   /// once such as vehicle wheels.  Returns the number of points that are
+   /// over terrain.  If valid is given it is set for every point; heights
+   /// of points over empty squares are left alone.
+   U32 getHeights(const Point2F *pos, U32 count, F32 *heights, bool *valid = NULL);
+
+   /// Batched getNormalAndHeight() with normalized normals.
+   U32 getNormalsAndHeights(const Point2F *pos, U32 count, Point3F *normals, F32 *heights, bool *valid = NULL);
+
    // only the editor currently uses this method - should always be using a ray to collide with
    bool collideBox(const Point3F &start, const Point3F &end, RayInfo* info){return(castRay(start,end,info));}
    S32 getMaterialAlphaIndex(const char *materialName);
@@ -269,6 +313,12 @@ class TerrainBlock : public SceneObject
   private:
    S32 squareSize;
 
+   /// The triangle under a point, shared by the height and normal queries.
+   struct HeightQuery;
+   inline bool findQueryTriangle(const Point2F &pos, F32 invSquareSize, HeightQuery &q);
+   inline F32  getQueryHeight(const HeightQuery &q);
+   inline void getQueryNormal(const HeightQuery &q, Point3F *normal, bool normalize);
+
   public:
    void setFile(Resource<TerrainFile> file);
    bool save(const char* filename);
@@ -292,6 +342,37 @@ class TerrainBlock : public SceneObject
    BSPTree *mTree;
    S32 mHeightMin;
    S32 mHeightMax;
+
+   /// @name Collision square cache
+   /// buildConvex() decodes the same squares tick after tick for anything
+   /// resting on or driving over the terrain, so the decoded heights,
+   /// and normals of recently used squares are kept in a small
+   /// set associative cache, least recently used out.  Tiled copies of a
+   /// square share its entry.  Flushed whenever the heights change.
+   /// @{
+   enum
+   {
+      CollisionCacheSets = 256,      ///< Power of two
+      CollisionCacheWays = 4,
+      CollisionCacheEmpty = 0xFFFFFFFF
+   };
+   struct CollisionSquare
+   {
+      U32     key;        ///< (xi << 16) | yi, or CollisionCacheEmpty
+      U32     lastUsed;
+      F32     height[4];  ///< In the TerrainConvex point order
+      VectorF normal[2];
+      bool    split45;
+      bool    concave;    ///< Needs a TerrainConvex for each half
+   };
+   CollisionSquare mCollisionCache[CollisionCacheSets * CollisionCacheWays];
+   U32 mCollisionCacheTime;
+
+   const CollisionSquare &getCollisionSquare(S32 xi, S32 yi, const GridSquare *gs);
+   void flushCollisionCache();
+   void flushCollisionCache(Point2I min, Point2I max);
+   /// @}
+
   public:
    void buildConvex(const Box3F& box,Convex* convex);
    bool buildPolyList(AbstractPolyList* polyList, const Box3F &box, const SphereF &sphere);
@@ -356,6 +437,21 @@ class TerrainFile : public ResourceInstance
    void buildGridMap();
    void heightDevLine(U32 p1x, U32 p1y, U32 p2x, U32 p2y, U32 pmx, U32 pmy, U16 *devPtr);
 
+   /// @name Normal cache
+   /// Unit normals of both triangles of every square, bottom one first,
+   /// stored as x,y,z S16s scaled by 32767.  Built by the first TerrainBlock
+   /// that uses the file and only valid for blocks with the squareSize it was
+   /// built for; other blocks compute their normals directly.
+   /// @{
+   S16 *mNormalCache;
+   S32  mNormalCacheSquareSize;
+
+   void buildNormalCache(S32 squareSize);
+   /// Rebuilds the squares touching the grid points in [min, max].
+   void updateNormalCache(Point2I min, Point2I max);
+   void freeNormalCache();
+   /// @}
+
    inline GridSquare *findSquare(U32 level, Point2I pos)
    {
       return mGridMap[level] + (pos.x >> level) + ((pos.y>>level) << (TerrainBlock::BlockShift - level));
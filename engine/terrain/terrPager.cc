@@ -0,0 +1,379 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "terrain/terrPager.h"
+#include "terrain/terrData.h"
+#include "core/bitStream.h"
+#include "core/resManager.h"
+#include "console/consoleTypes.h"
+#include "math/mathTypes.h"
+#include "sceneGraph/sceneGraph.h"
+#include "game/gameConnection.h"
+#include "game/shapeBase.h"
+#include "platform/profiler.h"
+
+IMPLEMENT_CO_NETOBJECT_V1(TerrainPager);
+
+//------------------------------------------------------------------------------
+class TerrainPagerUpdateEvent : public SimEvent
+{
+   public:
+      void process(SimObject *object) {
+         ((TerrainPager*)object)->updatePages();
+      }
+};
+
+//------------------------------------------------------------------------------
+TerrainPager::TerrainPager()
+{
+   mNetFlags.set(Ghostable | ScopeAlways);
+
+   mUpdateEvent = 0;
+
+   mPageFile = NULL;
+   mPageCount.set(1, 1);
+   mSquareSize = 8;
+   mLoadDistance = 1500.0f;
+   mUnloadDistance = 2500.0f;
+   mDetailTexture = NULL;
+}
+
+//------------------------------------------------------------------------------
+void TerrainPager::initPersistFields()
+{
+   Parent::initPersistFields();
+
+   addGroup("Media");
+   addField("pageFile",       TypeFilename,  Offset(mPageFile, TerrainPager));
+   addField("detailTexture",  TypeFilename,  Offset(mDetailTexture, TerrainPager));
+   endGroup("Media");
+
+   addGroup("Paging");
+   addField("pageCount",      TypePoint2I,   Offset(mPageCount, TerrainPager));
+   addField("squareSize",     TypeS32,       Offset(mSquareSize, TerrainPager));
+   addField("loadDistance",   TypeF32,       Offset(mLoadDistance, TerrainPager));
+   addField("unloadDistance", TypeF32,       Offset(mUnloadDistance, TerrainPager));
+   endGroup("Paging");
+}
+
+//------------------------------------------------------------------------------
+bool TerrainPager::onAdd()
+{
+   if(!Parent::onAdd())
+      return false;
+
+   if(!mPageFile || !mPageFile[0])
+   {
+      Con::errorf(ConsoleLogEntry::General, "TerrainPager::onAdd: no pageFile given.");
+      return false;
+   }
+
+   mPageCount.x = getMax(mPageCount.x, 1);
+   mPageCount.y = getMax(mPageCount.y, 1);
+   mSquareSize = getMax(mSquareSize, 1);
+   if(mUnloadDistance < mLoadDistance)
+      mUnloadDistance = mLoadDistance;
+
+   mPages.setSize(mPageCount.x * mPageCount.y);
+   for(U32 i = 0; i < mPages.size(); i++)
+   {
+      mPages[i].block = NULL;
+      mPages[i].resource = NULL;
+      mPages[i].loading = false;
+   }
+
+   updatePages();
+   return true;
+}
+
+void TerrainPager::onRemove()
+{
+   if(mUpdateEvent)
+   {
+      Sim::cancelEvent(mUpdateEvent);
+      mUpdateEvent = 0;
+   }
+
+   // loads still in flight find the pager gone and drop their lock
+   for(U32 i = 0; i < mPages.size(); i++)
+      unloadPage(i);
+   mPages.clear();
+
+   Parent::onRemove();
+}
+
+void TerrainPager::onDeleteNotify(SimObject *object)
+{
+   for(U32 i = 0; i < mPages.size(); i++)
+      if(mPages[i].block == object)
+         mPages[i].block = NULL;
+
+   Parent::onDeleteNotify(object);
+}
+
+//------------------------------------------------------------------------------
+void TerrainPager::getPageFileName(const Point2I &pos, char *buffer, U32 size)
+{
+   dSprintf(buffer, size, mPageFile, pos.x, pos.y);
+}
+
+F32 TerrainPager::getPageDistance(U32 index, const Point3F &point)
+{
+   Point3F origin = TerrainBlock::getPageOrigin(mSquareSize, getPagePos(index));
+   F32 pageSize = F32(mSquareSize * TerrainBlock::PageSquares);
+
+   F32 dx = getMax(getMax(origin.x - point.x, point.x - (origin.x + pageSize)), 0.0f);
+   F32 dy = getMax(getMax(origin.y - point.y, point.y - (origin.y + pageSize)), 0.0f);
+   return mSqrt(dx * dx + dy * dy);
+}
+
+bool TerrainPager::getViewPoints(Vector<Point3F> &points)
+{
+   if(isServerObject())
+   {
+      SimGroup *g = Sim::getClientGroup();
+      for(SimGroup::iterator itr = g->begin(); itr != g->end(); itr++)
+      {
+         GameConnection *con = dynamic_cast<GameConnection*>(*itr);
+         ShapeBase *obj = con ? con->getCameraObject() : NULL;
+         if(obj)
+            points.push_back(obj->getPosition());
+      }
+   }
+   else
+   {
+      GameConnection *con = GameConnection::getConnectionToServer();
+      MatrixF mat;
+      if(con && con->getControlCameraTransform(0, &mat))
+      {
+         points.increment();
+         mat.getColumn(3, &points.last());
+      }
+   }
+   return points.size() != 0;
+}
+
+//------------------------------------------------------------------------------
+void TerrainPager::updatePages()
+{
+   PROFILE_START(TerrainPager_updatePages);
+
+   // the server loads out to loadDistance, the client reads ahead to
+   // unloadDistance so the ghosts find their file in memory
+   F32 loadDistance = isServerObject() ? mLoadDistance : mUnloadDistance;
+
+   Vector<Point3F> points;
+   if(getViewPoints(points))
+   {
+      for(U32 i = 0; i < mPages.size(); i++)
+      {
+         F32 dist = getPageDistance(i, points[0]);
+         for(U32 j = 1; j < points.size(); j++)
+            dist = getMin(dist, getPageDistance(i, points[j]));
+
+         if(dist <= loadDistance)
+            loadPage(i);
+         else if(dist > mUnloadDistance)
+            unloadPage(i);
+      }
+
+      if(isClientObject())
+         updateCurrentTerrain(points[0]);
+   }
+
+   mUpdateEvent = Sim::postEvent(this, new TerrainPagerUpdateEvent, Sim::getCurrentTime() + UpdateMs);
+
+   PROFILE_END();
+}
+
+U32 TerrainPager::getNumLoadedPages()
+{
+   U32 count = 0;
+   for(U32 i = 0; i < mPages.size(); i++)
+      if(mPages[i].block || mPages[i].resource)
+         count++;
+   return count;
+}
+
+//------------------------------------------------------------------------------
+void TerrainPager::loadPage(U32 index)
+{
+   Page &page = mPages[index];
+   if(page.block || page.resource || page.loading)
+      return;
+
+   char fileName[1024];
+   getPageFileName(getPagePos(index), fileName, sizeof(fileName));
+
+   LoadRequest *request = new LoadRequest;
+   request->pagerId = getId();
+   request->index = index;
+
+   if(!ResourceManager->loadAsync(fileName, pageLoaded, request, true))
+   {
+      Con::errorf(ConsoleLogEntry::General, "TerrainPager: missing page %s", fileName);
+      delete request;
+      return;
+   }
+   page.loading = true;
+}
+
+void TerrainPager::unloadPage(U32 index)
+{
+   // a pending load is dropped when it comes back
+   Page &page = mPages[index];
+   page.loading = false;
+
+   if(page.block)
+   {
+      TerrainBlock *block = page.block;
+      page.block = NULL;
+      block->deleteObject();
+   }
+   if(page.resource)
+   {
+      ResourceManager->unlock(page.resource);
+      page.resource = NULL;
+   }
+}
+
+void TerrainPager::pageLoaded(ResourceObject *obj, void *userData)
+{
+   LoadRequest *request = (LoadRequest *) userData;
+   TerrainPager *pager = dynamic_cast<TerrainPager*>(Sim::findObject(request->pagerId));
+
+   if(pager && request->index < pager->mPages.size())
+      pager->onPageLoaded(request->index, obj);
+   else if(obj)
+      ResourceManager->unlock(obj);
+
+   delete request;
+}
+
+void TerrainPager::onPageLoaded(U32 index, ResourceObject *obj)
+{
+   Page &page = mPages[index];
+
+   // unloaded again, or already loaded by an earlier request
+   if(!page.loading)
+   {
+      if(obj)
+         ResourceManager->unlock(obj);
+      return;
+   }
+   page.loading = false;
+
+   if(!obj)
+   {
+      char fileName[1024];
+      getPageFileName(getPagePos(index), fileName, sizeof(fileName));
+      Con::errorf(ConsoleLogEntry::General, "TerrainPager: unable to load page %s", fileName);
+      return;
+   }
+
+   // the client keeps its lock until the page goes out of range; on the
+   // server the block takes its own
+   page.resource = obj;
+   if(isServerObject())
+   {
+      createPageBlock(index);
+      ResourceManager->unlock(page.resource);
+      page.resource = NULL;
+   }
+}
+
+void TerrainPager::createPageBlock(U32 index)
+{
+   char fileName[1024];
+   getPageFileName(getPagePos(index), fileName, sizeof(fileName));
+
+   TerrainBlock *block = new TerrainBlock;
+   block->mTerrFileName = StringTable->insert(fileName);
+   block->mDetailTextureName = mDetailTexture;
+   block->squareSize = mSquareSize;
+   block->mPaged = true;
+   block->mPagePos = getPagePos(index);
+
+   if(!block->registerObject())
+   {
+      Con::errorf(ConsoleLogEntry::General, "TerrainPager: unable to add page %s", fileName);
+      delete block;
+      return;
+   }
+   block->deleteNotify(this);
+   mPages[index].block = block;
+}
+
+//------------------------------------------------------------------------------
+static void findPageCallback(SceneObject *obj, void *key)
+{
+   Vector<TerrainBlock*> *blocks = (Vector<TerrainBlock*> *) key;
+   TerrainBlock *block = static_cast<TerrainBlock*>(obj);
+   if(block->mPaged)
+      blocks->push_back(block);
+}
+
+void TerrainPager::updateCurrentTerrain(const Point3F &camPos)
+{
+   // the scene graph's terrain is used for height and visibility queries
+   // around the camera, so it should be the page the camera is over
+   TerrainBlock *current = gClientSceneGraph->getCurrentTerrain();
+   if(current && current->mPaged)
+   {
+      Point3F origin = TerrainBlock::getPageOrigin(mSquareSize, current->mPagePos);
+      F32 pageSize = F32(mSquareSize * TerrainBlock::PageSquares);
+      if(camPos.x >= origin.x && camPos.x < origin.x + pageSize &&
+         camPos.y >= origin.y && camPos.y < origin.y + pageSize)
+         return;
+   }
+
+   Vector<TerrainBlock*> blocks;
+   gClientContainer.findObjects(TerrainObjectType, findPageCallback, &blocks);
+
+   TerrainBlock *best = NULL;
+   F32 bestDist = 1e30f;
+   for(U32 i = 0; i < blocks.size(); i++)
+   {
+      U32 index = blocks[i]->mPagePos.x + blocks[i]->mPagePos.y * mPageCount.x;
+      F32 dist = getPageDistance(index, camPos);
+      if(dist < bestDist)
+      {
+         best = blocks[i];
+         bestDist = dist;
+      }
+   }
+   if(best)
+      gClientSceneGraph->setCurrentTerrain(best);
+}
+
+//------------------------------------------------------------------------------
+U32 TerrainPager::packUpdate(NetConnection *, U32, BitStream *stream)
+{
+   stream->writeString(mPageFile);
+   stream->writeString(mDetailTexture);
+   stream->write(mPageCount.x);
+   stream->write(mPageCount.y);
+   stream->write(mSquareSize);
+   stream->write(mLoadDistance);
+   stream->write(mUnloadDistance);
+   return 0;
+}
+
+void TerrainPager::unpackUpdate(NetConnection *, BitStream *stream)
+{
+   mPageFile = stream->readSTString();
+   mDetailTexture = stream->readSTString();
+   stream->read(&mPageCount.x);
+   stream->read(&mPageCount.y);
+   stream->read(&mSquareSize);
+   stream->read(&mLoadDistance);
+   stream->read(&mUnloadDistance);
+}
+
+//------------------------------------------------------------------------------
+ConsoleMethod(TerrainPager, getNumLoadedPages, S32, 2, 2, "() Number of pages currently loaded.")
+{
+   return object->getNumLoadedPages();
+}
@@ -0,0 +1,107 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _TERRPAGER_H_
+#define _TERRPAGER_H_
+
+#ifndef _NETOBJECT_H_
+#include "sim/netObject.h"
+#endif
+#ifndef _MPOINT_H_
+#include "math/mPoint.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+
+class TerrainBlock;
+class ResourceObject;
+
+/// Paged terrain for maps bigger than one TerrainBlock.
+///
+/// The map is a grid of .ter files, pageCount.x by pageCount.y, named by
+/// pageFile with the page x and y filled in, e.g. "~/data/big_%d_%d.ter".
+/// Each page becomes a non-tiling TerrainBlock placed next to its neighbors
+/// (see TerrainBlock::PageSquares), so neighboring files must share their
+/// edge rows of samples.
+///
+/// On the server, pages within loadDistance of any client's camera object
+/// are read with ResManager::loadAsync(), and the page's TerrainBlock is
+/// created once the file is in memory.  Pages farther than unloadDistance
+/// from every client are deleted, which unlocks the file so the resource
+/// memory budget can evict it.  Clients get the blocks as ghosts.
+///
+/// The client's copy of the pager prefetches the files around its own
+/// camera out to unloadDistance, so the ghost's load finds them resident,
+/// and points the scene graph's current terrain at the page under the
+/// camera.
+class TerrainPager : public NetObject
+{
+   typedef NetObject Parent;
+
+   struct Page
+   {
+      TerrainBlock   *block;      ///< Server only, the page's block once loaded.
+      ResourceObject *resource;   ///< Client only, the prefetched file, locked.
+      bool           loading;     ///< A loadAsync() is in flight.
+   };
+
+   /// Handed to loadAsync(), so a load that outlives the pager is harmless.
+   struct LoadRequest
+   {
+      SimObjectId pagerId;
+      U32         index;
+   };
+
+   Vector<Page> mPages;
+   U32          mUpdateEvent;
+
+   static void pageLoaded(ResourceObject *obj, void *userData);
+   void onPageLoaded(U32 index, ResourceObject *obj);
+
+   void getPageFileName(const Point2I &pos, char *buffer, U32 size);
+   Point2I getPagePos(U32 index) { return Point2I(index % mPageCount.x, index / mPageCount.x); }
+
+   /// Distance in the XY plane from point to the page.
+   F32  getPageDistance(U32 index, const Point3F &point);
+
+   /// Fills points with the positions the pages are loaded around, returns false if none.
+   bool getViewPoints(Vector<Point3F> &points);
+
+   void loadPage(U32 index);
+   void unloadPage(U32 index);
+   void createPageBlock(U32 index);
+   void updateCurrentTerrain(const Point3F &camPos);
+
+  public:
+   enum { UpdateMs = 250 };
+
+   StringTableEntry mPageFile;
+   Point2I          mPageCount;
+   S32              mSquareSize;
+   F32              mLoadDistance;
+   F32              mUnloadDistance;
+   StringTableEntry mDetailTexture;
+
+   TerrainPager();
+
+   bool onAdd();
+   void onRemove();
+   void onDeleteNotify(SimObject *object);
+   static void initPersistFields();
+
+   /// Loads and unloads pages around the view points; runs every UpdateMs.
+   void updatePages();
+
+   /// Number of pages with a block (server) or a prefetched file (client).
+   U32  getNumLoadedPages();
+
+   U32  packUpdate  (NetConnection *conn, U32 mask, BitStream *stream);
+   void unpackUpdate(NetConnection *conn,           BitStream *stream);
+
+   DECLARE_CONOBJECT(TerrainPager);
+};
+
+#endif
@@ -19,6 +19,9 @@
 #include "sceneGraph/sceneGraph.h"
 #include "sceneGraph/sgUtil.h"
 #include "platform/profiler.h"
+#include "core/frameStats.h"
+#include "core/threadPool.h"
+#include "sceneGraph/boxCuller.h"
 
 inline F32 custom_dot(Point4F &a, Point3F &b)
 {
@@ -121,6 +124,21 @@ bool TerrainRender::mRenderOutline;
 
 U32 TerrainRender::mMaterialCount;
 
+bool TerrainRender::mEnableChunkedLOD = false;
+bool TerrainRender::mRenderingChunked = false;
+U32  TerrainRender::mChunkStampIndex = 0;
+U32  TerrainRender::mChunkStamp[TerrainBlock::ChunkSquareWidth * TerrainBlock::ChunkSquareWidth];
+U8   TerrainRender::mChunkLOD[TerrainBlock::ChunkSquareWidth * TerrainBlock::ChunkSquareWidth];
+EmitChunk *TerrainRender::mChunkEmitList = NULL;
+
+bool TerrainRender::mEnableAsyncBlend = true;
+S32  TerrainRender::mMaxBlendJobs = 4;
+S32  TerrainRender::mBlendUploadTime = 2;
+S32  TerrainRender::mPendingBlendCount = 0;
+Vector<TerrainBlendJob*> TerrainRender::mBlendRequests(__FILE__, __LINE__);
+Vector<TerrainBlendJob*> TerrainRender::mBlendJobs(__FILE__, __LINE__);
+Vector<TerrainBlendJob*> TerrainRender::mFreeBlendJobs(__FILE__, __LINE__);
+
 namespace {
 
 Point4F sgTexGenS;
@@ -206,6 +224,13 @@ void TerrainRender::init()
    Con::addVariable("pref::Terrain::dynamicLights", TypeBool, &mEnableTerrainDynLights);
    Con::addVariable("pref::Terrain::screenError", TypeF32, &mScreenError);
    Con::addVariable("pref::Terrain::textureCacheSize", TypeS32, &mTextureSlopSize);
+   Con::addVariable("pref::Terrain::chunkedLOD", TypeBool, &mEnableChunkedLOD);
+   Con::addVariable("pref::Terrain::asyncBlend", TypeBool, &mEnableAsyncBlend);
+   Con::addVariable("pref::Terrain::maxBlendJobs", TypeS32, &mMaxBlendJobs);
+   Con::addVariable("pref::Terrain::blendUploadTime", TypeS32, &mBlendUploadTime);
+   Con::addVariable("T2::pendingBlendCount", TypeS32, &mPendingBlendCount);
+
+   initChunkTables();
 }
 
 void TerrainRender::shutdown()
@@ -213,6 +238,10 @@ void TerrainRender::shutdown()
    delete mBlendBitmap;
    mBlendBitmap = NULL;
    flushCache();
+
+   for(S32 i = 0; i < mFreeBlendJobs.size(); i++)
+      delete mFreeBlendJobs[i];
+   mFreeBlendJobs.clear();
 }
 
 void TerrainRender::buildClippingPlanes(bool flipClipPlanes)
@@ -250,52 +279,7 @@ void TerrainRender::buildClippingPlanes(bool flipClipPlanes)
 
 S32 TerrainRender::TestSquareVisibility(Point3F &min, Point3F &max, S32 mask, F32 expand)
 {
-   S32 retMask = 0;
-   Point3F minPoint, maxPoint;
-   for(S32 i = 0; i < mNumClipPlanes; i++)
-   {
-      if(mask & (1 << i))
-      {
-         if(mClipPlane[i].x > 0.0f)
-         {
-            maxPoint.x = max.x;
-            minPoint.x = min.x;
-         }
-         else
-         {
-            maxPoint.x = min.x;
-            minPoint.x = max.x;
-         }
-         if(mClipPlane[i].y > 0.0f)
-         {
-            maxPoint.y = max.y;
-            minPoint.y = min.y;
-         }
-         else
-         {
-            maxPoint.y = min.y;
-            minPoint.y = max.y;
-         }
-         if(mClipPlane[i].z > 0.0f)
-         {
-            maxPoint.z = max.z;
-            minPoint.z = min.z;
-         }
-         else
-         {
-            maxPoint.z = min.z;
-            minPoint.z = max.z;
-         }
-         F32 maxDot = mDot(maxPoint, mClipPlane[i]);
-         F32 minDot = mDot(minPoint, mClipPlane[i]);
-         F32 planeD = mClipPlane[i].d;
-         if(maxDot <= -(planeD + expand))
-            return -1;
-         if(minDot <= -planeD)
-            retMask |= (1 << i);
-      }
-   }
-   return retMask;
+   return BoxCuller::cullBox(mClipPlane, mNumClipPlanes, mask, expand, min, max);
 }
 
 ChunkCornerPoint *TerrainRender::allocInitialPoint(Point3F pos)
@@ -404,15 +388,19 @@ void TerrainRender::emitTerrChunk(SquareStackNode *n, F32 squareDistance, U32 li
    if(mRenderingCommander)
       return;
 
-   chunk->edge[0] = (ChunkEdge *) n->top;
-   chunk->edge[1] = (ChunkEdge *) n->right;
-   chunk->edge[2] = (ChunkEdge *) n->bottom;
-   chunk->edge[3] = (ChunkEdge *) n->left;
-
-   chunk->edge[0]->c2 = chunk;
-   chunk->edge[1]->c1 = chunk;
-   chunk->edge[2]->c1 = chunk;
-   chunk->edge[3]->c2 = chunk;
+   // chunked LOD doesn't build the edges
+   if(!mRenderingChunked)
+   {
+      chunk->edge[0] = (ChunkEdge *) n->top;
+      chunk->edge[1] = (ChunkEdge *) n->right;
+      chunk->edge[2] = (ChunkEdge *) n->bottom;
+      chunk->edge[3] = (ChunkEdge *) n->left;
+
+      chunk->edge[0]->c2 = chunk;
+      chunk->edge[1]->c1 = chunk;
+      chunk->edge[2]->c1 = chunk;
+      chunk->edge[3]->c2 = chunk;
+   }
 
 
    // holes only in the primary terrain block
@@ -456,8 +444,27 @@ void TerrainRender::emitTerrChunk(SquareStackNode *n, F32 squareDistance, U32 li
          minSubdivideDistance = clampDistance;
       }
    }
+   // page edges stay at full detail so they meet the neighboring page
+   if(mCurrentBlock->mPaged &&
+      (n->pos.x == 0 || n->pos.y == 0 ||
+       n->pos.x == TerrainBlock::BlockSquareWidth - 4 || n->pos.y == TerrainBlock::BlockSquareWidth - 4))
+   {
+      subDivLevel = -1;
+      growFactor = 0.0f;
+   }
    chunk->subDivLevel = subDivLevel;
    chunk->growFactor = growFactor;
+
+   if(mRenderingChunked)
+   {
+      // remember the level for the neighbors' skirts
+      U32 index = (n->pos.x >> TerrainBlock::ChunkDownShift) + ((n->pos.y >> TerrainBlock::ChunkDownShift) << TerrainBlock::ChunkShift);
+      mChunkStamp[index] = mChunkStampIndex;
+      mChunkLOD[index] = getChunkLOD(chunk);
+      chunk->skirtMask = 0;
+      chunk->nextEmit = mChunkEmitList;
+      mChunkEmitList = chunk;
+   }
 }
 
 void TerrainRender::processCurrentBlock(SceneState*, EdgeParent *topEdge, EdgeParent *rightEdge, EdgeParent *bottomEdge, EdgeParent *leftEdge)
@@ -486,6 +493,9 @@ void TerrainRender::processCurrentBlock(SceneState*, EdgeParent *topEdge, EdgePa
 
    S32 curStackSize = 1;
 
+   mChunkStampIndex++;
+   mChunkEmitList = NULL;
+
    F32 worldToScreenScale   = dglProjectRadius(1,1);
    F32 zeroDetailDistance   = (mSquareSize * worldToScreenScale) / (1 << 6) - (mSquareSize >> 1);
    F32 zeroBumpDistance     = (mSquareSize * worldToScreenScale) / (1 << mCurrentBlock->mZeroBumpScale) - (mSquareSize >> 1);
@@ -631,6 +641,13 @@ notexalloc:
          curStackSize--;
          continue;
       }
+      if(mRenderingChunked)
+      {
+         n->clipFlags = nextClipFlags;
+         subdivideChunkedSquare(n);
+         curStackSize += 3;
+         continue;
+      }
       bool allocChunkEdges = (n->level == 3);
 
       Point2I pos = n->pos;
@@ -701,6 +718,9 @@ notexalloc:
 
       curStackSize += 3;
    }
+
+   if(mRenderingChunked)
+      resolveChunkSkirts();
 }
 
 
@@ -1600,6 +1620,7 @@ void TerrainRender::renderXFCache()
    {
       U32 mode = mXFIndexBuffer[count];
       U32 vertexCount = mXFIndexBuffer[count + 1];
+      STAT_INC(DrawCalls);
       glDrawElements(mode, vertexCount, GL_UNSIGNED_SHORT, mXFIndexBuffer + count + 2);
       count += vertexCount + 2;
    }
@@ -1696,7 +1717,7 @@ void TerrainRender::renderGLBumps(Point2F bumpTextureOffset, U32 hazeName)
 
 void TerrainRender::renderBlock(TerrainBlock *block, SceneState *state)
 {
-   PROFILE_START(TerrainRender);
+   PROFILE_GPU_START(TerrainRender);
 
    // verify lighting type is the same...
    static bool lastblended = false;
@@ -1722,9 +1743,11 @@ void TerrainRender::renderBlock(TerrainBlock *block, SceneState *state)
          mTextureFreeList[i] = TextureHandle((const char*)NULL, mBlendBitmap, TerrainTexture, true);
       }
    }
+   updateBlendJobs();
 
    mFrameIndex++;
    mSceneState = state;
+   mRenderingChunked = mEnableChunkedLOD && !mRenderingCommander && dglDoesSupportVertexBufferObject();
    mFarDistance = state->getVisibleDistance();
 
    dglGetModelview(&mCameraToObject);
@@ -1964,6 +1987,9 @@ void TerrainRender::renderBlock(TerrainBlock *block, SceneState *state)
    glDisable(GL_BLEND);
    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+   if(mRenderingChunked)
+      beginChunkedRender(blendedlighting ? 2 : 1);
+
    mXFIndex = 0;
    sgCurrLightTris = NULL;
    AllocatedTexture *walk;
@@ -1979,15 +2005,25 @@ void TerrainRender::renderBlock(TerrainBlock *block, SceneState *state)
       else
          walk->linkAfter(&mTextureFreeBigListHead);
       mStaticTextureCount++;
+
+      // draw with a larger square's texture while the blend is pending
+      AllocatedTexture *drawTex = walk;
       if(!walk->handle)
-         buildBlendMap(walk);
+      {
+         drawTex = requestBlendMap(walk);
+         if(!drawTex)
+         {
+            buildBlendMap(walk);
+            drawTex = walk;
+         }
+      }
       AllocatedTexture *step = walk;
       while(step)
       {
          // loop through the list and draw all the squares:
-         F32 invLevel = 1.0f / F32(mSquareSize << step->level);
-         sgTexGenS.set(invLevel, 0.0f, 0.0f, -(step->x >> step->level));
-         sgTexGenT.set(0.0f, invLevel, 0.0f, -(step->y >> step->level));
+         F32 invLevel = 1.0f / F32(mSquareSize << drawTex->level);
+         sgTexGenS.set(invLevel, 0.0f, 0.0f, -(step->x >> drawTex->level));
+         sgTexGenT.set(0.0f, invLevel, 0.0f, -(step->y >> drawTex->level));
 
          // Bump map texture coordinate "calculation" (hack) for ATi cards -CW
          // Why don't Point4F's have a multiply operator?
@@ -2001,6 +2037,12 @@ void TerrainRender::renderBlock(TerrainBlock *block, SceneState *state)
          bumpTexGenT.z = sgTexGenT.z * scale;
          bumpTexGenT.w = sgTexGenT.w * scale;
          // End -CW
+
+         if(mRenderingChunked)
+         {
+            renderChunkList(step, drawTex->handle, blendedlighting, detTexGenS, detTexGenT, zeroDetailDistance);
+            step->list = NULL;
+         }
 		 
          while(step->list)
          {
@@ -2155,7 +2197,7 @@ void TerrainRender::renderBlock(TerrainBlock *block, SceneState *state)
 			   }
 
                PROFILE_START(TerrainRenderBind);
-               glBindTexture(GL_TEXTURE_2D, walk->handle.getGLName());
+               glBindTexture(GL_TEXTURE_2D, drawTex->handle.getGLName());
                doTexGens(sgTexGenS, sgTexGenT);
 
                PROFILE_END();
@@ -2238,6 +2280,9 @@ void TerrainRender::renderBlock(TerrainBlock *block, SceneState *state)
       }
    }
 
+   if(mRenderingChunked)
+      endChunkedRender(blendedlighting ? 2 : 1);
+
    glActiveTextureARB(GL_TEXTURE1_ARB);
    glClientActiveTextureARB(GL_TEXTURE1_ARB);
    glDisable(GL_TEXTURE_2D);
@@ -2286,11 +2331,18 @@ void TerrainRender::renderBlock(TerrainBlock *block, SceneState *state)
          {
             if(blendedlighting)
             {
-               F32 invLevel = 1.0f / F32(mSquareSize << walkLT->chunkTexture->level);
-               sgTexGenS.set(invLevel, 0.0f, 0.0f, -(walkLT->chunkTexture->x >> walkLT->chunkTexture->level));
-               sgTexGenT.set(0.0f, invLevel, 0.0f, -(walkLT->chunkTexture->y >> walkLT->chunkTexture->level));
-
-               glBindTexture(GL_TEXTURE_2D, walkLT->chunkTexture->handle.getGLName());
+               AllocatedTexture *lightTex = walkLT->chunkTexture;
+               AllocatedTexture *drawTex = lightTex;
+               if(!drawTex->handle && drawTex->blendJob)
+                  drawTex = findBlendFallback(lightTex);
+               if(!drawTex)
+                  drawTex = lightTex;
+
+               F32 invLevel = 1.0f / F32(mSquareSize << drawTex->level);
+               sgTexGenS.set(invLevel, 0.0f, 0.0f, -(lightTex->x >> drawTex->level));
+               sgTexGenT.set(0.0f, invLevel, 0.0f, -(lightTex->y >> drawTex->level));
+
+               glBindTexture(GL_TEXTURE_2D, drawTex->handle.getGLName());
             }
 
             glBegin(GL_TRIANGLES);
@@ -2357,7 +2409,506 @@ void TerrainRender::renderBlock(TerrainBlock *block, SceneState *state)
 
    FrameAllocator::setWaterMark(storedWaterMark);
    dglSetRenderPrimType(0);
+   mRenderingChunked = false;
+   PROFILE_END();
+   PROFILE_GPU_END();
+}
+
+
+
+//---------------------------------------------------------------
+
+//---------------------------------------------------------------
+// Chunked LOD
+//---------------------------------------------------------------
+
+namespace {
+
+/// Layout of a chunked LOD page buffer: the 65x65 grid points of the page,
+/// then the 16 skirt bottoms of each of its 16x16 chunks.
+enum ChunkPageLayout {
+   ChunkPageRowVerts   = TerrainBlock::ChunkPageSize + 1,
+   ChunkPageGridVerts  = ChunkPageRowVerts * ChunkPageRowVerts,
+   ChunkPageChunkWidth = TerrainBlock::ChunkPageSize >> TerrainBlock::ChunkDownShift,
+   ChunkGridVerts      = 25,
+   ChunkRingVerts      = 16,
+   ChunkPageVerts      = ChunkPageGridVerts + ChunkPageChunkWidth * ChunkPageChunkWidth * ChunkRingVerts,
+   ChunkMaxIndices     = 16 * 6 + 4 * 4 * 6
+};
+
+// The tables use chunk local vertex ids: 0-24 are the 5x5 grid of the chunk
+// (y * 5 + x) and 25-40 the skirt bottoms under the points of sgChunkRing.
+U8  sgChunkRing[ChunkRingVerts][2];    ///< Border points clockwise from the top left, seen from above.
+U8  sgChunkFullTris[16 * 6];           ///< Two triangles for each square, squares in y * 4 + x order.
+U8  sgChunkCoarseTris[8 * 3];          ///< Fan around the center.
+U8  sgChunkSkirtTris[2][4][4 * 6];     ///< By level then edge (top, right, bottom, left).
+U16 sgChunkGridOffset[ChunkGridVerts]; ///< Grid id to vertex offset in the page.
+
+inline U8 ringGrid(U32 k)
+{
+   return sgChunkRing[k & (ChunkRingVerts - 1)][1] * 5 + sgChunkRing[k & (ChunkRingVerts - 1)][0];
+}
+
+void buildChunkLightTris(EmitChunk *chunk, const U8 *tris, U32 count)
+{
+   U32 triCount = count / 3;
+   if(!triCount)
+      return;
+
+   Point3F points[ChunkGridVerts];
+   for(U32 i = 0; i < ChunkGridVerts; i++)
+   {
+      S32 x = chunk->x + (i % 5);
+      S32 y = chunk->y + (i / 5);
+      points[i].set(x * TerrainRender::mSquareSize, y * TerrainRender::mSquareSize,
+                    fixedToFloat(TerrainRender::mCurrentBlock->getHeight(x, y)));
+   }
+
+   for(U32 i = 0; i < 32; i++)
+   {
+      if((chunk->lightMask & (1 << i)) == 0)
+         continue;
+
+      LightTriangle* lightTris = (LightTriangle*)FrameAllocator::alloc(sizeof(LightTriangle) * triCount);
+      U32 j;
+      for(j = 0; j < (triCount-1); j++)
+         lightTris[j].next = &lightTris[j+1];
+      lightTris[triCount-1].next = sgCurrLightTris;
+      sgCurrLightTris = lightTris;
+
+      for(j = 0; j < triCount; j++)
+      {
+         lightTris[j].point1 = points[tris[j * 3 + 0]];
+         lightTris[j].point2 = points[tris[j * 3 + 1]];
+         lightTris[j].point3 = points[tris[j * 3 + 2]];
+         lightTris[j].chunkTexture = chunk->chunkTexture;
+
+         buildLightTri(&lightTris[j], &TerrainRender::mTerrainLights[i]);
+      }
+   }
+}
+
+} // namespace {}
+
+void TerrainRender::initChunkTables()
+{
+   U32 i, x, y;
+
+   for(i = 0; i < 4; i++)
+   {
+      sgChunkRing[i][0]      = i;
+      sgChunkRing[i][1]      = 4;
+      sgChunkRing[i + 4][0]  = 4;
+      sgChunkRing[i + 4][1]  = 4 - i;
+      sgChunkRing[i + 8][0]  = 4 - i;
+      sgChunkRing[i + 8][1]  = 0;
+      sgChunkRing[i + 12][0] = 0;
+      sgChunkRing[i + 12][1] = i;
+   }
+
+   for(i = 0; i < ChunkGridVerts; i++)
+      sgChunkGridOffset[i] = (i / 5) * ChunkPageRowVerts + (i % 5);
+
+   // Split every square through its odd corner, which gives the same
+   // triangles as the fans renderChunkOutline() draws for a full chunk.
+   // Everything is clockwise seen from above, as the terrain is culled.
+   U8 *tri = sgChunkFullTris;
+   for(y = 0; y < 4; y++)
+   {
+      for(x = 0; x < 4; x++)
+      {
+         U8 bl = y * 5 + x;
+         U8 br = bl + 1;
+         U8 tl = bl + 5;
+         U8 tr = bl + 6;
+         if(((x + y) & 1) == 0)
+         {
+            tri[0] = tl; tri[1] = tr; tri[2] = bl;
+            tri[3] = bl; tri[4] = tr; tri[5] = br;
+         }
+         else
+         {
+            tri[0] = tl; tri[1] = tr; tri[2] = br;
+            tri[3] = tl; tri[4] = br; tri[5] = bl;
+         }
+         tri += 6;
+      }
+   }
+
+   for(i = 0; i < 8; i++)
+   {
+      sgChunkCoarseTris[i * 3 + 0] = 12;
+      sgChunkCoarseTris[i * 3 + 1] = ringGrid(i * 2);
+      sgChunkCoarseTris[i * 3 + 2] = ringGrid(i * 2 + 2);
+   }
+
+   // A skirt segment from border point a to the next one b faces out of
+   // the chunk, a' and b' being the points under them.
+   for(U32 lod = 0; lod < 2; lod++)
+   {
+      U32 step = 1 << lod;
+      for(U32 e = 0; e < 4; e++)
+      {
+         tri = sgChunkSkirtTris[lod][e];
+         for(i = e * 4; i < e * 4 + 4; i += step)
+         {
+            U32 next = (i + step) & (ChunkRingVerts - 1);
+            tri[0] = ringGrid(i);
+            tri[1] = ChunkGridVerts + next;
+            tri[2] = ringGrid(next);
+            tri[3] = ringGrid(i);
+            tri[4] = ChunkGridVerts + i;
+            tri[5] = ChunkGridVerts + next;
+            tri += 6;
+         }
+      }
+   }
+}
+
+U32 TerrainRender::getChunkLOD(EmitChunk *chunk)
+{
+   // the center fan can't leave holes out
+   return (chunk->subDivLevel >= 1 && !chunk->emptyFlags) ? 1 : 0;
+}
+
+void TerrainRender::subdivideChunkedSquare(SquareStackNode *n)
+{
+   Point2I pos = n->pos;
+   S32 squareHalfSize = (1 << n->level) >> 1;
+
+   n->level--;
+   for(S32 i = 1; i < 4; i++)
+   {
+      n[i].level = n->level;
+      n[i].clipFlags = n->clipFlags;
+      n[i].lightMask = n->lightMask;
+      n[i].texAllocated = n->texAllocated;
+   }
+   // push in reverse order of processing.
+   n[3].pos = pos;
+   n[2].pos.set(pos.x + squareHalfSize, pos.y);
+   n[1].pos.set(pos.x, pos.y + squareHalfSize);
+   n[0].pos.set(pos.x + squareHalfSize, pos.y + squareHalfSize);
+}
+
+void TerrainRender::resolveChunkSkirts()
+{
+   static const S32 dx[4] = { 0, 1, 0, -1 };
+   static const S32 dy[4] = { 1, 0, -1, 0 };
+   const S32 chunkMask = TerrainBlock::ChunkSquareWidth - 1;
+
+   for(EmitChunk *chunk = mChunkEmitList; chunk; chunk = chunk->nextEmit)
+   {
+      S32 cx = chunk->gridX >> TerrainBlock::ChunkDownShift;
+      S32 cy = chunk->gridY >> TerrainBlock::ChunkDownShift;
+      U8 lod = mChunkLOD[cx + (cy << TerrainBlock::ChunkShift)];
+
+      for(U32 e = 0; e < 4; e++)
+      {
+         S32 nx = cx + dx[e];
+         S32 ny = cy + dy[e];
+         if(nx < 0 || ny < 0 || nx > chunkMask || ny > chunkMask)
+         {
+            // the neighbor is in another copy of the block, which picks
+            // its own levels
+            if(mCurrentBlock->mTile)
+               chunk->skirtMask |= 1 << e;
+            continue;
+         }
+
+         // neighbors that weren't emitted are culled, so the edge can't be seen
+         U32 index = nx + (ny << TerrainBlock::ChunkShift);
+         if(mChunkStamp[index] == mChunkStampIndex && mChunkLOD[index] != lod)
+            chunk->skirtMask |= 1 << e;
+      }
+   }
+   mChunkEmitList = NULL;
+}
+
+U32 TerrainRender::buildChunkPage(TerrainBlock *block, U32 page)
+{
+   PROFILE_START(TerrainRenderBuildChunkPage);
+
+   U32 waterMark = FrameAllocator::getWaterMark();
+   Point3F *verts = (Point3F *) FrameAllocator::alloc(sizeof(Point3F) * ChunkPageVerts);
+
+   S32 pageX = (page % TerrainBlock::ChunkPageWidth) << TerrainBlock::ChunkPageShift;
+   S32 pageY = (page / TerrainBlock::ChunkPageWidth) << TerrainBlock::ChunkPageShift;
+   F32 squareSize = F32(block->getSquareSize());
+
+   // positions are in the space of the block, a tiled copy is translated
+   Point3F *vert = verts;
+   S32 x, y;
+   for(y = 0; y < ChunkPageRowVerts; y++)
+      for(x = 0; x < ChunkPageRowVerts; x++, vert++)
+         vert->set((pageX + x) * squareSize, (pageY + y) * squareSize,
+                   fixedToFloat(block->getHeight(pageX + x, pageY + y)));
+
+   // The skirts only have to reach down past the crack to the edge of a
+   // neighbor at the other level, and the edge midpoints are part of the
+   // first level deviance.
+   for(y = 0; y < ChunkPageChunkWidth; y++)
+   {
+      for(x = 0; x < ChunkPageChunkWidth; x++)
+      {
+         GridChunk *gc = block->findChunk(Point2I(pageX + (x << TerrainBlock::ChunkDownShift),
+                                                  pageY + (y << TerrainBlock::ChunkDownShift)));
+         F32 depth = fixedToFloat(gc->heightDeviance[0]) + squareSize * 0.0625f;
+         const Point3F *grid = verts + (y << TerrainBlock::ChunkDownShift) * ChunkPageRowVerts + (x << TerrainBlock::ChunkDownShift);
+
+         for(U32 k = 0; k < ChunkRingVerts; k++, vert++)
+         {
+            *vert = grid[sgChunkGridOffset[ringGrid(k)]];
+            vert->z -= depth;
+         }
+      }
+   }
+   AssertFatal(vert == verts + ChunkPageVerts, "TerrainRender::buildChunkPage: bad page layout");
+
+   GLuint buffer;
+   glGenBuffersARB(1, &buffer);
+   glBindBufferARB(GL_ARRAY_BUFFER_ARB, buffer);
+   glBufferDataARB(GL_ARRAY_BUFFER_ARB, sizeof(Point3F) * ChunkPageVerts, verts, GL_STATIC_DRAW_ARB);
+
+   FrameAllocator::setWaterMark(waterMark);
    PROFILE_END();
+   return buffer;
+}
+
+void TerrainRender::beginChunkedRender(U32 fogUnit)
+{
+   // The haze coordinates come from texgen: the height is linear in z
+   // already, and the eye depth stands in for the distance to the camera
+   // that constructPoint() uses.
+   F32 s0, t0, s1, t1;
+   gClientSceneGraph->getFogCoordPair(0.0f, 0.0f, s0, t0);
+   gClientSceneGraph->getFogCoordPair(1.0f, 1.0f, s1, t1);
+   Point4F fogS(0.0f, 0.0f, s0 - s1, s0);
+   Point4F fogT(0.0f, 0.0f, t1 - t0, t0);
+
+   glActiveTextureARB(GL_TEXTURE0_ARB + fogUnit);
+   glClientActiveTextureARB(GL_TEXTURE0_ARB + fogUnit);
+   glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+   glTexGeni(GL_S, GL_TEXTURE_GEN_MODE, GL_EYE_LINEAR);
+   glTexGeni(GL_T, GL_TEXTURE_GEN_MODE, GL_OBJECT_LINEAR);
+   glMatrixMode(GL_MODELVIEW);
+   glPushMatrix();
+   glLoadIdentity();
+   glTexGenfv(GL_S, GL_EYE_PLANE, fogS);
+   glPopMatrix();
+   glTexGenfv(GL_T, GL_OBJECT_PLANE, fogT);
+   glEnable(GL_TEXTURE_GEN_S);
+   glEnable(GL_TEXTURE_GEN_T);
+
+   glActiveTextureARB(GL_TEXTURE0_ARB);
+   glClientActiveTextureARB(GL_TEXTURE0_ARB);
+   glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+   glTexGeni(GL_S, GL_TEXTURE_GEN_MODE, GL_OBJECT_LINEAR);
+   glTexGeni(GL_T, GL_TEXTURE_GEN_MODE, GL_OBJECT_LINEAR);
+   glEnable(GL_TEXTURE_GEN_S);
+   glEnable(GL_TEXTURE_GEN_T);
+}
+
+void TerrainRender::endChunkedRender(U32 fogUnit)
+{
+   glActiveTextureARB(GL_TEXTURE0_ARB + fogUnit);
+   glDisable(GL_TEXTURE_GEN_S);
+   glDisable(GL_TEXTURE_GEN_T);
+
+   glActiveTextureARB(GL_TEXTURE0_ARB);
+   glDisable(GL_TEXTURE_GEN_S);
+   glDisable(GL_TEXTURE_GEN_T);
+
+   glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+}
+
+void TerrainRender::renderChunkList(AllocatedTexture *step, TextureHandle &handle, bool blendedlighting,
+                                    const Point4F &detTexGenS, const Point4F &detTexGenT, F32 zeroDetailDistance)
+{
+   EmitChunk *chunk = step->list;
+   if(!chunk)
+      return;
+
+   PROFILE_START(TerrainRenderChunked);
+
+   // all the chunks of a texture square are in one page of one copy of the block
+   U32 page = (chunk->gridX >> TerrainBlock::ChunkPageShift) +
+              (chunk->gridY >> TerrainBlock::ChunkPageShift) * TerrainBlock::ChunkPageWidth;
+   if(!mCurrentBlock->mChunkBuffers[page])
+      mCurrentBlock->mChunkBuffers[page] = buildChunkPage(mCurrentBlock, page);
+   else
+      glBindBufferARB(GL_ARRAY_BUFFER_ARB, mCurrentBlock->mChunkBuffers[page]);
+   glVertexPointer(3, GL_FLOAT, sizeof(Point3F), NULL);
+
+   Point2F offset(F32((chunk->x - chunk->gridX) * mSquareSize), F32((chunk->y - chunk->gridY) * mSquareSize));
+
+   U32 chunkCount = 0;
+   EmitChunk *walk;
+   for(walk = chunk; walk; walk = walk->next)
+      chunkCount++;
+
+   U16 *indices = (U16 *) FrameAllocator::alloc(sizeof(U16) * ChunkMaxIndices * chunkCount);
+   U16 *detailIndices = (U16 *) FrameAllocator::alloc(sizeof(U16) * 16 * 6 * chunkCount);
+   U32 indexCount = 0;
+   U32 detailCount = 0;
+
+   U8 tris[16 * 6];
+   for(walk = chunk; walk; walk = walk->next)
+   {
+      U32 lod = getChunkLOD(walk);
+      U32 count = 0;
+      U32 i;
+      if(lod)
+      {
+         dMemcpy(tris, sgChunkCoarseTris, sizeof(sgChunkCoarseTris));
+         count = sizeof(sgChunkCoarseTris);
+      }
+      else
+      {
+         for(i = 0; i < 16; i++)
+         {
+            if(walk->emptyFlags & (1 << i))
+               continue;
+            dMemcpy(tris + count, sgChunkFullTris + i * 6, 6);
+            count += 6;
+         }
+      }
+
+      S32 localX = walk->gridX & (TerrainBlock::ChunkPageSize - 1);
+      S32 localY = walk->gridY & (TerrainBlock::ChunkPageSize - 1);
+      U16 gridBase = localY * ChunkPageRowVerts + localX;
+      U16 skirtBase = ChunkPageGridVerts + ((localY >> TerrainBlock::ChunkDownShift) * ChunkPageChunkWidth +
+                                            (localX >> TerrainBlock::ChunkDownShift)) * ChunkRingVerts;
+
+      U16 *start = indices + indexCount;
+      for(i = 0; i < count; i++)
+         indices[indexCount++] = gridBase + sgChunkGridOffset[tris[i]];
+
+      if(walk->renderDetails && mEnableTerrainDetails)
+      {
+         dMemcpy(detailIndices + detailCount, start, sizeof(U16) * count);
+         detailCount += count;
+      }
+
+      if(walk->skirtMask)
+      {
+         U32 skirtCount = 4 * 6 >> lod;
+         for(U32 e = 0; e < 4; e++)
+         {
+            if(!(walk->skirtMask & (1 << e)))
+               continue;
+            const U8 *skirt = sgChunkSkirtTris[lod][e];
+            for(i = 0; i < skirtCount; i++)
+            {
+               if(skirt[i] < ChunkGridVerts)
+                  indices[indexCount++] = gridBase + sgChunkGridOffset[skirt[i]];
+               else
+                  indices[indexCount++] = skirtBase + skirt[i] - ChunkGridVerts;
+            }
+         }
+      }
+
+      if(mEnableTerrainDynLights && walk->lightMask)
+         buildChunkLightTris(walk, tris, count);
+   }
+   AssertFatal(indexCount <= ChunkMaxIndices * chunkCount, "TerrainRender::renderChunkList: index overrun");
+
+   if(indexCount)
+   {
+      glPushMatrix();
+      glTranslatef(offset.x, offset.y, 0.0f);
+
+      // the texgen planes are for the untranslated block
+      Point4F texGenS = sgTexGenS;
+      Point4F texGenT = sgTexGenT;
+      texGenS.w += texGenS.x * offset.x;
+      texGenT.w += texGenT.y * offset.y;
+
+      if(blendedlighting)
+      {
+         glActiveTextureARB(GL_TEXTURE1_ARB);
+         glEnable(GL_TEXTURE_2D);
+         glBindTexture(GL_TEXTURE_2D, mCurrentBlock->lightMapTexture.getGLName());
+
+         LightManager::sgSetupExposureRendering();
+
+         glEnable(GL_TEXTURE_GEN_S);
+         glEnable(GL_TEXTURE_GEN_T);
+         glTexGeni(GL_S, GL_TEXTURE_GEN_MODE, GL_OBJECT_LINEAR);
+         glTexGeni(GL_T, GL_TEXTURE_GEN_MODE, GL_OBJECT_LINEAR);
+
+         F32 lmOffset = 1.0f / F32(mCurrentBlock->getSquareSize() * TerrainBlock::BlockSize);
+         glTexGenfv(GL_S, GL_OBJECT_PLANE, Point4F(lmOffset, 0.0f, 0.0f, 0.0f));
+         glTexGenfv(GL_T, GL_OBJECT_PLANE, Point4F(0.0f, lmOffset, 0.0f, 0.0f));
+
+         glActiveTextureARB(GL_TEXTURE2_ARB);
+         glEnable(GL_TEXTURE_2D);
+
+         glActiveTextureARB(GL_TEXTURE0_ARB);
+      }
+
+      glBindTexture(GL_TEXTURE_2D, handle.getGLName());
+      glTexGenfv(GL_S, GL_OBJECT_PLANE, texGenS);
+      glTexGenfv(GL_T, GL_OBJECT_PLANE, texGenT);
+      STAT_INC(DrawCalls);
+      glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_SHORT, indices);
+
+      if(blendedlighting)
+      {
+         glActiveTextureARB(GL_TEXTURE1_ARB);
+         glDisable(GL_TEXTURE_GEN_S);
+         glDisable(GL_TEXTURE_GEN_T);
+
+         LightManager::sgResetExposureRendering();
+
+         glActiveTextureARB(GL_TEXTURE2_ARB);
+         glDisable(GL_TEXTURE_2D);
+
+         glActiveTextureARB(GL_TEXTURE0_ARB);
+      }
+
+      if(detailCount && mCurrentBlock->mDetailTextureHandle.getGLName() != 0)
+      {
+         PROFILE_START(TerrainRenderChunkedDetails);
+         texGenS = detTexGenS;
+         texGenT = detTexGenT;
+         texGenS.w += texGenS.x * offset.x;
+         texGenT.w += texGenT.y * offset.y;
+
+         glBindTexture(GL_TEXTURE_2D, mCurrentBlock->mDetailTextureHandle.getGLName());
+         glTexGenfv(GL_S, GL_OBJECT_PLANE, texGenS);
+         glTexGenfv(GL_T, GL_OBJECT_PLANE, texGenT);
+
+         // Fade the detail out to neutral gray over zeroDetailDistance with
+         // linear fog, in place of the per vertex colors of the other path.
+         const F32 gray[4] = {0.5f, 0.5f, 0.5f, 0.5f};
+         if(dglDoesSupportFogCoord())
+            glFogi(GL_FOG_COORDINATE_SOURCE_EXT, GL_FRAGMENT_DEPTH_EXT);
+         glFogi(GL_FOG_MODE, GL_LINEAR);
+         glFogfv(GL_FOG_COLOR, gray);
+         glFogf(GL_FOG_START, 0.0f);
+         glFogf(GL_FOG_END, zeroDetailDistance);
+         glEnable(GL_FOG);
+
+         glEnable(GL_BLEND);
+         glBlendFunc(GL_DST_COLOR, GL_SRC_COLOR);
+
+         glActiveTextureARB(GL_TEXTURE1_ARB);
+         glDisable(GL_TEXTURE_2D);
+         STAT_INC(DrawCalls);
+         glDrawElements(GL_TRIANGLES, detailCount, GL_UNSIGNED_SHORT, detailIndices);
+         glEnable(GL_TEXTURE_2D);
+         glActiveTextureARB(GL_TEXTURE0_ARB);
+
+         glDisable(GL_FOG);
+         glDisable(GL_BLEND);
+         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+         PROFILE_END();
+      }
+
+      glPopMatrix();
+   }
+
    PROFILE_END();
 }
 
@@ -2371,6 +2922,8 @@ void TerrainRender::renderBlock(TerrainBlock *block, SceneState *state)
 
 void TerrainRender::flushCache()
 {
+   finishBlendJobs();
+
    for(S32 i = 0; i < AllocatedTextureCount; i++)
       mTextureGrid[i] = 0;
 
@@ -2393,26 +2946,66 @@ void TerrainRender::flushCache()
 
 void TerrainRender::flushCacheRect(RectI bRect)
 {
+   // Only the grid slots over the rect, which is in block squares and may
+   // wrap.  All the copies of a square share its slot.
    bRect.inset(-1,-1);
+   for(S32 level = 2; level <= 6; level++)
+   {
+      S32 slots = TerrainBlock::BlockSize >> level;
+      S32 x0 = bRect.point.x >> level;
+      S32 y0 = bRect.point.y >> level;
+      S32 x1 = getMin((bRect.point.x + bRect.extent.x - 1) >> level, x0 + slots - 1);
+      S32 y1 = getMin((bRect.point.y + bRect.extent.y - 1) >> level, y0 + slots - 1);
+
+      AllocatedTexture **grid = mTextureGridPtr[level - 2];
+      for(S32 y = y0; y <= y1; y++)
+      {
+         for(S32 x = x0; x <= x1; x++)
+         {
+            S32 index = (x & (slots - 1)) + ((y & (slots - 1)) << (8 - level));
+            AllocatedTexture *tex = grid[index];
+            if(!tex)
+               continue;
+            grid[index] = NULL;
+            tex->unlink();
+            freeTerrTexture(tex);
+         }
+      }
+   }
+}
+
+void TerrainRender::flushBlock(TerrainBlock *block)
+{
    for(S32 i = 0; i < AllocatedTextureCount; i++)
    {
       AllocatedTexture *tex = mTextureGrid[i];
-      if(!tex)
-         continue;
-      RectI texRect(tex->x, tex->y, 1 << tex->level, 1 << tex->level);
-      if(texRect.intersect(bRect))
+      if(tex && tex->block == block)
       {
          mTextureGrid[i] = NULL;
          tex->unlink();
          freeTerrTexture(tex);
       }
    }
+
+   // copies chained off a grid slot aren't in the grid
+   AllocatedTexture *walk = mTextureFreeListHead.next;
+   while(walk != &mTextureFreeListTail)
+   {
+      AllocatedTexture *next = walk->next;
+      if(walk->block == block)
+      {
+         walk->unlink();
+         freeTerrTexture(walk);
+      }
+      walk = next;
+   }
 }
 
 //---------------------------------------------------------------
 
 void TerrainRender::freeTerrTexture(AllocatedTexture *texture)
 {
+   cancelBlendJob(texture);
    if(texture->handle)
    {
       mTextureFreeList.increment();
@@ -2450,15 +3043,16 @@ void TerrainRender::allocTerrTexture(Point2I pos, U32 level, U32 mipLevel, bool
       cur->y = y;
       cur->level = level;
       cur->nextLink = NULL;
+      cur->block = mCurrentBlock;
    }
    else
    {
       AssertFatal(cur->level == level, "Invalid block for this level.");
-      if(cur->list && (cur->x != x || cur->y != y))
+      if(cur->list && (cur->x != x || cur->y != y || cur->block != mCurrentBlock))
       {
          // see if the texture is already in the list...
          AllocatedTexture *walk = cur->nextLink;
-         while(walk && walk->x != x && walk->y != y)
+         while(walk && (walk->block != mCurrentBlock || (walk->x != x && walk->y != y)))
             walk = walk->nextLink;
          if(walk)
          {
@@ -2470,6 +3064,7 @@ void TerrainRender::allocTerrTexture(Point2I pos, U32 level, U32 mipLevel, bool
          tail->x = x;
          tail->y = y;
          tail->level = level;
+         tail->block = mCurrentBlock;
          tail->nextLink = cur->nextLink;
          tail->distance = distance;
          cur->nextLink = tail;
@@ -2478,6 +3073,19 @@ void TerrainRender::allocTerrTexture(Point2I pos, U32 level, U32 mipLevel, bool
       }
       else
       {
+         // a texture from another page is no good here
+         if(cur->block != mCurrentBlock)
+         {
+            cancelBlendJob(cur);
+            if(cur->handle)
+            {
+               mTextureFreeList.increment();
+               constructInPlace(&mTextureFreeList.last());
+               mTextureFreeList.last() = cur->handle;
+               cur->handle = NULL;
+            }
+            cur->block = mCurrentBlock;
+         }
          cur->x = x;
          cur->y = y;
          cur->unlink();
@@ -2525,26 +3133,8 @@ static inline void fixcolors(GBitmap* bmp)
 #endif
 }
 
-void TerrainRender::buildBlendMap(AllocatedTexture *tex)
+GBitmap *TerrainRender::getBlendLightmap()
 {
-   PROFILE_START(TerrainRenderBuildBlendMap);
-   GBitmap *bmp = mBlendBitmap;
-   S32 x = tex->x;
-   S32 y = tex->y;
-   S32 level = tex->level;
-
-   AssertFatal(mCurrentBlock->lightMap->getFormat() == GBitmap::RGB5551, "Error, lightmap must be 5551");
-   AssertFatal(bmp->getFormat() == GBitmap::RGB5551, "Error, destination must be 565");
-   AssertFatal(bmp->getWidth() == TerrainTextureSize && bmp->getHeight() == TerrainTextureSize, avar("Error, bitmaps must be %d high and wide for the terrain", TerrainTextureSize));
-   AssertFatal(mCurrentBlock->lightMap->getWidth() == 512 && mCurrentBlock->lightMap->getHeight() == 512,
-               "Fast blender requires a 512 lightmap!");
-
-   U16* mips[TerrainTextureMipLevel + 1];
-   for (U32 i = 0; i < bmp->getNumMipLevels(); i++)
-      mips[i] = (U16*)bmp->getWritableBits(i);
-
-
-   GBitmap *lightmap = NULL;
    if(LightManager::sgAllowBlendedTerrainDynamicLighting())
    {
 	   if(!mCurrentBlock->whiteMap)
@@ -2590,29 +3180,279 @@ void TerrainRender::buildBlendMap(AllocatedTexture *tex)
 		   mCurrentBlock->lightMapTexture = TextureHandle(NULL, lm);
 	   }
 
-	   lightmap = mCurrentBlock->whiteMap;
-   }
-   else
-   {
-	   lightmap = mCurrentBlock->lightMap;
+	   return mCurrentBlock->whiteMap;
    }
 
+   return mCurrentBlock->lightMap;
+}
 
-   mCurrentBlock->mBlender->blend(x, y, level, (const U16*)lightmap->getBits(), mips);
-
-   fixcolors(bmp);
-   
+void TerrainRender::uploadBlendMap(AllocatedTexture *tex, GBitmap *bmp)
+{
    mDynamicTextureCount++;
    if(mTextureFreeList.size())
    {
       tex->handle = mTextureFreeList.last();
       mTextureFreeList.last() = NULL;
       mTextureFreeList.decrement();
-      tex->handle.refresh(mBlendBitmap);
+      tex->handle.refresh(bmp);
    }
    else
    {
-      tex->handle = TextureHandle((const char*)NULL, mBlendBitmap, TerrainTexture, true);
+      tex->handle = TextureHandle((const char*)NULL, bmp, TerrainTexture, true);
+   }
+}
+
+void TerrainRender::buildBlendMap(AllocatedTexture *tex)
+{
+   PROFILE_START(TerrainRenderBuildBlendMap);
+   GBitmap *bmp = mBlendBitmap;
+   S32 x = tex->x;
+   S32 y = tex->y;
+   S32 level = tex->level;
+
+   AssertFatal(mCurrentBlock->lightMap->getFormat() == GBitmap::RGB5551, "Error, lightmap must be 5551");
+   AssertFatal(bmp->getFormat() == GBitmap::RGB5551, "Error, destination must be 565");
+   AssertFatal(bmp->getWidth() == TerrainTextureSize && bmp->getHeight() == TerrainTextureSize, avar("Error, bitmaps must be %d high and wide for the terrain", TerrainTextureSize));
+   AssertFatal(mCurrentBlock->lightMap->getWidth() == 512 && mCurrentBlock->lightMap->getHeight() == 512,
+               "Fast blender requires a 512 lightmap!");
+
+   U16* mips[TerrainTextureMipLevel + 1];
+   for (U32 i = 0; i < bmp->getNumMipLevels(); i++)
+      mips[i] = (U16*)bmp->getWritableBits(i);
+
+
+   GBitmap *lightmap = getBlendLightmap();
+   mCurrentBlock->mBlender->blend(x, y, level, (const U16*)lightmap->getBits(), mips);
+
+   fixcolors(bmp);
+   uploadBlendMap(tex, bmp);
+   PROFILE_END();
+}
+
+//---------------------------------------------------------------
+// Asynchronous blending
+//---------------------------------------------------------------
+
+/// One texture blended on a worker thread.  The job only reads the block's
+/// Blender and grid and the lightmap, and writes its own bitmap; the
+/// texture it was requested for is only touched on the main thread.
+struct TerrainBlendJob : public ThreadPool::WorkItem
+{
+   TerrainBlock     *block;
+   AllocatedTexture *texture;    ///< NULL once the texture is freed.
+   const U16        *lightmap;
+   S32               x, y;
+   U32               level;
+
+   GBitmap          *bitmap;     ///< 5551 result with mips, kept with the job.
+   ThreadPool::Counter done;
+
+   TerrainBlendJob()
+   {
+      block = NULL;
+      texture = NULL;
+      lightmap = NULL;
+      x = y = 0;
+      level = 0;
+      bitmap = NULL;
+   }
+
+   ~TerrainBlendJob()
+   {
+      delete bitmap;
+   }
+
+   void process()
+   {
+      PROFILE_START(TerrainBlendJob);
+      U16* mips[TerrainTextureMipLevel + 1];
+      for (U32 i = 0; i < bitmap->getNumMipLevels(); i++)
+         mips[i] = (U16*)bitmap->getWritableBits(i);
+
+      // Scratch space from this worker's own frame allocator.
+      FrameTemp<U32> buffer(Blender::getBlendBufferSize());
+      block->mBlender->blendThreadSafe(x, y, level, lightmap, mips, buffer, block);
+      fixcolors(bitmap);
+      PROFILE_END();
+   }
+};
+
+static S32 QSORT_CALLBACK cmpBlendJobNearest(const void *a, const void *b)
+{
+   F32 da = (*(TerrainBlendJob **) a)->texture->distance;
+   F32 db = (*(TerrainBlendJob **) b)->texture->distance;
+   return (da < db) ? -1 : ((da > db) ? 1 : 0);
+}
+
+static S32 QSORT_CALLBACK cmpBlendJobFarthest(const void *a, const void *b)
+{
+   return cmpBlendJobNearest(b, a);
+}
+
+AllocatedTexture *TerrainRender::findBlendFallback(AllocatedTexture *tex)
+{
+   // Any cached texture for the same spot in the block will do, the
+   // terrain repeats.
+   S32 x = tex->x & TerrainBlock::BlockMask;
+   S32 y = tex->y & TerrainBlock::BlockMask;
+
+   for(U32 level = tex->level + 1; level <= 6; level++)
+   {
+      AllocatedTexture *cur = mTextureGridPtr[level - 2][(x >> level) + ((y >> level) << (8 - level))];
+      if(cur && cur->handle && cur->block == tex->block)
+         return cur;
+   }
+   return NULL;
+}
+
+AllocatedTexture *TerrainRender::requestBlendMap(AllocatedTexture *tex)
+{
+   AllocatedTexture *fallback = NULL;
+   if(mEnableAsyncBlend && !mRenderingCommander && gThreadPool && gThreadPool->isThreaded())
+      fallback = findBlendFallback(tex);
+
+   if(!fallback)
+   {
+      cancelBlendJob(tex);
+      return NULL;
+   }
+
+   if(!tex->blendJob)
+   {
+      TerrainBlendJob *job;
+      if(mFreeBlendJobs.size())
+      {
+         job = mFreeBlendJobs.last();
+         mFreeBlendJobs.decrement();
+      }
+      else
+         job = new TerrainBlendJob;
+
+      job->block = mCurrentBlock;
+      job->texture = tex;
+      job->lightmap = (const U16*)getBlendLightmap()->getBits();
+      job->x = tex->x;
+      job->y = tex->y;
+      job->level = tex->level;
+
+      tex->blendJob = job;
+      mBlendRequests.push_back(job);
+   }
+   return fallback;
+}
+
+void TerrainRender::cancelBlendJob(AllocatedTexture *tex)
+{
+   // The job is recycled by updateBlendJobs() once it isn't running.
+   if(tex->blendJob)
+   {
+      tex->blendJob->texture = NULL;
+      tex->blendJob = NULL;
+   }
+}
+
+void TerrainRender::updateBlendJobs()
+{
+   if(!mBlendJobs.size() && !mBlendRequests.size())
+   {
+      mPendingBlendCount = 0;
+      return;
+   }
+
+   PROFILE_START(TerrainRenderUpdateBlendJobs);
+
+   // Upload the finished blends, nearest first, while there's time left.
+   Vector<TerrainBlendJob *> finished;
+   S32 i;
+   for(i = 0; i < mBlendJobs.size(); )
+   {
+      TerrainBlendJob *job = mBlendJobs[i];
+      if(!job->done.isDone())
+      {
+         i++;
+         continue;
+      }
+      mBlendJobs.erase_fast(i);
+      if(job->texture)
+         finished.push_back(job);
+      else
+         mFreeBlendJobs.push_back(job);
+   }
+
+   if(finished.size())
+   {
+      dQsort(finished.address(), finished.size(), sizeof(TerrainBlendJob *), cmpBlendJobNearest);
+
+      U32 startTime = Platform::getRealMilliseconds();
+      for(i = 0; i < finished.size(); i++)
+      {
+         TerrainBlendJob *job = finished[i];
+         if(i && Platform::getRealMilliseconds() - startTime >= U32(mBlendUploadTime))
+            break;
+
+         uploadBlendMap(job->texture, job->bitmap);
+         job->texture->blendJob = NULL;
+         job->texture = NULL;
+         mFreeBlendJobs.push_back(job);
+      }
+      // the rest wait for the next frame
+      for(; i < finished.size(); i++)
+         mBlendJobs.push_back(finished[i]);
+   }
+
+   // Start the nearest requests.
+   for(i = 0; i < mBlendRequests.size(); )
+   {
+      if(mBlendRequests[i]->texture)
+         i++;
+      else
+      {
+         mFreeBlendJobs.push_back(mBlendRequests[i]);
+         mBlendRequests.erase_fast(i);
+      }
    }
+
+   S32 maxJobs = getMax(mMaxBlendJobs, 1);
+   if(mBlendRequests.size() && mBlendJobs.size() < maxJobs)
+   {
+      dQsort(mBlendRequests.address(), mBlendRequests.size(), sizeof(TerrainBlendJob *), cmpBlendJobFarthest);
+      while(mBlendRequests.size() && mBlendJobs.size() < maxJobs)
+      {
+         TerrainBlendJob *job = mBlendRequests.last();
+         mBlendRequests.decrement();
+
+         if(!job->bitmap)
+            job->bitmap = new GBitmap(TerrainTextureSize, TerrainTextureSize, true, GBitmap::RGB5551);
+         mBlendJobs.push_back(job);
+         gThreadPool->queueWorkItem(job, &job->done);
+      }
+   }
+
+   mPendingBlendCount = mBlendJobs.size() + mBlendRequests.size();
    PROFILE_END();
 }
+
+void TerrainRender::finishBlendJobs()
+{
+   S32 i;
+   for(i = 0; i < mBlendRequests.size(); i++)
+   {
+      TerrainBlendJob *job = mBlendRequests[i];
+      if(job->texture)
+         cancelBlendJob(job->texture);
+      mFreeBlendJobs.push_back(job);
+   }
+   mBlendRequests.clear();
+
+   for(i = 0; i < mBlendJobs.size(); i++)
+   {
+      TerrainBlendJob *job = mBlendJobs[i];
+      if(!job->done.isDone())
+         gThreadPool->waitForCounter(&job->done);
+      if(job->texture)
+         cancelBlendJob(job->texture);
+      mFreeBlendJobs.push_back(job);
+   }
+   mBlendJobs.clear();
+   mPendingBlendCount = 0;
+}
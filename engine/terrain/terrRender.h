@@ -17,6 +17,7 @@
 #endif
 
 struct EmitChunk;
+struct TerrainBlendJob;
 
 struct AllocatedTexture {
    U32 level;
@@ -28,10 +29,14 @@ struct AllocatedTexture {
    AllocatedTexture *previous;
    AllocatedTexture *nextLink;
    U32 mipLevel;
+   TerrainBlendJob *blendJob;   ///< Blend in progress for handle, if any.
+   TerrainBlock *block;         ///< Block handle was made for; pages share grid slots.
 
    AllocatedTexture()
    {
       next = previous = NULL;
+      blendJob = NULL;
+      block = NULL;
    }
    inline void unlink()
    {
@@ -112,6 +117,9 @@ struct EmitChunk
 	bool renderBumps;
 //CW - end bump mapping stuff
 	AllocatedTexture *chunkTexture;
+
+   U32 skirtMask;          ///< Chunked LOD: edges (top, right, bottom, left) needing a skirt.
+   EmitChunk *nextEmit;    ///< Chunked LOD: chunks emitted for the current block.
 };
 
 struct SquareStackNode2
@@ -259,6 +267,66 @@ struct TerrainRender
 
    static GBitmap* mBlendBitmap;
 
+   /// @name Chunked LOD
+   /// With $pref::Terrain::chunkedLOD on, the chunks picked by
+   /// processCurrentBlock() are drawn from static vertex buffers instead of
+   /// being rebuilt every frame.  Each buffer holds a 64x64 square page of
+   /// the block, built the first time the page is drawn, and a chunk comes
+   /// in two levels: the full 4x4 grid or the fan around its center that
+   /// the normal path uses when it isn't subdivided.  Cracks between levels
+   /// are covered with skirts hanging from the chunk edges.
+   /// @{
+
+   static bool mEnableChunkedLOD;
+   static bool mRenderingChunked;     ///< Chunked path is in use this frame.
+   static U32  mChunkStampIndex;      ///< Bumped for every processCurrentBlock().
+   static U32  mChunkStamp[TerrainBlock::ChunkSquareWidth * TerrainBlock::ChunkSquareWidth];
+   static U8   mChunkLOD[TerrainBlock::ChunkSquareWidth * TerrainBlock::ChunkSquareWidth];
+   static EmitChunk *mChunkEmitList;
+
+   static void initChunkTables();
+   static U32  getChunkLOD(EmitChunk *chunk);
+   static void subdivideChunkedSquare(SquareStackNode *n);
+   static void resolveChunkSkirts();
+   static U32  buildChunkPage(TerrainBlock *block, U32 page);
+   static void beginChunkedRender(U32 fogUnit);
+   static void endChunkedRender(U32 fogUnit);
+   static void renderChunkList(AllocatedTexture *step, TextureHandle &handle, bool blendedlighting,
+                               const Point4F &detTexGenS, const Point4F &detTexGenT, F32 zeroDetailDistance);
+   /// @}
+
+   /// @name Asynchronous blending
+   /// With $pref::Terrain::asyncBlend on and a threaded gThreadPool, a
+   /// texture that isn't cached is blended by a worker job instead of in the
+   /// middle of the frame.  Requests are started nearest first, at most
+   /// $pref::Terrain::maxBlendJobs at a time, and until the result is back
+   /// the square is drawn with the cached texture of a larger square that
+   /// covers it.  Finished blends are uploaded at the start of renderBlock(),
+   /// nearest first, until $pref::Terrain::blendUploadTime milliseconds have
+   /// gone by.  A square with nothing to fall back on is still blended
+   /// right away.
+   /// @{
+
+   static bool mEnableAsyncBlend;
+   static S32  mMaxBlendJobs;
+   static S32  mBlendUploadTime;
+   static S32  mPendingBlendCount;                 ///< $T2::pendingBlendCount
+   static Vector<TerrainBlendJob*> mBlendRequests; ///< Waiting to be started.
+   static Vector<TerrainBlendJob*> mBlendJobs;     ///< Queued on gThreadPool.
+   static Vector<TerrainBlendJob*> mFreeBlendJobs;
+
+   /// Returns the texture to draw tex with while its blend is pending, or
+   /// NULL if it has to be blended now.
+   static AllocatedTexture *requestBlendMap(AllocatedTexture *tex);
+   static AllocatedTexture *findBlendFallback(AllocatedTexture *tex);
+   static void cancelBlendJob(AllocatedTexture *tex);
+   static void updateBlendJobs();
+
+   /// Waits for all the running blends and drops every request.  Must be
+   /// called before anything a job reads (the Blender, lightmaps) goes away.
+   static void finishBlendJobs();
+   /// @}
+
    static void init();
    static void shutdown();
 
@@ -281,10 +349,14 @@ struct TerrainRender
 
    static void flushCache();
    static void flushCacheRect(RectI rect);
+   /// Frees the textures of a block that is going away.
+   static void flushBlock(TerrainBlock *block);
 
    static void allocTerrTexture(Point2I pos, U32 level, U32 mipLevel, bool vis, F32 distance);
    static void freeTerrTexture(AllocatedTexture *texture);
    static void buildBlendMap(AllocatedTexture *texture);
+   static GBitmap *getBlendLightmap();
+   static void uploadBlendMap(AllocatedTexture *texture, GBitmap *bmp);
 
    static U32 TestSquareLights(GridSquare *sq, S32 level, Point2I pos, U32 lightMask);
    static S32 TestSquareVisibility(Point3F &min, Point3F &max, S32 clipMask, F32 expand);
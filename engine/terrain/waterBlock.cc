@@ -511,7 +511,7 @@ bool WaterBlock::prepRenderImage( SceneState* state,
    //  don't need to return a specialized RenderImage...
    if (state->isObjectRendered(this))
    {
-      SceneRenderImage* image = new SceneRenderImage;
+      SceneRenderImage* image = SceneState::newRenderImage<SceneRenderImage>();
       image->obj = this;
       image->isTranslucent = true;
 
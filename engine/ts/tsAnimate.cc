@@ -843,9 +843,10 @@ void TSShapeInstance::animate(S32 dl)
    if (dirtyFlags & IflDirty)
       animateIfls();
 
-   // animate nodes?
-   if (dirtyFlags & TransformDirty)
-      animateNodes(ss);
+   // animate nodes?  keep them dirty if animation LOD puts it off
+   U32 stillDirty = 0;
+   if ((dirtyFlags & TransformDirty) && !updateNodes(dl,ss))
+      stillDirty = TransformDirty;
 
    // animate objects?
    if (dirtyFlags & VisDirty)
@@ -859,7 +860,169 @@ void TSShapeInstance::animate(S32 dl)
    if (dirtyFlags & DecalDirty)
       animateDecals(ss);
 
-   mDirtyFlags[ss] = 0;
+   mDirtyFlags[ss] = stillDirty;
+}
+
+//-------------------------------------------------------------------------------------
+// Animation LOD
+//-------------------------------------------------------------------------------------
+
+static inline U32 hashPose(U32 hash, U32 val)
+{
+   return (hash ^ val) * 16777619;
+}
+
+static inline U32 hashPose(U32 hash, F32 val)
+{
+   union { F32 f; U32 u; } bits;
+   bits.f = val;
+   return hashPose(hash,bits.u);
+}
+
+U32 TSShapeInstance::getPoseHash()
+{
+   // these get changed from outside the threads, so we never know
+   if (mHandsOffNodes.start()<MAX_TS_SET_SIZE || mCallbackNodes.start()<MAX_TS_SET_SIZE)
+      return 0;
+
+   U32 hash = hashPose(2166136261U,U32(mThreadList.size()));
+   for (S32 i=0; i<mThreadList.size(); i++)
+   {
+      const TSThread * th = mThreadList[i];
+      hash = hashPose(hash,U32(th->sequence - mShape->sequences.address()));
+      hash = hashPose(hash,U32(th->keyNum1));
+      hash = hashPose(hash,U32(th->keyNum2));
+      hash = hashPose(hash,th->keyPos);
+      hash = hashPose(hash,U32(th->blendDisabled));
+      if (th->transitionData.inTransition)
+      {
+         hash = hashPose(hash,th->transitionData.pos);
+         hash = hashPose(hash,U32(th->transitionData.oldSequence));
+      }
+   }
+   return hash ? hash : 1;
+}
+
+U32 TSShapeInstance::getAnimLODInterval(S32 dl)
+{
+   if (!mAnimationLOD || smAnimLODMaxInterval<=0 || smAnimLODPixelSize<=0.0f || scaleCurrentlyAnimated())
+      return 0;
+
+   // collision and los details have negative sizes
+   F32 size = mShape->details[dl].size;
+   if (size<0.0f || size>=smAnimLODPixelSize)
+      return 0;
+
+   return U32(smAnimLODMaxInterval * (1.0f - size/smAnimLODPixelSize));
+}
+
+bool TSShapeInstance::updateNodes(S32 dl, S32 ss)
+{
+   U32 hash = getPoseHash();
+   U32 interval = hash ? getAnimLODInterval(dl) : 0;
+
+   if (interval==0)
+   {
+      // every frame, but only if something moved.  A blend still under way
+      // is finished first, since an unchanged hash won't animate over it.
+      if (mAnimLOD)
+      {
+         if (mAnimLOD->subShape>=0 && mAnimLOD->blending)
+            blendAnimLODPose(mAnimLOD->subShape,1.0f);
+         mAnimLOD->subShape = -1;
+         mAnimLOD->blending = false;
+      }
+      if (!hash || hash!=mPoseHashes[ss])
+      {
+         animateNodes(ss);
+         mPoseHashes[ss] = hash;
+      }
+      return true;
+   }
+
+   if (!mAnimLOD)
+      mAnimLOD = new AnimLODData;
+   AnimLODData & lod = *mAnimLOD;
+   U32 now = Platform::getVirtualMilliseconds();
+
+   if (lod.subShape!=ss)
+   {
+      // just got small enough, start from the current pose
+      animateNodes(ss);
+      mPoseHashes[ss] = hash;
+      saveAnimLODPose(ss,1);
+      lod.subShape   = ss;
+      lod.lastUpdate = now;
+      lod.interval   = interval;
+      lod.blending   = false;
+      return true;
+   }
+
+   if (now - lod.lastUpdate >= lod.interval)
+   {
+      if (hash==mPoseHashes[ss])
+      {
+         // stopped moving, finish up at the last pose
+         if (lod.blending)
+            blendAnimLODPose(ss,1.0f);
+         lod.blending = false;
+         return true;
+      }
+
+      lod.rotations[0].setSize(lod.rotations[1].size());
+      lod.translations[0].setSize(lod.translations[1].size());
+      dMemcpy(lod.rotations[0].address(),lod.rotations[1].address(),lod.rotations[1].size()*sizeof(QuatF));
+      dMemcpy(lod.translations[0].address(),lod.translations[1].address(),lod.translations[1].size()*sizeof(Point3F));
+      animateNodes(ss);
+      mPoseHashes[ss] = hash;
+      saveAnimLODPose(ss,1);
+      lod.lastUpdate = now;
+      lod.interval   = interval;
+      lod.blending   = smAnimLODInterpolate;
+      if (!lod.blending)
+         return true;
+   }
+   else if (!lod.blending)
+      return false;
+
+   blendAnimLODPose(ss,F32(now - lod.lastUpdate) / F32(lod.interval));
+   return false;
+}
+
+void TSShapeInstance::saveAnimLODPose(S32 ss, S32 which)
+{
+   S32 a = mShape->subShapeFirstNode[ss];
+   S32 b = a + mShape->subShapeNumNodes[ss];
+   Vector<QuatF> & rots = mAnimLOD->rotations[which];
+   Vector<Point3F> & trans = mAnimLOD->translations[which];
+   rots.setSize(mShape->nodes.size());
+   trans.setSize(mShape->nodes.size());
+   for (S32 i=a; i<b; i++)
+   {
+      rots[i].set(mNodeTransforms[i]);
+      mNodeTransforms[i].getColumn(3,&trans[i]);
+   }
+}
+
+void TSShapeInstance::blendAnimLODPose(S32 ss, F32 t)
+{
+   t = mClampF(t,0.0f,1.0f);
+
+   S32 a = mShape->subShapeFirstNode[ss];
+   S32 b = a + mShape->subShapeNumNodes[ss];
+   const AnimLODData & lod = *mAnimLOD;
+   if (lod.rotations[0].size()<b)
+      return;
+
+   // the nodes are in shape space, so each one can be blended on its own
+   QuatF q;
+   Point3F p;
+   for (S32 i=a; i<b; i++)
+   {
+      TSTransform::interpolate(lod.rotations[0][i],lod.rotations[1][i],t,&q);
+      TSTransform::interpolate(lod.translations[0][i],lod.translations[1][i],t,&p);
+      TSTransform::setMatrix(q,p,&mNodeTransforms[i]);
+   }
 }
 
 void TSShapeInstance::animateNodeSubtrees(bool forceFull)
@@ -876,8 +1039,13 @@ void TSShapeInstance::animateNodeSubtrees(bool forceFull)
       {
          animateNodes(i);
          mDirtyFlags[i] &= ~TransformDirty;
+         mPoseHashes[i] = 0;
       }
    }
+
+   // whatever animation LOD had saved is out of date now
+   if (mAnimLOD)
+      mAnimLOD->subShape = -1;
 }
 
 void TSShapeInstance::animateSubtrees(bool forceFull)
@@ -885,8 +1053,11 @@ void TSShapeInstance::animateSubtrees(bool forceFull)
    // animate all the subtrees
 
    if (forceFull)
+   {
       // force full animate
       setDirty(AllDirtyMask);
+      dMemset(mPoseHashes,0,mShape->subShapeFirstNode.size()*sizeof(U32));
+   }
 
    for (S32 i=0; i<mShape->details.size(); i++)
    {
@@ -1042,6 +1213,7 @@ void TSShapeInstance::setNodeAnimationState(S32 nodeIndex, U32 animationState)
 
    // feel so dirty...
    setDirty(AllDirtyMask);
+   dMemset(mPoseHashes,0,mShape->subShapeFirstNode.size()*sizeof(U32));
 
    if (animationState & MaskNodeAllButBlend)
    {
@@ -0,0 +1,324 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "ts/tsImpostorAtlas.h"
+#include "dgl/dgl.h"
+#include "dgl/gBitmap.h"
+#include "console/console.h"
+#include "console/consoleTypes.h"
+#include "platform/profiler.h"
+
+Vector<TSImpostorAtlas::Page*> TSImpostorAtlas::smPages;
+bool   TSImpostorAtlas::smBatching = false;
+U32    TSImpostorAtlas::smNumQueued = 0;
+bool   TSImpostorAtlas::smFogged = false;
+ColorF TSImpostorAtlas::smFogColor(0, 0, 0, 1);
+
+S32  TSImpostorAtlas::smPageSize = 1024;
+bool TSImpostorAtlas::smBatchRender = true;
+
+/// Makes a square of mip level from the level above it, size texels on a
+/// side at level, starting at (x, y).  RGBA only.
+static void filterMip(GBitmap *bmp, U32 level, U32 x, U32 y, U32 size)
+{
+   for (U32 j = 0; j < size; j++)
+   {
+      const U8 *src0 = bmp->getAddress(x * 2, (y + j) * 2, level - 1);
+      const U8 *src1 = bmp->getAddress(x * 2, (y + j) * 2 + 1, level - 1);
+      U8 *dst = bmp->getAddress(x, y + j, level);
+      for (U32 i = 0; i < size; i++, src0 += 8, src1 += 8, dst += 4)
+         for (U32 c = 0; c < 4; c++)
+            dst[c] = U8((U32(src0[c]) + src0[c + 4] + src1[c] + src1[c + 4] + 2) >> 2);
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+void TSImpostorAtlas::init()
+{
+   Con::addVariable("$pref::TS::impostorPageSize", TypeS32,  &smPageSize);
+   Con::addVariable("$pref::TS::batchImpostors",   TypeBool, &smBatchRender);
+}
+
+void TSImpostorAtlas::destroy()
+{
+   for (S32 i = 0; i < smPages.size(); i++)
+      deletePage(smPages[i]);
+   smPages.clear();
+}
+
+void TSImpostorAtlas::deletePage(Page *page)
+{
+   if (!page)
+      return;
+
+   // The texture owns the bitmap once there is one.
+   if (!page->handle.isValid())
+      delete page->bitmap;
+   delete page;
+}
+
+S32 TSImpostorAtlas::findPage(U32 cellSize)
+{
+   S32 empty = -1;
+   for (S32 i = 0; i < smPages.size(); i++)
+   {
+      if (!smPages[i])
+         empty = i;
+      else if (smPages[i]->cellSize == cellSize && smPages[i]->freeCells.size())
+         return i;
+   }
+
+   U32 size = getMax(getNextPow2(getMax(smPageSize, 64)), cellSize);
+   Page *page = new Page;
+   page->bitmap = new GBitmap(size, size, true, GBitmap::RGBA);
+   dMemset(page->bitmap->getWritableBits(0), 0, page->bitmap->byteSize);
+   page->cellSize = cellSize;
+   page->cellLevels = getBinLog2(cellSize) + 1;
+   page->numCells = 0;
+   page->dirty = true;
+
+   // Handed out from the back, so the first cells go at the start.
+   U32 perRow = size / cellSize;
+   for (U32 i = perRow * perRow; i-- > 0; )
+      page->freeCells.push_back(i);
+
+   if (empty == -1)
+   {
+      smPages.push_back(page);
+      return smPages.size() - 1;
+   }
+   smPages[empty] = page;
+   return empty;
+}
+
+void TSImpostorAtlas::updatePage(Page *page)
+{
+   if (!page->dirty)
+      return;
+
+   GBitmap *bmp = page->bitmap;
+   for (U32 level = page->cellLevels; level < bmp->getNumMipLevels(); level++)
+      filterMip(bmp, level, 0, 0, bmp->getWidth(level));
+
+   if (page->handle.isValid())
+      page->handle.refresh();
+   else
+      page->handle.set(NULL, (const GBitmap *) bmp, true);
+   page->dirty = false;
+}
+
+//-----------------------------------------------------------------------------
+
+bool TSImpostorAtlas::allocCell(const GBitmap *bmp, Cell &cell)
+{
+   cell.page = -1;
+   if (!bmp || bmp->getFormat() != GBitmap::RGBA || bmp->getWidth() != bmp->getHeight() ||
+       !isPow2(bmp->getWidth()))
+      return false;
+
+   U32 size = bmp->getWidth();
+   S32 index = findPage(size);
+   Page *page = smPages[index];
+
+   U32 slot = page->freeCells.last();
+   page->freeCells.pop_back();
+   page->numCells++;
+   page->dirty = true;
+
+   U32 perRow = page->bitmap->getWidth() / size;
+   cell.page = index;
+   cell.x = (slot % perRow) * size;
+   cell.y = (slot / perRow) * size;
+   cell.size = size;
+
+   // The cell's own mips where it has them, filtered down from them where it doesn't.
+   for (U32 level = 0; level < page->cellLevels; level++)
+   {
+      U32 levelSize = size >> level;
+      U32 x = cell.x >> level;
+      U32 y = cell.y >> level;
+      if (level >= bmp->getNumMipLevels())
+      {
+         filterMip(page->bitmap, level, x, y, levelSize);
+         continue;
+      }
+      for (U32 j = 0; j < levelSize; j++)
+         dMemcpy(page->bitmap->getAddress(x, y + j, level), bmp->getAddress(0, j, level), levelSize * 4);
+   }
+   return true;
+}
+
+void TSImpostorAtlas::freeCell(Cell &cell)
+{
+   if (cell.page < 0)
+      return;
+
+   Page *page = smPages[cell.page];
+   U32 perRow = page->bitmap->getWidth() / page->cellSize;
+   page->freeCells.push_back((cell.y / page->cellSize) * perRow + cell.x / page->cellSize);
+   if (--page->numCells == 0)
+   {
+      deletePage(page);
+      smPages[cell.page] = NULL;
+   }
+   cell.page = -1;
+}
+
+void TSImpostorAtlas::getTexCoords(const Cell &cell, Point2F *texCoords)
+{
+   // Half a texel in, so the filtering stays out of the next cell.
+   F32 inv = 1.0f / F32(smPages[cell.page]->bitmap->getWidth());
+   F32 u0 = (F32(cell.x) + 0.5f) * inv;
+   F32 u1 = (F32(cell.x + cell.size) - 0.5f) * inv;
+   F32 v0 = (F32(cell.y) + 0.5f) * inv;
+   F32 v1 = (F32(cell.y + cell.size) - 0.5f) * inv;
+   texCoords[0].set(u0, v1);
+   texCoords[1].set(u1, v1);
+   texCoords[2].set(u1, v0);
+   texCoords[3].set(u0, v0);
+}
+
+U32 TSImpostorAtlas::getGLName(const Cell &cell)
+{
+   Page *page = smPages[cell.page];
+   updatePage(page);
+   return page->handle.getGLName();
+}
+
+//-----------------------------------------------------------------------------
+
+void TSImpostorAtlas::beginBatch()
+{
+   AssertFatal(!smNumQueued, "TSImpostorAtlas::beginBatch: billboards left over from the last batch");
+   smBatching = true;
+}
+
+bool TSImpostorAtlas::canQueueFog(const ColorF &fogColor)
+{
+   if (!dglDoesSupportFogCoord())
+      return false;
+   return !smFogged || (smFogColor.red == fogColor.red &&
+                        smFogColor.green == fogColor.green &&
+                        smFogColor.blue == fogColor.blue);
+}
+
+void TSImpostorAtlas::queue(const Cell &cell, const Point3F *points, const ColorF &color,
+                            F32 fog, const ColorF &fogColor)
+{
+   AssertFatal(smBatching, "TSImpostorAtlas::queue: not batching");
+   if (fog > 0.0f && !smFogged)
+   {
+      smFogged = true;
+      smFogColor.set(fogColor.red, fogColor.green, fogColor.blue, 1.0f);
+   }
+
+   Point2F texCoords[4];
+   getTexCoords(cell, texCoords);
+   ColorF clamped = color;
+   clamped.clamp();
+   ColorI c = clamped;
+
+   Vector<Vertex> &verts = smPages[cell.page]->verts;
+   U32 first = verts.size();
+   verts.increment(4);
+   for (U32 i = 0; i < 4; i++)
+   {
+      Vertex &v = verts[first + i];
+      v.point = points[i];
+      v.texCoord = texCoords[i];
+      v.color = c;
+      v.fog = fog;
+   }
+   smNumQueued++;
+}
+
+void TSImpostorAtlas::endBatch()
+{
+   smBatching = false;
+   if (!smNumQueued)
+      return;
+
+   PROFILE_START(TSImpostorBatch);
+
+   // The corners are in camera space already.
+   glMatrixMode(GL_MODELVIEW);
+   glPushMatrix();
+   glLoadIdentity();
+
+   GLboolean wasLit = glIsEnabled(GL_LIGHTING);
+   GLboolean wasCulled = glIsEnabled(GL_CULL_FACE);
+   glDisable(GL_LIGHTING);
+   glDisable(GL_CULL_FACE);
+
+   glEnable(GL_BLEND);
+   glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
+   glDepthMask(GL_FALSE);
+   glEnable(GL_TEXTURE_2D);
+   glTexEnvi(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_MODULATE);
+
+   glEnableClientState(GL_VERTEX_ARRAY);
+   glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+   glEnableClientState(GL_COLOR_ARRAY);
+
+   // Fog coordinate f blends in f of the fog color, like the fog stage of
+   // TSLastDetail::renderFog_MultiCombine().
+   if (smFogged)
+   {
+      glEnable(GL_FOG);
+      glFogi(GL_FOG_COORDINATE_SOURCE_EXT, GL_FOG_COORDINATE_EXT);
+      glFogfv(GL_FOG_COLOR, smFogColor);
+      glFogi(GL_FOG_MODE, GL_LINEAR);
+      glFogf(GL_FOG_START, 0.0f);
+      glFogf(GL_FOG_END, 1.0f);
+      glEnableClientState(GL_FOG_COORDINATE_ARRAY_EXT);
+   }
+
+   for (S32 i = 0; i < smPages.size(); i++)
+   {
+      Page *page = smPages[i];
+      if (!page || page->verts.empty())
+         continue;
+
+      updatePage(page);
+      glBindTexture(GL_TEXTURE_2D, page->handle.getGLName());
+
+      const Vertex *verts = page->verts.address();
+      glVertexPointer  (3, GL_FLOAT,         sizeof(Vertex), &verts->point);
+      glTexCoordPointer(2, GL_FLOAT,         sizeof(Vertex), &verts->texCoord);
+      glColorPointer   (4, GL_UNSIGNED_BYTE, sizeof(Vertex), &verts->color);
+      if (smFogged)
+         glFogCoordPointerEXT(GL_FLOAT, sizeof(Vertex), (void *) &verts->fog);
+
+      glDrawArrays(GL_QUADS, 0, page->verts.size());
+      page->verts.clear();
+   }
+
+   if (smFogged)
+   {
+      glDisableClientState(GL_FOG_COORDINATE_ARRAY_EXT);
+      glFogi(GL_FOG_COORDINATE_SOURCE_EXT, GL_FRAGMENT_DEPTH_EXT);
+      glDisable(GL_FOG);
+   }
+
+   glDisableClientState(GL_COLOR_ARRAY);
+   glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+   glDisableClientState(GL_VERTEX_ARRAY);
+
+   glDepthMask(GL_TRUE);
+   glDisable(GL_BLEND);
+   glDisable(GL_TEXTURE_2D);
+   if (wasLit)
+      glEnable(GL_LIGHTING);
+   if (wasCulled)
+      glEnable(GL_CULL_FACE);
+
+   glPopMatrix();
+
+   smNumQueued = 0;
+   smFogged = false;
+
+   PROFILE_END();
+}
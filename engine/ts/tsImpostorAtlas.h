@@ -0,0 +1,113 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _TSIMPOSTORATLAS_H_
+#define _TSIMPOSTORATLAS_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
+#ifndef _MPOINT_H_
+#include "math/mPoint.h"
+#endif
+#ifndef _COLOR_H_
+#include "core/color.h"
+#endif
+#ifndef _GTEXMANAGER_H_
+#include "dgl/gTexManager.h"
+#endif
+
+class GBitmap;
+
+/// Shared texture pages for the views of every TSLastDetail.
+///
+/// Each view's snapshot is copied into a cell of a page, one page per cell
+/// size ($pref::TS::impostorPageSize square), mip levels and all.  The
+/// cells sit on a grid of their own size, so a cell's mips never pick up
+/// its neighbours until they're under a texel; those last levels are made
+/// from the page when it's next bound.
+///
+/// Between beginBatch() and endBatch() the billboards are queued on their
+/// page instead of drawn, with their corners in camera space and their
+/// lighting and fog worked out up front, and endBatch() draws each page's
+/// billboards with a single bind and draw call.  SceneState brackets its
+/// opaque images with these; anything drawn outside them, or that can't be
+/// expressed as a queued quad (override textures, dirty mode), is drawn
+/// right away by TSLastDetail on the page texture.
+class TSImpostorAtlas
+{
+  public:
+   /// Where a view lives.
+   struct Cell
+   {
+      S32 page;               ///< -1 if the view has no snapshot.
+      U16 x, y;               ///< Texels, in the page.
+      U16 size;
+   };
+
+  private:
+   struct Vertex
+   {
+      Point3F point;
+      Point2F texCoord;
+      ColorI  color;
+      F32     fog;
+   };
+
+   struct Page
+   {
+      TextureHandle handle;   ///< Owns bitmap.
+      GBitmap *bitmap;
+      U32 cellSize;
+      U32 cellLevels;         ///< Mip levels that come straight from the cells.
+      Vector<U16> freeCells;
+      U32 numCells;
+      bool dirty;             ///< Needs its small mips remade and uploading.
+      Vector<Vertex> verts;   ///< Queued quads.
+   };
+
+   static Vector<Page*> smPages;
+   static bool   smBatching;
+   static U32    smNumQueued;
+   static bool   smFogged;
+   static ColorF smFogColor;
+
+   static S32  findPage(U32 cellSize);
+   static void updatePage(Page *page);
+   static void deletePage(Page *page);
+
+  public:
+   static S32  smPageSize;       ///< $pref::TS::impostorPageSize
+   static bool smBatchRender;    ///< $pref::TS::batchImpostors
+
+   static void init();
+   static void destroy();
+
+   /// Copies bmp, a square pow2 RGBA snapshot, into a free cell.
+   static bool allocCell(const GBitmap *bmp, Cell &cell);
+   static void freeCell(Cell &cell);
+
+   /// Texture coordinates of the cell's corners, in TSLastDetail's order.
+   static void getTexCoords(const Cell &cell, Point2F *texCoords);
+   /// The page texture, brought up to date first.
+   static U32  getGLName(const Cell &cell);
+
+   static void beginBatch();
+   static void endBatch();
+   static bool isBatching() { return smBatching && smBatchRender; }
+
+   /// True if a billboard with this fog can go in the current batch.
+   static bool canQueueFog(const ColorF &fogColor);
+
+   /// Queues a billboard; points are the camera space corners.  fog is how
+   /// much of the fog color shows, 0 for none.
+   static void queue(const Cell &cell, const Point3F *points, const ColorF &color,
+                     F32 fog, const ColorF &fogColor);
+};
+
+#endif
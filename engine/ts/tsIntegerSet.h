@@ -22,6 +22,10 @@
 
 #define MAX_TS_SET_SIZE   (32*MAX_TS_SET_DWORDS)
 
+#if defined(TORQUE_COMPILER_VISUALC)
+#include <intrin.h>
+#endif
+
 class Stream;
 
 /// The standard mathmatical set, where there are no duplicates.  However,
@@ -31,6 +35,10 @@ class TSIntegerSet
    /// The bits!
    U32 bits[MAX_TS_SET_DWORDS];
 
+   /// Index of the lowest and highest set bit of a non-zero dword.
+   static S32 lowBit(U32 dword);
+   static S32 highBit(U32 dword);
+
 public:
 
    /// Sets this bit to false
@@ -61,9 +69,14 @@ public:
 
    void operator=(const TSIntegerSet& otherSet) { copy(otherSet); }
 
+   /// @name Iteration
+   /// for (i = set.start(); i < MAX_TS_SET_SIZE; set.next(i)) visits the
+   /// set bits in order, skipping empty dwords whole.
+   /// @{
    S32 start() const;
    S32 end() const;
    void next(S32 & i) const;
+   /// @}
 
    void read(Stream *);
    void write(Stream *);
@@ -93,4 +106,102 @@ inline bool TSIntegerSet::test(S32 index) const
    return ((bits[index>>5] & (1 << (index & 31)))!=0);
 }
 
+inline S32 TSIntegerSet::lowBit(U32 dword)
+{
+#if defined(TORQUE_COMPILER_VISUALC)
+   unsigned long index;
+   _BitScanForward(&index, dword);
+   return S32(index);
+#elif defined(TORQUE_COMPILER_GCC)
+   return __builtin_ctz(dword);
+#else
+   S32 index = 0;
+   while (!(dword & 1))
+   {
+      dword >>= 1;
+      index++;
+   }
+   return index;
+#endif
+}
+
+inline S32 TSIntegerSet::highBit(U32 dword)
+{
+#if defined(TORQUE_COMPILER_VISUALC)
+   unsigned long index;
+   _BitScanReverse(&index, dword);
+   return S32(index);
+#elif defined(TORQUE_COMPILER_GCC)
+   return 31 - __builtin_clz(dword);
+#else
+   S32 index = 31;
+   while (!(dword & 0x80000000))
+   {
+      dword <<= 1;
+      index--;
+   }
+   return index;
+#endif
+}
+
+// The set operations are a handful of dwords, left to the compiler to
+// unroll and vectorize.
+
+inline void TSIntegerSet::intersect(const TSIntegerSet & otherSet)
+{
+   for (S32 i=0; i<MAX_TS_SET_DWORDS; i++)
+      bits[i] &= otherSet.bits[i];
+}
+
+inline void TSIntegerSet::overlap(const TSIntegerSet & otherSet)
+{
+   for (S32 i=0; i<MAX_TS_SET_DWORDS; i++)
+      bits[i] |= otherSet.bits[i];
+}
+
+inline void TSIntegerSet::difference(const TSIntegerSet & otherSet)
+{
+   for (S32 i=0; i<MAX_TS_SET_DWORDS; i++)
+      bits[i] ^= otherSet.bits[i];
+}
+
+inline void TSIntegerSet::takeAway(const TSIntegerSet & otherSet)
+{
+   for (S32 i=0; i<MAX_TS_SET_DWORDS; i++)
+      bits[i] &= ~otherSet.bits[i];
+}
+
+inline S32 TSIntegerSet::start() const
+{
+   for (S32 i=0; i<MAX_TS_SET_DWORDS; i++)
+      if (bits[i])
+         return (i<<5) + lowBit(bits[i]);
+
+   return MAX_TS_SET_SIZE;
+}
+
+inline void TSIntegerSet::next(S32 & i) const
+{
+   i++;
+   S32 idx = i>>5;
+   if (idx>=MAX_TS_SET_DWORDS)
+   {
+      i = MAX_TS_SET_SIZE;
+      return;
+   }
+
+   // drop the bits below i, then find the next dword with any left
+   U32 dword = bits[idx] & ~((1 << (i&31)) - 1);
+   while (dword==0)
+   {
+      if (++idx>=MAX_TS_SET_DWORDS)
+      {
+         i = MAX_TS_SET_SIZE;
+         return;
+      }
+      dword = bits[idx];
+   }
+   i = (idx<<5) + lowBit(dword);
+}
+
 #endif
@@ -8,8 +8,15 @@
 #include "dgl/dgl.h"
 #include "ts/tsShape.h"
 #include "ts/tsShapeInstance.h"
+#include "core/fileStream.h"
+#include "core/resManager.h"
+#include "core/crc.h"
 
 bool TSLastDetail::smDirtyMode = false;
+bool TSLastDetail::smUseCache = true;
+
+static const U32 csCacheFileMagic = 0x42425354;    // "TSBB"
+static const U32 csCacheFileVersion = 1;
 
 Point2F TSLastDetail::smTVerts[4] = { Point2F(0,1),    Point2F(1,1),    Point2F(1,0),    Point2F(0,0) };
 Point3F TSLastDetail::smNorms[4]  = { Point3F(0,-1,0), Point3F(0,-1,0), Point3F(0,-1,0), Point3F(0,-1,0) };
@@ -21,65 +28,250 @@ TSLastDetail::TSLastDetail(TSShapeInstance * shape,
                            bool includePoles,
                            S32 dl, S32 dim)
 {
-   VECTOR_SET_ASSOCIATION(mBitmaps);
-   VECTOR_SET_ASSOCIATION(mTextures);
+   VECTOR_SET_ASSOCIATION(mCells);
+   VECTOR_SET_ASSOCIATION(mTexCoords);
 
    mNumEquatorSteps = numEquatorSteps;
    mNumPolarSteps = numPolarSteps;
    mPolarAngle = polarAngle;
    mIncludePoles = includePoles;
 
-   F32 equatorStepSize = M_2PI_F / (F32) numEquatorSteps;
-   F32 polarStepSize = numPolarSteps>0 ? (0.5f * M_PI_F - polarAngle) / (F32)numPolarSteps : 0.0f;
+   U32 numViews = numEquatorSteps * (2*numPolarSteps+1) + (includePoles ? 2 : 0);
+   Vector<GBitmap*> bitmaps;
+   char cacheName[1024];
+   U32 crc = 0;
+   bool useCache = smUseCache && getCacheName(shape, dl, dim, cacheName, sizeof(cacheName), crc);
+   if (!useCache || !readCache(cacheName, crc, dl, dim, numViews, bitmaps))
+   {
+      takeSnapshots(shape, dl, dim, bitmaps);
+      if (useCache)
+         writeCache(cacheName, crc, dl, dim, bitmaps);
+   }
+
+   // the atlas keeps its own copy
+   mCells.setSize(bitmaps.size());
+   mTexCoords.setSize(bitmaps.size() * 4);
+   for (S32 j=0; j<bitmaps.size(); j++)
+   {
+      // snapshot routine may refuse to give us a bitmap sometimes...
+      if (TSImpostorAtlas::allocCell(bitmaps[j],mCells[j]))
+         TSImpostorAtlas::getTexCoords(mCells[j],&mTexCoords[j*4]);
+      delete bitmaps[j];
+   }
+
+   mPoints[0].set(-shape->mShape->radius,0, shape->mShape->radius);
+   mPoints[1].set( shape->mShape->radius,0, shape->mShape->radius);
+   mPoints[2].set( shape->mShape->radius,0,-shape->mShape->radius);
+   mPoints[3].set(-shape->mShape->radius,0,-shape->mShape->radius);
+
+   mCenter = shape->mShape->center;
+}
+
+void TSLastDetail::takeSnapshots(TSShapeInstance * shape, S32 dl, S32 dim, Vector<GBitmap*> & bitmaps)
+{
+   F32 equatorStepSize = M_2PI_F / (F32) mNumEquatorSteps;
+   F32 polarStepSize = mNumPolarSteps>0 ? (0.5f * M_PI_F - mPolarAngle) / (F32)mNumPolarSteps : 0.0f;
 
    U32 i;
    F32 rotZ = 0;
-   for (i=0; i<numEquatorSteps; i++)
+   for (i=0; i<mNumEquatorSteps; i++)
    {
-      F32 rotX = numPolarSteps>0 ? polarAngle - 0.5f * M_PI_F : 0.0f;
-      for (U32 j=0; j<2*numPolarSteps+1; j++)
+      F32 rotX = mNumPolarSteps>0 ? mPolarAngle - 0.5f * M_PI_F : 0.0f;
+      for (U32 j=0; j<2*mNumPolarSteps+1; j++)
       {
          MatrixF angMat;
          angMat.mul(MatrixF(EulerF(0,0,-M_PI_F+rotZ)),MatrixF(EulerF(rotX,0,0)));
-	      mBitmaps.push_back(shape->snapshot(dim,dim,true,angMat,dl,1.0f,true));
+	      bitmaps.push_back(shape->snapshot(dim,dim,true,angMat,dl,1.0f,true));
          rotX += polarStepSize;
       }
       rotZ += equatorStepSize;
    }
 
-   if (includePoles)
+   if (mIncludePoles)
    {
       MatrixF m1( EulerF( M_PI_F / 2.0f, 0, 0 ) );
       MatrixF m2( EulerF( -M_PI_F / 2.0f, 0, 0 ) );
-      mBitmaps.push_back(shape->snapshot(dim,dim,true,m1,dl,1.0f,true));
-      mBitmaps.push_back(shape->snapshot(dim,dim,true,m2,dl,1.0f,true));
+      bitmaps.push_back(shape->snapshot(dim,dim,true,m1,dl,1.0f,true));
+      bitmaps.push_back(shape->snapshot(dim,dim,true,m2,dl,1.0f,true));
    }
+}
+
+TSLastDetail::~TSLastDetail()
+{
+   for (S32 i=0; i<mCells.size(); i++)
+      TSImpostorAtlas::freeCell(mCells[i]);
+}
 
-   mTextures.setSize(mBitmaps.size());
-   for (i=0; i<(U32)mBitmaps.size(); i++)
+//-------------------------------------------------------------------------------------
+// Snapshot cache
+//-------------------------------------------------------------------------------------
+
+bool TSLastDetail::getCacheName(TSShapeInstance * shape, S32 dl, S32 dim, char * buffer, U32 bufferSize, U32 & crc)
+{
+   const char * path = shape->hShape.getFilePath();
+   const char * name = shape->hShape.getFileName();
+   if (!path || !name)
+      return false;
+
+   char shapeName[1024];
+   dSprintf(shapeName,sizeof(shapeName),"%s/%s",path,name);
+   Stream * stream = ResourceManager->openStream(shapeName);
+   if (!stream)
+      return false;
+   crc = calculateCRCStream(stream);
+   ResourceManager->closeStream(stream);
+
+   dSprintf(buffer,bufferSize,"%s.bb%d_%d.imp",shapeName,dl,dim);
+   return true;
+}
+
+bool TSLastDetail::readCache(const char * fileName, U32 crc, S32 dl, S32 dim, U32 numViews, Vector<GBitmap*> & bitmaps)
+{
+   FileStream stream;
+   if (!stream.open(fileName,FileStream::Read))
+      return false;
+
+   U32 magic, version, fileCrc, numEquatorSteps, numPolarSteps, fileViews;
+   F32 polarAngle;
+   bool includePoles;
+   S32 fileDl, fileDim;
+   stream.read(&magic);
+   stream.read(&version);
+   stream.read(&fileCrc);
+   stream.read(&numEquatorSteps);
+   stream.read(&numPolarSteps);
+   stream.read(&polarAngle);
+   stream.read(&includePoles);
+   stream.read(&fileDl);
+   stream.read(&fileDim);
+   if (!stream.read(&fileViews) || magic != csCacheFileMagic || version != csCacheFileVersion ||
+       fileCrc != crc || numEquatorSteps != mNumEquatorSteps || numPolarSteps != mNumPolarSteps ||
+       polarAngle != mPolarAngle || includePoles != mIncludePoles ||
+       fileDl != dl || fileDim != dim || fileViews != numViews)
+      return false;
+
+   for (U32 i=0; i<numViews; i++)
    {
-      if (mBitmaps[i]) // snapshot routine may refuse to give us a bitmap sometimes...
-         mTextures[i] = new TextureHandle(NULL,mBitmaps[i],true);
-      else
-         mTextures[i] = NULL;
+      bool present;
+      if (!stream.read(&present))
+         break;
+      GBitmap * bmp = NULL;
+      if (present)
+      {
+         bmp = new GBitmap;
+         if (!bmp->read(stream) || bmp->getFormat() != GBitmap::RGBA || bmp->getWidth() != dim || bmp->getHeight() != dim)
+         {
+            delete bmp;
+            break;
+         }
+      }
+      bitmaps.push_back(bmp);
    }
 
-   mPoints[0].set(-shape->mShape->radius,0, shape->mShape->radius);
-   mPoints[1].set( shape->mShape->radius,0, shape->mShape->radius);
-   mPoints[2].set( shape->mShape->radius,0,-shape->mShape->radius);
-   mPoints[3].set(-shape->mShape->radius,0,-shape->mShape->radius);
+   if (bitmaps.size() == numViews && stream.getStatus() == Stream::Ok)
+      return true;
 
-   mCenter = shape->mShape->center;
+   for (S32 i=0; i<bitmaps.size(); i++)
+      delete bitmaps[i];
+   bitmaps.clear();
+   return false;
 }
 
-TSLastDetail::~TSLastDetail()
+void TSLastDetail::writeCache(const char * fileName, U32 crc, S32 dl, S32 dim, const Vector<GBitmap*> & bitmaps)
 {
-   for (S32 i=0; i<mTextures.size(); i++) {
-      delete mTextures[i];
-      mTextures[i] = NULL;
+   FileStream stream;
+   if (!ResourceManager->isValidWriteFileName(fileName) || !stream.open(fileName,FileStream::Write))
+      return;
+
+   stream.write(csCacheFileMagic);
+   stream.write(csCacheFileVersion);
+   stream.write(crc);
+   stream.write(mNumEquatorSteps);
+   stream.write(mNumPolarSteps);
+   stream.write(mPolarAngle);
+   stream.write(mIncludePoles);
+   stream.write(dl);
+   stream.write(dim);
+   stream.write(U32(bitmaps.size()));
+   for (S32 i=0; i<bitmaps.size(); i++)
+   {
+      stream.write(bitmaps[i] != NULL);
+      if (bitmaps[i])
+         bitmaps[i]->write(stream);
    }
+}
+
+//-------------------------------------------------------------------------------------
+// Render methods
+//-------------------------------------------------------------------------------------
 
-   // mBitmaps...owned by mTextures
+const Point2F * TSLastDetail::getTexCoords() const
+{
+   return TSShapeInstance::smRenderData.useOverride ? smTVerts : &mTexCoords[mBitmapIndex*4];
+}
+
+/// What the fixed function lighting makes of the billboard's white material at
+/// the camera space point p, facing the camera, with the lights set up now.
+static ColorF getLitColor(const Point3F & p, F32 alpha)
+{
+   if (!glIsEnabled(GL_LIGHTING))
+      return ColorF(1,1,1,1);
+
+   F32 v[4];
+   glGetMaterialfv(GL_FRONT,GL_EMISSION,v);
+   ColorF color(v[0],v[1],v[2]);
+   glGetFloatv(GL_LIGHT_MODEL_AMBIENT,v);
+   color += ColorF(v[0],v[1],v[2]);
+
+   const Point3F normal(0,-1,0);
+   for (U32 i=0; i<8; i++)
+   {
+      GLenum light = GL_LIGHT0 + i;
+      if (!glIsEnabled(light))
+         continue;
+
+      F32 pos[4], ambient[4], diffuse[4];
+      glGetLightfv(light,GL_POSITION,pos);
+      glGetLightfv(light,GL_AMBIENT,ambient);
+      glGetLightfv(light,GL_DIFFUSE,diffuse);
+
+      Point3F dir(pos[0],pos[1],pos[2]);
+      F32 atten = 1.0f;
+      if (pos[3] != 0.0f)
+      {
+         dir -= p;
+         F32 dist = dir.len();
+         F32 k0, k1, k2, cutoff;
+         glGetLightfv(light,GL_CONSTANT_ATTENUATION,&k0);
+         glGetLightfv(light,GL_LINEAR_ATTENUATION,&k1);
+         glGetLightfv(light,GL_QUADRATIC_ATTENUATION,&k2);
+         F32 denom = k0 + k1 * dist + k2 * dist * dist;
+         atten = denom > 0.0f ? 1.0f / denom : 1.0f;
+
+         glGetLightfv(light,GL_SPOT_CUTOFF,&cutoff);
+         if (cutoff != 180.0f)
+         {
+            F32 spotDir[3], exponent;
+            glGetLightfv(light,GL_SPOT_DIRECTION,spotDir);
+            glGetLightfv(light,GL_SPOT_EXPONENT,&exponent);
+            Point3F axis(spotDir[0],spotDir[1],spotDir[2]);
+            axis.normalizeSafe();
+            F32 spot = dist > 0.0f ? -mDot(dir,axis) / dist : 1.0f;
+            if (spot < mCos(mDegToRad(cutoff)))
+               continue;
+            atten *= mPow(getMax(spot,0.0f),exponent);
+         }
+      }
+      dir.normalizeSafe();
+
+      F32 diffuseAmount = getMax(mDot(normal,dir),0.0f);
+      color.red   += atten * (ambient[0] + diffuse[0] * diffuseAmount);
+      color.green += atten * (ambient[1] + diffuse[1] * diffuseAmount);
+      color.blue  += atten * (ambient[2] + diffuse[2] * diffuseAmount);
+   }
+
+   color.alpha = alpha;
+   return color;
 }
 
 void TSLastDetail::chooseView(const MatrixF & mat, const Point3F & scale)
@@ -136,13 +328,11 @@ void TSLastDetail::chooseView(const MatrixF & mat, const Point3F & scale)
    }
 
    // make sure we dont get invalid bitmap index!
-   mBitmapIndex = mClamp(mBitmapIndex, 0, mTextures.size()-1);
+   mBitmapIndex = mClamp(mBitmapIndex, 0, mCells.size()-1);
 }
 
 void TSLastDetail::render(F32 alpha, bool drawFog)
 {
-   glPushMatrix();
-
    // get camera matrix, adjust for shape center
    MatrixF mat;
    Point3F p,center;
@@ -155,6 +345,11 @@ void TSLastDetail::render(F32 alpha, bool drawFog)
    Point3F ones( 1, 1, 1 );
    chooseView(mat,ones);
 
+   const TSImpostorAtlas::Cell & cell = mCells[mBitmapIndex];
+   bool useOverride = TSShapeInstance::smRenderData.useOverride;
+   if (cell.page < 0 && !useOverride)
+      return;
+
    // following is a quicker version of mat.set(EulerF(0,rotY,0));
    // note:  we assume mat[12]=1 and mat[3]=mat[7]=mat[11]=0 to start with
    F32 * m = (F32*)mat;  // because [] operator isn't implemented on MatrixF, so it finds mat[0] ambiguous (const)
@@ -172,6 +367,27 @@ void TSLastDetail::render(F32 alpha, bool drawFog)
       m[1] = m[2] = m[4] = m[6] = m[8] = m[9] = 0.0f;
    }
 
+   // queue it for the atlas page if we can, with the lighting and fog worked out here
+   if (TSImpostorAtlas::isBatching() && !smDirtyMode && !useOverride)
+   {
+      const Point4F & fog = TSShapeInstance::smRenderData.fogColor;
+      ColorF fogColor(fog.x,fog.y,fog.z);
+      if (!drawFog || TSImpostorAtlas::canQueueFog(fogColor))
+      {
+         Point3F points[4];
+         for (U32 i=0; i<4; i++)
+         {
+            points[i] = mPoints[i];
+            if (TSShapeInstance::smRenderData.objectScale)
+               points[i].convolve(*TSShapeInstance::smRenderData.objectScale);
+            mat.mulP(points[i]);
+         }
+         TSImpostorAtlas::queue(cell,points,getLitColor(p,alpha),drawFog ? fog.w : 0.0f,fogColor);
+         return;
+      }
+   }
+
+   glPushMatrix();
    dglLoadMatrix(&mat);
    if (TSShapeInstance::smRenderData.objectScale)
       glScalef(
@@ -203,7 +419,7 @@ void TSLastDetail::renderNoFog(F32 alpha)
    glEnableClientState(GL_NORMAL_ARRAY);
    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
    glVertexPointer  (3, GL_FLOAT, 0, mPoints);
-   glTexCoordPointer(2, GL_FLOAT, 0, smTVerts);
+   glTexCoordPointer(2, GL_FLOAT, 0, getTexCoords());
    glNormalPointer  (   GL_FLOAT, 0, smNorms);
 
    // light the material
@@ -218,7 +434,7 @@ void TSLastDetail::renderNoFog(F32 alpha)
    glEnable(GL_TEXTURE_2D);
 
    if (TSShapeInstance::smRenderData.useOverride == false)
-      glBindTexture(GL_TEXTURE_2D, mTextures[mBitmapIndex]->getGLName());
+      glBindTexture(GL_TEXTURE_2D, TSImpostorAtlas::getGLName(mCells[mBitmapIndex]));
    else
       glBindTexture(GL_TEXTURE_2D, TSShapeInstance::smRenderData.override.getGLName());
 
@@ -249,7 +465,7 @@ void TSLastDetail::renderFog_Combine(F32 alpha)
    glEnableClientState(GL_NORMAL_ARRAY);
    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
    glVertexPointer  (3, GL_FLOAT, 0, mPoints);
-   glTexCoordPointer(2, GL_FLOAT, 0, smTVerts);
+   glTexCoordPointer(2, GL_FLOAT, 0, getTexCoords());
    glNormalPointer  (   GL_FLOAT, 0, smNorms);
 
    // light the material
@@ -264,7 +480,7 @@ void TSLastDetail::renderFog_Combine(F32 alpha)
    // texture
    glEnable(GL_TEXTURE_2D);
    if (TSShapeInstance::smRenderData.useOverride == false)
-      glBindTexture(GL_TEXTURE_2D, mTextures[mBitmapIndex]->getGLName());
+      glBindTexture(GL_TEXTURE_2D, TSImpostorAtlas::getGLName(mCells[mBitmapIndex]));
    else
       glBindTexture(GL_TEXTURE_2D, TSShapeInstance::smRenderData.override.getGLName());
 
@@ -317,7 +533,7 @@ void TSLastDetail::renderFog_MultiCombine(F32 alpha)
    glEnableClientState(GL_NORMAL_ARRAY);
    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
    glVertexPointer  (3,GL_FLOAT, 0, mPoints);
-   glTexCoordPointer(2,GL_FLOAT, 0, smTVerts);
+   glTexCoordPointer(2,GL_FLOAT, 0, getTexCoords());
    glNormalPointer  (  GL_FLOAT, 0, smNorms);
 
    // set color state
@@ -327,7 +543,7 @@ void TSLastDetail::renderFog_MultiCombine(F32 alpha)
    // first TE applies lighting to billboard texture
    glEnable(GL_TEXTURE_2D);
    if (TSShapeInstance::smRenderData.useOverride == false)
-      glBindTexture(GL_TEXTURE_2D, mTextures[mBitmapIndex]->getGLName());
+      glBindTexture(GL_TEXTURE_2D, TSImpostorAtlas::getGLName(mCells[mBitmapIndex]));
    else
       glBindTexture(GL_TEXTURE_2D, TSShapeInstance::smRenderData.override.getGLName());
    glTexEnvi(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_MODULATE);
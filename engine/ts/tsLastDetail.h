@@ -18,17 +18,24 @@
 #ifndef _TVECTOR_H_
 #include "core/tVector.h"
 #endif
+#ifndef _TSIMPOSTORATLAS_H_
+#include "ts/tsImpostorAtlas.h"
+#endif
 
 class TSShape;
 class TSShapeInstance;
 class GBitmap;
-class TextureHandle;
 
 /// This neat little class renders the object to a texture so that when the object
 /// is far away, it can be drawn as a billboard instead of a mesh.  This happens
 /// when the model is first loaded as to keep the realtime render as fast as possible.
 /// It also renders the model from a few different perspectives so that it would actually
 /// pass as a model instead of a silly old billboard.
+///
+/// The views go into the shared pages of TSImpostorAtlas, and are kept next to the
+/// shape in a .imp file so the next load doesn't have to render them again.  The
+/// file is checked against the shape's CRC and the billboard settings; material
+/// changes alone aren't noticed, delete the file to have it remade.
 class TSLastDetail
 {
    U32 mNumEquatorSteps; ///< number steps around the equator of the globe
@@ -42,13 +49,20 @@ class TSLastDetail
    U32 mBitmapIndex;
    F32 mRotY;
 
-   Vector<GBitmap*> mBitmaps;       ///< Rendered bitmaps
-   Vector<TextureHandle*> mTextures;///< Texture handles for those bitmaps
+   Vector<TSImpostorAtlas::Cell> mCells;  ///< Where each view is in the atlas
+   Vector<Point2F> mTexCoords;            ///< Four per view, for mCells
 
    Point3F mPoints[4];   ///< always draw poly defined by these points...
    static Point3F smNorms[4];
    static Point2F smTVerts[4];
 
+   const Point2F * getTexCoords() const;
+   void takeSnapshots(TSShapeInstance * shape, S32 dl, S32 dim, Vector<GBitmap*> & bitmaps);
+
+   static bool getCacheName(TSShapeInstance * shape, S32 dl, S32 dim, char * buffer, U32 bufferSize, U32 & crc);
+   bool readCache(const char * fileName, U32 crc, S32 dl, S32 dim, U32 numViews, Vector<GBitmap*> & bitmaps);
+   void writeCache(const char * fileName, U32 crc, S32 dl, S32 dim, const Vector<GBitmap*> & bitmaps);
+
    public:
 
     /// This indicates that the TSLastDetail need neither clear nor set gl render states.
@@ -56,6 +70,9 @@ class TSLastDetail
    /// If you're doing a more complex renderer this is a useful trick.
    static bool smDirtyMode;
 
+   /// $pref::TS::impostorCache, read and write the .imp files.
+   static bool smUseCache;
+
    TSLastDetail(TSShapeInstance * shape, U32 numEquatorSteps, U32 numPolarSteps, F32 polarAngle, bool includePoles, S32 dl, S32 dim);
    ~TSLastDetail();
 
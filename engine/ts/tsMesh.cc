@@ -9,6 +9,8 @@
 #include "math/mathIO.h"
 #include "ts/tsShape.h"
 #include "console/console.h"
+#include "console/consoleTypes.h"
+#include "dgl/gTexManager.h"
 #include "ts/tsShapeInstance.h"
 #include "sim/sceneObject.h"
 #include "ts/tsSortedMesh.h"
@@ -16,6 +18,7 @@
 #include "collision/convex.h"
 #include "core/frameAllocator.h"
 #include "platform/profiler.h"
+#include "core/frameStats.h"
 
 // Not worth the effort, much less the effort to comment, but if the draw types
 // are consecutive use addition rather than a table to go from index to command value...
@@ -52,6 +55,7 @@ bool TSMesh::smUseTriangles = false; // convert all primitives to triangle lists
 bool TSMesh::smUseOneStrip  = false; // join triangle strips into one long strip on load
 S32  TSMesh::smMinStripSize = 1;     // smallest number of _faces_ allowed per strip (all else put in tri list)
 bool TSMesh::smUseEncodedNormals = false;
+bool TSMesh::smOptimizeVertexCache = false; // reorder triangle lists for the post-transform cache on load
 
 // quick function to force object to face camera -- currently throws out roll :(
 void forceFaceCamera()
@@ -266,6 +270,7 @@ void TSMesh::renderVB(S32 frame, S32 matFrame, TSMaterialList *materials)
       PROFILE_START(TSShapeInstanceDE);
       S32 drawType = getDrawType(draw.matIndex>>30);
 
+      STAT_INC(DrawCalls);
       glDrawElements(drawType,draw.numElements,GL_UNSIGNED_SHORT,&indices[draw.start]);
       PROFILE_END();
    }
@@ -283,9 +288,6 @@ void TSMesh::render(S32 frame, S32 matFrame, TSMaterialList * materials)
       return;
    }
 
-   S32 firstVert  = vertsPerFrame * frame;
-   S32 firstTVert = vertsPerFrame * matFrame;
-
    if (getFlags(Billboard))
    {
       if (getFlags(BillboardZAxis))
@@ -296,61 +298,270 @@ void TSMesh::render(S32 frame, S32 matFrame, TSMaterialList * materials)
 
    glEnable(GL_NORMALIZE);
 
-   const Point3F * normals = getNormals(firstVert);
    saveMergeNormals(); // verts & tverts saved and restored on tsshapeinstance::setStatics
 
    // set up vertex arrays -- already enabled in TSShapeInstance::render
-   glVertexPointer(3,GL_FLOAT,0,&verts[firstVert]);
-   glNormalPointer(GL_FLOAT,0,normals);
-   ToolVector<Point2F> diffuse;
-   getUVs(tDiffuse, diffuse);
-   glTexCoordPointer(2,GL_FLOAT,0,&diffuse[firstTVert]);
-   if (TSShapeInstance::smRenderData.detailMapMethod == TSShapeInstance::DETAIL_MAP_MULTI_1 ||
-       TSShapeInstance::smRenderData.detailMapMethod == TSShapeInstance::DETAIL_MAP_MULTI_2)
+   bool usingBuffers = setupVertexArrays(frame,matFrame);
+   const U16 * indexBase = usingBuffers ? NULL : indices.address();
+
+   for (S32 i=0; i<primitives.size(); i++)
    {
-      glClientActiveTextureARB(GL_TEXTURE0_ARB + TSShapeInstance::smRenderData.detailMapTE);
-      glTexCoordPointer(2,GL_FLOAT,0,&diffuse[firstTVert]);
-      glClientActiveTextureARB(GL_TEXTURE0_ARB + TSShapeInstance::smRenderData.baseTE);
+      TSDrawPrimitive & draw = primitives[i];
+      AssertFatal(draw.matIndex & TSDrawPrimitive::Indexed,
+                  "TSMesh::render: rendering of non-indexed meshes no longer supported");
+
+      // material change?
+      if ( ((TSShapeInstance::smRenderData.materialIndex ^ draw.matIndex) &
+            (TSDrawPrimitive::MaterialMask|TSDrawPrimitive::NoMaterial)) != 0)
+         setMaterial(draw.matIndex,materials);
+
+      S32 drawType = getDrawType(draw.matIndex>>30);
+
+      STAT_INC(DrawCalls);
+      glDrawElements(drawType,draw.numElements,GL_UNSIGNED_SHORT,indexBase + draw.start);
    }
-   if (TSShapeInstance::smRenderData.lightMapMethod == TSShapeInstance::LIGHT_MAP_MULTI)
-   {
-      ToolVector<Point2F> lightmap;
-      getUVs(tLightmap, lightmap);
-      glClientActiveTextureARB(GL_TEXTURE0_ARB + TSShapeInstance::smRenderData.lightMapTE);
-      glTexCoordPointer(2,GL_FLOAT,0,&lightmap[firstTVert]);
-      glClientActiveTextureARB(GL_TEXTURE0_ARB + TSShapeInstance::smRenderData.baseTE);
+
+   resetVertexArrays(usingBuffers);
+
+   restoreMergeNormals();
+
+   glDisable(GL_NORMALIZE);
+}
+
+void TSMesh::renderInstanced(S32 frame, S32 matFrame, TSMaterialList * materials, const MatrixF * meshTransform,
+                             const MatrixF * instances, U32 count)
+{
+   AssertFatal(getMeshType()==StandardMeshType && !getFlags(Billboard),
+               "TSMesh::renderInstanced: only standard meshes can be instanced");
+
+   if( vertsPerFrame <= 0 ) {
+      return;
    }
 
-   // lock...
-   bool lockArrays = dglDoesSupportCompiledVertexArray();
-   if (lockArrays)
-      glLockArraysEXT(0,vertsPerFrame);
+   glEnable(GL_NORMALIZE);
+
+   saveMergeNormals();
+
+   // same arrays as render(), but they're set and locked once for all copies
+   bool usingBuffers = setupVertexArrays(frame,matFrame);
+   const U16 * indexBase = usingBuffers ? NULL : indices.address();
 
+   // one material change per primitive, then every copy of it
    for (S32 i=0; i<primitives.size(); i++)
    {
       TSDrawPrimitive & draw = primitives[i];
       AssertFatal(draw.matIndex & TSDrawPrimitive::Indexed,
-                  "TSMesh::render: rendering of non-indexed meshes no longer supported");
+                  "TSMesh::renderInstanced: rendering of non-indexed meshes no longer supported");
 
-      // material change?
       if ( ((TSShapeInstance::smRenderData.materialIndex ^ draw.matIndex) &
             (TSDrawPrimitive::MaterialMask|TSDrawPrimitive::NoMaterial)) != 0)
          setMaterial(draw.matIndex,materials);
 
       S32 drawType = getDrawType(draw.matIndex>>30);
 
-      glDrawElements(drawType,draw.numElements,GL_UNSIGNED_SHORT,&indices[draw.start]);
+      for (U32 k=0; k<count; k++)
+      {
+         glPushMatrix();
+         dglMultMatrix(&instances[k]);
+         if (meshTransform)
+            dglMultMatrix(meshTransform);
+         STAT_INC(DrawCalls);
+         glDrawElements(drawType,draw.numElements,GL_UNSIGNED_SHORT,indexBase + draw.start);
+         glPopMatrix();
+      }
    }
 
-   // unlock...
-   if (lockArrays)
-      glUnlockArraysEXT();
+   resetVertexArrays(usingBuffers);
 
    restoreMergeNormals();
 
    glDisable(GL_NORMALIZE);
 }
 
+//-----------------------------------------------------
+// buffer objects
+//-----------------------------------------------------
+
+bool TSMesh::smUseBufferObjects  = true;
+U32  TSMesh::smBufferGeneration  = 1;
+U32  TSMesh::smBufferCallbackKey = (U32)-1;
+
+void TSMesh::initBufferObjects()
+{
+   Con::addVariable("$pref::TS::vertexBufferObjects", TypeBool, &smUseBufferObjects);
+   smBufferCallbackKey = TextureManager::registerEventCallback(bufferTextureEvent, NULL);
+}
+
+void TSMesh::destroyBufferObjects()
+{
+   if (smBufferCallbackKey != (U32)-1)
+      TextureManager::unregisterEventCallback(smBufferCallbackKey);
+   smBufferCallbackKey = (U32)-1;
+
+   // shapes can outlive the context at shutdown, don't let them touch it
+   smBufferGeneration++;
+}
+
+void TSMesh::bufferTextureEvent(const U32 eventCode, void *)
+{
+   // the buffers die with the context, so just forget about them all and
+   // let each mesh upload itself again when it's next drawn
+   if (eventCode == TextureManager::BeginZombification)
+      smBufferGeneration++;
+}
+
+bool TSMesh::useBufferObjects()
+{
+   return smUseBufferObjects && dglDoesSupportVertexBufferObject();
+}
+
+bool TSMesh::canUseBufferObjects()
+{
+   return getMeshType() == StandardMeshType && !getFlags(Billboard) &&
+          numFrames == 1 && numMatFrames == 1 && mergeIndices.size() == 0 &&
+          vertsPerFrame > 0 && indices.size() > 0;
+}
+
+bool TSMesh::bindBufferObjects()
+{
+   if (!useBufferObjects() || !canUseBufferObjects())
+      return false;
+
+   if (mBufferGeneration != smBufferGeneration)
+   {
+      PROFILE_START(TSMesh_createBufferObjects);
+
+      // anything from an older generation went with its context
+      mVertexBufferObject = 0;
+      mIndexBufferObject = 0;
+
+      ToolVector<Point2F> diffuse, lightmap;
+      getUVs(tDiffuse, diffuse);
+      bool hasLightmap = getUVs(tLightmap, lightmap) && lightmap.size() >= vertsPerFrame;
+      AssertFatal(diffuse.size() >= vertsPerFrame, "TSMesh::bindBufferObjects: missing texture coordinates");
+
+      U32 numVerts   = vertsPerFrame;
+      U32 normOffset = numVerts * sizeof(Point3F);
+      U32 uvOffset   = normOffset * 2;
+      U32 lmOffset   = uvOffset + numVerts * sizeof(Point2F);
+      U32 size       = hasLightmap ? lmOffset + numVerts * sizeof(Point2F) : lmOffset;
+
+      GLuint buffers[2];
+      glGenBuffersARB(2, buffers);
+
+      glBindBufferARB(GL_ARRAY_BUFFER_ARB, buffers[0]);
+      glBufferDataARB(GL_ARRAY_BUFFER_ARB, size, NULL, GL_STATIC_DRAW_ARB);
+      glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, 0, normOffset, verts.address());
+      glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, normOffset, normOffset, getNormals(0));
+      glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, uvOffset, numVerts * sizeof(Point2F), diffuse.address());
+      if (hasLightmap)
+         glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, lmOffset, numVerts * sizeof(Point2F), lightmap.address());
+
+      glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, buffers[1]);
+      glBufferDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB, indices.size() * sizeof(U16), indices.address(), GL_STATIC_DRAW_ARB);
+
+      mVertexBufferObject   = buffers[0];
+      mIndexBufferObject    = buffers[1];
+      mBufferLightmapOffset = hasLightmap ? lmOffset : 0;
+      mBufferGeneration     = smBufferGeneration;
+
+      PROFILE_END();
+   }
+   else
+   {
+      glBindBufferARB(GL_ARRAY_BUFFER_ARB, mVertexBufferObject);
+      glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, mIndexBufferObject);
+   }
+
+   return true;
+}
+
+void TSMesh::unbindBufferObjects()
+{
+   // the rest of the engine draws from system memory
+   glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+   glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+}
+
+void TSMesh::deleteBufferObjects()
+{
+   if (mBufferGeneration == smBufferGeneration && mVertexBufferObject)
+   {
+      GLuint buffers[2] = { mVertexBufferObject, mIndexBufferObject };
+      glDeleteBuffersARB(2, buffers);
+   }
+   mVertexBufferObject = 0;
+   mIndexBufferObject = 0;
+   mBufferGeneration = 0;
+}
+
+bool TSMesh::setupVertexArrays(S32 frame, S32 matFrame)
+{
+   S32 & detailMapMethod = TSShapeInstance::smRenderData.detailMapMethod;
+   bool multiDetail = detailMapMethod == TSShapeInstance::DETAIL_MAP_MULTI_1 ||
+                      detailMapMethod == TSShapeInstance::DETAIL_MAP_MULTI_2;
+   bool multiLight  = TSShapeInstance::smRenderData.lightMapMethod == TSShapeInstance::LIGHT_MAP_MULTI;
+
+   if (bindBufferObjects())
+   {
+      const U8 * base = NULL;
+      const U8 * uvs  = base + 2 * vertsPerFrame * sizeof(Point3F);
+
+      glVertexPointer(3,GL_FLOAT,0,base);
+      glNormalPointer(GL_FLOAT,0,base + vertsPerFrame * sizeof(Point3F));
+      glTexCoordPointer(2,GL_FLOAT,0,uvs);
+      if (multiDetail)
+      {
+         glClientActiveTextureARB(GL_TEXTURE0_ARB + TSShapeInstance::smRenderData.detailMapTE);
+         glTexCoordPointer(2,GL_FLOAT,0,uvs);
+         glClientActiveTextureARB(GL_TEXTURE0_ARB + TSShapeInstance::smRenderData.baseTE);
+      }
+      if (multiLight)
+      {
+         glClientActiveTextureARB(GL_TEXTURE0_ARB + TSShapeInstance::smRenderData.lightMapTE);
+         glTexCoordPointer(2,GL_FLOAT,0,mBufferLightmapOffset ? base + mBufferLightmapOffset : uvs);
+         glClientActiveTextureARB(GL_TEXTURE0_ARB + TSShapeInstance::smRenderData.baseTE);
+      }
+      return true;
+   }
+
+   S32 firstVert  = vertsPerFrame * frame;
+   S32 firstTVert = vertsPerFrame * matFrame;
+
+   glVertexPointer(3,GL_FLOAT,0,&verts[firstVert]);
+   glNormalPointer(GL_FLOAT,0,getNormals(firstVert));
+   ToolVector<Point2F> diffuse;
+   getUVs(tDiffuse, diffuse);
+   glTexCoordPointer(2,GL_FLOAT,0,&diffuse[firstTVert]);
+   if (multiDetail)
+   {
+      glClientActiveTextureARB(GL_TEXTURE0_ARB + TSShapeInstance::smRenderData.detailMapTE);
+      glTexCoordPointer(2,GL_FLOAT,0,&diffuse[firstTVert]);
+      glClientActiveTextureARB(GL_TEXTURE0_ARB + TSShapeInstance::smRenderData.baseTE);
+   }
+   if (multiLight)
+   {
+      ToolVector<Point2F> lightmap;
+      getUVs(tLightmap, lightmap);
+      glClientActiveTextureARB(GL_TEXTURE0_ARB + TSShapeInstance::smRenderData.lightMapTE);
+      glTexCoordPointer(2,GL_FLOAT,0,&lightmap[firstTVert]);
+      glClientActiveTextureARB(GL_TEXTURE0_ARB + TSShapeInstance::smRenderData.baseTE);
+   }
+
+   if (dglDoesSupportCompiledVertexArray())
+      glLockArraysEXT(0,vertsPerFrame);
+
+   return false;
+}
+
+void TSMesh::resetVertexArrays(bool usingBuffers)
+{
+   if (usingBuffers)
+      unbindBufferObjects();
+   else if (dglDoesSupportCompiledVertexArray())
+      glUnlockArraysEXT();
+}
+
 const Point3F * TSMesh::getNormals(S32 firstVert)
 {
    if (getFlags(UseEncodedNormals))
@@ -1218,6 +1429,7 @@ void TSMesh::renderEnvironmentMap(S32 frame, S32 matFrame, TSMaterialList * mate
             }
          }
       }
+      STAT_INC(DrawCalls);
       glDrawElements(getDrawType(draw.matIndex>>30),draw.numElements,GL_UNSIGNED_SHORT,&indices[draw.start]);
    }
 
@@ -1349,7 +1561,10 @@ void TSMesh::renderDetailMap(S32 frame, S32 matFrame, TSMaterialList * materials
          }
       }
       if (TSShapeInstance::smRenderData.detailMapTE)
+      {
+         STAT_INC(DrawCalls);
          glDrawElements(getDrawType(draw.matIndex>>30),draw.numElements,GL_UNSIGNED_SHORT,&indices[draw.start]);
+      }
    }
 
    // unlock...
@@ -1460,7 +1675,10 @@ void TSMesh::renderLightMap(S32 frame, S32 matFrame, TSMaterialList * materials)
          }
       }
       if (TSShapeInstance::smRenderData.lightMapTE)
+      {
+         STAT_INC(DrawCalls);
          glDrawElements(getDrawType(draw.matIndex>>30),draw.numElements,GL_UNSIGNED_SHORT,&indices[draw.start]);
+      }
    }
 
    // unlock...
@@ -1592,6 +1810,7 @@ void TSMesh::renderFog(S32 frame, TSMaterialList* materials)
           materials->getFlags(primitives[i].matIndex & TSDrawPrimitive::MaterialMask) & (TSMaterialList::Translucent | TSMaterialList::Additive))
          continue;
 
+      STAT_INC(DrawCalls);
       glDrawElements(getDrawType(draw.matIndex>>30),draw.numElements,GL_UNSIGNED_SHORT,&indices[draw.start]);
    }
 
@@ -1680,10 +1899,10 @@ bool TSMesh::getFeatures(S32 frame, const MatrixF& mat, const VectorF& /*n*/, Co
    S32 i;
    S32 base = cf->mVertexList.size();
 
-   for (i = 0; i < vertsPerFrame; i++) {
-      cf->mVertexList.increment();
-      mat.mulP(verts[firstVert + i], &cf->mVertexList.last());
-   }
+   cf->mVertexList.increment(vertsPerFrame);
+   if (vertsPerFrame)
+      m_matF_x_point3F_array(mat, verts[firstVert], cf->mVertexList[base],
+                             vertsPerFrame, sizeof(Point3F));
 
    // add the polys...
    for (i=0; i < primitives.size(); i++)
@@ -1822,31 +2041,15 @@ void TSMesh::support(S32 frame, const Point3F& v, F32* currMaxDP, Point3F* currS
    if (vertsPerFrame == 0)
       return;
 
-   U32 waterMark = FrameAllocator::getWaterMark();
-   F32* pDots = (F32*)FrameAllocator::alloc(sizeof(F32) * vertsPerFrame);
-
    S32 firstVert = vertsPerFrame * frame;
-   m_point3F_bulk_dot(&v.x,
-                      &verts[firstVert].x,
-                      vertsPerFrame,
-                      sizeof(Point3F),
-                      pDots);
+   U32 index = m_point3F_bulk_max_dot(&v.x,
+                                      &verts[firstVert].x,
+                                      vertsPerFrame,
+                                      sizeof(Point3F),
+                                      NULL);
 
-   F32 localdp = *currMaxDP;
-   S32 index   = -1;
-
-   for (S32 i = 0; i < vertsPerFrame; i++)
-   {
-      if (pDots[i] > localdp)
-      {
-         localdp = pDots[i];
-         index   = i;
-      }
-   }
-
-   FrameAllocator::setWaterMark(waterMark);
-
-   if (index != -1)
+   F32 localdp = mDot(verts[index + firstVert], v);
+   if (localdp > *currMaxDP)
    {
       *currMaxDP   = localdp;
       *currSupport = verts[index + firstVert];
@@ -2140,15 +2343,22 @@ void TSMesh::computeBounds(Point3F * v, S32 numVerts, MatrixF & transform, Box3F
       return;
    }
 
-   S32 i;
-   Point3F p;
+   // The verts are transformed a batch at a time into a buffer on the stack.
+   enum { BatchSize = 128 };
+   Point3F batch[BatchSize];
+
+   S32 i, j;
    transform.mulP(*v,&bounds.min);
    bounds.max = bounds.min;
-   for (i=0; i<numVerts; i++)
+   for (i=0; i<numVerts; i+=BatchSize)
    {
-      transform.mulP(v[i],&p);
-      bounds.max.setMax(p);
-      bounds.min.setMin(p);
+      S32 count = getMin(numVerts - i, S32(BatchSize));
+      m_matF_x_point3F_array(transform, v[i], batch[0], count, sizeof(Point3F));
+      for (j=0; j<count; j++)
+      {
+         bounds.max.setMax(batch[j]);
+         bounds.min.setMin(batch[j]);
+      }
    }
    Point3F c;
    if (!center)
@@ -2159,11 +2369,15 @@ void TSMesh::computeBounds(Point3F * v, S32 numVerts, MatrixF & transform, Box3F
    if (radius)
    {
       *radius = 0.0f;
-      for (i=0; i<numVerts; i++)
+      for (i=0; i<numVerts; i+=BatchSize)
       {
-         transform.mulP(v[i],&p);
-         p -= *center;
-         *radius = getMax(*radius,mDot(p,p));
+         S32 count = getMin(numVerts - i, S32(BatchSize));
+         m_matF_x_point3F_array(transform, v[i], batch[0], count, sizeof(Point3F));
+         for (j=0; j<count; j++)
+         {
+            Point3F p = batch[j] - *center;
+            *radius = getMax(*radius,mDot(p,p));
+         }
       }
       *radius = mSqrt(*radius);
    }
@@ -2190,6 +2404,7 @@ S32 TSMesh::getNumPolys()
 
 TSMesh::~TSMesh()
 {
+   deleteBufferObjects();
 }
 
 //-----------------------------------------------------
@@ -2200,6 +2415,10 @@ Vector<MatrixF> gBoneTransforms;
 Vector<Point3F> gSkinVerts;
 Vector<Point3F> gSkinNorms;
 
+bool          TSSkinMesh::smUseSkinCache = true;
+TSSkinCache * TSSkinMesh::smCurrentCache = NULL;
+U32           TSSkinMesh::smMeshSerial = 0;
+
 /// Chris Lomont version of fast inverse sqrt,
 /// based on Newton method, 1 iteration, more accurate
 /// We use here for skinning cuz we don't need much accuracy -- BJG
@@ -2235,60 +2454,103 @@ void TSSkinMesh::updateSkin()
    norms.set(gSkinNorms.address(),gSkinNorms.size());
 #endif
 
-   // set up bone transforms
-   S32 i;
-   for (i=0; i<nodeIndex.size(); i++)
-   {
-      S32 node = nodeIndex[i];
-      gBoneTransforms[i].mul(TSShapeInstance::ObjectInstance::smTransforms[node],initialTransforms[i]);
-   }
-
-   // multiply verts and normals by boneTransforms
-   S32 prevIndex = -1;
-   S32 vertexIndexSize = vertexIndex.size();
-   Point3F v0,n0;
-   // TODO: vectorize this.
-   for (i=0; i<vertexIndexSize; i++)
-   {
-      const S32 &vIndex = vertexIndex[i];
-      const MatrixF & deltaTransform = gBoneTransforms[boneIndex[i]];
-      deltaTransform.mulP(initialVerts[vIndex],&v0);
-      deltaTransform.mulV(initialNorms[vIndex],&n0);
-      v0 *= weight[i];
-      n0 *= weight[i];
-      Point3F & v = verts[vIndex];
-      Point3F & n = norms[vIndex];
-      // this should be implemented as a series of conditional moves to avoid the branch
-      if (vIndex != prevIndex)
-      {
-         v.x = 0.0f;
-         v.y = 0.0f;
-         v.z = 0.0f;
-         n.x = 0.0f;
-         n.y = 0.0f;
-         n.z = 0.0f;
-      }
-      v += v0;
-      n += n0;
-      prevIndex = vIndex;
-   }
+   // set up bone transforms, then multiply verts and normals by them
+   computeBoneTransforms(TSShapeInstance::ObjectInstance::smTransforms,gBoneTransforms.address());
+   skinVerts(gBoneTransforms.address(),initialNorms.address(),verts.address(),norms.address(),norms.size());
+}
+
+void TSSkinMesh::computeBoneTransforms(const MatrixF * nodeTransforms, MatrixF * boneTransforms)
+{
+   for (S32 i=0; i<nodeIndex.size(); i++)
+      boneTransforms[i].mul(nodeTransforms[nodeIndex[i]],initialTransforms[i]);
+}
+
+void TSSkinMesh::skinVerts(const MatrixF * boneTransforms, const Point3F * initNorms,
+                           Point3F * outVerts, Point3F * outNorms, S32 numVerts)
+{
+   PROFILE_START(TSSkinMesh_skinVerts);
+
+   // the kernel is vectorized where the cpu allows, see mMathFn.h
+   m_skin_verts((const F32*)boneTransforms,nodeIndex.size(),
+                vertexIndex.address(),boneIndex.address(),weight.address(),vertexIndex.size(),
+                (const F32*)initialVerts.address(),(const F32*)initNorms,
+                (F32*)outVerts,(F32*)outNorms);
 
    // normalize normals...
-   for (i=0; i<norms.size(); i++)
+   for (S32 i=0; i<numVerts; i++)
    {
       // gotta do a check now since shared verts between meshes
       // may result in an unused vert in the list...
-      Point3F & n = norms[i];
+      Point3F & n = outNorms[i];
       F32 len2 = mDot(n,n);
       if (len2>0.01f)
-         norms[i] *= InvSqrt_Lomont(len2); // 1.0f/mSqrt(len2);
+         n *= InvSqrt_Lomont(len2); // 1.0f/mSqrt(len2);
+   }
+
+   PROFILE_END();
+}
+
+void TSSkinMesh::updateSkinCache(TSSkinCache & cache, const MatrixF * nodeTransforms)
+{
+   // Bone transforms are cheap next to the skinning, so they're always
+   //  worked out and only the skinning is skipped if they match.
+   S32 numBones = nodeIndex.size();
+   cache.pendingBones.setSize(numBones);
+   computeBoneTransforms(nodeTransforms,cache.pendingBones.address());
+
+   bool sameMesh = cache.mesh == this && cache.meshSerial == smMeshSerial;
+   if (sameMesh && cache.boneTransforms.size() == numBones &&
+       dMemcmp(cache.boneTransforms.address(),cache.pendingBones.address(),numBones * sizeof(MatrixF)) == 0)
+      return;
+
+   S32 numVerts = initialVerts.size();
+   const Point3F * initNorms = initialNorms.address();
+   if (encodedNorms.size())
+   {
+      // decoded once per cache rather than into shared scratch, so this
+      //  stays safe to run on several threads at once
+      if (!sameMesh || cache.decodedNorms.size() != vertsPerFrame)
+      {
+         cache.decodedNorms.setSize(vertsPerFrame);
+         for (S32 i=0; i<vertsPerFrame; i++)
+            cache.decodedNorms[i] = decodeNormal(encodedNorms[i]);
+      }
+      initNorms = cache.decodedNorms.address();
+      numVerts = vertsPerFrame;
+   }
+   else
+      cache.decodedNorms.clear();
+
+   if (!sameMesh)
+   {
+      // verts without influences are never written, so start them clean
+      cache.verts.setSize(numVerts);
+      cache.norms.setSize(numVerts);
+      dMemset(cache.verts.address(),0,numVerts * sizeof(Point3F));
+      dMemset(cache.norms.address(),0,numVerts * sizeof(Point3F));
    }
+
+   skinVerts(cache.pendingBones.address(),initNorms,cache.verts.address(),cache.norms.address(),numVerts);
+
+   cache.boneTransforms.setSize(numBones);
+   dMemcpy(cache.boneTransforms.address(),cache.pendingBones.address(),numBones * sizeof(MatrixF));
+   cache.mesh = this;
+   cache.meshSerial = smMeshSerial;
 }
 
 void TSSkinMesh::render(S32 frame, S32 matFrame, TSMaterialList * materials)
 {
    // update verts and normals...
-   updateSkin();
+#if !defined(TORQUE_LIB)
+   if (smCurrentCache)
+   {
+      updateSkinCache(*smCurrentCache,TSShapeInstance::ObjectInstance::smTransforms);
+      verts.set(smCurrentCache->verts.address(),smCurrentCache->verts.size());
+      norms.set(smCurrentCache->norms.address(),smCurrentCache->norms.size());
+   }
+   else
+#endif
+      updateSkin();
 
    // render...
    Parent::render(frame,matFrame,materials);
@@ -3088,6 +3350,210 @@ S8 * TSMesh::getSharedData8(S32 parentMesh, S32 size, S8 ** source, bool skip)
    return ptr;
 }
 
+//-----------------------------------------------------------------------------
+// vertex cache optimization
+//-----------------------------------------------------------------------------
+
+// Tom Forsyth's "Linear-Speed Vertex Cache Optimisation": triangles are
+// emitted greedily by score, where a vertex scores for being near the front
+// of a simulated LRU cache and for having few triangles left, so meshes
+// finish off the vertices they have in the cache before moving on.
+
+static const S32 csVCacheSize = 32;
+static const S32 csVCacheMaxValence = 64;
+
+static F32 sgVCachePosScore[csVCacheSize];
+static F32 sgVCacheValenceScore[csVCacheMaxValence];
+static bool sgVCacheScoresValid = false;
+
+static void initVCacheScores()
+{
+   for (S32 i=0; i<csVCacheSize; i++)
+   {
+      // the last triangle's vertices get a fixed score, so the order
+      // within a triangle doesn't matter
+      if (i<3)
+         sgVCachePosScore[i] = 0.75f;
+      else
+         sgVCachePosScore[i] = mPow(1.0f - F32(i-3) / F32(csVCacheSize-3), 1.5f);
+   }
+   sgVCacheValenceScore[0] = 0.0f;
+   for (S32 i=1; i<csVCacheMaxValence; i++)
+      sgVCacheValenceScore[i] = 2.0f * mPow(F32(i), -0.5f);
+   sgVCacheScoresValid = true;
+}
+
+static inline F32 getVCacheScore(S32 cachePos, S32 remaining)
+{
+   if (remaining==0)
+      return -1.0f;
+   F32 score = cachePos<0 ? 0.0f : sgVCachePosScore[cachePos];
+   return score + sgVCacheValenceScore[getMin(remaining,csVCacheMaxValence-1)];
+}
+
+void TSMesh::optimizeTriangleOrder(S16 * indices, S32 numIndices)
+{
+   S32 numTris = numIndices / 3;
+   if (numTris<2)
+      return;
+
+   if (!sgVCacheScoresValid)
+      initVCacheScores();
+
+   S32 numVerts = 0;
+   for (S32 i=0; i<numTris*3; i++)
+      numVerts = getMax(numVerts,S32(U16(indices[i]))+1);
+
+   // each vertex's triangles, the ones not yet emitted first
+   Vector<S32> vertRemaining(numVerts);
+   Vector<S32> vertTriStart(numVerts);
+   Vector<S32> vertCachePos(numVerts);
+   Vector<F32> vertScore(numVerts);
+   Vector<S32> vertTris(numTris*3);
+   Vector<F32> triScore(numTris);
+   Vector<bool> triDone(numTris);
+   vertRemaining.setSize(numVerts);
+   vertTriStart.setSize(numVerts);
+   vertCachePos.setSize(numVerts);
+   vertScore.setSize(numVerts);
+   vertTris.setSize(numTris*3);
+   triScore.setSize(numTris);
+   triDone.setSize(numTris);
+
+   S32 i, j, k;
+   for (i=0; i<numVerts; i++)
+   {
+      vertRemaining[i] = 0;
+      vertCachePos[i] = -1;
+   }
+   for (i=0; i<numTris*3; i++)
+      vertRemaining[U16(indices[i])]++;
+   for (i=0, k=0; i<numVerts; i++)
+   {
+      vertTriStart[i] = k;
+      k += vertRemaining[i];
+      vertRemaining[i] = 0;
+   }
+   for (i=0; i<numTris*3; i++)
+   {
+      S32 v = U16(indices[i]);
+      vertTris[vertTriStart[v] + vertRemaining[v]++] = i/3;
+   }
+   for (i=0; i<numVerts; i++)
+      vertScore[i] = getVCacheScore(-1,vertRemaining[i]);
+
+   S32 bestTri = -1;
+   F32 bestScore = -1.0f;
+   for (i=0; i<numTris; i++)
+   {
+      triDone[i] = false;
+      triScore[i] = vertScore[U16(indices[i*3+0])] + vertScore[U16(indices[i*3+1])] + vertScore[U16(indices[i*3+2])];
+      if (triScore[i]>bestScore)
+      {
+         bestScore = triScore[i];
+         bestTri = i;
+      }
+   }
+
+   Vector<S16> out(numTris*3);
+   out.setSize(numTris*3);
+   S32 cache[csVCacheSize+3];
+   S32 cacheSize = 0;
+
+   for (S32 emitted=0; emitted<numTris; emitted++)
+   {
+      if (bestTri<0)
+      {
+         // nothing in the cache has triangles left, start somewhere new
+         bestScore = -1.0f;
+         for (i=0; i<numTris; i++)
+            if (!triDone[i] && triScore[i]>bestScore)
+            {
+               bestScore = triScore[i];
+               bestTri = i;
+            }
+      }
+
+      S32 tri = bestTri;
+      triDone[tri] = true;
+      S32 newCache[csVCacheSize+3];
+      S32 newSize = 0;
+      for (j=0; j<3; j++)
+      {
+         S32 v = U16(indices[tri*3+j]);
+         out[emitted*3+j] = indices[tri*3+j];
+
+         // take the triangle off the vertex's list of those remaining
+         S32 * list = &vertTris[vertTriStart[v]];
+         S32 last = --vertRemaining[v];
+         for (k=0; k<last; k++)
+            if (list[k]==tri)
+            {
+               list[k] = list[last];
+               list[last] = tri;
+               break;
+            }
+
+         newCache[newSize++] = v;
+      }
+
+      // the triangle's vertices go to the front, the rest move back
+      for (j=0; j<cacheSize; j++)
+      {
+         S32 v = cache[j];
+         if (v!=newCache[0] && v!=newCache[1] && v!=newCache[2])
+            newCache[newSize++] = v;
+      }
+      for (j=csVCacheSize; j<newSize; j++)
+      {
+         vertCachePos[newCache[j]] = -1;
+         vertScore[newCache[j]] = getVCacheScore(-1,vertRemaining[newCache[j]]);
+      }
+      cacheSize = getMin(newSize,csVCacheSize);
+      for (j=0; j<cacheSize; j++)
+      {
+         S32 v = newCache[j];
+         cache[j] = v;
+         vertCachePos[v] = j;
+         vertScore[v] = getVCacheScore(j,vertRemaining[v]);
+      }
+
+      // rescore the triangles that touch the cache, and pick the next
+      bestTri = -1;
+      bestScore = -1.0f;
+      for (j=0; j<newSize; j++)
+      {
+         S32 v = newCache[j];
+         S32 * list = &vertTris[vertTriStart[v]];
+         for (k=0; k<vertRemaining[v]; k++)
+         {
+            S32 t = list[k];
+            F32 score = vertScore[U16(indices[t*3+0])] + vertScore[U16(indices[t*3+1])] + vertScore[U16(indices[t*3+2])];
+            triScore[t] = score;
+            if (score>bestScore)
+            {
+               bestScore = score;
+               bestTri = t;
+            }
+         }
+      }
+   }
+
+   dMemcpy(indices,out.address(),numTris*3*sizeof(S16));
+}
+
+void TSMesh::optimizeVertexCache(S32 * primitivesIn, S32 numPrimIn, S16 * indicesIn)
+{
+   // only within each triangle list, so the draw order of the materials
+   // (and of any strips) stays as it was
+   for (S32 i=0; i<numPrimIn; i++)
+   {
+      TSDrawPrimitive & draw = *(TSDrawPrimitive*) &primitivesIn[i*2];
+      if ((draw.matIndex & TSDrawPrimitive::TypeMask) == TSDrawPrimitive::Triangles)
+         optimizeTriangleOrder(indicesIn + draw.start, draw.numElements);
+   }
+}
+
 void TSMesh::assemble(bool skip)
 {
    alloc.checkGuard();
@@ -3115,7 +3581,7 @@ void TSMesh::assemble(bool skip)
       // we have encoded normals and we want to use them...
 
       if (parentMesh<0)
-         alloc.getPointer32(numVerts*3); // advance past norms, don't use
+         alloc.skip32(numVerts*3); // advance past norms, don't use
       norms.set(NULL,0);
 
       ptr8 = getSharedData8(parentMesh,numVerts,(S8**)smEncodedNormsList.address(),skip);
@@ -3129,7 +3595,7 @@ void TSMesh::assemble(bool skip)
       norms.set((Point3F*)ptr32,numVerts);
 
       if (parentMesh<0)
-         alloc.getPointer8(numVerts); // advance past encoded normls, don't use
+         alloc.skip8(numVerts); // advance past encoded normls, don't use
       encodedNorms.set(NULL,0);
    }
    else
@@ -3161,12 +3627,23 @@ void TSMesh::assemble(bool skip)
    S16 * ptr16 = alloc.allocShape16(cpyInd);
    alloc.align32();
    S32 chkPrim = szPrim, chkInd = szInd;
-   if (smUseTriangles)
-      convertToTris(prim16,prim32,ind16,szPrim,chkPrim,chkInd,ptr32,ptr16);
-   else if (smUseOneStrip)
-      convertToSingleStrip(prim16,prim32,ind16,szPrim,chkPrim,chkInd,ptr32,ptr16);
+   if (alloc.isBaked())
+   {
+      // converted, and reordered, when the block was baked
+      chkPrim = cpyPrim;
+      chkInd = cpyInd;
+   }
    else
-      leaveAsMultipleStrips(prim16,prim32,ind16,szPrim,chkPrim,chkInd,ptr32,ptr16);
+   {
+      if (smUseTriangles)
+         convertToTris(prim16,prim32,ind16,szPrim,chkPrim,chkInd,ptr32,ptr16);
+      else if (smUseOneStrip)
+         convertToSingleStrip(prim16,prim32,ind16,szPrim,chkPrim,chkInd,ptr32,ptr16);
+      else
+         leaveAsMultipleStrips(prim16,prim32,ind16,szPrim,chkPrim,chkInd,ptr32,ptr16);
+      if (smOptimizeVertexCache && ptr32 && !skip)
+         optimizeVertexCache(ptr32,cpyPrim,ptr16);
+   }
    AssertFatal(chkPrim==cpyPrim && chkInd==cpyInd,"TSMesh::primitive conversion");
    primitives.set(ptr32,cpyPrim);
    indices.set(ptr16,cpyInd);
@@ -3275,7 +3752,7 @@ void TSSkinMesh::assemble(bool skip)
    {
       // we have encoded normals and we want to use them...
       if (parentMesh<0)
-         alloc.getPointer32(numVerts*3); // advance past norms, don't use
+         alloc.skip32(numVerts*3); // advance past norms, don't use
       initialNorms.set(NULL,0);
 
       ptr8 = getSharedData8(parentMesh,numVerts,(S8**)smEncodedNormsList.address(),skip);
@@ -3290,7 +3767,7 @@ void TSSkinMesh::assemble(bool skip)
       initialNorms.set((Point3F*)ptr32,numVerts);
 
       if (parentMesh<0)
-         alloc.getPointer8(numVerts); // advance past encoded normls, don't use
+         alloc.skip8(numVerts); // advance past encoded normls, don't use
       encodedNorms.set(NULL,0);
    }
    else
@@ -161,6 +161,10 @@ class TSMesh
    virtual void morphVB(S32 vb, S32 morph, S32 frame, S32 matFrame, TSMaterialList *materials);
    virtual void renderVB(S32 frame, S32 matFrame, TSMaterialList *materials);
    virtual void render(S32 frame, S32 matFrame, TSMaterialList *);
+   /// Draws the mesh once per instance matrix, followed by meshTransform if
+   /// there is one.  Only for standard, non-billboard meshes.
+   void renderInstanced(S32 frame, S32 matFrame, TSMaterialList *, const MatrixF * meshTransform,
+                        const MatrixF * instances, U32 count);
    virtual void renderShadow(S32 frame, const MatrixF & mat, S32 dim, U32 * bits, TSMaterialList *);
    void renderEnvironmentMap(S32 frame, S32 matFrame, TSMaterialList *);
    void renderDetailMap(S32 frame, S32 matFrame, TSMaterialList *);
@@ -168,6 +172,51 @@ class TSMesh
    void renderLightMap(S32 frame, S32 matFrame, TSMaterialList *);
    /// @}
 
+   /// @name Buffer Objects
+   /// Meshes that never change on the cpu (standard, not billboards, one
+   /// vertex and one material frame, no merge verts) are uploaded into an
+   /// ARB_vertex_buffer_object the first time they're drawn.  The mesh
+   /// belongs to the TSShape, so every instance of the shape shares it.
+   /// Everything else, or everything if the extension is missing, keeps
+   /// using vertex arrays in system memory.
+   /// @{
+
+   U32 mVertexBufferObject;   ///< Positions, normals, diffuse and lightmap uvs, in that order.
+   U32 mIndexBufferObject;
+   U32 mBufferGeneration;     ///< smBufferGeneration the buffers were made in.
+   U32 mBufferLightmapOffset; ///< Byte offset of the lightmap uvs, 0 if there are none.
+
+   /// $pref::TS::vertexBufferObjects
+   static bool smUseBufferObjects;
+
+   /// Bumped when the GL context goes away; buffers from an older
+   /// generation are treated as not created.
+   static U32  smBufferGeneration;
+   static U32  smBufferCallbackKey;
+
+   static void initBufferObjects();
+   static void destroyBufferObjects();
+   static void bufferTextureEvent(const U32 eventCode, void *userData);
+
+   /// True if buffer objects are on and supported at all.
+   static bool useBufferObjects();
+
+   bool canUseBufferObjects();
+
+   /// Points the vertex arrays at the mesh's buffers, making them first if
+   /// need be.  Returns false if the mesh is drawn from system memory.
+   bool bindBufferObjects();
+   static void unbindBufferObjects();
+   void deleteBufferObjects();
+
+   /// Sets the vertex, normal and texture coordinate arrays for the frame,
+   /// and locks them if they're in system memory.  Returns true if they come
+   /// from the buffers, in which case indices are offsets into
+   /// mIndexBufferObject.
+   bool setupVertexArrays(S32 frame, S32 matFrame);
+   void resetVertexArrays(bool usingBuffers);
+   /// @}
+
    /// @name Material Methods
    /// @{
 
@@ -228,6 +277,7 @@ class TSMesh
    static bool smUseOneStrip;
    static S32  smMinStripSize;
    static bool smUseEncodedNormals;
+   static bool smOptimizeVertexCache;
 
    /// convert primitives on load...
    void convertToTris(S16 * primitiveDataIn, S32 * primitiveMatIn, S16 * indicesIn,
@@ -240,6 +290,11 @@ class TSMesh
                               S32 numPrimIn, S32 & numPrimOut, S32 & numIndicesOut,
                               S32 * primitivesOut, S16 * indicesOut);
 
+   /// Reorder the triangles of each triangle list primitive for the
+   /// post-transform vertex cache.  Strips are left alone.
+   static void optimizeVertexCache(S32 * primitivesIn, S32 numPrimIn, S16 * indicesIn);
+   static void optimizeTriangleOrder(S16 * indices, S32 numIndices);
+
    /// methods used during assembly to share vertexand other info
    /// between meshes (and for skipping detail levels on load)
    S32 * getSharedData32(S32 parentMesh, S32 size, S32 ** source, bool skip);
@@ -269,12 +324,34 @@ class TSMesh
       VECTOR_SET_ASSOCIATION(planeConstants);
       VECTOR_SET_ASSOCIATION(planeMaterials);
       parentMesh = -1;
+      mVertexBufferObject = 0;
+      mIndexBufferObject = 0;
+      mBufferGeneration = 0;
+      mBufferLightmapOffset = 0;
    }
    virtual ~TSMesh();
 };
 
 inline const Point3F & TSMesh::decodeNormal(U8 ncode) { return smU8ToNormalTable[ncode]; }
 
+class TSSkinMesh;
+
+/// Skinned verts and normals of one TSSkinMesh for one shape instance,
+/// along with the bone transforms they came from, so an instance whose pose
+/// hasn't changed isn't skinned again.
+struct TSSkinCache
+{
+   const TSSkinMesh * mesh;       ///< Mesh the cache was filled from, NULL if empty.
+   U32 meshSerial;                ///< TSSkinMesh::smMeshSerial when it was filled.
+   Vector<MatrixF> boneTransforms;
+   Vector<MatrixF> pendingBones;  ///< Scratch for the pose being tested.
+   Vector<Point3F> verts;
+   Vector<Point3F> norms;
+   Vector<Point3F> decodedNorms;  ///< Initial normals, if the mesh uses encoded ones.
+
+   TSSkinCache() : mesh(NULL), meshSerial(0) {}
+};
+
 class TSSkinMesh : public TSMesh
 {
 public:
@@ -299,6 +376,27 @@ public:
    /// set verts and normals...
    void updateSkin();
 
+   /// Skins into cache for the given node transforms, unless the cache
+   /// already holds this mesh in the same pose.  Only touches the cache, so
+   /// instances can be skinned on worker threads as long as no two share one.
+   void updateSkinCache(TSSkinCache & cache, const MatrixF * nodeTransforms);
+
+   /// $pref::TS::skinCache, keep skinned verts per instance.
+   static bool smUseSkinCache;
+
+   /// Set by TSShapeInstance::MeshObjectInstance::render() while the mesh
+   /// is rendered, render() then skins into it rather than shared scratch.
+   static TSSkinCache * smCurrentCache;
+
+   /// Bumped whenever skins are freed while their shape lives on (see
+   /// TSShape::unloadLazyDetail), since a new skin could then turn up at a
+   /// cached mesh's old address.
+   static U32 smMeshSerial;
+
+   void computeBoneTransforms(const MatrixF * nodeTransforms, MatrixF * boneTransforms);
+   void skinVerts(const MatrixF * boneTransforms, const Point3F * initNorms,
+                  Point3F * outVerts, Point3F * outNorms, S32 numVerts);
+
    // render methods..
    void render(S32 frame, S32 matFrame, TSMaterialList *);
    void renderShadow(S32 frame, const MatrixF & mat, S32 dim, U32 * bits, TSMaterialList *);
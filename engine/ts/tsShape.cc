@@ -11,9 +11,16 @@
 #include "collision/convex.h"
 #include "platform/platformGL.h"
 #include "util/safeDelete.h"
+#include "ts/tsSortedMesh.h"
+#include "ts/tsDecal.h"
+#include "core/fileStream.h"
+#include "core/crc.h"
+#include "platform/platformThread.h"
+#include "platform/profiler.h"
 
 /// most recent version -- this is the version we write
-S32 TSShape::smVersion = 25;
+/// version 26 adds compressed node keyframes after the material list
+S32 TSShape::smVersion = 26;
 /// the version currently being read...valid only during a read
 S32 TSShape::smReadVersion = -1;
 const U32 TSShape::smMostRecentExporterVersion = DTS_EXPORTER_CURRENT_VERSION;
@@ -30,6 +37,14 @@ S32 TSShape::smNumSkipLoadDetails = 0;
 
 bool TSShape::smInitOnRead = true;
 
+bool TSShape::smBakeShapes = false;
+
+bool TSShape::smLazyDetails = false;
+S32  TSShape::smLazyDetailBudget = 16384;
+S32  TSShape::smLazyDetailIdleMs = 5000;
+U32  TSShape::smLazyResidentBytes = 0;
+Vector<TSShape*> TSShape::smLazyShapes(__FILE__, __LINE__);
+
 
 TSShape::TSShape()
 {
@@ -42,6 +57,10 @@ TSShape::TSShape()
    mVertexBuffer = (U32)-1;
    mCallbackKey = (U32)-1;
 
+   mLoadLazy = false;
+   mLazyShared = false;
+   mLazySkins = false;
+
    VECTOR_SET_ASSOCIATION(sequences);
    VECTOR_SET_ASSOCIATION(billboardDetails);
    VECTOR_SET_ASSOCIATION(detailCollisionAccelerators);
@@ -102,6 +121,17 @@ TSShape::~TSShape()
    delete [] mMemoryBlock;
    mMemoryBlock = NULL;
 
+   // the paged in meshes were destroyed with the rest above
+   for (i=0; i<mLazyDetails.size(); i++)
+      if (mLazyDetails[i].block)
+      {
+         smLazyResidentBytes -= mLazyDetails[i].size;
+         delete [] mLazyDetails[i].block;
+      }
+   for (i=0; i<smLazyShapes.size(); i++)
+      if (smLazyShapes[i]==this)
+         smLazyShapes.erase_fast(i--);
+
    if (mVertexBuffer != -1)
       if (dglDoesSupportVertexBuffer())
          glFreeVertexBufferEXT(mVertexBuffer);
@@ -323,6 +353,9 @@ void TSShape::init()
          count += 2;
          continue;
       }
+      if (!isDetailResident(i))
+         // keep the count from the file until the meshes are here
+         continue;
       S32 start = subShapeFirstObject[ss];
       S32 end   = start + subShapeNumObjects[ss];
       for (j=start; j<end; j++)
@@ -367,12 +400,19 @@ void TSShape::init()
       S32 maxSize = 0;
       for (S32 dl=0; dl<obj->numMeshes; dl++)
       {
-         TSMesh * mesh = meshes[obj->startMeshIndex+dl];
+         S32 meshIndex = obj->startMeshIndex+dl;
+         TSMesh * mesh = meshes[meshIndex];
          if (mesh)
          {
             mesh->mergeBufferStart = mMergeBufferSize;
             maxSize = getMax((S32)maxSize,(S32)mesh->mergeIndices.size());
          }
+         if (meshIndex<mLazyMeshes.size() && mLazyMeshes[meshIndex].detail>=0)
+         {
+            // make room for it whether it's paged in or not
+            mLazyMeshes[meshIndex].mergeBufferStart = mMergeBufferSize;
+            maxSize = getMax(maxSize,mLazyMeshes[meshIndex].mergeSize);
+         }
       }
       mMergeBufferSize += maxSize;
    }
@@ -853,17 +893,36 @@ void TSShape::assembleShape()
    // read in the meshes (sans skins)...
    if (smReadVersion>15)
    {
+      setupLazyDetails(numMeshes,skipDL);
+
       // straight forward read one at a time
       ptr32 = alloc.allocShape32(numMeshes + numSkins*numDetails); // leave room for skins on old shapes
       S32 curObject = 0, curDecal = 0; // for tracking skipped meshes
       for (i=0; i<numMeshes; i++)
       {
          bool skip = checkSkip(i,curObject,curDecal,skipDL); // skip this mesh?
+
+         // meshes of deferred details are skipped for now, but we note
+         // where they are so loadLazyDetail can come back for them
+         LazyMesh * lazy = (!skip && mLazyMeshes.size() && mLazyMeshes[i].detail>=0) ? &mLazyMeshes[i] : NULL;
+         if (lazy)
+         {
+            skip = true;
+            alloc.getReadPosition(lazy->position);
+         }
+
          S32 meshType = alloc.get32();
          TSMesh * mesh = TSMesh::assembleMesh(meshType,skip);
          if (ptr32)
             ptr32[i] = skip ?  0 : (S32)mesh;
 
+         if (lazy && mesh)
+         {
+            lazy->mergeSize = mesh->mergeIndices.size();
+            mLazySkins |= meshType==TSMesh::SkinMeshType;
+            mLazyShared |= mesh->parentMesh>=0;
+         }
+
          // fill in location of verts, tverts, and normals for detail levels
          if (mesh && meshType!=TSMesh::DecalMeshType)
          {
@@ -1186,6 +1245,8 @@ void TSShape::disassembleShape()
 //-------------------------------------------------
 void TSShape::write(Stream * s)
 {
+   loadAllDetails();
+
    // write version
    s->write(smVersion | (mExporterVersion<<16));
 
@@ -1234,6 +1295,9 @@ void TSShape::write(Stream * s)
    // write material list - write will properly endian-flip.
    materialList->write(*s);
 
+   // write compressed keyframes - write will properly endian-flip.
+   writeKeyTracks(s);
+
    delete [] buffer32;
    delete [] buffer16;
    delete [] buffer8;
@@ -1243,7 +1307,7 @@ void TSShape::write(Stream * s)
 // read whole shape
 //-------------------------------------------------
 
-bool TSShape::read(Stream * s)
+bool TSShape::read(Stream * s, const char * bakedName)
 {
    // read version - read handles endian-flip
    s->read(&smReadVersion);
@@ -1258,11 +1322,14 @@ bool TSShape::read(Stream * s)
       return false;
    }
    mReadVersion = smReadVersion;
+   mLoadLazy = mLoadLazy && mReadVersion>=19;
 
    S32 * memBuffer32;
    S16 * memBuffer16;
    S8 * memBuffer8;
    S32 count32, count16, count8;
+   U32 tailStart = 0, tailEnd = 0;
+   bool ownBuffer = true;
    if (mReadVersion<19)
    {
    	Con::printf("... Shape with old version.");
@@ -1284,8 +1351,23 @@ bool TSShape::read(Stream * s)
          return false;
       }
 
-      S32 * tmp = new S32[sizeMemBuffer];
-      s->read(sizeof(S32)*sizeMemBuffer,(U8*)tmp);
+      // If the stream is memory mapped (and needs no endian flip) the
+      // buffers can be assembled straight out of the mapping.
+      S32 * tmp = NULL;
+#ifdef TORQUE_LITTLE_ENDIAN
+      tmp = (S32*)s->readDirect(sizeof(S32)*sizeMemBuffer);
+      if (tmp && (size_t(tmp) & 3))
+      {
+         s->setPosition(s->getPosition() - sizeof(S32)*sizeMemBuffer);
+         tmp = NULL;
+      }
+#endif
+      ownBuffer = tmp == NULL;
+      if (ownBuffer)
+      {
+         tmp = new S32[sizeMemBuffer];
+         s->read(sizeof(S32)*sizeMemBuffer,(U8*)tmp);
+      }
       memBuffer32 = tmp;
       memBuffer16 = (S16*)(tmp+startU16);
       memBuffer8  = (S8*)(tmp+startU8);
@@ -1294,48 +1376,476 @@ bool TSShape::read(Stream * s)
       count16 = startU8-startU16;
       count8  = sizeMemBuffer-startU8;
 
-      // read sequences
-      S32 numSequences;
-      s->read(&numSequences);
-      sequences.setSize(numSequences);
-      for (i=0; i<numSequences; i++)
-      {
-         constructInPlace(&sequences[i]);
-         sequences[i].read(s);
-      }
-
-      // read material list
-      delete materialList; // just in case...
-      materialList = new TSMaterialList;
-      materialList->read(*s);
+      tailStart = s->getPosition();
+      readTail(s);
+      tailEnd = s->getPosition();
    }
 
+   // Old shapes get patched up while they're assembled, which a replay
+   // wouldn't repeat, so only bake the current layout.
+   bool bake = bakedName && mReadVersion>=23 && StringTable && s->hasCapability(Stream::StreamPosition);
+
 	// since we read in the buffers, we need to endian-flip their entire contents...
-   fixEndian(memBuffer32,memBuffer16,memBuffer8,count32,count16,count8);
+   if (ownBuffer)
+      fixEndian(memBuffer32,memBuffer16,memBuffer8,count32,count16,count8);
 
    alloc.setRead(memBuffer32,memBuffer16,memBuffer8,true);
    assembleShape(); // determine size of buffer needed
+   if (mLoadLazy && mLazyShared)
+   {
+      // a deferred mesh needs another's data...load the whole thing
+      mLoadLazy = false;
+      alloc.setRead(memBuffer32,memBuffer16,memBuffer8,true);
+      assembleShape();
+   }
    S32 buffSize = alloc.getSize();
    alloc.doAlloc();
    mMemoryBlock = alloc.getBuffer();
    alloc.setRead(memBuffer32,memBuffer16,memBuffer8,false);
+   alloc.setRecord(bake);
    assembleShape(); // copy to buffer
    AssertFatal(alloc.getSize()==buffSize,"TSShape::read: shape data buffer size mis-calculated");
 
+   // Bake now, before init() and friends change the block.
+   if (bake)
+   {
+      writeBaked(bakedName,s,tailStart,tailEnd,buffSize);
+      alloc.setRecord(false);
+   }
+
    if (smReadVersion<19)
    {
       delete [] memBuffer32;
       delete [] memBuffer16;
       delete [] memBuffer8;
    }
-   else
+   else if (ownBuffer)
       delete [] memBuffer32; // this covers all the buffers
 
+   mLoadLazy = false;
+
+   if (smCompressOnLoad)
+      compressSequences(smCompressRotationTol,smCompressTranslationTol);
+
    if (smInitOnRead)
       init();
    return true;
 }
 
+void TSShape::readTail(Stream * s)
+{
+   // read sequences
+   S32 numSequences;
+   s->read(&numSequences);
+   sequences.setSize(numSequences);
+   for (S32 i=0; i<numSequences; i++)
+   {
+      constructInPlace(&sequences[i]);
+      sequences[i].read(s);
+   }
+
+   // read material list
+   delete materialList; // just in case...
+   materialList = new TSMaterialList;
+   materialList->read(*s);
+
+   // read compressed keyframes
+   sequenceKeyTracks.clear();
+   keyTrackOffsets.clear();
+   keyTrackData.clear();
+   if (smReadVersion>25 && !readKeyTracks(s))
+   {
+      Con::errorf(ConsoleLogEntry::General, "Error: bad compressed keyframes in shape file.");
+      sequenceKeyTracks.clear();
+   }
+}
+
+//-------------------------------------------------
+// baked shapes
+//-------------------------------------------------
+
+U32 TSShape::getBakeKey()
+{
+   // everything that changes what assembleShape leaves in the block
+   U32 key[] =
+   {
+      smVersion,
+      sizeof(void*),
+      sizeof(TSMesh),
+      sizeof(TSSkinMesh),
+      sizeof(TSDecalMesh),
+      sizeof(TSSortedMesh),
+      TSMesh::smUseTriangles,
+      TSMesh::smUseOneStrip,
+      TSMesh::smUseEncodedNormals,
+      TSMesh::smOptimizeVertexCache,
+      smNumSkipLoadDetails
+   };
+   return calculateCRC(key,sizeof(key));
+}
+
+void TSShape::writeBaked(const char * bakedName, Stream * source, U32 tailStart, U32 tailEnd, S32 blockSize)
+{
+   // the sequences, materials and keyframes are kept as they were in the .dts
+   U32 tailSize = tailEnd - tailStart;
+   U8 * tail = new U8[tailSize];
+   U32 pos = source->getPosition();
+   bool gotTail = source->setPosition(tailStart) && source->read(tailSize,tail);
+   source->setPosition(pos);
+
+   FileStream fs;
+   if (!gotTail || !ResourceManager->openFileForWrite(fs,bakedName))
+   {
+      delete [] tail;
+      return;
+   }
+
+   const Vector<S32> & record32 = alloc.getRecord32();
+   const Vector<S16> & record16 = alloc.getRecord16();
+   const Vector<S8>  & record8  = alloc.getRecord8();
+
+   fs.write(U32(BakedMagic));
+   fs.write(U32(BakedVersion));
+   fs.write(getBakeKey());
+   fs.write(U32(mReadVersion | (mExporterVersion << 16)));
+   fs.write(U32(record32.size()));
+   fs.write(U32(record16.size()));
+   fs.write(U32(record8.size()));
+   fs.write(U32(blockSize));
+   fs.write(tailSize);
+
+   fs.write(record32.size()*sizeof(S32),record32.address());
+   fs.write(record16.size()*sizeof(S16),record16.address());
+   fs.write(record8.size(),record8.address());
+   fs.write(blockSize,mMemoryBlock);
+   fs.write(tailSize,tail);
+   fs.close();
+
+   delete [] tail;
+}
+
+bool TSShape::readBaked(Stream * s)
+{
+   // nothing to clean up in the destructor if we bail
+   meshes.set(NULL,0);
+   decals.set(NULL,0);
+
+   U32 magic, version, key, readVersion, count32, count16, count8, blockSize, tailSize;
+   s->read(&magic);
+   s->read(&version);
+   s->read(&key);
+   s->read(&readVersion);
+   s->read(&count32);
+   s->read(&count16);
+   s->read(&count8);
+   s->read(&blockSize);
+   if (!s->read(&tailSize) || magic!=BakedMagic || version!=BakedVersion || key!=getBakeKey() ||
+       (readVersion & 0xFF)>smVersion || !StringTable)
+      return false;
+
+   smReadVersion = mReadVersion = readVersion & 0xFF;
+   mExporterVersion = readVersion >> 16;
+
+   // the recorded values are small...the block is the whole shape
+   U32 recordSize = count32*sizeof(S32) + count16*sizeof(S16) + count8;
+   S8 * record = new S8[recordSize];
+   mMemoryBlock = new S8[blockSize];
+   if (!s->read(recordSize,record) || !s->read(blockSize,mMemoryBlock))
+   {
+      delete [] record;
+      return false;
+   }
+
+   readTail(s);
+
+   alloc.setBaked((S32*)record,
+                  (S16*)(record + count32*sizeof(S32)),
+                  record + count32*sizeof(S32) + count16*sizeof(S16),
+                  mMemoryBlock);
+   assembleShape(); // fix up pointers into the block
+   AssertFatal(alloc.getSize()==blockSize,"TSShape::readBaked: baked shape doesn't match its block");
+   delete [] record;
+
+   if (smCompressOnLoad)
+      compressSequences(smCompressRotationTol,smCompressTranslationTol);
+
+   if (smInitOnRead)
+      init();
+   return true;
+}
+
+//-------------------------------------------------
+// lazy details
+//-------------------------------------------------
+
+void TSShape::setupLazyDetails(S32 numMeshes, S32 skipDL)
+{
+   mLazyMeshes.clear();
+   mLazyDetails.clear();
+   mLazyDetailMeshes.clear();
+   mLazyDetailIndex.clear();
+   mLazyShared = false;
+   mLazySkins = false;
+   if (!mLoadLazy || decals.size())
+      return;
+
+   // the lowest detail with meshes stays loaded, and so does everything
+   // after it (collision and LOS details)
+   S32 keepDL = -1;
+   S32 dl;
+   for (dl=0; dl<=mSmallestVisibleDL && dl<details.size(); dl++)
+      if (details[dl].subShapeNum>=0)
+         keepDL = dl;
+   if (keepDL<=skipDL)
+      return;
+
+   mLazyMeshes.setSize(numMeshes);
+   for (S32 i=0; i<numMeshes; i++)
+   {
+      mLazyMeshes[i].detail = -1;
+      mLazyMeshes[i].mergeSize = 0;
+      mLazyMeshes[i].mergeBufferStart = 0;
+   }
+   mLazyDetailIndex.setSize(details.size());
+   for (dl=0; dl<details.size(); dl++)
+      mLazyDetailIndex[dl] = -1;
+
+   for (dl=skipDL; dl<keepDL; dl++)
+   {
+      S32 ss = details[dl].subShapeNum;
+      S32 od = details[dl].objectDetailNum;
+      if (ss<0)
+         // billboard
+         continue;
+
+      bool keep = false;
+      S32 index = -1;
+      S32 k;
+      for (k=keepDL; k<details.size(); k++)
+         keep |= details[k].subShapeNum==ss && details[k].objectDetailNum==od;
+      for (k=0; k<mLazyDetails.size(); k++)
+         if (mLazyDetails[k].subShapeNum==ss && mLazyDetails[k].objectDetailNum==od)
+            index = k;
+      if (keep)
+         continue;
+
+      if (index<0)
+      {
+         index = mLazyDetails.size();
+         mLazyDetails.increment();
+         LazyDetail & ld = mLazyDetails.last();
+         ld.subShapeNum = ss;
+         ld.objectDetailNum = od;
+         ld.firstMesh = mLazyDetailMeshes.size();
+         ld.numMeshes = 0;
+         ld.block = NULL;
+         ld.size = 0;
+         ld.lastUsed = 0;
+
+         S32 start = subShapeFirstObject[ss];
+         S32 end   = start + subShapeNumObjects[ss];
+         for (S32 j=start; j<end; j++)
+         {
+            S32 meshIndex = objects[j].startMeshIndex + od;
+            if (od<objects[j].numMeshes && meshIndex<numMeshes)
+            {
+               mLazyDetailMeshes.push_back(meshIndex);
+               mLazyMeshes[meshIndex].detail = index;
+               ld.numMeshes++;
+            }
+         }
+      }
+      mLazyDetailIndex[dl] = index;
+   }
+
+   // skipped details are drawn with the first one we load (see init)
+   for (dl=0; dl<skipDL; dl++)
+      mLazyDetailIndex[dl] = mLazyDetailIndex[skipDL];
+
+   if (!mLazyDetails.size())
+   {
+      mLazyMeshes.clear();
+      mLazyDetailIndex.clear();
+   }
+}
+
+bool TSShape::isDetailResident(S32 dl) const
+{
+   S32 index = dl>=0 && dl<mLazyDetailIndex.size() ? mLazyDetailIndex[dl] : -1;
+   return index<0 || mLazyDetails[index].block!=NULL;
+}
+
+bool TSShape::requestDetail(S32 dl)
+{
+   S32 index = dl>=0 && dl<mLazyDetailIndex.size() ? mLazyDetailIndex[dl] : -1;
+   if (index<0 || !Thread::isMainThread())
+      return false;
+
+   LazyDetail & ld = mLazyDetails[index];
+   if (ld.block)
+   {
+      ld.lastUsed = Platform::getRealMilliseconds();
+      return false;
+   }
+   return loadLazyDetail(index);
+}
+
+void TSShape::loadAllDetails()
+{
+   for (S32 i=0; i<mLazyDetails.size(); i++)
+      if (!mLazyDetails[i].block)
+         loadLazyDetail(i);
+}
+
+bool TSShape::loadLazyDetail(S32 index)
+{
+   LazyDetail & ld = mLazyDetails[index];
+   AssertFatal(!ld.block,"TSShape::loadLazyDetail: already loaded");
+
+   Stream * s = mSourceResource ? ResourceManager->openStream(mSourceResource) : NULL;
+   if (!s)
+   {
+      Con::errorf(ConsoleLogEntry::General, "Error: unable to reopen shape to page in detail %i.",index);
+      return false;
+   }
+
+   PROFILE_START(TSShape_loadLazyDetail);
+
+   S32 readVersion;
+   U32 sizeMemBuffer, startU16, startU8;
+   s->read(&readVersion);
+   s->read(&sizeMemBuffer);
+   s->read(&startU16);
+   s->read(&startU8);
+   if (s->getStatus()!=Stream::Ok || (readVersion & 0xFF)!=mReadVersion)
+   {
+      ResourceManager->closeStream(s);
+      PROFILE_END();
+      return false;
+   }
+
+   // same as read()...use the mapping if we can
+   S32 * tmp = NULL;
+#ifdef TORQUE_LITTLE_ENDIAN
+   tmp = (S32*)s->readDirect(sizeof(S32)*sizeMemBuffer);
+   if (tmp && (size_t(tmp) & 3))
+      tmp = NULL;
+#endif
+   bool ownBuffer = tmp == NULL;
+   if (ownBuffer)
+   {
+      s->setPosition(4*sizeof(U32));
+      tmp = new S32[sizeMemBuffer];
+      s->read(sizeof(S32)*sizeMemBuffer,(U8*)tmp);
+      fixEndian(tmp,(S16*)(tmp+startU16),(S8*)(tmp+startU8),startU16,startU8-startU16,sizeMemBuffer-startU8);
+   }
+   S32 * memBuffer32 = tmp;
+   S16 * memBuffer16 = (S16*)(tmp+startU16);
+   S8  * memBuffer8  = (S8*)(tmp+startU8);
+
+   // size the meshes, then copy them in...one block for the lot
+   smReadVersion = mReadVersion;
+   const S32 * lazyMeshes = &mLazyDetailMeshes[ld.firstMesh];
+   for (S32 pass=0; pass<2; pass++)
+   {
+      if (pass)
+         alloc.doAlloc();
+      for (S32 i=0; i<ld.numMeshes; i++)
+      {
+         LazyMesh & lazy = mLazyMeshes[lazyMeshes[i]];
+         alloc.setRead(memBuffer32,memBuffer16,memBuffer8,pass==0 && i==0);
+         alloc.setReadPosition(lazy.position);
+         S32 meshType = alloc.get32();
+         TSMesh * mesh = TSMesh::assembleMesh(meshType,false);
+         if (pass && mesh)
+         {
+            mesh->mergeBufferStart = lazy.mergeBufferStart;
+            meshes[lazyMeshes[i]] = mesh;
+         }
+      }
+   }
+   ld.block = alloc.getBuffer();
+   ld.size = alloc.getSize();
+   ld.lastUsed = Platform::getRealMilliseconds();
+
+   if (ownBuffer)
+      delete [] tmp;
+   ResourceManager->closeStream(s);
+
+   // now that the meshes are here we can count them
+   S32 count = 0;
+   for (S32 i=0; i<ld.numMeshes; i++)
+      if (meshes[lazyMeshes[i]])
+         count += meshes[lazyMeshes[i]]->getNumPolys();
+   for (S32 dl=0; dl<mLazyDetailIndex.size(); dl++)
+      if (mLazyDetailIndex[dl]==index)
+         details[dl].polyCount = count;
+
+   bool listed = false;
+   for (S32 i=0; i<smLazyShapes.size(); i++)
+      listed |= smLazyShapes[i]==this;
+   if (!listed)
+      smLazyShapes.push_back(this);
+   smLazyResidentBytes += ld.size;
+   trimLazyDetails();
+
+   PROFILE_END();
+   return true;
+}
+
+void TSShape::unloadLazyDetail(S32 index)
+{
+   LazyDetail & ld = mLazyDetails[index];
+   if (!ld.block)
+      return;
+
+   const S32 * lazyMeshes = &mLazyDetailMeshes[ld.firstMesh];
+   for (S32 i=0; i<ld.numMeshes; i++)
+   {
+      if (meshes[lazyMeshes[i]])
+         destructInPlace(meshes[lazyMeshes[i]]);
+      meshes[lazyMeshes[i]] = NULL;
+   }
+   delete [] ld.block;
+   ld.block = NULL;
+   smLazyResidentBytes -= ld.size;
+   ld.size = 0;
+   TSSkinMesh::smMeshSerial++;
+}
+
+void TSShape::trimLazyDetails()
+{
+   // never anything used in the last little while, it could still be in
+   // the middle of being drawn
+   U32 now  = Platform::getRealMilliseconds();
+   U32 idle = getMax(smLazyDetailIdleMs,100);
+   while (smLazyResidentBytes > U32(getMax(smLazyDetailBudget,0))*1024)
+   {
+      TSShape * oldestShape = NULL;
+      S32 oldest = -1;
+      U32 oldestAge = 0;
+      for (S32 i=0; i<smLazyShapes.size(); i++)
+      {
+         TSShape * shape = smLazyShapes[i];
+         for (S32 j=0; j<shape->mLazyDetails.size(); j++)
+         {
+            const LazyDetail & ld = shape->mLazyDetails[j];
+            U32 age = now - ld.lastUsed;
+            if (ld.block && age>=idle && age>=oldestAge)
+            {
+               oldestShape = shape;
+               oldest = j;
+               oldestAge = age;
+            }
+         }
+      }
+      if (!oldestShape)
+         // everything's in use...stay over budget for now
+         break;
+      oldestShape->unloadLazyDetail(oldest);
+   }
+}
+
 void TSShape::fixEndian(S32 * buff32, S16 * buff16, S8 *, S32 count32, S32 count16, S32)
 {
 	// if endian-ness isn't the same, need to flip the buffer contents.
@@ -1458,11 +1968,54 @@ void TSShape::readIflMaterials(const char* shapePath)
    mFlags |= IflInit;
 }
 
-ResourceInstance *constructTSShape(Stream &stream)
+ResourceInstance *constructTSShape(Stream &stream, ResourceObject *obj)
 {
+   MemoryTagScope tagScope(Memory::TagShape);
+
+   // Baked images are raw little endian memory, and are looked up and
+   // written through the resource manager, so only on the main thread.
+   char bakedName[1024];
+   bool bake = false;
+#ifdef TORQUE_LITTLE_ENDIAN
+   bake = TSShape::smBakeShapes && obj && Thread::isMainThread();
+#endif
+
+   // Lazy details page in from the resource later, so they need one, and
+   // the baked block would be missing them.
+   bool lazy = TSShape::smLazyDetails && obj;
+   if (lazy)
+      bake = false;
+
+   if (bake)
+   {
+      if (obj->path && obj->path[0])
+         dStrcpyl(bakedName, sizeof(bakedName), obj->path, "/", obj->name, ".baked", NULL);
+      else
+         dStrcpyl(bakedName, sizeof(bakedName), obj->name, ".baked", NULL);
+
+      ResourceObject *rBaked = ResourceManager->find(bakedName);
+      if (rBaked)
+      {
+         FileTime bakedTime, shapeTime;
+         rBaked->getFileTimes(NULL, &bakedTime);
+         obj->getFileTimes(NULL, &shapeTime);
+         Stream *bs = Platform::compareFileTimes(bakedTime, shapeTime) >= 0 ? ResourceManager->openStream(rBaked) : NULL;
+         if (bs)
+         {
+            TSShape * baked = new TSShape;
+            bool ok = baked->readBaked(bs);
+            ResourceManager->closeStream(bs);
+            if (ok)
+               return baked;
+            delete baked;
+         }
+      }
+   }
+
    TSShape * ret = new TSShape;
-   
-   if (!ret->read(&stream))
+   ret->mLoadLazy = lazy;
+
+   if (!ret->read(&stream, bake ? bakedName : NULL))
    {
       // Failed, so clean up and set to NULL so we'll return NULL.
       SAFE_DELETE(ret);
@@ -333,6 +333,23 @@ class TSShape : public ResourceInstance
    Vector<const char *>             names;
    /// @}
 
+   /// @name Compressed node keyframes
+   /// Node rotations and translations of a sequence can be kept keyframe
+   /// reduced and quantized here instead of in nodeRotations and
+   /// nodeTranslations (see compressSequences()).  The tracks of a sequence
+   /// follow each other in keyTrackData, rotations first, and each one is
+   /// its key count, the frame number of each kept key, and then the keys.
+   /// @{
+   struct SequenceKeyTracks
+   {
+      S32 firstRotation;     ///< First of the sequence's tracks in keyTrackOffsets, -1 if raw.
+      S32 firstTranslation;
+   };
+   Vector<SequenceKeyTracks>        sequenceKeyTracks;  ///< Per sequence, may be shorter than sequences.
+   Vector<U32>                      keyTrackOffsets;    ///< Start of each track in keyTrackData.
+   Vector<U16>                      keyTrackData;
+   /// @}
+
    /// Memory block for data storage.
    ///
    /// Most vectors are stored in a single memory block
@@ -392,7 +409,7 @@ class TSShape : public ResourceInstance
    /// @{
 
    QuatF & getRotation(const Sequence & seq, S32 keyframeNum, S32 rotNum, QuatF *) const;
-   const Point3F & getTranslation(const Sequence & seq, S32 keyframeNum, S32 tranNum) const;
+   Point3F getTranslation(const Sequence & seq, S32 keyframeNum, S32 tranNum) const;
    F32 getUniformScale(const Sequence & seq, S32 keyframeNum, S32 scaleNum) const;
    const Point3F & getAlignedScale(const Sequence & seq, S32 keyframeNum, S32 scaleNum) const;
    TSScale & getArbitraryScale(const Sequence & seq, S32 keyframeNum, S32 scaleNum, TSScale *) const;
@@ -400,6 +417,35 @@ class TSShape : public ResourceInstance
    const DecalState & getDecalState(const Sequence & seq, S32 keyframeNum, S32 decalNum) const;
    /// @}
 
+   /// @name Keyframe Compression
+   /// @{
+
+   /// Returns the compressed tracks of seq, or NULL if its keys are raw.
+   const SequenceKeyTracks * getKeyTracks(const Sequence & seq) const;
+   bool hasCompressedSequences() const;
+
+   /// Keyframe reduces and quantizes the node rotations and translations of
+   /// every sequence that isn't compressed yet, and drops their raw keys.
+   ///
+   /// Rotations are packed in 48 bits (smallest three components), and
+   /// translations in 16 bits per axis over each track's range.  A key is
+   /// only kept if interpolating between its neighbours would be off by more
+   /// than rotTol radians or transTol shape units at some frame.
+   ///
+   /// @returns bytes saved.
+   S32 compressSequences(F32 rotTol, F32 transTol);
+
+   QuatF & getKeyTrackRotation(S32 track, S32 keyframeNum, QuatF *) const;
+   Point3F getKeyTrackTranslation(S32 track, S32 keyframeNum) const;
+
+   /// Compress shapes as they are loaded ($pref::TS::compressAnimations),
+   /// with these tolerances ($pref::TS::compressRotationTol and
+   /// $pref::TS::compressTranslationTol).
+   static bool smCompressOnLoad;
+   static F32  smCompressRotationTol;
+   static F32  smCompressTranslationTol;
+   /// @}
+
    /// build LOS collision detail
    void computeAccelerator(S32 dl);
    bool buildConvexHull(S32 dl) const;
@@ -451,6 +497,106 @@ class TSShape : public ResourceInstance
    /// by default we initialize shape when we read...
    static bool smInitOnRead;
 
+   /// @name Baked Shapes
+   ///
+   /// With $pref::TS::bakeShapes on, loading shape.dts also writes
+   /// shape.dts.baked: the assembled shape data exactly as it sits in
+   /// mMemoryBlock, plus the few values assembleShape() reads to set up the
+   /// pointers into it.  Later loads read the block in one go and only run
+   /// the pointer fixups (see TSShapeAlloc::setBaked) instead of sizing
+   /// and copying the whole shape.  A baked file is only used when it's
+   /// newer than the shape and was made by a build with the same mesh
+   /// layout and load settings, otherwise it's rewritten.
+   /// @{
+
+   enum BakedConstants {
+      BakedMagic   = 0x4b425354,   ///< "TSBK"
+      BakedVersion = 1
+   };
+
+   static bool smBakeShapes;
+
+   /// Identifies what assembleShape() would put in the block with the
+   /// current build and settings.
+   static U32 getBakeKey();
+
+   bool readBaked(Stream *);
+   void writeBaked(const char *bakedName, Stream *source, U32 tailStart, U32 tailEnd, S32 blockSize);
+   /// @}
+
+   /// @name Lazy Details
+   ///
+   /// With $pref::TS::lazyDetails on, a shape loaded through the resource
+   /// manager only assembles the meshes of its lowest mesh detail, and of
+   /// anything that isn't a visible detail (collision and LOS), up front.
+   /// The meshes of the higher details are left out of mMemoryBlock, with
+   /// their slots in meshes NULL, and are read back in from the .dts the
+   /// first time an instance selects or renders that detail (see
+   /// requestDetail()).
+   ///
+   /// Paged in details are counted across all shapes, and once they add up
+   /// to more than $pref::TS::lazyDetailBudget KB the least recently used
+   /// ones that have been idle for $pref::TS::lazyDetailIdleMs are dropped
+   /// again.
+   ///
+   /// Shapes with decals or with meshes sharing a parent mesh's data are
+   /// always loaded whole, as are pre version 19 shapes.  Lazy shapes are
+   /// never baked.
+   /// @{
+
+   struct LazyMesh
+   {
+      S32 detail;                          ///< Into mLazyDetails, -1 if it's always loaded.
+      S32 mergeSize;
+      S32 mergeBufferStart;                ///< Computed by init() like every other mesh's.
+      TSShapeAlloc::ReadPosition position; ///< Of the mesh in the .dts buffers.
+   };
+
+   struct LazyDetail
+   {
+      S32 subShapeNum;
+      S32 objectDetailNum;
+      S32 firstMesh;                       ///< Into mLazyDetailMeshes.
+      S32 numMeshes;
+      S8 * block;                          ///< Holds the meshes while they're paged in, else NULL.
+      U32 size;
+      U32 lastUsed;                        ///< Real time, in ms.
+   };
+
+   bool mLoadLazy;                         ///< Set while reading a shape that may be lazy.
+   bool mLazyShared;                       ///< A mesh that would be deferred shares data, so load it whole.
+   bool mLazySkins;                        ///< Some deferred mesh is a skin.
+   Vector<LazyMesh>   mLazyMeshes;         ///< Per mesh, empty if the shape was loaded whole.
+   Vector<LazyDetail> mLazyDetails;
+   Vector<S32>        mLazyDetailMeshes;   ///< Indices into meshes, grouped by detail.
+   Vector<S32>        mLazyDetailIndex;    ///< Per detail, into mLazyDetails or -1.
+
+   static bool smLazyDetails;
+   static S32  smLazyDetailBudget;
+   static S32  smLazyDetailIdleMs;
+   static U32  smLazyResidentBytes;
+   static Vector<TSShape*> smLazyShapes;   ///< Shapes with details paged in.
+
+   bool hasLazyDetails() const { return mLazyDetails.size()!=0; }
+   bool hasLazySkinMeshes() const { return mLazySkins; }
+   bool isDetailResident(S32 dl) const;
+
+   /// Pages in the meshes of dl if they aren't already, and marks them used.
+   /// Only does anything on the main thread.
+   /// @returns true if they were just paged in.
+   bool requestDetail(S32 dl);
+
+   /// Pages in every detail, for when the whole shape is needed.
+   void loadAllDetails();
+
+   /// Drops idle details until they're back under budget.
+   static void trimLazyDetails();
+
+   void setupLazyDetails(S32 numMeshes, S32 skipDL);
+   bool loadLazyDetail(S32 index);
+   void unloadLazyDetail(S32 index);
+   /// @}
+
    /// @name Version Info
    /// @{
 
@@ -466,7 +612,12 @@ class TSShape : public ResourceInstance
    /// @{
 
    void write(Stream *);
-   bool read(Stream *);
+   /// Reads a .dts, writing a baked image of it to bakedName if given.
+   bool read(Stream *, const char * bakedName = NULL);
+   /// Sequences, materials and keyframes, which follow the shape data.
+   void readTail(Stream *);
+   void writeKeyTracks(Stream *);
+   bool readKeyTracks(Stream *);
    void readOldShape(Stream * s, S32 * &, S16 * &, S8 * &, S32 &, S32 &, S32 &);
    void writeName(Stream *, S32 nameIndex);
    S32  readName(Stream *, bool addName);
@@ -591,7 +742,7 @@ class TSMaterialList : public MaterialList
    /// @}
 };
 
-extern ResourceInstance *constructTSShape(Stream &stream);
+extern ResourceInstance *constructTSShape(Stream &stream, ResourceObject *obj);
 
 #define TSNode TSShape::Node
 #define TSObject TSShape::Object
@@ -599,13 +750,27 @@ extern ResourceInstance *constructTSShape(Stream &stream);
 #define TSSequence TSShape::Sequence
 #define TSDetail TSShape::Detail
 
+inline const TSShape::SequenceKeyTracks * TSShape::getKeyTracks(const Sequence & seq) const
+{
+   U32 index = U32(&seq - sequences.address());
+   if (index < U32(sequenceKeyTracks.size()) && sequenceKeyTracks[index].firstRotation>=0)
+      return &sequenceKeyTracks[index];
+   return NULL;
+}
+
 inline QuatF & TSShape::getRotation(const Sequence & seq, S32 keyframeNum, S32 rotNum, QuatF * quat) const
 {
+   const SequenceKeyTracks * tracks = getKeyTracks(seq);
+   if (tracks)
+      return getKeyTrackRotation(tracks->firstRotation + rotNum,keyframeNum,quat);
    return nodeRotations[seq.baseRotation + rotNum*seq.numKeyframes + keyframeNum].getQuatF(quat);
 }
 
-inline const Point3F & TSShape::getTranslation(const Sequence & seq, S32 keyframeNum, S32 tranNum) const
+inline Point3F TSShape::getTranslation(const Sequence & seq, S32 keyframeNum, S32 tranNum) const
 {
+   const SequenceKeyTracks * tracks = getKeyTracks(seq);
+   if (tracks)
+      return getKeyTrackTranslation(tracks->firstTranslation + tranNum,keyframeNum);
    return nodeTranslations[seq.baseTranslation + tranNum*seq.numKeyframes + keyframeNum];
 }
 
@@ -14,6 +14,10 @@ void TSShapeAlloc::setRead(S32 * memBuffer32, S16 * memBuffer16, S8 * memBuffer8
    mMemBuffer16 = memBuffer16;
    mMemBuffer8  = memBuffer8 ;
 
+   mBase32 = memBuffer32;
+   mBase16 = memBuffer16;
+   mBase8  = memBuffer8;
+
    mMemGuard32  = 0;
    mMemGuard16  = 0;
    mMemGuard8   = 0;
@@ -30,6 +34,49 @@ void TSShapeAlloc::setRead(S32 * memBuffer32, S16 * memBuffer16, S8 * memBuffer8
 
    setSkipMode(false);
    mMode = TSShapeAlloc::ReadMode;
+   mRecord = false;
+   mBaked = false;
+}
+
+void TSShapeAlloc::setBaked(S32 * record32, S16 * record16, S8 * record8, S8 * dest)
+{
+   setRead(record32,record16,record8,true);
+   mDest = dest;
+   mBaked = true;
+}
+
+void TSShapeAlloc::setRecord(bool record)
+{
+   readOnly();
+
+   mRecord = record;
+   mRecord32.clear();
+   mRecord16.clear();
+   mRecord8.clear();
+}
+
+void TSShapeAlloc::getReadPosition(ReadPosition & pos)
+{
+   readOnly();
+
+   pos.offset32 = mMemBuffer32 - mBase32;
+   pos.offset16 = mMemBuffer16 - mBase16;
+   pos.offset8  = mMemBuffer8  - mBase8;
+   pos.guard32  = mMemGuard32;
+   pos.guard16  = mMemGuard16;
+   pos.guard8   = mMemGuard8;
+}
+
+void TSShapeAlloc::setReadPosition(const ReadPosition & pos)
+{
+   readOnly();
+
+   mMemBuffer32 = mBase32 + pos.offset32;
+   mMemBuffer16 = mBase16 + pos.offset16;
+   mMemBuffer8  = mBase8  + pos.offset8;
+   mMemGuard32  = pos.guard32;
+   mMemGuard16  = S16(pos.guard16);
+   mMemGuard8   = S8(pos.guard8);
 }
 
 void TSShapeAlloc::setWrite()
@@ -71,6 +118,8 @@ void TSShapeAlloc::align32()
 type TSShapeAlloc::get##suffix()                              \
 {                                                             \
    readOnly();                                                \
+   if (mRecord)                                               \
+      mRecord##suffix.push_back(*mMemBuffer##suffix);         \
    return *(mMemBuffer##suffix++);                            \
 }                                                             \
                                                               \
@@ -78,7 +127,7 @@ void TSShapeAlloc::get##suffix(type * dest, S32 num)          \
 {                                                             \
    readOnly();                                                \
    dMemcpy(dest,mMemBuffer##suffix,sizeof(type)*num);         \
-   mMemBuffer##suffix += num;                                 \
+   getPointer##suffix(num);                                   \
 }                                                             \
                                                               \
 type * TSShapeAlloc::allocShape##suffix(S32 num)              \
@@ -95,13 +144,34 @@ type * TSShapeAlloc::getPointer##suffix(S32 num)              \
 {                                                             \
    readOnly();                                                \
    type * ret = (type*)mMemBuffer##suffix;                    \
+   if (mRecord && num)                                        \
+   {                                                          \
+      S32 pos = mRecord##suffix.size();                       \
+      mRecord##suffix.setSize(pos+num);                       \
+      dMemcpy(mRecord##suffix.address()+pos,ret,sizeof(type)*num); \
+   }                                                          \
    mMemBuffer##suffix += num;                                 \
    return ret;                                                \
 }                                                             \
                                                               \
+void TSShapeAlloc::skip##suffix(S32 num)                      \
+{                                                             \
+   readOnly();                                                \
+   if (!mBaked)                                               \
+      mMemBuffer##suffix += num;                              \
+}                                                             \
+                                                              \
 type * TSShapeAlloc::copyToShape##suffix(S32 num, bool returnSomething) \
 {                                                             \
    readOnly();                                                \
+   if (mBaked)                                                \
+   {                                                          \
+      /* already in place, and not part of the recording */   \
+      type * ret = (type*)mDest;                              \
+      mDest += mMult*num*sizeof(type);                        \
+      mSize += mMult*num*sizeof(type);                        \
+      return ret;                                             \
+   }                                                          \
    type * ret = (!returnSomething || mDest) ? (type*)mDest : mMemBuffer##suffix; \
    if (mDest)                                                 \
    {                                                          \
@@ -12,6 +12,9 @@
 #ifndef _MMATH_H_
 #include "math/mMath.h"
 #endif
+#ifndef _TVECTOR_H_
+#include "core/tVector.h"
+#endif
 
 /// Alloc structure used in the reading/writing of shapes.
 ///
@@ -39,6 +42,18 @@
 /// 3. call getBuffer32 and getBufferSize32 to get 32-bit buffer and size.  Similarly for
 ///    16-bit, 8-bit (getBuffer16, getBuffer8).
 ///
+/// Baking:
+/// With setRecord(true) on the copy pass (step 4) everything handed out by the
+/// get and getPointer calls is also kept, so the pass can be replayed later
+/// without the original buffers.  setBaked() replays it: the input buffers are
+/// the recorded values and the destination buffer is one that was filled in on
+/// an earlier read, so copyToShape only moves along it.  See TSShape::readBaked.
+///
+/// Resuming:
+/// getReadPosition() notes where a read is up to, and setReadPosition() picks
+/// it up again on a later setRead() of the same buffers, so part of them can
+/// be assembled on its own (see TSShape::loadLazyDetail).
+///
 /// TSShape::assesmbleShape and TSShape::dissembleShape can be used as examples
 class TSShapeAlloc
 {
@@ -72,12 +87,33 @@ class TSShapeAlloc
    S32 mSize;
    S32 mMult; ///< mult incoming sizes by this (when 0, then mDest doesn't grow --> skip mode)
 
+   /// reading only...the buffers from setRead, for getReadPosition
+   S32 * mBase32;
+   S16 * mBase16;
+   S8  * mBase8;
+
+   /// reading only...baking
+   bool mRecord;             ///< keep what get/getPointer hand out
+   bool mBaked;              ///< mDest is already filled in
+   Vector<S32> mRecord32;
+   Vector<S16> mRecord16;
+   Vector<S8>  mRecord8;
+
    public:
 
    enum { ReadMode = 0, WriteMode = 1, PageSize = 1024 }; ///< PageSize must be multiple of 4 so that we can always
                                                           ///< "over-read" up to next dword
 
+   /// Offsets into the input buffers and the guard counts there.
+   struct ReadPosition
+   {
+      S32 offset32, offset16, offset8;
+      S32 guard32, guard16, guard8;
+   };
+
    void setRead(S32 * buff32, S16 * buff16, S8 * buff8, bool clear);
+   /// Replay a recorded read into dest, which already holds the assembled data.
+   void setBaked(S32 * record32, S16 * record16, S8 * record8, S8 * dest);
    void setWrite();
 
    // reading only...
@@ -86,6 +122,11 @@ class TSShapeAlloc
    S8 * getBuffer() { return mDest; }
    S32 getSize() { return mSize; }
    void setSkipMode(bool skip) { mMult = skip ? 0 : 1; }
+   bool isBaked() { return mBaked; }       ///< replaying into a filled in block
+   void setRecord(bool record);
+   void getReadPosition(ReadPosition &);
+   /// Moves on from the buffers given to setRead() to pos.
+   void setReadPosition(const ReadPosition & pos);
 
    /// @name Reading Operations:
    ///
@@ -97,6 +138,8 @@ class TSShapeAlloc
    ///
    /// getPointer(): gets pointer to next entries of type in input buffer (no effect on input buffer)
    ///
+   /// skip(): steps over entries of type in input buffer that aren't wanted (not recorded)
+   ///
    /// @note all operations advance current "position" of input and output buffers
    ///       writing operations:
    ///
@@ -115,6 +158,8 @@ class TSShapeAlloc
    void get##suffix(type*,S32);       \
    type * copyToShape##suffix(S32,bool returnSomething=false); \
    type * getPointer##suffix(S32);    \
+   void skip##suffix(S32);            \
+   const Vector<type> & getRecord##suffix() { return mRecord##suffix; } \
    type * allocShape##suffix(S32);    \
    bool checkGuard##suffix();         \
    type getPrevGuard##suffix();       \
@@ -0,0 +1,515 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "ts/tsShape.h"
+#include "ts/tsTransform.h"
+#include "core/stream.h"
+#include "console/console.h"
+
+// Keyframe reduced, quantized storage for node animation.
+//
+// A rotation track is laid out in keyTrackData as
+//
+//    numKeys, frame[numKeys], key[numKeys][3]
+//
+// with each key the three smallest quaternion components at 15 bits, and
+// the index of the largest in the top bits of the first two words.  A
+// translation track is
+//
+//    numKeys, frame[numKeys], min[3], step[3], key[numKeys][3]
+//
+// with min and step as floats split into two words each, and each key 16
+// bits per axis.  Between kept keys the decoder interpolates the same way
+// animateNodes() interpolates between frames.
+
+bool TSShape::smCompressOnLoad = false;
+F32  TSShape::smCompressRotationTol = 0.005f;
+F32  TSShape::smCompressTranslationTol = 0.001f;
+
+namespace {
+
+enum
+{
+   QuatKeyMax  = 0x7fff,
+   PointKeyMax = 0xffff,
+   MaxTrackFrames = 0xffff
+};
+
+// largest value the three smaller components of a unit quaternion can have
+const F32 sgQuatKeyRange = 0.70710678f;
+
+void packQuat(const QuatF & q, U16 * out)
+{
+   F32 c[4] = { q.x, q.y, q.z, q.w };
+   F32 lenSq = c[0]*c[0] + c[1]*c[1] + c[2]*c[2] + c[3]*c[3];
+   F32 invLen = lenSq > 0.0f ? 1.0f / mSqrt(lenSq) : 1.0f;
+
+   S32 largest = 0;
+   for (S32 i=1; i<4; i++)
+      if (mFabs(c[i]) > mFabs(c[largest]))
+         largest = i;
+
+   // q and -q are the same rotation, keep the largest one positive
+   if (c[largest] < 0.0f)
+      invLen = -invLen;
+
+   U16 v[3];
+   for (S32 i=0, j=0; i<4; i++)
+   {
+      if (i==largest)
+         continue;
+      F32 f = mClampF(c[i] * invLen, -sgQuatKeyRange, sgQuatKeyRange);
+      v[j++] = U16(mFloor((f / sgQuatKeyRange * 0.5f + 0.5f) * F32(QuatKeyMax) + 0.5f));
+   }
+
+   out[0] = v[0] | U16((largest & 1) << 15);
+   out[1] = v[1] | U16((largest >> 1) << 15);
+   out[2] = v[2];
+}
+
+void unpackQuat(const U16 * in, QuatF * q)
+{
+   S32 largest = (in[0] >> 15) | ((in[1] >> 15) << 1);
+
+   F32 v[3];
+   for (S32 i=0; i<3; i++)
+      v[i] = (F32(in[i] & QuatKeyMax) * (1.0f / F32(QuatKeyMax)) - 0.5f) * 2.0f * sgQuatKeyRange;
+   F32 big = mSqrt(getMax(0.0f, 1.0f - v[0]*v[0] - v[1]*v[1] - v[2]*v[2]));
+
+   F32 c[4];
+   for (S32 i=0, j=0; i<4; i++)
+      c[i] = i==largest ? big : v[j++];
+   q->set(c[0],c[1],c[2],c[3]);
+}
+
+// floats are split into words by value so the stream can be endian-flipped
+//  one word at a time
+void packF32(F32 f, U16 * out)
+{
+   U32 bits;
+   dMemcpy(&bits,&f,sizeof(U32));
+   out[0] = U16(bits & 0xffff);
+   out[1] = U16(bits >> 16);
+}
+
+F32 unpackF32(const U16 * in)
+{
+   U32 bits = U32(in[0]) | (U32(in[1]) << 16);
+   F32 f;
+   dMemcpy(&f,&bits,sizeof(F32));
+   return f;
+}
+
+/// Finds the last kept key at or before keyframeNum, and how far it is to
+/// the next one.  Returns the start of the track's key data.
+const U16 * findTrackKey(const U16 * track, S32 keyframeNum, S32 & key, F32 & t)
+{
+   S32 numKeys = track[0];
+   const U16 * frames = track + 1;
+
+   S32 lo = 0;
+   S32 hi = numKeys - 1;
+   while (lo < hi)
+   {
+      S32 mid = (lo + hi + 1) >> 1;
+      if (frames[mid] <= keyframeNum)
+         lo = mid;
+      else
+         hi = mid - 1;
+   }
+
+   key = lo;
+   t = 0.0f;
+   if (lo < numKeys - 1 && frames[lo] != keyframeNum)
+      t = F32(keyframeNum - frames[lo]) / F32(frames[lo+1] - frames[lo]);
+
+   return frames + numKeys;
+}
+
+S32 countMembers(const TSIntegerSet & set)
+{
+   S32 count = 0;
+   for (S32 i=set.start(); i<MAX_TS_SET_SIZE; set.next(i))
+      count++;
+   return count;
+}
+
+//-------------------------------------------------------------------------------------
+// key reduction
+//-------------------------------------------------------------------------------------
+
+/// Picks the frames to keep: each kept key reaches as far ahead as it can
+/// while every frame in between stays within tolerance of interpolating
+/// the two keys.  KeyError is called with (first, last, frame, t).
+template<class KeyError>
+void reduceKeys(S32 numFrames, KeyError & withinTol, Vector<U16> & keep)
+{
+   keep.clear();
+   keep.push_back(0);
+   if (numFrames==1)
+      return;
+
+   // does the first key hold the whole track?
+   bool constant = true;
+   for (S32 f=1; f<numFrames && constant; f++)
+      constant = withinTol(0,0,f,0.0f);
+   if (constant)
+      return;
+
+   S32 start = 0;
+   while (start < numFrames - 1)
+   {
+      S32 end = start + 1;
+      while (end + 1 < numFrames)
+      {
+         S32 next = end + 1;
+         bool ok = true;
+         for (S32 f=start+1; f<next && ok; f++)
+            ok = withinTol(start,next,f,F32(f - start) / F32(next - start));
+         if (!ok)
+            break;
+         end = next;
+      }
+      keep.push_back(U16(end));
+      start = end;
+   }
+}
+
+struct RotationError
+{
+   const QuatF * original;
+   const QuatF * quantized;
+   F32 minDot;
+
+   bool operator()(S32 a, S32 b, S32 f, F32 t)
+   {
+      QuatF q;
+      TSTransform::interpolate(quantized[a],quantized[b],t,&q);
+      const QuatF & o = original[f];
+      return mFabs(q.x*o.x + q.y*o.y + q.z*o.z + q.w*o.w) >= minDot;
+   }
+};
+
+struct TranslationError
+{
+   const Point3F * original;
+   const Point3F * quantized;
+   F32 tolSq;
+
+   bool operator()(S32 a, S32 b, S32 f, F32 t)
+   {
+      Point3F p;
+      TSTransform::interpolate(quantized[a],quantized[b],t,&p);
+      return (p - original[f]).lenSquared() <= tolSq;
+   }
+};
+
+void compressRotationTrack(const Quat16 * keys, S32 numFrames, F32 tol, Vector<U16> & out)
+{
+   static Vector<QuatF> original(__FILE__, __LINE__);
+   static Vector<QuatF> quantized(__FILE__, __LINE__);
+   static Vector<U16>   packed(__FILE__, __LINE__);
+   static Vector<U16>   keep(__FILE__, __LINE__);
+
+   original.setSize(numFrames);
+   quantized.setSize(numFrames);
+   packed.setSize(numFrames * 3);
+   for (S32 i=0; i<numFrames; i++)
+   {
+      keys[i].getQuatF(&original[i]);
+      original[i].normalize();
+      packQuat(original[i],&packed[i*3]);
+      unpackQuat(&packed[i*3],&quantized[i]);
+   }
+
+   // |dot| of two unit quaternions is the cosine of half the angle between them
+   RotationError error;
+   error.original  = original.address();
+   error.quantized = quantized.address();
+   error.minDot    = mCos(getMax(tol,0.0f) * 0.5f);
+   reduceKeys(numFrames,error,keep);
+
+   out.push_back(U16(keep.size()));
+   for (S32 i=0; i<keep.size(); i++)
+      out.push_back(keep[i]);
+   for (S32 i=0; i<keep.size(); i++)
+      for (S32 j=0; j<3; j++)
+         out.push_back(packed[keep[i]*3+j]);
+}
+
+void compressTranslationTrack(const Point3F * keys, S32 numFrames, F32 tol, Vector<U16> & out)
+{
+   static Vector<Point3F> quantized(__FILE__, __LINE__);
+   static Vector<U16>     packed(__FILE__, __LINE__);
+   static Vector<U16>     keep(__FILE__, __LINE__);
+
+   Point3F minP = keys[0];
+   Point3F maxP = keys[0];
+   for (S32 i=1; i<numFrames; i++)
+   {
+      minP.setMin(keys[i]);
+      maxP.setMax(keys[i]);
+   }
+   Point3F step = (maxP - minP) / F32(PointKeyMax);
+
+   quantized.setSize(numFrames);
+   packed.setSize(numFrames * 3);
+   for (S32 i=0; i<numFrames; i++)
+   {
+      for (S32 j=0; j<3; j++)
+      {
+         F32 v = step[j] > 0.0f ? (keys[i][j] - minP[j]) / step[j] : 0.0f;
+         packed[i*3+j] = U16(mClampF(mFloor(v + 0.5f),0.0f,F32(PointKeyMax)));
+         quantized[i][j] = minP[j] + F32(packed[i*3+j]) * step[j];
+      }
+   }
+
+   TranslationError error;
+   error.original  = keys;
+   error.quantized = quantized.address();
+   error.tolSq     = tol * tol;
+   reduceKeys(numFrames,error,keep);
+
+   out.push_back(U16(keep.size()));
+   for (S32 i=0; i<keep.size(); i++)
+      out.push_back(keep[i]);
+   U16 header[12];
+   for (S32 j=0; j<3; j++)
+   {
+      packF32(minP[j],&header[j*2]);
+      packF32(step[j],&header[6+j*2]);
+   }
+   for (S32 i=0; i<12; i++)
+      out.push_back(header[i]);
+   for (S32 i=0; i<keep.size(); i++)
+      for (S32 j=0; j<3; j++)
+         out.push_back(packed[keep[i]*3+j]);
+}
+
+} // namespace {}
+
+//-------------------------------------------------------------------------------------
+// decoding
+//-------------------------------------------------------------------------------------
+
+QuatF & TSShape::getKeyTrackRotation(S32 track, S32 keyframeNum, QuatF * quat) const
+{
+   S32 key;
+   F32 t;
+   const U16 * keys = findTrackKey(&keyTrackData[keyTrackOffsets[track]],keyframeNum,key,t);
+
+   unpackQuat(keys + key*3,quat);
+   if (t > 0.0f)
+   {
+      QuatF q1 = *quat;
+      QuatF q2;
+      unpackQuat(keys + key*3 + 3,&q2);
+      TSTransform::interpolate(q1,q2,t,quat);
+   }
+   return *quat;
+}
+
+Point3F TSShape::getKeyTrackTranslation(S32 track, S32 keyframeNum) const
+{
+   const U16 * data = &keyTrackData[keyTrackOffsets[track]];
+   S32 numKeys = data[0];
+   const U16 * header = data + 1 + numKeys;
+
+   S32 key;
+   F32 t;
+   findTrackKey(data,keyframeNum,key,t);
+   const U16 * keys = header + 12;
+
+   Point3F p;
+   for (S32 j=0; j<3; j++)
+   {
+      F32 minP = unpackF32(header + j*2);
+      F32 step = unpackF32(header + 6 + j*2);
+      F32 v = F32(keys[key*3+j]);
+      if (t > 0.0f)
+         v += (F32(keys[key*3+3+j]) - v) * t;
+      p[j] = minP + v * step;
+   }
+   return p;
+}
+
+bool TSShape::hasCompressedSequences() const
+{
+   for (S32 i=0; i<sequenceKeyTracks.size(); i++)
+      if (sequenceKeyTracks[i].firstRotation>=0)
+         return true;
+   return false;
+}
+
+//-------------------------------------------------------------------------------------
+// compression
+//-------------------------------------------------------------------------------------
+
+S32 TSShape::compressSequences(F32 rotTol, F32 transTol)
+{
+   S32 i;
+   S32 oldTracks = keyTrackOffsets.size();
+   S32 oldData   = keyTrackData.size();
+   S32 rawBytes  = 0;
+
+   Vector<bool> dropRot(__FILE__, __LINE__);
+   Vector<bool> dropTrans(__FILE__, __LINE__);
+   dropRot.setSize(nodeRotations.size());
+   dropTrans.setSize(nodeTranslations.size());
+   for (i=0; i<dropRot.size(); i++)
+      dropRot[i] = false;
+   for (i=0; i<dropTrans.size(); i++)
+      dropTrans[i] = false;
+
+   S32 oldSize = sequenceKeyTracks.size();
+   sequenceKeyTracks.setSize(sequences.size());
+   for (i=oldSize; i<sequences.size(); i++)
+   {
+      sequenceKeyTracks[i].firstRotation = -1;
+      sequenceKeyTracks[i].firstTranslation = -1;
+   }
+
+   for (i=0; i<sequences.size(); i++)
+   {
+      const Sequence & seq = sequences[i];
+      if (sequenceKeyTracks[i].firstRotation>=0)
+         continue;
+
+      S32 numFrames = seq.numKeyframes;
+      S32 numRots   = countMembers(seq.rotationMatters);
+      S32 numTrans  = countMembers(seq.translationMatters);
+      if (numFrames<1 || numFrames>MaxTrackFrames || numRots+numTrans==0)
+         continue;
+      if (numRots && seq.baseRotation + numRots*numFrames > nodeRotations.size())
+         continue;
+      if (numTrans && seq.baseTranslation + numTrans*numFrames > nodeTranslations.size())
+         continue;
+
+      S32 j;
+      sequenceKeyTracks[i].firstRotation = keyTrackOffsets.size();
+      for (j=0; j<numRots; j++)
+      {
+         keyTrackOffsets.push_back(keyTrackData.size());
+         compressRotationTrack(&nodeRotations[seq.baseRotation + j*numFrames],numFrames,rotTol,keyTrackData);
+      }
+      sequenceKeyTracks[i].firstTranslation = keyTrackOffsets.size();
+      for (j=0; j<numTrans; j++)
+      {
+         keyTrackOffsets.push_back(keyTrackData.size());
+         compressTranslationTrack(&nodeTranslations[seq.baseTranslation + j*numFrames],numFrames,transTol,keyTrackData);
+      }
+
+      for (j=0; j<numRots*numFrames; j++)
+         dropRot[seq.baseRotation + j] = true;
+      for (j=0; j<numTrans*numFrames; j++)
+         dropTrans[seq.baseTranslation + j] = true;
+      rawBytes += numRots*numFrames*sizeof(Quat16) + numTrans*numFrames*sizeof(Point3F);
+   }
+
+   // keep whatever the remaining raw sequences use, even if it overlaps
+   for (i=0; i<sequences.size(); i++)
+   {
+      const Sequence & seq = sequences[i];
+      if (sequenceKeyTracks[i].firstRotation>=0)
+         continue;
+      S32 j;
+      S32 numRots  = countMembers(seq.rotationMatters) * seq.numKeyframes;
+      S32 numTrans = countMembers(seq.translationMatters) * seq.numKeyframes;
+      for (j=0; j<numRots && seq.baseRotation+j<dropRot.size(); j++)
+         dropRot[seq.baseRotation + j] = false;
+      for (j=0; j<numTrans && seq.baseTranslation+j<dropTrans.size(); j++)
+         dropTrans[seq.baseTranslation + j] = false;
+   }
+
+   // squeeze out the dropped keys and move the raw sequences down
+   Vector<S32> rotRemap(__FILE__, __LINE__);
+   Vector<S32> transRemap(__FILE__, __LINE__);
+   rotRemap.setSize(nodeRotations.size() + 1);
+   transRemap.setSize(nodeTranslations.size() + 1);
+   S32 count = 0;
+   for (i=0; i<nodeRotations.size(); i++)
+   {
+      rotRemap[i] = count;
+      if (!dropRot[i])
+         nodeRotations[count++] = nodeRotations[i];
+   }
+   rotRemap[i] = count;
+   nodeRotations.setSize(count);
+   nodeRotations.compact();
+
+   count = 0;
+   for (i=0; i<nodeTranslations.size(); i++)
+   {
+      transRemap[i] = count;
+      if (!dropTrans[i])
+         nodeTranslations[count++] = nodeTranslations[i];
+   }
+   transRemap[i] = count;
+   nodeTranslations.setSize(count);
+   nodeTranslations.compact();
+
+   for (i=0; i<sequences.size(); i++)
+   {
+      Sequence & seq = sequences[i];
+      if (sequenceKeyTracks[i].firstRotation>=0)
+         continue;
+      if (seq.baseRotation>=0 && seq.baseRotation<rotRemap.size())
+         seq.baseRotation = rotRemap[seq.baseRotation];
+      if (seq.baseTranslation>=0 && seq.baseTranslation<transRemap.size())
+         seq.baseTranslation = transRemap[seq.baseTranslation];
+   }
+
+   S32 addedBytes = (keyTrackData.size() - oldData) * sizeof(U16) +
+                    (keyTrackOffsets.size() - oldTracks) * sizeof(U32);
+   return rawBytes - addedBytes;
+}
+
+//-------------------------------------------------------------------------------------
+// persist
+//-------------------------------------------------------------------------------------
+
+void TSShape::writeKeyTracks(Stream * s)
+{
+   S32 i;
+   s->write(sequenceKeyTracks.size());
+   for (i=0; i<sequenceKeyTracks.size(); i++)
+   {
+      s->write(sequenceKeyTracks[i].firstRotation);
+      s->write(sequenceKeyTracks[i].firstTranslation);
+   }
+   s->write(keyTrackOffsets.size());
+   for (i=0; i<keyTrackOffsets.size(); i++)
+      s->write(keyTrackOffsets[i]);
+   s->write(keyTrackData.size());
+   for (i=0; i<keyTrackData.size(); i++)
+      s->write(keyTrackData[i]);
+}
+
+bool TSShape::readKeyTracks(Stream * s)
+{
+   S32 i, sz;
+   s->read(&sz);
+   if (sz<0 || sz>sequences.size())
+      return false;
+   sequenceKeyTracks.setSize(sz);
+   for (i=0; i<sz; i++)
+   {
+      s->read(&sequenceKeyTracks[i].firstRotation);
+      s->read(&sequenceKeyTracks[i].firstTranslation);
+   }
+   s->read(&sz);
+   if (sz<0)
+      return false;
+   keyTrackOffsets.setSize(sz);
+   for (i=0; i<sz; i++)
+      s->read(&keyTrackOffsets[i]);
+   s->read(&sz);
+   if (sz<0)
+      return false;
+   keyTrackData.setSize(sz);
+   for (i=0; i<sz; i++)
+      s->read(&keyTrackData[i]);
+   return s->getStatus()==Stream::Ok;
+}
@@ -8,8 +8,10 @@
 #include "ts/tsLastDetail.h"
 #include "console/consoleTypes.h"
 #include "ts/tsDecal.h"
+#include "ts/tsSortedMesh.h"
 #include "platform/profiler.h"
 #include "core/frameAllocator.h"
+#include "core/threadPool.h"
 
 TSShapeInstance::RenderData   TSShapeInstance::smRenderData;
 MatrixF *                     TSShapeInstance::ObjectInstance::smTransforms = NULL;
@@ -22,6 +24,11 @@ bool                          TSShapeInstance::smFogExemptionOn = false;
 S32                           TSShapeInstance::smNumSkipRenderDetails = 0;
 bool                          TSShapeInstance::smSkipFirstFog = false;
 bool                          TSShapeInstance::smSkipFog = false;
+bool                          TSShapeInstance::smAllowInstancing = true;
+bool                          TSShapeInstance::smParallelSkinning = true;
+F32                           TSShapeInstance::smAnimLODPixelSize = 64.0f;
+S32                           TSShapeInstance::smAnimLODMaxInterval = 200;
+bool                          TSShapeInstance::smAnimLODInterpolate = true;
 
 Vector<QuatF>                 TSShapeInstance::smNodeCurrentRotations(__FILE__, __LINE__);
 Vector<Point3F>               TSShapeInstance::smNodeCurrentTranslations(__FILE__, __LINE__);
@@ -110,6 +117,8 @@ TSShapeInstance::~TSShapeInstance()
    setMaterialList(NULL);
 
    delete [] mDirtyFlags;
+   delete [] mPoseHashes;
+   delete mAnimLOD;
 }
 
 void TSShapeInstance::init()
@@ -127,10 +136,31 @@ void TSShapeInstance::init()
    Con::addVariable("$pref::TS::skipFirstFog",  TypeBool, &smSkipFirstFog);
    Con::addVariable("$pref::TS::screenError",   TypeF32,  &smScreenError);
    Con::addVariable("$pref::TS::UseTriangles",  TypeBool, &TSMesh::smUseTriangles);
+   Con::addVariable("$pref::TS::optimizeVertexCache", TypeBool, &TSMesh::smOptimizeVertexCache);
+   Con::addVariable("$pref::TS::sortedMeshOrders", TypeBool, &TSSortedMesh::smUseOrders);
+   Con::addVariable("$pref::TS::instancing",    TypeBool, &smAllowInstancing);
+   Con::addVariable("$pref::TS::skinCache",     TypeBool, &TSSkinMesh::smUseSkinCache);
+   Con::addVariable("$pref::TS::parallelSkinning", TypeBool, &smParallelSkinning);
+   Con::addVariable("$pref::TS::animLODPixelSize",   TypeF32,  &smAnimLODPixelSize);
+   Con::addVariable("$pref::TS::animLODMaxInterval", TypeS32,  &smAnimLODMaxInterval);
+   Con::addVariable("$pref::TS::animLODInterpolate", TypeBool, &smAnimLODInterpolate);
+   Con::addVariable("$pref::TS::compressAnimations",     TypeBool, &TSShape::smCompressOnLoad);
+   Con::addVariable("$pref::TS::compressRotationTol",    TypeF32,  &TSShape::smCompressRotationTol);
+   Con::addVariable("$pref::TS::compressTranslationTol", TypeF32,  &TSShape::smCompressTranslationTol);
+   Con::addVariable("$pref::TS::bakeShapes",             TypeBool, &TSShape::smBakeShapes);
+   Con::addVariable("$pref::TS::lazyDetails",            TypeBool, &TSShape::smLazyDetails);
+   Con::addVariable("$pref::TS::lazyDetailBudget",       TypeS32,  &TSShape::smLazyDetailBudget);
+   Con::addVariable("$pref::TS::lazyDetailIdleMs",       TypeS32,  &TSShape::smLazyDetailIdleMs);
+   Con::addVariable("$pref::TS::impostorCache",          TypeBool, &TSLastDetail::smUseCache);
+
+   TSImpostorAtlas::init();
+   TSMesh::initBufferObjects();
 }
 
 void TSShapeInstance::destroy()
 {
+   TSMesh::destroyBufferObjects();
+   TSImpostorAtlas::destroy();
    delete smRenderData.fogHandle;
 }
 
@@ -140,6 +170,11 @@ void TSShapeInstance::buildInstanceData(TSShape * _shape, bool loadMaterials)
 
    mShape = _shape;
 
+#ifdef TORQUE_HEADLESS
+   // Server instances only animate and collide.
+   loadMaterials = false;
+#endif
+
    debrisRefCount = 0;
 
    mEnvironmentMapOn = false;
@@ -195,6 +230,7 @@ void TSShapeInstance::buildInstanceData(TSShape * _shape, bool loadMaterials)
    // add objects to trees
    S32 numObjects = mShape->objects.size();
    mMeshObjects.setSize(numObjects);
+   mHasSkinMeshes = mShape->hasLazySkinMeshes();
    for (i=0; i<numObjects; i++)
    {
       const TSObject * obj = &mShape->objects[i];
@@ -212,6 +248,10 @@ void TSShapeInstance::buildInstanceData(TSShape * _shape, bool loadMaterials)
       else
          objInst->meshList = NULL;
 
+      for (S32 j=0; j<obj->numMeshes; j++)
+         if (objInst->meshList[j] && objInst->meshList[j]->getMeshType() == TSMesh::SkinMeshType)
+            mHasSkinMeshes = true;
+
       objInst->object = obj;
    }
 
@@ -267,75 +307,23 @@ void TSShapeInstance::buildInstanceData(TSShape * _shape, bool loadMaterials)
       }
    }
 
-   // check to see which dl's have detail texturing
+   // check to see which dl's have detail and lightmap texturing
    mMaxDetailMapDL = -1;
-   if(loadMaterials)
-   {
-      for (dl=0; dl<mShape->details.size(); dl++)
-      {
-         // check meshes on this detail level...
-         S32 ss = mShape->details[dl].subShapeNum;
-         S32 od = mShape->details[dl].objectDetailNum;
-         if (ss<0)
-            continue; // this is a billboard detail level
-         S32 start = mShape->subShapeFirstObject[ss];
-         S32 end = mShape->subShapeNumObjects[ss] + start;
-         for (i=start; i<end; i++)
-         {
-            TSMesh * mesh = mMeshObjects[i].getMesh(od);
-            if (!mesh)
-               continue;
-            for (S32 j=0; j<mesh->primitives.size(); j++)
-            {
-               if (mesh->primitives[j].matIndex & TSDrawPrimitive::NoMaterial)
-                  continue;
-               if (mMaterialList->getDetailMap(mesh->primitives[j].matIndex & TSDrawPrimitive::MaterialMask))
-               {
-                  mesh->setFlags(TSMesh::HasDetailTexture);
-                  if (dl>mMaxDetailMapDL)
-                     mMaxDetailMapDL = dl;
-               }
-            }
-         }
-      }
-   }
-
-   // check to see which dl's have lightmap texturing
    mMaxLightMapDL = -1;
    if(loadMaterials)
    {
       for (dl=0; dl<mShape->details.size(); dl++)
-      {
-         // check meshes on this detail level...
-         S32 ss = mShape->details[dl].subShapeNum;
-         S32 od = mShape->details[dl].objectDetailNum;
-         if (ss<0)
-            continue; // this is a billboard detail level
-         S32 start = mShape->subShapeFirstObject[ss];
-         S32 end = mShape->subShapeNumObjects[ss] + start;
-         for (i=start; i<end; i++)
-         {
-            TSMesh * mesh = mMeshObjects[i].getMesh(od);
-            if (!mesh)
-               continue;
-            for (S32 j=0; j<mesh->primitives.size(); j++)
-            {
-               if (mesh->primitives[j].matIndex & TSDrawPrimitive::NoMaterial)
-                  continue;
-               if (mMaterialList->getLightMap(mesh->primitives[j].matIndex & TSDrawPrimitive::MaterialMask))
-               {
-                  mesh->setFlags(TSMesh::HasLightTexture);
-                  if (dl>mMaxLightMapDL)
-                     mMaxLightMapDL = dl;
-               }
-            }
-         }
-      }
+         initDetailMaps(dl);
    }
 
    // set up subtree data
    S32 ss = mShape->subShapeFirstNode.size(); // we have this many subtrees
    mDirtyFlags = new U32[ss];
+   mPoseHashes = new U32[ss];
+   dMemset(mPoseHashes,0,ss*sizeof(U32));
+
+   mAnimLOD = NULL;
+   mAnimationLOD = loadMaterials;
 
    mGroundThread = NULL;
    mCurrentDetailLevel = 0;
@@ -386,6 +374,65 @@ void TSShapeInstance::buildInstanceData(TSShape * _shape, bool loadMaterials)
    }
 }
 
+void TSShapeInstance::initDetailMaps(S32 dl)
+{
+   // check meshes on this detail level...
+   S32 ss = mShape->details[dl].subShapeNum;
+   S32 od = mShape->details[dl].objectDetailNum;
+   if (ss<0)
+      return; // this is a billboard detail level
+
+   if (!mShape->isDetailResident(dl))
+   {
+      // can't tell until it's paged in, so allow for it if any material could
+      for (S32 j=0; j<mMaterialList->getMaterialCount(); j++)
+      {
+         if (mMaterialList->getDetailMap(j) && dl>mMaxDetailMapDL)
+            mMaxDetailMapDL = dl;
+         if (mMaterialList->getLightMap(j) && dl>mMaxLightMapDL)
+            mMaxLightMapDL = dl;
+      }
+      return;
+   }
+
+   S32 start = mShape->subShapeFirstObject[ss];
+   S32 end = mShape->subShapeNumObjects[ss] + start;
+   for (S32 i=start; i<end; i++)
+   {
+      TSMesh * mesh = mMeshObjects[i].getMesh(od);
+      if (!mesh)
+         continue;
+      for (S32 j=0; j<mesh->primitives.size(); j++)
+      {
+         if (mesh->primitives[j].matIndex & TSDrawPrimitive::NoMaterial)
+            continue;
+         U32 matIndex = mesh->primitives[j].matIndex & TSDrawPrimitive::MaterialMask;
+         if (mMaterialList->getDetailMap(matIndex))
+         {
+            mesh->setFlags(TSMesh::HasDetailTexture);
+            if (dl>mMaxDetailMapDL)
+               mMaxDetailMapDL = dl;
+         }
+         if (mMaterialList->getLightMap(matIndex))
+         {
+            mesh->setFlags(TSMesh::HasLightTexture);
+            if (dl>mMaxLightMapDL)
+               mMaxLightMapDL = dl;
+         }
+      }
+   }
+}
+
+void TSShapeInstance::requestDetail(S32 dl)
+{
+   if (mShape->hasLazyDetails() && mShape->requestDetail(dl) && mMaterialList)
+   {
+      // the mesh flags are shared, the other instances already allowed
+      // for this detail's maps when they were made
+      initDetailMaps(dl);
+   }
+}
+
 void TSShapeInstance::setMaterialList(TSMaterialList * ml)
 {
    // get rid of old list
@@ -638,6 +685,8 @@ void TSShapeInstance::render(S32 dl, F32 intraDL, const Point3F * objectScale)
 
    AssertFatal(dl>=0 && dl<mShape->details.size(),"TSShapeInstance::render");
 
+   requestDetail(dl);
+
    const TSDetail * detail = &mShape->details[dl];
    S32 ss = detail->subShapeNum;
 
@@ -675,7 +724,9 @@ void TSShapeInstance::render(S32 dl, F32 intraDL, const Point3F * objectScale)
 
    S32 od = detail->objectDetailNum;
 
-   bool supportBuffers = dglDoesSupportVertexBuffer();
+   // static meshes are better off in ARB buffer objects when we have them,
+   //  which TSMesh::render takes care of
+   bool supportBuffers = dglDoesSupportVertexBuffer() && !TSMesh::useBufferObjects();
    if (!supportBuffers || !renderMeshesX(ss,od))
    {
       // run through the meshes
@@ -741,6 +792,215 @@ void TSShapeInstance::render(S32 dl, F32 intraDL, const Point3F * objectScale)
    clearStatics();
 }
 
+void TSShapeInstance::renderInstanced(S32 dl, F32 intraDL, const MatrixF * instances, U32 count)
+{
+   if (dl==-1 || count==0)
+      return;
+
+   AssertFatal(dl>=0 && dl<mShape->details.size(),"TSShapeInstance::renderInstanced");
+
+   const TSDetail * detail = &mShape->details[dl];
+   S32 ss = detail->subShapeNum;
+   U32 k;
+
+   // billboards face the camera and ballooned shapes scale about each
+   // copy, so these are rendered one at a time
+   if (!smAllowInstancing || ss<0 || mBalloonShape)
+   {
+      for (k=0; k<count; k++)
+      {
+         glPushMatrix();
+         dglMultMatrix(&instances[k]);
+         render(dl,intraDL);
+         glPopMatrix();
+      }
+      return;
+   }
+
+   PROFILE_START(TSShapeInstanceRenderInstanced);
+   dglSetRenderPrimType(3);
+
+   setStatics(dl,intraDL);
+
+   S32 i;
+
+   // set up animating ifl materials
+   for (i=0; i<mIflMaterialInstances.size(); i++)
+   {
+      IflMaterialInstance  * iflMaterialInstance = &mIflMaterialInstances[i];
+      const TSShape::IflMaterial * iflMaterial = iflMaterialInstance->iflMaterial;
+      mMaterialList->remap(iflMaterial->materialSlot, iflMaterial->firstFrame + iflMaterialInstance->frame);
+   }
+
+   setupTexturing(dl,intraDL);
+   TSMesh::initMaterials();
+
+   S32 od = detail->objectDetailNum;
+
+   // mesh transforms are applied per copy, so nothing is left pushed
+   smRenderData.currentTransform = NULL;
+   S32 start = smNoRenderNonTranslucent ? mShape->subShapeFirstTranslucentObject[ss] : mShape->subShapeFirstObject[ss];
+   S32 end   = smNoRenderTranslucent ? mShape->subShapeFirstTranslucentObject[ss] : mShape->subShapeFirstObject[ss] + mShape->subShapeNumObjects[ss];
+   for (i=start; i<end; i++)
+      mMeshObjects[i].renderInstanced(od,mMaterialList,instances,count);
+
+   TSMesh::resetMaterials();
+
+   // the extra passes and decals are rare on the kind of shapes that get
+   // instanced, so they're just repeated for each copy
+   bool detailPass = twoPassDetailMap();
+   bool envPass    = twoPassEnvironmentMap();
+   bool lightPass  = twoPassLightMap();
+   bool fogPass    = twoPassFog();
+   bool decals     = smRenderData.renderDecals && !smNoRenderTranslucent &&
+                     mShape->subShapeNumDecals[ss] > 0;
+
+   if (detailPass || envPass || lightPass || fogPass || decals)
+   {
+      for (k=0; k<count; k++)
+      {
+         glPushMatrix();
+         dglMultMatrix(&instances[k]);
+
+         if (detailPass)
+            renderDetailMap();
+         if (envPass)
+            renderEnvironmentMap();
+         if (lightPass)
+            renderLightMap();
+
+         if (decals)
+         {
+            S32 first = mShape->subShapeFirstDecal[ss];
+            S32 last  = mShape->subShapeNumDecals[ss] + first;
+
+            TSDecalMesh::initDecalMaterials();
+            smRenderData.currentTransform = NULL;
+            for (i=first; i<last; i++)
+               mDecalObjects[i].render(od,mMaterialList);
+            if (smRenderData.currentTransform)
+               glPopMatrix();
+            TSDecalMesh::resetDecalMaterials();
+         }
+
+         if (fogPass)
+            renderFog();
+
+         TSMesh::resetMaterials();
+         glPopMatrix();
+      }
+   }
+
+   clearStatics();
+
+   dglSetRenderPrimType(0);
+   PROFILE_END();
+}
+
+//-------------------------------------------------------------------------------------
+// skinning
+//-------------------------------------------------------------------------------------
+
+namespace {
+
+struct SkinJob
+{
+   TSSkinMesh *    mesh;
+   TSSkinCache *   cache;
+   const MatrixF * nodeTransforms;
+};
+
+Vector<SkinJob>          sgSkinJobs(__FILE__, __LINE__);
+Vector<TSShapeInstance*> sgSkinInstances(__FILE__, __LINE__);
+
+S32 QSORT_CALLBACK cmpSkinInstances(const void * p1, const void * p2)
+{
+   TSShapeInstance * a = *(TSShapeInstance**)p1;
+   TSShapeInstance * b = *(TSShapeInstance**)p2;
+   return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+void processSkinJobs(U32 start, U32 end, void * userData)
+{
+   SkinJob * jobs = (SkinJob*)userData;
+   for (U32 i=start; i<end; i++)
+      jobs[i].mesh->updateSkinCache(*jobs[i].cache,jobs[i].nodeTransforms);
+}
+
+} // namespace {}
+
+bool TSShapeInstance::isParallelSkinning()
+{
+   return smParallelSkinning && TSSkinMesh::smUseSkinCache && gThreadPool && gThreadPool->isThreaded();
+}
+
+TSSkinCache * TSShapeInstance::MeshObjectInstance::getSkinCache(TSMesh * mesh)
+{
+   if (!TSSkinMesh::smUseSkinCache || mesh->getMeshType() != TSMesh::SkinMeshType)
+      return NULL;
+   if (!skinCache)
+      skinCache = new TSSkinCache;
+   return skinCache;
+}
+
+void TSShapeInstance::skinInstances(TSShapeInstance ** instances, U32 count)
+{
+   if (count == 0 || !isParallelSkinning())
+      return;
+
+   PROFILE_START(TSShapeInstance_skinInstances);
+
+   // an object can hand in its instance more than once, and two jobs must
+   //  never share a cache
+   sgSkinInstances.setSize(count);
+   dMemcpy(sgSkinInstances.address(),instances,count * sizeof(TSShapeInstance*));
+   dQsort(sgSkinInstances.address(),count,sizeof(TSShapeInstance*),cmpSkinInstances);
+
+   sgSkinJobs.clear();
+   for (U32 k=0; k<count; k++)
+   {
+      TSShapeInstance * si = sgSkinInstances[k];
+      if (k>0 && si==sgSkinInstances[k-1])
+         continue;
+
+      S32 dl = si->mCurrentDetailLevel;
+      if (dl<0)
+         continue;
+      si->requestDetail(dl);
+      const TSDetail & detail = si->mShape->details[dl];
+      S32 ss = detail.subShapeNum;
+      if (ss<0)
+         continue;
+
+      si->animate();
+
+      S32 od    = detail.objectDetailNum;
+      S32 start = si->mShape->subShapeFirstObject[ss];
+      S32 end   = start + si->mShape->subShapeNumObjects[ss];
+      for (S32 i=start; i<end; i++)
+      {
+         MeshObjectInstance & obj = si->mMeshObjects[i];
+         TSMesh * mesh = obj.getMesh(od);
+         if (!mesh || obj.visible<=0.01f)
+            continue;
+         TSSkinCache * cache = obj.getSkinCache(mesh);
+         if (!cache)
+            continue;
+
+         sgSkinJobs.increment();
+         SkinJob & job = sgSkinJobs.last();
+         job.mesh           = static_cast<TSSkinMesh*>(mesh);
+         job.cache          = cache;
+         job.nodeTransforms = si->mNodeTransforms.address();
+      }
+   }
+
+   if (sgSkinJobs.size())
+      gThreadPool->parallelFor(sgSkinJobs.size(),processSkinJobs,sgSkinJobs.address());
+
+   PROFILE_END();
+}
+
 bool TSShapeInstance::fillVB()
 {
    S32 i,start,end,vb;
@@ -1380,6 +1640,8 @@ void TSShapeInstance::setCurrentDetail(S32 dl, F32 intraDL)
       mCurrentDetailLevel = cutoff;
       mCurrentIntraDetailLevel = 1.0f;
    }
+
+   requestDetail(mCurrentDetailLevel);
 }
 
 S32 TSShapeInstance::selectCurrentDetail(bool ignoreScale)
@@ -1772,6 +2034,8 @@ void TSShapeInstance::renderShadow(S32 dl, const MatrixF & mat, S32 dim, U32 * b
 
    AssertFatal(dl>=0 && dl<mShape->details.size(),"TSShapeInstance::renderShadow");
 
+   requestDetail(dl);
+
    S32 i;
 
    const TSDetail * detail = &mShape->details[dl];
@@ -1978,6 +2242,7 @@ void TSShapeInstance::MeshObjectInstance::render(S32 objectDetail, TSMaterialLis
             }
             TSShapeInstance::smRenderData.currentTransform = transform;
          }
+         TSSkinMesh::smCurrentCache = getSkinCache(mesh);
          if (visible>0.99f)
          {
             if (TSShapeInstance::smRenderData.balloonShape)
@@ -1996,10 +2261,46 @@ void TSShapeInstance::MeshObjectInstance::render(S32 objectDetail, TSMaterialLis
             mesh->render(frame,matFrame,materials);
             mesh->clearFade();
          }
+         TSSkinMesh::smCurrentCache = NULL;
       }
    }
 }
 
+void TSShapeInstance::MeshObjectInstance::renderInstanced(S32 objectDetail, TSMaterialList * materials,
+                                                         const MatrixF * instances, U32 count)
+{
+   if (visible<=0.01f)
+      return;
+
+   TSMesh * mesh = getMesh(objectDetail);
+   if (!mesh)
+      return;
+
+   MatrixF * transform = getTransform();
+   bool fade = visible<=0.99f;
+   if (fade)
+      mesh->setFade(visible);
+
+   if (mesh->getMeshType()==TSMesh::StandardMeshType && !mesh->getFlags(TSMesh::Billboard))
+      mesh->renderInstanced(frame,matFrame,materials,transform,instances,count);
+   else
+   {
+      // skinned, sorted and billboard meshes do their own per copy work
+      for (U32 k=0; k<count; k++)
+      {
+         glPushMatrix();
+         dglMultMatrix(&instances[k]);
+         if (transform)
+            dglMultMatrix(transform);
+         mesh->render(frame,matFrame,materials);
+         glPopMatrix();
+      }
+   }
+
+   if (fade)
+      mesh->clearFade();
+}
+
 void TSShapeInstance::DecalObjectInstance::render(S32 objectDetail, TSMaterialList * materials)
 {
    if (targetObject->visible>0.01f)
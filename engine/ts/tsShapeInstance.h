@@ -135,6 +135,16 @@ class TSShapeInstance
       S32 matFrame;
       F32 visible;
 
+      /// Skinned verts of this object for this instance, made the first time
+      /// a skinned mesh of it is drawn.
+      TSSkinCache * skinCache;
+
+      MeshObjectInstance() : skinCache(NULL) {}
+      ~MeshObjectInstance() { delete skinCache; }
+
+      /// Returns the skin cache to use for mesh, or NULL if there shouldn't be one.
+      TSSkinCache * getSkinCache(TSMesh * mesh);
+
       S32 getSizeVB(S32 size);
       bool hasMergeIndices();
       /// @name Vertex Buffer functions
@@ -149,6 +159,7 @@ class TSShapeInstance
       /// This just selects the right detail level (mesh) and calls mesh's render
       /// @{
       void render(S32 objectDetail, TSMaterialList *);
+      void renderInstanced(S32 objectDetail, TSMaterialList *, const MatrixF * instances, U32 count);
       void renderEnvironmentMap(S32 objectDetail, TSMaterialList *);
       void renderDetailMap(S32 objectDetail, TSMaterialList *);
       void renderShadow(S32 objectDetail, const MatrixF & mat, S32 dim, U32 * bits, TSMaterialList *);
@@ -280,6 +291,8 @@ class TSShapeInstance
    bool mBalloonShape;   ///< Is this shape ballooned?
    F32  mBalloonValue;   ///< How much is it ballooned?
 
+   bool mHasSkinMeshes;  ///< Does any object of the shape have a skinned mesh?
+
    bool          mUseOverrideTexture;
    TextureHandle mOverrideTexture;
 
@@ -565,6 +578,32 @@ class TSShapeInstance
 
    virtual void render(const Point3F * objectScale = NULL);
    virtual void render(S32 dl, F32 intraDL = 0.0f, const Point3F * objectScale = NULL);
+
+   /// Draws detail dl once for each matrix in instances, which take the
+   /// place of the object to world transform (scale included).
+   ///
+   /// All the instances share this instance's pose, materials, fog and
+   /// lighting, so this is only meant for unanimated shapes.  Vertex arrays
+   /// and materials are set up once per mesh rather than once per copy.
+   /// The modelview should hold the world to camera transform.
+   void renderInstanced(S32 dl, F32 intraDL, const MatrixF * instances, U32 count);
+
+   /// Turns renderInstanced() on or off ($pref::TS::instancing), otherwise
+   /// it just renders each instance in turn.
+   static bool smAllowInstancing;
+
+   /// Animates the instances at their current detail levels and skins their
+   /// skinned meshes on the thread pool, into the per instance skin caches.
+   /// Rendering them afterwards in the same pose then skips the skinning.
+   /// Does nothing unless isParallelSkinning().
+   static void skinInstances(TSShapeInstance ** instances, U32 count);
+
+   /// $pref::TS::parallelSkinning, and only if the thread pool has threads.
+   static bool smParallelSkinning;
+   static bool isParallelSkinning();
+
+   bool hasSkinMeshes() const { return mHasSkinMeshes; }
+
    void renderShadow(S32 dl, const MatrixF & mat, S32 dim, U32 * bits);
    static void setupFog(F32 fogAmount, const ColorF & fogColor);
    void setupFog(F32 fogAmount, TextureHandle * fogMap, Point4F & s, Point4F & t);
@@ -584,6 +623,27 @@ class TSShapeInstance
    void animateSubtrees(bool forceFull = true);
    void animateNodeSubtrees(bool forceFull = true);
 
+   /// @name Animation LOD
+   /// animate() skips the node update when the threads are where they were
+   /// the last time the nodes were animated.  When the current detail is
+   /// smaller than smAnimLODPixelSize it also only animates the nodes every
+   /// so often, up to smAnimLODMaxInterval ms apart for the smallest
+   /// details.  In between, the nodes are blended from the previous update
+   /// to the last one (so they run one update behind), or just held if
+   /// smAnimLODInterpolate is off.
+   ///
+   /// Shapes with hands-off or callback nodes, or animated scale, are always
+   /// animated in full.  The reduced rate is on by default for instances
+   /// that load materials, i.e. the ones that get rendered.
+   /// @{
+   void setAnimationLOD(bool on) { mAnimationLOD = on; }
+   bool getAnimationLOD() const { return mAnimationLOD; }
+
+   static F32  smAnimLODPixelSize;    ///< $pref::TS::animLODPixelSize
+   static S32  smAnimLODMaxInterval;  ///< $pref::TS::animLODMaxInterval
+   static bool smAnimLODInterpolate;  ///< $pref::TS::animLODInterpolate
+   /// @}
+
    bool hasTranslucency();
    bool hasSolid();
 
@@ -633,6 +693,12 @@ class TSShapeInstance
    S32 selectCurrentDetail2Ex(F32 adjustedDist);
    S32 selectCurrentDetailEx(F32 errorTOL);
 
+   /// Pages in the meshes of dl if the shape left them on disk (see
+   /// TSShape::requestDetail), and sets them up for our materials.
+   void requestDetail(S32 dl);
+   /// Flags the meshes of dl that have detail or light maps.
+   void initDetailMaps(S32 dl);
+
    enum
    {
       TransformDirty =  BIT(0),
@@ -648,6 +714,44 @@ class TSShapeInstance
    void setDirty(U32 dirty);
    void clearDirty(U32 dirty);
 
+  protected:
+
+   /// Shape space node poses kept for animation LOD.
+   struct AnimLODData
+   {
+      S32 subShape;                 ///< Subtree the poses are for, -1 if none.
+      U32 lastUpdate;               ///< Virtual ms of the last full node update.
+      U32 interval;                 ///< ms until the next one.
+      bool blending;                ///< Still moving from the old to the new pose.
+      Vector<QuatF>   rotations[2]; ///< [0] is the old pose, [1] the new one.
+      Vector<Point3F> translations[2];
+
+      AnimLODData() : subShape(-1), lastUpdate(0), interval(0), blending(false) {}
+   };
+
+   AnimLODData * mAnimLOD;
+   bool          mAnimationLOD;
+
+   /// Hash of the thread state each subtree was last animated from, 0 if
+   /// unknown.
+   U32 * mPoseHashes;
+
+   /// Hash of everything animateNodes() reads that changes from frame to
+   /// frame, or 0 if that can't be known (hands-off or callback nodes).
+   U32  getPoseHash();
+
+   /// ms between node updates animation LOD allows at dl, 0 for every frame.
+   U32  getAnimLODInterval(S32 dl);
+
+   /// Brings the nodes of subtree ss up to date for animate(dl), returns
+   /// false if animation LOD is putting the update off.
+   bool updateNodes(S32 dl, S32 ss);
+
+   void saveAnimLODPose(S32 ss, S32 which);
+   void blendAnimLODPose(S32 ss, F32 t);
+
+  public:
+
 //-------------------------------------------------------------------------------------
 // collision interface routines
 //-------------------------------------------------------------------------------------
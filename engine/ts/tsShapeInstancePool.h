@@ -0,0 +1,70 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _TSSHAPEINSTANCEPOOL_H_
+#define _TSSHAPEINSTANCEPOOL_H_
+
+#ifndef _TSSHAPEINSTANCE_H_
+#include "ts/tsShapeInstance.h"
+#endif
+
+/// Keeps TSShapeInstances of one shape around for reuse.
+///
+/// Short lived effects, like explosions and debris, make a new instance of
+/// the same shape every time one spawns, which means allocating and setting
+/// up all of the node, object and material state.  A datablock can own one
+/// of these and have its objects take their instance from it, and hand it
+/// back when they're removed.
+///
+/// Instances come back with whatever threads and alpha they had; the user
+/// resets what it changes.  At most MaxFree are kept, the rest are deleted.
+class TSShapeInstancePool
+{
+   Vector<TSShapeInstance*> mFree;
+
+  public:
+   enum
+   {
+      MaxFree = 16
+   };
+
+   TSShapeInstancePool() { VECTOR_SET_ASSOCIATION(mFree); }
+   ~TSShapeInstancePool() { clear(); }
+
+   /// Returns an instance of shape, reused if one is free.
+   TSShapeInstance *alloc(const Resource<TSShape> &shape, bool loadMaterials = true)
+   {
+      while(mFree.size())
+      {
+         TSShapeInstance *inst = mFree.last();
+         mFree.pop_back();
+         if(inst->getShape() == (TSShape *) shape)
+            return inst;
+
+         // The datablock changed shapes under us.
+         delete inst;
+      }
+      return new TSShapeInstance(shape, loadMaterials);
+   }
+
+   void free(TSShapeInstance *inst)
+   {
+      if(!inst)
+         return;
+      if(mFree.size() < MaxFree)
+         mFree.push_back(inst);
+      else
+         delete inst;
+   }
+
+   void clear()
+   {
+      for(S32 i = 0; i < mFree.size(); i++)
+         delete mFree[i];
+      mFree.clear();
+   }
+};
+
+#endif
@@ -944,6 +944,13 @@ void TSShape::fixupOldSkins(S32 numMeshes, S32 numSkins, S32 numDetails, S32 * d
 //-------------------------------------------------
 void TSShape::exportSequences(Stream * s)
 {
+   // the dsq format only has raw keyframes
+   if (hasCompressedSequences())
+   {
+      Con::errorf("TSShape::exportSequences: can't export compressed sequences.");
+      return;
+   }
+
    // write version
    s->write(smVersion);
 
@@ -20,6 +20,9 @@
 // found in tsmesh
 extern void forceFaceCamera();
 extern void forceFaceCameraZAxis();
+extern void unwindStrip(S16 * indices, S32 numElements, Vector<S16> & triIndices);
+
+bool TSSortedMesh::smUseOrders = true;
 
 //-----------------------------------------------------
 // TSSortedMesh render methods
@@ -80,9 +83,28 @@ void TSSortedMesh::render(S32 frame, S32 matFrame, TSMaterialList * materials)
    if (alwaysWriteDepth)
       glDepthMask(GL_TRUE);
 
+   const Order * order = findOrder(frame,cameraCenter);
+   if (order)
+   {
+      for (S32 i=0; i<order->numRuns; i++)
+      {
+         const OrderRun & run = mOrderRuns[order->firstRun+i];
+
+         // material change?
+         if ( (TSShapeInstance::smRenderData.materialIndex ^ run.matIndex) & (TSDrawPrimitive::MaterialMask|TSDrawPrimitive::NoMaterial))
+         {
+            setMaterial(run.matIndex,materials);
+            if (alwaysWriteDepth)
+               glDepthMask(GL_TRUE);
+         }
+
+         glDrawElements(GL_TRIANGLES,run.numElements,GL_UNSIGNED_SHORT,&mOrderIndices[run.start]);
+      }
+   }
+
    Cluster * cluster;
-   S32 nextCluster = startCluster[frame];
-   do
+   S32 nextCluster = order ? -1 : startCluster[frame];
+   while (nextCluster>=0)
    {
       // the cluster...
       cluster = &clusters[nextCluster];
@@ -111,7 +133,7 @@ void TSSortedMesh::render(S32 frame, S32 matFrame, TSMaterialList * materials)
          nextCluster = (mDot(cluster->normal,cameraCenter) > cluster->k) ? cluster->frontCluster : cluster->backCluster;
       else
          nextCluster = cluster->frontCluster;
-   } while (nextCluster>=0);
+   }
 
    // unlock...
    if (lockArrays)
@@ -148,9 +170,20 @@ void TSSortedMesh::renderFog(S32 frame)
    if (lockArrays)
       glLockArraysEXT(0,vertCount);
 
+   // fog doesn't care about the materials
+   const Order * order = findOrder(frame,cameraCenter);
+   if (order)
+   {
+      for (S32 i=0; i<order->numRuns; i++)
+      {
+         const OrderRun & run = mOrderRuns[order->firstRun+i];
+         glDrawElements(GL_TRIANGLES,run.numElements,GL_UNSIGNED_SHORT,&mOrderIndices[run.start]);
+      }
+   }
+
    Cluster * cluster;
-   S32 nextCluster = startCluster[frame];
-   do
+   S32 nextCluster = order ? -1 : startCluster[frame];
+   while (nextCluster>=0)
    {
       // the cluster...
       cluster = &clusters[nextCluster];
@@ -167,13 +200,170 @@ void TSSortedMesh::renderFog(S32 frame)
          nextCluster = (mDot(cluster->normal,cameraCenter) > cluster->k) ? cluster->frontCluster : cluster->backCluster;
       else
          nextCluster = cluster->frontCluster;
-   } while (nextCluster>=0);
+   }
 
    // unlock...
    if (lockArrays)
       glUnlockArraysEXT();
 }
 
+//-----------------------------------------------------
+// TSSortedMesh precomputed orders
+//-----------------------------------------------------
+
+const TSSortedMesh::Order * TSSortedMesh::findOrder(S32 frame, const Point3F & cameraCenter)
+{
+   if (!smUseOrders || frame>=mOrderRoots.size() || mOrderRoots[frame]<0)
+      return NULL;
+
+   const OrderNode * node = &mOrderNodes[mOrderRoots[frame]];
+   while (node->cluster>=0)
+   {
+      const Cluster & cluster = clusters[node->cluster];
+      node = &mOrderNodes[(mDot(cluster.normal,cameraCenter) > cluster.k) ? node->front : node->back];
+   }
+   return &mOrders[node->front];
+}
+
+void TSSortedMesh::buildOrders()
+{
+   mOrderNodes.clear();
+   mOrderRoots.clear();
+   mOrders.clear();
+   mOrderRuns.clear();
+   mOrderIndices.clear();
+
+   // frames mostly share their start cluster, and with it the tree
+   mOrderRoots.setSize(startCluster.size());
+   for (S32 i=0; i<startCluster.size(); i++)
+   {
+      mOrderRoots[i] = -1;
+      for (S32 j=0; j<i && mOrderRoots[i]<0; j++)
+         if (startCluster[j]==startCluster[i])
+            mOrderRoots[i] = mOrderRoots[j];
+      if (mOrderRoots[i]>=0)
+         continue;
+
+      Vector<S32> path;
+      mOrderRoots[i] = buildOrderNode(startCluster[i],path);
+      if (mOrderRoots[i]<0)
+      {
+         // too many ways through, keep walking the clusters
+         mOrderNodes.clear();
+         mOrderRoots.clear();
+         mOrders.clear();
+         mOrderRuns.clear();
+         mOrderIndices.clear();
+         return;
+      }
+   }
+}
+
+S32 TSSortedMesh::buildOrderNode(S32 cluster, Vector<S32> & path)
+{
+   // follow the clusters without a plane, as render() does
+   while (cluster>=0)
+   {
+      // a loop, or more clusters than there are
+      if (cluster>=clusters.size() || path.size()>clusters.size())
+         return -1;
+
+      path.push_back(cluster);
+      const Cluster & c = clusters[cluster];
+      if (c.frontCluster!=c.backCluster)
+         break;
+      cluster = c.frontCluster;
+   }
+
+   S32 index = mOrderNodes.size();
+   mOrderNodes.increment();
+   if (cluster<0)
+   {
+      if (mOrders.size()==MaxOrders)
+         return -1;
+      mOrderNodes[index].cluster = -1;
+      mOrderNodes[index].front = mOrders.size();
+      mOrderNodes[index].back = -1;
+      addOrder(path);
+      return mOrderIndices.size()<=MaxOrderIndices ? index : -1;
+   }
+
+   const Cluster & c = clusters[cluster];
+   Vector<S32> backPath = path;
+   S32 front = buildOrderNode(c.frontCluster,path);
+   if (front<0)
+      return -1;
+   S32 back = buildOrderNode(c.backCluster,backPath);
+   if (back<0)
+      return -1;
+
+   mOrderNodes[index].cluster = cluster;
+   mOrderNodes[index].front = front;
+   mOrderNodes[index].back = back;
+   return index;
+}
+
+void TSSortedMesh::addOrder(const Vector<S32> & path)
+{
+   mOrders.increment();
+   Order & order = mOrders.last();
+   order.firstRun = mOrderRuns.size();
+   order.numRuns = 0;
+
+   Vector<S16> tris;
+   for (S32 i=0; i<path.size(); i++)
+   {
+      const Cluster & cluster = clusters[path[i]];
+      for (S32 j=cluster.startPrimitive; j<cluster.endPrimitive; j++)
+      {
+         const TSDrawPrimitive & draw = primitives[j];
+
+         // everything as triangles, in the order it would have been drawn
+         tris.clear();
+         S16 * src = (S16*)&indices[draw.start];
+         switch (draw.matIndex & TSDrawPrimitive::TypeMask)
+         {
+            case TSDrawPrimitive::Triangles:
+               for (S32 k=0; k+2<draw.numElements; k+=3)
+               {
+                  tris.push_back(src[k]);
+                  tris.push_back(src[k+1]);
+                  tris.push_back(src[k+2]);
+               }
+               break;
+            case TSDrawPrimitive::Strip:
+               unwindStrip(src,draw.numElements,tris);
+               break;
+            default:
+               for (S32 k=2; k<draw.numElements; k++)
+               {
+                  tris.push_back(src[0]);
+                  tris.push_back(src[k-1]);
+                  tris.push_back(src[k]);
+               }
+               break;
+         }
+
+         if (!tris.size())
+            continue;
+
+         // same material as the run before it, draw them together
+         S32 matIndex = (draw.matIndex & ~TSDrawPrimitive::TypeMask) | TSDrawPrimitive::Triangles;
+         if (!order.numRuns || mOrderRuns.last().matIndex!=matIndex)
+         {
+            mOrderRuns.increment();
+            mOrderRuns.last().start = mOrderIndices.size();
+            mOrderRuns.last().numElements = 0;
+            mOrderRuns.last().matIndex = matIndex;
+            order.numRuns++;
+         }
+         for (S32 k=0; k<tris.size(); k++)
+            mOrderIndices.push_back(U16(tris[k]));
+         mOrderRuns.last().numElements += tris.size();
+      }
+   }
+}
+
 //-----------------------------------------------------
 // TSSortedMesh collision methods
 //-----------------------------------------------------
@@ -225,13 +415,16 @@ void TSSortedMesh::assemble(bool skip)
 {
    bool save1 = TSMesh::smUseTriangles;
    bool save2 = TSMesh::smUseOneStrip;
+   bool save3 = TSMesh::smOptimizeVertexCache;
    TSMesh::smUseTriangles = false;
    TSMesh::smUseOneStrip = false;
+   TSMesh::smOptimizeVertexCache = false;   // the clusters are in drawing order
 
    TSMesh::assemble(skip);
 
    TSMesh::smUseTriangles = save1;
    TSMesh::smUseOneStrip = save2;
+   TSMesh::smOptimizeVertexCache = save3;
 
    S32 numClusters = alloc.get32();
    S32 * ptr32 = alloc.copyToShape32(numClusters*8);
@@ -256,6 +449,9 @@ void TSSortedMesh::assemble(bool skip)
    alwaysWriteDepth = alloc.get32()!=0;
 
    alloc.checkGuard();
+
+   if (!skip)
+      buildOrders();
 }
 
 void TSSortedMesh::disassemble()
@@ -40,6 +40,59 @@ public:
    /// sometimes, we want to write the depth value to the frame buffer even when object is translucent
    bool alwaysWriteDepth;
 
+   /// @name Precomputed Orders
+   ///
+   /// Which clusters get drawn, and in what order, only depends on which
+   /// side of each cluster plane the camera is on.  So every way through the
+   /// clusters is worked out on load, each as a list of triangle lists with
+   /// one per run of a material, and render() just tests the planes down a
+   /// small decision tree and draws the order it ends up at.  Meshes with
+   /// more than MaxOrders ways through keep walking the clusters.
+   /// @{
+
+   enum
+   {
+      MaxOrders       = 32,
+      MaxOrderIndices = 1 << 18
+   };
+
+   /// A plane test, or with cluster -1, a leaf whose front is the order.
+   struct OrderNode
+   {
+      S32 cluster;
+      S32 front;
+      S32 back;
+   };
+
+   struct Order
+   {
+      S32 firstRun;
+      S32 numRuns;
+   };
+
+   struct OrderRun
+   {
+      S32 start;
+      S32 numElements;
+      S32 matIndex;
+   };
+
+   Vector<OrderNode>       mOrderNodes;
+   Vector<S32>             mOrderRoots;   ///< node indexed by frame, -1 to walk the clusters
+   Vector<Order>           mOrders;
+   Vector<OrderRun>        mOrderRuns;    ///< triangle lists into mOrderIndices
+   Vector<U16>             mOrderIndices;
+
+   static bool smUseOrders;               ///< $pref::TS::sortedMeshOrders
+
+   void buildOrders();
+   S32  buildOrderNode(S32 cluster, Vector<S32> & path);
+   void addOrder(const Vector<S32> & path);
+
+   /// The order for a camera at cameraCenter, or NULL if there isn't one.
+   const Order * findOrder(S32 frame, const Point3F & cameraCenter);
+   /// @}
+
    // render methods..
    void render(S32 frame, S32 matFrame, TSMaterialList *);
    void renderFog(S32 frame);
@@ -8,6 +8,7 @@
 #include "sceneGraph/sgUtil.h"
 #include "terrain/sky.h"
 #include "dgl/dgl.h"
+#include "sceneGraph/boxCuller.h"
 
 SceneState *FrustrumCuller::smSceneState;
 Point3F     FrustrumCuller::smCamPos;
@@ -96,57 +97,9 @@ F32 FrustrumCuller::getBoxDistance(const Box3F &box)
 
 S32 FrustrumCuller::testBoxVisibility(const Box3F &bounds, const S32 mask, const F32 expand)
 {
-   S32 retMask = 0;
-
-   Point3F minPoint, maxPoint;
-   for(S32 i = 0; i < smNumClipPlanes; i++)
-   {
-      if(mask & (1 << i))
-      {
-         if(smClipPlane[i].x > 0)
-         {
-            maxPoint.x = bounds.max.x;
-            minPoint.x = bounds.min.x;
-         }
-         else
-         {
-            maxPoint.x = bounds.min.x;
-            minPoint.x = bounds.max.x;
-         }
-         if(smClipPlane[i].y > 0)
-         {
-            maxPoint.y = bounds.max.y;
-            minPoint.y = bounds.min.y;
-         }
-         else
-         {
-            maxPoint.y = bounds.min.y;
-            minPoint.y = bounds.max.y;
-         }
-
-         if(smClipPlane[i].z > 0)
-         {
-            maxPoint.z = bounds.max.z;
-            minPoint.z = bounds.min.z;
-         }
-         else
-         {
-            maxPoint.z = bounds.min.z;
-            minPoint.z = bounds.max.z;
-         }
-
-
-         F32 maxDot = mDot(maxPoint, smClipPlane[i]);
-         F32 minDot = mDot(minPoint, smClipPlane[i]);
-         F32 planeD = smClipPlane[i].d;
-
-         if(maxDot <= -(planeD + expand))
-            return -1;
-
-         if(minDot <= -planeD)
-            retMask |= (1 << i);
-      }
-   }
+   S32 retMask = BoxCuller::cullBox(smClipPlane, smNumClipPlanes, mask, expand, bounds.min, bounds.max);
+   if(retMask == -1)
+      return -1;
 
    // Check the far distance as well.
    if(mask & FarSphereMask)
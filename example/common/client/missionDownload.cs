@@ -23,6 +23,8 @@ function clientCmdMissionStartPhase1(%seq, %missionName, %musicTrack)
    // These need to come after the cls.
    echo ("*** New Mission: " @ %missionName);
    echo ("*** Phase 1: Download Datablocks & Targets");
+   startMissionLoad(%missionName);
+   missionLoadStage("datablocks");
    onMissionDownloadPhase1(%missionName, %musicTrack);
    commandToServer('MissionStartPhase1Ack', %seq);
 }
@@ -40,6 +42,7 @@ function clientCmdMissionStartPhase2(%seq,%missionName)
 {
    onPhase1Complete();
    echo ("*** Phase 2: Download Ghost Objects");
+   missionLoadStage("ghosts");
    purgeResources();
    onMissionDownloadPhase2(%missionName);
    commandToServer('MissionStartPhase2Ack', %seq);
@@ -67,6 +70,7 @@ function clientCmdMissionStartPhase3(%seq,%missionName)
    StartClientReplication();
    StartFoliageReplication();
    echo ("*** Phase 3: Mission Lighting");
+   missionLoadStage("lighting");
    $MSeq = %seq;
    $Client::MissionFile = %missionName;
 
@@ -92,6 +96,7 @@ function updateLightingProgress()
 function sceneLightingComplete()
 {
    echo("Mission lighting done");
+   endMissionLoad();
    onPhase3Complete();
    
    // The is also the end of the mission load cycle.
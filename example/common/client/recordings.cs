@@ -53,6 +53,31 @@ function StartSelectedDemo()
    }
 }
 
+//-----------------------------------------------------------------------------
+// Time demos play a recording one tick per frame, as fast as it renders,
+// write the frame times to <file>.json and quit.
+//-----------------------------------------------------------------------------
+
+function playTimeDemo(%file)
+{
+   new GameConnection(ServerConnection);
+   RootGroup.add(ServerConnection);
+
+   if(ServerConnection.playDemo(%file))
+   {
+      Canvas.setContent(PlayGui);
+      ServerConnection.prepDemoPlayback();
+      startTimeDemo(%file @ ".json");
+   }
+   else
+   {
+      error("Time demo playback failed for file '" @ %file @ "'.");
+      if (isObject(ServerConnection))
+         ServerConnection.delete();
+      quit();
+   }
+}
+
 function startDemoRecord()
 {
    // make sure that current recording stream is stopped
@@ -105,6 +130,12 @@ function stopDemoRecord()
 
 function demoPlaybackComplete()
 {
+   if($timeDemoFile !$= "")
+   {
+      quit();
+      return;
+   }
+
    disconnect();
    Canvas.setContent("MainMenuGui");
    Canvas.pushDialog(RecordingsDlg);
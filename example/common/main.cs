@@ -46,6 +46,7 @@ function initBaseServer()
    exec("./server/clientConnection.cs");
    exec("./server/kickban.cs");
    exec("./server/game.cs");
+   exec("./server/soakTest.cs");
 }   
 
 
@@ -63,7 +64,13 @@ function displayHelp() {
       "  -directX               Force DirectX acceleration\n"@
       "  -voodoo2               Force Voodoo2 acceleration\n"@
       "  -noSound               Starts game without sound\n"@
-      "  -prefs <configFile>    Exec the config file\n"
+      "  -prefs <configFile>    Exec the config file\n"@
+      "  -timedemo <demoFile>   Plays the recording as fast as possible and\n"@
+      "                         writes its frame times to <demoFile>.json\n"@
+      "  -soak <playerCounts>   Once the mission is loaded, soak tests the\n"@
+      "                         server with each number of bot players in\n"@
+      "                         turn, writing soak_<players>.json\n"@
+      "  -soakTime <seconds>    How long each soak test runs (60)\n"
    );
 }
 
@@ -125,6 +132,39 @@ function parseArgs()
             }
             else
                error("Error: Missing Command Line argument. Usage: -prefs <path/script.cs>");
+
+         //--------------------
+         case "-timedemo":
+            $argUsed[%i]++;
+            if (%hasNextArg) {
+               $timeDemoFile = %nextArg;
+               $argUsed[%i+1]++;
+               %i++;
+            }
+            else
+               error("Error: Missing Command Line argument. Usage: -timedemo <path/demo.rec>");
+
+         //--------------------
+         case "-soak":
+            $argUsed[%i]++;
+            if (%hasNextArg) {
+               $soakPlayers = strreplace(%nextArg, ",", " ");
+               $argUsed[%i+1]++;
+               %i++;
+            }
+            else
+               error("Error: Missing Command Line argument. Usage: -soak <playerCounts>");
+
+         //--------------------
+         case "-soakTime":
+            $argUsed[%i]++;
+            if (%hasNextArg) {
+               $soakTime = %nextArg;
+               $argUsed[%i+1]++;
+               %i++;
+            }
+            else
+               error("Error: Missing Command Line argument. Usage: -soakTime <seconds>");
       }
    }
 }
@@ -19,6 +19,11 @@ function loadMission( %missionName, %isFirstMission )
    echo("*** LOADING MISSION: " @ %missionName);
    echo("*** Stage 1 load");
 
+   // Start reading the mission's shapes, interiors and textures in the
+   // background while the rest of the load goes on.
+   startMissionLoad(%missionName);
+   missionLoadStage("mission info");
+
    // Reset all of these
    clearCenterPrintAll();
    clearBottomPrintAll();
@@ -70,6 +75,7 @@ function loadMissionStage2()
    $missionCRC = getFileCRC( %file );
 
    // Exec the mission, objects are added to the ServerGroup
+   missionLoadStage("mission objects");
    exec(%file);
    
    // If there was a problem with the load, let's try another mission
@@ -97,6 +103,13 @@ function loadMissionStage2()
    // Go ahead and launch the game
    onMissionLoaded();
    purgeResources();
+
+   // Without a local client there's nothing more to time.
+   if ($Server::Dedicated)
+      endMissionLoad();
+
+   if ($soakPlayers !$= "" && $soakIndex $= "")
+      startSoakTests();
 }
 
 
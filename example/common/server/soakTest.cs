@@ -0,0 +1,49 @@
+//-----------------------------------------------------------------------------
+// Torque Game Engine 
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Server soak tests
+// Runs a soak test for each player count in $soakPlayers once the mission
+// is loaded, each for $soakTime seconds, writing soak_<players>.json, then
+// quits.  Start a dedicated server with -soak "32 64 128" to measure how
+// the server scales.
+//-----------------------------------------------------------------------------
+
+function startSoakTests()
+{
+   if ($soakTime $= "")
+      $soakTime = 60;
+
+   // Make room for the bots
+   %max = 0;
+   for (%i = 0; %i < getWordCount($soakPlayers); %i++)
+      if (getWord($soakPlayers, %i) > %max)
+         %max = getWord($soakPlayers, %i);
+   if ($pref::Server::MaxPlayers < %max)
+      $pref::Server::MaxPlayers = %max;
+
+   $soakIndex = 0;
+   runNextSoakTest();
+}
+
+function runNextSoakTest()
+{
+   if ($soakIndex >= getWordCount($soakPlayers))
+   {
+      echo("*** Soak tests done");
+      quit();
+      return;
+   }
+   %players = getWord($soakPlayers, $soakIndex);
+   $soakIndex++;
+   if (!startSoakTest(%players, $soakTime, "soak_" @ %players @ ".json"))
+      error("Soak test with " @ %players @ " players didn't get all its bots in.");
+}
+
+function onSoakTestComplete(%reportFile)
+{
+   if ($soakPlayers !$= "")
+      schedule(1000, 0, runNextSoakTest);
+}
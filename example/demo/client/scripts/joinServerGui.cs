@@ -136,6 +136,11 @@ function onServerQueryStatus(%status, %msg, %value)
          JS_statusText.setText("Query Servers");
          JS_statusBar.setValue(%value);
 
+      case "update":
+         // Servers found so far, in fast query mode.
+         JoinServerGui.update();
+         JS_queryStatus.setVisible(true);
+
       case "done":
          JS_queryMaster.setActive(true);
          JS_queryStatus.setVisible(false);
@@ -163,6 +163,30 @@ for ($i = 1; $i < $Game::argc ; $i++)
          else
             error("Error: Missing Command Line argument. Usage: -jDebug <journal_name>");
 
+      //--------------------
+      case "-serverRecord":
+         $argUsed[$i]++;
+         if ($hasNextArg)
+         {
+            startServerRecording($nextArg);
+            $argUsed[$i+1]++;
+            $i++;
+         }
+         else
+            error("Error: Missing Command Line argument. Usage: -serverRecord <file_name>");
+
+      //--------------------
+      case "-serverReplay":
+         $argUsed[$i]++;
+         if ($hasNextArg)
+         {
+            startServerReplay($nextArg);
+            $argUsed[$i+1]++;
+            $i++;
+         }
+         else
+            error("Error: Missing Command Line argument. Usage: -serverReplay <file_name>");
+
       //-------------------
       case "-help":
          $displayHelp = true;
@@ -230,6 +254,8 @@ function displayHelp() {
       "  -jSave  <file_name>    Record a journal\n"@
       "  -jPlay  <file_name>    Play back a journal\n"@
       "  -jDebug <file_name>    Play back a journal and issue an int3 at the end\n"@
+      "  -serverRecord <file>   Record what the server is sent, for -serverReplay\n"@
+      "  -serverReplay <file>   Replay a server recording at full speed and report\n"@
       "  -help                  Display this help message\n"
    );
 }
@@ -246,6 +272,11 @@ if (!$logModeSpecified) {
 // to the scripts and the resource engine.
 setModPaths($userMods);
 
+// Bring every stale DSO up to date at once, spread over the thread pool,
+// so the execs below only have to load them.
+compileAll("*.cs");
+compileAll("*.gui");
+
 // Get the first mod on the list, which will be the last to be applied... this
 // does not modify the list.
 nextToken($userMods, currentMod, ";");
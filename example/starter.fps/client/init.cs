@@ -108,6 +108,11 @@ function initClient()
       loadMainMenu();
       connect($JoinGameAddress, "", $Pref::Player::Name);
    }
+   else if ($timeDemoFile !$= "") {
+      // Benchmark a recording, then quit.
+      loadMainMenu();
+      playTimeDemo($timeDemoFile);
+   }
    else {
       // Otherwise go to the splash screen.
       Canvas.setCursor("DefaultCursor");
@@ -67,11 +67,11 @@ LINK.LIBS.VORBIS  =  -L=../lib/xiph/linux -logg -lvorbis -ltheora
 # JMQNOTE: aside from gluProject/unProject, GLU doesn't work.  
 # calling a GLU function that calls a GL function will cause a 
 # crash.  let me know if you have a fix :)
-LINK.LIBS.GENERAL = $(LINK.LIBS.VORBIS) -Wl,-static -Wl,-lGLU -Wl,-dy -L/usr/X11R6/lib -lSDL -lpthread -ldl # -lefence
+LINK.LIBS.GENERAL = $(LINK.LIBS.VORBIS) -Wl,-static -Wl,-lGLU -Wl,-dy -L/usr/X11R6/lib -lSDL -lpthread -ldl -lrt # -lefence
 
-LINK.LIBS.TOOLS   = $(LINK.LIBS.VORBIS) -Wl,-static -Wl,-lGLU -Wl,-dy -L/usr/X11R6/lib -lSDL -lpthread -ldl # -lefence
+LINK.LIBS.TOOLS   = $(LINK.LIBS.VORBIS) -Wl,-static -Wl,-lGLU -Wl,-dy -L/usr/X11R6/lib -lSDL -lpthread -ldl -lrt # -lefence
 # -lefence is useful for finding memory corruption problems
-LINK.LIBS.SERVER  = $(LINK.LIBS.VORBIS) -lpthread -lSDL -L/usr/X11R6/lib
+LINK.LIBS.SERVER  = $(LINK.LIBS.VORBIS) -lpthread -lrt -lSDL -L/usr/X11R6/lib
 LINK.LIBS.RELEASE =  -lXft
 LINK.LIBS.DEBUG   =  -lXft
 
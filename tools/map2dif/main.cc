@@ -23,6 +23,7 @@
 #include "interior/floorPlanRes.h"
 #include "map2dif/morianGame.h"
 #include "core/frameAllocator.h"
+#include "core/threadPool.h"
 #include "gui/core/guiCanvas.h"
 #include "map2dif/lmapPacker.h"
 
@@ -73,12 +74,14 @@ static bool initLibraries()
 
    Math::init();
    Platform::init();    // platform specific initialization
+   ThreadPool::create();
    return(true);
 }
 
 static void shutdownLibraries()
 {
    // shut down
+   ThreadPool::destroy();
    Platform::shutdown();
    Con::shutdown();
 
@@ -8,6 +8,7 @@
 #include "math/mMath.h"
 #include "core/bitMatrix.h"
 #include "interior/interior.h"
+#include "core/threadPool.h"
 
 #ifdef DUMP_LIGHTMAPS
 #include "core/fileStream.h"
@@ -59,8 +60,6 @@ void sgIlluminateSurface(EditGeometry::Surface &surface)
 
 Lighting::Lighting() :
    mNumAmbiguousPlanes(0),
-   mNodeRepository(0),
-   mWindingStore(0),
    mSurfaceEmitterInfos(0),
    mEmitterSurfaceIndices(0)
 {
@@ -80,7 +79,7 @@ Lighting::~Lighting()
    
    //
    mEmitterInfoChunker.clear();
-   mNodeChunker.clear();
+   mStore.mNodeChunker.clear();
    mSurfaceChunker.clear();
    
    //
@@ -448,33 +447,60 @@ void Lighting::processEmitterBSPs()
 
 void Lighting::flushLexelPoints()
 {
-   mLexelPoints.setSize(0);
-   mLexelPoints.reserve(LexelPointStoreSize);
+   Vector<Point3D> & lexelPoints = getStore()->mLexelPoints;
+   lexelPoints.setSize(0);
+   lexelPoints.reserve(LexelPointStoreSize);
 }
 
 const Point3D & Lighting::getLexelPoint(U32 index)
 {
-   AssertFatal(index < mLexelPoints.size(), "Lighting::getLexelPoint: index out of range");
-   return(mLexelPoints[index]);
+   Vector<Point3D> & lexelPoints = getStore()->mLexelPoints;
+   AssertFatal(index < lexelPoints.size(), "Lighting::getLexelPoint: index out of range");
+   return(lexelPoints[index]);
 }
 
 U32 Lighting::insertLexelPoint(const Point3D & pnt)
 {
-   if(!mLexelPoints.size())
-      mLexelPoints.reserve(LexelPointStoreSize);
+   Vector<Point3D> & lexelPoints = getStore()->mLexelPoints;
+   if(!lexelPoints.size())
+      lexelPoints.reserve(LexelPointStoreSize);
 
-   if(mLexelPoints.size() == (mLexelPoints.capacity() - 1))
-      mLexelPoints.reserve(mLexelPoints.size() + LexelPointStoreSize);
+   if(lexelPoints.size() == (lexelPoints.capacity() - 1))
+      lexelPoints.reserve(lexelPoints.size() + LexelPointStoreSize);
 
-   mLexelPoints.push_back(pnt);
-   return(mLexelPoints.size() - 1);
+   lexelPoints.push_back(pnt);
+   return(lexelPoints.size() - 1);
 }
 
 //------------------------------------------------------------------------------
 
+TORQUE_THREAD_LOCAL Lighting::NodeStore * Lighting::smThreadStore = 0;
+
 void Lighting::lightSurfaces()
 {
-   for(U32 i = 0; i < mSurfaces.size(); i++)
+   // A surface only reads the shadow volumes and writes its own lightmaps,
+   // so the surfaces can be lit in any order, on any thread, and come out
+   // the same.  The nodes they clip come from a store per batch.
+   if(gThreadPool)
+      gThreadPool->parallelFor(mSurfaces.size(), lightSurfaceBatch, this);
+   else
+      lightSurfaceBatch(0, mSurfaces.size(), this);
+}
+
+void Lighting::lightSurfaceBatch(U32 start, U32 end, void * userData)
+{
+   NodeStore store;
+   NodeStore * prevStore = smThreadStore;
+   smThreadStore = &store;
+
+   ((Lighting *) userData)->lightSurfaces(start, end);
+
+   smThreadStore = prevStore;
+}
+
+void Lighting::lightSurfaces(U32 start, U32 end)
+{
+   for(U32 i = start; i < end; i++)
    {
       Surface * surface = mSurfaces[i];
 
@@ -798,7 +824,6 @@ void Lighting::lightSurfaces()
 
 #ifdef DUMP_LIGHTMAPS
       // 
-      static U32 majCnt = 0;
       U32 minCnt = 0;
       for(U32 j = 0; j < surface->mNumEmitters; j++)
       {
@@ -821,11 +846,10 @@ void Lighting::lightSurfaces()
 
             //
             FileStream output;
-            output.open(avar("lightmap_%d_%d.png", majCnt, minCnt++), FileStream::Write);
+            output.open(avar("lightmap_%d_%d.png", i, minCnt++), FileStream::Write);
             bitmap.writePNG(output);
          }
       }
-      majCnt++;
 #endif
    }
 }
@@ -836,10 +860,11 @@ void Lighting::lightSurfaces()
 
 Lighting::MiniWinding * Lighting::createWinding()
 {
-   if(mWindingStore)
+   NodeStore * store = getStore();
+   if(store->mWindingStore)
    {
-      MiniWinding * winding = mWindingStore;
-      mWindingStore = mWindingStore->mNext;
+      MiniWinding * winding = store->mWindingStore;
+      store->mWindingStore = store->mWindingStore->mNext;
 
       //
       winding->mNumIndices = 0;
@@ -847,7 +872,7 @@ Lighting::MiniWinding * Lighting::createWinding()
    }
 
    // create it
-   MiniWinding * winding = mWindingChunker.alloc();
+   MiniWinding * winding = store->mWindingChunker.alloc();
    winding->mNumIndices = 0;
    return(winding);   
 }
@@ -858,8 +883,9 @@ void Lighting::recycleWinding(MiniWinding * winding)
       return;
 
    // add to head
-   winding->mNext = mWindingStore;
-   mWindingStore = winding;
+   NodeStore * store = getStore();
+   winding->mNext = store->mWindingStore;
+   store->mWindingStore = winding;
 }
 
 void Lighting::recycleNode(SVNode * node)
@@ -879,8 +905,9 @@ void Lighting::recycleNode(SVNode * node)
    node->mWinding = 0;
 
    // add
-   node->mBack = mNodeRepository;
-   mNodeRepository = node;
+   NodeStore * store = getStore();
+   node->mBack = store->mNodeRepository;
+   store->mNodeRepository = node;
 }
 
 //-------------------------------------------------------------------
@@ -888,10 +915,11 @@ void Lighting::recycleNode(SVNode * node)
 Lighting::SVNode * Lighting::createNode(SVNode::Type type)
 {
    // try to get a recycled node first...
-   if(mNodeRepository)
+   NodeStore * store = getStore();
+   if(store->mNodeRepository)
    {
-      SVNode * node = mNodeRepository;
-      mNodeRepository = mNodeRepository->mBack;
+      SVNode * node = store->mNodeRepository;
+      store->mNodeRepository = store->mNodeRepository->mBack;
 
       //
       node->mType = type;
@@ -905,7 +933,7 @@ Lighting::SVNode * Lighting::createNode(SVNode::Type type)
    }
 
    // create the node
-   SVNode * node = mNodeChunker.alloc();
+   SVNode * node = store->mNodeChunker.alloc();
    node->mFront = node->mBack = 0;
    node->mTarget = 0;
    node->mEmitterInfo = 0;
@@ -1436,7 +1464,7 @@ bool Lighting::SVNode::clipWindingToPlaneFront(U32 planeEQIndex)
    // valid point indices?
    for(U32 i = 0; i < mWinding->mNumIndices; i++)
    {
-      U32 size = mType == LexelPlane ? gWorkingLighting->mLexelPoints.size() : 
+      U32 size = mType == LexelPlane ? gWorkingLighting->getStore()->mLexelPoints.size() : 
          gWorkingGeometry->mPoints.size();
       AssertFatal(mWinding->mIndices[i] < size, "Lighting::SVNode::clipWindingToPlaneFront: invalid point index");
    }
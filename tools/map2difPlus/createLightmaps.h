@@ -111,15 +111,28 @@ class Lighting
       MiniWinding * createWinding();
       void recycleWinding(MiniWinding *);
 
-      Chunker<MiniWinding>    mWindingChunker;
-      MiniWinding *           mWindingStore;
-
-      //
-      Chunker<SVNode> mNodeChunker;
-      SVNode * mNodeRepository;
-      
       SVNode * createNode(SVNode::Type type);
       void recycleNode(SVNode * node);
+
+      /// Where nodes, windings and lexel points come from.  Each batch of
+      /// lightSurfaces() has its own, so batches can be lit on any thread
+      /// of the pool; everything else uses mStore.
+      struct NodeStore
+      {
+         Chunker<MiniWinding>    mWindingChunker;
+         MiniWinding *           mWindingStore;
+
+         Chunker<SVNode>         mNodeChunker;
+         SVNode *                mNodeRepository;
+
+         Vector<Point3D>         mLexelPoints;
+
+         NodeStore() : mWindingStore(0), mNodeRepository(0) {}
+      };
+      NodeStore mStore;
+      static TORQUE_THREAD_LOCAL NodeStore * smThreadStore;
+
+      NodeStore * getStore() { return(smThreadStore ? smThreadStore : &mStore); }
       
       class Surface
       {
@@ -240,6 +253,8 @@ class Lighting
       void createShadowVolumes();
       void processEmitterBSPs();
       void lightSurfaces();
+      void lightSurfaces(U32 start, U32 end);
+      static void lightSurfaceBatch(U32 start, U32 end, void * userData);
       void processAnimatedLights();
 
       //
@@ -258,7 +273,6 @@ class Lighting
       //F64 getLumelScale();
       
       //
-      Vector<Point3D> mLexelPoints;
       U32 mNumAmbiguousPlanes;
 
       const Point3D & getLexelPoint(U32 index);
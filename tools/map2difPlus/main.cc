@@ -22,6 +22,7 @@
 #include "interior/floorPlanRes.h"
 #include "map2difPlus/morianGame.h"
 #include "core/frameAllocator.h"
+#include "core/threadPool.h"
 #include "gui/core/guiCanvas.h"
 #include "map2difPlus/lmapPacker.h"
 #include "map2difPlus/convert.h"
@@ -86,6 +87,7 @@ static bool initLibraries()
 
    Math::init();
    Platform::init();    // platform specific initialization
+   ThreadPool::create();
 
    // Create a log file
    Con::setLogMode(6);
@@ -96,6 +98,7 @@ static bool initLibraries()
 static void shutdownLibraries()
 {
    // shut down
+   ThreadPool::destroy();
    Platform::shutdown();
    Con::shutdown();
 
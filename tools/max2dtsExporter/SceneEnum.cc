@@ -30,6 +30,8 @@ F32 animationDelta;
 F32 maxFrameRate;
 S32 weightsPerVertex;
 F32 weightThreshhold;
+F32 keyframeRotationTolerance;
+F32 keyframeTranslationTolerance;
 char baseTexturePath[256];
 S32 t2AutoDetail;
 
@@ -447,6 +449,13 @@ void SceneEnumProc::processScene()
     // generate the shape
     pShape = shapeMimic.generateShape();
 
+    // keyframe reduce and quantize the node animation if asked to
+    if (pShape && (keyframeRotationTolerance>0.0f || keyframeTranslationTolerance>0.0f))
+    {
+        S32 saved = pShape->compressSequences(keyframeRotationTolerance,keyframeTranslationTolerance);
+        printDump(PDSequences,avar("Compressed keyframes, saved %i bytes.\r\n",saved));
+    }
+
     // clear lists for next time around
     shapeMimic.clearCollapseTransforms();
     
@@ -608,7 +617,7 @@ U32 BoolParamBit[NumBoolParams] =
     0
 };
 
-#define NumFloatParams 6
+#define NumFloatParams 8
 
 char * FloatParamNames[NumFloatParams] =
 {
@@ -617,7 +626,9 @@ char * FloatParamNames[NumFloatParams] =
     "Sequence::defaultFrameRate",
     "Sequence::defaultGroundFrameRate",
     "Params::SkinWeightThreshhold",
-    "Sequence::defaultDuration"
+    "Sequence::defaultDuration",
+    "Params::KeyframeRotationTolerance",
+    "Params::KeyframeTranslationTolerance"
 };
 
 F32 * FloatParams[NumFloatParams] =
@@ -627,7 +638,9 @@ F32 * FloatParams[NumFloatParams] =
     &SequenceObject::defaultFrameRate,
     &SequenceObject::defaultGroundFrameRate,
     &weightThreshhold,
-    &SequenceObject::defaultDuration
+    &SequenceObject::defaultDuration,
+    &keyframeRotationTolerance,
+    &keyframeTranslationTolerance
 };
 
 #define NumIntParams 5
@@ -1001,6 +1014,8 @@ void SceneEnumProc::setInitialDefaults()
     maxFrameRate = 30.0f;
     weightsPerVertex = 10;
     weightThreshhold = 0.001f;
+    keyframeRotationTolerance = 0.0f;
+    keyframeTranslationTolerance = 0.0f;
     dStrcpy(baseTexturePath,".");
 
     resetSequenceDefaults();
@@ -118,6 +118,8 @@ extern F32 animationDelta;
 extern F32 maxFrameRate;
 extern S32 weightsPerVertex;
 extern F32 weightThreshhold;
+extern F32 keyframeRotationTolerance;
+extern F32 keyframeTranslationTolerance;
 extern char baseTexturePath[256];
 extern S32 t2AutoDetail;
 